@@ -95,7 +95,34 @@ namespace xt
             }
         }
 
+        // state.range(1) is the small GEMM threshold, 0 sends every product to BLAS
+        template <class E>
+        inline auto benchmark_small_dot(benchmark::State& state)
+        {
+            E x, y;
+            init_xtensor_benchmark(x, y, state.range(0), state.range(0));
+
+            std::size_t threshold = xt::blas::small_gemm_threshold();
+            xt::blas::set_small_gemm_threshold(static_cast<std::size_t>(state.range(1)));
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(x, y);
+                benchmark::DoNotOptimize(res.data());
+            }
+            xt::blas::set_small_gemm_threshold(threshold);
+        }
+
+        inline void small_dot_arguments(benchmark::internal::Benchmark* b)
+        {
+            for (int n : {2, 3, 4, 8, 12, 16, 24, 32})
+            {
+                b->Args({n, 0});
+                b->Args({n, 32});
+            }
+        }
+
         BENCHMARK_TEMPLATE(benchmark_dot, xt::xtensor<double, 2>)->Range(32, 32<<3);
+        BENCHMARK_TEMPLATE(benchmark_small_dot, xt::xtensor<double, 2>)->Apply(small_dot_arguments);
         BENCHMARK_TEMPLATE(benchmark_transpose_dot, xt::xtensor<double, 2>)->Range(32, 32<<3);
         BENCHMARK_TEMPLATE(benchmark_transpose_with_assign_dot, xt::xtensor<double, 2>)->Range(32, 32<<3);
     }
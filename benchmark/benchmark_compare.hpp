@@ -0,0 +1,512 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef BENCHMARK_COMPARE_HPP
+#define BENCHMARK_COMPARE_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+#if defined(XTENSOR_BENCHMARK_EIGEN)
+#include <Eigen/Dense>
+#endif
+
+/**
+ * The same double precision workloads through xt::linalg, through the
+ * BLAS and LAPACK routines called directly, and through Eigen if it was
+ * found. The raw calls work on column major buffers, query their
+ * workspaces once outside of the timed loop and copy the inputs that
+ * LAPACK overwrites, so that the difference with xt::linalg is the cost
+ * of the wrappers: the checks, copies, layout conversions, workspace
+ * handling and result allocations. benchmark/compare.py times the same
+ * workloads with NumPy and prints the overhead of each library per call.
+ *
+ * The benchmarks are named benchmark_compare_<workload>_<library>, with
+ * the matrix size n as argument:
+ *   dot        (n x n) * (n x n)
+ *   solve      (n x n) x = b, b a vector
+ *   svd        full U, S and V^T of an (n x n) matrix
+ *   eigh       eigenvalues and eigenvectors of a symmetric (n x n) matrix
+ *   lstsq      minimum norm solution of a (2n x n) system, b a vector
+ *   tensordot  (n x 8 x 8) . (8 x 8 x n) over two axes
+ */
+
+namespace xt
+{
+    namespace benchmark_compare
+    {
+
+        /****************************
+         * Benchmark initialization *
+         ****************************/
+
+        // the same values, column after column, for every library; the
+        // diagonal is dominant so that the systems are well conditioned
+        inline double matrix_value(std::size_t i, std::size_t j, std::size_t rows, std::size_t cols)
+        {
+            double d = i == j ? double(rows + cols) : 0.;
+            return 0.5 + double((3 * i + 7 * j) % 13) / 7. + d;
+        }
+
+        inline double symmetric_value(std::size_t i, std::size_t j, std::size_t n)
+        {
+            std::size_t d = i > j ? i - j : j - i;
+            return 1. / double(1 + d) + (i == j ? double(n) : 0.);
+        }
+
+        template <class F>
+        inline std::vector<double> column_major_buffer(std::size_t rows, std::size_t cols, F f)
+        {
+            std::vector<double> v(rows * cols);
+            for (std::size_t j = 0; j < cols; ++j)
+            {
+                for (std::size_t i = 0; i < rows; ++i)
+                {
+                    v[i + j * rows] = f(i, j);
+                }
+            }
+            return v;
+        }
+
+        inline std::vector<double> general_buffer(std::size_t rows, std::size_t cols)
+        {
+            return column_major_buffer(rows, cols, [rows, cols](std::size_t i, std::size_t j) {
+                return matrix_value(i, j, rows, cols);
+            });
+        }
+
+        inline std::vector<double> symmetric_buffer(std::size_t n)
+        {
+            return column_major_buffer(n, n, [n](std::size_t i, std::size_t j) {
+                return symmetric_value(i, j, n);
+            });
+        }
+
+        // the default row major containers of an xt::linalg user
+        template <class E, class F>
+        inline E make_xtensor(const typename E::shape_type& shape, F f)
+        {
+            E e = E::from_shape(shape);
+            for (std::size_t i = 0; i < shape[0]; ++i)
+            {
+                for (std::size_t j = 0; j < shape[1]; ++j)
+                {
+                    e(i, j) = f(i, j);
+                }
+            }
+            return e;
+        }
+
+        inline xtensor<double, 2> general_xtensor(std::size_t rows, std::size_t cols)
+        {
+            return make_xtensor<xtensor<double, 2>>({rows, cols}, [rows, cols](std::size_t i, std::size_t j) {
+                return matrix_value(i, j, rows, cols);
+            });
+        }
+
+        inline xtensor<double, 2> symmetric_xtensor(std::size_t n)
+        {
+            return make_xtensor<xtensor<double, 2>>({n, n}, [n](std::size_t i, std::size_t j) {
+                return symmetric_value(i, j, n);
+            });
+        }
+
+        inline xtensor<double, 1> vector_xtensor(std::size_t n)
+        {
+            xtensor<double, 1> v = xtensor<double, 1>::from_shape({n});
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                v(i) = 1. + double(i % 5);
+            }
+            return v;
+        }
+
+        inline std::vector<double> vector_buffer(std::size_t n)
+        {
+            std::vector<double> v(n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                v[i] = 1. + double(i % 5);
+            }
+            return v;
+        }
+
+        inline void compare_sizes(benchmark::internal::Benchmark* b)
+        {
+            for (int n : {2, 4, 8, 16, 32, 64, 256})
+            {
+                b->Arg(n);
+            }
+        }
+
+        inline std::size_t size_argument(const benchmark::State& state)
+        {
+            return static_cast<std::size_t>(state.range(0));
+        }
+
+        inline void raw_gemm(blas_index_t m, blas_index_t n, blas_index_t k,
+                             const double* a, const double* b, double* c)
+        {
+#if defined(HAVE_CBLAS)
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, n, k,
+                        1., a, m, b, k, 0., c, m);
+#else
+            cxxblas::gemm(cxxblas::StorageOrder::ColMajor,
+                          cxxblas::Transpose::NoTrans, cxxblas::Transpose::NoTrans,
+                          m, n, k, 1., a, m, b, k, 0., c, m);
+#endif
+        }
+
+        /*******
+         * dot *
+         *******/
+
+        inline void benchmark_compare_dot_xtensor(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            auto a = general_xtensor(n, n);
+            auto b = symmetric_xtensor(n);
+            while (state.KeepRunning())
+            {
+                auto c = xt::linalg::dot(a, b);
+                benchmark::DoNotOptimize(c.data());
+            }
+        }
+
+        // the result is allocated in the loop, as it is by xt::linalg::dot
+        inline void benchmark_compare_dot_blas(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            blas_index_t ld = to_blas_index(n);
+            auto a = general_buffer(n, n);
+            auto b = symmetric_buffer(n);
+            while (state.KeepRunning())
+            {
+                std::vector<double> c(n * n);
+                raw_gemm(ld, ld, ld, a.data(), b.data(), c.data());
+                benchmark::DoNotOptimize(c.data());
+            }
+        }
+
+        /*********
+         * solve *
+         *********/
+
+        inline void benchmark_compare_solve_xtensor(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            auto a = general_xtensor(n, n);
+            auto b = vector_xtensor(n);
+            while (state.KeepRunning())
+            {
+                auto x = xt::linalg::solve(a, b);
+                benchmark::DoNotOptimize(x.data());
+            }
+        }
+
+        inline void benchmark_compare_solve_blas(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            blas_index_t ld = to_blas_index(n);
+            auto a = general_buffer(n, n);
+            auto b = vector_buffer(n);
+            while (state.KeepRunning())
+            {
+                std::vector<double> lu(a);
+                std::vector<double> x(b);
+                std::vector<blas_index_t> piv(n);
+                blas_index_t info = cxxlapack::gesv<blas_index_t>(ld, 1, lu.data(), ld, piv.data(), x.data(), ld);
+                benchmark::DoNotOptimize(info);
+                benchmark::DoNotOptimize(x.data());
+            }
+        }
+
+        /*******
+         * svd *
+         *******/
+
+        inline void benchmark_compare_svd_xtensor(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            auto a = general_xtensor(n, n);
+            while (state.KeepRunning())
+            {
+                auto usv = xt::linalg::svd(a);
+                benchmark::DoNotOptimize(std::get<1>(usv).data());
+            }
+        }
+
+        inline void benchmark_compare_svd_blas(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            blas_index_t ld = to_blas_index(n);
+            auto a = general_buffer(n, n);
+            std::vector<blas_index_t> iwork(8 * n);
+            double query = 0.;
+            cxxlapack::gesdd<blas_index_t>('A', ld, ld, nullptr, ld, nullptr, nullptr, ld, nullptr, ld,
+                                           &query, -1, iwork.data());
+            std::vector<double> work(static_cast<std::size_t>(query));
+            while (state.KeepRunning())
+            {
+                std::vector<double> m(a);
+                std::vector<double> s(n);
+                std::vector<double> u(n * n);
+                std::vector<double> vt(n * n);
+                blas_index_t info = cxxlapack::gesdd<blas_index_t>('A', ld, ld, m.data(), ld, s.data(),
+                                                                   u.data(), ld, vt.data(), ld,
+                                                                   work.data(), to_blas_index(work.size()),
+                                                                   iwork.data());
+                benchmark::DoNotOptimize(info);
+                benchmark::DoNotOptimize(s.data());
+            }
+        }
+
+        /********
+         * eigh *
+         ********/
+
+        inline void benchmark_compare_eigh_xtensor(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            auto a = symmetric_xtensor(n);
+            while (state.KeepRunning())
+            {
+                auto wv = xt::linalg::eigh(a);
+                benchmark::DoNotOptimize(std::get<0>(wv).data());
+            }
+        }
+
+        inline void benchmark_compare_eigh_blas(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            blas_index_t ld = to_blas_index(n);
+            auto a = symmetric_buffer(n);
+            double query = 0.;
+            blas_index_t iquery = 0;
+            cxxlapack::syevd<blas_index_t>('V', 'L', ld, nullptr, ld, nullptr, &query, -1, &iquery, -1);
+            std::vector<double> work(static_cast<std::size_t>(query));
+            std::vector<blas_index_t> iwork(static_cast<std::size_t>(iquery));
+            while (state.KeepRunning())
+            {
+                std::vector<double> v(a);
+                std::vector<double> w(n);
+                blas_index_t info = cxxlapack::syevd<blas_index_t>('V', 'L', ld, v.data(), ld, w.data(),
+                                                                   work.data(), to_blas_index(work.size()),
+                                                                   iwork.data(), to_blas_index(iwork.size()));
+                benchmark::DoNotOptimize(info);
+                benchmark::DoNotOptimize(w.data());
+            }
+        }
+
+        /*********
+         * lstsq *
+         *********/
+
+        inline void benchmark_compare_lstsq_xtensor(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            auto a = general_xtensor(2 * n, n);
+            auto b = vector_xtensor(2 * n);
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::lstsq(a, b);
+                benchmark::DoNotOptimize(std::get<0>(res).data());
+            }
+        }
+
+        inline void benchmark_compare_lstsq_blas(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            blas_index_t m = to_blas_index(2 * n);
+            blas_index_t k = to_blas_index(n);
+            auto a = general_buffer(2 * n, n);
+            auto b = vector_buffer(2 * n);
+            blas_index_t rank = 0;
+            double query = 0.;
+            blas_index_t iquery = 0;
+            cxxlapack::gelsd<blas_index_t>(m, k, 1, nullptr, m, nullptr, m, nullptr, -1., rank,
+                                           &query, -1, &iquery);
+            std::vector<double> work(static_cast<std::size_t>(query));
+            std::vector<blas_index_t> iwork(static_cast<std::size_t>(std::max(iquery, blas_index_t(1))));
+            while (state.KeepRunning())
+            {
+                std::vector<double> m_a(a);
+                std::vector<double> x(b);
+                std::vector<double> s(n);
+                blas_index_t info = cxxlapack::gelsd<blas_index_t>(m, k, 1, m_a.data(), m, x.data(), m, s.data(),
+                                                                   -1., rank, work.data(),
+                                                                   to_blas_index(work.size()), iwork.data());
+                benchmark::DoNotOptimize(info);
+                benchmark::DoNotOptimize(x.data());
+            }
+        }
+
+        /*************
+         * tensordot *
+         *************/
+
+        inline void benchmark_compare_tensordot_xtensor(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            xtensor<double, 3> a = xtensor<double, 3>::from_shape({n, 8, 8});
+            xtensor<double, 3> b = xtensor<double, 3>::from_shape({8, 8, n});
+            std::copy_n(general_buffer(n, 64).cbegin(), a.size(), a.begin());
+            std::copy_n(general_buffer(64, n).cbegin(), b.size(), b.begin());
+            while (state.KeepRunning())
+            {
+                auto c = xt::linalg::tensordot(a, b, 2);
+                benchmark::DoNotOptimize(c.data());
+            }
+        }
+
+        // the contraction is the (n x 64) * (64 x n) product of the reshaped operands
+        inline void benchmark_compare_tensordot_blas(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            blas_index_t ld = to_blas_index(n);
+            auto a = general_buffer(n, 64);
+            auto b = general_buffer(64, n);
+            while (state.KeepRunning())
+            {
+                std::vector<double> c(n * n);
+                raw_gemm(ld, ld, 64, a.data(), b.data(), c.data());
+                benchmark::DoNotOptimize(c.data());
+            }
+        }
+
+        BENCHMARK(benchmark_compare_dot_xtensor)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_dot_blas)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_solve_xtensor)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_solve_blas)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_svd_xtensor)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_svd_blas)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_eigh_xtensor)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_eigh_blas)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_lstsq_xtensor)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_lstsq_blas)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_tensordot_xtensor)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_tensordot_blas)->Apply(compare_sizes);
+
+#if defined(XTENSOR_BENCHMARK_EIGEN)
+
+        /*********
+         * Eigen *
+         *********/
+
+        inline Eigen::MatrixXd general_eigen(std::size_t rows, std::size_t cols)
+        {
+            auto v = general_buffer(rows, cols);
+            return Eigen::Map<Eigen::MatrixXd>(v.data(), Eigen::Index(rows), Eigen::Index(cols));
+        }
+
+        inline Eigen::MatrixXd symmetric_eigen(std::size_t n)
+        {
+            auto v = symmetric_buffer(n);
+            return Eigen::Map<Eigen::MatrixXd>(v.data(), Eigen::Index(n), Eigen::Index(n));
+        }
+
+        inline Eigen::VectorXd vector_eigen(std::size_t n)
+        {
+            auto v = vector_buffer(n);
+            return Eigen::Map<Eigen::VectorXd>(v.data(), Eigen::Index(n));
+        }
+
+        inline void benchmark_compare_dot_eigen(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            Eigen::MatrixXd a = general_eigen(n, n);
+            Eigen::MatrixXd b = symmetric_eigen(n);
+            while (state.KeepRunning())
+            {
+                Eigen::MatrixXd c = a * b;
+                benchmark::DoNotOptimize(c.data());
+            }
+        }
+
+        inline void benchmark_compare_solve_eigen(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            Eigen::MatrixXd a = general_eigen(n, n);
+            Eigen::VectorXd b = vector_eigen(n);
+            while (state.KeepRunning())
+            {
+                Eigen::VectorXd x = a.partialPivLu().solve(b);
+                benchmark::DoNotOptimize(x.data());
+            }
+        }
+
+        inline void benchmark_compare_svd_eigen(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            Eigen::MatrixXd a = general_eigen(n, n);
+            while (state.KeepRunning())
+            {
+                Eigen::BDCSVD<Eigen::MatrixXd> svd(a, Eigen::ComputeFullU | Eigen::ComputeFullV);
+                benchmark::DoNotOptimize(svd.singularValues().data());
+            }
+        }
+
+        inline void benchmark_compare_eigh_eigen(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            Eigen::MatrixXd a = symmetric_eigen(n);
+            while (state.KeepRunning())
+            {
+                Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigh(a);
+                benchmark::DoNotOptimize(eigh.eigenvalues().data());
+            }
+        }
+
+        // minimum norm solution through the SVD, as gelsd
+        inline void benchmark_compare_lstsq_eigen(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            Eigen::MatrixXd a = general_eigen(2 * n, n);
+            Eigen::VectorXd b = vector_eigen(2 * n);
+            while (state.KeepRunning())
+            {
+                Eigen::BDCSVD<Eigen::MatrixXd> svd(a, Eigen::ComputeThinU | Eigen::ComputeThinV);
+                Eigen::VectorXd x = svd.solve(b);
+                benchmark::DoNotOptimize(x.data());
+            }
+        }
+
+        // Eigen::Tensor is unsupported; the contraction is the product of the reshaped operands
+        inline void benchmark_compare_tensordot_eigen(benchmark::State& state)
+        {
+            std::size_t n = size_argument(state);
+            Eigen::MatrixXd a = general_eigen(n, 64);
+            Eigen::MatrixXd b = general_eigen(64, n);
+            while (state.KeepRunning())
+            {
+                Eigen::MatrixXd c = a * b;
+                benchmark::DoNotOptimize(c.data());
+            }
+        }
+
+        BENCHMARK(benchmark_compare_dot_eigen)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_solve_eigen)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_svd_eigen)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_eigh_eigen)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_lstsq_eigen)->Apply(compare_sizes);
+        BENCHMARK(benchmark_compare_tensordot_eigen)->Apply(compare_sizes);
+
+#endif
+    }
+}
+
+#endif
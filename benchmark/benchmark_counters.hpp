@@ -0,0 +1,244 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef BENCHMARK_COUNTERS_HPP
+#define BENCHMARK_COUNTERS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "xtl/xcomplex.hpp"
+
+#if defined(XTENSOR_BENCHMARK_PERF_EVENTS)
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace xt
+{
+    namespace benchmark_counters
+    {
+
+        /*******************
+         * Roofline counts *
+         *******************/
+
+        // a complex multiply-add is 8 real flops
+        template <class T>
+        inline double flops_per_fma()
+        {
+            return xtl::is_complex<T>::value ? 8. : 2.;
+        }
+
+        /**
+         * Reports the work of one iteration for a roofline plot: the flops
+         * and bytes per iteration, their rates and the arithmetic intensity.
+         * \em elements_per_iteration counts the operands read and the results
+         * written once each, so the bytes are the compulsory traffic, a lower
+         * bound of what the kernel moves through memory.
+         */
+        template <class T>
+        inline void set_roofline(benchmark::State& state, double fmas_per_iteration, double elements_per_iteration)
+        {
+            double flops = flops_per_fma<T>() * fmas_per_iteration;
+            double bytes = double(sizeof(T)) * elements_per_iteration;
+            double iterations = double(state.iterations());
+            state.counters["FLOP"] = flops;
+            state.counters["bytes"] = bytes;
+            state.counters["FLOP/byte"] = bytes == 0. ? 0. : flops / bytes;
+            state.counters["GFLOP/s"] = benchmark::Counter(flops * iterations * 1e-9, benchmark::Counter::kIsRate);
+            state.counters["GB/s"] = benchmark::Counter(bytes * iterations * 1e-9, benchmark::Counter::kIsRate);
+        }
+
+        /*************************
+         * Latency distributions *
+         *************************/
+
+        /**
+         * Records the duration of every iteration between start and stop,
+         * and reports its 50th, 90th and 99th percentiles and maximum, in
+         * nanoseconds. The samples are reserved up front so that recording
+         * does not allocate while the benchmark runs, and what comes between
+         * stop and the next start, as restoring the input of an in-place
+         * kernel, is not part of them.
+         */
+        class latency_recorder
+        {
+        public:
+
+            using clock_type = std::chrono::steady_clock;
+
+            explicit latency_recorder(const benchmark::State& state)
+            {
+                m_samples.reserve(static_cast<std::size_t>(std::min(double(state.max_iterations), double(1 << 24))));
+            }
+
+            void start()
+            {
+                m_start = clock_type::now();
+            }
+
+            void stop()
+            {
+                auto elapsed = clock_type::now() - m_start;
+                m_samples.push_back(double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            }
+
+            void report(benchmark::State& state)
+            {
+                if (m_samples.empty())
+                {
+                    return;
+                }
+                std::sort(m_samples.begin(), m_samples.end());
+                state.counters["p50"] = percentile(0.5);
+                state.counters["p90"] = percentile(0.9);
+                state.counters["p99"] = percentile(0.99);
+                state.counters["max"] = m_samples.back();
+            }
+
+        private:
+
+            // nearest rank
+            double percentile(double q) const
+            {
+                std::size_t rank = static_cast<std::size_t>(q * double(m_samples.size() - 1) + 0.5);
+                return m_samples[std::min(rank, m_samples.size() - 1)];
+            }
+
+            std::vector<double> m_samples;
+            clock_type::time_point m_start;
+        };
+
+        /*************************
+         * Hardware event counts *
+         *************************/
+
+#if defined(XTENSOR_BENCHMARK_PERF_EVENTS)
+
+        /**
+         * Counts the cycles, reference cycles, instructions and last level
+         * cache misses of the calling thread, in user space, between its
+         * construction and the call to report, which sets them per iteration
+         * with the instructions per cycle and the ratio of the core to the
+         * reference clock, below 1 when wide vector units lower the frequency.
+         * Threads started before, as those of a BLAS thread pool, are not
+         * counted. Nothing is reported if perf_event_open is not permitted.
+         */
+        class perf_scope
+        {
+        public:
+
+            perf_scope()
+            {
+                const std::uint64_t configs[event_count] = {
+                    PERF_COUNT_HW_CPU_CYCLES,
+                    PERF_COUNT_HW_REF_CPU_CYCLES,
+                    PERF_COUNT_HW_INSTRUCTIONS,
+                    PERF_COUNT_HW_CACHE_MISSES
+                };
+                for (std::size_t i = 0; i < event_count; ++i)
+                {
+                    m_fd[i] = i == 0 || m_fd[0] != -1 ? open_event(configs[i], i == 0 ? -1 : m_fd[0]) : -1;
+                }
+                if (m_fd[0] != -1)
+                {
+                    ioctl(m_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                    ioctl(m_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+                }
+            }
+
+            ~perf_scope()
+            {
+                for (int fd : m_fd)
+                {
+                    if (fd != -1)
+                    {
+                        close(fd);
+                    }
+                }
+            }
+
+            perf_scope(const perf_scope&) = delete;
+            perf_scope& operator=(const perf_scope&) = delete;
+
+            void report(benchmark::State& state) const
+            {
+                if (m_fd[0] == -1)
+                {
+                    return;
+                }
+                ioctl(m_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+                double iterations = std::max(double(state.iterations()), 1.);
+                const char* names[event_count] = {"cycles", "ref-cycles", "instructions", "LLC-misses"};
+                double values[event_count] = {};
+                for (std::size_t i = 0; i < event_count; ++i)
+                {
+                    std::uint64_t value = 0;
+                    if (m_fd[i] != -1 && read(m_fd[i], &value, sizeof(value)) == sizeof(value))
+                    {
+                        values[i] = double(value);
+                        state.counters[names[i]] = values[i] / iterations;
+                    }
+                }
+                if (values[0] != 0.)
+                {
+                    state.counters["IPC"] = values[2] / values[0];
+                }
+                if (values[1] != 0.)
+                {
+                    state.counters["clock ratio"] = values[0] / values[1];
+                }
+            }
+
+        private:
+
+            static constexpr std::size_t event_count = 4;
+
+            static int open_event(std::uint64_t config, int group)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = config;
+                attr.disabled = group == -1 ? 1 : 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+            }
+
+            int m_fd[event_count];
+        };
+
+#else
+
+        class perf_scope
+        {
+        public:
+
+            void report(benchmark::State&) const
+            {
+            }
+        };
+
+#endif
+    }
+}
+
+#endif
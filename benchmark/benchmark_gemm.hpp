@@ -0,0 +1,446 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef BENCHMARK_GEMM_HPP
+#define BENCHMARK_GEMM_HPP
+
+#include <complex>
+
+#include <benchmark/benchmark.h>
+
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+
+#include "benchmark_counters.hpp"
+
+namespace xt
+{
+    namespace benchmark_gemm
+    {
+
+        /****************************
+         * Benchmark initialization *
+         ****************************/
+
+        template <class T>
+        inline T init_value(std::size_t i, std::true_type /*is_complex*/)
+        {
+            using real_type = typename T::value_type;
+            return T(real_type(0.5) + real_type(i % 13) / real_type(7),
+                     real_type(0.25) - real_type(i % 11) / real_type(5));
+        }
+
+        template <class T>
+        inline T init_value(std::size_t i, std::false_type /*is_complex*/)
+        {
+            return T(0.5) + T(i % 13) / T(7);
+        }
+
+        // containers with layout_type::dynamic need the layout to be given
+        template <class E>
+        inline E make_operand(const typename E::shape_type& shape, layout_type l = E::static_layout)
+        {
+            using value_type = typename E::value_type;
+            E e(shape, l);
+            std::size_t i = 0;
+            for (auto& v : e)
+            {
+                v = init_value<value_type>(i++, xtl::is_complex<value_type>());
+            }
+            return e;
+        }
+
+        template <class E>
+        inline E make_matrix(std::size_t rows, std::size_t cols, layout_type l = E::static_layout)
+        {
+            return make_operand<E>({rows, cols}, l);
+        }
+
+        using benchmark_counters::perf_scope;
+        using benchmark_counters::set_roofline;
+
+        template <class T>
+        using row_major_matrix = xtensor<T, 2, layout_type::row_major>;
+
+        template <class T>
+        using column_major_matrix = xtensor<T, 2, layout_type::column_major>;
+
+        template <class T>
+        using dynamic_matrix = xarray<T, layout_type::dynamic>;
+
+        /*************************
+         * GEMM shapes and types *
+         *************************/
+
+        // state.range(0..2) are M, N and K of the (M x K) * (K x N) product
+        template <class EA, class EB>
+        inline void benchmark_dot_mm(benchmark::State& state)
+        {
+            std::size_t m = static_cast<std::size_t>(state.range(0));
+            std::size_t n = static_cast<std::size_t>(state.range(1));
+            std::size_t k = static_cast<std::size_t>(state.range(2));
+            EA a = make_matrix<EA>(m, k);
+            EB b = make_matrix<EB>(k, n);
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(a, b);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<typename EA::value_type>(state, double(m) * double(n) * double(k),
+                                                  double(m) * double(k) + double(k) * double(n) + double(m) * double(n));
+        }
+
+        // square, tall-skinny, short-fat and inner-product-like products
+        inline void gemm_shapes(benchmark::internal::Benchmark* b)
+        {
+            for (int n : {64, 256, 1024})
+            {
+                b->Args({n, n, n});
+            }
+            b->Args({4096, 16, 256});
+            b->Args({16, 4096, 256});
+            b->Args({4096, 4096, 16});
+            b->Args({64, 64, 16384});
+        }
+
+        inline void gemm_layout_shapes(benchmark::internal::Benchmark* b)
+        {
+            b->Args({256, 256, 256});
+            b->Args({4096, 16, 256});
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_dot_mm, row_major_matrix<float>, row_major_matrix<float>)->Apply(gemm_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_mm, row_major_matrix<double>, row_major_matrix<double>)->Apply(gemm_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_mm, row_major_matrix<std::complex<double>>, row_major_matrix<std::complex<double>>)->Apply(gemm_shapes);
+
+        BENCHMARK_TEMPLATE(benchmark_dot_mm, row_major_matrix<double>, column_major_matrix<double>)->Apply(gemm_layout_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_mm, column_major_matrix<double>, row_major_matrix<double>)->Apply(gemm_layout_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_mm, column_major_matrix<double>, column_major_matrix<double>)->Apply(gemm_layout_shapes);
+
+        // operands whose layout is only known at runtime, A row major and B column major
+        template <class T>
+        inline void benchmark_dot_mm_dynamic_layout(benchmark::State& state)
+        {
+            std::size_t m = static_cast<std::size_t>(state.range(0));
+            std::size_t n = static_cast<std::size_t>(state.range(1));
+            std::size_t k = static_cast<std::size_t>(state.range(2));
+            dynamic_matrix<T> a = make_matrix<dynamic_matrix<T>>(m, k, layout_type::row_major);
+            dynamic_matrix<T> b = make_matrix<dynamic_matrix<T>>(k, n, layout_type::column_major);
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(a, b);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<T>(state, double(m) * double(n) * double(k),
+                            double(m) * double(k) + double(k) * double(n) + double(m) * double(n));
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_dot_mm_dynamic_layout, double)->Apply(gemm_layout_shapes);
+
+        /*****************************
+         * Views and transposed GEMM *
+         *****************************/
+
+        // dot(transpose(A), B), the transposition is folded into the BLAS op
+        template <class E>
+        inline void benchmark_dot_transposed(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_matrix<E>(n, n);
+            E b = make_matrix<E>(n, n);
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(xt::transpose(a), b);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<typename E::value_type>(state, double(n) * double(n) * double(n),
+                                                 3. * double(n) * double(n));
+        }
+
+        // dot of strided views into larger matrices, passed with their leading stride
+        template <class E>
+        inline void benchmark_dot_strided_view(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_matrix<E>(2 * n, 2 * n);
+            E b = make_matrix<E>(2 * n, 2 * n);
+            auto va = xt::view(a, xt::range(0, n), xt::range(n, 2 * n));
+            auto vb = xt::view(b, xt::range(n, 2 * n), xt::range(0, n));
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(va, vb);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<typename E::value_type>(state, double(n) * double(n) * double(n),
+                                                 3. * double(n) * double(n));
+        }
+
+        // views with a non-unit inner stride have to be copied before the call
+        template <class E>
+        inline void benchmark_dot_step_view(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_matrix<E>(n, 2 * n);
+            E b = make_matrix<E>(n, 2 * n);
+            auto va = xt::view(a, xt::all(), xt::range(0, 2 * n, 2));
+            auto vb = xt::view(b, xt::all(), xt::range(1, 2 * n, 2));
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(va, vb);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<typename E::value_type>(state, double(n) * double(n) * double(n),
+                                                 3. * double(n) * double(n));
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_dot_transposed, row_major_matrix<double>)->Range(64, 1024);
+        BENCHMARK_TEMPLATE(benchmark_dot_strided_view, row_major_matrix<double>)->Range(64, 1024);
+        BENCHMARK_TEMPLATE(benchmark_dot_step_view, row_major_matrix<double>)->Range(64, 1024);
+
+        /*****************
+         * GEMV and SYRK *
+         *****************/
+
+        // dot(A, x) and dot(x, A), state.range(0..1) are the rows and columns of A
+        template <class E>
+        inline void benchmark_dot_mv(benchmark::State& state)
+        {
+            using value_type = typename E::value_type;
+            std::size_t m = static_cast<std::size_t>(state.range(0));
+            std::size_t n = static_cast<std::size_t>(state.range(1));
+            E a = make_matrix<E>(m, n);
+            xtensor<value_type, 1> x = make_operand<xtensor<value_type, 1>>({n});
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(a, x);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<value_type>(state, double(m) * double(n),
+                                     double(m) * double(n) + double(m) + double(n));
+        }
+
+        template <class E>
+        inline void benchmark_dot_vm(benchmark::State& state)
+        {
+            using value_type = typename E::value_type;
+            std::size_t m = static_cast<std::size_t>(state.range(0));
+            std::size_t n = static_cast<std::size_t>(state.range(1));
+            E a = make_matrix<E>(m, n);
+            xtensor<value_type, 1> x = make_operand<xtensor<value_type, 1>>({m});
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(x, a);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<value_type>(state, double(m) * double(n),
+                                     double(m) * double(n) + double(m) + double(n));
+        }
+
+        inline void gemv_shapes(benchmark::internal::Benchmark* b)
+        {
+            b->Args({1024, 1024});
+            b->Args({16384, 64});
+            b->Args({64, 16384});
+        }
+
+        // dot(A, transpose(A)) takes the SYRK fast path; GFLOP/s are counted as
+        // for the full GEMM, so that it compares directly with benchmark_dot_mm
+        template <class E>
+        inline void benchmark_dot_syrk(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            std::size_t k = static_cast<std::size_t>(state.range(1));
+            E a = make_matrix<E>(n, k);
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(a, xt::transpose(a));
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<typename E::value_type>(state, double(n) * double(n) * double(k),
+                                                 double(n) * double(k) + double(n) * double(n));
+        }
+
+        inline void syrk_shapes(benchmark::internal::Benchmark* b)
+        {
+            b->Args({256, 256});
+            b->Args({1024, 1024});
+            b->Args({1024, 64});
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_dot_mv, row_major_matrix<double>)->Apply(gemv_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_mv, column_major_matrix<double>)->Apply(gemv_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_mv, row_major_matrix<std::complex<double>>)->Apply(gemv_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_vm, row_major_matrix<double>)->Apply(gemv_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_syrk, row_major_matrix<double>)->Apply(syrk_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_syrk, column_major_matrix<double>)->Apply(syrk_shapes);
+
+        /**********************************
+         * Batched, N-D dot and tensordot *
+         **********************************/
+
+        // matmul of stacks, state.range(0) is the batch size, state.range(1) the matrix size
+        template <class T>
+        inline void benchmark_matmul_batched(benchmark::State& state)
+        {
+            using stack_type = xtensor<T, 3>;
+            std::size_t batch = static_cast<std::size_t>(state.range(0));
+            std::size_t n = static_cast<std::size_t>(state.range(1));
+            stack_type a = make_operand<stack_type>({batch, n, n});
+            stack_type b = make_operand<stack_type>({batch, n, n});
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::matmul(a, b);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<T>(state, double(batch) * double(n) * double(n) * double(n),
+                            3. * double(batch) * double(n) * double(n));
+        }
+
+        inline void batched_shapes(benchmark::internal::Benchmark* b)
+        {
+            b->Args({1024, 4});
+            b->Args({256, 16});
+            b->Args({16, 128});
+        }
+
+        // dot of a 3-D and a 2-D array (sum over the last axis of a and the
+        // second to last of b)
+        template <class T>
+        inline void benchmark_dot_nd(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            xarray<T> a = make_operand<xarray<T>>({8, n, n});
+            xarray<T> b = make_operand<xarray<T>>({n, n});
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::dot(a, b);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<T>(state, 8. * double(n) * double(n) * double(n),
+                            17. * double(n) * double(n));
+        }
+
+        // tensordot over two axes, reshaped into a single GEMM
+        template <class T>
+        inline void benchmark_tensordot(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            xarray<T> a = make_operand<xarray<T>>({n, 16, 16});
+            xarray<T> b = make_operand<xarray<T>>({16, 16, n});
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::tensordot(a, b, 2);
+                benchmark::DoNotOptimize(res.data());
+            }
+            perf.report(state);
+            set_roofline<T>(state, double(n) * double(n) * 256.,
+                            512. * double(n) + double(n) * double(n));
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_matmul_batched, double)->Apply(batched_shapes);
+        BENCHMARK_TEMPLATE(benchmark_matmul_batched, float)->Apply(batched_shapes);
+        BENCHMARK_TEMPLATE(benchmark_dot_nd, double)->Range(32, 256);
+        BENCHMARK_TEMPLATE(benchmark_tensordot, double)->Range(64, 1024);
+
+        /*****************************************
+         * Vendor BLAS versus the FLENS fallback *
+         *****************************************/
+
+        // the same column major GEMM through xt::blas::gemm (vendor BLAS unless
+        // built with XTENSOR_USE_FLENS_BLAS) and through the generic cxxblas kernel
+        template <class T>
+        inline void benchmark_blas_gemm(benchmark::State& state)
+        {
+            using matrix_type = column_major_matrix<T>;
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            matrix_type a = make_matrix<matrix_type>(n, n);
+            matrix_type b = make_matrix<matrix_type>(n, n);
+            matrix_type c = make_matrix<matrix_type>(n, n);
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                xt::blas::gemm(a, b, c);
+                benchmark::DoNotOptimize(c.data());
+            }
+            perf.report(state);
+            set_roofline<T>(state, double(n) * double(n) * double(n),
+                            3. * double(n) * double(n));
+        }
+
+        template <class T>
+        inline void benchmark_flens_gemm(benchmark::State& state)
+        {
+            using matrix_type = column_major_matrix<T>;
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            matrix_type a = make_matrix<matrix_type>(n, n);
+            matrix_type b = make_matrix<matrix_type>(n, n);
+            matrix_type c = make_matrix<matrix_type>(n, n);
+            blas_index_t ld = to_blas_index(n);
+
+            perf_scope perf;
+            while (state.KeepRunning())
+            {
+                cxxblas::gemm_generic(cxxblas::StorageOrder::ColMajor,
+                                      cxxblas::Transpose::NoTrans, cxxblas::Transpose::NoTrans,
+                                      ld, ld, ld,
+                                      T(1), a.data(), ld, b.data(), ld,
+                                      T(0), c.data(), ld);
+                benchmark::DoNotOptimize(c.data());
+            }
+            perf.report(state);
+            set_roofline<T>(state, double(n) * double(n) * double(n),
+                            3. * double(n) * double(n));
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_blas_gemm, double)->Range(32, 1024);
+        BENCHMARK_TEMPLATE(benchmark_flens_gemm, double)->Range(32, 1024);
+        BENCHMARK_TEMPLATE(benchmark_blas_gemm, float)->Range(32, 1024);
+        BENCHMARK_TEMPLATE(benchmark_flens_gemm, float)->Range(32, 1024);
+        BENCHMARK_TEMPLATE(benchmark_blas_gemm, std::complex<double>)->Range(32, 512);
+        BENCHMARK_TEMPLATE(benchmark_flens_gemm, std::complex<double>)->Range(32, 512);
+    }
+}
+
+#endif
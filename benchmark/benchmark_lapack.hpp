@@ -0,0 +1,517 @@
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          /****************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay           ***************************************************************************/
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef BENCHMARK_LAPACK_HPP
+#define BENCHMARK_LAPACK_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <complex>
+
+#include <benchmark/benchmark.h>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+    namespace benchmark_lapack
+    {
+
+        /*********************
+         * Allocation counts *
+         *********************/
+
+        // updated by the global operator new defined in main.cpp
+        inline std::atomic<std::size_t>& allocated_bytes()
+        {
+            static std::atomic<std::size_t> bytes(0);
+            return bytes;
+        }
+
+        inline std::atomic<std::size_t>& allocation_count()
+        {
+            static std::atomic<std::size_t> count(0);
+            return count;
+        }
+
+        inline void record_allocation(std::size_t size)
+        {
+            allocated_bytes().fetch_add(size, std::memory_order_relaxed);
+            allocation_count().fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Reports the bytes and the number of blocks allocated per iteration
+         * between its construction and the call to report.
+         */
+        class allocation_scope
+        {
+        public:
+
+            allocation_scope()
+                : m_bytes(allocated_bytes().load()), m_count(allocation_count().load())
+            {
+            }
+
+            void report(benchmark::State& state) const
+            {
+                double iterations = std::max(double(state.iterations()), 1.);
+                state.counters["bytes/call"] = double(allocated_bytes().load() - m_bytes) / iterations;
+                state.counters["allocs/call"] = double(allocation_count().load() - m_count) / iterations;
+            }
+
+        private:
+
+            std::size_t m_bytes;
+            std::size_t m_count;
+        };
+
+        /****************************
+         * Benchmark initialization *
+         ****************************/
+
+        template <class T>
+        using row_major_matrix = xtensor<T, 2, layout_type::row_major>;
+
+        template <class T>
+        using column_major_matrix = xtensor<T, 2, layout_type::column_major>;
+
+        template <class T>
+        using real_vector = xtensor<xtl::complex_value_type_t<T>, 1, layout_type::column_major>;
+
+        // symmetric (hermitian) and diagonally dominant, hence positive definite
+        template <class E>
+        inline E make_spd(std::size_t n)
+        {
+            using value_type = typename E::value_type;
+            E a = E::from_shape({n, n});
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    std::size_t d = i > j ? i - j : j - i;
+                    a(i, j) = value_type(1) / value_type(1 + d) + (i == j ? value_type(n) : value_type(0));
+                }
+            }
+            return a;
+        }
+
+        // non symmetric and diagonally dominant, hence non singular
+        template <class E>
+        inline E make_general(std::size_t rows, std::size_t cols)
+        {
+            using value_type = typename E::value_type;
+            E a = E::from_shape({rows, cols});
+            for (std::size_t i = 0; i < rows; ++i)
+            {
+                for (std::size_t j = 0; j < cols; ++j)
+                {
+                    a(i, j) = value_type(0.5) + value_type((3 * i + 7 * j) % 13) / value_type(7)
+                        + (i == j ? value_type(3 * cols) : value_type(0));
+                }
+            }
+            return a;
+        }
+
+        // restores the input of an in-place kernel without allocating
+        template <class E>
+        inline void reset(E& dst, const E& src)
+        {
+            std::copy(src.storage().cbegin(), src.storage().cend(), dst.storage().begin());
+        }
+
+        inline void lapack_sizes(benchmark::internal::Benchmark* b)
+        {
+            for (int n : {32, 128, 512})
+            {
+                b->Arg(n);
+            }
+        }
+
+        /**************************************
+         * Complete xt::linalg decompositions *
+         **************************************/
+
+        // the input layout is the one of E: row major inputs include
+        // the copy_to_layout done by the function
+        template <class E>
+        inline void benchmark_svd(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_general<E>(n, n);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::svd(a);
+                benchmark::DoNotOptimize(std::get<1>(res).data());
+            }
+            allocs.report(state);
+        }
+
+        template <class E>
+        inline void benchmark_eigh(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_spd<E>(n);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::eigh(a);
+                benchmark::DoNotOptimize(std::get<0>(res).data());
+            }
+            allocs.report(state);
+        }
+
+        template <class E>
+        inline void benchmark_eig(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_general<E>(n, n);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::eig(a);
+                benchmark::DoNotOptimize(std::get<0>(res).data());
+            }
+            allocs.report(state);
+        }
+
+        template <class E>
+        inline void benchmark_qr(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_general<E>(n, n);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::qr(a);
+                benchmark::DoNotOptimize(std::get<1>(res).data());
+            }
+            allocs.report(state);
+        }
+
+        template <class E>
+        inline void benchmark_cholesky(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_spd<E>(n);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::cholesky(a);
+                benchmark::DoNotOptimize(res.data());
+            }
+            allocs.report(state);
+        }
+
+        // (2n x n) system with 4 right-hand sides
+        template <class E>
+        inline void benchmark_lstsq(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_general<E>(2 * n, n);
+            E b = make_general<E>(2 * n, 4);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::lstsq(a, b);
+                benchmark::DoNotOptimize(std::get<0>(res).data());
+            }
+            allocs.report(state);
+        }
+
+        template <class E>
+        inline void benchmark_inv(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_general<E>(n, n);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::inv(a);
+                benchmark::DoNotOptimize(res.data());
+            }
+            allocs.report(state);
+        }
+
+        template <class E>
+        inline void benchmark_det(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            E a = make_general<E>(n, n);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto res = xt::linalg::det(a);
+                benchmark::DoNotOptimize(res);
+            }
+            allocs.report(state);
+        }
+
+#define XTENSOR_LAPACK_BENCHMARK(func)                                                   \
+        BENCHMARK_TEMPLATE(func, row_major_matrix<double>)->Apply(lapack_sizes);          \
+        BENCHMARK_TEMPLATE(func, column_major_matrix<double>)->Apply(lapack_sizes);       \
+        BENCHMARK_TEMPLATE(func, column_major_matrix<float>)->Apply(lapack_sizes);        \
+        BENCHMARK_TEMPLATE(func, column_major_matrix<std::complex<double>>)->Apply(lapack_sizes)
+
+        XTENSOR_LAPACK_BENCHMARK(benchmark_svd);
+        XTENSOR_LAPACK_BENCHMARK(benchmark_eigh);
+        XTENSOR_LAPACK_BENCHMARK(benchmark_eig);
+        XTENSOR_LAPACK_BENCHMARK(benchmark_qr);
+        XTENSOR_LAPACK_BENCHMARK(benchmark_cholesky);
+        XTENSOR_LAPACK_BENCHMARK(benchmark_lstsq);
+        XTENSOR_LAPACK_BENCHMARK(benchmark_inv);
+        XTENSOR_LAPACK_BENCHMARK(benchmark_det);
+
+#undef XTENSOR_LAPACK_BENCHMARK
+
+        /******************************************
+         * Cost breakdown: copy, query and kernel *
+         ******************************************/
+
+        // the copy_to_layout of a row major input done by the functions above
+        template <class T>
+        inline void benchmark_copy_to_layout(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<row_major_matrix<T>>(n, n);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto m = copy_to_layout<layout_type::column_major>(a);
+                benchmark::DoNotOptimize(m.data());
+            }
+            allocs.report(state);
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_copy_to_layout, double)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_copy_to_layout, std::complex<double>)->Apply(lapack_sizes);
+
+        // sizes and job flags of the workspace query done by each function
+        template <lapack::routine R>
+        struct query_args;
+
+        template <>
+        struct query_args<lapack::routine::gesdd>
+        {
+            static lapack::workspace_dims dims(blas_index_t n) { return {n, n, 0}; }
+            static lapack::workspace_jobs jobs() { return {'A', 0, 0}; }
+        };
+
+        template <>
+        struct query_args<lapack::routine::syevd>
+        {
+            static lapack::workspace_dims dims(blas_index_t n) { return {n, 0, 0}; }
+            static lapack::workspace_jobs jobs() { return {'V', 'L', 0}; }
+        };
+
+        template <>
+        struct query_args<lapack::routine::heevd> : query_args<lapack::routine::syevd>
+        {
+        };
+
+        template <>
+        struct query_args<lapack::routine::geev>
+        {
+            static lapack::workspace_dims dims(blas_index_t n) { return {n, 0, 0}; }
+            static lapack::workspace_jobs jobs() { return {'N', 'V', 0}; }
+        };
+
+        template <>
+        struct query_args<lapack::routine::geqrf>
+        {
+            static lapack::workspace_dims dims(blas_index_t n) { return {n, n, 0}; }
+            static lapack::workspace_jobs jobs() { return {}; }
+        };
+
+        template <>
+        struct query_args<lapack::routine::gelsd>
+        {
+            static lapack::workspace_dims dims(blas_index_t n) { return {2 * n, n, 4}; }
+            static lapack::workspace_jobs jobs() { return {}; }
+        };
+
+        template <>
+        struct query_args<lapack::routine::getri>
+        {
+            static lapack::workspace_dims dims(blas_index_t n) { return {n, 0, 0}; }
+            static lapack::workspace_jobs jobs() { return {}; }
+        };
+
+        // a cold query with a fresh workspace; the wrappers remember the
+        // result, so only the first call with a given shape pays for it
+        template <class T, lapack::routine R>
+        inline void benchmark_workspace_query(benchmark::State& state)
+        {
+            blas_index_t n = to_blas_index(state.range(0));
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                auto sizes = lapack::workspace_size<R, T>(query_args<R>::dims(n), query_args<R>::jobs());
+                benchmark::DoNotOptimize(sizes.work);
+            }
+            allocs.report(state);
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_workspace_query, double, lapack::routine::gesdd)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_workspace_query, double, lapack::routine::syevd)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_workspace_query, double, lapack::routine::geev)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_workspace_query, double, lapack::routine::geqrf)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_workspace_query, double, lapack::routine::gelsd)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_workspace_query, double, lapack::routine::getri)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_workspace_query, std::complex<double>, lapack::routine::gesdd)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_workspace_query, std::complex<double>, lapack::routine::heevd)->Apply(lapack_sizes);
+
+        // The kernels run on column major operands with a workspace prepared
+        // up front, so neither a copy nor a workspace query is timed. The
+        // input is restored outside of the timed region.
+
+        template <class T>
+        inline void benchmark_gesdd_kernel(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<column_major_matrix<T>>(n, n);
+            auto m = a;
+            lapack::workspace<T> ws;
+            ws.template prepare<lapack::routine::gesdd>({to_blas_index(n), to_blas_index(n), 0}, {'A', 0, 0});
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                state.PauseTiming();
+                reset(m, a);
+                state.ResumeTiming();
+                auto res = lapack::gesdd(m, 'A', ws);
+                benchmark::DoNotOptimize(std::get<2>(res).data());
+            }
+            allocs.report(state);
+        }
+
+        namespace detail
+        {
+            template <class WS>
+            inline void prepare_eigh(WS& ws, blas_index_t n, std::false_type /*is_complex*/)
+            {
+                ws.template prepare<lapack::routine::syevd>({n, 0, 0}, {'V', 'L', 0});
+            }
+
+            template <class WS>
+            inline void prepare_eigh(WS& ws, blas_index_t n, std::true_type /*is_complex*/)
+            {
+                ws.template prepare<lapack::routine::heevd>({n, 0, 0}, {'V', 'L', 0});
+            }
+
+            template <class E, class W, class WS>
+            inline int eigh_kernel(E& m, W& w, WS& ws, std::false_type /*is_complex*/)
+            {
+                return lapack::syevd(m, 'V', 'L', w, ws);
+            }
+
+            template <class E, class W, class WS>
+            inline int eigh_kernel(E& m, W& w, WS& ws, std::true_type /*is_complex*/)
+            {
+                return lapack::heevd(m, 'V', 'L', w, ws);
+            }
+        }
+
+        template <class T>
+        inline void benchmark_eigh_kernel(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_spd<column_major_matrix<T>>(n);
+            auto m = a;
+            auto w = real_vector<T>::from_shape({n});
+            lapack::workspace<T> ws;
+            detail::prepare_eigh(ws, to_blas_index(n), xtl::is_complex<T>());
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                state.PauseTiming();
+                reset(m, a);
+                state.ResumeTiming();
+                int info = detail::eigh_kernel(m, w, ws, xtl::is_complex<T>());
+                benchmark::DoNotOptimize(info);
+            }
+            allocs.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_geqrf_kernel(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<column_major_matrix<T>>(n, n);
+            auto m = a;
+            auto tau = xtensor<T, 1, layout_type::column_major>::from_shape({n});
+            lapack::workspace<T> ws;
+            ws.template prepare<lapack::routine::geqrf>({to_blas_index(n), to_blas_index(n), 0});
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                state.PauseTiming();
+                reset(m, a);
+                state.ResumeTiming();
+                int info = lapack::geqrf(m, tau, ws);
+                benchmark::DoNotOptimize(info);
+            }
+            allocs.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_potrf_kernel(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_spd<column_major_matrix<T>>(n);
+            auto m = a;
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                state.PauseTiming();
+                reset(m, a);
+                state.ResumeTiming();
+                int info = lapack::potr(m, 'L');
+                benchmark::DoNotOptimize(info);
+            }
+            allocs.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_getrf_kernel(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<column_major_matrix<T>>(n, n);
+            auto m = a;
+            uvector<blas_index_t> piv(n);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                state.PauseTiming();
+                reset(m, a);
+                state.ResumeTiming();
+                int info = lapack::getrf(m, piv);
+                benchmark::DoNotOptimize(info);
+            }
+            allocs.report(state);
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_gesdd_kernel, double)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_gesdd_kernel, std::complex<double>)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_eigh_kernel, double)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_eigh_kernel, std::complex<double>)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_geqrf_kernel, double)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_geqrf_kernel, std::complex<double>)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_potrf_kernel, double)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_potrf_kernel, std::complex<double>)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_getrf_kernel, double)->Apply(lapack_sizes);
+        BENCHMARK_TEMPLATE(benchmark_getrf_kernel, std::complex<double>)->Apply(lapack_sizes);
+    }
+}
+
+#endif
@@ -0,0 +1,273 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef BENCHMARK_LATENCY_HPP
+#define BENCHMARK_LATENCY_HPP
+
+#include <benchmark/benchmark.h>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+#include "benchmark_counters.hpp"
+#include "benchmark_lapack.hpp"
+
+namespace xt
+{
+    namespace benchmark_latency
+    {
+        using benchmark_counters::latency_recorder;
+        using benchmark_lapack::allocation_scope;
+        using benchmark_lapack::make_general;
+        using benchmark_lapack::make_spd;
+        using benchmark_lapack::reset;
+
+        template <class T>
+        using matrix_type = xtensor<T, 2, layout_type::column_major>;
+
+        template <class T>
+        using vector_type = xtensor<T, 1, layout_type::column_major>;
+
+        inline void latency_sizes(benchmark::internal::Benchmark* b)
+        {
+            for (int n : {8, 16, 32, 64})
+            {
+                b->Arg(n);
+            }
+        }
+
+        /*********************************
+         * Latency of small matrix calls *
+         *********************************/
+
+        // Each pair times the allocating xt::linalg function and its
+        // allocation-free counterpart on column major operands, the
+        // latter with its buffers, pivots and workspace prepared up front.
+        // p50, p90, p99 and max are the per call latencies in ns; the
+        // inputs of the in-place kernels are restored outside of them.
+
+        template <class T>
+        inline void benchmark_latency_dot(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<matrix_type<T>>(n, n);
+            auto b = make_spd<matrix_type<T>>(n);
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                latency.start();
+                auto c = xt::linalg::dot(a, b);
+                benchmark::DoNotOptimize(c.data());
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_latency_dot_into(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<matrix_type<T>>(n, n);
+            auto b = make_spd<matrix_type<T>>(n);
+            auto c = matrix_type<T>::from_shape({n, n});
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                latency.start();
+                xt::linalg::dot_into(a, b, c);
+                benchmark::DoNotOptimize(c.data());
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_latency_solve(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<matrix_type<T>>(n, n);
+            auto b = make_general<matrix_type<T>>(n, 1);
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                latency.start();
+                auto x = xt::linalg::solve(a, b);
+                benchmark::DoNotOptimize(x.data());
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_latency_solve_inplace(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<matrix_type<T>>(n, n);
+            auto b = make_general<matrix_type<T>>(n, 1);
+            auto lu = a;
+            auto x = b;
+            uvector<blas_index_t> piv(n);
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                reset(lu, a);
+                reset(x, b);
+                latency.start();
+                int info = xt::linalg::try_solve_inplace(lu, x, piv);
+                benchmark::DoNotOptimize(info);
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_latency_inv(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<matrix_type<T>>(n, n);
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                latency.start();
+                auto ainv = xt::linalg::inv(a);
+                benchmark::DoNotOptimize(ainv.data());
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_latency_inv_inplace(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_general<matrix_type<T>>(n, n);
+            auto m = a;
+            uvector<blas_index_t> piv(n);
+            lapack::workspace<T> ws;
+            ws.template prepare<lapack::routine::getri>({to_blas_index(n), 0, 0});
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                reset(m, a);
+                latency.start();
+                int info = xt::linalg::try_inv_inplace(m, piv, ws);
+                benchmark::DoNotOptimize(info);
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_latency_cholesky(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_spd<matrix_type<T>>(n);
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                latency.start();
+                auto l = xt::linalg::cholesky(a);
+                benchmark::DoNotOptimize(l.data());
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_latency_cholesky_inplace(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_spd<matrix_type<T>>(n);
+            auto m = a;
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                reset(m, a);
+                latency.start();
+                int info = xt::linalg::try_cholesky_inplace(m);
+                benchmark::DoNotOptimize(info);
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        template <class T>
+        inline void benchmark_latency_eigh(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_spd<matrix_type<T>>(n);
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                latency.start();
+                auto wv = xt::linalg::eigh(a);
+                benchmark::DoNotOptimize(std::get<0>(wv).data());
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        // real symmetric only: syevd on a prepared workspace
+        template <class T>
+        inline void benchmark_latency_eigh_inplace(benchmark::State& state)
+        {
+            std::size_t n = static_cast<std::size_t>(state.range(0));
+            auto a = make_spd<matrix_type<T>>(n);
+            auto m = a;
+            auto w = vector_type<T>::from_shape({n});
+            lapack::workspace<T> ws;
+            ws.template prepare<lapack::routine::syevd>({to_blas_index(n), 0, 0}, {'V', 'L', 0});
+            latency_recorder latency(state);
+            allocation_scope allocs;
+            while (state.KeepRunning())
+            {
+                reset(m, a);
+                latency.start();
+                int info = lapack::syevd(m, 'V', 'L', w, ws);
+                benchmark::DoNotOptimize(info);
+                latency.stop();
+            }
+            allocs.report(state);
+            latency.report(state);
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_latency_dot, double)->Apply(latency_sizes);
+        BENCHMARK_TEMPLATE(benchmark_latency_dot_into, double)->Apply(latency_sizes);
+        BENCHMARK_TEMPLATE(benchmark_latency_solve, double)->Apply(latency_sizes);
+        BENCHMARK_TEMPLATE(benchmark_latency_solve_inplace, double)->Apply(latency_sizes);
+        BENCHMARK_TEMPLATE(benchmark_latency_inv, double)->Apply(latency_sizes);
+        BENCHMARK_TEMPLATE(benchmark_latency_inv_inplace, double)->Apply(latency_sizes);
+        BENCHMARK_TEMPLATE(benchmark_latency_cholesky, double)->Apply(latency_sizes);
+        BENCHMARK_TEMPLATE(benchmark_latency_cholesky_inplace, double)->Apply(latency_sizes);
+        BENCHMARK_TEMPLATE(benchmark_latency_eigh, double)->Apply(latency_sizes);
+        BENCHMARK_TEMPLATE(benchmark_latency_eigh_inplace, double)->Apply(latency_sizes);
+    }
+}
+
+#endif
@@ -0,0 +1,246 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef BENCHMARK_THREADS_HPP
+#define BENCHMARK_THREADS_HPP
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xblas_threads.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+#include "benchmark_counters.hpp"
+#include "benchmark_lapack.hpp"
+
+namespace xt
+{
+    namespace benchmark_threads
+    {
+        using benchmark_counters::set_roofline;
+        using benchmark_lapack::make_general;
+        using benchmark_lapack::make_spd;
+
+        template <class T>
+        using matrix_type = xtensor<T, 2, layout_type::column_major>;
+
+        template <class T>
+        using stack_type = xtensor<T, 3>;
+
+        // 1, 2, 4, ... up to the number of cores, which is always included
+        inline std::vector<int> thread_counts()
+        {
+            int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            std::vector<int> counts;
+            for (int t = 1; t < cores; t *= 2)
+            {
+                counts.push_back(t);
+            }
+            counts.push_back(cores);
+            return counts;
+        }
+
+        /*****************************
+         * BLAS threads, one problem *
+         *****************************/
+
+        // state.range(0) is the BLAS thread count, state.range(1) the matrix size
+        inline void threads_and_sizes(benchmark::internal::Benchmark* b)
+        {
+            for (int t : thread_counts())
+            {
+                for (int n : {128, 512, 2048})
+                {
+                    b->Args({t, n});
+                }
+            }
+        }
+
+        template <class T>
+        inline void benchmark_threads_dot(benchmark::State& state)
+        {
+            int threads = static_cast<int>(state.range(0));
+            std::size_t n = static_cast<std::size_t>(state.range(1));
+            auto a = make_general<matrix_type<T>>(n, n);
+            auto b = make_spd<matrix_type<T>>(n);
+            blas::scoped_num_threads guard(threads);
+            while (state.KeepRunning())
+            {
+                auto c = xt::linalg::dot(a, b);
+                benchmark::DoNotOptimize(c.data());
+            }
+            set_roofline<T>(state, double(n) * double(n) * double(n), 3. * double(n) * double(n));
+        }
+
+        template <class T>
+        inline void benchmark_threads_cholesky(benchmark::State& state)
+        {
+            int threads = static_cast<int>(state.range(0));
+            std::size_t n = static_cast<std::size_t>(state.range(1));
+            auto a = make_spd<matrix_type<T>>(n);
+            blas::scoped_num_threads guard(threads);
+            while (state.KeepRunning())
+            {
+                auto l = xt::linalg::cholesky(a);
+                benchmark::DoNotOptimize(l.data());
+            }
+            set_roofline<T>(state, double(n) * double(n) * double(n) / 6., 2. * double(n) * double(n));
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_threads_dot, double)->Apply(threads_and_sizes)->UseRealTime();
+        BENCHMARK_TEMPLATE(benchmark_threads_cholesky, double)->Apply(threads_and_sizes)->UseRealTime();
+
+        /*************************************
+         * Batched small solves: who threads *
+         *************************************/
+
+        // state.range(0) is the thread count, state.range(1) the number of
+        // systems and state.range(2) their order, one right-hand side each
+        inline void threads_and_batches(benchmark::internal::Benchmark* b)
+        {
+            for (int t : thread_counts())
+            {
+                for (int batch : {64, 1024})
+                {
+                    for (int n : {16, 64, 256})
+                    {
+                        b->Args({t, batch, n});
+                    }
+                }
+            }
+        }
+
+        template <class T>
+        struct batch_problem
+        {
+            std::vector<matrix_type<T>> A;
+            std::vector<matrix_type<T>> b;
+
+            explicit batch_problem(const benchmark::State& state)
+            {
+                std::size_t batch = static_cast<std::size_t>(state.range(1));
+                std::size_t n = static_cast<std::size_t>(state.range(2));
+                A.assign(batch, make_general<matrix_type<T>>(n, n));
+                b.assign(batch, make_general<matrix_type<T>>(n, 1));
+            }
+
+            void solve(std::size_t begin, std::size_t end) const
+            {
+                for (std::size_t p = begin; p < end; ++p)
+                {
+                    auto x = xt::linalg::solve(A[p], b[p]);
+                    benchmark::DoNotOptimize(x.data());
+                }
+            }
+        };
+
+        // LU with one right-hand side
+        template <class T>
+        inline void set_batch_roofline(benchmark::State& state)
+        {
+            double batch = double(state.range(1));
+            double n = double(state.range(2));
+            set_roofline<T>(state, batch * (n * n * n / 3. + n * n), batch * (n * n + 2. * n));
+        }
+
+        // the systems one after the other, each with t BLAS threads
+        template <class T>
+        inline void benchmark_threads_solve_blas(benchmark::State& state)
+        {
+            batch_problem<T> problem(state);
+            blas::scoped_num_threads guard(static_cast<int>(state.range(0)));
+            while (state.KeepRunning())
+            {
+                problem.solve(0, problem.A.size());
+            }
+            set_batch_roofline<T>(state);
+        }
+
+        // the systems split between t threads, each calling single-threaded
+        // BLAS; the threads are started in every iteration, a cost that the
+        // batch sizes make small next to the solves
+        template <class T>
+        inline void benchmark_threads_solve_outer(benchmark::State& state)
+        {
+            batch_problem<T> problem(state);
+            std::size_t threads = static_cast<std::size_t>(state.range(0));
+            std::size_t batch = problem.A.size();
+            // process-wide with OpenBLAS, per thread with MKL and BLIS
+            blas::scoped_num_threads guard(1);
+            std::vector<std::thread> workers;
+            workers.reserve(threads);
+            while (state.KeepRunning())
+            {
+                for (std::size_t w = 0; w < threads; ++w)
+                {
+                    workers.emplace_back([&problem, w, threads, batch]() {
+#if !defined(WITH_OPENBLAS)
+                        blas::scoped_num_threads worker_guard(1);
+#endif
+                        problem.solve(w * batch / threads, (w + 1) * batch / threads);
+                    });
+                }
+                for (auto& worker : workers)
+                {
+                    worker.join();
+                }
+                workers.clear();
+            }
+            set_batch_roofline<T>(state);
+        }
+
+        // linalg::batch_solve on a (batch, n, n) stack, its loop over the
+        // stack run by t OpenMP threads when built with XTENSOR_USE_OPENMP,
+        // serial otherwise, with single-threaded BLAS
+        template <class T>
+        inline void benchmark_threads_batch_solve(benchmark::State& state)
+        {
+            std::size_t batch = static_cast<std::size_t>(state.range(1));
+            std::size_t n = static_cast<std::size_t>(state.range(2));
+            stack_type<T> A = stack_type<T>::from_shape({batch, n, n});
+            xtensor<T, 2> b = xtensor<T, 2>::from_shape({batch, n});
+            auto a = make_general<matrix_type<T>>(n, n);
+            for (std::size_t p = 0; p < batch; ++p)
+            {
+                xt::view(A, p, xt::all(), xt::all()) = a;
+                xt::view(b, p, xt::all()) = 1.;
+            }
+            blas::scoped_num_threads guard(1);
+#if defined(_OPENMP)
+            int omp_threads = omp_get_max_threads();
+            omp_set_num_threads(static_cast<int>(state.range(0)));
+#endif
+            while (state.KeepRunning())
+            {
+                auto x = xt::linalg::batch_solve(A, b);
+                benchmark::DoNotOptimize(x.data());
+            }
+#if defined(_OPENMP)
+            omp_set_num_threads(omp_threads);
+#endif
+            set_batch_roofline<T>(state);
+        }
+
+        BENCHMARK_TEMPLATE(benchmark_threads_solve_blas, double)->Apply(threads_and_batches)->UseRealTime();
+        BENCHMARK_TEMPLATE(benchmark_threads_solve_outer, double)->Apply(threads_and_batches)->UseRealTime();
+        BENCHMARK_TEMPLATE(benchmark_threads_batch_solve, double)->Apply(threads_and_batches)->UseRealTime();
+    }
+}
+
+#endif
@@ -0,0 +1,107 @@
+"""Per call times of the benchmark_compare workloads in xt::linalg, raw
+BLAS and LAPACK, Eigen and NumPy, with the overhead of each library over
+the raw calls.
+
+    python compare.py ./benchmark_xtensor
+    python compare.py --json compare.json   # from --benchmark_out
+
+The NumPy workloads are those of benchmark_compare.hpp, on the same sizes.
+"""
+
+import argparse
+import json
+import re
+import subprocess
+import timeit
+
+import numpy as np
+
+sizes = [2, 4, 8, 16, 32, 64, 256]
+workloads = ['dot', 'solve', 'svd', 'eigh', 'lstsq', 'tensordot']
+libraries = ['blas', 'xtensor', 'eigen', 'numpy']
+
+def general(rows, cols):
+    i, j = np.indices((rows, cols))
+    return 0.5 + ((3 * i + 7 * j) % 13) / 7. + np.where(i == j, float(rows + cols), 0.)
+
+def symmetric(n):
+    i, j = np.indices((n, n))
+    return 1. / (1 + abs(i - j)) + np.where(i == j, float(n), 0.)
+
+def vector(n):
+    return 1. + (np.arange(n) % 5)
+
+def numpy_workload(name, n):
+    if name == 'dot':
+        a, b = general(n, n), symmetric(n)
+        return lambda: np.dot(a, b)
+    if name == 'solve':
+        a, b = general(n, n), vector(n)
+        return lambda: np.linalg.solve(a, b)
+    if name == 'svd':
+        a = general(n, n)
+        return lambda: np.linalg.svd(a)
+    if name == 'eigh':
+        a = symmetric(n)
+        return lambda: np.linalg.eigh(a)
+    if name == 'lstsq':
+        a, b = general(2 * n, n), vector(2 * n)
+        return lambda: np.linalg.lstsq(a, b, rcond=None)
+    a = general(n, 64).reshape(n, 8, 8)
+    b = general(64, n).reshape(8, 8, n)
+    return lambda: np.tensordot(a, b, 2)
+
+def time_numpy(name, n):
+    timer = timeit.Timer(numpy_workload(name, n))
+    number, _ = timer.autorange()
+    return min(timer.repeat(3, number)) / number * 1e9
+
+def read_benchmarks(args):
+    if args.json:
+        with open(args.json) as f:
+            report = json.load(f)
+    else:
+        out = subprocess.check_output([args.benchmark,
+                                       '--benchmark_filter=benchmark_compare_',
+                                       '--benchmark_format=json'])
+        report = json.loads(out)
+    times = {}
+    pattern = re.compile(r'benchmark_compare_(\w+)_(blas|xtensor|eigen)/(\d+)$')
+    for b in report['benchmarks']:
+        match = pattern.match(b['name'])
+        if match is None or b.get('run_type', 'iteration') != 'iteration':
+            continue
+        scale = {'ns': 1., 'us': 1e3, 'ms': 1e6, 's': 1e9}[b.get('time_unit', 'ns')]
+        times[(match.group(1), match.group(2), int(match.group(3)))] = b['real_time'] * scale
+    return times
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('benchmark', nargs='?', default='./benchmark_xtensor')
+    parser.add_argument('--json', help='Google Benchmark JSON output instead of running the benchmark')
+    args = parser.parse_args()
+
+    times = read_benchmarks(args)
+    for name in workloads:
+        for n in sizes:
+            times[(name, 'numpy', n)] = time_numpy(name, n)
+
+    print('times per call in ns, overhead over the raw BLAS and LAPACK calls in brackets\n')
+    print('{:<10} {:>5} '.format('workload', 'n') + ''.join('{:>22}'.format(l) for l in libraries))
+    for name in workloads:
+        for n in sizes:
+            base = times.get((name, 'blas', n))
+            row = '{:<10} {:>5} '.format(name, n)
+            for library in libraries:
+                t = times.get((name, library, n))
+                if t is None:
+                    row += '{:>22}'.format('-')
+                elif base is None or library == 'blas':
+                    row += '{:>22.0f}'.format(t)
+                else:
+                    row += '{:>12.0f} ({:>+7.0f})'.format(t, t - base)
+            print(row)
+        print()
+
+if __name__ == '__main__':
+    main()
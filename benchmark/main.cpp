@@ -6,10 +6,34 @@
 // * The full license is in the file LICENSE, distributed with this software. *
 // ****************************************************************************/
 
+#include <cstdlib>
 #include <iostream>
+#include <new>
 #include <benchmark/benchmark.h>
 
 #include "benchmark_blas.hpp"
+#include "benchmark_compare.hpp"
+#include "benchmark_gemm.hpp"
+#include "benchmark_lapack.hpp"
+#include "benchmark_latency.hpp"
+#include "benchmark_threads.hpp"
+
+// counts the heap allocations reported by the LAPACK benchmarks; the
+// array, nothrow and sized forms forward to these two
+void* operator new(std::size_t size)
+{
+    xt::benchmark_lapack::record_allocation(size);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
 
 #ifdef WITH_OPENBLAS
 void blas_stats()
@@ -35,11 +35,13 @@
 
 #include "xflens/cxxblas/auxiliary/complex.h"
 #include "xflens/cxxblas/auxiliary/complextrait.h"
+#include "xflens/cxxblas/auxiliary/cpudispatch.h"
 #include "xflens/cxxblas/auxiliary/debugmacro.h"
 #include "xflens/cxxblas/auxiliary/fakeuse.h"
 #include "xflens/cxxblas/auxiliary/iscomplex.h"
 #include "xflens/cxxblas/auxiliary/ismpfrreal.h"
 #include "xflens/cxxblas/auxiliary/issame.h"
+#include "xflens/cxxblas/auxiliary/parallel.h"
 #include "xflens/cxxblas/auxiliary/pow.h"
 #include "xflens/cxxblas/auxiliary/restrictto.h"
 
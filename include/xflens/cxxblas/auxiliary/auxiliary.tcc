@@ -34,6 +34,8 @@
 #define CXXBLAS_AUXILIARY_AUXILIARY_TCC 1
 
 #include "xflens/cxxblas/auxiliary/complex.tcc"
+#include "xflens/cxxblas/auxiliary/cpudispatch.tcc"
+#include "xflens/cxxblas/auxiliary/parallel.tcc"
 #include "xflens/cxxblas/auxiliary/pow.tcc"
 
 #endif // CXXBLAS_AUXILIARY_AUXILIARY_TCC
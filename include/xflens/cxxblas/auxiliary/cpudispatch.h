@@ -0,0 +1,78 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_AUXILIARY_CPUDISPATCH_H
+#define CXXBLAS_AUXILIARY_CPUDISPATCH_H 1
+
+//
+//  Runtime selection of the instruction set of the generic kernels. The
+//  headers are compiled for the instruction set of the build machine; with
+//  CXXBLAS_CPU_DISPATCH (set by XTENSOR_BLAS_CPU_DISPATCH on x86-64 with GCC
+//  or Clang) the real gemm micro kernels and unit stride dots are also
+//  compiled for AVX2 + FMA and for AVX-512, with wider register blocks, and
+//  the widest level the processor supports is called. One binary then runs
+//  on older hosts and uses 512-bit kernels where they are available.
+//  AArch64 needs no dispatch: NEON is part of its baseline.
+//
+
+#if defined(CXXBLAS_CPU_DISPATCH)
+#   define CXXBLAS_TARGET_AVX2    __attribute__((target("avx2,fma")))
+#   define CXXBLAS_TARGET_AVX512  __attribute__((target("avx512f,avx512dq,avx2,fma")))
+#   define CXXBLAS_ALWAYS_INLINE  inline __attribute__((always_inline))
+#else
+#   define CXXBLAS_ALWAYS_INLINE  inline
+#endif
+
+namespace cxxblas {
+
+enum CpuLevel {
+    CpuBaseline = 0,    // instruction set of the build
+    CpuAvx2     = 1,    // AVX2 and FMA
+    CpuAvx512   = 2     // AVX-512 F and DQ
+};
+
+// widest level supported by the processor, CpuBaseline without dispatch
+inline CpuLevel
+detected_cpu_level();
+
+// level of the kernels called
+inline CpuLevel
+cpu_level();
+
+// restricts the kernels to level, at most the detected one, e.g. to compare
+// them; CpuBaseline runs the kernels compiled for the build
+inline void
+set_cpu_level(CpuLevel level);
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_AUXILIARY_CPUDISPATCH_H
@@ -0,0 +1,88 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_AUXILIARY_CPUDISPATCH_TCC
+#define CXXBLAS_AUXILIARY_CPUDISPATCH_TCC 1
+
+#include <algorithm>
+#include "xflens/cxxblas/auxiliary/cpudispatch.h"
+
+namespace cxxblas {
+
+namespace detail {
+
+inline CpuLevel
+query_cpu_level()
+{
+#if defined(CXXBLAS_CPU_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+        return CpuAvx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return CpuAvx2;
+    }
+#endif
+    return CpuBaseline;
+}
+
+inline CpuLevel &
+cpu_level_setting()
+{
+    static CpuLevel level = detected_cpu_level();
+    return level;
+}
+
+} // namespace detail
+
+inline CpuLevel
+detected_cpu_level()
+{
+    static const CpuLevel level = detail::query_cpu_level();
+    return level;
+}
+
+inline CpuLevel
+cpu_level()
+{
+    return detail::cpu_level_setting();
+}
+
+inline void
+set_cpu_level(CpuLevel level)
+{
+    detail::cpu_level_setting() = std::min(level, detected_cpu_level());
+}
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_AUXILIARY_CPUDISPATCH_TCC
@@ -0,0 +1,60 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_AUXILIARY_PARALLEL_H
+#define CXXBLAS_AUXILIARY_PARALLEL_H 1
+
+//
+//  Task parallelism of the generic level 3 routines. With XTENSOR_USE_TBB
+//  the tasks run on the TBB work-stealing scheduler, with XTENSOR_USE_OPENMP
+//  they are dynamically scheduled over an OpenMP team, and otherwise they
+//  run sequentially in the calling thread.
+//
+
+namespace cxxblas {
+
+// number of threads used by the generic level 3 routines, 0 restores the
+// default of the threading backend
+inline void
+set_num_threads(int numThreads);
+
+inline int
+get_num_threads();
+
+// calls f(i) for 0 <= i < n, possibly concurrently
+template <typename IndexType, typename F>
+    void
+    parallel_for(IndexType n, const F &f);
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_AUXILIARY_PARALLEL_H
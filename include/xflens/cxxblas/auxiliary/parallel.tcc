@@ -0,0 +1,114 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_AUXILIARY_PARALLEL_TCC
+#define CXXBLAS_AUXILIARY_PARALLEL_TCC 1
+
+#include "xflens/cxxblas/auxiliary/parallel.h"
+
+#if defined(XTENSOR_USE_TBB)
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#elif defined(XTENSOR_USE_OPENMP) && defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace cxxblas {
+
+namespace detail {
+
+inline int &
+num_threads_setting()
+{
+    static int numThreads = 0;
+    return numThreads;
+}
+
+} // namespace detail
+
+inline void
+set_num_threads(int numThreads)
+{
+    detail::num_threads_setting() = (numThreads>0) ? numThreads : 0;
+}
+
+inline int
+get_num_threads()
+{
+    if (detail::num_threads_setting()>0) {
+        return detail::num_threads_setting();
+    }
+#if defined(XTENSOR_USE_TBB)
+    return tbb::this_task_arena::max_concurrency();
+#elif defined(XTENSOR_USE_OPENMP) && defined(_OPENMP)
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+template <typename IndexType, typename F>
+void
+parallel_for(IndexType n, const F &f)
+{
+    const int numThreads = get_num_threads();
+    if ((n<=1) || (numThreads<=1)) {
+        for (IndexType i=0; i<n; ++i) {
+            f(i);
+        }
+        return;
+    }
+#if defined(XTENSOR_USE_TBB)
+    auto body = [&]() {
+        tbb::parallel_for(IndexType(0), n, [&](IndexType i) { f(i); });
+    };
+    if (detail::num_threads_setting()>0) {
+        tbb::task_arena arena(numThreads);
+        arena.execute(body);
+    } else {
+        body();
+    }
+#elif defined(XTENSOR_USE_OPENMP)
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(numThreads)
+    for (IndexType i=0; i<n; ++i) {
+        f(i);
+    }
+#else
+    for (IndexType i=0; i<n; ++i) {
+        f(i);
+    }
+#endif
+}
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_AUXILIARY_PARALLEL_TCC
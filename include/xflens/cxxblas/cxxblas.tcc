@@ -49,4 +49,8 @@
 #include "xflens/cxxblas/tinylevel1/tinylevel1.tcc"
 #include "xflens/cxxblas/tinylevel2/tinylevel2.tcc"
 
+#ifdef WITH_DYNAMICBLAS
+#include "xflens/cxxblas/drivers/dynamicblas.tcc"
+#endif
+
 #endif // CXXBLAS_CXXBLAS_TCC
@@ -0,0 +1,54 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_CXXBLAS_CORE_CXX
+#define CXXBLAS_CXXBLAS_CORE_CXX 1
+
+//
+//  The drivers, types and thread settings of cxxblas, without the kernels:
+//  enough for code that only forwards storage orders and transpositions or
+//  sets the thread count. With the dynamic driver, whose fallbacks are the
+//  generic kernels, the dense levels are included as well.
+//
+
+#include "xflens/cxxblas/auxiliary/auxiliary.h"
+#include "xflens/cxxblas/drivers/drivers.h"
+#include "xflens/cxxblas/typedefs.h"
+
+#include "xflens/cxxblas/auxiliary/auxiliary.tcc"
+#include "xflens/cxxblas/drivers/drivers.tcc"
+
+#ifdef WITH_DYNAMICBLAS
+#include "xflens/cxxblas/cxxblas_dense.cxx"
+#endif
+
+#endif // CXXBLAS_CXXBLAS_CORE_CXX
@@ -0,0 +1,61 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_CXXBLAS_DENSE_CXX
+#define CXXBLAS_CXXBLAS_DENSE_CXX 1
+
+//
+//  The dense levels of cxxblas and their extensions, without the sparse
+//  and tiny levels of cxxblas.cxx.
+//
+
+#include "xflens/cxxblas/cxxblas_core.cxx"
+
+#include "xflens/cxxblas/level1/level1.h"
+#include "xflens/cxxblas/level1extensions/level1extensions.h"
+#include "xflens/cxxblas/level2/level2.h"
+#include "xflens/cxxblas/level2extensions/level2extensions.h"
+#include "xflens/cxxblas/level3/level3.h"
+#include "xflens/cxxblas/level3extensions/level3extensions.h"
+
+#include "xflens/cxxblas/level1/level1.tcc"
+#include "xflens/cxxblas/level1extensions/level1extensions.tcc"
+#include "xflens/cxxblas/level2/level2.tcc"
+#include "xflens/cxxblas/level2extensions/level2extensions.tcc"
+#include "xflens/cxxblas/level3/level3.tcc"
+#include "xflens/cxxblas/level3extensions/level3extensions.tcc"
+
+#ifdef WITH_DYNAMICBLAS
+#include "xflens/cxxblas/drivers/dynamicblas.tcc"
+#endif
+
+#endif // CXXBLAS_CXXBLAS_DENSE_CXX
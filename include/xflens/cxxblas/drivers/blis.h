@@ -0,0 +1,136 @@
+/*
+ *   Copyright (c) 2010, Michael Lehn
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_DRIVERS_BLIS_H
+#define CXXBLAS_DRIVERS_BLIS_H 1
+
+#include <cstdint>
+
+#   define HAVE_CBLAS           1
+#   ifdef BLASINT
+#      define CBLAS_INT         BLASINT
+#   else
+#      define CBLAS_INT         int
+#   endif
+#   define BLAS_IMPL            "BLIS"
+#   ifndef CBLAS_INDEX
+#       define CBLAS_INDEX      size_t
+#   endif // CBLAS_INDEX
+
+// integer type of the typed API (gint_t), 64 bit unless BLIS was
+// configured with --int-size=32
+#ifndef BLIS_DIM_TYPE
+#    define BLIS_DIM_TYPE       std::int64_t
+#endif
+
+// the typed API takes a row and a column stride per matrix; the
+// declarations are made here rather than by including blis.h, whose CBLAS
+// header clashes with xflens/cxxblas/drivers/cblas.h
+#ifndef HAVE_BLIS_TYPED_API
+#    define HAVE_BLIS_TYPED_API
+#endif
+
+// trans_t and conj_t of the typed API
+#define CXXBLAS_BLIS_NO_TRANSPOSE       0x00
+#define CXXBLAS_BLIS_TRANSPOSE          0x08
+#define CXXBLAS_BLIS_CONJ_NO_TRANSPOSE  0x10
+#define CXXBLAS_BLIS_CONJ_TRANSPOSE     0x18
+#define CXXBLAS_BLIS_NO_CONJUGATE       0x00
+#define CXXBLAS_BLIS_CONJUGATE          0x10
+
+extern "C" {
+	/* Thread count of the calling thread (thread-local runtime, BLIS 0.9 and later) */
+	void bli_thread_set_num_threads(BLIS_DIM_TYPE n_threads);
+	BLIS_DIM_TYPE bli_thread_get_num_threads(void);
+
+	/* C := beta * C + alpha * transa(A) * transb(B), general strides */
+	void bli_sgemm(int transa, int transb,
+	               BLIS_DIM_TYPE m, BLIS_DIM_TYPE n, BLIS_DIM_TYPE k,
+	               const float* alpha,
+	               const float* a, BLIS_DIM_TYPE rsa, BLIS_DIM_TYPE csa,
+	               const float* b, BLIS_DIM_TYPE rsb, BLIS_DIM_TYPE csb,
+	               const float* beta,
+	               float* c, BLIS_DIM_TYPE rsc, BLIS_DIM_TYPE csc);
+	void bli_dgemm(int transa, int transb,
+	               BLIS_DIM_TYPE m, BLIS_DIM_TYPE n, BLIS_DIM_TYPE k,
+	               const double* alpha,
+	               const double* a, BLIS_DIM_TYPE rsa, BLIS_DIM_TYPE csa,
+	               const double* b, BLIS_DIM_TYPE rsb, BLIS_DIM_TYPE csb,
+	               const double* beta,
+	               double* c, BLIS_DIM_TYPE rsc, BLIS_DIM_TYPE csc);
+	void bli_cgemm(int transa, int transb,
+	               BLIS_DIM_TYPE m, BLIS_DIM_TYPE n, BLIS_DIM_TYPE k,
+	               const void* alpha,
+	               const void* a, BLIS_DIM_TYPE rsa, BLIS_DIM_TYPE csa,
+	               const void* b, BLIS_DIM_TYPE rsb, BLIS_DIM_TYPE csb,
+	               const void* beta,
+	               void* c, BLIS_DIM_TYPE rsc, BLIS_DIM_TYPE csc);
+	void bli_zgemm(int transa, int transb,
+	               BLIS_DIM_TYPE m, BLIS_DIM_TYPE n, BLIS_DIM_TYPE k,
+	               const void* alpha,
+	               const void* a, BLIS_DIM_TYPE rsa, BLIS_DIM_TYPE csa,
+	               const void* b, BLIS_DIM_TYPE rsb, BLIS_DIM_TYPE csb,
+	               const void* beta,
+	               void* c, BLIS_DIM_TYPE rsc, BLIS_DIM_TYPE csc);
+
+	/* y := beta * y + alpha * transa(A) * conjx(x), general strides */
+	void bli_sgemv(int transa, int conjx,
+	               BLIS_DIM_TYPE m, BLIS_DIM_TYPE n,
+	               const float* alpha,
+	               const float* a, BLIS_DIM_TYPE rsa, BLIS_DIM_TYPE csa,
+	               const float* x, BLIS_DIM_TYPE incx,
+	               const float* beta,
+	               float* y, BLIS_DIM_TYPE incy);
+	void bli_dgemv(int transa, int conjx,
+	               BLIS_DIM_TYPE m, BLIS_DIM_TYPE n,
+	               const double* alpha,
+	               const double* a, BLIS_DIM_TYPE rsa, BLIS_DIM_TYPE csa,
+	               const double* x, BLIS_DIM_TYPE incx,
+	               const double* beta,
+	               double* y, BLIS_DIM_TYPE incy);
+	void bli_cgemv(int transa, int conjx,
+	               BLIS_DIM_TYPE m, BLIS_DIM_TYPE n,
+	               const void* alpha,
+	               const void* a, BLIS_DIM_TYPE rsa, BLIS_DIM_TYPE csa,
+	               const void* x, BLIS_DIM_TYPE incx,
+	               const void* beta,
+	               void* y, BLIS_DIM_TYPE incy);
+	void bli_zgemv(int transa, int conjx,
+	               BLIS_DIM_TYPE m, BLIS_DIM_TYPE n,
+	               const void* alpha,
+	               const void* a, BLIS_DIM_TYPE rsa, BLIS_DIM_TYPE csa,
+	               const void* x, BLIS_DIM_TYPE incx,
+	               const void* beta,
+	               void* y, BLIS_DIM_TYPE incy);
+}
+
+#endif // CXXBLAS_DRIVERS_BLIS_H
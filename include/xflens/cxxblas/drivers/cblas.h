@@ -212,10 +212,10 @@ cblas_drotm(CBLAS_INT n,
             const double *P);
 
 void
-cblas_srotmg(float *d1, float *d2, float *b1, float *b2, float *P);
+cblas_srotmg(float *d1, float *d2, float *b1, const float b2, float *P);
 
 void
-cblas_drotmg(double *d1, double *d2, double *b1, double *b2, double *P);
+cblas_drotmg(double *d1, double *d2, double *b1, const double b2, double *P);
 
 // scal
 void
@@ -329,6 +329,52 @@ cblas_zgemv(enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans,
             const double *beta,
             double *y, CBLAS_INT incY);
 
+// gemv_batch_strided (MKL): the matrices and vectors of a batch at fixed
+// strides from the first ones
+#ifdef HAVE_CBLAS_GEMV_BATCH
+
+void
+cblas_sgemv_batch_strided(enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans,
+                          CBLAS_INT m, CBLAS_INT n,
+                          float alpha,
+                          const float *A, CBLAS_INT ldA, CBLAS_INT strideA,
+                          const float *x, CBLAS_INT incX, CBLAS_INT strideX,
+                          float beta,
+                          float *y, CBLAS_INT incY, CBLAS_INT strideY,
+                          CBLAS_INT batchSize);
+
+void
+cblas_dgemv_batch_strided(enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans,
+                          CBLAS_INT m, CBLAS_INT n,
+                          double alpha,
+                          const double *A, CBLAS_INT ldA, CBLAS_INT strideA,
+                          const double *x, CBLAS_INT incX, CBLAS_INT strideX,
+                          double beta,
+                          double *y, CBLAS_INT incY, CBLAS_INT strideY,
+                          CBLAS_INT batchSize);
+
+void
+cblas_cgemv_batch_strided(enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans,
+                          CBLAS_INT m, CBLAS_INT n,
+                          const void *alpha,
+                          const void *A, CBLAS_INT ldA, CBLAS_INT strideA,
+                          const void *x, CBLAS_INT incX, CBLAS_INT strideX,
+                          const void *beta,
+                          void *y, CBLAS_INT incY, CBLAS_INT strideY,
+                          CBLAS_INT batchSize);
+
+void
+cblas_zgemv_batch_strided(enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans,
+                          CBLAS_INT m, CBLAS_INT n,
+                          const void *alpha,
+                          const void *A, CBLAS_INT ldA, CBLAS_INT strideA,
+                          const void *x, CBLAS_INT incX, CBLAS_INT strideX,
+                          const void *beta,
+                          void *y, CBLAS_INT incY, CBLAS_INT strideY,
+                          CBLAS_INT batchSize);
+
+#endif // HAVE_CBLAS_GEMV_BATCH
+
 // sbmv
 void
 cblas_ssbmv(enum CBLAS_ORDER order, enum CBLAS_UPLO upLo,
@@ -824,6 +870,175 @@ cblas_zgemm(enum CBLAS_ORDER order,
             const double *beta,
             double *C, CBLAS_INT ldC);
 
+// gemm_batch (grouped interface, e.g. MKL)
+#ifdef HAVE_CBLAS_GEMM_BATCH
+
+void
+cblas_sgemm_batch(enum CBLAS_ORDER order,
+                  const enum CBLAS_TRANSPOSE *transA, const enum CBLAS_TRANSPOSE *transB,
+                  const CBLAS_INT *m, const CBLAS_INT *n, const CBLAS_INT *k,
+                  const float *alpha,
+                  const float **A, const CBLAS_INT *ldA,
+                  const float **B, const CBLAS_INT *ldB,
+                  const float *beta,
+                  float **C, const CBLAS_INT *ldC,
+                  CBLAS_INT groupCount, const CBLAS_INT *groupSize);
+
+void
+cblas_dgemm_batch(enum CBLAS_ORDER order,
+                  const enum CBLAS_TRANSPOSE *transA, const enum CBLAS_TRANSPOSE *transB,
+                  const CBLAS_INT *m, const CBLAS_INT *n, const CBLAS_INT *k,
+                  const double *alpha,
+                  const double **A, const CBLAS_INT *ldA,
+                  const double **B, const CBLAS_INT *ldB,
+                  const double *beta,
+                  double **C, const CBLAS_INT *ldC,
+                  CBLAS_INT groupCount, const CBLAS_INT *groupSize);
+
+void
+cblas_cgemm_batch(enum CBLAS_ORDER order,
+                  const enum CBLAS_TRANSPOSE *transA, const enum CBLAS_TRANSPOSE *transB,
+                  const CBLAS_INT *m, const CBLAS_INT *n, const CBLAS_INT *k,
+                  const float *alpha,
+                  const float **A, const CBLAS_INT *ldA,
+                  const float **B, const CBLAS_INT *ldB,
+                  const float *beta,
+                  float **C, const CBLAS_INT *ldC,
+                  CBLAS_INT groupCount, const CBLAS_INT *groupSize);
+
+void
+cblas_zgemm_batch(enum CBLAS_ORDER order,
+                  const enum CBLAS_TRANSPOSE *transA, const enum CBLAS_TRANSPOSE *transB,
+                  const CBLAS_INT *m, const CBLAS_INT *n, const CBLAS_INT *k,
+                  const double *alpha,
+                  const double **A, const CBLAS_INT *ldA,
+                  const double **B, const CBLAS_INT *ldB,
+                  const double *beta,
+                  double **C, const CBLAS_INT *ldC,
+                  CBLAS_INT groupCount, const CBLAS_INT *groupSize);
+
+#endif // HAVE_CBLAS_GEMM_BATCH
+
+// gemm3m: complex gemm with three real matrix products
+#ifdef HAVE_CBLAS_GEMM3M
+
+void
+cblas_cgemm3m(enum CBLAS_ORDER order,
+              enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+              CBLAS_INT m, CBLAS_INT n, CBLAS_INT k,
+              const float *alpha,
+              const float *A, CBLAS_INT ldA,
+              const float *B, CBLAS_INT ldB,
+              const float *beta,
+              float *C, CBLAS_INT ldC);
+
+void
+cblas_zgemm3m(enum CBLAS_ORDER order,
+              enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+              CBLAS_INT m, CBLAS_INT n, CBLAS_INT k,
+              const double *alpha,
+              const double *A, CBLAS_INT ldA,
+              const double *B, CBLAS_INT ldB,
+              const double *beta,
+              double *C, CBLAS_INT ldC);
+
+#endif // HAVE_CBLAS_GEMM3M
+
+// gemmt: gemm updating one triangle of C only
+#ifdef HAVE_CBLAS_GEMMT
+
+void
+cblas_sgemmt(enum CBLAS_ORDER order, enum CBLAS_UPLO upLo,
+             enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+             CBLAS_INT n, CBLAS_INT k,
+             float alpha,
+             const float *A, CBLAS_INT ldA,
+             const float *B, CBLAS_INT ldB,
+             float beta,
+             float *C, CBLAS_INT ldC);
+
+void
+cblas_dgemmt(enum CBLAS_ORDER order, enum CBLAS_UPLO upLo,
+             enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+             CBLAS_INT n, CBLAS_INT k,
+             double alpha,
+             const double *A, CBLAS_INT ldA,
+             const double *B, CBLAS_INT ldB,
+             double beta,
+             double *C, CBLAS_INT ldC);
+
+void
+cblas_cgemmt(enum CBLAS_ORDER order, enum CBLAS_UPLO upLo,
+             enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+             CBLAS_INT n, CBLAS_INT k,
+             const float *alpha,
+             const float *A, CBLAS_INT ldA,
+             const float *B, CBLAS_INT ldB,
+             const float *beta,
+             float *C, CBLAS_INT ldC);
+
+void
+cblas_zgemmt(enum CBLAS_ORDER order, enum CBLAS_UPLO upLo,
+             enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+             CBLAS_INT n, CBLAS_INT k,
+             const double *alpha,
+             const double *A, CBLAS_INT ldA,
+             const double *B, CBLAS_INT ldB,
+             const double *beta,
+             double *C, CBLAS_INT ldC);
+
+#endif // HAVE_CBLAS_GEMMT
+
+// gemm of 16 bit floating point matrices (given by their bits) with float
+// accumulation, e.g. cblas_gemm_bf16bf16f32 (MKL) or cblas_sbgemm (OpenBLAS)
+#ifdef HAVE_CBLAS_GEMM_BF16
+
+void
+CBLAS_GEMM_BF16(enum CBLAS_ORDER order,
+                enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+                CBLAS_INT m, CBLAS_INT n, CBLAS_INT k,
+                float alpha,
+                const unsigned short *A, CBLAS_INT ldA,
+                const unsigned short *B, CBLAS_INT ldB,
+                float beta,
+                float *C, CBLAS_INT ldC);
+
+#endif // HAVE_CBLAS_GEMM_BF16
+
+#ifdef HAVE_CBLAS_GEMM_F16
+
+void
+CBLAS_GEMM_F16(enum CBLAS_ORDER order,
+               enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+               CBLAS_INT m, CBLAS_INT n, CBLAS_INT k,
+               float alpha,
+               const unsigned short *A, CBLAS_INT ldA,
+               const unsigned short *B, CBLAS_INT ldB,
+               float beta,
+               float *C, CBLAS_INT ldC);
+
+#endif // HAVE_CBLAS_GEMM_F16
+
+// gemm of a signed and an unsigned 8 bit integer matrix with 32 bit integer
+// accumulation, C := alpha*(op(A)+ao)*(op(B)+bo) + beta*C + co
+#ifdef HAVE_CBLAS_GEMM_S8U8S32
+
+enum CBLAS_OFFSET       {CblasRowOffset=171, CblasColOffset=172,
+                         CblasFixOffset=173};
+
+void
+CBLAS_GEMM_S8U8S32(enum CBLAS_ORDER order,
+                   enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+                   enum CBLAS_OFFSET offsetC,
+                   CBLAS_INT m, CBLAS_INT n, CBLAS_INT k,
+                   float alpha,
+                   const void *A, CBLAS_INT ldA, char ao,
+                   const void *B, CBLAS_INT ldB, char bo,
+                   float beta,
+                   int *C, CBLAS_INT ldC, const int *co);
+
+#endif // HAVE_CBLAS_GEMM_S8U8S32
+
 // hemm
 void
 cblas_chemm(enum CBLAS_ORDER order, enum CBLAS_SIDE side, enum CBLAS_UPLO upLo,
@@ -36,6 +36,11 @@
 #include "xflens/cxxblas/auxiliary/issame.h"
 #include "xflens/cxxblas/auxiliary/restrictto.h"
 
+// symbols of libraries with suffixed (e.g. ILP64) interfaces
+#if defined (CXXBLAS_SYMBOL_SUFFIX) && !defined (WITH_DYNAMICBLAS)
+#   include "xflens/cxxblas/drivers/suffix.h"
+#endif
+
 // define implementation specific constants, macros, etc.
 #if defined (WITH_ATLAS)
 #   include "xflens/cxxblas/drivers/atlas.h"
@@ -43,12 +48,16 @@
 #   include "xflens/cxxblas/drivers/gotoblas.h"
 #elif defined (WITH_OPENBLAS)
 #   include "xflens/cxxblas/drivers/openblas.h"
+#elif defined (WITH_BLIS)
+#   include "xflens/cxxblas/drivers/blis.h"
 #elif defined (WITH_VECLIB)
 #   include "xflens/cxxblas/drivers/veclib.h"
 #elif defined (WITH_MKLBLAS)
 #   include "xflens/cxxblas/drivers/mklblas.h"
 #elif defined (WITH_REFBLAS)
 #   include "xflens/cxxblas/drivers/refblas.h"
+#elif defined (WITH_DYNAMICBLAS)
+#   include "xflens/cxxblas/drivers/dynamicblas.h"
 #endif
 
 
@@ -144,6 +153,20 @@ template <typename ENUM>
 
 #endif // HAVE_CBLAS
 
+//------------------------------------------------------------------------------
+#ifdef HAVE_BLIS_TYPED_API
+
+namespace BLIS {
+
+// trans_t of the BLIS typed API
+template <typename ENUM>
+    typename RestrictTo<IsSame<ENUM,Transpose>::value, int>::Type
+    getBlisType(ENUM trans);
+
+} // namespace BLIS
+
+#endif // HAVE_BLIS_TYPED_API
+
 } // namespace cxxblas
 
 
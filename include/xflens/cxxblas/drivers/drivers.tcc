@@ -193,6 +193,31 @@ getCblasType(ENUM diag)
 
 #endif // HAVE_CBLAS
 
+//------------------------------------------------------------------------------
+#ifdef HAVE_BLIS_TYPED_API
+
+namespace BLIS {
+
+template <typename ENUM>
+typename RestrictTo<IsSame<ENUM,Transpose>::value, int>::Type
+getBlisType(ENUM trans)
+{
+    if (trans==NoTrans) {
+        return CXXBLAS_BLIS_NO_TRANSPOSE;
+    }
+    if (trans==Conj) {
+        return CXXBLAS_BLIS_CONJ_NO_TRANSPOSE;
+    }
+    if (trans==Trans) {
+        return CXXBLAS_BLIS_TRANSPOSE;
+    }
+    return CXXBLAS_BLIS_CONJ_TRANSPOSE;
+}
+
+} // namespace BLIS
+
+#endif // HAVE_BLIS_TYPED_API
+
 } // namespace cxxblas
 
 #endif // CXXBLAS_DRIVERS_DRIVERS_TCC
@@ -0,0 +1,324 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_DRIVERS_DYNAMICBLAS_H
+#define CXXBLAS_DRIVERS_DYNAMICBLAS_H 1
+
+//
+//  Runtime selected BLAS/LAPACK (WITH_DYNAMICBLAS): nothing is linked at
+//  build time, the library is opened with dlopen when the first routine is
+//  called and every cblas_* (and LAPACK) call site looks its symbol up once.
+//  The library is taken from cxxblas::dynamic::load or, if that was not
+//  called, from the XTENSOR_BLAS_LIBRARY environment variable (or the
+//  CXXBLAS_DYNAMIC_DEFAULT_LIBRARY macro).  Routines the library does not
+//  provide fall back to the generic cxxblas kernels where one exists, the
+//  others throw std::runtime_error when called.
+//
+
+#   define HAVE_CBLAS           1
+#   ifdef BLASINT
+#      define CBLAS_INT         BLASINT
+#   else
+#      define CBLAS_INT         int
+#   endif
+#   define BLAS_IMPL            "DynamicBLAS"
+#   ifndef CBLAS_INDEX
+#       define CBLAS_INDEX      size_t
+#   endif // CBLAS_INDEX
+
+#include <cstddef>
+#include "xflens/cxxblas/drivers/cblas.h"
+
+namespace cxxblas { namespace dynamic {
+
+//  Opens the BLAS/LAPACK library 'name' (a path or a name searched by the
+//  dynamic loader).  Must be called before the first BLAS call, routines
+//  already called keep the symbol they were resolved to.  Returns false if
+//  the library can not be opened, the previous library is kept then.
+bool
+load(const char *name);
+
+bool
+isLoaded();
+
+//  Name of the loaded library, or an empty string.
+const char *
+libraryName();
+
+//  Address of 'name' in the loaded library (opening the default library on
+//  first use), or nullptr.
+void *
+symbol(const char *name);
+
+//  Resolves 'name' to a function of type F, 'fallback' if the library does
+//  not provide it.  Throws std::runtime_error if neither exists.
+template <typename F>
+    F
+    resolve(const char *name, F fallback);
+
+//  Thread count of the loaded library (OpenBLAS and MKL), returns the
+//  previous setting or 0 if the library has no known threading control.
+int
+setNumThreads(int n);
+
+int
+getNumThreads();
+
+//  cblas_* signatures implemented with the generic cxxblas kernels, e.g.
+//  fallback::dgemm for cblas_dgemm
+namespace fallback {
+
+inline decltype(::cblas_sasum) sasum;
+inline decltype(::cblas_dasum) dasum;
+inline decltype(::cblas_scasum) scasum;
+inline decltype(::cblas_dzasum) dzasum;
+inline decltype(::cblas_saxpy) saxpy;
+inline decltype(::cblas_daxpy) daxpy;
+inline decltype(::cblas_caxpy) caxpy;
+inline decltype(::cblas_zaxpy) zaxpy;
+inline decltype(::cblas_scopy) scopy;
+inline decltype(::cblas_dcopy) dcopy;
+inline decltype(::cblas_ccopy) ccopy;
+inline decltype(::cblas_zcopy) zcopy;
+inline decltype(::cblas_sdot) sdot;
+inline decltype(::cblas_ddot) ddot;
+inline decltype(::cblas_cdotu_sub) cdotu_sub;
+inline decltype(::cblas_cdotc_sub) cdotc_sub;
+inline decltype(::cblas_zdotu_sub) zdotu_sub;
+inline decltype(::cblas_zdotc_sub) zdotc_sub;
+inline decltype(::cblas_isamax) isamax;
+inline decltype(::cblas_idamax) idamax;
+inline decltype(::cblas_icamax) icamax;
+inline decltype(::cblas_izamax) izamax;
+inline decltype(::cblas_snrm2) snrm2;
+inline decltype(::cblas_dnrm2) dnrm2;
+inline decltype(::cblas_scnrm2) scnrm2;
+inline decltype(::cblas_dznrm2) dznrm2;
+inline decltype(::cblas_sscal) sscal;
+inline decltype(::cblas_dscal) dscal;
+inline decltype(::cblas_cscal) cscal;
+inline decltype(::cblas_zscal) zscal;
+inline decltype(::cblas_csscal) csscal;
+inline decltype(::cblas_zdscal) zdscal;
+inline decltype(::cblas_sswap) sswap;
+inline decltype(::cblas_dswap) dswap;
+inline decltype(::cblas_cswap) cswap;
+inline decltype(::cblas_zswap) zswap;
+inline decltype(::cblas_sgemv) sgemv;
+inline decltype(::cblas_dgemv) dgemv;
+inline decltype(::cblas_cgemv) cgemv;
+inline decltype(::cblas_zgemv) zgemv;
+inline decltype(::cblas_sgemm) sgemm;
+inline decltype(::cblas_dgemm) dgemm;
+inline decltype(::cblas_cgemm) cgemm;
+inline decltype(::cblas_zgemm) zgemm;
+inline decltype(::cblas_ssyrk) ssyrk;
+inline decltype(::cblas_dsyrk) dsyrk;
+inline decltype(::cblas_csyrk) csyrk;
+inline decltype(::cblas_zsyrk) zsyrk;
+inline decltype(::cblas_strsm) strsm;
+inline decltype(::cblas_dtrsm) dtrsm;
+inline decltype(::cblas_ctrsm) ctrsm;
+inline decltype(::cblas_ztrsm) ztrsm;
+
+} // namespace fallback
+
+} } // namespace dynamic, cxxblas
+
+#define CXXBLAS_DYNAMIC_SYMBOL(f, name, fallback)                           \
+    ([]() {                                                                 \
+        static const decltype(&f) f_                                        \
+            = ::cxxblas::dynamic::resolve<decltype(&f)>(name, fallback);    \
+        return f_;                                                          \
+    }())
+
+//  symbol name suffix of the library, see drivers/suffix.h
+#ifdef CXXBLAS_SYMBOL_SUFFIX
+#   define CXXBLAS_SUFFIX_STR_(s)       #s
+#   define CXXBLAS_SUFFIX_STR__(s)      CXXBLAS_SUFFIX_STR_(s)
+#   define CXXBLAS_SUFFIX_STR   CXXBLAS_SUFFIX_STR__(CXXBLAS_SYMBOL_SUFFIX)
+#else
+#   define CXXBLAS_SUFFIX_STR           ""
+#endif
+
+#define CXXBLAS_DYNAMIC(f)                                                  \
+    CXXBLAS_DYNAMIC_SYMBOL(::f, #f CXXBLAS_SUFFIX_STR, nullptr)
+
+#define CXXBLAS_DYNAMIC_GENERIC(f, g)                                       \
+    CXXBLAS_DYNAMIC_SYMBOL(::f, #f CXXBLAS_SUFFIX_STR,                      \
+                           &::cxxblas::dynamic::fallback::g)
+
+//  from here on every cblas_* call is looked up in the loaded library
+#define cblas_sasum          CXXBLAS_DYNAMIC_GENERIC(cblas_sasum, sasum)
+#define cblas_dasum          CXXBLAS_DYNAMIC_GENERIC(cblas_dasum, dasum)
+#define cblas_scasum         CXXBLAS_DYNAMIC_GENERIC(cblas_scasum, scasum)
+#define cblas_dzasum         CXXBLAS_DYNAMIC_GENERIC(cblas_dzasum, dzasum)
+#define cblas_saxpy          CXXBLAS_DYNAMIC_GENERIC(cblas_saxpy, saxpy)
+#define cblas_daxpy          CXXBLAS_DYNAMIC_GENERIC(cblas_daxpy, daxpy)
+#define cblas_caxpy          CXXBLAS_DYNAMIC_GENERIC(cblas_caxpy, caxpy)
+#define cblas_zaxpy          CXXBLAS_DYNAMIC_GENERIC(cblas_zaxpy, zaxpy)
+#define cblas_scopy          CXXBLAS_DYNAMIC_GENERIC(cblas_scopy, scopy)
+#define cblas_dcopy          CXXBLAS_DYNAMIC_GENERIC(cblas_dcopy, dcopy)
+#define cblas_ccopy          CXXBLAS_DYNAMIC_GENERIC(cblas_ccopy, ccopy)
+#define cblas_zcopy          CXXBLAS_DYNAMIC_GENERIC(cblas_zcopy, zcopy)
+#define cblas_sdsdot         CXXBLAS_DYNAMIC(cblas_sdsdot)
+#define cblas_dsdot          CXXBLAS_DYNAMIC(cblas_dsdot)
+#define cblas_sdot           CXXBLAS_DYNAMIC_GENERIC(cblas_sdot, sdot)
+#define cblas_ddot           CXXBLAS_DYNAMIC_GENERIC(cblas_ddot, ddot)
+#define cblas_cdotu_sub      CXXBLAS_DYNAMIC_GENERIC(cblas_cdotu_sub, cdotu_sub)
+#define cblas_cdotc_sub      CXXBLAS_DYNAMIC_GENERIC(cblas_cdotc_sub, cdotc_sub)
+#define cblas_zdotu_sub      CXXBLAS_DYNAMIC_GENERIC(cblas_zdotu_sub, zdotu_sub)
+#define cblas_zdotc_sub      CXXBLAS_DYNAMIC_GENERIC(cblas_zdotc_sub, zdotc_sub)
+#define cblas_isamax         CXXBLAS_DYNAMIC_GENERIC(cblas_isamax, isamax)
+#define cblas_idamax         CXXBLAS_DYNAMIC_GENERIC(cblas_idamax, idamax)
+#define cblas_icamax         CXXBLAS_DYNAMIC_GENERIC(cblas_icamax, icamax)
+#define cblas_izamax         CXXBLAS_DYNAMIC_GENERIC(cblas_izamax, izamax)
+#define cblas_snrm2          CXXBLAS_DYNAMIC_GENERIC(cblas_snrm2, snrm2)
+#define cblas_dnrm2          CXXBLAS_DYNAMIC_GENERIC(cblas_dnrm2, dnrm2)
+#define cblas_scnrm2         CXXBLAS_DYNAMIC_GENERIC(cblas_scnrm2, scnrm2)
+#define cblas_dznrm2         CXXBLAS_DYNAMIC_GENERIC(cblas_dznrm2, dznrm2)
+#define cblas_srot           CXXBLAS_DYNAMIC(cblas_srot)
+#define cblas_drot           CXXBLAS_DYNAMIC(cblas_drot)
+#define cblas_srotg          CXXBLAS_DYNAMIC(cblas_srotg)
+#define cblas_drotg          CXXBLAS_DYNAMIC(cblas_drotg)
+#define cblas_srotm          CXXBLAS_DYNAMIC(cblas_srotm)
+#define cblas_drotm          CXXBLAS_DYNAMIC(cblas_drotm)
+#define cblas_srotmg         CXXBLAS_DYNAMIC(cblas_srotmg)
+#define cblas_drotmg         CXXBLAS_DYNAMIC(cblas_drotmg)
+#define cblas_sscal          CXXBLAS_DYNAMIC_GENERIC(cblas_sscal, sscal)
+#define cblas_dscal          CXXBLAS_DYNAMIC_GENERIC(cblas_dscal, dscal)
+#define cblas_cscal          CXXBLAS_DYNAMIC_GENERIC(cblas_cscal, cscal)
+#define cblas_zscal          CXXBLAS_DYNAMIC_GENERIC(cblas_zscal, zscal)
+#define cblas_csscal         CXXBLAS_DYNAMIC_GENERIC(cblas_csscal, csscal)
+#define cblas_zdscal         CXXBLAS_DYNAMIC_GENERIC(cblas_zdscal, zdscal)
+#define cblas_sswap          CXXBLAS_DYNAMIC_GENERIC(cblas_sswap, sswap)
+#define cblas_dswap          CXXBLAS_DYNAMIC_GENERIC(cblas_dswap, dswap)
+#define cblas_cswap          CXXBLAS_DYNAMIC_GENERIC(cblas_cswap, cswap)
+#define cblas_zswap          CXXBLAS_DYNAMIC_GENERIC(cblas_zswap, zswap)
+#define cblas_sgbmv          CXXBLAS_DYNAMIC(cblas_sgbmv)
+#define cblas_dgbmv          CXXBLAS_DYNAMIC(cblas_dgbmv)
+#define cblas_cgbmv          CXXBLAS_DYNAMIC(cblas_cgbmv)
+#define cblas_zgbmv          CXXBLAS_DYNAMIC(cblas_zgbmv)
+#define cblas_sgemv          CXXBLAS_DYNAMIC_GENERIC(cblas_sgemv, sgemv)
+#define cblas_dgemv          CXXBLAS_DYNAMIC_GENERIC(cblas_dgemv, dgemv)
+#define cblas_cgemv          CXXBLAS_DYNAMIC_GENERIC(cblas_cgemv, cgemv)
+#define cblas_zgemv          CXXBLAS_DYNAMIC_GENERIC(cblas_zgemv, zgemv)
+#define cblas_ssbmv          CXXBLAS_DYNAMIC(cblas_ssbmv)
+#define cblas_dsbmv          CXXBLAS_DYNAMIC(cblas_dsbmv)
+#define cblas_ssymv          CXXBLAS_DYNAMIC(cblas_ssymv)
+#define cblas_dsymv          CXXBLAS_DYNAMIC(cblas_dsymv)
+#define cblas_sspmv          CXXBLAS_DYNAMIC(cblas_sspmv)
+#define cblas_dspmv          CXXBLAS_DYNAMIC(cblas_dspmv)
+#define cblas_chbmv          CXXBLAS_DYNAMIC(cblas_chbmv)
+#define cblas_zhbmv          CXXBLAS_DYNAMIC(cblas_zhbmv)
+#define cblas_chemv          CXXBLAS_DYNAMIC(cblas_chemv)
+#define cblas_zhemv          CXXBLAS_DYNAMIC(cblas_zhemv)
+#define cblas_chpmv          CXXBLAS_DYNAMIC(cblas_chpmv)
+#define cblas_zhpmv          CXXBLAS_DYNAMIC(cblas_zhpmv)
+#define cblas_stbsv          CXXBLAS_DYNAMIC(cblas_stbsv)
+#define cblas_dtbsv          CXXBLAS_DYNAMIC(cblas_dtbsv)
+#define cblas_ctbsv          CXXBLAS_DYNAMIC(cblas_ctbsv)
+#define cblas_ztbsv          CXXBLAS_DYNAMIC(cblas_ztbsv)
+#define cblas_strsv          CXXBLAS_DYNAMIC(cblas_strsv)
+#define cblas_dtrsv          CXXBLAS_DYNAMIC(cblas_dtrsv)
+#define cblas_ctrsv          CXXBLAS_DYNAMIC(cblas_ctrsv)
+#define cblas_ztrsv          CXXBLAS_DYNAMIC(cblas_ztrsv)
+#define cblas_stpsv          CXXBLAS_DYNAMIC(cblas_stpsv)
+#define cblas_dtpsv          CXXBLAS_DYNAMIC(cblas_dtpsv)
+#define cblas_ctpsv          CXXBLAS_DYNAMIC(cblas_ctpsv)
+#define cblas_ztpsv          CXXBLAS_DYNAMIC(cblas_ztpsv)
+#define cblas_stbmv          CXXBLAS_DYNAMIC(cblas_stbmv)
+#define cblas_dtbmv          CXXBLAS_DYNAMIC(cblas_dtbmv)
+#define cblas_ctbmv          CXXBLAS_DYNAMIC(cblas_ctbmv)
+#define cblas_ztbmv          CXXBLAS_DYNAMIC(cblas_ztbmv)
+#define cblas_strmv          CXXBLAS_DYNAMIC(cblas_strmv)
+#define cblas_dtrmv          CXXBLAS_DYNAMIC(cblas_dtrmv)
+#define cblas_ctrmv          CXXBLAS_DYNAMIC(cblas_ctrmv)
+#define cblas_ztrmv          CXXBLAS_DYNAMIC(cblas_ztrmv)
+#define cblas_stpmv          CXXBLAS_DYNAMIC(cblas_stpmv)
+#define cblas_dtpmv          CXXBLAS_DYNAMIC(cblas_dtpmv)
+#define cblas_ctpmv          CXXBLAS_DYNAMIC(cblas_ctpmv)
+#define cblas_ztpmv          CXXBLAS_DYNAMIC(cblas_ztpmv)
+#define cblas_sger           CXXBLAS_DYNAMIC(cblas_sger)
+#define cblas_dger           CXXBLAS_DYNAMIC(cblas_dger)
+#define cblas_cgeru          CXXBLAS_DYNAMIC(cblas_cgeru)
+#define cblas_cgerc          CXXBLAS_DYNAMIC(cblas_cgerc)
+#define cblas_zgeru          CXXBLAS_DYNAMIC(cblas_zgeru)
+#define cblas_zgerc          CXXBLAS_DYNAMIC(cblas_zgerc)
+#define cblas_ssyr           CXXBLAS_DYNAMIC(cblas_ssyr)
+#define cblas_dsyr           CXXBLAS_DYNAMIC(cblas_dsyr)
+#define cblas_sspr           CXXBLAS_DYNAMIC(cblas_sspr)
+#define cblas_dspr           CXXBLAS_DYNAMIC(cblas_dspr)
+#define cblas_cher           CXXBLAS_DYNAMIC(cblas_cher)
+#define cblas_zher           CXXBLAS_DYNAMIC(cblas_zher)
+#define cblas_chpr           CXXBLAS_DYNAMIC(cblas_chpr)
+#define cblas_zhpr           CXXBLAS_DYNAMIC(cblas_zhpr)
+#define cblas_sspr2          CXXBLAS_DYNAMIC(cblas_sspr2)
+#define cblas_dspr2          CXXBLAS_DYNAMIC(cblas_dspr2)
+#define cblas_ssyr2          CXXBLAS_DYNAMIC(cblas_ssyr2)
+#define cblas_dsyr2          CXXBLAS_DYNAMIC(cblas_dsyr2)
+#define cblas_cher2          CXXBLAS_DYNAMIC(cblas_cher2)
+#define cblas_zher2          CXXBLAS_DYNAMIC(cblas_zher2)
+#define cblas_chpr2          CXXBLAS_DYNAMIC(cblas_chpr2)
+#define cblas_zhpr2          CXXBLAS_DYNAMIC(cblas_zhpr2)
+#define cblas_sgemm          CXXBLAS_DYNAMIC_GENERIC(cblas_sgemm, sgemm)
+#define cblas_dgemm          CXXBLAS_DYNAMIC_GENERIC(cblas_dgemm, dgemm)
+#define cblas_cgemm          CXXBLAS_DYNAMIC_GENERIC(cblas_cgemm, cgemm)
+#define cblas_zgemm          CXXBLAS_DYNAMIC_GENERIC(cblas_zgemm, zgemm)
+#define cblas_chemm          CXXBLAS_DYNAMIC(cblas_chemm)
+#define cblas_zhemm          CXXBLAS_DYNAMIC(cblas_zhemm)
+#define cblas_cherk          CXXBLAS_DYNAMIC(cblas_cherk)
+#define cblas_zherk          CXXBLAS_DYNAMIC(cblas_zherk)
+#define cblas_cher2k         CXXBLAS_DYNAMIC(cblas_cher2k)
+#define cblas_zher2k         CXXBLAS_DYNAMIC(cblas_zher2k)
+#define cblas_ssymm          CXXBLAS_DYNAMIC(cblas_ssymm)
+#define cblas_dsymm          CXXBLAS_DYNAMIC(cblas_dsymm)
+#define cblas_csymm          CXXBLAS_DYNAMIC(cblas_csymm)
+#define cblas_zsymm          CXXBLAS_DYNAMIC(cblas_zsymm)
+#define cblas_ssyrk          CXXBLAS_DYNAMIC_GENERIC(cblas_ssyrk, ssyrk)
+#define cblas_dsyrk          CXXBLAS_DYNAMIC_GENERIC(cblas_dsyrk, dsyrk)
+#define cblas_csyrk          CXXBLAS_DYNAMIC_GENERIC(cblas_csyrk, csyrk)
+#define cblas_zsyrk          CXXBLAS_DYNAMIC_GENERIC(cblas_zsyrk, zsyrk)
+#define cblas_ssyr2k         CXXBLAS_DYNAMIC(cblas_ssyr2k)
+#define cblas_dsyr2k         CXXBLAS_DYNAMIC(cblas_dsyr2k)
+#define cblas_csyr2k         CXXBLAS_DYNAMIC(cblas_csyr2k)
+#define cblas_zsyr2k         CXXBLAS_DYNAMIC(cblas_zsyr2k)
+#define cblas_strmm          CXXBLAS_DYNAMIC(cblas_strmm)
+#define cblas_dtrmm          CXXBLAS_DYNAMIC(cblas_dtrmm)
+#define cblas_ctrmm          CXXBLAS_DYNAMIC(cblas_ctrmm)
+#define cblas_ztrmm          CXXBLAS_DYNAMIC(cblas_ztrmm)
+#define cblas_strsm          CXXBLAS_DYNAMIC_GENERIC(cblas_strsm, strsm)
+#define cblas_dtrsm          CXXBLAS_DYNAMIC_GENERIC(cblas_dtrsm, dtrsm)
+#define cblas_ctrsm          CXXBLAS_DYNAMIC_GENERIC(cblas_ctrsm, ctrsm)
+#define cblas_ztrsm          CXXBLAS_DYNAMIC_GENERIC(cblas_ztrsm, ztrsm)
+
+#endif // CXXBLAS_DRIVERS_DYNAMICBLAS_H
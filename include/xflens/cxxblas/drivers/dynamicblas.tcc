@@ -0,0 +1,802 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_DRIVERS_DYNAMICBLAS_TCC
+#define CXXBLAS_DRIVERS_DYNAMICBLAS_TCC 1
+
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <dlfcn.h>
+#endif
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas { namespace dynamic {
+
+struct Library
+{
+    std::mutex   mutex;
+    void         *handle = nullptr;
+    bool         opened = false;
+    std::string  name;
+};
+
+inline Library &
+library()
+{
+    static Library lib;
+    return lib;
+}
+
+inline void *
+openLibrary(const char *name)
+{
+#ifdef _WIN32
+    return reinterpret_cast<void *>(LoadLibraryA(name));
+#else
+    return dlopen(name, RTLD_NOW | RTLD_LOCAL);
+#endif
+}
+
+inline void *
+lookupSymbol(void *handle, const char *name)
+{
+#ifdef _WIN32
+    return reinterpret_cast<void *>(
+               GetProcAddress(reinterpret_cast<HMODULE>(handle), name));
+#else
+    return dlsym(handle, name);
+#endif
+}
+
+// expects the library mutex to be held
+inline bool
+loadLocked(Library &lib, const char *name)
+{
+    lib.opened = true;
+    void *handle = openLibrary(name);
+    if (!handle) {
+        return false;
+    }
+    // a previous library stays open, call sites may still refer to it
+    lib.handle = handle;
+    lib.name = name;
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] loaded " << name);
+    return true;
+}
+
+inline bool
+load(const char *name)
+{
+    Library &lib = library();
+    std::lock_guard<std::mutex> lock(lib.mutex);
+
+    return loadLocked(lib, name);
+}
+
+inline bool
+isLoaded()
+{
+    Library &lib = library();
+    std::lock_guard<std::mutex> lock(lib.mutex);
+
+    return lib.handle!=nullptr;
+}
+
+inline const char *
+libraryName()
+{
+    Library &lib = library();
+    std::lock_guard<std::mutex> lock(lib.mutex);
+
+    return lib.name.c_str();
+}
+
+inline void *
+symbol(const char *name)
+{
+    Library &lib = library();
+    std::lock_guard<std::mutex> lock(lib.mutex);
+
+    if (!lib.opened) {
+        const char *env = std::getenv("XTENSOR_BLAS_LIBRARY");
+        if (env && *env) {
+            loadLocked(lib, env);
+        }
+#       ifdef CXXBLAS_DYNAMIC_DEFAULT_LIBRARY
+        else {
+            loadLocked(lib, CXXBLAS_DYNAMIC_DEFAULT_LIBRARY);
+        }
+#       endif
+        lib.opened = true;
+    }
+    if (!lib.handle) {
+        return nullptr;
+    }
+    return lookupSymbol(lib.handle, name);
+}
+
+template <typename F>
+F
+resolve(const char *name, F fallback)
+{
+    void *f = symbol(name);
+    if (f) {
+        return reinterpret_cast<F>(f);
+    }
+    if (fallback) {
+        CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] " << name << ": using generic");
+        return fallback;
+    }
+    std::string msg = std::string("cxxblas: ") + name + " is not provided by ";
+    if (isLoaded()) {
+        msg += libraryName();
+    } else {
+        msg += "any library, set XTENSOR_BLAS_LIBRARY";
+    }
+    throw std::runtime_error(msg);
+}
+
+inline int
+setNumThreads(int n)
+{
+    typedef int  (*GetNumThreads)();
+    typedef void (*SetNumThreads)(int);
+    typedef int  (*SetNumThreadsLocal)(int);
+
+    if (void *set = symbol("openblas_set_num_threads" CXXBLAS_SUFFIX_STR)) {
+        int previous = 0;
+        if (void *get = symbol("openblas_get_num_threads" CXXBLAS_SUFFIX_STR)) {
+            previous = reinterpret_cast<GetNumThreads>(get)();
+        }
+        reinterpret_cast<SetNumThreads>(set)(n);
+        return previous;
+    }
+    if (void *set = symbol("MKL_Set_Num_Threads_Local")) {
+        return reinterpret_cast<SetNumThreadsLocal>(set)(n);
+    }
+    return 0;
+}
+
+inline int
+getNumThreads()
+{
+    typedef int  (*GetNumThreads)();
+
+    if (void *get = symbol("openblas_get_num_threads" CXXBLAS_SUFFIX_STR)) {
+        return reinterpret_cast<GetNumThreads>(get)();
+    }
+    if (void *get = symbol("MKL_Get_Max_Threads")) {
+        return reinterpret_cast<GetNumThreads>(get)();
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+namespace fallback {
+
+inline StorageOrder
+getOrder(enum CBLAS_ORDER order)
+{
+    return (order==CblasRowMajor) ? RowMajor : ColMajor;
+}
+
+inline Transpose
+getTranspose(enum CBLAS_TRANSPOSE trans)
+{
+    if (trans==CblasNoTrans) {
+        return NoTrans;
+    }
+    if (trans==CblasConjNoTrans) {
+        return Conj;
+    }
+    if (trans==CblasTrans) {
+        return Trans;
+    }
+    return ConjTrans;
+}
+
+inline StorageUpLo
+getUpLo(enum CBLAS_UPLO upLo)
+{
+    return (upLo==CblasUpper) ? Upper : Lower;
+}
+
+inline Side
+getSide(enum CBLAS_SIDE side)
+{
+    return (side==CblasLeft) ? Left : Right;
+}
+
+inline Diag
+getDiag(enum CBLAS_DIAG diag)
+{
+    return (diag==CblasUnit) ? Unit : NonUnit;
+}
+
+// cblas passes the first element in memory, the generic kernels expect
+// the first element of the vector
+template <typename T>
+T *
+first(CBLAS_INT n, T *x, CBLAS_INT incX)
+{
+    return ((incX<0) && (n>0)) ? x-incX*(n-1) : x;
+}
+
+template <typename T>
+const std::complex<T> *
+cplx(const T *x)
+{
+    return reinterpret_cast<const std::complex<T> *>(x);
+}
+
+template <typename T>
+std::complex<T> *
+cplx(T *x)
+{
+    return reinterpret_cast<std::complex<T> *>(x);
+}
+
+//-- level 1 ---------------------------------------------------------------
+
+inline float
+sasum(CBLAS_INT n, const float *x, CBLAS_INT incX)
+{
+    float absSum;
+    asum_generic(n, first(n, x, incX), incX, absSum);
+    return absSum;
+}
+
+inline double
+dasum(CBLAS_INT n, const double *x, CBLAS_INT incX)
+{
+    double absSum;
+    asum_generic(n, first(n, x, incX), incX, absSum);
+    return absSum;
+}
+
+inline float
+scasum(CBLAS_INT n, const float *x, CBLAS_INT incX)
+{
+    float absSum;
+    asum_generic(n, first(n, cplx(x), incX), incX, absSum);
+    return absSum;
+}
+
+inline double
+dzasum(CBLAS_INT n, const double *x, CBLAS_INT incX)
+{
+    double absSum;
+    asum_generic(n, first(n, cplx(x), incX), incX, absSum);
+    return absSum;
+}
+
+inline void
+saxpy(CBLAS_INT n, float alpha, const float *x, CBLAS_INT incX,
+      float *y, CBLAS_INT incY)
+{
+    axpy_generic(n, alpha, first(n, x, incX), incX,
+                 first(n, y, incY), incY);
+}
+
+inline void
+daxpy(CBLAS_INT n, double alpha, const double *x, CBLAS_INT incX,
+      double *y, CBLAS_INT incY)
+{
+    axpy_generic(n, alpha, first(n, x, incX), incX,
+                 first(n, y, incY), incY);
+}
+
+inline void
+caxpy(CBLAS_INT n, const float *alpha, const float *x, CBLAS_INT incX,
+      float *y, CBLAS_INT incY)
+{
+    axpy_generic(n, *cplx(alpha), first(n, cplx(x), incX), incX,
+                 first(n, cplx(y), incY), incY);
+}
+
+inline void
+zaxpy(CBLAS_INT n, const double *alpha, const double *x, CBLAS_INT incX,
+      double *y, CBLAS_INT incY)
+{
+    axpy_generic(n, *cplx(alpha), first(n, cplx(x), incX), incX,
+                 first(n, cplx(y), incY), incY);
+}
+
+inline void
+scopy(CBLAS_INT n, const float *x, CBLAS_INT incX, float *y, CBLAS_INT incY)
+{
+    copy_generic(n, first(n, x, incX), incX,
+                 first(n, y, incY), incY);
+}
+
+inline void
+dcopy(CBLAS_INT n, const double *x, CBLAS_INT incX, double *y, CBLAS_INT incY)
+{
+    copy_generic(n, first(n, x, incX), incX,
+                 first(n, y, incY), incY);
+}
+
+inline void
+ccopy(CBLAS_INT n, const float *x, CBLAS_INT incX, float *y, CBLAS_INT incY)
+{
+    copy_generic(n, first(n, cplx(x), incX), incX,
+                 first(n, cplx(y), incY), incY);
+}
+
+inline void
+zcopy(CBLAS_INT n, const double *x, CBLAS_INT incX, double *y, CBLAS_INT incY)
+{
+    copy_generic(n, first(n, cplx(x), incX), incX,
+                 first(n, cplx(y), incY), incY);
+}
+
+inline float
+sdot(CBLAS_INT n, const float *x, CBLAS_INT incX,
+     const float *y, CBLAS_INT incY)
+{
+    float result;
+    dotu_generic(n, first(n, x, incX), incX, first(n, y, incY), incY, result);
+    return result;
+}
+
+inline double
+ddot(CBLAS_INT n, const double *x, CBLAS_INT incX,
+     const double *y, CBLAS_INT incY)
+{
+    double result;
+    dotu_generic(n, first(n, x, incX), incX, first(n, y, incY), incY, result);
+    return result;
+}
+
+inline void
+cdotu_sub(CBLAS_INT n, const float *x, CBLAS_INT incX,
+          const float *y, CBLAS_INT incY, float *result)
+{
+    dotu_generic(n, first(n, cplx(x), incX), incX,
+             first(n, cplx(y), incY), incY, *cplx(result));
+}
+
+inline void
+cdotc_sub(CBLAS_INT n, const float *x, CBLAS_INT incX,
+          const float *y, CBLAS_INT incY, float *result)
+{
+    dot_generic(n, first(n, cplx(x), incX), incX,
+            first(n, cplx(y), incY), incY, *cplx(result));
+}
+
+inline void
+zdotu_sub(CBLAS_INT n, const double *x, CBLAS_INT incX,
+          const double *y, CBLAS_INT incY, double *result)
+{
+    dotu_generic(n, first(n, cplx(x), incX), incX,
+             first(n, cplx(y), incY), incY, *cplx(result));
+}
+
+inline void
+zdotc_sub(CBLAS_INT n, const double *x, CBLAS_INT incX,
+          const double *y, CBLAS_INT incY, double *result)
+{
+    dot_generic(n, first(n, cplx(x), incX), incX,
+            first(n, cplx(y), incY), incY, *cplx(result));
+}
+
+inline CBLAS_INDEX
+isamax(CBLAS_INT n, const float *x, CBLAS_INT incX)
+{
+    if (n<=0) {
+        return 0;
+    }
+    CBLAS_INT i;
+    iamax_generic(n, first(n, x, incX), incX, i);
+    return i;
+}
+
+inline CBLAS_INDEX
+idamax(CBLAS_INT n, const double *x, CBLAS_INT incX)
+{
+    if (n<=0) {
+        return 0;
+    }
+    CBLAS_INT i;
+    iamax_generic(n, first(n, x, incX), incX, i);
+    return i;
+}
+
+inline CBLAS_INDEX
+icamax(CBLAS_INT n, const float *x, CBLAS_INT incX)
+{
+    if (n<=0) {
+        return 0;
+    }
+    CBLAS_INT i;
+    iamax_generic(n, first(n, cplx(x), incX), incX, i);
+    return i;
+}
+
+inline CBLAS_INDEX
+izamax(CBLAS_INT n, const double *x, CBLAS_INT incX)
+{
+    if (n<=0) {
+        return 0;
+    }
+    CBLAS_INT i;
+    iamax_generic(n, first(n, cplx(x), incX), incX, i);
+    return i;
+}
+
+inline float
+snrm2(CBLAS_INT n, const float *x, CBLAS_INT incX)
+{
+    float norm;
+    nrm2_generic(n, first(n, x, incX), incX, norm);
+    return norm;
+}
+
+inline double
+dnrm2(CBLAS_INT n, const double *x, CBLAS_INT incX)
+{
+    double norm;
+    nrm2_generic(n, first(n, x, incX), incX, norm);
+    return norm;
+}
+
+inline float
+scnrm2(CBLAS_INT n, const float *x, CBLAS_INT incX)
+{
+    float norm;
+    nrm2_generic(n, first(n, cplx(x), incX), incX, norm);
+    return norm;
+}
+
+inline double
+dznrm2(CBLAS_INT n, const double *x, CBLAS_INT incX)
+{
+    double norm;
+    nrm2_generic(n, first(n, cplx(x), incX), incX, norm);
+    return norm;
+}
+
+inline void
+sscal(CBLAS_INT n, float alpha, float *x, CBLAS_INT incX)
+{
+    scal_generic(n, alpha, first(n, x, incX), incX);
+}
+
+inline void
+dscal(CBLAS_INT n, double alpha, double *x, CBLAS_INT incX)
+{
+    scal_generic(n, alpha, first(n, x, incX), incX);
+}
+
+inline void
+cscal(CBLAS_INT n, const float *alpha, float *x, CBLAS_INT incX)
+{
+    scal_generic(n, *cplx(alpha), first(n, cplx(x), incX), incX);
+}
+
+inline void
+zscal(CBLAS_INT n, const double *alpha, double *x, CBLAS_INT incX)
+{
+    scal_generic(n, *cplx(alpha), first(n, cplx(x), incX), incX);
+}
+
+inline void
+csscal(CBLAS_INT n, float alpha, float *x, CBLAS_INT incX)
+{
+    scal_generic(n, alpha, first(n, cplx(x), incX), incX);
+}
+
+inline void
+zdscal(CBLAS_INT n, double alpha, double *x, CBLAS_INT incX)
+{
+    scal_generic(n, alpha, first(n, cplx(x), incX), incX);
+}
+
+inline void
+sswap(CBLAS_INT n, float *x, CBLAS_INT incX, float *y, CBLAS_INT incY)
+{
+    swap_generic(n, first(n, x, incX), incX,
+                 first(n, y, incY), incY);
+}
+
+inline void
+dswap(CBLAS_INT n, double *x, CBLAS_INT incX, double *y, CBLAS_INT incY)
+{
+    swap_generic(n, first(n, x, incX), incX,
+                 first(n, y, incY), incY);
+}
+
+inline void
+cswap(CBLAS_INT n, float *x, CBLAS_INT incX, float *y, CBLAS_INT incY)
+{
+    swap_generic(n, first(n, cplx(x), incX), incX,
+                 first(n, cplx(y), incY), incY);
+}
+
+inline void
+zswap(CBLAS_INT n, double *x, CBLAS_INT incX, double *y, CBLAS_INT incY)
+{
+    swap_generic(n, first(n, cplx(x), incX), incX,
+                 first(n, cplx(y), incY), incY);
+}
+
+//-- level 2 ---------------------------------------------------------------
+
+inline void
+sgemv(enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans,
+      CBLAS_INT m, CBLAS_INT n,
+      float alpha,
+      const float *A, CBLAS_INT ldA,
+      const float *x, CBLAS_INT incX,
+      float beta,
+      float *y, CBLAS_INT incY)
+{
+    if ((m==0) || (n==0)) {
+        return;
+    }
+    gemv_generic(getOrder(order), getTranspose(trans), NoTrans, m, n,
+                 alpha, A, ldA, x, incX,
+                 beta, y, incY);
+}
+
+inline void
+dgemv(enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans,
+      CBLAS_INT m, CBLAS_INT n,
+      double alpha,
+      const double *A, CBLAS_INT ldA,
+      const double *x, CBLAS_INT incX,
+      double beta,
+      double *y, CBLAS_INT incY)
+{
+    if ((m==0) || (n==0)) {
+        return;
+    }
+    gemv_generic(getOrder(order), getTranspose(trans), NoTrans, m, n,
+                 alpha, A, ldA, x, incX,
+                 beta, y, incY);
+}
+
+inline void
+cgemv(enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans,
+      CBLAS_INT m, CBLAS_INT n,
+      const float *alpha,
+      const float *A, CBLAS_INT ldA,
+      const float *x, CBLAS_INT incX,
+      const float *beta,
+      float *y, CBLAS_INT incY)
+{
+    if ((m==0) || (n==0)) {
+        return;
+    }
+    gemv_generic(getOrder(order), getTranspose(trans), NoTrans, m, n,
+                 *cplx(alpha), cplx(A), ldA, cplx(x), incX,
+                 *cplx(beta), cplx(y), incY);
+}
+
+inline void
+zgemv(enum CBLAS_ORDER order, enum CBLAS_TRANSPOSE trans,
+      CBLAS_INT m, CBLAS_INT n,
+      const double *alpha,
+      const double *A, CBLAS_INT ldA,
+      const double *x, CBLAS_INT incX,
+      const double *beta,
+      double *y, CBLAS_INT incY)
+{
+    if ((m==0) || (n==0)) {
+        return;
+    }
+    gemv_generic(getOrder(order), getTranspose(trans), NoTrans, m, n,
+                 *cplx(alpha), cplx(A), ldA, cplx(x), incX,
+                 *cplx(beta), cplx(y), incY);
+}
+
+//-- level 3 ---------------------------------------------------------------
+
+inline void
+sgemm(enum CBLAS_ORDER order,
+      enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+      CBLAS_INT m, CBLAS_INT n, CBLAS_INT k,
+      float alpha,
+      const float *A, CBLAS_INT ldA,
+      const float *B, CBLAS_INT ldB,
+      float beta,
+      float *C, CBLAS_INT ldC)
+{
+    gemm_generic(getOrder(order), getTranspose(transA), getTranspose(transB),
+                 m, n, k, alpha, A, ldA, B, ldB,
+                 beta, C, ldC);
+}
+
+inline void
+dgemm(enum CBLAS_ORDER order,
+      enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+      CBLAS_INT m, CBLAS_INT n, CBLAS_INT k,
+      double alpha,
+      const double *A, CBLAS_INT ldA,
+      const double *B, CBLAS_INT ldB,
+      double beta,
+      double *C, CBLAS_INT ldC)
+{
+    gemm_generic(getOrder(order), getTranspose(transA), getTranspose(transB),
+                 m, n, k, alpha, A, ldA, B, ldB,
+                 beta, C, ldC);
+}
+
+inline void
+cgemm(enum CBLAS_ORDER order,
+      enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+      CBLAS_INT m, CBLAS_INT n, CBLAS_INT k,
+      const float *alpha,
+      const float *A, CBLAS_INT ldA,
+      const float *B, CBLAS_INT ldB,
+      const float *beta,
+      float *C, CBLAS_INT ldC)
+{
+    gemm_generic(getOrder(order), getTranspose(transA), getTranspose(transB),
+                 m, n, k, *cplx(alpha), cplx(A), ldA, cplx(B), ldB,
+                 *cplx(beta), cplx(C), ldC);
+}
+
+inline void
+zgemm(enum CBLAS_ORDER order,
+      enum CBLAS_TRANSPOSE transA, enum CBLAS_TRANSPOSE transB,
+      CBLAS_INT m, CBLAS_INT n, CBLAS_INT k,
+      const double *alpha,
+      const double *A, CBLAS_INT ldA,
+      const double *B, CBLAS_INT ldB,
+      const double *beta,
+      double *C, CBLAS_INT ldC)
+{
+    gemm_generic(getOrder(order), getTranspose(transA), getTranspose(transB),
+                 m, n, k, *cplx(alpha), cplx(A), ldA, cplx(B), ldB,
+                 *cplx(beta), cplx(C), ldC);
+}
+
+inline void
+ssyrk(enum CBLAS_ORDER order, enum CBLAS_UPLO upLo,
+      enum CBLAS_TRANSPOSE trans,
+      CBLAS_INT n, CBLAS_INT k,
+      float alpha,
+      const float *A, CBLAS_INT ldA,
+      float beta,
+      float *C, CBLAS_INT ldC)
+{
+    syrk_generic(getOrder(order), getUpLo(upLo), getTranspose(trans), n, k,
+                 alpha, A, ldA, beta, C, ldC);
+}
+
+inline void
+dsyrk(enum CBLAS_ORDER order, enum CBLAS_UPLO upLo,
+      enum CBLAS_TRANSPOSE trans,
+      CBLAS_INT n, CBLAS_INT k,
+      double alpha,
+      const double *A, CBLAS_INT ldA,
+      double beta,
+      double *C, CBLAS_INT ldC)
+{
+    syrk_generic(getOrder(order), getUpLo(upLo), getTranspose(trans), n, k,
+                 alpha, A, ldA, beta, C, ldC);
+}
+
+inline void
+csyrk(enum CBLAS_ORDER order, enum CBLAS_UPLO upLo,
+      enum CBLAS_TRANSPOSE trans,
+      CBLAS_INT n, CBLAS_INT k,
+      const float *alpha,
+      const float *A, CBLAS_INT ldA,
+      const float *beta,
+      float *C, CBLAS_INT ldC)
+{
+    syrk_generic(getOrder(order), getUpLo(upLo), getTranspose(trans), n, k,
+                 *cplx(alpha), cplx(A), ldA, *cplx(beta), cplx(C), ldC);
+}
+
+inline void
+zsyrk(enum CBLAS_ORDER order, enum CBLAS_UPLO upLo,
+      enum CBLAS_TRANSPOSE trans,
+      CBLAS_INT n, CBLAS_INT k,
+      const double *alpha,
+      const double *A, CBLAS_INT ldA,
+      const double *beta,
+      double *C, CBLAS_INT ldC)
+{
+    syrk_generic(getOrder(order), getUpLo(upLo), getTranspose(trans), n, k,
+                 *cplx(alpha), cplx(A), ldA, *cplx(beta), cplx(C), ldC);
+}
+
+inline void
+strsm(enum CBLAS_ORDER order, enum CBLAS_SIDE side, enum CBLAS_UPLO upLo,
+      enum CBLAS_TRANSPOSE transA, enum CBLAS_DIAG diag,
+      CBLAS_INT m, CBLAS_INT n,
+      float alpha,
+      const float *A, CBLAS_INT ldA,
+      float *B, CBLAS_INT ldB)
+{
+    trsm_generic(getOrder(order), getSide(side), getUpLo(upLo),
+                 getTranspose(transA), getDiag(diag), m, n,
+                 alpha, A, ldA, B, ldB);
+}
+
+inline void
+dtrsm(enum CBLAS_ORDER order, enum CBLAS_SIDE side, enum CBLAS_UPLO upLo,
+      enum CBLAS_TRANSPOSE transA, enum CBLAS_DIAG diag,
+      CBLAS_INT m, CBLAS_INT n,
+      double alpha,
+      const double *A, CBLAS_INT ldA,
+      double *B, CBLAS_INT ldB)
+{
+    trsm_generic(getOrder(order), getSide(side), getUpLo(upLo),
+                 getTranspose(transA), getDiag(diag), m, n,
+                 alpha, A, ldA, B, ldB);
+}
+
+inline void
+ctrsm(enum CBLAS_ORDER order, enum CBLAS_SIDE side, enum CBLAS_UPLO upLo,
+      enum CBLAS_TRANSPOSE transA, enum CBLAS_DIAG diag,
+      CBLAS_INT m, CBLAS_INT n,
+      const float *alpha,
+      const float *A, CBLAS_INT ldA,
+      float *B, CBLAS_INT ldB)
+{
+    trsm_generic(getOrder(order), getSide(side), getUpLo(upLo),
+                 getTranspose(transA), getDiag(diag), m, n,
+                 *cplx(alpha), cplx(A), ldA, cplx(B), ldB);
+}
+
+inline void
+ztrsm(enum CBLAS_ORDER order, enum CBLAS_SIDE side, enum CBLAS_UPLO upLo,
+      enum CBLAS_TRANSPOSE transA, enum CBLAS_DIAG diag,
+      CBLAS_INT m, CBLAS_INT n,
+      const double *alpha,
+      const double *A, CBLAS_INT ldA,
+      double *B, CBLAS_INT ldB)
+{
+    trsm_generic(getOrder(order), getSide(side), getUpLo(upLo),
+                 getTranspose(transA), getDiag(diag), m, n,
+                 *cplx(alpha), cplx(A), ldA, cplx(B), ldB);
+}
+
+} // namespace fallback
+
+} } // namespace dynamic, cxxblas
+
+#endif // CXXBLAS_DRIVERS_DYNAMICBLAS_TCC
@@ -52,6 +52,53 @@
 #    define BLAS_EXT(x)         cblas_##x
 #endif
 
+extern "C" {
+	/* Threading control of the MKL service layer */
+	void MKL_Set_Num_Threads(int nth);
+	int MKL_Set_Num_Threads_Local(int nth);
+	int MKL_Get_Max_Threads(void);
+}
+
+// batched gemm
+#ifndef HAVE_CBLAS_GEMM_BATCH
+#    define HAVE_CBLAS_GEMM_BATCH
+#endif
+
+// batched gemv at fixed strides
+#ifndef HAVE_CBLAS_GEMV_BATCH
+#    define HAVE_CBLAS_GEMV_BATCH
+#endif
+
+// gemm of one triangle
+#ifndef HAVE_CBLAS_GEMMT
+#    define HAVE_CBLAS_GEMMT
+#endif
+
+// complex gemm by the 3M algorithm
+#ifndef HAVE_CBLAS_GEMM3M
+#    define HAVE_CBLAS_GEMM3M
+#endif
+
+// bfloat16 gemm with float accumulation (MKL 2020 and later); the half
+// precision one needs oneMKL 2021.2 and is enabled by HAVE_CBLAS_GEMM_F16
+#ifndef HAVE_CBLAS_GEMM_BF16
+#    define HAVE_CBLAS_GEMM_BF16
+#endif
+#ifndef CBLAS_GEMM_BF16
+#    define CBLAS_GEMM_BF16     cblas_gemm_bf16bf16f32
+#endif
+#ifndef CBLAS_GEMM_F16
+#    define CBLAS_GEMM_F16      cblas_gemm_f16f16f32
+#endif
+
+// int8 x uint8 gemm with int32 accumulation (MKL 2018 and later)
+#ifndef HAVE_CBLAS_GEMM_S8U8S32
+#    define HAVE_CBLAS_GEMM_S8U8S32
+#endif
+#ifndef CBLAS_GEMM_S8U8S32
+#    define CBLAS_GEMM_S8U8S32  cblas_gemm_s8u8s32
+#endif
+
 // MKL includes LAPACK
 #ifndef USE_CXXLAPACK
 #    define USE_CXXLAPACK       1
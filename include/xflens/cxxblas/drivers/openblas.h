@@ -50,6 +50,20 @@
 #    define BLAS_EXT(x)         cblas_##x
 #endif
 
+// complex gemm by the 3M algorithm
+#ifndef HAVE_CBLAS_GEMM3M
+#    define HAVE_CBLAS_GEMM3M
+#endif
+
+// ?gemmt is only exported by OpenBLAS 0.3.27 and later: enabled by
+// HAVE_CBLAS_GEMMT
+
+// bfloat16 gemm with float accumulation, only in OpenBLAS builds with
+// BUILD_BFLOAT16: enabled by HAVE_CBLAS_GEMM_BF16
+#ifndef CBLAS_GEMM_BF16
+#    define CBLAS_GEMM_BF16     cblas_sbgemm
+#endif
+
 extern "C" {
 	/* Assume C declarations for C++ */
 
@@ -0,0 +1,218 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_DRIVERS_SUFFIX_H
+#define CXXBLAS_DRIVERS_SUFFIX_H 1
+
+//
+//  Libraries with a 64-bit integer interface may export it under suffixed
+//  symbols (e.g. cblas_dgemm64_ for OpenBLAS built with SYMBOLSUFFIX=64_,
+//  cblas_dgemm_64 for MKL), so that they can coexist with a LP64 BLAS in one
+//  process.  With CXXBLAS_SYMBOL_SUFFIX defined, the declarations in
+//  drivers/cblas.h and all call sites refer to the suffixed symbols.
+//
+
+#define CXXBLAS_SUFFIX_CAT_(f, s)       f##s
+#define CXXBLAS_SUFFIX_CAT(f, s)        CXXBLAS_SUFFIX_CAT_(f, s)
+#define CXXBLAS_SUFFIXED(f)     CXXBLAS_SUFFIX_CAT(f, CXXBLAS_SYMBOL_SUFFIX)
+
+#define cblas_sasum                CXXBLAS_SUFFIXED(cblas_sasum)
+#define cblas_dasum                CXXBLAS_SUFFIXED(cblas_dasum)
+#define cblas_scasum               CXXBLAS_SUFFIXED(cblas_scasum)
+#define cblas_dzasum               CXXBLAS_SUFFIXED(cblas_dzasum)
+#define cblas_saxpy                CXXBLAS_SUFFIXED(cblas_saxpy)
+#define cblas_daxpy                CXXBLAS_SUFFIXED(cblas_daxpy)
+#define cblas_caxpy                CXXBLAS_SUFFIXED(cblas_caxpy)
+#define cblas_zaxpy                CXXBLAS_SUFFIXED(cblas_zaxpy)
+#define cblas_scopy                CXXBLAS_SUFFIXED(cblas_scopy)
+#define cblas_dcopy                CXXBLAS_SUFFIXED(cblas_dcopy)
+#define cblas_ccopy                CXXBLAS_SUFFIXED(cblas_ccopy)
+#define cblas_zcopy                CXXBLAS_SUFFIXED(cblas_zcopy)
+#define cblas_sdsdot               CXXBLAS_SUFFIXED(cblas_sdsdot)
+#define cblas_dsdot                CXXBLAS_SUFFIXED(cblas_dsdot)
+#define cblas_sdot                 CXXBLAS_SUFFIXED(cblas_sdot)
+#define cblas_ddot                 CXXBLAS_SUFFIXED(cblas_ddot)
+#define cblas_cdotu_sub            CXXBLAS_SUFFIXED(cblas_cdotu_sub)
+#define cblas_cdotc_sub            CXXBLAS_SUFFIXED(cblas_cdotc_sub)
+#define cblas_zdotu_sub            CXXBLAS_SUFFIXED(cblas_zdotu_sub)
+#define cblas_zdotc_sub            CXXBLAS_SUFFIXED(cblas_zdotc_sub)
+#define cblas_isamax               CXXBLAS_SUFFIXED(cblas_isamax)
+#define cblas_idamax               CXXBLAS_SUFFIXED(cblas_idamax)
+#define cblas_icamax               CXXBLAS_SUFFIXED(cblas_icamax)
+#define cblas_izamax               CXXBLAS_SUFFIXED(cblas_izamax)
+#define cblas_snrm2                CXXBLAS_SUFFIXED(cblas_snrm2)
+#define cblas_dnrm2                CXXBLAS_SUFFIXED(cblas_dnrm2)
+#define cblas_scnrm2               CXXBLAS_SUFFIXED(cblas_scnrm2)
+#define cblas_dznrm2               CXXBLAS_SUFFIXED(cblas_dznrm2)
+#define cblas_srot                 CXXBLAS_SUFFIXED(cblas_srot)
+#define cblas_drot                 CXXBLAS_SUFFIXED(cblas_drot)
+#define cblas_srotg                CXXBLAS_SUFFIXED(cblas_srotg)
+#define cblas_drotg                CXXBLAS_SUFFIXED(cblas_drotg)
+#define cblas_srotm                CXXBLAS_SUFFIXED(cblas_srotm)
+#define cblas_drotm                CXXBLAS_SUFFIXED(cblas_drotm)
+#define cblas_srotmg               CXXBLAS_SUFFIXED(cblas_srotmg)
+#define cblas_drotmg               CXXBLAS_SUFFIXED(cblas_drotmg)
+#define cblas_sscal                CXXBLAS_SUFFIXED(cblas_sscal)
+#define cblas_dscal                CXXBLAS_SUFFIXED(cblas_dscal)
+#define cblas_cscal                CXXBLAS_SUFFIXED(cblas_cscal)
+#define cblas_zscal                CXXBLAS_SUFFIXED(cblas_zscal)
+#define cblas_csscal               CXXBLAS_SUFFIXED(cblas_csscal)
+#define cblas_zdscal               CXXBLAS_SUFFIXED(cblas_zdscal)
+#define cblas_sswap                CXXBLAS_SUFFIXED(cblas_sswap)
+#define cblas_dswap                CXXBLAS_SUFFIXED(cblas_dswap)
+#define cblas_cswap                CXXBLAS_SUFFIXED(cblas_cswap)
+#define cblas_zswap                CXXBLAS_SUFFIXED(cblas_zswap)
+#define cblas_sgbmv                CXXBLAS_SUFFIXED(cblas_sgbmv)
+#define cblas_dgbmv                CXXBLAS_SUFFIXED(cblas_dgbmv)
+#define cblas_cgbmv                CXXBLAS_SUFFIXED(cblas_cgbmv)
+#define cblas_zgbmv                CXXBLAS_SUFFIXED(cblas_zgbmv)
+#define cblas_sgemv                CXXBLAS_SUFFIXED(cblas_sgemv)
+#define cblas_dgemv                CXXBLAS_SUFFIXED(cblas_dgemv)
+#define cblas_cgemv                CXXBLAS_SUFFIXED(cblas_cgemv)
+#define cblas_zgemv                CXXBLAS_SUFFIXED(cblas_zgemv)
+#define cblas_sgemv_batch_strided  CXXBLAS_SUFFIXED(cblas_sgemv_batch_strided)
+#define cblas_dgemv_batch_strided  CXXBLAS_SUFFIXED(cblas_dgemv_batch_strided)
+#define cblas_cgemv_batch_strided  CXXBLAS_SUFFIXED(cblas_cgemv_batch_strided)
+#define cblas_zgemv_batch_strided  CXXBLAS_SUFFIXED(cblas_zgemv_batch_strided)
+#define cblas_ssbmv                CXXBLAS_SUFFIXED(cblas_ssbmv)
+#define cblas_dsbmv                CXXBLAS_SUFFIXED(cblas_dsbmv)
+#define cblas_ssymv                CXXBLAS_SUFFIXED(cblas_ssymv)
+#define cblas_dsymv                CXXBLAS_SUFFIXED(cblas_dsymv)
+#define cblas_sspmv                CXXBLAS_SUFFIXED(cblas_sspmv)
+#define cblas_dspmv                CXXBLAS_SUFFIXED(cblas_dspmv)
+#define cblas_chbmv                CXXBLAS_SUFFIXED(cblas_chbmv)
+#define cblas_zhbmv                CXXBLAS_SUFFIXED(cblas_zhbmv)
+#define cblas_chemv                CXXBLAS_SUFFIXED(cblas_chemv)
+#define cblas_zhemv                CXXBLAS_SUFFIXED(cblas_zhemv)
+#define cblas_chpmv                CXXBLAS_SUFFIXED(cblas_chpmv)
+#define cblas_zhpmv                CXXBLAS_SUFFIXED(cblas_zhpmv)
+#define cblas_stbsv                CXXBLAS_SUFFIXED(cblas_stbsv)
+#define cblas_dtbsv                CXXBLAS_SUFFIXED(cblas_dtbsv)
+#define cblas_ctbsv                CXXBLAS_SUFFIXED(cblas_ctbsv)
+#define cblas_ztbsv                CXXBLAS_SUFFIXED(cblas_ztbsv)
+#define cblas_strsv                CXXBLAS_SUFFIXED(cblas_strsv)
+#define cblas_dtrsv                CXXBLAS_SUFFIXED(cblas_dtrsv)
+#define cblas_ctrsv                CXXBLAS_SUFFIXED(cblas_ctrsv)
+#define cblas_ztrsv                CXXBLAS_SUFFIXED(cblas_ztrsv)
+#define cblas_stpsv                CXXBLAS_SUFFIXED(cblas_stpsv)
+#define cblas_dtpsv                CXXBLAS_SUFFIXED(cblas_dtpsv)
+#define cblas_ctpsv                CXXBLAS_SUFFIXED(cblas_ctpsv)
+#define cblas_ztpsv                CXXBLAS_SUFFIXED(cblas_ztpsv)
+#define cblas_stbmv                CXXBLAS_SUFFIXED(cblas_stbmv)
+#define cblas_dtbmv                CXXBLAS_SUFFIXED(cblas_dtbmv)
+#define cblas_ctbmv                CXXBLAS_SUFFIXED(cblas_ctbmv)
+#define cblas_ztbmv                CXXBLAS_SUFFIXED(cblas_ztbmv)
+#define cblas_strmv                CXXBLAS_SUFFIXED(cblas_strmv)
+#define cblas_dtrmv                CXXBLAS_SUFFIXED(cblas_dtrmv)
+#define cblas_ctrmv                CXXBLAS_SUFFIXED(cblas_ctrmv)
+#define cblas_ztrmv                CXXBLAS_SUFFIXED(cblas_ztrmv)
+#define cblas_stpmv                CXXBLAS_SUFFIXED(cblas_stpmv)
+#define cblas_dtpmv                CXXBLAS_SUFFIXED(cblas_dtpmv)
+#define cblas_ctpmv                CXXBLAS_SUFFIXED(cblas_ctpmv)
+#define cblas_ztpmv                CXXBLAS_SUFFIXED(cblas_ztpmv)
+#define cblas_sger                 CXXBLAS_SUFFIXED(cblas_sger)
+#define cblas_dger                 CXXBLAS_SUFFIXED(cblas_dger)
+#define cblas_cgeru                CXXBLAS_SUFFIXED(cblas_cgeru)
+#define cblas_cgerc                CXXBLAS_SUFFIXED(cblas_cgerc)
+#define cblas_zgeru                CXXBLAS_SUFFIXED(cblas_zgeru)
+#define cblas_zgerc                CXXBLAS_SUFFIXED(cblas_zgerc)
+#define cblas_ssyr                 CXXBLAS_SUFFIXED(cblas_ssyr)
+#define cblas_dsyr                 CXXBLAS_SUFFIXED(cblas_dsyr)
+#define cblas_sspr                 CXXBLAS_SUFFIXED(cblas_sspr)
+#define cblas_dspr                 CXXBLAS_SUFFIXED(cblas_dspr)
+#define cblas_cher                 CXXBLAS_SUFFIXED(cblas_cher)
+#define cblas_zher                 CXXBLAS_SUFFIXED(cblas_zher)
+#define cblas_chpr                 CXXBLAS_SUFFIXED(cblas_chpr)
+#define cblas_zhpr                 CXXBLAS_SUFFIXED(cblas_zhpr)
+#define cblas_sspr2                CXXBLAS_SUFFIXED(cblas_sspr2)
+#define cblas_dspr2                CXXBLAS_SUFFIXED(cblas_dspr2)
+#define cblas_ssyr2                CXXBLAS_SUFFIXED(cblas_ssyr2)
+#define cblas_dsyr2                CXXBLAS_SUFFIXED(cblas_dsyr2)
+#define cblas_cher2                CXXBLAS_SUFFIXED(cblas_cher2)
+#define cblas_zher2                CXXBLAS_SUFFIXED(cblas_zher2)
+#define cblas_chpr2                CXXBLAS_SUFFIXED(cblas_chpr2)
+#define cblas_zhpr2                CXXBLAS_SUFFIXED(cblas_zhpr2)
+#define cblas_sgemm                CXXBLAS_SUFFIXED(cblas_sgemm)
+#define cblas_dgemm                CXXBLAS_SUFFIXED(cblas_dgemm)
+#define cblas_cgemm                CXXBLAS_SUFFIXED(cblas_cgemm)
+#define cblas_zgemm                CXXBLAS_SUFFIXED(cblas_zgemm)
+#define cblas_sgemm_batch          CXXBLAS_SUFFIXED(cblas_sgemm_batch)
+#define cblas_dgemm_batch          CXXBLAS_SUFFIXED(cblas_dgemm_batch)
+#define cblas_cgemm_batch          CXXBLAS_SUFFIXED(cblas_cgemm_batch)
+#define cblas_zgemm_batch          CXXBLAS_SUFFIXED(cblas_zgemm_batch)
+#define cblas_cgemm3m              CXXBLAS_SUFFIXED(cblas_cgemm3m)
+#define cblas_zgemm3m              CXXBLAS_SUFFIXED(cblas_zgemm3m)
+#define cblas_sgemmt              CXXBLAS_SUFFIXED(cblas_sgemmt)
+#define cblas_dgemmt              CXXBLAS_SUFFIXED(cblas_dgemmt)
+#define cblas_cgemmt              CXXBLAS_SUFFIXED(cblas_cgemmt)
+#define cblas_zgemmt              CXXBLAS_SUFFIXED(cblas_zgemmt)
+#define cblas_sbgemm               CXXBLAS_SUFFIXED(cblas_sbgemm)
+#define cblas_gemm_bf16bf16f32     CXXBLAS_SUFFIXED(cblas_gemm_bf16bf16f32)
+#define cblas_gemm_f16f16f32       CXXBLAS_SUFFIXED(cblas_gemm_f16f16f32)
+#define cblas_gemm_s8u8s32         CXXBLAS_SUFFIXED(cblas_gemm_s8u8s32)
+#define cblas_chemm                CXXBLAS_SUFFIXED(cblas_chemm)
+#define cblas_zhemm                CXXBLAS_SUFFIXED(cblas_zhemm)
+#define cblas_cherk                CXXBLAS_SUFFIXED(cblas_cherk)
+#define cblas_zherk                CXXBLAS_SUFFIXED(cblas_zherk)
+#define cblas_cher2k               CXXBLAS_SUFFIXED(cblas_cher2k)
+#define cblas_zher2k               CXXBLAS_SUFFIXED(cblas_zher2k)
+#define cblas_ssymm                CXXBLAS_SUFFIXED(cblas_ssymm)
+#define cblas_dsymm                CXXBLAS_SUFFIXED(cblas_dsymm)
+#define cblas_csymm                CXXBLAS_SUFFIXED(cblas_csymm)
+#define cblas_zsymm                CXXBLAS_SUFFIXED(cblas_zsymm)
+#define cblas_ssyrk                CXXBLAS_SUFFIXED(cblas_ssyrk)
+#define cblas_dsyrk                CXXBLAS_SUFFIXED(cblas_dsyrk)
+#define cblas_csyrk                CXXBLAS_SUFFIXED(cblas_csyrk)
+#define cblas_zsyrk                CXXBLAS_SUFFIXED(cblas_zsyrk)
+#define cblas_ssyr2k               CXXBLAS_SUFFIXED(cblas_ssyr2k)
+#define cblas_dsyr2k               CXXBLAS_SUFFIXED(cblas_dsyr2k)
+#define cblas_csyr2k               CXXBLAS_SUFFIXED(cblas_csyr2k)
+#define cblas_zsyr2k               CXXBLAS_SUFFIXED(cblas_zsyr2k)
+#define cblas_strmm                CXXBLAS_SUFFIXED(cblas_strmm)
+#define cblas_dtrmm                CXXBLAS_SUFFIXED(cblas_dtrmm)
+#define cblas_ctrmm                CXXBLAS_SUFFIXED(cblas_ctrmm)
+#define cblas_ztrmm                CXXBLAS_SUFFIXED(cblas_ztrmm)
+#define cblas_strsm                CXXBLAS_SUFFIXED(cblas_strsm)
+#define cblas_dtrsm                CXXBLAS_SUFFIXED(cblas_dtrsm)
+#define cblas_ctrsm                CXXBLAS_SUFFIXED(cblas_ctrsm)
+#define cblas_ztrsm                CXXBLAS_SUFFIXED(cblas_ztrsm)
+
+// OpenBLAS suffixes its own extensions as well
+#define openblas_set_num_threads   CXXBLAS_SUFFIXED(openblas_set_num_threads)
+#define goto_set_num_threads       CXXBLAS_SUFFIXED(goto_set_num_threads)
+#define openblas_get_num_threads   CXXBLAS_SUFFIXED(openblas_get_num_threads)
+#define openblas_get_num_procs     CXXBLAS_SUFFIXED(openblas_get_num_procs)
+#define openblas_get_config        CXXBLAS_SUFFIXED(openblas_get_config)
+#define openblas_get_corename      CXXBLAS_SUFFIXED(openblas_get_corename)
+#define openblas_get_parallel      CXXBLAS_SUFFIXED(openblas_get_parallel)
+
+#endif // CXXBLAS_DRIVERS_SUFFIX_H
@@ -34,11 +34,59 @@
 #define CXXBLAS_LEVEL1_ASUM_TCC 1
 
 #include <cmath>
+#include <complex>
+#include <type_traits>
 #include "xflens/cxxblas/cxxblas.h"
 
 
 namespace cxxblas {
 
+//
+//  Unit stride kernels: a complex vector is summed as 2n reals, with
+//  independent partial sums so that the reduction can be vectorized.
+//
+template <typename IndexType, typename X, typename T>
+bool
+asum_unit_stride(IndexType, const X *, T &)
+{
+    return false;
+}
+
+template <typename IndexType, typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+asum_unit_stride(IndexType n, const T *x, T &absSum)
+{
+    using std::abs;
+
+    const IndexType L = 8;
+    T acc[L];
+    for (IndexType l=0; l<L; ++l) {
+        acc[l] = T(0);
+    }
+    IndexType i = 0;
+    for (; i+L<=n; i+=L) {
+        for (IndexType l=0; l<L; ++l) {
+            acc[l] += abs(x[i+l]);
+        }
+    }
+    T sum(0);
+    for (; i<n; ++i) {
+        sum += abs(x[i]);
+    }
+    for (IndexType l=0; l<L; ++l) {
+        sum += acc[l];
+    }
+    absSum = sum;
+    return true;
+}
+
+template <typename IndexType, typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+asum_unit_stride(IndexType n, const std::complex<T> *x, T &absSum)
+{
+    return asum_unit_stride(2*n, reinterpret_cast<const T *>(x), absSum);
+}
+
 template <typename IndexType, typename X, typename T>
 void
 asum_generic(IndexType n, const X *x, IndexType incX, T &absSum)
@@ -47,6 +95,9 @@ asum_generic(IndexType n, const X *x, IndexType incX, T &absSum)
 
     using std::abs;
 
+    if ((incX==1) && asum_unit_stride(n, x, absSum)) {
+        return;
+    }
     absSum = 0;
     for (IndexType i=0; i<n; ++i, x+=incX) {
         absSum += abs(cxxblas::real(*x)) + abs(cxxblas::imag(*x));
@@ -45,6 +45,12 @@ axpy_generic(IndexType n, const ALPHA &alpha, const X *x,
 {
     CXXBLAS_DEBUG_OUT("axpy_generic");
 
+    if ((incX==1) && (incY==1)) {
+        for (IndexType i=0; i<n; ++i) {
+            y[i] += alpha*x[i];
+        }
+        return;
+    }
     for (IndexType i=0, iX=0, iY=0; i<n; ++i, iX+=incX, iY+=incY) {
         y[iY] += alpha*x[iX];
     }
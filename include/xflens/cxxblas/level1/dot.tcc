@@ -33,10 +33,124 @@
 #ifndef CXXBLAS_LEVEL1_DOT_TCC
 #define CXXBLAS_LEVEL1_DOT_TCC 1
 
+#include <complex>
+#include <type_traits>
 #include "xflens/cxxblas/cxxblas.h"
 
 namespace cxxblas {
 
+//
+//  Unit stride kernels: independent partial sums break the dependency on a
+//  single accumulator so that the compiler can vectorize the reduction.
+//
+template <typename IndexType, typename X, typename Y, typename Result>
+bool
+dot_unit_stride(IndexType, const X *, const Y *, Result &, bool)
+{
+    return false;
+}
+
+template <int L, typename IndexType, typename T>
+CXXBLAS_ALWAYS_INLINE T
+dot_unit_stride_real(IndexType n, const T *x, const T *y)
+{
+    T acc[L];
+    for (IndexType l=0; l<L; ++l) {
+        acc[l] = T(0);
+    }
+    IndexType i = 0;
+    for (; i+L<=n; i+=L) {
+        for (IndexType l=0; l<L; ++l) {
+            acc[l] += x[i+l]*y[i+l];
+        }
+    }
+    T sum(0);
+    for (; i<n; ++i) {
+        sum += x[i]*y[i];
+    }
+    for (IndexType l=0; l<L; ++l) {
+        sum += acc[l];
+    }
+    return sum;
+}
+
+#if defined(CXXBLAS_CPU_DISPATCH)
+
+// four vectors of partial sums for the instruction sets selected at runtime
+template <typename IndexType, typename T>
+CXXBLAS_TARGET_AVX2 T
+dot_unit_stride_avx2(IndexType n, const T *x, const T *y)
+{
+    return dot_unit_stride_real<int(128/sizeof(T))>(n, x, y);
+}
+
+template <typename IndexType, typename T>
+CXXBLAS_TARGET_AVX512 T
+dot_unit_stride_avx512(IndexType n, const T *x, const T *y)
+{
+    return dot_unit_stride_real<int(256/sizeof(T))>(n, x, y);
+}
+
+#endif
+
+template <typename IndexType, typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+dot_unit_stride(IndexType n, const T *x, const T *y, T &result, bool)
+{
+#if defined(CXXBLAS_CPU_DISPATCH)
+    switch (cpu_level()) {
+        case CpuAvx512:
+            result = dot_unit_stride_avx512(n, x, y);
+            return true;
+        case CpuAvx2:
+            result = dot_unit_stride_avx2(n, x, y);
+            return true;
+        default:
+            break;
+    }
+#endif
+    result = dot_unit_stride_real<8>(n, x, y);
+    return true;
+}
+
+template <typename IndexType, typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+dot_unit_stride(IndexType n, const std::complex<T> *x_,
+                const std::complex<T> *y_, std::complex<T> &result,
+                bool conjX)
+{
+    const IndexType L = 4;
+    const T *x = reinterpret_cast<const T *>(x_);
+    const T *y = reinterpret_cast<const T *>(y_);
+    const T s = conjX ? T(-1) : T(1);
+    T re[L], im[L];
+    for (IndexType l=0; l<L; ++l) {
+        re[l] = im[l] = T(0);
+    }
+    IndexType i = 0;
+    for (; i+L<=n; i+=L) {
+        for (IndexType l=0; l<L; ++l) {
+            const T xr = x[2*(i+l)], xi = s*x[2*(i+l)+1];
+            const T yr = y[2*(i+l)], yi = y[2*(i+l)+1];
+            re[l] += xr*yr - xi*yi;
+            im[l] += xr*yi + xi*yr;
+        }
+    }
+    T sumRe(0), sumIm(0);
+    for (; i<n; ++i) {
+        const T xr = x[2*i], xi = s*x[2*i+1];
+        const T yr = y[2*i], yi = y[2*i+1];
+        sumRe += xr*yr - xi*yi;
+        sumIm += xr*yi + xi*yr;
+    }
+    for (IndexType l=0; l<L; ++l) {
+        sumRe += re[l];
+        sumIm += im[l];
+    }
+    result = std::complex<T>(sumRe, sumIm);
+    return true;
+}
+
 template <typename IndexType, typename X, typename Y, typename Result>
 void
 dotu_generic(IndexType n,
@@ -45,6 +159,9 @@ dotu_generic(IndexType n,
 {
     CXXBLAS_DEBUG_OUT("dotu_generic");
 
+    if ((incX==1) && (incY==1) && dot_unit_stride(n, x, y, result, false)) {
+        return;
+    }
     result = Result(0);
     for (IndexType i=0, iX=0, iY=0; i<n; ++i, iX+=incX, iY+=incY) {
         result += Result(x[iX])*Result(y[iY]);
@@ -60,6 +177,9 @@ dot_generic(IndexType n,
 {
     CXXBLAS_DEBUG_OUT("dot_generic");
 
+    if ((incX==1) && (incY==1) && dot_unit_stride(n, x, y, result, true)) {
+        return;
+    }
     result = Result(0);
     for (IndexType i=0, iX=0, iY=0; i<n; ++i, iX+=incX, iY+=incY) {
         result += Result(conjugate(x[iX]))*Result(y[iY]);
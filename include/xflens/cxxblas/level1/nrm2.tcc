@@ -33,10 +33,64 @@
 #ifndef CXXBLAS_LEVEL1_NRM2_TCC
 #define CXXBLAS_LEVEL1_NRM2_TCC 1
 
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <type_traits>
 #include "xflens/cxxblas/cxxblas.h"
 
 namespace cxxblas {
 
+//
+//  Unit stride kernels: the plain sum of squares is accumulated in
+//  independent partial sums and accepted if it neither overflowed nor came
+//  close to underflow. Otherwise the scaled (DLASSQ) loop below is used.
+//
+template <typename IndexType, typename X, typename T>
+bool
+nrm2_unit_stride(IndexType, const X *, T &)
+{
+    return false;
+}
+
+template <typename IndexType, typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+nrm2_unit_stride(IndexType n, const T *x, T &norm)
+{
+    const IndexType L = 8;
+    T acc[L];
+    for (IndexType l=0; l<L; ++l) {
+        acc[l] = T(0);
+    }
+    IndexType i = 0;
+    for (; i+L<=n; i+=L) {
+        for (IndexType l=0; l<L; ++l) {
+            acc[l] += x[i+l]*x[i+l];
+        }
+    }
+    T ssq(0);
+    for (; i<n; ++i) {
+        ssq += x[i]*x[i];
+    }
+    for (IndexType l=0; l<L; ++l) {
+        ssq += acc[l];
+    }
+    const T tiny = std::numeric_limits<T>::min()
+                 / std::numeric_limits<T>::epsilon();
+    if (!(ssq>=tiny && ssq<=std::numeric_limits<T>::max())) {
+        return false;
+    }
+    norm = std::sqrt(ssq);
+    return true;
+}
+
+template <typename IndexType, typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+nrm2_unit_stride(IndexType n, const std::complex<T> *x, T &norm)
+{
+    return nrm2_unit_stride(2*n, reinterpret_cast<const T *>(x), norm);
+}
+
 template <typename IndexType, typename X, typename T>
 void
 nrm2_generic(IndexType n, const X *x, IndexType incX, T &norm)
@@ -53,6 +107,8 @@ nrm2_generic(IndexType n, const X *x, IndexType incX, T &norm)
         norm = Zero;
     } else if (n==1) {
         norm = abs(*x);
+    } else if ((incX==1) && nrm2_unit_stride(n, x, norm)) {
+        return;
     } else {
         T scale = 0;
         T ssq = 1;
@@ -93,6 +149,8 @@ nrm2_generic(IndexType n, const std::complex<X> *x, IndexType incX, T &norm)
         norm = Zero;
     } else if (n==1) {
         norm = abs(*x);
+    } else if ((incX==1) && nrm2_unit_stride(n, x, norm)) {
+        return;
     } else {
         T scale = 0;
         T ssq = 1;
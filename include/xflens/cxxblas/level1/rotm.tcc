@@ -68,7 +68,7 @@ rotmg(T &d1, T &d2, T &b1, T &b2, T *p)
 {
     CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_srotmg");
 
-    cblas_srotmg(&d1, &d2, &b1, &b2, p);
+    cblas_srotmg(&d1, &d2, &b1, b2, p);
 }
 
 // drotg
@@ -78,7 +78,7 @@ rotmg(T &d1, T &d2, T &b1, T &b2, T *p)
 {
     CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_drotmg");
 
-    cblas_drotmg(&d1, &d2, &b1, &b2, p);
+    cblas_drotmg(&d1, &d2, &b1, b2, p);
 }
 
 #endif // HAVE_CBLAS
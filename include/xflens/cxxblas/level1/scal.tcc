@@ -43,6 +43,12 @@ scal_generic(IndexType n, const ALPHA &alpha, Y *y, IndexType incY)
 {
     CXXBLAS_DEBUG_OUT("scal_generic");
 
+    if (incY==1) {
+        for (IndexType i=0; i<n; ++i) {
+            y[i] *= alpha;
+        }
+        return;
+    }
     for (IndexType i=0, iY=0; i<n; ++i, iY+=incY) {
         y[iY] *= alpha;
     }
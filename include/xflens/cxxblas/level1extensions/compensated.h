@@ -0,0 +1,101 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL1EXTENSIONS_COMPENSATED_H
+#define CXXBLAS_LEVEL1EXTENSIONS_COMPENSATED_H 1
+
+#include <complex>
+#include "xflens/cxxblas/typedefs.h"
+#include "xflens/cxxblas/drivers/drivers.h"
+
+#define HAVE_CXXBLAS_COMPENSATED 1
+
+//
+//  Compensated dot products, sums and 2-norms (Ogita, Rump and Oishi's Dot2
+//  and Sum2): the rounding error of every product and addition is computed
+//  exactly by error-free transformations and accumulated separately, so the
+//  result is as accurate as if it was computed in twice the working
+//  precision and then rounded. Several lanes of partial sums vectorize the
+//  unit stride loops; with CXXBLAS_CPU_DISPATCH the dot kernel also runs
+//  with AVX2 and AVX-512 and its exact products use FMA. The error-free
+//  transformations need IEEE arithmetic: do not compile with -ffast-math.
+//
+
+namespace cxxblas {
+
+template <typename IndexType, typename T>
+    void
+    dot_compensated(IndexType n,
+                    const T *x, IndexType incX, const T *y, IndexType incY,
+                    T &result);
+
+template <typename IndexType, typename T>
+    void
+    dot_compensated(IndexType n,
+                    const std::complex<T> *x, IndexType incX,
+                    const std::complex<T> *y, IndexType incY,
+                    std::complex<T> &result);
+
+template <typename IndexType, typename T>
+    void
+    dotu_compensated(IndexType n,
+                     const T *x, IndexType incX, const T *y, IndexType incY,
+                     T &result);
+
+template <typename IndexType, typename T>
+    void
+    dotu_compensated(IndexType n,
+                     const std::complex<T> *x, IndexType incX,
+                     const std::complex<T> *y, IndexType incY,
+                     std::complex<T> &result);
+
+template <typename IndexType, typename T>
+    void
+    sum_compensated(IndexType n, const T *x, IndexType incX, T &result);
+
+template <typename IndexType, typename T>
+    void
+    sum_compensated(IndexType n, const std::complex<T> *x, IndexType incX,
+                    std::complex<T> &result);
+
+template <typename IndexType, typename T>
+    void
+    nrm2_compensated(IndexType n, const T *x, IndexType incX, T &result);
+
+template <typename IndexType, typename T>
+    void
+    nrm2_compensated(IndexType n, const std::complex<T> *x, IndexType incX,
+                     T &result);
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL1EXTENSIONS_COMPENSATED_H
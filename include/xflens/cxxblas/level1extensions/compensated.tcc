@@ -0,0 +1,430 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL1EXTENSIONS_COMPENSATED_TCC
+#define CXXBLAS_LEVEL1EXTENSIONS_COMPENSATED_TCC 1
+
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <type_traits>
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+// hardware FMA in the baseline of the build
+template <typename T>
+struct CompensatedFastFma : std::false_type
+{
+};
+
+#if defined(FP_FAST_FMA)
+template <>
+struct CompensatedFastFma<double> : std::true_type
+{
+};
+#endif
+
+#if defined(FP_FAST_FMAF)
+template <>
+struct CompensatedFastFma<float> : std::true_type
+{
+};
+#endif
+
+// a + b = s + e exactly
+template <typename T>
+CXXBLAS_ALWAYS_INLINE void
+two_sum(T a, T b, T &s, T &e)
+{
+    s = a + b;
+    const T z = s - a;
+    e = (a - (s - z)) + (b - z);
+}
+
+// a*b = p + e exactly, by FMA or by Dekker's product of Veltkamp's halves
+template <bool UseFma, typename T>
+CXXBLAS_ALWAYS_INLINE void
+two_prod(T a, T b, T &p, T &e)
+{
+    p = a*b;
+    if (UseFma) {
+        e = std::fma(a, b, -p);
+    } else {
+        const T factor = std::ldexp(T(1), (std::numeric_limits<T>::digits+1)/2)
+                       + T(1);
+        const T ca = factor*a, cb = factor*b;
+        const T ah = ca - (ca - a), al = a - ah;
+        const T bh = cb - (cb - b), bl = b - bh;
+        e = ((ah*bh - p) + ah*bl + al*bh) + al*bl;
+    }
+}
+
+// (hi, lo) := (hi, lo) + (h, l), the sum of two compensated results
+template <typename T>
+CXXBLAS_ALWAYS_INLINE void
+compensated_add(T &hi, T &lo, T h, T l)
+{
+    T s, e;
+    two_sum(hi, h, s, e);
+    hi = s;
+    lo += e + l;
+}
+
+//
+//  hi + lo = sum of (scale*x[i])*(scale*y[i]) with the products and the
+//  additions of each of the L lanes made exact; scale is a power of two.
+//  Inlined with unit increments, the lanes are vectorized.
+//
+template <int L, bool UseFma, typename IndexType, typename T>
+CXXBLAS_ALWAYS_INLINE void
+dot_compensated_kernel(IndexType n,
+                       const T *x, IndexType incX, const T *y, IndexType incY,
+                       T scale, T &hi, T &lo)
+{
+    T s[L], c[L];
+    for (int l=0; l<L; ++l) {
+        s[l] = c[l] = T(0);
+    }
+    IndexType i = 0;
+    for (; i+L<=n; i+=L) {
+        for (int l=0; l<L; ++l) {
+            T p, ep, t, es;
+            two_prod<UseFma>(scale*x[(i+l)*incX], scale*y[(i+l)*incY], p, ep);
+            two_sum(s[l], p, t, es);
+            s[l] = t;
+            c[l] += es + ep;
+        }
+    }
+    for (; i<n; ++i) {
+        T p, ep, t, es;
+        two_prod<UseFma>(scale*x[i*incX], scale*y[i*incY], p, ep);
+        two_sum(s[0], p, t, es);
+        s[0] = t;
+        c[0] += es + ep;
+    }
+    hi = lo = T(0);
+    for (int l=0; l<L; ++l) {
+        compensated_add(hi, lo, s[l], c[l]);
+    }
+}
+
+#if defined(CXXBLAS_CPU_DISPATCH)
+
+template <typename IndexType, typename T>
+CXXBLAS_TARGET_AVX2 void
+dot_compensated_avx2(IndexType n, const T *x, const T *y, T scale,
+                     T &hi, T &lo)
+{
+    dot_compensated_kernel<int(64/sizeof(T)), true>(n, x, IndexType(1),
+                                                    y, IndexType(1),
+                                                    scale, hi, lo);
+}
+
+template <typename IndexType, typename T>
+CXXBLAS_TARGET_AVX512 void
+dot_compensated_avx512(IndexType n, const T *x, const T *y, T scale,
+                       T &hi, T &lo)
+{
+    dot_compensated_kernel<int(128/sizeof(T)), true>(n, x, IndexType(1),
+                                                     y, IndexType(1),
+                                                     scale, hi, lo);
+}
+
+#endif
+
+// nonnegative increments
+template <typename IndexType, typename T>
+void
+dot_compensated_parts(IndexType n,
+                      const T *x, IndexType incX, const T *y, IndexType incY,
+                      T scale, T &hi, T &lo)
+{
+    if ((incX==1) && (incY==1)) {
+#if defined(CXXBLAS_CPU_DISPATCH)
+        switch (cpu_level()) {
+            case CpuAvx512:
+                dot_compensated_avx512(n, x, y, scale, hi, lo);
+                return;
+            case CpuAvx2:
+                dot_compensated_avx2(n, x, y, scale, hi, lo);
+                return;
+            default:
+                break;
+        }
+#endif
+        dot_compensated_kernel<8, CompensatedFastFma<T>::value>(
+            n, x, IndexType(1), y, IndexType(1), scale, hi, lo);
+        return;
+    }
+    dot_compensated_kernel<1, CompensatedFastFma<T>::value>(
+        n, x, incX, y, incY, scale, hi, lo);
+}
+
+// the real and imaginary parts of a complex vector are real vectors of
+// twice its increment
+template <typename IndexType, typename T>
+void
+dot_compensated_complex(IndexType n,
+                        const std::complex<T> *x_, IndexType incX,
+                        const std::complex<T> *y_, IndexType incY,
+                        bool conjX, std::complex<T> &result)
+{
+    if (incX<0) {
+        x_ -= incX*(n-1);
+        incX = -incX;
+    }
+    if (incY<0) {
+        y_ -= incY*(n-1);
+        incY = -incY;
+    }
+    const T *x = reinterpret_cast<const T *>(x_);
+    const T *y = reinterpret_cast<const T *>(y_);
+    const T s = conjX ? T(1) : T(-1);
+
+    T re, reLo, im, imLo, h, l;
+    dot_compensated_parts(n, x, 2*incX, y, 2*incY, T(1), re, reLo);
+    dot_compensated_parts(n, x+1, 2*incX, y+1, 2*incY, T(1), h, l);
+    compensated_add(re, reLo, s*h, s*l);
+    dot_compensated_parts(n, x, 2*incX, y+1, 2*incY, T(1), im, imLo);
+    dot_compensated_parts(n, x+1, 2*incX, y, 2*incY, T(1), h, l);
+    compensated_add(im, imLo, -s*h, -s*l);
+    result = std::complex<T>(re + reLo, im + imLo);
+}
+
+template <typename IndexType, typename T>
+void
+dot_compensated(IndexType n,
+                const T *x, IndexType incX, const T *y, IndexType incY,
+                T &result)
+{
+    CXXBLAS_DEBUG_OUT("dot_compensated");
+
+    if (incX<0) {
+        x -= incX*(n-1);
+        incX = -incX;
+    }
+    if (incY<0) {
+        y -= incY*(n-1);
+        incY = -incY;
+    }
+    T hi, lo;
+    dot_compensated_parts(n, x, incX, y, incY, T(1), hi, lo);
+    result = hi + lo;
+}
+
+template <typename IndexType, typename T>
+void
+dot_compensated(IndexType n,
+                const std::complex<T> *x, IndexType incX,
+                const std::complex<T> *y, IndexType incY,
+                std::complex<T> &result)
+{
+    CXXBLAS_DEBUG_OUT("dot_compensated");
+
+    dot_compensated_complex(n, x, incX, y, incY, true, result);
+}
+
+template <typename IndexType, typename T>
+void
+dotu_compensated(IndexType n,
+                 const T *x, IndexType incX, const T *y, IndexType incY,
+                 T &result)
+{
+    dot_compensated(n, x, incX, y, incY, result);
+}
+
+template <typename IndexType, typename T>
+void
+dotu_compensated(IndexType n,
+                 const std::complex<T> *x, IndexType incX,
+                 const std::complex<T> *y, IndexType incY,
+                 std::complex<T> &result)
+{
+    CXXBLAS_DEBUG_OUT("dotu_compensated");
+
+    dot_compensated_complex(n, x, incX, y, incY, false, result);
+}
+
+// hi + lo = sum of x[i*incX], incX >= 0
+template <int L, typename IndexType, typename T>
+CXXBLAS_ALWAYS_INLINE void
+sum_compensated_kernel(IndexType n, const T *x, IndexType incX,
+                       T &hi, T &lo)
+{
+    T s[L], c[L];
+    for (int l=0; l<L; ++l) {
+        s[l] = c[l] = T(0);
+    }
+    IndexType i = 0;
+    for (; i+L<=n; i+=L) {
+        for (int l=0; l<L; ++l) {
+            T t, e;
+            two_sum(s[l], x[(i+l)*incX], t, e);
+            s[l] = t;
+            c[l] += e;
+        }
+    }
+    for (; i<n; ++i) {
+        T t, e;
+        two_sum(s[0], x[i*incX], t, e);
+        s[0] = t;
+        c[0] += e;
+    }
+    hi = lo = T(0);
+    for (int l=0; l<L; ++l) {
+        compensated_add(hi, lo, s[l], c[l]);
+    }
+}
+
+template <typename IndexType, typename T>
+void
+sum_compensated_parts(IndexType n, const T *x, IndexType incX, T &hi, T &lo)
+{
+    if (incX==1) {
+        sum_compensated_kernel<16>(n, x, IndexType(1), hi, lo);
+    } else {
+        sum_compensated_kernel<1>(n, x, incX, hi, lo);
+    }
+}
+
+template <typename IndexType, typename T>
+void
+sum_compensated(IndexType n, const T *x, IndexType incX, T &result)
+{
+    CXXBLAS_DEBUG_OUT("sum_compensated");
+
+    if (incX<0) {
+        x -= incX*(n-1);
+        incX = -incX;
+    }
+    T hi, lo;
+    sum_compensated_parts(n, x, incX, hi, lo);
+    result = hi + lo;
+}
+
+template <typename IndexType, typename T>
+void
+sum_compensated(IndexType n, const std::complex<T> *x_, IndexType incX,
+                std::complex<T> &result)
+{
+    CXXBLAS_DEBUG_OUT("sum_compensated");
+
+    if (incX<0) {
+        x_ -= incX*(n-1);
+        incX = -incX;
+    }
+    const T *x = reinterpret_cast<const T *>(x_);
+    T re, reLo, im, imLo;
+    sum_compensated_parts(n, x, 2*incX, re, reLo);
+    sum_compensated_parts(n, x+1, 2*incX, im, imLo);
+    result = std::complex<T>(re + reLo, im + imLo);
+}
+
+//
+//  The elements are scaled by the power of two that brings the largest
+//  one into [0.5, 1), which is exact, so that the compensated sum of
+//  squares neither overflows nor underflows; its square root is refined
+//  by one Newton step on hi + lo.
+//
+template <typename IndexType, typename T>
+void
+nrm2_compensated_parts(IndexType n, const T *x, IndexType incX,
+                       IndexType parts, T &result)
+{
+    const IndexType len = n*parts;
+    const IndexType inc = (parts==1) ? incX : IndexType(1);
+    T amax(0);
+    for (IndexType k=0; k<n; ++k) {
+        for (IndexType q=0; q<parts; ++q) {
+            const T a = std::abs(x[k*incX*parts+q]);
+            if (std::isnan(a)) {
+                result = a;
+                return;
+            }
+            amax = std::max(amax, a);
+        }
+    }
+    if ((amax==T(0)) || std::isinf(amax)) {
+        result = amax;
+        return;
+    }
+    int exponent;
+    std::frexp(amax, &exponent);
+    const T scale = std::ldexp(T(1), -exponent);
+
+    T hi, lo;
+    if ((parts==1) || (incX==1)) {
+        dot_compensated_parts(len, x, inc, x, inc, scale, hi, lo);
+    } else {
+        T h, l;
+        dot_compensated_parts(n, x, parts*incX, x, parts*incX, scale, hi, lo);
+        dot_compensated_parts(n, x+1, parts*incX, x+1, parts*incX, scale, h, l);
+        compensated_add(hi, lo, h, l);
+    }
+    const T r = std::sqrt(hi);
+    T p, e;
+    two_prod<CompensatedFastFma<T>::value>(r, r, p, e);
+    result = (r + (((hi - p) - e) + lo)/(T(2)*r))/scale;
+}
+
+template <typename IndexType, typename T>
+void
+nrm2_compensated(IndexType n, const T *x, IndexType incX, T &result)
+{
+    CXXBLAS_DEBUG_OUT("nrm2_compensated");
+
+    if (incX<0) {
+        x -= incX*(n-1);
+        incX = -incX;
+    }
+    nrm2_compensated_parts(n, x, incX, IndexType(1), result);
+}
+
+template <typename IndexType, typename T>
+void
+nrm2_compensated(IndexType n, const std::complex<T> *x, IndexType incX,
+                 T &result)
+{
+    CXXBLAS_DEBUG_OUT("nrm2_compensated");
+
+    if (incX<0) {
+        x -= incX*(n-1);
+        incX = -incX;
+    }
+    nrm2_compensated_parts(n, reinterpret_cast<const T *>(x), incX,
+                           IndexType(2), result);
+}
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL1EXTENSIONS_COMPENSATED_TCC
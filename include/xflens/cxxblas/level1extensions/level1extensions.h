@@ -39,6 +39,7 @@
 #include "xflens/cxxblas/level1extensions/axpby.h"
 #include "xflens/cxxblas/level1extensions/axpy.h"
 #include "xflens/cxxblas/level1extensions/ccopy.h"
+#include "xflens/cxxblas/level1extensions/compensated.h"
 #include "xflens/cxxblas/level1extensions/dot.h"
 #include "xflens/cxxblas/level1extensions/gbaxpby.h"
 #include "xflens/cxxblas/level1extensions/gbaxpy.h"
@@ -39,6 +39,7 @@
 #include "xflens/cxxblas/level1extensions/axpby.tcc"
 #include "xflens/cxxblas/level1extensions/axpy.tcc"
 #include "xflens/cxxblas/level1extensions/ccopy.tcc"
+#include "xflens/cxxblas/level1extensions/compensated.tcc"
 #include "xflens/cxxblas/level1extensions/dot.tcc"
 #include "xflens/cxxblas/level1extensions/gbaxpby.tcc"
 #include "xflens/cxxblas/level1extensions/gbaxpy.tcc"
@@ -38,6 +38,38 @@
 
 namespace cxxblas {
 
+//
+//  y += alpha*A^T*x for row major A and unit stride y: four rows of A are
+//  combined per sweep over y, so that the inner loop has unit stride and
+//  y is loaded and stored a quarter as often as with one axpy per row.
+//
+template <typename IndexType, typename ALPHA, typename MA, typename VX,
+          typename VY>
+void
+gemv_trans_unit_stride(IndexType m, IndexType n,
+                       const ALPHA &alpha,
+                       const MA *A, IndexType ldA,
+                       const VX *x, IndexType incX,
+                       VY *y)
+{
+    CXXBLAS_DEBUG_OUT("gemv_trans_unit_stride");
+
+    IndexType i = 0;
+    for (; i+4<=m; i+=4) {
+        const VY a0 = alpha*x[(i+0)*incX], a1 = alpha*x[(i+1)*incX];
+        const VY a2 = alpha*x[(i+2)*incX], a3 = alpha*x[(i+3)*incX];
+        const MA *A0 = A+(i+0)*ldA, *A1 = A+(i+1)*ldA;
+        const MA *A2 = A+(i+2)*ldA, *A3 = A+(i+3)*ldA;
+        for (IndexType j=0; j<n; ++j) {
+            y[j] += a0*A0[j] + a1*A1[j] + a2*A2[j] + a3*A3[j];
+        }
+    }
+    for (; i<m; ++i) {
+        const VY a = alpha*x[i*incX];
+        axpy_generic(n, a, A+i*ldA, IndexType(1), y, IndexType(1));
+    }
+}
+
 template <typename IndexType, typename ALPHA, typename MA, typename VX,
           typename BETA, typename VY>
 void
@@ -101,6 +133,10 @@ gemv_generic(StorageOrder order, Transpose transA, Transpose conjX,
         }
 
         scal_init_generic(n, beta, y, incY);
+        if ((conjX==NoTrans) && (transA==Trans) && (incY==1)) {
+            gemv_trans_unit_stride(m, n, alpha, A, ldA, x, incX, y);
+            return;
+        }
         if (conjX==NoTrans) {
             if (transA==ConjTrans) {
                 for (IndexType i=0, iY=0; i<n; ++i, iY+=incY) {
@@ -0,0 +1,116 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL2EXTENSIONS_GEMV_BATCH_H
+#define CXXBLAS_LEVEL2EXTENSIONS_GEMV_BATCH_H 1
+
+#include "xflens/cxxblas/drivers/drivers.h"
+#include "xflens/cxxblas/typedefs.h"
+
+#define HAVE_CXXBLAS_GEMV_BATCH 1
+
+namespace cxxblas {
+
+//
+//  y[i] := alpha * op(A[i]) * x[i] + beta * y[i]   for i = 0, ..., batchCount-1
+//
+//  where A[i] = A + i*strideA, x[i] = x + i*strideX and y[i] = y + i*strideY.
+//  All products share the same dimensions, transposition, leading dimension
+//  and increments.
+//
+template <typename IndexType, typename ALPHA, typename MA, typename VX,
+          typename BETA, typename VY>
+    void
+    gemv_batch(StorageOrder order, Transpose transA,
+               IndexType m, IndexType n,
+               const ALPHA &alpha,
+               const MA *A, IndexType ldA, IndexType strideA,
+               const VX *x, IndexType incX, IndexType strideX,
+               const BETA &beta,
+               VY *y, IndexType incY, IndexType strideY,
+               IndexType batchCount);
+
+#ifdef HAVE_CBLAS_GEMV_BATCH
+
+// sgemv_batch
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemv_batch(StorageOrder order, Transpose transA,
+               IndexType m, IndexType n,
+               float alpha,
+               const float *A, IndexType ldA, IndexType strideA,
+               const float *x, IndexType incX, IndexType strideX,
+               float beta,
+               float *y, IndexType incY, IndexType strideY,
+               IndexType batchCount);
+
+// dgemv_batch
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemv_batch(StorageOrder order, Transpose transA,
+               IndexType m, IndexType n,
+               double alpha,
+               const double *A, IndexType ldA, IndexType strideA,
+               const double *x, IndexType incX, IndexType strideX,
+               double beta,
+               double *y, IndexType incY, IndexType strideY,
+               IndexType batchCount);
+
+// cgemv_batch
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemv_batch(StorageOrder order, Transpose transA,
+               IndexType m, IndexType n,
+               const ComplexFloat &alpha,
+               const ComplexFloat *A, IndexType ldA, IndexType strideA,
+               const ComplexFloat *x, IndexType incX, IndexType strideX,
+               const ComplexFloat &beta,
+               ComplexFloat *y, IndexType incY, IndexType strideY,
+               IndexType batchCount);
+
+// zgemv_batch
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemv_batch(StorageOrder order, Transpose transA,
+               IndexType m, IndexType n,
+               const ComplexDouble &alpha,
+               const ComplexDouble *A, IndexType ldA, IndexType strideA,
+               const ComplexDouble *x, IndexType incX, IndexType strideX,
+               const ComplexDouble &beta,
+               ComplexDouble *y, IndexType incY, IndexType strideY,
+               IndexType batchCount);
+
+#endif // HAVE_CBLAS_GEMV_BATCH
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL2EXTENSIONS_GEMV_BATCH_H
@@ -0,0 +1,184 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL2EXTENSIONS_GEMV_BATCH_TCC
+#define CXXBLAS_LEVEL2EXTENSIONS_GEMV_BATCH_TCC 1
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+template <typename IndexType, typename ALPHA, typename MA, typename VX,
+          typename BETA, typename VY>
+void
+gemv_batch(StorageOrder order, Transpose transA,
+           IndexType m, IndexType n,
+           const ALPHA &alpha,
+           const MA *A, IndexType ldA, IndexType strideA,
+           const VX *x, IndexType incX, IndexType strideX,
+           const BETA &beta,
+           VY *y, IndexType incY, IndexType strideY,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("gemv_batch_generic");
+
+    for (IndexType i=0; i<batchCount; ++i) {
+        gemv(order, transA, m, n,
+             alpha, A + i*strideA, ldA, x + i*strideX, incX,
+             beta,
+             y + i*strideY, incY);
+    }
+}
+
+#ifdef HAVE_CBLAS_GEMV_BATCH
+
+// sgemv_batch
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemv_batch(StorageOrder order, Transpose transA,
+           IndexType m, IndexType n,
+           float alpha,
+           const float *A, IndexType ldA, IndexType strideA,
+           const float *x, IndexType incX, IndexType strideX,
+           float beta,
+           float *y, IndexType incY, IndexType strideY,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_sgemv_batch_strided");
+
+    cblas_sgemv_batch_strided(CBLAS::getCblasType(order), CBLAS::getCblasType(transA),
+                              m, n,
+                              alpha,
+                              A, ldA, strideA,
+                              x, incX, strideX,
+                              beta,
+                              y, incY, strideY,
+                              batchCount);
+}
+
+// dgemv_batch
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemv_batch(StorageOrder order, Transpose transA,
+           IndexType m, IndexType n,
+           double alpha,
+           const double *A, IndexType ldA, IndexType strideA,
+           const double *x, IndexType incX, IndexType strideX,
+           double beta,
+           double *y, IndexType incY, IndexType strideY,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_dgemv_batch_strided");
+
+    cblas_dgemv_batch_strided(CBLAS::getCblasType(order), CBLAS::getCblasType(transA),
+                              m, n,
+                              alpha,
+                              A, ldA, strideA,
+                              x, incX, strideX,
+                              beta,
+                              y, incY, strideY,
+                              batchCount);
+}
+
+// cgemv_batch
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemv_batch(StorageOrder order, Transpose transA,
+           IndexType m, IndexType n,
+           const ComplexFloat &alpha,
+           const ComplexFloat *A, IndexType ldA, IndexType strideA,
+           const ComplexFloat *x, IndexType incX, IndexType strideX,
+           const ComplexFloat &beta,
+           ComplexFloat *y, IndexType incY, IndexType strideY,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_cgemv_batch_strided");
+
+    if (transA==Conj) {
+        for (IndexType i=0; i<batchCount; ++i) {
+            gemv(order, transA, m, n,
+                 alpha, A + i*strideA, ldA, x + i*strideX, incX,
+                 beta,
+                 y + i*strideY, incY);
+        }
+        return;
+    }
+
+    cblas_cgemv_batch_strided(CBLAS::getCblasType(order), CBLAS::getCblasType(transA),
+                              m, n,
+                              reinterpret_cast<const void *>(&alpha),
+                              reinterpret_cast<const void *>(A), ldA, strideA,
+                              reinterpret_cast<const void *>(x), incX, strideX,
+                              reinterpret_cast<const void *>(&beta),
+                              reinterpret_cast<void *>(y), incY, strideY,
+                              batchCount);
+}
+
+// zgemv_batch
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemv_batch(StorageOrder order, Transpose transA,
+           IndexType m, IndexType n,
+           const ComplexDouble &alpha,
+           const ComplexDouble *A, IndexType ldA, IndexType strideA,
+           const ComplexDouble *x, IndexType incX, IndexType strideX,
+           const ComplexDouble &beta,
+           ComplexDouble *y, IndexType incY, IndexType strideY,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_zgemv_batch_strided");
+
+    if (transA==Conj) {
+        for (IndexType i=0; i<batchCount; ++i) {
+            gemv(order, transA, m, n,
+                 alpha, A + i*strideA, ldA, x + i*strideX, incX,
+                 beta,
+                 y + i*strideY, incY);
+        }
+        return;
+    }
+
+    cblas_zgemv_batch_strided(CBLAS::getCblasType(order), CBLAS::getCblasType(transA),
+                              m, n,
+                              reinterpret_cast<const void *>(&alpha),
+                              reinterpret_cast<const void *>(A), ldA, strideA,
+                              reinterpret_cast<const void *>(x), incX, strideX,
+                              reinterpret_cast<const void *>(&beta),
+                              reinterpret_cast<void *>(y), incY, strideY,
+                              batchCount);
+}
+
+#endif // HAVE_CBLAS_GEMV_BATCH
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL2EXTENSIONS_GEMV_BATCH_TCC
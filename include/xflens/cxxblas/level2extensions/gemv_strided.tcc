@@ -0,0 +1,134 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL2EXTENSIONS_GEMV_STRIDED_TCC
+#define CXXBLAS_LEVEL2EXTENSIONS_GEMV_STRIDED_TCC 1
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+#ifdef HAVE_BLIS_TYPED_API
+
+// sgemv
+template <typename IndexType>
+void
+gemv_strided(Transpose transA,
+             IndexType m, IndexType n,
+             float alpha,
+             const float *A, IndexType rsA, IndexType csA,
+             const float *x, IndexType incX,
+             float beta,
+             float *y, IndexType incY)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] bli_sgemv");
+
+    bli_sgemv(BLIS::getBlisType(transA), CXXBLAS_BLIS_NO_CONJUGATE,
+              BLIS_DIM_TYPE(m), BLIS_DIM_TYPE(n),
+              &alpha,
+              A, BLIS_DIM_TYPE(rsA), BLIS_DIM_TYPE(csA),
+              x, BLIS_DIM_TYPE(incX),
+              &beta,
+              y, BLIS_DIM_TYPE(incY));
+}
+
+// dgemv
+template <typename IndexType>
+void
+gemv_strided(Transpose transA,
+             IndexType m, IndexType n,
+             double alpha,
+             const double *A, IndexType rsA, IndexType csA,
+             const double *x, IndexType incX,
+             double beta,
+             double *y, IndexType incY)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] bli_dgemv");
+
+    bli_dgemv(BLIS::getBlisType(transA), CXXBLAS_BLIS_NO_CONJUGATE,
+              BLIS_DIM_TYPE(m), BLIS_DIM_TYPE(n),
+              &alpha,
+              A, BLIS_DIM_TYPE(rsA), BLIS_DIM_TYPE(csA),
+              x, BLIS_DIM_TYPE(incX),
+              &beta,
+              y, BLIS_DIM_TYPE(incY));
+}
+
+// cgemv
+template <typename IndexType>
+void
+gemv_strided(Transpose transA,
+             IndexType m, IndexType n,
+             const ComplexFloat &alpha,
+             const ComplexFloat *A, IndexType rsA, IndexType csA,
+             const ComplexFloat *x, IndexType incX,
+             const ComplexFloat &beta,
+             ComplexFloat *y, IndexType incY)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] bli_cgemv");
+
+    bli_cgemv(BLIS::getBlisType(transA), CXXBLAS_BLIS_NO_CONJUGATE,
+              BLIS_DIM_TYPE(m), BLIS_DIM_TYPE(n),
+              &alpha,
+              A, BLIS_DIM_TYPE(rsA), BLIS_DIM_TYPE(csA),
+              x, BLIS_DIM_TYPE(incX),
+              &beta,
+              y, BLIS_DIM_TYPE(incY));
+}
+
+// zgemv
+template <typename IndexType>
+void
+gemv_strided(Transpose transA,
+             IndexType m, IndexType n,
+             const ComplexDouble &alpha,
+             const ComplexDouble *A, IndexType rsA, IndexType csA,
+             const ComplexDouble *x, IndexType incX,
+             const ComplexDouble &beta,
+             ComplexDouble *y, IndexType incY)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] bli_zgemv");
+
+    bli_zgemv(BLIS::getBlisType(transA), CXXBLAS_BLIS_NO_CONJUGATE,
+              BLIS_DIM_TYPE(m), BLIS_DIM_TYPE(n),
+              &alpha,
+              A, BLIS_DIM_TYPE(rsA), BLIS_DIM_TYPE(csA),
+              x, BLIS_DIM_TYPE(incX),
+              &beta,
+              y, BLIS_DIM_TYPE(incY));
+}
+
+#endif // HAVE_BLIS_TYPED_API
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL2EXTENSIONS_GEMV_STRIDED_TCC
@@ -35,6 +35,8 @@
 
 #include "xflens/cxxblas/level2extensions/gbmv.h"
 #include "xflens/cxxblas/level2extensions/gemv.h"
+#include "xflens/cxxblas/level2extensions/gemv_batch.h"
+#include "xflens/cxxblas/level2extensions/gemv_strided.h"
 #include "xflens/cxxblas/level2extensions/hemv.h"
 #include "xflens/cxxblas/level2extensions/her.h"
 #include "xflens/cxxblas/level2extensions/her2.h"
@@ -35,6 +35,8 @@
 
 #include "xflens/cxxblas/level2extensions/gbmv.tcc"
 #include "xflens/cxxblas/level2extensions/gemv.tcc"
+#include "xflens/cxxblas/level2extensions/gemv_batch.tcc"
+#include "xflens/cxxblas/level2extensions/gemv_strided.tcc"
 #include "xflens/cxxblas/level2extensions/hemv.tcc"
 #include "xflens/cxxblas/level2extensions/her.tcc"
 #include "xflens/cxxblas/level2extensions/her2.tcc"
@@ -33,6 +33,7 @@
 #ifndef CXXBLAS_LEVEL3_GEMM_H
 #define CXXBLAS_LEVEL3_GEMM_H 1
 
+#include <cstdint>
 #include "xflens/cxxblas/drivers/drivers.h"
 #include "xflens/cxxblas/typedefs.h"
 
@@ -40,6 +41,99 @@
 
 namespace cxxblas {
 
+//
+//  Register (MR x NR) and cache (MC x KC panels of A, KC x NC panels of B)
+//  block sizes of the packed generic gemm. Element types without a
+//  specialization use the unblocked gemv based implementation. Level is a
+//  CpuLevel: the kernels selected at runtime for AVX2 and AVX-512 keep
+//  more accumulators in their wider registers; other levels use the block
+//  sizes of the baseline.
+//
+template <typename T, int Level = 0>
+struct GemmBlockSize
+    : GemmBlockSize<T, 0>
+{
+};
+
+template <typename T>
+struct GemmBlockSize<T, 0>
+{
+    static const bool blocked = false;
+};
+
+template <>
+struct GemmBlockSize<float>
+{
+    static const bool blocked = true;
+    static const int  MR = 16, NR = 4, MC = 128, KC = 256, NC = 2048;
+};
+
+template <>
+struct GemmBlockSize<double>
+{
+    static const bool blocked = true;
+    static const int  MR = 8, NR = 4, MC = 96, KC = 256, NC = 2048;
+};
+
+// integers are multiplied exactly, with the register blocks of the
+// floating point type of the same width
+template <>
+struct GemmBlockSize<std::int32_t>
+{
+    static const bool blocked = true;
+    static const int  MR = 16, NR = 4, MC = 128, KC = 256, NC = 2048;
+};
+
+template <>
+struct GemmBlockSize<std::int64_t>
+{
+    static const bool blocked = true;
+    static const int  MR = 8, NR = 4, MC = 96, KC = 256, NC = 2048;
+};
+
+template <>
+struct GemmBlockSize<std::complex<float> >
+{
+    static const bool blocked = true;
+    static const int  MR = 8, NR = 2, MC = 96, KC = 256, NC = 1024;
+};
+
+template <>
+struct GemmBlockSize<std::complex<double> >
+{
+    static const bool blocked = true;
+    static const int  MR = 4, NR = 2, MC = 64, KC = 256, NC = 512;
+};
+
+// 12 (AVX2) and 16 (AVX-512) vector accumulators hide the FMA latency
+template <>
+struct GemmBlockSize<float, 1>
+{
+    static const bool blocked = true;
+    static const int  MR = 16, NR = 6, MC = 144, KC = 256, NC = 2040;
+};
+
+template <>
+struct GemmBlockSize<double, 1>
+{
+    static const bool blocked = true;
+    static const int  MR = 8, NR = 6, MC = 96, KC = 256, NC = 2040;
+};
+
+template <>
+struct GemmBlockSize<float, 2>
+{
+    static const bool blocked = true;
+    static const int  MR = 32, NR = 8, MC = 160, KC = 384, NC = 2048;
+};
+
+template <>
+struct GemmBlockSize<double, 2>
+{
+    static const bool blocked = true;
+    static const int  MR = 16, NR = 8, MC = 128, KC = 384, NC = 2048;
+};
+
 template <typename IndexType, typename ALPHA, typename MA, typename MB,
           typename BETA, typename MC>
     void
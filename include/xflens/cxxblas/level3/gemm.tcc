@@ -33,10 +33,353 @@
 #ifndef CXXBLAS_LEVEL3_GEMM_TCC
 #define CXXBLAS_LEVEL3_GEMM_TCC 1
 
+#include <algorithm>
+#include <type_traits>
+#include <vector>
 #include "xflens/cxxblas/cxxblas.h"
 
 namespace cxxblas {
 
+//
+//  Packed, cache blocked gemm in the style of GotoBLAS / BLIS for column
+//  major C := beta*C + alpha*op(A)*op(B). op(A) is packed (and scaled by
+//  alpha) into MR-row slivers of an MC x KC block, op(B) into NR-column
+//  slivers of a KC x NC block, so that the micro kernel streams both
+//  contiguously and keeps its MR x NR block of C in registers.
+//
+
+template <int MR, int NR, typename IndexType, typename T>
+CXXBLAS_ALWAYS_INLINE void
+gemm_micro_kernel_real(IndexType kc, const T *a, const T *b,
+                       T *C, IndexType ldC, IndexType mr, IndexType nr)
+{
+    T ab[MR*NR];
+    for (int i=0; i<MR*NR; ++i) {
+        ab[i] = T(0);
+    }
+    for (IndexType p=0; p<kc; ++p, a+=MR, b+=NR) {
+        for (int j=0; j<NR; ++j) {
+            const T bj = b[j];
+            for (int i=0; i<MR; ++i) {
+                ab[i+j*MR] += a[i]*bj;
+            }
+        }
+    }
+    for (IndexType j=0; j<nr; ++j) {
+        for (IndexType i=0; i<mr; ++i) {
+            C[i+j*ldC] += ab[i+j*MR];
+        }
+    }
+}
+
+template <int MR, int NR, typename IndexType, typename T>
+void
+gemm_micro_kernel(IndexType kc, const T *a, const T *b,
+                  T *C, IndexType ldC, IndexType mr, IndexType nr)
+{
+    gemm_micro_kernel_real<MR, NR>(kc, a, b, C, ldC, mr, nr);
+}
+
+// separate real and imaginary accumulators keep the complex kernel vectorizable
+template <int MR, int NR, typename IndexType, typename T>
+void
+gemm_micro_kernel(IndexType kc, const std::complex<T> *a_,
+                  const std::complex<T> *b_,
+                  std::complex<T> *C, IndexType ldC, IndexType mr, IndexType nr)
+{
+    const T *a = reinterpret_cast<const T *>(a_);
+    const T *b = reinterpret_cast<const T *>(b_);
+    T re[MR*NR], im[MR*NR];
+    for (int i=0; i<MR*NR; ++i) {
+        re[i] = im[i] = T(0);
+    }
+    for (IndexType p=0; p<kc; ++p, a+=2*MR, b+=2*NR) {
+        for (int j=0; j<NR; ++j) {
+            const T br = b[2*j], bi = b[2*j+1];
+            for (int i=0; i<MR; ++i) {
+                re[i+j*MR] += a[2*i]*br - a[2*i+1]*bi;
+                im[i+j*MR] += a[2*i]*bi + a[2*i+1]*br;
+            }
+        }
+    }
+    for (IndexType j=0; j<nr; ++j) {
+        for (IndexType i=0; i<mr; ++i) {
+            C[i+j*ldC] += std::complex<T>(re[i+j*MR], im[i+j*MR]);
+        }
+    }
+}
+
+// the micro kernels called by gemm_blocked_run
+struct GemmKernelBaseline
+{
+    template <int MR, int NR, typename IndexType, typename T>
+    static void
+    call(IndexType kc, const T *a, const T *b,
+         T *C, IndexType ldC, IndexType mr, IndexType nr)
+    {
+        gemm_micro_kernel<MR, NR>(kc, a, b, C, ldC, mr, nr);
+    }
+};
+
+#if defined(CXXBLAS_CPU_DISPATCH)
+
+// the real kernel compiled for the instruction sets selected at runtime;
+// it is inlined into these functions and vectorized for their target
+template <int MR, int NR, typename IndexType, typename T>
+CXXBLAS_TARGET_AVX2 void
+gemm_micro_kernel_avx2(IndexType kc, const T *a, const T *b,
+                       T *C, IndexType ldC, IndexType mr, IndexType nr)
+{
+    gemm_micro_kernel_real<MR, NR>(kc, a, b, C, ldC, mr, nr);
+}
+
+template <int MR, int NR, typename IndexType, typename T>
+CXXBLAS_TARGET_AVX512 void
+gemm_micro_kernel_avx512(IndexType kc, const T *a, const T *b,
+                         T *C, IndexType ldC, IndexType mr, IndexType nr)
+{
+    gemm_micro_kernel_real<MR, NR>(kc, a, b, C, ldC, mr, nr);
+}
+
+struct GemmKernelAvx2
+{
+    template <int MR, int NR, typename IndexType, typename T>
+    static void
+    call(IndexType kc, const T *a, const T *b,
+         T *C, IndexType ldC, IndexType mr, IndexType nr)
+    {
+        gemm_micro_kernel_avx2<MR, NR>(kc, a, b, C, ldC, mr, nr);
+    }
+};
+
+struct GemmKernelAvx512
+{
+    template <int MR, int NR, typename IndexType, typename T>
+    static void
+    call(IndexType kc, const T *a, const T *b,
+         T *C, IndexType ldC, IndexType mr, IndexType nr)
+    {
+        gemm_micro_kernel_avx512<MR, NR>(kc, a, b, C, ldC, mr, nr);
+    }
+};
+
+#endif
+
+// op(A)(i,l) = A[i*rs + l*cs], conjugated if conj
+template <int MR, typename IndexType, typename T>
+void
+gemm_pack_a(IndexType mc, IndexType kc, const T &alpha, bool conj,
+            const T *A, IndexType rs, IndexType cs, T *buffer)
+{
+    for (IndexType ir=0; ir<mc; ir+=MR) {
+        IndexType mr = std::min(IndexType(MR), mc-ir);
+        for (IndexType l=0; l<kc; ++l) {
+            const T *a = A + ir*rs + l*cs;
+            for (IndexType i=0; i<mr; ++i) {
+                buffer[i] = alpha*(conj ? conjugate(a[i*rs]) : a[i*rs]);
+            }
+            for (IndexType i=mr; i<MR; ++i) {
+                buffer[i] = T(0);
+            }
+            buffer += MR;
+        }
+    }
+}
+
+// op(B)(l,j) = B[l*rs + j*cs], conjugated if conj
+template <int NR, typename IndexType, typename T>
+void
+gemm_pack_b(IndexType kc, IndexType nc, bool conj,
+            const T *B, IndexType rs, IndexType cs, T *buffer)
+{
+    for (IndexType jr=0; jr<nc; jr+=NR) {
+        IndexType nr = std::min(IndexType(NR), nc-jr);
+        for (IndexType l=0; l<kc; ++l) {
+            const T *b = B + l*rs + jr*cs;
+            for (IndexType j=0; j<nr; ++j) {
+                buffer[j] = conj ? conjugate(b[j*cs]) : b[j*cs];
+            }
+            for (IndexType j=nr; j<NR; ++j) {
+                buffer[j] = T(0);
+            }
+            buffer += NR;
+        }
+    }
+}
+
+// C += alpha*op(A)*op(B), column major, with the block sizes BS and the
+// micro kernel of Kernel
+template <typename BS, typename Kernel, typename IndexType, typename T>
+void
+gemm_blocked_run(Transpose transA, Transpose transB,
+                 IndexType m, IndexType n, IndexType k,
+                 const T &alpha,
+                 const T *A, IndexType ldA,
+                 const T *B, IndexType ldB,
+                 T *C, IndexType ldC)
+{
+    const IndexType MR = BS::MR, NR = BS::NR;
+    const IndexType MC_ = BS::MC, KC = BS::KC, NC = BS::NC;
+
+    const bool transposedA = (transA==Trans) || (transA==ConjTrans);
+    const bool transposedB = (transB==Trans) || (transB==ConjTrans);
+    const bool conjA = (transA==Conj) || (transA==ConjTrans);
+    const bool conjB = (transB==Conj) || (transB==ConjTrans);
+    const IndexType rsA = transposedA ? ldA : 1, csA = transposedA ? 1 : ldA;
+    const IndexType rsB = transposedB ? ldB : 1, csB = transposedB ? 1 : ldB;
+
+    const IndexType ncMax = std::min(NC, ((n+NR-1)/NR)*NR);
+    const IndexType mcMax = std::min(MC_, ((m+MR-1)/MR)*MR);
+    const IndexType kcMax = std::min(KC, k);
+    std::vector<T> bufferB(kcMax*ncMax);
+
+    // Tasks are MC x NC/numParts blocks of C sharing the packed panel of B,
+    // each packing its own block of A. The panel of C is cut along its
+    // columns only if there are too few row blocks to keep all threads busy.
+    const IndexType numThreads = (double(m)*double(n)*double(k) < 1e6)
+                               ? 1 : IndexType(get_num_threads());
+    const IndexType numBlocksA = (m+MC_-1)/MC_;
+
+    for (IndexType jc=0; jc<n; jc+=NC) {
+        IndexType nc = std::min(NC, n-jc);
+        IndexType numSlivers = (nc+NR-1)/NR;
+        IndexType numParts = std::min(numSlivers,
+                                      (2*numThreads+numBlocksA-1)/numBlocksA);
+        IndexType partWidth = ((numSlivers+numParts-1)/numParts)*NR;
+        numParts = (nc+partWidth-1)/partWidth;
+
+        for (IndexType pc=0; pc<k; pc+=KC) {
+            IndexType kc = std::min(KC, k-pc);
+            gemm_pack_b<BS::NR>(kc, nc, conjB, B + pc*rsB + jc*csB, rsB, csB,
+                                bufferB.data());
+
+            parallel_for(numBlocksA*numParts, [&](IndexType task) {
+                IndexType ic = (task/numParts)*MC_;
+                IndexType j0 = (task%numParts)*partWidth;
+                IndexType mc = std::min(MC_, m-ic);
+                IndexType j1 = std::min(nc, j0+partWidth);
+
+                std::vector<T> bufferA(mcMax*kcMax);
+                gemm_pack_a<BS::MR>(mc, kc, alpha, conjA,
+                                    A + ic*rsA + pc*csA, rsA, csA,
+                                    bufferA.data());
+                for (IndexType jr=j0; jr<j1; jr+=NR) {
+                    IndexType nr = std::min(NR, j1-jr);
+                    for (IndexType ir=0; ir<mc; ir+=MR) {
+                        IndexType mr = std::min(MR, mc-ir);
+                        Kernel::template call<BS::MR, BS::NR>(
+                            kc, bufferA.data() + ir*kc, bufferB.data() + jr*kc,
+                            C + (ic+ir) + (jc+jr)*ldC, ldC, mr, nr);
+                    }
+                }
+            });
+        }
+    }
+}
+
+template <typename IndexType, typename T>
+void
+gemm_blocked_dispatch(Transpose transA, Transpose transB,
+                      IndexType m, IndexType n, IndexType k,
+                      const T &alpha,
+                      const T *A, IndexType ldA,
+                      const T *B, IndexType ldB,
+                      T *C, IndexType ldC,
+                      std::false_type)
+{
+    gemm_blocked_run<GemmBlockSize<T>, GemmKernelBaseline>(
+        transA, transB, m, n, k, alpha, A, ldA, B, ldB, C, ldC);
+}
+
+// float and double use the widest kernel the processor supports
+template <typename IndexType, typename T>
+void
+gemm_blocked_dispatch(Transpose transA, Transpose transB,
+                      IndexType m, IndexType n, IndexType k,
+                      const T &alpha,
+                      const T *A, IndexType ldA,
+                      const T *B, IndexType ldB,
+                      T *C, IndexType ldC,
+                      std::true_type)
+{
+#if defined(CXXBLAS_CPU_DISPATCH)
+    switch (cpu_level()) {
+        case CpuAvx512:
+            gemm_blocked_run<GemmBlockSize<T, CpuAvx512>, GemmKernelAvx512>(
+                transA, transB, m, n, k, alpha, A, ldA, B, ldB, C, ldC);
+            return;
+        case CpuAvx2:
+            gemm_blocked_run<GemmBlockSize<T, CpuAvx2>, GemmKernelAvx2>(
+                transA, transB, m, n, k, alpha, A, ldA, B, ldB, C, ldC);
+            return;
+        default:
+            break;
+    }
+#endif
+    gemm_blocked_run<GemmBlockSize<T>, GemmKernelBaseline>(
+        transA, transB, m, n, k, alpha, A, ldA, B, ldB, C, ldC);
+}
+
+template <typename IndexType, typename ALPHA, typename MA, typename MB,
+          typename BETA, typename MC>
+bool
+gemm_blocked(StorageOrder, Transpose, Transpose,
+             IndexType, IndexType, IndexType,
+             const ALPHA &, const MA *, IndexType, const MB *, IndexType,
+             const BETA &, MC *, IndexType,
+             std::false_type)
+{
+    return false;
+}
+
+template <typename IndexType, typename ALPHA, typename T,
+          typename BETA>
+bool
+gemm_blocked(StorageOrder order,
+             Transpose transA, Transpose transB,
+             IndexType m, IndexType n, IndexType k,
+             const ALPHA &alpha,
+             const T *A, IndexType ldA,
+             const T *B, IndexType ldB,
+             const BETA &beta,
+             T *C, IndexType ldC,
+             std::true_type)
+{
+    typedef GemmBlockSize<T> BS;
+    const IndexType MR = BS::MR, NR = BS::NR;
+
+    if (order==RowMajor) {
+        return gemm_blocked(ColMajor, transB, transA, n, m, k, alpha,
+                            B, ldB, A, ldA, beta, C, ldC,
+                            std::true_type());
+    }
+
+    // below a few register blocks, packing costs more than it saves
+    if ((m<MR) || (n<NR) || (k<8)) {
+        return false;
+    }
+    CXXBLAS_DEBUG_OUT("gemm_blocked");
+
+    gescal_init(ColMajor, m, n, beta, C, ldC);
+    if (alpha==ALPHA(0)) {
+        return true;
+    }
+
+    gemm_blocked_dispatch(transA, transB, m, n, k, T(alpha), A, ldA, B, ldB,
+                          C, ldC,
+                          std::integral_constant<bool,
+                              std::is_floating_point<T>::value>());
+    return true;
+}
+
+template <typename MA, typename MB, typename MC>
+struct GemmUseBlocked
+    : std::integral_constant<bool, std::is_same<MA, MC>::value
+                                   && std::is_same<MB, MC>::value
+                                   && GemmBlockSize<MC>::blocked>
+{
+};
+
 template <typename IndexType, typename ALPHA, typename MA, typename MB,
           typename BETA, typename MC>
 void
@@ -54,6 +397,10 @@ gemm_generic(StorageOrder order,
     if ((m==0) || (n==0)) {
         return;
     }
+    if (gemm_blocked(order, transA, transB, m, n, k, alpha, A, ldA, B, ldB,
+                     beta, C, ldC, GemmUseBlocked<MA, MB, MC>())) {
+        return;
+    }
     if (order==ColMajor) {
         gemm_generic(RowMajor, transB, transA,
                      n, m, k, alpha,
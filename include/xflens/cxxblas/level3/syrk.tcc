@@ -33,10 +33,75 @@
 #ifndef CXXBLAS_LEVEL3_SYRK_TCC
 #define CXXBLAS_LEVEL3_SYRK_TCC 1
 
+#include <algorithm>
 #include "xflens/cxxblas/cxxblas.h"
 
 namespace cxxblas {
 
+template <typename IndexType, typename ALPHA, typename MA,
+          typename BETA, typename MC>
+    void
+    syrk_generic(StorageOrder order, StorageUpLo upLoC,
+                 Transpose transA,
+                 IndexType n, IndexType k,
+                 const ALPHA &alpha,
+                 const MA *A, IndexType ldA,
+                 const BETA &beta,
+                 MC *C, IndexType ldC);
+
+//
+//  Row major C is split into blocks of rows. Each block updates its
+//  triangular diagonal part with rank-1 updates and the rectangle next to
+//  it with one gemm. Blocks are independent tasks of parallel_for.
+//
+template <typename IndexType, typename ALPHA, typename MA,
+          typename BETA, typename MC>
+bool
+syrk_blocked(StorageUpLo upLoC, Transpose transA,
+             IndexType n, IndexType k,
+             const ALPHA &alpha,
+             const MA *A, IndexType ldA,
+             const BETA &beta,
+             MC *C, IndexType ldC)
+{
+    const IndexType minBlock = 64;
+    if (n<2*minBlock) {
+        return false;
+    }
+    CXXBLAS_DEBUG_OUT("syrk_blocked");
+
+    const IndexType numThreads = get_num_threads();
+    const IndexType bs = std::max(minBlock, (n+4*numThreads-1)/(4*numThreads));
+    const IndexType numBlocks = (n+bs-1)/bs;
+    // row i of op(A)
+    const IndexType rs = (transA==NoTrans) ? ldA : 1;
+    const Transpose transB = (transA==NoTrans) ? Trans : NoTrans;
+
+    parallel_for(numBlocks, [&](IndexType b) {
+        IndexType i0 = b*bs;
+        IndexType nb = std::min(bs, n-i0);
+        MC *Cd = C + i0*ldC + i0;
+
+        syrk_generic(RowMajor, upLoC, transA, nb, k, alpha, A + i0*rs, ldA,
+                     beta, Cd, ldC);
+        if (upLoC==Lower) {
+            if (i0>0) {
+                gemm(RowMajor, transA, transB, nb, i0, k,
+                     alpha, A + i0*rs, ldA, A, ldA,
+                     beta, C + i0*ldC, ldC);
+            }
+        } else {
+            IndexType i1 = i0+nb;
+            if (i1<n) {
+                gemm(RowMajor, transA, transB, nb, n-i1, k,
+                     alpha, A + i0*rs, ldA, A + i1*rs, ldA,
+                     beta, Cd + nb, ldC);
+            }
+        }
+    });
+    return true;
+}
+
 template <typename IndexType, typename ALPHA, typename MA,
           typename BETA, typename MC>
 void
@@ -55,6 +120,10 @@ syrk_generic(StorageOrder order, StorageUpLo upLoC,
                      alpha, A, ldA, beta, C, ldC);
         return;
     }
+    if ((k>0) && ((transA==NoTrans) || (transA==Trans))
+     && syrk_blocked(upLoC, transA, n, k, alpha, A, ldA, beta, C, ldC)) {
+        return;
+    }
     syscal_init(order, upLoC, n, beta, C, ldC);
     if (k==0) {
         return;
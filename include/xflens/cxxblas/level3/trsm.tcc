@@ -33,6 +33,7 @@
 #ifndef CXXBLAS_LEVEL3_TRSM_TCC
 #define CXXBLAS_LEVEL3_TRSM_TCC 1
 
+#include <algorithm>
 #include "xflens/cxxblas/cxxblas.h"
 
 namespace cxxblas {
@@ -53,18 +54,29 @@ trsm_generic(StorageOrder order, Side sideA, StorageUpLo upLoA,
                      alpha, A, ldA, B, ldB);
         return;
     }
+    // the right hand sides are independent, chunks of them run as tasks
+    const IndexType numRhs = (sideA==Right) ? m : n;
+    const IndexType numChunks = std::min(numRhs,
+                                         IndexType(4*get_num_threads()));
+    const IndexType chunk = (numChunks>0) ? (numRhs+numChunks-1)/numChunks
+                                          : IndexType(0);
+
     if (sideA==Right) {
         transA = Transpose(transA^Trans);
-        for (IndexType i=0; i<m; ++i) {
-            trsv(order, upLoA, transA, diagA, n, A, ldA, B+i*ldB, IndexType(1));
-        }
     }
-    if (sideA==Left) {
-        for (IndexType j=0; j<n; ++j) {
-            trsv(order, upLoA, transA, diagA, m, A, ldA, B+j, ldB);
+    parallel_for(numChunks, [&](IndexType c) {
+        IndexType r1 = std::min(numRhs, (c+1)*chunk);
+        for (IndexType r=c*chunk; r<r1; ++r) {
+            if (sideA==Right) {
+                trsv(order, upLoA, transA, diagA, n, A, ldA,
+                     B+r*ldB, IndexType(1));
+                scal(n, alpha, B+r*ldB, IndexType(1));
+            } else {
+                trsv(order, upLoA, transA, diagA, m, A, ldA, B+r, ldB);
+                scal(m, alpha, B+r, ldB);
+            }
         }
-    }
-    gescal(order, m, n, alpha, B, ldB);
+    });
 }
 
 template <typename IndexType, typename ALPHA, typename MA, typename MB>
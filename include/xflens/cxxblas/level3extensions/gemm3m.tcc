@@ -0,0 +1,112 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM3M_TCC
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM3M_TCC 1
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+#ifdef HAVE_CBLAS_GEMM3M
+
+// cgemm3m
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemm3m(StorageOrder order,
+       Transpose transA, Transpose transB,
+       IndexType m, IndexType n, IndexType k,
+       const ComplexFloat &alpha,
+       const ComplexFloat *A, IndexType ldA,
+       const ComplexFloat *B, IndexType ldB,
+       const ComplexFloat &beta,
+       ComplexFloat *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_cgemm3m");
+
+    // CBLAS has no op for a conjugation without transposition
+    if (transA==Conj || transB==Conj) {
+        gemm(order, transA, transB, m, n, k,
+             alpha, A, ldA, B, ldB,
+             beta,
+             C, ldC);
+        return;
+    }
+
+    cblas_cgemm3m(CBLAS::getCblasType(order),
+                  CBLAS::getCblasType(transA), CBLAS::getCblasType(transB),
+                  m, n, k,
+                  reinterpret_cast<const float *>(&alpha),
+                  reinterpret_cast<const float *>(A), ldA,
+                  reinterpret_cast<const float *>(B), ldB,
+                  reinterpret_cast<const float *>(&beta),
+                  reinterpret_cast<float *>(C), ldC);
+}
+
+// zgemm3m
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemm3m(StorageOrder order,
+       Transpose transA, Transpose transB,
+       IndexType m, IndexType n, IndexType k,
+       const ComplexDouble &alpha,
+       const ComplexDouble *A, IndexType ldA,
+       const ComplexDouble *B, IndexType ldB,
+       const ComplexDouble &beta,
+       ComplexDouble *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_zgemm3m");
+
+    // CBLAS has no op for a conjugation without transposition
+    if (transA==Conj || transB==Conj) {
+        gemm(order, transA, transB, m, n, k,
+             alpha, A, ldA, B, ldB,
+             beta,
+             C, ldC);
+        return;
+    }
+
+    cblas_zgemm3m(CBLAS::getCblasType(order),
+                  CBLAS::getCblasType(transA), CBLAS::getCblasType(transB),
+                  m, n, k,
+                  reinterpret_cast<const double *>(&alpha),
+                  reinterpret_cast<const double *>(A), ldA,
+                  reinterpret_cast<const double *>(B), ldB,
+                  reinterpret_cast<const double *>(&beta),
+                  reinterpret_cast<double *>(C), ldC);
+}
+
+#endif // HAVE_CBLAS_GEMM3M
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM3M_TCC
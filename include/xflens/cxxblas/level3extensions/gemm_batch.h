@@ -0,0 +1,120 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_BATCH_H
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_BATCH_H 1
+
+#include "xflens/cxxblas/drivers/drivers.h"
+#include "xflens/cxxblas/typedefs.h"
+
+#define HAVE_CXXBLAS_GEMM_BATCH 1
+
+namespace cxxblas {
+
+//
+//  C[i] := alpha * op(A[i]) * op(B[i]) + beta * C[i]   for i = 0, ..., batchCount-1
+//
+//  All products share the same dimensions, transpositions and leading
+//  dimensions.  Pointers in A and B may repeat (e.g. for broadcasting).
+//
+template <typename IndexType, typename ALPHA, typename MA, typename MB,
+          typename BETA, typename MC>
+    void
+    gemm_batch(StorageOrder order,
+               Transpose transA, Transpose transB,
+               IndexType m, IndexType n, IndexType k,
+               const ALPHA &alpha,
+               const MA * const *A, IndexType ldA,
+               const MB * const *B, IndexType ldB,
+               const BETA &beta,
+               MC * const *C, IndexType ldC,
+               IndexType batchCount);
+
+#ifdef HAVE_CBLAS_GEMM_BATCH
+
+// sgemm_batch
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemm_batch(StorageOrder order,
+               Transpose transA, Transpose transB,
+               IndexType m, IndexType n, IndexType k,
+               float alpha,
+               const float * const *A, IndexType ldA,
+               const float * const *B, IndexType ldB,
+               float beta,
+               float * const *C, IndexType ldC,
+               IndexType batchCount);
+
+// dgemm_batch
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemm_batch(StorageOrder order,
+               Transpose transA, Transpose transB,
+               IndexType m, IndexType n, IndexType k,
+               double alpha,
+               const double * const *A, IndexType ldA,
+               const double * const *B, IndexType ldB,
+               double beta,
+               double * const *C, IndexType ldC,
+               IndexType batchCount);
+
+// cgemm_batch
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemm_batch(StorageOrder order,
+               Transpose transA, Transpose transB,
+               IndexType m, IndexType n, IndexType k,
+               const ComplexFloat &alpha,
+               const ComplexFloat * const *A, IndexType ldA,
+               const ComplexFloat * const *B, IndexType ldB,
+               const ComplexFloat &beta,
+               ComplexFloat * const *C, IndexType ldC,
+               IndexType batchCount);
+
+// zgemm_batch
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemm_batch(StorageOrder order,
+               Transpose transA, Transpose transB,
+               IndexType m, IndexType n, IndexType k,
+               const ComplexDouble &alpha,
+               const ComplexDouble * const *A, IndexType ldA,
+               const ComplexDouble * const *B, IndexType ldB,
+               const ComplexDouble &beta,
+               ComplexDouble * const *C, IndexType ldC,
+               IndexType batchCount);
+
+#endif // HAVE_CBLAS_GEMM_BATCH
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_BATCH_H
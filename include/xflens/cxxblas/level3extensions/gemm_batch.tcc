@@ -0,0 +1,217 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_BATCH_TCC
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_BATCH_TCC 1
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+template <typename IndexType, typename ALPHA, typename MA, typename MB,
+          typename BETA, typename MC>
+void
+gemm_batch(StorageOrder order,
+           Transpose transA, Transpose transB,
+           IndexType m, IndexType n, IndexType k,
+           const ALPHA &alpha,
+           const MA * const *A, IndexType ldA,
+           const MB * const *B, IndexType ldB,
+           const BETA &beta,
+           MC * const *C, IndexType ldC,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("gemm_batch_generic");
+
+    for (IndexType i=0; i<batchCount; ++i) {
+        gemm(order, transA, transB, m, n, k,
+             alpha, A[i], ldA, B[i], ldB,
+             beta,
+             C[i], ldC);
+    }
+}
+
+#ifdef HAVE_CBLAS_GEMM_BATCH
+
+// sgemm_batch
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemm_batch(StorageOrder order,
+           Transpose transA, Transpose transB,
+           IndexType m, IndexType n, IndexType k,
+           float alpha,
+           const float * const *A, IndexType ldA,
+           const float * const *B, IndexType ldB,
+           float beta,
+           float * const *C, IndexType ldC,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_sgemm_batch");
+
+    CBLAS_TRANSPOSE transA_ = CBLAS::getCblasType(transA);
+    CBLAS_TRANSPOSE transB_ = CBLAS::getCblasType(transB);
+    CBLAS_INT m_ = m, n_ = n, k_ = k;
+    CBLAS_INT ldA_ = ldA, ldB_ = ldB, ldC_ = ldC;
+    CBLAS_INT groupSize = batchCount;
+
+    cblas_sgemm_batch(CBLAS::getCblasType(order),
+                      &transA_, &transB_,
+                      &m_, &n_, &k_,
+                      &alpha,
+                      const_cast<const float **>(A), &ldA_,
+                      const_cast<const float **>(B), &ldB_,
+                      &beta,
+                      const_cast<float **>(C), &ldC_,
+                      1, &groupSize);
+}
+
+// dgemm_batch
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemm_batch(StorageOrder order,
+           Transpose transA, Transpose transB,
+           IndexType m, IndexType n, IndexType k,
+           double alpha,
+           const double * const *A, IndexType ldA,
+           const double * const *B, IndexType ldB,
+           double beta,
+           double * const *C, IndexType ldC,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_dgemm_batch");
+
+    CBLAS_TRANSPOSE transA_ = CBLAS::getCblasType(transA);
+    CBLAS_TRANSPOSE transB_ = CBLAS::getCblasType(transB);
+    CBLAS_INT m_ = m, n_ = n, k_ = k;
+    CBLAS_INT ldA_ = ldA, ldB_ = ldB, ldC_ = ldC;
+    CBLAS_INT groupSize = batchCount;
+
+    cblas_dgemm_batch(CBLAS::getCblasType(order),
+                      &transA_, &transB_,
+                      &m_, &n_, &k_,
+                      &alpha,
+                      const_cast<const double **>(A), &ldA_,
+                      const_cast<const double **>(B), &ldB_,
+                      &beta,
+                      const_cast<double **>(C), &ldC_,
+                      1, &groupSize);
+}
+
+// cgemm_batch
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemm_batch(StorageOrder order,
+           Transpose transA, Transpose transB,
+           IndexType m, IndexType n, IndexType k,
+           const ComplexFloat &alpha,
+           const ComplexFloat * const *A, IndexType ldA,
+           const ComplexFloat * const *B, IndexType ldB,
+           const ComplexFloat &beta,
+           ComplexFloat * const *C, IndexType ldC,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_cgemm_batch");
+
+    if (transA==Conj || transB==Conj) {
+        for (IndexType i=0; i<batchCount; ++i) {
+            gemm_generic(order, transA, transB, m, n, k,
+                         alpha, A[i], ldA, B[i], ldB,
+                         beta,
+                         C[i], ldC);
+        }
+        return;
+    }
+
+    CBLAS_TRANSPOSE transA_ = CBLAS::getCblasType(transA);
+    CBLAS_TRANSPOSE transB_ = CBLAS::getCblasType(transB);
+    CBLAS_INT m_ = m, n_ = n, k_ = k;
+    CBLAS_INT ldA_ = ldA, ldB_ = ldB, ldC_ = ldC;
+    CBLAS_INT groupSize = batchCount;
+
+    cblas_cgemm_batch(CBLAS::getCblasType(order),
+                      &transA_, &transB_,
+                      &m_, &n_, &k_,
+                      reinterpret_cast<const float *>(&alpha),
+                      reinterpret_cast<const float **>(const_cast<const ComplexFloat **>(A)), &ldA_,
+                      reinterpret_cast<const float **>(const_cast<const ComplexFloat **>(B)), &ldB_,
+                      reinterpret_cast<const float *>(&beta),
+                      reinterpret_cast<float **>(const_cast<ComplexFloat **>(C)), &ldC_,
+                      1, &groupSize);
+}
+
+// zgemm_batch
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemm_batch(StorageOrder order,
+           Transpose transA, Transpose transB,
+           IndexType m, IndexType n, IndexType k,
+           const ComplexDouble &alpha,
+           const ComplexDouble * const *A, IndexType ldA,
+           const ComplexDouble * const *B, IndexType ldB,
+           const ComplexDouble &beta,
+           ComplexDouble * const *C, IndexType ldC,
+           IndexType batchCount)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_zgemm_batch");
+
+    if (transA==Conj || transB==Conj) {
+        for (IndexType i=0; i<batchCount; ++i) {
+            gemm_generic(order, transA, transB, m, n, k,
+                         alpha, A[i], ldA, B[i], ldB,
+                         beta,
+                         C[i], ldC);
+        }
+        return;
+    }
+
+    CBLAS_TRANSPOSE transA_ = CBLAS::getCblasType(transA);
+    CBLAS_TRANSPOSE transB_ = CBLAS::getCblasType(transB);
+    CBLAS_INT m_ = m, n_ = n, k_ = k;
+    CBLAS_INT ldA_ = ldA, ldB_ = ldB, ldC_ = ldC;
+    CBLAS_INT groupSize = batchCount;
+
+    cblas_zgemm_batch(CBLAS::getCblasType(order),
+                      &transA_, &transB_,
+                      &m_, &n_, &k_,
+                      reinterpret_cast<const double *>(&alpha),
+                      reinterpret_cast<const double **>(const_cast<const ComplexDouble **>(A)), &ldA_,
+                      reinterpret_cast<const double **>(const_cast<const ComplexDouble **>(B)), &ldB_,
+                      reinterpret_cast<const double *>(&beta),
+                      reinterpret_cast<double **>(const_cast<ComplexDouble **>(C)), &ldC_,
+                      1, &groupSize);
+}
+
+#endif // HAVE_CBLAS_GEMM_BATCH
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_BATCH_TCC
@@ -0,0 +1,67 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_EPILOGUE_H
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_EPILOGUE_H 1
+
+#include "xflens/cxxblas/drivers/drivers.h"
+#include "xflens/cxxblas/typedefs.h"
+
+#define HAVE_CXXBLAS_GEMM_EPILOGUE 1
+
+namespace cxxblas {
+
+//
+//  C(i,j) := epilogue(i, j, (alpha * op(A) * op(B) + beta * C)(i,j))
+//
+//  with the epilogue applied to each block of C while it is in cache: by
+//  the generic kernel as soon as the block is complete, else after gemm on
+//  panels of C.  The epilogue is called once per element, possibly
+//  concurrently.
+//
+
+template <typename IndexType, typename ALPHA, typename T, typename BETA,
+          typename F>
+    void
+    gemm_epilogue(StorageOrder order,
+                  Transpose transA, Transpose transB,
+                  IndexType m, IndexType n, IndexType k,
+                  const ALPHA &alpha,
+                  const T *A, IndexType ldA,
+                  const T *B, IndexType ldB,
+                  const BETA &beta,
+                  T *C, IndexType ldC,
+                  const F &epilogue);
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_EPILOGUE_H
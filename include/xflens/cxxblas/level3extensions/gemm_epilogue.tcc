@@ -0,0 +1,216 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_EPILOGUE_TCC
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_EPILOGUE_TCC 1
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+// elements of C per panel of the gemm calls the epilogue follows
+const int gemmEpiloguePanelElements = 1 << 16;
+// narrowest panel worth a separate gemm call
+const int gemmEpilogueMinPanel = 256;
+
+template <typename IndexType, typename T, typename F>
+void
+gemm_epilogue_apply(StorageOrder order,
+                    IndexType i0, IndexType mb, IndexType j0, IndexType nb,
+                    T *C, IndexType ldC, const F &epilogue)
+{
+    if (order==ColMajor) {
+        for (IndexType j=j0; j<j0+nb; ++j) {
+            for (IndexType i=i0; i<i0+mb; ++i) {
+                T &c = C[i+j*ldC];
+                c = epilogue(i, j, c);
+            }
+        }
+    } else {
+        for (IndexType i=i0; i<i0+mb; ++i) {
+            for (IndexType j=j0; j<j0+nb; ++j) {
+                T &c = C[i*ldC+j];
+                c = epilogue(i, j, c);
+            }
+        }
+    }
+}
+
+// column major product of the generic blocked kernel, see gemm_blocked
+template <typename IndexType, typename T, typename F>
+void
+gemm_epilogue_blocked(Transpose transA, Transpose transB,
+                      IndexType m, IndexType n, IndexType k,
+                      const T &alpha,
+                      const T *A, IndexType ldA,
+                      const T *B, IndexType ldB,
+                      T *C, IndexType ldC,
+                      const F &epilogue)
+{
+    typedef GemmBlockSize<T> BS;
+
+    const bool transposedA = (transA==Trans) || (transA==ConjTrans);
+    const bool transposedB = (transB==Trans) || (transB==ConjTrans);
+    const bool conjA = (transA==Conj) || (transA==ConjTrans);
+    const bool conjB = (transB==Conj) || (transB==ConjTrans);
+    const IndexType rsA = transposedA ? ldA : 1, csA = transposedA ? 1 : ldA;
+    const IndexType rsB = transposedB ? ldB : 1, csB = transposedB ? 1 : ldB;
+
+    gemm_packed_loop(m, n, k,
+        [&](IndexType ic, IndexType mc, IndexType pc, IndexType kc,
+            T *buffer) -> const T *
+        {
+            gemm_pack_a<BS::MR>(mc, kc, alpha, conjA,
+                                A + ic*rsA + pc*csA, rsA, csA, buffer);
+            return buffer;
+        },
+        [&](IndexType jc, IndexType nc, IndexType pc, IndexType kc,
+            T *buffer) -> const T *
+        {
+            gemm_pack_b<BS::NR>(kc, nc, conjB, B + pc*rsB + jc*csB, rsB, csB,
+                                buffer);
+            return buffer;
+        },
+        [&](IndexType ic, IndexType mc, IndexType jc, IndexType nc)
+        {
+            gemm_epilogue_apply(ColMajor, ic, mc, jc, nc, C, ldC, epilogue);
+        },
+        C, ldC);
+}
+
+template <typename IndexType, typename ALPHA, typename T, typename BETA,
+          typename F>
+bool
+gemm_epilogue_blocked(StorageOrder, Transpose, Transpose,
+                      IndexType, IndexType, IndexType,
+                      const ALPHA &, const T *, IndexType, const T *, IndexType,
+                      const BETA &, T *, IndexType, const F &,
+                      std::false_type)
+{
+    return false;
+}
+
+template <typename IndexType, typename ALPHA, typename T, typename BETA,
+          typename F>
+bool
+gemm_epilogue_blocked(StorageOrder order,
+                      Transpose transA, Transpose transB,
+                      IndexType m, IndexType n, IndexType k,
+                      const ALPHA &alpha,
+                      const T *A, IndexType ldA,
+                      const T *B, IndexType ldB,
+                      const BETA &beta,
+                      T *C, IndexType ldC,
+                      const F &epilogue,
+                      std::true_type)
+{
+    typedef GemmBlockSize<T> BS;
+
+    // as in gemm_blocked, small products are not worth packing
+    const IndexType mc = (order==ColMajor) ? m : n;
+    const IndexType nc = (order==ColMajor) ? n : m;
+    if ((mc<BS::MR) || (nc<BS::NR) || (k<8) || (alpha==ALPHA(0))) {
+        return false;
+    }
+    CXXBLAS_DEBUG_OUT("gemm_epilogue_blocked");
+
+    gescal_init(order, m, n, beta, C, ldC);
+    if (order==ColMajor) {
+        gemm_epilogue_blocked(transA, transB, m, n, k, T(alpha),
+                              A, ldA, B, ldB, C, ldC, epilogue);
+    } else {
+        // C^T = op(B)^T * op(A)^T, the epilogue still sees C
+        gemm_epilogue_blocked(transB, transA, n, m, k, T(alpha),
+                              B, ldB, A, ldA, C, ldC,
+                              [&](IndexType i, IndexType j, const T &c)
+                              {
+                                  return epilogue(j, i, c);
+                              });
+    }
+    return true;
+}
+
+template <typename IndexType, typename ALPHA, typename T, typename BETA,
+          typename F>
+void
+gemm_epilogue(StorageOrder order,
+              Transpose transA, Transpose transB,
+              IndexType m, IndexType n, IndexType k,
+              const ALPHA &alpha,
+              const T *A, IndexType ldA,
+              const T *B, IndexType ldB,
+              const BETA &beta,
+              T *C, IndexType ldC,
+              const F &epilogue)
+{
+    CXXBLAS_DEBUG_OUT("gemm_epilogue");
+
+    if ((m==0) || (n==0)) {
+        return;
+    }
+    if (gemm_epilogue_blocked(order, transA, transB, m, n, k, alpha,
+                              A, ldA, B, ldB, beta, C, ldC, epilogue,
+                              GemmPackPanels<T>())) {
+        return;
+    }
+
+    // gemm on panels of whole columns (rows) of a column (row) major C,
+    // each followed by the epilogue
+    const IndexType rows = (order==ColMajor) ? m : n;
+    const IndexType cols = (order==ColMajor) ? n : m;
+    const IndexType width = std::max(IndexType(gemmEpilogueMinPanel),
+                                     IndexType(gemmEpiloguePanelElements)/rows);
+    for (IndexType p=0; p<cols; p+=width) {
+        IndexType w = std::min(width, cols-p);
+        if (order==ColMajor) {
+            // column p of op(B)
+            const bool transposedB = (transB==Trans) || (transB==ConjTrans);
+            gemm(order, transA, transB, m, w, k, alpha,
+                 A, ldA, B + (transposedB ? p : p*ldB), ldB,
+                 beta, C + p*ldC, ldC);
+            gemm_epilogue_apply(order, IndexType(0), m, p, w, C, ldC,
+                                epilogue);
+        } else {
+            // row p of op(A)
+            const bool transposedA = (transA==Trans) || (transA==ConjTrans);
+            gemm(order, transA, transB, w, n, k, alpha,
+                 A + (transposedA ? p : p*ldA), ldA, B, ldB,
+                 beta, C + p*ldC, ldC);
+            gemm_epilogue_apply(order, p, w, IndexType(0), n, C, ldC,
+                                epilogue);
+        }
+    }
+}
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_EPILOGUE_TCC
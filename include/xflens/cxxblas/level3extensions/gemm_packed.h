@@ -0,0 +1,113 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_PACKED_H
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_PACKED_H 1
+
+#include <type_traits>
+#include <vector>
+
+#include "xflens/cxxblas/drivers/drivers.h"
+#include "xflens/cxxblas/level3/gemm.h"
+#include "xflens/cxxblas/typedefs.h"
+
+#define HAVE_CXXBLAS_GEMM_PACKED 1
+
+namespace cxxblas {
+
+//
+//  C := alpha * op(A) * B + beta * C
+//
+//  for a fixed k x n operand B that is multiplied with many different A.
+//  gemm_pack stores op(B) once for C of a given storage order, gemm_compute
+//  then only packs A.  The generic kernel keeps op(B) in the sliver format
+//  of its micro kernel; with a BLAS driver op(B) is stored contiguously in
+//  the storage order of C and multiplied by ?gemm.
+//
+
+// whether gemm_pack stores op(B) as micro kernel slivers
+template <typename T>
+struct GemmPackPanels
+    : std::integral_constant<bool, GemmBlockSize<T>::blocked>
+{
+};
+
+#ifdef HAVE_CBLAS
+template <>
+struct GemmPackPanels<float> : std::false_type
+{
+};
+
+template <>
+struct GemmPackPanels<double> : std::false_type
+{
+};
+
+template <>
+struct GemmPackPanels<ComplexFloat> : std::false_type
+{
+};
+
+template <>
+struct GemmPackPanels<ComplexDouble> : std::false_type
+{
+};
+#endif // HAVE_CBLAS
+
+template <typename IndexType, typename T>
+struct GemmPacked
+{
+    StorageOrder    order = ColMajor;   // storage order of A and C
+    IndexType       k = 0, n = 0;
+    bool            panels = false;
+    std::vector<T>  data;
+};
+
+template <typename IndexType, typename T>
+    void
+    gemm_pack(StorageOrder order, Transpose transB,
+              IndexType k, IndexType n,
+              const T *B, IndexType ldB,
+              GemmPacked<IndexType, T> &packed);
+
+template <typename IndexType, typename ALPHA, typename BETA, typename T>
+    void
+    gemm_compute(Transpose transA, IndexType m,
+                 const ALPHA &alpha,
+                 const T *A, IndexType ldA,
+                 const GemmPacked<IndexType, T> &packed,
+                 const BETA &beta,
+                 T *C, IndexType ldC);
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_PACKED_H
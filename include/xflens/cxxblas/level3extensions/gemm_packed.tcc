@@ -0,0 +1,248 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_PACKED_TCC
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_PACKED_TCC 1
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+//
+//  In the sliver format op(B) is cut into blocks of NB columns and KC rows,
+//  each packed by gemm_pack_b into W-column slivers (NB = NC, W = NR for a
+//  column major C).  A row major C is computed as the column major
+//  C^T = op(B)^T * op(A)^T, where op(B)^T is the packed left operand of the
+//  micro kernel (NB = MC, W = MR); being unscaled, alpha is then applied
+//  when packing op(A)^T.  As every block but the last one has NB columns,
+//  a multiple of W, the block (jb, pc) starts at jb*k + pc*nbPadded.
+//
+
+template <int W, typename IndexType, typename T>
+void
+gemm_pack_slivers(IndexType k, IndexType n, IndexType NB, bool conj,
+                  const T *B, IndexType rs, IndexType cs, T *buffer)
+{
+    const IndexType KC = GemmBlockSize<T>::KC;
+
+    for (IndexType jb=0; jb<n; jb+=NB) {
+        IndexType nb = std::min(NB, n-jb);
+        IndexType nbPadded = ((nb+W-1)/W)*W;
+        for (IndexType pc=0; pc<k; pc+=KC) {
+            IndexType kc = std::min(KC, k-pc);
+            gemm_pack_b<W>(kc, nb, conj, B + pc*rs + jb*cs, rs, cs,
+                           buffer + jb*k + pc*nbPadded);
+        }
+    }
+}
+
+template <typename IndexType, typename T>
+void
+gemm_pack(StorageOrder order, Transpose transB,
+          IndexType k, IndexType n,
+          const T *B, IndexType ldB,
+          GemmPacked<IndexType, T> &packed)
+{
+    CXXBLAS_DEBUG_OUT("gemm_pack");
+
+    typedef GemmBlockSize<T> BS;
+
+    packed.order = order;
+    packed.k = k;
+    packed.n = n;
+    packed.panels = GemmPackPanels<T>::value;
+
+    // op(B)(l,j) = B[l*rs + j*cs]
+    const bool transposed = (transB==Trans) || (transB==ConjTrans);
+    const bool conj = (transB==Conj) || (transB==ConjTrans);
+    const bool rowwise = transposed != (order==RowMajor);
+    const IndexType rs = rowwise ? ldB : 1, cs = rowwise ? 1 : ldB;
+
+    if (!packed.panels) {
+        // op(B) in the storage order of C
+        packed.data.resize(k*n);
+        for (IndexType l=0; l<k; ++l) {
+            for (IndexType j=0; j<n; ++j) {
+                const T &b = B[l*rs + j*cs];
+                packed.data[order==RowMajor ? l*n+j : l+j*k]
+                    = conj ? conjugate(b) : b;
+            }
+        }
+        return;
+    }
+
+    if (order==ColMajor) {
+        packed.data.resize(k*(((n+BS::NR-1)/BS::NR)*BS::NR));
+        gemm_pack_slivers<BS::NR>(k, n, IndexType(BS::NC), conj, B, rs, cs,
+                                  packed.data.data());
+    } else {
+        packed.data.resize(k*(((n+BS::MR-1)/BS::MR)*BS::MR));
+        gemm_pack_slivers<BS::MR>(k, n, IndexType(BS::MC), conj, B, rs, cs,
+                                  packed.data.data());
+    }
+}
+
+//
+//  Column major C := C + left * right for an m x k left and a k x n right
+//  operand, given as functions that return the packed block of rows ic or
+//  columns jc for the rows pc of the inner dimension, using the given
+//  buffer if they need to pack.  tile(ic, mc, jc, nc) is called on each
+//  block of C once it is complete, by the thread that computed it.
+//
+template <typename IndexType, typename T, typename PackLeft,
+          typename PackRight, typename Tile>
+void
+gemm_packed_loop(IndexType m, IndexType n, IndexType k,
+                 const PackLeft &packLeft, const PackRight &packRight,
+                 const Tile &tile, T *C, IndexType ldC)
+{
+    typedef GemmBlockSize<T> BS;
+    const IndexType MR = BS::MR, NR = BS::NR;
+    const IndexType MC_ = BS::MC, KC = BS::KC, NC = BS::NC;
+
+    const IndexType ncMax = std::min(NC, ((n+NR-1)/NR)*NR);
+    const IndexType mcMax = std::min(MC_, ((m+MR-1)/MR)*MR);
+    const IndexType kcMax = std::min(KC, k);
+    std::vector<T> bufferB(kcMax*ncMax);
+    const IndexType numBlocksA = (m+MC_-1)/MC_;
+
+    for (IndexType jc=0; jc<n; jc+=NC) {
+        IndexType nc = std::min(NC, n-jc);
+        for (IndexType pc=0; pc<k; pc+=KC) {
+            IndexType kc = std::min(KC, k-pc);
+            const T *b = packRight(jc, nc, pc, kc, bufferB.data());
+
+            parallel_for(numBlocksA, [&](IndexType block) {
+                IndexType ic = block*MC_;
+                IndexType mc = std::min(MC_, m-ic);
+
+                std::vector<T> bufferA(mcMax*kcMax);
+                const T *a = packLeft(ic, mc, pc, kc, bufferA.data());
+                for (IndexType jr=0; jr<nc; jr+=NR) {
+                    IndexType nr = std::min(NR, nc-jr);
+                    for (IndexType ir=0; ir<mc; ir+=MR) {
+                        IndexType mr = std::min(MR, mc-ir);
+                        gemm_micro_kernel<BS::MR, BS::NR>(
+                            kc, a + ir*kc, b + jr*kc,
+                            C + (ic+ir) + (jc+jr)*ldC, ldC, mr, nr);
+                    }
+                }
+                if (pc+kc==k) {
+                    tile(ic, mc, jc, nc);
+                }
+            });
+        }
+    }
+}
+
+template <typename IndexType, typename ALPHA, typename BETA, typename T>
+void
+gemm_compute(Transpose transA, IndexType m,
+             const ALPHA &alpha,
+             const T *A, IndexType ldA,
+             const GemmPacked<IndexType, T> &packed,
+             const BETA &beta,
+             T *C, IndexType ldC)
+{
+    const StorageOrder order = packed.order;
+    const IndexType k = packed.k, n = packed.n;
+
+    if (!packed.panels) {
+        gemm(order, transA, NoTrans, m, n, k,
+             alpha, A, ldA, packed.data.data(), order==RowMajor ? n : k,
+             beta, C, ldC);
+        return;
+    }
+    CXXBLAS_DEBUG_OUT("gemm_compute");
+
+    if ((m==0) || (n==0)) {
+        return;
+    }
+    gescal_init(order, m, n, beta, C, ldC);
+    if (alpha==ALPHA(0) || k==0) {
+        return;
+    }
+
+    typedef GemmBlockSize<T> BS;
+    const T alpha_ = T(alpha);
+    const bool transposed = (transA==Trans) || (transA==ConjTrans);
+    const bool conj = (transA==Conj) || (transA==ConjTrans);
+    const T *B = packed.data.data();
+
+    // op(A)(i,l) = A[i*rs + l*cs] if A is column major, and
+    // op(A)^T(l,i) = A[l*rs + i*cs] if it is row major
+    const IndexType rs = transposed ? ldA : 1, cs = transposed ? 1 : ldA;
+
+    if (order==ColMajor) {
+        gemm_packed_loop(m, n, k,
+            [&](IndexType ic, IndexType mc, IndexType pc, IndexType kc,
+                T *buffer) -> const T *
+            {
+                gemm_pack_a<BS::MR>(mc, kc, alpha_, conj,
+                                    A + ic*rs + pc*cs, rs, cs, buffer);
+                return buffer;
+            },
+            [&](IndexType jc, IndexType nc, IndexType pc, IndexType,
+                T *) -> const T *
+            {
+                return B + jc*k + pc*(((nc+BS::NR-1)/BS::NR)*BS::NR);
+            },
+            [](IndexType, IndexType, IndexType, IndexType) {},
+            C, ldC);
+    } else {
+        gemm_packed_loop(n, m, k,
+            [&](IndexType ic, IndexType mc, IndexType pc, IndexType,
+                T *) -> const T *
+            {
+                return B + ic*k + pc*(((mc+BS::MR-1)/BS::MR)*BS::MR);
+            },
+            [&](IndexType jc, IndexType nc, IndexType pc, IndexType kc,
+                T *buffer) -> const T *
+            {
+                gemm_pack_b<BS::NR>(kc, nc, conj, A + pc*rs + jc*cs, rs, cs,
+                                    buffer);
+                if (alpha_!=T(1)) {
+                    IndexType size = kc*(((nc+BS::NR-1)/BS::NR)*BS::NR);
+                    for (IndexType i=0; i<size; ++i) {
+                        buffer[i] *= alpha_;
+                    }
+                }
+                return buffer;
+            },
+            [](IndexType, IndexType, IndexType, IndexType) {},
+            C, ldC);
+    }
+}
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_PACKED_TCC
@@ -0,0 +1,103 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_REDUCED_H
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_REDUCED_H 1
+
+#include <cstdint>
+#include "xflens/cxxblas/drivers/drivers.h"
+#include "xflens/cxxblas/typedefs.h"
+
+#define HAVE_CXXBLAS_GEMM_REDUCED 1
+
+namespace cxxblas {
+
+//
+//  C := alpha * op(A) * op(B) + beta * C
+//
+//  for A and B of a 16 bit floating point type, passed as their bits, and
+//  a float C, or for 8 bit integer A and B, shifted by the offsets ao and
+//  bo, and an int32 C.  Only available if the BLAS driver provides the
+//  routine.
+//
+
+#ifdef HAVE_CBLAS_GEMM_BF16
+
+// bfloat16 A and B
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemm_bf16(StorageOrder order,
+              Transpose transA, Transpose transB,
+              IndexType m, IndexType n, IndexType k,
+              float alpha,
+              const unsigned short *A, IndexType ldA,
+              const unsigned short *B, IndexType ldB,
+              float beta,
+              float *C, IndexType ldC);
+
+#endif // HAVE_CBLAS_GEMM_BF16
+
+#ifdef HAVE_CBLAS_GEMM_F16
+
+// IEEE half precision A and B
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemm_f16(StorageOrder order,
+             Transpose transA, Transpose transB,
+             IndexType m, IndexType n, IndexType k,
+             float alpha,
+             const unsigned short *A, IndexType ldA,
+             const unsigned short *B, IndexType ldB,
+             float beta,
+             float *C, IndexType ldC);
+
+#endif // HAVE_CBLAS_GEMM_F16
+
+#ifdef HAVE_CBLAS_GEMM_S8U8S32
+
+// int8 A and uint8 B
+template <typename IndexType>
+    typename If<IndexType>::isBlasCompatibleInteger
+    gemm_s8u8s32(StorageOrder order,
+                 Transpose transA, Transpose transB,
+                 IndexType m, IndexType n, IndexType k,
+                 float alpha,
+                 const std::int8_t *A, IndexType ldA, std::int8_t ao,
+                 const std::uint8_t *B, IndexType ldB, std::int8_t bo,
+                 float beta,
+                 std::int32_t *C, IndexType ldC);
+
+#endif // HAVE_CBLAS_GEMM_S8U8S32
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_REDUCED_H
@@ -0,0 +1,144 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_REDUCED_TCC
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_REDUCED_TCC 1
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+#if defined(HAVE_CBLAS_GEMM_BF16) || defined(HAVE_CBLAS_GEMM_F16) \
+ || defined(HAVE_CBLAS_GEMM_S8U8S32)
+
+namespace detail {
+
+// the data is real, so a conjugation is a no-op
+inline Transpose
+gemm_reduced_trans(Transpose trans)
+{
+    return (trans==Trans || trans==ConjTrans) ? Trans : NoTrans;
+}
+
+} // namespace detail
+
+#endif
+
+#ifdef HAVE_CBLAS_GEMM_BF16
+
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemm_bf16(StorageOrder order,
+          Transpose transA, Transpose transB,
+          IndexType m, IndexType n, IndexType k,
+          float alpha,
+          const unsigned short *A, IndexType ldA,
+          const unsigned short *B, IndexType ldB,
+          float beta,
+          float *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_gemm_bf16");
+
+    CBLAS_GEMM_BF16(CBLAS::getCblasType(order),
+                    CBLAS::getCblasType(detail::gemm_reduced_trans(transA)),
+                    CBLAS::getCblasType(detail::gemm_reduced_trans(transB)),
+                    m, n, k,
+                    alpha,
+                    A, ldA,
+                    B, ldB,
+                    beta,
+                    C, ldC);
+}
+
+#endif // HAVE_CBLAS_GEMM_BF16
+
+#ifdef HAVE_CBLAS_GEMM_F16
+
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemm_f16(StorageOrder order,
+         Transpose transA, Transpose transB,
+         IndexType m, IndexType n, IndexType k,
+         float alpha,
+         const unsigned short *A, IndexType ldA,
+         const unsigned short *B, IndexType ldB,
+         float beta,
+         float *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_gemm_f16");
+
+    CBLAS_GEMM_F16(CBLAS::getCblasType(order),
+                   CBLAS::getCblasType(detail::gemm_reduced_trans(transA)),
+                   CBLAS::getCblasType(detail::gemm_reduced_trans(transB)),
+                   m, n, k,
+                   alpha,
+                   A, ldA,
+                   B, ldB,
+                   beta,
+                   C, ldC);
+}
+
+#endif // HAVE_CBLAS_GEMM_F16
+
+#ifdef HAVE_CBLAS_GEMM_S8U8S32
+
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemm_s8u8s32(StorageOrder order,
+             Transpose transA, Transpose transB,
+             IndexType m, IndexType n, IndexType k,
+             float alpha,
+             const std::int8_t *A, IndexType ldA, std::int8_t ao,
+             const std::uint8_t *B, IndexType ldB, std::int8_t bo,
+             float beta,
+             std::int32_t *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_gemm_s8u8s32");
+
+    const int co = 0;
+    CBLAS_GEMM_S8U8S32(CBLAS::getCblasType(order),
+                       CBLAS::getCblasType(detail::gemm_reduced_trans(transA)),
+                       CBLAS::getCblasType(detail::gemm_reduced_trans(transB)),
+                       CblasFixOffset,
+                       m, n, k,
+                       alpha,
+                       A, ldA, static_cast<char>(ao),
+                       B, ldB, static_cast<char>(bo),
+                       beta,
+                       reinterpret_cast<int *>(C), ldC, &co);
+}
+
+#endif // HAVE_CBLAS_GEMM_S8U8S32
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_REDUCED_TCC
@@ -0,0 +1,70 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_SCATTER_H
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_SCATTER_H 1
+
+#include "xflens/cxxblas/drivers/drivers.h"
+#include "xflens/cxxblas/typedefs.h"
+
+#define HAVE_CXXBLAS_GEMM_SCATTER 1
+
+namespace cxxblas {
+
+//
+//  C := alpha * A * B + beta * C
+//
+//  for a column major m x n C and operands given by the element offsets of
+//  their rows and columns (scatter vectors):
+//
+//      A(i,l) = A[rowsA[i] + colsA[l]],   B(l,j) = B[rowsB[l] + colsB[j]].
+//
+//  This describes any strided block of a tensor, e.g. the free and
+//  contracted axes of the operands of a contraction, whatever their order
+//  in memory.  The generic kernel packs its slivers straight from these
+//  offsets, so no permuted copy of A or B is made; types it does not block
+//  are multiplied by dot products.
+//
+
+template <typename IndexType, typename ALPHA, typename T, typename BETA>
+    void
+    gemm_scatter(IndexType m, IndexType n, IndexType k,
+                 const ALPHA &alpha,
+                 const T *A, const IndexType *rowsA, const IndexType *colsA,
+                 const T *B, const IndexType *rowsB, const IndexType *colsB,
+                 const BETA &beta,
+                 T *C, IndexType ldC);
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_SCATTER_H
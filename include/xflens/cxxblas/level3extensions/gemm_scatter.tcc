@@ -0,0 +1,169 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_SCATTER_TCC
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_SCATTER_TCC 1
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+// as gemm_pack_a, for A(i,l) = A[rows[i] + cols[l]]
+template <int MR, typename IndexType, typename T>
+void
+gemm_scatter_pack_a(IndexType mc, IndexType kc, const T &alpha,
+                    const T *A, const IndexType *rows, const IndexType *cols,
+                    T *buffer)
+{
+    for (IndexType ir=0; ir<mc; ir+=MR) {
+        IndexType mr = std::min(IndexType(MR), mc-ir);
+        for (IndexType l=0; l<kc; ++l) {
+            const T *a = A + cols[l];
+            for (IndexType i=0; i<mr; ++i) {
+                buffer[i] = alpha*a[rows[ir+i]];
+            }
+            for (IndexType i=mr; i<MR; ++i) {
+                buffer[i] = T(0);
+            }
+            buffer += MR;
+        }
+    }
+}
+
+// as gemm_pack_b, for B(l,j) = B[rows[l] + cols[j]]
+template <int NR, typename IndexType, typename T>
+void
+gemm_scatter_pack_b(IndexType kc, IndexType nc,
+                    const T *B, const IndexType *rows, const IndexType *cols,
+                    T *buffer)
+{
+    for (IndexType jr=0; jr<nc; jr+=NR) {
+        IndexType nr = std::min(IndexType(NR), nc-jr);
+        for (IndexType l=0; l<kc; ++l) {
+            const T *b = B + rows[l];
+            for (IndexType j=0; j<nr; ++j) {
+                buffer[j] = b[cols[jr+j]];
+            }
+            for (IndexType j=nr; j<NR; ++j) {
+                buffer[j] = T(0);
+            }
+            buffer += NR;
+        }
+    }
+}
+
+template <typename IndexType, typename T>
+bool
+gemm_scatter_blocked(IndexType, IndexType, IndexType, const T &,
+                     const T *, const IndexType *, const IndexType *,
+                     const T *, const IndexType *, const IndexType *,
+                     T *, IndexType, std::false_type)
+{
+    return false;
+}
+
+template <typename IndexType, typename T>
+bool
+gemm_scatter_blocked(IndexType m, IndexType n, IndexType k, const T &alpha,
+                     const T *A, const IndexType *rowsA, const IndexType *colsA,
+                     const T *B, const IndexType *rowsB, const IndexType *colsB,
+                     T *C, IndexType ldC, std::true_type)
+{
+    typedef GemmBlockSize<T> BS;
+
+    // as in gemm_blocked, small products are not worth packing
+    if ((m<BS::MR) || (n<BS::NR) || (k<8)) {
+        return false;
+    }
+    CXXBLAS_DEBUG_OUT("gemm_scatter_blocked");
+
+    gemm_packed_loop(m, n, k,
+        [&](IndexType ic, IndexType mc, IndexType pc, IndexType kc,
+            T *buffer) -> const T *
+        {
+            gemm_scatter_pack_a<BS::MR>(mc, kc, alpha, A, rowsA + ic,
+                                        colsA + pc, buffer);
+            return buffer;
+        },
+        [&](IndexType jc, IndexType nc, IndexType pc, IndexType kc,
+            T *buffer) -> const T *
+        {
+            gemm_scatter_pack_b<BS::NR>(kc, nc, B, rowsB + pc, colsB + jc,
+                                        buffer);
+            return buffer;
+        },
+        [](IndexType, IndexType, IndexType, IndexType) {},
+        C, ldC);
+    return true;
+}
+
+template <typename IndexType, typename ALPHA, typename T, typename BETA>
+void
+gemm_scatter(IndexType m, IndexType n, IndexType k,
+             const ALPHA &alpha,
+             const T *A, const IndexType *rowsA, const IndexType *colsA,
+             const T *B, const IndexType *rowsB, const IndexType *colsB,
+             const BETA &beta,
+             T *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("gemm_scatter");
+
+    if ((m==0) || (n==0)) {
+        return;
+    }
+    gescal_init(ColMajor, m, n, beta, C, ldC);
+    if (alpha==ALPHA(0) || k==0) {
+        return;
+    }
+    const T alpha_ = T(alpha);
+    if (gemm_scatter_blocked(m, n, k, alpha_, A, rowsA, colsA, B, rowsB, colsB,
+                             C, ldC,
+                             std::integral_constant<bool,
+                                                    GemmBlockSize<T>::blocked>())) {
+        return;
+    }
+
+    parallel_for(n, [&](IndexType j) {
+        for (IndexType i=0; i<m; ++i) {
+            T sum = T(0);
+            for (IndexType l=0; l<k; ++l) {
+                sum += A[rowsA[i] + colsA[l]]*B[rowsB[l] + colsB[j]];
+            }
+            C[i+j*ldC] += alpha_*sum;
+        }
+    });
+}
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_SCATTER_TCC
@@ -0,0 +1,186 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_STRASSEN_TCC
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_STRASSEN_TCC 1
+
+#include <vector>
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+// column major Z := X + sign*Y for m x n blocks
+template <typename IndexType, typename T>
+void
+strassen_add(IndexType m, IndexType n,
+             const T *X, IndexType ldX, bool subtract,
+             const T *Y, IndexType ldY,
+             T *Z, IndexType ldZ)
+{
+    for (IndexType j=0; j<n; ++j) {
+        const T *x = X + j*ldX;
+        const T *y = Y + j*ldY;
+        T *z = Z + j*ldZ;
+        if (subtract) {
+            for (IndexType i=0; i<m; ++i) {
+                z[i] = x[i] - y[i];
+            }
+        } else {
+            for (IndexType i=0; i<m; ++i) {
+                z[i] = x[i] + y[i];
+            }
+        }
+    }
+}
+
+template <typename IndexType>
+bool
+strassen_recurse(IndexType m, IndexType n, IndexType k, IndexType crossover)
+{
+    return (m>crossover) && (n>crossover) && (k>crossover)
+        && (m>=2) && (n>=2) && (k>=2);
+}
+
+// elements of workspace used by strassen_level and its recursion
+template <typename IndexType>
+IndexType
+strassen_workspace(IndexType m, IndexType n, IndexType k, IndexType crossover)
+{
+    if (!strassen_recurse(m, n, k, crossover)) {
+        return 0;
+    }
+    IndexType mh = m/2, nh = n/2, kh = k/2;
+    return mh*std::max(kh, nh) + kh*nh
+         + strassen_workspace(mh, nh, kh, crossover);
+}
+
+//
+//  Column major C := A * B.  Even leading parts are multiplied with the
+//  schedule of Boyer, Dumas, Pernet and Zhou ("Memory efficient scheduling
+//  of Strassen-Winograd's matrix multiplication algorithm", 2009): two
+//  temporaries X, Y and the quadrants of C hold all intermediate results.
+//  A trailing odd row, column or inner index is added by gemm.
+//
+template <typename IndexType, typename T>
+void
+strassen_level(IndexType m, IndexType n, IndexType k,
+               const T *A, IndexType ldA,
+               const T *B, IndexType ldB,
+               T *C, IndexType ldC,
+               IndexType crossover, T *work)
+{
+    if (!strassen_recurse(m, n, k, crossover)) {
+        gemm(ColMajor, NoTrans, NoTrans, m, n, k,
+             T(1), A, ldA, B, ldB, T(0), C, ldC);
+        return;
+    }
+
+    const IndexType mh = m/2, nh = n/2, kh = k/2;
+    const T *A11 = A, *A21 = A + mh, *A12 = A + kh*ldA, *A22 = A12 + mh;
+    const T *B11 = B, *B21 = B + kh, *B12 = B + nh*ldB, *B22 = B12 + kh;
+    T *C11 = C, *C21 = C + mh, *C12 = C + nh*ldC, *C22 = C12 + mh;
+
+    // X is mh x kh or mh x nh, Y kh x nh
+    T *X = work, *Y = work + mh*std::max(kh, nh), *next = Y + kh*nh;
+    const IndexType ldX = mh, ldY = kh;
+
+    auto product = [&](const T *P, IndexType ldP, const T *Q, IndexType ldQ,
+                       T *R, IndexType ldR)
+    {
+        strassen_level(mh, nh, kh, P, ldP, Q, ldQ, R, ldR, crossover, next);
+    };
+
+    strassen_add(mh, kh, A11, ldA, true, A21, ldA, X, ldX);     // S3
+    strassen_add(kh, nh, B22, ldB, true, B12, ldB, Y, ldY);     // T3
+    product(X, ldX, Y, ldY, C21, ldC);                          // P7
+    strassen_add(mh, kh, A21, ldA, false, A22, ldA, X, ldX);    // S1
+    strassen_add(kh, nh, B12, ldB, true, B11, ldB, Y, ldY);     // T1
+    product(X, ldX, Y, ldY, C22, ldC);                          // P5
+    strassen_add(mh, kh, X, ldX, true, A11, ldA, X, ldX);       // S2
+    strassen_add(kh, nh, B22, ldB, true, Y, ldY, Y, ldY);       // T2
+    product(X, ldX, Y, ldY, C12, ldC);                          // P6
+    strassen_add(mh, kh, A12, ldA, true, X, ldX, X, ldX);       // S4
+    product(X, ldX, B22, ldB, C11, ldC);                        // P3
+    product(A11, ldA, B11, ldB, X, ldX);                        // P1
+    strassen_add(mh, nh, X, ldX, false, C12, ldC, C12, ldC);    // U2
+    strassen_add(mh, nh, C12, ldC, false, C21, ldC, C21, ldC);  // U3
+    strassen_add(mh, nh, C12, ldC, false, C22, ldC, C12, ldC);  // U4
+    strassen_add(mh, nh, C21, ldC, false, C22, ldC, C22, ldC);  // U7
+    strassen_add(mh, nh, C12, ldC, false, C11, ldC, C12, ldC);  // U5
+    strassen_add(kh, nh, Y, ldY, true, B21, ldB, Y, ldY);       // T4
+    product(A22, ldA, Y, ldY, C11, ldC);                        // P4
+    strassen_add(mh, nh, C21, ldC, true, C11, ldC, C21, ldC);   // U6
+    product(A12, ldA, B21, ldB, C11, ldC);                      // P2
+    strassen_add(mh, nh, X, ldX, false, C11, ldC, C11, ldC);    // U1
+
+    // dynamic peeling of odd dimensions
+    const IndexType me = 2*mh, ne = 2*nh, ke = 2*kh;
+    if (ke<k) {
+        gemm(ColMajor, NoTrans, NoTrans, me, ne, k-ke,
+             T(1), A + ke*ldA, ldA, B + ke, ldB, T(1), C, ldC);
+    }
+    if (ne<n) {
+        gemm(ColMajor, NoTrans, NoTrans, m, n-ne, k,
+             T(1), A, ldA, B + ne*ldB, ldB, T(0), C + ne*ldC, ldC);
+    }
+    if (me<m) {
+        gemm(ColMajor, NoTrans, NoTrans, m-me, ne, k,
+             T(1), A + me, ldA, B, ldB, T(0), C + me, ldC);
+    }
+}
+
+template <typename IndexType, typename T>
+void
+gemm_strassen(StorageOrder order,
+              IndexType m, IndexType n, IndexType k,
+              const T *A, IndexType ldA,
+              const T *B, IndexType ldB,
+              T *C, IndexType ldC,
+              IndexType crossover)
+{
+    CXXBLAS_DEBUG_OUT("gemm_strassen");
+
+    if (order==RowMajor) {
+        gemm_strassen(ColMajor, n, m, k, B, ldB, A, ldA, C, ldC, crossover);
+        return;
+    }
+    if ((m==0) || (n==0)) {
+        return;
+    }
+    std::vector<T> work(strassen_workspace(m, n, k, crossover));
+    strassen_level(m, n, k, A, ldA, B, ldB, C, ldC, crossover, work.data());
+}
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_STRASSEN_TCC
@@ -0,0 +1,101 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_STRIDED_H
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_STRIDED_H 1
+
+#include "xflens/cxxblas/drivers/drivers.h"
+#include "xflens/cxxblas/typedefs.h"
+
+#define HAVE_CXXBLAS_GEMM_STRIDED 1
+
+namespace cxxblas {
+
+//
+//  C := alpha * op(A) * op(B) + beta * C
+//
+//  for matrices given by a row and a column stride each instead of a
+//  storage order and a leading dimension, so that neither has to be unit.
+//  Only available with the typed API of BLIS.
+//
+
+#ifdef HAVE_BLIS_TYPED_API
+
+// sgemm
+template <typename IndexType>
+    void
+    gemm_strided(Transpose transA, Transpose transB,
+                 IndexType m, IndexType n, IndexType k,
+                 float alpha,
+                 const float *A, IndexType rsA, IndexType csA,
+                 const float *B, IndexType rsB, IndexType csB,
+                 float beta,
+                 float *C, IndexType rsC, IndexType csC);
+
+// dgemm
+template <typename IndexType>
+    void
+    gemm_strided(Transpose transA, Transpose transB,
+                 IndexType m, IndexType n, IndexType k,
+                 double alpha,
+                 const double *A, IndexType rsA, IndexType csA,
+                 const double *B, IndexType rsB, IndexType csB,
+                 double beta,
+                 double *C, IndexType rsC, IndexType csC);
+
+// cgemm
+template <typename IndexType>
+    void
+    gemm_strided(Transpose transA, Transpose transB,
+                 IndexType m, IndexType n, IndexType k,
+                 const ComplexFloat &alpha,
+                 const ComplexFloat *A, IndexType rsA, IndexType csA,
+                 const ComplexFloat *B, IndexType rsB, IndexType csB,
+                 const ComplexFloat &beta,
+                 ComplexFloat *C, IndexType rsC, IndexType csC);
+
+// zgemm
+template <typename IndexType>
+    void
+    gemm_strided(Transpose transA, Transpose transB,
+                 IndexType m, IndexType n, IndexType k,
+                 const ComplexDouble &alpha,
+                 const ComplexDouble *A, IndexType rsA, IndexType csA,
+                 const ComplexDouble *B, IndexType rsB, IndexType csB,
+                 const ComplexDouble &beta,
+                 ComplexDouble *C, IndexType rsC, IndexType csC);
+
+#endif // HAVE_BLIS_TYPED_API
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_STRIDED_H
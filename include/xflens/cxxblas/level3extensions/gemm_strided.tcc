@@ -0,0 +1,134 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMM_STRIDED_TCC
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMM_STRIDED_TCC 1
+
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+#ifdef HAVE_BLIS_TYPED_API
+
+// sgemm
+template <typename IndexType>
+void
+gemm_strided(Transpose transA, Transpose transB,
+             IndexType m, IndexType n, IndexType k,
+             float alpha,
+             const float *A, IndexType rsA, IndexType csA,
+             const float *B, IndexType rsB, IndexType csB,
+             float beta,
+             float *C, IndexType rsC, IndexType csC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] bli_sgemm");
+
+    bli_sgemm(BLIS::getBlisType(transA), BLIS::getBlisType(transB),
+              BLIS_DIM_TYPE(m), BLIS_DIM_TYPE(n), BLIS_DIM_TYPE(k),
+              &alpha,
+              A, BLIS_DIM_TYPE(rsA), BLIS_DIM_TYPE(csA),
+              B, BLIS_DIM_TYPE(rsB), BLIS_DIM_TYPE(csB),
+              &beta,
+              C, BLIS_DIM_TYPE(rsC), BLIS_DIM_TYPE(csC));
+}
+
+// dgemm
+template <typename IndexType>
+void
+gemm_strided(Transpose transA, Transpose transB,
+             IndexType m, IndexType n, IndexType k,
+             double alpha,
+             const double *A, IndexType rsA, IndexType csA,
+             const double *B, IndexType rsB, IndexType csB,
+             double beta,
+             double *C, IndexType rsC, IndexType csC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] bli_dgemm");
+
+    bli_dgemm(BLIS::getBlisType(transA), BLIS::getBlisType(transB),
+              BLIS_DIM_TYPE(m), BLIS_DIM_TYPE(n), BLIS_DIM_TYPE(k),
+              &alpha,
+              A, BLIS_DIM_TYPE(rsA), BLIS_DIM_TYPE(csA),
+              B, BLIS_DIM_TYPE(rsB), BLIS_DIM_TYPE(csB),
+              &beta,
+              C, BLIS_DIM_TYPE(rsC), BLIS_DIM_TYPE(csC));
+}
+
+// cgemm
+template <typename IndexType>
+void
+gemm_strided(Transpose transA, Transpose transB,
+             IndexType m, IndexType n, IndexType k,
+             const ComplexFloat &alpha,
+             const ComplexFloat *A, IndexType rsA, IndexType csA,
+             const ComplexFloat *B, IndexType rsB, IndexType csB,
+             const ComplexFloat &beta,
+             ComplexFloat *C, IndexType rsC, IndexType csC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] bli_cgemm");
+
+    bli_cgemm(BLIS::getBlisType(transA), BLIS::getBlisType(transB),
+              BLIS_DIM_TYPE(m), BLIS_DIM_TYPE(n), BLIS_DIM_TYPE(k),
+              &alpha,
+              A, BLIS_DIM_TYPE(rsA), BLIS_DIM_TYPE(csA),
+              B, BLIS_DIM_TYPE(rsB), BLIS_DIM_TYPE(csB),
+              &beta,
+              C, BLIS_DIM_TYPE(rsC), BLIS_DIM_TYPE(csC));
+}
+
+// zgemm
+template <typename IndexType>
+void
+gemm_strided(Transpose transA, Transpose transB,
+             IndexType m, IndexType n, IndexType k,
+             const ComplexDouble &alpha,
+             const ComplexDouble *A, IndexType rsA, IndexType csA,
+             const ComplexDouble *B, IndexType rsB, IndexType csB,
+             const ComplexDouble &beta,
+             ComplexDouble *C, IndexType rsC, IndexType csC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] bli_zgemm");
+
+    bli_zgemm(BLIS::getBlisType(transA), BLIS::getBlisType(transB),
+              BLIS_DIM_TYPE(m), BLIS_DIM_TYPE(n), BLIS_DIM_TYPE(k),
+              &alpha,
+              A, BLIS_DIM_TYPE(rsA), BLIS_DIM_TYPE(csA),
+              B, BLIS_DIM_TYPE(rsB), BLIS_DIM_TYPE(csB),
+              &beta,
+              C, BLIS_DIM_TYPE(rsC), BLIS_DIM_TYPE(csC));
+}
+
+#endif // HAVE_BLIS_TYPED_API
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMM_STRIDED_TCC
@@ -0,0 +1,244 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXBLAS_LEVEL3EXTENSIONS_GEMMT_TCC
+#define CXXBLAS_LEVEL3EXTENSIONS_GEMMT_TCC 1
+
+#include <algorithm>
+#include <vector>
+#include "xflens/cxxblas/cxxblas.h"
+
+namespace cxxblas {
+
+//
+//  Column major C is computed in blocks of gemmt_block columns: the part
+//  of a block column off the diagonal by gemm, the diagonal tile by gemm
+//  into a buffer, of which only the triangle is added to C.
+//
+const int gemmt_block = 64;
+
+template <typename IndexType, typename ALPHA, typename MA, typename MB,
+          typename BETA, typename MC>
+void
+gemmt_generic(StorageOrder order, StorageUpLo upLo,
+              Transpose transA, Transpose transB,
+              IndexType n, IndexType k,
+              const ALPHA &alpha,
+              const MA *A, IndexType ldA,
+              const MB *B, IndexType ldB,
+              const BETA &beta,
+              MC *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("gemmt_generic");
+
+    if (n==0) {
+        return;
+    }
+    // row major C is the column major C^T = op(B)^T * op(A)^T
+    if (order==RowMajor) {
+        gemmt_generic(ColMajor, (upLo==Upper) ? Lower : Upper,
+                      transB, transA, n, k, alpha,
+                      B, ldB, A, ldA, beta, C, ldC);
+        return;
+    }
+
+    const bool transposedA = (transA==Trans) || (transA==ConjTrans);
+    const bool transposedB = (transB==Trans) || (transB==ConjTrans);
+    // strides between the rows of op(A) and the columns of op(B)
+    const IndexType rowA = transposedA ? ldA : 1;
+    const IndexType colB = transposedB ? 1 : ldB;
+
+    std::vector<MC> tile(gemmt_block*gemmt_block);
+    for (IndexType j0=0; j0<n; j0+=gemmt_block) {
+        IndexType jb = std::min(IndexType(gemmt_block), n-j0);
+        const MB *Bj = B + j0*colB;
+
+        if (upLo==Lower && j0+jb<n) {
+            gemm(ColMajor, transA, transB, n-j0-jb, jb, k, alpha,
+                 A + (j0+jb)*rowA, ldA, Bj, ldB,
+                 beta, C + (j0+jb) + j0*ldC, ldC);
+        }
+        if (upLo==Upper && j0>0) {
+            gemm(ColMajor, transA, transB, j0, jb, k, alpha,
+                 A, ldA, Bj, ldB,
+                 beta, C + j0*ldC, ldC);
+        }
+
+        gemm(ColMajor, transA, transB, jb, jb, k, alpha,
+             A + j0*rowA, ldA, Bj, ldB,
+             MC(0), tile.data(), jb);
+        for (IndexType j=0; j<jb; ++j) {
+            IndexType i0 = (upLo==Lower) ? j : 0;
+            IndexType i1 = (upLo==Lower) ? jb : j+1;
+            for (IndexType i=i0; i<i1; ++i) {
+                MC &c = C[(j0+i) + (j0+j)*ldC];
+                c = (beta==BETA(0)) ? tile[i+j*jb] : tile[i+j*jb] + beta*c;
+            }
+        }
+    }
+}
+
+template <typename IndexType, typename ALPHA, typename MA, typename MB,
+          typename BETA, typename MC>
+void
+gemmt(StorageOrder order, StorageUpLo upLo,
+      Transpose transA, Transpose transB,
+      IndexType n, IndexType k,
+      const ALPHA &alpha,
+      const MA *A, IndexType ldA,
+      const MB *B, IndexType ldB,
+      const BETA &beta,
+      MC *C, IndexType ldC)
+{
+    gemmt_generic(order, upLo, transA, transB, n, k, alpha,
+                  A, ldA, B, ldB, beta, C, ldC);
+}
+
+#ifdef HAVE_CBLAS_GEMMT
+
+// sgemmt
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemmt(StorageOrder order, StorageUpLo upLo,
+      Transpose transA, Transpose transB,
+      IndexType n, IndexType k,
+      float alpha,
+      const float *A, IndexType ldA,
+      const float *B, IndexType ldB,
+      float beta,
+      float *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_sgemmt");
+
+    cblas_sgemmt(CBLAS::getCblasType(order), CBLAS::getCblasType(upLo),
+                 CBLAS::getCblasType(transA), CBLAS::getCblasType(transB),
+                 n, k,
+                 alpha,
+                 A, ldA,
+                 B, ldB,
+                 beta,
+                 C, ldC);
+}
+
+// dgemmt
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemmt(StorageOrder order, StorageUpLo upLo,
+      Transpose transA, Transpose transB,
+      IndexType n, IndexType k,
+      double alpha,
+      const double *A, IndexType ldA,
+      const double *B, IndexType ldB,
+      double beta,
+      double *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_dgemmt");
+
+    cblas_dgemmt(CBLAS::getCblasType(order), CBLAS::getCblasType(upLo),
+                 CBLAS::getCblasType(transA), CBLAS::getCblasType(transB),
+                 n, k,
+                 alpha,
+                 A, ldA,
+                 B, ldB,
+                 beta,
+                 C, ldC);
+}
+
+// cgemmt
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemmt(StorageOrder order, StorageUpLo upLo,
+      Transpose transA, Transpose transB,
+      IndexType n, IndexType k,
+      const ComplexFloat &alpha,
+      const ComplexFloat *A, IndexType ldA,
+      const ComplexFloat *B, IndexType ldB,
+      const ComplexFloat &beta,
+      ComplexFloat *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_cgemmt");
+
+    if (transA==Conj || transB==Conj) {
+        gemmt_generic(order, upLo, transA, transB, n, k,
+                      alpha, A, ldA, B, ldB,
+                      beta,
+                      C, ldC);
+        return;
+    }
+
+    cblas_cgemmt(CBLAS::getCblasType(order), CBLAS::getCblasType(upLo),
+                 CBLAS::getCblasType(transA), CBLAS::getCblasType(transB),
+                 n, k,
+                 reinterpret_cast<const float *>(&alpha),
+                 reinterpret_cast<const float *>(A), ldA,
+                 reinterpret_cast<const float *>(B), ldB,
+                 reinterpret_cast<const float *>(&beta),
+                 reinterpret_cast<float *>(C), ldC);
+}
+
+// zgemmt
+template <typename IndexType>
+typename If<IndexType>::isBlasCompatibleInteger
+gemmt(StorageOrder order, StorageUpLo upLo,
+      Transpose transA, Transpose transB,
+      IndexType n, IndexType k,
+      const ComplexDouble &alpha,
+      const ComplexDouble *A, IndexType ldA,
+      const ComplexDouble *B, IndexType ldB,
+      const ComplexDouble &beta,
+      ComplexDouble *C, IndexType ldC)
+{
+    CXXBLAS_DEBUG_OUT("[" BLAS_IMPL "] cblas_zgemmt");
+
+    if (transA==Conj || transB==Conj) {
+        gemmt_generic(order, upLo, transA, transB, n, k,
+                      alpha, A, ldA, B, ldB,
+                      beta,
+                      C, ldC);
+        return;
+    }
+
+    cblas_zgemmt(CBLAS::getCblasType(order), CBLAS::getCblasType(upLo),
+                 CBLAS::getCblasType(transA), CBLAS::getCblasType(transB),
+                 n, k,
+                 reinterpret_cast<const double *>(&alpha),
+                 reinterpret_cast<const double *>(A), ldA,
+                 reinterpret_cast<const double *>(B), ldB,
+                 reinterpret_cast<const double *>(&beta),
+                 reinterpret_cast<double *>(C), ldC);
+}
+
+#endif // HAVE_CBLAS_GEMMT
+
+} // namespace cxxblas
+
+#endif // CXXBLAS_LEVEL3EXTENSIONS_GEMMT_TCC
@@ -37,5 +37,14 @@
 #include "xflens/cxxblas/level3extensions/gbmm.h"
 #include "xflens/cxxblas/level3extensions/sbmm.h"
 #include "xflens/cxxblas/level3extensions/tbmm.h"
+#include "xflens/cxxblas/level3extensions/gemm_batch.h"
+#include "xflens/cxxblas/level3extensions/gemm_reduced.h"
+#include "xflens/cxxblas/level3extensions/gemm3m.h"
+#include "xflens/cxxblas/level3extensions/gemmt.h"
+#include "xflens/cxxblas/level3extensions/gemm_packed.h"
+#include "xflens/cxxblas/level3extensions/gemm_epilogue.h"
+#include "xflens/cxxblas/level3extensions/gemm_scatter.h"
+#include "xflens/cxxblas/level3extensions/gemm_strassen.h"
+#include "xflens/cxxblas/level3extensions/gemm_strided.h"
 
 #endif // CXXBLAS_LEVEL3EXTENSIONS_LEVEL3EXTENSIONS_H
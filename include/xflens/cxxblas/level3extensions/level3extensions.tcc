@@ -37,5 +37,14 @@
 #include "xflens/cxxblas/level3extensions/gbmm.tcc"
 #include "xflens/cxxblas/level3extensions/sbmm.tcc"
 #include "xflens/cxxblas/level3extensions/tbmm.tcc"
+#include "xflens/cxxblas/level3extensions/gemm_batch.tcc"
+#include "xflens/cxxblas/level3extensions/gemm_reduced.tcc"
+#include "xflens/cxxblas/level3extensions/gemm3m.tcc"
+#include "xflens/cxxblas/level3extensions/gemmt.tcc"
+#include "xflens/cxxblas/level3extensions/gemm_packed.tcc"
+#include "xflens/cxxblas/level3extensions/gemm_epilogue.tcc"
+#include "xflens/cxxblas/level3extensions/gemm_scatter.tcc"
+#include "xflens/cxxblas/level3extensions/gemm_strassen.tcc"
+#include "xflens/cxxblas/level3extensions/gemm_strided.tcc"
 
 #endif // CXXBLAS_LEVEL3EXTENSIONS_LEVEL3EXTENSIONS_TCC
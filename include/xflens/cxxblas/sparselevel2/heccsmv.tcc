@@ -135,7 +135,7 @@ heccsmv(StorageUpLo             upLo,
 
     char matdescra[5] = { "H*N*" };
     matdescra[1] = getF77BlasChar(upLo);
-    matdescra[3] = getIndexBaseChar(ia[0]);
+    matdescra[3] = getIndexBaseChar(ja[0]);
 
     if (matdescra[3]=='E') {
          heccsmv<IndexType, ComplexFloat, ComplexFloat,
@@ -173,7 +173,7 @@ heccsmv(StorageUpLo             upLo,
 
     char matdescra[5] = { "H*N*" };
     matdescra[1] = getF77BlasChar(upLo);
-    matdescra[3] = getIndexBaseChar(ia[0]);
+    matdescra[3] = getIndexBaseChar(ja[0]);
 
     if (matdescra[3]=='E') {
          heccsmv<IndexType, ComplexDouble, ComplexDouble,
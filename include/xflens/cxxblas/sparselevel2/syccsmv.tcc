@@ -133,7 +133,7 @@ syccsmv(StorageUpLo      upLo,
 
     char matdescra[5] = { "S*N*" };
     matdescra[1] = getF77BlasChar(upLo);
-    matdescra[3] = getIndexBaseChar(ia[0]);
+    matdescra[3] = getIndexBaseChar(ja[0]);
 
     if (matdescra[3]=='E') {
          syccsmv<IndexType, float, float,
@@ -169,7 +169,7 @@ syccsmv(StorageUpLo      upLo,
 
     char matdescra[5] = { "S*N*" };
     matdescra[1] = getF77BlasChar(upLo);
-    matdescra[3] = getIndexBaseChar(ia[0]);
+    matdescra[3] = getIndexBaseChar(ja[0]);
 
     if (matdescra[3]=='E') {
          syccsmv<IndexType, double, double,
@@ -205,7 +205,7 @@ syccsmv(StorageUpLo             upLo,
 
     char matdescra[5] = { "S*N*" };
     matdescra[1] = getF77BlasChar(upLo);
-    matdescra[3] = getIndexBaseChar(ia[0]);
+    matdescra[3] = getIndexBaseChar(ja[0]);
 
     if (matdescra[3]=='E') {
          syccsmv<IndexType, ComplexFloat, ComplexFloat,
@@ -243,7 +243,7 @@ syccsmv(StorageUpLo             upLo,
 
     char matdescra[5] = { "S*N*" };
     matdescra[1] = getF77BlasChar(upLo);
-    matdescra[3] = getIndexBaseChar(ia[0]);
+    matdescra[3] = getIndexBaseChar(ja[0]);
 
     if (matdescra[3]=='E') {
          syccsmv<IndexType, ComplexDouble, ComplexDouble,
@@ -0,0 +1,244 @@
+/*
+ *   Copyright (c) 2021, QuantStack
+ *
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in
+ *      the documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the FLENS development group nor the names of
+ *      its contributors may be used to endorse or promote products derived
+ *      from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CXXLAPACK_CXXLAPACK_XTENSOR_CXX
+#define CXXLAPACK_CXXLAPACK_XTENSOR_CXX 1
+
+//
+//  The interfaces wrapped by xtensor-blas, instead of the whole of
+//  cxxlapack.cxx. A routine called through cxxlapack:: by xtensor-blas has
+//  to be added here.
+//
+
+#include <complex>
+
+#include "xflens/cxxlapack/interface/bdsdc.h"
+#include "xflens/cxxlapack/interface/bdsqr.h"
+#include "xflens/cxxlapack/interface/cgesv.h"
+#include "xflens/cxxlapack/interface/cposv.h"
+#include "xflens/cxxlapack/interface/gbcon.h"
+#include "xflens/cxxlapack/interface/gbsv.h"
+#include "xflens/cxxlapack/interface/gbtrf.h"
+#include "xflens/cxxlapack/interface/gbtrs.h"
+#include "xflens/cxxlapack/interface/gecon.h"
+#include "xflens/cxxlapack/interface/gees.h"
+#include "xflens/cxxlapack/interface/geev.h"
+#include "xflens/cxxlapack/interface/geevx.h"
+#include "xflens/cxxlapack/interface/gehrd.h"
+#include "xflens/cxxlapack/interface/gejsv.h"
+#include "xflens/cxxlapack/interface/gels.h"
+#include "xflens/cxxlapack/interface/gelsd.h"
+#include "xflens/cxxlapack/interface/gelss.h"
+#include "xflens/cxxlapack/interface/gelsy.h"
+#include "xflens/cxxlapack/interface/geqp3.h"
+#include "xflens/cxxlapack/interface/geqrf.h"
+#include "xflens/cxxlapack/interface/gesdd.h"
+#include "xflens/cxxlapack/interface/gesv.h"
+#include "xflens/cxxlapack/interface/gesvd.h"
+#include "xflens/cxxlapack/interface/gesvj.h"
+#include "xflens/cxxlapack/interface/gesvx.h"
+#include "xflens/cxxlapack/interface/getrf.h"
+#include "xflens/cxxlapack/interface/getri.h"
+#include "xflens/cxxlapack/interface/getrs.h"
+#include "xflens/cxxlapack/interface/gges.h"
+#include "xflens/cxxlapack/interface/ggev.h"
+#include "xflens/cxxlapack/interface/gtsv.h"
+#include "xflens/cxxlapack/interface/hecon.h"
+#include "xflens/cxxlapack/interface/heevd.h"
+#include "xflens/cxxlapack/interface/heevr.h"
+#include "xflens/cxxlapack/interface/hegst.h"
+#include "xflens/cxxlapack/interface/hegvd.h"
+#include "xflens/cxxlapack/interface/hegvx.h"
+#include "xflens/cxxlapack/interface/hesv.h"
+#include "xflens/cxxlapack/interface/hetrd.h"
+#include "xflens/cxxlapack/interface/hetrf.h"
+#include "xflens/cxxlapack/interface/hetri.h"
+#include "xflens/cxxlapack/interface/hetrs.h"
+#include "xflens/cxxlapack/interface/hetrs2.h"
+#include "xflens/cxxlapack/interface/hpevd.h"
+#include "xflens/cxxlapack/interface/hpevx.h"
+#include "xflens/cxxlapack/interface/hpsv.h"
+#include "xflens/cxxlapack/interface/laed4.h"
+#include "xflens/cxxlapack/interface/lange.h"
+#include "xflens/cxxlapack/interface/lansy.h"
+#include "xflens/cxxlapack/interface/larfb.h"
+#include "xflens/cxxlapack/interface/larfg.h"
+#include "xflens/cxxlapack/interface/larft.h"
+#include "xflens/cxxlapack/interface/larnv.h"
+#include "xflens/cxxlapack/interface/laswp.h"
+#include "xflens/cxxlapack/interface/orgqr.h"
+#include "xflens/cxxlapack/interface/ormhr.h"
+#include "xflens/cxxlapack/interface/ormqr.h"
+#include "xflens/cxxlapack/interface/ormr2.h"
+#include "xflens/cxxlapack/interface/ormtr.h"
+#include "xflens/cxxlapack/interface/pocon.h"
+#include "xflens/cxxlapack/interface/posv.h"
+#include "xflens/cxxlapack/interface/posvx.h"
+#include "xflens/cxxlapack/interface/potrf.h"
+#include "xflens/cxxlapack/interface/potri.h"
+#include "xflens/cxxlapack/interface/potrs.h"
+#include "xflens/cxxlapack/interface/pptrf.h"
+#include "xflens/cxxlapack/interface/pptrs.h"
+#include "xflens/cxxlapack/interface/pstrf.h"
+#include "xflens/cxxlapack/interface/ptsv.h"
+#include "xflens/cxxlapack/interface/sgesv.h"
+#include "xflens/cxxlapack/interface/spevd.h"
+#include "xflens/cxxlapack/interface/spevx.h"
+#include "xflens/cxxlapack/interface/sposv.h"
+#include "xflens/cxxlapack/interface/spsv.h"
+#include "xflens/cxxlapack/interface/stedc.h"
+#include "xflens/cxxlapack/interface/stevr.h"
+#include "xflens/cxxlapack/interface/sycon.h"
+#include "xflens/cxxlapack/interface/syevd.h"
+#include "xflens/cxxlapack/interface/syevr.h"
+#include "xflens/cxxlapack/interface/sygst.h"
+#include "xflens/cxxlapack/interface/sygvd.h"
+#include "xflens/cxxlapack/interface/sygvx.h"
+#include "xflens/cxxlapack/interface/sysv.h"
+#include "xflens/cxxlapack/interface/sytrd.h"
+#include "xflens/cxxlapack/interface/sytrf.h"
+#include "xflens/cxxlapack/interface/sytri.h"
+#include "xflens/cxxlapack/interface/sytrs.h"
+#include "xflens/cxxlapack/interface/sytrs2.h"
+#include "xflens/cxxlapack/interface/tgsen.h"
+#include "xflens/cxxlapack/interface/tptrs.h"
+#include "xflens/cxxlapack/interface/trcon.h"
+#include "xflens/cxxlapack/interface/trsen.h"
+#include "xflens/cxxlapack/interface/trsyl.h"
+#include "xflens/cxxlapack/interface/trtri.h"
+#include "xflens/cxxlapack/interface/trtrs.h"
+#include "xflens/cxxlapack/interface/ungqr.h"
+#include "xflens/cxxlapack/interface/unmhr.h"
+#include "xflens/cxxlapack/interface/unmqr.h"
+#include "xflens/cxxlapack/interface/unmtr.h"
+
+#include "xflens/cxxlapack/interface/bdsdc.tcc"
+#include "xflens/cxxlapack/interface/bdsqr.tcc"
+#include "xflens/cxxlapack/interface/cgesv.tcc"
+#include "xflens/cxxlapack/interface/cposv.tcc"
+#include "xflens/cxxlapack/interface/gbcon.tcc"
+#include "xflens/cxxlapack/interface/gbsv.tcc"
+#include "xflens/cxxlapack/interface/gbtrf.tcc"
+#include "xflens/cxxlapack/interface/gbtrs.tcc"
+#include "xflens/cxxlapack/interface/gecon.tcc"
+#include "xflens/cxxlapack/interface/gees.tcc"
+#include "xflens/cxxlapack/interface/geev.tcc"
+#include "xflens/cxxlapack/interface/geevx.tcc"
+#include "xflens/cxxlapack/interface/gehrd.tcc"
+#include "xflens/cxxlapack/interface/gejsv.tcc"
+#include "xflens/cxxlapack/interface/gels.tcc"
+#include "xflens/cxxlapack/interface/gelsd.tcc"
+#include "xflens/cxxlapack/interface/gelss.tcc"
+#include "xflens/cxxlapack/interface/gelsy.tcc"
+#include "xflens/cxxlapack/interface/geqp3.tcc"
+#include "xflens/cxxlapack/interface/geqrf.tcc"
+#include "xflens/cxxlapack/interface/gesdd.tcc"
+#include "xflens/cxxlapack/interface/gesv.tcc"
+#include "xflens/cxxlapack/interface/gesvd.tcc"
+#include "xflens/cxxlapack/interface/gesvj.tcc"
+#include "xflens/cxxlapack/interface/gesvx.tcc"
+#include "xflens/cxxlapack/interface/getrf.tcc"
+#include "xflens/cxxlapack/interface/getri.tcc"
+#include "xflens/cxxlapack/interface/getrs.tcc"
+#include "xflens/cxxlapack/interface/gges.tcc"
+#include "xflens/cxxlapack/interface/ggev.tcc"
+#include "xflens/cxxlapack/interface/gtsv.tcc"
+#include "xflens/cxxlapack/interface/hecon.tcc"
+#include "xflens/cxxlapack/interface/heevd.tcc"
+#include "xflens/cxxlapack/interface/heevr.tcc"
+#include "xflens/cxxlapack/interface/hegst.tcc"
+#include "xflens/cxxlapack/interface/hegvd.tcc"
+#include "xflens/cxxlapack/interface/hegvx.tcc"
+#include "xflens/cxxlapack/interface/hesv.tcc"
+#include "xflens/cxxlapack/interface/hetrd.tcc"
+#include "xflens/cxxlapack/interface/hetrf.tcc"
+#include "xflens/cxxlapack/interface/hetri.tcc"
+#include "xflens/cxxlapack/interface/hetrs.tcc"
+#include "xflens/cxxlapack/interface/hetrs2.tcc"
+#include "xflens/cxxlapack/interface/hpevd.tcc"
+#include "xflens/cxxlapack/interface/hpevx.tcc"
+#include "xflens/cxxlapack/interface/hpsv.tcc"
+#include "xflens/cxxlapack/interface/laed4.tcc"
+#include "xflens/cxxlapack/interface/lange.tcc"
+#include "xflens/cxxlapack/interface/lansy.tcc"
+#include "xflens/cxxlapack/interface/larfb.tcc"
+#include "xflens/cxxlapack/interface/larfg.tcc"
+#include "xflens/cxxlapack/interface/larft.tcc"
+#include "xflens/cxxlapack/interface/larnv.tcc"
+#include "xflens/cxxlapack/interface/laswp.tcc"
+#include "xflens/cxxlapack/interface/orgqr.tcc"
+#include "xflens/cxxlapack/interface/ormhr.tcc"
+#include "xflens/cxxlapack/interface/ormqr.tcc"
+#include "xflens/cxxlapack/interface/ormr2.tcc"
+#include "xflens/cxxlapack/interface/ormtr.tcc"
+#include "xflens/cxxlapack/interface/pocon.tcc"
+#include "xflens/cxxlapack/interface/posv.tcc"
+#include "xflens/cxxlapack/interface/posvx.tcc"
+#include "xflens/cxxlapack/interface/potrf.tcc"
+#include "xflens/cxxlapack/interface/potri.tcc"
+#include "xflens/cxxlapack/interface/potrs.tcc"
+#include "xflens/cxxlapack/interface/pptrf.tcc"
+#include "xflens/cxxlapack/interface/pptrs.tcc"
+#include "xflens/cxxlapack/interface/pstrf.tcc"
+#include "xflens/cxxlapack/interface/ptsv.tcc"
+#include "xflens/cxxlapack/interface/sgesv.tcc"
+#include "xflens/cxxlapack/interface/spevd.tcc"
+#include "xflens/cxxlapack/interface/spevx.tcc"
+#include "xflens/cxxlapack/interface/sposv.tcc"
+#include "xflens/cxxlapack/interface/spsv.tcc"
+#include "xflens/cxxlapack/interface/stedc.tcc"
+#include "xflens/cxxlapack/interface/stevr.tcc"
+#include "xflens/cxxlapack/interface/sycon.tcc"
+#include "xflens/cxxlapack/interface/syevd.tcc"
+#include "xflens/cxxlapack/interface/syevr.tcc"
+#include "xflens/cxxlapack/interface/sygst.tcc"
+#include "xflens/cxxlapack/interface/sygvd.tcc"
+#include "xflens/cxxlapack/interface/sygvx.tcc"
+#include "xflens/cxxlapack/interface/sysv.tcc"
+#include "xflens/cxxlapack/interface/sytrd.tcc"
+#include "xflens/cxxlapack/interface/sytrf.tcc"
+#include "xflens/cxxlapack/interface/sytri.tcc"
+#include "xflens/cxxlapack/interface/sytrs.tcc"
+#include "xflens/cxxlapack/interface/sytrs2.tcc"
+#include "xflens/cxxlapack/interface/tgsen.tcc"
+#include "xflens/cxxlapack/interface/tptrs.tcc"
+#include "xflens/cxxlapack/interface/trcon.tcc"
+#include "xflens/cxxlapack/interface/trsen.tcc"
+#include "xflens/cxxlapack/interface/trsyl.tcc"
+#include "xflens/cxxlapack/interface/trtri.tcc"
+#include "xflens/cxxlapack/interface/trtrs.tcc"
+#include "xflens/cxxlapack/interface/ungqr.tcc"
+#include "xflens/cxxlapack/interface/unmhr.tcc"
+#include "xflens/cxxlapack/interface/unmqr.tcc"
+#include "xflens/cxxlapack/interface/unmtr.tcc"
+
+#endif // CXXLAPACK_CXXLAPACK_XTENSOR_CXX
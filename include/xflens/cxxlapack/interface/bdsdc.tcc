@@ -56,8 +56,8 @@ bdsdc(char                  upLo,
       IndexType             *iWork)
 {
     IndexType info;
-    CXXLAPACK_DEBUG_OUT("cbdsdc");
-    LAPACK_IMPL(cbdsdc)(&upLo,
+    CXXLAPACK_DEBUG_OUT("sbdsdc");
+    LAPACK_IMPL(sbdsdc)(&upLo,
                         &compq,
                         &n,
                         d,
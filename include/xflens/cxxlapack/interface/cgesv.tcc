@@ -66,8 +66,8 @@ zcgesv(IndexType                  n,
                         &ldB,
                         reinterpret_cast<double *>(X),
                         &ldX,
-                        work,
-                        swork,
+                        reinterpret_cast<double *>(work),
+                        reinterpret_cast<float  *>(swork),
                         rWork,
                         &iter,
                         &info);
@@ -42,7 +42,7 @@ template <typename IndexType>
     cposv(char                        uplo,
           IndexType                   n,
           IndexType                   nRhs,
-          const std::complex<double>  *A,
+          std::complex<double>        *A,
           IndexType                   ldA,
           const std::complex<double>  *B,
           IndexType                   ldB,
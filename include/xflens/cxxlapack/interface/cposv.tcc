@@ -45,7 +45,7 @@ IndexType
 cposv(char                        uplo,
       IndexType                   n,
       IndexType                   nRhs,
-      const std::complex<double>  *A,
+      std::complex<double>        *A,
       IndexType                   ldA,
       const std::complex<double>  *B,
       IndexType                   ldB,
@@ -61,14 +61,14 @@ cposv(char                        uplo,
     LAPACK_IMPL(zcposv)(&uplo,
                         &n,
                         &nRhs,
-                        A,
+                        reinterpret_cast<double *>(A),
                         &ldA,
-                        B,
+                        reinterpret_cast<const double *>(B),
                         &ldB,
-                        X,
+                        reinterpret_cast<double *>(X),
                         &ldX,
-                        work,
-                        swork,
+                        reinterpret_cast<double *>(work),
+                        reinterpret_cast<float  *>(swork),
                         rWork,
                         &iter,
                         &info);
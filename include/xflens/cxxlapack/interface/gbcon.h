@@ -77,7 +77,7 @@ template <typename IndexType>
           float                       anorm,
           float                       &rCond,
           std::complex<float >        *work,
-          IndexType                   *iWork);
+          float                       *rWork);
 
 template <typename IndexType>
     IndexType
@@ -91,7 +91,7 @@ template <typename IndexType>
           double                      anorm,
           double                      &rCond,
           std::complex<double>        *work,
-          IndexType                   *iWork);
+          double                      *rWork);
 
 } // namespace cxxlapack
 
@@ -65,7 +65,7 @@ gbcon(char                  norm,
                         &anorm,
                         &rCond,
                         work,
-                        &iWork,
+                        iWork,
                         &info);
 #   ifndef NDEBUG
     if (info<0) {
@@ -102,7 +102,7 @@ gbcon(char                  norm,
                         &anorm,
                         &rCond,
                         work,
-                        &iWork,
+                        iWork,
                         &info);
 #   ifndef NDEBUG
     if (info<0) {
@@ -125,7 +125,7 @@ gbcon(char                        norm,
       float                       anorm,
       float                       &rCond,
       std::complex<float >        *work,
-      IndexType                   *iWork)
+      float                       *rWork)
 {
     IndexType info;
     CXXLAPACK_DEBUG_OUT("cgbcon");
@@ -139,7 +139,7 @@ gbcon(char                        norm,
                         &anorm,
                         &rCond,
                         reinterpret_cast<float  *>(work),
-                        &iWork,
+                        rWork,
                         &info);
 #   ifndef NDEBUG
     if (info<0) {
@@ -162,7 +162,7 @@ gbcon(char                        norm,
       double                      anorm,
       double                      &rCond,
       std::complex<double>        *work,
-      IndexType                   *iWork)
+      double                      *rWork)
 {
     IndexType info;
     CXXLAPACK_DEBUG_OUT("zgbcon");
@@ -176,7 +176,7 @@ gbcon(char                        norm,
                         &anorm,
                         &rCond,
                         reinterpret_cast<double *>(work),
-                        &iWork,
+                        rWork,
                         &info);
 #   ifndef NDEBUG
     if (info<0) {
@@ -105,8 +105,8 @@ template <typename IndexType>
           IndexType               &iHi,
           float                   *scale,
           float                   &ABnorm,
-          float                   &rCondE,
-          float                   &rCondV,
+          float                   *rCondE,
+          float                   *rCondV,
           std::complex<float >    *work,
           IndexType               lWork,
           float                   *rWork);
@@ -129,8 +129,8 @@ template <typename IndexType>
           IndexType               &iHi,
           double                  *scale,
           double                  &ABnorm,
-          double                  &rCondE,
-          double                  &rCondV,
+          double                  *rCondE,
+          double                  *rCondV,
           std::complex<double>    *work,
           IndexType               lWork,
           double                  *rWork);
@@ -48,7 +48,7 @@ template <typename IndexType>
           IndexType             ldB,
           float                 *s,
           float                 rCond,
-          IndexType             rank,
+          IndexType            &rank,
           float                 *work,
           IndexType             lWork);
 
@@ -63,7 +63,7 @@ template <typename IndexType>
           IndexType             ldB,
           double                *s,
           double                rCond,
-          IndexType             rank,
+          IndexType            &rank,
           double                *work,
           IndexType             lWork);
 
@@ -76,11 +76,12 @@ template <typename IndexType>
           IndexType             ldA,
           std::complex<float >  *B,
           IndexType             ldB,
-          std::complex<float >  *s,
+          float                 *s,
           float                 rCond,
-          IndexType             rank,
+          IndexType            &rank,
           std::complex<float >  *work,
-          IndexType             lWork);
+          IndexType             lWork,
+          float                 *rWork);
 
 template <typename IndexType>
     IndexType
@@ -91,11 +92,12 @@ template <typename IndexType>
           IndexType             ldA,
           std::complex<double>  *B,
           IndexType             ldB,
-          std::complex<double>  *s,
+          double                *s,
           double                rCond,
-          IndexType             rank,
+          IndexType            &rank,
           std::complex<double>  *work,
-          IndexType             lWork);
+          IndexType             lWork,
+          double                *rWork);
 
 } // namespace cxxlapack
 
@@ -50,7 +50,7 @@ gelss(IndexType             m,
       IndexType             ldB,
       float                 *s,
       float                 rCond,
-      IndexType             rank,
+      IndexType            &rank,
       float                 *work,
       IndexType             lWork)
 {
@@ -89,7 +89,7 @@ gelss(IndexType             m,
       IndexType             ldB,
       double                *s,
       double                rCond,
-      IndexType             rank,
+      IndexType            &rank,
       double                *work,
       IndexType             lWork)
 {
@@ -126,12 +126,12 @@ gelss(IndexType             m,
       IndexType             ldA,
       std::complex<float >  *B,
       IndexType             ldB,
-      std::complex<float >  *s,
+      float                 *s,
       float                 rCond,
-      IndexType             rank,
+      IndexType            &rank,
       std::complex<float >  *work,
-      float                 rWork,
-      IndexType             lWork)
+      IndexType             lWork,
+      float                 *rWork)
 {
     IndexType info;
     CXXLAPACK_DEBUG_OUT("cgelss");
@@ -142,7 +142,7 @@ gelss(IndexType             m,
                         &ldA,
                         reinterpret_cast<float  *>(B),
                         &ldB,
-                        reinterpret_cast<float  *>(s),
+                        s,
                         &rCond,
                         &rank,
                         reinterpret_cast<float  *>(work),
@@ -167,12 +167,12 @@ gelss(IndexType             m,
       IndexType             ldA,
       std::complex<double>  *B,
       IndexType             ldB,
-      std::complex<double>  *s,
+      double                *s,
       double                rCond,
-      IndexType             rank,
+      IndexType            &rank,
       std::complex<double>  *work,
-      double                rWork,
-      IndexType             lWork)
+      IndexType             lWork,
+      double                *rWork)
 {
     IndexType info;
     CXXLAPACK_DEBUG_OUT("zgelss");
@@ -183,7 +183,7 @@ gelss(IndexType             m,
                         &ldA,
                         reinterpret_cast<double *>(B),
                         &ldB,
-                        reinterpret_cast<double *>(s),
+                        s,
                         &rCond,
                         &rank,
                         reinterpret_cast<double *>(work),
@@ -48,7 +48,7 @@ template <typename IndexType>
           float         *AF,
           IndexType     ldAF,
           IndexType     *iPiv,
-          char          equed,
+          char          &equed,
           float         *r,
           float         *c,
           float         *B,
@@ -72,7 +72,7 @@ template <typename IndexType>
           double        *AF,
           IndexType     ldAF,
           IndexType     *iPiv,
-          char          equed,
+          char          &equed,
           double        *r,
           double        *c,
           double        *B,
@@ -96,7 +96,7 @@ template <typename IndexType>
           std::complex<float >  *AF,
           IndexType             ldAF,
           IndexType             *iPiv,
-          char                  equed,
+          char                  &equed,
           float                 *r,
           float                 *c,
           std::complex<float >  *B,
@@ -120,7 +120,7 @@ template <typename IndexType>
           std::complex<double>  *AF,
           IndexType             ldAF,
           IndexType             *iPiv,
-          char                  equed,
+          char                  &equed,
           double                *r,
           double                *c,
           std::complex<double>  *B,
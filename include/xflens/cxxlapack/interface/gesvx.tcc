@@ -50,7 +50,7 @@ gesvx(char          fact,
       float         *AF,
       IndexType     ldAF,
       IndexType     *iPiv,
-      char          equed,
+      char          &equed,
       float         *r,
       float         *c,
       float         *B,
@@ -108,7 +108,7 @@ gesvx(char          fact,
       double        *AF,
       IndexType     ldAF,
       IndexType     *iPiv,
-      char          equed,
+      char          &equed,
       double        *r,
       double        *c,
       double        *B,
@@ -166,7 +166,7 @@ gesvx(char                  fact,
       std::complex<float >  *AF,
       IndexType             ldAF,
       IndexType             *iPiv,
-      char                  equed,
+      char                  &equed,
       float                 *r,
       float                 *c,
       std::complex<float >  *B,
@@ -224,7 +224,7 @@ gesvx(char                  fact,
       std::complex<double>  *AF,
       IndexType             ldAF,
       IndexType             *iPiv,
-      char                  equed,
+      char                  &equed,
       double                *r,
       double                *c,
       std::complex<double>  *B,
@@ -42,14 +42,15 @@ template <typename IndexType>
     gges(char                  jobvsl,
          char                  jobvsr,
          char                  sort,
-         IndexType             (*select)(const float  *, const float  *),
+         IndexType             (*select)(const float *, const float *, const float *),
          IndexType             n,
          float                 *A,
          IndexType             ldA,
          float                 *B,
          IndexType             ldB,
          IndexType             &sdim,
-         float                 *alpha,
+         float                 *alphar,
+         float                 *alphai,
          float                 *beta,
          float                 *Vsl,
          IndexType             ldVsl,
@@ -57,21 +58,22 @@ template <typename IndexType>
          IndexType             ldVsr,
          float                 *work,
          IndexType             lWork,
-         bool                  *bwork);
+         IndexType             *bWork);
 
 template <typename IndexType>
     IndexType
     gges(char                  jobvsl,
          char                  jobvsr,
          char                  sort,
-         IndexType             (*select)(const double *, const double *),
+         IndexType             (*select)(const double *, const double *, const double *),
          IndexType             n,
          double                *A,
          IndexType             ldA,
          double                *B,
          IndexType             ldB,
          IndexType             &sdim,
-         double                *alpha,
+         double                *alphar,
+         double                *alphai,
          double                *beta,
          double                *Vsl,
          IndexType             ldVsl,
@@ -79,37 +81,37 @@ template <typename IndexType>
          IndexType             ldVsr,
          double                *work,
          IndexType             lWork,
-         bool                  *bwork);
+         IndexType             *bWork);
 
 template <typename IndexType>
     IndexType
     gges(char                  jobvsl,
          char                  jobvsr,
          char                  sort,
-         IndexType             (*select)(const std::complex<double> *),
+         IndexType             (*select)(const std::complex<float > *, const std::complex<float > *),
          IndexType             n,
-         std::complex<float>   *A,
+         std::complex<float >  *A,
          IndexType             ldA,
-         std::complex<float>   *B,
+         std::complex<float >  *B,
          IndexType             ldB,
          IndexType             &sdim,
-         std::complex<float>   *alpha,
-         std::complex<float>   *beta,
-         std::complex<float>   *Vsl,
+         std::complex<float >  *alpha,
+         std::complex<float >  *beta,
+         std::complex<float >  *Vsl,
          IndexType             ldVsl,
-         std::complex<float>   *Vsr,
+         std::complex<float >  *Vsr,
          IndexType             ldVsr,
-         std::complex<float>   *work,
+         std::complex<float >  *work,
          IndexType             lWork,
-         double                rWork,
-         bool                  *bwork);
+         float                 *rWork,
+         IndexType             *bWork);
 
 template <typename IndexType>
     IndexType
     gges(char                  jobvsl,
          char                  jobvsr,
          char                  sort,
-         IndexType              (*select)(const std::complex<double> *),
+         IndexType             (*select)(const std::complex<double> *, const std::complex<double> *),
          IndexType             n,
          std::complex<double>  *A,
          IndexType             ldA,
@@ -124,8 +126,8 @@ template <typename IndexType>
          IndexType             ldVsr,
          std::complex<double>  *work,
          IndexType             lWork,
-         double                rWork,
-         bool                  *bwork);
+         double                *rWork,
+         IndexType             *bWork);
 
 } // namespace cxxlapack
 
@@ -44,14 +44,15 @@ IndexType
 gges(char                  jobvsl,
      char                  jobvsr,
      char                  sort,
-     IndexType             (*select)(const float  *, const float  *),
+     IndexType             (*select)(const float *, const float *, const float *),
      IndexType             n,
      float                 *A,
      IndexType             ldA,
      float                 *B,
      IndexType             ldB,
      IndexType             &sdim,
-     float                 *alpha,
+     float                 *alphar,
+     float                 *alphai,
      float                 *beta,
      float                 *Vsl,
      IndexType             ldVsl,
@@ -59,12 +60,11 @@ gges(char                  jobvsl,
      IndexType             ldVsr,
      float                 *work,
      IndexType             lWork,
-     bool                  *bwork)
+     IndexType             *bWork)
 {
     CXXLAPACK_DEBUG_OUT("sgges");
 
     IndexType info;
-    // TODO: Convert bwork into a logical array!
     LAPACK_IMPL(sgges)(&jobvsl,
                        &jobvsr,
                        &sort,
@@ -75,7 +75,8 @@ gges(char                  jobvsl,
                        B,
                        &ldB,
                        &sdim,
-                       alpha,
+                       alphar,
+                       alphai,
                        beta,
                        Vsl,
                        &ldVsl,
@@ -83,7 +84,7 @@ gges(char                  jobvsl,
                        &ldVsr,
                        work,
                        &lWork,
-                       bwork,
+                       bWork,
                        &info);
 #   ifndef NDEBUG
     if (info<0) {
@@ -99,14 +100,15 @@ IndexType
 gges(char                  jobvsl,
      char                  jobvsr,
      char                  sort,
-     IndexType             (*select)(const double *, const double *),
+     IndexType             (*select)(const double *, const double *, const double *),
      IndexType             n,
      double                *A,
      IndexType             ldA,
      double                *B,
      IndexType             ldB,
      IndexType             &sdim,
-     double                *alpha,
+     double                *alphar,
+     double                *alphai,
      double                *beta,
      double                *Vsl,
      IndexType             ldVsl,
@@ -114,12 +116,11 @@ gges(char                  jobvsl,
      IndexType             ldVsr,
      double                *work,
      IndexType             lWork,
-     bool                  *bwork)
+     IndexType             *bWork)
 {
     CXXLAPACK_DEBUG_OUT("dgges");
 
     IndexType info;
-    // TODO: Convert bwork into a logical array!
     LAPACK_IMPL(dgges)(&jobvsl,
                        &jobvsr,
                        &sort,
@@ -130,7 +131,8 @@ gges(char                  jobvsl,
                        B,
                        &ldB,
                        &sdim,
-                       alpha,
+                       alphar,
+                       alphai,
                        beta,
                        Vsl,
                        &ldVsl,
@@ -138,7 +140,7 @@ gges(char                  jobvsl,
                        &ldVsr,
                        work,
                        &lWork,
-                       bwork,
+                       bWork,
                        &info);
 #   ifndef NDEBUG
     if (info<0) {
@@ -154,7 +156,7 @@ IndexType
 gges(char                  jobvsl,
      char                  jobvsr,
      char                  sort,
-     IndexType              (*select)(const std::complex<float > *),
+     IndexType             (*select)(const std::complex<float > *, const std::complex<float > *),
      IndexType             n,
      std::complex<float >  *A,
      IndexType             ldA,
@@ -169,17 +171,18 @@ gges(char                  jobvsl,
      IndexType             ldVsr,
      std::complex<float >  *work,
      IndexType             lWork,
-     double                rWork,
-     bool                  *bwork)
+     float                 *rWork,
+     IndexType             *bWork)
 {
+    typedef IndexType (*LapackSelect)(const float  *, const float  *);
+
     CXXLAPACK_DEBUG_OUT("cgges");
 
     IndexType info;
-    // TODO: Convert bwork into a logical array!
     LAPACK_IMPL(cgges)(&jobvsl,
                        &jobvsr,
                        &sort,
-                       &select,
+                       reinterpret_cast<LapackSelect>(select),
                        &n,
                        reinterpret_cast<float  *>(A),
                        &ldA,
@@ -195,7 +198,7 @@ gges(char                  jobvsl,
                        reinterpret_cast<float  *>(work),
                        &lWork,
                        rWork,
-                       bwork,
+                       bWork,
                        &info);
 #   ifndef NDEBUG
     if (info<0) {
@@ -211,7 +214,7 @@ IndexType
 gges(char                  jobvsl,
      char                  jobvsr,
      char                  sort,
-     IndexType              (*select)(const std::complex<double> *),
+     IndexType             (*select)(const std::complex<double> *, const std::complex<double> *),
      IndexType             n,
      std::complex<double>  *A,
      IndexType             ldA,
@@ -226,17 +229,18 @@ gges(char                  jobvsl,
      IndexType             ldVsr,
      std::complex<double>  *work,
      IndexType             lWork,
-     double                rWork,
-     bool                  *bwork)
+     double                *rWork,
+     IndexType             *bWork)
 {
+    typedef IndexType (*LapackSelect)(const double *, const double *);
+
     CXXLAPACK_DEBUG_OUT("zgges");
 
     IndexType info;
-    // TODO: Convert bwork into a logical array!
     LAPACK_IMPL(zgges)(&jobvsl,
                        &jobvsr,
                        &sort,
-                       &select,
+                       reinterpret_cast<LapackSelect>(select),
                        &n,
                        reinterpret_cast<double *>(A),
                        &ldA,
@@ -252,7 +256,7 @@ gges(char                  jobvsl,
                        reinterpret_cast<double *>(work),
                        &lWork,
                        rWork,
-                       bwork,
+                       bWork,
                        &info);
 #   ifndef NDEBUG
     if (info<0) {
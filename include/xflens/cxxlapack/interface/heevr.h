@@ -54,6 +54,7 @@ template <typename IndexType>
           float                 *w,
           std::complex<float >  *Z,
           IndexType             ldZ,
+          IndexType             *isuppz,
           std::complex<float >  *work,
           IndexType             lWork,
           float                 *rWork,
@@ -78,6 +79,7 @@ template <typename IndexType>
           double                *w,
           std::complex<double>  *Z,
           IndexType             ldZ,
+          IndexType             *isuppz,
           std::complex<double>  *work,
           IndexType             lWork,
           double                *rWork,
@@ -56,6 +56,7 @@ heevr(char                  jobz,
       float                 *w,
       std::complex<float >  *Z,
       IndexType             ldZ,
+      IndexType             *isuppz,
       std::complex<float >  *work,
       IndexType             lWork,
       float                 *rWork,
@@ -81,6 +82,7 @@ heevr(char                  jobz,
                         w,
                         reinterpret_cast<float  *>(Z),
                         &ldZ,
+                        isuppz,
                         reinterpret_cast<float  *>(work),
                         &lWork,
                         rWork,
@@ -115,6 +117,7 @@ heevr(char                  jobz,
       double                *w,
       std::complex<double>  *Z,
       IndexType             ldZ,
+      IndexType             *isuppz,
       std::complex<double>  *work,
       IndexType             lWork,
       double                *rWork,
@@ -140,6 +143,7 @@ heevr(char                  jobz,
                         w,
                         reinterpret_cast<double *>(Z),
                         &ldZ,
+                        isuppz,
                         reinterpret_cast<double *>(work),
                         &lWork,
                         rWork,
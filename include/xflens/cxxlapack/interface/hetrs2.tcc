@@ -57,10 +57,9 @@ hetrs2(char                        uplo,
     LAPACK_IMPL(chetrs2)(&uplo,
                         &n,
                         &nRhs,
-                        reinterpret_cast<const float  *>(A),
+                        reinterpret_cast<float  *>(const_cast<std::complex<float > *>(A)),
                         &ldA,
                         iPiv,
-                        B,
                         reinterpret_cast<float  *>(B),
                         &ldB,
                         reinterpret_cast<float  *>(work),
@@ -92,10 +91,9 @@ hetrs2(char                        uplo,
     LAPACK_IMPL(zhetrs2)(&uplo,
                         &n,
                         &nRhs,
-                        reinterpret_cast<const double *>(A),
+                        reinterpret_cast<double *>(const_cast<std::complex<double> *>(A)),
                         &ldA,
                         iPiv,
-                        B,
                         reinterpret_cast<double *>(B),
                         &ldB,
                         reinterpret_cast<double *>(work),
@@ -40,28 +40,28 @@ namespace cxxlapack {
 template <typename IndexType>
     void
     larnv(IndexType             idist,
-          IndexType             iseed,
+          IndexType             *iseed,
           IndexType             n,
           float                 *x);
 
 template <typename IndexType>
     void
     larnv(IndexType             idist,
-          IndexType             iseed,
+          IndexType             *iseed,
           IndexType             n,
           double                *x);
 
 template <typename IndexType>
     void
     larnv(IndexType             idist,
-          IndexType             iseed,
+          IndexType             *iseed,
           IndexType             n,
           std::complex<float >  *x);
 
 template <typename IndexType>
     void
     larnv(IndexType             idist,
-          IndexType             iseed,
+          IndexType             *iseed,
           IndexType             n,
           std::complex<double>  *x);
 
@@ -42,14 +42,14 @@ namespace cxxlapack {
 template <typename IndexType>
 void
 larnv(IndexType             idist,
-      IndexType             iseed,
+      IndexType             *iseed,
       IndexType             n,
       float                 *x)
 {
     CXXLAPACK_DEBUG_OUT("slarnv");
 
     LAPACK_IMPL(slarnv)(&idist,
-                        &iseed,
+                        iseed,
                         &n,
                         x);
 }
@@ -58,14 +58,14 @@ larnv(IndexType             idist,
 template <typename IndexType>
 void
 larnv(IndexType             idist,
-      IndexType             iseed,
+      IndexType             *iseed,
       IndexType             n,
       double                *x)
 {
     CXXLAPACK_DEBUG_OUT("dlarnv");
 
     LAPACK_IMPL(dlarnv)(&idist,
-                        &iseed,
+                        iseed,
                         &n,
                         x);
 }
@@ -73,14 +73,14 @@ larnv(IndexType             idist,
 template <typename IndexType>
 void
 larnv(IndexType             idist,
-      IndexType             iseed,
+      IndexType             *iseed,
       IndexType             n,
       std::complex<float >  *x)
 {
     CXXLAPACK_DEBUG_OUT("clarnv");
 
     LAPACK_IMPL(clarnv)(&idist,
-                        &iseed,
+                        iseed,
                         &n,
                         reinterpret_cast<float  *>(x));
 }
@@ -88,14 +88,14 @@ larnv(IndexType             idist,
 template <typename IndexType>
 void
 larnv(IndexType             idist,
-      IndexType             iseed,
+      IndexType             *iseed,
       IndexType             n,
       std::complex<double>  *x)
 {
     CXXLAPACK_DEBUG_OUT("zlarnv");
 
     LAPACK_IMPL(zlarnv)(&idist,
-                        &iseed,
+                        iseed,
                         &n,
                         reinterpret_cast<double *>(x));
 }
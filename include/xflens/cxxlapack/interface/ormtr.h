@@ -30,8 +30,8 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef CXXLAPACK_INTERFACE_ORMTR_TCC
-#define CXXLAPACK_INTERFACE_ORMTR_TCC 1
+#ifndef CXXLAPACK_INTERFACE_ORMTR_H
+#define CXXLAPACK_INTERFACE_ORMTR_H 1
 
 #include <complex>
 
@@ -46,6 +46,7 @@ template <typename IndexType>
           IndexType             n,
           const float           *A,
           IndexType             ldA,
+          const float           *tau,
           float                 *C,
           IndexType             ldC,
           float                 *work,
@@ -60,6 +61,7 @@ template <typename IndexType>
           IndexType             n,
           const double          *A,
           IndexType             ldA,
+          const double          *tau,
           double                *C,
           IndexType             ldC,
           double                *work,
@@ -67,4 +69,4 @@ template <typename IndexType>
 
 } // namespace cxxlapack
 
-#endif // CXXLAPACK_INTERFACE_ORMTR_TCC
+#endif // CXXLAPACK_INTERFACE_ORMTR_H
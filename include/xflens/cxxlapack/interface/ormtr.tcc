@@ -48,6 +48,7 @@ ormtr(char                  side,
       IndexType             n,
       const float           *A,
       IndexType             ldA,
+      const float           *tau,
       float                 *C,
       IndexType             ldC,
       float                 *work,
@@ -63,6 +64,7 @@ ormtr(char                  side,
                         &n,
                         A,
                         &ldA,
+                        tau,
                         C,
                         &ldC,
                         work,
@@ -86,6 +88,7 @@ ormtr(char                  side,
       IndexType             n,
       const double          *A,
       IndexType             ldA,
+      const double          *tau,
       double                *C,
       IndexType             ldC,
       double                *work,
@@ -101,6 +104,7 @@ ormtr(char                  side,
                         &n,
                         A,
                         &ldA,
+                        tau,
                         C,
                         &ldC,
                         work,
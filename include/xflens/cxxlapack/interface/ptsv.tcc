@@ -46,7 +46,7 @@ ptsv (IndexType             n,
       float                 *d,
       float                 *e,
       float                 *B,
-      IndexType             &ldB)
+      IndexType             ldB)
 {
     CXXLAPACK_DEBUG_OUT("sptsv");
 
@@ -75,7 +75,7 @@ ptsv (IndexType             n,
       double                *d,
       double                *e,
       double                *B,
-      IndexType             &ldB)
+      IndexType             ldB)
 {
     CXXLAPACK_DEBUG_OUT("dptsv");
 
@@ -100,17 +100,17 @@ template <typename IndexType>
 IndexType
 ptsv (IndexType             n,
       IndexType             nRhs,
-      std::complex<float >  *d,
+      float                 *d,
       std::complex<float >  *e,
       std::complex<float >  *B,
-      IndexType             &ldB)
+      IndexType             ldB)
 {
     CXXLAPACK_DEBUG_OUT("cptsv");
 
     IndexType info;
     LAPACK_IMPL(cptsv) (&n,
                         &nRhs,
-                        reinterpret_cast<float  *>(d),
+                        d,
                         reinterpret_cast<float  *>(e),
                         reinterpret_cast<float  *>(B),
                         &ldB,
@@ -128,17 +128,17 @@ template <typename IndexType>
 IndexType
 ptsv (IndexType             n,
       IndexType             nRhs,
-      std::complex<double>  *d,
+      double                *d,
       std::complex<double>  *e,
       std::complex<double>  *B,
-      IndexType             &ldB)
+      IndexType             ldB)
 {
     CXXLAPACK_DEBUG_OUT("zptsv");
 
     IndexType info;
     LAPACK_IMPL(zptsv) (&n,
                         &nRhs,
-                        reinterpret_cast<double *>(d),
+                        d,
                         reinterpret_cast<double *>(e),
                         reinterpret_cast<double *>(B),
                         &ldB,
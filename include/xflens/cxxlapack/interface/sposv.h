@@ -41,6 +41,7 @@ template <typename IndexType>
     IndexType
     sposv(char                  uplo,
           IndexType             n,
+          IndexType             nRhs,
           double                *A,
           IndexType             ldA,
           const double          *B,
@@ -43,6 +43,7 @@ template <typename IndexType>
 IndexType
 sposv(char                  uplo,
       IndexType             n,
+      IndexType             nRhs,
       double                *A,
       IndexType             ldA,
       const double          *B,
@@ -58,6 +59,7 @@ sposv(char                  uplo,
     IndexType info;
     LAPACK_IMPL(dsposv)(&uplo,
                         &n,
+                        &nRhs,
                         A,
                         &ldA,
                         B,
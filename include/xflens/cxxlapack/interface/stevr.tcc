@@ -65,7 +65,7 @@ stevr(char                  jobz,
 
     IndexType info;
     LAPACK_IMPL(sstevr)(&jobz,
-                        &range
+                        &range,
                         &n,
                         d,
                         e,
@@ -119,7 +119,7 @@ stevr(char                  jobz,
 
     IndexType info;
     LAPACK_IMPL(dstevr)(&jobz,
-                        &range
+                        &range,
                         &n,
                         d,
                         e,
@@ -70,8 +70,7 @@ template <typename IndexType>
           const IndexType             *iPiv,
           float                       anorm,
           float                       &rCond,
-          std::complex<float >        *work,
-          IndexType                   *iWork);
+          std::complex<float >        *work);
 
 template <typename IndexType>
     IndexType
@@ -82,8 +81,7 @@ template <typename IndexType>
           const IndexType             *iPiv,
           double                      anorm,
           double                      &rCond,
-          std::complex<double>        *work,
-          IndexType                   *iWork);
+          std::complex<double>        *work);
 
 } // namespace cxxlapack
 
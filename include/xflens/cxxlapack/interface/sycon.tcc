@@ -117,8 +117,7 @@ sycon(char                        uplo,
       const IndexType             *iPiv,
       float                       anorm,
       float                       &rCond,
-      std::complex<float >        *work,
-      IndexType                   *iWork)
+      std::complex<float >        *work)
 {
     CXXLAPACK_DEBUG_OUT("csycon");
 
@@ -131,7 +130,6 @@ sycon(char                        uplo,
                         &anorm,
                         &rCond,
                         reinterpret_cast<float  *>(work),
-                        iWork,
                         &info);
 #   ifndef NDEBUG
     if (info<0) {
@@ -151,8 +149,7 @@ sycon(char                        uplo,
       const IndexType             *iPiv,
       double                      anorm,
       double                      &rCond,
-      std::complex<double>        *work,
-      IndexType                   *iWork)
+      std::complex<double>        *work)
 {
     CXXLAPACK_DEBUG_OUT("zsycon");
 
@@ -165,7 +162,6 @@ sycon(char                        uplo,
                         &anorm,
                         &rCond,
                         reinterpret_cast<double *>(work),
-                        iWork,
                         &info);
 #   ifndef NDEBUG
     if (info<0) {
@@ -39,7 +39,7 @@ namespace cxxlapack {
 
 template <typename IndexType>
     IndexType
-    sygst(char                  itype,
+    sygst(IndexType             itype,
           char                  uplo,
           IndexType             n,
           float                 *A,
@@ -49,7 +49,7 @@ template <typename IndexType>
 
 template <typename IndexType>
     IndexType
-    sygst(char                  itype,
+    sygst(IndexType             itype,
           char                  uplo,
           IndexType             n,
           double                *A,
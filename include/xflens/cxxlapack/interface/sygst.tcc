@@ -41,7 +41,7 @@ namespace cxxlapack {
 
 template <typename IndexType>
 IndexType
-sygst(char                  itype,
+sygst(IndexType             itype,
       char                  uplo,
       IndexType             n,
       float                 *A,
@@ -71,7 +71,7 @@ sygst(char                  itype,
 
 template <typename IndexType>
 IndexType
-sygst(char                  itype,
+sygst(IndexType             itype,
       char                  uplo,
       IndexType             n,
       double                *A,
@@ -126,7 +126,7 @@ sytrs2(char                        uplo,
     LAPACK_IMPL(csytrs2)(&uplo,
                         &n,
                         &nRhs,
-                        reinterpret_cast<const float  *>(A),
+                        reinterpret_cast<float  *>(const_cast<std::complex<float > *>(A)),
                         &ldA,
                         iPiv,
                         reinterpret_cast<float  *>(B),
@@ -160,7 +160,7 @@ sytrs2(char                        uplo,
     LAPACK_IMPL(zsytrs2)(&uplo,
                         &n,
                         &nRhs,
-                        reinterpret_cast<const double *>(A),
+                        reinterpret_cast<double *>(const_cast<std::complex<double> *>(A)),
                         &ldA,
                         iPiv,
                         reinterpret_cast<double *>(B),
@@ -37,111 +37,111 @@
 
 namespace cxxlapack {
 
-// template <typename IndexType>
-//     IndexType
-//     tgsen(IndexType             ijob,
-//           bool                  wantq,
-//           bool                  wantz,
-//           bool                  *select,
-//           IndexType             n,
-//           float                 *A,
-//           IndexType             ldA,
-//           float                 *B,
-//           IndexType             ldB,
-//           float                 *alphar,
-//           float                 *alphai,
-//           float                 *beta,
-//           float                 *Q,
-//           IndexType             ldQ,
-//           float                 *Z,
-//           IndexType             ldZ,
-//           IndexType             &m,
-//           float                 &pl,
-//           float                 &pr,
-//           float                 *dif,
-//           float                 *work,
-//           IndexType             lWork,
-//           IndexType             *iWork,
-//           IndexType             liWork);
-//
-// template <typename IndexType>
-//     IndexType
-//     tgsen(IndexType             ijob,
-//           bool                  wantq,
-//           bool                  wantz,
-//           bool                  *select,
-//           IndexType             n,
-//           double                *A,
-//           IndexType             ldA,
-//           double                *B,
-//           IndexType             ldB,
-//           double                *alphar,
-//           double                *alphai,
-//           double                *beta,
-//           double                *Q,
-//           IndexType             ldQ,
-//           double                *Z,
-//           IndexType             ldZ,
-//           IndexType             &m,
-//           double                &pl,
-//           double                &pr,
-//           double                *dif,
-//           double                *work,
-//           IndexType             lWork,
-//           IndexType             *iWork,
-//           IndexType             liWork);
-//
-// template <typename IndexType>
-//     IndexType
-//     tgsen(IndexType             ijob,
-//           bool                  wantq,
-//           bool                  wantz,
-//           bool                  *select,
-//           IndexType             n,
-//           std::complex<float >  *A,
-//           IndexType             ldA,
-//           std::complex<float >  *B,
-//           IndexType             ldB,
-//           std::complex<float >  *alpha,
-//           std::complex<float >  *beta,
-//           std::complex<float >  *Q,
-//           IndexType             ldQ,
-//           std::complex<float >  *Z,
-//           IndexType             ldZ,
-//           IndexType             &m,
-//           double                &pl,
-//           double                &pr,
-//           double                *dif,
-//           std::complex<float >  *work,
-//           IndexType             lWork,
-//           IndexType             *iWork,
-//           IndexType             liWork);
+template <typename IndexType>
+    IndexType
+    tgsen(IndexType             ijob,
+          IndexType             wantq,
+          IndexType             wantz,
+          const IndexType       *select,
+          IndexType             n,
+          float                 *A,
+          IndexType             ldA,
+          float                 *B,
+          IndexType             ldB,
+          float                 *alphar,
+          float                 *alphai,
+          float                 *beta,
+          float                 *Q,
+          IndexType             ldQ,
+          float                 *Z,
+          IndexType             ldZ,
+          IndexType             &m,
+          float                 &pl,
+          float                 &pr,
+          float                 *dif,
+          float                 *work,
+          IndexType             lWork,
+          IndexType             *iWork,
+          IndexType             liWork);
 
-// template <typename IndexType>
-//     IndexType
-//     tgsen(IndexType             ijob,
-//           bool                  wantq,
-//           bool                  wantz,
-//           bool                  *select,
-//           IndexType             n,
-//           std::complex<double>  *A,
-//           IndexType             ldA,
-//           std::complex<double>  *B,
-//           IndexType             ldB,
-//           std::complex<double>  *alpha,
-//           std::complex<double>  *beta,
-//           std::complex<double>  *Q,
-//           IndexType             ldQ,
-//           std::complex<double>  *Z,
-//           IndexType             ldZ,
-//           IndexType             &m,
-//           double                &pl,
-//           double                &pr,
-//           double                *dif,
-//           std::complex<double>  *work,
-//           IndexType             lWork,
-//           IndexType             *iWork,
-//           IndexType             liWork);
+template <typename IndexType>
+    IndexType
+    tgsen(IndexType             ijob,
+          IndexType             wantq,
+          IndexType             wantz,
+          const IndexType       *select,
+          IndexType             n,
+          double                *A,
+          IndexType             ldA,
+          double                *B,
+          IndexType             ldB,
+          double                *alphar,
+          double                *alphai,
+          double                *beta,
+          double                *Q,
+          IndexType             ldQ,
+          double                *Z,
+          IndexType             ldZ,
+          IndexType             &m,
+          double                &pl,
+          double                &pr,
+          double                *dif,
+          double                *work,
+          IndexType             lWork,
+          IndexType             *iWork,
+          IndexType             liWork);
+
+template <typename IndexType>
+    IndexType
+    tgsen(IndexType             ijob,
+          IndexType             wantq,
+          IndexType             wantz,
+          const IndexType       *select,
+          IndexType             n,
+          std::complex<float >  *A,
+          IndexType             ldA,
+          std::complex<float >  *B,
+          IndexType             ldB,
+          std::complex<float >  *alpha,
+          std::complex<float >  *beta,
+          std::complex<float >  *Q,
+          IndexType             ldQ,
+          std::complex<float >  *Z,
+          IndexType             ldZ,
+          IndexType             &m,
+          float                 &pl,
+          float                 &pr,
+          float                 *dif,
+          std::complex<float >  *work,
+          IndexType             lWork,
+          IndexType             *iWork,
+          IndexType             liWork);
+
+template <typename IndexType>
+    IndexType
+    tgsen(IndexType             ijob,
+          IndexType             wantq,
+          IndexType             wantz,
+          const IndexType       *select,
+          IndexType             n,
+          std::complex<double>  *A,
+          IndexType             ldA,
+          std::complex<double>  *B,
+          IndexType             ldB,
+          std::complex<double>  *alpha,
+          std::complex<double>  *beta,
+          std::complex<double>  *Q,
+          IndexType             ldQ,
+          std::complex<double>  *Z,
+          IndexType             ldZ,
+          IndexType             &m,
+          double                &pl,
+          double                &pr,
+          double                *dif,
+          std::complex<double>  *work,
+          IndexType             lWork,
+          IndexType             *iWork,
+          IndexType             liWork);
 
 } // namespace cxxlapack
 
@@ -49,7 +49,7 @@ trsen(char              job,
       IndexType         n,
       float             *T,
       IndexType         ldT,
-      double            *Q,
+      float             *Q,
       IndexType         ldQ,
       float             *wr,
       float             *wi,
@@ -164,7 +164,7 @@ trsen(char                  job,
     IndexType info;
     LAPACK_IMPL(ctrsen)(&job,
                         &compQ,
-                        *select,
+                        select,
                         &n,
                         reinterpret_cast<float  *>(T),
                         &ldT,
@@ -208,7 +208,7 @@ trsen(char                  job,
     IndexType info;
     LAPACK_IMPL(ztrsen)(&job,
                         &compQ,
-                        *select,
+                        select,
                         &n,
                         reinterpret_cast<double *>(T),
                         &ldT,
@@ -30,8 +30,8 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef CXXLAPACK_INTERFACE_UNMTR_TCC
-#define CXXLAPACK_INTERFACE_UNMTR_TCC 1
+#ifndef CXXLAPACK_INTERFACE_UNMTR_H
+#define CXXLAPACK_INTERFACE_UNMTR_H 1
 
 #include <complex>
 
@@ -69,4 +69,4 @@ template <typename IndexType>
 
 } // namespace cxxlapack
 
-#endif // CXXLAPACK_INTERFACE_UNMTR_TCC
+#endif // CXXLAPACK_INTERFACE_UNMTR_H
@@ -1,10 +1,12 @@
 #include "xflens/cxxlapack/netlib/netlib.h"
 
 #ifndef INTEGER
-#    ifndef MKL_ILP64
-typedef int INTEGER;
-#    else
+#    if defined(MKL_ILP64)
 typedef long INTEGER;
+#    elif defined(BLASINT)
+typedef BLASINT INTEGER;
+#    else
+typedef int INTEGER;
 #    endif
 #endif
 
@@ -997,7 +999,7 @@ void
 LAPACK_IMPL(cgges)(const char           *JOBVSL,
                    const char           *JOBVSR,
                    const char           *SORT,
-                   const LOGICAL        *SELCTG,
+                   LOGICAL              (*SELCTG)(const FLOAT_COMPLEX *, const FLOAT_COMPLEX *),
                    const INTEGER        *N,
                    FLOAT_COMPLEX        *A,
                    const INTEGER        *LDA,
@@ -6811,7 +6813,7 @@ void
 LAPACK_IMPL(dgges)(const char           *JOBVSL,
                    const char           *JOBVSR,
                    const char           *SORT,
-                   const LOGICAL        *SELCTG,
+                   LOGICAL              (*SELCTG)(const DOUBLE *, const DOUBLE *, const DOUBLE *),
                    const INTEGER        *N,
                    DOUBLE               *A,
                    const INTEGER        *LDA,
@@ -13133,7 +13135,7 @@ void
 LAPACK_IMPL(sgges)(const char           *JOBVSL,
                    const char           *JOBVSR,
                    const char           *SORT,
-                   const LOGICAL        *SELCTG,
+                   LOGICAL              (*SELCTG)(const FLOAT *, const FLOAT *, const FLOAT *),
                    const INTEGER        *N,
                    FLOAT                *A,
                    const INTEGER        *LDA,
@@ -19268,7 +19270,7 @@ void
 LAPACK_IMPL(zgges)(const char           *JOBVSL,
                    const char           *JOBVSR,
                    const char           *SORT,
-                   const LOGICAL        *SELCTG,
+                   LOGICAL              (*SELCTG)(const DOUBLE_COMPLEX *, const DOUBLE_COMPLEX *),
                    const INTEGER        *N,
                    DOUBLE_COMPLEX       *A,
                    const INTEGER        *LDA,
@@ -5,7 +5,18 @@
 #   undef   LAPACK_IMPL
 #endif
 
-#ifndef CXXLAPACK_NO_UNDERSCORE
+//  CXXBLAS_SYMBOL_SUFFIX is appended to the symbol, e.g. dgetrf_64_ for an
+//  OpenBLAS built with SYMBOLSUFFIX=64_ (or dgetrf_64 for MKL's _64 interface
+//  together with CXXLAPACK_NO_UNDERSCORE)
+#if defined(CXXBLAS_SYMBOL_SUFFIX) && !defined(WITH_DYNAMICBLAS)
+#   define     CXXLAPACK_SUFFIX_CAT_(x, s)      x##s
+#   define     CXXLAPACK_SUFFIX_CAT(x, s)       CXXLAPACK_SUFFIX_CAT_(x, s)
+#   ifndef CXXLAPACK_NO_UNDERSCORE
+#       define LAPACK_IMPL(x)   CXXLAPACK_SUFFIX_CAT(x##_, CXXBLAS_SYMBOL_SUFFIX)
+#   else
+#       define LAPACK_IMPL(x)   CXXLAPACK_SUFFIX_CAT(x, CXXBLAS_SYMBOL_SUFFIX)
+#   endif
+#elif !defined(CXXLAPACK_NO_UNDERSCORE)
 #   define     LAPACK_IMPL(x)           x##_
 #else
 #   define     LAPACK_IMPL(x)           x
@@ -27,4 +38,26 @@ extern "C" {
 
 }
 
+//  with a runtime selected library every LAPACK call site looks its symbol
+//  up in the library loaded by cxxblas.  The function type is taken from
+//  the call (the lookup of f stays dependent), so that interfaces without a
+//  declaration in lapack.in.h only fail if they are instantiated.
+#ifdef WITH_DYNAMICBLAS
+#   include "xflens/cxxblas/drivers/dynamicblas.h"
+#   undef   LAPACK_IMPL
+#   ifndef CXXLAPACK_NO_UNDERSCORE
+#       define  LAPACK_IMPL(x)          CXXLAPACK_DYNAMIC_IMPL(x##_)
+#   else
+#       define  LAPACK_IMPL(x)          CXXLAPACK_DYNAMIC_IMPL(x)
+#   endif
+#   define  CXXLAPACK_DYNAMIC_IMPL(f)                                       \
+        ([](auto... args) -> decltype(f(args...)) {                         \
+            typedef decltype(f(args...)) (*F)(decltype(args)...);           \
+            static const F f_                                               \
+                = ::cxxblas::dynamic::resolve<F>(#f CXXBLAS_SUFFIX_STR,     \
+                                                 nullptr);                  \
+            return f_(args...);                                             \
+        })
+#endif
+
 #endif //  CXXLAPACK_NETLIB_NETLIB_H
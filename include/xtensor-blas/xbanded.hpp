@@ -0,0 +1,617 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XBANDED_HPP
+#define XBANDED_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xstorage.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+    /***********
+     * xbanded *
+     ***********/
+
+    /**
+     * m by n band matrix with \em kl sub-diagonals and \em ku super-diagonals.
+     *
+     * The band is stored as in BLAS and LAPACK, in a column major
+     * (kl + ku + 1) by n array where ``storage()(ku + i - j, j) == A(i, j)``.
+     * Elements of the storage outside of the matrix are never read.
+     *
+     * It is not an xexpression: linalg::dot, solve_banded and lu_factor have
+     * overloads taking it, and dense() expands it when an xtensor is needed.
+     */
+    template <class T>
+    class xbanded
+    {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+        using storage_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        xbanded() = default;
+        xbanded(size_type m, size_type n, size_type kl, size_type ku, const value_type& value = value_type(0));
+
+        template <class E>
+        xbanded(const xexpression<E>& e, size_type kl, size_type ku);
+
+        shape_type shape() const noexcept;
+        size_type dimension() const noexcept;
+        size_type kl() const noexcept;
+        size_type ku() const noexcept;
+
+        bool in_band(size_type i, size_type j) const noexcept;
+        value_type operator()(size_type i, size_type j) const;
+        value_type& band(size_type i, size_type j);
+        const value_type& band(size_type i, size_type j) const;
+
+        storage_type& storage() noexcept;
+        const storage_type& storage() const noexcept;
+        value_type* data() noexcept;
+        const value_type* data() const noexcept;
+
+        xtensor<value_type, 2, layout_type::column_major> dense() const;
+
+    private:
+
+        storage_type m_storage;
+        size_type m_rows = 0;
+        size_type m_kl = 0;
+        size_type m_ku = 0;
+    };
+
+    /**************************
+     * xbanded implementation *
+     **************************/
+
+    /**
+     * Builds an m by n band matrix with every element of the band set to
+     * \em value.
+     */
+    template <class T>
+    inline xbanded<T>::xbanded(size_type m, size_type n, size_type kl, size_type ku, const value_type& value)
+        : m_storage(std::array<size_type, 2>{kl + ku + 1, n}, value), m_rows(m), m_kl(kl), m_ku(ku)
+    {
+    }
+
+    /**
+     * Copies the band of the matrix \em e. Elements outside of the band are
+     * not read.
+     */
+    template <class T>
+    template <class E>
+    inline xbanded<T>::xbanded(const xexpression<E>& e, size_type kl, size_type ku)
+        : xbanded(e.derived_cast().shape()[0], e.derived_cast().shape()[1], kl, ku)
+    {
+        const auto& de = e.derived_cast();
+        XTENSOR_ASSERT(de.dimension() == 2);
+        for (size_type j = 0; j < shape()[1]; ++j)
+        {
+            size_type first = j > m_ku ? j - m_ku : 0;
+            size_type last = std::min(m_rows, j + m_kl + 1);
+            for (size_type i = first; i < last; ++i)
+            {
+                band(i, j) = de(i, j);
+            }
+        }
+    }
+
+    template <class T>
+    inline auto xbanded<T>::shape() const noexcept -> shape_type
+    {
+        return {m_rows, m_storage.shape()[1]};
+    }
+
+    template <class T>
+    inline auto xbanded<T>::dimension() const noexcept -> size_type
+    {
+        return 2;
+    }
+
+    template <class T>
+    inline auto xbanded<T>::kl() const noexcept -> size_type
+    {
+        return m_kl;
+    }
+
+    template <class T>
+    inline auto xbanded<T>::ku() const noexcept -> size_type
+    {
+        return m_ku;
+    }
+
+    /**
+     * Returns true when element (i, j) lies in the band.
+     */
+    template <class T>
+    inline bool xbanded<T>::in_band(size_type i, size_type j) const noexcept
+    {
+        return i <= j + m_kl && j <= i + m_ku;
+    }
+
+    /**
+     * Returns element (i, j) of the matrix, zero outside of the band.
+     */
+    template <class T>
+    inline auto xbanded<T>::operator()(size_type i, size_type j) const -> value_type
+    {
+        return in_band(i, j) ? band(i, j) : value_type(0);
+    }
+
+    /**
+     * Returns a reference to element (i, j) of the band.
+     */
+    template <class T>
+    inline auto xbanded<T>::band(size_type i, size_type j) -> value_type&
+    {
+        XTENSOR_ASSERT(in_band(i, j));
+        return m_storage(m_ku + i - j, j);
+    }
+
+    template <class T>
+    inline auto xbanded<T>::band(size_type i, size_type j) const -> const value_type&
+    {
+        XTENSOR_ASSERT(in_band(i, j));
+        return m_storage(m_ku + i - j, j);
+    }
+
+    template <class T>
+    inline auto xbanded<T>::storage() noexcept -> storage_type&
+    {
+        return m_storage;
+    }
+
+    template <class T>
+    inline auto xbanded<T>::storage() const noexcept -> const storage_type&
+    {
+        return m_storage;
+    }
+
+    template <class T>
+    inline auto xbanded<T>::data() noexcept -> value_type*
+    {
+        return m_storage.data();
+    }
+
+    template <class T>
+    inline auto xbanded<T>::data() const noexcept -> const value_type*
+    {
+        return m_storage.data();
+    }
+
+    /**
+     * Returns the full matrix as a column major xtensor.
+     */
+    template <class T>
+    inline auto xbanded<T>::dense() const -> xtensor<value_type, 2, layout_type::column_major>
+    {
+        xtensor<value_type, 2, layout_type::column_major> result(shape());
+        for (size_type j = 0; j < shape()[1]; ++j)
+        {
+            for (size_type i = 0; i < m_rows; ++i)
+            {
+                result(i, j) = (*this)(i, j);
+            }
+        }
+        return result;
+    }
+
+namespace linalg
+{
+    namespace detail
+    {
+        /**
+         * Copies the band of \em A into the 2 kl + ku + 1 rows layout of
+         * gbtrf, leaving room for the fill-in above the band.
+         */
+        template <class T>
+        inline auto band_factor_storage(const xbanded<T>& A)
+        {
+            std::size_t kl = A.kl(), ku = A.ku(), n = A.shape()[1];
+            xtensor<T, 2, layout_type::column_major> ab(std::array<std::size_t, 2>{2 * kl + ku + 1, n}, T(0));
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                std::size_t first = j > ku ? j - ku : 0;
+                std::size_t last = std::min(A.shape()[0], j + kl + 1);
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    ab(kl + ku + i - j, j) = A.band(i, j);
+                }
+            }
+            return ab;
+        }
+
+        template <class T>
+        inline auto band_one_norm(const xbanded<T>& A)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            real_type result(0);
+            for (std::size_t j = 0; j < A.shape()[1]; ++j)
+            {
+                std::size_t first = j > A.ku() ? j - A.ku() : 0;
+                std::size_t last = std::min(A.shape()[0], j + A.kl() + 1);
+                real_type col(0);
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    col += std::abs(A.band(i, j));
+                }
+                result = std::max(result, col);
+            }
+            return result;
+        }
+
+        template <class T>
+        inline void check_square_band(const xbanded<T>& A)
+        {
+            if (A.shape()[0] != A.shape()[1])
+            {
+                XTENSOR_THROW(std::runtime_error, "Banded solve: matrix is not square.");
+            }
+        }
+
+        template <class E>
+        inline void check_band_rhs(const E& b, std::size_t n)
+        {
+            if (b.dimension() > 2 || b.shape()[0] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, "Banded solve: right hand side has the wrong shape.");
+            }
+        }
+    }
+
+    /**
+     * Matrix product of the band matrix \em A with the vector or matrix
+     * \em x, computed by gbmv column by column without expanding \em A.
+     * @return the product, with one row per row of \em A
+     */
+    template <class T, class E>
+    auto dot(const xbanded<T>& A, const xexpression<E>& x)
+    {
+        auto p = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        std::size_t m = A.shape()[0], n = A.shape()[1];
+        if (p.dimension() > 2 || p.shape()[0] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+        }
+
+        auto shape = p.shape();
+        shape[0] = m;
+        auto result = decltype(p)::from_shape(shape);
+        std::size_t k = p.dimension() == 2 ? p.shape()[1] : 1;
+        for (std::size_t j = 0; j < k; ++j)
+        {
+            cxxblas::gbmv<blas_index_t>(
+                cxxblas::StorageOrder::ColMajor,
+                cxxblas::Transpose::NoTrans,
+                to_blas_index(m),
+                to_blas_index(n),
+                to_blas_index(A.kl()),
+                to_blas_index(A.ku()),
+                T(1),
+                A.data(),
+                to_blas_index(A.kl() + A.ku() + 1),
+                p.data() + j * n,
+                blas_index_t(1),
+                T(0),
+                result.data() + j * m,
+                blas_index_t(1)
+            );
+        }
+        return result;
+    }
+
+    /**
+     * Solves the tridiagonal system A x = b, where A has sub-diagonal \em dl,
+     * diagonal \em d and super-diagonal \em du, with gtsv in O(n).
+     * @return solution x, with the shape of \em b
+     */
+    template <class E1, class E2, class E3, class E4>
+    auto solve_tridiagonal(const xexpression<E1>& dl, const xexpression<E2>& d,
+                           const xexpression<E3>& du, const xexpression<E4>& b)
+    {
+        using value_type = typename E2::value_type;
+        using vector_type = xtensor<value_type, 1, layout_type::column_major>;
+
+        vector_type dl_ = dl.derived_cast(), d_ = d.derived_cast(), du_ = du.derived_cast();
+        std::size_t n = d_.size();
+        if (dl_.size() + 1 != std::max(n, std::size_t(1)) || du_.size() != dl_.size())
+        {
+            XTENSOR_THROW(std::runtime_error, "Tridiagonal solve: diagonals have the wrong size.");
+        }
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        detail::check_band_rhs(x, n);
+
+        int info = lapack::gtsv(dl_, d_, du_, x);
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return x;
+    }
+
+    /**
+     * Solves the symmetric (Hermitian) positive definite tridiagonal system
+     * A x = b, where A has the real diagonal \em d and the sub-diagonal \em e,
+     * with ptsv in O(n).
+     * @return solution x, with the shape of \em b
+     */
+    template <class E1, class E2, class E3>
+    auto solveh_tridiagonal(const xexpression<E1>& d, const xexpression<E2>& e, const xexpression<E3>& b)
+    {
+        using value_type = typename E2::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+
+        xtensor<real_type, 1, layout_type::column_major> d_ = d.derived_cast();
+        xtensor<value_type, 1, layout_type::column_major> e_ = e.derived_cast();
+        std::size_t n = d_.size();
+        if (e_.size() + 1 != std::max(n, std::size_t(1)))
+        {
+            XTENSOR_THROW(std::runtime_error, "Tridiagonal solve: diagonals have the wrong size.");
+        }
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        detail::check_band_rhs(x, n);
+
+        int info = lapack::ptsv(d_, e_, x);
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Matrix is not positive definite.");
+        }
+        return x;
+    }
+
+    /**
+     * Solves A x = b for the square band matrix \em A in O(n kl (kl + ku)),
+     * with gbsv, or with gtsv when A is tridiagonal.
+     * @return solution x, with the shape of \em b
+     */
+    template <class T, class E>
+    auto solve_banded(const xbanded<T>& A, const xexpression<E>& b)
+    {
+        detail::check_square_band(A);
+        std::size_t n = A.shape()[0];
+
+        if (A.kl() == 1 && A.ku() == 1 && n > 1)
+        {
+            const auto& ab = A.storage();
+            xtensor<T, 1, layout_type::column_major> dl(std::array<std::size_t, 1>{n - 1});
+            xtensor<T, 1, layout_type::column_major> du(std::array<std::size_t, 1>{n - 1});
+            xtensor<T, 1, layout_type::column_major> d(std::array<std::size_t, 1>{n});
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                d(i) = ab(1, i);
+            }
+            for (std::size_t i = 0; i + 1 < n; ++i)
+            {
+                dl(i) = ab(2, i);
+                du(i) = ab(0, i + 1);
+            }
+            return solve_tridiagonal(dl, d, du, b);
+        }
+
+        auto ab = detail::band_factor_storage(A);
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        detail::check_band_rhs(x, n);
+
+        uvector<blas_index_t> piv(std::max(n, std::size_t(1)));
+        int info = lapack::gbsv(ab, A.kl(), A.ku(), piv, x);
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return x;
+    }
+
+    /**
+     * LU factorization with partial pivoting P A = L U of a square band
+     * matrix, as returned by lu_factor. U has kl + ku super-diagonals.
+     */
+    template <class T>
+    class banded_lu_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        explicit banded_lu_factorization(const xbanded<T>& A);
+
+        template <class E>
+        auto solve(const xexpression<E>& b, char trans = 'N') const;
+
+        value_type det() const;
+        std::tuple<value_type, real_type> logdet() const;
+        real_type rcond() const;
+
+        bool singular() const noexcept;
+        std::size_t kl() const noexcept;
+        std::size_t ku() const noexcept;
+        const matrix_type& matrix() const noexcept;
+        const uvector<blas_index_t>& pivots() const noexcept;
+
+    private:
+
+        matrix_type m_lu;
+        uvector<blas_index_t> m_piv;
+        std::size_t m_kl;
+        std::size_t m_ku;
+        real_type m_norm;
+        int m_info;
+    };
+
+    /******************************************
+     * banded_lu_factorization implementation *
+     ******************************************/
+
+    template <class T>
+    inline banded_lu_factorization<T>::banded_lu_factorization(const xbanded<T>& A)
+        : m_kl(A.kl()), m_ku(A.ku())
+    {
+        detail::check_square_band(A);
+        m_norm = detail::band_one_norm(A);
+        m_lu = detail::band_factor_storage(A);
+        m_piv.resize(std::max(A.shape()[0], std::size_t(1)));
+        m_info = lapack::gbtrf(m_lu, A.shape()[0], m_kl, m_ku, m_piv);
+        if (m_info < 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "LU factorization did not compute.");
+        }
+    }
+
+    /**
+     * Solve A x = b (A^T x = b for \em trans = 'T', A^H x = b for 'C').
+     * @return solution with the shape of \em b
+     */
+    template <class T>
+    template <class E>
+    inline auto banded_lu_factorization<T>::solve(const xexpression<E>& b, char trans) const
+    {
+        if (singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        if (x.shape()[0] != m_lu.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+        }
+        int info = lapack::gbtrs(m_lu, m_kl, m_ku, m_piv, x, trans);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return x;
+    }
+
+    template <class T>
+    inline auto banded_lu_factorization<T>::det() const -> value_type
+    {
+        value_type result(1);
+        for (std::size_t i = 0; i < m_lu.shape()[1]; ++i)
+        {
+            if (m_piv[i] != blas_index_t(i + 1))
+            {
+                result *= value_type(-1);
+            }
+            result *= m_lu(m_kl + m_ku, i);
+        }
+        return result;
+    }
+
+    /**
+     * @return (sign, log(abs(det))) of A. The sign has modulus one for complex
+     *         matrices, and the tuple is (0, -inf) for singular matrices.
+     */
+    template <class T>
+    inline auto banded_lu_factorization<T>::logdet() const -> std::tuple<value_type, real_type>
+    {
+        if (singular())
+        {
+            return std::make_tuple(value_type(0), -std::numeric_limits<real_type>::infinity());
+        }
+        value_type sign(1);
+        real_type result(0);
+        for (std::size_t i = 0; i < m_lu.shape()[1]; ++i)
+        {
+            if (m_piv[i] != blas_index_t(i + 1))
+            {
+                sign *= value_type(-1);
+            }
+            result += detail::log_abs_sign(sign, m_lu(m_kl + m_ku, i));
+        }
+        return std::make_tuple(sign, result);
+    }
+
+    /**
+     * @return estimate of the reciprocal condition number of A in the 1-norm
+     */
+    template <class T>
+    inline auto banded_lu_factorization<T>::rcond() const -> real_type
+    {
+        if (singular())
+        {
+            return real_type(0);
+        }
+        real_type result(0);
+        lapack::gbcon(m_lu, m_kl, m_ku, m_piv, '1', m_norm, result);
+        return result;
+    }
+
+    /**
+     * @return true if U has an exact zero on its diagonal
+     */
+    template <class T>
+    inline bool banded_lu_factorization<T>::singular() const noexcept
+    {
+        return m_info > 0;
+    }
+
+    template <class T>
+    inline std::size_t banded_lu_factorization<T>::kl() const noexcept
+    {
+        return m_kl;
+    }
+
+    template <class T>
+    inline std::size_t banded_lu_factorization<T>::ku() const noexcept
+    {
+        return m_ku;
+    }
+
+    /**
+     * @return L and U in the 2 kl + ku + 1 rows band storage of gbtrf
+     */
+    template <class T>
+    inline auto banded_lu_factorization<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_lu;
+    }
+
+    /**
+     * @return the (1-based) pivot indices as returned by gbtrf
+     */
+    template <class T>
+    inline auto banded_lu_factorization<T>::pivots() const noexcept -> const uvector<blas_index_t>&
+    {
+        return m_piv;
+    }
+
+    /**
+     * Compute the LU factorization of the band matrix \em A once, for
+     * repeated solves.
+     * @param A square band matrix
+     * @return banded_lu_factorization of \em A
+     */
+    template <class T>
+    inline auto lu_factor(const xbanded<T>& A)
+    {
+        return banded_lu_factorization<T>(A);
+    }
+}
+}
+
+#endif
@@ -11,148 +11,1774 @@
 #define XBLAS_HPP
 
 #include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <tuple>
+#include <utility>
 
 #include "xtensor/xarray.hpp"
 #include "xtensor/xcomplex.hpp"
 #include "xtensor/xio.hpp"
+#include "xtensor/xscalar.hpp"
 #include "xtensor/xtensor.hpp"
 #include "xtensor/xutils.hpp"
 
+#include "xtensor-blas/xblas_allocator.hpp"
 #include "xtensor-blas/xblas_config.hpp"
+#include "xtensor-blas/xblas_threads.hpp"
 #include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xhalf.hpp"
 
+#if defined(XTENSOR_BLAS_FULL_FLENS)
 #include "xflens/cxxblas/cxxblas.cxx"
+#else
+#include "xflens/cxxblas/cxxblas_dense.cxx"
+#endif
+
+#if defined(XTENSOR_USE_CUDA)
+#include "xtensor-blas/xblas_cuda.hpp"
+#endif
+
+namespace xt
+{
+
+namespace detail
+{
+    /**
+     * Calls \em f(result, layout), layout being a std::integral_constant of
+     * the storage order in which BLAS writes \em result: its static layout,
+     * or for a result of dynamic layout the order it has at run time, e.g.
+     * a Fortran-ordered NumPy array passed through xtensor-python. A
+     * dynamic result that no leading dimension describes is computed in a
+     * row-major copy of it, assigned back afterwards.
+     */
+    template <class R, class F>
+    inline void result_layout_dispatch(R& result, F&& f, std::false_type /*dynamic*/)
+    {
+        constexpr layout_type L = layout_remove_any(R::static_layout);
+        XTENSOR_ASSERT(result.layout() == L);
+        f(result, std::integral_constant<layout_type, L>());
+    }
+
+    template <class R, class F>
+    inline void result_layout_dispatch(R& result, F&& f, std::true_type /*dynamic*/)
+    {
+        layout_type l = result.layout();
+        if (l != layout_type::row_major && l != layout_type::column_major)
+        {
+            l = blas_strided_layout(result);
+        }
+        if (l == layout_type::row_major)
+        {
+            f(result, std::integral_constant<layout_type, layout_type::row_major>());
+        }
+        else if (l == layout_type::column_major)
+        {
+            f(result, std::integral_constant<layout_type, layout_type::column_major>());
+        }
+        else
+        {
+            // no leading dimension describes the result
+            XTENSOR_BLAS_INSTRUMENT_COPY("result_copy", result, layout_type::row_major);
+            xtensor<typename R::value_type, 2, layout_type::row_major> tmp = result;
+            f(tmp, std::integral_constant<layout_type, layout_type::row_major>());
+            result = tmp;
+        }
+    }
+
+    template <class R, class F>
+    inline void result_layout_dispatch(R& result, F&& f)
+    {
+        result_layout_dispatch(result, std::forward<F>(f),
+                               std::integral_constant<bool, R::static_layout == layout_type::dynamic>());
+    }
+
+    template <class... Args>
+    inline void trxm_kernel(std::false_type /*solve*/, Args... args)
+    {
+        cxxblas::trmm<blas_index_t>(args...);
+    }
+
+    template <class... Args>
+    inline void trxm_kernel(std::true_type /*solve*/, Args... args)
+    {
+        cxxblas::trsm<blas_index_t>(args...);
+    }
+
+    /**
+     * Shared implementation of blas::trmm and blas::trsm. B is updated in
+     * place in its own storage order; a triangular A stored in the other
+     * order is read as A^T, with the referenced triangle and op flipped.
+     */
+    template <class E, class R, class T, class S>
+    inline void trxm(const xexpression<E>& A, R& B, char side, char uplo,
+                     bool transpose_A, char diag, const T& alpha, S solve)
+    {
+        static_assert(has_data_interface<R>::value, "TRMM/TRSM operand must have a data interface.");
+        const auto& a = A.derived_cast();
+
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(a.shape()[0] == a.shape()[1]);
+        XTENSOR_ASSERT(B.dimension() == 2);
+
+        result_layout_dispatch(B, [&](auto& res, auto layout)
+        {
+            constexpr layout_type L = decltype(layout)::value;
+            xtensor<typename E::value_type, 2, L> a_copy;
+            auto op_a = get_matrix_operand<L>(a, a_copy, has_data_interface<E>());
+
+            XTENSOR_BLAS_INSTRUMENT_CALL(S::value ? "trsm" : "trmm", res.shape()[0], res.shape()[1],
+                                         (side == 'L' || side == 'l') ? res.shape()[0] : res.shape()[1], L,
+                                         (transpose_A != op_a.transposed) ? 'T' : 'N', 0,
+                                         instrument::fma_flops<T>(0.5 * double(res.shape()[0]) * double(res.shape()[1])
+                                                                  * double((side == 'L' || side == 'l') ? res.shape()[0] : res.shape()[1])));
+            trxm_kernel(
+                solve,
+                get_blas_storage_order(res),
+                blas_side(side),
+                blas_uplo(uplo, op_a.transposed),
+                (transpose_A != op_a.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                blas_diag(diag),
+                to_blas_index(res.shape()[0]),
+                to_blas_index(res.shape()[1]),
+                alpha,
+                op_a.data,
+                op_a.ld,
+                res.data() + res.data_offset(),
+                get_leading_stride(res)
+            );
+        });
+    }
+
+    // the op of an instrumented call, see xblas_instrument.hpp
+    inline char blas_trans_char(cxxblas::Transpose t)
+    {
+        return t == cxxblas::Transpose::NoTrans ? 'N' : (t == cxxblas::Transpose::Trans ? 'T' : 'C');
+    }
+
+    inline std::size_t& small_gemm_threshold_value()
+    {
+        static std::size_t threshold = 16;
+        return threshold;
+    }
+
+    inline bool& complex_gemm_3m_value()
+    {
+        static bool enabled = false;
+        return enabled;
+    }
+
+    template <class MA, class MB, class MC, class T>
+    inline bool gemm_3m(cxxblas::StorageOrder, cxxblas::Transpose, cxxblas::Transpose,
+                        blas_index_t, blas_index_t, blas_index_t, const T&,
+                        const MA*, blas_index_t, const MB*, blas_index_t,
+                        const T&, MC*, blas_index_t)
+    {
+        return false;
+    }
+
+#ifdef HAVE_CBLAS_GEMM3M
+    /**
+     * Complex products by ?gemm3m if blas::set_complex_gemm_3m is on:
+     * three real matrix products instead of four, at the price of a
+     * slightly larger rounding error.
+     */
+    template <class R>
+    inline bool gemm_3m_complex(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                                blas_index_t m, blas_index_t n, blas_index_t k, const std::complex<R>& alpha,
+                                const std::complex<R>* A, blas_index_t lda, const std::complex<R>* B, blas_index_t ldb,
+                                const std::complex<R>& beta, std::complex<R>* C, blas_index_t ldc)
+    {
+        if (!complex_gemm_3m_value())
+        {
+            return false;
+        }
+        cxxblas::gemm3m<blas_index_t>(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+        return true;
+    }
+
+    inline bool gemm_3m(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                        blas_index_t m, blas_index_t n, blas_index_t k, const std::complex<float>& alpha,
+                        const std::complex<float>* A, blas_index_t lda, const std::complex<float>* B, blas_index_t ldb,
+                        const std::complex<float>& beta, std::complex<float>* C, blas_index_t ldc)
+    {
+        return gemm_3m_complex(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+
+    inline bool gemm_3m(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                        blas_index_t m, blas_index_t n, blas_index_t k, const std::complex<double>& alpha,
+                        const std::complex<double>* A, blas_index_t lda, const std::complex<double>* B, blas_index_t ldb,
+                        const std::complex<double>& beta, std::complex<double>* C, blas_index_t ldc)
+    {
+        return gemm_3m_complex(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+#endif
+
+    /**
+     * C := alpha * op(A) * op(B) + beta * C for matrices small enough that
+     * the BLAS call overhead dominates. C is computed in 8 x 4 blocks held
+     * in registers; element (i, l) of op(A) is A[i * rs_a + l * cs_a].
+     */
+    template <class MA, class MB, class MC, class T>
+    inline void small_gemm(std::size_t m, std::size_t n, std::size_t k, const T& alpha,
+                           const MA* A, std::ptrdiff_t rs_a, std::ptrdiff_t cs_a,
+                           const MB* B, std::ptrdiff_t rs_b, std::ptrdiff_t cs_b,
+                           const T& beta, MC* C, std::ptrdiff_t rs_c, std::ptrdiff_t cs_c)
+    {
+        if (rs_c != 1 && cs_c == 1)
+        {
+            // row-major C: compute its transpose, which is column-major
+            small_gemm(n, m, k, alpha, B, cs_b, rs_b, A, cs_a, rs_a, beta, C, cs_c, rs_c);
+            return;
+        }
+        constexpr std::size_t mr = 8;
+        constexpr std::size_t nr = 4;
+        for (std::size_t j0 = 0; j0 < n; j0 += nr)
+        {
+            std::size_t nb = std::min(nr, n - j0);
+            for (std::size_t i0 = 0; i0 < m; i0 += mr)
+            {
+                std::size_t mb = std::min(mr, m - i0);
+                MC acc[nr][mr] = {};
+                const MA* a = A + static_cast<std::ptrdiff_t>(i0) * rs_a;
+                const MB* b = B + static_cast<std::ptrdiff_t>(j0) * cs_b;
+                if (mb == mr && nb == nr && rs_a == 1)
+                {
+                    // unit stride columns of op(A) vectorize
+                    for (std::size_t l = 0; l < k; ++l, a += cs_a, b += rs_b)
+                    {
+                        for (std::size_t j = 0; j < nr; ++j)
+                        {
+                            MC bj = b[static_cast<std::ptrdiff_t>(j) * cs_b];
+                            for (std::size_t i = 0; i < mr; ++i)
+                            {
+                                acc[j][i] += a[i] * bj;
+                            }
+                        }
+                    }
+                }
+                else if (mb == mr && nb == nr)
+                {
+                    for (std::size_t l = 0; l < k; ++l, a += cs_a, b += rs_b)
+                    {
+                        for (std::size_t j = 0; j < nr; ++j)
+                        {
+                            MC bj = b[static_cast<std::ptrdiff_t>(j) * cs_b];
+                            for (std::size_t i = 0; i < mr; ++i)
+                            {
+                                acc[j][i] += a[static_cast<std::ptrdiff_t>(i) * rs_a] * bj;
+                            }
+                        }
+                    }
+                }
+                else
+                {
+                    for (std::size_t j = 0; j < nb; ++j)
+                    {
+                        for (std::size_t i = 0; i < mb; ++i)
+                        {
+                            const MA* ai = a + static_cast<std::ptrdiff_t>(i) * rs_a;
+                            const MB* bj = b + static_cast<std::ptrdiff_t>(j) * cs_b;
+                            MC sum(0);
+                            for (std::size_t l = 0; l < k; ++l, ai += cs_a, bj += rs_b)
+                            {
+                                sum += *ai * *bj;
+                            }
+                            acc[j][i] = sum;
+                        }
+                    }
+                }
+                for (std::size_t j = 0; j < nb; ++j)
+                {
+                    for (std::size_t i = 0; i < mb; ++i)
+                    {
+                        MC& c = C[static_cast<std::ptrdiff_t>(i0 + i) * rs_c + static_cast<std::ptrdiff_t>(j0 + j) * cs_c];
+                        c = beta == T(0) ? MC(alpha * acc[j][i]) : MC(alpha * acc[j][i] + beta * c);
+                    }
+                }
+            }
+        }
+    }
+
+    template <class MA, class MB, class MC, class T>
+    inline void gemm_dispatch(cxxblas::StorageOrder order,
+                              cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                              blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                              const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                              const T& beta, MC* C, blas_index_t ldc);
+
+    /*****************************
+     * Mixed-type matrix product *
+     *****************************/
+
+    // elements of an operand converted at a time by gemm_mixed
+    constexpr std::size_t mixed_gemm_block_elements = std::size_t(1) << 18;
+    constexpr std::size_t mixed_gemm_min_block = 64;
+
+    template <class T>
+    struct gemm_blas_type
+        : std::integral_constant<bool, std::is_same<T, float>::value || std::is_same<T, double>::value ||
+                                       std::is_same<T, std::complex<float>>::value ||
+                                       std::is_same<T, std::complex<double>>::value>
+    {
+    };
+
+    enum class gemm_mixed_kind
+    {
+        none,
+        reduced,
+        convert_a,
+        convert_b,
+        real_complex,
+        complex_real
+    };
+
+    /**
+     * How gemm_mixed reduces a product of \em MA and \em MB into \em MC
+     * to BLAS calls of a single type: operands of another precision than
+     * \em MC are converted block by block, and a real operand multiplies
+     * a complex one through the real view of its interleaved storage.
+     * Two 16 bit floating point operands go to the reduced-precision
+     * GEMM of the BLAS driver if it has one.
+     */
+    template <class MA, class MB, class MC>
+    struct gemm_mixed_traits
+    {
+        using real_type = xtl::complex_value_type_t<MC>;
+        using a_type = std::conditional_t<xtl::is_complex<MA>::value, MC, real_type>;
+        using b_type = std::conditional_t<xtl::is_complex<MB>::value, MC, real_type>;
+
+        static constexpr bool supported = gemm_blas_type<MC>::value &&
+                                          (std::is_arithmetic<MA>::value || xtl::is_complex<MA>::value ||
+                                           is_reduced_float<MA>::value) &&
+                                          (std::is_arithmetic<MB>::value || xtl::is_complex<MB>::value ||
+                                           is_reduced_float<MB>::value) &&
+                                          (xtl::is_complex<MC>::value ||
+                                           (!xtl::is_complex<MA>::value && !xtl::is_complex<MB>::value));
+
+        static constexpr gemm_mixed_kind kind =
+            !supported || (std::is_same<MA, MC>::value && std::is_same<MB, MC>::value) ? gemm_mixed_kind::none :
+            is_reduced_float<MA>::value && std::is_same<MA, MB>::value && std::is_same<MC, float>::value ?
+                gemm_mixed_kind::reduced :
+            !std::is_same<MA, a_type>::value ? gemm_mixed_kind::convert_a :
+            !std::is_same<MB, b_type>::value ? gemm_mixed_kind::convert_b :
+            !xtl::is_complex<MA>::value && xtl::is_complex<MB>::value ? gemm_mixed_kind::real_complex :
+            xtl::is_complex<MA>::value && !xtl::is_complex<MB>::value ? gemm_mixed_kind::complex_real :
+            gemm_mixed_kind::none;
+    };
+
+    template <gemm_mixed_kind K>
+    using gemm_mixed_tag = std::integral_constant<gemm_mixed_kind, K>;
+
+    // strides of the rows and columns of op(X), X stored in order with ld
+    inline void gemm_op_strides(cxxblas::StorageOrder order, cxxblas::Transpose trans, blas_index_t ld,
+                                std::ptrdiff_t& rs, std::ptrdiff_t& cs)
+    {
+        bool row_major = order == cxxblas::StorageOrder::RowMajor;
+        rs = row_major ? ld : 1;
+        cs = row_major ? 1 : ld;
+        if (trans == cxxblas::Transpose::Trans || trans == cxxblas::Transpose::ConjTrans)
+        {
+            std::swap(rs, cs);
+        }
+    }
+
+    inline bool gemm_conjugates(cxxblas::Transpose trans)
+    {
+        return trans == cxxblas::Transpose::Conj || trans == cxxblas::Transpose::ConjTrans;
+    }
+
+    template <class T>
+    inline T gemm_conj_value(const T& x)
+    {
+        return x;
+    }
+
+    template <class T>
+    inline std::complex<T> gemm_conj_value(const std::complex<T>& x)
+    {
+        return std::conj(x);
+    }
+
+    /**
+     * Copies op(X)(i, j), for i < rows and j < cols, converted to \em D
+     * into \em buffer, stored in \em order with a leading dimension of
+     * cols (row-major) or rows (column-major).
+     */
+    template <class D, class S>
+    inline void gemm_convert_block(cxxblas::StorageOrder order, bool conjugate, std::size_t rows, std::size_t cols,
+                                   const S* X, std::ptrdiff_t rs, std::ptrdiff_t cs, D* buffer)
+    {
+        bool row_major = order == cxxblas::StorageOrder::RowMajor;
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            for (std::size_t j = 0; j < cols; ++j)
+            {
+                const S& x = X[static_cast<std::ptrdiff_t>(i) * rs + static_cast<std::ptrdiff_t>(j) * cs];
+                buffer[row_major ? i * cols + j : i + j * rows] = conjugate ? D(gemm_conj_value(x)) : D(x);
+            }
+        }
+    }
+
+    // op(A) is converted to D in blocks of rows, each multiplied by op(B)
+    template <class D, class MA, class MB, class MC, class T>
+    inline void gemm_convert_rows(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                                  blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                                  const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                                  const T& beta, MC* C, blas_index_t ldc)
+    {
+        std::size_t rows = static_cast<std::size_t>(m), inner = static_cast<std::size_t>(k);
+        std::size_t block = std::min(rows, std::max(mixed_gemm_min_block,
+                                                    mixed_gemm_block_elements / std::max(inner, std::size_t(1))));
+        std::ptrdiff_t rs, cs;
+        gemm_op_strides(order, trans_a, lda, rs, cs);
+        bool row_major = order == cxxblas::StorageOrder::RowMajor;
+        bool conjugate = xtl::is_complex<MA>::value && gemm_conjugates(trans_a);
+
+        scratch_buffer<D> buffer(block * inner);
+        for (std::size_t i0 = 0; i0 < rows; i0 += block)
+        {
+            std::size_t mb = std::min(block, rows - i0);
+            {
+                XTENSOR_BLAS_INSTRUMENT_CALL("mixed_gemm_convert", mb, inner, 0,
+                                             row_major ? layout_type::row_major : layout_type::column_major);
+                gemm_convert_block(order, conjugate, mb, inner, A + static_cast<std::ptrdiff_t>(i0) * rs, rs, cs,
+                                   buffer.data());
+            }
+            gemm_dispatch(order, cxxblas::Transpose::NoTrans, trans_b, to_blas_index(mb), n, k, alpha,
+                          static_cast<const D*>(buffer.data()), to_blas_index(std::max(row_major ? inner : mb, std::size_t(1))),
+                          B, ldb, beta, C + (row_major ? static_cast<std::ptrdiff_t>(i0) * ldc : static_cast<std::ptrdiff_t>(i0)),
+                          ldc);
+        }
+    }
+
+    template <class MA, class MB, class MC, class T>
+    inline void gemm_mixed(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                           blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                           const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                           const T& beta, MC* C, blas_index_t ldc, gemm_mixed_tag<gemm_mixed_kind::convert_a>)
+    {
+        using D = typename gemm_mixed_traits<MA, MB, MC>::a_type;
+        gemm_convert_rows<D>(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+
+    template <class M, class T>
+    inline bool gemm_reduced_driver(cxxblas::StorageOrder, cxxblas::Transpose, cxxblas::Transpose,
+                                    blas_index_t, blas_index_t, blas_index_t, const T&,
+                                    const M*, blas_index_t, const M*, blas_index_t,
+                                    const T&, float*, blas_index_t)
+    {
+        return false;
+    }
+
+#ifdef HAVE_CBLAS_GEMM_BF16
+    template <class T>
+    inline bool gemm_reduced_driver(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                                    blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                                    const bfloat16* A, blas_index_t lda, const bfloat16* B, blas_index_t ldb,
+                                    const T& beta, float* C, blas_index_t ldc)
+    {
+        if (static_cast<std::size_t>(std::max({m, n, k})) <= small_gemm_threshold_value())
+        {
+            return false;
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm_bf16", std::size_t(m), std::size_t(n), std::size_t(k),
+                                     order == cxxblas::StorageOrder::RowMajor ? layout_type::row_major : layout_type::column_major,
+                                     blas_trans_char(trans_a), blas_trans_char(trans_b),
+                                     instrument::fma_flops<float>(double(m) * double(n) * double(k)));
+        cxxblas::gemm_bf16<blas_index_t>(order, trans_a, trans_b, m, n, k, float(std::real(alpha)),
+                                         reinterpret_cast<const unsigned short*>(A), lda,
+                                         reinterpret_cast<const unsigned short*>(B), ldb,
+                                         float(std::real(beta)), C, ldc);
+        return true;
+    }
+#endif
+
+#ifdef HAVE_CBLAS_GEMM_F16
+    template <class T>
+    inline bool gemm_reduced_driver(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                                    blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                                    const float16* A, blas_index_t lda, const float16* B, blas_index_t ldb,
+                                    const T& beta, float* C, blas_index_t ldc)
+    {
+        if (static_cast<std::size_t>(std::max({m, n, k})) <= small_gemm_threshold_value())
+        {
+            return false;
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm_f16", std::size_t(m), std::size_t(n), std::size_t(k),
+                                     order == cxxblas::StorageOrder::RowMajor ? layout_type::row_major : layout_type::column_major,
+                                     blas_trans_char(trans_a), blas_trans_char(trans_b),
+                                     instrument::fma_flops<float>(double(m) * double(n) * double(k)));
+        cxxblas::gemm_f16<blas_index_t>(order, trans_a, trans_b, m, n, k, float(std::real(alpha)),
+                                        reinterpret_cast<const unsigned short*>(A), lda,
+                                        reinterpret_cast<const unsigned short*>(B), ldb,
+                                        float(std::real(beta)), C, ldc);
+        return true;
+    }
+#endif
+
+    /**
+     * 16 bit floating point A and B into a float C, by the BLAS driver
+     * or else by converting op(A) and op(B) to float block by block, so
+     * that only blocks of about mixed_gemm_block_elements are ever held
+     * in single precision.
+     */
+    template <class MA, class MB, class MC, class T>
+    inline void gemm_mixed(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                           blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                           const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                           const T& beta, MC* C, blas_index_t ldc, gemm_mixed_tag<gemm_mixed_kind::reduced>)
+    {
+        if (!gemm_reduced_driver(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc))
+        {
+            gemm_mixed(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc,
+                       gemm_mixed_tag<gemm_mixed_kind::convert_a>());
+        }
+    }
+
+    // C = op(A) op(B) is C^T = op(B)^T op(A)^T in the other storage order
+    inline cxxblas::StorageOrder gemm_other_order(cxxblas::StorageOrder order)
+    {
+        return order == cxxblas::StorageOrder::RowMajor ? cxxblas::StorageOrder::ColMajor : cxxblas::StorageOrder::RowMajor;
+    }
+
+    template <class MA, class MB, class MC, class T>
+    inline void gemm_mixed(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                           blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                           const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                           const T& beta, MC* C, blas_index_t ldc, gemm_mixed_tag<gemm_mixed_kind::convert_b>)
+    {
+        using D = typename gemm_mixed_traits<MA, MB, MC>::b_type;
+        gemm_convert_rows<D>(gemm_other_order(order), trans_b, trans_a, n, m, k, alpha, B, ldb, A, lda, beta, C, ldc);
+    }
+
+    /**
+     * Real A times complex B: if the columns of op(B) and of C are
+     * contiguous, their interleaved storage holds real matrices of 2 n
+     * columns, and C = op(A) op(B) is a single real GEMM on them. Other
+     * cases, or an alpha that is not real, convert A to complex.
+     */
+    template <class MA, class MB, class MC, class T>
+    inline void gemm_mixed(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                           blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                           const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                           const T& beta, MC* C, blas_index_t ldc, gemm_mixed_tag<gemm_mixed_kind::real_complex>)
+    {
+        using real_type = xtl::complex_value_type_t<MC>;
+        if (order != cxxblas::StorageOrder::RowMajor || trans_b != cxxblas::Transpose::NoTrans ||
+            std::imag(alpha) != 0)
+        {
+            gemm_convert_rows<MC>(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+            return;
+        }
+
+        real_type beta_r = real_type(std::real(beta));
+        if (std::imag(beta) != 0)
+        {
+            cxxblas::gescal<blas_index_t>(order, m, n, MC(beta), C, ldc);
+            beta_r = real_type(1);
+        }
+        gemm_dispatch(order,
+                      gemm_conjugates(trans_a) ? (trans_a == cxxblas::Transpose::ConjTrans ? cxxblas::Transpose::Trans
+                                                                                           : cxxblas::Transpose::NoTrans)
+                                               : trans_a,
+                      cxxblas::Transpose::NoTrans, m, 2 * n, k, real_type(std::real(alpha)),
+                      A, lda, reinterpret_cast<const real_type*>(B), 2 * ldb,
+                      beta_r, reinterpret_cast<real_type*>(C), 2 * ldc);
+    }
+
+    template <class MA, class MB, class MC, class T>
+    inline void gemm_mixed(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                           blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                           const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                           const T& beta, MC* C, blas_index_t ldc, gemm_mixed_tag<gemm_mixed_kind::complex_real>)
+    {
+        gemm_mixed(gemm_other_order(order), trans_b, trans_a, n, m, k, alpha, B, ldb, A, lda, beta, C, ldc,
+                   gemm_mixed_tag<gemm_mixed_kind::real_complex>());
+    }
+
+    /**
+     * cxxblas::gemm with the arguments of a BLAS call, or small_gemm if no
+     * dimension exceeds blas::small_gemm_threshold() and no operand is
+     * conjugated. Operands of different types are reduced to BLAS calls
+     * of the type of C by gemm_mixed.
+     */
+    template <class MA, class MB, class MC, class T, gemm_mixed_kind K>
+    inline void gemm_dispatch(cxxblas::StorageOrder order,
+                              cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                              blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                              const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                              const T& beta, MC* C, blas_index_t ldc, gemm_mixed_tag<K> kind)
+    {
+        gemm_mixed(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, kind);
+    }
+
+    template <class MA, class MB, class MC, class T>
+    inline void gemm_dispatch(cxxblas::StorageOrder order,
+                              cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                              blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                              const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                              const T& beta, MC* C, blas_index_t ldc, gemm_mixed_tag<gemm_mixed_kind::none>)
+    {
+        std::size_t threshold = small_gemm_threshold_value();
+        if (static_cast<std::size_t>(std::max({m, n, k})) <= threshold &&
+            trans_a != cxxblas::Transpose::ConjTrans && trans_b != cxxblas::Transpose::ConjTrans)
+        {
+            bool row_major = order == cxxblas::StorageOrder::RowMajor;
+            // strides of the stored matrices, then swapped for the op
+            std::ptrdiff_t rs_a = row_major ? lda : 1, cs_a = row_major ? 1 : lda;
+            std::ptrdiff_t rs_b = row_major ? ldb : 1, cs_b = row_major ? 1 : ldb;
+            std::ptrdiff_t rs_c = row_major ? ldc : 1, cs_c = row_major ? 1 : ldc;
+            if (trans_a != cxxblas::Transpose::NoTrans)
+            {
+                std::swap(rs_a, cs_a);
+            }
+            if (trans_b != cxxblas::Transpose::NoTrans)
+            {
+                std::swap(rs_b, cs_b);
+            }
+            XTENSOR_BLAS_INSTRUMENT_CALL("small_gemm", std::size_t(m), std::size_t(n), std::size_t(k),
+                                         row_major ? layout_type::row_major : layout_type::column_major,
+                                         blas_trans_char(trans_a), blas_trans_char(trans_b),
+                                         instrument::fma_flops<MC>(double(m) * double(n) * double(k)));
+            small_gemm(static_cast<std::size_t>(m), static_cast<std::size_t>(n), static_cast<std::size_t>(k),
+                       alpha, A, rs_a, cs_a, B, rs_b, cs_b, beta, C, rs_c, cs_c);
+            return;
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm", std::size_t(m), std::size_t(n), std::size_t(k),
+                                     order == cxxblas::StorageOrder::RowMajor ? layout_type::row_major : layout_type::column_major,
+                                     blas_trans_char(trans_a), blas_trans_char(trans_b),
+                                     instrument::fma_flops<MC>(double(m) * double(n) * double(k)));
+#if defined(XTENSOR_USE_CUDA)
+        if (cuda::detail::gemm(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc))
+        {
+            return;
+        }
+#endif
+        if (gemm_3m(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc))
+        {
+            return;
+        }
+        cxxblas::gemm<blas_index_t>(order, trans_a, trans_b, m, n, k, alpha,
+                                    A, lda, B, ldb, beta, C, ldc);
+    }
+
+    template <class MA, class MB, class MC, class T>
+    inline void gemm_dispatch(cxxblas::StorageOrder order,
+                              cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                              blas_index_t m, blas_index_t n, blas_index_t k, const T& alpha,
+                              const MA* A, blas_index_t lda, const MB* B, blas_index_t ldb,
+                              const T& beta, MC* C, blas_index_t ldc)
+    {
+        gemm_dispatch(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc,
+                      gemm_mixed_tag<gemm_mixed_traits<MA, MB, MC>::kind>());
+    }
+
+    /*****************************
+     * Quantized matrix product  *
+     *****************************/
+
+    template <class T>
+    struct is_quantized_type
+        : std::integral_constant<bool, std::is_same<T, std::int8_t>::value || std::is_same<T, std::uint8_t>::value>
+    {
+    };
+
+    template <class MA, class MB>
+    inline bool gemm_quantized_driver(cxxblas::StorageOrder, cxxblas::Transpose, cxxblas::Transpose,
+                                      blas_index_t, blas_index_t, blas_index_t,
+                                      const MA*, blas_index_t, std::int32_t, const MB*, blas_index_t, std::int32_t,
+                                      std::int32_t*, blas_index_t)
+    {
+        return false;
+    }
+
+#ifdef HAVE_CBLAS_GEMM_S8U8S32
+    // the driver adds its offsets to the operands, as int8
+    inline bool gemm_quantized_driver(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                                      blas_index_t m, blas_index_t n, blas_index_t k,
+                                      const std::int8_t* A, blas_index_t lda, std::int32_t a_zero,
+                                      const std::uint8_t* B, blas_index_t ldb, std::int32_t b_zero,
+                                      std::int32_t* C, blas_index_t ldc)
+    {
+        if (static_cast<std::size_t>(std::max({m, n, k})) <= small_gemm_threshold_value() ||
+            a_zero < -127 || a_zero > 128 || b_zero < -127 || b_zero > 128)
+        {
+            return false;
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm_s8u8s32", std::size_t(m), std::size_t(n), std::size_t(k),
+                                     order == cxxblas::StorageOrder::RowMajor ? layout_type::row_major : layout_type::column_major,
+                                     blas_trans_char(trans_a), blas_trans_char(trans_b));
+        cxxblas::gemm_s8u8s32<blas_index_t>(order, trans_a, trans_b, m, n, k, 1.0f,
+                                            A, lda, static_cast<std::int8_t>(-a_zero),
+                                            B, ldb, static_cast<std::int8_t>(-b_zero),
+                                            0.0f, C, ldc);
+        return true;
+    }
+
+    // C = op(A) op(B) is C^T = op(B)^T op(A)^T in the other storage order
+    inline bool gemm_quantized_driver(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                                      blas_index_t m, blas_index_t n, blas_index_t k,
+                                      const std::uint8_t* A, blas_index_t lda, std::int32_t a_zero,
+                                      const std::int8_t* B, blas_index_t ldb, std::int32_t b_zero,
+                                      std::int32_t* C, blas_index_t ldc)
+    {
+        return gemm_quantized_driver(gemm_other_order(order), trans_b, trans_a, n, m, k,
+                                     B, ldb, b_zero, A, lda, a_zero, C, ldc);
+    }
+#endif
+
+    /**
+     * Computes ``C := (op(A) - a_zero) * (op(B) - b_zero)`` for 8 bit
+     * integer A and B, exactly in 32 bit integers. Without a driver
+     * routine, the shifted operands are converted to int32 in blocks of
+     * columns of op(A) and rows of op(B), whose products are accumulated
+     * into C by the blocked integer GEMM.
+     */
+    template <class MA, class MB>
+    inline void gemm_quantized(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                               blas_index_t m, blas_index_t n, blas_index_t k,
+                               const MA* A, blas_index_t lda, std::int32_t a_zero,
+                               const MB* B, blas_index_t ldb, std::int32_t b_zero,
+                               std::int32_t* C, blas_index_t ldc)
+    {
+        static_assert(is_quantized_type<MA>::value && is_quantized_type<MB>::value,
+                      "gemm_quantized: operands have to be int8 or uint8.");
+        if (m == 0 || n == 0)
+        {
+            return;
+        }
+        if (gemm_quantized_driver(order, trans_a, trans_b, m, n, k, A, lda, a_zero, B, ldb, b_zero, C, ldc))
+        {
+            return;
+        }
+
+        bool row_major = order == cxxblas::StorageOrder::RowMajor;
+        std::size_t rows = static_cast<std::size_t>(m), cols = static_cast<std::size_t>(n);
+        std::size_t inner = static_cast<std::size_t>(k);
+        if (inner == 0)
+        {
+            for (std::size_t i = 0; i < rows; ++i)
+            {
+                for (std::size_t j = 0; j < cols; ++j)
+                {
+                    C[row_major ? i * std::size_t(ldc) + j : i + j * std::size_t(ldc)] = 0;
+                }
+            }
+            return;
+        }
+
+        std::ptrdiff_t rs_a, cs_a, rs_b, cs_b;
+        gemm_op_strides(order, trans_a, lda, rs_a, cs_a);
+        gemm_op_strides(order, trans_b, ldb, rs_b, cs_b);
+        std::size_t block = std::min(inner, std::max(mixed_gemm_min_block, mixed_gemm_block_elements / (rows + cols)));
+
+        scratch_buffer<std::int32_t> a_buffer(rows * block), b_buffer(block * cols);
+        for (std::size_t p0 = 0; p0 < inner; p0 += block)
+        {
+            std::size_t kb = std::min(block, inner - p0);
+            {
+                XTENSOR_BLAS_INSTRUMENT_CALL("quantized_gemm_convert", rows + cols, kb, 0,
+                                             row_major ? layout_type::row_major : layout_type::column_major);
+                const MA* a = A + static_cast<std::ptrdiff_t>(p0) * cs_a;
+                for (std::size_t i = 0; i < rows; ++i)
+                {
+                    for (std::size_t l = 0; l < kb; ++l)
+                    {
+                        a_buffer[row_major ? i * kb + l : i + l * rows] =
+                            std::int32_t(a[static_cast<std::ptrdiff_t>(i) * rs_a + static_cast<std::ptrdiff_t>(l) * cs_a]) - a_zero;
+                    }
+                }
+                const MB* b = B + static_cast<std::ptrdiff_t>(p0) * rs_b;
+                for (std::size_t l = 0; l < kb; ++l)
+                {
+                    for (std::size_t j = 0; j < cols; ++j)
+                    {
+                        b_buffer[row_major ? l * cols + j : l + j * kb] =
+                            std::int32_t(b[static_cast<std::ptrdiff_t>(l) * rs_b + static_cast<std::ptrdiff_t>(j) * cs_b]) - b_zero;
+                    }
+                }
+            }
+            gemm_dispatch(order, cxxblas::Transpose::NoTrans, cxxblas::Transpose::NoTrans, m, n, to_blas_index(kb),
+                          std::int32_t(1), static_cast<const std::int32_t*>(a_buffer.data()), to_blas_index(row_major ? kb : rows),
+                          static_cast<const std::int32_t*>(b_buffer.data()), to_blas_index(row_major ? cols : kb),
+                          std::int32_t(p0 == 0 ? 0 : 1), C, ldc);
+        }
+    }
+
+    /***************************************
+     * Operand expression folding for BLAS *
+     ***************************************/
+
+    // functors of xt::conj and of the product with a scalar, taken from
+    // the expressions themselves rather than from xtensor internals
+    using blas_conj_functor = typename decltype(xt::conj(std::declval<const xarray<std::complex<double>>&>()))::functor_type;
+    using blas_multiplies_functor = typename decltype(std::declval<const xarray<double>&>() * 2.0)::functor_type;
+
+    /**
+     * Describes a matrix operand \em e of GEMM as ``scale * op(operand)``,
+     * where op conjugates if \em conjugate is set. Expressions that are
+     * not a conjugation or a product with a scalar are their own operand.
+     */
+    template <class E, class = void>
+    struct blas_operand_fold
+    {
+        static constexpr bool value = false;
+        static constexpr bool conjugate = false;
+        using operand_type = E;
+
+        static const E& operand(const E& e)
+        {
+            return e;
+        }
+
+        static typename E::value_type scale(const E&)
+        {
+            return typename E::value_type(1);
+        }
+    };
+
+    // conj(e) of a complex e; xt::conj of a real expression is complex
+    // valued and is not folded
+    template <class F, class CT>
+    struct blas_operand_fold<xfunction<F, CT>,
+                             std::enable_if_t<std::is_same<F, blas_conj_functor>::value &&
+                                              xtl::is_complex<typename std::decay_t<CT>::value_type>::value>>
+    {
+        using inner = blas_operand_fold<std::decay_t<CT>>;
+        static constexpr bool value = true;
+        static constexpr bool conjugate = !inner::conjugate;
+        using operand_type = typename inner::operand_type;
+
+        static const operand_type& operand(const xfunction<F, CT>& e)
+        {
+            return inner::operand(std::get<0>(e.arguments()));
+        }
+
+        static auto scale(const xfunction<F, CT>& e)
+        {
+            return std::conj(inner::scale(std::get<0>(e.arguments())));
+        }
+    };
+
+    template <class F, class CT, class E, std::size_t S>
+    struct blas_scaled_operand_fold
+    {
+        using inner = blas_operand_fold<std::decay_t<CT>>;
+        static constexpr bool value = true;
+        static constexpr bool conjugate = inner::conjugate;
+        using operand_type = typename inner::operand_type;
+
+        static const operand_type& operand(const E& e)
+        {
+            return inner::operand(std::get<1 - S>(e.arguments()));
+        }
+
+        static auto scale(const E& e)
+        {
+            return typename E::value_type(std::get<S>(e.arguments())()) * inner::scale(std::get<1 - S>(e.arguments()));
+        }
+    };
+
+    // s * e and e * s, for a scalar that does not promote e
+    template <class F, class CT1, class CT2>
+    struct blas_operand_fold<xfunction<F, CT1, CT2>,
+                             std::enable_if_t<std::is_same<F, blas_multiplies_functor>::value &&
+                                              is_xscalar<std::decay_t<CT1>>::value &&
+                                              !is_xscalar<std::decay_t<CT2>>::value &&
+                                              std::is_same<typename xfunction<F, CT1, CT2>::value_type,
+                                                           typename std::decay_t<CT2>::value_type>::value>>
+        : blas_scaled_operand_fold<F, CT2, xfunction<F, CT1, CT2>, 0>
+    {
+    };
+
+    template <class F, class CT1, class CT2>
+    struct blas_operand_fold<xfunction<F, CT1, CT2>,
+                             std::enable_if_t<std::is_same<F, blas_multiplies_functor>::value &&
+                                              !is_xscalar<std::decay_t<CT1>>::value &&
+                                              is_xscalar<std::decay_t<CT2>>::value &&
+                                              std::is_same<typename xfunction<F, CT1, CT2>::value_type,
+                                                           typename std::decay_t<CT1>::value_type>::value>>
+        : blas_scaled_operand_fold<F, CT1, xfunction<F, CT1, CT2>, 1>
+    {
+    };
+
+    /*********************************************
+     * Matrix product of general strided operands *
+     *********************************************/
+
+    // blocks of gemm_packed: kc x mc elements of op(A), kc x nc of op(B)
+    constexpr std::size_t strided_gemm_kc = 256;
+    constexpr std::size_t strided_gemm_mc = 1024;
+    constexpr std::size_t strided_gemm_nc = 1024;
+
+    /**
+     * Matrix operand op(X) of gemm_packed: \em rs and \em cs are the
+     * strides of its rows and columns. An operand with a leading dimension
+     * is read in place by BLAS with \em ld and \em trans; one without is
+     * \em packed, copied block by block.
+     */
+    template <class T>
+    struct gemm_strided_operand
+    {
+        const T* data;
+        std::ptrdiff_t rs;
+        std::ptrdiff_t cs;
+        bool packed;
+        blas_index_t ld;
+        cxxblas::Transpose trans;
+    };
+
+    template <class T>
+    inline gemm_strided_operand<T> gemm_blas_operand(cxxblas::StorageOrder order, const blas_matrix_operand<T>& op,
+                                                     bool transpose)
+    {
+        cxxblas::Transpose trans = transpose != op.transposed ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans;
+        gemm_strided_operand<T> result{op.data, 0, 0, false, op.ld, trans};
+        gemm_op_strides(order, trans, op.ld, result.rs, result.cs);
+        return result;
+    }
+
+    template <class E>
+    inline bool gemm_needs_packing(const E& e, std::true_type /*has_data_interface*/)
+    {
+        return blas_strided_layout(e) == layout_type::dynamic;
+    }
+
+    template <class E>
+    inline bool gemm_needs_packing(const E&, std::false_type /*has_data_interface*/)
+    {
+        return false;
+    }
+
+    /**
+     * Operand of gemm_packed for the 2-D expression \em e, transposed if
+     * \em transpose is set: general strided views are described by their
+     * strides, everything else as by get_matrix_operand.
+     */
+    template <layout_type L, class E, class C>
+    inline auto get_strided_operand(const E& e, C& copy, bool transpose, std::true_type tag)
+    {
+        cxxblas::StorageOrder order = L == layout_type::row_major ? cxxblas::StorageOrder::RowMajor
+                                                                  : cxxblas::StorageOrder::ColMajor;
+        if (!gemm_needs_packing(e, tag))
+        {
+            return gemm_blas_operand(order, get_matrix_operand<L>(e, copy, tag), transpose);
+        }
+        std::ptrdiff_t rs = static_cast<std::ptrdiff_t>(e.strides()[0]);
+        std::ptrdiff_t cs = static_cast<std::ptrdiff_t>(e.strides()[1]);
+        if (transpose)
+        {
+            std::swap(rs, cs);
+        }
+        return gemm_strided_operand<typename C::value_type>{e.data() + e.data_offset(), rs, cs, true, 0,
+                                                            cxxblas::Transpose::NoTrans};
+    }
+
+    template <layout_type L, class E, class C>
+    inline auto get_strided_operand(const E& e, C& copy, bool transpose, std::false_type tag)
+    {
+        cxxblas::StorageOrder order = L == layout_type::row_major ? cxxblas::StorageOrder::RowMajor
+                                                                  : cxxblas::StorageOrder::ColMajor;
+        return gemm_blas_operand(order, get_matrix_operand<L>(e, copy, tag), transpose);
+    }
+
+    template <class MA, class MB, class MC, class T>
+    inline bool gemm_strided_driver(cxxblas::StorageOrder, std::size_t, std::size_t, std::size_t, const T&,
+                                    const gemm_strided_operand<MA>&, const gemm_strided_operand<MB>&,
+                                    const T&, MC*, std::ptrdiff_t, std::ptrdiff_t)
+    {
+        return false;
+    }
+
+#ifdef HAVE_BLIS_TYPED_API
+    // the typed API of BLIS reads the strides of the operands as they are
+    template <class M, class T>
+    inline std::enable_if_t<gemm_blas_type<M>::value, bool>
+    gemm_strided_driver(cxxblas::StorageOrder order, std::size_t m, std::size_t n, std::size_t k, const T& alpha,
+                        const gemm_strided_operand<M>& A, const gemm_strided_operand<M>& B,
+                        const T& beta, M* C, std::ptrdiff_t rs_c, std::ptrdiff_t cs_c)
+    {
+        if (std::max({m, n, k}) <= small_gemm_threshold_value() ||
+            A.rs <= 0 || A.cs <= 0 || B.rs <= 0 || B.cs <= 0)
+        {
+            return false;
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm_strided", m, n, k,
+                                     order == cxxblas::StorageOrder::RowMajor ? layout_type::row_major : layout_type::column_major,
+                                     'N', 'N', instrument::fma_flops<M>(double(m) * double(n) * double(k)));
+        cxxblas::gemm_strided(cxxblas::Transpose::NoTrans, cxxblas::Transpose::NoTrans,
+                              static_cast<std::ptrdiff_t>(m), static_cast<std::ptrdiff_t>(n), static_cast<std::ptrdiff_t>(k),
+                              M(alpha), A.data, A.rs, A.cs, B.data, B.rs, B.cs, M(beta), C, rs_c, cs_c);
+        return true;
+    }
+#endif
+
+    template <class MA, class MX, class MY, class T>
+    inline bool gemv_strided_driver(const MA*, std::ptrdiff_t, std::ptrdiff_t, std::size_t, std::size_t, bool,
+                                    const T&, const MX*, blas_index_t, const T&, MY*, blas_index_t)
+    {
+        return false;
+    }
+
+#ifdef HAVE_BLIS_TYPED_API
+    template <class M, class T>
+    inline std::enable_if_t<gemm_blas_type<M>::value, bool>
+    gemv_strided_driver(const M* A, std::ptrdiff_t rs, std::ptrdiff_t cs, std::size_t m, std::size_t n, bool transpose,
+                        const T& alpha, const M* x, blas_index_t inc_x, const T& beta, M* y, blas_index_t inc_y)
+    {
+        if (rs <= 0 || cs <= 0 || inc_x <= 0 || inc_y <= 0)
+        {
+            return false;
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemv_strided", m, n, 0, layout_type::dynamic, transpose ? 'T' : 'N', 0,
+                                     instrument::fma_flops<M>(double(m) * double(n)));
+        cxxblas::gemv_strided(transpose ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                              static_cast<std::ptrdiff_t>(m), static_cast<std::ptrdiff_t>(n), M(alpha), A, rs, cs,
+                              x, static_cast<std::ptrdiff_t>(inc_x), M(beta), y, static_cast<std::ptrdiff_t>(inc_y));
+        return true;
+    }
+#endif
+
+    template <class E, class X, class Y, class T>
+    inline bool gemv_strided(const E&, bool, const T&, const X&, const T&, const Y&, std::false_type /*has_data_interface*/)
+    {
+        return false;
+    }
+
+    /**
+     * ``y := alpha * op(A) x + beta * y`` for a matrix \em a without a
+     * unit stride, read through its strides by the BLIS driver.
+     * @return false, with nothing computed, if \em a has a leading
+     *         dimension or the driver cannot read it
+     */
+    template <class E, class X, class Y, class T>
+    inline bool gemv_strided(const E& a, bool transpose, const T& alpha, const X& x, const T& beta, const Y& y,
+                             std::true_type /*has_data_interface*/)
+    {
+        if (blas_strided_layout(a) != layout_type::dynamic)
+        {
+            return false;
+        }
+        return gemv_strided_driver(a.data() + a.data_offset(), static_cast<std::ptrdiff_t>(a.strides()[0]),
+                                   static_cast<std::ptrdiff_t>(a.strides()[1]), a.shape()[0], a.shape()[1], transpose,
+                                   alpha, x.data, x.inc, beta, y.data, y.inc);
+    }
+
+    /**
+     * Computes ``C := alpha * op(A) op(B) + beta * C`` for operands that
+     * BLAS cannot read through a leading dimension, without copying them
+     * as a whole: the loops of a BLIS macro-kernel run over blocks of
+     * strided_gemm_nc columns, strided_gemm_kc inner indices and
+     * strided_gemm_mc rows, each packed operand block is copied into a
+     * scratch buffer in the storage order of C, and each block product is
+     * one GEMM call. Operands that have a leading dimension are read in
+     * place, and their free dimension is not split. With the BLIS driver
+     * the product is one call of its typed API, which packs on its own.
+     */
+    template <class MA, class MB, class MC, class T>
+    inline void gemm_packed(cxxblas::StorageOrder order, std::size_t m, std::size_t n, std::size_t k, const T& alpha,
+                            const gemm_strided_operand<MA>& A, const gemm_strided_operand<MB>& B,
+                            const T& beta, MC* C, blas_index_t ldc)
+    {
+        if (m == 0 || n == 0)
+        {
+            return;
+        }
+        bool row_major = order == cxxblas::StorageOrder::RowMajor;
+        if (k == 0)
+        {
+            gemm_dispatch(order, cxxblas::Transpose::NoTrans, cxxblas::Transpose::NoTrans, to_blas_index(m),
+                          to_blas_index(n), blas_index_t(0), alpha, A.data, to_blas_index(row_major ? 1 : m),
+                          B.data, to_blas_index(row_major ? n : 1), beta, C, ldc);
+            return;
+        }
+
+        std::ptrdiff_t rs_c, cs_c;
+        gemm_op_strides(order, cxxblas::Transpose::NoTrans, ldc, rs_c, cs_c);
+        if (gemm_strided_driver(order, m, n, k, alpha, A, B, beta, C, rs_c, cs_c))
+        {
+            return;
+        }
+        std::size_t kc = std::min(k, strided_gemm_kc);
+        std::size_t mc = A.packed ? std::min(m, strided_gemm_mc) : m;
+        std::size_t nc = B.packed ? std::min(n, strided_gemm_nc) : n;
+
+        scratch_buffer<MA> a_buffer(A.packed ? mc * kc : 0);
+        scratch_buffer<MB> b_buffer(B.packed ? kc * nc : 0);
+        for (std::size_t j0 = 0; j0 < n; j0 += nc)
+        {
+            std::size_t nb = std::min(nc, n - j0);
+            for (std::size_t p0 = 0; p0 < k; p0 += kc)
+            {
+                std::size_t kb = std::min(kc, k - p0);
+                const MB* b = B.data + static_cast<std::ptrdiff_t>(p0) * B.rs + static_cast<std::ptrdiff_t>(j0) * B.cs;
+                blas_index_t ldb = B.ld;
+                cxxblas::Transpose trans_b = B.trans;
+                if (B.packed)
+                {
+                    XTENSOR_BLAS_INSTRUMENT_CALL("strided_gemm_pack", kb, nb, 0,
+                                                 row_major ? layout_type::row_major : layout_type::column_major);
+                    gemm_convert_block(order, false, kb, nb, b, B.rs, B.cs, b_buffer.data());
+                    b = b_buffer.data();
+                    ldb = to_blas_index(row_major ? nb : kb);
+                }
+                for (std::size_t i0 = 0; i0 < m; i0 += mc)
+                {
+                    std::size_t mb = std::min(mc, m - i0);
+                    const MA* a = A.data + static_cast<std::ptrdiff_t>(i0) * A.rs + static_cast<std::ptrdiff_t>(p0) * A.cs;
+                    blas_index_t lda = A.ld;
+                    if (A.packed)
+                    {
+                        XTENSOR_BLAS_INSTRUMENT_CALL("strided_gemm_pack", mb, kb, 0,
+                                                     row_major ? layout_type::row_major : layout_type::column_major);
+                        gemm_convert_block(order, false, mb, kb, a, A.rs, A.cs, a_buffer.data());
+                        a = a_buffer.data();
+                        lda = to_blas_index(row_major ? kb : mb);
+                    }
+                    MC* c = C + static_cast<std::ptrdiff_t>(i0) * rs_c + static_cast<std::ptrdiff_t>(j0) * cs_c;
+                    gemm_dispatch(order, A.trans, trans_b, to_blas_index(mb), to_blas_index(nb), to_blas_index(kb),
+                                  alpha, a, lda, b, ldb, p0 == 0 ? beta : T(1), c, ldc);
+                }
+            }
+        }
+    }
+
+    /**
+     * blas::gemm into a result stored in order \em L.
+     */
+    template <layout_type L, class E, class F, class R, class T>
+    inline void gemm_impl(const E& a, const F& b, R& result, bool transpose_A, bool transpose_B,
+                          const T& alpha, const T& beta)
+    {
+        // Operands stored in the other order than the result (e.g. transposed
+        // views) are read as their transpose with the op flipped, strided
+        // sub-matrix views through their leading dimension. Views with no
+        // unit stride are packed block by block by gemm_packed, and only
+        // expressions without a data interface are copied.
+        xtensor<typename E::value_type, 2, L> a_copy;
+        xtensor<typename F::value_type, 2, L> b_copy;
+        if (gemm_needs_packing(a, has_data_interface<E>()) || gemm_needs_packing(b, has_data_interface<F>()))
+        {
+            gemm_packed(L == layout_type::row_major ? cxxblas::StorageOrder::RowMajor : cxxblas::StorageOrder::ColMajor,
+                        transpose_A ? a.shape()[1] : a.shape()[0],
+                        transpose_B ? b.shape()[0] : b.shape()[1],
+                        transpose_B ? b.shape()[1] : b.shape()[0],
+                        alpha,
+                        get_strided_operand<L>(a, a_copy, transpose_A, has_data_interface<E>()),
+                        get_strided_operand<L>(b, b_copy, transpose_B, has_data_interface<F>()),
+                        beta,
+                        result.data() + result.data_offset(),
+                        get_leading_stride(result));
+            return;
+        }
+        auto op_a = get_matrix_operand<L>(a, a_copy, has_data_interface<E>());
+        auto op_b = get_matrix_operand<L>(b, b_copy, has_data_interface<F>());
+        bool trans_a = transpose_A != op_a.transposed;
+        bool trans_b = transpose_B != op_b.transposed;
+
+        gemm_dispatch(
+            L == layout_type::row_major ? cxxblas::StorageOrder::RowMajor : cxxblas::StorageOrder::ColMajor,
+            trans_a ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+            trans_b ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+            to_blas_index(transpose_A ? a.shape()[1] : a.shape()[0]),
+            to_blas_index(transpose_B ? b.shape()[0] : b.shape()[1]),
+            to_blas_index(transpose_B ? b.shape()[1] : b.shape()[0]),
+            alpha,
+            op_a.data,
+            op_a.ld,
+            op_b.data,
+            op_b.ld,
+            beta,
+            result.data() + result.data_offset(),
+            get_leading_stride(result)
+        );
+    }
+
+    template <class E, class F, class R, class T>
+    inline void gemm_layout_dispatch(const E& a, const F& b, R& result, bool transpose_A, bool transpose_B,
+                                     const T& alpha, const T& beta)
+    {
+        result_layout_dispatch(result, [&](auto& res, auto layout)
+        {
+            gemm_impl<decltype(layout)::value>(a, b, res, transpose_A, transpose_B, alpha, beta);
+        });
+    }
+}
+
+namespace blas
+{
+    /**
+     * Sets the size up to which matrix products by \ref gemm and
+     * \ref linalg::dot are computed by an inline kernel instead of the
+     * BLAS library. Products whose dimensions all are at most
+     * \em n bypass BLAS; 0 sends every product to BLAS. Defaults to 16.
+     *
+     * @param n largest dimension of a product computed inline
+     */
+    inline void set_small_gemm_threshold(std::size_t n)
+    {
+        detail::small_gemm_threshold_value() = n;
+    }
+
+    /**
+     * @return the current threshold, see \ref set_small_gemm_threshold
+     */
+    inline std::size_t small_gemm_threshold()
+    {
+        return detail::small_gemm_threshold_value();
+    }
+
+    /**
+     * Selects the 3M algorithm (``cgemm3m`` and ``zgemm3m``) for the
+     * complex matrix products of \ref gemm and \ref linalg::dot: three
+     * real products instead of four, i.e. about 25% fewer flops, with a
+     * slightly larger rounding error. Without a BLAS driver providing
+     * them, or for products below blas::small_gemm_threshold(), the
+     * regular complex GEMM is used. Off by default.
+     *
+     * @param enable true to use the 3M algorithm
+     */
+    inline void set_complex_gemm_3m(bool enable)
+    {
+        detail::complex_gemm_3m_value() = enable;
+    }
+
+    /**
+     * @return true if complex products use the 3M algorithm, see
+     *         \ref set_complex_gemm_3m
+     */
+    inline bool complex_gemm_3m()
+    {
+        return detail::complex_gemm_3m_value();
+    }
+
+    /**
+     * Calculate the 1-norm of a vector
+     *
+     * @param a vector of n elements
+     * @returns scalar result
+     */
+    template <class E, class R>
+    void asum(const xexpression<E>& a, R& result)
+    {
+        auto&& ad = view_eval<E::static_layout>(a.derived_cast());
+        XTENSOR_ASSERT(ad.dimension() == 1);
+
+        // the order of the elements does not matter here, and reference BLAS
+        // returns zero for non-positive increments
+        auto op = detail::get_vector_operand(ad);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("asum", ad.shape()[0], 0, 0, layout_type::dynamic);
+        cxxblas::asum<blas_index_t>(
+            to_blas_index(ad.shape()[0]),
+            op.data,
+            std::abs(op.inc),
+            result
+        );
+    }
+
+    /**
+     * Calculate the 2-norm of a vector
+     *
+     * @param a vector of n elements
+     * @returns scalar result
+     */
+    template <class E, class R>
+    void nrm2(const xexpression<E>& a, R& result)
+    {
+        auto&& ad = view_eval<E::static_layout>(a.derived_cast());
+        XTENSOR_ASSERT(ad.dimension() == 1);
+
+        // the order of the elements does not matter here, and reference BLAS
+        // returns zero for non-positive increments
+        auto op = detail::get_vector_operand(ad);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("nrm2", ad.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<typename E::value_type>(double(ad.shape()[0])));
+        cxxblas::nrm2<blas_index_t>(
+            to_blas_index(ad.shape()[0]),
+            op.data,
+            std::abs(op.inc),
+            result
+        );
+    }
+
+    /**
+     * Calculate the dot product between two vectors, conjugating
+     * the first argument \em a in the case of complex vectors.
+     *
+     * @param a vector of n elements
+     * @param b vector of n elements
+     * @returns scalar result
+     */
+    template <class E1, class E2, class R>
+    void dot(const xexpression<E1>& a, const xexpression<E2>& b,
+             R& result)
+    {
+        auto&& ad = view_eval<E1::static_layout>(a.derived_cast());
+        auto&& bd = view_eval<E2::static_layout>(b.derived_cast());
+        XTENSOR_ASSERT(ad.dimension() == 1);
+
+        auto op_a = detail::get_vector_operand(ad);
+        auto op_b = detail::get_vector_operand(bd);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("dot", ad.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<typename E1::value_type>(double(ad.shape()[0])));
+        cxxblas::dot<blas_index_t>(
+            to_blas_index(ad.shape()[0]),
+            op_a.data,
+            op_a.inc,
+            op_b.data,
+            op_b.inc,
+            result
+        );
+    }
+
+    /**
+     * Calculate the dot product between two complex vectors, not conjugating the
+     * first argument \em a.
+     *
+     * @param a vector of n elements
+     * @param b vector of n elements
+     * @returns scalar result
+     */
+    template <class E1, class E2, class R>
+    void dotu(const xexpression<E1>& a, const xexpression<E2>& b, R& result)
+    {
+        auto&& ad = view_eval<E1::static_layout>(a.derived_cast());
+        auto&& bd = view_eval<E2::static_layout>(b.derived_cast());
+        XTENSOR_ASSERT(ad.dimension() == 1);
+
+        auto op_a = detail::get_vector_operand(ad);
+        auto op_b = detail::get_vector_operand(bd);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("dotu", ad.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<typename E1::value_type>(double(ad.shape()[0])));
+        cxxblas::dotu<blas_index_t>(
+            to_blas_index(ad.shape()[0]),
+            op_a.data,
+            op_a.inc,
+            op_b.data,
+            op_b.inc,
+            result
+        );
+    }
+
+    /**
+     * Selects the compensated kernels of \ref dot, \ref dotu, \ref nrm2
+     * and \ref sum, as accurate as a computation in twice the working
+     * precision followed by a rounding, at a small constant factor of the
+     * cost of the plain kernels.
+     */
+    struct compensated_t
+    {
+    };
+
+    /// Tag of the compensated level 1 kernels
+    constexpr compensated_t compensated = {};
+
+    /**
+     * Calculate the dot product between two vectors, conjugating \em a,
+     * with the rounding error of every product and addition accumulated
+     * exactly (Ogita, Rump and Oishi's Dot2). The result is accurate even
+     * when the sum cancels; the vendor BLAS is not used.
+     *
+     * @param a vector of n elements
+     * @param b vector of n elements
+     * @param result scalar result
+     */
+    template <class E1, class E2, class R>
+    void dot(const xexpression<E1>& a, const xexpression<E2>& b, R& result, compensated_t)
+    {
+        auto&& ad = view_eval<E1::static_layout>(a.derived_cast());
+        auto&& bd = view_eval<E2::static_layout>(b.derived_cast());
+        XTENSOR_ASSERT(ad.dimension() == 1);
+
+        auto op_a = detail::get_vector_operand(ad);
+        auto op_b = detail::get_vector_operand(bd);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("dot_compensated", ad.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<typename E1::value_type>(double(ad.shape()[0])));
+        cxxblas::dot_compensated<blas_index_t>(
+            to_blas_index(ad.shape()[0]),
+            op_a.data,
+            op_a.inc,
+            op_b.data,
+            op_b.inc,
+            result
+        );
+    }
+
+    /**
+     * Compensated dot product not conjugating \em a, see the compensated
+     * \ref dot.
+     */
+    template <class E1, class E2, class R>
+    void dotu(const xexpression<E1>& a, const xexpression<E2>& b, R& result, compensated_t)
+    {
+        auto&& ad = view_eval<E1::static_layout>(a.derived_cast());
+        auto&& bd = view_eval<E2::static_layout>(b.derived_cast());
+        XTENSOR_ASSERT(ad.dimension() == 1);
+
+        auto op_a = detail::get_vector_operand(ad);
+        auto op_b = detail::get_vector_operand(bd);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("dotu_compensated", ad.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<typename E1::value_type>(double(ad.shape()[0])));
+        cxxblas::dotu_compensated<blas_index_t>(
+            to_blas_index(ad.shape()[0]),
+            op_a.data,
+            op_a.inc,
+            op_b.data,
+            op_b.inc,
+            result
+        );
+    }
+
+    /**
+     * Calculate the sum of the elements of a vector with compensated
+     * additions (Sum2).
+     *
+     * @param a vector of n elements
+     * @param result scalar result
+     */
+    template <class E, class R>
+    void sum(const xexpression<E>& a, R& result, compensated_t)
+    {
+        auto&& ad = view_eval<E::static_layout>(a.derived_cast());
+        XTENSOR_ASSERT(ad.dimension() == 1);
+
+        auto op = detail::get_vector_operand(ad);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("sum_compensated", ad.shape()[0], 0, 0, layout_type::dynamic);
+        cxxblas::sum_compensated<blas_index_t>(
+            to_blas_index(ad.shape()[0]),
+            op.data,
+            std::abs(op.inc),
+            result
+        );
+    }
+
+    /**
+     * Calculate the 2-norm of a vector from a compensated sum of squares,
+     * after an exact scaling by a power of two that prevents overflow
+     * and underflow.
+     *
+     * @param a vector of n elements
+     * @param result scalar result
+     */
+    template <class E, class R>
+    void nrm2(const xexpression<E>& a, R& result, compensated_t)
+    {
+        auto&& ad = view_eval<E::static_layout>(a.derived_cast());
+        XTENSOR_ASSERT(ad.dimension() == 1);
+
+        auto op = detail::get_vector_operand(ad);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("nrm2_compensated", ad.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<typename E::value_type>(double(ad.shape()[0])));
+        cxxblas::nrm2_compensated<blas_index_t>(
+            to_blas_index(ad.shape()[0]),
+            op.data,
+            std::abs(op.inc),
+            result
+        );
+    }
+
+    /**
+     * Calculate the index of the element of largest absolute value
+     * (``|re| + |im|`` for complex vectors). Ties resolve to the first
+     * such element in memory order.
+     *
+     * @param a vector of n elements
+     * @param result index into \em a
+     */
+    template <class E, class R>
+    void iamax(const xexpression<E>& a, R& result)
+    {
+        auto&& ad = view_eval<E::static_layout>(a.derived_cast());
+        XTENSOR_ASSERT(ad.dimension() == 1);
+
+        // walk the memory forward (reference BLAS returns zero for negative
+        // increments) and map the index back to the order of the view
+        auto op = detail::get_vector_operand(ad);
+        blas_index_t n = to_blas_index(ad.shape()[0]);
+        blas_index_t i = 0;
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("iamax", ad.shape()[0], 0, 0, layout_type::dynamic);
+        if (n > 0)
+        {
+            cxxblas::iamax<blas_index_t>(n, op.data, std::abs(op.inc), i);
+        }
+        result = static_cast<R>(op.inc < 0 ? n - 1 - i : i);
+    }
+
+    /**
+     * Calculate ``y := alpha * x + y`` in place.
+     *
+     * @param x vector of n elements
+     * @param y vector of n elements, overwritten with the result
+     * @param alpha scalar scale factor (defaults to 1)
+     */
+    template <class E, class R, class value_type = typename R::value_type>
+    void axpy(const xexpression<E>& x, R& y, const value_type& alpha = value_type(1.0))
+    {
+        static_assert(has_data_interface<R>::value, "AXPY output must have a data interface.");
+        auto&& dx = view_eval<E::static_layout>(x.derived_cast());
+        XTENSOR_ASSERT(dx.dimension() == 1);
+        XTENSOR_ASSERT(y.dimension() == 1);
+        XTENSOR_ASSERT(dx.shape()[0] == y.shape()[0]);
+
+        auto op_x = detail::get_vector_operand(dx);
+        auto op_y = detail::get_vector_operand(y);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("axpy", y.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<value_type>(double(y.shape()[0])));
+        cxxblas::axpy<blas_index_t>(
+            to_blas_index(y.shape()[0]),
+            alpha,
+            op_x.data,
+            op_x.inc,
+            op_y.data,
+            op_y.inc
+        );
+    }
+
+    /**
+     * Calculate ``y := alpha * x + beta * y`` in place. Uses the vendor
+     * ``?axpby`` extension where available, ``scal`` followed by ``axpy``
+     * otherwise.
+     *
+     * @param x vector of n elements
+     * @param y vector of n elements, overwritten with the result
+     * @param alpha scale factor for x (defaults to 1)
+     * @param beta scale factor for y (defaults to 1)
+     */
+    template <class E, class R, class value_type = typename R::value_type>
+    void axpby(const xexpression<E>& x, R& y,
+               const value_type& alpha = value_type(1.0),
+               const value_type& beta = value_type(1.0))
+    {
+        static_assert(has_data_interface<R>::value, "AXPBY output must have a data interface.");
+        auto&& dx = view_eval<E::static_layout>(x.derived_cast());
+        XTENSOR_ASSERT(dx.dimension() == 1);
+        XTENSOR_ASSERT(y.dimension() == 1);
+        XTENSOR_ASSERT(dx.shape()[0] == y.shape()[0]);
+
+        auto op_x = detail::get_vector_operand(dx);
+        auto op_y = detail::get_vector_operand(y);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("axpby", y.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<value_type>(1.5 * double(y.shape()[0])));
+        cxxblas::axpby<blas_index_t>(
+            to_blas_index(y.shape()[0]),
+            alpha,
+            op_x.data,
+            op_x.inc,
+            beta,
+            op_y.data,
+            op_y.inc
+        );
+    }
 
-namespace xt
-{
+    /**
+     * Calculate ``x := alpha * x`` in place.
+     *
+     * @param x vector of n elements, overwritten with the result
+     * @param alpha scalar scale factor
+     */
+    template <class R, class value_type = typename R::value_type>
+    void scal(R& x, const value_type& alpha)
+    {
+        static_assert(has_data_interface<R>::value, "SCAL operand must have a data interface.");
+        XTENSOR_ASSERT(x.dimension() == 1);
+
+        auto op_x = detail::get_vector_operand(x);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("scal", x.shape()[0], 0, 0, layout_type::dynamic);
+        cxxblas::scal<blas_index_t>(
+            to_blas_index(x.shape()[0]),
+            alpha,
+            op_x.data,
+            op_x.inc
+        );
+    }
 
-namespace blas
-{
     /**
-     * Calculate the 1-norm of a vector
+     * Copy the vector \em x into \em y.
      *
-     * @param a vector of n elements
-     * @returns scalar result
+     * @param x vector of n elements
+     * @param y vector of n elements, overwritten with \em x
      */
     template <class E, class R>
-    void asum(const xexpression<E>& a, R& result)
+    void copy(const xexpression<E>& x, R& y)
     {
-        auto&& ad = view_eval<E::static_layout>(a.derived_cast());
-        XTENSOR_ASSERT(ad.dimension() == 1);
+        static_assert(has_data_interface<R>::value, "COPY output must have a data interface.");
+        auto&& dx = view_eval<E::static_layout>(x.derived_cast());
+        XTENSOR_ASSERT(dx.dimension() == 1);
+        XTENSOR_ASSERT(y.dimension() == 1);
+        XTENSOR_ASSERT(dx.shape()[0] == y.shape()[0]);
 
-        cxxblas::asum<blas_index_t>(
-            static_cast<blas_index_t>(ad.shape()[0]),
-            ad.data() + ad.data_offset(),
-            stride_front(ad),
-            result
+        auto op_x = detail::get_vector_operand(dx);
+        auto op_y = detail::get_vector_operand(y);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("copy", y.shape()[0], 0, 0, layout_type::dynamic);
+        cxxblas::copy<blas_index_t>(
+            to_blas_index(y.shape()[0]),
+            op_x.data,
+            op_x.inc,
+            op_y.data,
+            op_y.inc
         );
     }
 
     /**
-     * Calculate the 2-norm of a vector
+     * Exchange the elements of the vectors \em x and \em y.
      *
-     * @param a vector of n elements
-     * @returns scalar result
+     * @param x vector of n elements
+     * @param y vector of n elements
      */
     template <class E, class R>
-    void nrm2(const xexpression<E>& a, R& result)
+    void swap(E& x, R& y)
     {
-        auto&& ad = view_eval<E::static_layout>(a.derived_cast());
-        XTENSOR_ASSERT(ad.dimension() == 1);
+        static_assert(has_data_interface<E>::value && has_data_interface<R>::value,
+                      "SWAP operands must have a data interface.");
+        XTENSOR_ASSERT(x.dimension() == 1);
+        XTENSOR_ASSERT(y.dimension() == 1);
+        XTENSOR_ASSERT(x.shape()[0] == y.shape()[0]);
 
-        cxxblas::nrm2<blas_index_t>(
-            static_cast<blas_index_t>(ad.shape()[0]),
-            ad.data() + ad.data_offset(),
-            stride_front(ad),
-            result
+        auto op_x = detail::get_vector_operand(x);
+        auto op_y = detail::get_vector_operand(y);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("swap", x.shape()[0], 0, 0, layout_type::dynamic);
+        cxxblas::swap<blas_index_t>(
+            to_blas_index(x.shape()[0]),
+            op_x.data,
+            op_x.inc,
+            op_y.data,
+            op_y.inc
         );
     }
 
     /**
-     * Calculate the dot product between two vectors, conjugating
-     * the first argument \em a in the case of complex vectors.
+     * Apply the plane rotation ``x := c * x + s * y``,
+     * ``y := c * y - conj(s) * x`` in place.
      *
-     * @param a vector of n elements
-     * @param b vector of n elements
-     * @returns scalar result
+     * @param x vector of n elements
+     * @param y vector of n elements
+     * @param c cosine of the rotation
+     * @param s sine of the rotation, complex for complex vectors
      */
-    template <class E1, class E2, class R>
-    void dot(const xexpression<E1>& a, const xexpression<E2>& b,
-             R& result)
+    template <class E, class R, class C, class S>
+    void rot(E& x, R& y, const C& c, const S& s)
     {
-        auto&& ad = view_eval<E1::static_layout>(a.derived_cast());
-        auto&& bd = view_eval<E2::static_layout>(b.derived_cast());
-        XTENSOR_ASSERT(ad.dimension() == 1);
-
-        blas_index_t stride_a = stride_front(ad);
-        blas_index_t stride_b = stride_front(bd);
+        static_assert(has_data_interface<E>::value && has_data_interface<R>::value,
+                      "ROT operands must have a data interface.");
+        XTENSOR_ASSERT(x.dimension() == 1);
+        XTENSOR_ASSERT(y.dimension() == 1);
+        XTENSOR_ASSERT(x.shape()[0] == y.shape()[0]);
 
-        auto* adt = ad.data() + ad.data_offset();
-        auto* bdt = bd.data() + bd.data_offset();
+        using real_type = xtl::complex_value_type_t<typename E::value_type>;
+        using sine_type = std::conditional_t<xtl::is_complex<S>::value, S, real_type>;
 
-        // we need to have a pointer that points to the "real" start of the memory
-        // not to the first element (BLAS is doing that transformation itself)
-        if (stride_a < 0) {
-            adt += (static_cast<blas_index_t>(ad.shape()[0]) - 1) * stride_a; // go back to the start
-        }
-        if (stride_b < 0) {
-            bdt += (static_cast<blas_index_t>(ad.shape()[0]) - 1) * stride_b; // go back to the start
-        }
+        auto op_x = detail::get_vector_operand(x);
+        auto op_y = detail::get_vector_operand(y);
 
-        cxxblas::dot<blas_index_t>(
-            static_cast<blas_index_t>(ad.shape()[0]),
-            adt,
-            stride_a,
-            bdt,
-            stride_b,
-            result
+        XTENSOR_BLAS_INSTRUMENT_CALL("rot", x.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<typename E::value_type>(2. * double(x.shape()[0])));
+        cxxblas::rot<blas_index_t>(
+            to_blas_index(x.shape()[0]),
+            op_x.data,
+            op_x.inc,
+            op_y.data,
+            op_y.inc,
+            static_cast<real_type>(c),
+            static_cast<sine_type>(s)
         );
     }
 
     /**
-     * Calculate the dot product between two complex vectors, not conjugating the
-     * first argument \em a.
+     * Construct the plane rotation (c, s) that rot applies to zero the
+     * second component of (a, b): ``c * a + s * b = r`` and
+     * ``c * b - conj(s) * a = 0``.
      *
-     * @param a vector of n elements
-     * @param b vector of n elements
-     * @returns scalar result
+     * @param a first component, overwritten with r
+     * @param b second component, overwritten with reconstruction data for
+     *          real values
+     * @param c cosine of the rotation
+     * @param s sine of the rotation, complex for complex values
      */
-    template <class E1, class E2, class R>
-    void dotu(const xexpression<E1>& a, const xexpression<E2>& b, R& result)
+    template <class T>
+    void rotg(T& a, T& b, xtl::complex_value_type_t<T>& c, T& s)
     {
-        auto&& ad = view_eval<E1::static_layout>(a.derived_cast());
-        auto&& bd = view_eval<E2::static_layout>(b.derived_cast());
-        XTENSOR_ASSERT(ad.dimension() == 1);
-
-        blas_index_t stride_a = stride_front(ad);
-        blas_index_t stride_b = stride_front(bd);
+        cxxblas::rotg(a, b, c, s);
+    }
 
-        auto* adt = ad.data() + ad.data_offset();
-        auto* bdt = bd.data() + bd.data_offset();
+    /**
+     * Apply the modified plane rotation H given by \em param, as computed by
+     * rotmg, to the pairs (x_i, y_i) in place. Real values only.
+     *
+     * @param x vector of n elements
+     * @param y vector of n elements
+     * @param param flag and elements of H as returned by rotmg, 5 values in
+     *              a container with a data interface
+     */
+    template <class E, class R, class P>
+    void rotm(E& x, R& y, const P& param)
+    {
+        static_assert(has_data_interface<E>::value && has_data_interface<R>::value,
+                      "ROTM operands must have a data interface.");
+        static_assert(!xtl::is_complex<typename E::value_type>::value, "ROTM requires real values.");
+        XTENSOR_ASSERT(x.dimension() == 1);
+        XTENSOR_ASSERT(y.dimension() == 1);
+        XTENSOR_ASSERT(x.shape()[0] == y.shape()[0]);
+        XTENSOR_ASSERT(param.size() >= 5);
 
-        // we need to have a pointer that points to the "real" start of the memory
-        // not to the first element (BLAS is doing that transformation itself)
-        if (stride_a < 0) {
-            adt += (static_cast<blas_index_t>(ad.shape()[0]) - 1) * stride_a; // go back to the start
-        }
-        if (stride_b < 0) {
-            bdt += (static_cast<blas_index_t>(ad.shape()[0]) - 1) * stride_b; // go back to the start
-        }
+        auto op_x = detail::get_vector_operand(x);
+        auto op_y = detail::get_vector_operand(y);
 
-        cxxblas::dotu<blas_index_t>(
-            static_cast<blas_index_t>(ad.shape()[0]),
-            adt,
-            stride_a,
-            bdt,
-            stride_b,
-            result
+        XTENSOR_BLAS_INSTRUMENT_CALL("rotm", x.shape()[0], 0, 0, layout_type::dynamic, 0, 0,
+                                     instrument::fma_flops<typename E::value_type>(2. * double(x.shape()[0])));
+        cxxblas::rotm<blas_index_t>(
+            to_blas_index(x.shape()[0]),
+            op_x.data,
+            op_x.inc,
+            op_y.data,
+            op_y.inc,
+            param.data()
         );
     }
 
+    /**
+     * Construct the modified plane rotation H that zeroes the second
+     * component of (sqrt(d1) x1, sqrt(d2) y1) without square roots: after
+     * the call, H (x1, y1) = (x1', 0) with the scaling factors updated.
+     *
+     * @param d1 first scaling factor, updated
+     * @param d2 second scaling factor, updated
+     * @param x1 first component, overwritten with x1'
+     * @param y1 second component
+     * @param param container of 5 values with a data interface, set to the
+     *              flag and elements of H to pass to rotm
+     */
+    template <class T, class P>
+    void rotmg(T& d1, T& d2, T& x1, const T& y1, P& param)
+    {
+        static_assert(!xtl::is_complex<T>::value, "ROTMG requires real values.");
+        XTENSOR_ASSERT(param.size() >= 5);
+        T y = y1;
+        cxxblas::rotmg(d1, d2, x1, y, param.data());
+    }
+
     /**
      * Calculate the general matrix times vector product according to
      * ``y := alpha * A * x + beta * y``.
      *
+     * Matrices without a unit stride are read through their strides with
+     * the BLIS driver (WITH_BLIS) and copied otherwise.
+     *
      * @param A matrix of n x m elements
      * @param x vector of n elements
      * @param transpose select if A should be transposed
@@ -166,22 +1792,188 @@ namespace blas
               const value_type& alpha = value_type(1.0),
               const value_type& beta = value_type(0.0))
     {
-        auto&& dA = view_eval<E1::static_layout>(A.derived_cast());
+        const auto& a = A.derived_cast();
         auto&& dx = view_eval<E2::static_layout>(x.derived_cast());
 
+        XTENSOR_ASSERT(a.dimension() == 2);
+
+        auto op_x = detail::get_vector_operand(dx);
+        auto op_y = detail::get_vector_operand(result);
+        if (detail::gemv_strided(a, transpose_A, alpha, op_x, beta, op_y, has_data_interface<E1>()))
+        {
+            return;
+        }
+
+        // A is read in row-major order; column-stored operands (including
+        // strided views) are passed as their transpose with the op flipped.
+        xtensor<typename E1::value_type, 2, layout_type::row_major> a_copy;
+        auto op_a = detail::get_matrix_operand<layout_type::row_major>(a, a_copy, has_data_interface<E1>());
+        std::size_t a_rows = op_a.transposed ? a.shape()[1] : a.shape()[0];
+        std::size_t a_cols = op_a.transposed ? a.shape()[0] : a.shape()[1];
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemv", a_rows, a_cols, 0, layout_type::row_major,
+                                     (transpose_A != op_a.transposed) ? 'T' : 'N', 0,
+                                     instrument::fma_flops<typename E1::value_type>(double(a_rows) * double(a_cols)));
         cxxblas::gemv<blas_index_t>(
-            get_blas_storage_order(result),
+            cxxblas::StorageOrder::RowMajor,
+            (transpose_A != op_a.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+            to_blas_index(a_rows),
+            to_blas_index(a_cols),
+            alpha,
+            op_a.data,
+            op_a.ld,
+            op_x.data,
+            op_x.inc,
+            beta,
+            op_y.data,
+            op_y.inc
+        );
+    }
+
+    /**
+     * Calculate the symmetric matrix times vector product according to
+     * ``y := alpha * A * x + beta * y``, reading only one triangle of A.
+     *
+     * @param A symmetric matrix of n x n elements
+     * @param x vector of n elements
+     * @param uplo 'L' or 'U', the triangle of A that is referenced
+     * @param alpha scalar scale factor
+     * @param beta scalar scale factor for y
+     */
+    template <class E1, class E2, class R, class value_type = typename E1::value_type>
+    void symv(const xexpression<E1>& A, const xexpression<E2>& x,
+              R& result,
+              char uplo = 'L',
+              const value_type& alpha = value_type(1.0),
+              const value_type& beta = value_type(0.0))
+    {
+        const auto& a = A.derived_cast();
+        auto&& dx = view_eval<E2::static_layout>(x.derived_cast());
+
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(a.shape()[0] == a.shape()[1]);
+
+        xtensor<typename E1::value_type, 2, layout_type::row_major> a_copy;
+        auto op_a = detail::get_matrix_operand<layout_type::row_major>(a, a_copy, has_data_interface<E1>());
+        auto op_x = detail::get_vector_operand(dx);
+        auto op_y = detail::get_vector_operand(result);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("symv", a.shape()[0], a.shape()[0], 0, layout_type::row_major, 0, 0,
+                                     instrument::fma_flops<typename E1::value_type>(double(a.shape()[0]) * double(a.shape()[0])));
+        cxxblas::symv<blas_index_t>(
+            cxxblas::StorageOrder::RowMajor,
+            detail::blas_uplo(uplo, op_a.transposed),
+            to_blas_index(a.shape()[0]),
+            alpha,
+            op_a.data,
+            op_a.ld,
+            op_x.data,
+            op_x.inc,
+            beta,
+            op_y.data,
+            op_y.inc
+        );
+    }
+
+    /**
+     * Calculate the triangular matrix times vector product
+     * ``x := op(A) * x`` in place.
+     *
+     * @param A triangular matrix of n x n elements
+     * @param x vector of n elements, overwritten with the result
+     * @param uplo 'L' or 'U', the triangle of A that is referenced
+     * @param transpose select if A should be transposed
+     * @param diag 'N', or 'U' if A has an implicit unit diagonal
+     */
+    template <class E, class R>
+    void trmv(const xexpression<E>& A, R& x,
+              char uplo = 'L',
+              bool transpose_A = false,
+              char diag = 'N')
+    {
+        static_assert(has_data_interface<R>::value, "TRMV operand must have a data interface.");
+        const auto& a = A.derived_cast();
+
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(a.shape()[0] == a.shape()[1]);
+        XTENSOR_ASSERT(x.dimension() == 1);
+
+        xtensor<typename E::value_type, 2, layout_type::row_major> a_copy;
+        auto op_a = detail::get_matrix_operand<layout_type::row_major>(a, a_copy, has_data_interface<E>());
+        auto op_x = detail::get_vector_operand(x);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("trmv", a.shape()[0], a.shape()[0], 0, layout_type::row_major,
+                                     (transpose_A != op_a.transposed) ? 'T' : 'N', 0,
+                                     instrument::fma_flops<typename E::value_type>(0.5 * double(a.shape()[0]) * double(a.shape()[0])));
+        cxxblas::trmv<blas_index_t>(
+            cxxblas::StorageOrder::RowMajor,
+            detail::blas_uplo(uplo, op_a.transposed),
+            (transpose_A != op_a.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+            detail::blas_diag(diag),
+            to_blas_index(a.shape()[0]),
+            op_a.data,
+            op_a.ld,
+            op_x.data,
+            op_x.inc
+        );
+    }
+
+    /**
+     * Calculate the banded matrix times vector product according to
+     * ``y := alpha * op(A) * x + beta * y``.
+     *
+     * A is m x n with \em kl sub- and \em ku super-diagonals, given in the
+     * LAPACK band storage \em AB of (kl + ku + 1) x n elements, where
+     * ``AB(ku + i - j, j) = A(i, j)``. Column-major band storage is passed
+     * to BLAS directly, other layouts are copied.
+     *
+     * @param AB band storage of A
+     * @param x vector of n elements (m if transposed)
+     * @param kl number of sub-diagonals of A
+     * @param ku number of super-diagonals of A
+     * @param transpose select if A should be transposed
+     * @param alpha scalar scale factor
+     * @param beta scalar scale factor for y
+     */
+    template <class E1, class E2, class R, class value_type = typename E1::value_type>
+    void gbmv(const xexpression<E1>& AB, const xexpression<E2>& x,
+              R& result,
+              std::size_t kl, std::size_t ku,
+              bool transpose_A = false,
+              const value_type& alpha = value_type(1.0),
+              const value_type& beta = value_type(0.0))
+    {
+        const auto& ab = AB.derived_cast();
+        auto&& dx = view_eval<E2::static_layout>(x.derived_cast());
+
+        XTENSOR_ASSERT(ab.dimension() == 2);
+        XTENSOR_ASSERT(ab.shape()[0] == kl + ku + 1);
+
+        xtensor<typename E1::value_type, 2, layout_type::column_major> ab_copy;
+        auto op_ab = detail::get_ordered_matrix_operand<layout_type::column_major>(ab, ab_copy, has_data_interface<E1>());
+        auto op_x = detail::get_vector_operand(dx);
+        auto op_y = detail::get_vector_operand(result);
+
+        std::size_t n = ab.shape()[1];
+        std::size_t m = transpose_A ? dx.shape()[0] : result.shape()[0];
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("gbmv", m, n, 0, layout_type::column_major, transpose_A ? 'T' : 'N', 0,
+                                     instrument::fma_flops<typename E1::value_type>(double(kl + ku + 1) * double(n)));
+        cxxblas::gbmv<blas_index_t>(
+            cxxblas::StorageOrder::ColMajor,
             transpose_A ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
-            static_cast<blas_index_t>(dA.shape()[0]),
-            static_cast<blas_index_t>(dA.shape()[1]),
+            to_blas_index(m),
+            to_blas_index(n),
+            to_blas_index(kl),
+            to_blas_index(ku),
             alpha,
-            dA.data() + dA.data_offset(),
-            get_leading_stride(dA),
-            dx.data() + dx.data_offset(),
-            get_leading_stride(dx),
+            op_ab.data,
+            op_ab.ld,
+            op_x.data,
+            op_x.inc,
             beta,
-            result.data() + result.data_offset(),
-            get_leading_stride(result)
+            op_y.data,
+            op_y.inc
         );
     }
 
@@ -190,6 +1982,12 @@ namespace blas
      *
      * C := alpha * A * B + beta * C
      *
+     * Operands stored in the other order than the result are read as their
+     * transpose with the op flipped, without a copy, and views with no
+     * unit stride are packed block by block. A result of dynamic layout is
+     * written in the storage order it has at run time, and only computed
+     * in a temporary if BLAS cannot address it.
+     *
      * @param A matrix of m-by-n elements
      * @param B matrix of n-by-k elements
      * @param transpose_A transpose A on the fly
@@ -204,31 +2002,436 @@ namespace blas
               const value_type& alpha = value_type(1.0),
               const value_type& beta = value_type(0.0))
     {
-        static_assert(R::static_layout != layout_type::dynamic, "GEMM result layout cannot be dynamic.");
-        auto&& dA = view_eval<R::static_layout>(A.derived_cast());
-        auto&& dB = view_eval<R::static_layout>(B.derived_cast());
+        XTENSOR_ASSERT(A.derived_cast().dimension() == 2);
+        XTENSOR_ASSERT(B.derived_cast().dimension() == 2);
+        detail::gemm_layout_dispatch(A.derived_cast(), B.derived_cast(), result, static_cast<bool>(transpose_A),
+                                     static_cast<bool>(transpose_B), alpha, beta);
+    }
 
-        XTENSOR_ASSERT(dA.layout() == dB.layout());
-        XTENSOR_ASSERT(result.layout() == dA.layout());
-        XTENSOR_ASSERT(dA.dimension() == 2);
-        XTENSOR_ASSERT(dB.dimension() == 2);
+    /**
+     * Calculate the product of the symmetric matrix @A and matrix @B
+     *
+     * C := alpha * A * B + beta * C (side 'L'), or
+     * C := alpha * B * A + beta * C (side 'R')
+     *
+     * @param A symmetric matrix of m-by-m elements (n-by-n for side 'R')
+     * @param B matrix of m-by-n elements
+     * @param side 'L' or 'R', the side on which A multiplies B
+     * @param uplo 'L' or 'U', the triangle of A that is referenced
+     * @param alpha scale factor for A * B (defaults to 1)
+     * @param beta scale factor for C (defaults to 0)
+     */
+    template <class E, class F, class R, class value_type = typename E::value_type>
+    void symm(const xexpression<E>& A, const xexpression<F>& B, R& result,
+              char side = 'L',
+              char uplo = 'L',
+              const value_type& alpha = value_type(1.0),
+              const value_type& beta = value_type(0.0))
+    {
+        const auto& a = A.derived_cast();
+        const auto& b = B.derived_cast();
 
-        cxxblas::gemm<blas_index_t>(
-            get_blas_storage_order(result),
-            transpose_A ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
-            transpose_B ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
-            static_cast<blas_index_t>(transpose_A ? dA.shape()[1] : dA.shape()[0]),
-            static_cast<blas_index_t>(transpose_B ? dB.shape()[0] : dB.shape()[1]),
-            static_cast<blas_index_t>(transpose_B ? dB.shape()[1] : dB.shape()[0]),
-            alpha,
-            dA.data() + dA.data_offset(),
-            get_leading_stride(dA),
-            dB.data() + dB.data_offset(),
-            get_leading_stride(dB),
-            beta,
-            result.data() + result.data_offset(),
-            get_leading_stride(result)
-        );
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(a.shape()[0] == a.shape()[1]);
+        XTENSOR_ASSERT(b.dimension() == 2);
+
+        detail::result_layout_dispatch(result, [&](auto& res, auto layout)
+        {
+            constexpr layout_type L = decltype(layout)::value;
+            // A^T = A, so a transposed A only swaps the referenced triangle;
+            // B has no op flag and is copied if stored in the other order
+            xtensor<typename E::value_type, 2, L> a_copy;
+            xtensor<typename F::value_type, 2, L> b_copy;
+            auto op_a = detail::get_matrix_operand<L>(a, a_copy, has_data_interface<E>());
+            auto op_b = detail::get_ordered_matrix_operand<L>(b, b_copy, has_data_interface<F>());
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("symm", res.shape()[0], res.shape()[1],
+                                         (side == 'L' || side == 'l') ? res.shape()[0] : res.shape()[1], L, 0, 0,
+                                         instrument::fma_flops<value_type>(double(res.shape()[0]) * double(res.shape()[1])
+                                                                           * double((side == 'L' || side == 'l') ? res.shape()[0] : res.shape()[1])));
+            cxxblas::symm<blas_index_t>(
+                get_blas_storage_order(res),
+                detail::blas_side(side),
+                detail::blas_uplo(uplo, op_a.transposed),
+                to_blas_index(res.shape()[0]),
+                to_blas_index(res.shape()[1]),
+                alpha,
+                op_a.data,
+                op_a.ld,
+                op_b.data,
+                op_b.ld,
+                beta,
+                res.data() + res.data_offset(),
+                get_leading_stride(res)
+            );
+        });
+    }
+
+    /**
+     * Calculate the \em uplo triangle of the matrix-matrix product of
+     * matrix @A and matrix @B, for a square result of which the other
+     * triangle is not referenced (e.g. a product known to be symmetric),
+     * at about half the flops of \ref gemm
+     *
+     * C := alpha * A * B + beta * C
+     *
+     * Uses ``?gemmt`` if the BLAS driver provides it, and otherwise
+     * calls GEMM on the blocks of the triangle.
+     *
+     * @param A matrix of n-by-k elements
+     * @param B matrix of k-by-n elements
+     * @param uplo 'L' or 'U', the triangle of C that is computed
+     * @param transpose_A transpose A on the fly
+     * @param transpose_B transpose B on the fly
+     * @param alpha scale factor for A * B (defaults to 1)
+     * @param beta scale factor for C (defaults to 0)
+     */
+    template <class E, class F, class R, class value_type = typename E::value_type>
+    void gemmt(const xexpression<E>& A, const xexpression<F>& B, R& result,
+               char uplo = 'L',
+               bool transpose_A = false,
+               bool transpose_B = false,
+               const value_type& alpha = value_type(1.0),
+               const value_type& beta = value_type(0.0))
+    {
+        const auto& a = A.derived_cast();
+        const auto& b = B.derived_cast();
+
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(b.dimension() == 2);
+        XTENSOR_ASSERT(result.shape()[0] == result.shape()[1]);
+
+        detail::result_layout_dispatch(result, [&](auto& res, auto layout)
+        {
+            constexpr layout_type L = decltype(layout)::value;
+            xtensor<typename E::value_type, 2, L> a_copy;
+            xtensor<typename F::value_type, 2, L> b_copy;
+            auto op_a = detail::get_matrix_operand<L>(a, a_copy, has_data_interface<E>());
+            auto op_b = detail::get_matrix_operand<L>(b, b_copy, has_data_interface<F>());
+            std::size_t k = transpose_A ? a.shape()[0] : a.shape()[1];
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("gemmt", res.shape()[0], res.shape()[0], k, L,
+                                         (transpose_A != op_a.transposed) ? 'T' : 'N',
+                                         (transpose_B != op_b.transposed) ? 'T' : 'N',
+                                         instrument::fma_flops<value_type>(0.5 * double(res.shape()[0]) * double(res.shape()[0] + 1)
+                                                                           * double(k)));
+            cxxblas::gemmt<blas_index_t>(
+                get_blas_storage_order(res),
+                detail::blas_uplo(uplo),
+                (transpose_A != op_a.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                (transpose_B != op_b.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                to_blas_index(res.shape()[0]),
+                to_blas_index(k),
+                alpha,
+                op_a.data,
+                op_a.ld,
+                op_b.data,
+                op_b.ld,
+                beta,
+                res.data() + res.data_offset(),
+                get_leading_stride(res)
+            );
+        });
+    }
+
+    /**
+     * Calculate the matrix-matrix product of matrix @A and matrix @B and
+     * apply the elementwise epilogue @f to it in the same pass
+     *
+     * C(i, j) := f(i, j, (alpha * A * B + beta * C)(i, j))
+     *
+     * The generic kernel applies f to each block of C as soon as it is
+     * complete; with a BLAS driver, GEMM is called on panels of C, each
+     * followed by f while it is still in cache. f is called once per
+     * element, possibly concurrently from several threads.
+     *
+     * @param A matrix of m-by-k elements
+     * @param B matrix of k-by-n elements
+     * @param f functor returning the new value of element (i, j) of C
+     *          from its value
+     * @param transpose_A transpose A on the fly
+     * @param transpose_B transpose B on the fly
+     * @param alpha scale factor for A * B (defaults to 1)
+     * @param beta scale factor for C (defaults to 0)
+     */
+    template <class E, class F, class R, class G, class value_type = typename R::value_type>
+    void gemm_epilogue(const xexpression<E>& A, const xexpression<F>& B, R& result, const G& f,
+                       bool transpose_A = false,
+                       bool transpose_B = false,
+                       const value_type& alpha = value_type(1.0),
+                       const value_type& beta = value_type(0.0))
+    {
+        const auto& a = A.derived_cast();
+        const auto& b = B.derived_cast();
+
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(b.dimension() == 2);
+
+        detail::result_layout_dispatch(result, [&](auto& res, auto layout)
+        {
+            constexpr layout_type L = decltype(layout)::value;
+            // operands of another type are converted to the type of the result
+            xtensor<value_type, 2, L> a_copy;
+            xtensor<value_type, 2, L> b_copy;
+            auto op_a = detail::get_matrix_operand<L>(
+                a, a_copy,
+                std::integral_constant<bool, has_data_interface<E>::value && std::is_same<typename E::value_type, value_type>::value>());
+            auto op_b = detail::get_matrix_operand<L>(
+                b, b_copy,
+                std::integral_constant<bool, has_data_interface<F>::value && std::is_same<typename F::value_type, value_type>::value>());
+            std::size_t k = transpose_A ? a.shape()[0] : a.shape()[1];
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("gemm_epilogue", res.shape()[0], res.shape()[1], k, L,
+                                         (transpose_A != op_a.transposed) ? 'T' : 'N',
+                                         (transpose_B != op_b.transposed) ? 'T' : 'N',
+                                         instrument::fma_flops<value_type>(double(res.shape()[0]) * double(res.shape()[1])
+                                                                           * double(k)));
+            cxxblas::gemm_epilogue<blas_index_t>(
+                get_blas_storage_order(res),
+                (transpose_A != op_a.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                (transpose_B != op_b.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                to_blas_index(res.shape()[0]),
+                to_blas_index(res.shape()[1]),
+                to_blas_index(k),
+                alpha,
+                op_a.data,
+                op_a.ld,
+                op_b.data,
+                op_b.ld,
+                beta,
+                res.data() + res.data_offset(),
+                get_leading_stride(res),
+                [&f](blas_index_t i, blas_index_t j, const value_type& c) -> value_type
+                {
+                    return f(std::size_t(i), std::size_t(j), c);
+                }
+            );
+        });
+    }
+
+    /**
+     * Calculate the symmetric rank-k update of C, of which only the
+     * \em uplo triangle is referenced and updated
+     *
+     * C := alpha * A * A' + beta * C, or
+     * C := alpha * A' * A + beta * C if transposed
+     *
+     * @param A matrix of n-by-k elements (k-by-n if transposed)
+     * @param uplo 'L' or 'U', the triangle of C that is updated
+     * @param transpose_A transpose A on the fly
+     * @param alpha scale factor for A * A' (defaults to 1)
+     * @param beta scale factor for C (defaults to 0)
+     */
+    template <class E, class R, class value_type = typename E::value_type>
+    void syrk(const xexpression<E>& A, R& result,
+              char uplo = 'L',
+              bool transpose_A = false,
+              const value_type& alpha = value_type(1.0),
+              const value_type& beta = value_type(0.0))
+    {
+        const auto& a = A.derived_cast();
+
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(result.shape()[0] == result.shape()[1]);
+
+        detail::result_layout_dispatch(result, [&](auto& res, auto layout)
+        {
+            constexpr layout_type L = decltype(layout)::value;
+            xtensor<typename E::value_type, 2, L> a_copy;
+            auto op_a = detail::get_matrix_operand<L>(a, a_copy, has_data_interface<E>());
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("syrk", res.shape()[0], res.shape()[0], transpose_A ? a.shape()[0] : a.shape()[1], L,
+                                         (transpose_A != op_a.transposed) ? 'T' : 'N', 0,
+                                         instrument::fma_flops<value_type>(0.5 * double(res.shape()[0]) * double(res.shape()[0] + 1)
+                                                                           * double(transpose_A ? a.shape()[0] : a.shape()[1])));
+            cxxblas::syrk<blas_index_t>(
+                get_blas_storage_order(res),
+                detail::blas_uplo(uplo),
+                (transpose_A != op_a.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                to_blas_index(res.shape()[0]),
+                to_blas_index(transpose_A ? a.shape()[0] : a.shape()[1]),
+                alpha,
+                op_a.data,
+                op_a.ld,
+                beta,
+                res.data() + res.data_offset(),
+                get_leading_stride(res)
+            );
+        });
+    }
+
+    /**
+     * Calculate the Hermitian rank-k update of C, of which only the
+     * \em uplo triangle is referenced and updated
+     *
+     * C := alpha * A * A^H + beta * C, or
+     * C := alpha * A^H * A + beta * C if conjugate transposed
+     *
+     * @param A matrix of n-by-k elements (k-by-n if transposed)
+     * @param uplo 'L' or 'U', the triangle of C that is updated
+     * @param transpose_A conjugate transpose A on the fly
+     * @param alpha real scale factor for A * A^H (defaults to 1)
+     * @param beta real scale factor for C (defaults to 0)
+     */
+    template <class E, class R, class real_type = xtl::complex_value_type_t<typename E::value_type>>
+    void herk(const xexpression<E>& A, R& result,
+              char uplo = 'L',
+              bool transpose_A = false,
+              const real_type& alpha = real_type(1.0),
+              const real_type& beta = real_type(0.0))
+    {
+        const auto& a = A.derived_cast();
+
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(result.shape()[0] == result.shape()[1]);
+
+        detail::result_layout_dispatch(result, [&](auto& res, auto layout)
+        {
+            constexpr layout_type L = decltype(layout)::value;
+            // A^T is not A^H, so an operand stored in the other order is copied
+            xtensor<typename E::value_type, 2, L> a_copy;
+            auto op_a = detail::get_ordered_matrix_operand<L>(a, a_copy, has_data_interface<E>());
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("herk", res.shape()[0], res.shape()[0], transpose_A ? a.shape()[0] : a.shape()[1], L,
+                                         transpose_A ? 'C' : 'N', 0,
+                                         instrument::fma_flops<typename E::value_type>(0.5 * double(res.shape()[0]) * double(res.shape()[0] + 1)
+                                                                                      * double(transpose_A ? a.shape()[0] : a.shape()[1])));
+            cxxblas::herk<blas_index_t>(
+                get_blas_storage_order(res),
+                detail::blas_uplo(uplo),
+                transpose_A ? cxxblas::Transpose::ConjTrans : cxxblas::Transpose::NoTrans,
+                to_blas_index(res.shape()[0]),
+                to_blas_index(transpose_A ? a.shape()[0] : a.shape()[1]),
+                alpha,
+                op_a.data,
+                op_a.ld,
+                beta,
+                res.data() + res.data_offset(),
+                get_leading_stride(res)
+            );
+        });
+    }
+
+    /**
+     * Calculate the symmetric rank-2k update of C, of which only the
+     * \em uplo triangle is referenced and updated
+     *
+     * C := alpha * A * B' + alpha * B * A' + beta * C, or
+     * C := alpha * A' * B + alpha * B' * A + beta * C if transposed
+     *
+     * @param A matrix of n-by-k elements (k-by-n if transposed)
+     * @param B matrix of the same shape as A
+     * @param uplo 'L' or 'U', the triangle of C that is updated
+     * @param transpose transpose A and B on the fly
+     * @param alpha scale factor for the products (defaults to 1)
+     * @param beta scale factor for C (defaults to 0)
+     */
+    template <class E, class F, class R, class value_type = typename E::value_type>
+    void syr2k(const xexpression<E>& A, const xexpression<F>& B, R& result,
+               char uplo = 'L',
+               bool transpose = false,
+               const value_type& alpha = value_type(1.0),
+               const value_type& beta = value_type(0.0))
+    {
+        const auto& a = A.derived_cast();
+        const auto& b = B.derived_cast();
+
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(b.dimension() == 2);
+        XTENSOR_ASSERT(result.shape()[0] == result.shape()[1]);
+
+        detail::result_layout_dispatch(result, [&](auto& res, auto layout)
+        {
+            constexpr layout_type L = decltype(layout)::value;
+            // A and B share one op flag, so they must be read in the same order
+            xtensor<typename E::value_type, 2, L> a_copy;
+            xtensor<typename F::value_type, 2, L> b_copy;
+            auto op_a = detail::get_matrix_operand<L>(a, a_copy, has_data_interface<E>());
+            auto op_b = detail::get_matrix_operand<L>(b, b_copy, has_data_interface<F>());
+            if (op_a.transposed != op_b.transposed)
+            {
+                if (op_a.transposed)
+                {
+                    op_a = detail::get_matrix_operand<L>(a, a_copy, std::false_type());
+                }
+                else
+                {
+                    op_b = detail::get_matrix_operand<L>(b, b_copy, std::false_type());
+                }
+            }
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("syr2k", res.shape()[0], res.shape()[0], transpose ? a.shape()[0] : a.shape()[1], L,
+                                         (transpose != op_a.transposed) ? 'T' : 'N', 0,
+                                         instrument::fma_flops<value_type>(double(res.shape()[0]) * double(res.shape()[0] + 1)
+                                                                           * double(transpose ? a.shape()[0] : a.shape()[1])));
+            cxxblas::syr2k<blas_index_t>(
+                get_blas_storage_order(res),
+                detail::blas_uplo(uplo),
+                (transpose != op_a.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                to_blas_index(res.shape()[0]),
+                to_blas_index(transpose ? a.shape()[0] : a.shape()[1]),
+                alpha,
+                op_a.data,
+                op_a.ld,
+                op_b.data,
+                op_b.ld,
+                beta,
+                res.data() + res.data_offset(),
+                get_leading_stride(res)
+            );
+        });
+    }
+
+    /**
+     * Calculate the product of the triangular matrix @A and matrix @B in place
+     *
+     * B := alpha * op(A) * B (side 'L'), or
+     * B := alpha * B * op(A) (side 'R')
+     *
+     * @param A triangular matrix of m-by-m elements (n-by-n for side 'R')
+     * @param B matrix of m-by-n elements, overwritten with the result
+     * @param side 'L' or 'R', the side on which A multiplies B
+     * @param uplo 'L' or 'U', the triangle of A that is referenced
+     * @param transpose_A transpose A on the fly
+     * @param diag 'N', or 'U' if A has an implicit unit diagonal
+     * @param alpha scale factor (defaults to 1)
+     */
+    template <class E, class R, class value_type = typename E::value_type>
+    void trmm(const xexpression<E>& A, R& B,
+              char side = 'L',
+              char uplo = 'L',
+              bool transpose_A = false,
+              char diag = 'N',
+              const value_type& alpha = value_type(1.0))
+    {
+        detail::trxm(A, B, side, uplo, transpose_A, diag, alpha, std::false_type());
+    }
+
+    /**
+     * Solve the triangular system with multiple right hand sides in place
+     *
+     * op(A) * X = alpha * B (side 'L'), or
+     * X * op(A) = alpha * B (side 'R'),
+     *
+     * overwriting B with X.
+     *
+     * @param A triangular matrix of m-by-m elements (n-by-n for side 'R')
+     * @param B matrix of m-by-n elements, overwritten with the solution
+     * @param side 'L' or 'R', the side on which A multiplies X
+     * @param uplo 'L' or 'U', the triangle of A that is referenced
+     * @param transpose_A transpose A on the fly
+     * @param diag 'N', or 'U' if A has an implicit unit diagonal
+     * @param alpha scale factor for B (defaults to 1)
+     */
+    template <class E, class R, class value_type = typename E::value_type>
+    void trsm(const xexpression<E>& A, R& B,
+              char side = 'L',
+              char uplo = 'L',
+              bool transpose_A = false,
+              char diag = 'N',
+              const value_type& alpha = value_type(1.0))
+    {
+        detail::trxm(A, B, side, uplo, transpose_A, diag, alpha, std::true_type());
     }
 
     /**
@@ -245,21 +2448,26 @@ namespace blas
              R& result,
              const value_type& alpha = value_type(1.0))
     {
-        auto&& dx = view_eval(x.derived_cast());
-        auto&& dy = view_eval(y.derived_cast());
+        auto&& dx = view_eval<E1::static_layout>(x.derived_cast());
+        auto&& dy = view_eval<E2::static_layout>(y.derived_cast());
 
         XTENSOR_ASSERT(dx.dimension() == 1);
         XTENSOR_ASSERT(dy.dimension() == 1);
 
+        auto op_x = detail::get_vector_operand(dx);
+        auto op_y = detail::get_vector_operand(dy);
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("ger", dx.shape()[0], dy.shape()[0], 0, result.layout(), 0, 0,
+                                     instrument::fma_flops<value_type>(double(dx.shape()[0]) * double(dy.shape()[0])));
         cxxblas::ger<blas_index_t>(
             get_blas_storage_order(result),
-            static_cast<blas_index_t>(dx.shape()[0]),
-            static_cast<blas_index_t>(dy.shape()[0]),
+            to_blas_index(dx.shape()[0]),
+            to_blas_index(dy.shape()[0]),
             alpha,
-            dx.data() + dx.data_offset(),
-            get_leading_stride(dx),
-            dy.data() + dy.data_offset(),
-            get_leading_stride(dy),
+            op_x.data,
+            op_x.inc,
+            op_y.data,
+            op_y.inc,
             result.data() + result.data_offset(),
             get_leading_stride(result)
         );
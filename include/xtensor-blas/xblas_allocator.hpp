@@ -0,0 +1,626 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XBLAS_ALLOCATOR_HPP
+#define XBLAS_ALLOCATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "xtensor/xstorage.hpp"
+
+#include "xtensor-blas/xblas_config.hpp"
+#include "xtensor-blas/xblas_threads.hpp"
+
+// Alignment of the buffers of blas_allocator, a cache line and the width of
+// an AVX-512 register
+#ifndef XTENSOR_BLAS_ALIGNMENT
+#define XTENSOR_BLAS_ALIGNMENT 64
+#endif
+
+namespace xt
+{
+namespace detail
+{
+    struct blas_allocation_settings
+    {
+        std::size_t huge_page_threshold = 0;
+        bool parallel_first_touch = false;
+    };
+
+    inline blas_allocation_settings& blas_allocation_settings_value()
+    {
+        static blas_allocation_settings settings;
+        return settings;
+    }
+
+    constexpr std::size_t page_size = 4096;
+    constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+    // smaller buffers are touched by the allocating thread
+    constexpr std::size_t first_touch_min_bytes = std::size_t(1) << 20;
+
+    /**
+     * Aligned allocation by over-allocating with malloc and storing the
+     * pointer malloc returned just before the aligned block.
+     */
+    inline void* aligned_malloc(std::size_t bytes, std::size_t alignment)
+    {
+        std::size_t extra = alignment + sizeof(void*);
+        if (bytes > std::numeric_limits<std::size_t>::max() - extra)
+        {
+            throw std::bad_alloc();
+        }
+        void* raw = std::malloc(bytes + extra);
+        if (raw == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+        std::uintptr_t aligned = (start + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+        void* result = reinterpret_cast<void*>(aligned);
+        std::memcpy(static_cast<char*>(result) - sizeof(void*), &raw, sizeof(void*));
+        return result;
+    }
+
+    inline void aligned_free(void* p) noexcept
+    {
+        if (p != nullptr)
+        {
+            void* raw;
+            std::memcpy(&raw, static_cast<char*>(p) - sizeof(void*), sizeof(void*));
+            std::free(raw);
+        }
+    }
+
+    /**
+     * Writes one byte per page of \em p from blas::get_num_threads()
+     * threads, each taking a contiguous slice as the BLAS threads split
+     * the rows or columns of a product, so that the first touch places
+     * every page on the NUMA node of the thread that will work on it.
+     */
+    inline void parallel_first_touch(char* p, std::size_t bytes)
+    {
+        std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(p);
+        std::uintptr_t first_page = begin / page_size;
+        std::size_t pages = static_cast<std::size_t>((begin + bytes - 1) / page_size - first_page) + 1;
+        std::size_t threads = std::min(static_cast<std::size_t>(std::max(blas::get_num_threads(), 1)), pages);
+        auto touch = [p, begin, first_page, pages, threads](std::size_t t)
+        {
+            std::size_t first = pages * t / threads;
+            std::size_t last = pages * (t + 1) / threads;
+            for (std::size_t page = first; page < last; ++page)
+            {
+                std::uintptr_t address = std::max(begin, (first_page + page) * page_size);
+                p[address - begin] = 0;
+            }
+        };
+        if (threads <= 1)
+        {
+            touch(0);
+            return;
+        }
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for schedule(static) num_threads(static_cast<int>(threads))
+        for (std::ptrdiff_t t = 0; t < static_cast<std::ptrdiff_t>(threads); ++t)
+        {
+            touch(static_cast<std::size_t>(t));
+        }
+#else
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        for (std::size_t t = 1; t < threads; ++t)
+        {
+            workers.emplace_back(touch, t);
+        }
+        touch(0);
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+#endif
+    }
+
+    inline void* blas_malloc(std::size_t bytes)
+    {
+        const blas_allocation_settings& settings = blas_allocation_settings_value();
+        bool huge = settings.huge_page_threshold != 0 && bytes >= settings.huge_page_threshold;
+        // transparent huge pages back whole 2 MiB aligned ranges only
+        void* p = aligned_malloc(bytes, huge ? huge_page_size : std::size_t(XTENSOR_BLAS_ALIGNMENT));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (huge)
+        {
+            std::size_t length = bytes / huge_page_size * huge_page_size;
+            if (length != 0)
+            {
+                // advice only: failure leaves the buffer in normal pages
+                madvise(p, length, MADV_HUGEPAGE);
+            }
+        }
+#endif
+        if (settings.parallel_first_touch && bytes >= first_touch_min_bytes)
+        {
+            parallel_first_touch(static_cast<char*>(p), bytes);
+        }
+        return p;
+    }
+}
+
+    /**
+     * Allocator for the buffers handed to BLAS and LAPACK, the default of
+     * the LAPACK workspaces.
+     *
+     * Memory is aligned on XTENSOR_BLAS_ALIGNMENT bytes (64 by default),
+     * so that the kernels start on a cache line and full width vector
+     * loads. Two opt-in behaviours serve large buffers on multi-socket
+     * machines, see blas::set_huge_page_threshold and
+     * blas::set_parallel_first_touch. Results can be allocated with it as
+     * well, e.g. ``dot(a, b, result_as<xtensor<double, 2, layout_type::row_major,
+     * blas_allocator<double>>>())``.
+     *
+     * Only the memory is managed: like std::allocator, allocate does not
+     * construct the elements.
+     */
+    template <class T>
+    class blas_allocator
+    {
+    public:
+
+        using value_type = T;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        template <class U>
+        struct rebind
+        {
+            using other = blas_allocator<U>;
+        };
+
+        blas_allocator() noexcept = default;
+
+        template <class U>
+        blas_allocator(const blas_allocator<U>&) noexcept
+        {
+        }
+
+        T* allocate(std::size_t n)
+        {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(detail::blas_malloc(std::max(n, std::size_t(1)) * sizeof(T)));
+        }
+
+        void deallocate(T* p, std::size_t) noexcept
+        {
+            detail::aligned_free(p);
+        }
+
+        std::size_t max_size() const noexcept
+        {
+            return std::numeric_limits<std::size_t>::max() / sizeof(T);
+        }
+    };
+
+    template <class T, class U>
+    inline bool operator==(const blas_allocator<T>&, const blas_allocator<U>&) noexcept
+    {
+        return true;
+    }
+
+    template <class T, class U>
+    inline bool operator!=(const blas_allocator<T>&, const blas_allocator<U>&) noexcept
+    {
+        return false;
+    }
+
+    /// Uninitialized buffer of the internal BLAS and LAPACK work arrays
+    template <class T>
+    using blas_buffer = uvector<T, blas_allocator<T>>;
+
+namespace detail
+{
+    /**
+     * Bump allocator of one thread, behind scratch_allocator.
+     *
+     * Allocations are carved from the current block, and a new block, at
+     * least twice as large, is started when it is full. Nothing is released
+     * before the last live allocation is: the arena is then rewound, and
+     * the blocks filled since the previous rewind are merged into a single
+     * one, so that a loop repeating the same temporaries soon runs on one
+     * block without calling malloc. The allocation freed last is popped
+     * right away, which serves nested temporaries.
+     */
+    class scratch_arena
+    {
+    public:
+
+        scratch_arena() = default;
+        scratch_arena(const scratch_arena&) = delete;
+        scratch_arena& operator=(const scratch_arena&) = delete;
+        ~scratch_arena();
+
+        void* allocate(std::size_t bytes);
+        bool deallocate(void* p) noexcept;
+        void reserve(std::size_t bytes) noexcept;
+        void release() noexcept;
+
+        std::size_t scopes = 0;
+        std::size_t high_water_mark = 0;
+
+        std::size_t capacity() const noexcept;
+        std::size_t used() const noexcept;
+
+    private:
+
+        struct block
+        {
+            char* data;
+            std::size_t size;
+        };
+
+        void rewind() noexcept;
+
+        std::vector<block> m_blocks;
+        std::vector<std::size_t> m_offsets;  // start of each live allocation, in the last block
+        std::size_t m_offset = 0;
+        std::size_t m_used = 0;         // bytes of the blocks before the last one
+        std::size_t m_live = 0;
+    };
+
+    constexpr std::size_t scratch_block_min_bytes = std::size_t(1) << 16;
+
+    inline scratch_arena::~scratch_arena()
+    {
+        // live allocations (e.g. tensors leaked past the thread) keep their memory
+        if (m_live == 0)
+        {
+            release();
+        }
+    }
+
+    inline void* scratch_arena::allocate(std::size_t bytes)
+    {
+        constexpr std::size_t alignment = XTENSOR_BLAS_ALIGNMENT;
+        bytes = (std::max(bytes, std::size_t(1)) + alignment - 1) / alignment * alignment;
+        if (m_blocks.empty() || m_offset + bytes > m_blocks.back().size)
+        {
+            std::size_t size = std::max({bytes, scratch_block_min_bytes, m_blocks.empty() ? 0 : 2 * m_blocks.back().size});
+            char* data = static_cast<char*>(aligned_malloc(size, alignment));
+            if (!m_blocks.empty())
+            {
+                m_used += m_offset;
+            }
+            m_blocks.push_back({data, size});
+            m_offset = 0;
+            m_offsets.clear();
+        }
+        void* p = m_blocks.back().data + m_offset;
+        m_offsets.push_back(m_offset);
+        m_offset += bytes;
+        ++m_live;
+        high_water_mark = std::max(high_water_mark, m_used + m_offset);
+        return p;
+    }
+
+    /// Returns false if \em p does not come from this arena.
+    inline bool scratch_arena::deallocate(void* p) noexcept
+    {
+        char* c = static_cast<char*>(p);
+        auto owner = std::find_if(m_blocks.begin(), m_blocks.end(), [c](const block& b)
+        {
+            return std::less_equal<char*>()(b.data, c) && std::less<char*>()(c, b.data + b.size);
+        });
+        if (owner == m_blocks.end())
+        {
+            return false;
+        }
+        std::size_t offset = static_cast<std::size_t>(c - owner->data);
+        if (owner + 1 == m_blocks.end() && !m_offsets.empty() && m_offsets.back() == offset)
+        {
+            m_offset = offset;
+            m_offsets.pop_back();
+        }
+        if (--m_live == 0)
+        {
+            rewind();
+        }
+        return true;
+    }
+
+    inline void scratch_arena::rewind() noexcept
+    {
+        if (m_blocks.size() > 1)
+        {
+            std::size_t size = 0;
+            for (const block& b : m_blocks)
+            {
+                size += b.size;
+            }
+            release();
+            reserve(size);
+        }
+        m_offset = 0;
+        m_used = 0;
+        m_offsets.clear();
+    }
+
+    /**
+     * Replaces the blocks of an arena without live allocations by a single
+     * one of at least \em bytes. A failed allocation leaves the arena
+     * empty, the next allocation starting over.
+     */
+    inline void scratch_arena::reserve(std::size_t bytes) noexcept
+    {
+        if (m_live != 0 || capacity() >= bytes)
+        {
+            return;
+        }
+        release();
+        try
+        {
+            m_blocks.push_back({static_cast<char*>(aligned_malloc(bytes, XTENSOR_BLAS_ALIGNMENT)), bytes});
+        }
+        catch (const std::bad_alloc&)
+        {
+        }
+    }
+
+    /// Frees the blocks of an arena without live allocations.
+    inline void scratch_arena::release() noexcept
+    {
+        if (m_live != 0)
+        {
+            return;
+        }
+        for (const block& b : m_blocks)
+        {
+            aligned_free(b.data);
+        }
+        m_blocks.clear();
+        m_offsets.clear();
+        m_offset = 0;
+        m_used = 0;
+    }
+
+    inline std::size_t scratch_arena::capacity() const noexcept
+    {
+        std::size_t size = 0;
+        for (const block& b : m_blocks)
+        {
+            size += b.size;
+        }
+        return size;
+    }
+
+    inline std::size_t scratch_arena::used() const noexcept
+    {
+        return m_used + m_offset;
+    }
+
+    inline scratch_arena& thread_scratch_arena()
+    {
+        static thread_local scratch_arena arena;
+        return arena;
+    }
+}
+
+    /**
+     * Allocator of the internal temporaries of the BLAS and LAPACK
+     * wrappers, e.g. the copies made by view_eval.
+     *
+     * Inside a blas::scratch_scope the memory comes from the bump arena of
+     * the calling thread, so that temporaries created and destroyed in a
+     * loop stop calling malloc and free; outside of one, and for memory of
+     * another thread, it behaves as blas_allocator. Memory taken within a
+     * scope must be freed on the same thread, which holds for temporaries.
+     */
+    template <class T>
+    class scratch_allocator : public blas_allocator<T>
+    {
+    public:
+
+        template <class U>
+        struct rebind
+        {
+            using other = scratch_allocator<U>;
+        };
+
+        scratch_allocator() noexcept = default;
+
+        template <class U>
+        scratch_allocator(const scratch_allocator<U>&) noexcept
+        {
+        }
+
+        T* allocate(std::size_t n)
+        {
+            detail::scratch_arena& arena = detail::thread_scratch_arena();
+            if (arena.scopes == 0)
+            {
+                return blas_allocator<T>::allocate(n);
+            }
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(arena.allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept
+        {
+            if (p != nullptr && !detail::thread_scratch_arena().deallocate(p))
+            {
+                blas_allocator<T>::deallocate(p, n);
+            }
+        }
+    };
+
+    template <class T, class U>
+    inline bool operator==(const scratch_allocator<T>&, const scratch_allocator<U>&) noexcept
+    {
+        return true;
+    }
+
+    template <class T, class U>
+    inline bool operator!=(const scratch_allocator<T>&, const scratch_allocator<U>&) noexcept
+    {
+        return false;
+    }
+
+    /// Uninitialized buffer of the internal temporaries, see scratch_allocator
+    template <class T>
+    using scratch_buffer = uvector<T, scratch_allocator<T>>;
+
+namespace blas
+{
+    /**
+     * Requests transparent huge pages for the buffers of blas_allocator of
+     * at least \em bytes: they are aligned on 2 MiB and advised with
+     * ``madvise(MADV_HUGEPAGE)`` (Linux only), which cuts the TLB misses of
+     * products streaming through large matrices. 0, the default, disables
+     * the advice.
+     *
+     * @param bytes size threshold
+     */
+    inline void set_huge_page_threshold(std::size_t bytes)
+    {
+        detail::blas_allocation_settings_value().huge_page_threshold = bytes;
+    }
+
+    /**
+     * @return the size threshold of the huge page advice, 0 if disabled,
+     *         see \ref set_huge_page_threshold
+     */
+    inline std::size_t huge_page_threshold()
+    {
+        return detail::blas_allocation_settings_value().huge_page_threshold;
+    }
+
+    /**
+     * Enables the parallel first touch of the buffers of blas_allocator of
+     * at least 1 MiB: their pages are touched by get_num_threads() threads
+     * in contiguous slices at allocation, so that Linux places each slice
+     * on the NUMA node of the thread touching it instead of the node of
+     * the allocating thread. This only pays off when the BLAS threads are
+     * pinned (e.g. ``OMP_PROC_BIND=close``) in the same order. Disabled by
+     * default.
+     *
+     * @param enable whether to touch the buffers in parallel
+     */
+    inline void set_parallel_first_touch(bool enable)
+    {
+        detail::blas_allocation_settings_value().parallel_first_touch = enable;
+    }
+
+    /**
+     * @return whether the buffers of blas_allocator are first touched in
+     *         parallel, see \ref set_parallel_first_touch
+     */
+    inline bool parallel_first_touch()
+    {
+        return detail::blas_allocation_settings_value().parallel_first_touch;
+    }
+
+    /**
+     * Enables the scratch arena of the calling thread for its lifetime:
+     * the temporaries of the wrappers (copies made by view_eval, conversion
+     * blocks of mixed type products) are then bump allocated, and the
+     * arena is rewound whenever the last of them is freed. Wrap a loop
+     * calling the linear algebra functions in a scope:
+     *
+     * \code{.cpp}
+     * xt::blas::scratch_scope scope;
+     * for (...) { auto y = xt::linalg::dot(A, x - mean); }
+     * \endcode
+     *
+     * Scopes nest; the arena keeps its memory after the last one closes,
+     * until release_scratch is called.
+     */
+    class scratch_scope
+    {
+    public:
+
+        scratch_scope() noexcept
+        {
+            ++detail::thread_scratch_arena().scopes;
+        }
+
+        ~scratch_scope()
+        {
+            --detail::thread_scratch_arena().scopes;
+        }
+
+        scratch_scope(const scratch_scope&) = delete;
+        scratch_scope& operator=(const scratch_scope&) = delete;
+    };
+
+    /**
+     * @return the largest number of bytes the scratch arena of the calling
+     *         thread held at once, a size \ref reserve_scratch can be given
+     */
+    inline std::size_t scratch_high_water_mark()
+    {
+        return detail::thread_scratch_arena().high_water_mark;
+    }
+
+    inline void reset_scratch_high_water_mark()
+    {
+        detail::thread_scratch_arena().high_water_mark = 0;
+    }
+
+    /**
+     * Gives the scratch arena of the calling thread a single block of at
+     * least \em bytes, if none of its memory is in use, so that a loop
+     * whose high water mark is known never calls malloc.
+     *
+     * @param bytes size of the block
+     */
+    inline void reserve_scratch(std::size_t bytes)
+    {
+        detail::thread_scratch_arena().reserve(bytes);
+    }
+
+    /**
+     * @return the bytes of the blocks of the scratch arena of the calling thread
+     */
+    inline std::size_t scratch_capacity()
+    {
+        return detail::thread_scratch_arena().capacity();
+    }
+
+    /**
+     * Frees the blocks of the scratch arena of the calling thread, if none
+     * of its memory is in use.
+     */
+    inline void release_scratch()
+    {
+        detail::thread_scratch_arena().release();
+    }
+}
+}
+
+#endif
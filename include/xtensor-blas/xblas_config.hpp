@@ -14,20 +14,54 @@
 #define XTENSOR_BLAS_VERSION_MINOR 19
 #define XTENSOR_BLAS_VERSION_PATCH 0
 
+// before the driver selection, which the cling configuration makes
+#ifdef __CLING__
+#include "xtensor-blas/xblas_config_cling.hpp"
+#endif
+
 #ifndef XTENSOR_USE_FLENS_BLAS
 #define HAVE_CBLAS 1
 #endif
 
+// BLAS and LAPACK are loaded at runtime, see cxxblas/drivers/dynamicblas.h
+#if defined(XTENSOR_USE_DYNAMIC_BLAS) && !defined(WITH_DYNAMICBLAS)
+#define WITH_DYNAMICBLAS 1
+#endif
+
+// the generic kernels are also compiled for AVX2 and AVX-512 and selected
+// at runtime, see cxxblas/auxiliary/cpudispatch.h
+#if defined(XTENSOR_BLAS_CPU_DISPATCH) && !defined(CXXBLAS_CPU_DISPATCH) && \
+    (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define CXXBLAS_CPU_DISPATCH 1
+#endif
+
 #ifndef USE_CXXLAPACK
 #define USE_CXXLAPACK
 #endif
 
+// 64-bit integer BLAS/LAPACK, e.g. MKL ILP64 or OpenBLAS built with
+// INTERFACE64=1. XTENSOR_BLAS_SYMBOL_SUFFIX names the suffix of libraries
+// that export the ILP64 interface under separate symbols (64_ for OpenBLAS
+// built with SYMBOLSUFFIX=64_, such as the one shipped with Julia), so that
+// they can be linked into a process that also uses a LP64 BLAS.
+#ifdef XTENSOR_BLAS_ILP64
+#ifndef BLASINT
+#define BLASINT long
+#endif
 #ifndef BLAS_IDX
-#define BLAS_IDX int
+#define BLAS_IDX BLASINT
+#endif
+#if defined(WITH_MKLBLAS) && !defined(MKL_ILP64)
+#define MKL_ILP64 1
+#endif
 #endif
 
-#ifdef __CLING__
-#include "xtensor-blas/xblas_config_cling.hpp"
+#if defined(XTENSOR_BLAS_SYMBOL_SUFFIX) && !defined(CXXBLAS_SYMBOL_SUFFIX)
+#define CXXBLAS_SYMBOL_SUFFIX XTENSOR_BLAS_SYMBOL_SUFFIX
+#endif
+
+#ifndef BLAS_IDX
+#define BLAS_IDX int
 #endif
 
 namespace xt
@@ -0,0 +1,43 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XBLAS_CONFIG_CLING_HPP
+#define XBLAS_CONFIG_CLING_HPP
+
+#pragma cling add_library_path("/usr/local/lib64")
+#pragma cling add_library_path("/usr/local/lib32")
+#pragma cling add_library_path("/usr/local/lib")
+
+#ifndef XTENSOR_USE_FLENS_BLAS
+
+// By default BLAS and LAPACK are opened on the first call through the
+// runtime selected driver, so that including xlinalg.hpp neither loads
+// them nor has cling resolve their symbols. LAPACK is opened rather than
+// BLAS, its dependencies provide the BLAS symbols. XTENSOR_BLAS_LIBRARY
+// overrides the library, XTENSOR_BLAS_CLING_EAGER_LOAD restores the
+// libraries loaded with the header.
+#if !defined(XTENSOR_BLAS_CLING_EAGER_LOAD) && !defined(XTENSOR_USE_DYNAMIC_BLAS)
+#define XTENSOR_USE_DYNAMIC_BLAS 1
+#ifndef CXXBLAS_DYNAMIC_DEFAULT_LIBRARY
+#define CXXBLAS_DYNAMIC_DEFAULT_LIBRARY "/usr/local/lib/liblapack.so"
+#endif
+#endif
+
+#ifndef XTENSOR_USE_DYNAMIC_BLAS
+
+#define HAVE_CBLAS 1
+
+#pragma cling load("libblas")
+#pragma cling load("liblapack")
+
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,873 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XBLAS_CUDA_HPP
+#define XBLAS_CUDA_HPP
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <cublas_v2.h>
+#include <cuda_runtime.h>
+#include <cusolverDn.h>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xeval.hpp"
+#include "xtensor/xexpression.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas_config.hpp"
+
+#include "xflens/cxxblas/typedefs.h"
+
+namespace xt
+{
+namespace cuda
+{
+    namespace detail
+    {
+        inline std::size_t& offload_threshold_value()
+        {
+            static std::size_t threshold = 1024;
+            return threshold;
+        }
+
+        inline void check(cudaError_t status, const char* what)
+        {
+            if (status != cudaSuccess)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(what) + ": " + cudaGetErrorString(status));
+            }
+        }
+
+        inline void check(cublasStatus_t status, const char* what)
+        {
+            if (status != CUBLAS_STATUS_SUCCESS)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(what) + " failed with cuBLAS status " + std::to_string(int(status)));
+            }
+        }
+
+        inline void check(cusolverStatus_t status, const char* what)
+        {
+            if (status != CUSOLVER_STATUS_SUCCESS)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(what) + " failed with cuSOLVER status " + std::to_string(int(status)));
+            }
+        }
+
+        /**
+         * Device or page-locked host memory that only grows, so that
+         * repeated calls of the same sizes do not allocate.
+         */
+        class buffer
+        {
+        public:
+
+            explicit buffer(bool pinned) noexcept
+                : m_pinned(pinned)
+            {
+            }
+
+            ~buffer()
+            {
+                release();
+            }
+
+            buffer(const buffer&) = delete;
+            buffer& operator=(const buffer&) = delete;
+
+            char* get(std::size_t bytes)
+            {
+                if (bytes > m_capacity)
+                {
+                    release();
+                    void* p = nullptr;
+                    if (m_pinned)
+                    {
+                        check(cudaMallocHost(&p, bytes), "cudaMallocHost");
+                    }
+                    else
+                    {
+                        check(cudaMalloc(&p, bytes), "cudaMalloc");
+                    }
+                    m_data = static_cast<char*>(p);
+                    m_capacity = bytes;
+                }
+                return m_data;
+            }
+
+        private:
+
+            void release() noexcept
+            {
+                // errors are ignored, the CUDA runtime may already be shut
+                // down when thread-local contexts are destroyed at exit
+                if (m_data != nullptr)
+                {
+                    if (m_pinned)
+                    {
+                        cudaFreeHost(m_data);
+                    }
+                    else
+                    {
+                        cudaFree(m_data);
+                    }
+                }
+                m_data = nullptr;
+                m_capacity = 0;
+            }
+
+            char* m_data = nullptr;
+            std::size_t m_capacity = 0;
+            bool m_pinned;
+        };
+
+        /**
+         * Stream, cuBLAS and cuSOLVER handles and staging buffers of the
+         * calling thread. Each thread computes on its own stream, so calls
+         * from several threads overlap on the device.
+         */
+        class context
+        {
+        public:
+
+            static context& thread_local_instance()
+            {
+                static thread_local context ctx;
+                return ctx;
+            }
+
+            context()
+                : device(false), host(true)
+            {
+                check(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking), "cudaStreamCreateWithFlags");
+                check(cublasCreate(&blas), "cublasCreate");
+                check(cublasSetStream(blas, stream), "cublasSetStream");
+                check(cusolverDnCreate(&solver), "cusolverDnCreate");
+                check(cusolverDnSetStream(solver, stream), "cusolverDnSetStream");
+            }
+
+            ~context()
+            {
+                cusolverDnDestroy(solver);
+                cublasDestroy(blas);
+                cudaStreamDestroy(stream);
+            }
+
+            context(const context&) = delete;
+            context& operator=(const context&) = delete;
+
+            void synchronize()
+            {
+                check(cudaStreamSynchronize(stream), "cudaStreamSynchronize");
+            }
+
+            cudaStream_t stream;
+            cublasHandle_t blas;
+            cusolverDnHandle_t solver;
+            buffer device;
+            buffer host;
+        };
+
+        /**
+         * Offsets of the arrays of one call in a single allocation, each
+         * aligned for coalesced access.
+         */
+        class arena_layout
+        {
+        public:
+
+            template <class T>
+            std::size_t add(std::size_t n)
+            {
+                std::size_t offset = m_size;
+                m_size += (std::max(n, std::size_t(1)) * sizeof(T) + 255) / 256 * 256;
+                return offset;
+            }
+
+            std::size_t size() const noexcept
+            {
+                return m_size;
+            }
+
+        private:
+
+            std::size_t m_size = 0;
+        };
+
+        template <class T>
+        inline T* at(char* base, std::size_t offset)
+        {
+            return reinterpret_cast<T*>(base + offset);
+        }
+
+        template <class T>
+        struct cuda_value
+        {
+            using type = T;
+        };
+
+        template <>
+        struct cuda_value<std::complex<float>>
+        {
+            using type = cuComplex;
+        };
+
+        template <>
+        struct cuda_value<std::complex<double>>
+        {
+            using type = cuDoubleComplex;
+        };
+
+        template <class T>
+        using cuda_value_t = typename cuda_value<T>::type;
+
+        template <class T>
+        inline cuda_value_t<std::remove_const_t<T>>* cast(T* p)
+        {
+            return reinterpret_cast<cuda_value_t<std::remove_const_t<T>>*>(const_cast<std::remove_const_t<T>*>(p));
+        }
+
+        /**
+         * The cuBLAS and cuSOLVER routines of one value type.
+         */
+        template <class T>
+        struct routines;
+
+#define XTENSOR_CUDA_ROUTINES(T, R, P, H)                                                                  \
+        template <>                                                                                        \
+        struct routines<T>                                                                                 \
+        {                                                                                                  \
+            using real_type = R;                                                                           \
+            using cuda_type = cuda_value_t<T>;                                                             \
+                                                                                                           \
+            static cublasStatus_t gemm(cublasHandle_t h, cublasOperation_t ta, cublasOperation_t tb,       \
+                                       int m, int n, int k, const T* alpha, const T* A, int lda,           \
+                                       const T* B, int ldb, const T* beta, T* C, int ldc)                  \
+            {                                                                                              \
+                return cublas##P##gemm(h, ta, tb, m, n, k, cast(alpha), cast(A), lda, cast(B), ldb,        \
+                                       cast(beta), cast(C), ldc);                                          \
+            }                                                                                              \
+                                                                                                           \
+            static cublasStatus_t geam(cublasHandle_t h, cublasOperation_t ta, cublasOperation_t tb,       \
+                                       int m, int n, const T* alpha, const T* A, int lda, const T* beta,   \
+                                       const T* B, int ldb, T* C, int ldc)                                 \
+            {                                                                                              \
+                return cublas##P##geam(h, ta, tb, m, n, cast(alpha), cast(A), lda, cast(beta), cast(B),    \
+                                       ldb, cast(C), ldc);                                                 \
+            }                                                                                              \
+                                                                                                           \
+            static cusolverStatus_t getrf_buffer_size(cusolverDnHandle_t h, int n, T* A, int lda, int* lw) \
+            {                                                                                              \
+                return cusolverDn##P##getrf_bufferSize(h, n, n, cast(A), lda, lw);                         \
+            }                                                                                              \
+                                                                                                           \
+            static cusolverStatus_t getrf(cusolverDnHandle_t h, int n, T* A, int lda, T* work,             \
+                                          int* piv, int* info)                                             \
+            {                                                                                              \
+                return cusolverDn##P##getrf(h, n, n, cast(A), lda, cast(work), piv, info);                 \
+            }                                                                                              \
+                                                                                                           \
+            static cusolverStatus_t getrs(cusolverDnHandle_t h, int n, int nrhs, const T* A, int lda,      \
+                                          const int* piv, T* B, int ldb, int* info)                        \
+            {                                                                                              \
+                return cusolverDn##P##getrs(h, CUBLAS_OP_N, n, nrhs, cast(A), lda, piv, cast(B), ldb,      \
+                                            info);                                                         \
+            }                                                                                              \
+                                                                                                           \
+            static cusolverStatus_t eigh_buffer_size(cusolverDnHandle_t h, cusolverEigMode_t jobz,         \
+                                                     cublasFillMode_t uplo, int n, const T* A, int lda,    \
+                                                     const R* w, int* lw)                                  \
+            {                                                                                              \
+                return cusolverDn##P##H##evd_bufferSize(h, jobz, uplo, n, cast(A), lda, w, lw);            \
+            }                                                                                              \
+                                                                                                           \
+            static cusolverStatus_t eigh(cusolverDnHandle_t h, cusolverEigMode_t jobz,                     \
+                                         cublasFillMode_t uplo, int n, T* A, int lda, R* w, T* work,       \
+                                         int lw, int* info)                                                \
+            {                                                                                              \
+                return cusolverDn##P##H##evd(h, jobz, uplo, n, cast(A), lda, w, cast(work), lw, info);     \
+            }                                                                                              \
+                                                                                                           \
+            static cusolverStatus_t gesvd_buffer_size(cusolverDnHandle_t h, int m, int n, int* lw)         \
+            {                                                                                              \
+                return cusolverDn##P##gesvd_bufferSize(h, m, n, lw);                                       \
+            }                                                                                              \
+                                                                                                           \
+            static cusolverStatus_t gesvd(cusolverDnHandle_t h, signed char jobu, signed char jobvt,       \
+                                          int m, int n, T* A, int lda, R* s, T* U, int ldu, T* VT,         \
+                                          int ldvt, T* work, int lw, R* rwork, int* info)                  \
+            {                                                                                              \
+                return cusolverDn##P##gesvd(h, jobu, jobvt, m, n, cast(A), lda, s, cast(U), ldu,           \
+                                            cast(VT), ldvt, cast(work), lw, rwork, info);                  \
+            }                                                                                              \
+        };
+
+        XTENSOR_CUDA_ROUTINES(float, float, S, sy)
+        XTENSOR_CUDA_ROUTINES(double, double, D, sy)
+        XTENSOR_CUDA_ROUTINES(std::complex<float>, float, C, he)
+        XTENSOR_CUDA_ROUTINES(std::complex<double>, double, Z, he)
+
+#undef XTENSOR_CUDA_ROUTINES
+
+        template <class T>
+        struct is_offload_type
+            : std::integral_constant<bool, std::is_same<T, float>::value || std::is_same<T, double>::value ||
+                                               std::is_same<T, std::complex<float>>::value ||
+                                               std::is_same<T, std::complex<double>>::value>
+        {
+        };
+
+        template <class... I>
+        inline bool fits_int(I... sizes)
+        {
+            bool fits = true;
+            for (auto s : {static_cast<long long>(sizes)...})
+            {
+                fits = fits && s >= 0 && s <= std::numeric_limits<int>::max();
+            }
+            return fits;
+        }
+
+        inline bool above_threshold(std::size_t n)
+        {
+            return n >= offload_threshold_value();
+        }
+
+        /**
+         * Copies the rows x cols column-major matrix at \em src (leading
+         * dimension ld) to \em dst on the device, packed with leading
+         * dimension rows, through the page-locked buffer at \em staging.
+         * The copy is asynchronous; \em staging must stay untouched until
+         * the stream is synchronized.
+         */
+        template <class T>
+        inline void upload(context& ctx, const T* src, std::size_t ld, std::size_t rows, std::size_t cols,
+                           T* staging, T* dst)
+        {
+            if (ld == rows)
+            {
+                std::memcpy(staging, src, rows * cols * sizeof(T));
+            }
+            else
+            {
+                for (std::size_t j = 0; j < cols; ++j)
+                {
+                    std::memcpy(staging + j * rows, src + j * ld, rows * sizeof(T));
+                }
+            }
+            check(cudaMemcpyAsync(dst, staging, rows * cols * sizeof(T), cudaMemcpyHostToDevice, ctx.stream),
+                  "cudaMemcpyAsync");
+        }
+
+        template <class T>
+        inline void download(context& ctx, const T* src, std::size_t rows, std::size_t cols, T* staging)
+        {
+            check(cudaMemcpyAsync(staging, src, rows * cols * sizeof(T), cudaMemcpyDeviceToHost, ctx.stream),
+                  "cudaMemcpyAsync");
+        }
+
+        /// Copies a packed matrix from \em staging after the stream is synchronized.
+        template <class T>
+        inline void unstage(const T* staging, std::size_t rows, std::size_t cols, T* dst, std::size_t ld)
+        {
+            if (ld == rows)
+            {
+                std::memcpy(dst, staging, rows * cols * sizeof(T));
+            }
+            else
+            {
+                for (std::size_t j = 0; j < cols; ++j)
+                {
+                    std::memcpy(dst + j * ld, staging + j * rows, rows * sizeof(T));
+                }
+            }
+        }
+
+        inline cublasOperation_t cublas_op(cxxblas::Transpose t)
+        {
+            return t == cxxblas::Transpose::NoTrans ? CUBLAS_OP_N
+                                                    : (t == cxxblas::Transpose::Trans ? CUBLAS_OP_T : CUBLAS_OP_C);
+        }
+
+        template <class MA, class MB, class MC, class T, class I>
+        inline bool gemm(cxxblas::StorageOrder, cxxblas::Transpose, cxxblas::Transpose, I, I, I, const T&,
+                         const MA*, I, const MB*, I, const T&, MC*, I, std::false_type /*offload*/)
+        {
+            return false;
+        }
+
+        template <class T, class I>
+        inline bool gemm(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                         I m, I n, I k, const T& alpha, const T* A, I lda, const T* B, I ldb,
+                         const T& beta, T* C, I ldc, std::true_type /*offload*/)
+        {
+            if (!above_threshold(static_cast<std::size_t>(std::min({m, n, k}))) ||
+                trans_a == cxxblas::Transpose::Conj || trans_b == cxxblas::Transpose::Conj ||
+                !fits_int(m, n, k, lda, ldb, ldc))
+            {
+                return false;
+            }
+            if (order == cxxblas::StorageOrder::RowMajor)
+            {
+                // C^T = op(B)^T op(A)^T on the column-major transposes
+                std::swap(m, n);
+                std::swap(A, B);
+                std::swap(lda, ldb);
+                std::swap(trans_a, trans_b);
+            }
+
+            auto rows_a = static_cast<std::size_t>(trans_a == cxxblas::Transpose::NoTrans ? m : k);
+            auto cols_a = static_cast<std::size_t>(trans_a == cxxblas::Transpose::NoTrans ? k : m);
+            auto rows_b = static_cast<std::size_t>(trans_b == cxxblas::Transpose::NoTrans ? k : n);
+            auto cols_b = static_cast<std::size_t>(trans_b == cxxblas::Transpose::NoTrans ? n : k);
+            auto rows_c = static_cast<std::size_t>(m);
+            auto cols_c = static_cast<std::size_t>(n);
+
+            arena_layout layout;
+            std::size_t oa = layout.add<T>(rows_a * cols_a);
+            std::size_t ob = layout.add<T>(rows_b * cols_b);
+            std::size_t oc = layout.add<T>(rows_c * cols_c);
+
+            context& ctx = context::thread_local_instance();
+            char* dev = ctx.device.get(layout.size());
+            char* host = ctx.host.get(layout.size());
+
+            bool read_c = beta != T(0);
+            upload(ctx, A, std::size_t(lda), rows_a, cols_a, at<T>(host, oa), at<T>(dev, oa));
+            upload(ctx, B, std::size_t(ldb), rows_b, cols_b, at<T>(host, ob), at<T>(dev, ob));
+            if (read_c)
+            {
+                upload(ctx, C, std::size_t(ldc), rows_c, cols_c, at<T>(host, oc), at<T>(dev, oc));
+            }
+            check(routines<T>::gemm(ctx.blas, cublas_op(trans_a), cublas_op(trans_b), int(m), int(n), int(k),
+                                    &alpha, at<T>(dev, oa), int(rows_a), at<T>(dev, ob), int(rows_b),
+                                    &beta, at<T>(dev, oc), int(rows_c)),
+                  "gemm");
+            download(ctx, at<T>(dev, oc), rows_c, cols_c, at<T>(host, oc));
+            ctx.synchronize();
+            unstage(at<T>(host, oc), rows_c, cols_c, C, std::size_t(ldc));
+            return true;
+        }
+
+        /**
+         * Computes C := alpha * op(A) * op(B) + beta * C with cuBLAS if the
+         * types are supported and the product is at least as large as the
+         * offload threshold in every dimension.
+         * @return true if the product was computed
+         */
+        template <class MA, class MB, class MC, class T, class I>
+        inline bool gemm(cxxblas::StorageOrder order, cxxblas::Transpose trans_a, cxxblas::Transpose trans_b,
+                         I m, I n, I k, const T& alpha, const MA* A, I lda, const MB* B, I ldb,
+                         const T& beta, MC* C, I ldc)
+        {
+            using offload = std::integral_constant<bool, is_offload_type<T>::value && std::is_same<MA, T>::value &&
+                                                             std::is_same<MB, T>::value && std::is_same<MC, T>::value>;
+            return gemm(order, trans_a, trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, offload());
+        }
+
+        template <class T, class I, std::enable_if_t<!is_offload_type<T>::value>* = nullptr>
+        inline bool gesv(std::size_t, I, T*, I, T*, I, int&)
+        {
+            return false;
+        }
+
+        /**
+         * Solves A X = B by LU factorization with cuSOLVER (getrf, getrs)
+         * for A of order at least the offload threshold. A receives its LU
+         * factors and B the solution, as with LAPACK gesv.
+         * @return true if the system was solved, with the LAPACK info in \em info
+         */
+        template <class T, class I, std::enable_if_t<is_offload_type<T>::value>* = nullptr>
+        inline bool gesv(std::size_t n, I nrhs, T* A, I lda, T* B, I ldb, int& info)
+        {
+            if (!above_threshold(n) || !fits_int(n, nrhs, lda, ldb))
+            {
+                return false;
+            }
+            auto nr = static_cast<std::size_t>(nrhs);
+            context& ctx = context::thread_local_instance();
+
+            int lwork = 0;
+            check(routines<T>::getrf_buffer_size(ctx.solver, int(n), nullptr, int(n), &lwork), "getrf_bufferSize");
+
+            arena_layout layout;
+            std::size_t oa = layout.add<T>(n * n);
+            std::size_t ob = layout.add<T>(n * nr);
+            std::size_t ow = layout.add<T>(std::size_t(lwork));
+            std::size_t op = layout.add<int>(n);
+            std::size_t oi = layout.add<int>(1);
+
+            char* dev = ctx.device.get(layout.size());
+            char* host = ctx.host.get(layout.size());
+
+            upload(ctx, A, std::size_t(lda), n, n, at<T>(host, oa), at<T>(dev, oa));
+            upload(ctx, B, std::size_t(ldb), n, nr, at<T>(host, ob), at<T>(dev, ob));
+            check(routines<T>::getrf(ctx.solver, int(n), at<T>(dev, oa), int(n), at<T>(dev, ow),
+                                     at<int>(dev, op), at<int>(dev, oi)),
+                  "getrf");
+            check(routines<T>::getrs(ctx.solver, int(n), int(nr), at<T>(dev, oa), int(n), at<int>(dev, op),
+                                     at<T>(dev, ob), int(n), at<int>(dev, oi)),
+                  "getrs");
+            download(ctx, at<T>(dev, oa), n, n, at<T>(host, oa));
+            download(ctx, at<T>(dev, ob), n, nr, at<T>(host, ob));
+            download(ctx, at<int>(dev, oi), 1, 1, at<int>(host, oi));
+            ctx.synchronize();
+
+            // getrs runs on a singular factor too, the solution is then
+            // left alone as with LAPACK
+            info = *at<int>(host, oi);
+            unstage(at<T>(host, oa), n, n, A, std::size_t(lda));
+            if (info == 0)
+            {
+                unstage(at<T>(host, ob), n, nr, B, std::size_t(ldb));
+            }
+            return true;
+        }
+
+        template <class T, class W, class I, std::enable_if_t<!is_offload_type<T>::value>* = nullptr>
+        inline bool eigh(char, char, std::size_t, T*, I, W*, int&)
+        {
+            return false;
+        }
+
+        /**
+         * Eigenvalues, and with \em jobz 'V' eigenvectors, of a symmetric or
+         * Hermitian matrix with cuSOLVER syevd or heevd.
+         * @return true if computed, with the LAPACK info in \em info
+         */
+        template <class T, class W, class I, std::enable_if_t<is_offload_type<T>::value>* = nullptr>
+        inline bool eigh(char jobz, char uplo, std::size_t n, T* A, I lda, W* w, int& info)
+        {
+            using real_type = typename routines<T>::real_type;
+            static_assert(std::is_same<W, real_type>::value, "eigenvalues must be real");
+            if (!above_threshold(n) || !fits_int(n, lda))
+            {
+                return false;
+            }
+            context& ctx = context::thread_local_instance();
+            auto mode = jobz == 'V' ? CUSOLVER_EIG_MODE_VECTOR : CUSOLVER_EIG_MODE_NOVECTOR;
+            auto fill = uplo == 'U' ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER;
+
+            int lwork = 0;
+            check(routines<T>::eigh_buffer_size(ctx.solver, mode, fill, int(n), nullptr, int(n), nullptr, &lwork),
+                  "evd_bufferSize");
+
+            arena_layout layout;
+            std::size_t oa = layout.add<T>(n * n);
+            std::size_t ow = layout.add<real_type>(n);
+            std::size_t ok = layout.add<T>(std::size_t(lwork));
+            std::size_t oi = layout.add<int>(1);
+
+            char* dev = ctx.device.get(layout.size());
+            char* host = ctx.host.get(layout.size());
+
+            upload(ctx, A, std::size_t(lda), n, n, at<T>(host, oa), at<T>(dev, oa));
+            check(routines<T>::eigh(ctx.solver, mode, fill, int(n), at<T>(dev, oa), int(n), at<real_type>(dev, ow),
+                                    at<T>(dev, ok), lwork, at<int>(dev, oi)),
+                  "evd");
+            if (jobz == 'V')
+            {
+                download(ctx, at<T>(dev, oa), n, n, at<T>(host, oa));
+            }
+            download(ctx, at<real_type>(dev, ow), n, 1, at<real_type>(host, ow));
+            download(ctx, at<int>(dev, oi), 1, 1, at<int>(host, oi));
+            ctx.synchronize();
+
+            info = *at<int>(host, oi);
+            if (jobz == 'V')
+            {
+                unstage(at<T>(host, oa), n, n, A, std::size_t(lda));
+            }
+            std::memcpy(w, at<real_type>(host, ow), n * sizeof(real_type));
+            return true;
+        }
+
+        template <class T, class S, std::enable_if_t<!is_offload_type<T>::value>* = nullptr>
+        inline bool gesvd(char, std::size_t, std::size_t, T*, S*, T*, std::size_t, T*, std::size_t, int&)
+        {
+            return false;
+        }
+
+        /**
+         * Singular value decomposition of the column-major m x n matrix A
+         * (leading dimension m) with cuSOLVER gesvd, for m >= n only.
+         * \em jobz is 'A', 'S' or 'N' as for gesdd; U and VT receive the
+         * singular vectors with leading dimensions ldu and ldvt, and A is
+         * destroyed.
+         * @return true if computed, with the LAPACK info in \em info
+         */
+        template <class T, class S, std::enable_if_t<is_offload_type<T>::value>* = nullptr>
+        inline bool gesvd(char jobz, std::size_t m, std::size_t n, T* A, S* s, T* U, std::size_t ldu,
+                          T* VT, std::size_t ldvt, int& info)
+        {
+            using real_type = typename routines<T>::real_type;
+            std::size_t mn = std::min(m, n);
+            if (m < n || !above_threshold(mn) || (jobz != 'A' && jobz != 'S' && jobz != 'N') || !fits_int(m, n))
+            {
+                return false;
+            }
+            context& ctx = context::thread_local_instance();
+
+            int lwork = 0;
+            check(routines<T>::gesvd_buffer_size(ctx.solver, int(m), int(n), &lwork), "gesvd_bufferSize");
+
+            bool vectors = jobz != 'N';
+            std::size_t u_cols = jobz == 'A' ? m : mn;
+
+            arena_layout layout;
+            std::size_t oa = layout.add<T>(m * n);
+            std::size_t os = layout.add<real_type>(mn);
+            std::size_t ou = layout.add<T>(vectors ? m * u_cols : 1);
+            std::size_t ov = layout.add<T>(vectors ? n * n : 1);
+            std::size_t ok = layout.add<T>(std::size_t(lwork));
+            std::size_t orw = layout.add<real_type>(mn);
+            std::size_t oi = layout.add<int>(1);
+
+            char* dev = ctx.device.get(layout.size());
+            char* host = ctx.host.get(layout.size());
+
+            auto job = static_cast<signed char>(jobz);
+            upload(ctx, A, m, m, n, at<T>(host, oa), at<T>(dev, oa));
+            check(routines<T>::gesvd(ctx.solver, job, job, int(m), int(n), at<T>(dev, oa), int(m),
+                                     at<real_type>(dev, os), at<T>(dev, ou), int(m), at<T>(dev, ov), int(n),
+                                     at<T>(dev, ok), lwork, at<real_type>(dev, orw), at<int>(dev, oi)),
+                  "gesvd");
+            download(ctx, at<real_type>(dev, os), mn, 1, at<real_type>(host, os));
+            if (vectors)
+            {
+                download(ctx, at<T>(dev, ou), m, u_cols, at<T>(host, ou));
+                download(ctx, at<T>(dev, ov), n, n, at<T>(host, ov));
+            }
+            download(ctx, at<int>(dev, oi), 1, 1, at<int>(host, oi));
+            ctx.synchronize();
+
+            info = *at<int>(host, oi);
+            std::memcpy(s, at<real_type>(host, os), mn * sizeof(real_type));
+            if (vectors)
+            {
+                unstage(at<T>(host, ou), m, u_cols, U, ldu);
+                unstage(at<T>(host, ov), n, n, VT, ldvt);
+            }
+            return true;
+        }
+    }
+
+    /**
+     * Sets the size from which calls are computed on the GPU: gemm when m,
+     * n and k all reach it, gesv, syevd and heevd when the order of the
+     * matrix does, gesdd when min(m, n) does. Smaller problems do not
+     * amortize the transfers and stay on the CPU BLAS.
+     *
+     * @param n smallest offloaded dimension, std::numeric_limits<std::size_t>::max()
+     *        disables the offload
+     */
+    inline void set_offload_threshold(std::size_t n)
+    {
+        detail::offload_threshold_value() = n;
+    }
+
+    /// @return the smallest offloaded dimension, see \ref set_offload_threshold
+    inline std::size_t offload_threshold()
+    {
+        return detail::offload_threshold_value();
+    }
+
+    /// Waits for the GPU work queued by the calling thread.
+    inline void synchronize()
+    {
+        detail::context::thread_local_instance().synchronize();
+    }
+
+    /**
+     * Column-major matrix in device memory, to chain GPU products without
+     * copying the intermediate results back to the host.
+     *
+     * Operations run asynchronously on the stream of the calling thread;
+     * a matrix used from another thread needs a \ref synchronize first.
+     */
+    template <class T>
+    class device_matrix
+    {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+
+        device_matrix() = default;
+
+        device_matrix(size_type rows, size_type cols)
+            : m_rows(rows), m_cols(cols)
+        {
+            void* p = nullptr;
+            detail::check(cudaMalloc(&p, std::max(rows * cols, size_type(1)) * sizeof(T)), "cudaMalloc");
+            m_data = static_cast<T*>(p);
+        }
+
+        ~device_matrix()
+        {
+            if (m_data != nullptr)
+            {
+                cudaFree(m_data);
+            }
+        }
+
+        device_matrix(const device_matrix&) = delete;
+        device_matrix& operator=(const device_matrix&) = delete;
+
+        device_matrix(device_matrix&& rhs) noexcept
+            : m_data(rhs.m_data), m_rows(rhs.m_rows), m_cols(rhs.m_cols)
+        {
+            rhs.m_data = nullptr;
+            rhs.m_rows = rhs.m_cols = 0;
+        }
+
+        device_matrix& operator=(device_matrix&& rhs) noexcept
+        {
+            std::swap(m_data, rhs.m_data);
+            std::swap(m_rows, rhs.m_rows);
+            std::swap(m_cols, rhs.m_cols);
+            return *this;
+        }
+
+        size_type rows() const noexcept
+        {
+            return m_rows;
+        }
+
+        size_type cols() const noexcept
+        {
+            return m_cols;
+        }
+
+        T* data() noexcept
+        {
+            return m_data;
+        }
+
+        const T* data() const noexcept
+        {
+            return m_data;
+        }
+
+    private:
+
+        T* m_data = nullptr;
+        size_type m_rows = 0;
+        size_type m_cols = 0;
+    };
+
+    /**
+     * Copies a 2-D expression to the device.
+     * @return the matrix in device memory
+     */
+    template <class E>
+    inline auto to_device(const xexpression<E>& e)
+    {
+        using value_type = typename E::value_type;
+        static_assert(detail::is_offload_type<value_type>::value, "to_device: unsupported value type");
+        xtensor<value_type, 2, layout_type::column_major> h = e.derived_cast();
+        std::size_t rows = h.shape()[0], cols = h.shape()[1];
+        device_matrix<value_type> d(rows, cols);
+        auto& ctx = detail::context::thread_local_instance();
+        value_type* staging = reinterpret_cast<value_type*>(ctx.host.get(std::max(rows * cols, std::size_t(1)) * sizeof(value_type)));
+        detail::upload(ctx, h.data(), rows, rows, cols, staging, d.data());
+        ctx.synchronize();
+        return d;
+    }
+
+    /**
+     * Copies a device matrix back to the host, after the work queued on it
+     * by the calling thread.
+     */
+    template <class T>
+    inline xtensor<T, 2, layout_type::column_major> to_host(const device_matrix<T>& d)
+    {
+        xtensor<T, 2, layout_type::column_major> h;
+        h.resize({d.rows(), d.cols()});
+        auto& ctx = detail::context::thread_local_instance();
+        detail::check(cudaMemcpyAsync(h.data(), d.data(), d.rows() * d.cols() * sizeof(T),
+                                      cudaMemcpyDeviceToHost, ctx.stream),
+                      "cudaMemcpyAsync");
+        ctx.synchronize();
+        return h;
+    }
+
+    /**
+     * Copies a device matrix of one column, such as the singular values
+     * or eigenvalues computed on the device, back to the host.
+     */
+    template <class T>
+    inline xtensor<T, 1> to_host_vector(const device_matrix<T>& d)
+    {
+        xtensor<T, 1> h;
+        h.resize({d.rows() * d.cols()});
+        auto& ctx = detail::context::thread_local_instance();
+        detail::check(cudaMemcpyAsync(h.data(), d.data(), h.size() * sizeof(T), cudaMemcpyDeviceToHost, ctx.stream),
+                      "cudaMemcpyAsync");
+        ctx.synchronize();
+        return h;
+    }
+
+    /**
+     * C := alpha * op(A) * op(B) + beta * C on the device, queued on the
+     * stream of the calling thread.
+     *
+     * @param transpose_A use A^T, or A^H for complex types
+     * @param transpose_B use B^T, or B^H for complex types
+     */
+    template <class T>
+    inline void gemm(const device_matrix<T>& A, const device_matrix<T>& B, device_matrix<T>& C,
+                     bool transpose_A = false, bool transpose_B = false,
+                     const T& alpha = T(1), const T& beta = T(0))
+    {
+        std::size_t m = transpose_A ? A.cols() : A.rows();
+        std::size_t k = transpose_A ? A.rows() : A.cols();
+        std::size_t n = transpose_B ? B.rows() : B.cols();
+        if ((transpose_B ? B.cols() : B.rows()) != k || C.rows() != m || C.cols() != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "gemm: operand shapes do not match.");
+        }
+        if (!detail::fits_int(m, n, k))
+        {
+            XTENSOR_THROW(std::runtime_error, "gemm: dimension too large for cuBLAS.");
+        }
+        cublasOperation_t herm = xtl::is_complex<T>::value ? CUBLAS_OP_C : CUBLAS_OP_T;
+        auto& ctx = detail::context::thread_local_instance();
+        detail::check(detail::routines<T>::gemm(ctx.blas, transpose_A ? herm : CUBLAS_OP_N,
+                                                transpose_B ? herm : CUBLAS_OP_N, int(m), int(n), int(k), &alpha,
+                                                A.data(), int(std::max(A.rows(), std::size_t(1))), B.data(),
+                                                int(std::max(B.rows(), std::size_t(1))), &beta, C.data(),
+                                                int(std::max(m, std::size_t(1)))),
+                      "gemm");
+    }
+
+    /**
+     * Matrix product of two device matrices, left on the device.
+     */
+    template <class T>
+    inline device_matrix<T> dot(const device_matrix<T>& A, const device_matrix<T>& B)
+    {
+        device_matrix<T> C(A.rows(), B.cols());
+        gemm(A, B, C);
+        return C;
+    }
+}
+}
+
+#endif
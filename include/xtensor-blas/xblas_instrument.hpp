@@ -0,0 +1,289 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XBLAS_INSTRUMENT_HPP
+#define XBLAS_INSTRUMENT_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xlayout.hpp"
+
+/**
+ * Compiling with XTENSOR_BLAS_INSTRUMENT defined reports every BLAS and
+ * LAPACK call made by xtensor-blas, and every copy of an operand into
+ * BLAS storage order, to the sink set with xt::instrument::set_sink.
+ * Without it the hooks expand to nothing.
+ */
+#ifdef XTENSOR_BLAS_INSTRUMENT
+#define XTENSOR_BLAS_INSTRUMENT_CALL(...) \
+    ::xt::instrument::scoped_call xtensor_blas_instrumented_call_(__VA_ARGS__)
+#define XTENSOR_BLAS_INSTRUMENT_COPY(routine, e, layout) \
+    ::xt::instrument::scoped_call xtensor_blas_instrumented_copy_(::xt::instrument::copy_tag(), routine, e, layout)
+#else
+#define XTENSOR_BLAS_INSTRUMENT_CALL(...) ((void) 0)
+#define XTENSOR_BLAS_INSTRUMENT_COPY(routine, e, layout) ((void) 0)
+#endif
+
+namespace xt
+{
+namespace instrument
+{
+    /**
+     * An instrumented call: a BLAS or LAPACK routine, or a copy of an
+     * operand (``copy_to_layout``, ``view_eval`` or a BLAS operand copy).
+     *
+     * \em m, \em n and \em k are the sizes of the call as in the BLAS
+     * documentation (for copies, the rows and the columns of the operand
+     * and k = 0). \em trans_a and \em trans_b are the ops 'N', 'T' or 'C' of
+     * BLAS routines, the first job flags of LAPACK routines, or 0. \em flops
+     * is 0 when it is not counted.
+     */
+    struct call_record
+    {
+        const char* routine;
+        std::size_t m;
+        std::size_t n;
+        std::size_t k;
+        layout_type layout;
+        char trans_a;
+        char trans_b;
+        double flops;
+        std::size_t copy_bytes;
+        double seconds;
+    };
+
+    using sink_type = std::function<void(const call_record&)>;
+
+    namespace detail
+    {
+        inline sink_type& sink_instance()
+        {
+            static sink_type sink;
+            return sink;
+        }
+    }
+
+    /**
+     * Sets the function receiving the records of the instrumented calls,
+     * an empty function disables the recording.
+     *
+     * The sink is called from the threads making the calls. It must not be
+     * changed while other threads run xtensor-blas functions.
+     */
+    inline void set_sink(sink_type sink)
+    {
+        detail::sink_instance() = std::move(sink);
+    }
+
+    inline const sink_type& sink()
+    {
+        return detail::sink_instance();
+    }
+
+    /**
+     * Returns the floating point operations of \em fmas multiply-adds in
+     * type \em T.
+     */
+    template <class T>
+    inline double fma_flops(double fmas)
+    {
+        return (xtl::is_complex<T>::value ? 8. : 2.) * fmas;
+    }
+
+    struct copy_tag
+    {
+    };
+
+    /**
+     * Times its own lifetime and reports it to the sink on destruction.
+     */
+    class scoped_call
+    {
+    public:
+
+        scoped_call(const char* routine, std::size_t m, std::size_t n, std::size_t k,
+                    layout_type layout, char trans_a = 0, char trans_b = 0, double flops = 0.)
+            : m_record{routine, m, n, k, layout, trans_a, trans_b, flops, 0, 0.},
+              m_active(static_cast<bool>(sink()))
+        {
+            if (m_active)
+            {
+                m_start = clock_type::now();
+            }
+        }
+
+        template <class E>
+        scoped_call(copy_tag, const char* routine, const E& e, layout_type layout)
+            : scoped_call(routine, e.dimension() > 0 ? e.shape()[0] : 1, 1, 0, layout)
+        {
+            std::size_t size = 1;
+            for (std::size_t i = 0; i < e.dimension(); ++i)
+            {
+                size *= e.shape()[i];
+            }
+            m_record.n = m_record.m != 0 ? size / m_record.m : 0;
+            m_record.copy_bytes = size * sizeof(typename E::value_type);
+        }
+
+        ~scoped_call()
+        {
+            if (m_active)
+            {
+                m_record.seconds = std::chrono::duration<double>(clock_type::now() - m_start).count();
+                sink()(m_record);
+            }
+        }
+
+        scoped_call(const scoped_call&) = delete;
+        scoped_call& operator=(const scoped_call&) = delete;
+
+    private:
+
+        using clock_type = std::chrono::steady_clock;
+
+        call_record m_record;
+        clock_type::time_point m_start;
+        bool m_active;
+    };
+
+    /**
+     * Accumulates call records per routine, shape, layout and transposes.
+     *
+     * \code{.cpp}
+     * xt::instrument::aggregator stats;
+     * xt::instrument::set_sink(stats.as_sink());
+     * // ... run the workload
+     * xt::instrument::set_sink({});
+     * stats.dump(std::cout);
+     * \endcode
+     */
+    class aggregator
+    {
+    public:
+
+        struct entry
+        {
+            std::size_t calls;
+            double seconds;
+            double flops;
+            std::size_t copy_bytes;
+        };
+
+        using key_type = std::tuple<std::string, std::size_t, std::size_t, std::size_t, layout_type, char, char>;
+
+        void record(const call_record& r);
+
+        /**
+         * Returns a sink recording into this aggregator, which must outlive
+         * its use.
+         */
+        sink_type as_sink();
+
+        std::map<key_type, entry> entries() const;
+        void clear();
+
+        /**
+         * Writes one line per shape, the most expensive first, with the
+         * number of calls, the total and mean time, the GFLOP/s and the
+         * bytes copied.
+         */
+        void dump(std::ostream& out) const;
+
+    private:
+
+        mutable std::mutex m_mutex;
+        std::map<key_type, entry> m_entries;
+    };
+
+    inline void aggregator::record(const call_record& r)
+    {
+        key_type key(r.routine, r.m, r.n, r.k, r.layout, r.trans_a, r.trans_b);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        entry& e = m_entries[key];
+        e.calls += 1;
+        e.seconds += r.seconds;
+        e.flops += r.flops;
+        e.copy_bytes += r.copy_bytes;
+    }
+
+    inline sink_type aggregator::as_sink()
+    {
+        return [this](const call_record& r) { record(r); };
+    }
+
+    inline auto aggregator::entries() const -> std::map<key_type, entry>
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries;
+    }
+
+    inline void aggregator::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+    }
+
+    inline void aggregator::dump(std::ostream& out) const
+    {
+        auto all = entries();
+        using value_type = std::pair<key_type, entry>;
+        std::vector<value_type> sorted(all.begin(), all.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [](const value_type& a, const value_type& b) {
+            return a.second.seconds > b.second.seconds;
+        });
+
+        auto layout_name = [](layout_type l) {
+            return l == layout_type::row_major ? 'R' : (l == layout_type::column_major ? 'C' : '-');
+        };
+        auto trans_name = [](char t) { return t == 0 ? '-' : t; };
+
+        out << std::left << std::setw(16) << "routine" << std::right
+            << std::setw(8) << "m" << std::setw(8) << "n" << std::setw(8) << "k"
+            << std::setw(7) << "layout" << std::setw(6) << "op"
+            << std::setw(10) << "calls" << std::setw(14) << "total [s]" << std::setw(14) << "mean [us]"
+            << std::setw(10) << "GFLOP/s" << std::setw(14) << "copied [B]" << '\n';
+        for (const auto& v : sorted)
+        {
+            const key_type& k = v.first;
+            const entry& e = v.second;
+            out << std::left << std::setw(16) << std::get<0>(k) << std::right
+                << std::setw(8) << std::get<1>(k) << std::setw(8) << std::get<2>(k) << std::setw(8) << std::get<3>(k)
+                << std::setw(7) << layout_name(std::get<4>(k))
+                << std::setw(5) << trans_name(std::get<5>(k)) << trans_name(std::get<6>(k))
+                << std::setw(10) << e.calls
+                << std::setw(14) << std::setprecision(6) << e.seconds
+                << std::setw(14) << std::setprecision(4) << e.seconds * 1e6 / double(e.calls);
+            if (e.flops > 0. && e.seconds > 0.)
+            {
+                out << std::setw(10) << std::setprecision(4) << e.flops * 1e-9 / e.seconds;
+            }
+            else
+            {
+                out << std::setw(10) << '-';
+            }
+            out << std::setw(14) << e.copy_bytes << '\n';
+        }
+    }
+}
+}
+
+#endif
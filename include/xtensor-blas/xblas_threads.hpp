@@ -0,0 +1,156 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XBLAS_THREADS_HPP
+#define XBLAS_THREADS_HPP
+
+#include <utility>
+
+#include "xtensor-blas/xblas_config.hpp"
+#include "xflens/cxxblas/cxxblas_core.cxx"
+
+namespace xt
+{
+namespace detail
+{
+    struct blas_threads_state
+    {
+        int vendor;
+        int generic;
+    };
+
+    /**
+     * Sets the thread count of the BLAS library selected by the cxxblas
+     * driver macros (WITH_OPENBLAS, WITH_MKLBLAS, WITH_BLIS) and of the generic
+     * cxxblas kernels, and returns the previous settings.
+     */
+    inline blas_threads_state set_blas_num_threads(int n)
+    {
+        blas_threads_state previous = {0, cxxblas::detail::num_threads_setting()};
+        cxxblas::set_num_threads(n);
+#if defined(WITH_OPENBLAS)
+        previous.vendor = openblas_get_num_threads();
+        openblas_set_num_threads(n);
+#elif defined(WITH_MKLBLAS)
+        // thread-local in MKL, 0 falls back to the global setting
+        previous.vendor = MKL_Set_Num_Threads_Local(n);
+#elif defined(WITH_BLIS)
+        // thread-local runtime (rntm_t) of the calling thread
+        previous.vendor = static_cast<int>(bli_thread_get_num_threads());
+        bli_thread_set_num_threads(n);
+#elif defined(WITH_DYNAMICBLAS)
+        previous.vendor = cxxblas::dynamic::setNumThreads(n);
+#endif
+        return previous;
+    }
+
+    inline void restore_blas_num_threads(const blas_threads_state& state)
+    {
+        cxxblas::set_num_threads(state.generic);
+#if defined(WITH_OPENBLAS)
+        openblas_set_num_threads(state.vendor);
+#elif defined(WITH_MKLBLAS)
+        MKL_Set_Num_Threads_Local(state.vendor);
+#elif defined(WITH_BLIS)
+        bli_thread_set_num_threads(state.vendor);
+#elif defined(WITH_DYNAMICBLAS)
+        cxxblas::dynamic::setNumThreads(state.vendor);
+#endif
+    }
+}
+
+namespace blas
+{
+    /**
+     * Sets the number of threads used by BLAS calls.
+     *
+     * With OpenBLAS this is a process-wide setting, with MKL it
+     * applies to the calling thread only (``mkl_set_num_threads_local``),
+     * as with BLIS 0.9 and later, whose runtime is thread-local.
+     * With XTENSOR_USE_DYNAMIC_BLAS the loaded library is detected at
+     * runtime.
+     * Other vendor libraries (e.g. vecLib) are not controlled. The generic
+     * kernels used with XTENSOR_USE_FLENS_BLAS, or for types the vendor
+     * BLAS does not support, follow the setting process-wide.
+     *
+     * @param n number of threads, 0 restores the library default (MKL and
+     *        the generic kernels only)
+     */
+    inline void set_num_threads(int n)
+    {
+        detail::set_blas_num_threads(n);
+    }
+
+    /**
+     * @return the number of threads used by BLAS calls of the calling
+     *         thread, or by the generic kernels if the library is not
+     *         controlled, see \ref set_num_threads
+     */
+    inline int get_num_threads()
+    {
+#if defined(WITH_OPENBLAS)
+        return openblas_get_num_threads();
+#elif defined(WITH_MKLBLAS)
+        return MKL_Get_Max_Threads();
+#elif defined(WITH_BLIS)
+        int n = static_cast<int>(bli_thread_get_num_threads());
+        return n > 0 ? n : cxxblas::get_num_threads();
+#elif defined(WITH_DYNAMICBLAS)
+        int n = cxxblas::dynamic::getNumThreads();
+        return n > 0 ? n : cxxblas::get_num_threads();
+#else
+        return cxxblas::get_num_threads();
+#endif
+    }
+
+    /**
+     * Sets the number of BLAS threads for its lifetime and restores the
+     * previous setting on destruction. Use ``scoped_num_threads guard(1);``
+     * around calls on small problems, or from the workers of an
+     * application thread pool, to keep BLAS from oversubscribing the cores.
+     */
+    class scoped_num_threads
+    {
+    public:
+
+        explicit scoped_num_threads(int n)
+            : m_previous(detail::set_blas_num_threads(n))
+        {
+        }
+
+        ~scoped_num_threads()
+        {
+            detail::restore_blas_num_threads(m_previous);
+        }
+
+        scoped_num_threads(const scoped_num_threads&) = delete;
+        scoped_num_threads& operator=(const scoped_num_threads&) = delete;
+
+    private:
+
+        detail::blas_threads_state m_previous;
+    };
+
+    /**
+     * Calls \em f with the BLAS thread count set to \em n.
+     *
+     * @param n number of threads, e.g. 1 to run the call single-threaded
+     * @param f callable, e.g. a lambda calling linalg::dot
+     * @return the result of f()
+     */
+    template <class F>
+    inline decltype(auto) with_num_threads(int n, F&& f)
+    {
+        scoped_num_threads guard(n);
+        return std::forward<F>(f)();
+    }
+}
+}
+
+#endif
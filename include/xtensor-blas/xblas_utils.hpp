@@ -10,14 +10,35 @@
 #ifndef XBLAS_UTILS_HPP
 #define XBLAS_UTILS_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
 #include <stdexcept>
+#include <string>
 #include <tuple>
 #include <type_traits>
+#include <typeinfo>
 
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+#include "xtensor-blas/xblas_allocator.hpp"
 #include "xtensor-blas/xblas_config.hpp"
+#include "xtensor-blas/xblas_instrument.hpp"
 #include "xflens/cxxblas/typedefs.h"
 #include "xtensor/xutils.hpp"
 
+#ifdef XTENSOR_BLAS_COPY_DIAGNOSTICS
+#define XTENSOR_BLAS_DIAGNOSE_COPY(helper, e) ::xt::detail::report_copy(helper, e)
+#else
+#define XTENSOR_BLAS_DIAGNOSE_COPY(helper, e) ((void) 0)
+#endif
+
 #ifndef DEFAULT_LEADING_STRIDE_BEHAVIOR
 #define DEFAULT_LEADING_STRIDE_BEHAVIOR XTENSOR_THROW(std::runtime_error, "No valid layout chosen.");
 #endif
@@ -28,6 +49,253 @@
 
 namespace xt
 {
+    /********************
+     * BLAS index casts *
+     ********************/
+
+    namespace detail
+    {
+        template <class T>
+        inline bool fits_blas_index(T value, std::true_type /*is_signed*/)
+        {
+            return static_cast<std::intmax_t>(value) >= std::intmax_t(std::numeric_limits<blas_index_t>::min())
+                   && static_cast<std::intmax_t>(value) <= std::intmax_t(std::numeric_limits<blas_index_t>::max());
+        }
+
+        template <class T>
+        inline bool fits_blas_index(T value, std::false_type /*is_signed*/)
+        {
+            return static_cast<std::uintmax_t>(value) <= std::uintmax_t(std::numeric_limits<blas_index_t>::max());
+        }
+    }
+
+    /**
+     * Converts a dimension, stride or count to the BLAS integer type.
+     *
+     * @param value the value to convert
+     * @return \em value as blas_index_t
+     * @throws std::overflow_error if \em value is not representable, i.e. for
+     *         dimensions of 2^31 and more unless built for an ILP64 BLAS
+     *         (XTENSOR_BLAS_ILP64)
+     */
+    template <class T>
+    inline blas_index_t to_blas_index(T value)
+    {
+        if (!detail::fits_blas_index(value, std::is_signed<T>()))
+        {
+            XTENSOR_THROW(std::overflow_error, "Dimension exceeds the range of the BLAS integer type (see XTENSOR_BLAS_ILP64).");
+        }
+        return static_cast<blas_index_t>(value);
+    }
+
+    /********************
+     * Copy diagnostics *
+     ********************/
+
+    /**
+     * Number and total size of the copies made by view_eval,
+     * copy_to_layout and the BLAS operand preparation since the last
+     * reset_copy_statistics. Only counted with XTENSOR_BLAS_COPY_DIAGNOSTICS.
+     */
+    struct copy_statistics
+    {
+        std::size_t copies;
+        std::size_t bytes;
+    };
+
+    namespace detail
+    {
+        inline std::atomic<std::size_t>& copy_count()
+        {
+            static std::atomic<std::size_t> count(0);
+            return count;
+        }
+
+        inline std::atomic<std::size_t>& copy_bytes()
+        {
+            static std::atomic<std::size_t> bytes(0);
+            return bytes;
+        }
+
+        inline std::atomic<bool>& copy_warnings()
+        {
+            static std::atomic<bool> enabled(false);
+            return enabled;
+        }
+
+        inline std::string demangle(const char* name)
+        {
+#if defined(__GNUG__)
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+            if (status == 0 && demangled != nullptr)
+            {
+                std::string result(demangled);
+                std::free(demangled);
+                return result;
+            }
+#endif
+            return name;
+        }
+
+        template <class E>
+        inline void report_copy(const char* helper, const E& e)
+        {
+            std::size_t size = 1;
+            for (std::size_t i = 0; i < e.dimension(); ++i)
+            {
+                size *= e.shape()[i];
+            }
+            std::size_t bytes = size * sizeof(typename E::value_type);
+            copy_count().fetch_add(1, std::memory_order_relaxed);
+            copy_bytes().fetch_add(bytes, std::memory_order_relaxed);
+            if (copy_warnings().load(std::memory_order_relaxed))
+            {
+                std::cerr << "xtensor-blas: " << helper << " copies " << bytes << " bytes of "
+                          << demangle(typeid(E).name()) << std::endl;
+            }
+        }
+
+        // false with XTENSOR_BLAS_STATIC_NO_COPY, dependent on E so that
+        // only the instantiated copies fail
+        template <class E>
+        struct view_eval_copy_allowed
+#ifdef XTENSOR_BLAS_STATIC_NO_COPY
+            : std::false_type
+#else
+            : std::true_type
+#endif
+        {
+        };
+    }
+
+    /**
+     * @return the copies counted since the last reset
+     */
+    inline copy_statistics get_copy_statistics()
+    {
+        return {detail::copy_count().load(), detail::copy_bytes().load()};
+    }
+
+    inline void reset_copy_statistics()
+    {
+        detail::copy_count() = 0;
+        detail::copy_bytes() = 0;
+    }
+
+    /**
+     * Enables writing a line to std::cerr, with the helper, the size and
+     * the type of the copied expression, for every counted copy.
+     */
+    inline void set_copy_warnings(bool enabled)
+    {
+        detail::copy_warnings() = enabled;
+    }
+
+    namespace detail
+    {
+        // edge of the square tiles of transpose_copy
+        constexpr std::size_t transpose_copy_tile = 32;
+
+        // smaller 2-D copies are left to the xtensor assignment
+        constexpr std::size_t transpose_copy_min_size = 4096;
+
+        // elements from which transpose_copy shares the tiles between OpenMP threads
+        constexpr std::size_t transpose_copy_parallel_size = std::size_t(1) << 18;
+
+        /**
+         * Copies the m-by-n matrix at \em src, element (i, j) at
+         * i * s0 + j * s1, into the column-major \em dst of leading
+         * dimension \em ldd, tile by tile: the source lines of a tile stay
+         * in cache while it is written column by column, instead of
+         * streaming through the whole matrix for every column when the
+         * source is stored by rows.
+         */
+        template <class T, class U>
+        inline void transpose_copy(const T* src, std::ptrdiff_t s0, std::ptrdiff_t s1, std::size_t m, std::size_t n,
+                                   U* dst, std::size_t ldd)
+        {
+            constexpr std::size_t tile = transpose_copy_tile;
+            std::ptrdiff_t tiles = static_cast<std::ptrdiff_t>((n + tile - 1) / tile);
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for if(m * n >= transpose_copy_parallel_size)
+#endif
+            for (std::ptrdiff_t t = 0; t < tiles; ++t)
+            {
+                std::size_t j0 = static_cast<std::size_t>(t) * tile;
+                std::size_t j1 = std::min(j0 + tile, n);
+                for (std::size_t i0 = 0; i0 < m; i0 += tile)
+                {
+                    std::size_t i1 = std::min(i0 + tile, m);
+                    for (std::size_t j = j0; j < j1; ++j)
+                    {
+                        const T* s = src + static_cast<std::ptrdiff_t>(j) * s1;
+                        U* d = dst + j * ldd;
+                        for (std::size_t i = i0; i < i1; ++i)
+                        {
+                            d[i] = s[static_cast<std::ptrdiff_t>(i) * s0];
+                        }
+                    }
+                }
+            }
+        }
+
+        template <class R, class E>
+        inline R layout_copy(const E& e, std::false_type /*has_data_interface*/)
+        {
+            return R(e);
+        }
+
+        /**
+         * Copy of \em e in the container type \em R made by view_eval and
+         * copy_to_layout. A matrix whose fastest axis is not that of \em R,
+         * e.g. a row-major matrix copied to column-major storage for LAPACK,
+         * goes through transpose_copy; any other copy is an assignment.
+         */
+        template <class R, class E>
+        inline R layout_copy(const E& e, std::true_type /*has_data_interface*/)
+        {
+            if (e.dimension() != 2 || e.size() < transpose_copy_min_size)
+            {
+                return R(e);
+            }
+            std::size_t m = e.shape()[0];
+            std::size_t n = e.shape()[1];
+            std::ptrdiff_t s0 = static_cast<std::ptrdiff_t>(e.strides()[0]);
+            std::ptrdiff_t s1 = static_cast<std::ptrdiff_t>(e.strides()[1]);
+            bool source_by_rows = std::abs(s1) <= std::abs(s0);
+            bool result_by_rows = R::static_layout != layout_type::column_major;
+            if (source_by_rows == result_by_rows)
+            {
+                return R(e);
+            }
+            R result = R::from_shape(e.shape());
+            const auto* src = e.data() + e.data_offset();
+            if (result_by_rows)
+            {
+                // the row-major result is the column-major storage of the transpose
+                transpose_copy(src, s1, s0, n, m, result.data(), n);
+            }
+            else
+            {
+                transpose_copy(src, s0, s1, m, n, result.data(), m);
+            }
+            return result;
+        }
+    }
+
+    /**
+     * True if view_eval<L> copies an expression of type \em E, i.e. if it
+     * has no data interface or another static layout than \em L. Meant for
+     * static_asserts in hot code.
+     */
+    template <class E, layout_type L = std::decay_t<E>::static_layout>
+    struct view_eval_copies
+        : std::integral_constant<bool, !(has_data_interface<std::decay_t<E>>::value
+                                         && std::decay_t<E>::static_layout == L)>
+    {
+    };
+
     template <layout_type L = layout_type::row_major, class T>
     inline auto view_eval(T&& t)
         -> std::enable_if_t<has_data_interface<std::decay_t<T>>::value && std::decay_t<T>::static_layout == L, T&&>
@@ -41,41 +309,206 @@ namespace xt
                             && detail::is_array<typename I::shape_type>::value,
                             xtensor<typename I::value_type,
                                     std::tuple_size<typename I::shape_type>::value,
-                                    layout_remove_any(L)>>
+                                    layout_remove_any(L),
+                                    scratch_allocator<typename I::value_type>>>
     {
-        return t;
+        static_assert(detail::view_eval_copy_allowed<I>::value,
+                      "view_eval copies this expression (XTENSOR_BLAS_STATIC_NO_COPY): evaluate it into a container "
+                      "of the expected static layout first.");
+        XTENSOR_BLAS_INSTRUMENT_COPY("view_eval", t, layout_remove_any(L));
+        XTENSOR_BLAS_DIAGNOSE_COPY("view_eval", t);
+        using result_type = xtensor<typename I::value_type, std::tuple_size<typename I::shape_type>::value, layout_remove_any(L),
+                                    scratch_allocator<typename I::value_type>>;
+        return detail::layout_copy<result_type>(t, has_data_interface<I>());
     }
 
     template <layout_type L = layout_type::row_major, class T, class I = std::decay_t<T>>
     inline auto view_eval(T&& t)
         -> std::enable_if_t<(!has_data_interface<std::decay_t<T>>::value || I::static_layout != L) &&
                             !detail::is_array<typename I::shape_type>::value,
-                            xarray<typename I::value_type, layout_remove_any(L)>>
+                            xarray<typename I::value_type, layout_remove_any(L), scratch_allocator<typename I::value_type>>>
     {
-        return t;
+        static_assert(detail::view_eval_copy_allowed<I>::value,
+                      "view_eval copies this expression (XTENSOR_BLAS_STATIC_NO_COPY): evaluate it into a container "
+                      "of the expected static layout first.");
+        XTENSOR_BLAS_INSTRUMENT_COPY("view_eval", t, layout_remove_any(L));
+        XTENSOR_BLAS_DIAGNOSE_COPY("view_eval", t);
+        using result_type = xarray<typename I::value_type, layout_remove_any(L), scratch_allocator<typename I::value_type>>;
+        return detail::layout_copy<result_type>(t, has_data_interface<I>());
     }
 
+    /**
+     * Returns \em t, copied by the caller into a container of layout \em L
+     * if it already has one, or else \em t evaluated in a new container of
+     * layout \em L. Expressions without a data interface, such as an
+     * xfunction right-hand side, are evaluated straight into the new
+     * container (the buffer LAPACK then overwrites) in a single pass.
+     */
     template <layout_type L = layout_type::row_major, class T>
     inline auto copy_to_layout(T&& t)
-        -> std::enable_if_t<std::decay_t<T>::static_layout == L, T>
+        -> std::enable_if_t<has_data_interface<std::decay_t<T>>::value && std::decay_t<T>::static_layout == L, T>
     {
         return t;
     }
 
     template <layout_type L = layout_type::row_major, class T, class I = std::decay_t<T>>
     inline auto copy_to_layout(T&& t)
-        -> std::enable_if_t<std::decay_t<T>::static_layout != L && detail::is_array<typename I::shape_type>::value,
+        -> std::enable_if_t<(!has_data_interface<I>::value || I::static_layout != L) &&
+                            detail::is_array<typename I::shape_type>::value,
                             xtensor<typename I::value_type, std::tuple_size<typename I::shape_type>::value, L>>
     {
-        return t;
+        XTENSOR_BLAS_INSTRUMENT_COPY("copy_to_layout", t, L);
+        XTENSOR_BLAS_DIAGNOSE_COPY("copy_to_layout", t);
+        using result_type = xtensor<typename I::value_type, std::tuple_size<typename I::shape_type>::value, L>;
+        return detail::layout_copy<result_type>(t, has_data_interface<I>());
     }
 
     template <layout_type L = layout_type::row_major, class T, class I = std::decay_t<T>>
     inline auto copy_to_layout(T&& t)
-        -> std::enable_if_t<std::decay_t<T>::static_layout != L && !detail::is_array<typename I::shape_type>::value,
+        -> std::enable_if_t<(!has_data_interface<I>::value || I::static_layout != L) &&
+                            !detail::is_array<typename I::shape_type>::value,
                             xarray<typename I::value_type, L>>
     {
-        return t;
+        XTENSOR_BLAS_INSTRUMENT_COPY("copy_to_layout", t, L);
+        XTENSOR_BLAS_DIAGNOSE_COPY("copy_to_layout", t);
+        return detail::layout_copy<xarray<typename I::value_type, L>>(t, has_data_interface<I>());
+    }
+
+    /*****************************
+     * Strided 2-D storage order *
+     *****************************/
+
+    namespace detail
+    {
+        /**
+         * Storage order in which BLAS can read the 2-D strided expression \em e
+         * through a pointer and a leading dimension: row_major if the last axis
+         * has unit stride, column_major if the first one has, dynamic if neither
+         * (or if \em e is not 2-D). Axes of length 1 can have any stride.
+         */
+        template <class E>
+        inline layout_type blas_strided_layout(const E& e)
+        {
+            if (e.dimension() != 2)
+            {
+                return layout_type::dynamic;
+            }
+
+            using stride_type = std::ptrdiff_t;
+            stride_type m = static_cast<stride_type>(e.shape()[0]);
+            stride_type n = static_cast<stride_type>(e.shape()[1]);
+            stride_type s0 = static_cast<stride_type>(e.strides()[0]);
+            stride_type s1 = static_cast<stride_type>(e.strides()[1]);
+
+            if ((n <= 1 || s1 == 1) && (m <= 1 || s0 >= std::max(n, stride_type(1))))
+            {
+                return layout_type::row_major;
+            }
+            if ((m <= 1 || s0 == 1) && (n <= 1 || s1 >= std::max(m, stride_type(1))))
+            {
+                return layout_type::column_major;
+            }
+            return layout_type::dynamic;
+        }
+
+        /**
+         * Leading dimension of the 2-D strided expression \em e read in
+         * storage order \em l, as returned by blas_strided_layout.
+         */
+        template <class E>
+        inline blas_index_t blas_strided_ld(const E& e, layout_type l)
+        {
+            std::size_t m = e.shape()[0];
+            std::size_t n = e.shape()[1];
+            if (l == layout_type::row_major)
+            {
+                return m <= 1 ? to_blas_index(std::max(n, std::size_t(1)))
+                              : to_blas_index(e.strides()[0]);
+            }
+            return n <= 1 ? to_blas_index(std::max(m, std::size_t(1)))
+                          : to_blas_index(e.strides()[1]);
+        }
+
+        template <class T>
+        struct blas_matrix_operand
+        {
+            const T* data;
+            blas_index_t ld;
+            bool transposed;
+        };
+
+        template <layout_type L, class E, class C>
+        inline auto get_matrix_operand(const E& e, C& copy, std::false_type /*has_data_interface*/)
+        {
+            XTENSOR_BLAS_INSTRUMENT_COPY("operand_copy", e, L);
+            XTENSOR_BLAS_DIAGNOSE_COPY("operand_copy", e);
+            copy = e;
+            return blas_matrix_operand<typename C::value_type>{copy.data(), blas_strided_ld(copy, L), false};
+        }
+
+        /**
+         * Pointer, leading dimension and transposition flag with which a BLAS
+         * call of storage order L reads the 2-D expression \em e. Strided
+         * views with one unit stride are passed through; \em e is copied
+         * into \em copy only when its strides cannot be described that way.
+         * \em transposed is set when \em e is stored in the other order, in
+         * which case the call must flip the op applied to the operand.
+         */
+        template <layout_type L, class E, class C>
+        inline auto get_matrix_operand(const E& e, C& copy, std::true_type /*has_data_interface*/)
+        {
+            layout_type l = blas_strided_layout(e);
+            if (l == layout_type::dynamic)
+            {
+                return get_matrix_operand<L>(e, copy, std::false_type());
+            }
+            return blas_matrix_operand<typename C::value_type>{e.data() + e.data_offset(), blas_strided_ld(e, l), l != L};
+        }
+
+        /**
+         * Like get_matrix_operand, for routines that cannot fold a
+         * transposition into their op flags: operands stored in the other
+         * order than L are copied.
+         */
+        template <layout_type L, class E, class C, class D>
+        inline auto get_ordered_matrix_operand(const E& e, C& copy, D tag)
+        {
+            auto op = get_matrix_operand<L>(e, copy, tag);
+            if (op.transposed)
+            {
+                op = get_matrix_operand<L>(e, copy, std::false_type());
+            }
+            return op;
+        }
+
+        inline cxxblas::StorageUpLo blas_uplo(char uplo)
+        {
+            return (uplo == 'U' || uplo == 'u') ? cxxblas::StorageUpLo::Upper : cxxblas::StorageUpLo::Lower;
+        }
+
+        /**
+         * BLAS sees a matrix stored in the other order as its transpose, whose
+         * triangles are swapped.
+         */
+        inline cxxblas::StorageUpLo blas_uplo(char uplo, bool transposed)
+        {
+            cxxblas::StorageUpLo ul = blas_uplo(uplo);
+            if (transposed)
+            {
+                return ul == cxxblas::StorageUpLo::Upper ? cxxblas::StorageUpLo::Lower : cxxblas::StorageUpLo::Upper;
+            }
+            return ul;
+        }
+
+        inline cxxblas::Diag blas_diag(char diag)
+        {
+            return (diag == 'U' || diag == 'u') ? cxxblas::Diag::Unit : cxxblas::Diag::NonUnit;
+        }
+
+        inline cxxblas::Side blas_side(char side)
+        {
+            return (side == 'R' || side == 'r') ? cxxblas::Side::Right : cxxblas::Side::Left;
+        }
     }
 
     template <class E>
@@ -89,6 +522,15 @@ namespace xt
         {
             return cxxblas::StorageOrder::ColMajor;
         }
+        layout_type l = detail::blas_strided_layout(e);
+        if (l == layout_type::row_major)
+        {
+            return cxxblas::StorageOrder::RowMajor;
+        }
+        else if (l == layout_type::column_major)
+        {
+            return cxxblas::StorageOrder::ColMajor;
+        }
         DEFAULT_STORAGE_ORDER_BEHAVIOR;
     }
 
@@ -101,25 +543,38 @@ namespace xt
         template <class T, class U>
         inline blas_index_t get_leading_stride_impl(const T& str, const U& sh)
         {
-            return str == T(0) ? static_cast<blas_index_t>(sh) : static_cast<blas_index_t>(str);
+            return str == T(0) ? to_blas_index(sh) : to_blas_index(str);
+        }
+
+        // the dimensions passed along with the leading stride must fit as well
+        template <class A>
+        inline void check_blas_shape(const A& a)
+        {
+            for (auto s : a.shape())
+            {
+                to_blas_index(s);
+            }
         }
     }
 
     template <class A, std::enable_if_t<A::static_layout == layout_type::row_major>* = nullptr>
     inline blas_index_t get_leading_stride(const A& a)
     {
+        detail::check_blas_shape(a);
         return detail::get_leading_stride_impl(a.strides().front(), a.shape().back());
     }
 
     template <class A, std::enable_if_t<A::static_layout == layout_type::column_major>* = nullptr>
     inline blas_index_t get_leading_stride(const A& a)
     {
+        detail::check_blas_shape(a);
         return detail::get_leading_stride_impl(a.strides().back(), a.shape().front());
     }
 
     template <class A, std::enable_if_t<A::static_layout != layout_type::row_major && A::static_layout != layout_type::column_major>* = nullptr>
     inline blas_index_t get_leading_stride(const A& a)
     {
+        detail::check_blas_shape(a);
         if (a.layout() == layout_type::row_major)
         {
             return detail::get_leading_stride_impl(a.strides().front(), a.shape().back());
@@ -128,6 +583,11 @@ namespace xt
         {
             return detail::get_leading_stride_impl(a.strides().back(), a.shape().front());
         }
+        layout_type l = detail::blas_strided_layout(a);
+        if (l != layout_type::dynamic)
+        {
+            return detail::blas_strided_ld(a, l);
+        }
         DEFAULT_LEADING_STRIDE_BEHAVIOR;
     }
 
@@ -144,7 +604,7 @@ namespace xt
         }
         else
         {
-            return static_cast<blas_index_t>(e.strides().front() == 0 ? 1 : e.strides().front());
+            return to_blas_index(e.strides().front() == 0 ? 1 : e.strides().front());
         }
     }
 
@@ -161,7 +621,39 @@ namespace xt
         }
         else
         {
-            return static_cast<blas_index_t>(e.strides().back() == 0 ? 1 : e.strides().back());
+            return to_blas_index(e.strides().back() == 0 ? 1 : e.strides().back());
+        }
+    }
+
+    /***************************
+     * Strided vector operands *
+     ***************************/
+
+    namespace detail
+    {
+        template <class P>
+        struct blas_vector_operand
+        {
+            P data;
+            blas_index_t inc;
+        };
+
+        /**
+         * Pointer and increment with which BLAS walks the 1-D strided
+         * expression \em e. Following the BLAS convention, the pointer
+         * addresses the lowest element in memory when the increment is
+         * negative, so reversed views are passed without a copy.
+         */
+        template <class E>
+        inline auto get_vector_operand(E& e)
+        {
+            auto* ptr = e.data() + e.data_offset();
+            blas_index_t inc = stride_front(e);
+            if (inc < 0 && e.shape()[0] > 0)
+            {
+                ptr += (static_cast<std::ptrdiff_t>(e.shape()[0]) - 1) * inc;
+            }
+            return blas_vector_operand<decltype(ptr)>{ptr, inc};
         }
     }
 
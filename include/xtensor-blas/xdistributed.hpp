@@ -0,0 +1,838 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XDISTRIBUTED_HPP
+#define XDISTRIBUTED_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <mpi.h>
+
+#include "xtensor/xexpression.hpp"
+#include "xtensor/xstorage.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas_config.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+// BLACS, PBLAS and ScaLAPACK have no standard C header
+extern "C"
+{
+    int Csys2blacs_handle(MPI_Comm comm);
+    void Cfree_blacs_system_handle(int handle);
+    void Cblacs_gridinit(int* context, const char* order, int nprow, int npcol);
+    void Cblacs_gridmap(int* context, int* usermap, int ldumap, int nprow, int npcol);
+    void Cblacs_gridinfo(int context, int* nprow, int* npcol, int* myrow, int* mycol);
+    void Cblacs_gridexit(int context);
+
+    int numroc_(const int* n, const int* nb, const int* iproc, const int* isrcproc, const int* nprocs);
+    void descinit_(int* desc, const int* m, const int* n, const int* mb, const int* nb, const int* irsrc,
+                   const int* icsrc, const int* context, const int* lld, int* info);
+
+    void psgemr2d_(const int* m, const int* n, const float* a, const int* ia, const int* ja, const int* desca,
+                   float* b, const int* ib, const int* jb, const int* descb, const int* context);
+    void pdgemr2d_(const int* m, const int* n, const double* a, const int* ia, const int* ja, const int* desca,
+                   double* b, const int* ib, const int* jb, const int* descb, const int* context);
+
+    void psgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+                 const float* alpha, const float* a, const int* ia, const int* ja, const int* desca,
+                 const float* b, const int* ib, const int* jb, const int* descb, const float* beta,
+                 float* c, const int* ic, const int* jc, const int* descc);
+    void pdgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+                 const double* alpha, const double* a, const int* ia, const int* ja, const int* desca,
+                 const double* b, const int* ib, const int* jb, const int* descb, const double* beta,
+                 double* c, const int* ic, const int* jc, const int* descc);
+
+    void pspotrf_(const char* uplo, const int* n, float* a, const int* ia, const int* ja, const int* desca, int* info);
+    void pdpotrf_(const char* uplo, const int* n, double* a, const int* ia, const int* ja, const int* desca, int* info);
+
+    void psgesv_(const int* n, const int* nrhs, float* a, const int* ia, const int* ja, const int* desca, int* ipiv,
+                 float* b, const int* ib, const int* jb, const int* descb, int* info);
+    void pdgesv_(const int* n, const int* nrhs, double* a, const int* ia, const int* ja, const int* desca, int* ipiv,
+                 double* b, const int* ib, const int* jb, const int* descb, int* info);
+
+    void pssyevd_(const char* jobz, const char* uplo, const int* n, float* a, const int* ia, const int* ja,
+                  const int* desca, float* w, float* z, const int* iz, const int* jz, const int* descz,
+                  float* work, const int* lwork, int* iwork, const int* liwork, int* info);
+    void pdsyevd_(const char* jobz, const char* uplo, const int* n, double* a, const int* ia, const int* ja,
+                  const int* desca, double* w, double* z, const int* iz, const int* jz, const int* descz,
+                  double* work, const int* lwork, int* iwork, const int* liwork, int* info);
+
+    void psgesvd_(const char* jobu, const char* jobvt, const int* m, const int* n, float* a, const int* ia,
+                  const int* ja, const int* desca, float* s, float* u, const int* iu, const int* ju,
+                  const int* descu, float* vt, const int* ivt, const int* jvt, const int* descvt,
+                  float* work, const int* lwork, int* info);
+    void pdgesvd_(const char* jobu, const char* jobvt, const int* m, const int* n, double* a, const int* ia,
+                  const int* ja, const int* desca, double* s, double* u, const int* iu, const int* ju,
+                  const int* descu, double* vt, const int* ivt, const int* jvt, const int* descvt,
+                  double* work, const int* lwork, int* info);
+}
+
+namespace xt
+{
+namespace distributed
+{
+    /**
+     * Two-dimensional BLACS process grid over an MPI communicator.
+     *
+     * Every process of the communicator must construct the grid, and
+     * pass it to the same collective operations in the same order.
+     */
+    class process_grid
+    {
+    public:
+
+        /**
+         * @param comm communicator whose processes form the grid
+         * @param rows number of process rows, 0 to pick the most square grid
+         * @param cols number of process columns, 0 for size / rows
+         */
+        explicit process_grid(MPI_Comm comm = MPI_COMM_WORLD, int rows = 0, int cols = 0);
+        ~process_grid();
+
+        process_grid(const process_grid&) = delete;
+        process_grid& operator=(const process_grid&) = delete;
+
+        int context() const noexcept;
+        int union_context() const noexcept;
+        MPI_Comm comm() const noexcept;
+        int rows() const noexcept;
+        int cols() const noexcept;
+        int row() const noexcept;
+        int col() const noexcept;
+        int rank() const noexcept;
+
+    private:
+
+        MPI_Comm m_comm;
+        int m_system;
+        int m_context;
+        int m_union;
+        int m_rows;
+        int m_cols;
+        int m_row;
+        int m_col;
+        int m_rank;
+    };
+
+    inline process_grid::process_grid(MPI_Comm comm, int rows, int cols)
+        : m_comm(comm)
+    {
+        int size = 0;
+        MPI_Comm_size(comm, &size);
+        MPI_Comm_rank(comm, &m_rank);
+        if (rows <= 0)
+        {
+            rows = static_cast<int>(std::sqrt(double(size)));
+            while (size % rows != 0)
+            {
+                --rows;
+            }
+        }
+        if (cols <= 0)
+        {
+            cols = size / rows;
+        }
+        if (rows * cols > size)
+        {
+            XTENSOR_THROW(std::runtime_error, "process_grid: more grid positions than processes.");
+        }
+        m_system = Csys2blacs_handle(comm);
+        m_context = m_system;
+        Cblacs_gridinit(&m_context, "Row", rows, cols);
+        Cblacs_gridinfo(m_context, &m_rows, &m_cols, &m_row, &m_col);
+        m_union = m_system;
+        Cblacs_gridinit(&m_union, "Row", 1, size);
+    }
+
+    inline process_grid::~process_grid()
+    {
+        // processes left out of the grid have no context
+        if (m_row >= 0)
+        {
+            Cblacs_gridexit(m_context);
+        }
+        Cblacs_gridexit(m_union);
+        Cfree_blacs_system_handle(m_system);
+    }
+
+    /// @return the BLACS context of the grid, -1 outside the grid
+    inline int process_grid::context() const noexcept
+    {
+        return m_context;
+    }
+
+    /**
+     * @return a BLACS context of all processes of the communicator, in
+     *         which matrices are redistributed
+     */
+    inline int process_grid::union_context() const noexcept
+    {
+        return m_union;
+    }
+
+    inline MPI_Comm process_grid::comm() const noexcept
+    {
+        return m_comm;
+    }
+
+    /// @return the number of process rows
+    inline int process_grid::rows() const noexcept
+    {
+        return m_rows;
+    }
+
+    /// @return the number of process columns
+    inline int process_grid::cols() const noexcept
+    {
+        return m_cols;
+    }
+
+    /// @return the process row of the calling process, -1 outside the grid
+    inline int process_grid::row() const noexcept
+    {
+        return m_row;
+    }
+
+    /// @return the process column of the calling process, -1 outside the grid
+    inline int process_grid::col() const noexcept
+    {
+        return m_col;
+    }
+
+    /// @return the rank of the calling process in the communicator
+    inline int process_grid::rank() const noexcept
+    {
+        return m_rank;
+    }
+
+    namespace detail
+    {
+        template <class T>
+        struct is_scalapack_type
+            : std::integral_constant<bool, std::is_same<T, float>::value || std::is_same<T, double>::value>
+        {
+        };
+
+        inline int to_int(std::size_t n)
+        {
+            if (n > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+            {
+                XTENSOR_THROW(std::runtime_error, "Dimension too large for ScaLAPACK.");
+            }
+            return static_cast<int>(n);
+        }
+
+        inline int local_extent(int n, int nb, int iproc, int nprocs)
+        {
+            int src = 0;
+            return numroc_(&n, &nb, &iproc, &src, &nprocs);
+        }
+    }
+
+    /**
+     * Dense matrix distributed block-cyclically over a process grid, in
+     * the ScaLAPACK layout: block (I, J) of mb x nb elements is held by the
+     * process at grid position (I mod rows, J mod cols), and each process
+     * stores its blocks as one column-major local matrix.
+     *
+     * @tparam T float or double
+     */
+    template <class T>
+    class block_cyclic_matrix
+    {
+    public:
+
+        static_assert(detail::is_scalapack_type<T>::value, "block_cyclic_matrix: T must be float or double");
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using local_type = xtensor<T, 2, layout_type::column_major>;
+
+        /**
+         * Creates a zero m x n matrix on \em grid; collective over the grid.
+         * @param mb rows of a block
+         * @param nb columns of a block
+         */
+        block_cyclic_matrix(const process_grid& grid, size_type m, size_type n, size_type mb = 64, size_type nb = 64);
+
+        size_type rows() const noexcept;
+        size_type cols() const noexcept;
+        size_type block_rows() const noexcept;
+        size_type block_cols() const noexcept;
+        const process_grid& grid() const noexcept;
+
+        /// @return the blocks of the calling process
+        local_type& local() noexcept;
+        const local_type& local() const noexcept;
+
+        /// @return global row of row \em i of the local matrix
+        size_type global_row(size_type i) const noexcept;
+
+        /// @return global column of column \em j of the local matrix
+        size_type global_col(size_type j) const noexcept;
+
+        /**
+         * Sets every local element from its global indices, so that a
+         * matrix can be formed without ever existing on a single process.
+         * @param f callable returning the element (i, j)
+         */
+        template <class F>
+        void fill(F&& f);
+
+        /// @return the ScaLAPACK array descriptor
+        const int* descriptor() const noexcept;
+
+    private:
+
+        const process_grid* p_grid;
+        size_type m_rows;
+        size_type m_cols;
+        size_type m_mb;
+        size_type m_nb;
+        local_type m_local;
+        std::array<int, 9> m_desc;
+    };
+
+    template <class T>
+    inline block_cyclic_matrix<T>::block_cyclic_matrix(const process_grid& grid, size_type m, size_type n,
+                                                       size_type mb, size_type nb)
+        : p_grid(&grid), m_rows(m), m_cols(n), m_mb(std::max(mb, size_type(1))), m_nb(std::max(nb, size_type(1)))
+    {
+        m_desc.fill(0);
+        // the context of processes outside the grid is -1
+        m_desc[1] = -1;
+        if (grid.row() < 0)
+        {
+            m_local.resize({0, 0});
+            return;
+        }
+        int im = detail::to_int(m), in = detail::to_int(n), imb = detail::to_int(m_mb), inb = detail::to_int(m_nb);
+        int locr = detail::local_extent(im, imb, grid.row(), grid.rows());
+        int locc = detail::local_extent(in, inb, grid.col(), grid.cols());
+        m_local = local_type::from_shape({size_type(locr), size_type(locc)});
+        std::fill(m_local.begin(), m_local.end(), T(0));
+
+        int zero = 0, context = grid.context(), lld = std::max(locr, 1), info = 0;
+        descinit_(m_desc.data(), &im, &in, &imb, &inb, &zero, &zero, &context, &lld, &info);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "block_cyclic_matrix: invalid descriptor.");
+        }
+    }
+
+    template <class T>
+    inline auto block_cyclic_matrix<T>::rows() const noexcept -> size_type
+    {
+        return m_rows;
+    }
+
+    template <class T>
+    inline auto block_cyclic_matrix<T>::cols() const noexcept -> size_type
+    {
+        return m_cols;
+    }
+
+    template <class T>
+    inline auto block_cyclic_matrix<T>::block_rows() const noexcept -> size_type
+    {
+        return m_mb;
+    }
+
+    template <class T>
+    inline auto block_cyclic_matrix<T>::block_cols() const noexcept -> size_type
+    {
+        return m_nb;
+    }
+
+    template <class T>
+    inline const process_grid& block_cyclic_matrix<T>::grid() const noexcept
+    {
+        return *p_grid;
+    }
+
+    template <class T>
+    inline auto block_cyclic_matrix<T>::local() noexcept -> local_type&
+    {
+        return m_local;
+    }
+
+    template <class T>
+    inline auto block_cyclic_matrix<T>::local() const noexcept -> const local_type&
+    {
+        return m_local;
+    }
+
+    template <class T>
+    inline auto block_cyclic_matrix<T>::global_row(size_type i) const noexcept -> size_type
+    {
+        return ((i / m_mb) * size_type(p_grid->rows()) + size_type(p_grid->row())) * m_mb + i % m_mb;
+    }
+
+    template <class T>
+    inline auto block_cyclic_matrix<T>::global_col(size_type j) const noexcept -> size_type
+    {
+        return ((j / m_nb) * size_type(p_grid->cols()) + size_type(p_grid->col())) * m_nb + j % m_nb;
+    }
+
+    template <class T>
+    template <class F>
+    inline void block_cyclic_matrix<T>::fill(F&& f)
+    {
+        for (size_type j = 0; j < m_local.shape()[1]; ++j)
+        {
+            size_type gj = global_col(j);
+            for (size_type i = 0; i < m_local.shape()[0]; ++i)
+            {
+                m_local(i, j) = static_cast<T>(f(global_row(i), gj));
+            }
+        }
+    }
+
+    template <class T>
+    inline const int* block_cyclic_matrix<T>::descriptor() const noexcept
+    {
+        return m_desc.data();
+    }
+
+    namespace detail
+    {
+        inline void pgemr2d(const int* m, const int* n, const float* a, const int* desca, float* b,
+                            const int* descb, const int* context)
+        {
+            int one = 1;
+            psgemr2d_(m, n, a, &one, &one, desca, b, &one, &one, descb, context);
+        }
+
+        inline void pgemr2d(const int* m, const int* n, const double* a, const int* desca, double* b,
+                            const int* descb, const int* context)
+        {
+            int one = 1;
+            pdgemr2d_(m, n, a, &one, &one, desca, b, &one, &one, descb, context);
+        }
+
+        inline void pgemm(char ta, char tb, int m, int n, int k, float alpha, const float* a, const int* desca,
+                          const float* b, const int* descb, float beta, float* c, const int* descc)
+        {
+            int one = 1;
+            psgemm_(&ta, &tb, &m, &n, &k, &alpha, a, &one, &one, desca, b, &one, &one, descb, &beta, c, &one, &one, descc);
+        }
+
+        inline void pgemm(char ta, char tb, int m, int n, int k, double alpha, const double* a, const int* desca,
+                          const double* b, const int* descb, double beta, double* c, const int* descc)
+        {
+            int one = 1;
+            pdgemm_(&ta, &tb, &m, &n, &k, &alpha, a, &one, &one, desca, b, &one, &one, descb, &beta, c, &one, &one, descc);
+        }
+
+        inline int ppotrf(char uplo, int n, float* a, const int* desca)
+        {
+            int one = 1, info = 0;
+            pspotrf_(&uplo, &n, a, &one, &one, desca, &info);
+            return info;
+        }
+
+        inline int ppotrf(char uplo, int n, double* a, const int* desca)
+        {
+            int one = 1, info = 0;
+            pdpotrf_(&uplo, &n, a, &one, &one, desca, &info);
+            return info;
+        }
+
+        inline int pgesv(int n, int nrhs, float* a, const int* desca, int* ipiv, float* b, const int* descb)
+        {
+            int one = 1, info = 0;
+            psgesv_(&n, &nrhs, a, &one, &one, desca, ipiv, b, &one, &one, descb, &info);
+            return info;
+        }
+
+        inline int pgesv(int n, int nrhs, double* a, const int* desca, int* ipiv, double* b, const int* descb)
+        {
+            int one = 1, info = 0;
+            pdgesv_(&n, &nrhs, a, &one, &one, desca, ipiv, b, &one, &one, descb, &info);
+            return info;
+        }
+
+        inline int psyevd(char jobz, char uplo, int n, float* a, const int* desca, float* w, float* z,
+                          const int* descz, float* work, int lwork, int* iwork, int liwork)
+        {
+            int one = 1, info = 0;
+            pssyevd_(&jobz, &uplo, &n, a, &one, &one, desca, w, z, &one, &one, descz, work, &lwork, iwork, &liwork, &info);
+            return info;
+        }
+
+        inline int psyevd(char jobz, char uplo, int n, double* a, const int* desca, double* w, double* z,
+                          const int* descz, double* work, int lwork, int* iwork, int liwork)
+        {
+            int one = 1, info = 0;
+            pdsyevd_(&jobz, &uplo, &n, a, &one, &one, desca, w, z, &one, &one, descz, work, &lwork, iwork, &liwork, &info);
+            return info;
+        }
+
+        inline int pgesvd(char job, int m, int n, float* a, const int* desca, float* s, float* u, const int* descu,
+                          float* vt, const int* descvt, float* work, int lwork)
+        {
+            int one = 1, info = 0;
+            psgesvd_(&job, &job, &m, &n, a, &one, &one, desca, s, u, &one, &one, descu, vt, &one, &one, descvt,
+                     work, &lwork, &info);
+            return info;
+        }
+
+        inline int pgesvd(char job, int m, int n, double* a, const int* desca, double* s, double* u, const int* descu,
+                          double* vt, const int* descvt, double* work, int lwork)
+        {
+            int one = 1, info = 0;
+            pdgesvd_(&job, &job, &m, &n, a, &one, &one, desca, s, u, &one, &one, descu, vt, &one, &one, descvt,
+                     work, &lwork, &info);
+            return info;
+        }
+
+        /**
+         * Descriptor of an m x n column-major matrix held whole by process
+         * \em root, in a 1 x 1 grid of that process only.
+         */
+        class root_grid
+        {
+        public:
+
+            root_grid(const process_grid& grid, int root)
+            {
+                m_system = Csys2blacs_handle(grid.comm());
+                m_context = m_system;
+                Cblacs_gridmap(&m_context, &root, 1, 1, 1);
+                m_member = grid.rank() == root;
+            }
+
+            ~root_grid()
+            {
+                if (m_member)
+                {
+                    Cblacs_gridexit(m_context);
+                }
+                Cfree_blacs_system_handle(m_system);
+            }
+
+            root_grid(const root_grid&) = delete;
+            root_grid& operator=(const root_grid&) = delete;
+
+            std::array<int, 9> descriptor(int m, int n) const
+            {
+                std::array<int, 9> desc;
+                desc.fill(0);
+                desc[1] = -1;
+                if (m_member)
+                {
+                    int zero = 0, info = 0, lld = std::max(m, 1);
+                    int mb = std::max(m, 1), nb = std::max(n, 1);
+                    descinit_(desc.data(), &m, &n, &mb, &nb, &zero, &zero, &m_context, &lld, &info);
+                }
+                return desc;
+            }
+
+        private:
+
+            int m_system;
+            int m_context;
+            bool m_member;
+        };
+
+        template <class T>
+        inline bool in_grid(const block_cyclic_matrix<T>& A)
+        {
+            return A.grid().row() >= 0;
+        }
+
+        template <class T>
+        inline void check_same_grid(const block_cyclic_matrix<T>& A, const block_cyclic_matrix<T>& B)
+        {
+            if (&A.grid() != &B.grid())
+            {
+                XTENSOR_THROW(std::runtime_error, "Distributed operands must share a process grid.");
+            }
+        }
+
+        /**
+         * Copy of a distributed matrix, for the routines that overwrite
+         * their operands.
+         */
+        template <class T>
+        inline block_cyclic_matrix<T> local_copy(const block_cyclic_matrix<T>& A)
+        {
+            block_cyclic_matrix<T> result(A.grid(), A.rows(), A.cols(), A.block_rows(), A.block_cols());
+            result.local() = A.local();
+            return result;
+        }
+
+        template <class T>
+        inline int first_error(const block_cyclic_matrix<T>& A, int info)
+        {
+            // every process returns the same info, but a process outside
+            // the grid has not computed anything
+            return in_grid(A) ? info : 0;
+        }
+    }
+
+    /**
+     * Distributes the matrix \em A held by process \em root over \em grid;
+     * collective over the communicator of the grid.
+     *
+     * @param A matrix, only read on \em root; its shape must be given on
+     *        every process
+     * @param root rank holding \em A
+     * @param mb rows of a block
+     * @param nb columns of a block
+     * @return the distributed matrix
+     */
+    template <class E>
+    auto scatter(const process_grid& grid, const xexpression<E>& A, int root = 0,
+                 std::size_t mb = 64, std::size_t nb = 64)
+    {
+        using value_type = typename E::value_type;
+        const auto& a = A.derived_cast();
+        int m = detail::to_int(a.shape()[0]), n = detail::to_int(a.shape()[1]);
+        block_cyclic_matrix<value_type> result(grid, a.shape()[0], a.shape()[1], mb, nb);
+
+        xtensor<value_type, 2, layout_type::column_major> whole;
+        if (grid.rank() == root)
+        {
+            whole = a;
+        }
+        detail::root_grid rg(grid, root);
+        auto desc = rg.descriptor(m, n);
+        int context = grid.union_context();
+        detail::pgemr2d(&m, &n, whole.data(), desc.data(), result.local().data(), result.descriptor(), &context);
+        return result;
+    }
+
+    /**
+     * Collects a distributed matrix on process \em root; collective over
+     * the communicator of the grid.
+     * @return the whole matrix on \em root, an empty matrix elsewhere
+     */
+    template <class T>
+    auto gather(const block_cyclic_matrix<T>& A, int root = 0)
+    {
+        const process_grid& grid = A.grid();
+        int m = detail::to_int(A.rows()), n = detail::to_int(A.cols());
+        xtensor<T, 2, layout_type::column_major> whole;
+        whole.resize({grid.rank() == root ? A.rows() : 0, grid.rank() == root ? A.cols() : 0});
+
+        detail::root_grid rg(grid, root);
+        auto desc = rg.descriptor(m, n);
+        int context = grid.union_context();
+        detail::pgemr2d(&m, &n, A.local().data(), A.descriptor(), whole.data(), desc.data(), &context);
+        return whole;
+    }
+
+}
+
+namespace linalg
+{
+    /**
+     * Distributed matrix product with PBLAS gemm; collective over the grid.
+     * @return A B, distributed with the blocking of \em A
+     */
+    template <class T>
+    auto dot(const distributed::block_cyclic_matrix<T>& A, const distributed::block_cyclic_matrix<T>& B)
+    {
+        distributed::detail::check_same_grid(A, B);
+        if (A.cols() != B.rows())
+        {
+            XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+        }
+        distributed::block_cyclic_matrix<T> C(A.grid(), A.rows(), B.cols(), A.block_rows(), B.block_cols());
+        if (distributed::detail::in_grid(A))
+        {
+            distributed::detail::pgemm('N', 'N', distributed::detail::to_int(A.rows()),
+                                       distributed::detail::to_int(B.cols()), distributed::detail::to_int(A.cols()),
+                                       T(1), A.local().data(), A.descriptor(), B.local().data(), B.descriptor(),
+                                       T(0), C.local().data(), C.descriptor());
+        }
+        return C;
+    }
+
+    /**
+     * Distributed Cholesky factorization with ScaLAPACK potrf.
+     * @return the lower triangular factor L, A = L L^T, distributed as \em A
+     */
+    template <class T>
+    auto cholesky(const distributed::block_cyclic_matrix<T>& A)
+    {
+        if (A.rows() != A.cols())
+        {
+            XTENSOR_THROW(std::runtime_error, "Last 2 dimensions of the array must be square.");
+        }
+        auto L = distributed::detail::local_copy(A);
+        int info = 0;
+        if (distributed::detail::in_grid(L))
+        {
+            info = distributed::detail::ppotrf('L', distributed::detail::to_int(L.rows()), L.local().data(), L.descriptor());
+        }
+        if (distributed::detail::first_error(L, info) > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
+        }
+        // potrf leaves the strict upper triangle alone
+        auto& local = L.local();
+        for (std::size_t j = 0; j < local.shape()[1]; ++j)
+        {
+            std::size_t gj = L.global_col(j);
+            for (std::size_t i = 0; i < local.shape()[0]; ++i)
+            {
+                if (L.global_row(i) < gj)
+                {
+                    local(i, j) = T(0);
+                }
+            }
+        }
+        return L;
+    }
+
+    /**
+     * Solves A X = B with the distributed LU factorization of ScaLAPACK
+     * gesv; collective over the grid. \em A must have square blocks and
+     * \em B the same row blocking.
+     * @return X, distributed as \em B
+     */
+    template <class T>
+    auto solve(const distributed::block_cyclic_matrix<T>& A, const distributed::block_cyclic_matrix<T>& B)
+    {
+        distributed::detail::check_same_grid(A, B);
+        if (A.rows() != A.cols() || B.rows() != A.rows())
+        {
+            XTENSOR_THROW(std::runtime_error, "solve: A must be square with as many rows as b.");
+        }
+        if (A.block_rows() != A.block_cols() || B.block_rows() != A.block_rows())
+        {
+            XTENSOR_THROW(std::runtime_error, "solve: A needs square blocks and b the row blocks of A.");
+        }
+        auto lu = distributed::detail::local_copy(A);
+        auto x = distributed::detail::local_copy(B);
+        int info = 0;
+        if (distributed::detail::in_grid(lu))
+        {
+            uvector<int> ipiv(lu.local().shape()[0] + lu.block_rows());
+            info = distributed::detail::pgesv(distributed::detail::to_int(A.rows()), distributed::detail::to_int(B.cols()),
+                                              lu.local().data(), lu.descriptor(), ipiv.data(),
+                                              x.local().data(), x.descriptor());
+        }
+        if (distributed::detail::first_error(lu, info) != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return x;
+    }
+
+    /**
+     * Eigenvalues and eigenvectors of a distributed symmetric matrix with
+     * ScaLAPACK syevd; collective over the grid. \em A must have square
+     * blocks.
+     * @param UPLO triangle of \em A that is read, 'L' or 'U'
+     * @return tuple of the ascending eigenvalues, on every process of the
+     *         grid, and the distributed eigenvectors
+     */
+    template <class T>
+    auto eigh(const distributed::block_cyclic_matrix<T>& A, char UPLO = 'L')
+    {
+        if (A.rows() != A.cols())
+        {
+            XTENSOR_THROW(std::runtime_error, "Last 2 dimensions of the array must be square.");
+        }
+        if (A.block_rows() != A.block_cols())
+        {
+            XTENSOR_THROW(std::runtime_error, "eigh: the distributed matrix needs square blocks.");
+        }
+        int n = distributed::detail::to_int(A.rows());
+        auto a = distributed::detail::local_copy(A);
+        distributed::block_cyclic_matrix<T> z(A.grid(), A.rows(), A.cols(), A.block_rows(), A.block_cols());
+        xtensor<T, 1> w;
+        w.resize({A.rows()});
+        int info = 0;
+        if (distributed::detail::in_grid(a))
+        {
+            T work_query(0);
+            int iwork_query = 0;
+            info = distributed::detail::psyevd('V', UPLO, n, a.local().data(), a.descriptor(), w.data(),
+                                               z.local().data(), z.descriptor(), &work_query, -1, &iwork_query, -1);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for syevd.");
+            }
+            uvector<T> work(std::max(std::size_t(work_query), std::size_t(1)));
+            uvector<int> iwork(std::max(std::size_t(iwork_query), std::size_t(1)));
+            info = distributed::detail::psyevd('V', UPLO, n, a.local().data(), a.descriptor(), w.data(),
+                                               z.local().data(), z.descriptor(), work.data(), int(work.size()),
+                                               iwork.data(), int(iwork.size()));
+        }
+        if (distributed::detail::first_error(a, info) > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+        return std::make_tuple(std::move(w), std::move(z));
+    }
+
+    /**
+     * Singular value decomposition of a distributed matrix with ScaLAPACK
+     * gesvd; collective over the grid. Only the min(m, n) leading singular
+     * vectors are computed, as ScaLAPACK does not form full U and Vt.
+     *
+     * @param compute_uv compute the singular vectors; U and Vt are 0 x 0
+     *        otherwise
+     * @return tuple of U, the descending singular values on every process of
+     *         the grid, and Vt
+     */
+    template <class T>
+    auto svd(const distributed::block_cyclic_matrix<T>& A, bool compute_uv = true)
+    {
+        std::size_t m = A.rows(), n = A.cols(), k = std::min(m, n);
+        auto a = distributed::detail::local_copy(A);
+        std::size_t mb = A.block_rows(), nb = A.block_cols();
+        distributed::block_cyclic_matrix<T> u(A.grid(), compute_uv ? m : 0, compute_uv ? k : 0, mb, nb);
+        distributed::block_cyclic_matrix<T> vt(A.grid(), compute_uv ? k : 0, compute_uv ? n : 0, mb, nb);
+        xtensor<T, 1> s;
+        s.resize({k});
+        char job = compute_uv ? 'V' : 'N';
+        int info = 0;
+        if (distributed::detail::in_grid(a))
+        {
+            int im = distributed::detail::to_int(m), in = distributed::detail::to_int(n);
+            // U and Vt are not referenced without vectors
+            T* u_data = compute_uv ? u.local().data() : a.local().data();
+            T* vt_data = compute_uv ? vt.local().data() : a.local().data();
+            const int* u_desc = compute_uv ? u.descriptor() : a.descriptor();
+            const int* vt_desc = compute_uv ? vt.descriptor() : a.descriptor();
+            T work_query(0);
+            info = distributed::detail::pgesvd(job, im, in, a.local().data(), a.descriptor(), s.data(),
+                                               u_data, u_desc, vt_data, vt_desc, &work_query, -1);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gesvd.");
+            }
+            uvector<T> work(std::max(std::size_t(work_query), std::size_t(1)));
+            info = distributed::detail::pgesvd(job, im, in, a.local().data(), a.descriptor(), s.data(),
+                                               u_data, u_desc, vt_data, vt_desc, work.data(), int(work.size()));
+        }
+        if (distributed::detail::first_error(a, info) > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "SVD decomposition failed.");
+        }
+        return std::make_tuple(std::move(u), std::move(s), std::move(vt));
+    }
+}
+}
+
+#endif
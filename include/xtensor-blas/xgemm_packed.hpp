@@ -0,0 +1,204 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+
+#ifndef XGEMM_PACKED_HPP
+#define XGEMM_PACKED_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xutils.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+
+namespace xt
+{
+    /****************
+     * xgemm_packed *
+     ****************/
+
+    /**
+     * Right operand B of matrix products A * B, stored once in the format
+     * in which GEMM reads it, for a B that multiplies many different A
+     * (e.g. the weights of a layer). The generic FLENS kernel keeps B in
+     * the slivers of its micro kernel, so that each product only packs A;
+     * with a BLAS driver B is kept contiguously in the order of the result
+     * and handed to ?gemm without a copy.
+     *
+     * The format depends on the storage order of the result: products
+     * taking it must have the layout \em L.
+     */
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT>
+    class xgemm_packed
+    {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+        using packed_type = cxxblas::GemmPacked<blas_index_t, T>;
+
+        static constexpr layout_type static_layout = layout_remove_any(L);
+
+        xgemm_packed() = default;
+
+        template <class E>
+        explicit xgemm_packed(const xexpression<E>& e, bool transpose = false);
+
+        shape_type shape() const noexcept;
+        size_type dimension() const noexcept;
+        const packed_type& packed() const noexcept;
+
+    private:
+
+        packed_type m_packed;
+    };
+
+    /*******************************
+     * xgemm_packed implementation *
+     *******************************/
+
+    /**
+     * Packs the matrix \em e, or its transpose if \em transpose is true,
+     * converting it to \em T.
+     */
+    template <class T, layout_type L>
+    template <class E>
+    inline xgemm_packed<T, L>::xgemm_packed(const xexpression<E>& e, bool transpose)
+    {
+        const auto& b = e.derived_cast();
+        XTENSOR_ASSERT(b.dimension() == 2);
+
+        xtensor<T, 2, static_layout> b_copy;
+        auto op_b = detail::get_matrix_operand<static_layout>(
+            b, b_copy,
+            std::integral_constant<bool, has_data_interface<E>::value && std::is_same<typename E::value_type, T>::value>());
+        cxxblas::gemm_pack<blas_index_t>(
+            static_layout == layout_type::row_major ? cxxblas::StorageOrder::RowMajor : cxxblas::StorageOrder::ColMajor,
+            (transpose != op_b.transposed) ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+            to_blas_index(transpose ? b.shape()[1] : b.shape()[0]),
+            to_blas_index(transpose ? b.shape()[0] : b.shape()[1]),
+            op_b.data,
+            op_b.ld,
+            m_packed
+        );
+    }
+
+    /**
+     * Returns the shape of the packed operand, k by n.
+     */
+    template <class T, layout_type L>
+    inline auto xgemm_packed<T, L>::shape() const noexcept -> shape_type
+    {
+        return {size_type(m_packed.k), size_type(m_packed.n)};
+    }
+
+    template <class T, layout_type L>
+    inline auto xgemm_packed<T, L>::dimension() const noexcept -> size_type
+    {
+        return 2;
+    }
+
+    template <class T, layout_type L>
+    inline auto xgemm_packed<T, L>::packed() const noexcept -> const packed_type&
+    {
+        return m_packed;
+    }
+
+namespace blas
+{
+    /**
+     * Calculate the matrix-matrix product of matrix @A and the packed
+     * matrix @B
+     *
+     * C := alpha * A * B + beta * C
+     *
+     * @param A matrix of m-by-k elements
+     * @param B packed matrix of k-by-n elements
+     * @param result matrix of m-by-n elements, of the layout B was packed for
+     * @param transpose_A transpose A on the fly
+     * @param alpha scale factor for A * B (defaults to 1)
+     * @param beta scale factor for C (defaults to 0)
+     */
+    template <class E, class T, layout_type L, class R>
+    void gemm(const xexpression<E>& A, const xgemm_packed<T, L>& B, R& result,
+              bool transpose_A = false,
+              const T& alpha = T(1.0),
+              const T& beta = T(0.0))
+    {
+        constexpr layout_type BL = xgemm_packed<T, L>::static_layout;
+        static_assert(layout_remove_any(R::static_layout) == BL,
+                      "GEMM with a packed operand: the result must have the layout it was packed for.");
+        static_assert(std::is_same<typename E::value_type, T>::value && std::is_same<typename R::value_type, T>::value,
+                      "GEMM with a packed operand: value types must match.");
+        const auto& a = A.derived_cast();
+        const auto& p = B.packed();
+
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(std::size_t(p.k) == (transpose_A ? a.shape()[0] : a.shape()[1]));
+        XTENSOR_ASSERT(result.shape()[0] == (transpose_A ? a.shape()[1] : a.shape()[0]));
+        XTENSOR_ASSERT(result.shape()[1] == std::size_t(p.n));
+
+        xtensor<T, 2, BL> a_copy;
+        auto op_a = detail::get_matrix_operand<BL>(a, a_copy, has_data_interface<E>());
+        cxxblas::Transpose trans_a = (transpose_A != op_a.transposed) ? cxxblas::Transpose::Trans
+                                                                      : cxxblas::Transpose::NoTrans;
+        blas_index_t m = to_blas_index(result.shape()[0]);
+
+        if (!p.panels)
+        {
+            detail::gemm_dispatch(p.order, trans_a, cxxblas::Transpose::NoTrans, m, p.n, p.k, alpha,
+                                  op_a.data, op_a.ld,
+                                  p.data.data(), std::max(p.order == cxxblas::StorageOrder::RowMajor ? p.n : p.k, blas_index_t(1)),
+                                  beta, result.data() + result.data_offset(), get_leading_stride(result));
+            return;
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm_compute", result.shape()[0], result.shape()[1], std::size_t(p.k), BL,
+                                     trans_a == cxxblas::Transpose::Trans ? 'T' : 'N', 'N',
+                                     instrument::fma_flops<T>(double(m) * double(p.n) * double(p.k)));
+        cxxblas::gemm_compute<blas_index_t>(
+            trans_a,
+            m,
+            alpha,
+            op_a.data,
+            op_a.ld,
+            p,
+            beta,
+            result.data() + result.data_offset(),
+            get_leading_stride(result)
+        );
+    }
+}
+
+namespace linalg
+{
+    /**
+     * Matrix product of \em a with the packed matrix \em b.
+     * @return the product, of the layout \em b was packed for
+     */
+    template <class E, class T, layout_type L>
+    auto dot(const xexpression<E>& a, const xgemm_packed<T, L>& b)
+    {
+        const auto& da = a.derived_cast();
+        XTENSOR_ASSERT(da.dimension() == 2);
+
+        using result_type = xtensor<T, 2, xgemm_packed<T, L>::static_layout>;
+        auto result = result_type::from_shape({da.shape()[0], b.shape()[1]});
+        blas::gemm(da, b, result);
+        return result;
+    }
+}
+}
+
+#endif
@@ -0,0 +1,212 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XHALF_HPP
+#define XHALF_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace xt
+{
+    namespace detail
+    {
+        inline std::uint32_t float_to_bits(float f)
+        {
+            std::uint32_t u;
+            std::memcpy(&u, &f, sizeof(u));
+            return u;
+        }
+
+        inline float bits_to_float(std::uint32_t u)
+        {
+            float f;
+            std::memcpy(&f, &u, sizeof(f));
+            return f;
+        }
+
+        // rounds the low \em shift bits of u away, to nearest even
+        inline std::uint32_t round_shift(std::uint32_t u, unsigned shift)
+        {
+            std::uint32_t h = u >> shift;
+            std::uint32_t rem = u & ((std::uint32_t(1) << shift) - 1);
+            std::uint32_t half = std::uint32_t(1) << (shift - 1);
+            return (rem > half || (rem == half && (h & 1))) ? h + 1 : h;
+        }
+    }
+
+    /**
+     * Brain floating point number: the upper 16 bits of an IEEE single
+     * precision number, i.e. its exponent range with an 8 bit significand.
+     * Only storage: arithmetic is done on the float it converts to.
+     * Conversions from float round to nearest even.
+     */
+    class bfloat16
+    {
+    public:
+
+        bfloat16() = default;
+
+        explicit bfloat16(float f)
+            : m_bits(from_float(f))
+        {
+        }
+
+        operator float() const
+        {
+            return detail::bits_to_float(std::uint32_t(m_bits) << 16);
+        }
+
+        std::uint16_t bits() const
+        {
+            return m_bits;
+        }
+
+        static bfloat16 from_bits(std::uint16_t bits)
+        {
+            bfloat16 b;
+            b.m_bits = bits;
+            return b;
+        }
+
+    private:
+
+        static std::uint16_t from_float(float f)
+        {
+            std::uint32_t u = detail::float_to_bits(f);
+            if ((u & 0x7FFFFFFFu) > 0x7F800000u)
+            {
+                // keeps NaN quiet, as rounding could make it infinite
+                return static_cast<std::uint16_t>((u >> 16) | 0x40u);
+            }
+            return static_cast<std::uint16_t>(detail::round_shift(u, 16));
+        }
+
+        std::uint16_t m_bits;
+    };
+
+    /**
+     * IEEE 754 half precision number (binary16): 5 exponent and 10
+     * significand bits, with subnormals. Only storage, as bfloat16.
+     * Conversions from float round to nearest even; values beyond the
+     * range of half become infinite.
+     */
+    class float16
+    {
+    public:
+
+        float16() = default;
+
+        explicit float16(float f)
+            : m_bits(from_float(f))
+        {
+        }
+
+        operator float() const
+        {
+            std::uint32_t sign = std::uint32_t(m_bits & 0x8000u) << 16;
+            std::uint32_t e = (m_bits >> 10) & 0x1Fu;
+            std::uint32_t m = m_bits & 0x3FFu;
+            if (e == 0x1Fu)
+            {
+                return detail::bits_to_float(sign | 0x7F800000u | (m << 13));
+            }
+            if (e == 0)
+            {
+                if (m == 0)
+                {
+                    return detail::bits_to_float(sign);
+                }
+                // subnormal: normalize the significand
+                e = 113;
+                while (!(m & 0x400u))
+                {
+                    m <<= 1;
+                    --e;
+                }
+                return detail::bits_to_float(sign | (e << 23) | ((m & 0x3FFu) << 13));
+            }
+            return detail::bits_to_float(sign | ((e + 112) << 23) | (m << 13));
+        }
+
+        std::uint16_t bits() const
+        {
+            return m_bits;
+        }
+
+        static float16 from_bits(std::uint16_t bits)
+        {
+            float16 h;
+            h.m_bits = bits;
+            return h;
+        }
+
+    private:
+
+        static std::uint16_t from_float(float f)
+        {
+            std::uint32_t u = detail::float_to_bits(f);
+            std::uint32_t sign = (u >> 16) & 0x8000u;
+            u &= 0x7FFFFFFFu;
+            if (u >= 0x7F800000u)
+            {
+                return static_cast<std::uint16_t>(sign | (u > 0x7F800000u ? 0x7E00u : 0x7C00u));
+            }
+            if (u >= 0x477FF000u)
+            {
+                // 65520 and above round to infinity
+                return static_cast<std::uint16_t>(sign | 0x7C00u);
+            }
+            if (u < 0x38800000u)
+            {
+                // below 2^-14: a subnormal half, 2^-25 and less round to 0
+                if (u <= 0x33000000u)
+                {
+                    return static_cast<std::uint16_t>(sign);
+                }
+                std::uint32_t e = u >> 23;
+                std::uint32_t m = (u & 0x7FFFFFu) | 0x800000u;
+                return static_cast<std::uint16_t>(sign | detail::round_shift(m, 126 - e));
+            }
+            // rebias the exponent; a carry of the rounding goes into it
+            return static_cast<std::uint16_t>(sign | (detail::round_shift(u, 13) - (112u << 10)));
+        }
+
+        std::uint16_t m_bits;
+    };
+
+    /**
+     * True for the 16 bit floating point types, which BLAS multiplies
+     * with float accumulation.
+     */
+    template <class T>
+    struct is_reduced_float : std::false_type
+    {
+    };
+
+    template <>
+    struct is_reduced_float<bfloat16> : std::true_type
+    {
+    };
+
+    template <>
+    struct is_reduced_float<float16> : std::true_type
+    {
+    };
+
+    /**
+     * Type in which products of \em T are accumulated: float for the
+     * 16 bit floating point types, \em T otherwise.
+     */
+    template <class T>
+    using accumulation_type_t = std::conditional_t<is_reduced_float<T>::value, float, T>;
+}
+
+#endif
@@ -0,0 +1,933 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XHODLR_HPP
+#define XHODLR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xstorage.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+    /**********
+     * xhodlr *
+     **********/
+
+    /// Compression parameters of xhodlr
+    struct hodlr_options
+    {
+        std::size_t leaf_size = 64;  ///< Largest diagonal block stored dense, at least 2
+        double tol = 1e-8;           ///< Relative accuracy of each off-diagonal block
+        std::size_t max_rank = 0;    ///< Largest rank of an off-diagonal block, 0 for no limit
+    };
+
+    /**
+     * Hierarchically off-diagonal low rank (HODLR) n x n matrix, for dense
+     * but data-sparse matrices such as boundary element and kernel matrices.
+     *
+     * The index range is halved recursively down to leaves of at most
+     * leaf_size rows. The diagonal blocks of the leaves are stored dense,
+     * and the two off-diagonal blocks of every other node as products
+     * U V^T of rank r, compressed by adaptive cross approximation (ACA,
+     * reading O(r (m + n)) elements of an m x n block) and truncated by a
+     * QR-SVD recompression to the relative tolerance. With ranks bounded
+     * by r, the storage and a product with a vector are O(n r log n), and
+     * lu_factor and solve are O(n r^2 log^2 n) and O(n r log n).
+     *
+     * Like xbanded, it is not an xexpression: linalg::dot, solve and
+     * lu_factor have overloads taking it, and the Krylov solvers of
+     * xkrylov.hpp take it through apply. The blocks of a level are
+     * compressed, multiplied and factored in parallel when
+     * XTENSOR_USE_OPENMP is defined.
+     */
+    template <class T>
+    class xhodlr
+    {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1>;
+
+        /// Off-diagonal blocks of the rows and columns [begin, end), split at mid
+        struct node
+        {
+            size_type begin;
+            size_type mid;
+            size_type end;
+            matrix_type u12;  ///< A(begin:mid, mid:end) ~ u12 v12^T
+            matrix_type v12;
+            matrix_type u21;  ///< A(mid:end, begin:mid) ~ u21 v21^T
+            matrix_type v21;
+        };
+
+        xhodlr() = default;
+
+        template <class E>
+        explicit xhodlr(const xexpression<E>& A, const hodlr_options& options = hodlr_options());
+
+        template <class F>
+        xhodlr(size_type n, F&& entry, const hodlr_options& options = hodlr_options());
+
+        shape_type shape() const noexcept;
+        size_type dimension() const noexcept;
+
+        size_type levels() const noexcept;
+        const std::vector<node>& nodes(size_type level) const;
+        const std::vector<matrix_type>& leaves() const noexcept;
+        const std::vector<size_type>& leaf_offsets() const noexcept;
+        size_type max_rank() const noexcept;
+        size_type stored_elements() const noexcept;
+
+        void apply(const vector_type& x, vector_type& y) const;
+        matrix_type dense() const;
+
+    private:
+
+        template <class F>
+        void build(size_type n, F& entry, const hodlr_options& options);
+
+        size_type m_n = 0;
+        std::vector<std::vector<node>> m_nodes;
+        std::vector<matrix_type> m_leaves;
+        std::vector<size_type> m_offsets;
+    };
+
+    namespace detail
+    {
+        // C := alpha op(A) B + beta C on column-major pointers, op(A) = A or A^T
+        template <class T>
+        inline void hodlr_gemm(bool trans_a, std::size_t m, std::size_t n, std::size_t k, const T& alpha,
+                               const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                               const T& beta, T* c, std::size_t ldc)
+        {
+            if (m == 0 || n == 0)
+            {
+                return;
+            }
+            auto ld = [](std::size_t l) { return std::max(blas_index_t(1), to_blas_index(l)); };
+            cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::ColMajor,
+                                        trans_a ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                                        cxxblas::Transpose::NoTrans, to_blas_index(m), to_blas_index(n),
+                                        to_blas_index(k), alpha, a, ld(lda), b, ld(ldb), beta, c, ld(ldc));
+        }
+
+        /*
+         * Adaptive cross approximation with partial pivoting of the m x n
+         * block of entry(r0 + i, c0 + j), recompressed by QR of both
+         * factors and SVD of the product of their R: block ~ U V^T with
+         * the singular values below tol times the largest dropped.
+         */
+        template <class T, class F>
+        inline void aca(F& entry, std::size_t r0, std::size_t m, std::size_t c0, std::size_t n,
+                        const hodlr_options& options,
+                        xtensor<T, 2, layout_type::column_major>& U, xtensor<T, 2, layout_type::column_major>& V)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            using matrix_type = xtensor<T, 2, layout_type::column_major>;
+
+            std::size_t cap = std::min(m, n);
+            if (options.max_rank != 0)
+            {
+                cap = std::min(cap, options.max_rank);
+            }
+            std::vector<std::vector<T>> us, vs;
+            std::vector<char> used(m, 0);
+            std::vector<T> row(n), col(m);
+            real_type frob2(0);
+            std::size_t i = 0, zero_pivots = 0;
+            while (us.size() < cap)
+            {
+                used[i] = 1;
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    T e = static_cast<T>(entry(r0 + i, c0 + j));
+                    for (std::size_t l = 0; l < us.size(); ++l)
+                    {
+                        e -= us[l][i] * vs[l][j];
+                    }
+                    row[j] = e;
+                }
+                std::size_t jp = 0;
+                for (std::size_t j = 1; j < n; ++j)
+                {
+                    if (std::abs(row[j]) > std::abs(row[jp]))
+                    {
+                        jp = j;
+                    }
+                }
+                if (std::abs(row[jp]) == real_type(0))
+                {
+                    // the row is already represented: a few more tries, then the block is
+                    // taken as converged
+                    auto next = std::find(used.begin(), used.end(), char(0));
+                    if (next == used.end() || ++zero_pivots > 8)
+                    {
+                        break;
+                    }
+                    i = static_cast<std::size_t>(next - used.begin());
+                    continue;
+                }
+                T pivot = row[jp];
+                for (auto& v : row)
+                {
+                    v /= pivot;
+                }
+                for (std::size_t ii = 0; ii < m; ++ii)
+                {
+                    T e = static_cast<T>(entry(r0 + ii, c0 + jp));
+                    for (std::size_t l = 0; l < us.size(); ++l)
+                    {
+                        e -= us[l][ii] * vs[l][jp];
+                    }
+                    col[ii] = e;
+                }
+
+                // ||sum of the terms||_F^2, updated with the new term
+                real_type un(0), vn(0), cross(0);
+                for (const auto& x : col)
+                {
+                    un += std::norm(x);
+                }
+                for (const auto& x : row)
+                {
+                    vn += std::norm(x);
+                }
+                for (std::size_t l = 0; l < us.size(); ++l)
+                {
+                    T cu(0), cv(0);
+                    for (std::size_t ii = 0; ii < m; ++ii)
+                    {
+                        cu += linalg::detail::conj_value(us[l][ii]) * col[ii];
+                    }
+                    for (std::size_t j = 0; j < n; ++j)
+                    {
+                        cv += linalg::detail::conj_value(vs[l][j]) * row[j];
+                    }
+                    cross += std::real(cu * cv);
+                }
+                frob2 += un * vn + real_type(2) * cross;
+                us.push_back(col);
+                vs.push_back(row);
+                if (std::sqrt(un * vn) <= real_type(options.tol) * std::sqrt(std::abs(frob2)))
+                {
+                    break;
+                }
+
+                // next pivot row: the largest element of the new column among the unused rows
+                bool found = false;
+                real_type best(-1);
+                for (std::size_t ii = 0; ii < m; ++ii)
+                {
+                    if (!used[ii] && std::abs(col[ii]) > best)
+                    {
+                        best = std::abs(col[ii]);
+                        i = ii;
+                        found = true;
+                    }
+                }
+                if (!found)
+                {
+                    break;
+                }
+            }
+
+            std::size_t k = us.size();
+            if (k == 0)
+            {
+                U = matrix_type::from_shape({m, std::size_t(0)});
+                V = matrix_type::from_shape({n, std::size_t(0)});
+                return;
+            }
+            matrix_type Qu = matrix_type::from_shape({m, k});
+            matrix_type Qv = matrix_type::from_shape({n, k});
+            for (std::size_t l = 0; l < k; ++l)
+            {
+                std::copy(us[l].begin(), us[l].end(), Qu.data() + l * m);
+                std::copy(vs[l].begin(), vs[l].end(), Qv.data() + l * n);
+            }
+            auto upper_r = [k](matrix_type& Q)
+            {
+                xtensor<T, 1, layout_type::column_major> tau = xtensor<T, 1, layout_type::column_major>::from_shape({k});
+                if (lapack::geqrf(Q, tau) != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "xhodlr: QR decomposition failed.");
+                }
+                matrix_type R = matrix_type::from_shape({k, k});
+                for (std::size_t j = 0; j < k; ++j)
+                {
+                    for (std::size_t ii = 0; ii < k; ++ii)
+                    {
+                        R(ii, j) = ii <= j ? Q(ii, j) : T(0);
+                    }
+                }
+                linalg::detail::call_gqr(Q, tau, to_blas_index(k));
+                return R;
+            };
+            matrix_type Ru = upper_r(Qu);
+            matrix_type Rv = upper_r(Qv);
+            matrix_type C = matrix_type::from_shape({k, k});
+            hodlr_gemm(false, k, k, k, T(1), Ru.data(), k, xtensor<T, 2, layout_type::column_major>(xt::transpose(Rv)).data(), k,
+                       T(0), C.data(), k);
+            auto svd = lapack::gesdd(C, 'A');
+            if (std::get<0>(svd) != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "xhodlr: SVD recompression failed.");
+            }
+            const auto& X = std::get<1>(svd);
+            const auto& s = std::get<2>(svd);
+            const auto& Yt = std::get<3>(svd);
+            std::size_t r = 0;
+            while (r < k && s(r) > real_type(options.tol) * s(0))
+            {
+                ++r;
+            }
+            if (options.max_rank != 0)
+            {
+                r = std::min(r, options.max_rank);
+            }
+
+            // U = Qu X_r S_r, V = Qv Yt_r^T
+            matrix_type Xs = matrix_type::from_shape({k, r});
+            matrix_type Y = matrix_type::from_shape({k, r});
+            for (std::size_t j = 0; j < r; ++j)
+            {
+                for (std::size_t ii = 0; ii < k; ++ii)
+                {
+                    Xs(ii, j) = X(ii, j) * s(j);
+                    Y(ii, j) = Yt(j, ii);
+                }
+            }
+            U = matrix_type::from_shape({m, r});
+            V = matrix_type::from_shape({n, r});
+            hodlr_gemm(false, m, r, k, T(1), Qu.data(), m, Xs.data(), k, T(0), U.data(), m);
+            hodlr_gemm(false, n, r, k, T(1), Qv.data(), n, Y.data(), k, T(0), V.data(), n);
+        }
+
+        /*
+         * Y := A X for the n x p column-major X and Y: the leaves, then the
+         * off-diagonal blocks level by level, each level in parallel as its
+         * nodes update disjoint rows.
+         */
+        template <class T>
+        inline void hodlr_multiply(const xhodlr<T>& A, const T* x, std::size_t ldx, std::size_t p,
+                                   T* y, std::size_t ldy)
+        {
+            const auto& leaves = A.leaves();
+            const auto& offsets = A.leaf_offsets();
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for
+#endif
+            for (std::ptrdiff_t q = 0; q < static_cast<std::ptrdiff_t>(leaves.size()); ++q)
+            {
+                std::size_t i = static_cast<std::size_t>(q);
+                std::size_t b = offsets[i], s = offsets[i + 1] - b;
+                hodlr_gemm(false, s, p, s, T(1), leaves[i].data(), s, x + b, ldx, T(0), y + b, ldy);
+            }
+            for (std::size_t level = 0; level < A.levels(); ++level)
+            {
+                const auto& nodes = A.nodes(level);
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp parallel for
+#endif
+                for (std::ptrdiff_t q = 0; q < static_cast<std::ptrdiff_t>(nodes.size()); ++q)
+                {
+                    const auto& nd = nodes[static_cast<std::size_t>(q)];
+                    std::size_t n1 = nd.mid - nd.begin, n2 = nd.end - nd.mid;
+                    std::size_t r12 = nd.u12.shape()[1], r21 = nd.u21.shape()[1];
+                    uvector<T> t(std::max(r12, r21) * p);
+                    // y1 += u12 (v12^T x2), y2 += u21 (v21^T x1)
+                    hodlr_gemm(true, r12, p, n2, T(1), nd.v12.data(), n2, x + nd.mid, ldx, T(0), t.data(), r12);
+                    hodlr_gemm(false, n1, p, r12, T(1), nd.u12.data(), n1, t.data(), r12, T(1), y + nd.begin, ldy);
+                    hodlr_gemm(true, r21, p, n1, T(1), nd.v21.data(), n1, x + nd.begin, ldx, T(0), t.data(), r21);
+                    hodlr_gemm(false, n2, p, r21, T(1), nd.u21.data(), n2, t.data(), r21, T(1), y + nd.mid, ldy);
+                }
+            }
+        }
+    }
+
+    /**
+     * Compresses the square matrix \em A, reading only the elements the
+     * cross approximation of each off-diagonal block needs.
+     * @param A square matrix expression
+     * @param options leaf size, tolerance and rank limit
+     */
+    template <class T>
+    template <class E>
+    inline xhodlr<T>::xhodlr(const xexpression<E>& A, const hodlr_options& options)
+    {
+        const auto& a = A.derived_cast();
+        linalg::assert_nd_square(a);
+        auto entry = [&a](size_type i, size_type j) { return a(i, j); };
+        build(a.shape()[0], entry, options);
+    }
+
+    /**
+     * Compresses the n x n matrix of elements entry(i, j), e.g. the
+     * interaction of boundary elements i and j, evaluating O(r n log n) of
+     * them. \em entry must be safe to call concurrently with
+     * XTENSOR_USE_OPENMP.
+     * @param n order of the matrix
+     * @param entry function of (i, j) returning the element (i, j)
+     * @param options leaf size, tolerance and rank limit
+     */
+    template <class T>
+    template <class F>
+    inline xhodlr<T>::xhodlr(size_type n, F&& entry, const hodlr_options& options)
+    {
+        build(n, entry, options);
+    }
+
+    template <class T>
+    template <class F>
+    inline void xhodlr<T>::build(size_type n, F& entry, const hodlr_options& options)
+    {
+        m_n = n;
+        size_type leaf_size = std::max(options.leaf_size, size_type(2));
+        size_type depth = 0;
+        while (((n + (size_type(1) << depth) - 1) >> depth) > leaf_size)
+        {
+            ++depth;
+        }
+
+        // ranges of the nodes, level by level
+        m_nodes.assign(depth, std::vector<node>());
+        std::vector<std::pair<size_type, size_type>> ranges = {{0, n}};
+        for (size_type level = 0; level < depth; ++level)
+        {
+            std::vector<std::pair<size_type, size_type>> next;
+            for (const auto& r : ranges)
+            {
+                node nd;
+                nd.begin = r.first;
+                nd.end = r.second;
+                nd.mid = r.first + (r.second - r.first) / 2;
+                m_nodes[level].push_back(nd);
+                next.emplace_back(nd.begin, nd.mid);
+                next.emplace_back(nd.mid, nd.end);
+            }
+            ranges = std::move(next);
+        }
+        m_offsets.clear();
+        for (const auto& r : ranges)
+        {
+            m_offsets.push_back(r.first);
+        }
+        m_offsets.push_back(n);
+
+        for (auto& level : m_nodes)
+        {
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for schedule(dynamic)
+#endif
+            for (std::ptrdiff_t q = 0; q < static_cast<std::ptrdiff_t>(level.size()); ++q)
+            {
+                node& nd = level[static_cast<size_type>(q)];
+                size_type n1 = nd.mid - nd.begin, n2 = nd.end - nd.mid;
+                detail::aca<T>(entry, nd.begin, n1, nd.mid, n2, options, nd.u12, nd.v12);
+                detail::aca<T>(entry, nd.mid, n2, nd.begin, n1, options, nd.u21, nd.v21);
+            }
+        }
+
+        m_leaves.assign(ranges.size(), matrix_type());
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t q = 0; q < static_cast<std::ptrdiff_t>(ranges.size()); ++q)
+        {
+            size_type i = static_cast<size_type>(q);
+            size_type b = ranges[i].first, s = ranges[i].second - b;
+            matrix_type D = matrix_type::from_shape({s, s});
+            for (size_type j = 0; j < s; ++j)
+            {
+                for (size_type k = 0; k < s; ++k)
+                {
+                    D(k, j) = static_cast<T>(entry(b + k, b + j));
+                }
+            }
+            m_leaves[i] = std::move(D);
+        }
+    }
+
+    template <class T>
+    inline auto xhodlr<T>::shape() const noexcept -> shape_type
+    {
+        return {m_n, m_n};
+    }
+
+    template <class T>
+    inline auto xhodlr<T>::dimension() const noexcept -> size_type
+    {
+        return 2;
+    }
+
+    /// @return the number of levels of nodes above the leaves
+    template <class T>
+    inline auto xhodlr<T>::levels() const noexcept -> size_type
+    {
+        return m_nodes.size();
+    }
+
+    /// @return the 2^level nodes of \em level, from the first rows to the last
+    template <class T>
+    inline auto xhodlr<T>::nodes(size_type level) const -> const std::vector<node>&
+    {
+        return m_nodes[level];
+    }
+
+    /// @return the dense diagonal blocks of the leaves
+    template <class T>
+    inline auto xhodlr<T>::leaves() const noexcept -> const std::vector<matrix_type>&
+    {
+        return m_leaves;
+    }
+
+    /// @return the first row of every leaf, followed by n
+    template <class T>
+    inline auto xhodlr<T>::leaf_offsets() const noexcept -> const std::vector<size_type>&
+    {
+        return m_offsets;
+    }
+
+    /// @return the largest rank of the off-diagonal blocks
+    template <class T>
+    inline auto xhodlr<T>::max_rank() const noexcept -> size_type
+    {
+        size_type r = 0;
+        for (const auto& level : m_nodes)
+        {
+            for (const auto& nd : level)
+            {
+                r = std::max(r, std::max(nd.u12.shape()[1], nd.u21.shape()[1]));
+            }
+        }
+        return r;
+    }
+
+    /// @return the number of stored elements, against n^2 for the dense matrix
+    template <class T>
+    inline auto xhodlr<T>::stored_elements() const noexcept -> size_type
+    {
+        size_type count = 0;
+        for (const auto& level : m_nodes)
+        {
+            for (const auto& nd : level)
+            {
+                count += nd.u12.size() + nd.v12.size() + nd.u21.size() + nd.v21.size();
+            }
+        }
+        for (const auto& D : m_leaves)
+        {
+            count += D.size();
+        }
+        return count;
+    }
+
+    /**
+     * y := A x, for the Krylov solvers.
+     */
+    template <class T>
+    inline void xhodlr<T>::apply(const vector_type& x, vector_type& y) const
+    {
+        detail::hodlr_multiply(*this, x.data(), m_n, 1, y.data(), m_n);
+    }
+
+    /// @return the approximated matrix, expanded
+    template <class T>
+    inline auto xhodlr<T>::dense() const -> matrix_type
+    {
+        matrix_type I = matrix_type::from_shape({m_n, m_n});
+        I.fill(T(0));
+        for (size_type i = 0; i < m_n; ++i)
+        {
+            I(i, i) = T(1);
+        }
+        matrix_type result = matrix_type::from_shape({m_n, m_n});
+        detail::hodlr_multiply(*this, I.data(), m_n, m_n, result.data(), m_n);
+        return result;
+    }
+
+namespace linalg
+{
+    /**
+     * Factorization of a HODLR matrix, as returned by lu_factor: the LU
+     * factors of the leaves, and for every node the factor of the
+     * low rank update I + W Z^T that maps the block diagonal of its two
+     * children to its own diagonal block (Ambikasaran and Darve), of
+     * order r12 + r21. It takes O(n r^2 log^2 n) flops and O(n r log n)
+     * storage, and a solve O(n r log n).
+     */
+    template <class T>
+    class hodlr_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using size_type = std::size_t;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1>;
+
+        explicit hodlr_factorization(const xhodlr<T>& A);
+
+        template <class E>
+        auto solve(const xexpression<E>& b) const;
+
+        std::tuple<value_type, real_type> slogdet() const;
+
+        void apply(const vector_type& x, vector_type& y) const;
+
+    private:
+
+        struct node_factor
+        {
+            size_type begin;
+            size_type mid;
+            size_type end;
+            matrix_type w12;  // A11^-1 u12
+            matrix_type w21;  // A22^-1 u21
+            matrix_type v12;
+            matrix_type v21;
+            matrix_type s;    // LU of I + Z^T W
+            uvector<blas_index_t> piv;
+        };
+
+        void solve_inplace(T* x, size_type ldx, size_type p) const;
+
+        size_type m_n;
+        std::vector<std::vector<node_factor>> m_nodes;
+        std::vector<matrix_type> m_leaves;
+        std::vector<uvector<blas_index_t>> m_leaf_piv;
+        std::vector<size_type> m_offsets;
+    };
+
+    /**
+     * Factors \em A bottom up: each leaf block is LU factored and applied
+     * to the rows of the U factors of its ancestors, and each node, level
+     * by level, factors its update of order r12 + r21 and applies it to
+     * the U factors of its own ancestors. The nodes of a level are
+     * processed in parallel when XTENSOR_USE_OPENMP is defined.
+     */
+    template <class T>
+    inline hodlr_factorization<T>::hodlr_factorization(const xhodlr<T>& A)
+        : m_n(A.shape()[0]), m_nodes(A.levels()), m_leaves(A.leaves()),
+          m_leaf_piv(A.leaves().size()), m_offsets(A.leaf_offsets())
+    {
+        size_type depth = A.levels();
+        std::size_t failed = 0;
+
+        // X of a node of depth d: its diagonal block of A, inverted, applied
+        // to the U factors of its ancestors of depth 0, ..., d - 1 restricted
+        // to its rows, in this order
+        std::vector<matrix_type> X(m_leaves.size());
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for reduction(+:failed)
+#endif
+        for (std::ptrdiff_t q = 0; q < static_cast<std::ptrdiff_t>(m_leaves.size()); ++q)
+        {
+            size_type i = static_cast<size_type>(q);
+            size_type b = m_offsets[i], s = m_offsets[i + 1] - b;
+            size_type cols = 0;
+            for (size_type d = 0; d < depth; ++d)
+            {
+                const auto& nd = A.nodes(d)[i >> (depth - d)];
+                cols += ((i >> (depth - d - 1)) & 1) ? nd.u21.shape()[1] : nd.u12.shape()[1];
+            }
+            matrix_type B = matrix_type::from_shape({s, cols});
+            size_type c = 0;
+            for (size_type d = 0; d < depth; ++d)
+            {
+                const auto& nd = A.nodes(d)[i >> (depth - d)];
+                bool right = ((i >> (depth - d - 1)) & 1) != 0;
+                const matrix_type& U = right ? nd.u21 : nd.u12;
+                size_type first = b - (right ? nd.mid : nd.begin);
+                size_type rows = U.shape()[0];
+                for (size_type j = 0; j < U.shape()[1]; ++j, ++c)
+                {
+                    std::copy(U.data() + j * rows + first, U.data() + j * rows + first + s, B.data() + c * s);
+                }
+            }
+            m_leaf_piv[i].resize(s);
+            blas_index_t lds = std::max(blas_index_t(1), to_blas_index(s));
+            if (s != 0 && cxxlapack::getrf<blas_index_t>(to_blas_index(s), to_blas_index(s), m_leaves[i].data(), lds,
+                                                         m_leaf_piv[i].data()) != 0)
+            {
+                ++failed;
+                continue;
+            }
+            if (s != 0 && cols != 0)
+            {
+                cxxlapack::getrs<blas_index_t>('N', to_blas_index(s), to_blas_index(cols), m_leaves[i].data(), lds,
+                                               m_leaf_piv[i].data(), B.data(), lds);
+            }
+            X[i] = std::move(B);
+        }
+        if (failed != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "hodlr_factorization: a diagonal block is singular.");
+        }
+
+        for (size_type d = depth; d-- > 0;)
+        {
+            const auto& nodes = A.nodes(d);
+            m_nodes[d].resize(nodes.size());
+            std::vector<matrix_type> parent(nodes.size());
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for reduction(+:failed)
+#endif
+            for (std::ptrdiff_t q = 0; q < static_cast<std::ptrdiff_t>(nodes.size()); ++q)
+            {
+                size_type j = static_cast<size_type>(q);
+                const auto& nd = nodes[j];
+                node_factor& f = m_nodes[d][j];
+                f.begin = nd.begin;
+                f.mid = nd.mid;
+                f.end = nd.end;
+                f.v12 = nd.v12;
+                f.v21 = nd.v21;
+                size_type n1 = nd.mid - nd.begin, n2 = nd.end - nd.mid, n = n1 + n2;
+                size_type r12 = nd.u12.shape()[1], r21 = nd.u21.shape()[1], k = r12 + r21;
+                const matrix_type& X1 = X[2 * j];
+                const matrix_type& X2 = X[2 * j + 1];
+                size_type K = X1.shape()[1] - r12;
+
+                // W = diag(A11^-1 u12, A22^-1 u21), the last columns of the children
+                f.w12 = matrix_type::from_shape({n1, r12});
+                f.w21 = matrix_type::from_shape({n2, r21});
+                std::copy(X1.data() + K * n1, X1.data() + (K + r12) * n1, f.w12.data());
+                std::copy(X2.data() + K * n2, X2.data() + (K + r21) * n2, f.w21.data());
+
+                // S = I + Z^T W = [I, v12^T w21; v21^T w12, I]
+                f.s = matrix_type::from_shape({k, k});
+                f.s.fill(T(0));
+                for (size_type l = 0; l < k; ++l)
+                {
+                    f.s(l, l) = T(1);
+                }
+                xt::detail::hodlr_gemm(true, r12, r21, n2, T(1), f.v12.data(), n2, f.w21.data(), n2, T(1),
+                                   f.s.data() + r12 * k, k);
+                xt::detail::hodlr_gemm(true, r21, r12, n1, T(1), f.v21.data(), n1, f.w12.data(), n1, T(1),
+                                   f.s.data() + r12, k);
+                f.piv.resize(k);
+                if (k != 0 && cxxlapack::getrf<blas_index_t>(to_blas_index(k), to_blas_index(k), f.s.data(),
+                                                             to_blas_index(k), f.piv.data()) != 0)
+                {
+                    ++failed;
+                    continue;
+                }
+
+                // the ancestors' columns of both children, stacked, times (I + W Z^T)^-1
+                matrix_type P = matrix_type::from_shape({n, K});
+                for (size_type c = 0; c < K; ++c)
+                {
+                    std::copy(X1.data() + c * n1, X1.data() + (c + 1) * n1, P.data() + c * n);
+                    std::copy(X2.data() + c * n2, X2.data() + (c + 1) * n2, P.data() + c * n + n1);
+                }
+                if (k != 0 && K != 0)
+                {
+                    matrix_type t = matrix_type::from_shape({k, K});
+                    xt::detail::hodlr_gemm(true, r12, K, n2, T(1), f.v12.data(), n2, P.data() + n1, n, T(0), t.data(), k);
+                    xt::detail::hodlr_gemm(true, r21, K, n1, T(1), f.v21.data(), n1, P.data(), n, T(0), t.data() + r12, k);
+                    cxxlapack::getrs<blas_index_t>('N', to_blas_index(k), to_blas_index(K), f.s.data(), to_blas_index(k),
+                                                   f.piv.data(), t.data(), to_blas_index(k));
+                    xt::detail::hodlr_gemm(false, n1, K, r12, T(-1), f.w12.data(), n1, t.data(), k, T(1), P.data(), n);
+                    xt::detail::hodlr_gemm(false, n2, K, r21, T(-1), f.w21.data(), n2, t.data() + r12, k, T(1), P.data() + n1, n);
+                }
+                parent[j] = std::move(P);
+            }
+            if (failed != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "hodlr_factorization: a low rank update is singular.");
+            }
+            X = std::move(parent);
+        }
+    }
+
+    /*
+     * x := A^-1 x for the n x p column-major x: the leaves, then the
+     * updates of the nodes from the deepest level to the root.
+     */
+    template <class T>
+    inline void hodlr_factorization<T>::solve_inplace(T* x, size_type ldx, size_type p) const
+    {
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t q = 0; q < static_cast<std::ptrdiff_t>(m_leaves.size()); ++q)
+        {
+            size_type i = static_cast<size_type>(q);
+            size_type b = m_offsets[i], s = m_offsets[i + 1] - b;
+            if (s != 0)
+            {
+                cxxlapack::getrs<blas_index_t>('N', to_blas_index(s), to_blas_index(p), m_leaves[i].data(),
+                                               to_blas_index(s), m_leaf_piv[i].data(), x + b, to_blas_index(ldx));
+            }
+        }
+        for (size_type d = m_nodes.size(); d-- > 0;)
+        {
+            const auto& nodes = m_nodes[d];
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for
+#endif
+            for (std::ptrdiff_t q = 0; q < static_cast<std::ptrdiff_t>(nodes.size()); ++q)
+            {
+                const auto& f = nodes[static_cast<size_type>(q)];
+                size_type n1 = f.mid - f.begin, n2 = f.end - f.mid;
+                size_type r12 = f.w12.shape()[1], r21 = f.w21.shape()[1], k = r12 + r21;
+                if (k == 0)
+                {
+                    continue;
+                }
+                // x -= W S^-1 Z^T x
+                uvector<T> t(k * p);
+                xt::detail::hodlr_gemm(true, r12, p, n2, T(1), f.v12.data(), n2, x + f.mid, ldx, T(0), t.data(), k);
+                xt::detail::hodlr_gemm(true, r21, p, n1, T(1), f.v21.data(), n1, x + f.begin, ldx, T(0), t.data() + r12, k);
+                cxxlapack::getrs<blas_index_t>('N', to_blas_index(k), to_blas_index(p), f.s.data(), to_blas_index(k),
+                                               f.piv.data(), t.data(), to_blas_index(k));
+                xt::detail::hodlr_gemm(false, n1, p, r12, T(-1), f.w12.data(), n1, t.data(), k, T(1), x + f.begin, ldx);
+                xt::detail::hodlr_gemm(false, n2, p, r21, T(-1), f.w21.data(), n2, t.data() + r12, k, T(1), x + f.mid, ldx);
+            }
+        }
+    }
+
+    /**
+     * Solves A x = b.
+     * @param b vector of size n or n x p matrix
+     * @return x, column-major, of the shape of \em b
+     */
+    template <class T>
+    template <class E>
+    inline auto hodlr_factorization<T>::solve(const xexpression<E>& b) const
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        if (x.dimension() == 0 || x.dimension() > 2 || x.shape()[0] != m_n)
+        {
+            XTENSOR_THROW(std::runtime_error, "hodlr_factorization::solve: shape mismatch.");
+        }
+        size_type p = x.dimension() == 1 ? 1 : x.shape()[1];
+        if (m_n != 0 && p != 0)
+        {
+            solve_inplace(x.data(), m_n, p);
+        }
+        return x;
+    }
+
+    /**
+     * @return the sign (or phase) and the logarithm of the modulus of the
+     *         determinant, from the factors of the leaves and the updates
+     */
+    template <class T>
+    inline auto hodlr_factorization<T>::slogdet() const -> std::tuple<value_type, real_type>
+    {
+        value_type sign(1);
+        real_type logdet(0);
+        auto accumulate = [&sign, &logdet](const matrix_type& lu, const uvector<blas_index_t>& piv)
+        {
+            if (lu.size() == 0)
+            {
+                return;
+            }
+            auto part = detail::slogdet_from_lu(lu.data(), piv.data(), lu.shape()[0]);
+            sign *= std::get<0>(part);
+            logdet += std::get<1>(part);
+        };
+        for (size_type i = 0; i < m_leaves.size(); ++i)
+        {
+            accumulate(m_leaves[i], m_leaf_piv[i]);
+        }
+        for (const auto& level : m_nodes)
+        {
+            for (const auto& f : level)
+            {
+                accumulate(f.s, f.piv);
+            }
+        }
+        return std::make_tuple(sign, logdet);
+    }
+
+    /**
+     * y := A^-1 x, e.g. to precondition a Krylov solver with a coarser
+     * HODLR approximation.
+     */
+    template <class T>
+    inline void hodlr_factorization<T>::apply(const vector_type& x, vector_type& y) const
+    {
+        y = x;
+        if (m_n != 0)
+        {
+            solve_inplace(y.data(), m_n, 1);
+        }
+    }
+
+    /**
+     * Factors the HODLR matrix \em A once, for repeated solves.
+     * @param A HODLR matrix
+     * @return hodlr_factorization of \em A
+     */
+    template <class T>
+    inline auto lu_factor(const xhodlr<T>& A)
+    {
+        return hodlr_factorization<T>(A);
+    }
+
+    /**
+     * Product of a HODLR matrix with a vector or an n x p matrix, in
+     * O(n r log n) per column.
+     */
+    template <class T, class E>
+    inline auto dot(const xhodlr<T>& A, const xexpression<E>& x)
+    {
+        auto&& cx = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        if (cx.dimension() == 0 || cx.dimension() > 2 || cx.shape()[0] != A.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "dot: shape mismatch of the HODLR matrix and the operand.");
+        }
+        using result_type = std::decay_t<decltype(cx)>;
+        result_type y = result_type::from_shape(cx.shape());
+        std::size_t n = A.shape()[0];
+        std::size_t p = cx.dimension() == 1 ? 1 : cx.shape()[1];
+        if (n != 0 && p != 0)
+        {
+            xt::detail::hodlr_multiply(A, cx.data(), n, p, y.data(), n);
+        }
+        return y;
+    }
+
+    /**
+     * Solves A x = b for a HODLR matrix, factoring it first; use lu_factor
+     * for several right-hand sides given one after the other.
+     */
+    template <class T, class E>
+    inline auto solve(const xhodlr<T>& A, const xexpression<E>& b)
+    {
+        return lu_factor(A).solve(b);
+    }
+}
+}
+
+#endif
@@ -0,0 +1,2451 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+
+#ifndef XKRYLOV_HPP
+#define XKRYLOV_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xsparse.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+    namespace detail
+    {
+        /*
+         * y := A x for the operators of the Krylov solvers: anything with an
+         * apply(x, y) member, dense matrices, sparse matrices and
+         * kron_operator.
+         */
+        template <class A, class V>
+        inline auto krylov_apply(const A& a, const V& x, V& y) -> decltype(a.apply(x, y), void())
+        {
+            a.apply(x, y);
+        }
+
+        template <class E, class V>
+        inline void krylov_apply(const xexpression<E>& a, const V& x, V& y)
+        {
+            blas::gemv(a, x, y);
+        }
+
+        template <class T, class V>
+        inline void krylov_apply(const xsparse_csr<T>& a, const V& x, V& y)
+        {
+            csr_mv(a, x.data(), y.data());
+        }
+
+        template <class T, class V>
+        inline void krylov_apply(const xsparse_ccs<T>& a, const V& x, V& y)
+        {
+            ccs_mv(a, x.data(), y.data());
+        }
+
+        template <class T, class O, class V>
+        inline void krylov_apply(const kron_operator<T, O>& a, const V& x, V& y)
+        {
+            y = dot(a, x);
+        }
+
+        // level 1 kernels on whole vectors, dot conjugating x
+        template <class T>
+        inline T krylov_dot(const xtensor<T, 1>& x, const xtensor<T, 1>& y)
+        {
+            T result;
+            cxxblas::dot<blas_index_t>(to_blas_index(x.size()), x.data(), 1, y.data(), 1, result);
+            return result;
+        }
+
+        template <class T>
+        inline xtl::complex_value_type_t<T> krylov_norm(const xtensor<T, 1>& x)
+        {
+            xtl::complex_value_type_t<T> result;
+            cxxblas::nrm2<blas_index_t>(to_blas_index(x.size()), x.data(), 1, result);
+            return result;
+        }
+
+        // y := alpha x + y
+        template <class T>
+        inline void krylov_axpy(const T& alpha, const xtensor<T, 1>& x, xtensor<T, 1>& y)
+        {
+            cxxblas::axpy<blas_index_t>(to_blas_index(x.size()), alpha, x.data(), 1, y.data(), 1);
+        }
+
+        // y := alpha x + beta y
+        template <class T>
+        inline void krylov_axpby(const T& alpha, const xtensor<T, 1>& x, const T& beta, xtensor<T, 1>& y)
+        {
+            cxxblas::axpby<blas_index_t>(to_blas_index(x.size()), alpha, x.data(), 1, beta, y.data(), 1);
+        }
+
+        template <class T>
+        inline void krylov_scal(const T& alpha, xtensor<T, 1>& x)
+        {
+            cxxblas::scal<blas_index_t>(to_blas_index(x.size()), alpha, x.data(), 1);
+        }
+    }
+
+    /*******************
+     * linear_operator *
+     *******************/
+
+    /**
+     * Square linear operator of order n given by a function computing
+     * y = A x into a vector of n elements, e.g. for matrix-free operators.
+     * The Krylov solvers accept any type with such an apply(x, y) member,
+     * as well as dense and sparse matrices and kron_operator; wrapping
+     * them in a linear_operator gives them a common type.
+     */
+    template <class T>
+    class linear_operator
+    {
+    public:
+
+        using value_type = T;
+        using vector_type = xtensor<T, 1>;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+
+        template <class F>
+        linear_operator(size_type n, F f);
+
+        shape_type shape() const noexcept;
+        void apply(const vector_type& x, vector_type& y) const;
+
+    private:
+
+        std::function<void(const vector_type&, vector_type&)> m_apply;
+        size_type m_size;
+    };
+
+    /**
+     * @return a linear_operator applying \em a, which is referenced and not
+     *         copied
+     */
+    template <class A>
+    linear_operator<typename A::value_type> make_linear_operator(const A& a)
+    {
+        using vector_type = typename linear_operator<typename A::value_type>::vector_type;
+        return linear_operator<typename A::value_type>(a.shape()[0], [&a](const vector_type& x, vector_type& y)
+        {
+            detail::krylov_apply(a, x, y);
+        });
+    }
+
+    /**
+     * Builds the operator of order \em n applying \em f, called as f(x, y)
+     * to compute y = A x.
+     */
+    template <class T>
+    template <class F>
+    inline linear_operator<T>::linear_operator(size_type n, F f)
+        : m_apply(std::move(f)), m_size(n)
+    {
+    }
+
+    template <class T>
+    inline auto linear_operator<T>::shape() const noexcept -> shape_type
+    {
+        return {m_size, m_size};
+    }
+
+    template <class T>
+    inline void linear_operator<T>::apply(const vector_type& x, vector_type& y) const
+    {
+        m_apply(x, y);
+    }
+
+    /*******************
+     * Preconditioners *
+     *******************/
+
+    /// Preconditioner of the Krylov solvers that leaves the residual unchanged
+    struct identity_preconditioner
+    {
+        template <class V>
+        void apply(const V& x, V& y) const
+        {
+            y = x;
+        }
+    };
+
+    /**
+     * Jacobi (diagonal) preconditioner: divides the residual by the
+     * diagonal of the operator.
+     */
+    template <class T>
+    class jacobi_preconditioner
+    {
+    public:
+
+        using value_type = T;
+        using vector_type = xtensor<T, 1>;
+
+        template <class E>
+        explicit jacobi_preconditioner(const xexpression<E>& diagonal);
+
+        explicit jacobi_preconditioner(const xsparse_csr<T>& A);
+
+        void apply(const vector_type& x, vector_type& y) const;
+
+    private:
+
+        vector_type m_inverse;
+    };
+
+    /**
+     * Builds the preconditioner of the operator with the given \em diagonal,
+     * which must have no zero element.
+     */
+    template <class T>
+    template <class E>
+    inline jacobi_preconditioner<T>::jacobi_preconditioner(const xexpression<E>& diagonal)
+        : m_inverse(diagonal.derived_cast())
+    {
+        for (auto& d : m_inverse)
+        {
+            if (d == T(0))
+            {
+                XTENSOR_THROW(std::runtime_error, "jacobi_preconditioner: zero on the diagonal.");
+            }
+            d = T(1) / d;
+        }
+    }
+
+    template <class T>
+    inline void jacobi_preconditioner<T>::apply(const vector_type& x, vector_type& y) const
+    {
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            y(i) = m_inverse(i) * x(i);
+        }
+    }
+
+    /**
+     * Block Jacobi preconditioner: multiplies the residual by the inverses
+     * of the diagonal blocks of the operator, the last of which may be
+     * smaller. The blocks are inverted by batch_inv, so those of order up to
+     * 8 use its unrolled kernels, and they are applied in parallel with
+     * XTENSOR_USE_OPENMP.
+     */
+    template <class T>
+    class block_jacobi_preconditioner
+    {
+    public:
+
+        using value_type = T;
+        using vector_type = xtensor<T, 1>;
+        using size_type = std::size_t;
+
+        block_jacobi_preconditioner(const xsparse_csr<T>& A, size_type block_size);
+
+        size_type block_size() const noexcept;
+        const xtensor<T, 3>& inverse_blocks() const noexcept;
+
+        void apply(const vector_type& x, vector_type& y) const;
+
+    private:
+
+        xtensor<T, 3> m_inverse;
+        size_type m_size;
+        size_type m_block_size;
+    };
+
+    /**
+     * Incomplete Cholesky preconditioner IC(0) of a Hermitian positive
+     * definite matrix: L L^H, where L has the nonzeros of the lower triangle
+     * of the matrix and L L^H equals it on them.
+     *
+     * With no sweeps, L is computed row by row. Otherwise it is the result
+     * of that many fixed-point sweeps of Chow and Patel, each computing all
+     * the elements of L from the previous ones, in parallel with
+     * XTENSOR_USE_OPENMP. The sweeps converge to the same factor, and a few
+     * of them usually precondition about as well. The two triangular solves
+     * of apply are level scheduled by sparse_triangular_solver.
+     */
+    template <class T>
+    class ic0_preconditioner
+    {
+    public:
+
+        using value_type = T;
+        using vector_type = xtensor<T, 1>;
+        using size_type = std::size_t;
+
+        explicit ic0_preconditioner(const xsparse_csr<T>& A, size_type sweeps = 0);
+
+        const xsparse_csr<T>& factor() const noexcept;
+
+        void apply(const vector_type& x, vector_type& y) const;
+
+    private:
+
+        xsparse_csr<T> m_factor;
+        sparse_triangular_solver<T> m_lower;
+        sparse_triangular_solver<T> m_upper;
+    };
+
+    /**
+     * Incomplete LU preconditioner ILU(0): L U, where the unit lower L and
+     * the upper U have the nonzeros of the matrix and L U equals it on them.
+     * The sweeps are those of ic0_preconditioner.
+     */
+    template <class T>
+    class ilu0_preconditioner
+    {
+    public:
+
+        using value_type = T;
+        using vector_type = xtensor<T, 1>;
+        using size_type = std::size_t;
+
+        explicit ilu0_preconditioner(const xsparse_csr<T>& A, size_type sweeps = 0);
+
+        const xsparse_csr<T>& factors() const noexcept;
+
+        void apply(const vector_type& x, vector_type& y) const;
+
+    private:
+
+        xsparse_csr<T> m_factors;
+        sparse_triangular_solver<T> m_lower;
+        sparse_triangular_solver<T> m_upper;
+    };
+
+    /**
+     * Incomplete LU preconditioner with threshold ILUT(tau, fill) (Saad):
+     * row i is eliminated with the rows of U above it, the elements smaller
+     * than tau times the norm of row i of the matrix are dropped, and the
+     * \em fill largest remaining ones are kept in each of L and U, besides
+     * the diagonal. A zero pivot is replaced by tau times the norm of its
+     * row. The factorization is sequential; apply, as that of
+     * ilu0_preconditioner, is level scheduled.
+     */
+    template <class T>
+    class ilut_preconditioner
+    {
+    public:
+
+        using value_type = T;
+        using vector_type = xtensor<T, 1>;
+        using size_type = std::size_t;
+
+        explicit ilut_preconditioner(const xsparse_csr<T>& A, double tau = 1e-4, size_type fill = 10);
+
+        const xsparse_csr<T>& factors() const noexcept;
+
+        void apply(const vector_type& x, vector_type& y) const;
+
+    private:
+
+        xsparse_csr<T> m_factors;
+        sparse_triangular_solver<T> m_lower;
+        sparse_triangular_solver<T> m_upper;
+    };
+
+    namespace detail
+    {
+        template <class T>
+        inline xtensor<T, 1> sparse_diagonal(const xsparse_csr<T>& A)
+        {
+            check_sparse_square(A.shape()[0], A.shape()[1]);
+            const auto& ia = A.row_offsets();
+            const auto& ja = A.column_indices();
+            const auto& a = A.values();
+            xtensor<T, 1> result = xtensor<T, 1>::from_shape({A.shape()[0]});
+            for (std::size_t i = 0; i < A.shape()[0]; ++i)
+            {
+                T d(0);
+                for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                {
+                    if (static_cast<std::size_t>(ja[static_cast<std::size_t>(k)]) == i)
+                    {
+                        d += a[static_cast<std::size_t>(k)];
+                    }
+                }
+                result(i) = d;
+            }
+            return result;
+        }
+
+        /// Copy of the square matrix \em A with sorted column indices
+        template <class T>
+        inline xsparse_csr<T> sorted_csr(const xsparse_csr<T>& A)
+        {
+            check_sparse_square(A.shape()[0], A.shape()[1]);
+            return csr_transpose_storage(csr_transpose_storage(A, false), false);
+        }
+
+        template <class T>
+        inline bool finite_pivot(const T& d)
+        {
+            double m = static_cast<double>(std::abs(d));
+            return m > 0. && m <= std::numeric_limits<double>::max();
+        }
+
+        /**
+         * Computes the elements of an incomplete factorization stored in
+         * \em v, on the rows of the CSR offsets \em ia, where update(i, p, v)
+         * is element p, of row i, given the current elements. With no sweeps
+         * the elements are updated in place in storage order, so that every
+         * one is computed from final ones; otherwise each sweep computes all
+         * of them from the previous sweep (Chow and Patel).
+         */
+        template <class V, class F>
+        inline void incomplete_sweeps(const blas_index_t* ia, std::size_t n, V& v, std::size_t sweeps, F update)
+        {
+            if (sweeps == 0)
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    for (auto p = static_cast<std::size_t>(ia[i]); p < static_cast<std::size_t>(ia[i + 1]); ++p)
+                    {
+                        v[p] = update(i, p, v.data());
+                    }
+                }
+                return;
+            }
+            V next(v.size());
+            for (std::size_t s = 0; s < sweeps; ++s)
+            {
+                const auto* current = v.data();
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp parallel for schedule(dynamic, 64)
+#endif
+                for (std::ptrdiff_t r = 0; r < static_cast<std::ptrdiff_t>(n); ++r)
+                {
+                    std::size_t i = static_cast<std::size_t>(r);
+                    for (auto p = static_cast<std::size_t>(ia[i]); p < static_cast<std::size_t>(ia[i + 1]); ++p)
+                    {
+                        next[p] = update(i, p, current);
+                    }
+                }
+                std::swap(v, next);
+            }
+        }
+
+        /**
+         * Element p, in row i, of the IC(0) factor L, stored as the lower
+         * triangle with sorted columns: l_ij = (a_ij - sum_k<j l_ik conj(l_jk)) / l_jj
+         * and l_ii = sqrt(a_ii - sum_k<i |l_ik|^2), zero if not positive.
+         */
+        template <class T>
+        inline T ic0_element(const blas_index_t* il, const blas_index_t* jl, const T* a, const T* v,
+                             std::size_t i, std::size_t p)
+        {
+            std::size_t j = static_cast<std::size_t>(jl[p]);
+            std::size_t q = static_cast<std::size_t>(il[i]);
+            std::size_t r = static_cast<std::size_t>(il[j]);
+            std::size_t diagonal = static_cast<std::size_t>(il[j + 1]) - 1;
+            T s = a[p];
+            while (q < p && r < diagonal)
+            {
+                if (jl[q] == jl[r])
+                {
+                    s -= v[q++] * conj_value(v[r++]);
+                }
+                else if (jl[q] < jl[r])
+                {
+                    ++q;
+                }
+                else
+                {
+                    ++r;
+                }
+            }
+            if (i != j)
+            {
+                return s / v[diagonal];
+            }
+            auto d = std::real(s);
+            return d > 0 ? T(std::sqrt(d)) : T(0);
+        }
+
+        /// IC(0) factor of the lower triangle of \em A, see ic0_preconditioner
+        template <class T>
+        inline xsparse_csr<T> ic0_factor(const xsparse_csr<T>& A, std::size_t sweeps)
+        {
+            using index_storage = typename xsparse_csr<T>::index_storage;
+            using value_storage = typename xsparse_csr<T>::value_storage;
+            auto S = sorted_csr(A);
+            std::size_t n = S.shape()[0];
+            const auto& ia = S.row_offsets();
+            const auto& ja = S.column_indices();
+            const auto& sa = S.values();
+
+            index_storage offsets(n + 1, 0);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto k = ia[i];
+                while (k < ia[i + 1] && static_cast<std::size_t>(ja[static_cast<std::size_t>(k)]) <= i)
+                {
+                    ++k;
+                }
+                if (k == ia[i] || static_cast<std::size_t>(ja[static_cast<std::size_t>(k - 1)]) != i)
+                {
+                    XTENSOR_THROW(std::runtime_error, "ic0_preconditioner: missing diagonal element.");
+                }
+                offsets[i + 1] = offsets[i] + (k - ia[i]);
+            }
+            index_storage indices(static_cast<std::size_t>(offsets[n]));
+            value_storage a(indices.size());
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                std::size_t count = static_cast<std::size_t>(offsets[i + 1] - offsets[i]);
+                std::copy(ja.begin() + ia[i], ja.begin() + ia[i] + static_cast<std::ptrdiff_t>(count), indices.begin() + offsets[i]);
+                std::copy(sa.begin() + ia[i], sa.begin() + ia[i] + static_cast<std::ptrdiff_t>(count), a.begin() + offsets[i]);
+            }
+
+            value_storage v(a);
+            if (sweeps != 0)
+            {
+                // initial guess: the lower triangle scaled by the square roots of the diagonal
+                std::vector<double> root(n);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    double d = static_cast<double>(std::real(a[static_cast<std::size_t>(offsets[i + 1]) - 1]));
+                    if (!(d > 0.))
+                    {
+                        XTENSOR_THROW(std::runtime_error, "ic0_preconditioner: the matrix is not positive definite.");
+                    }
+                    root[i] = std::sqrt(d);
+                }
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    for (auto p = static_cast<std::size_t>(offsets[i]); p < static_cast<std::size_t>(offsets[i + 1]); ++p)
+                    {
+                        std::size_t j = static_cast<std::size_t>(indices[p]);
+                        v[p] = i == j ? T(root[i]) : T(a[p] / root[j]);
+                    }
+                }
+            }
+            const blas_index_t* il = offsets.data();
+            const blas_index_t* jl = indices.data();
+            const T* pa = a.data();
+            incomplete_sweeps(il, n, v, sweeps, [il, jl, pa](std::size_t i, std::size_t p, const T* current) {
+                return ic0_element(il, jl, pa, current, i, p);
+            });
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                bool finite = true;
+                for (auto p = static_cast<std::size_t>(offsets[i]); p + 1 < static_cast<std::size_t>(offsets[i + 1]); ++p)
+                {
+                    finite = finite && static_cast<double>(std::abs(v[p])) <= std::numeric_limits<double>::max();
+                }
+                if (!finite || !finite_pivot(v[static_cast<std::size_t>(offsets[i + 1]) - 1]))
+                {
+                    XTENSOR_THROW(std::runtime_error, "ic0_preconditioner: the matrix is not positive definite.");
+                }
+            }
+            return xsparse_csr<T>(n, n, std::move(v), std::move(offsets), std::move(indices));
+        }
+
+        /**
+         * Column structure of the upper triangle, diagonal included, of the
+         * CSR matrix with sorted columns \em A: the rows and storage
+         * positions of the elements of column j are rows[k] and positions[k]
+         * for offsets[j] <= k < offsets[j + 1], by increasing row.
+         */
+        struct csr_upper_columns
+        {
+            std::vector<std::size_t> offsets;
+            std::vector<std::size_t> rows;
+            std::vector<std::size_t> positions;
+        };
+
+        template <class T>
+        inline csr_upper_columns upper_columns(const xsparse_csr<T>& A)
+        {
+            std::size_t n = A.shape()[0];
+            const auto& ia = A.row_offsets();
+            const auto& ja = A.column_indices();
+            csr_upper_columns result;
+            result.offsets.assign(n + 1, 0);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                {
+                    std::size_t j = static_cast<std::size_t>(ja[static_cast<std::size_t>(k)]);
+                    result.offsets[j + 1] += j >= i;
+                }
+            }
+            std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+            std::vector<std::size_t> next(result.offsets.begin(), result.offsets.end() - 1);
+            result.rows.resize(result.offsets[n]);
+            result.positions.resize(result.offsets[n]);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                {
+                    std::size_t j = static_cast<std::size_t>(ja[static_cast<std::size_t>(k)]);
+                    if (j >= i)
+                    {
+                        result.rows[next[j]] = i;
+                        result.positions[next[j]++] = static_cast<std::size_t>(k);
+                    }
+                }
+            }
+            return result;
+        }
+
+        /**
+         * Element p, in row i, of the ILU(0) factors stored in the pattern of
+         * the matrix with sorted columns, L without its unit diagonal:
+         * l_ij = (a_ij - sum_k<j l_ik u_kj) / u_jj and u_ij = a_ij - sum_k<i l_ik u_kj.
+         */
+        template <class T>
+        inline T ilu0_element(const blas_index_t* ia, const blas_index_t* ja, const std::size_t* diagonal,
+                              const csr_upper_columns& u, const T* a, const T* v, std::size_t i, std::size_t p)
+        {
+            std::size_t j = static_cast<std::size_t>(ja[p]);
+            std::size_t end = std::min(i, j);
+            std::size_t q = static_cast<std::size_t>(ia[i]);
+            std::size_t r = u.offsets[j];
+            T s = a[p];
+            while (q < diagonal[i] && r < u.offsets[j + 1])
+            {
+                std::size_t kq = static_cast<std::size_t>(ja[q]);
+                std::size_t kr = u.rows[r];
+                if (kq >= end || kr >= end)
+                {
+                    break;
+                }
+                if (kq == kr)
+                {
+                    s -= v[q++] * v[u.positions[r++]];
+                }
+                else if (kq < kr)
+                {
+                    ++q;
+                }
+                else
+                {
+                    ++r;
+                }
+            }
+            return i > j ? s / v[diagonal[j]] : s;
+        }
+
+        /// ILU(0) factors of \em A, see ilu0_preconditioner
+        template <class T>
+        inline xsparse_csr<T> ilu0_factors(const xsparse_csr<T>& A, std::size_t sweeps)
+        {
+            using value_storage = typename xsparse_csr<T>::value_storage;
+            auto S = sorted_csr(A);
+            std::size_t n = S.shape()[0];
+            const auto& ia = S.row_offsets();
+            const auto& ja = S.column_indices();
+
+            std::vector<std::size_t> diagonal(n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto first = ja.begin() + ia[i];
+                auto last = ja.begin() + ia[i + 1];
+                auto it = std::lower_bound(first, last, to_blas_index(i));
+                if (it == last || static_cast<std::size_t>(*it) != i)
+                {
+                    XTENSOR_THROW(std::runtime_error, "ilu0_preconditioner: missing diagonal element.");
+                }
+                diagonal[i] = static_cast<std::size_t>(it - ja.begin());
+            }
+            csr_upper_columns u = upper_columns(S);
+
+            const value_storage& a = S.values();
+            value_storage v(a);
+            if (sweeps != 0)
+            {
+                // initial guess: the strict lower triangle scaled by the diagonal, and the upper one
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    if (a[diagonal[i]] == T(0))
+                    {
+                        XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+                    }
+                    for (auto p = static_cast<std::size_t>(ia[i]); p < diagonal[i]; ++p)
+                    {
+                        v[p] = a[p] / a[diagonal[static_cast<std::size_t>(ja[p])]];
+                    }
+                }
+            }
+            const blas_index_t* pia = ia.data();
+            const blas_index_t* pja = ja.data();
+            const std::size_t* pd = diagonal.data();
+            const T* pa = a.data();
+            incomplete_sweeps(pia, n, v, sweeps, [pia, pja, pd, &u, pa](std::size_t i, std::size_t p, const T* current) {
+                return ilu0_element(pia, pja, pd, u, pa, current, i, p);
+            });
+
+            for (std::size_t p = 0; p < v.size(); ++p)
+            {
+                if (!(static_cast<double>(std::abs(v[p])) <= std::numeric_limits<double>::max()))
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+                }
+            }
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (!finite_pivot(v[diagonal[i]]))
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+                }
+            }
+            return xsparse_csr<T>(n, n, std::move(v), S.row_offsets(), S.column_indices());
+        }
+
+        /// Keeps the \em fill elements of largest magnitude, then sorts them by column.
+        inline void keep_largest(std::vector<std::pair<double, std::size_t>>& elements, std::size_t fill)
+        {
+            if (elements.size() > fill)
+            {
+                std::nth_element(elements.begin(), elements.begin() + static_cast<std::ptrdiff_t>(fill), elements.end(),
+                                 [](const auto& l, const auto& r) { return l.first > r.first; });
+                elements.resize(fill);
+            }
+            std::sort(elements.begin(), elements.end(),
+                      [](const auto& l, const auto& r) { return l.second < r.second; });
+        }
+
+        /// ILUT factors of \em A, stored as those of ILU(0), see ilut_preconditioner
+        template <class T>
+        inline xsparse_csr<T> ilut_factors(const xsparse_csr<T>& A, double tau, std::size_t fill)
+        {
+            using index_storage = typename xsparse_csr<T>::index_storage;
+            using value_storage = typename xsparse_csr<T>::value_storage;
+            check_sparse_square(A.shape()[0], A.shape()[1]);
+            if (!(tau >= 0.))
+            {
+                XTENSOR_THROW(std::runtime_error, "ilut_preconditioner: tau must be nonnegative.");
+            }
+            std::size_t n = A.shape()[0];
+            const auto& ia = A.row_offsets();
+            const auto& ja = A.column_indices();
+            const auto& a = A.values();
+
+            // rows of U as they are computed, their diagonal first
+            std::vector<std::size_t> u_offsets(1, 0);
+            std::vector<std::size_t> u_indices;
+            std::vector<T> u_values;
+            std::vector<blas_index_t> offsets(1, 0);
+            std::vector<blas_index_t> indices;
+            std::vector<T> values;
+
+            // the current row, densely, and the columns of its nonzeros
+            std::vector<T> w(n, T(0));
+            std::vector<char> stored(n, 0);
+            std::vector<std::size_t> pattern;
+            std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<std::size_t>> pending;
+            std::vector<std::pair<double, std::size_t>> kept;
+            auto insert = [&](std::size_t j, std::size_t i) {
+                if (!stored[j])
+                {
+                    stored[j] = 1;
+                    pattern.push_back(j);
+                    if (j < i)
+                    {
+                        pending.push(j);
+                    }
+                }
+            };
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                double norm = 0.;
+                for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                {
+                    std::size_t j = static_cast<std::size_t>(ja[static_cast<std::size_t>(k)]);
+                    insert(j, i);
+                    w[j] += a[static_cast<std::size_t>(k)];
+                    double m = static_cast<double>(std::abs(a[static_cast<std::size_t>(k)]));
+                    norm += m * m;
+                }
+                norm = std::sqrt(norm);
+                if (norm == 0.)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+                }
+                double drop = tau * norm;
+
+                // eliminate the columns left of the diagonal in increasing order, fill-in included
+                while (!pending.empty())
+                {
+                    std::size_t k = pending.top();
+                    pending.pop();
+                    T l = w[k] / u_values[u_offsets[k]];
+                    w[k] = T(0);
+                    if (static_cast<double>(std::abs(l)) < drop || l == T(0))
+                    {
+                        continue;
+                    }
+                    w[k] = l;
+                    for (std::size_t q = u_offsets[k] + 1; q < u_offsets[k + 1]; ++q)
+                    {
+                        insert(u_indices[q], i);
+                        w[u_indices[q]] -= l * u_values[q];
+                    }
+                }
+
+                kept.clear();
+                for (std::size_t j : pattern)
+                {
+                    if (j < i && w[j] != T(0))
+                    {
+                        kept.emplace_back(static_cast<double>(std::abs(w[j])), j);
+                    }
+                }
+                keep_largest(kept, fill);
+                for (const auto& e : kept)
+                {
+                    indices.push_back(to_blas_index(e.second));
+                    values.push_back(w[e.second]);
+                }
+
+                T pivot = w[i];
+                if (pivot == T(0))
+                {
+                    pivot = T(drop > 0. ? drop : norm);
+                }
+                indices.push_back(to_blas_index(i));
+                values.push_back(pivot);
+                u_indices.push_back(i);
+                u_values.push_back(pivot);
+
+                kept.clear();
+                for (std::size_t j : pattern)
+                {
+                    double m = static_cast<double>(std::abs(w[j]));
+                    if (j > i && m >= drop && w[j] != T(0))
+                    {
+                        kept.emplace_back(m, j);
+                    }
+                }
+                keep_largest(kept, fill);
+                for (const auto& e : kept)
+                {
+                    indices.push_back(to_blas_index(e.second));
+                    values.push_back(w[e.second]);
+                    u_indices.push_back(e.second);
+                    u_values.push_back(w[e.second]);
+                }
+                u_offsets.push_back(u_indices.size());
+                offsets.push_back(to_blas_index(indices.size()));
+
+                for (std::size_t j : pattern)
+                {
+                    w[j] = T(0);
+                    stored[j] = 0;
+                }
+                pattern.clear();
+            }
+            return xsparse_csr<T>(n, n, value_storage(values.begin(), values.end()),
+                                  index_storage(offsets.begin(), offsets.end()),
+                                  index_storage(indices.begin(), indices.end()));
+        }
+    }
+
+    /**
+     * Builds the preconditioner of the sparse matrix \em A from its
+     * diagonal, which must have no zero element.
+     */
+    template <class T>
+    inline jacobi_preconditioner<T>::jacobi_preconditioner(const xsparse_csr<T>& A)
+        : jacobi_preconditioner(detail::sparse_diagonal(A))
+    {
+    }
+
+    /**
+     * Inverts the diagonal blocks of order \em block_size of \em A.
+     */
+    template <class T>
+    inline block_jacobi_preconditioner<T>::block_jacobi_preconditioner(const xsparse_csr<T>& A, size_type block_size)
+        : m_size(A.shape()[0]), m_block_size(block_size)
+    {
+        detail::check_sparse_square(A.shape()[0], A.shape()[1]);
+        if (block_size == 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "block_jacobi_preconditioner: the block size must be positive.");
+        }
+        size_type b = block_size;
+        size_type count = (m_size + b - 1) / b;
+        xtensor<T, 3> blocks = zeros<T>({count, b, b});
+        // the missing rows of the last block are those of the identity
+        for (size_type i = m_size; i < count * b; ++i)
+        {
+            blocks(count - 1, i % b, i % b) = T(1);
+        }
+        const auto& ia = A.row_offsets();
+        const auto& ja = A.column_indices();
+        const auto& a = A.values();
+        for (size_type i = 0; i < m_size; ++i)
+        {
+            for (auto k = ia[i]; k < ia[i + 1]; ++k)
+            {
+                size_type j = static_cast<size_type>(ja[static_cast<size_type>(k)]);
+                if (j / b == i / b)
+                {
+                    blocks(i / b, i % b, j % b) += a[static_cast<size_type>(k)];
+                }
+            }
+        }
+        m_inverse = batch_inv(blocks);
+    }
+
+    template <class T>
+    inline auto block_jacobi_preconditioner<T>::block_size() const noexcept -> size_type
+    {
+        return m_block_size;
+    }
+
+    /// The inverses of the diagonal blocks, of shape (blocks, block_size, block_size)
+    template <class T>
+    inline auto block_jacobi_preconditioner<T>::inverse_blocks() const noexcept -> const xtensor<T, 3>&
+    {
+        return m_inverse;
+    }
+
+    template <class T>
+    inline void block_jacobi_preconditioner<T>::apply(const vector_type& x, vector_type& y) const
+    {
+        size_type b = m_block_size;
+        size_type count = m_inverse.shape()[0];
+        const T* inverse = m_inverse.data();
+        const T* px = x.data();
+        T* py = y.data();
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t k = 0; k < static_cast<std::ptrdiff_t>(count); ++k)
+        {
+            size_type first = static_cast<size_type>(k) * b;
+            size_type rows = std::min(b, m_size - first);
+            const T* block = inverse + static_cast<size_type>(k) * b * b;
+            for (size_type r = 0; r < rows; ++r)
+            {
+                T s(0);
+                for (size_type c = 0; c < rows; ++c)
+                {
+                    s += block[r * b + c] * px[first + c];
+                }
+                py[first + r] = s;
+            }
+        }
+    }
+
+    /**
+     * Factors the lower triangle of \em A, which must store the diagonal.
+     * @param sweeps number of parallel fixed-point sweeps, 0 for the exact
+     *        IC(0) factor computed row by row
+     */
+    template <class T>
+    inline ic0_preconditioner<T>::ic0_preconditioner(const xsparse_csr<T>& A, size_type sweeps)
+        : m_factor(detail::ic0_factor(A, sweeps)),
+          m_lower(m_factor, 'L'),
+          m_upper(detail::csr_transpose_storage(m_factor, true), 'U')
+    {
+    }
+
+    /// The factor L, lower triangular
+    template <class T>
+    inline auto ic0_preconditioner<T>::factor() const noexcept -> const xsparse_csr<T>&
+    {
+        return m_factor;
+    }
+
+    /// y = (L L^H)^-1 x
+    template <class T>
+    inline void ic0_preconditioner<T>::apply(const vector_type& x, vector_type& y) const
+    {
+        vector_type z = vector_type::from_shape({x.size()});
+        m_lower.solve(x.data(), z.data());
+        m_upper.solve(z.data(), y.data());
+    }
+
+    /**
+     * Factors \em A, which must store its diagonal.
+     * @param sweeps number of parallel fixed-point sweeps, 0 for the exact
+     *        ILU(0) factors computed row by row
+     */
+    template <class T>
+    inline ilu0_preconditioner<T>::ilu0_preconditioner(const xsparse_csr<T>& A, size_type sweeps)
+        : m_factors(detail::ilu0_factors(A, sweeps)),
+          m_lower(m_factors, 'L', true),
+          m_upper(m_factors, 'U')
+    {
+    }
+
+    /**
+     * The factors in the pattern of the matrix: L below the diagonal,
+     * without its unit diagonal, and U on and above it.
+     */
+    template <class T>
+    inline auto ilu0_preconditioner<T>::factors() const noexcept -> const xsparse_csr<T>&
+    {
+        return m_factors;
+    }
+
+    /// y = (L U)^-1 x
+    template <class T>
+    inline void ilu0_preconditioner<T>::apply(const vector_type& x, vector_type& y) const
+    {
+        vector_type z = vector_type::from_shape({x.size()});
+        m_lower.solve(x.data(), z.data());
+        m_upper.solve(z.data(), y.data());
+    }
+
+    /**
+     * Factors \em A.
+     * @param tau drop tolerance, relative to the norm of each row
+     * @param fill largest number of elements per row of L and of U, besides
+     *        the diagonal
+     */
+    template <class T>
+    inline ilut_preconditioner<T>::ilut_preconditioner(const xsparse_csr<T>& A, double tau, size_type fill)
+        : m_factors(detail::ilut_factors(A, tau, fill)),
+          m_lower(m_factors, 'L', true),
+          m_upper(m_factors, 'U')
+    {
+    }
+
+    /// The factors, stored as those of ilu0_preconditioner
+    template <class T>
+    inline auto ilut_preconditioner<T>::factors() const noexcept -> const xsparse_csr<T>&
+    {
+        return m_factors;
+    }
+
+    /// y = (L U)^-1 x
+    template <class T>
+    inline void ilut_preconditioner<T>::apply(const vector_type& x, vector_type& y) const
+    {
+        vector_type z = vector_type::from_shape({x.size()});
+        m_lower.solve(x.data(), z.data());
+        m_upper.solve(z.data(), y.data());
+    }
+
+    /******************
+     * Krylov solvers *
+     ******************/
+
+    /// Stopping criteria of the Krylov solvers
+    struct krylov_options
+    {
+        double rtol = 1e-8;              ///< Stop when ||b - A x|| <= max(rtol ||b||, atol)
+        double atol = 0.;                ///< Absolute tolerance on the residual norm
+        std::size_t max_iterations = 0;  ///< Limit on the products with A, 0 for 10 n
+        std::size_t restart = 30;        ///< Krylov subspace dimension of gmres
+    };
+
+    /// Outcome of a Krylov solver
+    struct krylov_info
+    {
+        bool converged = false;        ///< Whether the tolerance was reached
+        std::size_t iterations = 0;    ///< Number of iterations (products with A)
+        double residual_norm = 0.;     ///< ||b - A x|| of the returned x
+    };
+
+    namespace detail
+    {
+        /*
+         * Vectors and state shared by the solvers: the right hand side, the
+         * residual r = b - A x and the target residual norm.
+         */
+        template <class T>
+        struct krylov_state
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            using vector_type = xtensor<T, 1>;
+
+            template <class A, class E>
+            krylov_state(const A& a, const xexpression<E>& xb, vector_type& x, const krylov_options& options)
+                : b(xb.derived_cast())
+            {
+                std::size_t n = b.size();
+                if (a.shape()[0] != n || a.shape()[1] != n)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Krylov solver: the operator must be square, of the size of b.");
+                }
+                if (x.size() == 0)
+                {
+                    x = xtensor<T, 1>::from_shape({n});
+                    x.fill(T(0));
+                }
+                else if (x.size() != n)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Krylov solver: the initial guess must have the size of b.");
+                }
+                r = vector_type::from_shape({n});
+                residual(a, x);
+                target = std::max(options.rtol * double(krylov_norm(b)), options.atol);
+                max_iterations = options.max_iterations == 0 ? 10 * n : options.max_iterations;
+            }
+
+            // r := b - A x
+            template <class A>
+            void residual(const A& a, const vector_type& x)
+            {
+                krylov_apply(a, x, r);
+                krylov_axpby(T(1), b, T(-1), r);
+            }
+
+            bool done(double norm) const
+            {
+                return norm <= target;
+            }
+
+            template <class A>
+            krylov_info finish(const A& a, const vector_type& x, bool converged, std::size_t iterations)
+            {
+                residual(a, x);
+                krylov_info info;
+                info.converged = converged;
+                info.iterations = iterations;
+                info.residual_norm = double(krylov_norm(r));
+                return info;
+            }
+
+            vector_type b;
+            vector_type r;
+            double target;
+            std::size_t max_iterations;
+        };
+    }
+
+    /**
+     * Solves A x = b by the preconditioned conjugate gradient method, for a
+     * symmetric (Hermitian) positive definite operator \em a and
+     * preconditioner \em m.
+     *
+     * The work vectors are allocated once; an iteration takes one product
+     * with \em a, one application of \em m, two dot products and three
+     * axpy / axpby updates.
+     *
+     * @param a operator, see linear_operator
+     * @param b right hand side
+     * @param x initial guess, zero if empty, overwritten by the solution
+     * @param options stopping criteria
+     * @param m preconditioner, any operator approximating the inverse of \em a
+     * @return convergence information
+     */
+    template <class A, class E, class T, class M = identity_preconditioner>
+    krylov_info cg(const A& a, const xexpression<E>& b, xtensor<T, 1>& x,
+                   const krylov_options& options = krylov_options(), const M& m = M())
+    {
+        using real_type = xtl::complex_value_type_t<T>;
+        using vector_type = xtensor<T, 1>;
+
+        detail::krylov_state<T> s(a, b, x, options);
+        std::size_t n = x.size();
+        vector_type z = vector_type::from_shape({n});
+        vector_type p = vector_type::from_shape({n});
+        vector_type q = vector_type::from_shape({n});
+
+        if (s.done(double(detail::krylov_norm(s.r))))
+        {
+            return s.finish(a, x, true, 0);
+        }
+        detail::krylov_apply(m, s.r, z);
+        p = z;
+        real_type rz = std::real(detail::krylov_dot(s.r, z));
+
+        std::size_t it = 0;
+        bool converged = false;
+        while (it < s.max_iterations)
+        {
+            detail::krylov_apply(a, p, q);
+            ++it;
+            real_type pq = std::real(detail::krylov_dot(p, q));
+            if (pq == real_type(0))
+            {
+                break;
+            }
+            T alpha = T(rz / pq);
+            detail::krylov_axpy(alpha, p, x);
+            detail::krylov_axpy(T(-alpha), q, s.r);
+            if (s.done(double(detail::krylov_norm(s.r))))
+            {
+                converged = true;
+                break;
+            }
+            detail::krylov_apply(m, s.r, z);
+            real_type rz_next = std::real(detail::krylov_dot(s.r, z));
+            detail::krylov_axpby(T(1), z, T(rz_next / rz), p);
+            rz = rz_next;
+        }
+        return s.finish(a, x, converged, it);
+    }
+
+    /**
+     * Solves A x = b by the preconditioned minimal residual method
+     * (Paige and Saunders), for a symmetric (Hermitian), possibly
+     * indefinite operator \em a and a positive definite preconditioner
+     * \em m. The iteration follows Elman, Silvester and Wathen, Finite
+     * Elements and Fast Iterative Solvers, algorithm 2.4, and stops on its
+     * estimate of the residual, exact without preconditioner.
+     *
+     * @param a operator, see linear_operator
+     * @param b right hand side
+     * @param x initial guess, zero if empty, overwritten by the solution
+     * @param options stopping criteria
+     * @param m preconditioner, positive definite
+     * @return convergence information
+     */
+    template <class A, class E, class T, class M = identity_preconditioner>
+    krylov_info minres(const A& a, const xexpression<E>& b, xtensor<T, 1>& x,
+                       const krylov_options& options = krylov_options(), const M& m = M())
+    {
+        using real_type = xtl::complex_value_type_t<T>;
+        using vector_type = xtensor<T, 1>;
+
+        detail::krylov_state<T> s(a, b, x, options);
+        std::size_t n = x.size();
+        real_type r0 = detail::krylov_norm(s.r);
+        if (s.done(double(r0)))
+        {
+            return s.finish(a, x, true, 0);
+        }
+
+        // Lanczos vectors v and z = M^-1 v, and the search directions w
+        vector_type v_prev = vector_type::from_shape({n});
+        vector_type v = s.r;
+        vector_type v_next = vector_type::from_shape({n});
+        vector_type z = vector_type::from_shape({n});
+        vector_type z_next = vector_type::from_shape({n});
+        vector_type az = vector_type::from_shape({n});
+        vector_type w_prev = vector_type::from_shape({n});
+        vector_type w = vector_type::from_shape({n});
+        vector_type w_next = vector_type::from_shape({n});
+        v_prev.fill(T(0));
+        w_prev.fill(T(0));
+        w.fill(T(0));
+
+        detail::krylov_apply(m, v, z);
+        real_type zv = std::real(detail::krylov_dot(z, v));
+        if (zv <= real_type(0))
+        {
+            XTENSOR_THROW(std::runtime_error, "minres: the preconditioner is not positive definite.");
+        }
+        real_type gamma_prev = 1, gamma = std::sqrt(zv);
+        // the estimate |eta| is in the M^-1 norm, scaled to that of r0
+        real_type eta = gamma, scale = r0 / gamma;
+        real_type c_prev = 1, c = 1, s_prev = 0, s_ = 0;
+
+        std::size_t it = 0;
+        bool converged = false;
+        while (it < s.max_iterations)
+        {
+            detail::krylov_scal(T(real_type(1) / gamma), z);
+            detail::krylov_apply(a, z, az);
+            ++it;
+            real_type delta = std::real(detail::krylov_dot(z, az));
+
+            // v_next = A z - delta / gamma v - gamma / gamma_prev v_prev
+            v_next = az;
+            detail::krylov_axpy(T(-delta / gamma), v, v_next);
+            detail::krylov_axpy(T(-gamma / gamma_prev), v_prev, v_next);
+            detail::krylov_apply(m, v_next, z_next);
+            zv = std::real(detail::krylov_dot(z_next, v_next));
+            if (zv < real_type(0))
+            {
+                XTENSOR_THROW(std::runtime_error, "minres: the preconditioner is not positive definite.");
+            }
+            real_type gamma_next = std::sqrt(zv);
+
+            // QR factorization of the tridiagonal Lanczos matrix by rotations
+            real_type alpha0 = c * delta - c_prev * s_ * gamma;
+            real_type alpha1 = std::sqrt(alpha0 * alpha0 + gamma_next * gamma_next);
+            real_type alpha2 = s_ * delta + c_prev * c * gamma;
+            real_type alpha3 = s_prev * gamma;
+            if (alpha1 == real_type(0))
+            {
+                break;
+            }
+            real_type c_next = alpha0 / alpha1, s_next = gamma_next / alpha1;
+
+            // w_next = (z - alpha3 w_prev - alpha2 w) / alpha1
+            w_next = z;
+            detail::krylov_axpy(T(-alpha3), w_prev, w_next);
+            detail::krylov_axpy(T(-alpha2), w, w_next);
+            detail::krylov_scal(T(real_type(1) / alpha1), w_next);
+            detail::krylov_axpy(T(c_next * eta), w_next, x);
+            eta = -s_next * eta;
+
+            if (s.done(double(std::abs(eta) * scale)) || gamma_next == real_type(0))
+            {
+                converged = true;
+                break;
+            }
+
+            std::swap(v_prev, v);
+            std::swap(v, v_next);
+            std::swap(z, z_next);
+            std::swap(w_prev, w);
+            std::swap(w, w_next);
+            gamma_prev = gamma;
+            gamma = gamma_next;
+            c_prev = c;
+            c = c_next;
+            s_prev = s_;
+            s_ = s_next;
+        }
+        return s.finish(a, x, converged, it);
+    }
+
+    namespace detail
+    {
+        // rotation [c s; -conj(s) c] taking (a, b) to (r, 0)
+        template <class T>
+        inline void krylov_givens(const T& a, const T& b, xtl::complex_value_type_t<T>& c, T& s)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            real_type abs_a = std::abs(a), abs_b = std::abs(b);
+            if (abs_b == real_type(0))
+            {
+                c = 1;
+                s = T(0);
+            }
+            else if (abs_a == real_type(0))
+            {
+                c = 0;
+                s = conj_value(b) / T(abs_b);
+            }
+            else
+            {
+                real_type norm = std::hypot(abs_a, abs_b);
+                c = abs_a / norm;
+                s = (a / T(abs_a)) * conj_value(b) / T(norm);
+            }
+        }
+
+        template <class T>
+        inline void krylov_rotate(xtl::complex_value_type_t<T> c, const T& s, T& x, T& y)
+        {
+            T t = c * x + s * y;
+            y = -conj_value(s) * x + c * y;
+            x = t;
+        }
+
+        /*
+         * Orthogonalizes w against the rows 0, ..., j - 1 of V by classical
+         * Gram-Schmidt done twice, two gemv per pass; h receives the
+         * coefficients. Returns the norm of the orthogonalized w.
+         */
+        template <class T>
+        inline xtl::complex_value_type_t<T> krylov_orthogonalize(const xtensor<T, 2, layout_type::row_major>& V,
+                                                                 std::size_t j, xtensor<T, 1>& w,
+                                                                 xtensor<T, 1>& h, xtensor<T, 1>& work)
+        {
+            blas_index_t n = to_blas_index(w.size());
+            blas_index_t k = to_blas_index(j);
+            std::fill(h.begin(), h.begin() + std::ptrdiff_t(j), T(0));
+            for (int pass = 0; pass < 2 && j > 0; ++pass)
+            {
+                // the rows of V are the columns of a column-major n x j matrix
+                cxxblas::gemv<blas_index_t>(cxxblas::ColMajor, cxxblas::ConjTrans, n, k,
+                                            T(1), V.data(), n, w.data(), 1, T(0), work.data(), 1);
+                cxxblas::gemv<blas_index_t>(cxxblas::ColMajor, cxxblas::NoTrans, n, k,
+                                            T(-1), V.data(), n, work.data(), 1, T(1), w.data(), 1);
+                for (std::size_t i = 0; i < j; ++i)
+                {
+                    h(i) += work(i);
+                }
+            }
+            return krylov_norm(w);
+        }
+    }
+
+    /**
+     * Solves A x = b by the restarted generalized minimal residual method
+     * GMRES(restart), for any nonsingular operator \em a. The preconditioner
+     * is applied on the right, so that the residual norm monitored is the
+     * true one. The Arnoldi basis is orthogonalized by classical
+     * Gram-Schmidt done twice, as two gemv per pass rather than a dot and
+     * an axpy per basis vector, and stored in a single matrix reused by
+     * every cycle.
+     *
+     * @param a operator, see linear_operator
+     * @param b right hand side
+     * @param x initial guess, zero if empty, overwritten by the solution
+     * @param options stopping criteria and restart length
+     * @param m preconditioner
+     * @return convergence information, with the total number of inner
+     *         iterations
+     */
+    template <class A, class E, class T, class M = identity_preconditioner>
+    krylov_info gmres(const A& a, const xexpression<E>& b, xtensor<T, 1>& x,
+                      const krylov_options& options = krylov_options(), const M& m = M())
+    {
+        using real_type = xtl::complex_value_type_t<T>;
+        using vector_type = xtensor<T, 1>;
+
+        detail::krylov_state<T> s(a, b, x, options);
+        std::size_t n = x.size();
+        std::size_t k = std::max(std::size_t(1), std::min(options.restart, n));
+
+        // basis vectors are the rows of V, H is the Hessenberg matrix
+        xtensor<T, 2, layout_type::row_major> V = xtensor<T, 2, layout_type::row_major>::from_shape({k + 1, n});
+        xtensor<T, 2> H = xtensor<T, 2>::from_shape({k + 1, k});
+        xtensor<T, 1> g = xtensor<T, 1>::from_shape({k + 1});
+        xtensor<real_type, 1> cs = xtensor<real_type, 1>::from_shape({k});
+        xtensor<T, 1> sn = xtensor<T, 1>::from_shape({k});
+        vector_type v = vector_type::from_shape({n});
+        vector_type z = vector_type::from_shape({n});
+        vector_type w = vector_type::from_shape({n});
+        vector_type coefficients = vector_type::from_shape({k + 1});
+        vector_type work = vector_type::from_shape({k + 1});
+
+        auto row = [&V, n](std::size_t i) { return V.data() + i * n; };
+
+        std::size_t it = 0;
+        bool converged = false;
+        real_type beta = detail::krylov_norm(s.r);
+        while (true)
+        {
+            if (s.done(double(beta)))
+            {
+                converged = true;
+                break;
+            }
+            if (it >= s.max_iterations)
+            {
+                break;
+            }
+            std::copy(s.r.begin(), s.r.end(), row(0));
+            cxxblas::scal<blas_index_t>(to_blas_index(n), T(real_type(1) / beta), row(0), 1);
+            g.fill(T(0));
+            g(0) = beta;
+
+            std::size_t j = 0;
+            bool breakdown = false;
+            for (; j < k && it < s.max_iterations; ++j)
+            {
+                std::copy(row(j), row(j) + n, v.begin());
+                detail::krylov_apply(m, v, z);
+                detail::krylov_apply(a, z, w);
+                ++it;
+                real_type h = detail::krylov_orthogonalize(V, j + 1, w, coefficients, work);
+                for (std::size_t i = 0; i <= j; ++i)
+                {
+                    H(i, j) = coefficients(i);
+                }
+                H(j + 1, j) = h;
+                if (h != real_type(0))
+                {
+                    std::copy(w.begin(), w.end(), row(j + 1));
+                    cxxblas::scal<blas_index_t>(to_blas_index(n), T(real_type(1) / h), row(j + 1), 1);
+                }
+
+                for (std::size_t i = 0; i < j; ++i)
+                {
+                    detail::krylov_rotate(cs(i), sn(i), H(i, j), H(i + 1, j));
+                }
+                detail::krylov_givens(H(j, j), H(j + 1, j), cs(j), sn(j));
+                detail::krylov_rotate(cs(j), sn(j), H(j, j), H(j + 1, j));
+                detail::krylov_rotate(cs(j), sn(j), g(j), g(j + 1));
+                if (s.done(double(std::abs(g(j + 1)))) || h == real_type(0))
+                {
+                    breakdown = h == real_type(0);
+                    ++j;
+                    break;
+                }
+            }
+
+            // x += M^-1 V y for the triangular H(0:j, 0:j) y = g(0:j)
+            for (std::size_t i = j; i-- > 0;)
+            {
+                T sum = g(i);
+                for (std::size_t l = i + 1; l < j; ++l)
+                {
+                    sum -= H(i, l) * g(l);
+                }
+                g(i) = sum / H(i, i);
+            }
+            v.fill(T(0));
+            for (std::size_t i = 0; i < j; ++i)
+            {
+                cxxblas::axpy<blas_index_t>(to_blas_index(n), g(i), row(i), 1, v.data(), 1);
+            }
+            detail::krylov_apply(m, v, z);
+            detail::krylov_axpy(T(1), z, x);
+
+            s.residual(a, x);
+            beta = detail::krylov_norm(s.r);
+            if (breakdown)
+            {
+                converged = s.done(double(beta));
+                break;
+            }
+        }
+        return s.finish(a, x, converged, it);
+    }
+
+    /**
+     * Solves A x = b by the stabilized biconjugate gradient method
+     * BiCGStab (van der Vorst), for any nonsingular operator \em a, with
+     * the preconditioner applied on the right. An iteration takes two
+     * products with \em a and two applications of \em m; it is counted
+     * as two iterations.
+     *
+     * @param a operator, see linear_operator
+     * @param b right hand side
+     * @param x initial guess, zero if empty, overwritten by the solution
+     * @param options stopping criteria
+     * @param m preconditioner
+     * @return convergence information
+     */
+    template <class A, class E, class T, class M = identity_preconditioner>
+    krylov_info bicgstab(const A& a, const xexpression<E>& b, xtensor<T, 1>& x,
+                         const krylov_options& options = krylov_options(), const M& m = M())
+    {
+        using vector_type = xtensor<T, 1>;
+
+        detail::krylov_state<T> s(a, b, x, options);
+        std::size_t n = x.size();
+        if (s.done(double(detail::krylov_norm(s.r))))
+        {
+            return s.finish(a, x, true, 0);
+        }
+
+        vector_type r_hat = s.r;
+        vector_type p = vector_type::from_shape({n});
+        vector_type v = vector_type::from_shape({n});
+        vector_type p_hat = vector_type::from_shape({n});
+        vector_type s_hat = vector_type::from_shape({n});
+        vector_type t = vector_type::from_shape({n});
+        p.fill(T(0));
+        v.fill(T(0));
+        T rho(1), alpha(1), omega(1);
+
+        std::size_t it = 0;
+        bool converged = false;
+        while (it < s.max_iterations)
+        {
+            T rho_next = detail::krylov_dot(r_hat, s.r);
+            if (rho_next == T(0))
+            {
+                break;
+            }
+            // p = r + beta (p - omega v)
+            T beta = (rho_next / rho) * (alpha / omega);
+            detail::krylov_axpy(T(-omega), v, p);
+            detail::krylov_axpby(T(1), s.r, beta, p);
+
+            detail::krylov_apply(m, p, p_hat);
+            detail::krylov_apply(a, p_hat, v);
+            ++it;
+            T rv = detail::krylov_dot(r_hat, v);
+            if (rv == T(0))
+            {
+                break;
+            }
+            alpha = rho_next / rv;
+            // s = r - alpha v, kept in r
+            detail::krylov_axpy(T(-alpha), v, s.r);
+            if (s.done(double(detail::krylov_norm(s.r))))
+            {
+                detail::krylov_axpy(alpha, p_hat, x);
+                converged = true;
+                break;
+            }
+
+            detail::krylov_apply(m, s.r, s_hat);
+            detail::krylov_apply(a, s_hat, t);
+            ++it;
+            auto tt = std::real(detail::krylov_dot(t, t));
+            omega = tt == 0 ? T(0) : detail::krylov_dot(t, s.r) / T(tt);
+            detail::krylov_axpy(alpha, p_hat, x);
+            detail::krylov_axpy(omega, s_hat, x);
+            detail::krylov_axpy(T(-omega), t, s.r);
+            if (s.done(double(detail::krylov_norm(s.r))))
+            {
+                converged = true;
+                break;
+            }
+            if (omega == T(0))
+            {
+                break;
+            }
+            rho = rho_next;
+        }
+        return s.finish(a, x, converged, it);
+    }
+
+    /************************************
+     * Sketched least squares with LSQR *
+     ************************************/
+
+    /// Sketch and streaming parameters of lstsq_randomized
+    struct lstsq_randomized_options
+    {
+        double sketch_factor = 4.;     ///< Rows of the sketch per column of A
+        std::size_t block_rows = 0;    ///< Rows of A per streamed block, 0 for blocks of about 16 MiB
+        std::uint64_t seed = 0;        ///< Seed of the sketch
+    };
+
+    namespace detail
+    {
+        /*
+         * Row-major blocks of rows of a matrix expression: pointers into it
+         * when it is a row-major container, or else the rows evaluated into
+         * a buffer of block_rows rows.
+         */
+        template <class E, bool = has_data_interface<E>::value && E::static_layout == layout_type::row_major>
+        class row_block_reader
+        {
+        public:
+
+            using value_type = typename E::value_type;
+
+            row_block_reader(const E& e, std::size_t /*block_rows*/)
+                : m_data(e.data() + e.data_offset()), m_cols(e.shape()[1])
+            {
+            }
+
+            const value_type* rows(std::size_t r0, std::size_t /*r1*/)
+            {
+                return m_data + r0 * m_cols;
+            }
+
+        private:
+
+            const value_type* m_data;
+            std::size_t m_cols;
+        };
+
+        template <class E>
+        class row_block_reader<E, false>
+        {
+        public:
+
+            using value_type = typename E::value_type;
+
+            row_block_reader(const E& e, std::size_t block_rows)
+                : m_e(e), m_buffer(block_rows * e.shape()[1])
+            {
+            }
+
+            const value_type* rows(std::size_t r0, std::size_t r1)
+            {
+                std::size_t n = m_e.shape()[1];
+                std::array<std::size_t, 2> shape = {r1 - r0, n};
+                auto block = adapt<layout_type::row_major>(m_buffer.data(), (r1 - r0) * n, no_ownership(), shape);
+                noalias(block) = view(m_e, range(r0, r1), all());
+                return m_buffer.data();
+            }
+
+        private:
+
+            const E& m_e;
+            uvector<value_type> m_buffer;
+        };
+
+        // bucket and sign of row i in a CountSketch of s rows
+        inline std::pair<std::size_t, bool> count_sketch_hash(std::uint64_t seed, std::size_t i, std::size_t s)
+        {
+            std::uint64_t z = seed + 0x9E3779B97F4A7C15ull * (std::uint64_t(i) + 1);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            return {std::size_t((z >> 1) % s), (z & 1) != 0};
+        }
+    }
+
+    /**
+     * Least squares solution of an overdetermined system, min ||b - A x||
+     * for a tall m x n matrix \em A of full column rank, by sketching and
+     * preconditioned LSQR (Blendenpik, LSRN).
+     *
+     * \em A is read in blocks of rows, never copied as a whole: one pass
+     * adds each row, with a random sign, to a random row of an s x n
+     * CountSketch SA, s = sketch_factor n; the R factor of the QR
+     * decomposition of SA makes A R^-1 well conditioned, and LSQR on it
+     * converges in a few tens of iterations, independently of the condition
+     * of \em A. Each iteration is two passes over \em A by gemv. Besides
+     * the s x n sketch, the memory is one block of rows (when \em A is not
+     * a row-major container) and three vectors of size m. \em A may be any
+     * row-major readable expression, e.g. a memory map.
+     *
+     * @param A m x n real matrix expression, m >= n
+     * @param b right hand side of size m
+     * @param options stopping criteria: LSQR stops when ||A^T r|| <=
+     *        rtol ||A R^-1|| ||r||, or ||r|| <= max(rtol ||b||, atol)
+     * @param sketch sketch size, block size and seed
+     * @return tuple of the solution of size n and the convergence
+     *         information, with the residual norm ||b - A x|| computed by a
+     *         last pass
+     * @throws std::runtime_error if m < n or A is numerically rank deficient
+     */
+    template <class E, class F>
+    auto lstsq_randomized(const xexpression<E>& A, const xexpression<F>& b,
+                          const krylov_options& options = krylov_options(),
+                          const lstsq_randomized_options& sketch = lstsq_randomized_options())
+    {
+        using value_type = typename E::value_type;
+        static_assert(!xtl::is_complex<value_type>::value, "lstsq_randomized: expected a real matrix.");
+        using vector_type = xtensor<value_type, 1>;
+
+        const auto& a = A.derived_cast();
+        const auto& rhs = b.derived_cast();
+        if (a.dimension() != 2 || rhs.dimension() != 1 || rhs.shape()[0] != a.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "lstsq_randomized: expected an m x n matrix and a vector of size m.");
+        }
+        std::size_t m = a.shape()[0];
+        std::size_t n = a.shape()[1];
+        if (m < n || n == 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "lstsq_randomized: A must have at least as many rows as columns.");
+        }
+        std::size_t bm = sketch.block_rows != 0 ? sketch.block_rows
+                                                : std::max(std::size_t(1), (std::size_t(16) << 20) / (n * sizeof(value_type)));
+        bm = std::min(bm, m);
+        detail::row_block_reader<E> reader(a, bm);
+
+        // sketch SA, row-major; rows of A are summed into it in parallel by column chunks
+        std::size_t s = std::min(m, std::max(n, static_cast<std::size_t>(std::ceil(sketch.sketch_factor * double(n)))));
+        bool identity = s == m;
+        xtensor<value_type, 2> sa = xtensor<value_type, 2>::from_shape({s, n});
+        sa.fill(value_type(0));
+        std::vector<std::pair<std::size_t, bool>> buckets(bm);
+        constexpr std::size_t chunk = 64;
+        std::size_t chunks = (n + chunk - 1) / chunk;
+        for (std::size_t r0 = 0; r0 < m; r0 += bm)
+        {
+            std::size_t rows = std::min(bm, m - r0);
+            const value_type* block = reader.rows(r0, r0 + rows);
+            for (std::size_t i = 0; i < rows; ++i)
+            {
+                buckets[i] = identity ? std::make_pair(r0 + i, false) : detail::count_sketch_hash(sketch.seed, r0 + i, s);
+            }
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for
+#endif
+            for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(chunks); ++p)
+            {
+                std::size_t c0 = static_cast<std::size_t>(p) * chunk;
+                std::size_t c1 = std::min(n, c0 + chunk);
+                for (std::size_t i = 0; i < rows; ++i)
+                {
+                    const value_type* src = block + i * n;
+                    value_type* dst = sa.data() + buckets[i].first * n;
+                    if (buckets[i].second)
+                    {
+                        for (std::size_t j = c0; j < c1; ++j)
+                        {
+                            dst[j] -= src[j];
+                        }
+                    }
+                    else
+                    {
+                        for (std::size_t j = c0; j < c1; ++j)
+                        {
+                            dst[j] += src[j];
+                        }
+                    }
+                }
+            }
+        }
+
+        // preconditioner R, upper triangle of the column-major QR factor of SA
+        xtensor<value_type, 2, layout_type::column_major> r = sa;
+        sa = xtensor<value_type, 2>::from_shape({0, 0});
+        xtensor<value_type, 1> tau = xtensor<value_type, 1>::from_shape({n});
+        if (lapack::geqrf(r, tau) != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "lstsq_randomized: the QR factorization of the sketch failed.");
+        }
+        value_type rmax(0);
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            rmax = std::max(rmax, std::abs(r(j, j)));
+        }
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            if (!(std::abs(r(j, j)) > value_type(n) * std::numeric_limits<value_type>::epsilon() * rmax))
+            {
+                XTENSOR_THROW(std::runtime_error, "lstsq_randomized: A is numerically rank deficient, use lstsq.");
+            }
+        }
+        blas_index_t ldr = stride_back(r);
+        auto solve_r = [&](vector_type& x, cxxblas::Transpose trans)
+        {
+            cxxblas::trsv<blas_index_t>(cxxblas::StorageOrder::ColMajor, cxxblas::StorageUpLo::Upper, trans,
+                                        cxxblas::Diag::NonUnit, to_blas_index(n), r.data(), ldr, x.data(), 1);
+        };
+
+        // u := scale A R^-1 v + keep u, and v := R^-T A^T u, streaming over the blocks
+        vector_type z = vector_type::from_shape({n});
+        auto apply = [&](const vector_type& in, value_type scale, value_type keep, vector_type& out)
+        {
+            z = in;
+            solve_r(z, cxxblas::Transpose::NoTrans);
+            for (std::size_t r0 = 0; r0 < m; r0 += bm)
+            {
+                std::size_t rows = std::min(bm, m - r0);
+                cxxblas::gemv<blas_index_t>(cxxblas::StorageOrder::RowMajor, cxxblas::Transpose::NoTrans,
+                                            to_blas_index(rows), to_blas_index(n), scale, reader.rows(r0, r0 + rows),
+                                            to_blas_index(n), z.data(), 1, keep, out.data() + r0, 1);
+            }
+        };
+        auto apply_adjoint = [&](const vector_type& in, vector_type& out)
+        {
+            out.fill(value_type(0));
+            for (std::size_t r0 = 0; r0 < m; r0 += bm)
+            {
+                std::size_t rows = std::min(bm, m - r0);
+                cxxblas::gemv<blas_index_t>(cxxblas::StorageOrder::RowMajor, cxxblas::Transpose::Trans,
+                                            to_blas_index(rows), to_blas_index(n), value_type(1),
+                                            reader.rows(r0, r0 + rows), to_blas_index(n), in.data() + r0, 1,
+                                            value_type(1), out.data(), 1);
+            }
+            solve_r(out, cxxblas::Transpose::Trans);
+        };
+
+        // LSQR (Paige and Saunders) on min ||b - A R^-1 y||, x = R^-1 y
+        vector_type u = rhs;
+        vector_type v = vector_type::from_shape({n});
+        vector_type v_prev = vector_type::from_shape({n});
+        vector_type w = vector_type::from_shape({n});
+        vector_type y = vector_type::from_shape({n});
+        y.fill(value_type(0));
+        value_type beta = detail::krylov_norm(u);
+        double target = std::max(options.rtol * double(beta), options.atol);
+        std::size_t max_iterations = options.max_iterations == 0 ? 10 * n : options.max_iterations;
+        value_type alpha(0);
+        if (beta > value_type(0))
+        {
+            detail::krylov_scal(value_type(1) / beta, u);
+            apply_adjoint(u, v);
+            alpha = detail::krylov_norm(v);
+        }
+        if (alpha > value_type(0))
+        {
+            detail::krylov_scal(value_type(1) / alpha, v);
+        }
+        w = v;
+        value_type phibar = beta, rhobar = alpha;
+        value_type norm_estimate = alpha;
+
+        std::size_t it = 0;
+        bool converged = beta == value_type(0) || alpha == value_type(0) || double(beta) <= target;
+        while (!converged && it < max_iterations)
+        {
+            ++it;
+            apply(v, value_type(1), -alpha, u);
+            beta = detail::krylov_norm(u);
+            if (beta > value_type(0))
+            {
+                detail::krylov_scal(value_type(1) / beta, u);
+                v_prev = v;
+                apply_adjoint(u, v);
+                detail::krylov_axpy(-beta, v_prev, v);
+                alpha = detail::krylov_norm(v);
+                if (alpha > value_type(0))
+                {
+                    detail::krylov_scal(value_type(1) / alpha, v);
+                }
+            }
+            else
+            {
+                alpha = value_type(0);
+            }
+            norm_estimate = std::sqrt(norm_estimate * norm_estimate + alpha * alpha + beta * beta);
+
+            value_type rho = std::hypot(rhobar, beta);
+            value_type c = rhobar / rho;
+            value_type sn = beta / rho;
+            value_type theta = sn * alpha;
+            rhobar = -c * alpha;
+            value_type phi = c * phibar;
+            phibar = sn * phibar;
+
+            detail::krylov_axpy(phi / rho, w, y);
+            detail::krylov_axpby(value_type(1), v, -theta / rho, w);
+
+            // ||r|| = phibar and ||(A R^-1)^T r|| = phibar alpha |c|
+            converged = double(phibar) <= target ||
+                        double(alpha * std::abs(c)) <= options.rtol * double(norm_estimate) ||
+                        alpha == value_type(0);
+        }
+
+        vector_type x = y;
+        solve_r(x, cxxblas::Transpose::NoTrans);
+
+        // ||b - A x|| by a last pass
+        krylov_info info;
+        info.converged = converged;
+        info.iterations = it;
+        vector_type residual = vector_type::from_shape({bm});
+        double sum = 0.;
+        for (std::size_t r0 = 0; r0 < m; r0 += bm)
+        {
+            std::size_t rows = std::min(bm, m - r0);
+            auto rb = view(rhs, range(r0, r0 + rows));
+            std::copy(rb.begin(), rb.end(), residual.begin());
+            cxxblas::gemv<blas_index_t>(cxxblas::StorageOrder::RowMajor, cxxblas::Transpose::NoTrans,
+                                        to_blas_index(rows), to_blas_index(n), value_type(-1),
+                                        reader.rows(r0, r0 + rows), to_blas_index(n), x.data(), 1,
+                                        value_type(1), residual.data(), 1);
+            for (std::size_t i = 0; i < rows; ++i)
+            {
+                sum += double(residual(i)) * double(residual(i));
+            }
+        }
+        info.residual_norm = std::sqrt(sum);
+        return std::make_tuple(std::move(x), info);
+    }
+
+    /***********************
+     * Krylov eigensolvers *
+     ***********************/
+
+    /// Eigenvalues sought by eigsh and eigs
+    enum class eigen_target
+    {
+        largest_magnitude,  ///< Largest absolute value
+        largest_real,       ///< Largest (real part of the) eigenvalue
+        smallest_real       ///< Smallest (real part of the) eigenvalue
+    };
+
+    /// Parameters of the Krylov eigensolvers
+    struct krylov_eigen_options
+    {
+        std::size_t ncv = 0;             ///< Krylov subspace dimension, 0 for max(2 nev + 1, 20)
+        double tol = 1e-10;              ///< Accept a Ritz pair when ||A x - lambda x|| <= tol ||A||
+        std::size_t max_restarts = 1000; ///< Limit on the restart cycles
+    };
+
+    namespace detail
+    {
+        template <class A>
+        inline std::size_t krylov_eigen_size(const A& a, std::size_t nev, const krylov_eigen_options& options,
+                                             const char* name)
+        {
+            std::size_t n = a.shape()[0];
+            if (a.shape()[1] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": the operator must be square.");
+            }
+            if (nev == 0 || nev >= n)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": nev must be in [1, n).");
+            }
+            std::size_t m = options.ncv == 0 ? std::max(2 * nev + 1, std::size_t(20)) : options.ncv;
+            return std::min(n, std::max(m, nev + 1));
+        }
+
+        // deterministic pseudo-random start and restart vectors
+        template <class T>
+        inline void krylov_random_vector(xtensor<T, 1>& v, std::size_t seed)
+        {
+            std::uint64_t state = 0x9E3779B97F4A7C15ull * (seed + 1);
+            for (auto& x : v)
+            {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                x = T(double(state >> 11) / double(std::uint64_t(1) << 53) - 0.5);
+            }
+        }
+
+        /*
+         * Stores in row j + 1 of V the normalized w, of norm beta after its
+         * orthogonalization to the rows 0, ..., j and norm before it. If w
+         * vanished, the Krylov space is invariant: continues with a random
+         * vector orthogonal to it, and returns a zero coupling.
+         */
+        template <class T, class R>
+        inline R krylov_next_vector(xtensor<T, 2, layout_type::row_major>& V, std::size_t j, xtensor<T, 1>& w,
+                                    R beta, R norm, xtensor<T, 1>& h, xtensor<T, 1>& work)
+        {
+            std::size_t n = w.size();
+            T* row = V.data() + (j + 1) * n;
+            if (beta > R(64) * std::numeric_limits<R>::epsilon() * norm)
+            {
+                std::transform(w.begin(), w.end(), row, [beta](const T& x) { return x / beta; });
+                return beta;
+            }
+            krylov_random_vector(w, j + 1);
+            R fresh = krylov_orthogonalize(V, j + 1, w, h, work);
+            if (fresh > std::numeric_limits<R>::epsilon())
+            {
+                std::transform(w.begin(), w.end(), row, [fresh](const T& x) { return x / fresh; });
+            }
+            else
+            {
+                std::fill(row, row + n, T(0));
+            }
+            return R(0);
+        }
+
+        // score of an eigenvalue, the largest first
+        template <class T>
+        inline double eigen_score(const T& lambda, eigen_target which)
+        {
+            switch (which)
+            {
+                case eigen_target::largest_real:
+                    return double(std::real(lambda));
+                case eigen_target::smallest_real:
+                    return -double(std::real(lambda));
+                default:
+                    return double(std::abs(lambda));
+            }
+        }
+
+        // rows 0, ..., p - 1 of V := Y V, for Y of p x m
+        template <class T>
+        inline void krylov_rotate_basis(xtensor<T, 2, layout_type::row_major>& V, const T* Y, std::size_t p,
+                                        std::size_t m, xtensor<T, 2, layout_type::row_major>& work)
+        {
+            blas_index_t n = to_blas_index(V.shape()[1]);
+            cxxblas::gemm<blas_index_t>(cxxblas::RowMajor, cxxblas::NoTrans, cxxblas::NoTrans,
+                                        to_blas_index(p), n, to_blas_index(m), T(1), Y, to_blas_index(m),
+                                        V.data(), n, T(0), work.data(), n);
+            std::copy(work.data(), work.data() + p * V.shape()[1], V.data());
+        }
+
+        // y := A x for complex x and y, computed from the real and imaginary parts for a real A
+        template <class A, class C>
+        inline void krylov_apply_complex(const A& a, const xtensor<C, 1>& x, xtensor<C, 1>& y,
+                                         std::array<xtensor<xtl::complex_value_type_t<C>, 1>, 4>&, std::true_type)
+        {
+            krylov_apply(a, x, y);
+        }
+
+        template <class A, class C>
+        inline void krylov_apply_complex(const A& a, const xtensor<C, 1>& x, xtensor<C, 1>& y,
+                                         std::array<xtensor<xtl::complex_value_type_t<C>, 1>, 4>& parts, std::false_type)
+        {
+            for (std::size_t i = 0; i < x.size(); ++i)
+            {
+                parts[0](i) = std::real(x(i));
+                parts[1](i) = std::imag(x(i));
+            }
+            krylov_apply(a, parts[0], parts[2]);
+            krylov_apply(a, parts[1], parts[3]);
+            for (std::size_t i = 0; i < x.size(); ++i)
+            {
+                y(i) = C(parts[2](i), parts[3](i));
+            }
+        }
+
+        /*
+         * Swaps the adjacent diagonal entries k and k + 1 of the upper
+         * triangular S by a rotation, also applied to the Schur vectors Z,
+         * as LAPACK trexc.
+         */
+        template <class M>
+        inline void schur_swap(M& S, M& Z, std::size_t k)
+        {
+            using value_type = typename M::value_type;
+            std::size_t m = S.shape()[0];
+            value_type t11 = S(k, k), t22 = S(k + 1, k + 1);
+            xtl::complex_value_type_t<value_type> c;
+            value_type s;
+            krylov_givens(S(k, k + 1), value_type(t22 - t11), c, s);
+            for (std::size_t q = k + 2; q < m; ++q)
+            {
+                krylov_rotate(c, s, S(k, q), S(k + 1, q));
+            }
+            for (std::size_t q = 0; q < k; ++q)
+            {
+                krylov_rotate(c, std::conj(s), S(q, k), S(q, k + 1));
+            }
+            S(k, k) = t22;
+            S(k + 1, k + 1) = t11;
+            for (std::size_t q = 0; q < m; ++q)
+            {
+                krylov_rotate(c, std::conj(s), Z(q, k), Z(q, k + 1));
+            }
+        }
+    }
+
+    /**
+     * Computes \em nev eigenvalues of the symmetric (Hermitian) operator
+     * \em a, and their eigenvectors, by the thick-restart Lanczos method,
+     * which is equivalent to ARPACK's implicitly restarted Lanczos. Only
+     * products of \em a with vectors are needed, so \em a can be sparse
+     * or matrix-free, see linear_operator.
+     *
+     * The Lanczos basis is fully reorthogonalized by two gemv per vector,
+     * the restarts rotate it by a gemm, and the projected problem, of order
+     * ncv, is solved by syevd. The smallest eigenvalues of an operator
+     * converge slowly when they are clustered; computing the largest ones
+     * of a shifted or inverted operator is then faster.
+     *
+     * @param a symmetric (Hermitian) operator
+     * @param nev number of eigenvalues, less than the order of \em a
+     * @param which eigenvalues sought
+     * @param options subspace size, tolerance and restart limit
+     * @return tuple (w, V) of the ascending eigenvalues and the orthonormal
+     *         eigenvectors as columns of V
+     */
+    template <class A>
+    auto eigsh(const A& a, std::size_t nev, eigen_target which = eigen_target::largest_magnitude,
+               const krylov_eigen_options& options = krylov_eigen_options())
+    {
+        using value_type = typename A::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using basis_type = xtensor<value_type, 2, layout_type::row_major>;
+        using vector_type = xtensor<value_type, 1>;
+
+        std::size_t m = detail::krylov_eigen_size(a, nev, options, "eigsh");
+        std::size_t n = a.shape()[0];
+
+        // basis vectors are the rows of V, T the projected matrix
+        basis_type V = basis_type::from_shape({m + 1, n});
+        basis_type work = basis_type::from_shape({m, n});
+        basis_type Y = basis_type::from_shape({m, m});
+        xtensor<real_type, 2, layout_type::column_major> T = xtensor<real_type, 2, layout_type::column_major>::from_shape({m, m});
+        xtensor<real_type, 2, layout_type::column_major> Q = xtensor<real_type, 2, layout_type::column_major>::from_shape({m, m});
+        xtensor<real_type, 1, layout_type::column_major> theta = xtensor<real_type, 1, layout_type::column_major>::from_shape({m});
+        vector_type v = vector_type::from_shape({n});
+        vector_type w = vector_type::from_shape({n});
+        vector_type h = vector_type::from_shape({m + 1});
+        vector_type hw = vector_type::from_shape({m + 1});
+        std::vector<std::size_t> order(m);
+        T.fill(real_type(0));
+
+        detail::krylov_random_vector(w, 0);
+        real_type w0 = detail::krylov_norm(w);
+        std::transform(w.begin(), w.end(), V.data(), [w0](const value_type& x) { return x / w0; });
+
+        std::size_t k = 0;
+        real_type beta = 0;
+        for (std::size_t restart = 0;; ++restart)
+        {
+            for (std::size_t j = k; j < m; ++j)
+            {
+                std::copy(V.data() + j * n, V.data() + (j + 1) * n, v.begin());
+                detail::krylov_apply(a, v, w);
+                real_type norm = detail::krylov_norm(w);
+                real_type b = detail::krylov_orthogonalize(V, j + 1, w, h, hw);
+                T(j, j) = std::real(h(j));
+                beta = detail::krylov_next_vector(V, j, w, b, norm, h, hw);
+                if (j + 1 < m)
+                {
+                    T(j, j + 1) = beta;
+                    T(j + 1, j) = beta;
+                }
+            }
+
+            Q = T;
+            int info = lapack::syevd(Q, 'V', 'L', theta);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "eigsh: syevd failed.");
+            }
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t i, std::size_t j) {
+                return detail::eigen_score(theta(i), which) > detail::eigen_score(theta(j), which);
+            });
+
+            // residual of a Ritz pair: |beta| times the last entry of its vector
+            real_type anorm = std::max(std::abs(theta(0)), std::abs(theta(m - 1)));
+            real_type tol = std::max(real_type(options.tol), std::numeric_limits<real_type>::epsilon()) * anorm;
+            bool converged = true;
+            for (std::size_t i = 0; i < nev; ++i)
+            {
+                converged = converged && std::abs(beta * Q(m - 1, order[i])) <= tol;
+            }
+            if (converged || m == n)
+            {
+                break;
+            }
+            if (restart + 1 >= options.max_restarts)
+            {
+                XTENSOR_THROW(std::runtime_error, "eigsh: no convergence, increase max_restarts or ncv.");
+            }
+
+            // keep the p most wanted Ritz vectors, coupled to the residual vector
+            std::size_t p = nev + (m - nev) / 2;
+            for (std::size_t i = 0; i < p; ++i)
+            {
+                for (std::size_t l = 0; l < m; ++l)
+                {
+                    Y(i, l) = value_type(Q(l, order[i]));
+                }
+            }
+            detail::krylov_rotate_basis(V, Y.data(), p, m, work);
+            std::copy(V.data() + m * n, V.data() + (m + 1) * n, V.data() + p * n);
+            T.fill(real_type(0));
+            for (std::size_t i = 0; i < p; ++i)
+            {
+                T(i, i) = theta(order[i]);
+                T(i, p) = beta * Q(m - 1, order[i]);
+                T(p, i) = T(i, p);
+            }
+            k = p;
+        }
+
+        std::sort(order.begin(), order.begin() + std::ptrdiff_t(nev), [&theta](std::size_t i, std::size_t j) {
+            return theta(i) < theta(j);
+        });
+        xtensor<real_type, 1> eigenvalues = xtensor<real_type, 1>::from_shape({nev});
+        for (std::size_t i = 0; i < nev; ++i)
+        {
+            eigenvalues(i) = theta(order[i]);
+            for (std::size_t l = 0; l < m; ++l)
+            {
+                Y(i, l) = value_type(Q(l, order[i]));
+            }
+        }
+        // the columns of a column-major n x nev matrix are the rows of Y V
+        xtensor<value_type, 2, layout_type::column_major> eigenvectors
+            = xtensor<value_type, 2, layout_type::column_major>::from_shape({n, nev});
+        cxxblas::gemm<blas_index_t>(cxxblas::RowMajor, cxxblas::NoTrans, cxxblas::NoTrans,
+                                    to_blas_index(nev), to_blas_index(n), to_blas_index(m),
+                                    value_type(1), Y.data(), to_blas_index(m), V.data(), to_blas_index(n),
+                                    value_type(0), eigenvectors.data(), to_blas_index(n));
+        return std::make_tuple(std::move(eigenvalues), std::move(eigenvectors));
+    }
+
+    /**
+     * Computes \em nev eigenvalues of the general operator \em a, and their
+     * eigenvectors, by the Krylov-Schur method (Stewart), a stable
+     * formulation of ARPACK's implicitly restarted Arnoldi method. Only
+     * products of \em a with vectors are needed, see linear_operator.
+     *
+     * The Arnoldi basis is complex and fully reorthogonalized by gemv; the
+     * restarts rotate it by a gemm. The projected matrix, of order ncv, is
+     * reduced to complex Schur form by gees and reordered by rotations to
+     * bring the wanted eigenvalues first. A real operator is applied to
+     * the real and imaginary parts of the basis vectors separately.
+     *
+     * @param a square operator
+     * @param nev number of eigenvalues, less than the order of \em a
+     * @param which eigenvalues sought
+     * @param options subspace size, tolerance and restart limit
+     * @return tuple (w, V) of the complex eigenvalues, the most wanted
+     *         first, and the unit eigenvectors as columns of V
+     */
+    template <class A>
+    auto eigs(const A& a, std::size_t nev, eigen_target which = eigen_target::largest_magnitude,
+              const krylov_eigen_options& options = krylov_eigen_options())
+    {
+        using operator_type = typename A::value_type;
+        using real_type = xtl::complex_value_type_t<operator_type>;
+        using value_type = std::complex<real_type>;
+        using basis_type = xtensor<value_type, 2, layout_type::row_major>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1>;
+
+        std::size_t m = detail::krylov_eigen_size(a, nev, options, "eigs");
+        std::size_t n = a.shape()[0];
+
+        basis_type V = basis_type::from_shape({m + 1, n});
+        basis_type work = basis_type::from_shape({m, n});
+        basis_type Y = basis_type::from_shape({m, m});
+        matrix_type H = matrix_type::from_shape({m + 1, m});
+        matrix_type S = matrix_type::from_shape({m, m});
+        matrix_type Z = matrix_type::from_shape({m, m});
+        xtensor<value_type, 1, layout_type::column_major> ritz = xtensor<value_type, 1, layout_type::column_major>::from_shape({m});
+        xtensor<value_type, 2, layout_type::column_major> U = xtensor<value_type, 2, layout_type::column_major>::from_shape({nev, nev});
+        vector_type v = vector_type::from_shape({n});
+        vector_type w = vector_type::from_shape({n});
+        vector_type h = vector_type::from_shape({m + 1});
+        vector_type hw = vector_type::from_shape({m + 1});
+        std::array<xtensor<real_type, 1>, 4> parts;
+        if (!xtl::is_complex<operator_type>::value)
+        {
+            for (auto& part : parts)
+            {
+                part = xtensor<real_type, 1>::from_shape({n});
+            }
+        }
+        H.fill(value_type(0));
+
+        detail::krylov_random_vector(w, 0);
+        real_type w0 = detail::krylov_norm(w);
+        std::transform(w.begin(), w.end(), V.data(), [w0](const value_type& x) { return x / w0; });
+
+        // eigenvectors of the leading nev x nev block of S, as columns of U
+        auto triangular_eigenvectors = [&S, &U, nev]()
+        {
+            U.fill(value_type(0));
+            for (std::size_t i = 0; i < nev; ++i)
+            {
+                value_type lambda = S(i, i);
+                real_type small = std::numeric_limits<real_type>::epsilon() * std::max(std::abs(lambda), real_type(1));
+                U(i, i) = value_type(1);
+                for (std::size_t l = i; l-- > 0;)
+                {
+                    value_type sum(0);
+                    for (std::size_t q = l + 1; q <= i; ++q)
+                    {
+                        sum += S(l, q) * U(q, i);
+                    }
+                    value_type d = S(l, l) - lambda;
+                    U(l, i) = -sum / (std::abs(d) < small ? value_type(small) : d);
+                }
+            }
+        };
+
+        std::size_t k = 0;
+        real_type beta = 0;
+        for (std::size_t restart = 0;; ++restart)
+        {
+            for (std::size_t j = k; j < m; ++j)
+            {
+                std::copy(V.data() + j * n, V.data() + (j + 1) * n, v.begin());
+                detail::krylov_apply_complex(a, v, w, parts, xtl::is_complex<operator_type>());
+                real_type norm = detail::krylov_norm(w);
+                real_type b = detail::krylov_orthogonalize(V, j + 1, w, h, hw);
+                for (std::size_t i = 0; i <= j; ++i)
+                {
+                    H(i, j) = h(i);
+                }
+                beta = detail::krylov_next_vector(V, j, w, b, norm, h, hw);
+                if (j + 1 < m)
+                {
+                    H(j + 1, j) = beta;
+                }
+            }
+
+            for (std::size_t j = 0; j < m; ++j)
+            {
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    S(i, j) = H(i, j);
+                }
+            }
+            blas_index_t (*select)(const value_type*) = nullptr;
+            blas_index_t sdim = 0;
+            int info = lapack::gees(S, 'V', 'N', select, sdim, ritz, Z);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "eigs: gees failed.");
+            }
+
+            // bubble the wanted eigenvalues to the top of S, most wanted first
+            std::size_t p = nev + (m - nev) / 2;
+            for (std::size_t i = 0; i < p; ++i)
+            {
+                std::size_t best = i;
+                for (std::size_t l = i + 1; l < m; ++l)
+                {
+                    if (detail::eigen_score(S(l, l), which) > detail::eigen_score(S(best, best), which))
+                    {
+                        best = l;
+                    }
+                }
+                for (std::size_t l = best; l > i; --l)
+                {
+                    detail::schur_swap(S, Z, l - 1);
+                }
+            }
+
+            // residual of a Ritz pair: |beta| |z_m^T u| for its vector Z u
+            triangular_eigenvectors();
+            real_type anorm = 0;
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                anorm = std::max(anorm, std::abs(S(i, i)));
+            }
+            real_type tol = std::max(real_type(options.tol), std::numeric_limits<real_type>::epsilon()) * anorm;
+            bool converged = true;
+            for (std::size_t i = 0; i < nev; ++i)
+            {
+                value_type last(0);
+                real_type unorm = 0;
+                for (std::size_t l = 0; l <= i; ++l)
+                {
+                    last += Z(m - 1, l) * U(l, i);
+                    unorm += std::norm(U(l, i));
+                }
+                converged = converged && beta * std::abs(last) <= tol * std::sqrt(unorm);
+            }
+            if (converged || m == n)
+            {
+                break;
+            }
+            if (restart + 1 >= options.max_restarts)
+            {
+                XTENSOR_THROW(std::runtime_error, "eigs: no convergence, increase max_restarts or ncv.");
+            }
+
+            // keep the leading p Schur vectors, coupled to the residual vector
+            for (std::size_t i = 0; i < p; ++i)
+            {
+                for (std::size_t l = 0; l < m; ++l)
+                {
+                    Y(i, l) = Z(l, i);
+                }
+            }
+            detail::krylov_rotate_basis(V, Y.data(), p, m, work);
+            std::copy(V.data() + m * n, V.data() + (m + 1) * n, V.data() + p * n);
+            H.fill(value_type(0));
+            for (std::size_t j = 0; j < p; ++j)
+            {
+                for (std::size_t i = 0; i <= j; ++i)
+                {
+                    H(i, j) = S(i, j);
+                }
+                H(p, j) = beta * Z(m - 1, j);
+            }
+            k = p;
+        }
+
+        // eigenvector i is V^T Z u_i, normalized
+        xtensor<value_type, 1> eigenvalues = xtensor<value_type, 1>::from_shape({nev});
+        for (std::size_t i = 0; i < nev; ++i)
+        {
+            eigenvalues(i) = S(i, i);
+            for (std::size_t l = 0; l < m; ++l)
+            {
+                value_type sum(0);
+                for (std::size_t q = 0; q <= i; ++q)
+                {
+                    sum += Z(l, q) * U(q, i);
+                }
+                Y(i, l) = sum;
+            }
+        }
+        xtensor<value_type, 2, layout_type::column_major> eigenvectors
+            = xtensor<value_type, 2, layout_type::column_major>::from_shape({n, nev});
+        cxxblas::gemm<blas_index_t>(cxxblas::RowMajor, cxxblas::NoTrans, cxxblas::NoTrans,
+                                    to_blas_index(nev), to_blas_index(n), to_blas_index(m),
+                                    value_type(1), Y.data(), to_blas_index(m), V.data(), to_blas_index(n),
+                                    value_type(0), eigenvectors.data(), to_blas_index(n));
+        for (std::size_t i = 0; i < nev; ++i)
+        {
+            value_type* column = eigenvectors.data() + i * n;
+            real_type norm;
+            cxxblas::nrm2<blas_index_t>(to_blas_index(n), column, 1, norm);
+            cxxblas::scal<blas_index_t>(to_blas_index(n), value_type(real_type(1) / norm), column, 1);
+        }
+        return std::make_tuple(std::move(eigenvalues), std::move(eigenvectors));
+    }
+}
+}
+
+#endif
@@ -11,6 +11,13 @@
 #define XLAPACK_HPP
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
 
 #include "xtl/xcomplex.hpp"
 
@@ -21,34 +28,497 @@
 #include "xtensor/xtensor.hpp"
 #include "xtensor/xutils.hpp"
 
+#if defined(XTENSOR_BLAS_FULL_FLENS)
 #include "xflens/cxxlapack/cxxlapack.cxx"
+#else
+#include "xflens/cxxlapack/cxxlapack_xtensor.cxx"
+#endif
 
+#include "xtensor-blas/xblas_allocator.hpp"
 #include "xtensor-blas/xblas_config.hpp"
 #include "xtensor-blas/xblas_utils.hpp"
 
+#if defined(XTENSOR_USE_CUDA)
+#include "xtensor-blas/xblas_cuda.hpp"
+#endif
+
 namespace xt
 {
 
 namespace lapack
 {
+    /**
+     * LAPACK routines whose wrappers use a workspace. The sizes passed to
+     * workspace_size and workspace::prepare are, in this order:
+     *
+     * - gesdd, geqrf: m, n
+     * - orgqr, ungqr: m, n, k
+     * - ormqr, unmqr: m, n, k (m and n are the dimensions of C)
+     * - larfb: m, n, k (m and n the dimensions of C, k the number of reflectors)
+     * - gehrd, sytrd, hetrd: n
+     * - ormhr, unmhr: m, n, nq (m and n the dimensions of C, nq the order of Q)
+     * - ormtr, unmtr: m, n (the dimensions of C)
+     * - gelsd, gelsy, gelss, gels: m, n, nrhs
+     * - syevd, heevd, syev, heev, geev, getri: n
+     * - geevx: n (the job flags are jobvl, jobvr and sense)
+     * - sygvd, hegvd, sygvx, hegvx: n, itype
+     * - spevd, hpevd: n
+     * - spevx, hpevx: n (the job flags are jobz and range)
+     * - sysv, hesv: n
+     * - sytrf, hetrf: n
+     * - syevr, heevr: n
+     * - stedc, stevr: n (the job flags are compz, and jobz and range)
+     * - bdsqr, bdsdc: n (the job flag of bdsdc is compq)
+     * - gees, ggev, gges: n
+     * - trsen: n (the job flag is job), tgsen: n, ijob
+     * - pstrf: n
+     * - gesvd, gesvj, gejsv: m, n
+     * - geqp3: m, n
+     *
+     * and the job flags are the char arguments of the wrapper, in order.
+     */
+    enum class routine
+    {
+        gesdd,
+        geqrf,
+        orgqr,
+        ungqr,
+        ormqr,
+        unmqr,
+        gelsd,
+        syevd,
+        heevd,
+        geev,
+        getri,
+        sygvd,
+        spevd,
+        hpevd,
+        sysv,
+        hesv,
+        syevr,
+        heevr,
+        gees,
+        gesvd,
+        gesvj,
+        gejsv,
+        geqp3,
+        gelsy,
+        gelss,
+        gels,
+        geevx,
+        sytrf,
+        hetrf,
+        hegvd,
+        sygvx,
+        hegvx,
+        ggev,
+        gges,
+        gehrd,
+        ormhr,
+        unmhr,
+        sytrd,
+        hetrd,
+        ormtr,
+        unmtr,
+        larfb,
+        stedc,
+        stevr,
+        bdsqr,
+        bdsdc,
+        trsen,
+        tgsen,
+        pstrf,
+        spevx,
+        hpevx,
+        syev,
+        heev
+    };
+
+    using workspace_dims = std::array<blas_index_t, 3>;
+    using workspace_jobs = std::array<char, 3>;
+
+    /**
+     * Lengths of the work, rwork and iwork arrays of a LAPACK call.
+     */
+    struct workspace_sizes
+    {
+        std::size_t work;
+        std::size_t rwork;
+        std::size_t iwork;
+    };
+
+    namespace detail
+    {
+        /**
+         * Identifies a workspace query: the routine, its size arguments and
+         * its job flags.
+         */
+        struct workspace_key
+        {
+            routine name;
+            workspace_dims dims;
+            workspace_jobs jobs;
+
+            bool operator<(const workspace_key& rhs) const
+            {
+                return std::tie(name, dims, jobs) < std::tie(rhs.name, rhs.dims, rhs.jobs);
+            }
+        };
+
+        template <routine R>
+        struct workspace_query;
+    }
+
+    /**
+     * Work arrays for the LAPACK wrappers with value type \em T.
+     *
+     * The result of each workspace query is remembered, and the arrays only
+     * ever grow, so repeated calls with the same shapes neither query LAPACK
+     * again nor allocate. Every wrapper taking a workspace accepts one as its
+     * last argument. Without it, the wrapper uses the thread_local_instance
+     * of the calling thread.
+     *
+     * For allocation free calls, prepare the workspace for every routine and
+     * shape up front. A wrapper called on a prepared workspace makes no
+     * workspace query and so cannot throw on its failure either. The arrays come from blas_allocator, 64-byte aligned;
+     * memory can be taken from an arena by passing a custom allocator \em A.
+     */
+    template <class T, class A = blas_allocator<T>>
+    class workspace
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using allocator_type = A;
+        using work_type = uvector<value_type, A>;
+        using rwork_type = uvector<real_type, typename std::allocator_traits<A>::template rebind_alloc<real_type>>;
+        using iwork_type = uvector<blas_index_t, typename std::allocator_traits<A>::template rebind_alloc<blas_index_t>>;
+
+        workspace() = default;
+        explicit workspace(const allocator_type& alloc);
+
+        static workspace& thread_local_instance();
+
+        template <routine R>
+        const workspace_sizes& prepare(const workspace_dims& dims, const workspace_jobs& jobs = {});
+
+        template <class Q>
+        const workspace_sizes& sizes(const detail::workspace_key& key, Q&& query);
+
+        template <class Q>
+        const workspace_sizes& measure(const detail::workspace_key& key, Q&& query);
+
+        void reserve(const workspace_sizes& s);
+        void clear();
+
+        bool query_only() const noexcept;
+
+        work_type work;
+        rwork_type rwork;
+        iwork_type iwork;
+
+    private:
+
+        template <class V>
+        static void grow(V& v, std::size_t n);
+
+        std::map<detail::workspace_key, workspace_sizes> m_sizes;
+        const workspace_sizes* m_last = nullptr;
+        bool m_query_only = false;
+    };
+
+    template <class T, class A>
+    inline workspace<T, A>::workspace(const allocator_type& alloc)
+        : work(alloc), rwork(typename rwork_type::allocator_type(alloc)),
+          iwork(typename iwork_type::allocator_type(alloc))
+    {
+    }
+
+    /**
+     * Returns the workspace used by the wrappers on the calling thread when
+     * no workspace is passed.
+     */
+    template <class T, class A>
+    inline auto workspace<T, A>::thread_local_instance() -> workspace&
+    {
+        static thread_local workspace ws;
+        return ws;
+    }
+
+    /**
+     * Queries the workspace of routine \em R for the given sizes and job flags
+     * and grows the arrays accordingly. Later calls of the wrapper with these
+     * arguments neither query LAPACK nor allocate.
+     *
+     * @return the required sizes
+     */
+    template <class T, class A>
+    template <routine R>
+    inline const workspace_sizes& workspace<T, A>::prepare(const workspace_dims& dims, const workspace_jobs& jobs)
+    {
+        m_query_only = true;
+        detail::workspace_query<R>::template run<T>(dims, jobs, *this);
+        m_query_only = false;
+        return *m_last;
+    }
+
+    /**
+     * Returns the sizes for \em key, calling \em query with this workspace
+     * the first time. The work arrays hold at least one element during the
+     * query and are grown to the returned sizes afterwards.
+     */
+    template <class T, class A>
+    template <class Q>
+    inline const workspace_sizes& workspace<T, A>::sizes(const detail::workspace_key& key, Q&& query)
+    {
+        const workspace_sizes& s = measure(key, std::forward<Q>(query));
+        reserve(s);
+        m_last = &s;
+        return s;
+    }
+
+    /**
+     * Returns the sizes for \em key as sizes does, without growing the
+     * arrays to them, e.g. to check them against the memory budget first.
+     */
+    template <class T, class A>
+    template <class Q>
+    inline const workspace_sizes& workspace<T, A>::measure(const detail::workspace_key& key, Q&& query)
+    {
+        auto it = m_sizes.find(key);
+        if (it == m_sizes.end())
+        {
+            reserve(workspace_sizes{1, 1, 1});
+            workspace_sizes s = query(*this);
+            s.work = std::max(s.work, std::size_t(1));
+            it = m_sizes.emplace(key, s).first;
+        }
+        return it->second;
+    }
+
+    template <class T, class A>
+    inline void workspace<T, A>::reserve(const workspace_sizes& s)
+    {
+        grow(work, s.work);
+        grow(rwork, s.rwork);
+        grow(iwork, s.iwork);
+    }
+
+    /**
+     * Releases the work arrays and forgets all query results.
+     */
+    template <class T, class A>
+    inline void workspace<T, A>::clear()
+    {
+        m_sizes.clear();
+        m_last = nullptr;
+        work = work_type(work.get_allocator());
+        rwork = rwork_type(rwork.get_allocator());
+        iwork = iwork_type(iwork.get_allocator());
+    }
+
+    /**
+     * True while the workspace is being prepared: wrappers return right
+     * after the workspace query, without calling the routine.
+     */
+    template <class T, class A>
+    inline bool workspace<T, A>::query_only() const noexcept
+    {
+        return m_query_only;
+    }
+
+    template <class T, class A>
+    template <class V>
+    inline void workspace<T, A>::grow(V& v, std::size_t n)
+    {
+        if (v.size() < n)
+        {
+            v.resize(n);
+        }
+    }
+
+    /**
+     * Returns the sizes of the work arrays that routine \em R needs for
+     * value type \em T, the given sizes and job flags.
+     */
+    template <routine R, class T>
+    inline workspace_sizes workspace_size(const workspace_dims& dims, const workspace_jobs& jobs = {})
+    {
+        workspace<T> ws;
+        return ws.template prepare<R>(dims, jobs);
+    }
+
+    /*****************
+     * memory budget *
+     *****************/
+
+    namespace detail
+    {
+        inline std::size_t& global_memory_budget()
+        {
+            static std::size_t budget = 0;
+            return budget;
+        }
+
+        /// Budget of a scoped_memory_budget on this thread, if any.
+        inline std::pair<bool, std::size_t>& thread_memory_budget()
+        {
+            static thread_local std::pair<bool, std::size_t> budget(false, 0);
+            return budget;
+        }
+
+        inline routine& last_driver_value()
+        {
+            static thread_local routine r = routine::gesdd;
+            return r;
+        }
+    }
+
+    /**
+     * Sets the memory budget, in bytes, of the work arrays of the LAPACK
+     * drivers that have a lower memory alternative: above it, gesdd runs
+     * gesvd, syevd syev, heevd heev, and gelsd gelss, instead of
+     * allocating the workspace. 0, the default, means no budget. The
+     * setting is global; see scoped_memory_budget for one call.
+     */
+    inline void set_memory_budget(std::size_t bytes)
+    {
+        detail::global_memory_budget() = bytes;
+    }
+
+    /**
+     * @return the memory budget in effect on the calling thread, 0 if none,
+     *         see set_memory_budget
+     */
+    inline std::size_t memory_budget()
+    {
+        const auto& local = detail::thread_memory_budget();
+        return local.first ? local.second : detail::global_memory_budget();
+    }
+
+    /**
+     * Sets the memory budget of the calling thread for its lifetime, over
+     * the global one (see set_memory_budget).
+     *
+     * \code{.cpp}
+     * {
+     *     xt::lapack::scoped_memory_budget budget(256 << 20);
+     *     auto res = xt::linalg::svd(A);
+     *     // xt::lapack::last_driver() is routine::gesvd if gesdd did not fit
+     * }
+     * \endcode
+     */
+    class scoped_memory_budget
+    {
+    public:
+
+        explicit scoped_memory_budget(std::size_t bytes)
+            : m_saved(detail::thread_memory_budget())
+        {
+            detail::thread_memory_budget() = std::make_pair(true, bytes);
+        }
+
+        ~scoped_memory_budget()
+        {
+            detail::thread_memory_budget() = m_saved;
+        }
+
+        scoped_memory_budget(const scoped_memory_budget&) = delete;
+        scoped_memory_budget& operator=(const scoped_memory_budget&) = delete;
+
+    private:
+
+        std::pair<bool, std::size_t> m_saved;
+    };
+
+    /**
+     * @return the routine run by the last call of gesdd, syevd, heevd or
+     *         gelsd on the calling thread: that routine, or the lower
+     *         memory one it fell back to under the memory budget
+     */
+    inline routine last_driver() noexcept
+    {
+        return detail::last_driver_value();
+    }
+
+    namespace detail
+    {
+        template <class T>
+        inline std::size_t workspace_bytes(const workspace_sizes& s)
+        {
+            return s.work * sizeof(T) + s.rwork * sizeof(xtl::complex_value_type_t<T>) + s.iwork * sizeof(blas_index_t);
+        }
+
+        /**
+         * True if the workspace of \em key, measured without being
+         * allocated, exceeds the memory budget, in which case the wrapper
+         * runs its lower memory alternative. Otherwise records the routine
+         * of \em key as the last driver.
+         */
+        template <class T, class W, class Q>
+        inline bool use_fallback(W& ws, const workspace_key& key, Q&& query)
+        {
+            if (ws.query_only())
+            {
+                return false;
+            }
+            std::size_t budget = memory_budget();
+            if (budget != 0 && workspace_bytes<T>(ws.measure(key, std::forward<Q>(query))) > budget)
+            {
+                return true;
+            }
+            last_driver_value() = key.name;
+            return false;
+        }
+    }
+
+    /**
+     * Releases the work arrays and the cached workspace sizes used by the
+     * LAPACK wrappers for value type \em T on the calling thread.
+     */
+    template <class T>
+    inline void clear_workspace_cache()
+    {
+        workspace<T>::thread_local_instance().clear();
+    }
+
+    namespace detail
+    {
+        template <class T>
+        inline std::size_t workspace_query_result(const T& w)
+        {
+            return static_cast<std::size_t>(std::real(w));
+        }
+    }
+
     /**
      * Interface to LAPACK gesv.
      */
     template <class E, class F>
     int gesv(E& A, F& b)
     {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gesv", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major);
         XTENSOR_ASSERT(A.dimension() == 2);
         XTENSOR_ASSERT(A.layout() == layout_type::column_major);
         XTENSOR_ASSERT(b.dimension() <= 2);
         XTENSOR_ASSERT(b.layout() == layout_type::column_major);
 
-        uvector<blas_index_t> piv(A.shape()[0]);
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+#if defined(XTENSOR_USE_CUDA)
+        int cuda_info = 0;
+        if (cuda::detail::gesv(A.shape()[0], b_dim, A.data(), stride_back(A), b.data(), b_stride, cuda_info))
+        {
+            return cuda_info;
+        }
+#endif
 
-        blas_index_t b_dim = b.dimension() > 1 ? static_cast<blas_index_t>(b.shape().back()) : 1;
-        blas_index_t b_stride = b_dim == 1 ? static_cast<blas_index_t>(b.shape().front()) : stride_back(b);
+        uvector<blas_index_t> piv(A.shape()[0]);
 
         int info = cxxlapack::gesv<blas_index_t>(
-            static_cast<blas_index_t>(A.shape()[0]),
+            to_blas_index(A.shape()[0]),
             b_dim,
             A.data(),
             stride_back(A),
@@ -60,15 +530,133 @@ namespace lapack
         return info;
     }
 
+    namespace detail
+    {
+        inline int mixed_gesv(blas_index_t n, blas_index_t nrhs, double* A, blas_index_t lda, blas_index_t* piv,
+                              const double* b, blas_index_t ldb, double* x, blas_index_t ldx, blas_index_t& iter)
+        {
+            uvector<double> work(static_cast<std::size_t>(std::max(n * nrhs, blas_index_t(1))));
+            uvector<float> swork(static_cast<std::size_t>(std::max(n * (n + nrhs), blas_index_t(1))));
+            return cxxlapack::sgesv<blas_index_t>(n, nrhs, A, lda, piv, b, ldb, x, ldx,
+                                                  work.data(), swork.data(), iter);
+        }
+
+        inline int mixed_gesv(blas_index_t n, blas_index_t nrhs, std::complex<double>* A, blas_index_t lda,
+                              blas_index_t* piv, const std::complex<double>* b, blas_index_t ldb,
+                              std::complex<double>* x, blas_index_t ldx, blas_index_t& iter)
+        {
+            uvector<std::complex<double>> work(static_cast<std::size_t>(std::max(n * nrhs, blas_index_t(1))));
+            uvector<std::complex<float>> swork(static_cast<std::size_t>(std::max(n * (n + nrhs), blas_index_t(1))));
+            uvector<double> rwork(static_cast<std::size_t>(std::max(n, blas_index_t(1))));
+            return cxxlapack::zcgesv<blas_index_t>(n, nrhs, A, lda, piv, b, ldb, x, ldx,
+                                                   work.data(), swork.data(), rwork.data(), iter);
+        }
+
+        inline int mixed_posv(char uplo, blas_index_t n, blas_index_t nrhs, double* A, blas_index_t lda,
+                              const double* b, blas_index_t ldb, double* x, blas_index_t ldx, blas_index_t& iter)
+        {
+            uvector<double> work(static_cast<std::size_t>(std::max(n * nrhs, blas_index_t(1))));
+            uvector<float> swork(static_cast<std::size_t>(std::max(n * (n + nrhs), blas_index_t(1))));
+            return cxxlapack::sposv<blas_index_t>(uplo, n, nrhs, A, lda, b, ldb, x, ldx,
+                                                  work.data(), swork.data(), iter);
+        }
+
+        inline int mixed_posv(char uplo, blas_index_t n, blas_index_t nrhs, std::complex<double>* A, blas_index_t lda,
+                              const std::complex<double>* b, blas_index_t ldb, std::complex<double>* x,
+                              blas_index_t ldx, blas_index_t& iter)
+        {
+            uvector<std::complex<double>> work(static_cast<std::size_t>(std::max(n * nrhs, blas_index_t(1))));
+            uvector<std::complex<float>> swork(static_cast<std::size_t>(std::max(n * (n + nrhs), blas_index_t(1))));
+            uvector<double> rwork(static_cast<std::size_t>(std::max(n, blas_index_t(1))));
+            return cxxlapack::cposv<blas_index_t>(uplo, n, nrhs, A, lda, b, ldb, x, ldx,
+                                                  work.data(), swork.data(), rwork.data(), iter);
+        }
+    }
+
+    /**
+     * Interface to LAPACK dsgesv (zcgesv for complex values): solves
+     * A x = b with a single precision LU factorization refined to double
+     * precision. A is overwritten only when LAPACK falls back to a double
+     * precision factorization.
+     * @param iter number of refinement steps, negative when LAPACK fell
+     *             back to double precision
+     */
+    template <class E, class P, class F, class G>
+    int dsgesv(E& A, P& piv, const F& b, G& x, blas_index_t& iter)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("dsgesv", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(x.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+        blas_index_t x_stride = b_dim == 1 ? to_blas_index(x.shape().front()) : stride_back(x);
+
+        return detail::mixed_gesv(
+            to_blas_index(A.shape()[0]),
+            b_dim,
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            piv.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1)),
+            x.data(),
+            std::max(x_stride, blas_index_t(1)),
+            iter
+        );
+    }
+
+    /**
+     * Interface to LAPACK dsposv (zcposv for complex values): solves
+     * A x = b for positive definite A with a single precision Cholesky
+     * factorization refined to double precision. Only the \em uplo triangle
+     * of A is read.
+     * @param iter number of refinement steps, negative when LAPACK fell
+     *             back to double precision
+     */
+    template <class E, class F, class G>
+    int dsposv(E& A, const F& b, G& x, blas_index_t& iter, char uplo = 'L')
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("dsposv", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(x.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+        blas_index_t x_stride = b_dim == 1 ? to_blas_index(x.shape().front()) : stride_back(x);
+
+        return detail::mixed_posv(
+            uplo,
+            to_blas_index(A.shape()[0]),
+            b_dim,
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            b.data(),
+            std::max(b_stride, blas_index_t(1)),
+            x.data(),
+            std::max(x_stride, blas_index_t(1)),
+            iter
+        );
+    }
+
     template <class E, class F>
     auto getrf(E& A, F& piv)
     {
+        XTENSOR_BLAS_INSTRUMENT_CALL("getrf", A.shape()[0], A.shape()[1], 0, layout_type::column_major, 0, 0,
+                                     instrument::fma_flops<typename E::value_type>(double(std::min(A.shape()[0], A.shape()[1]))
+                                                                                  * double(A.shape()[0]) * double(A.shape()[1]) / 3.));
         XTENSOR_ASSERT(A.dimension() == 2);
         XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
         int info = cxxlapack::getrf<blas_index_t>(
-            static_cast<blas_index_t>(A.shape()[0]),
-            static_cast<blas_index_t>(A.shape()[1]),
+            to_blas_index(A.shape()[0]),
+            to_blas_index(A.shape()[1]),
             A.data(),
             stride_back(A),
             piv.data()
@@ -77,140 +665,265 @@ namespace lapack
         return info;
     }
 
-    template <class E, class T>
-    inline auto orgqr(E& A, T& tau, blas_index_t n = -1)
+    template <class E, class T, class Alloc>
+    inline auto orgqr(E& A, T& tau, blas_index_t n, workspace<typename E::value_type, Alloc>& ws)
     {
-        using value_type = typename E::value_type;
-
-        uvector<value_type> work(1);
+        XTENSOR_BLAS_INSTRUMENT_CALL("orgqr", A.shape()[0], A.shape()[1], tau.size(), layout_type::column_major);
 
         if (n == -1)
         {
-            n = static_cast<blas_index_t>(A.shape()[1]);
+            n = to_blas_index(A.shape()[1]);
         }
 
-        blas_index_t m = static_cast<blas_index_t>(A.shape()[0]);
+        blas_index_t m = to_blas_index(A.shape()[0]);
         blas_index_t a_stride = std::max(blas_index_t(1), m);
+        blas_index_t k = to_blas_index(tau.size());
+
+        const auto& sizes = ws.sizes({routine::orgqr, {m, n, k}, {}}, [&](auto& w) {
+            int info = cxxlapack::orgqr<blas_index_t>(
+                m,
+                n,
+                k,
+                A.data(),
+                a_stride,
+                tau.data(),
+                w.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for orgqr.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, 0};
+        });
 
-        int info = cxxlapack::orgqr<blas_index_t>(
-            m,
-            n,
-            static_cast<blas_index_t>(tau.size()),
-            A.data(),
-            a_stride,
-            tau.data(),
-            work.data(),
-            static_cast<blas_index_t>(-1)
-        );
-
-        if (info != 0)
+        if (ws.query_only())
         {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for orgqr.");
+            return 0;
         }
 
-        work.resize(static_cast<std::size_t>(work[0]));
-
-        info = cxxlapack::orgqr<blas_index_t>(
+        int info = cxxlapack::orgqr<blas_index_t>(
             m,
             n,
-            static_cast<blas_index_t>(tau.size()),
+            k,
             A.data(),
             a_stride,
             tau.data(),
-            work.data(),
-            static_cast<blas_index_t>(work.size())
+            ws.work.data(),
+            to_blas_index(sizes.work)
         );
 
         return info;
     }
 
     template <class E, class T>
-    inline auto ungqr(E& A, T& tau, blas_index_t n = -1)
+    inline auto orgqr(E& A, T& tau, blas_index_t n = -1)
     {
-        using value_type = typename E::value_type;
+        return orgqr(A, tau, n, workspace<typename E::value_type>::thread_local_instance());
+    }
 
-        uvector<value_type> work(1);
+    template <class E, class T, class Alloc>
+    inline auto ungqr(E& A, T& tau, blas_index_t n, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("ungqr", A.shape()[0], A.shape()[1], tau.size(), layout_type::column_major);
 
         if (n == -1)
         {
-            n = static_cast<blas_index_t>(A.shape()[1]);
+            n = to_blas_index(A.shape()[1]);
         }
 
-        blas_index_t m = static_cast<blas_index_t>(A.shape()[0]);
+        blas_index_t m = to_blas_index(A.shape()[0]);
         blas_index_t a_stride = std::max(blas_index_t(1), m);
+        blas_index_t k = to_blas_index(tau.size());
+
+        const auto& sizes = ws.sizes({routine::ungqr, {m, n, k}, {}}, [&](auto& w) {
+            int info = cxxlapack::ungqr<blas_index_t>(
+                m,
+                n,
+                k,
+                A.data(),
+                a_stride,
+                tau.data(),
+                w.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for ungqr.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, 0};
+        });
 
-        int info = cxxlapack::ungqr<blas_index_t>(
-            m,
-            n,
-            static_cast<blas_index_t>(tau.size()),
-            A.data(),
-            a_stride,
-            tau.data(),
-            work.data(),
-            static_cast<blas_index_t>(-1)
-        );
-
-        if (info != 0)
+        if (ws.query_only())
         {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for ungqr.");
+            return 0;
         }
 
-        work.resize(static_cast<std::size_t>(std::real(work[0])));
-
-        info = cxxlapack::ungqr<blas_index_t>(
+        int info = cxxlapack::ungqr<blas_index_t>(
             m,
             n,
-            static_cast<blas_index_t>(tau.size()),
+            k,
             A.data(),
             a_stride,
             tau.data(),
-            work.data(),
-            static_cast<blas_index_t>(work.size())
+            ws.work.data(),
+            to_blas_index(sizes.work)
         );
 
         return info;
     }
 
     template <class E, class T>
-    int geqrf(E& A, T& tau)
+    inline auto ungqr(E& A, T& tau, blas_index_t n = -1)
     {
-        using value_type = typename E::value_type;
+        return ungqr(A, tau, n, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    template <class E, class T, class Alloc>
+    int geqrf(E& A, T& tau, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("geqrf", A.shape()[0], A.shape()[1], 0, layout_type::column_major, 0, 0,
+                                     instrument::fma_flops<typename E::value_type>(double(A.shape()[0]) * double(A.shape()[1]) * double(A.shape()[1])
+                                                                                  - double(A.shape()[1]) * double(A.shape()[1]) * double(A.shape()[1]) / 3.));
 
         XTENSOR_ASSERT(A.dimension() == 2);
         XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
-        uvector<value_type> work(1);
-        blas_index_t m = static_cast<blas_index_t>(A.shape()[0]);
+        blas_index_t m = to_blas_index(A.shape()[0]);
+        blas_index_t n = to_blas_index(A.shape()[1]);
         blas_index_t a_stride = std::max(blas_index_t(1), m);
 
+        const auto& sizes = ws.sizes({routine::geqrf, {m, n, 0}, {}}, [&](auto& w) {
+            int info = cxxlapack::geqrf<blas_index_t>(
+                m,
+                n,
+                A.data(),
+                a_stride,
+                tau.data(),
+                w.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geqrf.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
         int info = cxxlapack::geqrf<blas_index_t>(
             m,
-            static_cast<blas_index_t>(A.shape()[1]),
+            n,
             A.data(),
             a_stride,
             tau.data(),
-            work.data(),
-            static_cast<blas_index_t>(-1)
+            ws.work.data(),
+            to_blas_index(sizes.work)
         );
 
-        if (info != 0)
-        {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geqrf.");
-        }
+        return info;
+    }
 
-        work.resize(static_cast<std::size_t>(std::real(work[0])));
+    template <class E, class T>
+    int geqrf(E& A, T& tau)
+    {
+        return geqrf(A, tau, workspace<typename E::value_type>::thread_local_instance());
+    }
 
-        info = cxxlapack::geqrf<blas_index_t>(
-            m,
-            static_cast<blas_index_t>(A.shape()[1]),
-            A.data(),
-            a_stride,
-            tau.data(),
-            work.data(),
-            static_cast<blas_index_t>(work.size())
+    /**
+     * Interface to LAPACK geqp3, the QR factorization with column pivoting
+     * A P = Q R. The diagonal of R is non-increasing in magnitude.
+     *
+     * @param A Column-major matrix, overwritten with R and the Householder reflectors
+     * @param jpvt on entry, nonzero entries mark columns moved to the front;
+     *        on exit, the 1-based index of the column of A that is the j-th column of A P
+     * @param tau scalar factors of the reflectors, of size min(m, n)
+     * @param ws workspace
+     * @returns info
+     */
+    template <class E, class P, class T, class Alloc, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int geqp3(E& A, P& jpvt, T& tau, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("geqp3", A.shape()[0], A.shape()[1], 0, layout_type::column_major);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        blas_index_t m = to_blas_index(A.shape()[0]);
+        blas_index_t n = to_blas_index(A.shape()[1]);
+        blas_index_t a_stride = std::max(m, blas_index_t(1));
+
+        const auto& sizes = ws.sizes({routine::geqp3, {m, n, 0}, {}}, [&](auto& w) {
+            int info = cxxlapack::geqp3<blas_index_t>(
+                m, n, A.data(), a_stride, jpvt.data(), tau.data(),
+                w.work.data(), to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geqp3.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::geqp3<blas_index_t>(
+            m, n, A.data(), a_stride, jpvt.data(), tau.data(),
+            ws.work.data(), to_blas_index(sizes.work)
         );
+    }
 
-        return info;
+    template <class E, class P, class T, class Alloc, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int geqp3(E& A, P& jpvt, T& tau, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("geqp3", A.shape()[0], A.shape()[1], 0, layout_type::column_major);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        blas_index_t m = to_blas_index(A.shape()[0]);
+        blas_index_t n = to_blas_index(A.shape()[1]);
+        blas_index_t a_stride = std::max(m, blas_index_t(1));
+        std::size_t rwork_size = std::max(2 * static_cast<std::size_t>(n), std::size_t(1));
+
+        const auto& sizes = ws.sizes({routine::geqp3, {m, n, 0}, {}}, [&](auto& w) {
+            w.reserve(workspace_sizes{1, rwork_size, 0});
+            int info = cxxlapack::geqp3<blas_index_t>(
+                m, n, A.data(), a_stride, jpvt.data(), tau.data(),
+                w.work.data(), to_blas_index(-1), w.rwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geqp3.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), rwork_size, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::geqp3<blas_index_t>(
+            m, n, A.data(), a_stride, jpvt.data(), tau.data(),
+            ws.work.data(), to_blas_index(sizes.work), ws.rwork.data()
+        );
+    }
+
+    template <class E, class P, class T>
+    int geqp3(E& A, P& jpvt, T& tau)
+    {
+        return geqp3(A, jpvt, tau, workspace<typename E::value_type>::thread_local_instance());
     }
 
     namespace detail
@@ -253,11 +966,54 @@ namespace lapack
             return std::make_pair(std::max(blas_index_t(u.shape()[0]), 1),
                                   std::max(blas_index_t(vt.shape()[0]), 1));
         }
+
+        // length of the real work array of the complex gesdd
+        inline std::size_t gesdd_rwork_size(char jobz, std::size_t m, std::size_t n)
+        {
+            std::size_t mx = std::max(m, n);
+            std::size_t mn = std::min(m, n);
+            std::size_t rwork_size;
+            if (jobz == 'N')
+            {
+                // 5 mn since LAPACK 3.7, 7 mn before
+                rwork_size = 7 * mn;
+            }
+            else if (mx > mn)
+            {
+                // TODO verify size
+                rwork_size = 5 * mn * mn + 5 * mn;
+            }
+            else
+            {
+                // TODO verify size
+                rwork_size = std::max(5 * mn * mn + 5 * mn, 2 * mx * mn + 2 * mn * mn + mn);
+            }
+            return std::max(rwork_size, std::size_t(1));
+        }
+
+        // gesdd with jobz 'N', where U and Vt are not referenced
+        template <class T>
+        inline int gesdd_values(blas_index_t m, blas_index_t n, T* a, blas_index_t lda, T* s,
+                                T* work, blas_index_t lwork, T* /*rwork*/, blas_index_t* iwork)
+        {
+            T dummy(0);
+            return cxxlapack::gesdd<blas_index_t>('N', m, n, a, lda, s, &dummy, 1, &dummy, 1, work, lwork, iwork);
+        }
+
+        template <class T>
+        inline int gesdd_values(blas_index_t m, blas_index_t n, std::complex<T>* a, blas_index_t lda, T* s,
+                                std::complex<T>* work, blas_index_t lwork, T* rwork, blas_index_t* iwork)
+        {
+            std::complex<T> dummy(0);
+            return cxxlapack::gesdd<blas_index_t>('N', m, n, a, lda, s, &dummy, 1, &dummy, 1, work, lwork,
+                                                  rwork, iwork);
+        }
     }
 
-    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto gesdd(E& A, char jobz = 'A')
+    template <class E, class Alloc, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto gesdd(E& A, char jobz, workspace<typename E::value_type, Alloc>& ws)
     {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gesdd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz);
         using value_type = typename E::value_type;
         using xtype1 = xtensor<value_type, 1, layout_type::column_major>;
         using xtype2 = xtensor<value_type, 2, layout_type::column_major>;
@@ -265,8 +1021,6 @@ namespace lapack
         XTENSOR_ASSERT(A.dimension() == 2);
         XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
-        uvector<value_type> work(1);
-
         std::size_t m = A.shape()[0];
         std::size_t n = A.shape()[1];
 
@@ -278,35 +1032,64 @@ namespace lapack
         blas_index_t u_stride, vt_stride;
         std::tie(u_stride, vt_stride) = detail::init_u_vt(u, vt, jobz, m, n);
 
-        uvector<blas_index_t> iwork(8 * std::min(m, n));
-        blas_index_t a_stride = static_cast<blas_index_t>(std::max(std::size_t(1), m));
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+        std::size_t iwork_size = std::max(8 * std::min(m, n), std::size_t(1));
 
-        int info = cxxlapack::gesdd<blas_index_t>(
-            jobz,
-            static_cast<blas_index_t>(A.shape()[0]),
-            static_cast<blas_index_t>(A.shape()[1]),
-            A.data(),
-            a_stride,
-            s.data(),
-            u.data(),
-            u_stride,
-            vt.data(),
-            vt_stride,
-            work.data(),
-            static_cast<blas_index_t>(-1),
-            iwork.data()
-        );
+#if defined(XTENSOR_USE_CUDA)
+        int cuda_info = 0;
+        if (!ws.query_only() && cuda::detail::gesvd(jobz, m, n, A.data(), s.data(), u.data(), std::size_t(u_stride),
+                                                    vt.data(), std::size_t(vt_stride), cuda_info))
+        {
+            return std::make_tuple(cuda_info, std::move(u), std::move(s), std::move(vt));
+        }
+#endif
+
+        detail::workspace_key key = {routine::gesdd, {to_blas_index(m), to_blas_index(n), 0}, {jobz}};
+        auto query = [&](auto& w) {
+            w.reserve(workspace_sizes{1, 0, iwork_size});
+            int info = cxxlapack::gesdd<blas_index_t>(
+                jobz,
+                to_blas_index(A.shape()[0]),
+                to_blas_index(A.shape()[1]),
+                A.data(),
+                a_stride,
+                s.data(),
+                u.data(),
+                u_stride,
+                vt.data(),
+                vt_stride,
+                w.work.data(),
+                to_blas_index(-1),
+                w.iwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for real gesdd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, iwork_size};
+        };
+
+        if (jobz != 'O' && detail::use_fallback<value_type>(ws, key, query))
+        {
+            // gesvd needs a fraction of the workspace of gesdd; it has no
+            // counterpart of jobz = 'O', which keeps the gesdd workspace
+            auto res = gesvd(A, jobz, ws);
+            detail::last_driver_value() = routine::gesvd;
+            return res;
+        }
+
+        const auto& sizes = ws.sizes(key, query);
 
-        if (info != 0)
+        if (ws.query_only())
         {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for real gesdd.");
+            return std::make_tuple(0, std::move(u), std::move(s), std::move(vt));
         }
 
-        work.resize(static_cast<std::size_t>(work[0]));
-        info = cxxlapack::gesdd<blas_index_t>(
+        int info = cxxlapack::gesdd<blas_index_t>(
             jobz,
-            static_cast<blas_index_t>(A.shape()[0]),
-            static_cast<blas_index_t>(A.shape()[1]),
+            to_blas_index(A.shape()[0]),
+            to_blas_index(A.shape()[1]),
             A.data(),
             a_stride,
             s.data(),
@@ -314,18 +1097,19 @@ namespace lapack
             u_stride,
             vt.data(),
             vt_stride,
-            work.data(),
-            static_cast<blas_index_t>(work.size()),
-            iwork.data()
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.iwork.data()
         );
 
         return std::make_tuple(std::move(info), std::move(u), std::move(s), std::move(vt));
     }
 
     // Complex variant of gesdd
-    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto gesdd(E& A, char jobz = 'A')
+    template <class E, class Alloc, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto gesdd(E& A, char jobz, workspace<typename E::value_type, Alloc>& ws)
     {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gesdd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz);
         using value_type = typename E::value_type;
         using underlying_value_type = typename value_type::value_type;
         using xtype1 = xtensor<underlying_value_type, 1, layout_type::column_major>;
@@ -337,26 +1121,8 @@ namespace lapack
         std::size_t m = A.shape()[0];
         std::size_t n = A.shape()[1];
 
-        uvector<value_type> work(1);
-        uvector<underlying_value_type> rwork(1);
-        uvector<blas_index_t> iwork(8 * std::min(m, n));
-
-        std::size_t mx = std::max(m, n);
-        std::size_t mn = std::min(m, n);
-        if (jobz == 'N')
-        {
-            rwork.resize(5 * mn);
-        }
-        else if (mx > mn)
-        {
-            // TODO verify size
-            rwork.resize(5 * mn * mn + 5 * mn);
-        }
-        else
-        {
-            // TODO verify size
-            rwork.resize(std::max(5 * mn * mn + 5 * mn, 2 * mx * mn + 2 * mn * mn + mn));
-        }
+        std::size_t iwork_size = std::max(8 * std::min(m, n), std::size_t(1));
+        std::size_t rwork_size = detail::gesdd_rwork_size(jobz, m, n);
 
         xtype1 s;
         s.resize({ std::max(static_cast<std::size_t>(1), std::min(m, n)) });
@@ -365,35 +1131,64 @@ namespace lapack
 
         blas_index_t u_stride, vt_stride;
         std::tie(u_stride, vt_stride) = detail::init_u_vt(u, vt, jobz, m, n);
-        blas_index_t a_stride = static_cast<blas_index_t>(std::max(std::size_t(1), m));
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
 
-        int info = cxxlapack::gesdd<blas_index_t>(
-            jobz,
-            static_cast<blas_index_t>(A.shape()[0]),
-            static_cast<blas_index_t>(A.shape()[1]),
-            A.data(),
-            a_stride,
-            s.data(),
-            u.data(),
-            u_stride,
-            vt.data(),
-            vt_stride,
-            work.data(),
-            static_cast<blas_index_t>(-1),
-            rwork.data(),
-            iwork.data()
-        );
+#if defined(XTENSOR_USE_CUDA)
+        int cuda_info = 0;
+        if (!ws.query_only() && cuda::detail::gesvd(jobz, m, n, A.data(), s.data(), u.data(), std::size_t(u_stride),
+                                                    vt.data(), std::size_t(vt_stride), cuda_info))
+        {
+            return std::make_tuple(cuda_info, std::move(u), std::move(s), std::move(vt));
+        }
+#endif
 
-        if (info != 0)
+        detail::workspace_key key = {routine::gesdd, {to_blas_index(m), to_blas_index(n), 0}, {jobz}};
+        auto query = [&](auto& w) {
+            w.reserve(workspace_sizes{1, rwork_size, iwork_size});
+            int info = cxxlapack::gesdd<blas_index_t>(
+                jobz,
+                to_blas_index(A.shape()[0]),
+                to_blas_index(A.shape()[1]),
+                A.data(),
+                a_stride,
+                s.data(),
+                u.data(),
+                u_stride,
+                vt.data(),
+                vt_stride,
+                w.work.data(),
+                to_blas_index(-1),
+                w.rwork.data(),
+                w.iwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for complex gesdd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), rwork_size, iwork_size};
+        };
+
+        if (jobz != 'O' && detail::use_fallback<value_type>(ws, key, query))
+        {
+            // gesvd needs a fraction of the workspace of gesdd; it has no
+            // counterpart of jobz = 'O', which keeps the gesdd workspace
+            auto res = gesvd(A, jobz, ws);
+            detail::last_driver_value() = routine::gesvd;
+            return res;
+        }
+
+        const auto& sizes = ws.sizes(key, query);
+
+        if (ws.query_only())
         {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for complex gesdd.");
+            return std::make_tuple(0, std::move(u), std::move(s), std::move(vt));
         }
-        work.resize(static_cast<std::size_t>(std::real(work[0])));
 
-        info = cxxlapack::gesdd<blas_index_t>(
+        int info = cxxlapack::gesdd<blas_index_t>(
             jobz,
-            static_cast<blas_index_t>(A.shape()[0]),
-            static_cast<blas_index_t>(A.shape()[1]),
+            to_blas_index(A.shape()[0]),
+            to_blas_index(A.shape()[1]),
             A.data(),
             a_stride,
             s.data(),
@@ -401,531 +1196,5895 @@ namespace lapack
             u_stride,
             vt.data(),
             vt_stride,
-            work.data(),
-            static_cast<blas_index_t>(work.size()),
-            rwork.data(),
-            iwork.data()
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.rwork.data(),
+            ws.iwork.data()
         );
 
         return std::make_tuple(std::move(info), std::move(u), std::move(s), std::move(vt));
     }
 
-
     template <class E>
-    int potr(E& A, char uplo = 'L')
+    auto gesdd(E& A, char jobz = 'A')
     {
-        XTENSOR_ASSERT(A.dimension() == 2);
-        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
-
-        int info = cxxlapack::potrf<blas_index_t>(
-            uplo,
-            static_cast<blas_index_t>(A.shape()[0]),
-            A.data(),
-            stride_back(A)
-        );
-
-        return info;
+        return gesdd(A, jobz, workspace<typename E::value_type>::thread_local_instance());
     }
 
-    template <class E1, class E2>
-    int potrs(E1& A, E2& b, char uplo = 'L')
+    /**
+     * Interface to LAPACK gesdd with jobz 'N': stores the singular values
+     * of \em A in decreasing order into the first min(m, n) elements of
+     * \em s, without allocating U and Vt. It shares the workspace entry of
+     * gesdd(A, 'N'), so that nothing is allocated once it is cached.
+     *
+     * @param A Column-major matrix, destroyed on exit
+     * @param s real vector of at least min(m, n) elements
+     * @returns info
+     */
+    template <class E, class S, class Alloc, std::enable_if_t<!std::is_arithmetic<S>::value>* = nullptr>
+    int gesdd(E& A, S& s, workspace<typename E::value_type, Alloc>& ws)
     {
-      XTENSOR_ASSERT(A.dimension() == 2);
-      XTENSOR_ASSERT(A.layout() == layout_type::column_major);
-
-      XTENSOR_ASSERT(b.dimension() == 1);
+        XTENSOR_BLAS_INSTRUMENT_CALL("gesdd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, 'N');
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(s.size() >= std::min(A.shape()[0], A.shape()[1]));
 
-      XTENSOR_ASSERT(A.shape()[0] == A.shape()[1]);
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+        std::size_t iwork_size = std::max(8 * std::min(m, n), std::size_t(1));
+        std::size_t rwork_size = xtl::is_complex<typename E::value_type>::value ? detail::gesdd_rwork_size('N', m, n) : 0;
+
+        const auto& sizes = ws.sizes({routine::gesdd, {to_blas_index(m), to_blas_index(n), 0}, {'N'}},
+                                     [&](auto& w) {
+            w.reserve(workspace_sizes{1, rwork_size, iwork_size});
+            int info = detail::gesdd_values(to_blas_index(m), to_blas_index(n), A.data(), a_stride, s.data(),
+                                            w.work.data(), to_blas_index(-1), w.rwork.data(), w.iwork.data());
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gesdd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), rwork_size, iwork_size};
+        });
 
-      int info = cxxlapack::potrs<blas_index_t>(
-          uplo,
-          static_cast<blas_index_t>(A.shape()[0]),
-          1,
-          A.data(),
-          static_cast<blas_index_t>(A.shape()[0]),
-          b.data(),
-          static_cast<blas_index_t>(b.shape()[0])
-      );
+        if (ws.query_only())
+        {
+            return 0;
+        }
 
-      return info;
+        return detail::gesdd_values(to_blas_index(m), to_blas_index(n), A.data(), a_stride, s.data(),
+                                    ws.work.data(), to_blas_index(sizes.work), ws.rwork.data(), ws.iwork.data());
     }
 
-    template <class E1, class E2>
-    int trtrs(E1& A, E2& b, char uplo = 'L', char trans = 'N', char diag = 'N')
+    template <class E, class S, std::enable_if_t<!std::is_arithmetic<S>::value>* = nullptr>
+    int gesdd(E& A, S& s)
     {
-      XTENSOR_ASSERT(A.dimension() == 2);
-      XTENSOR_ASSERT(A.layout() == layout_type::column_major);
-
-      XTENSOR_ASSERT(b.dimension() == 1);
-
-      XTENSOR_ASSERT(A.shape()[0] == A.shape()[1]);
-
-      int info = cxxlapack::trtrs<blas_index_t>(
-          uplo,
-          trans,
-          diag,
-          static_cast<blas_index_t>(A.shape()[0]),
-          1,
-          A.data(),
-          static_cast<blas_index_t>(A.shape()[0]),
-          b.data(),
-          static_cast<blas_index_t>(b.shape()[0])
-      );
-
-      return info;
+        return gesdd(A, s, workspace<typename E::value_type>::thread_local_instance());
     }
 
     /**
-     * Interface to LAPACK getri.
+     * Interface to LAPACK gesvd, the SVD by QR iteration. It needs less
+     * workspace than gesdd (no integer work array and O(m + n) instead of
+     * O(min(m, n)^2) floating point work), at the price of a slower
+     * computation of the singular vectors.
      *
-     * @param A matrix to invert
-     * @return inverse of A
+     * @param A Column-major matrix, destroyed on exit
+     * @param jobz 'A' (all of U and Vt), 'S' (the min(m, n) leading columns
+     *        of U and rows of Vt) or 'N' (singular values only)
+     * @param ws workspace
+     * @returns tuple (info, U, S, Vt), as gesdd
      */
-    template <class E>
-    int getri(E& A, uvector<blas_index_t>& piv)
+    template <class E, class Alloc, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto gesvd(E& A, char jobz, workspace<typename E::value_type, Alloc>& ws)
     {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gesvd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz);
         using value_type = typename E::value_type;
+        using xtype1 = xtensor<value_type, 1, layout_type::column_major>;
+        using xtype2 = xtensor<value_type, 2, layout_type::column_major>;
 
         XTENSOR_ASSERT(A.dimension() == 2);
         XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
-        uvector<value_type> work(1);
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
 
-        // get work size
-        int info = cxxlapack::getri<blas_index_t>(
-            static_cast<blas_index_t>(A.shape()[0]),
-            A.data(),
-            stride_back(A),
-            piv.data(),
-            work.data(),
-            static_cast<blas_index_t>(-1)
-        );
+        xtype1 s;
+        s.resize({ std::max(static_cast<std::size_t>(1), std::min(m, n)) });
+
+        xtype2 u, vt;
 
-        if (info > 0)
+        blas_index_t u_stride, vt_stride;
+        std::tie(u_stride, vt_stride) = detail::init_u_vt(u, vt, jobz, m, n);
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+
+        const auto& sizes = ws.sizes({routine::gesvd, {to_blas_index(m), to_blas_index(n), 0}, {jobz}},
+                                     [&](auto& w) {
+            int info = cxxlapack::gesvd<blas_index_t>(
+                jobz,
+                jobz,
+                to_blas_index(m),
+                to_blas_index(n),
+                A.data(),
+                a_stride,
+                s.data(),
+                u.data(),
+                u_stride,
+                vt.data(),
+                vt_stride,
+                w.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for real gesvd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
         {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for getri.");
+            return std::make_tuple(0, std::move(u), std::move(s), std::move(vt));
         }
 
-        work.resize(static_cast<std::size_t>(std::real(work[0])));
-
-        info = cxxlapack::getri<blas_index_t>(
-            static_cast<blas_index_t>(A.shape()[0]),
+        int info = cxxlapack::gesvd<blas_index_t>(
+            jobz,
+            jobz,
+            to_blas_index(m),
+            to_blas_index(n),
             A.data(),
-            stride_back(A),
-            piv.data(),
-            work.data(),
-            static_cast<blas_index_t>(work.size())
+            a_stride,
+            s.data(),
+            u.data(),
+            u_stride,
+            vt.data(),
+            vt_stride,
+            ws.work.data(),
+            to_blas_index(sizes.work)
         );
 
-        return info;
+        return std::make_tuple(std::move(info), std::move(u), std::move(s), std::move(vt));
     }
 
-    /**
-     * Interface to LAPACK geev.
-     * @returns info
-     */
-    template <class E, class W, class V>
-    int geev(E& A, char jobvl, char jobvr, W& wr, W& wi, V& VL, V& VR)
+    // Complex variant of gesvd
+    template <class E, class Alloc, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto gesvd(E& A, char jobz, workspace<typename E::value_type, Alloc>& ws)
     {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gesvd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz);
+        using value_type = typename E::value_type;
+        using underlying_value_type = typename value_type::value_type;
+        using xtype1 = xtensor<underlying_value_type, 1, layout_type::column_major>;
+        using xtype2 = xtensor<value_type, 2, layout_type::column_major>;
+
         XTENSOR_ASSERT(A.dimension() == 2);
         XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
-        using value_type = typename E::value_type;
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
+        std::size_t rwork_size = std::max(5 * std::min(m, n), std::size_t(1));
 
-        const auto N = A.shape()[0];
-        uvector<value_type> work(1);
+        xtype1 s;
+        s.resize({ std::max(static_cast<std::size_t>(1), std::min(m, n)) });
 
-        int info = cxxlapack::geev<blas_index_t>(
-            jobvl,
-            jobvr,
-            static_cast<blas_index_t>(N),
-            A.data(),
-            stride_back(A),
-            wr.data(),
-            wi.data(),
-            VL.data(),
-            stride_back(VL),
-            VR.data(),
-            stride_back(VR),
-            work.data(),
-            static_cast<blas_index_t>(-1)
-        );
+        xtype2 u, vt;
 
-        if (info != 0)
+        blas_index_t u_stride, vt_stride;
+        std::tie(u_stride, vt_stride) = detail::init_u_vt(u, vt, jobz, m, n);
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+
+        const auto& sizes = ws.sizes({routine::gesvd, {to_blas_index(m), to_blas_index(n), 0}, {jobz}},
+                                     [&](auto& w) {
+            w.reserve(workspace_sizes{1, rwork_size, 0});
+            int info = cxxlapack::gesvd<blas_index_t>(
+                jobz,
+                jobz,
+                to_blas_index(m),
+                to_blas_index(n),
+                A.data(),
+                a_stride,
+                s.data(),
+                u.data(),
+                u_stride,
+                vt.data(),
+                vt_stride,
+                w.work.data(),
+                to_blas_index(-1),
+                w.rwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for complex gesvd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), rwork_size, 0};
+        });
+
+        if (ws.query_only())
         {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geev.");
+            return std::make_tuple(0, std::move(u), std::move(s), std::move(vt));
         }
 
-        work.resize(static_cast<std::size_t>(work[0]));
-
-        info = cxxlapack::geev<blas_index_t>(
-            jobvl,
-            jobvr,
-            static_cast<blas_index_t>(N),
+        int info = cxxlapack::gesvd<blas_index_t>(
+            jobz,
+            jobz,
+            to_blas_index(m),
+            to_blas_index(n),
             A.data(),
-            stride_back(A),
-            wr.data(),
-            wi.data(),
-            VL.data(),
-            stride_back(VL),
-            VR.data(),
-            stride_back(VR),
-            work.data(),
-            static_cast<blas_index_t>(work.size())
+            a_stride,
+            s.data(),
+            u.data(),
+            u_stride,
+            vt.data(),
+            vt_stride,
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.rwork.data()
         );
 
-        return info;
+        return std::make_tuple(std::move(info), std::move(u), std::move(s), std::move(vt));
+    }
+
+    template <class E>
+    auto gesvd(E& A, char jobz = 'A')
+    {
+        return gesvd(A, jobz, workspace<typename E::value_type>::thread_local_instance());
     }
 
     /**
-     * Interface to LAPACK syevd.
-     * @returns info
+     * Interface to LAPACK gesvj, the one-sided Jacobi SVD of a real matrix
+     * with m >= n. It computes the singular values to high relative
+     * accuracy and is fast for small, well-conditioned matrices. gesvj has
+     * no workspace query; its documented minimal workspace is used.
+     *
+     * @param A Column-major matrix, overwritten with the n leading left
+     *        singular vectors when \em jobu is 'U'
+     * @param jobu 'U' to compute the left singular vectors, 'N' otherwise
+     * @param jobv 'V' to compute the right singular vectors, 'N' otherwise
+     * @param ws workspace
+     * @returns tuple (info, S, V) with the singular values in descending
+     *          order and V of shape (n, n) (unreferenced for \em jobv 'N')
      */
-    template <class E, class W>
-    int syevd(E& A, char jobz, char uplo, W& w)
+    template <class E, class Alloc>
+    auto gesvj(E& A, char jobu, char jobv, workspace<typename E::value_type, Alloc>& ws)
     {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gesvj", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobu, jobv);
+        using value_type = typename E::value_type;
+        using xtype1 = xtensor<value_type, 1, layout_type::column_major>;
+        using xtype2 = xtensor<value_type, 2, layout_type::column_major>;
+        static_assert(!xtl::is_complex<value_type>::value, "gesvj only supports real matrices.");
+
         XTENSOR_ASSERT(A.dimension() == 2);
         XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
-        using value_type = typename E::value_type;
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
 
-        auto N = A.shape()[0];
-        uvector<value_type> work(1);
-        uvector<blas_index_t> iwork(1);
+        xtype1 s;
+        s.resize({ std::max(std::size_t(1), n) });
+        xtype2 v;
+        blas_index_t v_stride = 1;
+        if (jobv == 'V')
+        {
+            v.resize({n, n});
+            v_stride = to_blas_index(std::max(std::size_t(1), n));
+        }
 
-        int info = cxxlapack::syevd<blas_index_t>(
-            jobz,
-            uplo,
-            static_cast<blas_index_t>(N),
-            A.data(),
-            stride_back(A),
-            w.data(),
-            work.data(),
-            static_cast<blas_index_t>(-1),
-            iwork.data(),
-            static_cast<blas_index_t>(-1)
-        );
+        const auto& sizes = ws.sizes({routine::gesvj, {to_blas_index(m), to_blas_index(n), 0}, {jobu, jobv}},
+                                     [&](auto&) {
+            return workspace_sizes{std::max(m + n, std::size_t(6)), 0, 0};
+        });
 
-        if (info != 0)
+        if (ws.query_only())
         {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for syevd.");
+            return std::make_tuple(0, std::move(s), std::move(v));
         }
 
-        work.resize(std::size_t(work[0]));
-        iwork.resize(std::size_t(iwork[0]));
-
-        info = cxxlapack::syevd<blas_index_t>(
-            jobz,
-            uplo,
-            static_cast<blas_index_t>(N),
+        int info = cxxlapack::gesvj<blas_index_t>(
+            'G',
+            jobu,
+            jobv,
+            to_blas_index(m),
+            to_blas_index(n),
             A.data(),
-            stride_back(A),
-            w.data(),
-            work.data(),
-            static_cast<blas_index_t>(work.size()),
-            iwork.data(),
-            static_cast<blas_index_t>(iwork.size())
+            to_blas_index(std::max(std::size_t(1), m)),
+            s.data(),
+            0,
+            v.data(),
+            v_stride,
+            ws.work.data(),
+            to_blas_index(sizes.work)
         );
 
-        return info;
+        // the singular values are returned scaled to avoid overflow
+        value_type scale = ws.work[0];
+        if (info == 0 && scale != value_type(1))
+        {
+            std::transform(s.begin(), s.end(), s.begin(), [scale](value_type x) { return scale * x; });
+        }
+
+        return std::make_tuple(std::move(info), std::move(s), std::move(v));
+    }
+
+    template <class E>
+    auto gesvj(E& A, char jobu = 'U', char jobv = 'V')
+    {
+        return gesvj(A, jobu, jobv, workspace<typename E::value_type>::thread_local_instance());
     }
 
     /**
-     * Interface to LAPACK sygvd.
-     * @returns info
+     * Interface to LAPACK gejsv, the preconditioned Jacobi SVD of a real
+     * matrix with m >= n. It computes the singular values to high relative
+     * accuracy, also for badly scaled columns. gejsv has no workspace query
+     * in all LAPACK versions; its documented minimal workspace is used.
+     *
+     * @param A Column-major matrix, destroyed on exit
+     * @param jobu 'F' (all m left singular vectors), 'U' (the n leading
+     *        ones) or 'N'
+     * @param jobv 'V' to compute the right singular vectors, 'N' otherwise
+     * @param ws workspace
+     * @returns tuple (info, U, S, V) with the singular values in descending
+     *          order and V of shape (n, n)
      */
-    template <class E, class W>
-    int sygvd(E& A, E& B, blas_index_t itype, char jobz, char uplo, W& w)
+    template <class E, class Alloc>
+    auto gejsv(E& A, char jobu, char jobv, workspace<typename E::value_type, Alloc>& ws)
     {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gejsv", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobu, jobv);
+        using value_type = typename E::value_type;
+        using xtype1 = xtensor<value_type, 1, layout_type::column_major>;
+        using xtype2 = xtensor<value_type, 2, layout_type::column_major>;
+        static_assert(!xtl::is_complex<value_type>::value, "gejsv only supports real matrices.");
+
         XTENSOR_ASSERT(A.dimension() == 2);
         XTENSOR_ASSERT(A.layout() == layout_type::column_major);
-        XTENSOR_ASSERT(B.dimension() == 2);
-        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
 
-        using value_type = typename E::value_type;
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
 
-        auto N = A.shape()[0];
-        XTENSOR_ASSERT(B.shape()[0] ==N);
+        xtype1 s;
+        s.resize({ std::max(std::size_t(1), n) });
+        xtype2 u, v;
+        blas_index_t u_stride = 1, v_stride = 1;
+        if (jobu != 'N')
+        {
+            u.resize({m, jobu == 'F' ? m : n});
+            u_stride = to_blas_index(std::max(std::size_t(1), m));
+        }
+        if (jobv != 'N')
+        {
+            v.resize({n, n});
+            v_stride = to_blas_index(std::max(std::size_t(1), n));
+        }
 
-        uvector<value_type> work(1);
-        uvector<blas_index_t> iwork(1);
+        const auto& sizes = ws.sizes({routine::gejsv, {to_blas_index(m), to_blas_index(n), 0}, {jobu, jobv}},
+                                     [&](auto&) {
+            std::size_t lwork = std::max({std::size_t(7), 2 * m + n, 6 * n + 2 * n * n, m + 3 * n + n * n});
+            return workspace_sizes{lwork, 0, std::max(m + 3 * n, std::size_t(3))};
+        });
 
-        int info = cxxlapack::sygvd<blas_index_t>(
-            itype,
-            jobz,
-            uplo,
-            static_cast<blas_index_t>(N),
+        if (ws.query_only())
+        {
+            return std::make_tuple(0, std::move(u), std::move(s), std::move(v));
+        }
+
+        int info = cxxlapack::gejsv<blas_index_t>(
+            'C',
+            jobu,
+            jobv,
+            'R',
+            'N',
+            'N',
+            to_blas_index(m),
+            to_blas_index(n),
             A.data(),
-            stride_back(A),
-            B.data(),
-            stride_back(B),
-            w.data(),
-            work.data(),
-            static_cast<blas_index_t>(-1),
-            iwork.data(),
-            static_cast<blas_index_t>(-1)
+            to_blas_index(std::max(std::size_t(1), m)),
+            s.data(),
+            u.data(),
+            u_stride,
+            v.data(),
+            v_stride,
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.iwork.data()
         );
 
-        if (info != 0)
+        // sigma = (work[1] / work[0]) * sva
+        if (info == 0 && ws.work[0] != ws.work[1])
         {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for sygvd.");
+            value_type scale = ws.work[1] / ws.work[0];
+            std::transform(s.begin(), s.end(), s.begin(), [scale](value_type x) { return scale * x; });
         }
 
-        work.resize(std::size_t(work[0]));
-        iwork.resize(std::size_t(iwork[0]));
+        return std::make_tuple(std::move(info), std::move(u), std::move(s), std::move(v));
+    }
 
-        info = cxxlapack::sygvd<blas_index_t>(
-            itype,
-            jobz,
+    template <class E>
+    auto gejsv(E& A, char jobu = 'U', char jobv = 'V')
+    {
+        return gejsv(A, jobu, jobv, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+
+    template <class E>
+    int potr(E& A, char uplo = 'L')
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("potrf", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo, 0,
+                                     instrument::fma_flops<typename E::value_type>(double(A.shape()[0]) * double(A.shape()[0]) * double(A.shape()[0]) / 6.));
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        int info = cxxlapack::potrf<blas_index_t>(
             uplo,
-            static_cast<blas_index_t>(N),
+            to_blas_index(A.shape()[0]),
             A.data(),
-            stride_back(A),
-            B.data(),
-            stride_back(B),
-            w.data(),
-            work.data(),
-            static_cast<blas_index_t>(work.size()),
-            iwork.data(),
-            static_cast<blas_index_t>(iwork.size())
+            stride_back(A)
         );
 
         return info;
     }
 
     /**
-     * Complex version of geev
+     * Interface to LAPACK pstrf: the Cholesky factorization with complete
+     * pivoting P^T A P = L L^H (uplo 'L') or U^H U (uplo 'U') of a positive
+     * semidefinite matrix. It stops when the largest remaining diagonal
+     * element is at most \em tol, a negative \em tol selecting
+     * n eps max(diag(A)), and returns the number of computed columns in
+     * \em rank; the trailing block of \em A beyond it is not referenced.
+     * \em piv receives the 1-based pivots.
+     * @returns info, 1 if \em A is rank deficient
      */
-    template <class E, class W, class V>
-    int geev(E& A, char jobvl, char jobvr, W& w, V& VL, V& VR)
+    template <class E, class P, class Alloc>
+    int pstrf(E& A, P& piv, blas_index_t& rank, xtl::complex_value_type_t<typename E::value_type> tol,
+              char uplo, workspace<typename E::value_type, Alloc>& ws)
     {
-        // TODO implement for complex numbers
-
+        XTENSOR_BLAS_INSTRUMENT_CALL("pstrf", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo, 0);
         XTENSOR_ASSERT(A.dimension() == 2);
         XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(piv.size() >= A.shape()[0]);
 
-        using value_type = typename E::value_type;
-        using underlying_value_type = typename value_type::value_type;
-
-        const auto N = A.shape()[0];
-        uvector<value_type> work(1);
-        uvector<underlying_value_type> rwork(2 * N);
+        blas_index_t n = to_blas_index(A.shape()[0]);
 
-        int info = cxxlapack::geev<blas_index_t>(
-            jobvl,
-            jobvr,
-            static_cast<blas_index_t>(N),
-            A.data(),
-            stride_back(A),
-            w.data(),
-            VL.data(),
-            stride_back(VL),
-            VR.data(),
-            stride_back(VR),
-            work.data(),
-            -1,
-            rwork.data()
-        );
+        // pstrf has no workspace query: the real work array has 2 n elements
+        ws.sizes({routine::pstrf, {n, 0, 0}, {}}, [&](auto&) {
+            return workspace_sizes{0, std::max(2 * static_cast<std::size_t>(n), std::size_t(1)), 0};
+        });
 
-        if (info != 0)
+        if (ws.query_only())
         {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geev.");
+            return 0;
         }
 
-        work.resize(std::size_t(std::real(work[0])));
-
-        info = cxxlapack::geev<blas_index_t>(
-            jobvl,
-            jobvr,
-            static_cast<blas_index_t>(N),
-            A.data(),
-            stride_back(A),
-            w.data(),
-            VL.data(),
-            stride_back(VL),
-            VR.data(),
-            stride_back(VR),
-            work.data(),
-            static_cast<blas_index_t>(work.size()),
-            rwork.data()
+        return cxxlapack::pstrf<blas_index_t>(
+            uplo, n, A.data(), std::max(stride_back(A), blas_index_t(1)),
+            piv.data(), rank, tol, ws.rwork.data()
         );
-
-        return info;
     }
 
-    template <class E, class W>
-    int heevd(E& A, char jobz, char uplo, W& w)
+    template <class E, class P>
+    int pstrf(E& A, P& piv, blas_index_t& rank, xtl::complex_value_type_t<typename E::value_type> tol = -1,
+              char uplo = 'L')
     {
-        XTENSOR_ASSERT(A.dimension() == 2);
-        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
-
-        using value_type = typename E::value_type;
-        using underlying_value_type = typename value_type::value_type;
+        return pstrf(A, piv, rank, tol, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
 
-        auto N = A.shape()[0];
-        uvector<value_type> work(1);
-        uvector<underlying_value_type> rwork(1);
-        uvector<blas_index_t> iwork(1);
+    template <class E1, class E2>
+    int potrs(E1& A, E2& b, char uplo = 'L')
+    {
+      XTENSOR_BLAS_INSTRUMENT_CALL("potrs", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, uplo, 0,
+                                   instrument::fma_flops<typename E1::value_type>(double(A.shape()[0]) * double(A.shape()[0]) * double(b.dimension() > 1 ? b.shape()[1] : 1)));
+      XTENSOR_ASSERT(A.dimension() == 2);
+      XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
-        int info = cxxlapack::heevd<blas_index_t>(
-            jobz,
-            uplo,
-            static_cast<blas_index_t>(N),
-            A.data(),
-            stride_back(A),
-            w.data(),
-            work.data(),
-            static_cast<blas_index_t>(-1),
-            rwork.data(),
-            static_cast<blas_index_t>(-1),
-            iwork.data(),
-            static_cast<blas_index_t>(-1)
-        );
+      XTENSOR_ASSERT(b.dimension() <= 2);
 
-        if (info != 0)
-        {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for heevd.");
-        }
+      XTENSOR_ASSERT(A.shape()[0] == A.shape()[1]);
 
-        work.resize(std::size_t(std::real(work[0])));
-        rwork.resize(std::size_t(rwork[0]));
-        iwork.resize(std::size_t(iwork[0]));
+      blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+      blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
 
-        info = cxxlapack::heevd<blas_index_t>(
-            jobz,
-            uplo,
-            static_cast<blas_index_t>(N),
-            A.data(),
-            stride_back(A),
-            w.data(),
-            work.data(),
-            static_cast<blas_index_t>(work.size()),
-            rwork.data(),
-            static_cast<blas_index_t>(rwork.size()),
-            iwork.data(),
-            static_cast<blas_index_t>(iwork.size())
-        );
+      int info = cxxlapack::potrs<blas_index_t>(
+          uplo,
+          to_blas_index(A.shape()[0]),
+          b_dim,
+          A.data(),
+          to_blas_index(A.shape()[0]),
+          b.data(),
+          std::max(b_stride, blas_index_t(1))
+      );
 
-        return info;
+      return info;
     }
 
-    template <class E, class F, class S, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    int gelsd(E& A, F& b, S& s, blas_index_t& rank, double rcond)
+    template <class E1, class E2>
+    int trtrs(E1& A, E2& b, char uplo = 'L', char trans = 'N', char diag = 'N')
     {
-        using value_type = typename E::value_type;
+      XTENSOR_BLAS_INSTRUMENT_CALL("trtrs", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, uplo, trans,
+                                   instrument::fma_flops<typename E1::value_type>(0.5 * double(A.shape()[0]) * double(A.shape()[0]) * double(b.dimension() > 1 ? b.shape()[1] : 1)));
+      XTENSOR_ASSERT(A.dimension() == 2);
+      XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
-        uvector<value_type> work(1);
-        uvector<blas_index_t> iwork(1);
+      XTENSOR_ASSERT(b.dimension() <= 2);
 
-        blas_index_t b_dim = b.dimension() > 1 ? static_cast<blas_index_t>(b.shape().back()) : 1;
+      XTENSOR_ASSERT(A.shape()[0] == A.shape()[1]);
 
-        std::size_t m = A.shape()[0];
-        std::size_t n = A.shape()[1];
+      blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+      blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
 
-        blas_index_t a_stride = static_cast<blas_index_t>(std::max(std::size_t(1), m));
-        blas_index_t b_stride = static_cast<blas_index_t>(std::max(std::max(std::size_t(1), m), n));
+      int info = cxxlapack::trtrs<blas_index_t>(
+          uplo,
+          trans,
+          diag,
+          to_blas_index(A.shape()[0]),
+          b_dim,
+          A.data(),
+          std::max(stride_back(A), blas_index_t(1)),
+          b.data(),
+          std::max(b_stride, blas_index_t(1))
+      );
 
-        int info = cxxlapack::gelsd<blas_index_t>(
-            static_cast<blas_index_t>(A.shape()[0]),
-            static_cast<blas_index_t>(A.shape()[1]),
-            b_dim,
-            A.data(),
-            a_stride,
-            b.data(),
-            b_stride,
-            s.data(),
-            rcond,
-            rank,
-            work.data(),
-            static_cast<blas_index_t>(-1),
-            iwork.data()
-        );
+      return info;
+    }
 
-        if (info != 0)
-        {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gelsd.");
-        }
+    /**
+     * Interface to LAPACK getrs.
+     *
+     * Solves A X = B (or A^T X = B, A^H X = B) with the LU factorization
+     * computed by getrf.
+     */
+    template <class E, class P, class F>
+    int getrs(E& A, P& piv, F& b, char trans = 'N')
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("getrs", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, trans, 0,
+                                     instrument::fma_flops<typename E::value_type>(double(A.shape()[0]) * double(A.shape()[0]) * double(b.dimension() > 1 ? b.shape()[1] : 1)));
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
 
-        work.resize(std::size_t(work[0]));
-        iwork.resize(std::size_t(iwork[0]));
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
 
-        info = cxxlapack::gelsd<blas_index_t>(
-            static_cast<blas_index_t>(A.shape()[0]),
-            static_cast<blas_index_t>(A.shape()[1]),
+        int info = cxxlapack::getrs<blas_index_t>(
+            trans,
+            to_blas_index(A.shape()[0]),
             b_dim,
             A.data(),
-            a_stride,
+            std::max(stride_back(A), blas_index_t(1)),
+            piv.data(),
             b.data(),
-            b_stride,
-            s.data(),
-            rcond,
-            rank,
-            work.data(),
-            static_cast<blas_index_t>(work.size()),
-            iwork.data()
+            std::max(b_stride, blas_index_t(1))
         );
 
         return info;
     }
 
-    template <class E, class F, class S, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    int gelsd(E& A, F& b, S& s, blas_index_t& rank, double rcond = -1)
+    /**
+     * Interface to LAPACK laswp.
+     *
+     * Interchanges the rows of the matrix or vector \em A with the one based
+     * pivots returned by getrf: row i with row piv[i] - 1, for increasing i,
+     * or for decreasing i if not \em forward, which undoes them.
+     */
+    template <class E, class P>
+    void laswp(E& A, const P& piv, bool forward = true)
     {
-        using value_type = typename E::value_type;
-        using underlying_value_type = typename value_type::value_type;
-
-        uvector<value_type> work(1);
-        uvector<underlying_value_type> rwork(1);
-        uvector<blas_index_t> iwork(1);
+        XTENSOR_BLAS_INSTRUMENT_CALL("laswp", A.shape()[0], A.dimension() > 1 ? A.shape()[1] : 1, 0, layout_type::column_major);
+        XTENSOR_ASSERT(A.dimension() <= 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
-        blas_index_t b_dim = b.dimension() > 1 ? static_cast<blas_index_t>(b.shape().back()) : 1;
-        blas_index_t b_stride = b_dim == 1 ? static_cast<blas_index_t>(b.shape().front()) : stride_back(b);
+        blas_index_t n = A.dimension() > 1 ? to_blas_index(A.shape()[1]) : 1;
+        blas_index_t ld = A.dimension() > 1 ? stride_back(A) : to_blas_index(A.shape()[0]);
+        if (piv.size() == 0 || n == 0)
+        {
+            return;
+        }
 
-        int info = cxxlapack::gelsd<blas_index_t>(
-            static_cast<blas_index_t>(A.shape()[0]),
-            static_cast<blas_index_t>(A.shape()[1]),
-            b_dim,
+        cxxlapack::laswp<blas_index_t>(
+            n,
             A.data(),
-            stride_back(A),
-            b.data(),
-            b_stride,
-            s.data(),
-            rcond,
-            rank,
-            work.data(),
-            static_cast<blas_index_t>(-1),
-            rwork.data(),
-            iwork.data()
+            std::max(ld, blas_index_t(1)),
+            1,
+            to_blas_index(piv.size()),
+            piv.data(),
+            forward ? 1 : -1
         );
+    }
 
-        if (info != 0)
-        {
-            XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gelsd.");
-        }
-
-        work.resize(std::size_t(std::real(work[0])));
-        rwork.resize(std::size_t(rwork[0]));
-        iwork.resize(std::size_t(iwork[0]));
+    /**
+     * Interface to LAPACK potri.
+     *
+     * Computes the inverse from the Cholesky factorization computed by potr.
+     * Only the \em uplo triangle of the result is set.
+     */
+    template <class E>
+    int potri(E& A, char uplo = 'L')
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("potri", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
 
-        info = cxxlapack::gelsd<blas_index_t>(
-            static_cast<blas_index_t>(A.shape()[0]),
-            static_cast<blas_index_t>(A.shape()[1]),
-            b_dim,
+        int info = cxxlapack::potri<blas_index_t>(
+            uplo,
+            to_blas_index(A.shape()[0]),
             A.data(),
-            stride_back(A),
-            b.data(),
-            b_stride,
-            s.data(),
-            rcond,
-            rank,
-            work.data(),
-            static_cast<blas_index_t>(work.size()),
-            rwork.data(),
-            iwork.data()
+            std::max(stride_back(A), blas_index_t(1))
         );
 
         return info;
     }
+
+    /**
+     * Interface to LAPACK trtri.
+     *
+     * Inverts the \em uplo triangle of \em A in place; \em diag 'U' takes
+     * the diagonal as one. The other triangle is not referenced.
+     * @returns info, positive if A is singular
+     */
+    template <class E>
+    int trtri(E& A, char uplo = 'L', char diag = 'N')
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("trtri", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo, diag,
+                                     instrument::fma_flops<typename E::value_type>(double(A.shape()[0]) * double(A.shape()[0]) * double(A.shape()[0]) / 6.));
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        int info = cxxlapack::trtri<blas_index_t>(
+            uplo,
+            diag,
+            to_blas_index(A.shape()[0]),
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK trsyl.
+     *
+     * Solves the Sylvester equation op(A) X + isgn X op(B) = scale C for the
+     * upper (quasi) triangular Schur forms \em A (m x m) and \em B (n x n),
+     * overwriting the m x n \em C with X. \em trana and \em tranb are 'N',
+     * 'T' or, for complex matrices, 'C'. \em scale <= 1 is chosen to avoid
+     * overflow.
+     * @returns info, 1 if A and -isgn B have common or close eigenvalues
+     */
+    template <class E, class F, class G>
+    int trsyl(const E& A, const F& B, G& C, char trana, char tranb, blas_index_t isgn,
+              xtl::complex_value_type_t<typename E::value_type>& scale)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("trsyl", C.shape()[0], C.shape()[1], 0, layout_type::column_major, trana, tranb,
+                                     instrument::fma_flops<typename E::value_type>(double(C.shape()[0]) * double(C.shape()[1])
+                                                                                   * double(C.shape()[0] + C.shape()[1]) / 2.));
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(C.layout() == layout_type::column_major);
+
+        // a single column has a zero column stride
+        blas_index_t ldc = C.shape()[1] == 1 ? to_blas_index(C.shape()[0]) : stride_back(C);
+        int info = cxxlapack::trsyl<blas_index_t>(
+            trana,
+            tranb,
+            isgn,
+            to_blas_index(C.shape()[0]),
+            to_blas_index(C.shape()[1]),
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            B.data(),
+            std::max(stride_back(B), blas_index_t(1)),
+            C.data(),
+            std::max(ldc, blas_index_t(1)),
+            scale
+        );
+
+        return info;
+    }
+
+    namespace detail
+    {
+        template <class E, class P, class W>
+        inline int call_sytrf(E& A, P& piv, char uplo, W* work, blas_index_t lwork, std::false_type /*hermitian*/)
+        {
+            return cxxlapack::sytrf<blas_index_t>(uplo, to_blas_index(A.shape()[0]), A.data(),
+                                                  std::max(stride_back(A), blas_index_t(1)), piv.data(), work, lwork);
+        }
+
+        template <class E, class P, class W>
+        inline int call_sytrf(E& A, P& piv, char uplo, W* work, blas_index_t lwork, std::true_type /*hermitian*/)
+        {
+            return cxxlapack::hetrf<blas_index_t>(uplo, to_blas_index(A.shape()[0]), A.data(),
+                                                  std::max(stride_back(A), blas_index_t(1)), piv.data(), work, lwork);
+        }
+
+        // Bunch-Kaufman factorization of sytrf (H false) or hetrf (H true)
+        template <class H, class E, class P, class Alloc>
+        inline int bunch_kaufman(E& A, P& piv, char uplo, workspace<typename E::value_type, Alloc>& ws)
+        {
+            XTENSOR_ASSERT(A.dimension() == 2);
+            XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+            const char* name = H::value ? "hetrf" : "sytrf";
+            routine r = H::value ? routine::hetrf : routine::sytrf;
+            blas_index_t n = to_blas_index(A.shape()[0]);
+            const auto& sizes = ws.sizes({r, {n, 0, 0}, {uplo}}, [&](auto& c) {
+                int info = call_sytrf(A, piv, uplo, c.work.data(), to_blas_index(-1), H());
+                if (info != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, std::string("Could not find workspace size for ") + name + ".");
+                }
+                return workspace_sizes{detail::workspace_query_result(c.work[0]), 0, 0};
+            });
+
+            if (ws.query_only())
+            {
+                return 0;
+            }
+            return call_sytrf(A, piv, uplo, ws.work.data(), to_blas_index(std::max(sizes.work, std::size_t(1))), H());
+        }
+    }
+
+    /**
+     * Interface to LAPACK sytrf: Bunch-Kaufman factorization of a symmetric
+     * (complex symmetric) matrix, for sytri or sytrs.
+     * @returns info, positive if the block diagonal factor is singular
+     */
+    template <class E, class P, class Alloc>
+    int sytrf(E& A, P& piv, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("sytrf", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        return detail::bunch_kaufman<std::false_type>(A, piv, uplo, ws);
+    }
+
+    template <class E, class P>
+    int sytrf(E& A, P& piv, char uplo = 'L')
+    {
+        return sytrf(A, piv, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK hetrf: Bunch-Kaufman factorization of a Hermitian
+     * matrix, for hetri or hetrs.
+     * @returns info, positive if the block diagonal factor is singular
+     */
+    template <class E, class P, class Alloc>
+    int hetrf(E& A, P& piv, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("hetrf", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        return detail::bunch_kaufman<std::true_type>(A, piv, uplo, ws);
+    }
+
+    template <class E, class P>
+    int hetrf(E& A, P& piv, char uplo = 'L')
+    {
+        return hetrf(A, piv, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK sytri.
+     *
+     * Computes the inverse from the factorization of sytrf. Only the
+     * \em uplo triangle of the result is set.
+     * @returns info, positive if A is singular
+     */
+    template <class E, class P, class Alloc>
+    int sytri(E& A, const P& piv, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("sytri", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        ws.reserve(workspace_sizes{std::max(2 * A.shape()[0], std::size_t(1)), 0, 0});
+        int info = cxxlapack::sytri<blas_index_t>(
+            uplo,
+            to_blas_index(A.shape()[0]),
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            piv.data(),
+            ws.work.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class P>
+    int sytri(E& A, const P& piv, char uplo = 'L')
+    {
+        return sytri(A, piv, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK hetri, see sytri.
+     * @returns info, positive if A is singular
+     */
+    template <class E, class P, class Alloc>
+    int hetri(E& A, const P& piv, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("hetri", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        ws.reserve(workspace_sizes{std::max(A.shape()[0], std::size_t(1)), 0, 0});
+        int info = cxxlapack::hetri<blas_index_t>(
+            uplo,
+            to_blas_index(A.shape()[0]),
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            piv.data(),
+            ws.work.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class P>
+    int hetri(E& A, const P& piv, char uplo = 'L')
+    {
+        return hetri(A, piv, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    namespace detail
+    {
+        template <class E, class P, class F>
+        inline int call_sytrs(E& A, const P& piv, F& b, char uplo, std::false_type /*hermitian*/)
+        {
+            blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+            blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+            return cxxlapack::sytrs<blas_index_t>(uplo, to_blas_index(A.shape()[0]), b_dim, A.data(),
+                                                  std::max(stride_back(A), blas_index_t(1)), piv.data(),
+                                                  b.data(), std::max(b_stride, blas_index_t(1)));
+        }
+
+        template <class E, class P, class F>
+        inline int call_sytrs(E& A, const P& piv, F& b, char uplo, std::true_type /*hermitian*/)
+        {
+            blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+            blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+            return cxxlapack::hetrs<blas_index_t>(uplo, to_blas_index(A.shape()[0]), b_dim, A.data(),
+                                                  std::max(stride_back(A), blas_index_t(1)), piv.data(),
+                                                  b.data(), std::max(b_stride, blas_index_t(1)));
+        }
+
+        template <class E, class P, class F, class W>
+        inline int call_sytrs2(E& A, const P& piv, F& b, char uplo, W* work, std::false_type /*hermitian*/)
+        {
+            return cxxlapack::sytrs2<blas_index_t>(uplo, to_blas_index(A.shape()[0]), to_blas_index(b.shape()[1]),
+                                                   A.data(), std::max(stride_back(A), blas_index_t(1)), piv.data(),
+                                                   b.data(), std::max(stride_back(b), blas_index_t(1)), work);
+        }
+
+        template <class E, class P, class F, class W>
+        inline int call_sytrs2(E& A, const P& piv, F& b, char uplo, W* work, std::true_type /*hermitian*/)
+        {
+            return cxxlapack::hetrs2<blas_index_t>(uplo, to_blas_index(A.shape()[0]), to_blas_index(b.shape()[1]),
+                                                   A.data(), std::max(stride_back(A), blas_index_t(1)), piv.data(),
+                                                   b.data(), std::max(stride_back(b), blas_index_t(1)), work);
+        }
+
+        // sytrs / hetrs (H true) for one right hand side, sytrs2 / hetrs2
+        // (level 3 BLAS, n workspace) for several
+        template <class H, class E, class P, class F, class Alloc>
+        inline int bunch_kaufman_solve(E& A, const P& piv, F& b, char uplo, workspace<typename E::value_type, Alloc>& ws)
+        {
+            XTENSOR_ASSERT(A.dimension() == 2);
+            XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+            XTENSOR_ASSERT(b.dimension() <= 2);
+            XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+            if (b.dimension() < 2 || b.shape()[1] < 2)
+            {
+                return call_sytrs(A, piv, b, uplo, H());
+            }
+            ws.reserve(workspace_sizes{std::max(A.shape()[0], std::size_t(1)), 0, 0});
+            return call_sytrs2(A, piv, b, uplo, ws.work.data(), H());
+        }
+
+        template <class E, class P, class R, class Alloc>
+        inline int call_sycon(E& A, const P& piv, char uplo, R anorm, R& rcond,
+                              workspace<typename E::value_type, Alloc>& ws, std::false_type /*is_complex*/)
+        {
+            std::size_t n = std::max(A.shape()[0], std::size_t(1));
+            ws.reserve(workspace_sizes{2 * n, 0, n});
+            return cxxlapack::sycon<blas_index_t>(uplo, to_blas_index(A.shape()[0]), A.data(),
+                                                  std::max(stride_back(A), blas_index_t(1)), piv.data(),
+                                                  anorm, rcond, ws.work.data(), ws.iwork.data());
+        }
+
+        template <class E, class P, class R, class Alloc>
+        inline int call_sycon(E& A, const P& piv, char uplo, R anorm, R& rcond,
+                              workspace<typename E::value_type, Alloc>& ws, std::true_type /*is_complex*/)
+        {
+            ws.reserve(workspace_sizes{2 * std::max(A.shape()[0], std::size_t(1)), 0, 0});
+            return cxxlapack::sycon<blas_index_t>(uplo, to_blas_index(A.shape()[0]), A.data(),
+                                                  std::max(stride_back(A), blas_index_t(1)), piv.data(),
+                                                  anorm, rcond, ws.work.data());
+        }
+    }
+
+    /**
+     * Interface to LAPACK sytrs and sytrs2.
+     *
+     * Solves A X = B with the factorization computed by sytrf. Several
+     * right hand sides go through sytrs2, which converts the factor in
+     * place to apply it with level 3 BLAS and restores it before returning.
+     */
+    template <class E, class P, class F, class Alloc>
+    int sytrs(E& A, const P& piv, F& b, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("sytrs", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, uplo, 0,
+                                     instrument::fma_flops<typename E::value_type>(double(A.shape()[0]) * double(A.shape()[0]) * double(b.dimension() > 1 ? b.shape()[1] : 1)));
+        return detail::bunch_kaufman_solve<std::false_type>(A, piv, b, uplo, ws);
+    }
+
+    template <class E, class P, class F>
+    int sytrs(E& A, const P& piv, F& b, char uplo = 'L')
+    {
+        return sytrs(A, piv, b, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK hetrs and hetrs2, see sytrs.
+     */
+    template <class E, class P, class F, class Alloc>
+    int hetrs(E& A, const P& piv, F& b, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("hetrs", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, uplo, 0,
+                                     instrument::fma_flops<typename E::value_type>(double(A.shape()[0]) * double(A.shape()[0]) * double(b.dimension() > 1 ? b.shape()[1] : 1)));
+        return detail::bunch_kaufman_solve<std::true_type>(A, piv, b, uplo, ws);
+    }
+
+    template <class E, class P, class F>
+    int hetrs(E& A, const P& piv, F& b, char uplo = 'L')
+    {
+        return hetrs(A, piv, b, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK sycon.
+     *
+     * Estimates the reciprocal condition number in the 1-norm of a
+     * symmetric (complex symmetric) matrix from its factorization computed
+     * by sytrf. \em anorm is the 1-norm of the matrix before the
+     * factorization.
+     */
+    template <class E, class P, class R, class Alloc>
+    int sycon(E& A, const P& piv, char uplo, R anorm, R& rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("sycon", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        return detail::call_sycon(A, piv, uplo, anorm, rcond, ws, xtl::is_complex<typename E::value_type>());
+    }
+
+    template <class E, class P, class R>
+    int sycon(E& A, const P& piv, char uplo, R anorm, R& rcond)
+    {
+        return sycon(A, piv, uplo, anorm, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK hecon, see sycon; for the factorization of a
+     * Hermitian matrix computed by hetrf.
+     */
+    template <class E, class P, class R, class Alloc>
+    int hecon(E& A, const P& piv, char uplo, R anorm, R& rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("hecon", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        ws.reserve(workspace_sizes{2 * std::max(A.shape()[0], std::size_t(1)), 0, 0});
+        // the pivots are only read, the interface lacks the const
+        int info = cxxlapack::hecon<blas_index_t>(
+            uplo,
+            to_blas_index(A.shape()[0]),
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            const_cast<blas_index_t*>(piv.data()),
+            anorm,
+            rcond,
+            ws.work.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class P, class R>
+    int hecon(E& A, const P& piv, char uplo, R anorm, R& rcond)
+    {
+        return hecon(A, piv, uplo, anorm, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    namespace detail
+    {
+        /**
+         * Order of the matrix whose packed triangle has \em size elements.
+         */
+        inline blas_index_t packed_order(std::size_t size)
+        {
+            double root = std::sqrt(8. * static_cast<double>(size) + 1.);
+            std::size_t n = static_cast<std::size_t>((root - 1.) / 2. + 0.5);
+            XTENSOR_ASSERT(n * (n + 1) / 2 == size);
+            return to_blas_index(n);
+        }
+    }
+
+    /**
+     * Interface to LAPACK pptrf.
+     *
+     * Cholesky factorization of a symmetric (Hermitian) positive definite
+     * matrix whose \em uplo triangle is packed column by column in \em AP.
+     * The factor overwrites \em AP.
+     */
+    template <class E>
+    int pptrf(E& AP, char uplo = 'L')
+    {
+        int info = cxxlapack::pptrf<blas_index_t>(
+            uplo,
+            detail::packed_order(AP.size()),
+            AP.data()
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK pptrs.
+     *
+     * Solves A X = B with the packed Cholesky factor computed by pptrf.
+     */
+    template <class E, class F>
+    int pptrs(const E& AP, F& b, char uplo = 'L')
+    {
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        int info = cxxlapack::pptrs<blas_index_t>(
+            uplo,
+            detail::packed_order(AP.size()),
+            b_dim,
+            AP.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK spsv.
+     *
+     * Solves A X = B for a symmetric matrix packed in \em AP, with the
+     * Bunch-Kaufman factorization. The factorization overwrites \em AP and
+     * \em piv, the solution overwrites \em b.
+     */
+    template <class E, class P, class F>
+    int spsv(E& AP, P& piv, F& b, char uplo = 'L')
+    {
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        int info = cxxlapack::spsv<blas_index_t>(
+            uplo,
+            detail::packed_order(AP.size()),
+            b_dim,
+            AP.data(),
+            piv.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK hpsv, the Hermitian counterpart of spsv.
+     */
+    template <class E, class P, class F>
+    int hpsv(E& AP, P& piv, F& b, char uplo = 'L')
+    {
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        int info = cxxlapack::hpsv<blas_index_t>(
+            uplo,
+            detail::packed_order(AP.size()),
+            b_dim,
+            AP.data(),
+            piv.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK tptrs.
+     *
+     * Solves A X = B (or A^T X = B, A^H X = B) for a triangular matrix
+     * packed in \em AP.
+     */
+    template <class E, class F>
+    int tptrs(const E& AP, F& b, char uplo = 'L', char trans = 'N', char diag = 'N')
+    {
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        int info = cxxlapack::tptrs<blas_index_t>(
+            uplo,
+            trans,
+            diag,
+            detail::packed_order(AP.size()),
+            b_dim,
+            AP.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK gbtrf.
+     *
+     * LU factorization with partial pivoting of an m by n band matrix with
+     * \em kl sub- and \em ku super-diagonals. \em AB is column major with
+     * 2 kl + ku + 1 rows: A(i, j) is stored in AB(kl + ku + i - j, j), and the
+     * first kl rows are overwritten by the fill-in of the factorization.
+     */
+    template <class E, class P>
+    int gbtrf(E& AB, std::size_t m, std::size_t kl, std::size_t ku, P& piv)
+    {
+        XTENSOR_ASSERT(AB.dimension() == 2);
+        XTENSOR_ASSERT(AB.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(AB.shape()[0] == 2 * kl + ku + 1);
+
+        int info = cxxlapack::gbtrf<blas_index_t>(
+            to_blas_index(m),
+            to_blas_index(AB.shape()[1]),
+            to_blas_index(kl),
+            to_blas_index(ku),
+            AB.data(),
+            to_blas_index(AB.shape()[0]),
+            piv.data()
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK gbtrs.
+     *
+     * Solves A X = B (or A^T X = B, A^H X = B) with the band LU factorization
+     * computed by gbtrf.
+     */
+    template <class E, class P, class F>
+    int gbtrs(const E& AB, std::size_t kl, std::size_t ku, const P& piv, F& b, char trans = 'N')
+    {
+        XTENSOR_ASSERT(AB.dimension() == 2);
+        XTENSOR_ASSERT(AB.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        int info = cxxlapack::gbtrs<blas_index_t>(
+            trans,
+            to_blas_index(AB.shape()[1]),
+            to_blas_index(kl),
+            to_blas_index(ku),
+            b_dim,
+            AB.data(),
+            to_blas_index(AB.shape()[0]),
+            piv.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK gbsv.
+     *
+     * Solves A X = B for a square band matrix, stored in \em AB as for gbtrf.
+     * The factorization overwrites \em AB and \em piv, the solution \em b.
+     */
+    template <class E, class P, class F>
+    int gbsv(E& AB, std::size_t kl, std::size_t ku, P& piv, F& b)
+    {
+        XTENSOR_ASSERT(AB.dimension() == 2);
+        XTENSOR_ASSERT(AB.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(AB.shape()[0] == 2 * kl + ku + 1);
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        int info = cxxlapack::gbsv<blas_index_t>(
+            to_blas_index(AB.shape()[1]),
+            to_blas_index(kl),
+            to_blas_index(ku),
+            b_dim,
+            AB.data(),
+            to_blas_index(AB.shape()[0]),
+            piv.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK gtsv.
+     *
+     * Solves A X = B for a tridiagonal matrix with sub-diagonal \em dl,
+     * diagonal \em d and super-diagonal \em du, by Gaussian elimination with
+     * partial pivoting. The three diagonals are overwritten.
+     */
+    template <class E, class F>
+    int gtsv(E& dl, E& d, E& du, F& b)
+    {
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        int info = cxxlapack::gtsv<blas_index_t>(
+            to_blas_index(d.size()),
+            b_dim,
+            dl.data(),
+            d.data(),
+            du.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK ptsv.
+     *
+     * Solves A X = B for a symmetric (Hermitian) positive definite tridiagonal
+     * matrix with real diagonal \em d and sub-diagonal \em e. \em d and \em e
+     * are overwritten by the L D L^H factorization.
+     */
+    template <class D, class E, class F>
+    int ptsv(D& d, E& e, F& b)
+    {
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        int info = cxxlapack::ptsv<blas_index_t>(
+            to_blas_index(d.size()),
+            b_dim,
+            d.data(),
+            e.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    namespace detail
+    {
+        template <class E, class T, class F, class W>
+        inline int call_ormqr(char side, char trans, E& A, T& tau, F& C, W& ws, std::false_type)
+        {
+            blas_index_t m = to_blas_index(C.shape()[0]);
+            blas_index_t n = C.dimension() > 1 ? to_blas_index(C.shape()[1]) : 1;
+            blas_index_t k = to_blas_index(tau.size());
+            blas_index_t ldc = std::max(n > 1 ? stride_back(C) : m, blas_index_t(1));
+            blas_index_t lda = std::max(A.shape()[1] > 1 ? stride_back(A) : to_blas_index(A.shape()[0]),
+                                        blas_index_t(1));
+
+            const auto& sizes = ws.sizes({routine::ormqr, {m, n, k}, {side, trans}}, [&](auto& w) {
+                int info = cxxlapack::ormqr<blas_index_t>(
+                    side, trans, m, n, k, A.data(), lda, tau.data(),
+                    C.data(), ldc, w.work.data(), to_blas_index(-1)
+                );
+
+                if (info != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Could not find workspace size for ormqr.");
+                }
+                return workspace_sizes{workspace_query_result(w.work[0]), 0, 0};
+            });
+
+            if (ws.query_only())
+            {
+                return 0;
+            }
+
+            return cxxlapack::ormqr<blas_index_t>(
+                side, trans, m, n, k, A.data(), lda, tau.data(),
+                C.data(), ldc, ws.work.data(), to_blas_index(sizes.work)
+            );
+        }
+
+        template <class E, class T, class F, class W>
+        inline int call_ormqr(char side, char trans, E& A, T& tau, F& C, W& ws, std::true_type)
+        {
+            blas_index_t m = to_blas_index(C.shape()[0]);
+            blas_index_t n = C.dimension() > 1 ? to_blas_index(C.shape()[1]) : 1;
+            blas_index_t k = to_blas_index(tau.size());
+            blas_index_t ldc = std::max(n > 1 ? stride_back(C) : m, blas_index_t(1));
+            blas_index_t lda = std::max(A.shape()[1] > 1 ? stride_back(A) : to_blas_index(A.shape()[0]),
+                                        blas_index_t(1));
+            trans = trans == 'T' ? 'C' : trans;
+
+            const auto& sizes = ws.sizes({routine::unmqr, {m, n, k}, {side, trans}}, [&](auto& w) {
+                int info = cxxlapack::unmqr<blas_index_t>(
+                    side, trans, m, n, k, A.data(), lda, tau.data(),
+                    C.data(), ldc, w.work.data(), to_blas_index(-1)
+                );
+
+                if (info != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Could not find workspace size for unmqr.");
+                }
+                return workspace_sizes{workspace_query_result(w.work[0]), 0, 0};
+            });
+
+            if (ws.query_only())
+            {
+                return 0;
+            }
+
+            return cxxlapack::unmqr<blas_index_t>(
+                side, trans, m, n, k, A.data(), lda, tau.data(),
+                C.data(), ldc, ws.work.data(), to_blas_index(sizes.work)
+            );
+        }
+    }
+
+    /**
+     * Interface to LAPACK ormqr (unmqr for complex values).
+     *
+     * Overwrites \em C with Q C, Q^H C, C Q or C Q^H where Q is given by the
+     * elementary reflectors returned by geqrf in \em A and \em tau.
+     *
+     * @param side 'L' to apply Q from the left, 'R' from the right
+     * @param trans 'N' to apply Q, 'T' (or 'C') to apply its (conjugate) transpose
+     */
+    template <class E, class T, class F, class Alloc>
+    int ormqr(E& A, T& tau, F& C, char side, char trans, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("ormqr", C.shape()[0], C.shape()[1], tau.size(), layout_type::column_major, side, trans);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(C.dimension() <= 2);
+        XTENSOR_ASSERT(C.layout() == layout_type::column_major);
+
+        return detail::call_ormqr(side, trans, A, tau, C, ws, xtl::is_complex<typename E::value_type>());
+    }
+
+    template <class E, class T, class F>
+    int ormqr(E& A, T& tau, F& C, char side = 'L', char trans = 'T')
+    {
+        return ormqr(A, tau, C, side, trans, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK larfg: generates the elementary reflector
+     * H = I - tau v v^H, with v(0) = 1, such that H^H (alpha, x) = (beta, 0)
+     * with beta real. tau is 0, and H the identity, when x is zero and
+     * alpha real.
+     *
+     * @param alpha First element of the vector, overwritten with beta
+     * @param x 1-D expression of the remaining n - 1 elements, overwritten
+     *          with v(1 : n)
+     * @return tau
+     */
+    template <class E>
+    typename E::value_type larfg(typename E::value_type& alpha, E& x)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("larfg", x.size() + 1, 0, 0, layout_type::column_major, 0, 0);
+        XTENSOR_ASSERT(x.dimension() == 1);
+
+        // the nrm2 and scal calls of larfg need a positive increment
+        auto xv = xt::detail::get_vector_operand(x);
+        blas_index_t inc = x.size() > 1 ? xv.inc : 1;
+        XTENSOR_ASSERT(inc > 0);
+        typename E::value_type tau(0);
+        cxxlapack::larfg<blas_index_t>(to_blas_index(x.size() + 1), alpha, xv.data, inc, tau);
+        return tau;
+    }
+
+    /**
+     * Interface to LAPACK laed4: the i-th root, counted from 0, of the
+     * secular equation 1 + rho sum_j z(j)^2 / (d(j) - lambda) = 0, i.e.
+     * the i-th eigenvalue of diag(d) + rho z z^T.
+     *
+     * @param i Index of the root, in [0, n)
+     * @param d 1-D contiguous expression of n strictly increasing values
+     * @param z 1-D contiguous expression of n values with unit norm
+     * @param delta 1-D contiguous expression of n values, overwritten with
+     *              d(j) - lambda, accurate even when lambda is close to d(j)
+     * @param rho Positive weight of the update
+     * @param dlam Overwritten with the root lambda
+     */
+    template <class D, class Z, class DL>
+    int laed4(std::size_t i, const D& d, const Z& z, DL& delta,
+              typename D::value_type rho, typename D::value_type& dlam)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("laed4", d.size(), 0, 0, layout_type::column_major, 0, 0);
+        XTENSOR_ASSERT(d.dimension() == 1 && z.size() == d.size() && delta.size() == d.size());
+        XTENSOR_ASSERT(i < d.size());
+
+        return cxxlapack::laed4<blas_index_t>(
+            to_blas_index(d.size()),
+            to_blas_index(i + 1),
+            d.data(),
+            z.data(),
+            delta.data(),
+            rho,
+            dlam
+        );
+    }
+
+    /**
+     * Interface to LAPACK larft: forms the triangular factor T of the
+     * compact WY representation I - V T V^H of a block of k elementary
+     * reflectors, H(0) H(1) ... H(k - 1) with T upper triangular when
+     * \em direct is 'F', H(k - 1) ... H(0) with T lower triangular when it
+     * is 'B'.
+     *
+     * @param V Column-major matrix of the reflectors, n x k with one per
+     *          column when \em storev is 'C', k x n with one per row when
+     *          it is 'R'. The unit elements of the reflectors and the
+     *          elements past them are not referenced, so \em V can be the
+     *          result of geqrf or gelqf
+     * @param tau The k scalar factors of the reflectors
+     * @param T Column-major k x k matrix, overwritten with the triangular factor
+     */
+    template <class E, class S, class F>
+    void larft(E& V, S& tau, F& T, char direct = 'F', char storev = 'C')
+    {
+        XTENSOR_ASSERT(V.dimension() == 2);
+        XTENSOR_ASSERT(V.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(T.dimension() == 2);
+        XTENSOR_ASSERT(T.layout() == layout_type::column_major);
+
+        blas_index_t k = to_blas_index(tau.size());
+        blas_index_t n = to_blas_index(storev == 'C' ? V.shape()[0] : V.shape()[1]);
+        XTENSOR_BLAS_INSTRUMENT_CALL("larft", n, k, 0, layout_type::column_major, direct, storev);
+        XTENSOR_ASSERT(T.shape()[0] >= tau.size() && T.shape()[1] >= tau.size());
+
+        blas_index_t ldv = std::max(V.shape()[1] > 1 ? stride_back(V) : to_blas_index(V.shape()[0]),
+                                    blas_index_t(1));
+        blas_index_t ldt = std::max(T.shape()[1] > 1 ? stride_back(T) : to_blas_index(T.shape()[0]),
+                                    blas_index_t(1));
+
+        cxxlapack::larft<blas_index_t>(direct, storev, n, k, V.data(), ldv, tau.data(), T.data(), ldt);
+    }
+
+    /**
+     * Interface to LAPACK larfb: overwrites \em C with H C, H^H C, C H or
+     * C H^H, where H = I - V T V^H is the block reflector formed by larft,
+     * with level 3 BLAS. The k x n (or m x k) work block is taken from
+     * \em ws.
+     *
+     * @param V The reflectors, stored as for larft
+     * @param T The k x k triangular factor returned by larft
+     * @param C Column-major m x n matrix
+     * @param side 'L' to apply H from the left, 'R' from the right
+     * @param trans 'N' to apply H, 'T' (or 'C') to apply its (conjugate) transpose
+     */
+    template <class E, class F, class G, class Alloc>
+    void larfb(E& V, F& T, G& C, char side, char trans, char direct, char storev,
+               workspace<typename G::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("larfb", C.shape()[0], C.shape()[1], T.shape()[0], layout_type::column_major, side, trans);
+        XTENSOR_ASSERT(V.dimension() == 2);
+        XTENSOR_ASSERT(V.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(T.dimension() == 2);
+        XTENSOR_ASSERT(T.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(C.dimension() == 2);
+        XTENSOR_ASSERT(C.layout() == layout_type::column_major);
+
+        blas_index_t m = to_blas_index(C.shape()[0]);
+        blas_index_t n = to_blas_index(C.shape()[1]);
+        blas_index_t k = to_blas_index(T.shape()[0]);
+        blas_index_t ldv = std::max(V.shape()[1] > 1 ? stride_back(V) : to_blas_index(V.shape()[0]),
+                                    blas_index_t(1));
+        blas_index_t ldt = std::max(T.shape()[1] > 1 ? stride_back(T) : k, blas_index_t(1));
+        blas_index_t ldc = std::max(n > 1 ? stride_back(C) : m, blas_index_t(1));
+        blas_index_t ldwork = std::max(side == 'L' ? n : m, blas_index_t(1));
+        if (xtl::is_complex<typename G::value_type>::value && trans == 'T')
+        {
+            trans = 'C';
+        }
+
+        // larfb has no workspace query: work is ldwork x k
+        ws.sizes({routine::larfb, {m, n, k}, {side}}, [&](auto&) {
+            return workspace_sizes{static_cast<std::size_t>(ldwork) * static_cast<std::size_t>(k), 0, 0};
+        });
+
+        if (ws.query_only() || m == 0 || n == 0 || k == 0)
+        {
+            return;
+        }
+
+        cxxlapack::larfb<blas_index_t>(
+            side, trans, direct, storev, m, n, k, V.data(), ldv, T.data(), ldt,
+            C.data(), ldc, ws.work.data(), ldwork
+        );
+    }
+
+    template <class E, class F, class G>
+    void larfb(E& V, F& T, G& C, char side = 'L', char trans = 'N', char direct = 'F', char storev = 'C')
+    {
+        larfb(V, T, C, side, trans, direct, storev, workspace<typename G::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gehrd: reduces a square matrix to upper Hessenberg
+     * form H = Q^H A Q. On exit the upper Hessenberg part of \em A is H, and
+     * the elements below the first subdiagonal, with \em tau of length
+     * n - 1, are the elementary reflectors of Q.
+     */
+    template <class E, class T, class Alloc>
+    int gehrd(E& A, T& tau, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gehrd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, 0, 0,
+                                     instrument::fma_flops<typename E::value_type>(5. / 3. * double(A.shape()[0])
+                                                                                  * double(A.shape()[0]) * double(A.shape()[0])));
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        blas_index_t lda = std::max(n, blas_index_t(1));
+
+        const auto& sizes = ws.sizes({routine::gehrd, {n, 0, 0}, {}}, [&](auto& w) {
+            int info = cxxlapack::gehrd<blas_index_t>(
+                n, blas_index_t(1), n, A.data(), lda, tau.data(), w.work.data(), to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gehrd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::gehrd<blas_index_t>(
+            n, blas_index_t(1), n, A.data(), lda, tau.data(), ws.work.data(),
+            to_blas_index(std::max(sizes.work, std::size_t(1)))
+        );
+    }
+
+    template <class E, class T>
+    int gehrd(E& A, T& tau)
+    {
+        return gehrd(A, tau, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    namespace detail
+    {
+        template <class E, class T, class F, class W>
+        inline int call_ormhr(char side, char trans, E& A, T& tau, F& C, W& ws, std::false_type)
+        {
+            blas_index_t m = to_blas_index(C.shape()[0]);
+            blas_index_t n = C.dimension() > 1 ? to_blas_index(C.shape()[1]) : 1;
+            blas_index_t nq = to_blas_index(A.shape()[0]);
+            blas_index_t ldc = std::max(n > 1 ? stride_back(C) : m, blas_index_t(1));
+            blas_index_t lda = std::max(nq, blas_index_t(1));
+
+            const auto& sizes = ws.sizes({routine::ormhr, {m, n, nq}, {side, trans}}, [&](auto& w) {
+                int info = cxxlapack::ormhr<blas_index_t>(
+                    side, trans, m, n, blas_index_t(1), nq, A.data(), lda, tau.data(),
+                    C.data(), ldc, w.work.data(), to_blas_index(-1)
+                );
+
+                if (info != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Could not find workspace size for ormhr.");
+                }
+                return workspace_sizes{workspace_query_result(w.work[0]), 0, 0};
+            });
+
+            if (ws.query_only())
+            {
+                return 0;
+            }
+
+            return cxxlapack::ormhr<blas_index_t>(
+                side, trans, m, n, blas_index_t(1), nq, A.data(), lda, tau.data(),
+                C.data(), ldc, ws.work.data(), to_blas_index(std::max(sizes.work, std::size_t(1)))
+            );
+        }
+
+        template <class E, class T, class F, class W>
+        inline int call_ormhr(char side, char trans, E& A, T& tau, F& C, W& ws, std::true_type)
+        {
+            blas_index_t m = to_blas_index(C.shape()[0]);
+            blas_index_t n = C.dimension() > 1 ? to_blas_index(C.shape()[1]) : 1;
+            blas_index_t nq = to_blas_index(A.shape()[0]);
+            blas_index_t ldc = std::max(n > 1 ? stride_back(C) : m, blas_index_t(1));
+            blas_index_t lda = std::max(nq, blas_index_t(1));
+            trans = trans == 'T' ? 'C' : trans;
+
+            const auto& sizes = ws.sizes({routine::unmhr, {m, n, nq}, {side, trans}}, [&](auto& w) {
+                int info = cxxlapack::unmhr<blas_index_t>(
+                    side, trans, m, n, blas_index_t(1), nq, A.data(), lda, tau.data(),
+                    C.data(), ldc, w.work.data(), to_blas_index(-1)
+                );
+
+                if (info != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Could not find workspace size for unmhr.");
+                }
+                return workspace_sizes{workspace_query_result(w.work[0]), 0, 0};
+            });
+
+            if (ws.query_only())
+            {
+                return 0;
+            }
+
+            return cxxlapack::unmhr<blas_index_t>(
+                side, trans, m, n, blas_index_t(1), nq, A.data(), lda, tau.data(),
+                C.data(), ldc, ws.work.data(), to_blas_index(std::max(sizes.work, std::size_t(1)))
+            );
+        }
+    }
+
+    /**
+     * Interface to LAPACK ormhr (unmhr for complex values).
+     *
+     * Overwrites \em C with Q C, Q^H C, C Q or C Q^H where Q is given by the
+     * elementary reflectors returned by gehrd in \em A and \em tau.
+     *
+     * @param side 'L' to apply Q from the left, 'R' from the right
+     * @param trans 'N' to apply Q, 'T' (or 'C') to apply its (conjugate) transpose
+     */
+    template <class E, class T, class F, class Alloc>
+    int ormhr(E& A, T& tau, F& C, char side, char trans, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("ormhr", C.shape()[0], C.dimension() > 1 ? C.shape()[1] : 1, A.shape()[0],
+                                     layout_type::column_major, side, trans);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(C.dimension() <= 2);
+        XTENSOR_ASSERT(C.layout() == layout_type::column_major);
+
+        return detail::call_ormhr(side, trans, A, tau, C, ws, xtl::is_complex<typename E::value_type>());
+    }
+
+    template <class E, class T, class F>
+    int ormhr(E& A, T& tau, F& C, char side = 'L', char trans = 'T')
+    {
+        return ormhr(A, tau, C, side, trans, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    namespace detail
+    {
+        template <class E, class D, class T, class W>
+        inline int call_sytrd(char uplo, E& A, D& d, D& e, T& tau, W* work, blas_index_t lwork, std::false_type)
+        {
+            blas_index_t n = to_blas_index(A.shape()[0]);
+            return cxxlapack::sytrd<blas_index_t>(uplo, n, A.data(), std::max(n, blas_index_t(1)), d.data(),
+                                                  e.data(), tau.data(), work, lwork);
+        }
+
+        template <class E, class D, class T, class W>
+        inline int call_sytrd(char uplo, E& A, D& d, D& e, T& tau, W* work, blas_index_t lwork, std::true_type)
+        {
+            blas_index_t n = to_blas_index(A.shape()[0]);
+            return cxxlapack::hetrd<blas_index_t>(uplo, n, A.data(), std::max(n, blas_index_t(1)), d.data(),
+                                                  e.data(), tau.data(), work, lwork);
+        }
+    }
+
+    /**
+     * Interface to LAPACK sytrd (hetrd for complex values): reduces a
+     * symmetric (Hermitian) matrix to real symmetric tridiagonal form
+     * T = Q^H A Q.
+     *
+     * @param uplo triangle of \em A that is read and that holds the
+     *        elementary reflectors of Q on exit
+     * @param d the n diagonal elements of T, real
+     * @param e the n - 1 off-diagonal elements of T, real
+     * @param tau the n - 1 scalar factors of the reflectors
+     */
+    template <class E, class D, class T, class Alloc>
+    int sytrd(E& A, D& d, D& e, T& tau, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        using is_complex = xtl::is_complex<typename E::value_type>;
+        XTENSOR_BLAS_INSTRUMENT_CALL("sytrd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo, 0,
+                                     instrument::fma_flops<typename E::value_type>(2. / 3. * double(A.shape()[0])
+                                                                                  * double(A.shape()[0]) * double(A.shape()[0])));
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        routine r = is_complex::value ? routine::hetrd : routine::sytrd;
+        const auto& sizes = ws.sizes({r, {n, 0, 0}, {uplo}}, [&](auto& w) {
+            int info = detail::call_sytrd(uplo, A, d, e, tau, w.work.data(), to_blas_index(-1), is_complex());
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for sytrd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return detail::call_sytrd(uplo, A, d, e, tau, ws.work.data(),
+                                  to_blas_index(std::max(sizes.work, std::size_t(1))), is_complex());
+    }
+
+    template <class E, class D, class T>
+    int sytrd(E& A, D& d, D& e, T& tau, char uplo = 'L')
+    {
+        return sytrd(A, d, e, tau, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    namespace detail
+    {
+        template <class E, class T, class F, class W>
+        inline int call_ormtr(char side, char uplo, char trans, E& A, T& tau, F& C, W& ws, std::false_type)
+        {
+            blas_index_t m = to_blas_index(C.shape()[0]);
+            blas_index_t n = C.dimension() > 1 ? to_blas_index(C.shape()[1]) : 1;
+            blas_index_t ldc = std::max(n > 1 ? stride_back(C) : m, blas_index_t(1));
+            blas_index_t lda = std::max(to_blas_index(A.shape()[0]), blas_index_t(1));
+
+            const auto& sizes = ws.sizes({routine::ormtr, {m, n, 0}, {side, uplo, trans}}, [&](auto& w) {
+                int info = cxxlapack::ormtr<blas_index_t>(
+                    side, uplo, trans, m, n, A.data(), lda, tau.data(),
+                    C.data(), ldc, w.work.data(), to_blas_index(-1)
+                );
+
+                if (info != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Could not find workspace size for ormtr.");
+                }
+                return workspace_sizes{workspace_query_result(w.work[0]), 0, 0};
+            });
+
+            if (ws.query_only())
+            {
+                return 0;
+            }
+
+            return cxxlapack::ormtr<blas_index_t>(
+                side, uplo, trans, m, n, A.data(), lda, tau.data(),
+                C.data(), ldc, ws.work.data(), to_blas_index(std::max(sizes.work, std::size_t(1)))
+            );
+        }
+
+        template <class E, class T, class F, class W>
+        inline int call_ormtr(char side, char uplo, char trans, E& A, T& tau, F& C, W& ws, std::true_type)
+        {
+            blas_index_t m = to_blas_index(C.shape()[0]);
+            blas_index_t n = C.dimension() > 1 ? to_blas_index(C.shape()[1]) : 1;
+            blas_index_t ldc = std::max(n > 1 ? stride_back(C) : m, blas_index_t(1));
+            blas_index_t lda = std::max(to_blas_index(A.shape()[0]), blas_index_t(1));
+            trans = trans == 'T' ? 'C' : trans;
+
+            const auto& sizes = ws.sizes({routine::unmtr, {m, n, 0}, {side, uplo, trans}}, [&](auto& w) {
+                int info = cxxlapack::unmtr<blas_index_t>(
+                    side, uplo, trans, m, n, A.data(), lda, tau.data(),
+                    C.data(), ldc, w.work.data(), to_blas_index(-1)
+                );
+
+                if (info != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Could not find workspace size for unmtr.");
+                }
+                return workspace_sizes{workspace_query_result(w.work[0]), 0, 0};
+            });
+
+            if (ws.query_only())
+            {
+                return 0;
+            }
+
+            return cxxlapack::unmtr<blas_index_t>(
+                side, uplo, trans, m, n, A.data(), lda, tau.data(),
+                C.data(), ldc, ws.work.data(), to_blas_index(std::max(sizes.work, std::size_t(1)))
+            );
+        }
+    }
+
+    /**
+     * Interface to LAPACK ormtr (unmtr for complex values).
+     *
+     * Overwrites \em C with Q C, Q^H C, C Q or C Q^H where Q is given by the
+     * elementary reflectors returned by sytrd in the \em uplo triangle of
+     * \em A and in \em tau.
+     *
+     * @param side 'L' to apply Q from the left, 'R' from the right
+     * @param uplo the \em uplo argument of sytrd
+     * @param trans 'N' to apply Q, 'T' (or 'C') to apply its (conjugate) transpose
+     */
+    template <class E, class T, class F, class Alloc>
+    int ormtr(E& A, T& tau, F& C, char side, char uplo, char trans, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("ormtr", C.shape()[0], C.dimension() > 1 ? C.shape()[1] : 1, A.shape()[0],
+                                     layout_type::column_major, side, trans);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(C.dimension() <= 2);
+        XTENSOR_ASSERT(C.layout() == layout_type::column_major);
+
+        return detail::call_ormtr(side, uplo, trans, A, tau, C, ws, xtl::is_complex<typename E::value_type>());
+    }
+
+    template <class E, class T, class F>
+    int ormtr(E& A, T& tau, F& C, char side = 'L', char uplo = 'L', char trans = 'T')
+    {
+        return ormtr(A, tau, C, side, uplo, trans, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    namespace detail
+    {
+        template <class W>
+        inline auto con_work(W& ws, std::size_t n, std::size_t work_len, std::size_t aux_len, std::false_type)
+        {
+            ws.reserve(workspace_sizes{work_len * n, 0, aux_len * n});
+            return ws.iwork.data();
+        }
+
+        template <class W>
+        inline auto con_work(W& ws, std::size_t n, std::size_t work_len, std::size_t aux_len, std::true_type)
+        {
+            ws.reserve(workspace_sizes{work_len * n, aux_len * n, 0});
+            return ws.rwork.data();
+        }
+    }
+
+    /**
+     * Interface to LAPACK lange.
+     *
+     * Returns the 1-norm (\em norm = '1'), infinity-norm ('I'), Frobenius
+     * norm ('F') or largest absolute value ('M') of a general matrix in a
+     * single pass. Strided operands of either storage order are read in
+     * place; a matrix stored in row major order is read as its transpose,
+     * with '1' and 'I' exchanged.
+     */
+    template <class E, class Alloc>
+    auto lange(const xexpression<E>& A, char norm, workspace<typename E::value_type, Alloc>& ws)
+    {
+        using value_type = typename E::value_type;
+        const auto& a = A.derived_cast();
+        XTENSOR_ASSERT(a.dimension() == 2);
+
+        xtensor<value_type, 2, layout_type::column_major> a_copy;
+        auto op = xt::detail::get_matrix_operand<layout_type::column_major>(a, a_copy, has_data_interface<E>());
+        std::size_t m = a.shape()[0], n = a.shape()[1];
+        if (op.transposed)
+        {
+            std::swap(m, n);
+            norm = (norm == '1' || norm == 'O' || norm == 'o') ? 'I' : ((norm == 'I' || norm == 'i') ? '1' : norm);
+        }
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("lange", m, n, 0, layout_type::column_major, norm);
+        ws.reserve(workspace_sizes{0, (norm == 'I' || norm == 'i') ? m : 0, 0});
+        return cxxlapack::lange<blas_index_t>(
+            norm,
+            to_blas_index(m),
+            to_blas_index(n),
+            op.data,
+            op.ld,
+            ws.rwork.data()
+        );
+    }
+
+    template <class E>
+    auto lange(const xexpression<E>& A, char norm)
+    {
+        return lange(A, norm, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK lansy.
+     *
+     * Like lange, for a symmetric or hermitian matrix of which only the
+     * triangle \em uplo is read. The norms do not depend on the
+     * conjugation, so complex hermitian matrices are accepted too.
+     */
+    template <class E, class Alloc>
+    auto lansy(const xexpression<E>& A, char norm, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        using value_type = typename E::value_type;
+        const auto& a = A.derived_cast();
+        XTENSOR_ASSERT(a.dimension() == 2);
+        XTENSOR_ASSERT(a.shape()[0] == a.shape()[1]);
+
+        xtensor<value_type, 2, layout_type::column_major> a_copy;
+        auto op = xt::detail::get_matrix_operand<layout_type::column_major>(a, a_copy, has_data_interface<E>());
+        if (op.transposed)
+        {
+            // the triangle uplo of A is the other one of its transpose
+            uplo = (uplo == 'U' || uplo == 'u') ? 'L' : 'U';
+        }
+
+        std::size_t n = a.shape()[0];
+        XTENSOR_BLAS_INSTRUMENT_CALL("lansy", n, n, 0, layout_type::column_major, norm, uplo);
+        bool needs_work = norm == '1' || norm == 'O' || norm == 'o' || norm == 'I' || norm == 'i';
+        ws.reserve(workspace_sizes{0, needs_work ? n : 0, 0});
+        return cxxlapack::lansy<blas_index_t>(
+            norm,
+            uplo,
+            to_blas_index(n),
+            op.data,
+            op.ld,
+            ws.rwork.data()
+        );
+    }
+
+    template <class E>
+    auto lansy(const xexpression<E>& A, char norm, char uplo)
+    {
+        return lansy(A, norm, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gecon.
+     *
+     * Estimates the reciprocal condition number of a general matrix in the
+     * 1-norm (\em norm = '1') or infinity-norm (\em norm = 'I') from its LU
+     * factorization computed by getrf. \em anorm is the norm of the matrix
+     * before the factorization.
+     */
+    template <class E, class R, class Alloc>
+    int gecon(E& A, char norm, R anorm, R& rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gecon", A.shape()[0], A.shape()[1], 0, layout_type::column_major, norm);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        using is_complex = xtl::is_complex<typename E::value_type>;
+        std::size_t n = std::max(A.shape()[0], std::size_t(1));
+        auto aux = detail::con_work(ws, n, is_complex::value ? 2 : 4, is_complex::value ? 2 : 1, is_complex());
+
+        int info = cxxlapack::gecon<blas_index_t>(
+            norm,
+            to_blas_index(A.shape()[0]),
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            anorm,
+            rcond,
+            ws.work.data(),
+            aux
+        );
+
+        return info;
+    }
+
+    template <class E, class R>
+    int gecon(E& A, char norm, R anorm, R& rcond)
+    {
+        return gecon(A, norm, anorm, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK pocon.
+     *
+     * Estimates the reciprocal condition number in the 1-norm of a
+     * symmetric (hermitian) positive definite matrix from its Cholesky
+     * factorization computed by potr.
+     */
+    template <class E, class R, class Alloc>
+    int pocon(E& A, char uplo, R anorm, R& rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("pocon", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        using is_complex = xtl::is_complex<typename E::value_type>;
+        std::size_t n = std::max(A.shape()[0], std::size_t(1));
+        auto aux = detail::con_work(ws, n, is_complex::value ? 2 : 3, 1, is_complex());
+
+        int info = cxxlapack::pocon<blas_index_t>(
+            uplo,
+            to_blas_index(A.shape()[0]),
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            anorm,
+            rcond,
+            ws.work.data(),
+            aux
+        );
+
+        return info;
+    }
+
+    template <class E, class R>
+    int pocon(E& A, char uplo, R anorm, R& rcond)
+    {
+        return pocon(A, uplo, anorm, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gesvx, the expert driver of gesv.
+     *
+     * With \em fact = 'E', scales the rows and columns of \em A when it is
+     * badly scaled (equilibration, reported in \em equed), factors it into
+     * \em AF and \em piv, solves for \em X and refines it iteratively. On
+     * exit \em rcond estimates the reciprocal condition number of the
+     * scaled matrix, and \em ferr and \em berr hold a forward error bound
+     * and the componentwise backward error of each column of \em X.
+     * \em A and \em B are overwritten by their scaled versions when
+     * \em equed is not 'N'.
+     *
+     * @param fact 'E' to equilibrate if needed, 'N' to factor \em A as it
+     *        is, 'F' to reuse \em AF, \em piv, \em equed, \em r and \em c
+     * @param trans 'N' to solve A X = B, 'T' for A^T X = B, 'C' for A^H X = B
+     * @returns info, i in 1..n if U(i, i) is exactly zero, n + 1 if the
+     *          matrix is singular to working precision; \em X is computed
+     *          in the latter case
+     */
+    template <class E, class P, class F, class G, class S, class R, class Alloc>
+    int gesvx(E& A, E& AF, P& piv, F& B, G& X, char& equed, S& r, S& c, R& rcond, S& ferr, S& berr,
+              char fact, char trans, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gesvx", A.shape()[0], B.dimension() > 1 ? B.shape()[1] : 1, 0,
+                                     layout_type::column_major, fact, trans);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(X.layout() == layout_type::column_major);
+
+        using is_complex = xtl::is_complex<typename E::value_type>;
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        blas_index_t nrhs = B.dimension() > 1 ? to_blas_index(B.shape()[1]) : 1;
+        blas_index_t lda = std::max(n, blas_index_t(1));
+        blas_index_t ldb = std::max(nrhs > 1 ? stride_back(B) : n, blas_index_t(1));
+        blas_index_t ldx = std::max(nrhs > 1 ? stride_back(X) : n, blas_index_t(1));
+        auto aux = detail::con_work(ws, std::max(A.shape()[0], std::size_t(1)), is_complex::value ? 2 : 4,
+                                    is_complex::value ? 2 : 1, is_complex());
+
+        return cxxlapack::gesvx<blas_index_t>(
+            fact, trans, n, nrhs, A.data(), lda, AF.data(), lda, piv.data(), equed, r.data(), c.data(),
+            B.data(), ldb, X.data(), ldx, rcond, ferr.data(), berr.data(), ws.work.data(), aux
+        );
+    }
+
+    template <class E, class P, class F, class G, class S, class R>
+    int gesvx(E& A, E& AF, P& piv, F& B, G& X, char& equed, S& r, S& c, R& rcond, S& ferr, S& berr,
+              char fact = 'E', char trans = 'N')
+    {
+        return gesvx(A, AF, piv, B, X, equed, r, c, rcond, ferr, berr, fact, trans,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK posvx, the expert driver of posv for symmetric
+     * (Hermitian) positive definite matrices. The arguments are those of
+     * gesvx, with the single scaling \em s of the rows and columns and
+     * the Cholesky factor in \em AF.
+     *
+     * @returns info, i in 1..n if the leading minor of order i is not
+     *          positive definite, n + 1 if the matrix is singular to working
+     *          precision; \em X is computed in the latter case
+     */
+    template <class E, class F, class G, class S, class R, class Alloc>
+    int posvx(E& A, E& AF, F& B, G& X, char& equed, S& s, R& rcond, S& ferr, S& berr,
+              char fact, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("posvx", A.shape()[0], B.dimension() > 1 ? B.shape()[1] : 1, 0,
+                                     layout_type::column_major, fact, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(X.layout() == layout_type::column_major);
+
+        using is_complex = xtl::is_complex<typename E::value_type>;
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        blas_index_t nrhs = B.dimension() > 1 ? to_blas_index(B.shape()[1]) : 1;
+        blas_index_t lda = std::max(n, blas_index_t(1));
+        blas_index_t ldb = std::max(nrhs > 1 ? stride_back(B) : n, blas_index_t(1));
+        blas_index_t ldx = std::max(nrhs > 1 ? stride_back(X) : n, blas_index_t(1));
+        auto aux = detail::con_work(ws, std::max(A.shape()[0], std::size_t(1)), is_complex::value ? 2 : 3, 1,
+                                    is_complex());
+
+        return cxxlapack::posvx<blas_index_t>(
+            fact, uplo, n, nrhs, A.data(), lda, AF.data(), lda, equed, s.data(),
+            B.data(), ldb, X.data(), ldx, rcond, ferr.data(), berr.data(), ws.work.data(), aux
+        );
+    }
+
+    template <class E, class F, class G, class S, class R>
+    int posvx(E& A, E& AF, F& B, G& X, char& equed, S& s, R& rcond, S& ferr, S& berr,
+              char fact = 'E', char uplo = 'L')
+    {
+        return posvx(A, AF, B, X, equed, s, rcond, ferr, berr, fact, uplo,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK trcon.
+     *
+     * Estimates the reciprocal condition number of a triangular matrix in
+     * the 1-norm (\em norm = '1') or infinity-norm (\em norm = 'I').
+     */
+    template <class E, class R, class Alloc>
+    int trcon(E& A, char norm, char uplo, char diag, R& rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("trcon", A.shape()[0], A.shape()[1], 0, layout_type::column_major, norm, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        using is_complex = xtl::is_complex<typename E::value_type>;
+        std::size_t n = std::max(A.shape()[0], std::size_t(1));
+        auto aux = detail::con_work(ws, n, is_complex::value ? 2 : 3, 1, is_complex());
+
+        int info = cxxlapack::trcon<blas_index_t>(
+            norm,
+            uplo,
+            diag,
+            to_blas_index(A.shape()[0]),
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            rcond,
+            ws.work.data(),
+            aux
+        );
+
+        return info;
+    }
+
+    template <class E, class R>
+    int trcon(E& A, char norm, char uplo, char diag, R& rcond)
+    {
+        return trcon(A, norm, uplo, diag, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gbcon.
+     *
+     * Estimates the reciprocal condition number of a band matrix in the
+     * 1-norm (\em norm = '1') or infinity-norm (\em norm = 'I') from its
+     * factorization computed by gbtrf. \em anorm is the norm of the matrix
+     * before the factorization.
+     */
+    template <class E, class P, class R, class Alloc>
+    int gbcon(const E& AB, std::size_t kl, std::size_t ku, const P& piv, char norm, R anorm, R& rcond,
+              workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_ASSERT(AB.dimension() == 2);
+        XTENSOR_ASSERT(AB.layout() == layout_type::column_major);
+
+        using is_complex = xtl::is_complex<typename E::value_type>;
+        std::size_t n = std::max(AB.shape()[1], std::size_t(1));
+        auto aux = detail::con_work(ws, n, is_complex::value ? 2 : 3, 1, is_complex());
+
+        int info = cxxlapack::gbcon<blas_index_t>(
+            norm,
+            to_blas_index(AB.shape()[1]),
+            to_blas_index(kl),
+            to_blas_index(ku),
+            AB.data(),
+            to_blas_index(AB.shape()[0]),
+            piv.data(),
+            anorm,
+            rcond,
+            ws.work.data(),
+            aux
+        );
+
+        return info;
+    }
+
+    template <class E, class P, class R>
+    int gbcon(const E& AB, std::size_t kl, std::size_t ku, const P& piv, char norm, R anorm, R& rcond)
+    {
+        return gbcon(AB, kl, ku, piv, norm, anorm, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK getri.
+     *
+     * @param A matrix to invert
+     * @return inverse of A
+     */
+    template <class E, class Alloc>
+    int getri(E& A, uvector<blas_index_t>& piv, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("getri", A.shape()[0], A.shape()[1], 0, layout_type::column_major);
+
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+
+        const auto& sizes = ws.sizes({routine::getri, {n, 0, 0}, {}}, [&](auto& w) {
+            // get work size
+            int info = cxxlapack::getri<blas_index_t>(
+                n,
+                A.data(),
+                stride_back(A),
+                piv.data(),
+                w.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info > 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for getri.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::getri<blas_index_t>(
+            n,
+            A.data(),
+            stride_back(A),
+            piv.data(),
+            ws.work.data(),
+            to_blas_index(sizes.work)
+        );
+
+        return info;
+    }
+
+    template <class E>
+    int getri(E& A, uvector<blas_index_t>& piv)
+    {
+        return getri(A, piv, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK posv: solves A x = b for positive definite A with
+     * the Cholesky factorization of its \em uplo triangle.
+     * @returns info
+     */
+    template <class E, class F>
+    int posv(E& A, F& b, char uplo = 'L')
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("posv", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        int info = cxxlapack::posv<blas_index_t>(
+            uplo,
+            to_blas_index(A.shape()[0]),
+            b_dim,
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            b.data(),
+            std::max(b_stride, blas_index_t(1))
+        );
+
+        return info;
+    }
+
+    /**
+     * Interface to LAPACK sysv: solves A x = b for symmetric A with the
+     * Bunch-Kaufman factorization of its \em uplo triangle.
+     * @returns info
+     */
+    template <class E, class P, class F, class Alloc>
+    int sysv(E& A, P& piv, F& b, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("sysv", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        const auto& sizes = ws.sizes({routine::sysv, {n, 0, 0}, {uplo}}, [&](auto& c) {
+            int info = cxxlapack::sysv<blas_index_t>(
+                uplo,
+                n,
+                b_dim,
+                A.data(),
+                std::max(stride_back(A), blas_index_t(1)),
+                piv.data(),
+                b.data(),
+                std::max(b_stride, blas_index_t(1)),
+                c.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for sysv.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::sysv<blas_index_t>(
+            uplo,
+            n,
+            b_dim,
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            piv.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1)),
+            ws.work.data(),
+            to_blas_index(sizes.work)
+        );
+
+        return info;
+    }
+
+    template <class E, class P, class F>
+    int sysv(E& A, P& piv, F& b, char uplo = 'L')
+    {
+        return sysv(A, piv, b, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK hesv: solves A x = b for Hermitian A with the
+     * Bunch-Kaufman factorization of its \em uplo triangle.
+     * @returns info
+     */
+    template <class E, class P, class F, class Alloc>
+    int hesv(E& A, P& piv, F& b, char uplo, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("hesv", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(b.dimension() <= 2);
+        XTENSOR_ASSERT(b.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        const auto& sizes = ws.sizes({routine::hesv, {n, 0, 0}, {uplo}}, [&](auto& c) {
+            int info = cxxlapack::hesv<blas_index_t>(
+                uplo,
+                n,
+                b_dim,
+                A.data(),
+                std::max(stride_back(A), blas_index_t(1)),
+                piv.data(),
+                b.data(),
+                std::max(b_stride, blas_index_t(1)),
+                c.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for hesv.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::hesv<blas_index_t>(
+            uplo,
+            n,
+            b_dim,
+            A.data(),
+            std::max(stride_back(A), blas_index_t(1)),
+            piv.data(),
+            b.data(),
+            std::max(b_stride, blas_index_t(1)),
+            ws.work.data(),
+            to_blas_index(sizes.work)
+        );
+
+        return info;
+    }
+
+    template <class E, class P, class F>
+    int hesv(E& A, P& piv, F& b, char uplo = 'L')
+    {
+        return hesv(A, piv, b, uplo, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK geev.
+     * @returns info
+     */
+    template <class E, class W, class V, class Alloc>
+    int geev(E& A, char jobvl, char jobvr, W& wr, W& wi, V& VL, V& VR, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("geev", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvl, jobvr);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        const auto N = A.shape()[0];
+
+        const auto& sizes = ws.sizes({routine::geev, {to_blas_index(N), 0, 0}, {jobvl, jobvr}}, [&](auto& w) {
+            int info = cxxlapack::geev<blas_index_t>(
+                jobvl,
+                jobvr,
+                to_blas_index(N),
+                A.data(),
+                stride_back(A),
+                wr.data(),
+                wi.data(),
+                VL.data(),
+                stride_back(VL),
+                VR.data(),
+                stride_back(VR),
+                w.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geev.");
+            }
+            return workspace_sizes{detail::workspace_query_result(w.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::geev<blas_index_t>(
+            jobvl,
+            jobvr,
+            to_blas_index(N),
+            A.data(),
+            stride_back(A),
+            wr.data(),
+            wi.data(),
+            VL.data(),
+            stride_back(VL),
+            VR.data(),
+            stride_back(VR),
+            ws.work.data(),
+            to_blas_index(sizes.work)
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V>
+    int geev(E& A, char jobvl, char jobvr, W& wr, W& wi, V& VL, V& VR)
+    {
+        return geev(A, jobvl, jobvr, wr, wi, VL, VR, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gees for real matrices.
+     *
+     * Overwrites \em A with its real Schur form T and, with \em jobvs 'V',
+     * stores the Schur vectors in \em VS. With \em sort 'S', the eigenvalues
+     * for which \em select returns nonzero are moved to the leading block,
+     * whose size is returned in \em sdim. \em VS must always have a leading
+     * dimension of at least 1.
+     * @returns info
+     */
+    template <class E, class W, class V, class S, class Alloc>
+    int gees(E& A, char jobvs, char sort, S select, blas_index_t& sdim, W& wr, W& wi, V& VS,
+             workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gees", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvs, sort);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+
+        const auto& sizes = ws.sizes({routine::gees, {n, 0, 0}, {jobvs, sort}}, [&](auto& c) {
+            int info = cxxlapack::gees<blas_index_t>(
+                jobvs, sort, select, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                sdim, wr.data(), wi.data(),
+                VS.data(), std::max(stride_back(VS), blas_index_t(1)),
+                c.work.data(), to_blas_index(-1),
+                c.iwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gees.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                   std::max(static_cast<std::size_t>(n), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::gees<blas_index_t>(
+            jobvs, sort, select, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            sdim, wr.data(), wi.data(),
+            VS.data(), std::max(stride_back(VS), blas_index_t(1)),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V, class S>
+    int gees(E& A, char jobvs, char sort, S select, blas_index_t& sdim, W& wr, W& wi, V& VS)
+    {
+        return gees(A, jobvs, sort, select, sdim, wr, wi, VS, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gees for complex matrices, which overwrites \em A
+     * with its upper triangular Schur form.
+     * @returns info
+     */
+    template <class E, class W, class V, class S, class Alloc>
+    int gees(E& A, char jobvs, char sort, S select, blas_index_t& sdim, W& w, V& VS,
+             workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gees", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvs, sort);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+
+        const auto& sizes = ws.sizes({routine::gees, {n, 0, 0}, {jobvs, sort}}, [&](auto& c) {
+            int info = cxxlapack::gees<blas_index_t>(
+                jobvs, sort, select, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                sdim, w.data(),
+                VS.data(), std::max(stride_back(VS), blas_index_t(1)),
+                c.work.data(), to_blas_index(-1),
+                c.rwork.data(), c.iwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gees.");
+            }
+            std::size_t len = std::max(static_cast<std::size_t>(n), std::size_t(1));
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), len, len};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::gees<blas_index_t>(
+            jobvs, sort, select, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            sdim, w.data(),
+            VS.data(), std::max(stride_back(VS), blas_index_t(1)),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.rwork.data(), ws.iwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V, class S>
+    int gees(E& A, char jobvs, char sort, S select, blas_index_t& sdim, W& w, V& VS)
+    {
+        return gees(A, jobvs, sort, select, sdim, w, VS, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gges for real matrices.
+     *
+     * Overwrites \em A and \em B with their generalized real Schur form
+     * (S, T) = (Q^T A Z, Q^T B Z) and, with \em jobvsl / \em jobvsr 'V',
+     * stores Q and Z in \em VSL and \em VSR. With \em sort 'S', the
+     * eigenvalues (alphar + i alphai) / beta for which \em select returns
+     * nonzero are moved to the leading block, whose size is returned in
+     * \em sdim. \em VSL and \em VSR must always have a leading dimension of
+     * at least 1.
+     * @returns info
+     */
+    template <class E, class W, class V, class S, class Alloc>
+    int gges(E& A, E& B, char jobvsl, char jobvsr, char sort, S select, blas_index_t& sdim,
+             W& alphar, W& alphai, W& beta, V& VSL, V& VSR, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gges", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvsl, sort);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+
+        const auto& sizes = ws.sizes({routine::gges, {n, 0, 0}, {jobvsl, jobvsr, sort}}, [&](auto& c) {
+            int info = cxxlapack::gges<blas_index_t>(
+                jobvsl, jobvsr, sort, select, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                B.data(), std::max(stride_back(B), blas_index_t(1)),
+                sdim, alphar.data(), alphai.data(), beta.data(),
+                VSL.data(), std::max(stride_back(VSL), blas_index_t(1)),
+                VSR.data(), std::max(stride_back(VSR), blas_index_t(1)),
+                c.work.data(), to_blas_index(-1),
+                c.iwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gges.");
+            }
+            // iwork holds the logical bwork array
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                   std::max(static_cast<std::size_t>(n), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::gges<blas_index_t>(
+            jobvsl, jobvsr, sort, select, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1)),
+            sdim, alphar.data(), alphai.data(), beta.data(),
+            VSL.data(), std::max(stride_back(VSL), blas_index_t(1)),
+            VSR.data(), std::max(stride_back(VSR), blas_index_t(1)),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V, class S>
+    int gges(E& A, E& B, char jobvsl, char jobvsr, char sort, S select, blas_index_t& sdim,
+             W& alphar, W& alphai, W& beta, V& VSL, V& VSR)
+    {
+        return gges(A, B, jobvsl, jobvsr, sort, select, sdim, alphar, alphai, beta, VSL, VSR,
+                    workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gges for complex matrices, which overwrites \em A
+     * and \em B with their upper triangular generalized Schur form; the
+     * eigenvalues are alpha / beta.
+     * @returns info
+     */
+    template <class E, class W, class V, class S, class Alloc>
+    int gges(E& A, E& B, char jobvsl, char jobvsr, char sort, S select, blas_index_t& sdim,
+             W& alpha, W& beta, V& VSL, V& VSR, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gges", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvsl, sort);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        std::size_t len = std::max(static_cast<std::size_t>(n), std::size_t(1));
+
+        const auto& sizes = ws.sizes({routine::gges, {n, 0, 0}, {jobvsl, jobvsr, sort}}, [&](auto& c) {
+            int info = cxxlapack::gges<blas_index_t>(
+                jobvsl, jobvsr, sort, select, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                B.data(), std::max(stride_back(B), blas_index_t(1)),
+                sdim, alpha.data(), beta.data(),
+                VSL.data(), std::max(stride_back(VSL), blas_index_t(1)),
+                VSR.data(), std::max(stride_back(VSR), blas_index_t(1)),
+                c.work.data(), to_blas_index(-1),
+                c.rwork.data(), c.iwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gges.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 8 * len, len};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::gges<blas_index_t>(
+            jobvsl, jobvsr, sort, select, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1)),
+            sdim, alpha.data(), beta.data(),
+            VSL.data(), std::max(stride_back(VSL), blas_index_t(1)),
+            VSR.data(), std::max(stride_back(VSR), blas_index_t(1)),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.rwork.data(), ws.iwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V, class S>
+    int gges(E& A, E& B, char jobvsl, char jobvsr, char sort, S select, blas_index_t& sdim,
+             W& alpha, W& beta, V& VSL, V& VSR)
+    {
+        return gges(A, B, jobvsl, jobvsr, sort, select, sdim, alpha, beta, VSL, VSR,
+                    workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    namespace detail
+    {
+        // the work arrays of trsen and tgsen grow with m (n - m) for m
+        // selected eigenvalues, at most n^2 / 4: they are sized for that
+        // bound, so that the cached sizes hold for every selection
+        inline std::size_t reorder_block(blas_index_t n)
+        {
+            std::size_t un = static_cast<std::size_t>(std::max(n, blas_index_t(0)));
+            return un * un / 4 + 1;
+        }
+
+        inline workspace_sizes trsen_sizes(char job, blas_index_t n, bool complex)
+        {
+            std::size_t q = reorder_block(n);
+            std::size_t un = std::max(static_cast<std::size_t>(std::max(n, blas_index_t(0))), std::size_t(1));
+            std::size_t work = job == 'N' ? (complex ? 1 : un) : (job == 'E' ? q : 2 * q);
+            std::size_t iwork = complex || job == 'N' || job == 'E' ? 1 : q;
+            return workspace_sizes{work, 0, iwork};
+        }
+
+        inline workspace_sizes tgsen_sizes(blas_index_t ijob, blas_index_t n, bool complex)
+        {
+            std::size_t q = reorder_block(n);
+            std::size_t un = static_cast<std::size_t>(std::max(n, blas_index_t(0)));
+            std::size_t base = complex ? 1 : 4 * un + 16;
+            std::size_t extra = ijob == 0 ? 0 : (ijob == 3 || ijob == 5 ? 4 * q : 2 * q);
+            std::size_t iwork = ijob == 0 ? 1 : (ijob == 3 || ijob == 5 ? std::max(2 * q, un + 6) : un + 6);
+            return workspace_sizes{std::max(base, extra), 0, iwork};
+        }
+    }
+
+    /**
+     * Interface to LAPACK trsen for real matrices.
+     *
+     * Reorders the real Schur form \em T computed by gees so that the
+     * eigenvalues flagged nonzero in \em select, one flag per diagonal
+     * position, form its leading block, whose size is returned in \em m;
+     * a complex conjugate pair moves if either of its flags is set. With
+     * \em compq 'V' the Schur vectors \em Q are updated. \em job 'N'
+     * computes no condition number, 'E' the reciprocal condition number
+     * \em s of the selected cluster of eigenvalues, 'V' the separation
+     * \em sep of the invariant subspace and 'B' both. The eigenvalues are
+     * returned in their new order in \em wr and \em wi.
+     * @returns info
+     */
+    template <class E, class Q, class L, class W, class Alloc>
+    int trsen(char job, char compq, const L& select, E& T, Q& q, W& wr, W& wi, blas_index_t& m,
+              typename E::value_type& s, typename E::value_type& sep, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("trsen", T.shape()[0], T.shape()[1], 0, layout_type::column_major, job, compq);
+        XTENSOR_ASSERT(T.dimension() == 2);
+        XTENSOR_ASSERT(T.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(q.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(select.size() == T.shape()[0]);
+
+        blas_index_t n = to_blas_index(T.shape()[0]);
+        const auto& sizes = ws.sizes({routine::trsen, {n, 0, 0}, {job}}, [&](auto&) {
+            return detail::trsen_sizes(job, n, false);
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::trsen<blas_index_t>(
+            job, compq, select.data(), n,
+            T.data(), std::max(stride_back(T), blas_index_t(1)),
+            q.data(), std::max(compq == 'V' ? stride_back(q) : n, blas_index_t(1)),
+            wr.data(), wi.data(), m, s, sep,
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data(), to_blas_index(sizes.iwork)
+        );
+    }
+
+    template <class E, class Q, class L, class W>
+    int trsen(char job, char compq, const L& select, E& T, Q& q, W& wr, W& wi, blas_index_t& m,
+              typename E::value_type& s, typename E::value_type& sep)
+    {
+        return trsen(job, compq, select, T, q, wr, wi, m, s, sep,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK trsen for complex matrices, which reorders the
+     * upper triangular Schur form \em T and returns the eigenvalues in
+     * their new order in \em w.
+     * @returns info
+     */
+    template <class E, class Q, class L, class W, class Alloc>
+    int trsen(char job, char compq, const L& select, E& T, Q& q, W& w, blas_index_t& m,
+              xtl::complex_value_type_t<typename E::value_type>& s,
+              xtl::complex_value_type_t<typename E::value_type>& sep,
+              workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("trsen", T.shape()[0], T.shape()[1], 0, layout_type::column_major, job, compq);
+        XTENSOR_ASSERT(T.dimension() == 2);
+        XTENSOR_ASSERT(T.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(q.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(select.size() == T.shape()[0]);
+
+        blas_index_t n = to_blas_index(T.shape()[0]);
+        const auto& sizes = ws.sizes({routine::trsen, {n, 0, 0}, {job}}, [&](auto&) {
+            return detail::trsen_sizes(job, n, true);
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::trsen<blas_index_t>(
+            job, compq, select.data(), n,
+            T.data(), std::max(stride_back(T), blas_index_t(1)),
+            q.data(), std::max(compq == 'V' ? stride_back(q) : n, blas_index_t(1)),
+            w.data(), m, s, sep,
+            ws.work.data(), to_blas_index(sizes.work)
+        );
+    }
+
+    template <class E, class Q, class L, class W>
+    int trsen(char job, char compq, const L& select, E& T, Q& q, W& w, blas_index_t& m,
+              xtl::complex_value_type_t<typename E::value_type>& s,
+              xtl::complex_value_type_t<typename E::value_type>& sep)
+    {
+        return trsen(job, compq, select, T, q, w, m, s, sep,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK tgsen for real matrices.
+     *
+     * Reorders the generalized real Schur form (\em A, \em B) computed by
+     * gges so that the eigenvalues flagged nonzero in \em select form its
+     * leading blocks, of size \em m, and with \em wantq / \em wantz updates
+     * \em Q and \em Z. \em ijob 0 computes no condition estimate; 1 to 5
+     * compute the projection norms \em pl, \em pr and the separation
+     * estimates \em dif (2 elements) as described by LAPACK.
+     * @returns info
+     */
+    template <class E, class L, class W, class D, class Alloc>
+    int tgsen(blas_index_t ijob, bool wantq, bool wantz, const L& select, E& A, E& B,
+              W& alphar, W& alphai, W& beta, E& Q, E& Z, blas_index_t& m,
+              typename E::value_type& pl, typename E::value_type& pr, D& dif,
+              workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("tgsen", A.shape()[0], A.shape()[1], 0, layout_type::column_major, 0, 0);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(select.size() == A.shape()[0]);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        const auto& sizes = ws.sizes({routine::tgsen, {n, ijob, 0}, {}}, [&](auto&) {
+            return detail::tgsen_sizes(ijob, n, false);
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::tgsen<blas_index_t>(
+            ijob, wantq, wantz, select.data(), n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1)),
+            alphar.data(), alphai.data(), beta.data(),
+            Q.data(), std::max(wantq ? stride_back(Q) : n, blas_index_t(1)),
+            Z.data(), std::max(wantz ? stride_back(Z) : n, blas_index_t(1)),
+            m, pl, pr, dif.data(),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data(), to_blas_index(sizes.iwork)
+        );
+    }
+
+    template <class E, class L, class W, class D>
+    int tgsen(blas_index_t ijob, bool wantq, bool wantz, const L& select, E& A, E& B,
+              W& alphar, W& alphai, W& beta, E& Q, E& Z, blas_index_t& m,
+              typename E::value_type& pl, typename E::value_type& pr, D& dif)
+    {
+        return tgsen(ijob, wantq, wantz, select, A, B, alphar, alphai, beta, Q, Z, m, pl, pr, dif,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK tgsen for complex matrices, which reorders the
+     * upper triangular generalized Schur form; the eigenvalues are
+     * alpha / beta.
+     * @returns info
+     */
+    template <class E, class L, class W, class D, class Alloc>
+    int tgsen(blas_index_t ijob, bool wantq, bool wantz, const L& select, E& A, E& B,
+              W& alpha, W& beta, E& Q, E& Z, blas_index_t& m,
+              xtl::complex_value_type_t<typename E::value_type>& pl,
+              xtl::complex_value_type_t<typename E::value_type>& pr, D& dif,
+              workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("tgsen", A.shape()[0], A.shape()[1], 0, layout_type::column_major, 0, 0);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(select.size() == A.shape()[0]);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        const auto& sizes = ws.sizes({routine::tgsen, {n, ijob, 0}, {}}, [&](auto&) {
+            return detail::tgsen_sizes(ijob, n, true);
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::tgsen<blas_index_t>(
+            ijob, wantq, wantz, select.data(), n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1)),
+            alpha.data(), beta.data(),
+            Q.data(), std::max(wantq ? stride_back(Q) : n, blas_index_t(1)),
+            Z.data(), std::max(wantz ? stride_back(Z) : n, blas_index_t(1)),
+            m, pl, pr, dif.data(),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data(), to_blas_index(sizes.iwork)
+        );
+    }
+
+    template <class E, class L, class W, class D>
+    int tgsen(blas_index_t ijob, bool wantq, bool wantz, const L& select, E& A, E& B,
+              W& alpha, W& beta, E& Q, E& Z, blas_index_t& m,
+              xtl::complex_value_type_t<typename E::value_type>& pl,
+              xtl::complex_value_type_t<typename E::value_type>& pr, D& dif)
+    {
+        return tgsen(ijob, wantq, wantz, select, A, B, alpha, beta, Q, Z, m, pl, pr, dif,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK syev, the eigensolver with the smallest workspace,
+     * used by syevd under the memory budget.
+     * @returns info
+     */
+    template <class E, class W, class Alloc>
+    int syev(E& A, char jobz, char uplo, W& w, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("syev", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        auto N = A.shape()[0];
+
+        const auto& sizes = ws.sizes({routine::syev, {to_blas_index(N), 0, 0}, {jobz, uplo}}, [&](auto& c) {
+            int info = cxxlapack::syev<blas_index_t>(
+                jobz,
+                uplo,
+                to_blas_index(N),
+                A.data(),
+                stride_back(A),
+                w.data(),
+                c.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for syev.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::syev<blas_index_t>(
+            jobz,
+            uplo,
+            to_blas_index(N),
+            A.data(),
+            stride_back(A),
+            w.data(),
+            ws.work.data(),
+            to_blas_index(sizes.work)
+        );
+    }
+
+    template <class E, class W>
+    int syev(E& A, char jobz, char uplo, W& w)
+    {
+        return syev(A, jobz, uplo, w, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK syevd.
+     * @returns info
+     */
+    template <class E, class W, class Alloc>
+    int syevd(E& A, char jobz, char uplo, W& w, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("syevd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        auto N = A.shape()[0];
+
+#if defined(XTENSOR_USE_CUDA)
+        int cuda_info = 0;
+        if (!ws.query_only() && cuda::detail::eigh(jobz, uplo, N, A.data(), stride_back(A), w.data(), cuda_info))
+        {
+            return cuda_info;
+        }
+#endif
+
+        detail::workspace_key key = {routine::syevd, {to_blas_index(N), 0, 0}, {jobz, uplo}};
+        auto query = [&](auto& c) {
+            int info = cxxlapack::syevd<blas_index_t>(
+                jobz,
+                uplo,
+                to_blas_index(N),
+                A.data(),
+                stride_back(A),
+                w.data(),
+                c.work.data(),
+                to_blas_index(-1),
+                c.iwork.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for syevd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                           std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        };
+
+        if (detail::use_fallback<typename E::value_type>(ws, key, query))
+        {
+            // syev works in place with a workspace of 3 n
+            int res = syev(A, jobz, uplo, w, ws);
+            detail::last_driver_value() = routine::syev;
+            return res;
+        }
+
+        const auto& sizes = ws.sizes(key, query);
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::syevd<blas_index_t>(
+            jobz,
+            uplo,
+            to_blas_index(N),
+            A.data(),
+            stride_back(A),
+            w.data(),
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.iwork.data(),
+            to_blas_index(sizes.iwork)
+        );
+
+        return info;
+    }
+
+    template <class E, class W>
+    int syevd(E& A, char jobz, char uplo, W& w)
+    {
+        return syevd(A, jobz, uplo, w, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK sygvd.
+     * @returns info
+     */
+    template <class E, class W, class Alloc>
+    int sygvd(E& A, E& B, blas_index_t itype, char jobz, char uplo, W& w, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("sygvd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.dimension() == 2);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+
+        auto N = A.shape()[0];
+        XTENSOR_ASSERT(B.shape()[0] ==N);
+
+        const auto& sizes = ws.sizes({routine::sygvd, {to_blas_index(N), itype, 0}, {jobz, uplo}}, [&](auto& c) {
+            int info = cxxlapack::sygvd<blas_index_t>(
+                itype,
+                jobz,
+                uplo,
+                to_blas_index(N),
+                A.data(),
+                stride_back(A),
+                B.data(),
+                stride_back(B),
+                w.data(),
+                c.work.data(),
+                to_blas_index(-1),
+                c.iwork.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for sygvd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                           std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::sygvd<blas_index_t>(
+            itype,
+            jobz,
+            uplo,
+            to_blas_index(N),
+            A.data(),
+            stride_back(A),
+            B.data(),
+            stride_back(B),
+            w.data(),
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.iwork.data(),
+            to_blas_index(sizes.iwork)
+        );
+
+        return info;
+    }
+
+    template <class E, class W>
+    int sygvd(E& A, E& B, blas_index_t itype, char jobz, char uplo, W& w)
+    {
+        return sygvd(A, B, itype, jobz, uplo, w, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK hegvd, the Hermitian counterpart of sygvd.
+     * @returns info
+     */
+    template <class E, class W, class Alloc>
+    int hegvd(E& A, E& B, blas_index_t itype, char jobz, char uplo, W& w, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("hegvd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.dimension() == 2);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        XTENSOR_ASSERT(B.shape()[0] == A.shape()[0]);
+
+        const auto& sizes = ws.sizes({routine::hegvd, {n, itype, 0}, {jobz, uplo}}, [&](auto& c) {
+            int info = cxxlapack::hegvd<blas_index_t>(
+                itype, jobz, uplo, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                B.data(), std::max(stride_back(B), blas_index_t(1)),
+                w.data(),
+                c.work.data(), to_blas_index(-1),
+                c.rwork.data(), to_blas_index(-1),
+                c.iwork.data(), to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for hegvd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]),
+                                   std::max(std::size_t(c.rwork[0]), std::size_t(1)),
+                                   std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::hegvd<blas_index_t>(
+            itype, jobz, uplo, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1)),
+            w.data(),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.rwork.data(), to_blas_index(sizes.rwork),
+            ws.iwork.data(), to_blas_index(sizes.iwork)
+        );
+
+        return info;
+    }
+
+    template <class E, class W>
+    int hegvd(E& A, E& B, blas_index_t itype, char jobz, char uplo, W& w)
+    {
+        return hegvd(A, B, itype, jobz, uplo, w, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK sygst.
+     *
+     * Reduces the symmetric-definite problem of \em A and the Cholesky
+     * factor of B stored in the \em uplo triangle of \em B (potrf) to
+     * standard form: with \em itype 1, A is overwritten with
+     * inv(L) A inv(L)^T, or inv(U)^T A inv(U) with \em uplo 'U'.
+     * @returns info
+     */
+    template <class E, class F>
+    int sygst(E& A, const F& B, blas_index_t itype = 1, char uplo = 'L')
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("sygst", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.dimension() == 2);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+
+        return cxxlapack::sygst<blas_index_t>(
+            itype, uplo, to_blas_index(A.shape()[0]),
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1))
+        );
+    }
+
+    /**
+     * Interface to LAPACK hegst, the Hermitian counterpart of sygst.
+     * @returns info
+     */
+    template <class E, class F>
+    int hegst(E& A, const F& B, blas_index_t itype = 1, char uplo = 'L')
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("hegst", A.shape()[0], A.shape()[1], 0, layout_type::column_major, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.dimension() == 2);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+
+        return cxxlapack::hegst<blas_index_t>(
+            itype, uplo, to_blas_index(A.shape()[0]),
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1))
+        );
+    }
+
+    /**
+     * Interface to LAPACK sygvx.
+     *
+     * Selected eigenvalues, and with \em jobz 'V' eigenvectors, of the
+     * symmetric-definite problem of \em A and \em B; \em range, \em vl,
+     * \em vu, \em il, \em iu, \em m and \em Z are as for syevr. \em B is
+     * overwritten with its Cholesky factor. A positive info of at most n
+     * counts eigenvectors that failed to converge; above n, B is not
+     * positive definite.
+     * @returns info
+     */
+    template <class E, class W, class Z, class Alloc>
+    int sygvx(E& A, E& B, blas_index_t itype, char jobz, char range, char uplo,
+              typename E::value_type vl, typename E::value_type vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("sygvx", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, range);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        using value_type = typename E::value_type;
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        uvector<blas_index_t> ifail(std::max(static_cast<std::size_t>(n), std::size_t(1)));
+        value_type abstol = 2 * std::numeric_limits<value_type>::min();
+
+        // a single selected eigenvector has a zero column stride
+        blas_index_t z_stride = z.shape()[1] == 1 ? to_blas_index(z.shape()[0]) : stride_back(z);
+        const auto& sizes = ws.sizes({routine::sygvx, {n, itype, 0}, {jobz, range, uplo}}, [&](auto& c) {
+            int info = cxxlapack::sygvx<blas_index_t>(
+                itype, jobz, range, uplo, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                B.data(), std::max(stride_back(B), blas_index_t(1)),
+                vl, vu, il, iu, abstol, m,
+                w.data(), z.data(), std::max(z_stride, blas_index_t(1)),
+                c.work.data(), to_blas_index(-1),
+                c.iwork.data(), ifail.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for sygvx.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                   5 * std::max(static_cast<std::size_t>(n), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::sygvx<blas_index_t>(
+            itype, jobz, range, uplo, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1)),
+            vl, vu, il, iu, abstol, m,
+            w.data(), z.data(), std::max(z_stride, blas_index_t(1)),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data(), ifail.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class Z>
+    int sygvx(E& A, E& B, blas_index_t itype, char jobz, char range, char uplo,
+              typename E::value_type vl, typename E::value_type vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z)
+    {
+        return sygvx(A, B, itype, jobz, range, uplo, vl, vu, il, iu, m, w, z,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK hegvx, the Hermitian counterpart of sygvx.
+     * @returns info
+     */
+    template <class E, class W, class Z, class Alloc>
+    int hegvx(E& A, E& B, blas_index_t itype, char jobz, char range, char uplo,
+              xtl::complex_value_type_t<typename E::value_type> vl,
+              xtl::complex_value_type_t<typename E::value_type> vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("hegvx", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, range);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        using underlying_value_type = xtl::complex_value_type_t<typename E::value_type>;
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        std::size_t len = std::max(static_cast<std::size_t>(n), std::size_t(1));
+        uvector<blas_index_t> ifail(len);
+        underlying_value_type abstol = 2 * std::numeric_limits<underlying_value_type>::min();
+
+        // a single selected eigenvector has a zero column stride
+        blas_index_t z_stride = z.shape()[1] == 1 ? to_blas_index(z.shape()[0]) : stride_back(z);
+        const auto& sizes = ws.sizes({routine::hegvx, {n, itype, 0}, {jobz, range, uplo}}, [&](auto& c) {
+            int info = cxxlapack::hegvx<blas_index_t>(
+                itype, jobz, range, uplo, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                B.data(), std::max(stride_back(B), blas_index_t(1)),
+                vl, vu, il, iu, abstol, m,
+                w.data(), z.data(), std::max(z_stride, blas_index_t(1)),
+                c.work.data(), to_blas_index(-1),
+                c.rwork.data(), c.iwork.data(), ifail.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for hegvx.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 7 * len, 5 * len};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::hegvx<blas_index_t>(
+            itype, jobz, range, uplo, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1)),
+            vl, vu, il, iu, abstol, m,
+            w.data(), z.data(), std::max(z_stride, blas_index_t(1)),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.rwork.data(), ws.iwork.data(), ifail.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class Z>
+    int hegvx(E& A, E& B, blas_index_t itype, char jobz, char range, char uplo,
+              xtl::complex_value_type_t<typename E::value_type> vl,
+              xtl::complex_value_type_t<typename E::value_type> vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z)
+    {
+        return hegvx(A, B, itype, jobz, range, uplo, vl, vu, il, iu, m, w, z,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Complex version of geev
+     */
+    template <class E, class W, class V, class Alloc>
+    int geev(E& A, char jobvl, char jobvr, W& w, V& VL, V& VR, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("geev", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvl, jobvr);
+        // TODO implement for complex numbers
+
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        const auto N = A.shape()[0];
+        std::size_t rwork_size = std::max(2 * N, std::size_t(1));
+
+        const auto& sizes = ws.sizes({routine::geev, {to_blas_index(N), 0, 0}, {jobvl, jobvr}}, [&](auto& c) {
+            c.reserve(workspace_sizes{1, rwork_size, 0});
+            int info = cxxlapack::geev<blas_index_t>(
+                jobvl,
+                jobvr,
+                to_blas_index(N),
+                A.data(),
+                stride_back(A),
+                w.data(),
+                VL.data(),
+                stride_back(VL),
+                VR.data(),
+                stride_back(VR),
+                c.work.data(),
+                -1,
+                c.rwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geev.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), rwork_size, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::geev<blas_index_t>(
+            jobvl,
+            jobvr,
+            to_blas_index(N),
+            A.data(),
+            stride_back(A),
+            w.data(),
+            VL.data(),
+            stride_back(VL),
+            VR.data(),
+            stride_back(VR),
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.rwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V>
+    int geev(E& A, char jobvl, char jobvr, W& w, V& VL, V& VR)
+    {
+        return geev(A, jobvl, jobvr, w, VL, VR, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK ggev for real matrices.
+     *
+     * Generalized eigenvalues (alphar + i alphai) / beta of the pair
+     * (\em A, \em B), with the left and right eigenvectors packed as by
+     * geev. \em A and \em B are destroyed. \em VL and \em VR are only
+     * referenced with \em jobvl / \em jobvr 'V', but must always have a
+     * leading dimension of at least 1.
+     * @returns info
+     */
+    template <class E, class W, class V, class Alloc>
+    int ggev(E& A, E& B, char jobvl, char jobvr, W& alphar, W& alphai, W& beta, V& VL, V& VR,
+             workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("ggev", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvl, jobvr);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+
+        const auto& sizes = ws.sizes({routine::ggev, {n, 0, 0}, {jobvl, jobvr}}, [&](auto& c) {
+            int info = cxxlapack::ggev<blas_index_t>(
+                jobvl, jobvr, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                B.data(), std::max(stride_back(B), blas_index_t(1)),
+                alphar.data(), alphai.data(), beta.data(),
+                VL.data(), std::max(stride_back(VL), blas_index_t(1)),
+                VR.data(), std::max(stride_back(VR), blas_index_t(1)),
+                c.work.data(), to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for ggev.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::ggev<blas_index_t>(
+            jobvl, jobvr, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1)),
+            alphar.data(), alphai.data(), beta.data(),
+            VL.data(), std::max(stride_back(VL), blas_index_t(1)),
+            VR.data(), std::max(stride_back(VR), blas_index_t(1)),
+            ws.work.data(), to_blas_index(sizes.work)
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V>
+    int ggev(E& A, E& B, char jobvl, char jobvr, W& alphar, W& alphai, W& beta, V& VL, V& VR)
+    {
+        return ggev(A, B, jobvl, jobvr, alphar, alphai, beta, VL, VR,
+                    workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK ggev for complex matrices, with the generalized
+     * eigenvalues alpha / beta.
+     * @returns info
+     */
+    template <class E, class W, class V, class Alloc>
+    int ggev(E& A, E& B, char jobvl, char jobvr, W& alpha, W& beta, V& VL, V& VR,
+             workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("ggev", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvl, jobvr);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(B.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        std::size_t rwork_size = 8 * std::max(static_cast<std::size_t>(n), std::size_t(1));
+
+        const auto& sizes = ws.sizes({routine::ggev, {n, 0, 0}, {jobvl, jobvr}}, [&](auto& c) {
+            c.reserve(workspace_sizes{1, rwork_size, 0});
+            int info = cxxlapack::ggev<blas_index_t>(
+                jobvl, jobvr, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                B.data(), std::max(stride_back(B), blas_index_t(1)),
+                alpha.data(), beta.data(),
+                VL.data(), std::max(stride_back(VL), blas_index_t(1)),
+                VR.data(), std::max(stride_back(VR), blas_index_t(1)),
+                c.work.data(), to_blas_index(-1),
+                c.rwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for ggev.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), rwork_size, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::ggev<blas_index_t>(
+            jobvl, jobvr, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            B.data(), std::max(stride_back(B), blas_index_t(1)),
+            alpha.data(), beta.data(),
+            VL.data(), std::max(stride_back(VL), blas_index_t(1)),
+            VR.data(), std::max(stride_back(VR), blas_index_t(1)),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.rwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V>
+    int ggev(E& A, E& B, char jobvl, char jobvr, W& alpha, W& beta, V& VL, V& VR)
+    {
+        return ggev(A, B, jobvl, jobvr, alpha, beta, VL, VR, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK geevx for real matrices.
+     *
+     * With \em balanc 'P', 'S' or 'B', \em A is permuted and/or scaled
+     * before the reduction; \em ilo, \em ihi and \em scale describe the
+     * balancing and \em abnrm is the one-norm of the balanced matrix. With
+     * \em sense 'E', 'V' or 'B', the reciprocal condition numbers of the
+     * eigenvalues and of the right eigenvectors are stored in \em rconde and
+     * \em rcondv, which requires \em jobvl and \em jobvr 'V'. \em VL,
+     * \em VR, \em rconde and \em rcondv are not referenced when not
+     * computed, but must hold at least one element.
+     * @returns info
+     */
+    template <class E, class W, class V, class Alloc>
+    int geevx(E& A, char balanc, char jobvl, char jobvr, char sense, W& wr, W& wi, V& VL, V& VR,
+              blas_index_t& ilo, blas_index_t& ihi, W& scale, typename E::value_type& abnrm, W& rconde, W& rcondv,
+              workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("geevx", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvl, jobvr);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        std::size_t iwork_size = std::max(2 * static_cast<std::size_t>(n), std::size_t(3)) - 2;
+
+        const auto& sizes = ws.sizes({routine::geevx, {n, 0, 0}, {jobvl, jobvr, sense}}, [&](auto& c) {
+            c.reserve(workspace_sizes{1, 0, iwork_size});
+            int info = cxxlapack::geevx<blas_index_t>(
+                balanc, jobvl, jobvr, sense, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                wr.data(), wi.data(),
+                VL.data(), std::max(stride_back(VL), blas_index_t(1)),
+                VR.data(), std::max(stride_back(VR), blas_index_t(1)),
+                ilo, ihi, scale.data(), abnrm, rconde.data(), rcondv.data(),
+                c.work.data(), to_blas_index(-1),
+                c.iwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geevx.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0, iwork_size};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::geevx<blas_index_t>(
+            balanc, jobvl, jobvr, sense, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            wr.data(), wi.data(),
+            VL.data(), std::max(stride_back(VL), blas_index_t(1)),
+            VR.data(), std::max(stride_back(VR), blas_index_t(1)),
+            ilo, ihi, scale.data(), abnrm, rconde.data(), rcondv.data(),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V>
+    int geevx(E& A, char balanc, char jobvl, char jobvr, char sense, W& wr, W& wi, V& VL, V& VR,
+              blas_index_t& ilo, blas_index_t& ihi, W& scale, typename E::value_type& abnrm, W& rconde, W& rcondv)
+    {
+        return geevx(A, balanc, jobvl, jobvr, sense, wr, wi, VL, VR, ilo, ihi, scale, abnrm, rconde, rcondv,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Complex version of geevx, see the real version. \em scale, \em rconde
+     * and \em rcondv are real.
+     * @returns info
+     */
+    template <class E, class W, class V, class R, class Alloc>
+    int geevx(E& A, char balanc, char jobvl, char jobvr, char sense, W& w, V& VL, V& VR,
+              blas_index_t& ilo, blas_index_t& ihi, R& scale, xtl::complex_value_type_t<typename E::value_type>& abnrm,
+              R& rconde, R& rcondv, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("geevx", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobvl, jobvr);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        std::size_t rwork_size = std::max(2 * static_cast<std::size_t>(n), std::size_t(1));
+
+        const auto& sizes = ws.sizes({routine::geevx, {n, 0, 0}, {jobvl, jobvr, sense}}, [&](auto& c) {
+            c.reserve(workspace_sizes{1, rwork_size, 0});
+            int info = cxxlapack::geevx<blas_index_t>(
+                balanc, jobvl, jobvr, sense, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                w.data(),
+                VL.data(), std::max(stride_back(VL), blas_index_t(1)),
+                VR.data(), std::max(stride_back(VR), blas_index_t(1)),
+                ilo, ihi, scale.data(), abnrm, rconde.data(), rcondv.data(),
+                c.work.data(), to_blas_index(-1),
+                c.rwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for geevx.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), rwork_size, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::geevx<blas_index_t>(
+            balanc, jobvl, jobvr, sense, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            w.data(),
+            VL.data(), std::max(stride_back(VL), blas_index_t(1)),
+            VR.data(), std::max(stride_back(VR), blas_index_t(1)),
+            ilo, ihi, scale.data(), abnrm, rconde.data(), rcondv.data(),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.rwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class V, class R>
+    int geevx(E& A, char balanc, char jobvl, char jobvr, char sense, W& w, V& VL, V& VR,
+              blas_index_t& ilo, blas_index_t& ihi, R& scale, xtl::complex_value_type_t<typename E::value_type>& abnrm,
+              R& rconde, R& rcondv)
+    {
+        return geevx(A, balanc, jobvl, jobvr, sense, w, VL, VR, ilo, ihi, scale, abnrm, rconde, rcondv,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK heev, the eigensolver with the smallest workspace,
+     * used by heevd under the memory budget.
+     * @returns info
+     */
+    template <class E, class W, class Alloc>
+    int heev(E& A, char jobz, char uplo, W& w, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("heev", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        auto N = A.shape()[0];
+        std::size_t rwork_size = std::max(3 * N, std::size_t(3)) - 2;
+
+        const auto& sizes = ws.sizes({routine::heev, {to_blas_index(N), 0, 0}, {jobz, uplo}}, [&](auto& c) {
+            int info = cxxlapack::heev<blas_index_t>(
+                jobz,
+                uplo,
+                to_blas_index(N),
+                A.data(),
+                stride_back(A),
+                w.data(),
+                c.work.data(),
+                to_blas_index(-1),
+                c.rwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for heev.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), rwork_size, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::heev<blas_index_t>(
+            jobz,
+            uplo,
+            to_blas_index(N),
+            A.data(),
+            stride_back(A),
+            w.data(),
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.rwork.data()
+        );
+    }
+
+    template <class E, class W>
+    int heev(E& A, char jobz, char uplo, W& w)
+    {
+        return heev(A, jobz, uplo, w, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    template <class E, class W, class Alloc>
+    int heevd(E& A, char jobz, char uplo, W& w, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("heevd", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, uplo);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+
+        auto N = A.shape()[0];
+
+#if defined(XTENSOR_USE_CUDA)
+        int cuda_info = 0;
+        if (!ws.query_only() && cuda::detail::eigh(jobz, uplo, N, A.data(), stride_back(A), w.data(), cuda_info))
+        {
+            return cuda_info;
+        }
+#endif
+
+        detail::workspace_key key = {routine::heevd, {to_blas_index(N), 0, 0}, {jobz, uplo}};
+        auto query = [&](auto& c) {
+            int info = cxxlapack::heevd<blas_index_t>(
+                jobz,
+                uplo,
+                to_blas_index(N),
+                A.data(),
+                stride_back(A),
+                w.data(),
+                c.work.data(),
+                to_blas_index(-1),
+                c.rwork.data(),
+                to_blas_index(-1),
+                c.iwork.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for heevd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]),
+                                           std::max(std::size_t(c.rwork[0]), std::size_t(1)),
+                                           std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        };
+
+        if (detail::use_fallback<typename E::value_type>(ws, key, query))
+        {
+            // heev works in place with a workspace of 2 n and 3 n reals
+            int res = heev(A, jobz, uplo, w, ws);
+            detail::last_driver_value() = routine::heev;
+            return res;
+        }
+
+        const auto& sizes = ws.sizes(key, query);
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::heevd<blas_index_t>(
+            jobz,
+            uplo,
+            to_blas_index(N),
+            A.data(),
+            stride_back(A),
+            w.data(),
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.rwork.data(),
+            to_blas_index(sizes.rwork),
+            ws.iwork.data(),
+            to_blas_index(sizes.iwork)
+        );
+
+        return info;
+    }
+
+    template <class E, class W>
+    int heevd(E& A, char jobz, char uplo, W& w)
+    {
+        return heevd(A, jobz, uplo, w, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK syevr.
+     *
+     * Selected eigenvalues, and with \em jobz 'V' eigenvectors, of a
+     * symmetric matrix with the MRRR algorithm. \em range is 'A' for all
+     * eigenvalues, 'V' for those in (vl, vu] and 'I' for the il-th to the
+     * iu-th (1-based, ascending). \em w needs n elements; the m found values
+     * come first. The first m columns of \em Z receive the eigenvectors, so
+     * it needs iu - il + 1 columns for 'I' and n columns otherwise; it must
+     * always have a leading dimension of at least 1.
+     * @returns info
+     */
+    template <class E, class W, class Z, class Alloc>
+    int syevr(E& A, char jobz, char range, char uplo,
+              typename E::value_type vl, typename E::value_type vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("syevr", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, range);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        using value_type = typename E::value_type;
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        uvector<blas_index_t> isuppz(2 * std::max(static_cast<std::size_t>(n), std::size_t(1)));
+        value_type abstol = std::numeric_limits<value_type>::min();
+
+        // a single selected eigenvector has a zero column stride
+        blas_index_t z_stride = z.shape()[1] == 1 ? to_blas_index(z.shape()[0]) : stride_back(z);
+        const auto& sizes = ws.sizes({routine::syevr, {n, 0, 0}, {jobz, range, uplo}}, [&](auto& c) {
+            int info = cxxlapack::syevr<blas_index_t>(
+                jobz, range, uplo, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                vl, vu, il, iu, abstol, m,
+                w.data(), z.data(), std::max(z_stride, blas_index_t(1)), isuppz.data(),
+                c.work.data(), to_blas_index(-1),
+                c.iwork.data(), to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for syevr.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                   std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::syevr<blas_index_t>(
+            jobz, range, uplo, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            vl, vu, il, iu, abstol, m,
+            w.data(), z.data(), std::max(z_stride, blas_index_t(1)), isuppz.data(),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data(), to_blas_index(sizes.iwork)
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class Z>
+    int syevr(E& A, char jobz, char range, char uplo,
+              typename E::value_type vl, typename E::value_type vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z)
+    {
+        return syevr(A, jobz, range, uplo, vl, vu, il, iu, m, w, z,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK heevr, the Hermitian counterpart of syevr.
+     * @returns info
+     */
+    template <class E, class W, class Z, class Alloc>
+    int heevr(E& A, char jobz, char range, char uplo,
+              xtl::complex_value_type_t<typename E::value_type> vl,
+              xtl::complex_value_type_t<typename E::value_type> vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("heevr", A.shape()[0], A.shape()[1], 0, layout_type::column_major, jobz, range);
+        XTENSOR_ASSERT(A.dimension() == 2);
+        XTENSOR_ASSERT(A.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        using underlying_value_type = xtl::complex_value_type_t<typename E::value_type>;
+        blas_index_t n = to_blas_index(A.shape()[0]);
+        uvector<blas_index_t> isuppz(2 * std::max(static_cast<std::size_t>(n), std::size_t(1)));
+        underlying_value_type abstol = std::numeric_limits<underlying_value_type>::min();
+
+        // a single selected eigenvector has a zero column stride
+        blas_index_t z_stride = z.shape()[1] == 1 ? to_blas_index(z.shape()[0]) : stride_back(z);
+        const auto& sizes = ws.sizes({routine::heevr, {n, 0, 0}, {jobz, range, uplo}}, [&](auto& c) {
+            int info = cxxlapack::heevr<blas_index_t>(
+                jobz, range, uplo, n,
+                A.data(), std::max(stride_back(A), blas_index_t(1)),
+                vl, vu, il, iu, abstol, m,
+                w.data(), z.data(), std::max(z_stride, blas_index_t(1)), isuppz.data(),
+                c.work.data(), to_blas_index(-1),
+                c.rwork.data(), to_blas_index(-1),
+                c.iwork.data(), to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for heevr.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]),
+                                   std::max(std::size_t(c.rwork[0]), std::size_t(1)),
+                                   std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::heevr<blas_index_t>(
+            jobz, range, uplo, n,
+            A.data(), std::max(stride_back(A), blas_index_t(1)),
+            vl, vu, il, iu, abstol, m,
+            w.data(), z.data(), std::max(z_stride, blas_index_t(1)), isuppz.data(),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.rwork.data(), to_blas_index(sizes.rwork),
+            ws.iwork.data(), to_blas_index(sizes.iwork)
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class Z>
+    int heevr(E& A, char jobz, char range, char uplo,
+              xtl::complex_value_type_t<typename E::value_type> vl,
+              xtl::complex_value_type_t<typename E::value_type> vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z)
+    {
+        return heevr(A, jobz, range, uplo, vl, vu, il, iu, m, w, z,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK stedc: all eigenvalues, and with \em compz 'I'
+     * the eigenvectors, of the real symmetric tridiagonal matrix with
+     * diagonal \em d and off-diagonal \em e, by divide and conquer. With
+     * \em compz 'V', \em Z holds on entry the orthogonal matrix that reduced
+     * a full matrix to this tridiagonal form and receives the eigenvectors
+     * of the full matrix.
+     *
+     * @param d the n diagonal elements, overwritten with the eigenvalues in ascending order
+     * @param e the n - 1 off-diagonal elements, destroyed
+     * @param Z column-major n x n matrix, only referenced with \em compz 'I' or 'V'
+     * @returns info
+     */
+    template <class D, class F, class Z, class Alloc>
+    int stedc(char compz, D& d, F& e, Z& z, workspace<typename Z::value_type, Alloc>& ws)
+    {
+        using value_type = typename Z::value_type;
+        static_assert(!xtl::is_complex<value_type>::value, "stedc is only wrapped for real matrices.");
+        XTENSOR_BLAS_INSTRUMENT_CALL("stedc", d.size(), 0, 0, layout_type::column_major, compz, 0);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(d.size());
+        blas_index_t ldz = std::max(z.dimension() == 2 && z.shape()[1] > 1 ? stride_back(z) : n, blas_index_t(1));
+
+        const auto& sizes = ws.sizes({routine::stedc, {n, 0, 0}, {compz}}, [&](auto& c) {
+            int info = cxxlapack::stedc<blas_index_t>(
+                compz, n, d.data(), e.data(), z.data(), ldz,
+                c.work.data(), to_blas_index(-1),
+                c.iwork.data(), to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for stedc.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                   std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::stedc<blas_index_t>(
+            compz, n, d.data(), e.data(), z.data(), ldz,
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data(), to_blas_index(sizes.iwork)
+        );
+    }
+
+    template <class D, class F, class Z>
+    int stedc(char compz, D& d, F& e, Z& z)
+    {
+        return stedc(compz, d, e, z, workspace<typename Z::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK stevr: selected eigenvalues, and with \em jobz 'V'
+     * eigenvectors, of the real symmetric tridiagonal matrix with diagonal
+     * \em d and off-diagonal \em e, with the MRRR algorithm. \em range,
+     * \em vl, \em vu, \em il, \em iu, \em w and \em Z are as for syevr.
+     *
+     * @param d the n diagonal elements, may be scaled on exit
+     * @param e the n - 1 off-diagonal elements, destroyed
+     * @returns info
+     */
+    template <class D, class F, class W, class Z, class Alloc>
+    int stevr(D& d, F& e, char jobz, char range,
+              typename Z::value_type vl, typename Z::value_type vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z, workspace<typename Z::value_type, Alloc>& ws)
+    {
+        using value_type = typename Z::value_type;
+        static_assert(!xtl::is_complex<value_type>::value, "stevr only supports real matrices.");
+        XTENSOR_BLAS_INSTRUMENT_CALL("stevr", d.size(), 0, 0, layout_type::column_major, jobz, range);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(d.size());
+        uvector<blas_index_t> isuppz(2 * std::max(static_cast<std::size_t>(n), std::size_t(1)));
+        value_type abstol = std::numeric_limits<value_type>::min();
+
+        // a single selected eigenvector has a zero column stride
+        blas_index_t z_stride = z.shape()[1] == 1 ? to_blas_index(z.shape()[0]) : stride_back(z);
+        const auto& sizes = ws.sizes({routine::stevr, {n, 0, 0}, {jobz, range}}, [&](auto& c) {
+            int info = cxxlapack::stevr<blas_index_t>(
+                jobz, range, n, d.data(), e.data(),
+                vl, vu, il, iu, abstol, m,
+                w.data(), z.data(), std::max(z_stride, blas_index_t(1)), isuppz.data(),
+                c.work.data(), to_blas_index(-1),
+                c.iwork.data(), to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for stevr.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                   std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::stevr<blas_index_t>(
+            jobz, range, n, d.data(), e.data(),
+            vl, vu, il, iu, abstol, m,
+            w.data(), z.data(), std::max(z_stride, blas_index_t(1)), isuppz.data(),
+            ws.work.data(), to_blas_index(sizes.work),
+            ws.iwork.data(), to_blas_index(sizes.iwork)
+        );
+    }
+
+    template <class D, class F, class W, class Z>
+    int stevr(D& d, F& e, char jobz, char range,
+              typename Z::value_type vl, typename Z::value_type vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z)
+    {
+        return stevr(d, e, jobz, range, vl, vu, il, iu, m, w, z,
+                     workspace<typename Z::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK bdsqr: the singular values of the upper
+     * (\em uplo 'U') or lower ('L') bidiagonal matrix B with diagonal \em d
+     * and off-diagonal \em e, B = Q S P^H, by implicit zero-shift QR. When
+     * they are not empty, \em VT is overwritten with P^H VT, \em U with U Q
+     * and \em C with Q^H C, so that passing the matrices of gebrd gives the
+     * singular vectors of the full matrix, and identities those of B.
+     *
+     * @param d the n diagonal elements, overwritten with the singular values in decreasing order
+     * @param e the n - 1 off-diagonal elements, destroyed
+     * @param VT column-major n x ncvt matrix, or empty
+     * @param U column-major nru x n matrix, or empty
+     * @param C column-major n x ncc matrix, or empty
+     * @returns info
+     */
+    template <class D, class F, class V, class U, class C, class Alloc>
+    int bdsqr(char uplo, D& d, F& e, V& vt, U& u, C& c, workspace<typename V::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("bdsqr", d.size(), u.size() / std::max(d.size(), std::size_t(1)), 0,
+                                     layout_type::column_major, uplo, 0);
+        XTENSOR_ASSERT(vt.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(u.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(c.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(d.size());
+        blas_index_t ncvt = vt.size() == 0 ? 0 : to_blas_index(vt.shape()[1]);
+        blas_index_t nru = u.size() == 0 ? 0 : to_blas_index(u.shape()[0]);
+        blas_index_t ncc = c.size() == 0 ? 0 : to_blas_index(c.shape()[1]);
+        blas_index_t ldvt = std::max(ncvt > 1 ? stride_back(vt) : n, blas_index_t(1));
+        blas_index_t ldu = std::max(n > 1 && nru > 0 ? stride_back(u) : nru, blas_index_t(1));
+        blas_index_t ldc = std::max(ncc > 1 ? stride_back(c) : n, blas_index_t(1));
+
+        // bdsqr has no workspace query: the real work array has 4 n elements
+        ws.sizes({routine::bdsqr, {n, 0, 0}, {}}, [&](auto&) {
+            return workspace_sizes{0, std::max(4 * static_cast<std::size_t>(n), std::size_t(1)), 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::bdsqr<blas_index_t>(
+            uplo, n, ncvt, nru, ncc, d.data(), e.data(),
+            vt.data(), ldvt, u.data(), ldu, c.data(), ldc,
+            ws.rwork.data()
+        );
+    }
+
+    template <class D, class F, class V, class U, class C>
+    int bdsqr(char uplo, D& d, F& e, V& vt, U& u, C& c)
+    {
+        return bdsqr(uplo, d, e, vt, u, c, workspace<typename V::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK bdsdc: the singular values, and with \em compq 'I'
+     * the singular vectors, of the upper (\em uplo 'U') or lower ('L') real
+     * bidiagonal matrix B = U S VT with diagonal \em d and off-diagonal
+     * \em e, by divide and conquer. \em compq 'N' computes the singular
+     * values only; the compact form 'P' is not wrapped.
+     *
+     * @param d the n diagonal elements, overwritten with the singular values in decreasing order
+     * @param e the n - 1 off-diagonal elements, destroyed
+     * @param U column-major n x n matrix, set with \em compq 'I'
+     * @param VT column-major n x n matrix, set with \em compq 'I'
+     * @returns info
+     */
+    template <class D, class F, class U, class V, class Alloc>
+    int bdsdc(char uplo, char compq, D& d, F& e, U& u, V& vt, workspace<typename U::value_type, Alloc>& ws)
+    {
+        using value_type = typename U::value_type;
+        static_assert(!xtl::is_complex<value_type>::value, "bdsdc only supports real matrices.");
+        XTENSOR_BLAS_INSTRUMENT_CALL("bdsdc", d.size(), 0, 0, layout_type::column_major, uplo, compq);
+        XTENSOR_ASSERT(compq == 'N' || compq == 'I');
+        XTENSOR_ASSERT(u.layout() == layout_type::column_major);
+        XTENSOR_ASSERT(vt.layout() == layout_type::column_major);
+
+        blas_index_t n = to_blas_index(d.size());
+        blas_index_t ldu = std::max(compq == 'I' && n > 1 ? stride_back(u) : n, blas_index_t(1));
+        blas_index_t ldvt = std::max(compq == 'I' && n > 1 ? stride_back(vt) : n, blas_index_t(1));
+
+        // bdsdc has no workspace query
+        ws.sizes({routine::bdsdc, {n, 0, 0}, {compq}}, [&](auto&) {
+            std::size_t un = static_cast<std::size_t>(n);
+            std::size_t work = compq == 'I' ? 3 * un * un + 4 * un : 4 * un;
+            return workspace_sizes{std::max(work, std::size_t(1)), 0, std::max(8 * un, std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        value_type q(0);
+        blas_index_t iq(0);
+        return cxxlapack::bdsdc<blas_index_t>(
+            uplo, compq, n, d.data(), e.data(),
+            u.data(), ldu, vt.data(), ldvt, &q, &iq,
+            ws.work.data(), ws.iwork.data()
+        );
+    }
+
+    template <class D, class F, class U, class V>
+    int bdsdc(char uplo, char compq, D& d, F& e, U& u, V& vt)
+    {
+        return bdsdc(uplo, compq, d, e, u, vt, workspace<typename U::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK spevd.
+     *
+     * Eigenvalues, and with \em jobz 'V' eigenvectors, of a symmetric matrix
+     * packed in \em AP, which is destroyed. \em Z is only referenced with
+     * \em jobz 'V', but must always have a leading dimension of at least 1.
+     * @returns info
+     */
+    template <class E, class W, class Z, class Alloc>
+    int spevd(E& AP, char jobz, char uplo, W& w, Z& z, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_ASSERT(z.dimension() == 2);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        blas_index_t N = detail::packed_order(AP.size());
+        blas_index_t z_stride = std::max(stride_back(z), blas_index_t(1));
+
+        const auto& sizes = ws.sizes({routine::spevd, {N, 0, 0}, {jobz, uplo}}, [&](auto& c) {
+            int info = cxxlapack::spevd<blas_index_t>(
+                jobz,
+                uplo,
+                N,
+                AP.data(),
+                w.data(),
+                z.data(),
+                z_stride,
+                c.work.data(),
+                to_blas_index(-1),
+                c.iwork.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for spevd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                           std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::spevd<blas_index_t>(
+            jobz,
+            uplo,
+            N,
+            AP.data(),
+            w.data(),
+            z.data(),
+            z_stride,
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.iwork.data(),
+            to_blas_index(sizes.iwork)
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class Z>
+    int spevd(E& AP, char jobz, char uplo, W& w, Z& z)
+    {
+        return spevd(AP, jobz, uplo, w, z, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK hpevd, the Hermitian counterpart of spevd.
+     * @returns info
+     */
+    template <class E, class W, class Z, class Alloc>
+    int hpevd(E& AP, char jobz, char uplo, W& w, Z& z, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_ASSERT(z.dimension() == 2);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        blas_index_t N = detail::packed_order(AP.size());
+        blas_index_t z_stride = std::max(stride_back(z), blas_index_t(1));
+
+        const auto& sizes = ws.sizes({routine::hpevd, {N, 0, 0}, {jobz, uplo}}, [&](auto& c) {
+            int info = cxxlapack::hpevd<blas_index_t>(
+                jobz,
+                uplo,
+                N,
+                AP.data(),
+                w.data(),
+                z.data(),
+                z_stride,
+                c.work.data(),
+                to_blas_index(-1),
+                c.rwork.data(),
+                to_blas_index(-1),
+                c.iwork.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for hpevd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]),
+                                           std::max(std::size_t(c.rwork[0]), std::size_t(1)),
+                                           std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::hpevd<blas_index_t>(
+            jobz,
+            uplo,
+            N,
+            AP.data(),
+            w.data(),
+            z.data(),
+            z_stride,
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.rwork.data(),
+            to_blas_index(sizes.rwork),
+            ws.iwork.data(),
+            to_blas_index(sizes.iwork)
+        );
+
+        return info;
+    }
+
+    template <class E, class W, class Z>
+    int hpevd(E& AP, char jobz, char uplo, W& w, Z& z)
+    {
+        return hpevd(AP, jobz, uplo, w, z, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK spevx: selected eigenvalues, and with \em jobz 'V'
+     * eigenvectors, of a symmetric matrix packed in \em AP, which is
+     * destroyed, by bisection and inverse iteration. \em range, \em vl,
+     * \em vu, \em il, \em iu, \em m, \em w and \em Z are as for syevr.
+     * @returns info, i > 0 if i eigenvectors failed to converge
+     */
+    template <class E, class W, class Z, class Alloc>
+    int spevx(E& AP, char jobz, char range, char uplo,
+              typename E::value_type vl, typename E::value_type vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z, workspace<typename E::value_type, Alloc>& ws)
+    {
+        using value_type = typename E::value_type;
+        static_assert(!xtl::is_complex<value_type>::value, "spevx only supports real matrices.");
+        XTENSOR_ASSERT(z.dimension() == 2);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        blas_index_t N = detail::packed_order(AP.size());
+        XTENSOR_BLAS_INSTRUMENT_CALL("spevx", N, N, 0, layout_type::column_major, jobz, range);
+        uvector<blas_index_t> ifail(std::max(static_cast<std::size_t>(N), std::size_t(1)));
+        value_type abstol = std::numeric_limits<value_type>::min();
+
+        // a single selected eigenvector has a zero column stride
+        blas_index_t z_stride = z.shape()[1] == 1 ? to_blas_index(z.shape()[0]) : stride_back(z);
+
+        // spevx has no workspace query: work has 8 n elements, iwork 5 n
+        ws.sizes({routine::spevx, {N, 0, 0}, {jobz, range}}, [&](auto&) {
+            std::size_t un = static_cast<std::size_t>(N);
+            return workspace_sizes{std::max(8 * un, std::size_t(1)), 0, std::max(5 * un, std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::spevx<blas_index_t>(
+            jobz, range, uplo, N, AP.data(),
+            vl, vu, il, iu, abstol, m,
+            w.data(), z.data(), std::max(z_stride, blas_index_t(1)),
+            ws.work.data(), ws.iwork.data(), ifail.data()
+        );
+    }
+
+    template <class E, class W, class Z>
+    int spevx(E& AP, char jobz, char range, char uplo,
+              typename E::value_type vl, typename E::value_type vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z)
+    {
+        return spevx(AP, jobz, range, uplo, vl, vu, il, iu, m, w, z,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK hpevx, the Hermitian counterpart of spevx.
+     * @returns info, i > 0 if i eigenvectors failed to converge
+     */
+    template <class E, class W, class Z, class Alloc>
+    int hpevx(E& AP, char jobz, char range, char uplo,
+              xtl::complex_value_type_t<typename E::value_type> vl,
+              xtl::complex_value_type_t<typename E::value_type> vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z, workspace<typename E::value_type, Alloc>& ws)
+    {
+        using real_type = xtl::complex_value_type_t<typename E::value_type>;
+        XTENSOR_ASSERT(z.dimension() == 2);
+        XTENSOR_ASSERT(z.layout() == layout_type::column_major);
+
+        blas_index_t N = detail::packed_order(AP.size());
+        XTENSOR_BLAS_INSTRUMENT_CALL("hpevx", N, N, 0, layout_type::column_major, jobz, range);
+        uvector<blas_index_t> ifail(std::max(static_cast<std::size_t>(N), std::size_t(1)));
+        real_type abstol = std::numeric_limits<real_type>::min();
+
+        blas_index_t z_stride = z.shape()[1] == 1 ? to_blas_index(z.shape()[0]) : stride_back(z);
+
+        // hpevx has no workspace query: work has 2 n elements, rwork 7 n, iwork 5 n
+        ws.sizes({routine::hpevx, {N, 0, 0}, {jobz, range}}, [&](auto&) {
+            std::size_t un = static_cast<std::size_t>(N);
+            return workspace_sizes{std::max(2 * un, std::size_t(1)), std::max(7 * un, std::size_t(1)),
+                                   std::max(5 * un, std::size_t(1))};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::hpevx<blas_index_t>(
+            jobz, range, uplo, N, AP.data(),
+            vl, vu, il, iu, abstol, m,
+            w.data(), z.data(), std::max(z_stride, blas_index_t(1)),
+            ws.work.data(), ws.rwork.data(), ws.iwork.data(), ifail.data()
+        );
+    }
+
+    template <class E, class W, class Z>
+    int hpevx(E& AP, char jobz, char range, char uplo,
+              xtl::complex_value_type_t<typename E::value_type> vl,
+              xtl::complex_value_type_t<typename E::value_type> vu, blas_index_t il, blas_index_t iu,
+              blas_index_t& m, W& w, Z& z)
+    {
+        return hpevx(AP, jobz, range, uplo, vl, vu, il, iu, m, w, z,
+                     workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    template <class E, class F, class S, class Alloc, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int gelsd(E& A, F& b, S& s, blas_index_t& rank, double rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gelsd", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
+
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+        blas_index_t b_stride = to_blas_index(std::max(std::max(std::size_t(1), m), n));
+
+        detail::workspace_key key = {routine::gelsd, {to_blas_index(m), to_blas_index(n), b_dim}, {}};
+        auto query = [&](auto& c) {
+            int info = cxxlapack::gelsd<blas_index_t>(
+                to_blas_index(A.shape()[0]),
+                to_blas_index(A.shape()[1]),
+                b_dim,
+                A.data(),
+                a_stride,
+                b.data(),
+                b_stride,
+                s.data(),
+                rcond,
+                rank,
+                c.work.data(),
+                to_blas_index(-1),
+                c.iwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gelsd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0,
+                                           std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        };
+
+        if (detail::use_fallback<typename E::value_type>(ws, key, query))
+        {
+            // gelss (SVD by QR iteration) has a workspace linear in m and n
+            // and the same outputs
+            int res = gelss(A, b, s, rank, rcond, ws);
+            detail::last_driver_value() = routine::gelss;
+            return res;
+        }
+
+        const auto& sizes = ws.sizes(key, query);
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::gelsd<blas_index_t>(
+            to_blas_index(A.shape()[0]),
+            to_blas_index(A.shape()[1]),
+            b_dim,
+            A.data(),
+            a_stride,
+            b.data(),
+            b_stride,
+            s.data(),
+            rcond,
+            rank,
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.iwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class F, class S, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int gelsd(E& A, F& b, S& s, blas_index_t& rank, double rcond)
+    {
+        return gelsd(A, b, s, rank, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    template <class E, class F, class S, class Alloc, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int gelsd(E& A, F& b, S& s, blas_index_t& rank, double rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gelsd", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major);
+
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+        blas_index_t b_stride = b_dim == 1 ? to_blas_index(b.shape().front()) : stride_back(b);
+
+        blas_index_t m = to_blas_index(A.shape()[0]);
+        blas_index_t n = to_blas_index(A.shape()[1]);
+
+        detail::workspace_key key = {routine::gelsd, {m, n, b_dim}, {}};
+        auto query = [&](auto& c) {
+            int info = cxxlapack::gelsd<blas_index_t>(
+                m,
+                n,
+                b_dim,
+                A.data(),
+                stride_back(A),
+                b.data(),
+                b_stride,
+                s.data(),
+                rcond,
+                rank,
+                c.work.data(),
+                to_blas_index(-1),
+                c.rwork.data(),
+                c.iwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gelsd.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]),
+                                           std::max(std::size_t(c.rwork[0]), std::size_t(1)),
+                                           std::max(std::size_t(c.iwork[0]), std::size_t(1))};
+        };
+
+        if (detail::use_fallback<typename E::value_type>(ws, key, query))
+        {
+            // gelss (SVD by QR iteration) has a workspace linear in m and n
+            // and the same outputs
+            int res = gelss(A, b, s, rank, rcond, ws);
+            detail::last_driver_value() = routine::gelss;
+            return res;
+        }
+
+        const auto& sizes = ws.sizes(key, query);
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::gelsd<blas_index_t>(
+            m,
+            n,
+            b_dim,
+            A.data(),
+            stride_back(A),
+            b.data(),
+            b_stride,
+            s.data(),
+            rcond,
+            rank,
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.rwork.data(),
+            ws.iwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class F, class S, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int gelsd(E& A, F& b, S& s, blas_index_t& rank, double rcond = -1)
+    {
+        return gelsd(A, b, s, rank, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gelsy: minimum norm least squares solution of
+     * A x = b with a complete orthogonal factorization of A.
+     *
+     * On exit, the first N rows of \em b hold the solution, \em rank is the
+     * effective rank of \em A and \em jpvt the (1-based) column permutation.
+     * @returns info
+     */
+    template <class E, class F, class P, class Alloc, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int gelsy(E& A, F& b, P& jpvt, blas_index_t& rank, double rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gelsy", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major);
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
+
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+        blas_index_t b_stride = to_blas_index(std::max(std::max(std::size_t(1), m), n));
+
+        const auto& sizes = ws.sizes({routine::gelsy, {to_blas_index(m), to_blas_index(n), b_dim}, {}},
+                                     [&](auto& c) {
+            cxxlapack::gelsy<blas_index_t>(
+                to_blas_index(m),
+                to_blas_index(n),
+                b_dim,
+                A.data(),
+                a_stride,
+                b.data(),
+                b_stride,
+                jpvt.data(),
+                rcond,
+                rank,
+                c.work.data(),
+                to_blas_index(-1)
+            );
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        cxxlapack::gelsy<blas_index_t>(
+            to_blas_index(m),
+            to_blas_index(n),
+            b_dim,
+            A.data(),
+            a_stride,
+            b.data(),
+            b_stride,
+            jpvt.data(),
+            rcond,
+            rank,
+            ws.work.data(),
+            to_blas_index(sizes.work)
+        );
+
+        // gelsy has no failure mode besides illegal arguments
+        return 0;
+    }
+
+    template <class E, class F, class P, class Alloc, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int gelsy(E& A, F& b, P& jpvt, blas_index_t& rank, double rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gelsy", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major);
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
+
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+        blas_index_t b_stride = to_blas_index(std::max(std::max(std::size_t(1), m), n));
+
+        const auto& sizes = ws.sizes({routine::gelsy, {to_blas_index(m), to_blas_index(n), b_dim}, {}},
+                                     [&](auto& c) {
+            cxxlapack::gelsy<blas_index_t>(
+                to_blas_index(m),
+                to_blas_index(n),
+                b_dim,
+                A.data(),
+                a_stride,
+                b.data(),
+                b_stride,
+                jpvt.data(),
+                rcond,
+                rank,
+                c.work.data(),
+                to_blas_index(-1),
+                c.rwork.data()
+            );
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), std::max(2 * n, std::size_t(1)), 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        cxxlapack::gelsy<blas_index_t>(
+            to_blas_index(m),
+            to_blas_index(n),
+            b_dim,
+            A.data(),
+            a_stride,
+            b.data(),
+            b_stride,
+            jpvt.data(),
+            rcond,
+            rank,
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.rwork.data()
+        );
+
+        return 0;
+    }
+
+    template <class E, class F, class P>
+    int gelsy(E& A, F& b, P& jpvt, blas_index_t& rank, double rcond = -1)
+    {
+        return gelsy(A, b, jpvt, rank, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gelss: minimum norm least squares solution of
+     * A x = b with the SVD of A computed by QR iteration.
+     *
+     * On exit, the first N rows of \em b hold the solution and \em s the
+     * singular values of \em A in decreasing order.
+     * @returns info
+     */
+    template <class E, class F, class S, class Alloc, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int gelss(E& A, F& b, S& s, blas_index_t& rank, double rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gelss", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major);
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
+
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+        blas_index_t b_stride = to_blas_index(std::max(std::max(std::size_t(1), m), n));
+
+        const auto& sizes = ws.sizes({routine::gelss, {to_blas_index(m), to_blas_index(n), b_dim}, {}},
+                                     [&](auto& c) {
+            int info = cxxlapack::gelss<blas_index_t>(
+                to_blas_index(m),
+                to_blas_index(n),
+                b_dim,
+                A.data(),
+                a_stride,
+                b.data(),
+                b_stride,
+                s.data(),
+                rcond,
+                rank,
+                c.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gelss.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::gelss<blas_index_t>(
+            to_blas_index(m),
+            to_blas_index(n),
+            b_dim,
+            A.data(),
+            a_stride,
+            b.data(),
+            b_stride,
+            s.data(),
+            rcond,
+            rank,
+            ws.work.data(),
+            to_blas_index(sizes.work)
+        );
+
+        return info;
+    }
+
+    template <class E, class F, class S, class Alloc, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    int gelss(E& A, F& b, S& s, blas_index_t& rank, double rcond, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gelss", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major);
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
+
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+        blas_index_t b_stride = to_blas_index(std::max(std::max(std::size_t(1), m), n));
+
+        const auto& sizes = ws.sizes({routine::gelss, {to_blas_index(m), to_blas_index(n), b_dim}, {}},
+                                     [&](auto& c) {
+            int info = cxxlapack::gelss<blas_index_t>(
+                to_blas_index(m),
+                to_blas_index(n),
+                b_dim,
+                A.data(),
+                a_stride,
+                b.data(),
+                b_stride,
+                s.data(),
+                rcond,
+                rank,
+                c.work.data(),
+                to_blas_index(-1),
+                c.rwork.data()
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gelss.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]),
+                                   std::max(5 * std::min(m, n), std::size_t(1)), 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        int info = cxxlapack::gelss<blas_index_t>(
+            to_blas_index(m),
+            to_blas_index(n),
+            b_dim,
+            A.data(),
+            a_stride,
+            b.data(),
+            b_stride,
+            s.data(),
+            rcond,
+            rank,
+            ws.work.data(),
+            to_blas_index(sizes.work),
+            ws.rwork.data()
+        );
+
+        return info;
+    }
+
+    template <class E, class F, class S>
+    int gelss(E& A, F& b, S& s, blas_index_t& rank, double rcond = -1)
+    {
+        return gelss(A, b, s, rank, rcond, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    /**
+     * Interface to LAPACK gels: least squares (M >= N) or minimum norm
+     * (M < N) solution of op(A) x = b for a full rank A, with a QR or LQ
+     * factorization. \em trans is 'N', or 'T' ('C' for complex A).
+     *
+     * On exit, the leading rows of \em b hold the solution.
+     * @returns info, positive if \em A is rank deficient
+     */
+    template <class E, class F, class Alloc>
+    int gels(E& A, F& b, char trans, workspace<typename E::value_type, Alloc>& ws)
+    {
+        XTENSOR_BLAS_INSTRUMENT_CALL("gels", A.shape()[0], A.shape()[1], b.dimension() > 1 ? b.shape()[1] : 1, layout_type::column_major, trans);
+        blas_index_t b_dim = b.dimension() > 1 ? to_blas_index(b.shape().back()) : 1;
+
+        std::size_t m = A.shape()[0];
+        std::size_t n = A.shape()[1];
+
+        blas_index_t a_stride = to_blas_index(std::max(std::size_t(1), m));
+        blas_index_t b_stride = to_blas_index(std::max(std::max(std::size_t(1), m), n));
+
+        const auto& sizes = ws.sizes({routine::gels, {to_blas_index(m), to_blas_index(n), b_dim}, {trans}},
+                                     [&](auto& c) {
+            int info = cxxlapack::gels<blas_index_t>(
+                trans,
+                to_blas_index(m),
+                to_blas_index(n),
+                b_dim,
+                A.data(),
+                a_stride,
+                b.data(),
+                b_stride,
+                c.work.data(),
+                to_blas_index(-1)
+            );
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find workspace size for gels.");
+            }
+            return workspace_sizes{detail::workspace_query_result(c.work[0]), 0, 0};
+        });
+
+        if (ws.query_only())
+        {
+            return 0;
+        }
+
+        return cxxlapack::gels<blas_index_t>(
+            trans,
+            to_blas_index(m),
+            to_blas_index(n),
+            b_dim,
+            A.data(),
+            a_stride,
+            b.data(),
+            b_stride,
+            ws.work.data(),
+            to_blas_index(sizes.work)
+        );
+    }
+
+    template <class E, class F>
+    int gels(E& A, F& b, char trans = 'N')
+    {
+        return gels(A, b, trans, workspace<typename E::value_type>::thread_local_instance());
+    }
+
+    namespace detail
+    {
+        /*
+         * Each specialization calls its wrapper on placeholder arguments of the
+         * requested sizes. The workspace is in query only mode, so the
+         * wrapper returns right after the workspace query.
+         */
+        template <class T>
+        using query_matrix = xtensor<T, 2, layout_type::column_major>;
+
+        template <class T>
+        using query_vector = xtensor<T, 1, layout_type::column_major>;
+
+        inline std::size_t query_dim(blas_index_t d)
+        {
+            return static_cast<std::size_t>(std::max(d, blas_index_t(0)));
+        }
+
+        template <>
+        struct workspace_query<routine::gesdd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[1])});
+                gesdd(A, jobs[0] ? jobs[0] : 'A', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::geqrf>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[1])});
+                auto tau = query_vector<T>::from_shape({std::max(std::min(A.shape()[0], A.shape()[1]), std::size_t(1))});
+                geqrf(A, tau, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::orgqr>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[1])});
+                auto tau = query_vector<T>::from_shape({query_dim(dims[2])});
+                orgqr(A, tau, dims[1], ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::ungqr>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[1])});
+                auto tau = query_vector<T>::from_shape({query_dim(dims[2])});
+                ungqr(A, tau, dims[1], ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::ormqr>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                char side = jobs[0] ? jobs[0] : 'L';
+                std::size_t m = query_dim(dims[0]), n = query_dim(dims[1]), k = query_dim(dims[2]);
+                auto A = query_matrix<T>::from_shape({side == 'L' ? m : n, k});
+                auto tau = query_vector<T>::from_shape({k});
+                auto C = query_matrix<T>::from_shape({m, n});
+                ormqr(A, tau, C, side, jobs[1] ? jobs[1] : 'T', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::unmqr> : workspace_query<routine::ormqr>
+        {
+        };
+
+        template <>
+        struct workspace_query<routine::gehrd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto tau = query_vector<T>::from_shape({std::max(n, std::size_t(2)) - 1});
+                gehrd(A, tau, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::ormhr>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t m = query_dim(dims[0]), n = query_dim(dims[1]), nq = query_dim(dims[2]);
+                auto A = query_matrix<T>::from_shape({nq, nq});
+                auto tau = query_vector<T>::from_shape({std::max(nq, std::size_t(2)) - 1});
+                auto C = query_matrix<T>::from_shape({m, n});
+                ormhr(A, tau, C, jobs[0] ? jobs[0] : 'L', jobs[1] ? jobs[1] : 'T', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::unmhr> : workspace_query<routine::ormhr>
+        {
+        };
+
+        template <>
+        struct workspace_query<routine::sytrd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto d = query_vector<xtl::complex_value_type_t<T>>::from_shape({std::max(n, std::size_t(1))});
+                auto e = query_vector<xtl::complex_value_type_t<T>>::from_shape({std::max(n, std::size_t(1))});
+                auto tau = query_vector<T>::from_shape({std::max(n, std::size_t(1))});
+                sytrd(A, d, e, tau, jobs[0] ? jobs[0] : 'L', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::hetrd> : workspace_query<routine::sytrd>
+        {
+        };
+
+        template <>
+        struct workspace_query<routine::ormtr>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t m = query_dim(dims[0]), n = query_dim(dims[1]);
+                char side = jobs[0] ? jobs[0] : 'L';
+                std::size_t nq = side == 'L' ? m : n;
+                auto A = query_matrix<T>::from_shape({nq, nq});
+                auto tau = query_vector<T>::from_shape({std::max(nq, std::size_t(2)) - 1});
+                auto C = query_matrix<T>::from_shape({m, n});
+                ormtr(A, tau, C, side, jobs[1] ? jobs[1] : 'L', jobs[2] ? jobs[2] : 'T', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::unmtr> : workspace_query<routine::ormtr>
+        {
+        };
+
+        template <>
+        struct workspace_query<routine::larfb>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t m = query_dim(dims[0]), n = query_dim(dims[1]), k = query_dim(dims[2]);
+                char side = jobs[0] ? jobs[0] : 'L';
+                auto V = query_matrix<T>::from_shape({side == 'L' ? m : n, k});
+                auto Tk = query_matrix<T>::from_shape({k, k});
+                auto C = query_matrix<T>::from_shape({m, n});
+                larfb(V, Tk, C, side, 'N', 'F', 'C', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::stedc>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto d = query_vector<T>::from_shape({n});
+                auto e = query_vector<T>::from_shape({std::max(n, std::size_t(1))});
+                auto Z = query_matrix<T>::from_shape({std::max(n, std::size_t(1)), std::max(n, std::size_t(1))});
+                stedc(jobs[0] ? jobs[0] : 'I', d, e, Z, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::stevr>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto d = query_vector<T>::from_shape({n});
+                auto e = query_vector<T>::from_shape({std::max(n, std::size_t(1))});
+                auto w = query_vector<T>::from_shape({std::max(n, std::size_t(1))});
+                auto Z = query_matrix<T>::from_shape({std::max(n, std::size_t(1)), std::max(n, std::size_t(1))});
+                blas_index_t m = 0;
+                stevr(d, e, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'A', T(0), T(0), 1, 1, m, w, Z, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::bdsqr>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                auto d = query_vector<xtl::complex_value_type_t<T>>::from_shape({query_dim(dims[0])});
+                auto e = query_vector<xtl::complex_value_type_t<T>>::from_shape({query_dim(dims[0])});
+                auto empty = query_matrix<T>::from_shape({0, 0});
+                bdsqr('U', d, e, empty, empty, empty, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::bdsdc>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto d = query_vector<T>::from_shape({n});
+                auto e = query_vector<T>::from_shape({n});
+                auto U = query_matrix<T>::from_shape({n, n});
+                auto VT = query_matrix<T>::from_shape({n, n});
+                bdsdc('U', jobs[0] ? jobs[0] : 'I', d, e, U, VT, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::gelsd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                std::size_t m = query_dim(dims[0]), n = query_dim(dims[1]);
+                std::size_t nrhs = std::max(query_dim(dims[2]), std::size_t(1));
+                auto A = query_matrix<T>::from_shape({m, n});
+                auto b = query_matrix<T>::from_shape({std::max(std::max(m, n), std::size_t(1)), nrhs});
+                auto s = query_vector<xtl::complex_value_type_t<T>>::from_shape({std::max(std::min(m, n), std::size_t(1))});
+                blas_index_t rank;
+                gelsd(A, b, s, rank, -1., ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::syevd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto w = query_vector<T>::from_shape({query_dim(dims[0])});
+                syevd(A, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'L', w, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::syev>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto w = query_vector<T>::from_shape({query_dim(dims[0])});
+                syev(A, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'L', w, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::heev>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto w = query_vector<xtl::complex_value_type_t<T>>::from_shape({query_dim(dims[0])});
+                heev(A, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'L', w, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::heevd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto w = query_vector<xtl::complex_value_type_t<T>>::from_shape({query_dim(dims[0])});
+                heevd(A, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'L', w, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::geev>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                run_impl<T>(query_dim(dims[0]), jobs[0] ? jobs[0] : 'N', jobs[1] ? jobs[1] : 'V', ws,
+                            xtl::is_complex<T>());
+            }
+
+            template <class T, class W>
+            static void run_impl(std::size_t n, char jobvl, char jobvr, W& ws, std::false_type)
+            {
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto wr = query_vector<T>::from_shape({n});
+                auto wi = query_vector<T>::from_shape({n});
+                auto VL = query_matrix<T>::from_shape({n, n});
+                auto VR = query_matrix<T>::from_shape({n, n});
+                geev(A, jobvl, jobvr, wr, wi, VL, VR, ws);
+            }
+
+            template <class T, class W>
+            static void run_impl(std::size_t n, char jobvl, char jobvr, W& ws, std::true_type)
+            {
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto w = query_vector<T>::from_shape({n});
+                auto VL = query_matrix<T>::from_shape({n, n});
+                auto VR = query_matrix<T>::from_shape({n, n});
+                geev(A, jobvl, jobvr, w, VL, VR, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::geevx>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                using real_type = xtl::complex_value_type_t<T>;
+                std::size_t n = query_dim(dims[0]);
+                char jobvl = jobs[0] ? jobs[0] : 'N';
+                char jobvr = jobs[1] ? jobs[1] : 'V';
+                std::size_t nl = jobvl == 'V' ? n : 1;
+                std::size_t nr = jobvr == 'V' ? n : 1;
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto VL = query_matrix<T>::from_shape({nl, nl});
+                auto VR = query_matrix<T>::from_shape({nr, nr});
+                auto scale = query_vector<real_type>::from_shape({std::max(n, std::size_t(1))});
+                auto rconde = query_vector<real_type>::from_shape({std::max(n, std::size_t(1))});
+                auto rcondv = query_vector<real_type>::from_shape({std::max(n, std::size_t(1))});
+                blas_index_t ilo = 0, ihi = 0;
+                real_type abnrm = 0;
+                run_impl<T>(A, jobvl, jobvr, jobs[2] ? jobs[2] : 'N', VL, VR, ilo, ihi, scale, abnrm, rconde, rcondv,
+                            ws, xtl::is_complex<T>());
+            }
+
+            template <class T, class M, class R, class S, class W>
+            static void run_impl(M& A, char jobvl, char jobvr, char sense, M& VL, M& VR, blas_index_t& ilo,
+                                 blas_index_t& ihi, R& scale, S& abnrm, R& rconde, R& rcondv, W& ws, std::false_type)
+            {
+                auto wr = query_vector<T>::from_shape({A.shape()[0]});
+                auto wi = query_vector<T>::from_shape({A.shape()[0]});
+                geevx(A, 'B', jobvl, jobvr, sense, wr, wi, VL, VR, ilo, ihi, scale, abnrm, rconde, rcondv, ws);
+            }
+
+            template <class T, class M, class R, class S, class W>
+            static void run_impl(M& A, char jobvl, char jobvr, char sense, M& VL, M& VR, blas_index_t& ilo,
+                                 blas_index_t& ihi, R& scale, S& abnrm, R& rconde, R& rcondv, W& ws, std::true_type)
+            {
+                auto w = query_vector<T>::from_shape({A.shape()[0]});
+                geevx(A, 'B', jobvl, jobvr, sense, w, VL, VR, ilo, ihi, scale, abnrm, rconde, rcondv, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::sytrf>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                uvector<blas_index_t> piv(std::max(n, std::size_t(1)));
+                sytrf(A, piv, jobs[0] ? jobs[0] : 'L', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::hetrf>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                uvector<blas_index_t> piv(std::max(n, std::size_t(1)));
+                hetrf(A, piv, jobs[0] ? jobs[0] : 'L', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::getri>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                uvector<blas_index_t> piv(std::max(A.shape()[0], std::size_t(1)));
+                getri(A, piv, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::sysv>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto b = query_vector<T>::from_shape({query_dim(dims[0])});
+                uvector<blas_index_t> piv(std::max(A.shape()[0], std::size_t(1)));
+                sysv(A, piv, b, jobs[0] ? jobs[0] : 'L', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::hesv>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto b = query_vector<T>::from_shape({query_dim(dims[0])});
+                uvector<blas_index_t> piv(std::max(A.shape()[0], std::size_t(1)));
+                hesv(A, piv, b, jobs[0] ? jobs[0] : 'L', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::syevr>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto w = query_vector<xtl::complex_value_type_t<T>>::from_shape({std::max(n, std::size_t(1))});
+                auto z = query_matrix<T>::from_shape({std::max(n, std::size_t(1)), std::max(n, std::size_t(1))});
+                blas_index_t m = 0;
+                run_impl(A, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'A', jobs[2] ? jobs[2] : 'L',
+                         to_blas_index(n), m, w, z, ws, xtl::is_complex<T>());
+            }
+
+            template <class M, class V, class Z, class W>
+            static void run_impl(M& A, char jobz, char range, char uplo, blas_index_t n, blas_index_t& m,
+                                 V& w, Z& z, W& ws, std::false_type)
+            {
+                syevr(A, jobz, range, uplo, 0, 1, 1, n, m, w, z, ws);
+            }
+
+            template <class M, class V, class Z, class W>
+            static void run_impl(M& A, char jobz, char range, char uplo, blas_index_t n, blas_index_t& m,
+                                 V& w, Z& z, W& ws, std::true_type)
+            {
+                heevr(A, jobz, range, uplo, 0, 1, 1, n, m, w, z, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::heevr> : workspace_query<routine::syevr>
+        {
+        };
+
+        template <>
+        struct workspace_query<routine::gees>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto VS = query_matrix<T>::from_shape({std::max(n, std::size_t(1)), std::max(n, std::size_t(1))});
+                blas_index_t sdim = 0;
+                run_impl<T>(A, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'N', sdim, VS, ws, xtl::is_complex<T>());
+            }
+
+            template <class T, class M, class V, class W>
+            static void run_impl(M& A, char jobvs, char sort, blas_index_t& sdim, V& VS, W& ws, std::false_type)
+            {
+                auto wr = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                auto wi = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                blas_index_t (*select)(const T*, const T*) = nullptr;
+                gees(A, jobvs, sort, select, sdim, wr, wi, VS, ws);
+            }
+
+            template <class T, class M, class V, class W>
+            static void run_impl(M& A, char jobvs, char sort, blas_index_t& sdim, V& VS, W& ws, std::true_type)
+            {
+                auto w = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                blas_index_t (*select)(const T*) = nullptr;
+                gees(A, jobvs, sort, select, sdim, w, VS, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::gesvd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[1])});
+                gesvd(A, jobs[0] ? jobs[0] : 'A', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::gesvj>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[1])});
+                gesvj(A, jobs[0] ? jobs[0] : 'U', jobs[1] ? jobs[1] : 'V', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::gejsv>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[1])});
+                gejsv(A, jobs[0] ? jobs[0] : 'U', jobs[1] ? jobs[1] : 'V', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::geqp3>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[1])});
+                uvector<blas_index_t> jpvt(std::max(A.shape()[1], std::size_t(1)), 0);
+                auto tau = query_vector<T>::from_shape({std::max(std::min(A.shape()[0], A.shape()[1]), std::size_t(1))});
+                geqp3(A, jpvt, tau, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::gelsy>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                std::size_t m = query_dim(dims[0]), n = query_dim(dims[1]);
+                std::size_t nrhs = std::max(query_dim(dims[2]), std::size_t(1));
+                auto A = query_matrix<T>::from_shape({m, n});
+                auto b = query_matrix<T>::from_shape({std::max(std::max(m, n), std::size_t(1)), nrhs});
+                uvector<blas_index_t> jpvt(std::max(n, std::size_t(1)), 0);
+                blas_index_t rank;
+                gelsy(A, b, jpvt, rank, -1., ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::gelss>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                std::size_t m = query_dim(dims[0]), n = query_dim(dims[1]);
+                std::size_t nrhs = std::max(query_dim(dims[2]), std::size_t(1));
+                auto A = query_matrix<T>::from_shape({m, n});
+                auto b = query_matrix<T>::from_shape({std::max(std::max(m, n), std::size_t(1)), nrhs});
+                auto s = query_vector<xtl::complex_value_type_t<T>>::from_shape({std::max(std::min(m, n), std::size_t(1))});
+                blas_index_t rank;
+                gelss(A, b, s, rank, -1., ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::gels>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t m = query_dim(dims[0]), n = query_dim(dims[1]);
+                std::size_t nrhs = std::max(query_dim(dims[2]), std::size_t(1));
+                auto A = query_matrix<T>::from_shape({m, n});
+                auto b = query_matrix<T>::from_shape({std::max(std::max(m, n), std::size_t(1)), nrhs});
+                gels(A, b, jobs[0] ? jobs[0] : 'N', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::sygvd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto B = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto w = query_vector<T>::from_shape({query_dim(dims[0])});
+                sygvd(A, B, dims[1] ? dims[1] : 1, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'L', w, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::hegvd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                auto A = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto B = query_matrix<T>::from_shape({query_dim(dims[0]), query_dim(dims[0])});
+                auto w = query_vector<xtl::complex_value_type_t<T>>::from_shape({query_dim(dims[0])});
+                hegvd(A, B, dims[1] ? dims[1] : 1, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'L', w, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::sygvx>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto B = query_matrix<T>::from_shape({n, n});
+                auto w = query_vector<xtl::complex_value_type_t<T>>::from_shape({std::max(n, std::size_t(1))});
+                auto z = query_matrix<T>::from_shape({std::max(n, std::size_t(1)), std::max(n, std::size_t(1))});
+                blas_index_t m = 0;
+                run_impl(A, B, dims[1] ? dims[1] : 1, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'A',
+                         jobs[2] ? jobs[2] : 'L', to_blas_index(n), m, w, z, ws, xtl::is_complex<T>());
+            }
+
+            template <class M, class V, class Z, class W>
+            static void run_impl(M& A, M& B, blas_index_t itype, char jobz, char range, char uplo, blas_index_t n,
+                                 blas_index_t& m, V& w, Z& z, W& ws, std::false_type)
+            {
+                sygvx(A, B, itype, jobz, range, uplo, 0, 1, 1, n, m, w, z, ws);
+            }
+
+            template <class M, class V, class Z, class W>
+            static void run_impl(M& A, M& B, blas_index_t itype, char jobz, char range, char uplo, blas_index_t n,
+                                 blas_index_t& m, V& w, Z& z, W& ws, std::true_type)
+            {
+                hegvx(A, B, itype, jobz, range, uplo, 0, 1, 1, n, m, w, z, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::hegvx> : workspace_query<routine::sygvx>
+        {
+        };
+
+        template <>
+        struct workspace_query<routine::ggev>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                std::size_t len = std::max(n, std::size_t(1));
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto B = query_matrix<T>::from_shape({n, n});
+                auto VL = query_matrix<T>::from_shape({len, len});
+                auto VR = query_matrix<T>::from_shape({len, len});
+                run_impl<T>(A, B, jobs[0] ? jobs[0] : 'N', jobs[1] ? jobs[1] : 'V', VL, VR, ws, xtl::is_complex<T>());
+            }
+
+            template <class T, class M, class V, class W>
+            static void run_impl(M& A, M& B, char jobvl, char jobvr, V& VL, V& VR, W& ws, std::false_type)
+            {
+                auto alphar = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                auto alphai = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                auto beta = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                ggev(A, B, jobvl, jobvr, alphar, alphai, beta, VL, VR, ws);
+            }
+
+            template <class T, class M, class V, class W>
+            static void run_impl(M& A, M& B, char jobvl, char jobvr, V& VL, V& VR, W& ws, std::true_type)
+            {
+                auto alpha = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                auto beta = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                ggev(A, B, jobvl, jobvr, alpha, beta, VL, VR, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::gges>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                std::size_t len = std::max(n, std::size_t(1));
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto B = query_matrix<T>::from_shape({n, n});
+                auto VSL = query_matrix<T>::from_shape({len, len});
+                auto VSR = query_matrix<T>::from_shape({len, len});
+                blas_index_t sdim = 0;
+                run_impl<T>(A, B, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'V', jobs[2] ? jobs[2] : 'N',
+                            sdim, VSL, VSR, ws, xtl::is_complex<T>());
+            }
+
+            template <class T, class M, class V, class W>
+            static void run_impl(M& A, M& B, char jobvsl, char jobvsr, char sort, blas_index_t& sdim,
+                                 V& VSL, V& VSR, W& ws, std::false_type)
+            {
+                auto alphar = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                auto alphai = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                auto beta = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                blas_index_t (*select)(const T*, const T*, const T*) = nullptr;
+                gges(A, B, jobvsl, jobvsr, sort, select, sdim, alphar, alphai, beta, VSL, VSR, ws);
+            }
+
+            template <class T, class M, class V, class W>
+            static void run_impl(M& A, M& B, char jobvsl, char jobvsr, char sort, blas_index_t& sdim,
+                                 V& VSL, V& VSR, W& ws, std::true_type)
+            {
+                auto alpha = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                auto beta = query_vector<T>::from_shape({std::max(A.shape()[0], std::size_t(1))});
+                blas_index_t (*select)(const T*, const T*) = nullptr;
+                gges(A, B, jobvsl, jobvsr, sort, select, sdim, alpha, beta, VSL, VSR, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::pstrf>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto piv = query_vector<blas_index_t>::from_shape({n});
+                blas_index_t rank = 0;
+                pstrf(A, piv, rank, -1, 'L', ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::trsen>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto Q = query_matrix<T>::from_shape({n, n});
+                auto select = query_vector<blas_index_t>::from_shape({n});
+                blas_index_t m = 0;
+                run_impl<T>(jobs[0] ? jobs[0] : 'N', select, A, Q, m, ws, xtl::is_complex<T>());
+            }
+
+            template <class T, class L, class M, class W>
+            static void run_impl(char job, L& select, M& A, M& Q, blas_index_t& m, W& ws, std::false_type)
+            {
+                auto wr = query_vector<T>::from_shape({A.shape()[0]});
+                auto wi = query_vector<T>::from_shape({A.shape()[0]});
+                T s, sep;
+                trsen(job, 'V', select, A, Q, wr, wi, m, s, sep, ws);
+            }
+
+            template <class T, class L, class M, class W>
+            static void run_impl(char job, L& select, M& A, M& Q, blas_index_t& m, W& ws, std::true_type)
+            {
+                auto w = query_vector<T>::from_shape({A.shape()[0]});
+                xtl::complex_value_type_t<T> s, sep;
+                trsen(job, 'V', select, A, Q, w, m, s, sep, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::tgsen>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs&, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto A = query_matrix<T>::from_shape({n, n});
+                auto B = query_matrix<T>::from_shape({n, n});
+                auto Q = query_matrix<T>::from_shape({n, n});
+                auto Z = query_matrix<T>::from_shape({n, n});
+                auto select = query_vector<blas_index_t>::from_shape({n});
+                auto dif = query_vector<xtl::complex_value_type_t<T>>::from_shape({2});
+                blas_index_t m = 0;
+                run_impl<T>(dims[1], select, A, B, Q, Z, m, dif, ws, xtl::is_complex<T>());
+            }
+
+            template <class T, class L, class M, class D, class W>
+            static void run_impl(blas_index_t ijob, L& select, M& A, M& B, M& Q, M& Z, blas_index_t& m,
+                                 D& dif, W& ws, std::false_type)
+            {
+                auto alphar = query_vector<T>::from_shape({A.shape()[0]});
+                auto alphai = query_vector<T>::from_shape({A.shape()[0]});
+                auto beta = query_vector<T>::from_shape({A.shape()[0]});
+                T pl, pr;
+                tgsen(ijob, true, true, select, A, B, alphar, alphai, beta, Q, Z, m, pl, pr, dif, ws);
+            }
+
+            template <class T, class L, class M, class D, class W>
+            static void run_impl(blas_index_t ijob, L& select, M& A, M& B, M& Q, M& Z, blas_index_t& m,
+                                 D& dif, W& ws, std::true_type)
+            {
+                auto alpha = query_vector<T>::from_shape({A.shape()[0]});
+                auto beta = query_vector<T>::from_shape({A.shape()[0]});
+                xtl::complex_value_type_t<T> pl, pr;
+                tgsen(ijob, true, true, select, A, B, alpha, beta, Q, Z, m, pl, pr, dif, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::spevd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto AP = query_vector<T>::from_shape({n * (n + 1) / 2});
+                auto w = query_vector<xtl::complex_value_type_t<T>>::from_shape({n});
+                auto Z = query_matrix<T>::from_shape({std::max(n, std::size_t(1)), n});
+                spevd(AP, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'L', w, Z, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::hpevd>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto AP = query_vector<T>::from_shape({n * (n + 1) / 2});
+                auto w = query_vector<xtl::complex_value_type_t<T>>::from_shape({n});
+                auto Z = query_matrix<T>::from_shape({std::max(n, std::size_t(1)), n});
+                hpevd(AP, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'L', w, Z, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::spevx>
+        {
+            template <class T, class W>
+            static void run(const workspace_dims& dims, const workspace_jobs& jobs, W& ws)
+            {
+                std::size_t n = query_dim(dims[0]);
+                auto AP = query_vector<T>::from_shape({n * (n + 1) / 2});
+                auto w = query_vector<xtl::complex_value_type_t<T>>::from_shape({std::max(n, std::size_t(1))});
+                auto Z = query_matrix<T>::from_shape({std::max(n, std::size_t(1)), std::max(n, std::size_t(1))});
+                blas_index_t m = 0;
+                run_impl(AP, jobs[0] ? jobs[0] : 'V', jobs[1] ? jobs[1] : 'A', m, w, Z, ws, xtl::is_complex<T>());
+            }
+
+            template <class P, class V, class Z, class W>
+            static void run_impl(P& AP, char jobz, char range, blas_index_t& m, V& w, Z& z, W& ws, std::false_type)
+            {
+                spevx(AP, jobz, range, 'L', 0, 1, 1, 1, m, w, z, ws);
+            }
+
+            template <class P, class V, class Z, class W>
+            static void run_impl(P& AP, char jobz, char range, blas_index_t& m, V& w, Z& z, W& ws, std::true_type)
+            {
+                hpevx(AP, jobz, range, 'L', 0, 1, 1, 1, m, w, z, ws);
+            }
+        };
+
+        template <>
+        struct workspace_query<routine::hpevx> : workspace_query<routine::spevx>
+        {
+        };
+    }
 }
 
 }
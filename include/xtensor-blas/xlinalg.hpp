@@ -11,17 +11,35 @@
 #define XLINALG_HPP
 
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
 #include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
 #include <sstream>
+#include <string>
+#include <tuple>
 #include <chrono>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <vector>
 
 #include "xtl/xcomplex.hpp"
+#include "xtl/xsequence.hpp"
 
+#include "xtensor/xadapt.hpp"
 #include "xtensor/xarray.hpp"
 #include "xtensor/xcomplex.hpp"
 #include "xtensor/xeval.hpp"
+#include "xtensor/xfixed.hpp"
 #include "xtensor/xio.hpp"
 #include "xtensor/xmanipulation.hpp"
+#include "xtensor/xnoalias.hpp"
+#include "xtensor/xshape.hpp"
 #include "xtensor/xstrided_view.hpp"
 #include "xtensor/xtensor.hpp"
 #include "xtensor/xutils.hpp"
@@ -44,9 +62,145 @@ namespace linalg
         neg_inf  ///< Negative infinity norm
     };
 
+    /// Selects the precision of the factorization used by the solvers
+    enum class solve_mode {
+        full_precision,  ///< Factor and solve in the precision of the operands
+        mixed_precision  ///< Factor in single precision and refine to double
+    };
+
+    /// Selects the structure solve assumes for the coefficient matrix
+    enum class assume_a {
+        general,            ///< LU factorization (gesv)
+        symmetric,          ///< Symmetric indefinite factorization (sysv)
+        hermitian,          ///< Hermitian indefinite factorization (hesv)
+        positive_definite,  ///< Cholesky factorization (posv)
+        lower_triangular,   ///< Triangular solve (trtrs)
+        upper_triangular,   ///< Triangular solve (trtrs)
+        detect              ///< Choose one of the above with detect_structure
+    };
+
+    /**
+     * Tag selecting the container type \em R in which dot, matmul, solve and
+     * inv construct their result, e.g. an xtensor with a pool allocator or
+     * an xtensor-python pytensor: ``dot(a, b, result_as<R>())`` allocates an
+     * \em R once and lets BLAS or LAPACK write into it, where assigning the
+     * returned xarray or xtensor to an \em R would copy it. \em R must hold
+     * the value type of the result and have its rank, if fixed.
+     */
+    template <class R>
+    struct result_as
+    {
+    };
+
+    namespace detail
+    {
+        template <class R, class S>
+        inline R make_result(const S& shape)
+        {
+            using shape_type = typename R::shape_type;
+            using size_type = typename shape_type::value_type;
+            auto result_shape = xtl::make_sequence<shape_type>(shape.size(), size_type(0));
+            if (result_shape.size() != shape.size())
+            {
+                XTENSOR_THROW(std::runtime_error, "result_as: the container does not have the rank of the result.");
+            }
+            std::transform(shape.begin(), shape.end(), result_shape.begin(),
+                           [](std::size_t extent) { return static_cast<size_type>(extent); });
+            return R::from_shape(result_shape);
+        }
+    }
+
+    namespace detail
+    {
+        template <class R, class E>
+        inline R vector_max_abs(const E& v, std::false_type /*is_complex*/)
+        {
+            if (v.size() == 0)
+            {
+                return R(0);
+            }
+            std::size_t i;
+            blas::iamax(v, i);
+            return static_cast<R>(std::abs(v(i)));
+        }
+
+        // iamax picks by |re| + |im| for complex values
+        template <class R, class E>
+        inline R vector_max_abs(const E& v, std::true_type /*is_complex*/)
+        {
+            R result(0);
+            for (std::size_t i = 0; i < v.size(); ++i)
+            {
+                result = std::max(result, static_cast<R>(std::abs(v(i))));
+            }
+            return result;
+        }
+
+        template <class R, class E>
+        inline R vector_min_abs(const E& v)
+        {
+            R result(0);
+            for (std::size_t i = 0; i < v.size(); ++i)
+            {
+                R a = static_cast<R>(std::abs(v(i)));
+                result = i == 0 ? a : std::min(result, a);
+            }
+            return result;
+        }
+
+        /**
+         * Smallest sum of absolute values over the columns (\em axis = 0)
+         * or the rows (\em axis = 1) of the matrix \em v, accumulated one
+         * line at a time. LAPACK has no routine for it.
+         */
+        template <class R, class E>
+        inline R min_abs_sum(const E& v, std::size_t axis)
+        {
+            std::size_t lines = v.shape()[1 - axis];
+            std::size_t len = v.shape()[axis];
+            R result(0);
+            for (std::size_t l = 0; l < lines; ++l)
+            {
+                R line(0);
+                for (std::size_t k = 0; k < len; ++k)
+                {
+                    line += static_cast<R>(std::abs(axis == 0 ? v(k, l) : v(l, k)));
+                }
+                result = l == 0 ? line : std::min(result, line);
+            }
+            return result;
+        }
+
+        // singular values only, in decreasing order: gesdd with jobz 'N'
+        // into min(m, n) elements, without containers for U and Vt
+        template <class T, class S>
+        inline void singular_values_inplace(T& A, S& s)
+        {
+            if (lapack::gesdd(A, s) > 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "SVD decomposition failed.");
+            }
+        }
+
+        template <class E>
+        inline auto matrix_singular_values(const E& v)
+        {
+            using real_type = xtl::complex_value_type_t<typename E::value_type>;
+            using vector_type = xtensor<real_type, 1, layout_type::column_major>;
+            auto M = copy_to_layout<layout_type::column_major>(v);
+            vector_type s = vector_type::from_shape({std::min(M.shape()[0], M.shape()[1])});
+            singular_values_inplace(M, s);
+            return s;
+        }
+    }
+
     /**
      * Calculate norm of vector, or matrix
      *
+     * The 1- and 2-norms of vectors are computed by BLAS asum and nrm2,
+     * the 1-norm and infinity-norm of matrices by LAPACK lange, and the
+     * matrix 2-norms from the singular values alone.
+     *
      * @param vec input vector
      * @param ord order of norm. This can be any integer for a vector
      *            or [-2,-1,1,2] for a matrix.
@@ -67,6 +221,7 @@ namespace linalg
         {
             if (ord == 1)
             {
+                // asum adds |re| + |im| for complex values
                 if (xtl::is_complex<value_type>::value)
                 {
                     for (std::size_t i = 0; i < v.size(); ++i)
@@ -94,7 +249,7 @@ namespace linalg
             {
                 for (std::size_t i = 0; i < v.size(); ++i)
                 {
-                    result += std::abs(std::pow(v(i), ord));
+                    result += std::pow(std::abs(v(i)), ord);
                 }
                 result = std::pow(result, 1. / static_cast<double>(ord));
             }
@@ -102,31 +257,22 @@ namespace linalg
         }
         else if (v.dimension() == 2)
         {
-            if (ord == 1 || ord == -1)
+            if (ord == 1)
             {
-                xtensor<underlying_value_type, 1> s = sum(abs(v), {0});
-                if (ord == 1)
-                {
-                    return *std::max_element(s.begin(), s.end());
-                }
-                else
-                {
-                    return *std::min_element(s.begin(), s.end());
-                }
+                return static_cast<underlying_value_type>(lapack::lange(v, '1'));
+            }
+            if (ord == -1)
+            {
+                return detail::min_abs_sum<underlying_value_type>(v, 0);
             }
             if (ord == 2 || ord == -2)
             {
-                auto M = copy_to_layout<layout_type::column_major>(v);
-                auto gesdd_res = lapack::gesdd(M, 'N');
-                auto& s = std::get<2>(gesdd_res);
-                if (ord == 2)
-                {
-                    return *std::max_element(s.begin(), s.end());
-                }
-                else
+                auto s = detail::matrix_singular_values(v);
+                if (s.size() == 0)
                 {
-                    return *std::min_element(s.begin(), s.end());
+                    return underlying_value_type(0);
                 }
+                return ord == 2 ? s(0) : s(s.size() - 1);
             }
         }
         std::stringstream ss;
@@ -137,6 +283,10 @@ namespace linalg
     /**
      * Calculate matrix or vector norm using \ref normorder.
      *
+     * The Frobenius and infinity-norms of matrices are computed by LAPACK
+     * lange, without overflow in the sum of squares, and the nuclear norm
+     * from the singular values alone.
+     *
      * @param vec The matrix or vector to take the norm of
      * @param ord normorder (frob, nuc, inf, neg_inf)
      *
@@ -146,47 +296,37 @@ namespace linalg
     auto norm(const xexpression<E>& vec, normorder ord)
     {
         using value_type = xtl::complex_value_type_t<typename E::value_type>;
-
+    
         const auto& v = vec.derived_cast();
         if (v.dimension() == 2)
         {
             if (ord == normorder::frob)
             {
-                return static_cast<value_type>(std::sqrt(sum(pow(abs(v), 2))()));
+                return static_cast<value_type>(lapack::lange(v, 'F'));
             }
             if (ord == normorder::nuc)
             {
-                auto M = copy_to_layout<layout_type::column_major>(v);
-                auto gesdd_res = lapack::gesdd(M, 'N');
-                auto& s = std::get<2>(gesdd_res);
+                auto s = detail::matrix_singular_values(v);
                 return std::accumulate(s.begin(), s.end(), value_type(0));
             }
-            if (ord == normorder::inf || ord == normorder::neg_inf)
+            if (ord == normorder::inf)
             {
-                xtensor<value_type, 1> s = xt::sum(abs(v), {1});
-                if (ord == normorder::inf)
-                {
-                    return *std::max_element(s.begin(), s.end());
-                }
-                else
-                {
-                    return *std::min_element(s.begin(), s.end());
-                }
+                return static_cast<value_type>(lapack::lange(v, 'I'));
+            }
+            if (ord == normorder::neg_inf)
+            {
+                return detail::min_abs_sum<value_type>(v, 1);
             }
         }
         else if (v.dimension() == 1)
         {
-            if (ord == normorder::inf || ord == normorder::neg_inf)
+            if (ord == normorder::inf)
             {
-                auto s = abs(v);
-                if (ord == normorder::inf)
-                {
-                    return *std::max_element(s.begin(), s.end());
-                }
-                else
-                {
-                    return *std::min_element(s.begin(), s.end());
-                }
+                return detail::vector_max_abs<value_type>(v, xtl::is_complex<typename E::value_type>());
+            }
+            if (ord == normorder::neg_inf)
+            {
+                return detail::vector_min_abs<value_type>(v);
             }
         }
         std::stringstream ss;
@@ -214,1630 +354,17978 @@ namespace linalg
         }
     }
 
-    /**
-     * Solve a linear matrix equation, or system of linear scalar equations.
-     * Computes the “exact” solution, x, of the well-determined, i.e., full rank,
-     * linear matrix equation ax = b.
-     *
-     * @param a Coefficient matrix
-     * @param b Ordinate or “dependent variable” values.
-     * @return Solution to the system a x = b. Returned shape is identical to b.
-     */
-    template <class E1, class E2>
-    auto solve(const xexpression<E1>& A, const xexpression<E2>& b)
+    /*******************
+     * axis reductions *
+     *******************/
+
+    namespace detail
     {
-        assert_nd_square(A);
-        auto dA = copy_to_layout<layout_type::column_major>(A.derived_cast());
-        auto db = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        /**
+         * The lines of a matrix along \em axis: line i, element j is at
+         * offset i * line_stride + j * element_stride.
+         */
+        struct matrix_lines
+        {
+            std::size_t lines;
+            std::size_t length;
+            std::ptrdiff_t line_stride;
+            std::ptrdiff_t element_stride;
+        };
 
-        int info = lapack::gesv(dA, db);
+        template <class E>
+        inline matrix_lines get_matrix_lines(const E& m, std::size_t axis, const char* name)
+        {
+            if (m.dimension() != 2 || axis > 1)
+            {
+                std::string message = std::string(name) + ": expected a matrix and an axis of 0 or 1.";
+                XTENSOR_THROW(std::runtime_error, message);
+            }
+            return {m.shape()[1 - axis], m.shape()[axis],
+                    static_cast<std::ptrdiff_t>(m.strides()[1 - axis]), static_cast<std::ptrdiff_t>(m.strides()[axis])};
+        }
 
-        if (info != 0)
+        /**
+         * out(i) = finish(fold_j step(x(i, j), y(i, j))) for the lines of one
+         * or two operands with the same geometry up to their strides.
+         *
+         * Lines with unit element strides are folded one at a time, four
+         * partial results interleaved, and in parallel with OpenMP; when the
+         * lines are contiguous across instead (the reduced axis is the slow
+         * one) the elements are swept in memory order, updating all the
+         * partial results at once, a loop the compiler vectorizes.
+         */
+        template <class R, class Op, class X, class Y>
+        inline void fold_lines(const matrix_lines& gx, const X* x, const matrix_lines& gy, const Y* y, R* out, Op op)
         {
-            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+            std::size_t lines = gx.lines, length = gx.length;
+            if (length <= 1 || (gx.element_stride == 1 && gy.element_stride == 1))
+            {
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp parallel for
+#endif
+                for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(lines); ++p)
+                {
+                    const X* xi = x + p * gx.line_stride;
+                    const Y* yi = y + p * gy.line_stride;
+                    R acc[4] = {op.init(), op.init(), op.init(), op.init()};
+                    std::size_t j = 0;
+                    for (; j + 4 <= length; j += 4)
+                    {
+                        acc[0] = op.step(acc[0], xi[j], yi[j]);
+                        acc[1] = op.step(acc[1], xi[j + 1], yi[j + 1]);
+                        acc[2] = op.step(acc[2], xi[j + 2], yi[j + 2]);
+                        acc[3] = op.step(acc[3], xi[j + 3], yi[j + 3]);
+                    }
+                    for (; j < length; ++j)
+                    {
+                        acc[0] = op.step(acc[0], xi[j], yi[j]);
+                    }
+                    out[p] = op.combine(op.combine(acc[0], acc[1]), op.combine(acc[2], acc[3]));
+                }
+            }
+            else if (gx.line_stride == 1 && gy.line_stride == 1)
+            {
+                constexpr std::size_t block = 1024;
+                std::size_t blocks = (lines + block - 1) / block;
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp parallel for
+#endif
+                for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(blocks); ++p)
+                {
+                    std::size_t i0 = static_cast<std::size_t>(p) * block;
+                    std::size_t i1 = std::min(i0 + block, lines);
+                    std::fill(out + i0, out + i1, op.init());
+                    for (std::size_t j = 0; j < length; ++j)
+                    {
+                        const X* xj = x + static_cast<std::ptrdiff_t>(j) * gx.element_stride;
+                        const Y* yj = y + static_cast<std::ptrdiff_t>(j) * gy.element_stride;
+                        for (std::size_t i = i0; i < i1; ++i)
+                        {
+                            out[i] = op.step(out[i], xj[i], yj[i]);
+                        }
+                    }
+                }
+            }
+            else
+            {
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp parallel for
+#endif
+                for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(lines); ++p)
+                {
+                    const X* xi = x + p * gx.line_stride;
+                    const Y* yi = y + p * gy.line_stride;
+                    R acc = op.init();
+                    for (std::size_t j = 0; j < length; ++j)
+                    {
+                        std::ptrdiff_t jj = static_cast<std::ptrdiff_t>(j);
+                        acc = op.step(acc, xi[jj * gx.element_stride], yi[jj * gy.element_stride]);
+                    }
+                    out[p] = acc;
+                }
+            }
+            for (std::size_t i = 0; i < lines; ++i)
+            {
+                out[i] = op.finish(out[i]);
+            }
         }
 
-        return db;
-    }
+        template <class R>
+        struct sum_fold
+        {
+            R init() const { return R(0); }
+            R combine(R a, R b) const { return a + b; }
+            R finish(R a) const { return a; }
+        };
 
-    /**
-     * Compute the (multiplicative) inverse of a matrix.
-     *
-     * @param A xexpression to be inverted
-     * @return (Multiplicative) inverse of the matrix a.
-     */
-    template <class E1>
-    auto inv(const xexpression<E1>& A)
-    {
-        assert_nd_square(A);
-        auto dA = copy_to_layout<layout_type::column_major>(A.derived_cast());
+        template <class R>
+        struct abs_sum_fold : sum_fold<R>
+        {
+            template <class T>
+            R step(R acc, const T& x, const T&) const { return acc + static_cast<R>(std::abs(x)); }
+        };
 
-        uvector<blas_index_t> piv(std::min(dA.shape()[0], dA.shape()[1]));
+        template <class R>
+        struct square_sum_fold : sum_fold<R>
+        {
+            template <class T>
+            R step(R acc, const T& x, const T&) const
+            {
+                R re = static_cast<R>(std::real(x)), im = static_cast<R>(std::imag(x));
+                return acc + re * re + im * im;
+            }
+        };
 
-        // DEV note: numpy uses gesv here, instead of getrf and getri. Might
-        //           be interesting to investigate if there is a perf or accuracy
-        //           difference.
-        int info = lapack::getrf(dA, piv);
-        if (info > 0)
+        template <class R>
+        struct count_nonzero_fold : sum_fold<R>
         {
-            XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (getrf).");
+            template <class T>
+            R step(R acc, const T& x, const T&) const { return acc + R(x != T(0)); }
+        };
+
+        template <class R>
+        struct power_sum_fold : sum_fold<R>
+        {
+            R ord;
+            template <class T>
+            R step(R acc, const T& x, const T&) const { return acc + std::pow(static_cast<R>(std::abs(x)), ord); }
+            R finish(R a) const { return std::pow(a, R(1) / ord); }
+        };
+
+        template <class R>
+        struct max_abs_fold
+        {
+            R init() const { return R(0); }
+            template <class T>
+            R step(R acc, const T& x, const T&) const { return std::max(acc, static_cast<R>(std::abs(x))); }
+            R combine(R a, R b) const { return std::max(a, b); }
+            R finish(R a) const { return a; }
+        };
+
+        template <class R>
+        struct min_abs_fold
+        {
+            R init() const { return std::numeric_limits<R>::infinity(); }
+            template <class T>
+            R step(R acc, const T& x, const T&) const { return std::min(acc, static_cast<R>(std::abs(x))); }
+            R combine(R a, R b) const { return std::min(a, b); }
+            R finish(R a) const { return a; }
+        };
+
+        template <class R>
+        struct product_sum_fold : sum_fold<R>
+        {
+            template <class T, class U>
+            R step(R acc, const T& x, const U& y) const { return acc + static_cast<R>(x) * static_cast<R>(y); }
+        };
+
+        template <class R, class E, class Op>
+        inline auto fold_along(const E& m, std::size_t axis, Op op, const char* name)
+        {
+            matrix_lines g = get_matrix_lines(m, axis, name);
+            using value_type = typename E::value_type;
+            xtensor<R, 1> result = xtensor<R, 1>::from_shape({g.lines});
+            const value_type* data = m.data() + m.data_offset();
+            fold_lines(g, data, g, data, result.data(), op);
+            return result;
         }
 
-        info = lapack::getri(dA, piv);
-        if (info > 0)
+        /**
+         * 2-norms of the lines from their sums of squares; the lines whose
+         * sum overflowed or lost precision to underflow are recomputed by
+         * nrm2, which scales.
+         */
+        template <class E, class R>
+        inline void finish_two_norms(const E& m, std::size_t axis, xtensor<R, 1>& result)
         {
-            XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (getri).");
+            matrix_lines g = get_matrix_lines(m, axis, "norm");
+            const auto* data = m.data() + m.data_offset();
+            for (std::size_t i = 0; i < g.lines; ++i)
+            {
+                R sq = result(i);
+                if (sq >= std::numeric_limits<R>::min() && sq <= std::numeric_limits<R>::max())
+                {
+                    result(i) = std::sqrt(sq);
+                }
+                else
+                {
+                    const auto* line = data + static_cast<std::ptrdiff_t>(i) * g.line_stride;
+                    std::ptrdiff_t inc = g.element_stride;
+                    if (inc < 0)
+                    {
+                        line += static_cast<std::ptrdiff_t>(g.length - 1) * inc;
+                    }
+                    cxxblas::nrm2<blas_index_t>(to_blas_index(g.length), line, to_blas_index(std::size_t(std::abs(inc))),
+                                                result(i));
+                }
+            }
         }
-        return dA;
     }
 
     /**
-     * Calculate the condition number of matrix M
+     * Vector norms of the rows (\em axis = 1) or columns (\em axis = 0) of
+     * the matrix \em A, i.e. \em axis is the one reduced, as in NumPy.
+     *
+     * Each norm is accumulated in a single pass over \em A into the 1-D
+     * result, without the temporaries of ``sum(pow(abs(A), 2), {axis})``:
+     * rows of a row-major matrix are folded one by one, in parallel with
+     * OpenMP, and a matrix whose reduced axis is the slow one is swept in
+     * memory order. The 2-norms come from the sums of squares, and only the
+     * lines whose sum overflows or underflows are recomputed with nrm2.
+     *
+     * @param A matrix
+     * @param ord order of the vector norm: 1, 2, 0 (number of nonzeros) or
+     *            any other positive integer
+     * @param axis axis along which the norms are taken
+     * @return vector of the norms, of A.shape()[1 - axis] elements
      */
     template <class E>
-    auto cond(const xexpression<E>& M, int ord)
+    auto norm(const xexpression<E>& A, int ord, std::size_t axis)
     {
-        return norm(M, ord) * norm(inv(M), ord);
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+
+        auto&& m = view_eval<E::static_layout>(A.derived_cast());
+        switch (ord)
+        {
+            case 1:
+                return detail::fold_along<real_type>(m, axis, detail::abs_sum_fold<real_type>(), "norm");
+            case 2:
+            {
+                auto result = detail::fold_along<real_type>(m, axis, detail::square_sum_fold<real_type>(), "norm");
+                detail::finish_two_norms(m, axis, result);
+                return result;
+            }
+            case 0:
+                return detail::fold_along<real_type>(m, axis, detail::count_nonzero_fold<real_type>(), "norm");
+            default:
+                if (ord < 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "norm: negative orders are not implemented along an axis.");
+                }
+                detail::power_sum_fold<real_type> op;
+                op.ord = real_type(ord);
+                return detail::fold_along<real_type>(m, axis, op, "norm");
+        }
     }
 
+    /**
+     * Infinity and negative infinity norms, the largest and smallest
+     * absolute values, of the rows (\em axis = 1) or columns (\em axis = 0)
+     * of the matrix \em A, in a single pass.
+     *
+     * @param A matrix
+     * @param ord normorder::inf or normorder::neg_inf
+     * @param axis axis along which the norms are taken
+     * @return vector of the norms, of A.shape()[1 - axis] elements
+     */
     template <class E>
-    auto cond(const xexpression<E>& M, normorder ord)
+    auto norm(const xexpression<E>& A, normorder ord, std::size_t axis)
     {
-        return norm(M, ord) * norm(inv(M), ord);
+        using real_type = xtl::complex_value_type_t<typename E::value_type>;
+
+        auto&& m = view_eval<E::static_layout>(A.derived_cast());
+        if (ord == normorder::inf)
+        {
+            return detail::fold_along<real_type>(m, axis, detail::max_abs_fold<real_type>(), "norm");
+        }
+        if (ord == normorder::neg_inf)
+        {
+            return detail::fold_along<real_type>(m, axis, detail::min_abs_fold<real_type>(), "norm");
+        }
+        XTENSOR_THROW(std::runtime_error, "norm: only the inf and neg_inf norms are implemented along an axis.");
     }
 
     /**
-     * Compute the eigenvalues and right eigenvectors of a square array.
+     * Dot products of the rows (\em axis = 1) or columns (\em axis = 0) of
+     * \em A with those of \em B, ``einsum('ij,ij->i')`` for axis 1, without
+     * conjugation and without forming ``A * B``. The kernel is that of the
+     * axis norms, for any layouts of \em A and \em B.
      *
-     * @param Matrix for which the eigenvalues and right eigenvectors will be computed
-     * @return (eigenvalues, eigenvectors) tuple. The first element corresponds to the eigenvalues,
-     *         each repeated according to its multiplicity. The eigenvalues are not necessarily
-     *         ordered. The second (1) element are the normalized (unit “length”) eigenvectors,
-     *         such that the column v[:, i] corresponds to the eigenvalue w[i].
+     * @param A matrix
+     * @param B matrix of the shape of \em A
+     * @param axis axis along which the products are summed
+     * @return vector of the products, of A.shape()[1 - axis] elements
      */
-    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eig(const xexpression<E>& A)
+    template <class T, class O>
+    auto dot_along(const xexpression<T>& A, const xexpression<O>& B, std::size_t axis)
     {
-        using underlying_type = typename E::value_type;
-        using value_type = typename E::value_type;
-
-        assert_nd_square(A);
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
 
-        std::size_t N = M.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<value_type, 1, layout_type::column_major> wr(vN), wi(vN);
+        auto&& a = view_eval<T::static_layout>(A.derived_cast());
+        auto&& b = view_eval<O::static_layout>(B.derived_cast());
+        detail::matrix_lines ga = detail::get_matrix_lines(a, axis, "dot_along");
+        detail::matrix_lines gb = detail::get_matrix_lines(b, axis, "dot_along");
+        if (ga.lines != gb.lines || ga.length != gb.length)
+        {
+            XTENSOR_THROW(std::runtime_error, "dot_along: A and B must have the same shape.");
+        }
+        xtensor<value_type, 1> result = xtensor<value_type, 1>::from_shape({ga.lines});
+        detail::fold_lines(ga, a.data() + a.data_offset(), gb, b.data() + b.data_offset(), result.data(),
+                           detail::product_sum_fold<value_type>());
+        return result;
+    }
 
-        std::array<std::size_t, 2> shp = {N, N};
-        xtensor<value_type, 2, layout_type::column_major> VL(shp), VR(shp);
+    /***********************
+     * small-matrix kernels *
+     ***********************/
 
-        // jobvl N: left eigenvectors of A are not computed
-        // jobvr V: then right eigenvectors of A are computed
-        int info = lapack::geev(M, 'N', 'V', wr, wi, VL, VR);
+    namespace detail
+    {
+        template <class T>
+        inline auto conj_value(const T& x) -> std::enable_if_t<!xtl::is_complex<T>::value, T>
+        {
+            return x;
+        }
 
-        if (info != 0)
+        template <class T>
+        inline auto conj_value(const T& x) -> std::enable_if_t<xtl::is_complex<T>::value, T>
         {
-            XTENSOR_THROW(std::runtime_error, "Eigenvalue calculation did not converge.");
+            return std::conj(x);
         }
 
-        auto eig_vecs = xtensor<std::complex<underlying_type>, 2>::from_shape({ N, N });
-        auto eig_vals = xtensor<std::complex<underlying_type>, 1>::from_shape({ N });
+        /// Largest matrix order handled by the unrolled small-matrix kernels.
+        constexpr std::size_t small_matrix_order = 8;
 
-        xt::real(eig_vals) = wr;
-        xt::imag(eig_vals) = wi;
+        template <class T>
+        inline auto pivot_magnitude(const T& v)
+        {
+            return std::abs(std::real(v)) + std::abs(std::imag(v));
+        }
 
-        for (std::size_t i = 0; i < N; ++i)
+        /**
+         * In-place LU factorization with partial pivoting of the row-major
+         * N x N matrix \em a. Pivots are stored one-based, as getrf does.
+         * @return false if an exact zero pivot was found
+         */
+        template <std::size_t N, class T>
+        inline bool small_getrf(T* a, blas_index_t* piv)
         {
-            for (std::size_t j = 0; j < N; ++j)
+            bool regular = true;
+            for (std::size_t k = 0; k < N; ++k)
             {
-                if (wi(j) != 0)
+                std::size_t p = k;
+                auto p_max = pivot_magnitude(a[k * N + k]);
+                for (std::size_t i = k + 1; i < N; ++i)
                 {
-                    eig_vecs(i, j)     = std::complex<underlying_type>(VR(i, j),  VR(i, j + 1));
-                    eig_vecs(i, j + 1) = std::complex<underlying_type>(VR(i, j), -VR(i, j + 1));
-                    ++j;
+                    auto v = pivot_magnitude(a[i * N + k]);
+                    if (v > p_max)
+                    {
+                        p_max = v;
+                        p = i;
+                    }
                 }
-                else
+                piv[k] = to_blas_index(p + 1);
+                if (p_max == 0)
                 {
-                    eig_vecs(i, j) = std::complex<underlying_type>(VR(i, j), 0);
+                    regular = false;
+                    continue;
                 }
-            }
-        }
+                if (p != k)
+                {
+                    for (std::size_t j = 0; j < N; ++j)
+                    {
+                        std::swap(a[k * N + j], a[p * N + j]);
+                    }
+                }
+                T inv_pivot = T(1) / a[k * N + k];
+                for (std::size_t i = k + 1; i < N; ++i)
+                {
+                    T l = a[i * N + k] * inv_pivot;
+                    a[i * N + k] = l;
+                    for (std::size_t j = k + 1; j < N; ++j)
+                    {
+                        a[i * N + j] -= l * a[k * N + j];
+                    }
+                }
+            }
+            return regular;
+        }
+
+        /**
+         * Solves L U X = P B in place, where \em lu and \em piv come from
+         * small_getrf and \em b is a row-major N x nrhs matrix.
+         */
+        template <std::size_t N, class T>
+        inline void small_getrs(const T* lu, const blas_index_t* piv, T* b, std::size_t nrhs)
+        {
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                std::size_t p = static_cast<std::size_t>(piv[k] - 1);
+                if (p != k)
+                {
+                    for (std::size_t j = 0; j < nrhs; ++j)
+                    {
+                        std::swap(b[k * nrhs + j], b[p * nrhs + j]);
+                    }
+                }
+            }
+            for (std::size_t i = 1; i < N; ++i)
+            {
+                for (std::size_t k = 0; k < i; ++k)
+                {
+                    T l = lu[i * N + k];
+                    for (std::size_t j = 0; j < nrhs; ++j)
+                    {
+                        b[i * nrhs + j] -= l * b[k * nrhs + j];
+                    }
+                }
+            }
+            for (std::size_t i = N; i-- > 0;)
+            {
+                for (std::size_t k = i + 1; k < N; ++k)
+                {
+                    T u = lu[i * N + k];
+                    for (std::size_t j = 0; j < nrhs; ++j)
+                    {
+                        b[i * nrhs + j] -= u * b[k * nrhs + j];
+                    }
+                }
+                T inv_diag = T(1) / lu[i * N + i];
+                for (std::size_t j = 0; j < nrhs; ++j)
+                {
+                    b[i * nrhs + j] *= inv_diag;
+                }
+            }
+        }
+
+        /**
+         * In-place Cholesky factorization A = L L^H of the row-major N x N
+         * matrix \em a. Only the lower triangle is read; the strict upper
+         * triangle is set to zero.
+         * @return false if \em a is not positive definite
+         */
+        template <std::size_t N, class T>
+        inline bool small_potrf(T* a)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                real_type d = std::real(a[j * N + j]);
+                for (std::size_t k = 0; k < j; ++k)
+                {
+                    d -= std::norm(a[j * N + k]);
+                }
+                if (!(d > real_type(0)))
+                {
+                    return false;
+                }
+                d = std::sqrt(d);
+                a[j * N + j] = T(d);
+                for (std::size_t i = j + 1; i < N; ++i)
+                {
+                    T s = a[i * N + j];
+                    for (std::size_t k = 0; k < j; ++k)
+                    {
+                        s -= a[i * N + k] * conj_value(a[j * N + k]);
+                    }
+                    a[i * N + j] = s / d;
+                }
+                for (std::size_t k = j + 1; k < N; ++k)
+                {
+                    a[j * N + k] = T(0);
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Eigenvalues and eigenvectors of the real symmetric row-major N x N
+         * matrix \em a by cyclic Jacobi sweeps; only the \em uplo triangle is
+         * read. A single rotation diagonalizes a 2 x 2 matrix, and a 3 x 3
+         * one takes a few sweeps, each as accurate as LAPACK. \em w receives the
+         * eigenvalues in ascending order and the row-major \em v the
+         * eigenvectors in its columns; \em a and \em v may alias.
+         */
+        template <std::size_t N, class T>
+        inline void small_syev_jacobi(const T* a, char uplo, T* w, T* v)
+        {
+            std::array<T, N * N> m;
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                for (std::size_t j = 0; j <= i; ++j)
+                {
+                    T x = uplo == 'L' ? a[i * N + j] : a[j * N + i];
+                    m[i * N + j] = x;
+                    m[j * N + i] = x;
+                }
+            }
+            std::array<T, N * N> q = {};
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                q[i * N + i] = T(1);
+            }
+
+            constexpr std::size_t max_sweeps = 32;
+            for (std::size_t sweep = 0; sweep < max_sweeps; ++sweep)
+            {
+                bool rotated = false;
+                for (std::size_t p = 0; p + 1 < N; ++p)
+                {
+                    for (std::size_t r = p + 1; r < N; ++r)
+                    {
+                        T apr = m[p * N + r];
+                        T app = m[p * N + p];
+                        T arr = m[r * N + r];
+                        if (std::abs(apr) <= std::numeric_limits<T>::epsilon() * std::sqrt(std::abs(app) * std::abs(arr)) ||
+                            apr == T(0))
+                        {
+                            m[p * N + r] = m[r * N + p] = T(0);
+                            continue;
+                        }
+                        rotated = true;
+                        T theta = (arr - app) / (T(2) * apr);
+                        T t = (theta < T(0) ? T(-1) : T(1)) / (std::abs(theta) + std::hypot(theta, T(1)));
+                        T c = T(1) / std::hypot(t, T(1));
+                        T sn = t * c;
+                        m[p * N + p] = app - t * apr;
+                        m[r * N + r] = arr + t * apr;
+                        m[p * N + r] = m[r * N + p] = T(0);
+                        for (std::size_t k = 0; k < N; ++k)
+                        {
+                            if (k != p && k != r)
+                            {
+                                T akp = m[k * N + p];
+                                T akr = m[k * N + r];
+                                m[k * N + p] = m[p * N + k] = c * akp - sn * akr;
+                                m[k * N + r] = m[r * N + k] = sn * akp + c * akr;
+                            }
+                            T qkp = q[k * N + p];
+                            T qkr = q[k * N + r];
+                            q[k * N + p] = c * qkp - sn * qkr;
+                            q[k * N + r] = sn * qkp + c * qkr;
+                        }
+                    }
+                }
+                if (!rotated)
+                {
+                    break;
+                }
+            }
+
+            std::array<std::size_t, N> order;
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [&m](std::size_t i, std::size_t j) {
+                return m[i * N + i] < m[j * N + j];
+            });
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                w[j] = m[order[j] * N + order[j]];
+                for (std::size_t i = 0; i < N; ++i)
+                {
+                    v[i * N + j] = q[i * N + order[j]];
+                }
+            }
+        }
+
+        /**
+         * Reduced QR decomposition of the row-major m x n matrix \em a, with
+         * m, n <= small_matrix_order, by Householder reflections on a copy
+         * held in fixed-size arrays. \em q receives the row-major m x k
+         * matrix Q and \em r the row-major k x n matrix R, k = min(m, n).
+         */
+        template <class T>
+        inline void small_geqr_householder(const T* a, std::size_t m, std::size_t n, T* q, T* r)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            constexpr std::size_t cap = small_matrix_order;
+            std::size_t k = std::min(m, n);
+
+            std::array<T, cap * cap> h;
+            std::copy(a, a + m * n, h.begin());
+            std::array<T, cap * cap> v;
+            std::array<real_type, cap> tau;
+
+            for (std::size_t c = 0; c < k; ++c)
+            {
+                real_type norm2(0);
+                for (std::size_t i = c; i < m; ++i)
+                {
+                    norm2 += std::norm(h[i * n + c]);
+                }
+                if (norm2 == real_type(0))
+                {
+                    tau[c] = real_type(0);
+                    continue;
+                }
+                T x0 = h[c * n + c];
+                real_type abs_x0 = std::abs(x0);
+                // alpha has the opposite phase of x0, so that x0 - alpha does not cancel
+                real_type nrm = std::sqrt(norm2);
+                T alpha = abs_x0 == real_type(0) ? T(-nrm) : -(x0 / abs_x0) * nrm;
+                v[c * k + c] = x0 - alpha;
+                for (std::size_t i = c + 1; i < m; ++i)
+                {
+                    v[i * k + c] = h[i * n + c];
+                }
+                real_type v_norm2 = (abs_x0 + nrm) * (abs_x0 + nrm) + norm2 - abs_x0 * abs_x0;
+                tau[c] = real_type(2) / v_norm2;
+
+                for (std::size_t j = c + 1; j < n; ++j)
+                {
+                    T s(0);
+                    for (std::size_t i = c; i < m; ++i)
+                    {
+                        s += conj_value(v[i * k + c]) * h[i * n + j];
+                    }
+                    s *= tau[c];
+                    for (std::size_t i = c; i < m; ++i)
+                    {
+                        h[i * n + j] -= s * v[i * k + c];
+                    }
+                }
+                h[c * n + c] = alpha;
+                for (std::size_t i = c + 1; i < m; ++i)
+                {
+                    h[i * n + c] = T(0);
+                }
+            }
+
+            std::copy(h.begin(), h.begin() + k * n, r);
+
+            // Q = H_0 ... H_{k-1} applied to the leading k columns of the identity
+            std::fill(q, q + m * k, T(0));
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                q[i * k + i] = T(1);
+            }
+            for (std::size_t c = k; c-- > 0;)
+            {
+                if (tau[c] == real_type(0))
+                {
+                    continue;
+                }
+                for (std::size_t j = 0; j < k; ++j)
+                {
+                    T s(0);
+                    for (std::size_t i = c; i < m; ++i)
+                    {
+                        s += conj_value(v[i * k + c]) * q[i * k + j];
+                    }
+                    s *= tau[c];
+                    for (std::size_t i = c; i < m; ++i)
+                    {
+                        q[i * k + j] -= s * v[i * k + c];
+                    }
+                }
+            }
+        }
+
+        /**
+         * Reduced SVD A = U S Vt of the real row-major m x n matrix \em a,
+         * with m, n <= small_matrix_order, by one-sided (Hestenes) Jacobi
+         * rotations of the columns of A, or of A^T when m < n. \em u receives
+         * the row-major m x k matrix U, \em s the k singular values in
+         * decreasing order and \em vt the row-major k x n matrix Vt,
+         * k = min(m, n). The columns of U of zero singular values complete
+         * an orthonormal basis.
+         */
+        template <class T>
+        inline void small_gesvd_jacobi(const T* a, std::size_t m, std::size_t n, T* u, T* s, T* vt)
+        {
+            constexpr std::size_t cap = small_matrix_order;
+            bool transposed = m < n;
+            std::size_t rows = transposed ? n : m;
+            std::size_t k = transposed ? m : n;
+
+            std::array<T, cap * cap> g;
+            for (std::size_t i = 0; i < rows; ++i)
+            {
+                for (std::size_t j = 0; j < k; ++j)
+                {
+                    g[i * k + j] = transposed ? a[j * n + i] : a[i * n + j];
+                }
+            }
+            std::array<T, cap * cap> v = {};
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                v[i * k + i] = T(1);
+            }
+
+            constexpr std::size_t max_sweeps = 32;
+            for (std::size_t sweep = 0; sweep < max_sweeps; ++sweep)
+            {
+                bool rotated = false;
+                for (std::size_t p = 0; p + 1 < k; ++p)
+                {
+                    for (std::size_t q = p + 1; q < k; ++q)
+                    {
+                        T alpha(0), beta(0), gamma(0);
+                        for (std::size_t i = 0; i < rows; ++i)
+                        {
+                            alpha += g[i * k + p] * g[i * k + p];
+                            beta += g[i * k + q] * g[i * k + q];
+                            gamma += g[i * k + p] * g[i * k + q];
+                        }
+                        if (gamma == T(0) || std::abs(gamma) <= std::numeric_limits<T>::epsilon() * std::sqrt(alpha * beta))
+                        {
+                            continue;
+                        }
+                        rotated = true;
+                        T zeta = (beta - alpha) / (T(2) * gamma);
+                        T t = (zeta < T(0) ? T(-1) : T(1)) / (std::abs(zeta) + std::hypot(zeta, T(1)));
+                        T c = T(1) / std::hypot(t, T(1));
+                        T sn = t * c;
+                        for (std::size_t i = 0; i < rows; ++i)
+                        {
+                            T gp = g[i * k + p];
+                            T gq = g[i * k + q];
+                            g[i * k + p] = c * gp - sn * gq;
+                            g[i * k + q] = sn * gp + c * gq;
+                        }
+                        for (std::size_t i = 0; i < k; ++i)
+                        {
+                            T vp = v[i * k + p];
+                            T vq = v[i * k + q];
+                            v[i * k + p] = c * vp - sn * vq;
+                            v[i * k + q] = sn * vp + c * vq;
+                        }
+                    }
+                }
+                if (!rotated)
+                {
+                    break;
+                }
+            }
+
+            std::array<T, cap> sigma;
+            std::array<std::size_t, cap> order;
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                T norm2(0);
+                for (std::size_t i = 0; i < rows; ++i)
+                {
+                    norm2 += g[i * k + j] * g[i * k + j];
+                }
+                sigma[j] = std::sqrt(norm2);
+                order[j] = j;
+            }
+            std::sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(k),
+                      [&sigma](std::size_t i, std::size_t j) { return sigma[i] > sigma[j]; });
+
+            // left singular vectors of the rotated problem, rows x k
+            std::array<T, cap * cap> w;
+            T cutoff = k == 0 ? T(0) : sigma[order[0]] * T(rows) * std::numeric_limits<T>::epsilon();
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                std::size_t o = order[j];
+                s[j] = sigma[o];
+                if (sigma[o] > cutoff && sigma[o] > T(0))
+                {
+                    for (std::size_t i = 0; i < rows; ++i)
+                    {
+                        w[i * k + j] = g[i * k + o] / sigma[o];
+                    }
+                    continue;
+                }
+                // complete the basis with the unit vector least in the span of the previous columns
+                T best_norm(-1);
+                for (std::size_t e = 0; e < rows; ++e)
+                {
+                    std::array<T, cap> x = {};
+                    x[e] = T(1);
+                    for (std::size_t pass = 0; pass < 2; ++pass)
+                    {
+                        for (std::size_t c = 0; c < j; ++c)
+                        {
+                            T d(0);
+                            for (std::size_t i = 0; i < rows; ++i)
+                            {
+                                d += w[i * k + c] * x[i];
+                            }
+                            for (std::size_t i = 0; i < rows; ++i)
+                            {
+                                x[i] -= d * w[i * k + c];
+                            }
+                        }
+                    }
+                    T norm2(0);
+                    for (std::size_t i = 0; i < rows; ++i)
+                    {
+                        norm2 += x[i] * x[i];
+                    }
+                    if (norm2 > best_norm)
+                    {
+                        best_norm = norm2;
+                        T inv = T(1) / std::sqrt(norm2);
+                        for (std::size_t i = 0; i < rows; ++i)
+                        {
+                            w[i * k + j] = x[i] * inv;
+                        }
+                    }
+                }
+            }
+
+            // A = W S V^T, or A^T = W S V^T when transposed
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                std::size_t o = order[j];
+                for (std::size_t i = 0; i < k; ++i)
+                {
+                    if (transposed)
+                    {
+                        u[i * k + j] = v[i * k + o];
+                    }
+                    else
+                    {
+                        vt[j * n + i] = v[i * k + o];
+                    }
+                }
+                for (std::size_t i = 0; i < rows; ++i)
+                {
+                    if (transposed)
+                    {
+                        vt[j * n + i] = w[i * k + j];
+                    }
+                    else
+                    {
+                        u[i * k + j] = w[i * k + j];
+                    }
+                }
+            }
+        }
+
+        /// Determinant from LU factors of order \em n with one-based pivots.
+        template <class T>
+        inline T det_from_lu(const T* lu, const blas_index_t* piv, std::size_t n)
+        {
+            T result(1);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (piv[i] != blas_index_t(i + 1))
+                {
+                    result = -result;
+                }
+                result *= lu[i * n + i];
+            }
+            return result;
+        }
+
+        template <class T>
+        inline auto log_abs_sign(T& sign, const T& x) -> std::enable_if_t<!xtl::is_complex<T>::value, T>
+        {
+            sign *= x < T(0) ? T(-1) : T(1);
+            return std::log(std::abs(x));
+        }
+
+        template <class T>
+        inline auto log_abs_sign(T& sign, const T& x)
+            -> std::enable_if_t<xtl::is_complex<T>::value, xtl::complex_value_type_t<T>>
+        {
+            auto abs_x = std::abs(x);
+            sign *= x / abs_x;
+            return std::log(abs_x);
+        }
+
+        /**
+         * Sign and logarithm of the modulus of the determinant from LU
+         * factors of order \em n with one-based pivots, (0, -inf) when
+         * singular.
+         */
+        template <class T>
+        inline auto slogdet_from_lu(const T* lu, const blas_index_t* piv, std::size_t n)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            T sign(1);
+            real_type result(0);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (lu[i * n + i] == T(0))
+                {
+                    return std::make_tuple(T(0), -std::numeric_limits<real_type>::infinity());
+                }
+                if (piv[i] != blas_index_t(i + 1))
+                {
+                    sign = -sign;
+                }
+                result += log_abs_sign(sign, lu[i * n + i]);
+            }
+            return std::make_tuple(sign, result);
+        }
+
+        /// Sign and logarithm of the determinant of L L^H from the Cholesky factor L of order \em n.
+        template <class T>
+        inline auto slogdet_from_cholesky(const T* l, std::size_t n)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            real_type result(0);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                result += std::log(std::real(l[i * n + i]));
+            }
+            return std::make_tuple(T(1), real_type(2) * result);
+        }
+
+        /**
+         * Calls \em f with std::integral_constant<std::size_t, n> for
+         * 1 <= n <= small_matrix_order.
+         */
+        template <class F>
+        inline decltype(auto) dispatch_small_size(std::size_t n, F&& f)
+        {
+            switch (n)
+            {
+                case 1: return f(std::integral_constant<std::size_t, 1>());
+                case 2: return f(std::integral_constant<std::size_t, 2>());
+                case 3: return f(std::integral_constant<std::size_t, 3>());
+                case 4: return f(std::integral_constant<std::size_t, 4>());
+                case 5: return f(std::integral_constant<std::size_t, 5>());
+                case 6: return f(std::integral_constant<std::size_t, 6>());
+                case 7: return f(std::integral_constant<std::size_t, 7>());
+                default: return f(std::integral_constant<std::size_t, 8>());
+            }
+        }
+    }
+
+    /************************************
+     * fixed-size matrix specializations *
+     ************************************/
+
+    namespace detail
+    {
+        template <class S>
+        struct fixed_square_order_impl : std::integral_constant<std::size_t, 0>
+        {
+        };
+
+        template <std::size_t N>
+        struct fixed_square_order_impl<fixed_shape<N, N>>
+            : std::integral_constant<std::size_t, (N <= small_matrix_order ? N : 0)>
+        {
+        };
+
+        /**
+         * Order of \em E if it is a small square matrix whose shape is known at
+         * compile time (e.g. xtensor_fixed<T, xshape<3, 3>>), 0 otherwise.
+         */
+        template <class E>
+        using fixed_square_order = fixed_square_order_impl<typename E::shape_type>;
+
+        template <class S, std::size_t N>
+        struct is_fixed_rhs : std::false_type
+        {
+        };
+
+        template <std::size_t N>
+        struct is_fixed_rhs<fixed_shape<N>, N> : std::true_type
+        {
+        };
+
+        template <std::size_t N, std::size_t K>
+        struct is_fixed_rhs<fixed_shape<N, K>, N> : std::true_type
+        {
+        };
+
+        /// Order of the fixed-size system A x = b, 0 if either operand is not fixed-size.
+        template <class E1, class E2>
+        using fixed_solve_order = std::integral_constant<std::size_t,
+            is_fixed_rhs<typename E2::shape_type, fixed_square_order<E1>::value>::value ? fixed_square_order<E1>::value : 0>;
+
+        template <class S>
+        struct fixed_shape_size;
+
+        template <>
+        struct fixed_shape_size<fixed_shape<>> : std::integral_constant<std::size_t, 1>
+        {
+        };
+
+        template <std::size_t X, std::size_t... Xs>
+        struct fixed_shape_size<fixed_shape<X, Xs...>>
+            : std::integral_constant<std::size_t, X * fixed_shape_size<fixed_shape<Xs...>>::value>
+        {
+        };
+
+        template <class T, std::size_t N>
+        using fixed_matrix = xtensor_fixed<T, xshape<N, N>>;
+
+        template <class T, std::size_t N, class E>
+        inline std::array<T, N * N> load_fixed_matrix(const E& e)
+        {
+            std::array<T, N * N> result;
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                for (std::size_t j = 0; j < N; ++j)
+                {
+                    result[i * N + j] = e(i, j);
+                }
+            }
+            return result;
+        }
+
+        template <class R, class T, std::size_t S>
+        inline R store_fixed(const std::array<T, S>& a)
+        {
+            R result;
+            std::copy(a.begin(), a.end(), result.begin());
+            return result;
+        }
+
+        // closed forms for 2x2 and 3x3 matrices
+
+        template <class T>
+        inline T fixed_det(const std::array<T, 4>& a, std::integral_constant<std::size_t, 2>)
+        {
+            return a[0] * a[3] - a[1] * a[2];
+        }
+
+        template <class T>
+        inline T fixed_det(const std::array<T, 9>& a, std::integral_constant<std::size_t, 3>)
+        {
+            return a[0] * (a[4] * a[8] - a[5] * a[7])
+                 - a[1] * (a[3] * a[8] - a[5] * a[6])
+                 + a[2] * (a[3] * a[7] - a[4] * a[6]);
+        }
+
+        template <class T, std::size_t S, std::size_t N>
+        inline T fixed_det(std::array<T, S> a, std::integral_constant<std::size_t, N>)
+        {
+            std::array<blas_index_t, N> piv;
+            return small_getrf<N>(a.data(), piv.data()) ? det_from_lu(a.data(), piv.data(), N) : T(0);
+        }
+
+        /// Closed-form determinant of the row-major 2 x 2 or 3 x 3 matrix \em a.
+        template <class T>
+        inline T closed_form_det(const T* a, std::size_t n)
+        {
+            if (n == 2)
+            {
+                std::array<T, 4> m;
+                std::copy(a, a + 4, m.begin());
+                return fixed_det(m, std::integral_constant<std::size_t, 2>());
+            }
+            std::array<T, 9> m;
+            std::copy(a, a + 9, m.begin());
+            return fixed_det(m, std::integral_constant<std::size_t, 3>());
+        }
+
+        template <class T>
+        inline std::array<T, 4> fixed_adjugate(const std::array<T, 4>& a)
+        {
+            return {{a[3], -a[1], -a[2], a[0]}};
+        }
+
+        template <class T>
+        inline std::array<T, 9> fixed_adjugate(const std::array<T, 9>& a)
+        {
+            return {{a[4] * a[8] - a[5] * a[7], a[2] * a[7] - a[1] * a[8], a[1] * a[5] - a[2] * a[4],
+                     a[5] * a[6] - a[3] * a[8], a[0] * a[8] - a[2] * a[6], a[2] * a[3] - a[0] * a[5],
+                     a[3] * a[7] - a[4] * a[6], a[1] * a[6] - a[0] * a[7], a[0] * a[4] - a[1] * a[3]}};
+        }
+
+        /**
+         * Overwrites the row-major N x nrhs matrix \em b with inv(A) b, using the
+         * adjugate (Cramer's rule) for N <= 3 and the unrolled LU kernel otherwise.
+         * @return false if A is singular
+         */
+        template <std::size_t N, class T, std::size_t S, std::size_t R>
+        inline bool fixed_solve_inplace(std::array<T, S> a, std::array<T, R>& b,
+                                        std::true_type /*closed form*/)
+        {
+            constexpr std::size_t nrhs = R / N;
+            T d = fixed_det(a, std::integral_constant<std::size_t, N>());
+            if (d == T(0))
+            {
+                return false;
+            }
+            auto adj = fixed_adjugate(a);
+            std::array<T, R> x;
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                for (std::size_t j = 0; j < nrhs; ++j)
+                {
+                    T s(0);
+                    for (std::size_t k = 0; k < N; ++k)
+                    {
+                        s += adj[i * N + k] * b[k * nrhs + j];
+                    }
+                    x[i * nrhs + j] = s / d;
+                }
+            }
+            b = x;
+            return true;
+        }
+
+        template <std::size_t N, class T, std::size_t S, std::size_t R>
+        inline bool fixed_solve_inplace(std::array<T, S> a, std::array<T, R>& b,
+                                        std::false_type /*closed form*/)
+        {
+            std::array<blas_index_t, N> piv;
+            if (!small_getrf<N>(a.data(), piv.data()))
+            {
+                return false;
+            }
+            small_getrs<N>(a.data(), piv.data(), b.data(), R / N);
+            return true;
+        }
+
+        template <std::size_t N, class T, std::size_t S, std::size_t R>
+        inline bool fixed_solve_inplace(const std::array<T, S>& a, std::array<T, R>& b)
+        {
+            return fixed_solve_inplace<N>(a, b, std::integral_constant<bool, (N == 2 || N == 3)>());
+        }
+
+        template <class T, std::size_t N>
+        inline std::array<T, N * N> fixed_identity()
+        {
+            std::array<T, N * N> result;
+            result.fill(T(0));
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                result[i * N + i] = T(1);
+            }
+            return result;
+        }
+
+        template <class S>
+        struct is_fixed_shape : std::false_type
+        {
+        };
+
+        template <std::size_t... X>
+        struct is_fixed_shape<fixed_shape<X...>> : std::true_type
+        {
+        };
+
+        template <std::size_t M, std::size_t K, std::size_t N, class S>
+        struct small_fixed_dot
+        {
+            static constexpr std::size_t rows = M;
+            static constexpr std::size_t inner = K;
+            static constexpr std::size_t cols = N;
+            using shape_type = std::conditional_t<(M <= small_matrix_order && K <= small_matrix_order &&
+                                                   N <= small_matrix_order), S, void>;
+        };
+
+        /**
+         * Result shape of dot for small operands whose shapes are known at
+         * compile time, void when the product goes through BLAS.
+         */
+        template <class TS, class OS>
+        struct fixed_dot_traits
+        {
+            using shape_type = void;
+        };
+
+        template <std::size_t M, std::size_t K, std::size_t N>
+        struct fixed_dot_traits<fixed_shape<M, K>, fixed_shape<K, N>>
+            : small_fixed_dot<M, K, N, fixed_shape<M, N>>
+        {
+        };
+
+        template <std::size_t M, std::size_t K>
+        struct fixed_dot_traits<fixed_shape<M, K>, fixed_shape<K>>
+            : small_fixed_dot<M, K, 1, fixed_shape<M>>
+        {
+        };
+
+        template <std::size_t K, std::size_t N>
+        struct fixed_dot_traits<fixed_shape<K>, fixed_shape<K, N>>
+            : small_fixed_dot<1, K, N, fixed_shape<N>>
+        {
+        };
+
+        template <std::size_t K>
+        struct fixed_dot_traits<fixed_shape<K>, fixed_shape<K>>
+            : small_fixed_dot<1, K, 1, fixed_shape<1>>
+        {
+        };
+
+        template <class E, std::size_t N>
+        inline auto fixed_element(const E& e, std::size_t i, std::size_t j, fixed_shape<N>)
+        {
+            // vector operands are 1 x K or K x 1, so one of i and j is zero
+            return e(i + j);
+        }
+
+        template <class E, std::size_t M, std::size_t N>
+        inline auto fixed_element(const E& e, std::size_t i, std::size_t j, fixed_shape<M, N>)
+        {
+            return e(i, j);
+        }
+
+        template <class F, class T, class O>
+        inline auto fixed_dot(const T& t, const O& o)
+        {
+            using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+            using result_type = xtensor_fixed<value_type, typename F::shape_type>;
+
+            result_type result;
+            for (std::size_t i = 0; i < F::rows; ++i)
+            {
+                for (std::size_t j = 0; j < F::cols; ++j)
+                {
+                    value_type s(0);
+                    for (std::size_t k = 0; k < F::inner; ++k)
+                    {
+                        s += fixed_element(t, i, k, typename T::shape_type()) *
+                             fixed_element(o, k, j, typename O::shape_type());
+                    }
+                    result.data()[i * F::cols + j] = s;
+                }
+            }
+            return result;
+        }
+    }
+
+    namespace detail
+    {
+        template <class E>
+        inline void check_inplace_operand(const E& e, const char* name)
+        {
+            if (e.dimension() > 2 || e.layout() != layout_type::column_major)
+            {
+                std::stringstream msg;
+                msg << name << ": expected a column-major container of dimension 1 or 2.";
+                XTENSOR_THROW(std::runtime_error, msg.str());
+            }
+        }
+
+        template <class E>
+        inline bool is_contiguous_row_major(const E& e)
+        {
+            return e.dimension() == 2 && e.layout() == layout_type::row_major &&
+                   (e.shape()[1] <= 1 || e.strides()[1] == 1) &&
+                   (e.shape()[0] <= 1 || static_cast<std::size_t>(e.strides()[0]) == e.shape()[1]);
+        }
+
+        template <class E, class R>
+        inline void transposed_copy(const E& e, R& result, std::true_type /*has_data_interface*/)
+        {
+            if (is_contiguous_row_major(e))
+            {
+                // the row-major buffer of e is the column-major storage of its transpose
+                auto first = e.data() + e.data_offset();
+                std::copy(first, first + e.size(), result.data());
+            }
+            else if (e.size() >= xt::detail::transpose_copy_min_size)
+            {
+                xt::detail::transpose_copy(e.data() + e.data_offset(), static_cast<std::ptrdiff_t>(e.strides()[1]),
+                                           static_cast<std::ptrdiff_t>(e.strides()[0]), e.shape()[1], e.shape()[0],
+                                           result.data(), e.shape()[1]);
+            }
+            else
+            {
+                noalias(result) = transpose(e);
+            }
+        }
+
+        template <class E, class R>
+        inline void transposed_copy(const E& e, R& result, std::false_type /*has_data_interface*/)
+        {
+            noalias(result) = transpose(e);
+        }
+
+        /**
+         * Returns a column-major copy of the transpose of the 2-D expression \em e.
+         * For a row-major container this is a flat copy of its buffer, which is
+         * much cheaper than the strided copy done by copy_to_layout.
+         */
+        template <class E>
+        inline auto transposed_column_major(const E& e)
+        {
+            using result_type = xtensor<typename E::value_type, 2, layout_type::column_major>;
+            result_type result = result_type::from_shape({e.shape()[1], e.shape()[0]});
+            transposed_copy(e, result, has_data_interface<E>());
+            return result;
+        }
+
+        /**
+         * Reinterprets the column-major matrix \em m as the row-major storage
+         * of its transpose, moving the buffer instead of copying it.
+         */
+        template <class R, class T>
+        inline R transposed_row_major(xtensor<T, 2, layout_type::column_major>&& m)
+        {
+            R result = R::from_shape({m.shape()[1], m.shape()[0]});
+            std::swap(result.storage(), m.storage());
+            return result;
+        }
+
+        template <class E>
+        using row_major_matrix_t = std::conditional_t<xt::detail::is_array<typename E::shape_type>::value,
+                                                      xtensor<typename E::value_type, 2, layout_type::row_major>,
+                                                      xarray<typename E::value_type, layout_type::row_major>>;
+
+        template <class E>
+        using is_static_row_major = std::integral_constant<bool, E::static_layout == layout_type::row_major>;
+
+        /**
+         * Returns a column-major copy of \em e, or of its transpose when that
+         * one is cheaper to obtain. Only valid for quantities invariant under
+         * transposition, like the determinant.
+         */
+        template <class E>
+        inline auto column_major_up_to_transpose(const E& e)
+        {
+            if (e.layout() == layout_type::row_major)
+            {
+                return transposed_column_major(e);
+            }
+            xtensor<typename E::value_type, 2, layout_type::column_major> result = e;
+            return result;
+        }
+    }
+
+    /**
+     * Solve a linear matrix equation in the buffers of the caller.
+     * Same as solve, without copying the operands: on exit \em A holds
+     * the LU factors of the coefficient matrix and \em b the solution.
+     *
+     * @param A Square, column-major coefficient matrix, overwritten
+     * @param b Column-major right-hand side(s), overwritten with the solution
+     * @return reference to \em b
+     */
+    template <class E1, class E2>
+    E2& solve_inplace(E1& A, E2& b)
+    {
+        assert_nd_square(A);
+        detail::check_inplace_operand(A, "solve_inplace");
+        detail::check_inplace_operand(b, "solve_inplace");
+
+        int info = lapack::gesv(A, b);
+
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+
+        return b;
+    }
+
+    /****************************
+     * Status-returning solvers *
+     ****************************/
+
+    namespace detail
+    {
+        template <class E>
+        inline bool is_try_square_operand(const E& A) noexcept
+        {
+            return A.dimension() == 2 && A.shape()[0] == A.shape()[1] && A.layout() == layout_type::column_major
+                   && xt::detail::fits_blas_index(A.shape()[0], std::false_type());
+        }
+
+        template <class E, class F>
+        inline bool is_try_rhs_operand(const E& A, const F& b) noexcept
+        {
+            return (b.dimension() == 1 || b.dimension() == 2) && b.shape()[0] == A.shape()[0]
+                   && b.layout() == layout_type::column_major
+                   && xt::detail::fits_blas_index(b.dimension() == 2 ? b.shape()[1] : std::size_t(1), std::false_type());
+        }
+
+        template <class E, class F>
+        inline bool same_shape(const E& e, const F& f) noexcept
+        {
+            return e.dimension() == f.dimension() && std::equal(e.shape().cbegin(), e.shape().cend(), f.shape().cbegin());
+        }
+    }
+
+    /**
+     * Solve a linear matrix equation in the buffers of the caller, without
+     * throwing. Same as solve_inplace, with the pivots supplied by the
+     * caller and the status returned as the LAPACK info: neither allocates
+     * nor throws, for code built without exceptions and hot loops.
+     *
+     * @param A Square, column-major coefficient matrix, overwritten with its LU factors
+     * @param b Column-major right-hand side(s), overwritten with the solution
+     * @param piv pivot indices of at least as many blas_index_t as A has rows
+     * @return 0 on success, i > 0 if the matrix is singular (U(i - 1, i - 1) is zero),
+     *         and -1, -2 or -3 if \em A, \em b or \em piv does not have the
+     *         expected shape or layout, in which case nothing is written
+     */
+    template <class E1, class E2, class P>
+    int try_solve_inplace(E1& A, E2& b, P& piv) noexcept
+    {
+        if (!detail::is_try_square_operand(A))
+        {
+            return -1;
+        }
+        if (!detail::is_try_rhs_operand(A, b))
+        {
+            return -2;
+        }
+        if (piv.size() < A.shape()[0])
+        {
+            return -3;
+        }
+        int info = lapack::getrf(A, piv);
+        if (info == 0)
+        {
+            info = lapack::getrs(A, piv, b);
+        }
+        return info;
+    }
+
+    /**
+     * Solve a linear matrix equation into the output \em x, without throwing.
+     * \em A is copied into \em lu and \em b into \em x, of the same shapes,
+     * then factored and solved there, so a loop over preallocated buffers
+     * neither allocates nor throws.
+     *
+     * @param A Coefficient matrix
+     * @param b Ordinate or “dependent variable” values.
+     * @param x Column-major output of the shape of \em b, the solution on success
+     * @param lu Column-major matrix of the shape of \em A, overwritten with its LU factors
+     * @param piv pivot indices of at least as many blas_index_t as A has rows
+     * @return the status of try_solve_inplace, -1 also if \em lu does not have
+     *         the shape of \em A and -2 if \em x does not have that of \em b
+     */
+    template <class E1, class E2, class X, class LU, class P>
+    int try_solve(const xexpression<E1>& A, const xexpression<E2>& b, X& x, LU& lu, P& piv) noexcept
+    {
+        const auto& a = A.derived_cast();
+        const auto& rb = b.derived_cast();
+        if (!detail::same_shape(a, lu) || !detail::is_try_square_operand(lu))
+        {
+            return -1;
+        }
+        if (!detail::same_shape(rb, x) || !detail::is_try_rhs_operand(lu, x))
+        {
+            return -2;
+        }
+        noalias(lu) = a;
+        noalias(x) = rb;
+        return try_solve_inplace(lu, x, piv);
+    }
+
+    /**
+     * Solve a linear matrix equation into the output \em x, without throwing
+     * on a singular matrix. The LU factors and the pivots are allocated on
+     * each call; pass them to the overload taking \em lu and \em piv to
+     * avoid this.
+     *
+     * @param A Coefficient matrix
+     * @param b Ordinate or “dependent variable” values.
+     * @param x Column-major output of the shape of \em b, the solution on success
+     * @return the status of try_solve_inplace
+     */
+    template <class E1, class E2, class X>
+    int try_solve(const xexpression<E1>& A, const xexpression<E2>& b, X& x)
+    {
+        const auto& a = A.derived_cast();
+        if (a.dimension() != 2)
+        {
+            return -1;
+        }
+        using lu_type = xtensor<typename X::value_type, 2, layout_type::column_major>;
+        lu_type lu = lu_type::from_shape({a.shape()[0], a.shape()[1]});
+        uvector<blas_index_t> piv(a.shape()[0]);
+        return try_solve(a, b, x, lu, piv);
+    }
+
+    /**
+     * Solve a x = b for a symmetric (Hermitian) positive definite matrix in
+     * the buffers of the caller, without throwing: Cholesky factorization of
+     * the \em uplo triangle of \em A (potrf) followed by potrs.
+     *
+     * @param A Square, column-major matrix, overwritten with its Cholesky factor
+     * @param b Column-major right-hand side(s), overwritten with the solution
+     * @param uplo triangle of A to read, 'L' or 'U'
+     * @return 0 on success, i > 0 if the leading minor of order i is not
+     *         positive, -1 or -2 if \em A or \em b does not have the expected
+     *         shape or layout
+     */
+    template <class E1, class E2>
+    int try_solve_positive_definite_inplace(E1& A, E2& b, char uplo = 'L') noexcept
+    {
+        if (!detail::is_try_square_operand(A))
+        {
+            return -1;
+        }
+        if (!detail::is_try_rhs_operand(A, b))
+        {
+            return -2;
+        }
+        int info = lapack::potr(A, uplo);
+        if (info == 0)
+        {
+            info = lapack::potrs(A, b, uplo);
+        }
+        return info;
+    }
+
+    /**
+     * Compute the (multiplicative) inverse of a matrix in the buffer of the
+     * caller, without throwing. The getri workspace is taken from \em ws;
+     * with \em ws prepared for the order of \em A (prepare<routine::getri>({n}))
+     * no workspace query is made, so the call neither allocates nor throws.
+     *
+     * @param A Square, column-major matrix, overwritten with its inverse on success
+     * @param piv pivot indices of at least as many blas_index_t as A has rows
+     * @param ws LAPACK workspace
+     * @return 0 on success, i > 0 if the matrix is singular, -1 or -2 if
+     *         \em A or \em piv does not have the expected shape or layout
+     */
+    template <class E, class Alloc>
+    int try_inv_inplace(E& A, uvector<blas_index_t>& piv, lapack::workspace<typename E::value_type, Alloc>& ws) noexcept
+    {
+        if (!detail::is_try_square_operand(A))
+        {
+            return -1;
+        }
+        if (piv.size() < A.shape()[0])
+        {
+            return -2;
+        }
+        int info = lapack::getrf(A, piv);
+        if (info == 0)
+        {
+            info = lapack::getri(A, piv, ws);
+        }
+        return info;
+    }
+
+    namespace detail
+    {
+        // overwrites the column-major right-hand side(s) db with the solution
+        template <class E1, class B>
+        inline void solve_into(const E1& rA, B& db)
+        {
+            if (rA.layout() == layout_type::row_major)
+            {
+                // factor A^T, which is the row-major buffer read column-major,
+                // and solve the transposed system
+                auto dA = transposed_column_major(rA);
+                check_inplace_operand(db, "solve");
+                uvector<blas_index_t> piv(dA.shape()[0]);
+                int info = lapack::getrf(dA, piv);
+                if (info == 0)
+                {
+                    info = lapack::getrs(dA, piv, db, 'T');
+                }
+                if (info != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+                }
+                return;
+            }
+
+            auto dA = copy_to_layout<layout_type::column_major>(rA);
+            solve_inplace(dA, db);
+        }
+
+        template <class E1, class E2>
+        inline auto solve_dispatch(const E1& rA, const E2& b, std::integral_constant<std::size_t, 0>)
+        {
+            auto db = copy_to_layout<layout_type::column_major>(b);
+            solve_into(rA, db);
+            return db;
+        }
+
+        template <class E1, class E2, std::size_t N>
+        inline auto solve_dispatch(const E1& A, const E2& b, std::integral_constant<std::size_t, N>)
+        {
+            using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+            using result_type = xtensor_fixed<value_type, typename E2::shape_type>;
+
+            auto a = load_fixed_matrix<value_type, N>(A);
+            std::array<value_type, fixed_shape_size<typename E2::shape_type>::value> x;
+            std::copy(b.begin(), b.end(), x.begin());
+            if (!fixed_solve_inplace<N>(a, x))
+            {
+                XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+            }
+            return store_fixed<result_type>(x);
+        }
+    }
+
+    /**
+     * Solve a linear matrix equation, or system of linear scalar equations.
+     * Computes the “exact” solution, x, of the well-determined, i.e., full rank,
+     * linear matrix equation ax = b.
+     *
+     * @param a Coefficient matrix
+     * @param b Ordinate or “dependent variable” values.
+     * @return Solution to the system a x = b. Returned shape is identical to b.
+     *         Small systems whose shapes are known at compile time are solved
+     *         without LAPACK and return an xtensor_fixed.
+     */
+    template <class E1, class E2>
+    auto solve(const xexpression<E1>& A, const xexpression<E2>& b)
+    {
+        assert_nd_square(A);
+        return detail::solve_dispatch(A.derived_cast(), b.derived_cast(), detail::fixed_solve_order<E1, E2>());
+    }
+
+    /**
+     * Solve a linear matrix equation into a container of type \em R.
+     * The right-hand side(s) are copied once into the result, which LAPACK
+     * overwrites with the solution when it is a vector or a column-major
+     * matrix; a row-major matrix result is solved in a column-major buffer
+     * and assigned.
+     *
+     * @param a Coefficient matrix
+     * @param b Ordinate or “dependent variable” values.
+     * @return Solution to the system a x = b, an \em R of the shape of b
+     */
+    template <class E1, class E2, class R>
+    R solve(const xexpression<E1>& A, const xexpression<E2>& b, result_as<R>)
+    {
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        static_assert(std::is_same<typename R::value_type, value_type>::value,
+                      "result_as: the container must hold the value type of the result");
+        assert_nd_square(A);
+
+        const auto& rb = b.derived_cast();
+        R x = detail::make_result<R>(rb.shape());
+        if (rb.dimension() == 1)
+        {
+            noalias(x) = rb;
+            auto buffer = xt::adapt<layout_type::column_major>(x.data(), x.size(), xt::no_ownership(),
+                                                               std::array<std::size_t, 1>{x.size()});
+            detail::solve_into(A.derived_cast(), buffer);
+        }
+        else if (rb.dimension() == 2 && x.layout() == layout_type::column_major)
+        {
+            noalias(x) = rb;
+            auto buffer = xt::adapt<layout_type::column_major>(x.data(), x.size(), xt::no_ownership(),
+                                                               std::array<std::size_t, 2>{rb.shape()[0], rb.shape()[1]});
+            detail::solve_into(A.derived_cast(), buffer);
+        }
+        else
+        {
+            noalias(x) = detail::solve_dispatch(A.derived_cast(), rb, std::integral_constant<std::size_t, 0>());
+        }
+        return x;
+    }
+
+    namespace detail
+    {
+        template <class T>
+        using has_mixed_precision = std::integral_constant<bool, std::is_same<T, double>::value ||
+                                                                 std::is_same<T, std::complex<double>>::value>;
+
+        template <class E1, class E2>
+        inline auto mixed_solve(const E1& A, const E2& b, std::true_type)
+        {
+            auto dA = copy_to_layout<layout_type::column_major>(A);
+            auto db = copy_to_layout<layout_type::column_major>(b);
+            auto x = db;
+            uvector<blas_index_t> piv(dA.shape()[0]);
+            blas_index_t iter = 0;
+
+            int info = lapack::dsgesv(dA, piv, db, x, iter);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+            }
+            return std::make_tuple(std::move(x), static_cast<int>(iter));
+        }
+
+        template <class E1, class E2>
+        inline auto mixed_solve(const E1& A, const E2& b, std::false_type)
+        {
+            return std::make_tuple(solve_dispatch(A, b, std::integral_constant<std::size_t, 0>()), 0);
+        }
+
+        template <class E1, class E2>
+        inline auto mixed_solve_positive_definite(const E1& A, const E2& b, char uplo, std::true_type)
+        {
+            auto dA = copy_to_layout<layout_type::column_major>(A);
+            auto db = copy_to_layout<layout_type::column_major>(b);
+            auto x = db;
+            blas_index_t iter = 0;
+
+            int info = lapack::dsposv(dA, db, x, iter, uplo);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is not positive definite.");
+            }
+            return std::make_tuple(std::move(x), static_cast<int>(iter));
+        }
+
+        template <class E1, class E2>
+        inline auto mixed_solve_positive_definite(const E1& A, const E2& b, char uplo, std::false_type)
+        {
+            auto dA = copy_to_layout<layout_type::column_major>(A);
+            auto db = copy_to_layout<layout_type::column_major>(b);
+
+            int info = lapack::potr(dA, uplo);
+            if (info == 0)
+            {
+                info = lapack::potrs(dA, db, uplo);
+            }
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is not positive definite.");
+            }
+            return std::make_tuple(std::move(db), 0);
+        }
+    }
+
+    /**
+     * Solves a x = b with the factorization precision chosen by \em mode.
+     * In mixed precision, double and complex<double> systems are factored
+     * in single precision and the solution is refined to double precision
+     * (LAPACK dsgesv / zcgesv). When the refinement does not converge,
+     * LAPACK falls back to a double precision factorization. Other value
+     * types are always solved in full precision.
+     *
+     * @param a Coefficient matrix
+     * @param b Ordinate or “dependent variable” values.
+     * @param mode precision of the factorization
+     * @return tuple (x, iterations), where iterations is the number of
+     *         refinement steps, negative when LAPACK fell back to full
+     *         precision and 0 for full precision solves
+     */
+    template <class E1, class E2>
+    auto solve(const xexpression<E1>& A, const xexpression<E2>& b, solve_mode mode)
+    {
+        assert_nd_square(A);
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        if (mode == solve_mode::mixed_precision)
+        {
+            return detail::mixed_solve(A.derived_cast(), b.derived_cast(), detail::has_mixed_precision<value_type>());
+        }
+        return detail::mixed_solve(A.derived_cast(), b.derived_cast(), std::false_type());
+    }
+
+    /**
+     * Solves a x = b for a symmetric (Hermitian) positive definite matrix
+     * with a Cholesky factorization. Only the \em uplo triangle of a is read.
+     * In mixed precision, double and complex<double> systems are factored in
+     * single precision and refined to double precision (LAPACK dsposv /
+     * zcposv), with the same fallback as solve.
+     *
+     * @param a positive definite coefficient matrix
+     * @param b right hand side
+     * @param mode precision of the factorization
+     * @param uplo triangle of a to read, 'L' or 'U'
+     * @return tuple (x, iterations)
+     */
+    template <class E1, class E2>
+    auto solve_positive_definite(const xexpression<E1>& A, const xexpression<E2>& b,
+                                 solve_mode mode = solve_mode::full_precision, char uplo = 'L')
+    {
+        assert_nd_square(A);
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        if (mode == solve_mode::mixed_precision)
+        {
+            return detail::mixed_solve_positive_definite(A.derived_cast(), b.derived_cast(), uplo,
+                                                         detail::has_mixed_precision<value_type>());
+        }
+        return detail::mixed_solve_positive_definite(A.derived_cast(), b.derived_cast(), uplo, std::false_type());
+    }
+
+    namespace detail
+    {
+        template <class T>
+        inline bool positive_real(const T& x)
+        {
+            return std::imag(x) == 0 && std::real(x) > 0;
+        }
+
+        template <class E>
+        inline assume_a probe_structure(const E& A)
+        {
+            std::size_t n = A.shape()[0];
+            bool lower = true, upper = true, symmetric = true, hermitian = true;
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                for (std::size_t i = 0; i < j; ++i)
+                {
+                    auto above = A(i, j);
+                    auto below = A(j, i);
+                    lower = lower && above == decltype(above)(0);
+                    upper = upper && below == decltype(below)(0);
+                    symmetric = symmetric && above == below;
+                    hermitian = hermitian && above == conj_value(below);
+                }
+                if (!(lower || upper || symmetric || hermitian))
+                {
+                    return assume_a::general;
+                }
+                hermitian = hermitian && std::imag(A(j, j)) == 0;
+            }
+
+            if (lower)
+            {
+                return assume_a::lower_triangular;
+            }
+            if (upper)
+            {
+                return assume_a::upper_triangular;
+            }
+            if (hermitian)
+            {
+                bool positive_diagonal = true;
+                for (std::size_t i = 0; i < n && positive_diagonal; ++i)
+                {
+                    positive_diagonal = positive_real(A(i, i));
+                }
+                return positive_diagonal ? assume_a::positive_definite : assume_a::hermitian;
+            }
+            return symmetric ? assume_a::symmetric : assume_a::general;
+        }
+
+        template <class E, class F>
+        inline int indefinite_solve(E& A, F& b, std::true_type /*hermitian*/)
+        {
+            uvector<blas_index_t> piv(A.shape()[0]);
+            return lapack::hesv(A, piv, b, 'L');
+        }
+
+        template <class E, class F>
+        inline int indefinite_solve(E& A, F& b, std::false_type /*hermitian*/)
+        {
+            uvector<blas_index_t> piv(A.shape()[0]);
+            return lapack::sysv(A, piv, b, 'L');
+        }
+    }
+
+    /**
+     * Guesses the structure of the square matrix \em A in O(n^2) without
+     * factoring it: triangular, Hermitian with a positive real diagonal
+     * (a candidate for Cholesky), Hermitian, symmetric or general. The scan
+     * stops as soon as the matrix is known to be general.
+     *
+     * @param A square matrix
+     * @return the detected structure, never assume_a::detect
+     */
+    template <class E>
+    assume_a detect_structure(const xexpression<E>& A)
+    {
+        assert_nd_square(A);
+        return detail::probe_structure(A.derived_cast());
+    }
+
+    /**
+     * Solves a x = b with the factorization suited to the structure of a.
+     * Only the lower triangle of a is read for the symmetric, Hermitian and
+     * positive definite solvers. With assume_a::detect, the structure is
+     * taken from detect_structure, and a matrix that looked positive
+     * definite but is not falls back to the Hermitian solver.
+     *
+     * @param a Coefficient matrix
+     * @param b Ordinate or “dependent variable” values.
+     * @param structure structure assumed for a
+     * @return Solution to the system a x = b. Returned shape is identical to b.
+     */
+    template <class E1, class E2>
+    auto solve(const xexpression<E1>& A, const xexpression<E2>& b, assume_a structure)
+    {
+        assert_nd_square(A);
+        using value_type = typename E1::value_type;
+
+        bool detected = structure == assume_a::detect;
+        if (detected)
+        {
+            structure = detail::probe_structure(A.derived_cast());
+        }
+
+        auto dA = copy_to_layout<layout_type::column_major>(A.derived_cast());
+        auto db = copy_to_layout<layout_type::column_major>(b.derived_cast());
+
+        int info = 0;
+        switch (structure)
+        {
+            case assume_a::positive_definite:
+                info = lapack::posv(dA, db, 'L');
+                if (info > 0 && detected)
+                {
+                    // posv leaves b untouched when the factorization fails
+                    dA = copy_to_layout<layout_type::column_major>(A.derived_cast());
+                    info = detail::indefinite_solve(dA, db, xtl::is_complex<value_type>());
+                }
+                else if (info > 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is not positive definite.");
+                }
+                break;
+            case assume_a::hermitian:
+                info = detail::indefinite_solve(dA, db, xtl::is_complex<value_type>());
+                break;
+            case assume_a::symmetric:
+                info = detail::indefinite_solve(dA, db, std::false_type());
+                break;
+            case assume_a::lower_triangular:
+                info = lapack::trtrs(dA, db, 'L', 'N');
+                break;
+            case assume_a::upper_triangular:
+                info = lapack::trtrs(dA, db, 'U', 'N');
+                break;
+            default:
+                info = lapack::gesv(dA, db);
+                break;
+        }
+
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return db;
+    }
+
+    namespace detail
+    {
+        template <class M, class B, class R, class F>
+        inline int expert_solve(M& A, B& b, B& x, R& rcond, F& ferr, F& berr, bool positive_definite,
+                                bool equilibrate)
+        {
+            std::size_t n = std::max(A.shape()[0], std::size_t(1));
+            auto AF = A;
+            F scale_r = F::from_shape({n});
+            char equed = 'N';
+            char fact = equilibrate ? 'E' : 'N';
+            if (positive_definite)
+            {
+                return lapack::posvx(A, AF, b, x, equed, scale_r, rcond, ferr, berr, fact, 'L');
+            }
+            F scale_c = F::from_shape({n});
+            uvector<blas_index_t> piv(n);
+            return lapack::gesvx(A, AF, piv, b, x, equed, scale_r, scale_c, rcond, ferr, berr, fact, 'N');
+        }
+    }
+
+    /**
+     * Solves a x = b with the LAPACK expert drivers: gesvx, or posvx for
+     * assume_a::positive_definite (which reads the lower triangle of a).
+     * The other structures are solved by gesvx as general matrices, and
+     * assume_a::detect falls back to gesvx when a matrix that looked
+     * positive definite is not.
+     *
+     * Badly scaled matrices have their rows and columns equilibrated
+     * before the factorization, which is much cheaper than a least-squares
+     * solve. The solution is refined iteratively, and the condition and
+     * error estimates come from the same factorization.
+     *
+     * @param a Coefficient matrix
+     * @param b right hand side, a vector or a matrix of one column each
+     * @param structure structure assumed for a
+     * @param equilibrate scale a when LAPACK finds it badly scaled
+     * @return tuple (x, rcond, ferr, berr): the solution, the reciprocal
+     *         condition number estimate of the (scaled) matrix, and for each
+     *         column of x a forward error bound and the componentwise
+     *         relative backward error. A matrix singular to working
+     *         precision gives a small rcond rather than an exception.
+     */
+    template <class E1, class E2>
+    auto solve_refined(const xexpression<E1>& A, const xexpression<E2>& b,
+                       assume_a structure = assume_a::general, bool equilibrate = true)
+    {
+        assert_nd_square(A);
+        using real_type = xtl::complex_value_type_t<typename E1::value_type>;
+        using error_type = xtensor<real_type, 1, layout_type::column_major>;
+
+        bool detected = structure == assume_a::detect;
+        if (detected)
+        {
+            structure = detail::probe_structure(A.derived_cast());
+        }
+        bool positive_definite = structure == assume_a::positive_definite;
+
+        auto dA = copy_to_layout<layout_type::column_major>(A.derived_cast());
+        auto db = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        std::size_t n = dA.shape()[0];
+        if (db.dimension() == 0 || db.dimension() > 2 || db.shape()[0] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+        }
+        auto x = db;
+        std::size_t nrhs = std::max(db.dimension() > 1 ? db.shape()[1] : std::size_t(1), std::size_t(1));
+        error_type ferr = error_type::from_shape({nrhs});
+        error_type berr = error_type::from_shape({nrhs});
+        real_type rcond(0);
+
+        int info = detail::expert_solve(dA, db, x, rcond, ferr, berr, positive_definite, equilibrate);
+        if (positive_definite && info > 0 && std::size_t(info) <= n)
+        {
+            if (!detected)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is not positive definite.");
+            }
+            // posvx may have scaled a and b before the factorization failed
+            dA = copy_to_layout<layout_type::column_major>(A.derived_cast());
+            db = copy_to_layout<layout_type::column_major>(b.derived_cast());
+            info = detail::expert_solve(dA, db, x, rcond, ferr, berr, false, equilibrate);
+        }
+        if (info > 0 && std::size_t(info) <= n)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return std::make_tuple(std::move(x), rcond, std::move(ferr), std::move(berr));
+    }
+
+    namespace xblas_detail
+    {
+        /**
+         * Sets the strict upper (\em upper true) or lower triangle of the
+         * 2-D container \em A to zero. Contiguous column-major and row-major
+         * storage is cleared one contiguous segment per column (row), other
+         * layouts element by element.
+         */
+        template <class T>
+        inline void zero_strict_triangle(T& A, bool upper)
+        {
+            using value_type = typename T::value_type;
+
+            std::size_t rows = A.shape()[0];
+            std::size_t cols = A.shape()[1];
+            if (A.layout() != layout_type::column_major && A.layout() != layout_type::row_major)
+            {
+                for (std::size_t j = 0; j < cols; ++j)
+                {
+                    for (std::size_t i = upper ? 0 : j + 1; i < (upper ? std::min(j, rows) : rows); ++i)
+                    {
+                        A(i, j) = value_type(0);
+                    }
+                }
+                return;
+            }
+
+            // row-major storage is the column-major storage of the transpose
+            if (A.layout() == layout_type::row_major)
+            {
+                std::swap(rows, cols);
+                upper = !upper;
+            }
+            value_type* a = A.data();
+            for (std::size_t j = 0; j < cols; ++j)
+            {
+                value_type* col = a + j * rows;
+                if (upper)
+                {
+                    std::fill_n(col, std::min(j, rows), value_type(0));
+                }
+                else if (j + 1 < rows)
+                {
+                    std::fill_n(col + j + 1, rows - j - 1, value_type(0));
+                }
+            }
+        }
+    }
+
+    namespace detail
+    {
+        /**
+         * Sets the strict upper triangle of the square column-major \em A to
+         * the (conjugate) transpose of its strict lower triangle, in tiles so
+         * that the strided reads of the rows stay in cache.
+         */
+        template <class T>
+        inline void mirror_lower(T& A, bool conjugate)
+        {
+            using value_type = typename T::value_type;
+
+            std::size_t n = A.shape()[0];
+            value_type* a = A.data();
+            constexpr std::size_t tile = 32;
+            for (std::size_t j0 = 0; j0 < n; j0 += tile)
+            {
+                std::size_t j1 = std::min(j0 + tile, n);
+                for (std::size_t i0 = 0; i0 < j1; i0 += tile)
+                {
+                    std::size_t i1 = std::min(i0 + tile, n);
+                    for (std::size_t j = j0; j < j1; ++j)
+                    {
+                        // upper entries (i, j), i < j, of column j
+                        for (std::size_t i = i0; i < std::min(i1, j); ++i)
+                        {
+                            value_type v = a[i * n + j];
+                            a[j * n + i] = conjugate ? conj_value(v) : v;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Compute the (multiplicative) inverse of a matrix in the buffer of the caller.
+     *
+     * @param A Square, column-major matrix, overwritten with its inverse
+     * @return reference to \em A
+     */
+    template <class E1>
+    E1& inv_inplace(E1& A)
+    {
+        assert_nd_square(A);
+        detail::check_inplace_operand(A, "inv_inplace");
+
+        uvector<blas_index_t> piv(std::min(A.shape()[0], A.shape()[1]));
+
+        // DEV note: numpy uses gesv here, instead of getrf and getri. Might
+        //           be interesting to investigate if there is a perf or accuracy
+        //           difference.
+        int info = lapack::getrf(A, piv);
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (getrf).");
+        }
+
+        info = lapack::getri(A, piv);
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (getri).");
+        }
+        return A;
+    }
+
+    namespace detail
+    {
+        template <class E>
+        inline auto inv_impl(const E& A, std::false_type /*is_static_row_major*/)
+        {
+            auto dA = copy_to_layout<layout_type::column_major>(A);
+            inv_inplace(dA);
+            return dA;
+        }
+
+        template <class E>
+        inline auto inv_impl(const E& A, std::true_type /*is_static_row_major*/)
+        {
+            // inv(A^T) = inv(A)^T: invert the column-major view of the buffer
+            // and hand the result back as row-major storage
+            auto dA = transposed_column_major(A);
+            inv_inplace(dA);
+            return transposed_row_major<row_major_matrix_t<E>>(std::move(dA));
+        }
+
+        template <class E>
+        inline auto inv_dispatch(const E& A, std::integral_constant<std::size_t, 0>)
+        {
+            return inv_impl(A, is_static_row_major<E>());
+        }
+
+        template <class E, std::size_t N>
+        inline auto inv_dispatch(const E& A, std::integral_constant<std::size_t, N>)
+        {
+            using value_type = typename E::value_type;
+
+            auto result = fixed_identity<value_type, N>();
+            if (!fixed_solve_inplace<N>(load_fixed_matrix<value_type, N>(A), result))
+            {
+                XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible.");
+            }
+            return store_fixed<fixed_matrix<value_type, N>>(result);
+        }
+    }
+
+    /**
+     * Compute the (multiplicative) inverse of a matrix.
+     * The result has the layout of \em A when \em A is row-major. Small
+     * matrices whose shape is known at compile time are inverted in closed
+     * form (adjugate for 2x2 and 3x3) and return an xtensor_fixed.
+     *
+     * @param A xexpression to be inverted
+     * @return (Multiplicative) inverse of the matrix a.
+     */
+    template <class E1>
+    auto inv(const xexpression<E1>& A)
+    {
+        assert_nd_square(A);
+        return detail::inv_dispatch(A.derived_cast(), detail::fixed_square_order<E1>());
+    }
+
+    /**
+     * Compute the inverse of a matrix directly in a container of type \em R.
+     * A row-major result holds A^T when read column-major, so that it is
+     * inverted in place into inv(A)^T, i.e. inv(A) in row-major order: the
+     * only copy is that of \em A into the result.
+     *
+     * @param A xexpression to be inverted
+     * @return (Multiplicative) inverse of the matrix a, an \em R
+     */
+    template <class E1, class R>
+    R inv(const xexpression<E1>& A, result_as<R>)
+    {
+        static_assert(std::is_same<typename R::value_type, typename E1::value_type>::value,
+                      "result_as: the container must hold the value type of the result");
+        assert_nd_square(A);
+
+        const auto& a = A.derived_cast();
+        std::size_t n = a.shape()[0];
+        R result = detail::make_result<R>(std::array<std::size_t, 2>{n, n});
+        if (result.layout() != layout_type::row_major && result.layout() != layout_type::column_major)
+        {
+            XTENSOR_THROW(std::runtime_error, "inv: the result has to be row or column major.");
+        }
+        noalias(result) = a;
+        auto buffer = xt::adapt<layout_type::column_major>(result.data(), n * n, xt::no_ownership(),
+                                                           std::array<std::size_t, 2>{n, n});
+        inv_inplace(buffer);
+        return result;
+    }
+
+    namespace detail
+    {
+        // inverse of a Hermitian indefinite matrix from its lower triangle
+        template <class M>
+        inline void indefinite_inv(M& A, std::true_type /*hermitian*/)
+        {
+            uvector<blas_index_t> piv(std::max(A.shape()[0], std::size_t(1)));
+            if (lapack::hetrf(A, piv, 'L') > 0 || lapack::hetri(A, piv, 'L') > 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (hetri).");
+            }
+            mirror_lower(A, true);
+        }
+
+        // inverse of a (complex) symmetric matrix from its lower triangle
+        template <class M>
+        inline void indefinite_inv(M& A, std::false_type /*hermitian*/)
+        {
+            uvector<blas_index_t> piv(std::max(A.shape()[0], std::size_t(1)));
+            if (lapack::sytrf(A, piv, 'L') > 0 || lapack::sytri(A, piv, 'L') > 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (sytri).");
+            }
+            mirror_lower(A, false);
+        }
+    }
+
+    /**
+     * Compute the inverse of a matrix of known structure, with the LAPACK
+     * routines suited to it, which take roughly half the flops of LU:
+     * potrf and potri for positive definite matrices, sytrf and sytri
+     * (hetrf and hetri) for symmetric (Hermitian) ones, trtri for
+     * triangular ones. Only the lower triangle of symmetric, Hermitian and
+     * positive definite matrices is read, and the inverse is returned full.
+     * With assume_a::detect, a matrix that looked positive definite but whose
+     * Cholesky factorization fails is inverted as symmetric (Hermitian).
+     *
+     * @param A square matrix
+     * @param structure structure of \em A, or assume_a::detect
+     * @return column-major inverse of \em A
+     */
+    template <class E1>
+    auto inv(const xexpression<E1>& A, assume_a structure)
+    {
+        using value_type = typename E1::value_type;
+
+        assert_nd_square(A);
+        bool detected = structure == assume_a::detect;
+        if (detected)
+        {
+            structure = detail::probe_structure(A.derived_cast());
+        }
+
+        auto dA = copy_to_layout<layout_type::column_major>(A.derived_cast());
+        switch (structure)
+        {
+            case assume_a::positive_definite:
+            {
+                int info = lapack::potr(dA, 'L');
+                if (info == 0)
+                {
+                    info = lapack::potri(dA, 'L');
+                    if (info > 0)
+                    {
+                        XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (potri).");
+                    }
+                    detail::mirror_lower(dA, true);
+                }
+                else if (detected)
+                {
+                    dA = copy_to_layout<layout_type::column_major>(A.derived_cast());
+                    detail::indefinite_inv(dA, xtl::is_complex<value_type>());
+                }
+                else
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is not positive definite.");
+                }
+                break;
+            }
+            case assume_a::hermitian:
+                detail::indefinite_inv(dA, xtl::is_complex<value_type>());
+                break;
+            case assume_a::symmetric:
+                detail::indefinite_inv(dA, std::false_type());
+                break;
+            case assume_a::lower_triangular:
+            case assume_a::upper_triangular:
+            {
+                bool lower = structure == assume_a::lower_triangular;
+                if (lapack::trtri(dA, lower ? 'L' : 'U', 'N') > 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (trtri).");
+                }
+                xblas_detail::zero_strict_triangle(dA, lower);
+                break;
+            }
+            default:
+                inv_inplace(dA);
+                break;
+        }
+        return dA;
+    }
+
+    namespace detail
+    {
+        /**
+         * Runs geev for the right eigenvectors of a real matrix.
+         * @return tuple (wr, wi, VR) as computed by LAPACK
+         */
+        template <class E>
+        inline auto real_geev_vectors(const E& A)
+        {
+            using value_type = typename E::value_type;
+
+            auto M = copy_to_layout<layout_type::column_major>(A);
+
+            std::size_t N = M.shape()[0];
+            std::array<std::size_t, 1> vN = {N};
+            xtensor<value_type, 1, layout_type::column_major> wr(vN), wi(vN);
+
+            // VL is not referenced with jobvl N, but needs a leading
+            // dimension of at least 1
+            std::array<std::size_t, 2> shp = {N, N};
+            std::array<std::size_t, 2> shp_l = {1, 1};
+            xtensor<value_type, 2, layout_type::column_major> VL(shp_l), VR(shp);
+
+            // jobvl N: left eigenvectors of A are not computed
+            // jobvr V: then right eigenvectors of A are computed
+            int info = lapack::geev(M, 'N', 'V', wr, wi, VL, VR);
+
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue calculation did not converge.");
+            }
+            return std::make_tuple(std::move(wr), std::move(wi), std::move(VR));
+        }
+
+        /**
+         * Expands the packed real eigenvectors of geev into complex
+         * eigenvectors: a conjugate pair (wi(j) > 0, wi(j + 1) < 0) stores
+         * the real and imaginary parts in columns j and j + 1.
+         *
+         * The columns are classified once, then copied in row blocks so that
+         * the column reads of VR stay contiguous while the rows written to
+         * \em out remain in cache.
+         */
+        template <class W, class V, class R>
+        inline void assemble_eigenvectors(const W& wi, const V& VR, R& out)
+        {
+            using complex_type = typename R::value_type;
+            using real_type = typename complex_type::value_type;
+
+            std::size_t N = VR.shape()[0];
+            // offset of the imaginary part column, 0 for real eigenvectors,
+            // and its sign
+            std::vector<std::size_t> imag_col(N, 0);
+            std::vector<real_type> imag_sign(N, real_type(0));
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                if (wi(j) != 0 && j + 1 < N)
+                {
+                    imag_col[j] = j + 1;
+                    imag_sign[j] = real_type(1);
+                    imag_col[j + 1] = j + 1;
+                    imag_sign[j + 1] = real_type(-1);
+                    // the second column of the pair holds the imaginary part
+                    ++j;
+                }
+            }
+
+            const real_type* vr = VR.data();
+            complex_type* o = out.data();
+            constexpr std::size_t block = 64;
+            for (std::size_t i0 = 0; i0 < N; i0 += block)
+            {
+                std::size_t i1 = std::min(i0 + block, N);
+                for (std::size_t j = 0; j < N; ++j)
+                {
+                    // the first column of the pair holds the real part
+                    const real_type* re = vr + (imag_sign[j] < 0 ? j - 1 : j) * N;
+                    if (imag_sign[j] == 0)
+                    {
+                        for (std::size_t i = i0; i < i1; ++i)
+                        {
+                            o[i * N + j] = complex_type(re[i], real_type(0));
+                        }
+                    }
+                    else
+                    {
+                        const real_type* im = vr + imag_col[j] * N;
+                        real_type sign = imag_sign[j];
+                        for (std::size_t i = i0; i < i1; ++i)
+                        {
+                            o[i * N + j] = complex_type(re[i], sign * im[i]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Compute the eigenvalues and right eigenvectors of a square array.
+     *
+     * @param Matrix for which the eigenvalues and right eigenvectors will be computed
+     * @return (eigenvalues, eigenvectors) tuple. The first element corresponds to the eigenvalues,
+     *         each repeated according to its multiplicity. The eigenvalues are not necessarily
+     *         ordered. The second (1) element are the normalized (unit “length”) eigenvectors,
+     *         such that the column v[:, i] corresponds to the eigenvalue w[i].
+     */
+    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eig(const xexpression<E>& A)
+    {
+        using underlying_type = typename E::value_type;
+
+        assert_nd_square(A);
+        auto res = detail::real_geev_vectors(A.derived_cast());
+        const auto& wr = std::get<0>(res);
+        const auto& wi = std::get<1>(res);
+        std::size_t N = wr.size();
+
+        auto eig_vecs = xtensor<std::complex<underlying_type>, 2>::from_shape({ N, N });
+        auto eig_vals = xtensor<std::complex<underlying_type>, 1>::from_shape({ N });
+
+        xt::real(eig_vals) = wr;
+        xt::imag(eig_vals) = wi;
+
+        detail::assemble_eigenvectors(wi, std::get<2>(res), eig_vecs);
+
+        return std::make_tuple(std::move(eig_vals), std::move(eig_vecs));
+    }
+
+    /**
+     * Compute the eigenvalues and right eigenvectors of a real square array
+     * in the real form computed by LAPACK, without building complex results.
+     *
+     * A real eigenvalue wr[j] has the eigenvector VR[:, j]. A complex
+     * conjugate pair wr[j] +/- i wi[j], with wi[j] > 0, is stored in
+     * consecutive entries and has the eigenvectors VR[:, j] +/- i VR[:, j + 1].
+     *
+     * @param A Matrix for which the eigenvalues and right eigenvectors are computed
+     * @return tuple (wr, wi, VR) of the real and imaginary parts of the
+     *         eigenvalues and the packed column-major eigenvectors
+     */
+    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eig_split(const xexpression<E>& A)
+    {
+        assert_nd_square(A);
+        return detail::real_geev_vectors(A.derived_cast());
+    }
+
+    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eig(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+
+        assert_nd_square(A);
+        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+
+        std::size_t N = M.shape()[0];
+        std::array<std::size_t, 1> vN = {N};
+        xtensor<value_type, 1, layout_type::column_major> w(vN);
+
+        std::array<std::size_t, 2> shp = {N, N};
+        xtensor<value_type, 2, layout_type::column_major> VL(shp), VR(shp);
+
+        // jobvl N: left eigenvectors of A are not computed
+        // jobvr V: then right eigenvectors of A are computed
+        int info = lapack::geev(M, 'N', 'V', w, VL, VR);
+
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue calculation did not converge.");
+        }
+
+        return std::make_tuple(std::move(w), std::move(VR));
+    }
+
+    namespace detail
+    {
+        template <class E1, class E2>
+        inline void assert_generalized_pair(const E1& A, const E2& B)
+        {
+            assert_nd_square(A);
+            assert_nd_square(B);
+            if (A.shape()[0] != B.shape()[0])
+            {
+                XTENSOR_THROW(std::runtime_error, "A and B must have the same shape.");
+            }
+        }
+
+        /// alpha / beta, infinite for beta = 0 and NaN for alpha = beta = 0
+        template <class T>
+        inline std::complex<T> generalized_eigenvalue(const std::complex<T>& alpha, const std::complex<T>& beta)
+        {
+            if (beta == std::complex<T>(0))
+            {
+                return std::complex<T>(alpha == std::complex<T>(0) ? std::numeric_limits<T>::quiet_NaN()
+                                                                   : std::numeric_limits<T>::infinity(), T(0));
+            }
+            return alpha / beta;
+        }
+
+        template <class M>
+        inline auto generalized_eig(M& A, M& B, std::false_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+
+            std::size_t N = A.shape()[0];
+            std::array<std::size_t, 1> vN = {N};
+            xtensor<value_type, 1, layout_type::column_major> alphar(vN), alphai(vN), beta(vN);
+            // VL is not referenced with jobvl N
+            std::array<std::size_t, 2> shp = {N, N};
+            std::array<std::size_t, 2> shp_l = {1, 1};
+            xtensor<value_type, 2, layout_type::column_major> VL(shp_l), VR(shp);
+
+            int info = lapack::ggev(A, B, 'N', 'V', alphar, alphai, beta, VL, VR);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue calculation did not converge.");
+            }
+
+            auto w = xtensor<std::complex<value_type>, 1>::from_shape({N});
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                w(j) = generalized_eigenvalue(std::complex<value_type>(alphar(j), alphai(j)),
+                                              std::complex<value_type>(beta(j)));
+            }
+            // the eigenvectors are packed as by geev
+            auto V = xtensor<std::complex<value_type>, 2>::from_shape({N, N});
+            assemble_eigenvectors(alphai, VR, V);
+            return std::make_tuple(std::move(w), std::move(V));
+        }
+
+        template <class M>
+        inline auto generalized_eig(M& A, M& B, std::true_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+
+            std::size_t N = A.shape()[0];
+            std::array<std::size_t, 1> vN = {N};
+            xtensor<value_type, 1, layout_type::column_major> alpha(vN), beta(vN);
+            std::array<std::size_t, 2> shp = {N, N};
+            std::array<std::size_t, 2> shp_l = {1, 1};
+            xtensor<value_type, 2, layout_type::column_major> VL(shp_l), VR(shp);
+
+            int info = lapack::ggev(A, B, 'N', 'V', alpha, beta, VL, VR);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue calculation did not converge.");
+            }
+
+            auto w = xtensor<value_type, 1>::from_shape({N});
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                w(j) = generalized_eigenvalue(alpha(j), beta(j));
+            }
+            return std::make_tuple(std::move(w), std::move(VR));
+        }
+    }
+
+    /**
+     * Compute the generalized eigenvalues and right eigenvectors of the
+     * square pair (A, B), A v = w B v, with LAPACK ggev. Neither matrix
+     * needs to be symmetric, and B may be singular.
+     *
+     * @param A,B Matrices of the generalized problem
+     * @return tuple (w, V) of the complex eigenvalues w[j] = alpha[j] / beta[j],
+     *         infinite where beta[j] is 0, and the eigenvectors as columns
+     *         of V, each scaled so that its largest component has
+     *         |re| + |im| = 1
+     */
+    template <class E1, class E2>
+    auto eig(const xexpression<E1>& A, const xexpression<E2>& B)
+    {
+        using value_type = typename E1::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        detail::assert_generalized_pair(A.derived_cast(), B.derived_cast());
+        matrix_type M1 = A.derived_cast();
+        matrix_type M2 = B.derived_cast();
+        return detail::generalized_eig(M1, M2, xtl::is_complex<value_type>());
+    }
+
+    /// Selects the eigenvectors computed by eig
+    enum class eig_vectors {
+        none,   ///< Eigenvalues only
+        right,  ///< Right eigenvectors, A v = w v
+        left,   ///< Left eigenvectors, u^H A = w u^H
+        both    ///< Left and right eigenvectors
+    };
+
+    /// Selects the balancing applied by eig before the reduction (gebal / gebak)
+    enum class eig_balance {
+        none,     ///< No balancing
+        permute,  ///< Permute to isolate eigenvalues
+        scale,    ///< Scale rows and columns to make their norms closer
+        both      ///< Permute and scale, as eig without options
+    };
+
+    namespace detail
+    {
+        inline char eig_balance_job(eig_balance balance)
+        {
+            switch (balance)
+            {
+                case eig_balance::none:
+                    return 'N';
+                case eig_balance::permute:
+                    return 'P';
+                case eig_balance::scale:
+                    return 'S';
+                default:
+                    return 'B';
+            }
+        }
+
+        // eigenvector matrix passed to geevx: N x N when computed, placeholder otherwise
+        template <class T>
+        inline xtensor<T, 2, layout_type::column_major> geevx_vectors(std::size_t N, char job)
+        {
+            std::size_t n = job == 'V' ? N : std::size_t(1);
+            return xtensor<T, 2, layout_type::column_major>::from_shape({n, n});
+        }
+
+        template <class T>
+        inline xtensor<T, 1, layout_type::column_major> geevx_vector(std::size_t N)
+        {
+            return xtensor<T, 1, layout_type::column_major>::from_shape({std::max(N, std::size_t(1))});
+        }
+
+        /**
+         * Runs geevx on a copy of \em A.
+         * @return tuple (w, VL, VR, rconde, rcondv), with complex eigenvalues
+         *         and eigenvectors; the eigenvectors not computed and the
+         *         condition numbers without \em sense are empty
+         */
+        template <class E>
+        inline auto eig_expert(const E& A, char balanc, char jobvl, char jobvr, char sense, std::false_type /*is_complex*/)
+        {
+            using value_type = typename E::value_type;
+            using complex_type = std::complex<value_type>;
+
+            auto M = copy_to_layout<layout_type::column_major>(A);
+            std::size_t N = M.shape()[0];
+            std::array<std::size_t, 1> vN = {N};
+            xtensor<value_type, 1, layout_type::column_major> wr(vN), wi(vN);
+            auto VL = geevx_vectors<value_type>(N, jobvl);
+            auto VR = geevx_vectors<value_type>(N, jobvr);
+            auto scale = geevx_vector<value_type>(N);
+            auto rconde = geevx_vector<value_type>(sense == 'N' ? 1 : N);
+            auto rcondv = geevx_vector<value_type>(sense == 'N' ? 1 : N);
+            blas_index_t ilo = 0, ihi = 0;
+            value_type abnrm = 0;
+
+            int info = lapack::geevx(M, balanc, jobvl, jobvr, sense, wr, wi, VL, VR, ilo, ihi, scale, abnrm, rconde, rcondv);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue calculation did not converge.");
+            }
+
+            auto w = xtensor<complex_type, 1>::from_shape({N});
+            xt::real(w) = wr;
+            xt::imag(w) = wi;
+
+            auto vectors = [&](const auto& V, char job) {
+                std::size_t n = job == 'V' ? N : 0;
+                auto result = xtensor<complex_type, 2>::from_shape({n, n});
+                if (n != 0)
+                {
+                    assemble_eigenvectors(wi, V, result);
+                }
+                return result;
+            };
+            auto vl = vectors(VL, jobvl);
+            auto vr = vectors(VR, jobvr);
+            if (sense == 'N')
+            {
+                rconde.resize({0});
+                rcondv.resize({0});
+            }
+            return std::make_tuple(std::move(w), std::move(vl), std::move(vr), std::move(rconde), std::move(rcondv));
+        }
+
+        template <class E>
+        inline auto eig_expert(const E& A, char balanc, char jobvl, char jobvr, char sense, std::true_type /*is_complex*/)
+        {
+            using value_type = typename E::value_type;
+            using real_type = xtl::complex_value_type_t<value_type>;
+
+            auto M = copy_to_layout<layout_type::column_major>(A);
+            std::size_t N = M.shape()[0];
+            std::array<std::size_t, 1> vN = {N};
+            xtensor<value_type, 1, layout_type::column_major> w(vN);
+            auto VL = geevx_vectors<value_type>(N, jobvl);
+            auto VR = geevx_vectors<value_type>(N, jobvr);
+            auto scale = geevx_vector<real_type>(N);
+            auto rconde = geevx_vector<real_type>(sense == 'N' ? 1 : N);
+            auto rcondv = geevx_vector<real_type>(sense == 'N' ? 1 : N);
+            blas_index_t ilo = 0, ihi = 0;
+            real_type abnrm = 0;
+
+            int info = lapack::geevx(M, balanc, jobvl, jobvr, sense, w, VL, VR, ilo, ihi, scale, abnrm, rconde, rcondv);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue calculation did not converge.");
+            }
+
+            if (jobvl != 'V')
+            {
+                VL.resize({0, 0});
+            }
+            if (jobvr != 'V')
+            {
+                VR.resize({0, 0});
+            }
+            if (sense == 'N')
+            {
+                rconde.resize({0});
+                rcondv.resize({0});
+            }
+            return std::make_tuple(std::move(w), std::move(VL), std::move(VR), std::move(rconde), std::move(rcondv));
+        }
+    }
+
+    /**
+     * Compute the eigenvalues and the selected left and right eigenvectors
+     * of a square array, with the given balancing, by LAPACK geevx. Only the
+     * eigenvectors requested are allocated.
+     *
+     * The left eigenvectors satisfy u[:, i]^H A = w[i] u[:, i]^H, which saves
+     * inverting the right eigenvectors.
+     *
+     * @param A Matrix for which the eigenvalues are computed
+     * @param vectors eigenvectors to compute
+     * @param balance balancing of \em A before the reduction
+     * @return tuple (w, vl, vr) of the eigenvalues and the left and right
+     *         eigenvectors, as complex arrays; the eigenvectors that are not
+     *         computed are empty
+     */
+    template <class E>
+    auto eig(const xexpression<E>& A, eig_vectors vectors, eig_balance balance = eig_balance::both)
+    {
+        assert_nd_square(A);
+        char jobvl = vectors == eig_vectors::left || vectors == eig_vectors::both ? 'V' : 'N';
+        char jobvr = vectors == eig_vectors::right || vectors == eig_vectors::both ? 'V' : 'N';
+        auto res = detail::eig_expert(A.derived_cast(), detail::eig_balance_job(balance), jobvl, jobvr, 'N',
+                                      xtl::is_complex<typename E::value_type>());
+        return std::make_tuple(std::move(std::get<0>(res)), std::move(std::get<1>(res)), std::move(std::get<2>(res)));
+    }
+
+    /**
+     * Compute the eigenvalues, the left and right eigenvectors and their
+     * reciprocal condition numbers by LAPACK geevx.
+     *
+     * @param A Matrix for which the eigenvalues are computed
+     * @param balance balancing of \em A before the reduction
+     * @return tuple (w, vl, vr, rconde, rcondv) of the eigenvalues, the left
+     *         and right eigenvectors, and the reciprocal condition numbers of
+     *         the eigenvalues and of the right eigenvectors
+     */
+    template <class E>
+    auto eig_condition(const xexpression<E>& A, eig_balance balance = eig_balance::both)
+    {
+        assert_nd_square(A);
+        return detail::eig_expert(A.derived_cast(), detail::eig_balance_job(balance), 'V', 'V', 'B',
+                                  xtl::is_complex<typename E::value_type>());
+    }
+
+    /**
+     * Compute the eigenvalues and eigenvectors of a square Hermitian or real symmetric
+     * matrix in the buffer of the caller.
+     *
+     * @param A Column-major matrix, overwritten with the orthonormal eigenvectors
+     * @return xtensor containing the eigenvalues in ascending order.
+     */
+    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eigh_inplace(E& A, char UPLO = 'L')
+    {
+        using value_type = typename E::value_type;
+
+        assert_nd_square(A);
+        detail::check_inplace_operand(A, "eigh_inplace");
+
+        std::size_t N = A.shape()[0];
+        std::array<std::size_t, 1> vN = {N};
+        xtensor<value_type, 1, layout_type::column_major> w(vN);
+
+        int info = lapack::syevd(A, 'V', UPLO, w);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+
+        return w;
+    }
+
+    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eigh_inplace(E& A, char UPLO = 'L')
+    {
+        using value_type = typename E::value_type;
+        using underlying_value_type = typename value_type::value_type;
+
+        assert_nd_square(A);
+        detail::check_inplace_operand(A, "eigh_inplace");
+
+        std::size_t N = A.shape()[0];
+        std::array<std::size_t, 1> vN = {N};
+        xtensor<underlying_value_type, 1, layout_type::column_major> w(vN);
+
+        int info = lapack::heevd(A, 'V', UPLO, w);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+
+        return w;
+    }
+
+    /**
+     * Compute the eigenvalues and eigenvectors of a square Hermitian or real symmetric xexpression.
+     *
+     * @param A Matrix for which the eigenvalues and right eigenvectors are computed
+     * @return xtensor containing the eigenvalues.
+     */
+    template <class E>
+    auto eigh(const xexpression<E>& A, char UPLO = 'L')
+    {
+        assert_nd_square(A);
+        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+
+        auto w = eigh_inplace(M, UPLO);
+        return std::make_tuple(std::move(w), std::move(M));
+    }
+
+    namespace detail
+    {
+        template <class M, class W>
+        inline int generalized_eigen(M& A, M& B, char jobz, char uplo, W& w, std::false_type /*is_complex*/)
+        {
+            return lapack::sygvd(A, B, 1, jobz, uplo, w);
+        }
+
+        template <class M, class W>
+        inline int generalized_eigen(M& A, M& B, char jobz, char uplo, W& w, std::true_type /*is_complex*/)
+        {
+            return lapack::hegvd(A, B, 1, jobz, uplo, w);
+        }
+    }
+
+    /**
+     * Compute the generalized eigenvalues and eigenvectors of A x = lambda B x,
+     * for a Hermitian or real symmetric A and a Hermitian or real symmetric
+     * positive definite B, with the divide and conquer sygvd / hegvd.
+     *
+     * To solve for many A with the same B, generalized_eigh_factor
+     * factors B once.
+     *
+     * @param A,B Matrices for which the generalized eigenvalues and right eigenvectors are computed
+     * @param UPLO triangle of A and B to read
+     * @return tuple (w, V) of the ascending eigenvalues and the B-orthonormal
+     *         eigenvectors as columns of V
+     */
+    template <class E1, class E2>
+    auto eigh(const xexpression<E1>& A, const xexpression<E2>& B, const char UPLO = 'L')
+    {
+        using value_type = typename E1::value_type;
+        using underlying_value_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        detail::assert_generalized_pair(A.derived_cast(), B.derived_cast());
+        matrix_type M1 = A.derived_cast();
+        matrix_type M2 = B.derived_cast();
+
+        std::size_t N = M1.shape()[0];
+        std::array<std::size_t, 1> vN = {N};
+        xtensor<underlying_value_type, 1, layout_type::column_major> w(vN);
+
+        int info = detail::generalized_eigen(M1, M2, 'V', UPLO, w, xtl::is_complex<value_type>());
+        if (info > static_cast<int>(N))
+        {
+            XTENSOR_THROW(std::runtime_error, "Matrix B is not positive definite.");
+        }
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+
+        return std::make_tuple(std::move(w), std::move(M1));
+    }
+
+    /**
+     * Compute the eigenvalues of a square xexpression.
+     *
+     * @param A Matrix for which the eigenvalues are computed
+     * @return xtensor containing the eigenvalues.
+     */
+    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eigvals(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+
+        assert_nd_square(A);
+        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+
+        std::size_t N = M.shape()[0];
+        std::array<std::size_t, 1> vN = {N};
+        xtensor<value_type, 1, layout_type::column_major> wr(vN);
+        xtensor<value_type, 1, layout_type::column_major> wi(vN);
+
+        // VL and VR are not referenced without eigenvectors, but need a
+        // leading dimension of at least 1
+        std::array<std::size_t, 2> shp = {1, 1};
+        xtensor<value_type, 2, layout_type::column_major> VL(shp);
+        xtensor<value_type, 2, layout_type::column_major> VR(shp);
+
+        auto info = lapack::geev(M, 'N', 'N', wr, wi, VL, VR);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Failed to compute eigenvalue " +
+                std::to_string(std::abs(info)) + ".");
+        }
+
+        xtensor<std::complex<value_type>, 1> eig_vals;
+        eig_vals.resize({N});
+
+        xt::real(eig_vals) = wr;
+        xt::imag(eig_vals) = wi;
+
+        return eig_vals;
+    }
+
+    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eigvals(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+
+        assert_nd_square(A);
+        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+
+        std::size_t N = M.shape()[0];
+        std::array<std::size_t, 1> vN = {N};
+        xtensor<value_type, 1, layout_type::column_major> w(vN);
+
+        std::array<std::size_t, 2> shp = {1, 1};
+        xtensor<value_type, 2, layout_type::column_major> VL(shp);
+        xtensor<value_type, 2, layout_type::column_major> VR(shp);
+
+        auto info = lapack::geev(M, 'N', 'N', w, VL, VR);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Failed to compute eigenvalue " +
+                std::to_string(std::abs(info)) + ".");
+        }
+
+        using value_type = typename E::value_type;
+
+        return w;
+    }
+
+    /**
+     * Compute the eigenvalues of a real square xexpression as separate real
+     * and imaginary parts, without building a complex result. Complex
+     * conjugate pairs are consecutive, with the positive imaginary part first.
+     *
+     * @param A Matrix for which the eigenvalues are computed
+     * @return tuple (wr, wi) of the real and imaginary parts
+     */
+    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eigvals_split(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+
+        assert_nd_square(A);
+        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+
+        std::size_t N = M.shape()[0];
+        std::array<std::size_t, 1> vN = {N};
+        xtensor<value_type, 1, layout_type::column_major> wr(vN);
+        xtensor<value_type, 1, layout_type::column_major> wi(vN);
+
+        std::array<std::size_t, 2> shp = {1, 1};
+        xtensor<value_type, 2, layout_type::column_major> VL(shp);
+        xtensor<value_type, 2, layout_type::column_major> VR(shp);
+
+        auto info = lapack::geev(M, 'N', 'N', wr, wi, VL, VR);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Failed to compute eigenvalue " +
+                std::to_string(std::abs(info)) + ".");
+        }
+
+        return std::make_tuple(std::move(wr), std::move(wi));
+    }
+
+    /// Selects the eigenvalues schur moves to the leading block of the Schur form
+    enum class schur_sort {
+        none,               ///< Keep the order computed by LAPACK
+        left_half_plane,    ///< Eigenvalues with a negative real part
+        inside_unit_circle  ///< Eigenvalues with a modulus less than 1
+    };
+
+    namespace detail
+    {
+        template <class T>
+        inline blas_index_t schur_left_half_plane(const T* re, const T* /*im*/)
+        {
+            return *re < T(0);
+        }
+
+        template <class T>
+        inline blas_index_t schur_inside_unit_circle(const T* re, const T* im)
+        {
+            return std::hypot(*re, *im) < T(1);
+        }
+
+        template <class T>
+        inline blas_index_t schur_left_half_plane(const std::complex<T>* w)
+        {
+            return w->real() < T(0);
+        }
+
+        template <class T>
+        inline blas_index_t schur_inside_unit_circle(const std::complex<T>* w)
+        {
+            return std::abs(*w) < T(1);
+        }
+
+        template <class M>
+        inline auto schur_impl(M& A, schur_sort sort, bool compute_vectors, std::false_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+
+            std::size_t N = A.shape()[0];
+            std::array<std::size_t, 1> vN = {N};
+            std::size_t NZ = compute_vectors ? N : 0;
+            std::array<std::size_t, 2> shp = {NZ, NZ};
+            xtensor<value_type, 1, layout_type::column_major> wr(vN);
+            xtensor<value_type, 1, layout_type::column_major> wi(vN);
+            xtensor<value_type, 2, layout_type::column_major> Z(shp);
+
+            blas_index_t (*select)(const value_type*, const value_type*) = &schur_inside_unit_circle<value_type>;
+            if (sort == schur_sort::left_half_plane)
+            {
+                select = &schur_left_half_plane<value_type>;
+            }
+            blas_index_t sdim = 0;
+            int info = lapack::gees(A, compute_vectors ? 'V' : 'N', sort == schur_sort::none ? 'N' : 'S', select,
+                                    sdim, wr, wi, Z);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Schur decomposition did not converge.");
+            }
+            return std::make_tuple(std::move(Z), static_cast<std::size_t>(sdim));
+        }
+
+        template <class M>
+        inline auto schur_impl(M& A, schur_sort sort, bool compute_vectors, std::true_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+            using underlying_value_type = typename value_type::value_type;
+
+            std::size_t N = A.shape()[0];
+            std::array<std::size_t, 1> vN = {N};
+            std::size_t NZ = compute_vectors ? N : 0;
+            std::array<std::size_t, 2> shp = {NZ, NZ};
+            xtensor<value_type, 1, layout_type::column_major> w(vN);
+            xtensor<value_type, 2, layout_type::column_major> Z(shp);
+
+            blas_index_t (*select)(const value_type*) = &schur_inside_unit_circle<underlying_value_type>;
+            if (sort == schur_sort::left_half_plane)
+            {
+                select = &schur_left_half_plane<underlying_value_type>;
+            }
+            blas_index_t sdim = 0;
+            int info = lapack::gees(A, compute_vectors ? 'V' : 'N', sort == schur_sort::none ? 'N' : 'S', select,
+                                    sdim, w, Z);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Schur decomposition did not converge.");
+            }
+            return std::make_tuple(std::move(Z), static_cast<std::size_t>(sdim));
+        }
+    }
+
+    /**
+     * Compute the Schur decomposition A = Z T Z^H of a square xexpression
+     * with LAPACK gees. T is upper triangular for complex input, and quasi
+     * upper triangular with 2 x 2 blocks for the complex conjugate pairs of
+     * real input. With a \em sort selection, the selected eigenvalues form
+     * the leading sdim x sdim block of T, and the first sdim columns of Z
+     * are an orthonormal basis of the corresponding invariant subspace.
+     * Without \em compute_vectors, LAPACK does not accumulate Z, and an
+     * empty 0 x 0 matrix is returned in its place.
+     *
+     * @param A Matrix to decompose
+     * @param sort eigenvalues to move to the leading block
+     * @param compute_vectors whether to compute the Schur vectors Z
+     * @return tuple (T, Z, sdim), with sdim 0 when nothing is sorted
+     */
+    template <class E>
+    auto schur(const xexpression<E>& A, schur_sort sort = schur_sort::none, bool compute_vectors = true)
+    {
+        assert_nd_square(A);
+        auto T = copy_to_layout<layout_type::column_major>(A.derived_cast());
+        auto res = detail::schur_impl(T, sort, compute_vectors, xtl::is_complex<typename E::value_type>());
+        return std::make_tuple(std::move(T), std::move(std::get<0>(res)), std::get<1>(res));
+    }
+
+    namespace detail
+    {
+        // one LAPACK logical per eigenvalue, nonzero for those to move
+        template <class E>
+        inline auto reorder_select(const E& select, std::size_t n, const char* name)
+        {
+            if (select.dimension() != 1 || select.size() != n)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": select must hold one flag per eigenvalue.");
+            }
+            xtensor<blas_index_t, 1, layout_type::column_major> flags = xtensor<blas_index_t, 1, layout_type::column_major>::from_shape({n});
+            std::transform(select.cbegin(), select.cend(), flags.begin(), [](const auto& f) {
+                return static_cast<bool>(f) ? blas_index_t(1) : blas_index_t(0);
+            });
+            return flags;
+        }
+
+        template <class M, class L>
+        inline int ordschur_impl(M& T, M& Z, const L& select, blas_index_t& m, std::false_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+            std::array<std::size_t, 1> vN = {T.shape()[0]};
+            xtensor<value_type, 1, layout_type::column_major> wr(vN), wi(vN);
+            value_type s, sep;
+            return lapack::trsen('N', Z.size() == 0 ? 'N' : 'V', select, T, Z, wr, wi, m, s, sep);
+        }
+
+        template <class M, class L>
+        inline int ordschur_impl(M& T, M& Z, const L& select, blas_index_t& m, std::true_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+            std::array<std::size_t, 1> vN = {T.shape()[0]};
+            xtensor<value_type, 1, layout_type::column_major> w(vN);
+            typename value_type::value_type s, sep;
+            return lapack::trsen('N', Z.size() == 0 ? 'N' : 'V', select, T, Z, w, m, s, sep);
+        }
+    }
+
+    /**
+     * Reorder a Schur decomposition (T, Z) computed by schur so that the
+     * eigenvalues flagged in \em select form the leading sdim x sdim block
+     * of T, with LAPACK trsen. Unlike the \em sort argument of schur, the
+     * selection is an arbitrary mask over the diagonal of T; for real input,
+     * a complex conjugate pair moves when either of its flags is set. The
+     * columns of Z are updated to keep A = Z T Z^H; an empty Z, as returned
+     * by schur without compute_vectors, is left empty.
+     *
+     * @param T Schur form
+     * @param Z Schur vectors, or an empty matrix
+     * @param select one flag per diagonal position of T
+     * @return tuple (T, Z, sdim) of the reordered decomposition
+     */
+    template <class E1, class E2, class E3>
+    auto ordschur(const xexpression<E1>& T, const xexpression<E2>& Z, const xexpression<E3>& select)
+    {
+        using value_type = typename E1::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        assert_nd_square(T);
+        matrix_type TS = T.derived_cast();
+        matrix_type ZS = Z.derived_cast();
+        if (ZS.size() != 0 && (ZS.shape()[0] != TS.shape()[0] || ZS.shape()[1] != TS.shape()[1]))
+        {
+            XTENSOR_THROW(std::runtime_error, "ordschur: Z must have the shape of T.");
+        }
+        auto flags = detail::reorder_select(select.derived_cast(), TS.shape()[0], "ordschur");
+        blas_index_t sdim = 0;
+        int info = detail::ordschur_impl(TS, ZS, flags, sdim, xtl::is_complex<value_type>());
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "ordschur: eigenvalues too close to be reordered.");
+        }
+        return std::make_tuple(std::move(TS), std::move(ZS), static_cast<std::size_t>(sdim));
+    }
+
+    namespace detail
+    {
+        // beta is nonnegative for real matrices
+        template <class T>
+        inline blas_index_t qz_left_half_plane(const T* alphar, const T* /*alphai*/, const T* beta)
+        {
+            return *alphar < T(0) && *beta > T(0);
+        }
+
+        template <class T>
+        inline blas_index_t qz_inside_unit_circle(const T* alphar, const T* alphai, const T* beta)
+        {
+            return std::hypot(*alphar, *alphai) < *beta;
+        }
+
+        template <class T>
+        inline blas_index_t qz_left_half_plane(const std::complex<T>* alpha, const std::complex<T>* beta)
+        {
+            return std::real(*alpha * std::conj(*beta)) < T(0);
+        }
+
+        template <class T>
+        inline blas_index_t qz_inside_unit_circle(const std::complex<T>* alpha, const std::complex<T>* beta)
+        {
+            return std::abs(*alpha) < std::abs(*beta);
+        }
+
+        template <class M>
+        inline auto qz_impl(M& A, M& B, schur_sort sort, bool compute_vectors, std::false_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+
+            std::size_t N = A.shape()[0];
+            std::array<std::size_t, 1> vN = {N};
+            std::size_t NZ = compute_vectors ? N : 0;
+            std::array<std::size_t, 2> shp = {NZ, NZ};
+            xtensor<value_type, 1, layout_type::column_major> alphar(vN), alphai(vN), beta(vN);
+            xtensor<value_type, 2, layout_type::column_major> Q(shp), Z(shp);
+
+            blas_index_t (*select)(const value_type*, const value_type*, const value_type*)
+                = &qz_inside_unit_circle<value_type>;
+            if (sort == schur_sort::left_half_plane)
+            {
+                select = &qz_left_half_plane<value_type>;
+            }
+            blas_index_t sdim = 0;
+            char jobvs = compute_vectors ? 'V' : 'N';
+            int info = lapack::gges(A, B, jobvs, jobvs, sort == schur_sort::none ? 'N' : 'S', select, sdim,
+                                    alphar, alphai, beta, Q, Z);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "QZ decomposition did not converge.");
+            }
+            return std::make_tuple(std::move(Q), std::move(Z), static_cast<std::size_t>(sdim));
+        }
+
+        template <class M>
+        inline auto qz_impl(M& A, M& B, schur_sort sort, bool compute_vectors, std::true_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+            using underlying_value_type = typename value_type::value_type;
+
+            std::size_t N = A.shape()[0];
+            std::array<std::size_t, 1> vN = {N};
+            std::size_t NZ = compute_vectors ? N : 0;
+            std::array<std::size_t, 2> shp = {NZ, NZ};
+            xtensor<value_type, 1, layout_type::column_major> alpha(vN), beta(vN);
+            xtensor<value_type, 2, layout_type::column_major> Q(shp), Z(shp);
+
+            blas_index_t (*select)(const value_type*, const value_type*) = &qz_inside_unit_circle<underlying_value_type>;
+            if (sort == schur_sort::left_half_plane)
+            {
+                select = &qz_left_half_plane<underlying_value_type>;
+            }
+            blas_index_t sdim = 0;
+            char jobvs = compute_vectors ? 'V' : 'N';
+            int info = lapack::gges(A, B, jobvs, jobvs, sort == schur_sort::none ? 'N' : 'S', select, sdim,
+                                    alpha, beta, Q, Z);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "QZ decomposition did not converge.");
+            }
+            return std::make_tuple(std::move(Q), std::move(Z), static_cast<std::size_t>(sdim));
+        }
+    }
+
+    /**
+     * Compute the generalized Schur (QZ) decomposition A = Q S Z^H,
+     * B = Q T Z^H of a square pair with LAPACK gges. S and T are upper
+     * triangular for complex input; for real input S is quasi upper
+     * triangular with 2 x 2 blocks for the complex conjugate pairs. The
+     * generalized eigenvalues are S[j, j] / T[j, j]. With a \em sort
+     * selection, the selected eigenvalues form the leading sdim x sdim
+     * blocks of S and T. Without \em compute_vectors, Q and Z are not
+     * accumulated and are returned as empty 0 x 0 matrices.
+     *
+     * @param A,B Matrices to decompose
+     * @param sort eigenvalues to move to the leading blocks
+     * @param compute_vectors whether to compute the Schur vectors Q and Z
+     * @return tuple (S, T, Q, Z, sdim), with sdim 0 when nothing is sorted
+     */
+    template <class E1, class E2>
+    auto qz(const xexpression<E1>& A, const xexpression<E2>& B, schur_sort sort = schur_sort::none,
+            bool compute_vectors = true)
+    {
+        using value_type = typename E1::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        detail::assert_generalized_pair(A.derived_cast(), B.derived_cast());
+        matrix_type S = A.derived_cast();
+        matrix_type T = B.derived_cast();
+        auto res = detail::qz_impl(S, T, sort, compute_vectors, xtl::is_complex<value_type>());
+        return std::make_tuple(std::move(S), std::move(T), std::move(std::get<0>(res)),
+                               std::move(std::get<1>(res)), std::get<2>(res));
+    }
+
+    namespace detail
+    {
+        template <class M, class L, class D>
+        inline int ordqz_impl(M& S, M& T, M& Q, M& Z, const L& select, blas_index_t& m, D& dif,
+                              std::false_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+            std::array<std::size_t, 1> vN = {S.shape()[0]};
+            xtensor<value_type, 1, layout_type::column_major> alphar(vN), alphai(vN), beta(vN);
+            value_type pl, pr;
+            return lapack::tgsen(0, Q.size() != 0, Z.size() != 0, select, S, T, alphar, alphai, beta,
+                                 Q, Z, m, pl, pr, dif);
+        }
+
+        template <class M, class L, class D>
+        inline int ordqz_impl(M& S, M& T, M& Q, M& Z, const L& select, blas_index_t& m, D& dif,
+                              std::true_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+            std::array<std::size_t, 1> vN = {S.shape()[0]};
+            xtensor<value_type, 1, layout_type::column_major> alpha(vN), beta(vN);
+            typename value_type::value_type pl, pr;
+            return lapack::tgsen(0, Q.size() != 0, Z.size() != 0, select, S, T, alpha, beta,
+                                 Q, Z, m, pl, pr, dif);
+        }
+    }
+
+    /**
+     * Reorder a generalized Schur decomposition (S, T, Q, Z) computed by qz
+     * so that the eigenvalues flagged in \em select form the leading
+     * sdim x sdim blocks of S and T, with LAPACK tgsen. Q and Z are updated
+     * to keep A = Q S Z^H and B = Q T Z^H; empty ones are left empty.
+     *
+     * @param S,T generalized Schur form
+     * @param Q,Z Schur vectors, or empty matrices
+     * @param select one flag per diagonal position of S
+     * @return tuple (S, T, Q, Z, sdim) of the reordered decomposition
+     */
+    template <class E1, class E2, class E3, class E4, class E5>
+    auto ordqz(const xexpression<E1>& S, const xexpression<E2>& T, const xexpression<E3>& Q,
+               const xexpression<E4>& Z, const xexpression<E5>& select)
+    {
+        using value_type = typename E1::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using real_type = xtl::complex_value_type_t<value_type>;
+
+        detail::assert_generalized_pair(S.derived_cast(), T.derived_cast());
+        matrix_type SS = S.derived_cast();
+        matrix_type TS = T.derived_cast();
+        matrix_type QS = Q.derived_cast();
+        matrix_type ZS = Z.derived_cast();
+        std::size_t N = SS.shape()[0];
+        for (const matrix_type* V : {&QS, &ZS})
+        {
+            if (V->size() != 0 && (V->shape()[0] != N || V->shape()[1] != N))
+            {
+                XTENSOR_THROW(std::runtime_error, "ordqz: Q and Z must have the shape of S.");
+            }
+        }
+        auto flags = detail::reorder_select(select.derived_cast(), N, "ordqz");
+        xtensor<real_type, 1, layout_type::column_major> dif = xtensor<real_type, 1, layout_type::column_major>::from_shape({2});
+        blas_index_t sdim = 0;
+        int info = detail::ordqz_impl(SS, TS, QS, ZS, flags, sdim, dif, xtl::is_complex<value_type>());
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "ordqz: eigenvalues too close to be reordered.");
+        }
+        return std::make_tuple(std::move(SS), std::move(TS), std::move(QS), std::move(ZS),
+                               static_cast<std::size_t>(sdim));
+    }
+
+    /**
+     * Compute the eigenvalues of a Hermitian or real symmetric matrix xexpression.
+     *
+     * @param Matrix for which the eigenvalues are computed
+     * @return xtensor containing the eigenvalues.
+     */
+    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eigvalsh(const xexpression<E>& A, char UPLO = 'L')
+    {
+        using value_type = typename E::value_type;
+
+        assert_nd_square(A);
+        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+
+        std::size_t N = M.shape()[0];
+        std::array<std::size_t, 1> vN = {N};
+        xtensor<value_type, 1, layout_type::column_major> w(vN);
+
+        int info = lapack::syevd(M, 'N', UPLO, w);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+
+        return w;
+    }
+
+    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
+    auto eigvalsh(const xexpression<E>& A, char UPLO = 'L')
+    {
+        using value_type = typename E::value_type;
+        using underlying_value_type = typename value_type::value_type;
+
+        assert_nd_square(A);
+        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+
+        std::size_t N = M.shape()[0];
+        std::array<std::size_t, 1> vN = {N};
+        xtensor<underlying_value_type, 1, layout_type::column_major> w(vN);
+
+        int info = lapack::heevd(M, 'N', UPLO, w);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+
+        return w;
+    }
+
+    /// Selects the eigenvalues of eigh and eigvalsh in the half-open interval (lower, upper]
+    struct select_range
+    {
+        double lower;
+        double upper;
+    };
+
+    /// Selects the eigenvalues of eigh and eigvalsh with ascending 0-based indices first to last, inclusive
+    struct select_index
+    {
+        std::size_t first;
+        std::size_t last;
+    };
+
+    namespace detail
+    {
+        template <class M, class W, class Z, class R>
+        inline int eigen_subset(M& A, char jobz, char range, char uplo, R vl, R vu, blas_index_t il,
+                                blas_index_t iu, blas_index_t& m, W& w, Z& z, std::false_type /*is_complex*/)
+        {
+            return lapack::syevr(A, jobz, range, uplo, vl, vu, il, iu, m, w, z);
+        }
+
+        template <class M, class W, class Z, class R>
+        inline int eigen_subset(M& A, char jobz, char range, char uplo, R vl, R vu, blas_index_t il,
+                                blas_index_t iu, blas_index_t& m, W& w, Z& z, std::true_type /*is_complex*/)
+        {
+            return lapack::heevr(A, jobz, range, uplo, vl, vu, il, iu, m, w, z);
+        }
+
+        inline void check_eigen_selection(char range, double vl, double vu,
+                                          std::size_t first, std::size_t last, std::size_t N)
+        {
+            if (range == 'I' && (first > last || last >= N))
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue index selection out of range.");
+            }
+            if (range == 'V' && !(vl < vu))
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue range selection is empty.");
+            }
+        }
+
+        /// Output arrays of syevr / heevr and sygvx / hegvx for an n x n problem
+        template <class T>
+        inline auto eigen_subset_outputs(std::size_t N, char jobz, char range, std::size_t first, std::size_t last)
+        {
+            using underlying_value_type = xtl::complex_value_type_t<T>;
+
+            std::size_t cols = jobz == 'N' ? 1 : (range == 'I' ? last - first + 1 : N);
+            std::array<std::size_t, 1> vN = {std::max(N, std::size_t(1))};
+            std::array<std::size_t, 2> zN = {std::max(N, std::size_t(1)), cols};
+            xtensor<underlying_value_type, 1, layout_type::column_major> w(vN);
+            xtensor<T, 2, layout_type::column_major> z(zN);
+            return std::make_tuple(std::move(w), std::move(z));
+        }
+
+        /**
+         * Shrinks the outputs of a subset eigensolver to the m eigenvalues
+         * found and, with \em jobz 'V', their N x m eigenvectors.
+         */
+        template <class W, class Z>
+        inline auto leading_eigenpairs(const W& w, Z& z, blas_index_t m, std::size_t N, char jobz)
+        {
+            using underlying_value_type = typename W::value_type;
+            using value_type = typename Z::value_type;
+
+            std::size_t k = static_cast<std::size_t>(m);
+            std::array<std::size_t, 1> vk = {k};
+            xtensor<underlying_value_type, 1, layout_type::column_major> wk(vk);
+            std::copy(w.data(), w.data() + k, wk.data());
+
+            std::array<std::size_t, 2> zk = {N, jobz == 'N' ? 0 : k};
+            if (z.shape() != zk)
+            {
+                // the eigenvectors are the leading columns of the column major z
+                xtensor<value_type, 2, layout_type::column_major> vectors(zk);
+                std::copy(z.data(), z.data() + vectors.size(), vectors.data());
+                z = std::move(vectors);
+            }
+            return std::make_tuple(std::move(wk), std::move(z));
+        }
+
+        /**
+         * Runs syevr / heevr on the column major \em M, which is destroyed,
+         * and returns the m selected eigenvalues and, with \em jobz 'V', the
+         * n x m eigenvectors.
+         */
+        template <class M>
+        inline auto eigh_subset_inplace(M& A, char jobz, char range, double vl, double vu,
+                                        std::size_t first, std::size_t last, char UPLO)
+        {
+            using value_type = typename M::value_type;
+            using underlying_value_type = xtl::complex_value_type_t<value_type>;
+
+            std::size_t N = A.shape()[0];
+            check_eigen_selection(range, vl, vu, first, last, N);
+            auto out = eigen_subset_outputs<value_type>(N, jobz, range, first, last);
+            auto& w = std::get<0>(out);
+            auto& z = std::get<1>(out);
+
+            blas_index_t m = 0;
+            int info = eigen_subset(A, jobz, range, UPLO,
+                                    static_cast<underlying_value_type>(vl), static_cast<underlying_value_type>(vu),
+                                    to_blas_index(first + 1), to_blas_index(last + 1),
+                                    m, w, z, xtl::is_complex<value_type>());
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+            }
+            return leading_eigenpairs(w, z, m, N, jobz);
+        }
+
+        /// Runs eigh_subset_inplace on a copy of \em A
+        template <class E>
+        inline auto eigh_subset(const E& A, char jobz, char range, double vl, double vu,
+                                std::size_t first, std::size_t last, char UPLO)
+        {
+            auto M = copy_to_layout<layout_type::column_major>(A);
+            return eigh_subset_inplace(M, jobz, range, vl, vu, first, last, UPLO);
+        }
+    }
+
+    /**
+     * Compute selected eigenvalues and eigenvectors of a square Hermitian or
+     * real symmetric xexpression with the MRRR algorithm (syevr / heevr).
+     * Only the selected eigenvectors are computed and stored, so selecting
+     * k of n eigenpairs needs O(nk) memory for the result.
+     *
+     * @param A Matrix for which the eigenvalues and eigenvectors are computed
+     * @param select ascending indices of the eigenvalues to compute; the k
+     *               largest eigenpairs are select_index{n - k, n - 1}
+     * @param UPLO triangle of A to read
+     * @return tuple (w, V) with the selected eigenvalues in ascending order
+     *         and the corresponding eigenvectors as columns of V
+     */
+    template <class E>
+    auto eigh(const xexpression<E>& A, select_index select, char UPLO = 'L')
+    {
+        assert_nd_square(A);
+        return detail::eigh_subset(A.derived_cast(), 'V', 'I', 0., 0., select.first, select.last, UPLO);
+    }
+
+    /**
+     * Compute the eigenvalues in (select.lower, select.upper] and their
+     * eigenvectors of a square Hermitian or real symmetric xexpression with
+     * the MRRR algorithm (syevr / heevr). As the number of eigenvalues in the
+     * interval is not known in advance, the work array for the eigenvectors
+     * has n columns; the result only keeps the selected ones.
+     *
+     * @param A Matrix for which the eigenvalues and eigenvectors are computed
+     * @param select interval of the eigenvalues to compute
+     * @param UPLO triangle of A to read
+     * @return tuple (w, V) with the selected eigenvalues in ascending order
+     *         and the corresponding eigenvectors as columns of V
+     */
+    template <class E>
+    auto eigh(const xexpression<E>& A, select_range select, char UPLO = 'L')
+    {
+        assert_nd_square(A);
+        return detail::eigh_subset(A.derived_cast(), 'V', 'V', select.lower, select.upper, 0, 0, UPLO);
+    }
+
+    /**
+     * Compute selected eigenvalues of a Hermitian or real symmetric matrix
+     * xexpression with syevr / heevr.
+     *
+     * @param A Matrix for which the eigenvalues are computed
+     * @param select ascending indices of the eigenvalues to compute
+     * @param UPLO triangle of A to read
+     * @return xtensor containing the selected eigenvalues in ascending order
+     */
+    template <class E>
+    auto eigvalsh(const xexpression<E>& A, select_index select, char UPLO = 'L')
+    {
+        assert_nd_square(A);
+        return std::get<0>(detail::eigh_subset(A.derived_cast(), 'N', 'I', 0., 0., select.first, select.last, UPLO));
+    }
+
+    /**
+     * Compute the eigenvalues in (select.lower, select.upper] of a Hermitian
+     * or real symmetric matrix xexpression with syevr / heevr.
+     *
+     * @param A Matrix for which the eigenvalues are computed
+     * @param select interval of the eigenvalues to compute
+     * @param UPLO triangle of A to read
+     * @return xtensor containing the selected eigenvalues in ascending order
+     */
+    template <class E>
+    auto eigvalsh(const xexpression<E>& A, select_range select, char UPLO = 'L')
+    {
+        assert_nd_square(A);
+        return std::get<0>(detail::eigh_subset(A.derived_cast(), 'N', 'V', select.lower, select.upper, 0, 0, UPLO));
+    }
+
+    /**************************************
+     * tridiagonal and bidiagonal solvers *
+     **************************************/
+
+    namespace detail
+    {
+        /**
+         * Copies the diagonal \em d and off-diagonal \em e of a real
+         * tridiagonal or bidiagonal matrix of order n to the buffers that
+         * LAPACK overwrites, \em e padded to n elements.
+         */
+        template <class D, class F>
+        inline auto diagonal_operands(const D& d, const F& e, const char* name)
+        {
+            using value_type = std::common_type_t<typename D::value_type, typename F::value_type>;
+            using vector_type = xtensor<value_type, 1, layout_type::column_major>;
+            static_assert(std::is_floating_point<value_type>::value, "d and e must be real floating point.");
+
+            if (d.dimension() != 1 || e.dimension() != 1 || e.size() + 1 != std::max(d.size(), std::size_t(1)))
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": e must be a vector with one element less than d.");
+            }
+
+            vector_type dv = d;
+            vector_type ev = vector_type::from_shape({std::max(d.size(), std::size_t(1))});
+            ev.fill(value_type(0));
+            std::copy(e.begin(), e.end(), ev.begin());
+            return std::make_tuple(std::move(dv), std::move(ev));
+        }
+
+        /// Runs stevr on the operands of diagonal_operands, as eigh_subset_inplace does syevr
+        template <class V>
+        inline auto eigh_tridiagonal_subset(V& d, V& e, char jobz, char range, double vl, double vu,
+                                            std::size_t first, std::size_t last)
+        {
+            using value_type = typename V::value_type;
+
+            std::size_t N = d.size();
+            check_eigen_selection(range, vl, vu, first, last, N);
+            auto out = eigen_subset_outputs<value_type>(N, jobz, range, first, last);
+            auto& w = std::get<0>(out);
+            auto& z = std::get<1>(out);
+
+            blas_index_t m = 0;
+            int info = lapack::stevr(d, e, jobz, range, static_cast<value_type>(vl), static_cast<value_type>(vu),
+                                     to_blas_index(first + 1), to_blas_index(last + 1), m, w, z);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+            }
+            return leading_eigenpairs(w, z, m, N, jobz);
+        }
+    }
+
+    /**
+     * Compute the eigenvalues and eigenvectors of the real symmetric
+     * tridiagonal matrix with diagonal \em d and off-diagonal \em e by
+     * divide and conquer (stedc), without forming the matrix: O(n) input
+     * instead of the n x n matrix that eigh would reduce again.
+     *
+     * @param d the n diagonal elements
+     * @param e the n - 1 off-diagonal elements
+     * @return tuple (w, V) with the eigenvalues in ascending order and the
+     *         corresponding eigenvectors as columns of V
+     */
+    template <class D, class F>
+    auto eigh_tridiagonal(const xexpression<D>& d, const xexpression<F>& e)
+    {
+        auto ops = detail::diagonal_operands(d.derived_cast(), e.derived_cast(), "eigh_tridiagonal");
+        auto& w = std::get<0>(ops);
+        using value_type = typename std::decay_t<decltype(w)>::value_type;
+
+        std::size_t N = w.size();
+        xtensor<value_type, 2, layout_type::column_major> V = xtensor<value_type, 2, layout_type::column_major>::from_shape({N, N});
+        int info = lapack::stedc('I', w, std::get<1>(ops), V);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+        return std::make_tuple(std::move(w), std::move(V));
+    }
+
+    /**
+     * Compute selected eigenvalues and eigenvectors of the real symmetric
+     * tridiagonal matrix with diagonal \em d and off-diagonal \em e with the
+     * MRRR algorithm (stevr), in O(nk) for k eigenpairs.
+     *
+     * @param d the n diagonal elements
+     * @param e the n - 1 off-diagonal elements
+     * @param select ascending indices of the eigenvalues to compute
+     * @return tuple (w, V) with the selected eigenvalues in ascending order
+     *         and the corresponding eigenvectors as columns of V
+     */
+    template <class D, class F>
+    auto eigh_tridiagonal(const xexpression<D>& d, const xexpression<F>& e, select_index select)
+    {
+        auto ops = detail::diagonal_operands(d.derived_cast(), e.derived_cast(), "eigh_tridiagonal");
+        return detail::eigh_tridiagonal_subset(std::get<0>(ops), std::get<1>(ops), 'V', 'I', 0., 0.,
+                                               select.first, select.last);
+    }
+
+    /**
+     * Compute the eigenvalues in (select.lower, select.upper] and their
+     * eigenvectors of the real symmetric tridiagonal matrix with diagonal
+     * \em d and off-diagonal \em e with the MRRR algorithm (stevr).
+     *
+     * @param d the n diagonal elements
+     * @param e the n - 1 off-diagonal elements
+     * @param select interval of the eigenvalues to compute
+     * @return tuple (w, V) with the selected eigenvalues in ascending order
+     *         and the corresponding eigenvectors as columns of V
+     */
+    template <class D, class F>
+    auto eigh_tridiagonal(const xexpression<D>& d, const xexpression<F>& e, select_range select)
+    {
+        auto ops = detail::diagonal_operands(d.derived_cast(), e.derived_cast(), "eigh_tridiagonal");
+        return detail::eigh_tridiagonal_subset(std::get<0>(ops), std::get<1>(ops), 'V', 'V',
+                                               select.lower, select.upper, 0, 0);
+    }
+
+    /**
+     * Compute the eigenvalues of the real symmetric tridiagonal matrix with
+     * diagonal \em d and off-diagonal \em e (stedc, which uses the root
+     * free QR algorithm without eigenvectors).
+     *
+     * @param d the n diagonal elements
+     * @param e the n - 1 off-diagonal elements
+     * @return xtensor containing the eigenvalues in ascending order
+     */
+    template <class D, class F>
+    auto eigvalsh_tridiagonal(const xexpression<D>& d, const xexpression<F>& e)
+    {
+        auto ops = detail::diagonal_operands(d.derived_cast(), e.derived_cast(), "eigvalsh_tridiagonal");
+        auto& w = std::get<0>(ops);
+        using value_type = typename std::decay_t<decltype(w)>::value_type;
+
+        auto Z = xtensor<value_type, 2, layout_type::column_major>::from_shape({1, 1});
+        int info = lapack::stedc('N', w, std::get<1>(ops), Z);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+        return std::move(w);
+    }
+
+    /**
+     * Compute selected eigenvalues of the real symmetric tridiagonal matrix
+     * with diagonal \em d and off-diagonal \em e with stevr.
+     *
+     * @param d the n diagonal elements
+     * @param e the n - 1 off-diagonal elements
+     * @param select ascending indices of the eigenvalues to compute
+     * @return xtensor containing the selected eigenvalues in ascending order
+     */
+    template <class D, class F>
+    auto eigvalsh_tridiagonal(const xexpression<D>& d, const xexpression<F>& e, select_index select)
+    {
+        auto ops = detail::diagonal_operands(d.derived_cast(), e.derived_cast(), "eigvalsh_tridiagonal");
+        return std::get<0>(detail::eigh_tridiagonal_subset(std::get<0>(ops), std::get<1>(ops), 'N', 'I', 0., 0.,
+                                                           select.first, select.last));
+    }
+
+    /**
+     * Compute the eigenvalues in (select.lower, select.upper] of the real
+     * symmetric tridiagonal matrix with diagonal \em d and off-diagonal
+     * \em e with stevr.
+     *
+     * @param d the n diagonal elements
+     * @param e the n - 1 off-diagonal elements
+     * @param select interval of the eigenvalues to compute
+     * @return xtensor containing the selected eigenvalues in ascending order
+     */
+    template <class D, class F>
+    auto eigvalsh_tridiagonal(const xexpression<D>& d, const xexpression<F>& e, select_range select)
+    {
+        auto ops = detail::diagonal_operands(d.derived_cast(), e.derived_cast(), "eigvalsh_tridiagonal");
+        return std::get<0>(detail::eigh_tridiagonal_subset(std::get<0>(ops), std::get<1>(ops), 'N', 'V',
+                                                           select.lower, select.upper, 0, 0));
+    }
+
+    /**
+     * Compute the SVD B = U S VT of the real bidiagonal matrix B with
+     * diagonal \em d and off-diagonal \em e by divide and conquer (bdsdc),
+     * without forming B.
+     *
+     * @param d the n diagonal elements
+     * @param e the n - 1 off-diagonal elements, on the superdiagonal of B
+     *          for \em uplo 'U' and on the subdiagonal for 'L'
+     * @param compute_uv compute the singular vectors; U and VT are empty otherwise
+     * @param uplo 'U' or 'L'
+     * @return tuple (U, s, VT) with the singular values in decreasing order
+     */
+    template <class D, class F>
+    auto svd_bidiagonal(const xexpression<D>& d, const xexpression<F>& e, bool compute_uv = true, char uplo = 'U')
+    {
+        if (uplo != 'U' && uplo != 'L')
+        {
+            XTENSOR_THROW(std::runtime_error, "svd_bidiagonal: uplo must be 'U' or 'L'.");
+        }
+        auto ops = detail::diagonal_operands(d.derived_cast(), e.derived_cast(), "svd_bidiagonal");
+        auto& s = std::get<0>(ops);
+        using value_type = typename std::decay_t<decltype(s)>::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        std::size_t N = compute_uv ? s.size() : 0;
+        matrix_type U = matrix_type::from_shape({N, N});
+        matrix_type VT = matrix_type::from_shape({N, N});
+        int info = lapack::bdsdc(uplo, compute_uv ? 'I' : 'N', s, std::get<1>(ops), U, VT);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "SVD decomposition failed.");
+        }
+        return std::make_tuple(std::move(U), std::move(s), std::move(VT));
+    }
+
+    namespace detail
+    {
+        template <class M, class W, class Z, class R>
+        inline int generalized_eigen_subset(M& A, M& B, char jobz, char range, char uplo, R vl, R vu,
+                                            blas_index_t il, blas_index_t iu, blas_index_t& m, W& w, Z& z,
+                                            std::false_type /*is_complex*/)
+        {
+            return lapack::sygvx(A, B, 1, jobz, range, uplo, vl, vu, il, iu, m, w, z);
+        }
+
+        template <class M, class W, class Z, class R>
+        inline int generalized_eigen_subset(M& A, M& B, char jobz, char range, char uplo, R vl, R vu,
+                                            blas_index_t il, blas_index_t iu, blas_index_t& m, W& w, Z& z,
+                                            std::true_type /*is_complex*/)
+        {
+            return lapack::hegvx(A, B, 1, jobz, range, uplo, vl, vu, il, iu, m, w, z);
+        }
+
+        /**
+         * Runs sygvx / hegvx on copies of \em A and \em B and returns the m
+         * selected generalized eigenvalues and, with \em jobz 'V', the
+         * n x m eigenvectors.
+         */
+        template <class E1, class E2>
+        inline auto generalized_eigh_subset(const E1& A, const E2& B, char jobz, char range, double vl, double vu,
+                                            std::size_t first, std::size_t last, char UPLO)
+        {
+            using value_type = typename E1::value_type;
+            using underlying_value_type = xtl::complex_value_type_t<value_type>;
+            using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+            assert_generalized_pair(A, B);
+            matrix_type M1 = A;
+            matrix_type M2 = B;
+            std::size_t N = M1.shape()[0];
+            check_eigen_selection(range, vl, vu, first, last, N);
+            auto out = eigen_subset_outputs<value_type>(N, jobz, range, first, last);
+            auto& w = std::get<0>(out);
+            auto& z = std::get<1>(out);
+
+            blas_index_t m = 0;
+            int info = generalized_eigen_subset(M1, M2, jobz, range, UPLO,
+                                                static_cast<underlying_value_type>(vl),
+                                                static_cast<underlying_value_type>(vu),
+                                                to_blas_index(first + 1), to_blas_index(last + 1),
+                                                m, w, z, xtl::is_complex<value_type>());
+            if (info > static_cast<int>(N))
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix B is not positive definite.");
+            }
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+            }
+            return leading_eigenpairs(w, z, m, N, jobz);
+        }
+    }
+
+    /**
+     * Compute selected generalized eigenvalues and eigenvectors of
+     * A x = lambda B x, for a Hermitian or real symmetric A and a Hermitian
+     * or real symmetric positive definite B, with sygvx / hegvx. Only the
+     * selected eigenvectors are computed.
+     *
+     * @param A,B Matrices of the generalized problem
+     * @param select ascending indices of the eigenvalues to compute; the k
+     *               largest eigenpairs are select_index{n - k, n - 1}
+     * @param UPLO triangle of A and B to read
+     * @return tuple (w, V) with the selected eigenvalues in ascending order
+     *         and the corresponding eigenvectors as columns of V
+     */
+    template <class E1, class E2>
+    auto eigh(const xexpression<E1>& A, const xexpression<E2>& B, select_index select, char UPLO = 'L')
+    {
+        return detail::generalized_eigh_subset(A.derived_cast(), B.derived_cast(), 'V', 'I', 0., 0.,
+                                               select.first, select.last, UPLO);
+    }
+
+    /**
+     * Compute the generalized eigenvalues in (select.lower, select.upper]
+     * and their eigenvectors of A x = lambda B x with sygvx / hegvx.
+     *
+     * @param A,B Matrices of the generalized problem
+     * @param select interval of the eigenvalues to compute
+     * @param UPLO triangle of A and B to read
+     * @return tuple (w, V) with the selected eigenvalues in ascending order
+     *         and the corresponding eigenvectors as columns of V
+     */
+    template <class E1, class E2>
+    auto eigh(const xexpression<E1>& A, const xexpression<E2>& B, select_range select, char UPLO = 'L')
+    {
+        return detail::generalized_eigh_subset(A.derived_cast(), B.derived_cast(), 'V', 'V',
+                                               select.lower, select.upper, 0, 0, UPLO);
+    }
+
+    namespace detail
+    {
+        template <class M, class F>
+        inline int reduce_to_standard(M& A, const F& B, char uplo, std::false_type /*is_complex*/)
+        {
+            return lapack::sygst(A, B, 1, uplo);
+        }
+
+        template <class M, class F>
+        inline int reduce_to_standard(M& A, const F& B, char uplo, std::true_type /*is_complex*/)
+        {
+            return lapack::hegst(A, B, 1, uplo);
+        }
+    }
+
+    /**
+     * Generalized eigenproblem A x = lambda B x for a fixed Hermitian or real
+     * symmetric positive definite B, as returned by generalized_eigh_factor.
+     *
+     * B is factored once (potrf). Each eigh call then reduces A to the
+     * standard problem inv(L) A inv(L)^H (sygst / hegst), solves it with
+     * syevr / heevr and back-transforms the eigenvectors with one
+     * triangular solve, which saves the O(n^3) factorization of B per call.
+     */
+    template <class T>
+    class generalized_eigh_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        template <class E>
+        explicit generalized_eigh_factorization(const xexpression<E>& B, char UPLO = 'L');
+
+        template <class E>
+        auto eigh(const xexpression<E>& A) const;
+
+        template <class E>
+        auto eigh(const xexpression<E>& A, select_index select) const;
+
+        template <class E>
+        auto eigh(const xexpression<E>& A, select_range select) const;
+
+        template <class E>
+        auto eigvalsh(const xexpression<E>& A) const;
+
+        const matrix_type& matrix() const noexcept;
+        char uplo() const noexcept;
+
+    private:
+
+        template <class E>
+        auto solve(const E& A, char jobz, char range, double vl, double vu, std::size_t first, std::size_t last) const;
+
+        matrix_type m_factor;
+        char m_uplo;
+    };
+
+    /**
+     * @param B Hermitian or real symmetric positive definite matrix
+     * @param UPLO triangle of B, and of every A passed to eigh, to read
+     */
+    template <class T>
+    template <class E>
+    inline generalized_eigh_factorization<T>::generalized_eigh_factorization(const xexpression<E>& B, char UPLO)
+        : m_factor(B.derived_cast()), m_uplo(UPLO)
+    {
+        assert_nd_square(B);
+        if (lapack::potr(m_factor, m_uplo) != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Matrix B is not positive definite.");
+        }
+    }
+
+    template <class T>
+    template <class E>
+    inline auto generalized_eigh_factorization<T>::solve(const E& A, char jobz, char range, double vl, double vu,
+                                                         std::size_t first, std::size_t last) const
+    {
+        assert_nd_square(A);
+        std::size_t N = m_factor.shape()[0];
+        if (A.shape()[0] != N)
+        {
+            XTENSOR_THROW(std::runtime_error, "A and B must have the same shape.");
+        }
+
+        matrix_type M = A;
+        detail::reduce_to_standard(M, m_factor, m_uplo, xtl::is_complex<value_type>());
+        auto res = detail::eigh_subset_inplace(M, jobz, range, vl, vu, first, last, m_uplo);
+
+        // x = inv(L)^H y, or inv(U) y
+        auto& V = std::get<1>(res);
+        if (jobz == 'V' && V.shape()[1] != 0)
+        {
+            bool lower = m_uplo == 'L' || m_uplo == 'l';
+            cxxblas::trsm<blas_index_t>(
+                cxxblas::StorageOrder::ColMajor,
+                cxxblas::Side::Left,
+                lower ? cxxblas::StorageUpLo::Lower : cxxblas::StorageUpLo::Upper,
+                lower ? cxxblas::Transpose::ConjTrans : cxxblas::Transpose::NoTrans,
+                cxxblas::Diag::NonUnit,
+                to_blas_index(N),
+                to_blas_index(V.shape()[1]),
+                value_type(1),
+                m_factor.data(),
+                to_blas_index(std::max(N, std::size_t(1))),
+                V.data(),
+                to_blas_index(std::max(N, std::size_t(1)))
+            );
+        }
+        return res;
+    }
+
+    /**
+     * Solve A x = lambda B x.
+     * @param A Hermitian or real symmetric matrix of the shape of B
+     * @return tuple (w, V) of the ascending eigenvalues and the B-orthonormal
+     *         eigenvectors as columns of V
+     */
+    template <class T>
+    template <class E>
+    inline auto generalized_eigh_factorization<T>::eigh(const xexpression<E>& A) const
+    {
+        return solve(A.derived_cast(), 'V', 'A', 0., 0., 0, 0);
+    }
+
+    /**
+     * Solve A x = lambda B x for the eigenvalues with the ascending
+     * indices select.first to select.last.
+     */
+    template <class T>
+    template <class E>
+    inline auto generalized_eigh_factorization<T>::eigh(const xexpression<E>& A, select_index select) const
+    {
+        return solve(A.derived_cast(), 'V', 'I', 0., 0., select.first, select.last);
+    }
+
+    /**
+     * Solve A x = lambda B x for the eigenvalues in
+     * (select.lower, select.upper].
+     */
+    template <class T>
+    template <class E>
+    inline auto generalized_eigh_factorization<T>::eigh(const xexpression<E>& A, select_range select) const
+    {
+        return solve(A.derived_cast(), 'V', 'V', select.lower, select.upper, 0, 0);
+    }
+
+    /**
+     * @return the ascending generalized eigenvalues of A x = lambda B x
+     */
+    template <class T>
+    template <class E>
+    inline auto generalized_eigh_factorization<T>::eigvalsh(const xexpression<E>& A) const
+    {
+        return std::get<0>(solve(A.derived_cast(), 'N', 'A', 0., 0., 0, 0));
+    }
+
+    /**
+     * @return the Cholesky factor of B in the uplo() triangle, as computed by potrf
+     */
+    template <class T>
+    inline auto generalized_eigh_factorization<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_factor;
+    }
+
+    template <class T>
+    inline char generalized_eigh_factorization<T>::uplo() const noexcept
+    {
+        return m_uplo;
+    }
+
+    /**
+     * Factor \em B once for repeated generalized eigenproblems
+     * A x = lambda B x with different A.
+     * @param B Hermitian or real symmetric positive definite matrix
+     * @param UPLO triangle of B, and of every A, to read
+     * @return generalized_eigh_factorization of \em B
+     */
+    template <class E>
+    inline auto generalized_eigh_factor(const xexpression<E>& B, char UPLO = 'L')
+    {
+        return generalized_eigh_factorization<typename E::value_type>(B, UPLO);
+    }
+
+    namespace detail
+    {
+        template <class A>
+        struct offset_iter_without_axis
+        {
+
+            using shape_type = typename A::shape_type;
+            using size_type = typename A::size_type;
+            using index_type = xindex_type_t<shape_type>;
+
+            offset_iter_without_axis(const A& a, std::size_t axis)
+                : m_a(a), m_axis(axis)
+            {
+                resize_container(m_idx, a.dimension());
+                std::fill(m_idx.begin(), m_idx.end(), 0);
+                m_offset = 0;
+            }
+
+            #define SC(X) static_cast<std::size_t>(X)
+            inline bool next()
+            {
+                size_type dim = static_cast<size_type>(m_a.dimension());
+                for (size_type j = dim; j != 0; --j)
+                {
+                    size_type i = j - 1;
+                    if (i == m_axis)
+                    {
+                        // skip
+                    }
+                    else if (m_idx[SC(i)] == m_a.shape()[SC(i)] - 1)
+                    {
+                        m_offset -= static_cast<std::ptrdiff_t>(m_idx[i]) * m_a.strides()[i];
+                        m_idx[i] = size_type(0);
+                        if (i == 0 || m_axis == 0 && i == 1)
+                        {
+                            return false;
+                        }
+                    }
+                    else
+                    {
+                        ++m_idx[i];
+                        m_offset += m_a.strides()[i];
+                        return true;
+                    }
+                }
+                return false;
+            }
+            #undef SC
+            inline std::ptrdiff_t offset() const
+            {
+                return m_offset;
+            }
+
+        private:
+            const A& m_a;
+            index_type m_idx;
+            size_type m_axis;
+            std::ptrdiff_t m_offset;
+        };
+    }
+
+    namespace detail
+    {
+        template <class R, class S>
+        inline void check_dot_out_shape(const R& result, const S& shape)
+        {
+            if (result.dimension() != shape.size() ||
+                !std::equal(shape.begin(), shape.end(), result.shape().begin()))
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: output shape mismatch.");
+            }
+        }
+
+        /**
+         * Computes ``result := alpha * op(m) * v + beta * result`` where op
+         * transposes \em m if \em transpose_m is set. The storage order of
+         * \em m is passed to BLAS directly, so no copy is required.
+         */
+        template <class M, class V, class R, class T>
+        inline void dot_mv_impl(const M& m, const V& v, R& result, bool transpose_m,
+                                const T& alpha, const T& beta)
+        {
+            XTENSOR_ASSERT(m.layout() == layout_type::row_major || m.layout() == layout_type::column_major);
+            XTENSOR_ASSERT(std::min(m.strides()[0], m.strides()[1]) <= 1);
+
+            auto op_v = get_vector_operand(v);
+            auto op_r = get_vector_operand(result);
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("gemv", m.shape()[0], m.shape()[1], 0, m.layout(), transpose_m ? 'T' : 'N', 0,
+                                         instrument::fma_flops<T>(double(m.shape()[0]) * double(m.shape()[1])));
+            cxxblas::gemv<blas_index_t>(
+                get_blas_storage_order(m),
+                transpose_m ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                to_blas_index(m.shape()[0]),
+                to_blas_index(m.shape()[1]),
+                alpha,
+                m.data() + m.data_offset(),
+                get_leading_stride(m),
+                op_v.data,
+                op_v.inc,
+                beta,
+                op_r.data,
+                op_r.inc
+            );
+        }
+
+        constexpr std::size_t mirror_block_size = 32;
+
+        /**
+         * Copies the \em uplo triangle of the square matrix \em m onto the
+         * other one (conjugated if \em hermitian), tile by tile so that the
+         * rows read and the columns written in one tile stay in cache.
+         */
+        template <class M>
+        inline void mirror_triangle(M& m, char uplo, bool hermitian = false)
+        {
+            std::size_t n = m.shape()[0];
+            auto* p = m.data() + m.data_offset();
+            std::ptrdiff_t s0 = static_cast<std::ptrdiff_t>(m.strides()[0]);
+            std::ptrdiff_t s1 = static_cast<std::ptrdiff_t>(m.strides()[1]);
+
+            // (i, j) walks the strict lower triangle
+            std::ptrdiff_t src_i = s0, src_j = s1;
+            std::ptrdiff_t dst_i = s1, dst_j = s0;
+            if (uplo == 'U' || uplo == 'u')
+            {
+                std::swap(src_i, dst_i);
+                std::swap(src_j, dst_j);
+            }
+
+            for (std::size_t ib = 0; ib < n; ib += mirror_block_size)
+            {
+                std::size_t ie = std::min(ib + mirror_block_size, n);
+                for (std::size_t jb = 0; jb <= ib; jb += mirror_block_size)
+                {
+                    for (std::size_t i = ib; i < ie; ++i)
+                    {
+                        std::size_t je = std::min(jb + mirror_block_size, i);
+                        for (std::size_t j = jb; j < je; ++j)
+                        {
+                            std::ptrdiff_t ii = static_cast<std::ptrdiff_t>(i);
+                            std::ptrdiff_t jj = static_cast<std::ptrdiff_t>(j);
+                            const auto& v = p[ii * src_i + jj * src_j];
+                            p[ii * dst_i + jj * dst_j] = hermitian ? conj_value(v) : v;
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * Computes ``result := alpha * t * o + beta * result`` for two matrices,
+         * using the layout of \em result as BLAS storage order and folding any
+         * layout mismatch of the operands into the transpose flags. Operands
+         * without a unit stride go to xt::detail::gemm_packed.
+         */
+        template <class T, class O, class R, class V>
+        inline void dot_mm_impl(const T& t, const O& o, R& result, const V& alpha, const V& beta)
+        {
+            // views without a unit stride are packed block by block
+            layout_type lt = xt::detail::blas_strided_layout(t);
+            layout_type lo = xt::detail::blas_strided_layout(o);
+            if (lt == layout_type::dynamic || lo == layout_type::dynamic)
+            {
+                xt::detail::gemm_layout_dispatch(t, o, result, false, false, alpha, beta);
+                return;
+            }
+
+            cxxblas::Transpose transpose_A = cxxblas::Transpose::NoTrans,
+                               transpose_B = cxxblas::Transpose::NoTrans;
+
+            if (result.layout() != lt)
+            {
+                transpose_A = cxxblas::Transpose::Trans;
+            }
+            if (result.layout() != lo)
+            {
+                transpose_B = cxxblas::Transpose::Trans;
+            }
+
+            // This adds a fast path for A * A' by calling SYRK and only computing
+            // the upper triangle. o is A' when it starts at the same element,
+            // has the transposed shape and is stored in the other order with
+            // the same leading stride. Small products skip it for the inline
+            // kernel of gemm_dispatch.
+            if (beta == V(0) &&
+                std::max(t.shape()[0], t.shape()[1]) > blas::small_gemm_threshold() &&
+                std::is_same<typename T::value_type, typename O::value_type>::value &&
+                std::is_same<typename T::value_type, V>::value &&
+                (static_cast<const void*>(t.data() + t.data_offset()) == static_cast<const void*>(o.data() + o.data_offset())) &&
+                ((transpose_A == cxxblas::Transpose::Trans && transpose_B == cxxblas::Transpose::NoTrans) ||
+                 (transpose_A == cxxblas::Transpose::NoTrans && transpose_B == cxxblas::Transpose::Trans)) &&
+                t.shape()[0] == o.shape()[1] && t.shape()[1] == o.shape()[0] &&
+                xt::detail::blas_strided_ld(t, lt) == xt::detail::blas_strided_ld(o, lo))
+            {
+                XTENSOR_BLAS_INSTRUMENT_CALL("syrk", t.shape()[0], t.shape()[0], t.shape()[1], result.layout(),
+                                             transpose_A == cxxblas::Transpose::Trans ? 'T' : 'N', 0,
+                                             instrument::fma_flops<V>(0.5 * double(t.shape()[0]) * double(t.shape()[0] + 1)
+                                                                      * double(t.shape()[1])));
+                cxxblas::syrk<blas_index_t>(
+                    get_blas_storage_order(result),
+                    cxxblas::StorageUpLo::Upper,
+                    transpose_A,
+                    to_blas_index(t.shape()[0]),
+                    to_blas_index(t.shape()[1]),
+                    alpha,
+                    t.data() + t.data_offset(),
+                    xt::detail::blas_strided_ld(t, lt),
+                    V(0),
+                    result.data() + result.data_offset(),
+                    get_leading_stride(result)
+                );
+
+                mirror_triangle(result, 'U');
+                return;
+            }
+
+            xt::detail::gemm_dispatch(
+                get_blas_storage_order(result),
+                transpose_A,
+                transpose_B,
+                to_blas_index(t.shape()[0]),
+                to_blas_index(o.shape()[1]),
+                to_blas_index(o.shape()[0]),
+                alpha,
+                t.data() + t.data_offset(),
+                xt::detail::blas_strided_ld(t, lt),
+                o.data() + o.data_offset(),
+                xt::detail::blas_strided_ld(o, lo),
+                beta,
+                result.data() + result.data_offset(),
+                get_leading_stride(result)
+            );
+        }
+
+        /**
+         * True if dot_into can pass \em T and \em O to GEMM as scaled or
+         * conjugated operands, see xt::detail::blas_operand_fold.
+         */
+        template <class T, class O, class R>
+        struct dot_foldable
+            : std::integral_constant<bool,
+                                     (xt::detail::blas_operand_fold<T>::value || xt::detail::blas_operand_fold<O>::value) &&
+                                     has_data_interface<typename xt::detail::blas_operand_fold<T>::operand_type>::value &&
+                                     has_data_interface<typename xt::detail::blas_operand_fold<O>::operand_type>::value &&
+                                     std::is_same<typename xt::detail::blas_operand_fold<T>::operand_type::value_type,
+                                                  typename R::value_type>::value &&
+                                     std::is_same<typename xt::detail::blas_operand_fold<O>::operand_type::value_type,
+                                                  typename R::value_type>::value>
+        {
+        };
+
+        template <class T, class O, class R, class V>
+        inline bool dot_mm_folded(const T&, const O&, R&, const V&, const V&, std::false_type)
+        {
+            return false;
+        }
+
+        /**
+         * Computes ``result := alpha * t * o + beta * result`` with a single
+         * GEMM call where \em t or \em o is a product with a scalar or a
+         * conjugation of a matrix: the scalars are folded into alpha and
+         * the conjugation into a ConjTrans op. BLAS has no conjugation
+         * without transposition, so a conjugated matrix has to be stored in
+         * the other order than \em result, as conj(transpose(a)) of a
+         * container is.
+         * @return false, with nothing computed, if the product cannot be
+         *         passed to BLAS that way
+         */
+        template <class T, class O, class R, class V>
+        inline bool dot_mm_folded(const T& t, const O& o, R& result, const V& alpha, const V& beta, std::true_type)
+        {
+            using fold_t = xt::detail::blas_operand_fold<T>;
+            using fold_o = xt::detail::blas_operand_fold<O>;
+            const auto& a = fold_t::operand(t);
+            const auto& b = fold_o::operand(o);
+            if (a.dimension() != 2 || b.dimension() != 2 || a.shape()[1] != b.shape()[0])
+            {
+                return false;
+            }
+
+            layout_type lr = result.layout();
+            layout_type la = xt::detail::blas_strided_layout(a);
+            layout_type lb = xt::detail::blas_strided_layout(b);
+            if ((lr != layout_type::row_major && lr != layout_type::column_major) ||
+                la == layout_type::dynamic || lb == layout_type::dynamic)
+            {
+                return false;
+            }
+            bool trans_a = la != lr;
+            bool trans_b = lb != lr;
+            if ((fold_t::conjugate && !trans_a) || (fold_o::conjugate && !trans_b))
+            {
+                return false;
+            }
+            check_dot_out_shape(result, std::array<std::size_t, 2>{a.shape()[0], b.shape()[1]});
+
+            xt::detail::gemm_dispatch(
+                get_blas_storage_order(result),
+                !trans_a ? cxxblas::Transpose::NoTrans : (fold_t::conjugate ? cxxblas::Transpose::ConjTrans : cxxblas::Transpose::Trans),
+                !trans_b ? cxxblas::Transpose::NoTrans : (fold_o::conjugate ? cxxblas::Transpose::ConjTrans : cxxblas::Transpose::Trans),
+                to_blas_index(a.shape()[0]),
+                to_blas_index(b.shape()[1]),
+                to_blas_index(b.shape()[0]),
+                V(alpha * fold_t::scale(t) * fold_o::scale(o)),
+                a.data() + a.data_offset(),
+                xt::detail::blas_strided_ld(a, la),
+                b.data() + b.data_offset(),
+                xt::detail::blas_strided_ld(b, lb),
+                beta,
+                result.data() + result.data_offset(),
+                get_leading_stride(result)
+            );
+            return true;
+        }
+
+        /**
+         * Checks whether all but the last dimension of \em t can be collapsed
+         * into the rows of a single matrix with storage order \em l, without
+         * copying. On success, \em ld holds the leading stride of that matrix.
+         */
+        template <class E>
+        inline bool collapse_leading_dims(const E& t, layout_type l, blas_index_t& ld)
+        {
+            std::size_t dim = t.dimension();
+            std::size_t k = t.shape()[dim - 1];
+            std::ptrdiff_t expected = 0;
+            if (l == layout_type::row_major)
+            {
+                if (k != 1 && t.strides()[dim - 1] != 1)
+                {
+                    return false;
+                }
+                std::ptrdiff_t row_stride = static_cast<std::ptrdiff_t>(std::max(k, std::size_t(1)));
+                for (std::size_t i = dim - 1; i-- > 0;)
+                {
+                    if (t.shape()[i] == 1)
+                    {
+                        continue;
+                    }
+                    if (expected == 0)
+                    {
+                        row_stride = t.strides()[i];
+                        if (row_stride < static_cast<std::ptrdiff_t>(k))
+                        {
+                            return false;
+                        }
+                    }
+                    else if (t.strides()[i] != expected)
+                    {
+                        return false;
+                    }
+                    expected = t.strides()[i] * static_cast<std::ptrdiff_t>(t.shape()[i]);
+                }
+                ld = to_blas_index(row_stride);
+                return true;
+            }
+            else if (l == layout_type::column_major)
+            {
+                expected = 1;
+                for (std::size_t i = 0; i < dim - 1; ++i)
+                {
+                    if (t.shape()[i] == 1)
+                    {
+                        continue;
+                    }
+                    if (t.strides()[i] != expected)
+                    {
+                        return false;
+                    }
+                    expected *= static_cast<std::ptrdiff_t>(t.shape()[i]);
+                }
+                std::ptrdiff_t col_stride = k == 1 ? expected : t.strides()[dim - 1];
+                if (col_stride < expected)
+                {
+                    return false;
+                }
+                ld = to_blas_index(col_stride);
+                return true;
+            }
+            return false;
+        }
+
+        template <class T, class O>
+        inline auto dot_impl(const xexpression<T>& xt, const xexpression<O>& xo)
+        {
+            using value_type = accumulation_type_t<std::common_type_t<typename T::value_type, typename O::value_type>>;
+
+            using return_type = std::conditional_t<(T::static_layout == O::static_layout) &&
+                                                   (T::static_layout != layout_type::dynamic && T::static_layout != layout_type::any),
+                                                   xarray<value_type, T::static_layout>,
+                                                   xarray<value_type, XTENSOR_DEFAULT_LAYOUT>>;
+            return_type result;
+
+            auto&& t = view_eval<T::static_layout>(xt.derived_cast());
+            auto&& o = view_eval<O::static_layout>(xo.derived_cast());
+
+            // is one of each a scalar? just multiply
+            if (t.dimension() == 0 || o.dimension() == 0)
+            {
+                return return_type(t * o);
+            }
+            if (t.dimension() == 1 && o.dimension() == 1)
+            {
+                result.resize(std::vector<std::size_t>{1});
+                if (t.shape()[0] != o.shape()[0])
+                {
+                    XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+                }
+
+                if (xtl::is_complex<typename T::value_type>::value)
+                {
+                    blas::dotu(t, o, result(0));
+                }
+                else
+                {
+                    blas::dot(t, o, result(0));
+                }
+                return result;
+            }
+            else
+            {
+                if (t.dimension() == 2 && o.dimension() == 1)
+                {
+                    if (t.shape()[1] != o.shape()[0])
+                    {
+                        XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+                    }
+
+                    result.resize({static_cast<std::size_t>(t.shape()[0])});
+                    detail::dot_mv_impl(t, o, result, false, value_type(1.0), value_type(0.0));
+                }
+                else if (t.dimension() == 1 && o.dimension() == 2)
+                {
+                    if (t.shape()[0] != o.shape()[0])
+                    {
+                        XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+                    }
+
+                    result.resize({static_cast<std::size_t>(o.shape()[1])});
+                    detail::dot_mv_impl(o, t, result, true, value_type(1.0), value_type(0.0));
+                }
+                else if (t.dimension() == 2 && o.dimension() == 2)
+                {
+                    if (t.shape()[1] != o.shape()[0])
+                    {
+                        XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+                    }
+
+                    result.resize({static_cast<std::size_t>(t.shape()[0]), static_cast<std::size_t>(o.shape()[1])});
+                    detail::dot_mm_impl(t, o, result, value_type(1.0), value_type(0.0));
+                }
+                else
+                {
+                    // TODO more testing for different layouts!
+                    std::size_t l = t.shape().back();
+                    std::size_t match_dim = 0;
+
+                    if (o.dimension() > 1)
+                    {
+                        match_dim = o.dimension() - 2;
+                    }
+                    if (o.shape()[match_dim] != l)
+                    {
+                        XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+                    }
+
+                    blas_index_t a_dim = to_blas_index(t.dimension());
+                    blas_index_t b_dim = to_blas_index(o.dimension());
+
+                    blas_index_t nd = a_dim + b_dim - 2;
+
+                    std::size_t j = 0;
+                    std::vector<std::size_t> dimensions(static_cast<std::size_t>(nd));
+
+                    for (blas_index_t i = 0; i < a_dim - 1; ++i)
+                    {
+                        dimensions[j++] = t.shape()[static_cast<std::size_t>(i)];
+                    }
+                    for (blas_index_t i = 0; i < b_dim - 2; ++i)
+                    {
+                        dimensions[j++] = o.shape()[static_cast<std::size_t>(i)];
+                    }
+                    if (b_dim > 1)
+                    {
+                        dimensions[j++] = o.shape().back();
+                    }
+
+                    result.resize(dimensions);
+
+                    // If the leading dimensions of t are contiguous, t is a single
+                    // (prod(t.shape[:-1]), l) matrix and the product is one GEMM.
+                    // Either operand may be stored in the other order than the
+                    // result, like a Fortran-ordered array of dynamic layout,
+                    // and is then read transposed.
+                    blas_index_t t_ld = 0;
+                    layout_type lr = result.layout();
+                    layout_type lt = layout_type::dynamic;
+                    layout_type lo = layout_type::dynamic;
+                    if (b_dim == 2)
+                    {
+                        layout_type other = lr == layout_type::row_major ? layout_type::column_major : layout_type::row_major;
+                        lt = detail::collapse_leading_dims(t, lr, t_ld) ? lr
+                             : (detail::collapse_leading_dims(t, other, t_ld) ? other : layout_type::dynamic);
+                        lo = xt::detail::blas_strided_layout(o);
+                    }
+                    if (lt != layout_type::dynamic && lo != layout_type::dynamic)
+                    {
+                        std::size_t rows = 1;
+                        for (std::size_t i = 0; i < t.dimension() - 1; ++i)
+                        {
+                            rows *= t.shape()[i];
+                        }
+                        std::size_t cols = o.shape()[1];
+                        std::size_t result_ld = result.layout() == layout_type::row_major ? cols : rows;
+
+                        XTENSOR_BLAS_INSTRUMENT_CALL("gemm", rows, cols, l, lr, lt != lr ? 'T' : 'N', lo != lr ? 'T' : 'N',
+                                                     instrument::fma_flops<value_type>(double(rows) * double(cols) * double(l)));
+                        cxxblas::gemm<blas_index_t>(
+                            get_blas_storage_order(result),
+                            lt != lr ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                            lo != lr ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                            to_blas_index(rows),
+                            to_blas_index(cols),
+                            to_blas_index(l),
+                            value_type(1.0),
+                            t.data() + t.data_offset(),
+                            std::max(t_ld, blas_index_t(1)),
+                            o.data() + o.data_offset(),
+                            xt::detail::blas_strided_ld(o, lo),
+                            value_type(0.0),
+                            result.data(),
+                            to_blas_index(std::max(result_ld, std::size_t(1)))
+                        );
+                        return result;
+                    }
+
+                    blas_index_t a_stride = to_blas_index(t.strides().back());
+                    blas_index_t b_stride = to_blas_index(o.strides()[match_dim]);
+
+                    auto a_iter = detail::offset_iter_without_axis<std::decay_t<decltype(t)>>(t, t.dimension() - 1);
+                    auto b_iter = detail::offset_iter_without_axis<std::decay_t<decltype(o)>>(o, match_dim);
+
+                    value_type temp;
+                    auto result_it = result.begin();
+
+                    XTENSOR_BLAS_INSTRUMENT_CALL("dot_nd", result.size(), 0, l, layout_type::dynamic, 0, 0,
+                                                 instrument::fma_flops<value_type>(double(result.size()) * double(l)));
+                    do
+                    {
+                        do
+                        {
+                            cxxblas::dot<blas_index_t>(
+                                to_blas_index(l),
+                                t.data() + a_iter.offset(),
+                                a_stride,
+                                o.data() + b_iter.offset(),
+                                b_stride,
+                                temp
+                            );
+                            *(result_it++) = temp;
+
+                        } while (b_iter.next());
+
+                    } while (a_iter.next());
+
+                }
+                return result;
+            }
+        }
+    }
+
+    namespace detail
+    {
+        template <class R, class E>
+        inline bool dot_operand_aliases(const R& result, const E& e, std::true_type /*has_data_interface*/)
+        {
+            std::less<const void*> less;
+            const void* r_begin = result.data();
+            const void* r_end = result.data() + result.storage().size();
+            const void* e_begin = e.data();
+            const void* e_end = e.data() + e.storage().size();
+            return less(r_begin, e_end) && less(e_begin, r_end);
+        }
+
+        // operands without a data interface are evaluated before BLAS writes
+        template <class R, class E>
+        inline bool dot_operand_aliases(const R&, const E&, std::false_type /*has_data_interface*/)
+        {
+            return false;
+        }
+
+        /**
+         * True if the storage of \em result overlaps that of the operand
+         * \em e, or of the matrix that \em e scales or conjugates, see
+         * dot_mm_folded.
+         */
+        template <class R, class E>
+        inline bool dot_operand_aliases(const R& result, const E& e)
+        {
+            using fold = xt::detail::blas_operand_fold<E>;
+            return dot_operand_aliases(result, fold::operand(e), has_data_interface<typename fold::operand_type>());
+        }
+
+        // true if e is result itself: same first element, shape and strides
+        template <class R, class E>
+        inline bool dot_same_matrix(const R& result, const E& e, std::true_type /*has_data_interface*/)
+        {
+            return static_cast<const void*>(result.data() + result.data_offset()) ==
+                       static_cast<const void*>(e.data() + e.data_offset()) &&
+                   std::equal(result.shape().cbegin(), result.shape().cend(), e.shape().cbegin()) &&
+                   std::equal(result.strides().cbegin(), result.strides().cend(), e.strides().cbegin());
+        }
+
+        template <class R, class E>
+        inline bool dot_same_matrix(const R&, const E&, std::false_type /*has_data_interface*/)
+        {
+            return false;
+        }
+
+        // elements of the panel of an operand copied at a time by dot_mm_in_place
+        constexpr std::size_t dot_in_place_panel_elements = std::size_t(1) << 18;
+        constexpr std::size_t dot_in_place_min_panel = 64;
+
+        /**
+         * Computes ``result := alpha * t * o + beta * result`` where \em result
+         * is the matrix \em t itself (\em lhs) or \em o, and does not overlap
+         * the other operand. Row i of t o only reads row i of t, and column
+         * j only column j of o, so the product is computed panel by panel,
+         * each panel of the aliased operand copied into a scratch buffer of
+         * about dot_in_place_panel_elements before GEMM overwrites it.
+         * @return false, with nothing computed, if the operands are not such
+         *         matrices
+         */
+        template <class E>
+        using dot_maybe_matrix = std::integral_constant<bool, static_dimension<typename E::shape_type>::value == 2 ||
+                                                                  static_dimension<typename E::shape_type>::value == -1>;
+
+        template <class T, class O, class R>
+        using dot_in_place_candidate = std::integral_constant<bool, dot_maybe_matrix<T>::value && dot_maybe_matrix<O>::value &&
+                                                                        dot_maybe_matrix<R>::value>;
+
+        template <class T, class O, class R, class V>
+        inline bool dot_mm_in_place(const T&, const O&, R&, const V&, const V&, bool, std::false_type)
+        {
+            return false;
+        }
+
+        template <class T, class O, class R, class V>
+        inline bool dot_mm_in_place(const T& t, const O& o, R& result, const V& alpha, const V& beta, bool lhs,
+                                    std::true_type)
+        {
+            if (t.dimension() != 2 || o.dimension() != 2 || result.dimension() != 2 ||
+                !(lhs ? dot_same_matrix(result, t, has_data_interface<T>()) : dot_same_matrix(result, o, has_data_interface<O>())))
+            {
+                return false;
+            }
+            if (t.shape()[1] != o.shape()[0])
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+            }
+            check_dot_out_shape(result, std::array<std::size_t, 2>{t.shape()[0], o.shape()[1]});
+
+            constexpr layout_type L = R::static_layout == layout_type::column_major
+                ? layout_type::column_major : layout_type::row_major;
+            std::size_t inner = t.shape()[1];
+            std::size_t extent = lhs ? result.shape()[0] : result.shape()[1];
+            std::size_t panel = std::min(extent, std::max(dot_in_place_min_panel,
+                                                          dot_in_place_panel_elements / std::max(inner, std::size_t(1))));
+            for (std::size_t i0 = 0; i0 < extent; i0 += panel)
+            {
+                auto r = range(i0, std::min(extent, i0 + panel));
+                if (lhs)
+                {
+                    xtensor<typename T::value_type, 2, L, scratch_allocator<typename T::value_type>> a = xt::view(t, r, all());
+                    auto c = xt::view(result, r, all());
+                    xt::detail::gemm_layout_dispatch(a, o, c, false, false, alpha, beta);
+                }
+                else
+                {
+                    xtensor<typename O::value_type, 2, L, scratch_allocator<typename O::value_type>> b = xt::view(o, all(), r);
+                    auto c = xt::view(result, all(), r);
+                    xt::detail::gemm_layout_dispatch(t, b, c, false, false, alpha, beta);
+                }
+            }
+            return true;
+        }
+    }
+
+    /**
+     * Non-broadcasting dot function writing into a preallocated \em result,
+     * according to ``result := alpha * dot(t, o) + beta * result``.
+     * The shape of \em result has to match the shape of the product; for
+     * vector, matrix-vector and matrix-matrix products the data of \em result
+     * is passed straight to BLAS so that no temporary is allocated.
+     * Matrix operands such as ``transpose(a)``, ``2.0 * a`` or
+     * ``conj(transpose(a))`` reach GEMM without being evaluated: the
+     * transposition and conjugation go into its op flags, the scalar into
+     * alpha.
+     * \em result may share memory with an operand: ``dot_into(a, b, a)``
+     * and ``dot_into(a, b, b)`` copy one panel of \em a (rows) or \em b
+     * (columns) at a time, other overlaps go through a temporary of the
+     * shape of the result.
+     *
+     * @param t input array
+     * @param o input array
+     * @param result preallocated output array
+     * @param alpha scale factor for the product (defaults to 1)
+     * @param beta scale factor for \em result (defaults to 0)
+     */
+    template <class T, class O, class R, class value_type = typename R::value_type>
+    void dot_into(const xexpression<T>& xt, const xexpression<O>& xo, R& result,
+                  const value_type& alpha = value_type(1.0),
+                  const value_type& beta = value_type(0.0))
+    {
+        bool alias_t = detail::dot_operand_aliases(result, xt.derived_cast());
+        bool alias_o = detail::dot_operand_aliases(result, xo.derived_cast());
+        if (alias_t || alias_o)
+        {
+            if (alias_t != alias_o &&
+                detail::dot_mm_in_place(xt.derived_cast(), xo.derived_cast(), result, alpha, beta, alias_t,
+                                        detail::dot_in_place_candidate<T, O, R>()))
+            {
+                return;
+            }
+            constexpr layout_type L = R::static_layout == layout_type::column_major
+                ? layout_type::column_major : layout_type::row_major;
+            xarray<typename R::value_type, L> temp = beta == value_type(0)
+                ? xarray<typename R::value_type, L>::from_shape(result.shape()) : xarray<typename R::value_type, L>(result);
+            dot_into(xt, xo, temp, alpha, beta);
+            noalias(result) = temp;
+            return;
+        }
+
+        // scaled and conjugated matrices are passed to GEMM without
+        // evaluating them first
+        if (detail::dot_mm_folded(xt.derived_cast(), xo.derived_cast(), result, alpha, beta,
+                                  detail::dot_foldable<T, O, R>()))
+        {
+            return;
+        }
+
+        auto&& t = view_eval<T::static_layout>(xt.derived_cast());
+        auto&& o = view_eval<O::static_layout>(xo.derived_cast());
+
+        if (t.dimension() == 1 && o.dimension() == 1)
+        {
+            if (t.shape()[0] != o.shape()[0])
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+            }
+            if (result.size() != 1)
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: output shape mismatch.");
+            }
+
+            value_type temp;
+            if (xtl::is_complex<typename T::value_type>::value)
+            {
+                blas::dotu(t, o, temp);
+            }
+            else
+            {
+                blas::dot(t, o, temp);
+            }
+            auto& r = *(result.data() + result.data_offset());
+            r = beta == value_type(0) ? alpha * temp : alpha * temp + beta * r;
+        }
+        else if (t.dimension() == 2 && o.dimension() == 1)
+        {
+            if (t.shape()[1] != o.shape()[0])
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+            }
+            detail::check_dot_out_shape(result, std::array<std::size_t, 1>{t.shape()[0]});
+            detail::dot_mv_impl(t, o, result, false, alpha, beta);
+        }
+        else if (t.dimension() == 1 && o.dimension() == 2)
+        {
+            if (t.shape()[0] != o.shape()[0])
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+            }
+            detail::check_dot_out_shape(result, std::array<std::size_t, 1>{o.shape()[1]});
+            detail::dot_mv_impl(o, t, result, true, alpha, beta);
+        }
+        else if (t.dimension() == 2 && o.dimension() == 2)
+        {
+            if (t.shape()[1] != o.shape()[0])
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+            }
+            if (result.layout() != layout_type::row_major && result.layout() != layout_type::column_major)
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: output has to be row or column major.");
+            }
+            detail::check_dot_out_shape(result, std::array<std::size_t, 2>{t.shape()[0], o.shape()[1]});
+            detail::dot_mm_impl(t, o, result, alpha, beta);
+        }
+        else
+        {
+            auto temp = detail::dot_impl(t, o);
+            detail::check_dot_out_shape(result, temp.shape());
+            if (beta == value_type(0))
+            {
+                noalias(result) = alpha * temp;
+            }
+            else
+            {
+                noalias(result) = alpha * temp + beta * result;
+            }
+        }
+    }
+
+    /**
+     * Non-broadcasting dot function writing into a preallocated \em result.
+     * Equivalent to ``dot_into(t, o, result)``.
+     *
+     * @param t input array
+     * @param o input array
+     * @param result preallocated output array
+     */
+    template <class T, class O, class R>
+    void dot(const xexpression<T>& xt, const xexpression<O>& xo, R& result)
+    {
+        dot_into(xt, xo, result);
+    }
+
+    /**
+     * Complex matrix product of operands in split (planar) storage,
+     * ``Cr + i Ci := (Ar + i Ai) * (Br + i Bi)``, computed by real GEMMs
+     * on the real and imaginary parts without interleaving them into
+     * complex arrays.
+     *
+     * Four products are used by default, accumulated straight into
+     * \em Cr and \em Ci with no temporary. If blas::complex_gemm_3m is
+     * on, three products are used instead (``Ar * Br``, ``Ai * Bi`` and
+     * ``(Ar + Ai) * (Br + Bi)``), at the cost of the two operand sums
+     * and one m-by-n temporary, and with a slightly larger rounding
+     * error in the imaginary part.
+     *
+     * @param Ar real part of A, m-by-k
+     * @param Ai imaginary part of A, m-by-k
+     * @param Br real part of B, k-by-n
+     * @param Bi imaginary part of B, k-by-n
+     * @param Cr preallocated real part of the result, m-by-n
+     * @param Ci preallocated imaginary part of the result, m-by-n
+     */
+    template <class E1, class E2, class E3, class E4, class R1, class R2>
+    void dot_planar(const xexpression<E1>& Ar, const xexpression<E2>& Ai,
+                    const xexpression<E3>& Br, const xexpression<E4>& Bi,
+                    R1& Cr, R2& Ci)
+    {
+        using value_type = typename R1::value_type;
+        static_assert(std::is_same<value_type, typename R2::value_type>::value,
+                      "dot_planar: real and imaginary parts of the result must have the same type");
+        static_assert(!xtl::is_complex<value_type>::value,
+                      "dot_planar: the parts have to be real");
+
+        const auto& ar = Ar.derived_cast();
+        const auto& ai = Ai.derived_cast();
+        const auto& br = Br.derived_cast();
+        const auto& bi = Bi.derived_cast();
+        if (ar.dimension() != 2 || ai.dimension() != 2 || br.dimension() != 2 || bi.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "dot_planar: operands have to be matrices.");
+        }
+        if (!std::equal(ar.shape().begin(), ar.shape().end(), ai.shape().begin()) ||
+            !std::equal(br.shape().begin(), br.shape().end(), bi.shape().begin()) ||
+            ar.shape()[1] != br.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "dot_planar: shape mismatch.");
+        }
+        std::array<std::size_t, 2> shape = {ar.shape()[0], br.shape()[1]};
+        detail::check_dot_out_shape(Cr, shape);
+        detail::check_dot_out_shape(Ci, shape);
+        if (detail::dot_operand_aliases(Cr, ar) || detail::dot_operand_aliases(Cr, ai) ||
+            detail::dot_operand_aliases(Cr, br) || detail::dot_operand_aliases(Cr, bi) ||
+            detail::dot_operand_aliases(Ci, ar) || detail::dot_operand_aliases(Ci, ai) ||
+            detail::dot_operand_aliases(Ci, br) || detail::dot_operand_aliases(Ci, bi) ||
+            detail::dot_operand_aliases(Cr, Ci))
+        {
+            XTENSOR_THROW(std::runtime_error, "dot_planar: the result may not overlap the operands.");
+        }
+
+        if (!blas::complex_gemm_3m())
+        {
+            blas::gemm(ar, br, Cr, false, false, value_type(1), value_type(0));
+            blas::gemm(ai, bi, Cr, false, false, value_type(-1), value_type(1));
+            blas::gemm(ar, bi, Ci, false, false, value_type(1), value_type(0));
+            blas::gemm(ai, br, Ci, false, false, value_type(1), value_type(1));
+            return;
+        }
+
+        constexpr layout_type L = R1::static_layout == layout_type::column_major
+            ? layout_type::column_major : layout_type::row_major;
+        xtensor<value_type, 2, L> sa = ar + ai;
+        xtensor<value_type, 2, L> sb = br + bi;
+        xtensor<value_type, 2, L> t2 = xtensor<value_type, 2, L>::from_shape(shape);
+        blas::gemm(ar, br, Cr, false, false, value_type(1), value_type(0));
+        blas::gemm(ai, bi, t2, false, false, value_type(1), value_type(0));
+        blas::gemm(sa, sb, Ci, false, false, value_type(1), value_type(0));
+        Ci -= Cr;
+        Ci -= t2;
+        Cr -= t2;
+    }
+
+    /**
+     * Non-broadcasting dot function constructing its result in a container
+     * of type \em R. Vector, matrix-vector and matrix-matrix products are
+     * computed by dot_into straight into the new \em R, which may have
+     * either layout; products of higher dimensional operands are evaluated
+     * first and assigned.
+     *
+     * @param t input array
+     * @param o input array
+     * @return the product, an \em R
+     */
+    template <class T, class O, class R>
+    R dot(const xexpression<T>& xt, const xexpression<O>& xo, result_as<R>)
+    {
+        static_assert(std::is_same<typename R::value_type, typename detail::dot_traits<T, O>::value_type>::value,
+                      "result_as: the container must hold the value type of the result");
+        const auto& t = xt.derived_cast();
+        const auto& o = xo.derived_cast();
+        std::size_t t_dim = t.dimension();
+        std::size_t o_dim = o.dimension();
+        if (t_dim == 0 || o_dim == 0 || t_dim > 2 || o_dim > 2)
+        {
+            auto temp = detail::dot_impl(t, o);
+            R result = detail::make_result<R>(temp.shape());
+            noalias(result) = temp;
+            return result;
+        }
+
+        std::vector<std::size_t> shape;
+        if (t_dim == 2)
+        {
+            shape.push_back(t.shape()[0]);
+        }
+        if (o_dim == 2)
+        {
+            shape.push_back(o.shape()[1]);
+        }
+        if (shape.empty())
+        {
+            shape.push_back(1);
+        }
+        R result = detail::make_result<R>(shape);
+        dot_into(xt, xo, result);
+        return result;
+    }
+
+    /**
+     * Lazy product ``alpha * dot(t, o)`` returned by lazy_dot.
+     *
+     * Nothing is computed until the expression is assigned with
+     * linalg::assign or linalg::add_assign, which compute it and the update
+     * of the destination in a single BLAS call writing directly into the
+     * destination, or evaluated with evaluate(). Scaling the expression by a
+     * scalar only changes alpha. The operands are held by reference and
+     * must outlive the expression.
+     */
+    template <class T, class O, class V>
+    class xdot_expression
+    {
+    public:
+
+        using value_type = V;
+
+        xdot_expression(const T& t, const O& o, const value_type& alpha)
+            : m_t(t), m_o(o), m_alpha(alpha)
+        {
+        }
+
+        const T& lhs() const noexcept
+        {
+            return m_t;
+        }
+
+        const O& rhs() const noexcept
+        {
+            return m_o;
+        }
+
+        const value_type& alpha() const noexcept
+        {
+            return m_alpha;
+        }
+
+        /**
+         * @return a new array holding ``alpha * dot(t, o)``
+         */
+        auto evaluate() const
+        {
+            auto result = dot(m_t, m_o);
+            if (m_alpha != value_type(1))
+            {
+                result *= m_alpha;
+            }
+            return result;
+        }
+
+    private:
+
+        const T& m_t;
+        const O& m_o;
+        value_type m_alpha;
+    };
+
+    /**
+     * Returns the lazy product of \em t and \em o, see xdot_expression.
+     *
+     * \code{.cpp}
+     * // C := 2 * A * B + 0.5 * C in one GEMM, without a temporary
+     * linalg::assign(C, 2.0 * linalg::lazy_dot(A, B), 0.5);
+     * // C += A * B
+     * linalg::add_assign(C, linalg::lazy_dot(A, B));
+     * \endcode
+     *
+     * @param t input array
+     * @param o input array
+     * @return the unevaluated product
+     */
+    template <class T, class O>
+    inline auto lazy_dot(const xexpression<T>& t, const xexpression<O>& o)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+        return xdot_expression<T, O, value_type>(t.derived_cast(), o.derived_cast(), value_type(1));
+    }
+
+    template <class S, class T, class O, class V, class = std::enable_if_t<std::is_convertible<S, V>::value>>
+    inline xdot_expression<T, O, V> operator*(const S& s, const xdot_expression<T, O, V>& d)
+    {
+        return xdot_expression<T, O, V>(d.lhs(), d.rhs(), V(s) * d.alpha());
+    }
+
+    template <class S, class T, class O, class V, class = std::enable_if_t<std::is_convertible<S, V>::value>>
+    inline xdot_expression<T, O, V> operator*(const xdot_expression<T, O, V>& d, const S& s)
+    {
+        return xdot_expression<T, O, V>(d.lhs(), d.rhs(), d.alpha() * V(s));
+    }
+
+    template <class T, class O, class V>
+    inline xdot_expression<T, O, V> operator-(const xdot_expression<T, O, V>& d)
+    {
+        return xdot_expression<T, O, V>(d.lhs(), d.rhs(), -d.alpha());
+    }
+
+    /**
+     * Evaluates the lazy product \em d into \em result according to
+     * ``result := d + beta * result``, i.e. runs dot_into with the alpha of
+     * \em d. \em result must have the shape of the product and may share
+     * memory with an operand, see dot_into.
+     *
+     * @param result destination array
+     * @param d lazy product returned by lazy_dot
+     * @param beta scale factor for \em result (defaults to 0)
+     */
+    template <class R, class T, class O, class V>
+    void assign(R& result, const xdot_expression<T, O, V>& d, const V& beta = V(0))
+    {
+        dot_into(d.lhs(), d.rhs(), result, d.alpha(), beta);
+    }
+
+    /**
+     * Adds the lazy product \em d to \em result, ``result += d``, in a
+     * single BLAS call.
+     *
+     * @param result destination array of the shape of the product
+     * @param d lazy product returned by lazy_dot
+     */
+    template <class R, class T, class O, class V>
+    void add_assign(R& result, const xdot_expression<T, O, V>& d)
+    {
+        assign(result, d, V(1));
+    }
+
+    namespace detail
+    {
+        /**
+         * Solves the matrix chain problem for matrices of shapes
+         * ``(dims[i], dims[i + 1])``: split[i][j] is the index after which
+         * the product of matrices i to j is split to minimize the number of
+         * multiply-adds.
+         */
+        inline std::vector<std::vector<std::size_t>> multi_dot_order(const std::vector<std::size_t>& dims)
+        {
+            std::size_t n = dims.size() - 1;
+            std::vector<std::vector<double>> cost(n, std::vector<double>(n, 0.));
+            std::vector<std::vector<std::size_t>> split(n, std::vector<std::size_t>(n, 0));
+            for (std::size_t len = 1; len < n; ++len)
+            {
+                for (std::size_t i = 0; i + len < n; ++i)
+                {
+                    std::size_t j = i + len;
+                    cost[i][j] = std::numeric_limits<double>::infinity();
+                    for (std::size_t k = i; k < j; ++k)
+                    {
+                        double c = cost[i][k] + cost[k + 1][j]
+                            + double(dims[i]) * double(dims[k + 1]) * double(dims[j + 1]);
+                        if (c < cost[i][j])
+                        {
+                            cost[i][j] = c;
+                            split[i][j] = k;
+                        }
+                    }
+                }
+            }
+            return split;
+        }
+
+        /**
+         * Returns the chain dimensions of the operands of multi_dot, where a
+         * leading 1-D array is a row vector and a trailing one a column
+         * vector.
+         */
+        inline std::vector<std::size_t> multi_dot_dims(const std::vector<std::vector<std::size_t>>& shapes)
+        {
+            std::size_t n = shapes.size();
+            if (n < 2)
+            {
+                XTENSOR_THROW(std::runtime_error, "multi_dot: at least two arrays are required.");
+            }
+            std::vector<std::size_t> dims(n + 1);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const auto& s = shapes[i];
+                bool vector_allowed = i == 0 || i == n - 1;
+                if (s.size() != 2 && !(s.size() == 1 && vector_allowed))
+                {
+                    XTENSOR_THROW(std::runtime_error, "multi_dot: arrays must be 2-D, except for the first and the last which may be 1-D.");
+                }
+                std::size_t rows = s.size() == 2 ? s[0] : (i == 0 ? 1 : s[0]);
+                std::size_t cols = s.size() == 2 ? s[1] : (i == 0 ? s[0] : 1);
+                if (i > 0 && rows != dims[i])
+                {
+                    XTENSOR_THROW(std::runtime_error, "multi_dot: shape mismatch.");
+                }
+                dims[i] = rows;
+                dims[i + 1] = cols;
+            }
+            return dims;
+        }
+
+        template <std::size_t I = 0, class Tuple, class F>
+        inline std::enable_if_t<I == std::tuple_size<Tuple>::value>
+        visit_operand(const Tuple&, std::size_t, F&)
+        {
+        }
+
+        template <std::size_t I = 0, class Tuple, class F>
+        inline std::enable_if_t<(I < std::tuple_size<Tuple>::value)>
+        visit_operand(const Tuple& operands, std::size_t i, F& f)
+        {
+            if (i == I)
+            {
+                f(std::get<I>(operands));
+            }
+            else
+            {
+                visit_operand<I + 1>(operands, i, f);
+            }
+        }
+
+        /**
+         * Evaluates a chain of products in the order given by
+         * multi_dot_order. \em operand(i, f) calls f with the i-th array.
+         * The intermediate products are released as soon as they are
+         * consumed, and products of an array with its transpose view go
+         * through the SYRK path of dot.
+         */
+        template <class V, class F>
+        class multi_dot_chain
+        {
+        public:
+
+            using result_type = xarray<V>;
+
+            multi_dot_chain(const F& operand, std::vector<std::vector<std::size_t>> split)
+                : m_operand(operand), m_split(std::move(split))
+            {
+            }
+
+            result_type eval(std::size_t i, std::size_t j) const
+            {
+                std::size_t k = m_split[i][j];
+                result_type result;
+                with_factor(i, k, [&](const auto& lhs) {
+                    with_factor(k + 1, j, [&](const auto& rhs) { result = dot(lhs, rhs); });
+                });
+                return result;
+            }
+
+        private:
+
+            template <class G>
+            void with_factor(std::size_t i, std::size_t j, G&& g) const
+            {
+                if (i == j)
+                {
+                    m_operand(i, g);
+                }
+                else
+                {
+                    result_type product = eval(i, j);
+                    g(product);
+                }
+            }
+
+            const F& m_operand;
+            std::vector<std::vector<std::size_t>> m_split;
+        };
+
+        template <class V, class F>
+        inline xarray<V> multi_dot_impl(const std::vector<std::vector<std::size_t>>& shapes, const F& operand)
+        {
+            auto dims = multi_dot_dims(shapes);
+            multi_dot_chain<V, F> chain(operand, multi_dot_order(dims));
+            return chain.eval(0, shapes.size() - 1);
+        }
+
+        template <class E>
+        inline std::vector<std::size_t> shape_vector(const E& e)
+        {
+            return std::vector<std::size_t>(e.shape().begin(), e.shape().end());
+        }
+    }
+
+    /**
+     * Computes the product of two or more arrays in the order of
+     * parenthesization that needs the fewest multiply-adds, as NumPy's
+     * ``multi_dot``. For instance with A (10, 1000), B (1000, 5) and
+     * C (5, 500), ``(A * B) * C`` costs 75000 multiply-adds whereas
+     * ``A * (B * C)`` costs 7500000.
+     *
+     * The first array may be 1-D and is then a row vector, the last one may
+     * be 1-D and is then a column vector, all other arrays must be 2-D.
+     *
+     * @param args the arrays to multiply, in order
+     * @return the product of the arrays
+     */
+    template <class... E>
+    auto multi_dot(const xexpression<E>&... args)
+    {
+        static_assert(sizeof...(E) >= 2, "multi_dot: at least two arrays are required.");
+        using value_type = std::common_type_t<typename E::value_type...>;
+        auto operands = std::forward_as_tuple(args.derived_cast()...);
+        auto operand = [&operands](std::size_t i, auto& f) { detail::visit_operand(operands, i, f); };
+        return detail::multi_dot_impl<value_type>({detail::shape_vector(args.derived_cast())...}, operand);
+    }
+
+    /**
+     * Computes the product of a sequence of arrays of the same type in the
+     * optimal order, see the variadic overload.
+     *
+     * @param arrays the arrays to multiply, in order
+     * @return the product of the arrays
+     */
+    template <class E>
+    auto multi_dot(const std::vector<E>& arrays)
+    {
+        using value_type = typename E::value_type;
+        std::vector<std::vector<std::size_t>> shapes;
+        shapes.reserve(arrays.size());
+        for (const auto& a : arrays)
+        {
+            shapes.push_back(detail::shape_vector(a));
+        }
+        auto operand = [&arrays](std::size_t i, auto& f) { f(arrays[i]); };
+        return detail::multi_dot_impl<value_type>(shapes, operand);
+    }
+
+    namespace detail
+    {
+        enum class dot_kernel
+        {
+            dynamic,
+            vector,
+            matrix_vector,
+            vector_matrix,
+            matrix_matrix,
+            generic
+        };
+
+        constexpr dot_kernel select_dot_kernel(std::ptrdiff_t t_dim, std::ptrdiff_t o_dim)
+        {
+            return (t_dim < 0 || o_dim < 0) ? dot_kernel::dynamic :
+                   (t_dim == 1 && o_dim == 1) ? dot_kernel::vector :
+                   (t_dim == 2 && o_dim == 1) ? dot_kernel::matrix_vector :
+                   (t_dim == 1 && o_dim == 2) ? dot_kernel::vector_matrix :
+                   (t_dim == 2 && o_dim == 2) ? dot_kernel::matrix_matrix :
+                   dot_kernel::generic;
+        }
+
+        // -1 stands for a rank only known at runtime
+        constexpr std::ptrdiff_t dot_result_dimension(std::ptrdiff_t t_dim, std::ptrdiff_t o_dim)
+        {
+            return (t_dim < 0 || o_dim < 0) ? -1 :
+                   (t_dim == 0 || o_dim == 0) ? t_dim + o_dim :
+                   (t_dim + o_dim - 2 > 1) ? t_dim + o_dim - 2 : 1;
+        }
+
+        template <class V, layout_type L, std::ptrdiff_t N>
+        struct fixed_rank_result
+        {
+            using type = xtensor<V, static_cast<std::size_t>(N), L>;
+        };
+
+        template <class V, layout_type L>
+        struct fixed_rank_result<V, L, -1>
+        {
+            using type = xarray<V, L>;
+        };
+
+        template <class T, class O>
+        struct dot_traits
+        {
+            using value_type = accumulation_type_t<std::common_type_t<typename T::value_type, typename O::value_type>>;
+            static constexpr layout_type layout = (T::static_layout == O::static_layout) &&
+                                                  (T::static_layout != layout_type::dynamic && T::static_layout != layout_type::any) ?
+                                                  T::static_layout : XTENSOR_DEFAULT_LAYOUT;
+            static constexpr std::ptrdiff_t t_dim = static_dimension<typename T::shape_type>::value;
+            static constexpr std::ptrdiff_t o_dim = static_dimension<typename O::shape_type>::value;
+
+            using kernel = std::integral_constant<dot_kernel, select_dot_kernel(t_dim, o_dim)>;
+            using result_type = typename fixed_rank_result<value_type, layout, dot_result_dimension(t_dim, o_dim)>::type;
+        };
+
+        // dynamic rank, or static rank without a dedicated BLAS kernel
+        template <class R, class T, class O, dot_kernel K>
+        inline R dot_dispatch(const xexpression<T>& xt, const xexpression<O>& xo,
+                              std::integral_constant<dot_kernel, K>)
+        {
+            return R(dot_impl(xt, xo));
+        }
+
+        template <class R, class T, class O>
+        inline R dot_dispatch(const xexpression<T>& xt, const xexpression<O>& xo,
+                              std::integral_constant<dot_kernel, dot_kernel::vector>)
+        {
+            R result = R::from_shape({1});
+            dot_into(xt, xo, result);
+            return result;
+        }
+
+        template <class R, class T, class O>
+        inline R dot_dispatch(const xexpression<T>& xt, const xexpression<O>& xo,
+                              std::integral_constant<dot_kernel, dot_kernel::matrix_vector>)
+        {
+            R result = R::from_shape({xt.derived_cast().shape()[0]});
+            dot_into(xt, xo, result);
+            return result;
+        }
+
+        template <class R, class T, class O>
+        inline R dot_dispatch(const xexpression<T>& xt, const xexpression<O>& xo,
+                              std::integral_constant<dot_kernel, dot_kernel::vector_matrix>)
+        {
+            R result = R::from_shape({xo.derived_cast().shape()[1]});
+            dot_into(xt, xo, result);
+            return result;
+        }
+
+        template <class R, class T, class O>
+        inline R dot_dispatch(const xexpression<T>& xt, const xexpression<O>& xo,
+                              std::integral_constant<dot_kernel, dot_kernel::matrix_matrix>)
+        {
+            R result = R::from_shape({xt.derived_cast().shape()[0], xo.derived_cast().shape()[1]});
+            dot_into(xt, xo, result);
+            return result;
+        }
+
+        template <class R, class F, class T, class O, class K>
+        inline R dot_select(const xexpression<T>& xt, const xexpression<O>& xo, K kernel, std::true_type /*blas*/)
+        {
+            return dot_dispatch<R>(xt, xo, kernel);
+        }
+
+        template <class R, class F, class T, class O, class K>
+        inline auto dot_select(const xexpression<T>& xt, const xexpression<O>& xo, K, std::false_type /*blas*/)
+        {
+            return fixed_dot<F>(xt.derived_cast(), xo.derived_cast());
+        }
+    }
+
+    /**
+     * Non-broadcasting dot function.
+     * In the case of two 1D vectors, computes the vector dot
+     * product. In the case of complex vectors, computes the dot
+     * product without conjugating the first argument.
+     * If \em t or \em o is a 2D matrix, computes the matrix-times-vector
+     * product. If both \em t and \em o ar 2D matrices, computes
+     * the matrix-product.
+     * If the ranks of both operands are known at compile time, the
+     * result is an xtensor of the corresponding rank and the BLAS kernel
+     * is selected at compile time; otherwise an xarray is returned.
+     * Small operands whose shapes are known at compile time are multiplied
+     * without calling BLAS and give an xtensor_fixed. Matrix products with
+     * no dimension above blas::small_gemm_threshold() use an inline kernel
+     * instead of BLAS as well. Transposed, scaled and conjugated-transposed
+     * matrices are not evaluated, see \ref dot_into.
+     * Matrices of mixed value types are not converted as a whole: a real
+     * matrix multiplies a complex one through the real view of its
+     * interleaved storage where the layouts allow it, and operands of
+     * lower precision are converted block by block. The product of
+     * bfloat16 or float16 matrices is accumulated and returned in float.
+     *
+     * @param t input array
+     * @param o input array
+     *
+     * @return resulting array
+     */
+    template <class T, class O>
+    auto dot(const xexpression<T>& xt, const xexpression<O>& xo)
+    {
+        using traits = detail::dot_traits<T, O>;
+        using fixed = detail::fixed_dot_traits<typename T::shape_type, typename O::shape_type>;
+        return detail::dot_select<typename traits::result_type, fixed>(xt, xo, typename traits::kernel(),
+                                                                        std::is_void<typename fixed::shape_type>());
+    }
+
+    /// Selects the algorithm of the matrix product computed by dot
+    enum class dot_algorithm {
+        standard,  ///< GEMM of the BLAS driver
+        strassen   ///< Strassen-Winograd recursion with GEMM below set_strassen_crossover()
+    };
+
+    namespace detail
+    {
+        inline std::size_t& strassen_crossover_value()
+        {
+            static std::size_t crossover = 2048;
+            return crossover;
+        }
+    }
+
+    /**
+     * Sets the size down to which dot with dot_algorithm::strassen recurses:
+     * a product is split in four while all its dimensions exceed \em n, and
+     * multiplied by GEMM below. Defaults to 2048, so that an 8192 x 8192
+     * product recurses two levels.
+     *
+     * @param n crossover size
+     */
+    inline void set_strassen_crossover(std::size_t n)
+    {
+        detail::strassen_crossover_value() = n;
+    }
+
+    /**
+     * @return the crossover size of dot_algorithm::strassen, see
+     *         \ref set_strassen_crossover
+     */
+    inline std::size_t strassen_crossover()
+    {
+        return detail::strassen_crossover_value();
+    }
+
+    /**
+     * Matrix product of \em t and \em o computed by \em algorithm.
+     *
+     * With dot_algorithm::strassen, each level of the Winograd variant of
+     * Strassen's algorithm replaces 8 products of half the size by 7 and
+     * 15 additions, saving up to 12.5% of the flops per level for large
+     * square products. One workspace of less than half the size of the
+     * operands is allocated per call, and the products below the crossover
+     * are computed by the (multithreaded) GEMM of the BLAS driver.
+     *
+     * Strassen's algorithm is only stable normwise: the error is bounded by
+     * ``c u ||t|| ||o||`` (u the unit roundoff), not componentwise as for
+     * GEMM, and each level multiplies the constant \em c by up to 18 (see
+     * Higham, Accuracy and Stability of Numerical Algorithms, 23.2.2).
+     * Entries of the product much smaller than the norms of the operands
+     * can thus lose all their accuracy.
+     *
+     * @param t matrix of m-by-k elements
+     * @param o matrix of k-by-n elements
+     * @param algorithm algorithm of the product
+     *
+     * @return m-by-n matrix
+     */
+    template <class T, class O>
+    auto dot(const xexpression<T>& xt, const xexpression<O>& xo, dot_algorithm algorithm)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+        constexpr layout_type L = detail::dot_traits<T, O>::layout;
+        using result_type = xtensor<value_type, 2, L>;
+
+        auto&& t = view_eval<T::static_layout>(xt.derived_cast());
+        auto&& o = view_eval<O::static_layout>(xo.derived_cast());
+        if (t.dimension() != 2 || o.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "dot: the algorithm can only be selected for matrices.");
+        }
+        if (t.shape()[1] != o.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "dot: shape mismatch.");
+        }
+        if (algorithm == dot_algorithm::standard)
+        {
+            return result_type(dot(t, o));
+        }
+
+        // operands are read untransposed, in the order of the result
+        using t_type = std::decay_t<decltype(t)>;
+        using o_type = std::decay_t<decltype(o)>;
+        result_type t_copy, o_copy;
+        auto op_t = xt::detail::get_ordered_matrix_operand<L>(
+            t, t_copy,
+            std::integral_constant<bool, has_data_interface<t_type>::value && std::is_same<typename t_type::value_type, value_type>::value>());
+        auto op_o = xt::detail::get_ordered_matrix_operand<L>(
+            o, o_copy,
+            std::integral_constant<bool, has_data_interface<o_type>::value && std::is_same<typename o_type::value_type, value_type>::value>());
+
+        result_type result = result_type::from_shape({t.shape()[0], o.shape()[1]});
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm_strassen", t.shape()[0], o.shape()[1], t.shape()[1], L, 'N', 'N',
+                                     instrument::fma_flops<value_type>(double(t.shape()[0]) * double(o.shape()[1])
+                                                                       * double(t.shape()[1])));
+        cxxblas::gemm_strassen<blas_index_t>(
+            get_blas_storage_order(result),
+            to_blas_index(t.shape()[0]),
+            to_blas_index(o.shape()[1]),
+            to_blas_index(t.shape()[1]),
+            op_t.data,
+            op_t.ld,
+            op_o.data,
+            op_o.ld,
+            result.data(),
+            get_leading_stride(result),
+            to_blas_index(strassen_crossover())
+        );
+        return result;
+    }
+
+    /**
+     * Product of two quantized matrices, ``(a - a_zero) * (b - b_zero)``,
+     * computed exactly with 32 bit integer accumulation. The operands
+     * are int8 or uint8; an int8 times uint8 product (in either order)
+     * goes to ``cblas_gemm_s8u8s32`` with MKL if the zero points fit its
+     * int8 offsets. Otherwise blocks of the shifted operands are widened
+     * to int32 for the blocked integer GEMM, so that the operands are
+     * never converted as a whole.
+     *
+     * @param a int8 or uint8 matrix
+     * @param a_zero zero point of \em a
+     * @param b int8 or uint8 matrix
+     * @param b_zero zero point of \em b
+     *
+     * @return row-major int32 matrix of the product
+     */
+    template <class T, class O>
+    xtensor<std::int32_t, 2> dot_quantized(const xexpression<T>& xa, std::int32_t a_zero,
+                                           const xexpression<O>& xb, std::int32_t b_zero)
+    {
+        auto&& a = view_eval<T::static_layout>(xa.derived_cast());
+        auto&& b = view_eval<O::static_layout>(xb.derived_cast());
+        if (a.dimension() != 2 || b.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "dot_quantized: operands have to be matrices.");
+        }
+        if (a.shape()[1] != b.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "dot_quantized: shape mismatch.");
+        }
+
+        xtensor<std::int32_t, 2> result = xtensor<std::int32_t, 2>::from_shape({a.shape()[0], b.shape()[1]});
+        xt::detail::gemm_quantized(
+            get_blas_storage_order(result),
+            a.layout() != result.layout() ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+            b.layout() != result.layout() ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+            to_blas_index(a.shape()[0]),
+            to_blas_index(b.shape()[1]),
+            to_blas_index(a.shape()[1]),
+            a.data() + a.data_offset(),
+            get_leading_stride(a),
+            a_zero,
+            b.data() + b.data_offset(),
+            get_leading_stride(b),
+            b_zero,
+            result.data(),
+            get_leading_stride(result)
+        );
+        return result;
+    }
+
+    /**
+     * Real valued product of two quantized matrices, whose values are
+     * ``a_scale * (a - a_zero)`` and ``b_scale * (b - b_zero)``. The
+     * integer product of \ref dot_quantized is scaled once at the end.
+     *
+     * @param a int8 or uint8 matrix
+     * @param a_scale scale of \em a
+     * @param a_zero zero point of \em a
+     * @param b int8 or uint8 matrix
+     * @param b_scale scale of \em b
+     * @param b_zero zero point of \em b
+     *
+     * @return row-major float matrix of the product
+     */
+    template <class T, class O>
+    xtensor<float, 2> dot_quantized(const xexpression<T>& xa, float a_scale, std::int32_t a_zero,
+                                    const xexpression<O>& xb, float b_scale, std::int32_t b_zero)
+    {
+        return xtensor<float, 2>((a_scale * b_scale) * xt::cast<float>(dot_quantized(xa, a_zero, xb, b_zero)));
+    }
+
+    /**
+     * Computes the symmetric product ``a * w * transpose(a)`` of a matrix
+     * \em a and a symmetric matrix \em w. ``a * w`` is computed by GEMM,
+     * and only the lower triangle of its product with ``transpose(a)``
+     * by GEMMT, then mirrored. \em a is evaluated once for both products.
+     *
+     * @param a matrix of m-by-k elements
+     * @param w symmetric matrix of k-by-k elements
+     *
+     * @return symmetric m-by-m matrix
+     */
+    template <class T, class W>
+    auto sandwich(const xexpression<T>& xa, const xexpression<W>& xw)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename W::value_type>;
+        using result_type = xtensor<value_type, 2>;
+
+        auto&& a = view_eval<T::static_layout>(xa.derived_cast());
+        auto&& w = view_eval<W::static_layout>(xw.derived_cast());
+        if (a.dimension() != 2 || w.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "sandwich: operands have to be matrices.");
+        }
+        if (w.shape()[0] != w.shape()[1] || a.shape()[1] != w.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "sandwich: shape mismatch.");
+        }
+
+        result_type aw = result_type::from_shape({a.shape()[0], a.shape()[1]});
+        blas::gemm(a, w, aw);
+        result_type result = result_type::from_shape({a.shape()[0], a.shape()[0]});
+        blas::gemmt(aw, a, result, 'L', false, true);
+        detail::mirror_triangle(result, 'L');
+        return result;
+    }
+
+    namespace detail
+    {
+        template <class T, class O>
+        inline void check_epilogue_operands(const T& a, const O& b)
+        {
+            if (a.dimension() != 2 || b.dimension() != 2)
+            {
+                XTENSOR_THROW(std::runtime_error, "dot_epilogue: operands have to be matrices.");
+            }
+            if (a.shape()[1] != b.shape()[0])
+            {
+                XTENSOR_THROW(std::runtime_error, "dot_epilogue: shape mismatch.");
+            }
+        }
+    }
+
+    /**
+     * Computes ``f(dot(a, b))`` for an elementwise function \em f without a
+     * second pass over the product: \em f is applied to each block of the
+     * result while it is in cache (see blas::gemm_epilogue). \em f may be
+     * called concurrently.
+     *
+     * @param a matrix of m-by-k elements
+     * @param b matrix of k-by-n elements
+     * @param f function of an element of the product
+     *
+     * @return m-by-n matrix
+     */
+    template <class T, class O, class F>
+    auto dot_epilogue(const xexpression<T>& xa, const xexpression<O>& xb, F f)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+        using result_type = xtensor<value_type, 2>;
+
+        auto&& a = view_eval<T::static_layout>(xa.derived_cast());
+        auto&& b = view_eval<O::static_layout>(xb.derived_cast());
+        detail::check_epilogue_operands(a, b);
+
+        result_type result = result_type::from_shape({a.shape()[0], b.shape()[1]});
+        blas::gemm_epilogue(a, b, result, [&f](std::size_t, std::size_t, const value_type& c)
+        {
+            return value_type(f(c));
+        });
+        return result;
+    }
+
+    /**
+     * Computes ``f(dot(a, b) + bias)``, with the vector \em bias added to
+     * every row of the product, as dot_epilogue(a, b, f).
+     *
+     * @param a matrix of m-by-k elements
+     * @param b matrix of k-by-n elements
+     * @param bias vector of n elements
+     * @param f function of an element of the biased product
+     *
+     * @return m-by-n matrix
+     */
+    template <class T, class O, class B, class F>
+    auto dot_epilogue(const xexpression<T>& xa, const xexpression<O>& xb, const xexpression<B>& xbias, F f)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+        using result_type = xtensor<value_type, 2>;
+
+        auto&& a = view_eval<T::static_layout>(xa.derived_cast());
+        auto&& b = view_eval<O::static_layout>(xb.derived_cast());
+        detail::check_epilogue_operands(a, b);
+        xtensor<value_type, 1> bias = xbias.derived_cast();
+        if (bias.shape()[0] != b.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "dot_epilogue: bias must have one element per column.");
+        }
+
+        result_type result = result_type::from_shape({a.shape()[0], b.shape()[1]});
+        blas::gemm_epilogue(a, b, result, [&f, &bias](std::size_t, std::size_t j, const value_type& c)
+        {
+            return value_type(f(c + bias(j)));
+        });
+        return result;
+    }
+
+    namespace detail
+    {
+        template <class E>
+        inline void check_pairwise_operands(const E& x, const E& y)
+        {
+            if (x.dimension() != 2 || y.dimension() != 2 || x.shape()[1] != y.shape()[1])
+            {
+                XTENSOR_THROW(std::runtime_error, "pairwise_sqdist: X and Y must be matrices with the same number of columns.");
+            }
+        }
+
+        template <class E>
+        inline auto row_sq_norms(const E& a)
+        {
+            using value_type = typename E::value_type;
+            xtensor<value_type, 1> result = xtensor<value_type, 1>::from_shape({a.shape()[0]});
+            for (std::size_t i = 0; i < a.shape()[0]; ++i)
+            {
+                value_type s(0);
+                for (std::size_t j = 0; j < a.shape()[1]; ++j)
+                {
+                    s += a(i, j) * a(i, j);
+                }
+                result(i) = s;
+            }
+            return result;
+        }
+
+        constexpr std::size_t pairwise_block_rows = 256;
+        constexpr std::size_t pairwise_block_cols = 2048;
+    }
+
+    /**
+     * Squared Euclidean distances between the rows of \em X and of \em Y,
+     * computed as ``|x_i|^2 + |y_j|^2 - 2 X Y^T`` by one GEMM, with the norms
+     * added (and rounding below zero clamped) by its epilogue while each
+     * block is in cache. No m x n x d broadcast is formed; the result is the
+     * only m x n allocation. The expansion loses accuracy for pairs much
+     * closer than the norms of the points.
+     *
+     * @param X real matrix of m points of dimension d
+     * @param Y real matrix of n points of dimension d
+     * @return m-by-n matrix of squared distances
+     */
+    template <class T, class O>
+    auto pairwise_sqdist(const xexpression<T>& X, const xexpression<O>& Y)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+        static_assert(!xtl::is_complex<value_type>::value, "pairwise_sqdist: expected real points.");
+        using result_type = xtensor<value_type, 2>;
+
+        auto&& x = view_eval<layout_type::row_major>(X.derived_cast());
+        auto&& y = view_eval<layout_type::row_major>(Y.derived_cast());
+        detail::check_pairwise_operands(x, y);
+
+        auto xn = detail::row_sq_norms(x);
+        auto yn = detail::row_sq_norms(y);
+        result_type result = result_type::from_shape({x.shape()[0], y.shape()[0]});
+        if (result.size() == 0)
+        {
+            return result;
+        }
+        blas::gemm_epilogue(x, y, result, [&xn, &yn](std::size_t i, std::size_t j, const value_type& c)
+        {
+            return std::max(xn(i) + yn(j) + c, value_type(0));
+        }, false, true, value_type(-2));
+        return result;
+    }
+
+    /**
+     * The \em k nearest rows of \em Y to each row of \em X, in squared
+     * Euclidean distance, without the m x n distance matrix: blocks of X
+     * and Y rows are multiplied into a bounded tile by GEMM, as in
+     * pairwise_sqdist, and each row keeps a heap of its k best candidates.
+     * The blocks of X are processed in parallel when XTENSOR_USE_OPENMP is
+     * defined.
+     *
+     * @param X real matrix of m points of dimension d
+     * @param Y real matrix of n points of dimension d
+     * @param k number of neighbours, at most n
+     * @return tuple of the m-by-k indices into Y and the m-by-k squared
+     *         distances, by increasing distance (ties by index)
+     */
+    template <class T, class O>
+    auto pairwise_topk(const xexpression<T>& X, const xexpression<O>& Y, std::size_t k)
+    {
+        using value_type = typename T::value_type;
+        static_assert(!xtl::is_complex<value_type>::value, "pairwise_topk: expected real points.");
+        static_assert(std::is_same<value_type, typename O::value_type>::value,
+                      "pairwise_topk: X and Y must have the same value type.");
+        using candidate = std::pair<value_type, std::size_t>;
+
+        auto&& x = view_eval<layout_type::row_major>(X.derived_cast());
+        auto&& y = view_eval<layout_type::row_major>(Y.derived_cast());
+        detail::check_pairwise_operands(x, y);
+        std::size_t m = x.shape()[0], n = y.shape()[0], d = x.shape()[1];
+        if (k > n)
+        {
+            XTENSOR_THROW(std::runtime_error, "pairwise_topk: k is larger than the number of rows of Y.");
+        }
+
+        auto xn = detail::row_sq_norms(x);
+        auto yn = detail::row_sq_norms(y);
+        xtensor<std::size_t, 2> indices = xtensor<std::size_t, 2>::from_shape({m, k});
+        xtensor<value_type, 2> distances = xtensor<value_type, 2>::from_shape({m, k});
+        if (m == 0 || k == 0)
+        {
+            return std::make_tuple(std::move(indices), std::move(distances));
+        }
+
+        constexpr std::size_t bm = detail::pairwise_block_rows;
+        constexpr std::size_t bn = detail::pairwise_block_cols;
+        std::size_t blocks = (m + bm - 1) / bm;
+        const value_type* xp = x.data() + x.data_offset();
+        const value_type* yp = y.data() + y.data_offset();
+        blas_index_t ldx = std::max(blas_index_t(1), get_leading_stride(x));
+        blas_index_t ldy = std::max(blas_index_t(1), get_leading_stride(y));
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm_topk", m, n, d, layout_type::row_major, 'N', 'T',
+                                     instrument::fma_flops<value_type>(double(m) * double(n) * double(d)));
+
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(blocks); ++p)
+        {
+            std::size_t i0 = static_cast<std::size_t>(p) * bm;
+            std::size_t mi = std::min(bm, m - i0);
+            uvector<value_type> tile(mi * std::min(bn, n));
+            // max-heaps on (distance, index): the worst candidate on top
+            std::vector<std::vector<candidate>> heaps(mi);
+            for (auto& h : heaps)
+            {
+                h.reserve(k);
+            }
+
+            for (std::size_t j0 = 0; j0 < n; j0 += bn)
+            {
+                std::size_t nj = std::min(bn, n - j0);
+                cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::RowMajor, cxxblas::Transpose::NoTrans,
+                                            cxxblas::Transpose::Trans, to_blas_index(mi), to_blas_index(nj),
+                                            to_blas_index(d), value_type(-2), xp + std::ptrdiff_t(i0) * ldx, ldx,
+                                            yp + std::ptrdiff_t(j0) * ldy, ldy, value_type(0), tile.data(),
+                                            std::max(blas_index_t(1), to_blas_index(nj)));
+                for (std::size_t i = 0; i < mi; ++i)
+                {
+                    auto& h = heaps[i];
+                    const value_type* row = tile.data() + i * nj;
+                    for (std::size_t j = 0; j < nj; ++j)
+                    {
+                        candidate c(std::max(xn(i0 + i) + yn(j0 + j) + row[j], value_type(0)), j0 + j);
+                        if (h.size() < k)
+                        {
+                            h.push_back(c);
+                            std::push_heap(h.begin(), h.end());
+                        }
+                        else if (c < h.front())
+                        {
+                            std::pop_heap(h.begin(), h.end());
+                            h.back() = c;
+                            std::push_heap(h.begin(), h.end());
+                        }
+                    }
+                }
+            }
+
+            for (std::size_t i = 0; i < mi; ++i)
+            {
+                std::sort_heap(heaps[i].begin(), heaps[i].end());
+                for (std::size_t q = 0; q < k; ++q)
+                {
+                    distances(i0 + i, q) = heaps[i][q].first;
+                    indices(i0 + i, q) = heaps[i][q].second;
+                }
+            }
+        }
+        return std::make_tuple(std::move(indices), std::move(distances));
+    }
+
+    namespace detail
+    {
+        /// Bytes of an im2col tile, sized to stay in L2 with the kernel panel.
+        constexpr std::size_t im2col_tile_bytes = std::size_t(256) << 10;
+
+        struct conv2d_geometry
+        {
+            std::size_t batch, channels, height, width;
+            std::size_t filters, kh, kw;
+            std::size_t sy, sx, py, px;
+            std::size_t out_h, out_w;
+        };
+
+        template <class I, class K>
+        inline conv2d_geometry make_conv2d_geometry(const I& input, const K& kernel,
+                                                    const std::array<std::size_t, 2>& strides,
+                                                    const std::array<std::size_t, 2>& padding,
+                                                    const char* name)
+        {
+            std::size_t idim = input.dimension();
+            std::size_t kdim = kernel.dimension();
+            conv2d_geometry g;
+            if (idim == 2 && kdim == 2)
+            {
+                g.batch = 1;
+                g.channels = 1;
+                g.filters = 1;
+            }
+            else if ((idim == 3 || idim == 4) && kdim == 4)
+            {
+                g.batch = idim == 4 ? input.shape()[0] : 1;
+                g.channels = input.shape()[idim - 3];
+                g.filters = kernel.shape()[0];
+                if (kernel.shape()[1] != g.channels)
+                {
+                    XTENSOR_THROW(std::runtime_error, std::string(name) + ": the kernel and the input have different channel counts.");
+                }
+            }
+            else
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": expected a (H, W) input with a (kh, kw) kernel, "
+                                                  "or a (C, H, W) or (N, C, H, W) input with a (F, C, kh, kw) kernel.");
+            }
+            g.height = input.shape()[idim - 2];
+            g.width = input.shape()[idim - 1];
+            g.kh = kernel.shape()[kdim - 2];
+            g.kw = kernel.shape()[kdim - 1];
+            g.sy = strides[0];
+            g.sx = strides[1];
+            g.py = padding[0];
+            g.px = padding[1];
+            if (g.sy == 0 || g.sx == 0)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": strides must be positive.");
+            }
+            if (g.kh == 0 || g.kw == 0 || g.kh > g.height + 2 * g.py || g.kw > g.width + 2 * g.px)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": the kernel is larger than the padded input.");
+            }
+            g.out_h = (g.height + 2 * g.py - g.kh) / g.sy + 1;
+            g.out_w = (g.width + 2 * g.px - g.kw) / g.sx + 1;
+            return g;
+        }
+
+        /**
+         * Unfolds the output positions [p0, p0 + np) of one image into the
+         * row-major (C kh kw) x np tile \em col, zero outside the image.
+         */
+        template <class T>
+        inline void im2col_tile(const T* image, const conv2d_geometry& g, std::size_t p0, std::size_t np, T* col)
+        {
+            for (std::size_t c = 0; c < g.channels; ++c)
+            {
+                const T* plane = image + c * g.height * g.width;
+                for (std::size_t i = 0; i < g.kh; ++i)
+                {
+                    for (std::size_t j = 0; j < g.kw; ++j)
+                    {
+                        T* row = col + ((c * g.kh + i) * g.kw + j) * np;
+                        std::size_t oy = p0 / g.out_w;
+                        std::size_t ox = p0 % g.out_w;
+                        for (std::size_t q = 0; q < np; ++q)
+                        {
+                            // padded coordinates, unsigned: below the padding wraps above the bound
+                            std::size_t iy = oy * g.sy + i - g.py;
+                            std::size_t ix = ox * g.sx + j - g.px;
+                            row[q] = (iy < g.height && ix < g.width) ? plane[iy * g.width + ix] : T(0);
+                            if (++ox == g.out_w)
+                            {
+                                ox = 0;
+                                ++oy;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        template <class T>
+        inline void conv2d_image(const T* image, const T* kmat, const conv2d_geometry& g, T* out, uvector<T>& col)
+        {
+            std::size_t ck = g.channels * g.kh * g.kw;
+            std::size_t positions = g.out_h * g.out_w;
+            std::size_t tile = std::min(positions, std::max(std::size_t(1), im2col_tile_bytes / (ck * sizeof(T))));
+            if (col.size() < ck * tile)
+            {
+                col.resize(ck * tile);
+            }
+            for (std::size_t p0 = 0; p0 < positions; p0 += tile)
+            {
+                std::size_t np = std::min(tile, positions - p0);
+                im2col_tile(image, g, p0, np, col.data());
+                cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::RowMajor, cxxblas::Transpose::NoTrans,
+                                            cxxblas::Transpose::NoTrans, to_blas_index(g.filters), to_blas_index(np),
+                                            to_blas_index(ck), T(1), kmat, to_blas_index(ck), col.data(),
+                                            to_blas_index(np), T(0), out + p0, to_blas_index(positions));
+            }
+        }
+
+        template <class E, class K>
+        inline auto conv2d_impl(const xexpression<E>& input, const xexpression<K>& kernel,
+                                const std::array<std::size_t, 2>& strides,
+                                const std::array<std::size_t, 2>& padding, bool flip, const char* name)
+        {
+            using value_type = typename E::value_type;
+            static_assert(std::is_same<value_type, typename K::value_type>::value,
+                          "conv2d: the input and the kernel must have the same value type.");
+
+            auto&& x = view_eval<layout_type::row_major>(input.derived_cast());
+            const auto& k = kernel.derived_cast();
+            conv2d_geometry g = make_conv2d_geometry(x, k, strides, padding, name);
+
+            // the kernel as a row-major F x (C kh kw) matrix, flipped for a convolution
+            std::size_t ck = g.channels * g.kh * g.kw;
+            xtensor<value_type, 2> kmat = xtensor<value_type, 2>::from_shape({g.filters, ck});
+            xtensor<value_type, 4> k4 = reshape_view(k, std::vector<std::size_t>{g.filters, g.channels, g.kh, g.kw});
+            for (std::size_t f = 0; f < g.filters; ++f)
+            {
+                for (std::size_t c = 0; c < g.channels; ++c)
+                {
+                    for (std::size_t i = 0; i < g.kh; ++i)
+                    {
+                        for (std::size_t j = 0; j < g.kw; ++j)
+                        {
+                            kmat(f, (c * g.kh + i) * g.kw + j) =
+                                flip ? k4(f, c, g.kh - 1 - i, g.kw - 1 - j) : k4(f, c, i, j);
+                        }
+                    }
+                }
+            }
+
+            std::vector<std::size_t> shape;
+            if (x.dimension() == 4)
+            {
+                shape.push_back(g.batch);
+            }
+            if (x.dimension() != 2)
+            {
+                shape.push_back(g.filters);
+            }
+            shape.push_back(g.out_h);
+            shape.push_back(g.out_w);
+            xarray<value_type> result = xarray<value_type>::from_shape(shape);
+            if (result.size() == 0 || ck == 0)
+            {
+                result.fill(value_type(0));
+                return result;
+            }
+
+            const value_type* xp = x.data() + x.data_offset();
+            value_type* rp = result.data();
+            std::size_t image_size = g.channels * g.height * g.width;
+            std::size_t out_size = g.filters * g.out_h * g.out_w;
+            XTENSOR_BLAS_INSTRUMENT_CALL(name, g.filters, g.batch * g.out_h * g.out_w, ck, layout_type::row_major, 'N', 'N',
+                                         instrument::fma_flops<value_type>(double(g.batch) * double(out_size) * double(ck)));
+
+            if (g.batch == 1)
+            {
+                // one image: the BLAS threads share each tile product
+                uvector<value_type> col;
+                conv2d_image(xp, kmat.data(), g, rp, col);
+                return result;
+            }
+
+#if defined(XTENSOR_USE_OPENMP)
+            blas::scoped_num_threads guard(1);
+            #pragma omp parallel
+#endif
+            {
+#if defined(XTENSOR_USE_OPENMP)
+                blas::scoped_num_threads worker_guard(1);
+#endif
+                uvector<value_type> col;
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp for schedule(static)
+#endif
+                for (std::ptrdiff_t b = 0; b < static_cast<std::ptrdiff_t>(g.batch); ++b)
+                {
+                    std::size_t q = static_cast<std::size_t>(b);
+                    conv2d_image(xp + q * image_size, kmat.data(), g, rp + q * out_size, col);
+                }
+            }
+            return result;
+        }
+    }
+
+    /**
+     * 2-D cross-correlation of images with a bank of filters, the
+     * "convolution" of neural networks: each output position is the sum of
+     * the products of a filter with the window of the input under it.
+     *
+     * Each image is unfolded (im2col) into tiles of output positions, sized
+     * to stay in the L2 cache, and every tile is multiplied by the F x
+     * (C kh kw) filter matrix with one GEMM; the unfolded image is never
+     * formed as a whole. The images of a batch are processed in parallel
+     * when XTENSOR_USE_OPENMP is defined, with BLAS pinned to one thread; a
+     * single image uses the BLAS threads.
+     *
+     * @param input (H, W) image, (C, H, W) image of C channels, or (N, C, H, W)
+     *        batch of images
+     * @param kernel (kh, kw) filter for a (H, W) input, (F, C, kh, kw) bank
+     *        of F filters otherwise
+     * @param strides steps between output positions along H and W
+     * @param padding zeros added on both sides of the input along H and W
+     * @return (H', W'), (F, H', W') or (N, F, H', W') result, with
+     *         H' = (H + 2 padding[0] - kh) / strides[0] + 1, and W' likewise
+     */
+    template <class E, class K>
+    auto correlate2d(const xexpression<E>& input, const xexpression<K>& kernel,
+                     std::array<std::size_t, 2> strides = {{1, 1}},
+                     std::array<std::size_t, 2> padding = {{0, 0}})
+    {
+        return detail::conv2d_impl(input, kernel, strides, padding, false, "correlate2d");
+    }
+
+    /**
+     * 2-D convolution of images with a bank of filters, as correlate2d with
+     * the filters flipped along both spatial axes, so that a (H, W) input and
+     * a (kh, kw) kernel give the "valid" part of scipy.signal.convolve2d.
+     *
+     * @param input (H, W), (C, H, W) or (N, C, H, W) input, see correlate2d
+     * @param kernel (kh, kw) or (F, C, kh, kw) filters, see correlate2d
+     * @param strides steps between output positions along H and W
+     * @param padding zeros added on both sides of the input along H and W
+     * @return (H', W'), (F, H', W') or (N, F, H', W') result, see correlate2d
+     */
+    template <class E, class K>
+    auto conv2d(const xexpression<E>& input, const xexpression<K>& kernel,
+                std::array<std::size_t, 2> strides = {{1, 1}},
+                std::array<std::size_t, 2> padding = {{0, 0}})
+    {
+        return detail::conv2d_impl(input, kernel, strides, padding, true, "conv2d");
+    }
+
+    namespace detail
+    {
+        template <class R, class T, class O>
+        inline R matmul_dot(const T& a, const O& b, std::true_type /*same value type*/)
+        {
+            return dot(a, b, result_as<R>());
+        }
+
+        // reduced precision products are accumulated in float
+        template <class R, class T, class O>
+        inline R matmul_dot(const T& a, const O& b, std::false_type /*same value type*/)
+        {
+            R result = dot(a, b);
+            return result;
+        }
+
+        template <class R, class T, class O>
+        inline R matmul_impl(const xexpression<T>& xa, const xexpression<O>& xb)
+        {
+            using value_type = typename R::value_type;
+
+            auto&& a = view_eval<layout_type::row_major>(xa.derived_cast());
+            auto&& b = view_eval<layout_type::row_major>(xb.derived_cast());
+
+            std::size_t a_dim = a.dimension();
+            std::size_t b_dim = b.dimension();
+
+            if (a_dim == 0 || b_dim == 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matmul: scalar operands are not allowed.");
+            }
+
+            if (a_dim == 1 || b_dim == 1 || (a_dim == 2 && b_dim == 2))
+            {
+                using dot_value_type = typename dot_traits<std::decay_t<decltype(a)>, std::decay_t<decltype(b)>>::value_type;
+                return matmul_dot<R>(a, b, std::is_same<value_type, dot_value_type>());
+            }
+
+            std::size_t m = a.shape()[a_dim - 2];
+            std::size_t k = a.shape()[a_dim - 1];
+            std::size_t n = b.shape()[b_dim - 1];
+            if (b.shape()[b_dim - 2] != k)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matmul: shape mismatch.");
+            }
+
+            // batch dimensions are aligned to the right, as for broadcasting
+            std::size_t batch_dim = std::max(a_dim, b_dim) - 2;
+            std::size_t a_skip = batch_dim - (a_dim - 2);
+            std::size_t b_skip = batch_dim - (b_dim - 2);
+
+            dynamic_shape<std::size_t> result_shape(batch_dim + 2);
+            std::size_t batch_size = 1;
+            for (std::size_t i = 0; i < batch_dim; ++i)
+            {
+                std::size_t a_len = i < a_skip ? 1 : a.shape()[i - a_skip];
+                std::size_t b_len = i < b_skip ? 1 : b.shape()[i - b_skip];
+                if (a_len != b_len && a_len != 1 && b_len != 1)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matmul: batch dimensions cannot be broadcast.");
+                }
+                result_shape[i] = std::max(a_len, b_len);
+                batch_size *= result_shape[i];
+            }
+            result_shape[batch_dim] = m;
+            result_shape[batch_dim + 1] = n;
+            R result = make_result<R>(result_shape);
+            if (result.layout() != layout_type::row_major)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matmul: the result of a batched product has to be row major.");
+            }
+
+            using a_value_type = typename std::decay_t<decltype(a)>::value_type;
+            using b_value_type = typename std::decay_t<decltype(b)>::value_type;
+            std::vector<const a_value_type*> a_ptrs(batch_size);
+            std::vector<const b_value_type*> b_ptrs(batch_size);
+            std::vector<value_type*> c_ptrs(batch_size);
+
+            std::vector<std::size_t> idx(batch_dim, 0);
+            for (std::size_t p = 0; p < batch_size; ++p)
+            {
+                std::ptrdiff_t a_offset = 0, b_offset = 0;
+                for (std::size_t i = 0; i < batch_dim; ++i)
+                {
+                    if (i >= a_skip && a.shape()[i - a_skip] != 1)
+                    {
+                        a_offset += static_cast<std::ptrdiff_t>(idx[i]) * a.strides()[i - a_skip];
+                    }
+                    if (i >= b_skip && b.shape()[i - b_skip] != 1)
+                    {
+                        b_offset += static_cast<std::ptrdiff_t>(idx[i]) * b.strides()[i - b_skip];
+                    }
+                }
+                a_ptrs[p] = a.data() + a.data_offset() + a_offset;
+                b_ptrs[p] = b.data() + b.data_offset() + b_offset;
+                c_ptrs[p] = result.data() + p * m * n;
+
+                // increment the row-major batch index
+                for (std::size_t i = batch_dim; i != 0; --i)
+                {
+                    if (++idx[i - 1] < result_shape[i - 1])
+                    {
+                        break;
+                    }
+                    idx[i - 1] = 0;
+                }
+            }
+
+            blas_index_t lda = std::max(blas_index_t(1), xt::detail::get_leading_stride_impl(a.strides()[a_dim - 2], k));
+            blas_index_t ldb = std::max(blas_index_t(1), xt::detail::get_leading_stride_impl(b.strides()[b_dim - 2], n));
+            blas_index_t ldc = std::max(blas_index_t(1), to_blas_index(n));
+
+            // one record for the whole batch
+            XTENSOR_BLAS_INSTRUMENT_CALL("gemm_batch", m, n, k, layout_type::row_major, 'N', 'N',
+                                         instrument::fma_flops<value_type>(double(batch_size) * double(m) * double(n) * double(k)));
+
+#if defined(XTENSOR_USE_OPENMP) && !defined(HAVE_CBLAS_GEMM_BATCH)
+            #pragma omp parallel for
+            for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+            {
+                std::size_t i = static_cast<std::size_t>(p);
+                cxxblas::gemm<blas_index_t>(
+                    cxxblas::StorageOrder::RowMajor,
+                    cxxblas::Transpose::NoTrans,
+                    cxxblas::Transpose::NoTrans,
+                    to_blas_index(m),
+                    to_blas_index(n),
+                    to_blas_index(k),
+                    value_type(1.0),
+                    a_ptrs[i],
+                    lda,
+                    b_ptrs[i],
+                    ldb,
+                    value_type(0.0),
+                    c_ptrs[i],
+                    ldc
+                );
+            }
+#else
+            cxxblas::gemm_batch<blas_index_t>(
+                cxxblas::StorageOrder::RowMajor,
+                cxxblas::Transpose::NoTrans,
+                cxxblas::Transpose::NoTrans,
+                to_blas_index(m),
+                to_blas_index(n),
+                to_blas_index(k),
+                value_type(1.0),
+                a_ptrs.data(),
+                lda,
+                b_ptrs.data(),
+                ldb,
+                value_type(0.0),
+                c_ptrs.data(),
+                ldc,
+                to_blas_index(batch_size)
+            );
+#endif
+            return result;
+        }
+    }
+
+    /**
+     * Matrix product with NumPy ``matmul`` semantics.
+     * Arguments with more than two dimensions are treated as stacks of
+     * matrices residing in the last two dimensions, and the leading (batch)
+     * dimensions are broadcast against each other. All products of the
+     * stack are issued as a single batched GEMM call (``cblas_?gemm_batch``
+     * if the BLAS driver provides it, else one GEMM per matrix, run in
+     * parallel when xtensor is built with OpenMP support).
+     * If either argument is 1D or both are 2D, this is equivalent to \ref dot.
+     *
+     * @param a input array
+     * @param b input array
+     *
+     * @return resulting array
+     */
+    template <class T, class O>
+    auto matmul(const xexpression<T>& xa, const xexpression<O>& xb)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+        return detail::matmul_impl<xarray<value_type, layout_type::row_major>>(xa, xb);
+    }
+
+    /**
+     * Matrix product with NumPy ``matmul`` semantics, constructed in a
+     * container of type \em R; stacks of matrices need a row-major \em R,
+     * which the batched GEMM writes into.
+     *
+     * @param a input array
+     * @param b input array
+     * @return the product, an \em R
+     */
+    template <class T, class O, class R>
+    R matmul(const xexpression<T>& xa, const xexpression<O>& xb, result_as<R>)
+    {
+        static_assert(std::is_same<typename R::value_type,
+                                   std::common_type_t<typename T::value_type, typename O::value_type>>::value,
+                      "result_as: the container must hold the value type of the result");
+        return detail::matmul_impl<R>(xa, xb);
+    }
+
+    namespace detail
+    {
+        // the elements of e are contiguous in layout L, extents of 1 aside
+        template <layout_type L, class E>
+        inline bool is_dense(const E& e)
+        {
+            if (E::static_layout != L && e.layout() != L)
+            {
+                return false;
+            }
+            std::size_t dim = e.dimension();
+            std::ptrdiff_t expected = 1;
+            for (std::size_t i = 0; i < dim; ++i)
+            {
+                std::size_t d = L == layout_type::row_major ? dim - 1 - i : i;
+                if (e.shape()[d] != 1 && static_cast<std::ptrdiff_t>(e.strides()[d]) != expected)
+                {
+                    return false;
+                }
+                expected *= static_cast<std::ptrdiff_t>(e.shape()[d]);
+            }
+            return true;
+        }
+
+        template <layout_type L, class V, class E>
+        inline bool is_dense_buffer(const E& e, std::true_type /*has_data_interface*/)
+        {
+            return std::is_same<typename E::value_type, V>::value && is_dense<L>(e);
+        }
+
+        template <layout_type L, class V, class E>
+        inline bool is_dense_buffer(const E&, std::false_type /*has_data_interface*/)
+        {
+            return false;
+        }
+
+        template <class V, class E>
+        inline const V* buffer_data(const E& e, std::true_type /*has_data_interface*/)
+        {
+            return reinterpret_cast<const V*>(e.data() + e.data_offset());
+        }
+
+        template <class V, class E>
+        inline const V* buffer_data(const E&, std::false_type /*has_data_interface*/)
+        {
+            return nullptr;
+        }
+
+        /**
+         * The elements of \em e in row-major order: its own buffer when it
+         * is dense row-major with value type \em V, else a copy in \em copy.
+         */
+        template <class V, class E>
+        inline const V* row_major_elements(const E& e, uvector<V>& copy)
+        {
+            if (is_dense_buffer<layout_type::row_major, V>(e, has_data_interface<E>()))
+            {
+                return buffer_data<V>(e, has_data_interface<E>());
+            }
+            copy.resize(e.size());
+            std::copy(e.template cbegin<layout_type::row_major>(), e.template cend<layout_type::row_major>(), copy.begin());
+            return copy.data();
+        }
+    }
+
+    /**
+     * Computes the dot product of two arrays flattened to vectors, as
+     * NumPy's vdot: the sum of conj(a) * b over the elements in row-major
+     * order, so that complex values of \em a are conjugated.
+     *
+     * Inputs that are contiguous in the same layout and of the same value
+     * type go to a single BLAS dot (dotc) over their buffers, without
+     * copies: any two row-major ones, or column-major ones of the same
+     * shape, whose elements pair up the same in either order. Other inputs
+     * are copied to row-major order first.
+     *
+     * @param a input array
+     * @param b input array of the same size
+     *
+     * @return the scalar result
+     */
+    template <class T, class O>
+    auto vdot(const xexpression<T>& a, const xexpression<O>& b)
+    {
+        using common_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+
+        const auto& da = a.derived_cast();
+        const auto& db = b.derived_cast();
+        if (da.size() != db.size())
+        {
+            XTENSOR_THROW(std::runtime_error, "vdot: the inputs must have the same size.");
+        }
+
+        common_type result(0);
+        if (da.dimension() == 1 && db.dimension() == 1)
+        {
+            // strided vectors go to BLAS with their increments
+            blas::dot(da, db, result);
+            return result;
+        }
+
+        const common_type* pa = nullptr;
+        const common_type* pb = nullptr;
+        uvector<common_type> a_copy, b_copy;
+        if (detail::is_dense_buffer<layout_type::column_major, common_type>(da, has_data_interface<T>()) &&
+            detail::is_dense_buffer<layout_type::column_major, common_type>(db, has_data_interface<O>()) &&
+            std::equal(da.shape().cbegin(), da.shape().cend(), db.shape().cbegin(), db.shape().cend()))
+        {
+            pa = detail::buffer_data<common_type>(da, has_data_interface<T>());
+            pb = detail::buffer_data<common_type>(db, has_data_interface<O>());
+        }
+        else
+        {
+            pa = detail::row_major_elements(da, a_copy);
+            pb = detail::row_major_elements(db, b_copy);
+        }
+
+        if (da.size() != 0)
+        {
+            XTENSOR_BLAS_INSTRUMENT_CALL("dot", da.size(), 0, 0, layout_type::dynamic, 0, 0,
+                                         instrument::fma_flops<common_type>(double(da.size())));
+            cxxblas::dot<blas_index_t>(to_blas_index(da.size()), pa, 1, pb, 1, result);
+        }
+        return result;
+    }
+
+    /**
+     * Inner product with NumPy semantics: the sum over the last axes of
+     * \em a and \em b, of shape ``a.shape[:-1] + b.shape[:-1]``, without
+     * conjugation. Both arrays are seen as row-major matrices A (M x k) and
+     * B (N x k), without copies if they are dense row-major, and the result
+     * is the single GEMM A B^T. A scalar (0-D) operand scales the other.
+     *
+     * @param a input array
+     * @param b input array whose last extent matches that of \em a
+     *
+     * @return row-major array, 0-D for two vectors
+     */
+    template <class T, class O>
+    auto inner(const xexpression<T>& a, const xexpression<O>& b)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+        using result_type = xarray<value_type, layout_type::row_major>;
+
+        const auto& da = a.derived_cast();
+        const auto& db = b.derived_cast();
+        std::size_t a_dim = da.dimension();
+        std::size_t b_dim = db.dimension();
+        if (a_dim == 0 || b_dim == 0)
+        {
+            result_type result = da * db;
+            return result;
+        }
+        std::size_t k = da.shape()[a_dim - 1];
+        if (db.shape()[b_dim - 1] != k)
+        {
+            XTENSOR_THROW(std::runtime_error, "inner: the last dimensions must match.");
+        }
+
+        dynamic_shape<std::size_t> result_shape(a_dim + b_dim - 2);
+        std::copy(da.shape().cbegin(), da.shape().cbegin() + static_cast<std::ptrdiff_t>(a_dim - 1), result_shape.begin());
+        std::copy(db.shape().cbegin(), db.shape().cbegin() + static_cast<std::ptrdiff_t>(b_dim - 1),
+                  result_shape.begin() + static_cast<std::ptrdiff_t>(a_dim - 1));
+        result_type result = result_type::from_shape(result_shape);
+        std::size_t m = std::accumulate(result_shape.cbegin(), result_shape.cbegin() + static_cast<std::ptrdiff_t>(a_dim - 1),
+                                        std::size_t(1), std::multiplies<std::size_t>());
+        std::size_t n = std::accumulate(result_shape.cbegin() + static_cast<std::ptrdiff_t>(a_dim - 1), result_shape.cend(),
+                                        std::size_t(1), std::multiplies<std::size_t>());
+        if (k == 0 || result.size() == 0)
+        {
+            std::fill(result.begin(), result.end(), value_type(0));
+            return result;
+        }
+
+        uvector<value_type> a_copy, b_copy;
+        const value_type* pa = detail::row_major_elements(da, a_copy);
+        const value_type* pb = detail::row_major_elements(db, b_copy);
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm", m, n, k, layout_type::row_major, 'N', 'T',
+                                     instrument::fma_flops<value_type>(double(m) * double(n) * double(k)));
+        cxxblas::gemm<blas_index_t>(
+            cxxblas::StorageOrder::RowMajor,
+            cxxblas::Transpose::NoTrans,
+            cxxblas::Transpose::Trans,
+            to_blas_index(m),
+            to_blas_index(n),
+            to_blas_index(k),
+            value_type(1),
+            pa,
+            to_blas_index(k),
+            pb,
+            to_blas_index(k),
+            value_type(0),
+            result.data(),
+            to_blas_index(n)
+        );
+        return result;
+    }
+
+    /**
+     * Compute the outer product of two vectors.
+     *
+     * The result is allocated uninitialized and each element is written
+     * once, a row at a time.
+     *
+     * @param t input vector (1D)
+     * @param o input vector (1D)
+     *
+     * @return resulting array
+     */
+    template <class T, class O>
+    auto outer(const xexpression<T>& a, const xexpression<O>& b) {
+        using common_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+        using return_type = xtensor<common_type, 2>;
+
+        const auto& da = a.derived_cast();
+        auto&& db = view_eval<layout_type::row_major>(b.derived_cast());
+
+        XTENSOR_ASSERT(da.dimension() == 1);
+        XTENSOR_ASSERT(db.dimension() == 1);
+
+        std::size_t m = da.shape()[0], n = db.shape()[0];
+        return_type result = return_type::from_shape({m, n});
+
+        const auto* b_data = db.data() + db.data_offset();
+        common_type* row = result.data();
+        for (std::size_t i = 0; i < m; ++i, row += n)
+        {
+            common_type ai = static_cast<common_type>(da(i));
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                row[j] = ai * static_cast<common_type>(b_data[j]);
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * Rank-1 update ``C := C + alpha * outer(a, b)`` of an existing matrix
+     * with a single GER call, without a temporary for the outer product.
+     * As in outer, \em b is not conjugated.
+     *
+     * @param a input vector of m elements
+     * @param b input vector of n elements
+     * @param C row- or column-major m-by-n matrix, updated in place
+     * @param alpha scale factor of the outer product
+     * @return reference to \em C
+     */
+    template <class T, class O, class R, class V = typename R::value_type>
+    R& outer_into(const xexpression<T>& a, const xexpression<O>& b, R& C, const V& alpha = V(1))
+    {
+        static_assert(has_data_interface<R>::value, "outer_into: C must have a data interface.");
+        const auto& da = a.derived_cast();
+        const auto& db = b.derived_cast();
+        if (da.dimension() != 1 || db.dimension() != 1 || C.dimension() != 2
+            || C.shape()[0] != da.shape()[0] || C.shape()[1] != db.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "outer_into: C must have shape (a.size(), b.size()).");
+        }
+
+        blas::ger(da, db, C, static_cast<typename R::value_type>(alpha));
+        return C;
+    }
+
+    namespace detail
+    {
+        /// Which BLAS kernel applies A in a quadratic form: 0 general, 1 symmetric, 2 Hermitian
+        template <class T>
+        inline int quad_form_kernel(assume_a structure)
+        {
+            switch (structure)
+            {
+                case assume_a::symmetric:
+                    return 1;
+                case assume_a::hermitian:
+                case assume_a::positive_definite:
+                    return xtl::is_complex<T>::value ? 2 : 1;
+                default:
+                    return 0;
+            }
+        }
+
+        // t := A y for the row-major n x n A with the symmetric (kernel 1) or Hermitian (kernel 2) kernel
+        template <class T>
+        inline void quad_form_symv(int kernel, blas_index_t n, cxxblas::StorageUpLo ul, const T* a, const T* y, T* t,
+                                   std::false_type /*is_complex*/)
+        {
+            (void) kernel;
+            cxxblas::symv<blas_index_t>(cxxblas::RowMajor, ul, n, T(1), a, n, y, 1, T(0), t, 1);
+        }
+
+        template <class T>
+        inline void quad_form_symv(int kernel, blas_index_t n, cxxblas::StorageUpLo ul, const T* a, const T* y, T* t,
+                                   std::true_type /*is_complex*/)
+        {
+            if (kernel == 2)
+            {
+                cxxblas::hemv<blas_index_t>(cxxblas::RowMajor, ul, n, T(1), a, n, y, 1, T(0), t, 1);
+            }
+            else
+            {
+                cxxblas::symv<blas_index_t>(cxxblas::RowMajor, ul, n, T(1), a, n, y, 1, T(0), t, 1);
+            }
+        }
+
+        // z := x A for the row-major m x n x and n x n A, with the same kernels
+        template <class T>
+        inline void quad_form_symm(int kernel, blas_index_t m, blas_index_t n, cxxblas::StorageUpLo ul, const T* a,
+                                   const T* x, T* z, std::false_type /*is_complex*/)
+        {
+            (void) kernel;
+            cxxblas::symm<blas_index_t>(cxxblas::RowMajor, cxxblas::Side::Right, ul, m, n, T(1), a, n, x, n, T(0), z, n);
+        }
+
+        template <class T>
+        inline void quad_form_symm(int kernel, blas_index_t m, blas_index_t n, cxxblas::StorageUpLo ul, const T* a,
+                                   const T* x, T* z, std::true_type /*is_complex*/)
+        {
+            if (kernel == 2)
+            {
+                cxxblas::hemm<blas_index_t>(cxxblas::RowMajor, cxxblas::Side::Right, ul, m, n, T(1), a, n, x, n, T(0), z, n);
+            }
+            else
+            {
+                cxxblas::symm<blas_index_t>(cxxblas::RowMajor, cxxblas::Side::Right, ul, m, n, T(1), a, n, x, n, T(0), z, n);
+            }
+        }
+
+        /**
+         * d(i) = sum_j (conj(X) A)(i, j) Y(i, j) for the row-major N x n
+         * matrices X and Y, computed in blocks of rows so that only a block
+         * of conj(X) A is held at a time.
+         */
+        template <class T>
+        inline void batched_quad_form_impl(std::size_t N, std::size_t n, const T* x, const T* a, const T* y,
+                                           int kernel, char uplo, T* d)
+        {
+            std::size_t block = std::min(N, std::max(std::size_t(1), std::size_t(1 << 15) / std::max(n, std::size_t(1))));
+            uvector<T> xc(xtl::is_complex<T>::value ? block * n : 0), z(block * n);
+            cxxblas::StorageUpLo ul = xt::detail::blas_uplo(uplo);
+            for (std::size_t i0 = 0; i0 < N; i0 += block)
+            {
+                std::size_t m = std::min(block, N - i0);
+                const T* xb = x + i0 * n;
+                const T* yb = y + i0 * n;
+                const T* xr = xb;
+                if (xtl::is_complex<T>::value)
+                {
+                    std::transform(xb, xb + m * n, xc.begin(), [](const T& v) { return conj_value(v); });
+                    xr = xc.data();
+                }
+                XTENSOR_BLAS_INSTRUMENT_CALL(kernel == 0 ? "gemm" : (kernel == 1 ? "symm" : "hemm"), m, n, n,
+                                             layout_type::row_major, 'N', 'N',
+                                             instrument::fma_flops<T>(double(m) * double(n) * double(n)));
+                if (kernel == 0)
+                {
+                    cxxblas::gemm<blas_index_t>(cxxblas::RowMajor, cxxblas::NoTrans, cxxblas::NoTrans,
+                                                to_blas_index(m), to_blas_index(n), to_blas_index(n),
+                                                T(1), xr, to_blas_index(n), a, to_blas_index(n),
+                                                T(0), z.data(), to_blas_index(n));
+                }
+                else
+                {
+                    quad_form_symm(kernel, to_blas_index(m), to_blas_index(n), ul, a, xr, z.data(),
+                                   xtl::is_complex<T>());
+                }
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    const T* zi = z.data() + i * n;
+                    const T* yi = yb + i * n;
+                    T acc(0);
+                    for (std::size_t j = 0; j < n; ++j)
+                    {
+                        acc += zi[j] * yi[j];
+                    }
+                    d[i0 + i] = acc;
+                }
+            }
+        }
+    }
+
+    /**
+     * Compute the bilinear form ``x^H A y`` (``x^T A y`` for real values)
+     * with one gemv and one dot, without forming the matrix product
+     * expressions of ``dot(x, dot(A, y))``. With a symmetric or Hermitian
+     * \em structure, A is applied with symv (hemv) reading only its
+     * \em uplo triangle; other structures use gemv.
+     *
+     * @param x vector of m elements, conjugated if complex
+     * @param A matrix of m x n elements
+     * @param y vector of n elements
+     * @param structure structure of \em A, assume_a::general by default
+     * @param uplo 'L' or 'U', the triangle of a symmetric or Hermitian \em A that is read
+     * @return the scalar result
+     */
+    template <class EX, class EA, class EY>
+    auto quad_form(const xexpression<EX>& x, const xexpression<EA>& A, const xexpression<EY>& y,
+                   assume_a structure = assume_a::general, char uplo = 'L')
+    {
+        using value_type = std::common_type_t<typename EX::value_type, typename EA::value_type, typename EY::value_type>;
+        const auto& dx = x.derived_cast();
+        const auto& da = A.derived_cast();
+        const auto& dy = y.derived_cast();
+        if (dx.dimension() != 1 || da.dimension() != 2 || dy.dimension() != 1
+            || da.shape()[0] != dx.size() || da.shape()[1] != dy.size())
+        {
+            XTENSOR_THROW(std::runtime_error, "quad_form: expected x of size m, A of shape (m, n) and y of size n.");
+        }
+        std::size_t m = dx.size();
+        std::size_t n = dy.size();
+        int kernel = detail::quad_form_kernel<value_type>(structure);
+        if (kernel != 0 && m != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "quad_form: a symmetric or Hermitian A must be square.");
+        }
+        value_type result(0);
+        if (m == 0 || n == 0)
+        {
+            return result;
+        }
+
+        uvector<value_type> a_copy, x_copy, y_copy;
+        const value_type* pa = detail::row_major_elements(da, a_copy);
+        const value_type* px = detail::row_major_elements(dx, x_copy);
+        bool same = static_cast<const void*>(&dy) == static_cast<const void*>(&dx);
+        const value_type* py = same ? px : detail::row_major_elements(dy, y_copy);
+        uvector<value_type> t(m);
+        XTENSOR_BLAS_INSTRUMENT_CALL(kernel == 0 ? "gemv" : (kernel == 1 ? "symv" : "hemv"), m, n, 0,
+                                     layout_type::row_major, 0, 0,
+                                     instrument::fma_flops<value_type>(double(m) * double(n)));
+        if (kernel == 0)
+        {
+            cxxblas::gemv<blas_index_t>(cxxblas::RowMajor, cxxblas::NoTrans, to_blas_index(m), to_blas_index(n),
+                                        value_type(1), pa, to_blas_index(n), py, 1, value_type(0), t.data(), 1);
+        }
+        else
+        {
+            detail::quad_form_symv(kernel, to_blas_index(n), xt::detail::blas_uplo(uplo), pa, py, t.data(),
+                                   xtl::is_complex<value_type>());
+        }
+        cxxblas::dot<blas_index_t>(to_blas_index(m), px, 1, t.data(), 1, result);
+        return result;
+    }
+
+    /// Quadratic form ``x^H A x``; see quad_form(x, A, y)
+    template <class EX, class EA>
+    auto quad_form(const xexpression<EX>& x, const xexpression<EA>& A,
+                   assume_a structure = assume_a::general, char uplo = 'L')
+    {
+        return quad_form(x, A, x, structure, uplo);
+    }
+
+    /**
+     * Compute the bilinear forms ``x_i^H A y_i`` of the rows of \em X and
+     * \em Y, e.g. the squared Mahalanobis distances ``diag(X A X^T)`` of N
+     * points. A block of rows of ``conj(X) A`` is computed with one gemm
+     * (symm or hemm for a symmetric or Hermitian \em structure) and reduced
+     * against the same rows of \em Y right away, so the N x N product is
+     * never formed and the extra memory is bounded by a few blocks.
+     *
+     * @param X matrix of N x n elements, conjugated if complex
+     * @param A square matrix of n x n elements
+     * @param Y matrix of N x n elements
+     * @param structure structure of \em A, assume_a::general by default
+     * @param uplo 'L' or 'U', the triangle of a symmetric or Hermitian \em A that is read
+     * @return vector of the N forms
+     */
+    template <class EX, class EA, class EY>
+    auto batched_quad_form(const xexpression<EX>& X, const xexpression<EA>& A, const xexpression<EY>& Y,
+                           assume_a structure = assume_a::general, char uplo = 'L')
+    {
+        using value_type = std::common_type_t<typename EX::value_type, typename EA::value_type, typename EY::value_type>;
+        const auto& dx = X.derived_cast();
+        const auto& da = A.derived_cast();
+        const auto& dy = Y.derived_cast();
+        if (dx.dimension() != 2 || da.dimension() != 2 || dy.dimension() != 2
+            || da.shape()[0] != da.shape()[1] || dx.shape()[1] != da.shape()[0]
+            || dy.shape()[0] != dx.shape()[0] || dy.shape()[1] != dx.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "batched_quad_form: expected X and Y of shape (N, n) and A of shape (n, n).");
+        }
+        std::size_t N = dx.shape()[0];
+        std::size_t n = dx.shape()[1];
+        xtensor<value_type, 1> result = xtensor<value_type, 1>::from_shape({N});
+        if (N == 0)
+        {
+            return result;
+        }
+        if (n == 0)
+        {
+            result.fill(value_type(0));
+            return result;
+        }
+
+        int kernel = detail::quad_form_kernel<value_type>(structure);
+        uvector<value_type> a_copy, x_copy, y_copy;
+        const value_type* pa = detail::row_major_elements(da, a_copy);
+        const value_type* px = detail::row_major_elements(dx, x_copy);
+        bool same = static_cast<const void*>(&dy) == static_cast<const void*>(&dx);
+        const value_type* py = same ? px : detail::row_major_elements(dy, y_copy);
+        detail::batched_quad_form_impl(N, n, px, pa, py, kernel, uplo, result.data());
+        return result;
+    }
+
+    /// Quadratic forms ``x_i^H A x_i`` of the rows of \em X; see batched_quad_form(X, A, Y)
+    template <class EX, class EA>
+    auto batched_quad_form(const xexpression<EX>& X, const xexpression<EA>& A,
+                           assume_a structure = assume_a::general, char uplo = 'L')
+    {
+        return batched_quad_form(X, A, X, structure, uplo);
+    }
+
+    namespace detail
+    {
+        template <class E, class R>
+        inline void gram_impl(const E& A, R& result, char uplo, std::false_type /*is_complex*/)
+        {
+            blas::syrk(A, result, uplo, true);
+        }
+
+        template <class E, class R>
+        inline void gram_impl(const E& A, R& result, char uplo, std::true_type /*is_complex*/)
+        {
+            blas::herk(A, result, uplo, true);
+        }
+
+        // C += A^H A for the column-major A of k x n
+        template <class T>
+        inline void rank_k_update(char uplo, blas_index_t n, blas_index_t k, const T* A, blas_index_t ldA,
+                                  T* C, blas_index_t ldC, std::false_type /*is_complex*/)
+        {
+            cxxblas::syrk<blas_index_t>(cxxblas::ColMajor, xt::detail::blas_uplo(uplo), cxxblas::Trans, n, k,
+                                        T(1), A, ldA, T(1), C, ldC);
+        }
+
+        template <class T>
+        inline void rank_k_update(char uplo, blas_index_t n, blas_index_t k, const T* A, blas_index_t ldA,
+                                  T* C, blas_index_t ldC, std::true_type /*is_complex*/)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            cxxblas::herk<blas_index_t>(cxxblas::ColMajor, xt::detail::blas_uplo(uplo), cxxblas::ConjTrans, n, k,
+                                        real_type(1), A, ldA, real_type(1), C, ldC);
+        }
+    }
+
+    /**
+     * Compute the Gram matrix ``A^H * A`` of the columns of \em A with a
+     * single SYRK (HERK for complex matrices) call, which does half the work
+     * of the matrix product.
+     *
+     * Only the \em uplo triangle is computed, the other one is zero. This is
+     * what consumers that read one half, such as cholesky (which reads the
+     * lower triangle), expect; pass \em full to mirror it into a complete
+     * symmetric (Hermitian) matrix.
+     *
+     * @param A input matrix of m-by-n elements
+     * @param uplo 'L' or 'U', the triangle that is computed
+     * @param full mirror the computed triangle onto the other one
+     * @return column-major matrix of n-by-n elements
+     */
+    template <class E>
+    auto gram(const xexpression<E>& A, char uplo = 'L', bool full = false)
+    {
+        using value_type = typename E::value_type;
+        using result_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& a = A.derived_cast();
+        if (a.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "gram: input must be a matrix.");
+        }
+
+        std::size_t n = a.shape()[1];
+        typename result_type::shape_type s = {n, n};
+        result_type result(s, value_type(0));
+
+        detail::gram_impl(a, result, uplo, xtl::is_complex<value_type>());
+        if (full)
+        {
+            detail::mirror_triangle(result, uplo, xtl::is_complex<value_type>::value);
+        }
+        return result;
+    }
+
+    /**
+     * Gram matrix ``X^H X``, column means and covariance of a matrix X given
+     * as chunks of rows, accumulated by SYRK (HERK for complex matrices)
+     * with beta = 1 into a single n x n triangle.
+     *
+     * The rows are shifted by the mean of the first chunk before the update,
+     * so that the centered covariance does not lose its digits to the
+     * cancellation of ``X^H X - N mean^H mean`` when the means are large
+     * compared to the spread. The shifted chunk is copied to a buffer kept
+     * between calls. Accumulators filled by different threads are combined
+     * with merge, and the triangle is mirrored once, by gram or covariance.
+     */
+    template <class T>
+    class gram_accumulator
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1>;
+
+        explicit gram_accumulator(std::size_t n, char uplo = 'L');
+
+        template <class E>
+        gram_accumulator& add(const xexpression<E>& chunk);
+
+        gram_accumulator& merge(const gram_accumulator& other);
+
+        std::size_t rows() const noexcept;
+        vector_type mean() const;
+        matrix_type gram() const;
+        matrix_type covariance(std::size_t ddof = 1) const;
+
+    private:
+
+        // G += conj(d) s^T + conj(s) d^T + count conj(d) d^T, on the triangle
+        void shift_triangle(matrix_type& G, const vector_type& s, const vector_type& d, std::size_t count) const;
+        bool in_triangle(std::size_t i, std::size_t j) const noexcept;
+
+        matrix_type m_gram;    // sum of (x - shift)^H (x - shift), uplo triangle
+        vector_type m_sum;     // sum of x - shift
+        vector_type m_shift;
+        uvector<value_type> m_work;
+        std::size_t m_rows;
+        char m_uplo;
+    };
+
+    /**
+     * @param n number of columns of X
+     * @param uplo 'L' or 'U', the triangle that is accumulated
+     */
+    template <class T>
+    inline gram_accumulator<T>::gram_accumulator(std::size_t n, char uplo)
+        : m_gram(std::array<std::size_t, 2>{n, n}, value_type(0)),
+          m_sum(std::array<std::size_t, 1>{n}, value_type(0)),
+          m_shift(std::array<std::size_t, 1>{n}, value_type(0)),
+          m_rows(0),
+          m_uplo(uplo == 'u' ? 'U' : (uplo == 'l' ? 'L' : uplo))
+    {
+        if (m_uplo != 'L' && m_uplo != 'U')
+        {
+            XTENSOR_THROW(std::runtime_error, "gram_accumulator: uplo must be 'L' or 'U'.");
+        }
+    }
+
+    /**
+     * Add a chunk of rows of X.
+     * @param chunk matrix of shape (k, n)
+     */
+    template <class T>
+    template <class E>
+    inline gram_accumulator<T>& gram_accumulator<T>::add(const xexpression<E>& chunk)
+    {
+        const auto& x = chunk.derived_cast();
+        std::size_t n = m_gram.shape()[0];
+        if (x.dimension() != 2 || x.shape()[1] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "gram_accumulator: the chunks must have n columns.");
+        }
+        std::size_t k = x.shape()[0];
+        if (k == 0 || n == 0)
+        {
+            m_rows += k;
+            return *this;
+        }
+        if (m_rows == 0)
+        {
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                value_type s(0);
+                for (std::size_t i = 0; i < k; ++i)
+                {
+                    s += static_cast<value_type>(x(i, j));
+                }
+                m_shift(j) = s / real_type(k);
+            }
+        }
+
+        m_work.resize(k * n);
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            value_type* col = m_work.data() + j * k;
+            value_type s(0);
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                col[i] = static_cast<value_type>(x(i, j)) - m_shift(j);
+                s += col[i];
+            }
+            m_sum(j) += s;
+        }
+
+        XTENSOR_BLAS_INSTRUMENT_CALL("syrk_accumulate", n, n, k, layout_type::column_major);
+        detail::rank_k_update(m_uplo, to_blas_index(n), to_blas_index(k), m_work.data(), to_blas_index(k),
+                              m_gram.data(), to_blas_index(n), xtl::is_complex<value_type>());
+        m_rows += k;
+        return *this;
+    }
+
+    /**
+     * Add the rows accumulated by \em other, e.g. in another thread.
+     */
+    template <class T>
+    inline gram_accumulator<T>& gram_accumulator<T>::merge(const gram_accumulator& other)
+    {
+        std::size_t n = m_gram.shape()[0];
+        if (other.m_gram.shape()[0] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "gram_accumulator: merge of accumulators of different sizes.");
+        }
+        if (other.m_rows == 0)
+        {
+            return *this;
+        }
+        if (m_rows == 0)
+        {
+            char uplo = m_uplo;
+            *this = other;
+            if (uplo != m_uplo)
+            {
+                detail::mirror_triangle(m_gram, m_uplo, xtl::is_complex<value_type>::value);
+                m_uplo = uplo;
+            }
+            return *this;
+        }
+
+        // the rows of other, shifted by this shift instead of theirs
+        matrix_type G = other.m_gram;
+        if (other.m_uplo != m_uplo)
+        {
+            detail::mirror_triangle(G, other.m_uplo, xtl::is_complex<value_type>::value);
+        }
+        vector_type d = other.m_shift;
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            d(j) -= m_shift(j);
+        }
+        shift_triangle(G, other.m_sum, d, other.m_rows);
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (in_triangle(i, j))
+                {
+                    m_gram(i, j) += G(i, j);
+                }
+            }
+            m_sum(j) += other.m_sum(j) + real_type(other.m_rows) * d(j);
+        }
+        m_rows += other.m_rows;
+        return *this;
+    }
+
+    template <class T>
+    inline bool gram_accumulator<T>::in_triangle(std::size_t i, std::size_t j) const noexcept
+    {
+        return m_uplo == 'L' ? i >= j : i <= j;
+    }
+
+    template <class T>
+    inline void gram_accumulator<T>::shift_triangle(matrix_type& G, const vector_type& s, const vector_type& d,
+                                                    std::size_t count) const
+    {
+        std::size_t n = G.shape()[0];
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (in_triangle(i, j))
+                {
+                    G(i, j) += detail::conj_value(d(i)) * s(j) + detail::conj_value(s(i)) * d(j)
+                               + real_type(count) * detail::conj_value(d(i)) * d(j);
+                }
+            }
+        }
+    }
+
+    /// @return the number of rows added
+    template <class T>
+    inline std::size_t gram_accumulator<T>::rows() const noexcept
+    {
+        return m_rows;
+    }
+
+    /// @return the mean of the columns of X
+    template <class T>
+    inline auto gram_accumulator<T>::mean() const -> vector_type
+    {
+        if (m_rows == 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "gram_accumulator: no rows were added.");
+        }
+        vector_type result = m_shift;
+        for (std::size_t j = 0; j < result.shape()[0]; ++j)
+        {
+            result(j) += m_sum(j) / real_type(m_rows);
+        }
+        return result;
+    }
+
+    /// @return the full Gram matrix X^H X, of shape (n, n)
+    template <class T>
+    inline auto gram_accumulator<T>::gram() const -> matrix_type
+    {
+        matrix_type result = m_gram;
+        shift_triangle(result, m_sum, m_shift, m_rows);
+        detail::mirror_triangle(result, m_uplo, xtl::is_complex<value_type>::value);
+        return result;
+    }
+
+    /**
+     * @param ddof delta degrees of freedom: the sums of squares are divided
+     *        by N - ddof, 1 for the unbiased estimate
+     * @return the full covariance matrix of the columns of X, whose (i, j)
+     *         element is the mean of conj(x_i - mean_i) (x_j - mean_j)
+     */
+    template <class T>
+    inline auto gram_accumulator<T>::covariance(std::size_t ddof) const -> matrix_type
+    {
+        if (m_rows <= ddof)
+        {
+            XTENSOR_THROW(std::runtime_error, "gram_accumulator: not enough rows for the covariance.");
+        }
+        std::size_t n = m_gram.shape()[0];
+        matrix_type result = m_gram;
+        real_type scale = real_type(1) / real_type(m_rows - ddof);
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (in_triangle(i, j))
+                {
+                    result(i, j) = (result(i, j) - detail::conj_value(m_sum(i)) * m_sum(j) / real_type(m_rows)) * scale;
+                }
+            }
+        }
+        detail::mirror_triangle(result, m_uplo, xtl::is_complex<value_type>::value);
+        return result;
+    }
+
+    namespace detail
+    {
+        /// True for the column-major containers, whose buffer an rvalue argument can hand over.
+        template <class E>
+        struct is_column_major_container : std::false_type
+        {
+        };
+
+        template <class EC, class SC, class Tag>
+        struct is_column_major_container<xarray_container<EC, layout_type::column_major, SC, Tag>> : std::true_type
+        {
+        };
+
+        template <class EC, class Tag>
+        struct is_column_major_container<xtensor_container<EC, 2, layout_type::column_major, Tag>> : std::true_type
+        {
+        };
+
+        /// Determinant of the column-major square matrix \em LU, overwritten with its LU factors.
+        template <class M>
+        inline auto det_inplace(M& LU)
+        {
+            std::size_t n = LU.shape()[0];
+            uvector<blas_index_t> piv(n);
+            lapack::getrf(LU, piv);
+            return det_from_lu(LU.data(), piv.data(), n);
+        }
+
+        template <class M>
+        inline auto slogdet_inplace(M& LU, std::true_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+            std::size_t n = LU.shape()[0];
+            uvector<blas_index_t> piv(n);
+            if (lapack::getrf(LU, piv) != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "LU factorization did not compute.");
+            }
+            auto res = slogdet_from_lu(LU.data(), piv.data(), n);
+            return std::make_tuple(std::get<0>(res), value_type(std::get<1>(res)));
+        }
+
+        template <class M>
+        inline auto slogdet_inplace(M& LU, std::false_type /*is_complex*/)
+        {
+            std::size_t n = LU.shape()[0];
+            uvector<blas_index_t> piv(n);
+            lapack::getrf(LU, piv);
+            return slogdet_from_lu(LU.data(), piv.data(), n);
+        }
+
+        template <class E>
+        inline auto det_dispatch(const E& A, std::integral_constant<std::size_t, 0>)
+        {
+            auto LU = column_major_up_to_transpose(A);
+            return det_inplace(LU);
+        }
+
+        template <class E, std::size_t N>
+        inline auto det_dispatch(const E& A, std::integral_constant<std::size_t, N> order)
+        {
+            return fixed_det(load_fixed_matrix<typename E::value_type, N>(A), order);
+        }
+    }
+
+    /**
+     * Compute the determinant by utilizing LU factorization
+     * (closed form for 2x2 and 3x3 matrices whose shape is known at compile time).
+     *
+     * A column-major xarray or xtensor passed as an rvalue is factored in
+     * its own buffer instead of a copy.
+     *
+     * @param A matrix for which determinant is to be computed
+     * @returns determinant of the \em A
+     */
+    template <class T>
+    auto det(const xexpression<T>& A)
+    {
+        assert_nd_square(A);
+        return detail::det_dispatch(A.derived_cast(), detail::fixed_square_order<T>());
+    }
+
+    /// @cond DOXYGEN_INCLUDE_SFINAE
+    template <class E, std::enable_if_t<detail::is_column_major_container<E>::value, int> = 0>
+    auto det(E&& A)
+    {
+        assert_nd_square(A);
+        E LU = std::move(A);
+        return detail::det_inplace(LU);
+    }
+    /// @endcond
+
+    /**
+     * Compute the sign and (natural) logarithm of the determinant of an xexpression.
+     *
+     * If an array has a very small or very large determinant, then a call to det may
+     * overflow or underflow. This routine is more robust against such issues, because
+     * it computes the logarithm of the determinant rather than the determinant itself.
+     * A column-major xarray or xtensor passed as an rvalue is factored in
+     * its own buffer instead of a copy.
+     *
+     * @param A matrix for which determinant is to be computed
+     * @returns tuple containing (sign, determinant)
+     */
+    template <class T>
+    auto slogdet(const xexpression<T>& A)
+    {
+        using value_type = typename T::value_type;
+        assert_nd_square(A);
+        auto LU = detail::column_major_up_to_transpose(A.derived_cast());
+        return detail::slogdet_inplace(LU, xtl::is_complex<value_type>());
+    }
+
+    /// @cond DOXYGEN_INCLUDE_SFINAE
+    template <class E, std::enable_if_t<detail::is_column_major_container<E>::value, int> = 0>
+    auto slogdet(E&& A)
+    {
+        assert_nd_square(A);
+        E LU = std::move(A);
+        return detail::slogdet_inplace(LU, xtl::is_complex<typename E::value_type>());
+    }
+    /// @endcond
+
+    /**
+     * Compute the sign and (natural) logarithm of the determinant of a
+     * matrix of known structure.
+     *
+     * A positive definite matrix is factored with Cholesky, half the work
+     * of LU, and its sign is 1. With assume_a::detect, a matrix that looked
+     * positive definite but is not falls back to LU, the other structures
+     * always use it.
+     *
+     * @param A square matrix
+     * @param structure structure of \em A, or assume_a::detect
+     * @returns tuple containing (sign, determinant), as slogdet(A)
+     * @throws std::runtime_error if \em A was declared positive definite and is not
+     */
+    template <class T>
+    auto slogdet(const xexpression<T>& A, assume_a structure)
+    {
+        using value_type = typename T::value_type;
+        assert_nd_square(A);
+
+        bool detected = structure == assume_a::detect;
+        if (detected)
+        {
+            structure = detail::probe_structure(A.derived_cast());
+        }
+
+        if (structure == assume_a::positive_definite)
+        {
+            xtensor<value_type, 2, layout_type::column_major> L = A.derived_cast();
+            if (lapack::potr(L, 'L') == 0)
+            {
+                auto res = detail::slogdet_from_cholesky(L.data(), L.shape()[0]);
+                return std::make_tuple(std::get<0>(res), value_type(std::get<1>(res)));
+            }
+            if (!detected)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is not positive definite.");
+            }
+        }
+        return slogdet(A);
+    }
+
+    namespace detail
+    {
+        template <class E, class T>
+        inline auto call_gqr(E& A, T& tau, blas_index_t n)
+            -> std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>
+        {
+            int info = lapack::orgqr(A, tau, n);
+            if (info > 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find Q (orgqr).");
+            }
+        }
+
+        template <class E, class T>
+        inline auto call_gqr(E& A, T& tau, blas_index_t n)
+            -> std::enable_if_t<xtl::is_complex<typename E::value_type>::value>
+        {
+            int info = lapack::ungqr(A, tau, n);
+            if (info > 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Could not find Q (ungqr).");
+            }
+        }
+    }
+
+    /// Select the mode for the qr decomposition ``K = min(M, K)``
+    enum class qrmode {
+        reduced,  ///< return Q, R with dimensions (M, K), (K, N) (default)
+        complete, ///< return Q, R with dimensions (M, M), (M, N)
+        r,        ///< return empty Q and R with dimensions (0, 0), (K, N)
+        raw       ///< return H, Tau with dimensions (N, M), (K, 1)
+    };
+
+    namespace detail
+    {
+        /**
+         * Copies the upper trapezoid of the first \em rows rows of the
+         * column-major \em H into \em R, which is resized to rows x N. The
+         * entries below the diagonal are set to zero.
+         */
+        template <class X, class Y>
+        inline void copy_upper_trapezoid(const X& H, std::size_t rows, Y& R)
+        {
+            using value_type = typename Y::value_type;
+
+            std::size_t M = H.shape()[0];
+            std::size_t N = H.shape()[1];
+            R.resize({rows, N});
+            const auto* h = H.data();
+            auto* r = R.data();
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                std::size_t len = std::min(std::min(j + 1, M), rows);
+                std::copy(h + j * M, h + j * M + len, r + j * rows);
+                std::fill(r + j * rows + len, r + (j + 1) * rows, value_type(0));
+            }
+        }
+
+        /**
+         * Builds the result of qr and qr_pivoted from the reflectors \em H
+         * and \em tau computed by geqrf / geqp3. R is copied out of \em H
+         * once, and Q is generated in the buffer of \em H when it has the
+         * shape of Q, in a copy of its leading columns otherwise.
+         */
+        template <class X>
+        inline auto qr_assemble(X& H, X& tau, qrmode mode)
+        {
+            std::size_t M = H.shape()[0];
+            std::size_t N = H.shape()[1];
+            std::size_t K = std::min(M, N);
+
+            // explicitly set shape/size == 0!
+            auto Q = X::from_shape({0});
+
+            if (mode == qrmode::raw)
+            {
+                H = transpose(H);
+                return std::make_tuple(std::move(H), std::move(tau));
+            }
+
+            bool complete = mode == qrmode::complete && M > N;
+            X R;
+            copy_upper_trapezoid(H, complete ? M : K, R);
+
+            if (mode == qrmode::r)
+            {
+                return std::make_tuple(std::move(Q), std::move(R));
+            }
+
+            if (complete || M < N)
+            {
+                // Q is M x M: the leading min(M, N) columns of H are a
+                // contiguous prefix of its column-major storage
+                Q.resize({M, M});
+                std::copy(H.data(), H.data() + M * K, Q.data());
+                call_gqr(Q, tau, to_blas_index(M));
+            }
+            else
+            {
+                call_gqr(H, tau, to_blas_index(N));
+                Q = std::move(H);
+            }
+
+            return std::make_tuple(std::move(Q), std::move(R));
+        }
+
+        template <class E>
+        inline void check_qr_inplace_operands(const E& A)
+        {
+            check_inplace_operand(A, "qr_inplace");
+            if (A.dimension() != 2 || A.shape()[0] < A.shape()[1])
+            {
+                XTENSOR_THROW(std::runtime_error, "qr_inplace: A must have at least as many rows as columns.");
+            }
+        }
+    }
+
+    /**
+     * Compute the reduced QR decomposition of \em A in the buffers of the
+     * caller, without allocating anything but tau and the LAPACK workspace.
+     *
+     * @param A Column-major M x N matrix with M >= N, overwritten with Q
+     * @param R Column-major container, resized to N x N and set to R
+     * @return reference to \em A
+     */
+    template <class E, class F>
+    E& qr_inplace(E& A, F& R)
+    {
+        using value_type = typename E::value_type;
+
+        detail::check_qr_inplace_operands(A);
+        detail::check_inplace_operand(R, "qr_inplace");
+
+        std::size_t N = A.shape()[1];
+        auto tau = xtensor<value_type, 1, layout_type::column_major>::from_shape({N});
+        int info = lapack::geqrf(A, tau);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "QR decomposition failed.");
+        }
+
+        detail::copy_upper_trapezoid(A, N, R);
+        detail::call_gqr(A, tau, to_blas_index(N));
+        return A;
+    }
+
+    /**
+     * Compute the QR decomposition of \em A.
+     * @param t The matrix to calculate Q and R for
+     * @return std::tuple with Q and R
+     */
+    template <class T>
+    auto qr(const xexpression<T>& A, qrmode mode = qrmode::reduced)
+    {
+        using value_type = typename T::value_type;
+        using xtype = xarray<value_type, layout_type::column_major>;
+
+        xtype R = A.derived_cast();
+
+        std::size_t M = R.shape()[0];
+        std::size_t N = R.shape()[1];
+        std::size_t K = std::min(M, N);
+
+        auto tau = xarray<value_type, layout_type::column_major>::from_shape({K});
+        int info = lapack::geqrf(R, tau);
+
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "QR decomposition failed.");
+        }
+
+        return detail::qr_assemble(R, tau, mode);
+    }
+
+    /**
+     * Compute the QR decomposition with column pivoting A P = Q R of \em A
+     * (geqp3). The magnitude of the diagonal of R is non-increasing, which
+     * reveals the numerical rank of \em A.
+     *
+     * @param A The matrix to calculate Q and R for
+     * @param mode shapes of Q and R, as for qr. For qrmode::raw, the
+     *        Householder reflectors and tau are returned instead of Q and R
+     * @return std::tuple with Q, R and the permutation P, such that the
+     *         columns of A at the indices P equal Q R
+     */
+    template <class T>
+    auto qr_pivoted(const xexpression<T>& A, qrmode mode = qrmode::reduced)
+    {
+        using value_type = typename T::value_type;
+        using xtype = xarray<value_type, layout_type::column_major>;
+
+        xtype R = A.derived_cast();
+
+        std::size_t N = R.shape()[1];
+        std::size_t K = std::min(R.shape()[0], N);
+
+        auto tau = xtype::from_shape({std::max(K, std::size_t(1))});
+        uvector<blas_index_t> jpvt(std::max(N, std::size_t(1)), 0);
+        int info = lapack::geqp3(R, jpvt, tau);
+
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Pivoted QR decomposition failed.");
+        }
+
+        tau = xt::view(tau, range(0, K));
+        std::array<std::size_t, 1> p_shp = {N};
+        xtensor<std::size_t, 1> P(p_shp);
+        std::transform(jpvt.begin(), jpvt.begin() + static_cast<std::ptrdiff_t>(N), P.begin(),
+                       [](blas_index_t j) { return static_cast<std::size_t>(j - 1); });
+
+        auto res = detail::qr_assemble(R, tau, mode);
+        return std::make_tuple(std::move(std::get<0>(res)), std::move(std::get<1>(res)), std::move(P));
+    }
+
+    /**
+     * Compute the Cholesky decomposition of \em A in the buffer of the caller.
+     *
+     * @param A Column-major matrix, overwritten with the lower triangular factor
+     * @param zero_upper set the strict upper triangle to zero. Without it, the
+     *        upper triangle keeps the entries of \em A, which is enough for
+     *        consumers reading only the lower triangle, such as potrs or trsm.
+     * @return reference to \em A
+     */
+    template <class T>
+    T& cholesky_inplace(T& A, bool zero_upper = true)
+    {
+        assert_nd_square(A);
+        detail::check_inplace_operand(A, "cholesky_inplace");
+
+        int info = lapack::potr(A, 'L');
+
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
+        }
+
+        if (zero_upper)
+        {
+            xblas_detail::zero_strict_triangle(A, true);
+        }
+        return A;
+    }
+
+    /**
+     * Compute the Cholesky decomposition of \em A in the buffer of the caller,
+     * without throwing. Same as cholesky_inplace, with the status returned.
+     *
+     * @param A Square, column-major matrix, overwritten with the lower triangular factor
+     * @param zero_upper set the strict upper triangle to zero on success
+     * @return 0 on success, i > 0 if the leading minor of order i is not
+     *         positive definite, -1 if \em A is not a square column-major matrix
+     */
+    template <class T>
+    int try_cholesky_inplace(T& A, bool zero_upper = true) noexcept
+    {
+        if (!detail::is_try_square_operand(A))
+        {
+            return -1;
+        }
+        int info = lapack::potr(A, 'L');
+        if (info == 0 && zero_upper)
+        {
+            xblas_detail::zero_strict_triangle(A, true);
+        }
+        return info;
+    }
+
+    namespace detail
+    {
+        template <class E>
+        inline auto cholesky_dispatch(const E& A, bool zero_upper, std::integral_constant<std::size_t, 0>)
+        {
+            auto M = copy_to_layout<layout_type::column_major>(A);
+            cholesky_inplace(M, zero_upper);
+            return M;
+        }
+
+        // the unrolled kernel always stores zeros above the diagonal
+        template <class E, std::size_t N>
+        inline auto cholesky_dispatch(const E& A, bool /*zero_upper*/, std::integral_constant<std::size_t, N>)
+        {
+            using value_type = typename E::value_type;
+
+            auto a = load_fixed_matrix<value_type, N>(A);
+            if (!small_potrf<N>(a.data()))
+            {
+                XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
+            }
+            return store_fixed<fixed_matrix<value_type, N>>(a);
+        }
+    }
+
+    /**
+     * Compute the Cholesky decomposition of \em A.
+     * Small matrices whose shape is known at compile time are decomposed by
+     * an unrolled kernel and return an xtensor_fixed.
+     * @param A Hermitian positive definite matrix, only its lower triangle is read
+     * @param zero_upper set the strict upper triangle of the factor to zero,
+     *        see cholesky_inplace
+     * @return the decomposed matrix
+     */
+    template <class T>
+    auto cholesky(const xexpression<T>& A, bool zero_upper = true)
+    {
+        assert_nd_square(A);
+        return detail::cholesky_dispatch(A.derived_cast(), zero_upper, detail::fixed_square_order<T>());
+    }
+
+    /**
+    * Solves a system of linear equations M*X = B with a symmetric
+    * where M = A*A**T if uplo is L.
+    * Factorization of M can be computed with cholesky.
+    * @return solution X
+    */
+    template <class T, class D>
+    auto solve_cholesky(const xexpression<T>& A, const xexpression<D>& b)
+    {
+      assert_nd_square(A);
+      auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+      auto p = copy_to_layout<layout_type::column_major>(b.derived_cast());
+
+      int info = lapack::potrs(M, p, 'L');
+
+      if (info > 0)
+      {
+        XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
+      }
+
+      return p;
+    }
+
+    namespace detail
+    {
+        // L L^H + x x^H for the lower triangular L with leading dimension ld:
+        // the rotation of the columns (L_k, x) zeroing x_k, for k = 0 .. n - 1
+        template <class T>
+        inline void cholesky_rank1_update(T* l, blas_index_t ld, blas_index_t n, T* x)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            for (blas_index_t k = 0; k < n; ++k)
+            {
+                T* col = l + k * ld + k;
+                T a = *col, b = x[k];
+                real_type c;
+                T s;
+                blas::rotg(a, b, c, s);
+                // keep the diagonal positive, rotg takes the sign of the larger component
+                if (std::real(a) < real_type(0))
+                {
+                    c = -c;
+                    s = -s;
+                }
+                cxxblas::rot<blas_index_t>(n - k, col, 1, x + k, 1, c, s);
+            }
+        }
+
+        // L L^H - x x^H (LINPACK downdate): with L u = x and
+        // alpha = sqrt(1 - |u|^2), the rotations mapping [u; alpha] to e_n
+        // turn [L^H; 0] into [L'^H; x^H]. Returns false, leaving L
+        // unchanged, if the result is not positive definite.
+        template <class T>
+        inline bool cholesky_rank1_downdate(T* l, blas_index_t ld, blas_index_t n, T* x)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            std::size_t size = static_cast<std::size_t>(n);
+
+            if (cxxlapack::trtrs<blas_index_t>('L', 'N', 'N', n, 1, l, ld, x, std::max(n, blas_index_t(1))) != 0)
+            {
+                return false;
+            }
+            real_type alpha(0);
+            cxxblas::nrm2<blas_index_t>(n, x, 1, alpha);
+            if (!(alpha < real_type(1)))
+            {
+                return false;
+            }
+            alpha = std::sqrt((real_type(1) - alpha) * (real_type(1) + alpha));
+
+            uvector<real_type> c(size);
+            uvector<T> s(size);
+            for (std::size_t i = size; i-- > 0;)
+            {
+                real_type scale = alpha + std::abs(x[i]);
+                real_type a = alpha / scale;
+                T v = x[i] / scale;
+                real_type norm = std::sqrt(a * a + std::norm(v));
+                c[i] = a / norm;
+                // the rotation of the rows of L^H, conjugated for the columns of L
+                s[i] = v / norm;
+                alpha = scale * norm;
+            }
+
+            std::fill(x, x + size, T(0));
+            for (std::size_t i = size; i-- > 0;)
+            {
+                blas_index_t k = to_blas_index(i);
+                cxxblas::rot<blas_index_t>(n - k, x + k, 1, l + k * ld + k, 1, c[i], s[i]);
+            }
+            return true;
+        }
+
+        template <class E, class X>
+        inline void cholesky_rank_k(E& L, const X& x, bool downdate, std::true_type /*has_data_interface*/)
+        {
+            using value_type = typename E::value_type;
+
+            std::size_t n = L.shape()[0];
+            if (L.dimension() != 2 || L.shape()[1] != n || x.dimension() < 1 || x.dimension() > 2 || x.shape()[0] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, downdate ? "cholesky_downdate: shape mismatch." : "cholesky_update: shape mismatch.");
+            }
+            if (L.layout() != layout_type::column_major && n > 1)
+            {
+                // row major factors, e.g. of fixed size, are updated through a copy
+                xtensor<value_type, 2, layout_type::column_major> Lc = L;
+                cholesky_rank_k(Lc, x, downdate, std::true_type());
+                L = Lc;
+                return;
+            }
+
+            xtensor<value_type, 2, layout_type::column_major> work;
+            if (x.dimension() == 1)
+            {
+                work = xt::view(x, xt::all(), xt::newaxis());
+            }
+            else
+            {
+                work = x;
+            }
+
+            value_type* l = L.data() + L.data_offset();
+            blas_index_t ld = n > 1 ? stride_back(L) : 1;
+            blas_index_t bn = to_blas_index(n);
+            for (std::size_t j = 0; j < work.shape()[1]; ++j)
+            {
+                value_type* col = work.data() + j * n;
+                if (!downdate)
+                {
+                    cholesky_rank1_update(l, ld, bn, col);
+                }
+                else if (!cholesky_rank1_downdate(l, ld, bn, col))
+                {
+                    XTENSOR_THROW(std::runtime_error, "cholesky_downdate: the downdated matrix is not positive definite.");
+                }
+            }
+        }
+
+        template <class E, class X>
+        inline void cholesky_rank_k(E& L, const X& x, bool downdate, std::false_type /*has_data_interface*/)
+        {
+            xtensor<typename E::value_type, 2, layout_type::column_major> Lc = L;
+            cholesky_rank_k(Lc, x, downdate, std::true_type());
+            L = Lc;
+        }
+    }
+
+    /**
+     * Update the Cholesky factor \em L of A in place to that of A + x x^H,
+     * in O(N^2) per column of x instead of refactorizing A.
+     *
+     * @param L lower triangular factor with positive diagonal, as returned
+     *          by cholesky
+     * @param x vector of N elements, or (N, K) matrix for the rank-K update
+     *          A + x x^H
+     * @return reference to \em L
+     */
+    template <class E, class X>
+    inline E& cholesky_update(E& L, const xexpression<X>& x)
+    {
+        detail::cholesky_rank_k(L, x.derived_cast(), false, has_data_interface<E>());
+        return L;
+    }
+
+    /**
+     * Downdate the Cholesky factor \em L of A in place to that of A - x x^H,
+     * in O(N^2) per column of x.
+     *
+     * Throws if A - x x^H is not positive definite. For a rank-K downdate,
+     * the columns of x before the failing one stay applied.
+     *
+     * @param L lower triangular factor with positive diagonal, as returned
+     *          by cholesky
+     * @param x vector of N elements, or (N, K) matrix for the rank-K
+     *          downdate A - x x^H
+     * @return reference to \em L
+     */
+    template <class E, class X>
+    inline E& cholesky_downdate(E& L, const xexpression<X>& x)
+    {
+        detail::cholesky_rank_k(L, x.derived_cast(), true, has_data_interface<E>());
+        return L;
+    }
+
+    /**
+     * Compute the Cholesky factorization with complete pivoting of a
+     * Hermitian positive semidefinite matrix (pstrf), which stops at its
+     * numerical rank r instead of failing on a singular matrix: A = L L^H
+     * up to the tolerance, with L of n x r elements. At each step the
+     * largest remaining diagonal element of the Schur complement is the
+     * pivot, and the factorization stops when it is at most \em tol.
+     *
+     * @param A Hermitian positive semidefinite matrix, only its lower
+     *        triangle is read
+     * @param tol stopping tolerance on the pivots, n eps max(diag(A)) if
+     *        negative
+     * @return tuple (L, P), with L in the row order of A and P the pivot
+     *         order, such that the rows of L at the indices P are lower
+     *         trapezoidal
+     */
+    template <class E>
+    auto cholesky_pivoted(const xexpression<E>& A, double tol = -1.)
+    {
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        assert_nd_square(A);
+        matrix_type M = A.derived_cast();
+        std::size_t N = M.shape()[0];
+        uvector<blas_index_t> piv(std::max(N, std::size_t(1)), 0);
+        blas_index_t rank = 0;
+        int info = lapack::pstrf(M, piv, rank, static_cast<real_type>(tol), 'L');
+        if (info < 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Pivoted Cholesky decomposition failed.");
+        }
+
+        std::size_t r = N == 0 ? 0 : static_cast<std::size_t>(rank);
+        matrix_type L = xt::zeros<value_type>({N, r});
+        std::array<std::size_t, 1> p_shp = {N};
+        xtensor<std::size_t, 1> P(p_shp);
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            P(i) = static_cast<std::size_t>(piv[i] - 1);
+        }
+        for (std::size_t j = 0; j < r; ++j)
+        {
+            for (std::size_t i = j; i < N; ++i)
+            {
+                L(P(i), j) = M(i, j);
+            }
+        }
+        return std::make_tuple(std::move(L), std::move(P));
+    }
+
+    /**
+     * Compute the first columns of the pivoted Cholesky factorization of a
+     * Hermitian positive semidefinite matrix that is only available through
+     * its diagonal and a function computing a column, as a kernel matrix.
+     * The pivots are chosen as by cholesky_pivoted, and only their columns
+     * are evaluated: k columns cost O(n k^2) flops and k calls of
+     * \em column, without ever forming the matrix.
+     *
+     * @param diag the n diagonal elements of the matrix A
+     * @param column called as column(j, c) to store column j of A into the
+     *        xtensor c of n elements
+     * @param max_rank maximum number of columns to compute
+     * @param tol stopping tolerance on the pivots, n eps max(diag) if
+     *        negative
+     * @return tuple (L, P) as for cholesky_pivoted, with L of n x r
+     *         elements, r <= max_rank, and A - L L^H positive semidefinite
+     *         with a diagonal of at most \em tol if r < max_rank
+     */
+    template <class D, class F>
+    auto cholesky_pivoted_partial(const xexpression<D>& diag, F column, std::size_t max_rank, double tol = -1.)
+    {
+        using value_type = typename D::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1>;
+
+        const auto& dg = diag.derived_cast();
+        if (dg.dimension() != 1)
+        {
+            XTENSOR_THROW(std::runtime_error, "cholesky_pivoted_partial: diag must be a vector.");
+        }
+        std::size_t N = dg.size();
+        std::size_t K = std::min(max_rank, N);
+
+        // the diagonal of the Schur complement, in the row order of A
+        std::vector<real_type> d(N);
+        std::transform(dg.cbegin(), dg.cend(), d.begin(), [](const value_type& x) { return std::real(x); });
+        real_type stop = static_cast<real_type>(tol);
+        if (stop < real_type(0))
+        {
+            real_type dmax = N == 0 ? real_type(0) : *std::max_element(d.begin(), d.end());
+            stop = real_type(N) * std::numeric_limits<real_type>::epsilon() * dmax;
+        }
+
+        std::array<std::size_t, 1> p_shp = {N};
+        xtensor<std::size_t, 1> P(p_shp);
+        std::iota(P.begin(), P.end(), std::size_t(0));
+        matrix_type L = xt::zeros<value_type>({N, K});
+        vector_type c = vector_type::from_shape({N});
+        vector_type w = vector_type::from_shape({std::max(K, std::size_t(1))});
+        blas_index_t ld = std::max(to_blas_index(N), blas_index_t(1));
+
+        std::size_t r = 0;
+        for (; r < K; ++r)
+        {
+            auto best = std::max_element(P.begin() + static_cast<std::ptrdiff_t>(r), P.end(),
+                                         [&d](std::size_t a, std::size_t b) { return d[a] < d[b]; });
+            std::size_t p = *best;
+            if (!(d[p] > stop))
+            {
+                break;
+            }
+            std::iter_swap(P.begin() + static_cast<std::ptrdiff_t>(r), best);
+
+            // column p of the Schur complement: A(:, p) - L(:, :r) L(p, :r)^H
+            column(p, c);
+            value_type* l = L.data() + r * N;
+            if (r > 0)
+            {
+                for (std::size_t j = 0; j < r; ++j)
+                {
+                    w(j) = detail::conj_value(L(p, j));
+                }
+                cxxblas::gemv<blas_index_t>(cxxblas::StorageOrder::ColMajor, cxxblas::Transpose::NoTrans,
+                                            to_blas_index(N), to_blas_index(r), value_type(-1),
+                                            L.data(), ld, w.data(), 1, value_type(1), c.data(), 1);
+            }
+
+            real_type pivot = std::sqrt(d[p]);
+            for (std::size_t t = r + 1; t < N; ++t)
+            {
+                std::size_t i = P(t);
+                l[i] = c(i) / pivot;
+                d[i] -= std::norm(l[i]);
+            }
+            l[p] = value_type(pivot);
+            d[p] = real_type(0);
+        }
+
+        if (r < K)
+        {
+            matrix_type Lr = xt::view(L, xt::all(), xt::range(0, r));
+            return std::make_tuple(std::move(Lr), std::move(P));
+        }
+        return std::make_tuple(std::move(L), std::move(P));
+    }
+
+    namespace detail
+    {
+        // op of a matrix read through storage that may be its transpose;
+        // 'C' is only valid for non-transposed storage
+        inline cxxblas::Transpose blas_transpose(char trans, bool transposed)
+        {
+            if (trans == 'C' || trans == 'c')
+            {
+                return cxxblas::Transpose::ConjTrans;
+            }
+            bool t = trans == 'T' || trans == 't';
+            return t != transposed ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans;
+        }
+    }
+
+    /**
+     * Solves op(A) x = b for a triangular \em A with trsm. Row-major and
+     * column-major matrices are read in place, a row-major one as its
+     * transpose with the other triangle, so that only \em b is copied.
+     * Elements outside the \em uplo triangle are ignored.
+     *
+     * @param A square triangular matrix
+     * @param b right hand side, a vector or one column per system
+     * @param uplo 'L' or 'U', the triangle of A that is referenced
+     * @param unit_diagonal take the diagonal of A as one instead of reading it
+     * @param trans 'N', 'T' or 'C': solve A x = b, A^T x = b or A^H x = b
+     * @return solution x, column-major, with the shape of \em b
+     */
+    template <class T, class D>
+    auto solve_triangular(const xexpression<T>& A, const xexpression<D>& b, char uplo = 'L',
+                          bool unit_diagonal = false, char trans = 'N')
+    {
+        using value_type = typename T::value_type;
+
+        assert_nd_square(A);
+        const auto& a = A.derived_cast();
+        auto p = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        std::size_t n = a.shape()[0];
+        if (p.shape()[0] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "solve_triangular: b must have as many rows as A.");
+        }
+
+        xtensor<value_type, 2, layout_type::column_major> a_copy;
+        auto op_a = xt::detail::get_matrix_operand<layout_type::column_major>(a, a_copy, has_data_interface<T>());
+        if (trans == 'C' || trans == 'c')
+        {
+            if (!xtl::is_complex<value_type>::value)
+            {
+                trans = 'T';
+            }
+            else if (op_a.transposed)
+            {
+                // A^H is the conjugate of the transposed storage, which BLAS cannot apply
+                op_a = xt::detail::get_matrix_operand<layout_type::column_major>(a, a_copy, std::false_type());
+            }
+        }
+
+        if (!unit_diagonal)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (op_a.data[static_cast<std::ptrdiff_t>(i) * (op_a.ld + 1)] == value_type(0))
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+                }
+            }
+        }
+
+        std::size_t nrhs = p.dimension() > 1 ? p.shape()[1] : 1;
+        XTENSOR_BLAS_INSTRUMENT_CALL("trsm", n, nrhs, n, layout_type::column_major, trans, 0,
+                                     instrument::fma_flops<value_type>(0.5 * double(n) * double(n) * double(nrhs)));
+        if (n != 0 && nrhs != 0)
+        {
+            cxxblas::trsm<blas_index_t>(
+                cxxblas::StorageOrder::ColMajor,
+                cxxblas::Side::Left,
+                xt::detail::blas_uplo(uplo, op_a.transposed),
+                detail::blas_transpose(trans, op_a.transposed),
+                unit_diagonal ? cxxblas::Diag::Unit : cxxblas::Diag::NonUnit,
+                to_blas_index(n),
+                to_blas_index(nrhs),
+                value_type(1),
+                op_a.data,
+                op_a.ld,
+                p.data(),
+                to_blas_index(std::max(n, std::size_t(1)))
+            );
+        }
+        return p;
+    }
+
+    /**
+     * LU factorization with partial pivoting P A = L U of a square matrix,
+     * as returned by lu_factor.
+     *
+     * The factorization is computed once. It can then be used for any number
+     * of solves, and for the determinant, inverse and condition number of A.
+     */
+    template <class T>
+    class lu_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        template <class E>
+        explicit lu_factorization(const xexpression<E>& A);
+
+        lu_factorization(matrix_type lu, uvector<blas_index_t> pivots, real_type norm, real_type norm_inf, int info);
+
+        template <class E>
+        auto solve(const xexpression<E>& b, char trans = 'N') const;
+
+        value_type det() const;
+        std::tuple<value_type, real_type> logdet() const;
+        matrix_type inv() const;
+        real_type rcond(char norm = '1') const;
+
+        bool singular() const noexcept;
+        const matrix_type& matrix() const noexcept;
+        const uvector<blas_index_t>& pivots() const noexcept;
+        real_type norm(char norm = '1') const noexcept;
+        int info() const noexcept;
+
+    private:
+
+        matrix_type m_lu;
+        uvector<blas_index_t> m_piv;
+        real_type m_norm;
+        real_type m_norm_inf;
+        int m_info;
+    };
+
+    /**
+     * Cholesky factorization A = L L^H of a symmetric (hermitian) positive
+     * definite matrix, as returned by cholesky_factor.
+     */
+    template <class T>
+    class cholesky_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        template <class E>
+        explicit cholesky_factorization(const xexpression<E>& A);
+
+        cholesky_factorization(matrix_type l, real_type norm);
+
+        template <class E>
+        auto solve(const xexpression<E>& b) const;
+
+        real_type det() const;
+        real_type logdet() const;
+        matrix_type inv(bool full = true) const;
+        real_type rcond() const;
+
+        template <class E>
+        void update(const xexpression<E>& X, bool downdate = false);
+
+        const matrix_type& matrix() const noexcept;
+        real_type norm() const noexcept;
+
+    private:
+
+        matrix_type m_l;
+        real_type m_norm;
+    };
+
+    /**
+     * Bunch-Kaufman factorization A = L D L^H of a Hermitian (or A = L D L^T
+     * of a complex symmetric) matrix that may be indefinite, as returned by
+     * ldl_factor. D is block diagonal with 1x1 and 2x2 blocks.
+     *
+     * The factorization takes half the flops and storage of the LU
+     * factorization, and the inertia of A is that of D.
+     */
+    template <class T>
+    class ldl_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using inertia_type = std::tuple<std::size_t, std::size_t, std::size_t>;
+
+        template <class E>
+        explicit ldl_factorization(const xexpression<E>& A, bool hermitian = true);
+
+        template <class E>
+        auto solve(const xexpression<E>& b) const;
+
+        value_type det() const;
+        std::tuple<value_type, real_type> logdet() const;
+        inertia_type inertia(real_type tol = real_type(0)) const;
+        matrix_type inv() const;
+        real_type rcond() const;
+
+        bool hermitian() const noexcept;
+        bool singular() const noexcept;
+        const matrix_type& matrix() const noexcept;
+        const uvector<blas_index_t>& pivots() const noexcept;
+
+    private:
+
+        value_type block_det(std::size_t k, bool pair) const;
+
+        // sytrs2 converts the factor in place and restores it, which is
+        // why solve cannot run concurrently on one object.
+        mutable matrix_type m_ldl;
+        uvector<blas_index_t> m_piv;
+        real_type m_norm;
+        int m_info;
+        bool m_hermitian;
+    };
+
+    namespace detail
+    {
+        template <class M, class V, class E>
+        inline auto apply_reflectors(M& H, V& tau, const E& b, char trans)
+        {
+            using value_type = typename M::value_type;
+            using result_type = xarray<value_type, layout_type::column_major>;
+
+            std::size_t m = H.shape()[0];
+            std::size_t n = H.shape()[1];
+            if (trans != 'N' && trans != 'T' && trans != 'C')
+            {
+                XTENSOR_THROW(std::runtime_error, "apply_q: trans must be 'N', 'T' or 'C'.");
+            }
+            if (b.dimension() < 1 || b.dimension() > 2 ||
+                !(b.shape()[0] == m || (trans == 'N' && n < m && b.shape()[0] == n)))
+            {
+                XTENSOR_THROW(std::runtime_error, "apply_q: shape mismatch.");
+            }
+
+            result_type c;
+            if (b.shape()[0] == m)
+            {
+                c = b;
+            }
+            else
+            {
+                // the economy Q is the full Q applied to b padded with zeros
+                auto shape = b.shape();
+                dynamic_shape<std::size_t> c_shape(shape.begin(), shape.end());
+                c_shape[0] = m;
+                c.resize(c_shape);
+                c.fill(value_type(0));
+                if (b.dimension() == 1)
+                {
+                    xt::view(c, range(0, n)) = b;
+                }
+                else
+                {
+                    xt::view(c, range(0, n), all()) = b;
+                }
+            }
+
+            int info = lapack::ormqr(H, tau, c, 'L', trans == 'N' ? 'N' : 'T');
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "apply_q: ormqr failed.");
+            }
+            return c;
+        }
+    }
+
+    /**
+     * QR factorization A = Q R of a matrix with at least as many rows as
+     * columns, as returned by qr_factor. Q is kept as the elementary
+     * reflectors computed by geqrf.
+     *
+     * solve returns the least squares solution for rectangular matrices.
+     * det, logdet and inv require a square matrix.
+     */
+    template <class T>
+    class qr_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1, layout_type::column_major>;
+
+        template <class E>
+        explicit qr_factorization(const xexpression<E>& A);
+
+        qr_factorization(matrix_type qr, vector_type tau);
+
+        template <class E>
+        auto solve(const xexpression<E>& b) const;
+
+        template <class E>
+        auto apply_q(const xexpression<E>& b, char trans = 'N') const;
+
+        value_type det() const;
+        std::tuple<value_type, real_type> logdet() const;
+        matrix_type inv() const;
+        real_type rcond() const;
+
+        const matrix_type& matrix() const noexcept;
+        const vector_type& tau() const noexcept;
+
+    private:
+
+        value_type reflector_det(std::size_t i) const;
+
+        // ormqr only reads the reflectors but takes them by non-const
+        // pointer, which is why solve cannot run concurrently on one object.
+        mutable matrix_type m_qr;
+        vector_type m_tau;
+    };
+
+    /***********************************
+     * lu_factorization implementation *
+     ***********************************/
+
+    template <class T>
+    template <class E>
+    inline lu_factorization<T>::lu_factorization(const xexpression<E>& A)
+        : m_lu(A.derived_cast())
+    {
+        assert_nd_square(A);
+        m_norm = lapack::lange(m_lu, '1');
+        m_norm_inf = lapack::lange(m_lu, 'I');
+        m_piv.resize(m_lu.shape()[0]);
+        m_info = lapack::getrf(m_lu, m_piv);
+        if (m_info < 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "LU factorization did not compute.");
+        }
+    }
+
+    /**
+     * Takes the factors and pivots computed by getrf, or an equivalent
+     * algorithm, of a matrix of 1-norm \em norm and infinity-norm
+     * \em norm_inf; \em info is that of getrf.
+     */
+    template <class T>
+    inline lu_factorization<T>::lu_factorization(matrix_type lu, uvector<blas_index_t> pivots,
+                                                 real_type norm, real_type norm_inf, int info)
+        : m_lu(std::move(lu)), m_piv(std::move(pivots)), m_norm(norm), m_norm_inf(norm_inf), m_info(info)
+    {
+    }
+
+    /**
+     * Solve A x = b (A^T x = b for \em trans = 'T', A^H x = b for 'C').
+     * @return solution with the shape of \em b
+     */
+    template <class T>
+    template <class E>
+    inline auto lu_factorization<T>::solve(const xexpression<E>& b, char trans) const
+    {
+        if (singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        if (x.shape()[0] != m_lu.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+        }
+        int info = lapack::getrs(m_lu, m_piv, x, trans);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return x;
+    }
+
+    template <class T>
+    inline auto lu_factorization<T>::det() const -> value_type
+    {
+        value_type result(1);
+        for (std::size_t i = 0; i < m_piv.size(); ++i)
+        {
+            if (m_piv[i] != blas_index_t(i + 1))
+            {
+                result *= value_type(-1);
+            }
+            result *= m_lu(i, i);
+        }
+        return result;
+    }
+
+    /**
+     * @return (sign, log(abs(det))) of A. The sign has modulus one for complex
+     *         matrices, and the tuple is (0, -inf) for singular matrices.
+     */
+    template <class T>
+    inline auto lu_factorization<T>::logdet() const -> std::tuple<value_type, real_type>
+    {
+        if (singular())
+        {
+            return std::make_tuple(value_type(0), -std::numeric_limits<real_type>::infinity());
+        }
+        value_type sign(1);
+        real_type result(0);
+        for (std::size_t i = 0; i < m_piv.size(); ++i)
+        {
+            if (m_piv[i] != blas_index_t(i + 1))
+            {
+                sign *= value_type(-1);
+            }
+            result += detail::log_abs_sign(sign, m_lu(i, i));
+        }
+        return std::make_tuple(sign, result);
+    }
+
+    template <class T>
+    inline auto lu_factorization<T>::inv() const -> matrix_type
+    {
+        if (singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (getrf).");
+        }
+        matrix_type result = m_lu;
+        uvector<blas_index_t> piv = m_piv;
+        int info = lapack::getri(result, piv);
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (getri).");
+        }
+        return result;
+    }
+
+    /**
+     * Estimates the reciprocal condition number of A with gecon, in O(n^2)
+     * from the factors.
+     *
+     * @param norm '1' for the 1-norm, 'I' for the infinity-norm
+     * @return estimate of the reciprocal condition number of A
+     */
+    template <class T>
+    inline auto lu_factorization<T>::rcond(char norm) const -> real_type
+    {
+        if (singular())
+        {
+            return real_type(0);
+        }
+        bool one = norm == '1' || norm == 'O' || norm == 'o';
+        real_type result(0);
+        lapack::gecon(m_lu, one ? '1' : 'I', one ? m_norm : m_norm_inf, result);
+        return result;
+    }
+
+    /**
+     * @return true if U has an exact zero on its diagonal
+     */
+    template <class T>
+    inline bool lu_factorization<T>::singular() const noexcept
+    {
+        return m_info > 0;
+    }
+
+    /**
+     * @return L and U packed in one matrix, the unit diagonal of L is not stored
+     */
+    template <class T>
+    inline auto lu_factorization<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_lu;
+    }
+
+    /**
+     * @return the (1-based) pivot indices as returned by getrf
+     */
+    template <class T>
+    inline auto lu_factorization<T>::pivots() const noexcept -> const uvector<blas_index_t>&
+    {
+        return m_piv;
+    }
+
+    /**
+     * @return the 1-norm ('1') or infinity-norm ('I') of the factored matrix
+     */
+    template <class T>
+    inline auto lu_factorization<T>::norm(char norm) const noexcept -> real_type
+    {
+        return (norm == 'I' || norm == 'i') ? m_norm_inf : m_norm;
+    }
+
+    /**
+     * @return the info returned by getrf
+     */
+    template <class T>
+    inline int lu_factorization<T>::info() const noexcept
+    {
+        return m_info;
+    }
+
+    /*****************************************
+     * cholesky_factorization implementation *
+     *****************************************/
+
+    template <class T>
+    template <class E>
+    inline cholesky_factorization<T>::cholesky_factorization(const xexpression<E>& A)
+        : m_l(A.derived_cast())
+    {
+        assert_nd_square(A);
+        m_norm = lapack::lansy(m_l, '1', 'L');
+        int info = lapack::potr(m_l, 'L');
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
+        }
+        xblas_detail::zero_strict_triangle(m_l, true);
+    }
+
+    /**
+     * Takes the lower triangular factor computed by potrf, with a zero
+     * strict upper triangle, of a matrix of 1-norm \em norm.
+     */
+    template <class T>
+    inline cholesky_factorization<T>::cholesky_factorization(matrix_type l, real_type norm)
+        : m_l(std::move(l)), m_norm(norm)
+    {
+    }
+
+    /**
+     * Solve A x = b.
+     * @return solution with the shape of \em b
+     */
+    template <class T>
+    template <class E>
+    inline auto cholesky_factorization<T>::solve(const xexpression<E>& b) const
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        if (x.shape()[0] != m_l.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+        }
+        int info = lapack::potrs(m_l, x, 'L');
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return x;
+    }
+
+    template <class T>
+    inline auto cholesky_factorization<T>::det() const -> real_type
+    {
+        real_type result(1);
+        for (std::size_t i = 0; i < m_l.shape()[0]; ++i)
+        {
+            real_type d = std::real(m_l(i, i));
+            result *= d * d;
+        }
+        return result;
+    }
+
+    /**
+     * @return log(det(A)), the determinant of A being positive
+     */
+    template <class T>
+    inline auto cholesky_factorization<T>::logdet() const -> real_type
+    {
+        real_type result(0);
+        for (std::size_t i = 0; i < m_l.shape()[0]; ++i)
+        {
+            result += std::log(std::real(m_l(i, i)));
+        }
+        return real_type(2) * result;
+    }
+
+    /**
+     * Computes the inverse of A with potri, from the factor.
+     * @param full fill both triangles; otherwise only the lower triangle of
+     *        the inverse is set and the strict upper triangle is zero
+     * @return the inverse of A
+     */
+    template <class T>
+    inline auto cholesky_factorization<T>::inv(bool full) const -> matrix_type
+    {
+        matrix_type result = m_l;
+        int info = lapack::potri(result, 'L');
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Matrix not invertible (potri).");
+        }
+        if (full)
+        {
+            detail::mirror_lower(result, true);
+        }
+        return result;
+    }
+
+    /**
+     * @return estimate of the reciprocal condition number of A in the 1-norm
+     */
+    template <class T>
+    inline auto cholesky_factorization<T>::rcond() const -> real_type
+    {
+        real_type result(0);
+        lapack::pocon(m_l, 'L', m_norm, result);
+        return result;
+    }
+
+    /**
+     * Update the factorization in place to the one of A + X X^H, or of
+     * A - X X^H for \em downdate, in O(N^2 K) instead of refactoring in
+     * O(N^3); see cholesky_update.
+     *
+     * Afterwards rcond uses ||A||_1 + ||X||_1 ||X||_inf as the norm of the
+     * updated matrix, which bounds it from above, so that the estimate
+     * errs on the side of a larger condition number.
+     *
+     * @param X matrix of shape (N, K), or vector for a rank one update
+     * @param downdate subtract X X^H instead of adding it; throws, leaving
+     *        the factorization unchanged, if the result is not positive definite
+     */
+    template <class T>
+    template <class E>
+    inline void cholesky_factorization<T>::update(const xexpression<E>& X, bool downdate)
+    {
+        const auto& x = X.derived_cast();
+        matrix_type l = m_l;
+        detail::cholesky_rank_k(l, x, downdate, std::true_type());
+
+        std::size_t n = l.shape()[0];
+        std::size_t k = x.dimension() > 1 ? x.shape()[1] : 1;
+        real_type norm_1(0), norm_inf(0);
+        uvector<real_type> row_sums(n, real_type(0));
+        for (std::size_t c = 0; c < k; ++c)
+        {
+            real_type col_sum(0);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                real_type a = std::abs(x.dimension() > 1 ? x(i, c) : x(i));
+                col_sum += a;
+                row_sums[i] += a;
+            }
+            norm_1 = std::max(norm_1, col_sum);
+        }
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            norm_inf = std::max(norm_inf, row_sums[i]);
+        }
+        m_l = std::move(l);
+        m_norm += norm_1 * norm_inf;
+    }
+
+    /**
+     * @return the lower triangular factor L
+     */
+    template <class T>
+    inline auto cholesky_factorization<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_l;
+    }
+
+    /**
+     * @return the 1-norm of the factored matrix, as used by rcond
+     */
+    template <class T>
+    inline auto cholesky_factorization<T>::norm() const noexcept -> real_type
+    {
+        return m_norm;
+    }
+
+    /************************************
+     * ldl_factorization implementation *
+     ************************************/
+
+    namespace detail
+    {
+        // hetrf, hetrs, hetri and hecon for Hermitian complex matrices,
+        // the sy routines otherwise
+        template <class M, class P>
+        inline int ldl_factorize(M& A, P& piv, bool hermitian, std::true_type /*is_complex*/)
+        {
+            return hermitian ? lapack::hetrf(A, piv, 'L') : lapack::sytrf(A, piv, 'L');
+        }
+
+        template <class M, class P>
+        inline int ldl_factorize(M& A, P& piv, bool, std::false_type /*is_complex*/)
+        {
+            return lapack::sytrf(A, piv, 'L');
+        }
+
+        template <class M, class P, class B>
+        inline int ldl_solve(M& A, const P& piv, B& b, bool hermitian, std::true_type /*is_complex*/)
+        {
+            return hermitian ? lapack::hetrs(A, piv, b, 'L') : lapack::sytrs(A, piv, b, 'L');
+        }
+
+        template <class M, class P, class B>
+        inline int ldl_solve(M& A, const P& piv, B& b, bool, std::false_type /*is_complex*/)
+        {
+            return lapack::sytrs(A, piv, b, 'L');
+        }
+
+        template <class M, class P>
+        inline int ldl_inverse(M& A, const P& piv, bool hermitian, std::true_type /*is_complex*/)
+        {
+            return hermitian ? lapack::hetri(A, piv, 'L') : lapack::sytri(A, piv, 'L');
+        }
+
+        template <class M, class P>
+        inline int ldl_inverse(M& A, const P& piv, bool, std::false_type /*is_complex*/)
+        {
+            return lapack::sytri(A, piv, 'L');
+        }
+
+        template <class M, class P, class R>
+        inline int ldl_rcond(M& A, const P& piv, R anorm, R& rcond, bool hermitian, std::true_type /*is_complex*/)
+        {
+            return hermitian ? lapack::hecon(A, piv, 'L', anorm, rcond) : lapack::sycon(A, piv, 'L', anorm, rcond);
+        }
+
+        template <class M, class P, class R>
+        inline int ldl_rcond(M& A, const P& piv, R anorm, R& rcond, bool, std::false_type /*is_complex*/)
+        {
+            return lapack::sycon(A, piv, 'L', anorm, rcond);
+        }
+    }
+
+    /**
+     * Factorize \em A, of which only the lower triangle is read.
+     * @param hermitian for complex matrices, factorize A = L D L^H (hetrf);
+     *        otherwise A = L D L^T (sytrf). Ignored for real matrices.
+     */
+    template <class T>
+    template <class E>
+    inline ldl_factorization<T>::ldl_factorization(const xexpression<E>& A, bool hermitian)
+        : m_ldl(A.derived_cast()), m_hermitian(hermitian && xtl::is_complex<T>::value)
+    {
+        assert_nd_square(A);
+        m_norm = lapack::lansy(m_ldl, '1', 'L');
+        m_piv.resize(std::max(m_ldl.shape()[0], std::size_t(1)));
+        m_info = detail::ldl_factorize(m_ldl, m_piv, m_hermitian, xtl::is_complex<T>());
+        if (m_info < 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "LDL factorization did not compute.");
+        }
+        xblas_detail::zero_strict_triangle(m_ldl, true);
+    }
+
+    /**
+     * Solve A x = b, with sytrs2 (level 3 BLAS) when \em b has several
+     * columns.
+     * @return solution with the shape of \em b
+     */
+    template <class T>
+    template <class E>
+    inline auto ldl_factorization<T>::solve(const xexpression<E>& b) const
+    {
+        if (singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        if (x.shape()[0] != m_ldl.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+        }
+        int info = detail::ldl_solve(m_ldl, m_piv, x, m_hermitian, xtl::is_complex<T>());
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return x;
+    }
+
+    // determinant of the 1x1 block of D at k, or of the 2x2 block at k, k + 1
+    template <class T>
+    inline auto ldl_factorization<T>::block_det(std::size_t k, bool pair) const -> value_type
+    {
+        if (!pair)
+        {
+            return m_ldl(k, k);
+        }
+        const value_type& b = m_ldl(k + 1, k);
+        return m_ldl(k, k) * m_ldl(k + 1, k + 1) - b * (m_hermitian ? detail::conj_value(b) : b);
+    }
+
+    template <class T>
+    inline auto ldl_factorization<T>::det() const -> value_type
+    {
+        value_type result(1);
+        std::size_t n = m_ldl.shape()[0];
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            bool pair = m_piv[k] < 0;
+            result *= block_det(k, pair);
+            k += pair ? 1 : 0;
+        }
+        return result;
+    }
+
+    /**
+     * @return (sign, log(abs(det))) of A, from the blocks of D. The sign is
+     *         real for Hermitian matrices, and the tuple is (0, -inf) for
+     *         singular matrices.
+     */
+    template <class T>
+    inline auto ldl_factorization<T>::logdet() const -> std::tuple<value_type, real_type>
+    {
+        if (singular())
+        {
+            return std::make_tuple(value_type(0), -std::numeric_limits<real_type>::infinity());
+        }
+        value_type sign(1);
+        real_type result(0);
+        std::size_t n = m_ldl.shape()[0];
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            bool pair = m_piv[k] < 0;
+            result += detail::log_abs_sign(sign, block_det(k, pair));
+            k += pair ? 1 : 0;
+        }
+        return std::make_tuple(sign, result);
+    }
+
+    /**
+     * Inertia of a Hermitian A, which by Sylvester's law is that of D: the
+     * eigenvalues of the 2x2 blocks are computed in closed form. An
+     * optimizer can check that a KKT matrix has exactly as many negative
+     * eigenvalues as constraints without an eigendecomposition.
+     *
+     * @param tol eigenvalues of D of modulus at most \em tol count as zero
+     * @return numbers of positive, negative and zero eigenvalues of D
+     */
+    template <class T>
+    inline auto ldl_factorization<T>::inertia(real_type tol) const -> inertia_type
+    {
+        if (!m_hermitian && xtl::is_complex<T>::value)
+        {
+            XTENSOR_THROW(std::runtime_error, "inertia: the matrix is complex symmetric, not hermitian.");
+        }
+        std::size_t positive = 0, negative = 0, zero = 0;
+        auto count = [&](real_type lambda) {
+            if (lambda > tol)
+            {
+                ++positive;
+            }
+            else if (lambda < -tol)
+            {
+                ++negative;
+            }
+            else
+            {
+                ++zero;
+            }
+        };
+
+        std::size_t n = m_ldl.shape()[0];
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            real_type a = std::real(m_ldl(k, k));
+            if (m_piv[k] > 0)
+            {
+                count(a);
+                continue;
+            }
+            real_type c = std::real(m_ldl(k + 1, k + 1));
+            real_type mid = (a + c) / real_type(2);
+            real_type radius = std::hypot((a - c) / real_type(2), std::abs(m_ldl(k + 1, k)));
+            count(mid + radius);
+            count(mid - radius);
+            ++k;
+        }
+        return std::make_tuple(positive, negative, zero);
+    }
+
+    /**
+     * Computes the inverse of A with sytri (hetri), from the factors.
+     */
+    template <class T>
+    inline auto ldl_factorization<T>::inv() const -> matrix_type
+    {
+        if (singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (sytrf).");
+        }
+        matrix_type result = m_ldl;
+        int info = detail::ldl_inverse(result, m_piv, m_hermitian, xtl::is_complex<T>());
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Singular matrix not invertible (sytri).");
+        }
+        detail::mirror_lower(result, m_hermitian);
+        return result;
+    }
+
+    /**
+     * @return estimate of the reciprocal condition number of A in the
+     *         1-norm with sycon (hecon), 0 for singular A
+     */
+    template <class T>
+    inline auto ldl_factorization<T>::rcond() const -> real_type
+    {
+        if (singular())
+        {
+            return real_type(0);
+        }
+        real_type result(0);
+        detail::ldl_rcond(m_ldl, m_piv, m_norm, result, m_hermitian, xtl::is_complex<T>());
+        return result;
+    }
+
+    /**
+     * @return true for the L D L^H factorization of a complex matrix
+     */
+    template <class T>
+    inline bool ldl_factorization<T>::hermitian() const noexcept
+    {
+        return m_hermitian;
+    }
+
+    /**
+     * @return true if D is exactly singular
+     */
+    template <class T>
+    inline bool ldl_factorization<T>::singular() const noexcept
+    {
+        return m_info > 0;
+    }
+
+    /**
+     * @return D and the multipliers of L in the lower triangle, as returned
+     *         by sytrf; the strict upper triangle is zero
+     */
+    template <class T>
+    inline auto ldl_factorization<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_ldl;
+    }
+
+    /**
+     * @return the (1-based) pivot indices as returned by sytrf: a negative
+     *         pair marks a 2x2 block of D
+     */
+    template <class T>
+    inline auto ldl_factorization<T>::pivots() const noexcept -> const uvector<blas_index_t>&
+    {
+        return m_piv;
+    }
+
+    /***********************************
+     * qr_factorization implementation *
+     ***********************************/
+
+    template <class T>
+    template <class E>
+    inline qr_factorization<T>::qr_factorization(const xexpression<E>& A)
+        : m_qr(A.derived_cast())
+    {
+        if (m_qr.shape()[0] < m_qr.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "QR factorization requires at least as many rows as columns.");
+        }
+        m_tau.resize({m_qr.shape()[1]});
+        int info = lapack::geqrf(m_qr, m_tau);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "QR decomposition failed.");
+        }
+    }
+
+    /**
+     * Takes the reflectors and R as computed by geqrf in \em qr, and the
+     * scalar factors of the reflectors in \em tau.
+     */
+    template <class T>
+    inline qr_factorization<T>::qr_factorization(matrix_type qr, vector_type tau)
+        : m_qr(std::move(qr)), m_tau(std::move(tau))
+    {
+        if (m_qr.shape()[0] < m_qr.shape()[1] || m_tau.size() != m_qr.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "QR factorization requires at least as many rows as columns.");
+        }
+    }
+
+    /**
+     * Solve A x = b, in the least squares sense if A has more rows than
+     * columns.
+     * @return solution with shape (N) or (N, K) for \em b of shape (M) or (M, K)
+     */
+    template <class T>
+    template <class E>
+    inline auto qr_factorization<T>::solve(const xexpression<E>& b) const
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        if (x.shape()[0] != m_qr.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+        }
+
+        int info = lapack::ormqr(m_qr, m_tau, x, 'L', 'T');
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+
+        blas_index_t m = to_blas_index(m_qr.shape()[0]);
+        blas_index_t n = to_blas_index(m_qr.shape()[1]);
+        blas_index_t nrhs = x.dimension() > 1 ? to_blas_index(x.shape()[1]) : 1;
+        info = cxxlapack::trtrs<blas_index_t>(
+            'U', 'N', 'N', n, nrhs,
+            m_qr.data(), std::max(m, blas_index_t(1)),
+            x.data(), std::max(m, blas_index_t(1))
+        );
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+
+        x = view(x, range(0, m_qr.shape()[1]));
+        return x;
+    }
+
+    /**
+     * Multiply \em b by Q (\em trans = 'N') or Q^H ('T' or 'C') with ormqr /
+     * unmqr, without forming Q. For 'N', \em b may also have N rows, and is
+     * then multiplied by the economy (M, N) Q.
+     * @return product with M rows
+     */
+    template <class T>
+    template <class E>
+    inline auto qr_factorization<T>::apply_q(const xexpression<E>& b, char trans) const
+    {
+        return detail::apply_reflectors(m_qr, m_tau, b.derived_cast(), trans);
+    }
+
+    template <class T>
+    inline auto qr_factorization<T>::reflector_det(std::size_t i) const -> value_type
+    {
+        // H_i = I - tau_i v v^H with v(i) = 1, so det(H_i) = 1 - tau_i v^H v
+        real_type v_norm(1);
+        for (std::size_t k = i + 1; k < m_qr.shape()[0]; ++k)
+        {
+            v_norm += std::norm(m_qr(k, i));
+        }
+        return value_type(1) - m_tau(i) * v_norm;
+    }
+
+    template <class T>
+    inline auto qr_factorization<T>::det() const -> value_type
+    {
+        assert_nd_square(m_qr);
+        value_type result(1);
+        for (std::size_t i = 0; i < m_qr.shape()[1]; ++i)
+        {
+            result *= reflector_det(i) * m_qr(i, i);
+        }
+        return result;
+    }
+
+    /**
+     * @return (sign, log(abs(det))) of A, see lu_factorization::logdet
+     */
+    template <class T>
+    inline auto qr_factorization<T>::logdet() const -> std::tuple<value_type, real_type>
+    {
+        assert_nd_square(m_qr);
+        value_type sign(1);
+        real_type result(0);
+        for (std::size_t i = 0; i < m_qr.shape()[1]; ++i)
+        {
+            if (m_qr(i, i) == value_type(0))
+            {
+                return std::make_tuple(value_type(0), -std::numeric_limits<real_type>::infinity());
+            }
+            value_type h = reflector_det(i);
+            sign *= h / value_type(std::abs(h));
+            result += detail::log_abs_sign(sign, m_qr(i, i));
+        }
+        return std::make_tuple(sign, result);
+    }
+
+    template <class T>
+    inline auto qr_factorization<T>::inv() const -> matrix_type
+    {
+        assert_nd_square(m_qr);
+        matrix_type identity = xt::eye<value_type>(m_qr.shape()[0]);
+        return solve(identity);
+    }
+
+    /**
+     * @return estimate of the reciprocal condition number of R in the 1-norm,
+     *         which is that of A in the 2-norm
+     */
+    template <class T>
+    inline auto qr_factorization<T>::rcond() const -> real_type
+    {
+        matrix_type r = view(m_qr, range(0, m_qr.shape()[1]), all());
+        real_type result(0);
+        lapack::trcon(r, '1', 'U', 'N', result);
+        return result;
+    }
+
+    /**
+     * @return R in the upper triangle and the elementary reflectors of Q
+     *         below the diagonal, as returned by geqrf
+     */
+    template <class T>
+    inline auto qr_factorization<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_qr;
+    }
+
+    template <class T>
+    inline auto qr_factorization<T>::tau() const noexcept -> const vector_type&
+    {
+        return m_tau;
+    }
+
+    /**
+     * Compute the LU factorization of \em A once, for repeated solves.
+     * @param A square matrix
+     * @return lu_factorization of \em A
+     */
+    template <class E>
+    inline auto lu_factor(const xexpression<E>& A)
+    {
+        return lu_factorization<typename E::value_type>(A);
+    }
+
+    /**
+     * Compute the Cholesky factorization of \em A once, for repeated solves.
+     * @param A symmetric (hermitian) positive definite matrix
+     * @return cholesky_factorization of \em A
+     */
+    template <class E>
+    inline auto cholesky_factor(const xexpression<E>& A)
+    {
+        return cholesky_factorization<typename E::value_type>(A);
+    }
+
+    /**
+     * Compute the Bunch-Kaufman factorization of \em A once, for repeated
+     * solves with a symmetric indefinite matrix, such as the KKT matrix of
+     * a Newton step.
+     * @param A Hermitian (or complex symmetric) matrix; only its lower
+     *        triangle is read
+     * @param hermitian factorize a complex A as Hermitian rather than
+     *        complex symmetric
+     * @return ldl_factorization of \em A
+     */
+    template <class E>
+    inline auto ldl_factor(const xexpression<E>& A, bool hermitian = true)
+    {
+        return ldl_factorization<typename E::value_type>(A, hermitian);
+    }
+
+    /**
+     * Estimate the reciprocal condition number of a square matrix with the
+     * LAPACK condition estimators, in O(n^2) after a factorization where
+     * one is needed: gecon from the LU factorization, pocon from the
+     * Cholesky factorization of a positive definite matrix, and trcon
+     * directly for triangular matrices. Symmetric and Hermitian matrices
+     * go through the LU factorization. With assume_a::detect, a matrix that
+     * looked positive definite but is not falls back to it too.
+     *
+     * @param A square matrix
+     * @param norm '1' for the 1-norm, 'I' for the infinity-norm
+     * @param structure structure of \em A, or assume_a::detect
+     * @return estimate of 1 / (norm(A) norm(inv(A))), 0 for singular A
+     */
+    template <class E>
+    auto rcond(const xexpression<E>& A, char norm = '1', assume_a structure = assume_a::general)
+    {
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        assert_nd_square(A);
+
+        bool detected = structure == assume_a::detect;
+        if (detected)
+        {
+            structure = detail::probe_structure(A.derived_cast());
+        }
+
+        real_type result(0);
+        if (structure == assume_a::lower_triangular || structure == assume_a::upper_triangular)
+        {
+            matrix_type a = A.derived_cast();
+            lapack::trcon(a, norm, structure == assume_a::lower_triangular ? 'L' : 'U', 'N', result);
+            return result;
+        }
+        if (structure == assume_a::positive_definite)
+        {
+            // the norms of a symmetric matrix agree
+            matrix_type a = A.derived_cast();
+            real_type anorm = lapack::lansy(a, '1', 'L');
+            if (lapack::potr(a, 'L') == 0)
+            {
+                lapack::pocon(a, 'L', anorm, result);
+                return result;
+            }
+            if (!detected)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is not positive definite.");
+            }
+        }
+        return lu_factor(A).rcond(norm);
+    }
+
+    /**
+     * Calculate the condition number of matrix M
+     *
+     * The 2-norm condition numbers (\em ord = 2 or -2) are ratios of the
+     * singular values, computed without the singular vectors. The
+     * 1-norm condition number is 1 / rcond(M), an estimate from the LU
+     * factorization that never exceeds the exact value and is usually
+     * equal to it. The other orders compute the inverse of \em M.
+     *
+     * @param M square matrix
+     * @param ord order of the norm
+     * @return condition number of \em M
+     */
+    template <class E>
+    auto cond(const xexpression<E>& M, int ord)
+    {
+        using real_type = xtl::complex_value_type_t<typename E::value_type>;
+        if (ord == 2 || ord == -2)
+        {
+            assert_nd_square(M);
+            auto s = detail::matrix_singular_values(M.derived_cast());
+            real_type largest = s(0), smallest = s(s.size() - 1);
+            return ord == 2 ? largest / smallest : smallest / largest;
+        }
+        if (ord == 1)
+        {
+            return real_type(1) / rcond(M, '1');
+        }
+        return static_cast<real_type>(norm(M, ord) * norm(inv(M), ord));
+    }
+
+    /**
+     * Calculate the condition number of matrix M using \ref normorder
+     *
+     * The infinity-norm condition number is 1 / rcond(M, 'I'), an estimate
+     * as for cond(M, 1). The other orders compute the inverse of \em M.
+     *
+     * @param M square matrix
+     * @param ord normorder (frob, nuc, inf, neg_inf)
+     * @return condition number of \em M
+     */
+    template <class E>
+    auto cond(const xexpression<E>& M, normorder ord)
+    {
+        using real_type = xtl::complex_value_type_t<typename E::value_type>;
+        if (ord == normorder::inf)
+        {
+            return real_type(1) / rcond(M, 'I');
+        }
+        return static_cast<real_type>(norm(M, ord) * norm(inv(M), ord));
+    }
+
+    /**
+     * Compute the QR factorization of \em A once, for repeated solves.
+     * @param A matrix with at least as many rows as columns
+     * @return qr_factorization of \em A
+     */
+    template <class E>
+    inline auto qr_factor(const xexpression<E>& A)
+    {
+        return qr_factorization<typename E::value_type>(A);
+    }
+
+    /**
+     * Multiply \em b by the Q factor of \em qr (\em trans = 'N') or by its
+     * Hermitian transpose ('T' or 'C') without forming Q, e.g. to compute
+     * Q^T b for least squares.
+     *
+     * @param qr factorization returned by qr_factor
+     * @param b matrix or vector with M rows (or N rows for \em trans = 'N')
+     * @param trans 'N', 'T' or 'C'
+     * @return product with M rows
+     */
+    template <class T, class E>
+    inline auto apply_q(const qr_factorization<T>& qr, const xexpression<E>& b, char trans = 'N')
+    {
+        return qr.apply_q(b, trans);
+    }
+
+    /**
+     * Multiply \em b by the Q factor given as the Householder reflectors and
+     * scalar factors returned by qr with qrmode::raw (or qr_pivoted), without
+     * forming Q.
+     *
+     * @param h reflectors of shape (N, M), as returned by qrmode::raw
+     * @param tau scalar factors of the reflectors
+     * @param b matrix or vector with M rows (or N rows for \em trans = 'N')
+     * @param trans 'N', 'T' or 'C'
+     * @return product with M rows
+     */
+    template <class H, class V, class E>
+    inline auto apply_q(const xexpression<H>& h, const xexpression<V>& tau, const xexpression<E>& b, char trans = 'N')
+    {
+        using value_type = typename H::value_type;
+        xtensor<value_type, 2, layout_type::column_major> reflectors = xt::transpose(h.derived_cast());
+        xtensor<value_type, 1, layout_type::column_major> t = tau.derived_cast();
+        return detail::apply_reflectors(reflectors, t, b.derived_cast(), trans);
+    }
+
+    /**
+     * Compute the Householder reflector H = I - tau v v^H, with v(0) = 1,
+     * that maps \em x to a multiple of the first unit vector:
+     * H^H x = (beta, 0, ..., 0) with beta real.
+     *
+     * @param x vector of length n >= 1
+     * @return tuple of v, tau and beta
+     */
+    template <class E>
+    inline auto householder(const xexpression<E>& x)
+    {
+        using value_type = typename E::value_type;
+        using vector_type = xtensor<value_type, 1, layout_type::column_major>;
+
+        const auto& xd = x.derived_cast();
+        if (xd.dimension() != 1 || xd.size() == 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "householder: x must be a non-empty vector.");
+        }
+
+        vector_type v = xd;
+        value_type beta = v(0);
+        auto tail = xt::view(v, range(1, v.size()));
+        value_type tau = lapack::larfg(beta, tail);
+        v(0) = value_type(1);
+        return std::make_tuple(std::move(v), tau, beta);
+    }
+
+    /**
+     * Form the upper triangular factor T of the compact WY representation
+     * H(0) H(1) ... H(k - 1) = I - V T V^H of k Householder reflectors, as
+     * applied by apply_block_reflector.
+     *
+     * @param V matrix of shape (n, k) with the reflectors in its columns
+     *          below the diagonal, as in the transpose of qrmode::raw; the
+     *          diagonal is taken as 1 and the elements above it are ignored
+     * @param tau the k scalar factors of the reflectors
+     * @return k x k upper triangular T
+     */
+    template <class E, class S>
+    inline auto block_reflector(const xexpression<E>& V, const xexpression<S>& tau)
+    {
+        using value_type = typename E::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        matrix_type v = V.derived_cast();
+        xtensor<value_type, 1, layout_type::column_major> t = tau.derived_cast();
+        if (t.size() > v.shape()[1] || t.size() > v.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "block_reflector: more scalar factors than reflectors.");
+        }
+
+        matrix_type T = zeros<value_type>({t.size(), t.size()});
+        lapack::larft(v, t, T);
+        return T;
+    }
+
+    /**
+     * Apply the block reflector H = I - V T V^H, or its Hermitian transpose,
+     * to \em c from the left (H c) or from the right (c H) with level 3
+     * BLAS, which is much faster than applying the reflectors one by one.
+     *
+     * @param V reflectors of shape (n, k), as passed to block_reflector
+     * @param T the k x k factor returned by block_reflector
+     * @param c matrix with n rows ('L') or n columns ('R')
+     * @param side 'L' or 'R'
+     * @param trans 'N' to apply H, 'T' or 'C' to apply H^H
+     * @return product of the shape of \em c
+     */
+    template <class E, class F, class G>
+    inline auto apply_block_reflector(const xexpression<E>& V, const xexpression<F>& T, const xexpression<G>& c,
+                                      char side = 'L', char trans = 'N')
+    {
+        using value_type = typename G::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        if (side != 'L' && side != 'R')
+        {
+            XTENSOR_THROW(std::runtime_error, "apply_block_reflector: side must be 'L' or 'R'.");
+        }
+        if (trans != 'N' && trans != 'T' && trans != 'C')
+        {
+            XTENSOR_THROW(std::runtime_error, "apply_block_reflector: trans must be 'N', 'T' or 'C'.");
+        }
+
+        matrix_type v = V.derived_cast();
+        matrix_type t = T.derived_cast();
+        matrix_type result = c.derived_cast();
+        std::size_t n = side == 'L' ? result.shape()[0] : result.shape()[1];
+        if (v.shape()[0] != n || t.shape()[0] != t.shape()[1] || t.shape()[0] > v.shape()[1] || t.shape()[0] > n)
+        {
+            XTENSOR_THROW(std::runtime_error, "apply_block_reflector: shape mismatch.");
+        }
+
+        lapack::larfb(v, t, result, side, trans == 'N' ? 'N' : 'T');
+        return result;
+    }
+
+    namespace detail
+    {
+        // elements of each line rotated together by apply_rotations
+        constexpr std::size_t rotation_block = 128;
+
+        template <class T, class R>
+        inline void rotate_pair(T* x, T* y, std::size_t n, std::ptrdiff_t stride, R c, R s)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                std::ptrdiff_t off = static_cast<std::ptrdiff_t>(i) * stride;
+                T xi = x[off];
+                T yi = y[off];
+                x[off] = c * xi + s * yi;
+                y[off] = c * yi - s * xi;
+            }
+        }
+
+        /*
+         * Applies the rotations in the planes of the lines (first, second)
+         * chosen by pivot, in the order given by direct, to the lines of
+         * a, a block of rotation_block elements of every line at a time:
+         * the block stays in cache through the whole sequence, and is
+         * contiguous when the elements of a line are.
+         */
+        template <class T, class R>
+        inline void rotate_lines(T* a, std::ptrdiff_t line_stride, std::ptrdiff_t elem_stride,
+                                 std::size_t lines, std::size_t len, const R* c, const R* s,
+                                 char pivot, char direct)
+        {
+            std::size_t blocks = (len + rotation_block - 1) / rotation_block;
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for
+#endif
+            for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(blocks); ++p)
+            {
+                std::size_t begin = static_cast<std::size_t>(p) * rotation_block;
+                std::size_t n = std::min(len - begin, rotation_block);
+                T* base = a + static_cast<std::ptrdiff_t>(begin) * elem_stride;
+                for (std::size_t step = 0; step + 1 < lines; ++step)
+                {
+                    std::size_t k = direct == 'F' ? step : lines - 2 - step;
+                    if (c[k] == R(1) && s[k] == R(0))
+                    {
+                        continue;
+                    }
+                    std::size_t first = pivot == 'T' ? 0 : k;
+                    std::size_t second = pivot == 'B' ? lines - 1 : k + 1;
+                    T* x = base + static_cast<std::ptrdiff_t>(first) * line_stride;
+                    T* y = base + static_cast<std::ptrdiff_t>(second) * line_stride;
+                    if (elem_stride == 1)
+                    {
+                        rotate_pair(x, y, n, 1, c[k], s[k]);
+                    }
+                    else
+                    {
+                        rotate_pair(x, y, n, elem_stride, c[k], s[k]);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Apply a sequence of z - 1 plane rotations to the rows (\em side = 'L')
+     * or the columns ('R') of \em A in place, as LAPACK lasr: rotation k,
+     * [c(k) s(k); -s(k) c(k)], acts on the lines (k, k + 1) for \em pivot
+     * 'V', (0, k + 1) for 'T' and (k, z - 1) for 'B', and the rotations
+     * are applied from the first (\em direct = 'F') or from the last ('B').
+     *
+     * The rotations are applied to a block of the lines at a time, which
+     * keeps it in cache for the whole sequence, instead of one rotation to
+     * the full lines at a time; the blocks are parallel with OpenMP.
+     *
+     * @param A matrix with a data interface, of any strides, e.g. a view
+     * @param c cosines of the rotations, z - 1 values for z lines
+     * @param s sines of the rotations, real
+     * @param side 'L' to rotate the rows, 'R' to rotate the columns
+     * @param pivot 'V', 'T' or 'B'
+     * @param direct 'F' or 'B'
+     * @return reference to \em A
+     */
+    template <class E, class C, class S>
+    inline E& apply_rotations(E& A, const xexpression<C>& c, const xexpression<S>& s,
+                              char side = 'L', char pivot = 'V', char direct = 'F')
+    {
+        static_assert(has_data_interface<E>::value, "apply_rotations: A must have a data interface.");
+        using real_type = xtl::complex_value_type_t<typename E::value_type>;
+
+        if (A.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "apply_rotations: A must be a matrix.");
+        }
+        if ((side != 'L' && side != 'R') || (pivot != 'V' && pivot != 'T' && pivot != 'B') ||
+            (direct != 'F' && direct != 'B'))
+        {
+            XTENSOR_THROW(std::runtime_error, "apply_rotations: invalid side, pivot or direct.");
+        }
+
+        std::size_t axis = side == 'L' ? 0 : 1;
+        std::size_t lines = A.shape()[axis];
+        std::size_t len = A.shape()[1 - axis];
+        xtensor<real_type, 1> cv = c.derived_cast();
+        xtensor<real_type, 1> sv = s.derived_cast();
+        if (cv.size() != sv.size() || cv.size() + 1 != std::max(lines, std::size_t(1)))
+        {
+            XTENSOR_THROW(std::runtime_error, "apply_rotations: c and s must have one value less than the lines of A.");
+        }
+        if (lines < 2 || len == 0)
+        {
+            return A;
+        }
+
+        detail::rotate_lines(A.data() + A.data_offset(),
+                             static_cast<std::ptrdiff_t>(A.strides()[axis]),
+                             static_cast<std::ptrdiff_t>(A.strides()[1 - axis]),
+                             lines, len, cv.data(), sv.data(), pivot, direct);
+        return A;
+    }
+
+    /*****************************
+     * warm-started eigensolvers *
+     *****************************/
+
+    namespace detail
+    {
+        /**
+         * Indices into \em mu of the Ritz values nearest to \em theta, one
+         * per element of \em theta and each used once, sorted by value.
+         */
+        template <class W>
+        inline std::vector<std::size_t> nearest_ritz_values(const W& mu, const W& theta)
+        {
+            std::vector<bool> used(mu.size(), false);
+            std::vector<std::size_t> result;
+            result.reserve(theta.size());
+            for (std::size_t j = 0; j < theta.size(); ++j)
+            {
+                std::size_t best = mu.size();
+                for (std::size_t i = 0; i < mu.size(); ++i)
+                {
+                    if (!used[i] && (best == mu.size() || std::abs(mu(i) - theta(j)) < std::abs(mu(best) - theta(j))))
+                    {
+                        best = i;
+                    }
+                }
+                used[best] = true;
+                result.push_back(best);
+            }
+            std::sort(result.begin(), result.end(), [&mu](std::size_t a, std::size_t b) { return mu(a) < mu(b); });
+            return result;
+        }
+
+        /// The columns \em idx of \em M
+        template <class M>
+        inline M select_columns(const M& m, const std::vector<std::size_t>& idx)
+        {
+            std::size_t rows = m.shape()[0];
+            M result = M::from_shape({rows, idx.size()});
+            for (std::size_t j = 0; j < idx.size(); ++j)
+            {
+                std::copy(m.data() + idx[j] * rows, m.data() + (idx[j] + 1) * rows, result.data() + j * rows);
+            }
+            return result;
+        }
+
+        template <class W>
+        inline W select_values(const W& w, const std::vector<std::size_t>& idx)
+        {
+            W result = W::from_shape({idx.size()});
+            for (std::size_t j = 0; j < idx.size(); ++j)
+            {
+                result(j) = w(idx[j]);
+            }
+            return result;
+        }
+
+        /// Eigenpairs of the Hermitian part of the projection S^H (A S), in ascending order
+        template <class M>
+        inline auto rayleigh_ritz(const M& S, const M& AS)
+        {
+            using value_type = typename M::value_type;
+            M H = dot(conj(transpose(S)), AS);
+            M Hs = value_type(0.5) * (H + conj(transpose(H)));
+            return eigh(Hs);
+        }
+
+        /**
+         * Eigenpairs of the full eigh of \em a whose eigenvectors overlap the
+         * most with the columns of \em X, one per column, in ascending order.
+         */
+        template <class M>
+        inline auto eigh_warm_fallback(const M& a, const M& X)
+        {
+            auto full = eigh(a);
+            M U = std::get<1>(full);
+            auto w = std::get<0>(full);
+            M overlap = dot(conj(transpose(U)), X);
+            std::vector<bool> used(U.shape()[1], false);
+            std::vector<std::size_t> idx;
+            for (std::size_t j = 0; j < X.shape()[1]; ++j)
+            {
+                std::size_t best = 0;
+                double best_overlap = -1.;
+                for (std::size_t i = 0; i < U.shape()[1]; ++i)
+                {
+                    double o = static_cast<double>(std::abs(overlap(i, j)));
+                    if (!used[i] && o > best_overlap)
+                    {
+                        best = i;
+                        best_overlap = o;
+                    }
+                }
+                used[best] = true;
+                idx.push_back(best);
+            }
+            std::sort(idx.begin(), idx.end());
+            return std::make_tuple(select_values(w, idx), select_columns(U, idx));
+        }
+    }
+
+    /**
+     * Compute k eigenpairs of the Hermitian or real symmetric matrix \em A
+     * starting from the eigenvectors \em V of a nearby matrix, for instance
+     * the previous step of a slowly varying problem.
+     *
+     * Each iteration applies \em A to the current Ritz vectors and their
+     * residuals with one GEMM, then solves the Rayleigh–Ritz problem of
+     * order 2k with syevd (heevd) and keeps the k Ritz pairs nearest to the
+     * current ones: O(n^2 k) per iteration instead of the O(n^3) of eigh.
+     * When the residuals stop decreasing or \em max_iter is reached, the
+     * full eigh is computed and the eigenpairs whose eigenvectors overlap
+     * the most with \em V are returned, so the result always has the
+     * requested accuracy.
+     *
+     * @param A square Hermitian or real symmetric matrix of order n
+     * @param V n x m matrix whose first k columns approximate eigenvectors of A
+     * @param k number of eigenpairs to compute, 1 <= k <= m
+     * @param tol largest residual ||A x - w x|| relative to the Frobenius norm of A;
+     *        a negative value selects 1000 times the machine epsilon of the value type
+     * @param max_iter maximum number of iterations before falling back to eigh
+     * @return tuple (w, X) with the k eigenvalues in ascending order and the
+     *         corresponding eigenvectors as columns of X
+     */
+    template <class E, class F>
+    auto eigh_warm(const xexpression<E>& A, const xexpression<F>& V, std::size_t k,
+                   double tol = -1., std::size_t max_iter = 20)
+    {
+        using value_type = std::common_type_t<typename E::value_type, typename F::value_type>;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        assert_nd_square(A);
+        const auto& dV = V.derived_cast();
+        matrix_type a = A.derived_cast();
+        std::size_t n = a.shape()[0];
+        if (dV.dimension() != 2 || dV.shape()[0] != n || k == 0 || k > dV.shape()[1] || k > n)
+        {
+            XTENSOR_THROW(std::runtime_error, "eigh_warm: V must be an n x m matrix with 1 <= k <= m.");
+        }
+        if (tol < 0)
+        {
+            tol = 1e3 * static_cast<double>(std::numeric_limits<real_type>::epsilon());
+        }
+
+        matrix_type X0 = view(dV, all(), range(std::size_t(0), k));
+        matrix_type X = std::get<0>(qr(X0));
+        matrix_type AX = dot(a, X);
+        auto rr = detail::rayleigh_ritz(X, AX);
+        auto theta = std::get<0>(rr);
+        X = dot(X, std::get<1>(rr));
+        AX = dot(AX, std::get<1>(rr));
+
+        real_type a_norm = std::sqrt(sum(xt::norm(a))());
+        real_type limit = static_cast<real_type>(tol) * std::max(a_norm, std::numeric_limits<real_type>::min());
+        real_type previous = std::numeric_limits<real_type>::infinity();
+        for (std::size_t it = 0; it <= max_iter; ++it)
+        {
+            matrix_type R = AX - X * view(theta, newaxis(), all());
+            real_type residual = 0;
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                residual = std::max(residual, static_cast<real_type>(std::sqrt(sum(xt::norm(view(R, all(), j)))())));
+            }
+            if (residual <= limit)
+            {
+                return std::make_tuple(std::move(theta), std::move(X));
+            }
+            if (it == max_iter || !(residual < previous))
+            {
+                break;
+            }
+            previous = residual;
+
+            // orthonormal basis of the Ritz vectors and their residuals
+            matrix_type XR = matrix_type::from_shape({n, 2 * k});
+            std::copy(X.data(), X.data() + n * k, XR.data());
+            std::copy(R.data(), R.data() + n * k, XR.data() + n * k);
+            matrix_type S = std::get<0>(qr(XR));
+            matrix_type AS = dot(a, S);
+            auto ritz = detail::rayleigh_ritz(S, AS);
+            auto idx = detail::nearest_ritz_values(std::get<0>(ritz), theta);
+            matrix_type Z = detail::select_columns(matrix_type(std::get<1>(ritz)), idx);
+            theta = detail::select_values(std::get<0>(ritz), idx);
+            X = dot(S, Z);
+            AX = dot(AS, Z);
+        }
+        return detail::eigh_warm_fallback(a, X0);
+    }
+
+    /********************
+     * low rank updates *
+     ********************/
+
+    namespace detail
+    {
+        // C = alpha op(A) B + beta C on column-major storage, with op(A) of
+        // shape (m, k), B of shape (k, n) and C of shape (m, n)
+        template <class T>
+        inline void woodbury_gemm(bool trans_a, std::size_t m, std::size_t n, std::size_t k, T alpha,
+                                  const T* A, const T* B, T beta, T* C)
+        {
+            if (m == 0 || n == 0)
+            {
+                return;
+            }
+            std::size_t lda = trans_a ? k : m;
+            cxxblas::gemm<blas_index_t>(
+                cxxblas::StorageOrder::ColMajor,
+                trans_a ? cxxblas::Transpose::Trans : cxxblas::Transpose::NoTrans,
+                cxxblas::Transpose::NoTrans,
+                to_blas_index(m), to_blas_index(n), to_blas_index(k),
+                alpha,
+                A, to_blas_index(std::max(lda, std::size_t(1))),
+                B, to_blas_index(std::max(k, std::size_t(1))),
+                beta,
+                C, to_blas_index(std::max(m, std::size_t(1)))
+            );
+        }
+
+        template <class U, class C, class V>
+        inline const U& check_woodbury_operands(std::size_t n, const U& u, const C& c, const V& v)
+        {
+            if (u.dimension() != 2 || c.dimension() != 2 || v.dimension() != 2)
+            {
+                XTENSOR_THROW(std::runtime_error, "Woodbury update: U, C and V must be matrices.");
+            }
+            std::size_t k = u.shape()[1];
+            if (u.shape()[0] != n || v.shape()[0] != n || v.shape()[1] != k
+                || c.shape()[0] != k || c.shape()[1] != k)
+            {
+                XTENSOR_THROW(std::runtime_error, "Woodbury update: expected U and V of shape (N, K) and C of shape (K, K).");
+            }
+            return u;
+        }
+
+        // W = C V^T, of shape (k, n)
+        template <class T, class EC, class EV>
+        inline xtensor<T, 2, layout_type::column_major> woodbury_right(const EC& C, const EV& V)
+        {
+            using matrix_type = xtensor<T, 2, layout_type::column_major>;
+            matrix_type c = C;
+            matrix_type vt = xt::transpose(V);
+            std::size_t k = c.shape()[0];
+            std::size_t n = vt.shape()[1];
+            matrix_type w = matrix_type::from_shape({k, n});
+            woodbury_gemm(false, k, n, k, T(1), c.data(), vt.data(), T(0), w.data());
+            return w;
+        }
+
+        // I + W Z, of shape (k, k)
+        template <class M>
+        inline M woodbury_capacitance(const M& w, const M& z)
+        {
+            using value_type = typename M::value_type;
+            std::size_t k = w.shape()[0];
+            M result = M::from_shape({k, k});
+            std::fill(result.begin(), result.end(), value_type(0));
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                result(i, i) = value_type(1);
+            }
+            woodbury_gemm(false, k, k, w.shape()[1], value_type(1), w.data(), z.data(), value_type(1), result.data());
+            return result;
+        }
+
+        /**
+         * Solves with a diagonal matrix, so that it can be the base of a
+         * woodbury_factorization.
+         */
+        template <class T>
+        class diagonal_solver
+        {
+        public:
+
+            using value_type = T;
+
+            explicit diagonal_solver(xtensor<T, 1> d)
+                : m_d(std::move(d))
+            {
+                if (std::find(m_d.begin(), m_d.end(), T(0)) != m_d.end())
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+                }
+            }
+
+            template <class E>
+            auto solve(const xexpression<E>& b) const
+            {
+                auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+                std::size_t n = m_d.size();
+                if (x.shape()[0] != n)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+                }
+                auto* data = x.data();
+                for (std::size_t j = 0; j < x.size(); ++j)
+                {
+                    data[j] /= m_d(j % n);
+                }
+                return x;
+            }
+
+        private:
+
+            xtensor<T, 1> m_d;
+        };
+    }
+
+    /**
+     * Solver for the low rank update A + U C V^T of a matrix A given by its
+     * factorization, as returned by woodbury_update. The Woodbury identity
+     *
+     *     (A + U C V^T)^-1 = A^-1 - Z (I + C V^T Z)^-1 C V^T A^-1,  Z = A^-1 U
+     *
+     * reduces the update of rank K to a K x K system: the construction
+     * costs K solves with A, each solve then one solve with A and O(N K).
+     * C need not be invertible. V is transposed, not conjugated: pass
+     * conj(V) for A + U C V^H.
+     *
+     * \em F is any type with a solve member returning a column-major
+     * result, e.g. lu_factorization, cholesky_factorization or
+     * woodbury_factorization itself, for successive updates. The size of A
+     * is the number of rows of U, which A^-1 U checks.
+     */
+    template <class F, class T = typename F::value_type>
+    class woodbury_factorization
+    {
+    public:
+
+        using value_type = T;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using base_type = F;
+
+        template <class EU, class EC, class EV>
+        woodbury_factorization(F a, const xexpression<EU>& U, const xexpression<EC>& C, const xexpression<EV>& V);
+
+        template <class E>
+        auto solve(const xexpression<E>& b) const;
+
+        const base_type& base() const noexcept;
+        std::size_t rank() const noexcept;
+
+    private:
+
+        base_type m_a;
+        matrix_type m_z;
+        matrix_type m_w;
+        lu_factorization<value_type> m_k;
+    };
+
+    template <class F, class T>
+    template <class EU, class EC, class EV>
+    inline woodbury_factorization<F, T>::woodbury_factorization(F a, const xexpression<EU>& U,
+                                                                const xexpression<EC>& C,
+                                                                const xexpression<EV>& V)
+        : m_a(std::move(a)),
+          m_z(m_a.solve(detail::check_woodbury_operands(U.derived_cast().shape()[0], U.derived_cast(),
+                                                        C.derived_cast(), V.derived_cast()))),
+          m_w(detail::woodbury_right<value_type>(C.derived_cast(), V.derived_cast())),
+          m_k(detail::woodbury_capacitance(m_w, m_z))
+    {
+        if (m_k.singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "Woodbury update: the updated matrix is singular.");
+        }
+    }
+
+    /**
+     * Solve (A + U C V^T) x = b.
+     * @param b vector of size N or matrix of shape (N, M)
+     * @return solution with the shape of \em b
+     */
+    template <class F, class T>
+    template <class E>
+    inline auto woodbury_factorization<F, T>::solve(const xexpression<E>& b) const
+    {
+        auto x = m_a.solve(b);
+        std::size_t n = m_z.shape()[0];
+        std::size_t k = m_z.shape()[1];
+        if (x.shape()[0] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+        }
+        std::size_t nrhs = x.dimension() > 1 ? x.shape()[1] : 1;
+        if (k == 0 || nrhs == 0)
+        {
+            return x;
+        }
+        matrix_type t = matrix_type::from_shape({k, nrhs});
+        detail::woodbury_gemm(false, k, nrhs, n, value_type(1), m_w.data(), x.data(), value_type(0), t.data());
+        matrix_type s = m_k.solve(t);
+        detail::woodbury_gemm(false, n, nrhs, k, value_type(-1), m_z.data(), s.data(), value_type(1), x.data());
+        return x;
+    }
+
+    /**
+     * @return the factorization of A
+     */
+    template <class F, class T>
+    inline auto woodbury_factorization<F, T>::base() const noexcept -> const base_type&
+    {
+        return m_a;
+    }
+
+    /**
+     * @return the rank K of the update
+     */
+    template <class F, class T>
+    inline std::size_t woodbury_factorization<F, T>::rank() const noexcept
+    {
+        return m_z.shape()[1];
+    }
+
+    /**
+     * Factor the low rank update A + U C V^T of a factored matrix A in
+     * O(N^2 K), for repeated solves; see woodbury_factorization.
+     *
+     * @param a factorization of A, e.g. returned by lu_factor
+     * @param U matrix of shape (N, K)
+     * @param C matrix of shape (K, K)
+     * @param V matrix of shape (N, K)
+     * @return woodbury_factorization of A + U C V^T
+     */
+    template <class F, class EU, class EC, class EV, std::enable_if_t<!is_xexpression<F>::value, int> = 0>
+    inline auto woodbury_update(F a, const xexpression<EU>& U, const xexpression<EC>& C, const xexpression<EV>& V)
+    {
+        return woodbury_factorization<F>(std::move(a), U, C, V);
+    }
+
+    /**
+     * Factor the low rank update diag(d) + U C V^T of a diagonal matrix in
+     * O(N K^2).
+     *
+     * @param d diagonal of A, without zeros
+     * @param U matrix of shape (N, K)
+     * @param C matrix of shape (K, K)
+     * @param V matrix of shape (N, K)
+     * @return woodbury_factorization of diag(d) + U C V^T
+     */
+    template <class E, class EU, class EC, class EV>
+    inline auto woodbury_update(const xexpression<E>& d, const xexpression<EU>& U,
+                                const xexpression<EC>& C, const xexpression<EV>& V)
+    {
+        using value_type = typename E::value_type;
+        if (d.derived_cast().dimension() != 1)
+        {
+            XTENSOR_THROW(std::runtime_error, "Woodbury update: a diagonal matrix is given as a vector.");
+        }
+        return woodbury_factorization<detail::diagonal_solver<value_type>>(
+            detail::diagonal_solver<value_type>(d.derived_cast()), U, C, V);
+    }
+
+    /**
+     * Solve (A + U C V^T) x = b for a factored or diagonal A with the
+     * Woodbury identity, in O(N^2 K) instead of the O(N^3) of forming and
+     * solving the updated matrix; see woodbury_factorization. Use
+     * woodbury_update to solve repeatedly with the same update.
+     *
+     * @param a factorization of A, e.g. returned by lu_factor, or the
+     *        diagonal of A as a vector
+     * @param U matrix of shape (N, K)
+     * @param C matrix of shape (K, K)
+     * @param V matrix of shape (N, K)
+     * @param b vector of size N or matrix of shape (N, M)
+     * @return solution with the shape of \em b
+     */
+    template <class F, class EU, class EC, class EV, class E>
+    inline auto solve_woodbury(const F& a, const xexpression<EU>& U, const xexpression<EC>& C,
+                               const xexpression<EV>& V, const xexpression<E>& b)
+    {
+        return woodbury_update(a, U, C, V).solve(b);
+    }
+
+    /**
+     * Sherman-Morrison-Woodbury update of an explicit inverse: from A^-1,
+     * compute (A + U C V^T)^-1 = B - B U (I + C V^T B U)^-1 C V^T B with
+     * B = A^-1, in O(N^2 K).
+     *
+     * @param Ainv inverse of A, of shape (N, N)
+     * @param U matrix of shape (N, K)
+     * @param C matrix of shape (K, K)
+     * @param V matrix of shape (N, K)
+     * @return the inverse of A + U C V^T
+     */
+    template <class E, class EU, class EC, class EV>
+    inline auto inv_update(const xexpression<E>& Ainv, const xexpression<EU>& U,
+                           const xexpression<EC>& C, const xexpression<EV>& V)
+    {
+        using value_type = typename E::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        assert_nd_square(Ainv);
+        matrix_type b = Ainv.derived_cast();
+        std::size_t n = b.shape()[0];
+        detail::check_woodbury_operands(n, U.derived_cast(), C.derived_cast(), V.derived_cast());
+        matrix_type u = U.derived_cast();
+        matrix_type v = V.derived_cast();
+        std::size_t k = u.shape()[1];
+        if (k == 0 || n == 0)
+        {
+            return b;
+        }
+
+        matrix_type z = matrix_type::from_shape({n, k});
+        detail::woodbury_gemm(false, n, k, n, value_type(1), b.data(), u.data(), value_type(0), z.data());
+        matrix_type vtb = matrix_type::from_shape({k, n});
+        detail::woodbury_gemm(true, k, n, n, value_type(1), v.data(), b.data(), value_type(0), vtb.data());
+        matrix_type c = C.derived_cast();
+        matrix_type w = matrix_type::from_shape({k, n});
+        detail::woodbury_gemm(false, k, n, k, value_type(1), c.data(), vtb.data(), value_type(0), w.data());
+
+        auto capacitance = lu_factor(detail::woodbury_capacitance(w, u));
+        if (capacitance.singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "Woodbury update: the updated matrix is singular.");
+        }
+        matrix_type s = capacitance.solve(w);
+        detail::woodbury_gemm(false, n, n, k, value_type(-1), z.data(), s.data(), value_type(1), b.data());
+        return b;
+    }
+
+    namespace detail
+    {
+        /**
+         * Eigendecomposition of diag(d) + rho z z^T, with the eigenvalues in
+         * ascending order and the eigenvectors as columns of the k x k
+         * result: the components of z that are negligible and the pairs of
+         * nearly equal d are deflated with Givens rotations, as in laed2,
+         * and the remaining roots of the secular equation are found with
+         * laed4. The vectors are computed from the Gu–Eisenstat
+         * reconstruction of z so that they are orthogonal to working
+         * precision even when the roots are clustered.
+         */
+        template <class T>
+        inline auto rank_one_eigen(std::vector<T> d, std::vector<T> z, T rho)
+        {
+            using matrix_type = xtensor<T, 2, layout_type::column_major>;
+            std::size_t k = d.size();
+            bool negative = rho < 0;
+            if (negative)
+            {
+                rho = -rho;
+                std::transform(d.begin(), d.end(), d.begin(), std::negate<T>());
+            }
+
+            std::vector<std::size_t> perm(k);
+            std::iota(perm.begin(), perm.end(), std::size_t(0));
+            std::stable_sort(perm.begin(), perm.end(), [&d](std::size_t i, std::size_t j) { return d[i] < d[j]; });
+            std::vector<T> ds(k), zs(k);
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                ds[i] = d[perm[i]];
+                zs[i] = z[perm[i]];
+            }
+
+            T z_norm = std::sqrt(std::inner_product(zs.begin(), zs.end(), zs.begin(), T(0)));
+            matrix_type G = matrix_type::from_shape({k, k});
+            std::fill(G.begin(), G.end(), T(0));
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                G(i, i) = T(1);
+            }
+
+            std::vector<bool> deflated(k, true);
+            if (z_norm > 0 && rho > 0)
+            {
+                for (auto& zi : zs)
+                {
+                    zi /= z_norm;
+                }
+                rho *= z_norm * z_norm;
+                T d_max = 0;
+                for (auto di : ds)
+                {
+                    d_max = std::max(d_max, std::abs(di));
+                }
+                T tol = 8 * std::numeric_limits<T>::epsilon() * std::max(d_max, rho);
+
+                std::size_t prev = k;
+                for (std::size_t j = 0; j < k; ++j)
+                {
+                    if (rho * std::abs(zs[j]) <= tol)
+                    {
+                        continue;
+                    }
+                    deflated[j] = false;
+                    if (prev != k)
+                    {
+                        // rotate z(prev) into z(j) when the resulting off-diagonal is negligible
+                        T t = std::hypot(zs[prev], zs[j]);
+                        T c = zs[j] / t;
+                        T s = zs[prev] / t;
+                        if (std::abs((ds[j] - ds[prev]) * c * s) <= tol)
+                        {
+                            for (std::size_t r = 0; r < k; ++r)
+                            {
+                                T gp = G(r, prev);
+                                T gj = G(r, j);
+                                G(r, prev) = c * gp - s * gj;
+                                G(r, j) = s * gp + c * gj;
+                            }
+                            T dp = ds[prev];
+                            ds[prev] = c * c * dp + s * s * ds[j];
+                            ds[j] = s * s * dp + c * c * ds[j];
+                            zs[prev] = T(0);
+                            zs[j] = t;
+                            deflated[prev] = true;
+                        }
+                    }
+                    prev = j;
+                }
+            }
+
+            std::vector<std::size_t> active;
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                if (!deflated[i])
+                {
+                    active.push_back(i);
+                }
+            }
+
+            std::vector<T> lambda(ds);
+            matrix_type Q = G;
+            std::size_t na = active.size();
+            if (na != 0)
+            {
+                xtensor<T, 1> da = xtensor<T, 1>::from_shape({na});
+                xtensor<T, 1> za = xtensor<T, 1>::from_shape({na});
+                for (std::size_t i = 0; i < na; ++i)
+                {
+                    da(i) = ds[active[i]];
+                    za(i) = zs[active[i]];
+                }
+                T za_norm = std::sqrt(sum(za * za)());
+                za /= za_norm;
+                T rho_a = rho * za_norm * za_norm;
+
+                // delta(j, i) = da(j) - lambda(i) for n > 2
+                matrix_type delta = matrix_type::from_shape({na, na});
+                std::vector<T> roots(na);
+                for (std::size_t i = 0; i < na; ++i)
+                {
+                    auto col = xtensor<T, 1>::from_shape({na});
+                    if (lapack::laed4(i, da, za, col, rho_a, roots[i]) != 0)
+                    {
+                        XTENSOR_THROW(std::runtime_error, "Rank-one eigenupdate: secular equation did not converge.");
+                    }
+                    std::copy(col.begin(), col.end(), &delta(0, i));
+                }
+
+                // for n <= 2, laed4 returns the eigenvectors themselves in delta
+                matrix_type Y = delta;
+                std::vector<T> zhat(na > 2 ? na : 0);
+                for (std::size_t j = 0; j < zhat.size(); ++j)
+                {
+                    T v = -delta(j, j) / rho_a;
+                    for (std::size_t i = 0; i < na; ++i)
+                    {
+                        if (i != j)
+                        {
+                            v *= -delta(j, i) / (da(i) - da(j));
+                        }
+                    }
+                    zhat[j] = std::copysign(std::sqrt(std::abs(v)), za(j));
+                }
+
+                for (std::size_t i = 0; i < zhat.size(); ++i)
+                {
+                    T norm2 = 0;
+                    for (std::size_t j = 0; j < na; ++j)
+                    {
+                        Y(j, i) = zhat[j] / delta(j, i);
+                        norm2 += Y(j, i) * Y(j, i);
+                    }
+                    T inv = T(1) / std::sqrt(norm2);
+                    for (std::size_t j = 0; j < na; ++j)
+                    {
+                        Y(j, i) *= inv;
+                    }
+                }
+
+                for (std::size_t i = 0; i < na; ++i)
+                {
+                    lambda[active[i]] = roots[i];
+                    for (std::size_t r = 0; r < k; ++r)
+                    {
+                        T acc = 0;
+                        for (std::size_t j = 0; j < na; ++j)
+                        {
+                            acc += G(r, active[j]) * Y(j, i);
+                        }
+                        Q(r, active[i]) = acc;
+                    }
+                }
+            }
+
+            if (negative)
+            {
+                std::transform(lambda.begin(), lambda.end(), lambda.begin(), std::negate<T>());
+            }
+            std::vector<std::size_t> order(k);
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::stable_sort(order.begin(), order.end(), [&lambda](std::size_t i, std::size_t j) { return lambda[i] < lambda[j]; });
+
+            xtensor<T, 1> w = xtensor<T, 1>::from_shape({k});
+            matrix_type V = matrix_type::from_shape({k, k});
+            for (std::size_t c = 0; c < k; ++c)
+            {
+                w(c) = lambda[order[c]];
+                for (std::size_t r = 0; r < k; ++r)
+                {
+                    V(perm[r], c) = Q(r, order[c]);
+                }
+            }
+            return std::make_tuple(std::move(w), std::move(V));
+        }
+
+        template <class T>
+        inline T unit_phase(const T& x, std::false_type)
+        {
+            return x < 0 ? T(-1) : T(1);
+        }
+
+        template <class T>
+        inline T unit_phase(const T& x, std::true_type)
+        {
+            auto a = std::abs(x);
+            return a == 0 ? T(1) : x / a;
+        }
+
+        /// Orthogonalizes \em C against the orthonormal columns of \em U, twice: returns (U^H C, C - U U^H C)
+        template <class M>
+        inline auto project_out(const M& U, M C)
+        {
+            M L = dot(conj(transpose(U)), C);
+            C -= dot(U, L);
+            M L2 = dot(conj(transpose(U)), C);
+            C -= dot(U, L2);
+            L += L2;
+            return std::make_tuple(std::move(L), std::move(C));
+        }
+
+        /// Number of singular values kept by an SVD update
+        inline std::size_t svd_update_rank(std::size_t available, std::size_t limit, std::size_t rank)
+        {
+            std::size_t r = std::min(available, limit);
+            return rank == 0 ? r : std::min(r, rank);
+        }
+    }
+
+    /**
+     * Update the eigendecomposition of a Hermitian or real symmetric matrix
+     * A = V diag(w) V^H by the rank-one term rho x x^H.
+     *
+     * The component of \em x outside of the columns of \em V, if any, adds
+     * one column, and the k x k (or k + 1) problem diag(w) + rho z z^H is
+     * solved through its secular equation with laed4, so the update costs
+     * O(n k^2) instead of the O(n^3) of eigh. \em V may hold only the k
+     * eigenvectors of the dominant eigenvalues, the rest of A being taken
+     * as zero.
+     *
+     * @param w the k eigenvalues of A, as returned by eigh
+     * @param V n x k matrix with orthonormal eigenvectors as columns
+     * @param x vector of size n
+     * @param rho real weight of the update
+     * @param rank if non-zero, only the \em rank eigenpairs of largest
+     *        magnitude are kept
+     * @return tuple (w, V) of the updated matrix, the eigenvalues in ascending order
+     */
+    template <class EW, class EV, class EX>
+    auto eigh_update(const xexpression<EW>& w, const xexpression<EV>& V, const xexpression<EX>& x,
+                     double rho = 1., std::size_t rank = 0)
+    {
+        using value_type = std::common_type_t<typename EV::value_type, typename EX::value_type>;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& dw = w.derived_cast();
+        const auto& dV = V.derived_cast();
+        const auto& dx = x.derived_cast();
+        if (dV.dimension() != 2 || dw.dimension() != 1 || dx.dimension() != 1
+            || dV.shape()[1] != dw.size() || dV.shape()[0] != dx.size() || dw.size() > dx.size())
+        {
+            XTENSOR_THROW(std::runtime_error, "eigh_update: expected w of size k, V of shape (n, k) and x of size n.");
+        }
+        std::size_t n = dx.size();
+        std::size_t k = dw.size();
+
+        matrix_type Vm = dV;
+        matrix_type X = matrix_type::from_shape({n, 1});
+        std::copy(dx.begin(), dx.end(), X.begin());
+        auto projected = detail::project_out(Vm, X);
+        const matrix_type& Z = std::get<0>(projected);
+        const matrix_type& R = std::get<1>(projected);
+
+        real_type x_norm = std::sqrt(sum(xt::norm(X))());
+        real_type beta = std::sqrt(sum(xt::norm(R))());
+        bool augment = k < n && beta > 16 * std::numeric_limits<real_type>::epsilon() * x_norm;
+        std::size_t m = augment ? k + 1 : k;
+
+        matrix_type Vaug = matrix_type::from_shape({n, m});
+        std::copy(Vm.data(), Vm.data() + n * k, Vaug.data());
+        std::vector<real_type> d(m, real_type(0));
+        std::vector<value_type> zc(m, value_type(0));
+        std::copy(dw.begin(), dw.end(), d.begin());
+        std::copy(Z.data(), Z.data() + k, zc.begin());
+        if (augment)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                Vaug(i, k) = R(i, 0) / beta;
+            }
+            zc[k] = value_type(beta);
+        }
+
+        // diag(d) + rho z z^H = P (diag(d) + rho |z| |z|^T) P^H with P the diagonal of the phases of z
+        std::vector<real_type> za(m);
+        std::vector<value_type> phase(m);
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            za[i] = std::abs(zc[i]);
+            phase[i] = detail::unit_phase(zc[i], xtl::is_complex<value_type>());
+        }
+        auto secular = detail::rank_one_eigen(std::move(d), std::move(za), static_cast<real_type>(rho));
+        const auto& lambda = std::get<0>(secular);
+        const auto& Q = std::get<1>(secular);
+
+        std::vector<std::size_t> keep(m);
+        std::iota(keep.begin(), keep.end(), std::size_t(0));
+        if (rank != 0 && rank < m)
+        {
+            std::vector<std::size_t> by_magnitude(keep);
+            std::stable_sort(by_magnitude.begin(), by_magnitude.end(), [&lambda](std::size_t i, std::size_t j) {
+                return std::abs(lambda(i)) > std::abs(lambda(j));
+            });
+            keep.assign(by_magnitude.begin(), by_magnitude.begin() + static_cast<std::ptrdiff_t>(rank));
+            std::sort(keep.begin(), keep.end());
+        }
+
+        std::size_t r = keep.size();
+        matrix_type PQ = matrix_type::from_shape({m, r});
+        xtensor<real_type, 1> w_new = xtensor<real_type, 1>::from_shape({r});
+        for (std::size_t c = 0; c < r; ++c)
+        {
+            w_new(c) = lambda(keep[c]);
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                PQ(i, c) = phase[i] * Q(i, keep[c]);
+            }
+        }
+        matrix_type V_new = dot(Vaug, PQ);
+        return std::make_tuple(std::move(w_new), std::move(V_new));
+    }
+
+    /**
+     * Update the thin SVD A = U diag(s) Vt with the columns \em C appended
+     * to A, by Brand's method: the part of \em C outside of the span of U is
+     * orthogonalized with a QR decomposition and the (k + c) x (k + c) core
+     * matrix is decomposed with gesdd, so an update costs O((m + n) k^2)
+     * for a few columns instead of the O(m n^2) of svd.
+     *
+     * @param U m x k matrix with orthonormal columns, as returned by svd(A, false)
+     * @param s the k singular values, in descending order
+     * @param Vt k x n matrix with orthonormal rows
+     * @param C m x c matrix of the appended columns
+     * @param rank if non-zero, only the \em rank largest singular values are kept
+     * @return tuple (U, s, Vt) of [A, C]
+     */
+    template <class EU, class ES, class EV, class EC>
+    auto svd_append(const xexpression<EU>& U, const xexpression<ES>& s, const xexpression<EV>& Vt,
+                    const xexpression<EC>& C, std::size_t rank = 0)
+    {
+        using value_type = std::common_type_t<typename EU::value_type, typename EV::value_type, typename EC::value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        matrix_type Um = U.derived_cast();
+        matrix_type Vm = Vt.derived_cast();
+        matrix_type Cm = C.derived_cast();
+        const auto& ds = s.derived_cast();
+        if (Um.shape()[1] != ds.size() || Vm.shape()[0] != ds.size() || Cm.shape()[0] != Um.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "svd_append: expected U of shape (m, k), s of size k, Vt of shape (k, n) and C of shape (m, c).");
+        }
+        std::size_t m = Um.shape()[0];
+        std::size_t k = Um.shape()[1];
+        std::size_t n = Vm.shape()[1];
+        std::size_t c = Cm.shape()[1];
+
+        auto projected = detail::project_out(Um, std::move(Cm));
+        const matrix_type& L = std::get<0>(projected);
+        auto JK = qr(std::get<1>(projected));
+        matrix_type J = std::get<0>(JK);
+        matrix_type K = std::get<1>(JK);
+        std::size_t cj = J.shape()[1];
+
+        // core = [[diag(s), L], [0, K]]
+        matrix_type core = matrix_type::from_shape({k + cj, k + c});
+        std::fill(core.begin(), core.end(), value_type(0));
+        for (std::size_t i = 0; i < k; ++i)
+        {
+            core(i, i) = ds(i);
+        }
+        view(core, range(std::size_t(0), k), range(k, k + c)) = L;
+        view(core, range(k, k + cj), range(k, k + c)) = K;
+
+        auto res = lapack::gesdd(core, 'S');
+        if (std::get<0>(res) != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "svd_append: SVD did not converge.");
+        }
+        const auto& Uc = std::get<1>(res);
+        const auto& sc = std::get<2>(res);
+        const auto& Vct = std::get<3>(res);
+        std::size_t r = detail::svd_update_rank(std::min(k + cj, k + c), std::min(m, n + c), rank);
+
+        matrix_type UJ = matrix_type::from_shape({m, k + cj});
+        std::copy(Um.data(), Um.data() + m * k, UJ.data());
+        std::copy(J.data(), J.data() + m * cj, UJ.data() + m * k);
+        matrix_type U_new = dot(UJ, view(Uc, all(), range(std::size_t(0), r)));
+
+        // Vt_new = Vct [[Vt, 0], [0, I]]
+        matrix_type Vct_r = view(Vct, range(std::size_t(0), r), all());
+        matrix_type Vt_new = matrix_type::from_shape({r, n + c});
+        view(Vt_new, all(), range(std::size_t(0), n)) = dot(view(Vct_r, all(), range(std::size_t(0), k)), Vm);
+        view(Vt_new, all(), range(n, n + c)) = view(Vct_r, all(), range(k, k + c));
+
+        xtensor<xtl::complex_value_type_t<value_type>, 1> s_new = view(sc, range(std::size_t(0), r));
+        return std::make_tuple(std::move(U_new), std::move(s_new), std::move(Vt_new));
+    }
+
+    /**
+     * Update the thin SVD A = U diag(s) Vt with the column \em j removed
+     * from A: the remaining k x (n - 1) block of Vt is orthonormalized with
+     * a QR decomposition of its adjoint and the k x k core diag(s) R^H is
+     * decomposed with gesdd, in O(n k^2).
+     *
+     * @param U m x k matrix with orthonormal columns
+     * @param s the k singular values, in descending order
+     * @param Vt k x n matrix with orthonormal rows
+     * @param j index of the removed column
+     * @param rank if non-zero, only the \em rank largest singular values are kept
+     * @return tuple (U, s, Vt) of A without its column j
+     */
+    template <class EU, class ES, class EV>
+    auto svd_downdate(const xexpression<EU>& U, const xexpression<ES>& s, const xexpression<EV>& Vt,
+                      std::size_t j, std::size_t rank = 0)
+    {
+        using value_type = std::common_type_t<typename EU::value_type, typename EV::value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        matrix_type Um = U.derived_cast();
+        const auto& ds = s.derived_cast();
+        const auto& dVt = Vt.derived_cast();
+        if (Um.shape()[1] != ds.size() || dVt.shape()[0] != ds.size() || j >= dVt.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "svd_downdate: expected U of shape (m, k), s of size k, Vt of shape (k, n) and j < n.");
+        }
+        std::size_t m = Um.shape()[0];
+        std::size_t k = Um.shape()[1];
+        std::size_t n = dVt.shape()[1];
+
+        // W = (Vt without column j)^H, of shape (n - 1, k)
+        matrix_type W = matrix_type::from_shape({n - 1, k});
+        for (std::size_t c = 0; c < k; ++c)
+        {
+            for (std::size_t i = 0, row = 0; i < n; ++i)
+            {
+                if (i != j)
+                {
+                    W(row++, c) = detail::conj_value(value_type(dVt(c, i)));
+                }
+            }
+        }
+        auto QRv = qr(W);
+        const matrix_type& Qv = std::get<0>(QRv);
+        const matrix_type& Rv = std::get<1>(QRv);
+
+        // core = diag(s) Rv^H, of shape (k, kq)
+        matrix_type core = conj(transpose(Rv));
+        for (std::size_t i = 0; i < k; ++i)
+        {
+            view(core, i, all()) *= value_type(ds(i));
+        }
+
+        auto res = lapack::gesdd(core, 'S');
+        if (std::get<0>(res) != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "svd_downdate: SVD did not converge.");
+        }
+        const auto& Uc = std::get<1>(res);
+        const auto& sc = std::get<2>(res);
+        const auto& Vch = std::get<3>(res);
+        std::size_t r = detail::svd_update_rank(std::min(k, Qv.shape()[1]), std::min(m, n - 1), rank);
+
+        matrix_type U_new = dot(Um, view(Uc, all(), range(std::size_t(0), r)));
+        matrix_type Vt_new = dot(view(Vch, range(std::size_t(0), r), all()), conj(transpose(Qv)));
+        xtensor<xtl::complex_value_type_t<value_type>, 1> s_new = view(sc, range(std::size_t(0), r));
+        return std::make_tuple(std::move(U_new), std::move(s_new), std::move(Vt_new));
+    }
+
+    /*******************************
+     * batched small-matrix solvers *
+     *******************************/
+
+    namespace detail
+    {
+        template <class E>
+        inline void check_batch_square(const E& e, const char* name)
+        {
+            if (e.dimension() < 2 || e.shape()[e.dimension() - 1] != e.shape()[e.dimension() - 2])
+            {
+                std::stringstream msg;
+                msg << name << ": expected a stack of square matrices of shape (..., n, n).";
+                XTENSOR_THROW(std::runtime_error, msg.str());
+            }
+        }
+
+        template <class E>
+        inline dynamic_shape<std::size_t> batch_shape(const E& e, std::size_t core_dim)
+        {
+            return dynamic_shape<std::size_t>(e.shape().begin(), e.shape().end() - static_cast<std::ptrdiff_t>(core_dim));
+        }
+
+        /// Column-major copy of the transpose of the row-major n x n matrix at \em a.
+        template <class T>
+        inline xtensor<T, 2, layout_type::column_major> transposed_matrix(const T* a, std::size_t n)
+        {
+            auto result = xtensor<T, 2, layout_type::column_major>::from_shape({n, n});
+            std::copy(a, a + n * n, result.data());
+            return result;
+        }
+
+        template <class M, class W>
+        inline int call_evd(M& A, char uplo, W& w, std::false_type /*is_complex*/)
+        {
+            return lapack::syevd(A, 'V', uplo, w);
+        }
+
+        template <class M, class W>
+        inline int call_evd(M& A, char uplo, W& w, std::true_type /*is_complex*/)
+        {
+            return lapack::heevd(A, 'V', uplo, w);
+        }
+
+        /// Runs small_syev_jacobi on the row-major matrix \em a of order 2 or 3, in place.
+        template <class T, class R>
+        inline bool closed_form_eigh(T* a, std::size_t n, char uplo, R* w, std::false_type /*is_complex*/)
+        {
+            if (n == 2)
+            {
+                small_syev_jacobi<2>(a, uplo, w, a);
+            }
+            else if (n == 3)
+            {
+                small_syev_jacobi<3>(a, uplo, w, a);
+            }
+            return n == 2 || n == 3;
+        }
+
+        template <class T, class R>
+        inline bool closed_form_eigh(T*, std::size_t, char, R*, std::true_type /*is_complex*/)
+        {
+            return false;
+        }
+    }
+
+    /**
+     * Compute the determinants of a stack of square matrices.
+     *
+     * Matrices of order 2 and 3 use the closed forms, those of order up to
+     * 8 unrolled kernels, larger ones one LAPACK getrf call per matrix. The loop over the stack is
+     * parallel when XTENSOR_USE_OPENMP is defined.
+     *
+     * @param A xexpression of shape (..., n, n)
+     * @return array of shape (...) containing the determinants
+     */
+    template <class E>
+    auto batch_det(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+
+        const auto& dA = A.derived_cast();
+        detail::check_batch_square(dA, "batch_det");
+
+        xarray<value_type, layout_type::row_major> lu = dA;
+        std::size_t n = lu.shape()[lu.dimension() - 1];
+        xarray<value_type, layout_type::row_major> result = xarray<value_type>::from_shape(detail::batch_shape(lu, 2));
+        std::size_t batch_size = result.size();
+        value_type* lu_data = lu.data();
+        value_type* res_data = result.data();
+
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            value_type* a = lu_data + static_cast<std::size_t>(p) * n * n;
+            std::array<blas_index_t, detail::small_matrix_order> small_piv;
+            if (n == 0)
+            {
+                res_data[p] = value_type(1);
+            }
+            else if (n == 2 || n == 3)
+            {
+                res_data[p] = detail::closed_form_det(a, n);
+            }
+            else if (n <= detail::small_matrix_order)
+            {
+                res_data[p] = detail::dispatch_small_size(n, [&](auto N) {
+                    return detail::small_getrf<decltype(N)::value>(a, small_piv.data())
+                        ? detail::det_from_lu(a, small_piv.data(), n) : value_type(0);
+                });
+            }
+            else
+            {
+                // det(A^T) = det(A), so the row-major buffer can be factored as is
+                auto M = detail::transposed_matrix(a, n);
+                uvector<blas_index_t> piv(n);
+                int info = lapack::getrf(M, piv);
+                res_data[p] = info == 0 ? detail::det_from_lu(M.data(), piv.data(), n) : value_type(0);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Compute the signs and (natural) logarithms of the determinants of a
+     * stack of square matrices, see slogdet.
+     *
+     * The kernels are those of batch_det. With assume_a::positive_definite
+     * the matrices are factored with Cholesky instead, half the work of LU,
+     * and the signs are 1; the other structures use LU.
+     *
+     * @param A xexpression of shape (..., n, n)
+     * @param structure assume_a::positive_definite for a stack of positive definite matrices
+     * @return tuple of the signs and of the logarithms of the absolute values
+     *         of the determinants, arrays of shape (...)
+     * @throws std::runtime_error if a matrix declared positive definite is not
+     */
+    template <class E>
+    auto batch_slogdet(const xexpression<E>& A, assume_a structure = assume_a::general)
+    {
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+
+        const auto& dA = A.derived_cast();
+        detail::check_batch_square(dA, "batch_slogdet");
+
+        xarray<value_type, layout_type::row_major> lu = dA;
+        std::size_t n = lu.shape()[lu.dimension() - 1];
+        auto shape = detail::batch_shape(lu, 2);
+        xarray<value_type, layout_type::row_major> sign = xarray<value_type>::from_shape(shape);
+        xarray<real_type, layout_type::row_major> logdet = xarray<real_type>::from_shape(shape);
+        std::size_t batch_size = sign.size();
+        value_type* lu_data = lu.data();
+        value_type* sign_data = sign.data();
+        real_type* logdet_data = logdet.data();
+        bool positive_definite = structure == assume_a::positive_definite;
+
+        int failed = 0;
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for reduction(+:failed)
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            value_type* a = lu_data + static_cast<std::size_t>(p) * n * n;
+            std::tuple<value_type, real_type> res(value_type(1), real_type(0));
+            if (n == 0)
+            {
+                // the empty matrix has determinant 1
+            }
+            else if (positive_definite && n <= detail::small_matrix_order)
+            {
+                bool ok = detail::dispatch_small_size(n, [&](auto N) {
+                    return detail::small_potrf<decltype(N)::value>(a);
+                });
+                failed += !ok;
+                if (ok)
+                {
+                    res = detail::slogdet_from_cholesky(a, n);
+                }
+            }
+            else if (positive_definite)
+            {
+                // the upper triangle of A^T is the lower one of A, and the
+                // diagonal of its factor is that of the factor of A
+                auto M = detail::transposed_matrix(a, n);
+                bool ok = lapack::potr(M, 'U') == 0;
+                failed += !ok;
+                if (ok)
+                {
+                    res = detail::slogdet_from_cholesky(M.data(), n);
+                }
+            }
+            else if (n == 2 || n == 3)
+            {
+                value_type d = detail::closed_form_det(a, n);
+                if (d == value_type(0))
+                {
+                    res = std::make_tuple(value_type(0), -std::numeric_limits<real_type>::infinity());
+                }
+                else
+                {
+                    value_type s(1);
+                    real_type l = detail::log_abs_sign(s, d);
+                    res = std::make_tuple(s, l);
+                }
+            }
+            else if (n <= detail::small_matrix_order)
+            {
+                std::array<blas_index_t, detail::small_matrix_order> small_piv;
+                res = detail::dispatch_small_size(n, [&](auto N) {
+                    return detail::small_getrf<decltype(N)::value>(a, small_piv.data())
+                        ? detail::slogdet_from_lu(a, small_piv.data(), n)
+                        : std::make_tuple(value_type(0), -std::numeric_limits<real_type>::infinity());
+                });
+            }
+            else
+            {
+                // det(A^T) = det(A), so the row-major buffer can be factored as is
+                auto M = detail::transposed_matrix(a, n);
+                uvector<blas_index_t> piv(n);
+                lapack::getrf(M, piv);
+                res = detail::slogdet_from_lu(M.data(), piv.data(), n);
+            }
+            sign_data[p] = std::get<0>(res);
+            logdet_data[p] = std::get<1>(res);
+        }
+
+        if (failed != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_slogdet: matrix is not positive definite.");
+        }
+        return std::make_tuple(std::move(sign), std::move(logdet));
+    }
+
+    /**
+     * Compute the inverses of a stack of square matrices.
+     * See batch_det for the choice of kernels.
+     *
+     * @param A xexpression of shape (..., n, n)
+     * @return array of the shape of \em A containing the inverses
+     */
+    template <class E>
+    auto batch_inv(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+
+        const auto& dA = A.derived_cast();
+        detail::check_batch_square(dA, "batch_inv");
+
+        xarray<value_type, layout_type::row_major> lu = dA;
+        std::size_t n = lu.shape()[lu.dimension() - 1];
+        xarray<value_type, layout_type::row_major> result = xarray<value_type>::from_shape(lu.shape());
+        std::size_t batch_size = n == 0 ? 0 : lu.size() / (n * n);
+        value_type* lu_data = lu.data();
+        value_type* res_data = result.data();
+
+        int failed = 0;
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for reduction(+:failed)
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            value_type* a = lu_data + static_cast<std::size_t>(p) * n * n;
+            value_type* r = res_data + static_cast<std::size_t>(p) * n * n;
+            if (n <= detail::small_matrix_order)
+            {
+                std::array<blas_index_t, detail::small_matrix_order> piv;
+                std::fill(r, r + n * n, value_type(0));
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    r[i * n + i] = value_type(1);
+                }
+                detail::dispatch_small_size(n, [&](auto N) {
+                    if (detail::small_getrf<decltype(N)::value>(a, piv.data()))
+                    {
+                        detail::small_getrs<decltype(N)::value>(a, piv.data(), r, n);
+                    }
+                    else
+                    {
+                        ++failed;
+                    }
+                });
+            }
+            else
+            {
+                // inv(A^T) = inv(A)^T, so the column-major result is the
+                // row-major inverse of the row-major input
+                auto M = detail::transposed_matrix(a, n);
+                uvector<blas_index_t> piv(n);
+                int info = lapack::getrf(M, piv);
+                if (info == 0)
+                {
+                    info = lapack::getri(M, piv);
+                }
+                failed += info != 0;
+                std::copy(M.data(), M.data() + n * n, r);
+            }
+        }
+
+        if (failed != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_inv: singular matrix not invertible.");
+        }
+        return result;
+    }
+
+    /**
+     * Solve a stack of linear systems A x = b.
+     * See batch_det for the choice of kernels.
+     *
+     * @param A xexpression of shape (..., n, n)
+     * @param b xexpression of shape (..., n) or (..., n, k), with the same
+     *          leading dimensions as \em A
+     * @return array of the shape of \em b containing the solutions
+     */
+    template <class E1, class E2>
+    auto batch_solve(const xexpression<E1>& A, const xexpression<E2>& b)
+    {
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+
+        const auto& dA = A.derived_cast();
+        const auto& db = b.derived_cast();
+        detail::check_batch_square(dA, "batch_solve");
+
+        std::size_t a_dim = dA.dimension();
+        std::size_t n = dA.shape()[a_dim - 1];
+        bool vector_rhs = db.dimension() == a_dim - 1;
+        if (!vector_rhs && db.dimension() != a_dim)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_solve: b must have shape (..., n) or (..., n, k).");
+        }
+        if (!std::equal(dA.shape().begin(), dA.shape().end() - 2, db.shape().begin()) ||
+            db.shape()[a_dim - 2] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_solve: shape mismatch.");
+        }
+
+        xarray<value_type, layout_type::row_major> lu = dA;
+        xarray<value_type, layout_type::row_major> x = db;
+        std::size_t nrhs = vector_rhs ? 1 : db.shape()[a_dim - 1];
+        std::size_t batch_size = n == 0 ? 0 : lu.size() / (n * n);
+        value_type* lu_data = lu.data();
+        value_type* x_data = x.data();
+
+        int failed = 0;
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for reduction(+:failed)
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            value_type* a = lu_data + static_cast<std::size_t>(p) * n * n;
+            value_type* r = x_data + static_cast<std::size_t>(p) * n * nrhs;
+            if (n <= detail::small_matrix_order)
+            {
+                std::array<blas_index_t, detail::small_matrix_order> piv;
+                detail::dispatch_small_size(n, [&](auto N) {
+                    if (detail::small_getrf<decltype(N)::value>(a, piv.data()))
+                    {
+                        detail::small_getrs<decltype(N)::value>(a, piv.data(), r, nrhs);
+                    }
+                    else
+                    {
+                        ++failed;
+                    }
+                });
+            }
+            else
+            {
+                // the row-major buffer holds A^T: solve with trans = 'T'
+                auto M = detail::transposed_matrix(a, n);
+                auto X = xtensor<value_type, 2, layout_type::column_major>::from_shape({n, nrhs});
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    for (std::size_t j = 0; j < nrhs; ++j)
+                    {
+                        X(i, j) = r[i * nrhs + j];
+                    }
+                }
+                uvector<blas_index_t> piv(n);
+                int info = lapack::getrf(M, piv);
+                if (info == 0)
+                {
+                    info = lapack::getrs(M, piv, X, 'T');
+                }
+                failed += info != 0;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    for (std::size_t j = 0; j < nrhs; ++j)
+                    {
+                        r[i * nrhs + j] = X(i, j);
+                    }
+                }
+            }
+        }
+
+        if (failed != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_solve: the solution could not be computed.");
+        }
+        return x;
+    }
+
+    /**
+     * Compute the Cholesky decompositions of a stack of Hermitian positive
+     * definite matrices. Only the lower triangles are read.
+     * See batch_det for the choice of kernels.
+     *
+     * @param A xexpression of shape (..., n, n)
+     * @return array of the shape of \em A containing the lower triangular factors
+     */
+    template <class E>
+    auto batch_cholesky(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+
+        const auto& dA = A.derived_cast();
+        detail::check_batch_square(dA, "batch_cholesky");
+
+        xarray<value_type, layout_type::row_major> result = dA;
+        std::size_t n = result.shape()[result.dimension() - 1];
+        std::size_t batch_size = n == 0 ? 0 : result.size() / (n * n);
+        value_type* res_data = result.data();
+
+        int failed = 0;
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for reduction(+:failed)
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            value_type* a = res_data + static_cast<std::size_t>(p) * n * n;
+            if (n <= detail::small_matrix_order)
+            {
+                failed += !detail::dispatch_small_size(n, [&](auto N) {
+                    return detail::small_potrf<decltype(N)::value>(a);
+                });
+            }
+            else
+            {
+                // The column-major read of the buffer is A^T, whose upper
+                // triangle is the lower triangle of A. Its factor U, with
+                // U^H U = A^T, read back row-major is L = U^T with L L^H = A.
+                auto M = detail::transposed_matrix(a, n);
+                failed += lapack::potr(M, 'U') != 0;
+                std::copy(M.data(), M.data() + n * n, a);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    std::fill(a + i * n + i + 1, a + (i + 1) * n, value_type(0));
+                }
+            }
+        }
+
+        if (failed != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_cholesky: Cholesky decomposition failed.");
+        }
+        return result;
+    }
+
+    /**
+     * Compute the eigenvalues and eigenvectors of a stack of Hermitian or
+     * real symmetric matrices.
+     *
+     * Real matrices of order 2 and 3, such as structure or stress tensors,
+     * are diagonalized by Jacobi rotations in registers, without workspace
+     * or copies; the other stacks make one LAPACK call per matrix. The loop
+     * over the stack is parallel when XTENSOR_USE_OPENMP is defined.
+     *
+     * @param A xexpression of shape (..., n, n)
+     * @param UPLO triangle of the matrices that is read
+     * @return tuple of the eigenvalues, of shape (..., n), in ascending order
+     *         and of the eigenvectors, of shape (..., n, n), stored by column
+     */
+    template <class E>
+    auto batch_eigh(const xexpression<E>& A, char UPLO = 'L')
+    {
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+
+        const auto& dA = A.derived_cast();
+        detail::check_batch_square(dA, "batch_eigh");
+
+        xarray<value_type, layout_type::row_major> vecs = dA;
+        std::size_t n = vecs.shape()[vecs.dimension() - 1];
+        xarray<real_type, layout_type::row_major> vals = xarray<real_type>::from_shape(detail::batch_shape(vecs, 1));
+        std::size_t batch_size = n == 0 ? 0 : vecs.size() / (n * n);
+        value_type* vecs_data = vecs.data();
+        real_type* vals_data = vals.data();
+
+        int failed = 0;
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for reduction(+:failed)
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            value_type* a = vecs_data + static_cast<std::size_t>(p) * n * n;
+            if (detail::closed_form_eigh(a, n, UPLO, vals_data + static_cast<std::size_t>(p) * n,
+                                         xtl::is_complex<value_type>()))
+            {
+                continue;
+            }
+            auto M = xtensor<value_type, 2, layout_type::column_major>::from_shape({n, n});
+            auto w = xtensor<real_type, 1, layout_type::column_major>::from_shape({n});
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    M(i, j) = a[i * n + j];
+                }
+            }
+            failed += detail::call_evd(M, UPLO, w, xtl::is_complex<value_type>()) != 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    a[i * n + j] = M(i, j);
+                }
+            }
+            std::copy(w.data(), w.data() + n, vals_data + static_cast<std::size_t>(p) * n);
+        }
+
+        if (failed != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_eigh: eigenvalue computation did not converge.");
+        }
+        return std::make_tuple(std::move(vals), std::move(vecs));
+    }
+
+    namespace detail
+    {
+        template <class E>
+        inline void check_batch_matrix(const E& e, const char* name)
+        {
+            if (e.dimension() < 2)
+            {
+                std::stringstream msg;
+                msg << name << ": expected a stack of matrices of shape (..., m, n).";
+                XTENSOR_THROW(std::runtime_error, msg.str());
+            }
+        }
+
+        /// Shape of the stack of \em e with the matrix dimensions replaced by rows x cols.
+        template <class E>
+        inline dynamic_shape<std::size_t> batch_matrix_shape(const E& e, std::size_t rows, std::size_t cols)
+        {
+            auto shape = batch_shape(e, 2);
+            shape.push_back(rows);
+            shape.push_back(cols);
+            return shape;
+        }
+
+        /// Column-major copy of the row-major m x n matrix at \em a.
+        template <class T>
+        inline xtensor<T, 2, layout_type::column_major> column_major_matrix(const T* a, std::size_t m, std::size_t n)
+        {
+            auto result = xtensor<T, 2, layout_type::column_major>::from_shape({m, n});
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    result(i, j) = a[i * n + j];
+                }
+            }
+            return result;
+        }
+
+        /// Copies the matrix \em M into the row-major buffer \em r.
+        template <class M, class T>
+        inline void store_row_major(const M& m, T* r)
+        {
+            std::size_t rows = m.shape()[0];
+            std::size_t cols = m.shape()[1];
+            for (std::size_t i = 0; i < rows; ++i)
+            {
+                for (std::size_t j = 0; j < cols; ++j)
+                {
+                    r[i * cols + j] = m(i, j);
+                }
+            }
+        }
+
+        template <class T, class R>
+        inline bool small_batch_svd(const T* a, std::size_t m, std::size_t n, T* u, R* s, T* vt, std::false_type /*is_complex*/)
+        {
+            if (m > small_matrix_order || n > small_matrix_order)
+            {
+                return false;
+            }
+            small_gesvd_jacobi(a, m, n, u, s, vt);
+            return true;
+        }
+
+        template <class T, class R>
+        inline bool small_batch_svd(const T*, std::size_t, std::size_t, T*, R*, T*, std::true_type /*is_complex*/)
+        {
+            return false;
+        }
+    }
+
+    /**
+     * Compute the reduced QR decompositions of a stack of matrices,
+     * as qr(A) of each matrix.
+     *
+     * Matrices with at most small_matrix_order (8) rows and columns are
+     * factored by Householder reflections in fixed-size arrays, without
+     * workspace or copies; larger ones make one geqrf call per matrix. The
+     * loop over the stack is parallel when XTENSOR_USE_OPENMP is defined.
+     *
+     * @param A xexpression of shape (..., m, n)
+     * @return tuple of Q, of shape (..., m, k), and R, of shape (..., k, n),
+     *         with k = min(m, n)
+     */
+    template <class E>
+    auto batch_qr(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+
+        const auto& dA = A.derived_cast();
+        detail::check_batch_matrix(dA, "batch_qr");
+
+        xarray<value_type, layout_type::row_major> a = dA;
+        std::size_t m = a.shape()[a.dimension() - 2];
+        std::size_t n = a.shape()[a.dimension() - 1];
+        std::size_t k = std::min(m, n);
+        xarray<value_type, layout_type::row_major> Q = xarray<value_type>::from_shape(detail::batch_matrix_shape(a, m, k));
+        xarray<value_type, layout_type::row_major> R = xarray<value_type>::from_shape(detail::batch_matrix_shape(a, k, n));
+        std::size_t batch_size = m * n == 0 ? 0 : a.size() / (m * n);
+        const value_type* a_data = a.data();
+        value_type* q_data = Q.data();
+        value_type* r_data = R.data();
+        bool fixed_size = m <= detail::small_matrix_order && n <= detail::small_matrix_order;
+
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            std::size_t b = static_cast<std::size_t>(p);
+            const value_type* ap = a_data + b * m * n;
+            value_type* qp = q_data + b * m * k;
+            value_type* rp = r_data + b * k * n;
+            if (fixed_size)
+            {
+                detail::small_geqr_householder(ap, m, n, qp, rp);
+            }
+            else
+            {
+                auto res = qr(detail::column_major_matrix(ap, m, n));
+                detail::store_row_major(std::get<0>(res), qp);
+                detail::store_row_major(std::get<1>(res), rp);
+            }
+        }
+        return std::make_tuple(std::move(Q), std::move(R));
+    }
+
+    /**
+     * Compute the reduced singular value decompositions of a stack of
+     * matrices, as svd(A, false) of each matrix.
+     *
+     * Real matrices with at most small_matrix_order (8) rows and columns
+     * are decomposed by one-sided Jacobi rotations in fixed-size arrays,
+     * which are accurate for the small singular values too; the other
+     * stacks make one gesdd call per matrix. The loop over the stack is
+     * parallel when XTENSOR_USE_OPENMP is defined.
+     *
+     * @param A xexpression of shape (..., m, n)
+     * @return tuple of U, of shape (..., m, k), of the singular values, of
+     *         shape (..., k), in decreasing order, and of Vt, of shape
+     *         (..., k, n), with k = min(m, n)
+     */
+    template <class E>
+    auto batch_svd(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+
+        const auto& dA = A.derived_cast();
+        detail::check_batch_matrix(dA, "batch_svd");
+
+        xarray<value_type, layout_type::row_major> a = dA;
+        std::size_t m = a.shape()[a.dimension() - 2];
+        std::size_t n = a.shape()[a.dimension() - 1];
+        std::size_t k = std::min(m, n);
+        auto s_shape = detail::batch_shape(a, 2);
+        s_shape.push_back(k);
+        xarray<value_type, layout_type::row_major> U = xarray<value_type>::from_shape(detail::batch_matrix_shape(a, m, k));
+        xarray<real_type, layout_type::row_major> S = xarray<real_type>::from_shape(s_shape);
+        xarray<value_type, layout_type::row_major> Vt = xarray<value_type>::from_shape(detail::batch_matrix_shape(a, k, n));
+        std::size_t batch_size = m * n == 0 ? 0 : a.size() / (m * n);
+        const value_type* a_data = a.data();
+        value_type* u_data = U.data();
+        real_type* s_data = S.data();
+        value_type* vt_data = Vt.data();
+
+        int failed = 0;
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for reduction(+:failed)
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            std::size_t b = static_cast<std::size_t>(p);
+            const value_type* ap = a_data + b * m * n;
+            value_type* up = u_data + b * m * k;
+            real_type* sp = s_data + b * k;
+            value_type* vtp = vt_data + b * k * n;
+            if (detail::small_batch_svd(ap, m, n, up, sp, vtp, xtl::is_complex<value_type>()))
+            {
+                continue;
+            }
+            auto M = detail::column_major_matrix(ap, m, n);
+            auto res = lapack::gesdd(M, 'S');
+            failed += std::get<0>(res) != 0;
+            detail::store_row_major(std::get<1>(res), up);
+            std::copy(std::get<2>(res).data(), std::get<2>(res).data() + k, sp);
+            detail::store_row_major(std::get<3>(res), vtp);
+        }
+
+        if (failed != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_svd: SVD decomposition failed.");
+        }
+        return std::make_tuple(std::move(U), std::move(S), std::move(Vt));
+    }
+
+    namespace detail
+    {
+        /// Stack of the scalar results of linalg::batched, of the batch shape.
+        template <class R, class = void>
+        struct batched_stack
+        {
+            using type = xarray<R, layout_type::row_major>;
+
+            static type make(const R&, const dynamic_shape<std::size_t>& batch)
+            {
+                return type::from_shape(batch);
+            }
+
+            static void store(type& out, std::size_t p, std::size_t /*batch_dim*/, const R& r)
+            {
+                out.data()[p] = r;
+            }
+        };
+
+        /// Stack of array results, of the batch shape followed by the shape of the results.
+        template <class R>
+        struct batched_stack<R, std::enable_if_t<is_xexpression<R>::value>>
+        {
+            using type = xarray<typename R::value_type, layout_type::row_major>;
+
+            static type make(const R& r, const dynamic_shape<std::size_t>& batch)
+            {
+                dynamic_shape<std::size_t> shape = batch;
+                shape.insert(shape.end(), r.shape().begin(), r.shape().end());
+                return type::from_shape(shape);
+            }
+
+            static void store(type& out, std::size_t p, std::size_t batch_dim, const R& r)
+            {
+                if (r.dimension() + batch_dim != out.dimension() ||
+                    !std::equal(r.shape().begin(), r.shape().end(), out.shape().begin() + static_cast<std::ptrdiff_t>(batch_dim)))
+                {
+                    XTENSOR_THROW(std::runtime_error, "batched: f must return results of the same shape.");
+                }
+                const auto& c = view_eval<layout_type::row_major>(r);
+                std::copy(c.data(), c.data() + c.size(), out.data() + p * c.size());
+            }
+        };
+
+        /// Tuple of the stacks of the elements of tuple results.
+        template <class... R>
+        struct batched_stack<std::tuple<R...>>
+        {
+            using type = std::tuple<typename batched_stack<R>::type...>;
+
+            static type make(const std::tuple<R...>& r, const dynamic_shape<std::size_t>& batch)
+            {
+                return make_impl(r, batch, std::index_sequence_for<R...>());
+            }
+
+            static void store(type& out, std::size_t p, std::size_t batch_dim, const std::tuple<R...>& r)
+            {
+                store_impl(out, p, batch_dim, r, std::index_sequence_for<R...>());
+            }
+
+        private:
+
+            template <std::size_t... I>
+            static type make_impl(const std::tuple<R...>& r, const dynamic_shape<std::size_t>& batch,
+                                  std::index_sequence<I...>)
+            {
+                return type(batched_stack<R>::make(std::get<I>(r), batch)...);
+            }
+
+            template <std::size_t... I>
+            static void store_impl(type& out, std::size_t p, std::size_t batch_dim, const std::tuple<R...>& r,
+                                   std::index_sequence<I...>)
+            {
+                using expand = int[];
+                (void) expand{0, (batched_stack<R>::store(std::get<I>(out), p, batch_dim, std::get<I>(r)), 0)...};
+            }
+        };
+    }
+
+    /**
+     * Apply \em f to each of the N-D sub-arrays over the last N axes of
+     * \em A and stack the results over the leading axes.
+     *
+     * \em f receives a row-major xtensor of rank N and may return a scalar,
+     * an array or a tuple of those; the results are stacked into arrays of
+     * shape (..., result shape), tuples giving tuples of stacks. Every call
+     * must return results of the same shapes.
+     *
+     * With XTENSOR_USE_OPENMP the sub-arrays are distributed over the
+     * OpenMP threads with BLAS pinned to one thread per worker, so \em f
+     * must be safe to call concurrently. Each worker reuses the
+     * thread-local LAPACK workspaces of the wrappers across its calls.
+     *
+     * \code{.cpp}
+     * xt::xarray<double> stack = ...;  // shape (10000, n, n)
+     * auto w = xt::linalg::batched([](const auto& a) { return xt::linalg::eigvalsh(a); }, stack);
+     * \endcode
+     *
+     * @param f callable taking an xtensor of rank N
+     * @param A xexpression of shape (..., core shape), with a non empty batch
+     * @tparam N number of trailing axes passed to \em f
+     * @return stacked results of \em f
+     */
+    template <std::size_t N = 2, class F, class E>
+    auto batched(F&& f, const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+        using slice_type = xtensor<value_type, N, layout_type::row_major>;
+        using result_type = std::decay_t<decltype(f(std::declval<const slice_type&>()))>;
+        using stack = detail::batched_stack<result_type>;
+
+        const auto& dA = A.derived_cast();
+        if (dA.dimension() < N)
+        {
+            XTENSOR_THROW(std::runtime_error, "batched: the array has fewer dimensions than the sub-arrays.");
+        }
+
+        xarray<value_type, layout_type::row_major> a = dA;
+        std::size_t batch_dim = a.dimension() - N;
+        auto batch = detail::batch_shape(a, N);
+        std::array<std::size_t, N> core;
+        std::copy(a.shape().begin() + static_cast<std::ptrdiff_t>(batch_dim), a.shape().end(), core.begin());
+        std::size_t block = std::accumulate(core.begin(), core.end(), std::size_t(1), std::multiplies<std::size_t>());
+        std::size_t batch_size = std::accumulate(batch.begin(), batch.end(), std::size_t(1), std::multiplies<std::size_t>());
+        if (batch_size == 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "batched: the stack is empty, the shape of the results is unknown.");
+        }
+        const value_type* a_data = a.data();
+
+        // the first result sets the shapes of the stacks
+        slice_type first = slice_type::from_shape(core);
+        std::copy(a_data, a_data + block, first.data());
+        auto r0 = f(static_cast<const slice_type&>(first));
+        typename stack::type result = stack::make(r0, batch);
+        stack::store(result, 0, batch_dim, r0);
+
+#if defined(XTENSOR_USE_OPENMP)
+        blas::scoped_num_threads guard(1);
+        std::exception_ptr error;
+        #pragma omp parallel
+        {
+            // thread-local with MKL, so set again on each worker
+            blas::scoped_num_threads worker_guard(1);
+            slice_type slice = slice_type::from_shape(core);
+            #pragma omp for schedule(dynamic)
+            for (std::ptrdiff_t p = 1; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+            {
+                try
+                {
+                    std::size_t q = static_cast<std::size_t>(p);
+                    std::copy(a_data + q * block, a_data + (q + 1) * block, slice.data());
+                    stack::store(result, q, batch_dim, f(static_cast<const slice_type&>(slice)));
+                }
+                catch (...)
+                {
+                    #pragma omp critical
+                    {
+                        if (!error)
+                        {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            }
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+#else
+        slice_type slice = slice_type::from_shape(core);
+        for (std::size_t p = 1; p < batch_size; ++p)
+        {
+            std::copy(a_data + p * block, a_data + (p + 1) * block, slice.data());
+            stack::store(result, p, batch_dim, f(static_cast<const slice_type&>(slice)));
+        }
+#endif
+        return result;
+    }
+
+    /// Selects the LAPACK driver of svd, svd_inplace and pinv
+    enum class svd_driver {
+        gesdd,  ///< divide and conquer (default), fastest for large matrices
+        gesvd,  ///< QR iteration, with the smallest workspace
+        gesvj,  ///< one-sided Jacobi, real matrices only
+        gejsv   ///< preconditioned Jacobi, real matrices only
+    };
+
+    namespace detail
+    {
+        template <class T>
+        inline auto svd_jacobi(T& A, bool /*full_matrices*/, bool /*compute_uv*/, svd_driver /*driver*/, std::true_type /*is_complex*/)
+            -> decltype(lapack::gesdd(A, 'N'))
+        {
+            XTENSOR_THROW(std::runtime_error, "SVD: the gesvj and gejsv drivers only support real matrices.");
+        }
+
+        // gesvj / gejsv of a matrix with m >= n, returning (info, U, S, V)
+        template <class M>
+        inline auto svd_jacobi_tall(M& A, bool full_matrices, bool compute_uv, svd_driver driver)
+        {
+            using value_type = typename M::value_type;
+            using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+            std::size_t m = A.shape()[0];
+            std::size_t n = A.shape()[1];
+            char jobu = compute_uv ? 'U' : 'N';
+            char jobv = compute_uv ? 'V' : 'N';
+
+            if (driver == svd_driver::gejsv)
+            {
+                if (full_matrices && compute_uv)
+                {
+                    jobu = 'F';
+                }
+                return lapack::gejsv(A, jobu, jobv);
+            }
+
+            auto res = lapack::gesvj(A, jobu, jobv);
+            matrix_type u;
+            if (compute_uv)
+            {
+                u = A;
+                // complete the orthonormal basis of the n left singular vectors
+                if (full_matrices && m > n)
+                {
+                    matrix_type R = u;
+                    std::array<std::size_t, 1> tau_shp = {n};
+                    xtensor<value_type, 1, layout_type::column_major> tau(tau_shp);
+                    lapack::geqrf(R, tau);
+                    std::array<std::size_t, 2> q_shp = {m, m};
+                    matrix_type Q(q_shp);
+                    xt::view(Q, all(), range(0, n)) = R;
+                    call_gqr(Q, tau, to_blas_index(m));
+                    xt::view(Q, all(), range(0, n)) = u;
+                    u = std::move(Q);
+                }
+            }
+            return std::make_tuple(std::get<0>(res), std::move(u), std::move(std::get<1>(res)), std::move(std::get<2>(res)));
+        }
+
+        template <class T>
+        inline auto svd_jacobi(T& A, bool full_matrices, bool compute_uv, svd_driver driver, std::false_type /*is_complex*/)
+            -> decltype(lapack::gesdd(A, 'N'))
+        {
+            using value_type = typename T::value_type;
+            using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+            // both routines need m >= n: decompose the transpose of wide matrices
+            bool wide = A.shape()[0] < A.shape()[1];
+            matrix_type At;
+            if (wide)
+            {
+                At = xt::transpose(A);
+            }
+            auto res = wide ? svd_jacobi_tall(At, full_matrices, compute_uv, driver)
+                            : svd_jacobi_tall(A, full_matrices, compute_uv, driver);
+            int info = std::get<0>(res);
+            auto& u = std::get<1>(res);
+            auto& s = std::get<2>(res);
+            auto& v = std::get<3>(res);
+
+            if (!compute_uv)
+            {
+                return std::make_tuple(info, matrix_type(), std::move(s), matrix_type());
+            }
+            if (wide)
+            {
+                // At = U S V^T, so A = V S U^T
+                matrix_type ut = xt::transpose(u);
+                return std::make_tuple(info, std::move(v), std::move(s), std::move(ut));
+            }
+            matrix_type vt = xt::transpose(v);
+            return std::make_tuple(info, std::move(u), std::move(s), std::move(vt));
+        }
+    }
+
+    /**
+     * Compute the SVD decomposition of \em A in the buffer of the caller.
+     * The content of \em A is destroyed.
+     *
+     * @param A Column-major matrix, overwritten
+     * @param full_matrices compute all columns of U and rows of Vt
+     * @param compute_uv compute the singular vectors
+     * @param driver LAPACK routine used for the decomposition
+     * @return tuple containing S, V, and D
+     */
+    template <class T>
+    auto svd_inplace(T& A, bool full_matrices = true, bool compute_uv = true, svd_driver driver = svd_driver::gesdd)
+    {
+        detail::check_inplace_operand(A, "svd_inplace");
+
+        char job_type = 'A';
+        if (!compute_uv)
+        {
+            job_type = 'N';
+        }
+        else if (!full_matrices && compute_uv)
+        {
+            job_type = 'S';
+        }
+
+        auto result = driver == svd_driver::gesdd ? lapack::gesdd(A, job_type)
+                    : driver == svd_driver::gesvd ? lapack::gesvd(A, job_type)
+                    : detail::svd_jacobi(A, full_matrices, compute_uv, driver, xtl::is_complex<typename T::value_type>());
+
+        if (std::get<0>(result) > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "SVD decomposition failed.");
+        }
+
+        return std::make_tuple(std::move(std::get<1>(result)), std::move(std::get<2>(result)), std::move(std::get<3>(result)));
+    }
+
+    /**
+     * Compute the SVD decomposition of \em A.
+     *
+     * @param A Matrix to decompose
+     * @param full_matrices compute all columns of U and rows of Vt
+     * @param compute_uv compute the singular vectors
+     * @param driver LAPACK routine used for the decomposition
+     * @return tuple containing S, V, and D
+     */
+    template <class T>
+    auto svd(const xexpression<T>& A, bool full_matrices = true, bool compute_uv = true, svd_driver driver = svd_driver::gesdd)
+    {
+        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+
+        return svd_inplace(M, full_matrices, compute_uv, driver);
+    }
+
+    /**
+     * Compute the singular values of \em A into \em s, in the buffers of
+     * the caller, with gesdd and jobz 'N'. Neither the singular vectors nor
+     * their containers are allocated, and the LAPACK workspace is cached
+     * per thread, so that repeated calls on the same shape do not allocate.
+     * The content of \em A is destroyed.
+     *
+     * @param A Column-major matrix, overwritten
+     * @param s real vector of min(m, n) elements, the singular values in
+     *          decreasing order on exit
+     * @return reference to \em s
+     */
+    template <class T, class S>
+    S& svdvals_inplace(T& A, S& s)
+    {
+        detail::check_inplace_operand(A, "svdvals_inplace");
+        if (s.size() != std::min(A.shape()[0], A.shape()[1]))
+        {
+            XTENSOR_THROW(std::runtime_error, "svdvals_inplace: s must have min(m, n) elements.");
+        }
+        detail::singular_values_inplace(A, s);
+        return s;
+    }
+
+    /**
+     * Compute the singular values of \em A, as svd(A, false, false) without
+     * the empty containers for U and Vt, see svdvals_inplace.
+     *
+     * @param A Matrix of m x n elements
+     * @return vector of the min(m, n) singular values in decreasing order
+     */
+    template <class T>
+    auto svdvals(const xexpression<T>& A)
+    {
+        return detail::matrix_singular_values(A.derived_cast());
+    }
+
+    namespace detail
+    {
+        // Z = A^H Q with one GEMM; complex operands go through conj(Q^T A)
+        // so A is never copied
+        template <class E, class M>
+        inline auto adjoint_product(const E& A, const M& Q, std::false_type /*is_complex*/)
+        {
+            std::array<std::size_t, 2> shp = {A.shape()[1], Q.shape()[1]};
+            xtensor<typename M::value_type, 2, layout_type::column_major> Z(shp);
+            blas::gemm(A, Q, Z, true, false);
+            return Z;
+        }
+
+        template <class E, class M>
+        inline auto adjoint_product(const E& A, const M& Q, std::true_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+            xtensor<value_type, 2, layout_type::column_major> Qc = xt::conj(Q);
+            std::array<std::size_t, 2> shp = {Q.shape()[1], A.shape()[1]};
+            xtensor<value_type, 2, layout_type::column_major> B(shp);
+            blas::gemm(Qc, A, B, true, false);
+            xtensor<value_type, 2, layout_type::column_major> Z = xt::conj(xt::transpose(B));
+            return Z;
+        }
+
+        template <class E, class M>
+        inline auto adjoint_product(const E& A, const M& Q)
+        {
+            return adjoint_product(A, Q, xtl::is_complex<typename M::value_type>());
+        }
+
+        // Replaces the columns of the tall matrix Q with an orthonormal basis
+        // of their span (geqrf + orgqr / ungqr)
+        template <class M>
+        inline void orthonormalize(M& Q)
+        {
+            std::array<std::size_t, 1> shp = {Q.shape()[1]};
+            xtensor<typename M::value_type, 1, layout_type::column_major> tau(shp);
+            int info = lapack::geqrf(Q, tau);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "QR decomposition failed.");
+            }
+            call_gqr(Q, tau, to_blas_index(Q.shape()[1]));
+        }
+
+        template <class T, class G>
+        inline void fill_gaussian(T& M, G& engine, std::false_type /*is_complex*/)
+        {
+            std::normal_distribution<typename T::value_type> dist;
+            std::generate(M.begin(), M.end(), [&]() { return dist(engine); });
+        }
+
+        template <class T, class G>
+        inline void fill_gaussian(T& M, G& engine, std::true_type /*is_complex*/)
+        {
+            using value_type = typename T::value_type;
+            std::normal_distribution<typename value_type::value_type> dist;
+            std::generate(M.begin(), M.end(), [&]() { return value_type(dist(engine), dist(engine)); });
+        }
+
+        // Rayleigh-Ritz step: given an orthonormal basis V of a right singular
+        // subspace, the thin SVD of A V gives U, S, and the rotation of V
+        template <class E, class M>
+        inline auto svd_project(const E& A, const M& V, std::size_t k)
+        {
+            using value_type = typename M::value_type;
+            std::array<std::size_t, 2> shp = {A.shape()[0], V.shape()[1]};
+            xtensor<value_type, 2, layout_type::column_major> Y(shp);
+            blas::gemm(A, V, Y);
+
+            auto res = svd_inplace(Y, false, true);
+            auto& wt = std::get<2>(res);
+            std::array<std::size_t, 2> vt_shp = {wt.shape()[0], V.shape()[0]};
+            xtensor<value_type, 2, layout_type::column_major> Vt(vt_shp);
+            // Vt = W^H V^H = (V W)^H
+            xtensor<value_type, 2, layout_type::column_major> Vc = xt::conj(V);
+            blas::gemm(wt, Vc, Vt, false, true);
+
+            using u_type = std::decay_t<decltype(std::get<0>(res))>;
+            using s_type = std::decay_t<decltype(std::get<1>(res))>;
+            u_type U = xt::view(std::get<0>(res), all(), range(0, k));
+            s_type S = xt::view(std::get<1>(res), range(0, k));
+            u_type Vk = xt::view(Vt, range(0, k), all());
+            return std::make_tuple(std::move(U), std::move(S), std::move(Vk));
+        }
+
+        template <class E>
+        inline void check_svd_rank(const E& A, std::size_t k, const char* name)
+        {
+            if (A.dimension() != 2)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": input must be a matrix.");
+            }
+            if (k == 0 || k > std::min(A.shape()[0], A.shape()[1]))
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": rank k out of range.");
+            }
+        }
+    }
+
+    /**
+     * Compute the \em k largest singular values of \em A and their singular
+     * vectors. The dominant eigenvectors of the smaller Gram matrix A^H A
+     * (or A A^H) are computed with the MRRR subset solver, and a thin SVD of
+     * the m x k (or k x n) projection refines them. The work beyond the Gram
+     * matrix product is O((m + n) k^2), instead of a full gesdd. Singular
+     * values below sqrt(eps) times the largest are computed less accurately
+     * than by svd.
+     *
+     * @param A Matrix to decompose
+     * @param k number of singular triplets, 1 <= k <= min(m, n)
+     * @return tuple (U, S, Vt) with shapes (m, k), (k), (k, n)
+     */
+    template <class T>
+    auto svd_truncated(const xexpression<T>& A, std::size_t k)
+    {
+        using value_type = typename T::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& dA = A.derived_cast();
+        detail::check_svd_rank(dA, k, "svd_truncated");
+
+        std::size_t m = dA.shape()[0];
+        std::size_t n = dA.shape()[1];
+        bool wide = m < n;
+
+        // work on the Hermitian transpose of wide matrices so that the
+        // Gram matrix is min(m, n) x min(m, n)
+        matrix_type M = wide ? matrix_type(xt::conj(xt::transpose(dA))) : matrix_type(dA);
+        std::size_t p = M.shape()[1];
+
+        matrix_type G = detail::adjoint_product(M, M);
+        auto eig = eigh(G, select_index{p - k, p - 1});
+        auto& W = std::get<1>(eig);
+        // largest eigenvalues first
+        std::array<std::size_t, 2> v_shp = {p, k};
+        matrix_type V(v_shp);
+        for (std::size_t j = 0; j < k; ++j)
+        {
+            xt::view(V, all(), j) = xt::view(W, all(), k - 1 - j);
+        }
+
+        auto res = detail::svd_project(M, V, k);
+        if (!wide)
+        {
+            return res;
+        }
+        matrix_type U = xt::conj(xt::transpose(std::get<2>(res)));
+        matrix_type Vt = xt::conj(xt::transpose(std::get<0>(res)));
+        return std::make_tuple(std::move(U), std::move(std::get<1>(res)), std::move(Vt));
+    }
+
+    /**
+     * Compute an approximation of the \em k largest singular triplets of
+     * \em A with the randomized range finder of Halko, Martinsson and Tropp.
+     * A Gaussian test matrix with k + oversample columns is drawn from a
+     * std::mt19937 seeded with \em seed, and each power iteration applies
+     * A and A^H with one GEMM on the whole block, followed by a QR
+     * re-orthonormalization. A is finally applied to an orthonormal basis
+     * of its approximate right singular subspace, and the thin m x
+     * (k + oversample) result is decomposed with gesdd.
+     *
+     * @param A Matrix to decompose
+     * @param k number of singular triplets, 1 <= k <= min(m, n)
+     * @param oversample extra test vectors, clamped so that k + oversample <= min(m, n)
+     * @param power_iters number of power iterations, improving accuracy for
+     *        slowly decaying spectra
+     * @param seed seed of the random test matrix
+     * @return tuple (U, S, Vt) with shapes (m, k), (k), (k, n)
+     */
+    template <class T>
+    auto randomized_svd(const xexpression<T>& A, std::size_t k, std::size_t oversample = 10,
+                        std::size_t power_iters = 2, std::mt19937::result_type seed = 0)
+    {
+        using value_type = typename T::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        auto&& dA = xt::eval(A.derived_cast());
+        detail::check_svd_rank(dA, k, "randomized_svd");
+
+        std::size_t m = dA.shape()[0];
+        std::size_t n = dA.shape()[1];
+        std::size_t l = std::min(k + oversample, std::min(m, n));
+
+        std::mt19937 engine(seed);
+        std::array<std::size_t, 2> omega_shp = {n, l};
+        matrix_type Omega(omega_shp);
+        detail::fill_gaussian(Omega, engine, xtl::is_complex<value_type>());
+
+        std::array<std::size_t, 2> y_shp = {m, l};
+        matrix_type Q(y_shp);
+        blas::gemm(dA, Omega, Q);
+        detail::orthonormalize(Q);
+
+        for (std::size_t i = 0; i < power_iters; ++i)
+        {
+            matrix_type Z = detail::adjoint_product(dA, Q);
+            detail::orthonormalize(Z);
+            blas::gemm(dA, Z, Q);
+            detail::orthonormalize(Q);
+        }
+
+        // A ~ Q Q^H A; the right singular subspace of Q^H A is spanned by
+        // the columns of A^H Q
+        matrix_type Z = detail::adjoint_product(dA, Q);
+        detail::orthonormalize(Z);
+        return detail::svd_project(dA, Z, k);
+    }
+
+    /// Column sampling of nystrom
+    enum class nystrom_sampling
+    {
+        uniform,   ///< k columns drawn uniformly without replacement
+        leverage   ///< k columns drawn by the leverage scores of a uniform pilot approximation
+    };
+
+    /// Parameters of nystrom
+    struct nystrom_options
+    {
+        nystrom_sampling sampling = nystrom_sampling::uniform;  ///< Column sampling
+        double rcond = 1e-10;                                   ///< Core eigenvalues below rcond times the largest are dropped
+        std::mt19937::result_type seed = 0;                     ///< Seed of the sampling
+    };
+
+    /**
+     * Low rank approximation A ~ F F^T of a symmetric positive semidefinite
+     * n x n matrix, as returned by nystrom, with products, shifted solves
+     * and log-determinants in O(n r) and O(n r^2) instead of O(n^3).
+     *
+     * The solves and log-determinants are those of F F^T + shift I, e.g.
+     * a kernel matrix with a noise variance, by the Woodbury identity:
+     * (F F^T + s I)^-1 = (I - F (s I + F^T F)^-1 F^T) / s, and
+     * det(F F^T + s I) = s^(n - r) det(s I + F^T F), with the r x r matrix
+     * s I + F^T F factored by Cholesky at each call.
+     */
+    template <class T>
+    class nystrom_approximation
+    {
+    public:
+
+        using value_type = T;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        nystrom_approximation(matrix_type factor, std::vector<std::size_t> indices);
+
+        template <class E>
+        auto dot(const xexpression<E>& x) const;
+
+        template <class E>
+        auto solve(const xexpression<E>& b, value_type shift) const;
+
+        value_type logdet(value_type shift) const;
+
+        std::size_t size() const noexcept;
+        std::size_t rank() const noexcept;
+        const matrix_type& factor() const noexcept;
+        const std::vector<std::size_t>& indices() const noexcept;
+
+    private:
+
+        cholesky_factorization<value_type> core(value_type shift) const;
+
+        matrix_type m_factor;
+        matrix_type m_gram;
+        std::vector<std::size_t> m_indices;
+    };
+
+    namespace detail
+    {
+        // k distinct indices of [0, n), sorted
+        template <class G>
+        inline std::vector<std::size_t> sample_uniform(std::size_t n, std::size_t k, G& engine)
+        {
+            std::vector<std::size_t> order(n);
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                std::uniform_int_distribution<std::size_t> pick(i, n - 1);
+                std::swap(order[i], order[pick(engine)]);
+            }
+            order.resize(k);
+            std::sort(order.begin(), order.end());
+            return order;
+        }
+
+        // k distinct indices of [0, n) drawn with probabilities proportional to weights (Efraimidis and Spirakis)
+        template <class W, class G>
+        inline std::vector<std::size_t> sample_weighted(const W& weights, std::size_t k, G& engine)
+        {
+            std::size_t n = weights.size();
+            std::uniform_real_distribution<double> unit(0., 1.);
+            std::vector<std::pair<double, std::size_t>> keys(n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                // log(u) / w, the logarithm of the key u^(1/w)
+                double u = std::max(unit(engine), std::numeric_limits<double>::min());
+                keys[i] = {std::log(u) / double(weights[i]), i};
+            }
+            std::nth_element(keys.begin(), keys.begin() + std::ptrdiff_t(k - 1), keys.end(),
+                             [](const auto& a, const auto& b) { return a.first > b.first; });
+            std::vector<std::size_t> result(k);
+            for (std::size_t q = 0; q < k; ++q)
+            {
+                result[q] = keys[q].second;
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        /*
+         * F = C V_r L_r^-1/2 from the columns C = A(:, I) and the eigenpairs
+         * (L, V) of the core W = A(I, I), dropping the eigenvalues below
+         * rcond times the largest.
+         */
+        template <class T>
+        inline xtensor<T, 2, layout_type::column_major>
+        nystrom_factor(const xtensor<T, 2, layout_type::column_major>& C, const std::vector<std::size_t>& indices,
+                       double rcond)
+        {
+            using matrix_type = xtensor<T, 2, layout_type::column_major>;
+            std::size_t k = indices.size();
+            matrix_type W = matrix_type::from_shape({k, k});
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                for (std::size_t i = 0; i < k; ++i)
+                {
+                    W(i, j) = (C(indices[i], j) + C(indices[j], i)) / T(2);
+                }
+            }
+            auto w = eigh_inplace(W);
+            T cutoff = T(rcond) * std::max(w(k - 1), T(0));
+            std::size_t first = 0;
+            while (first < k && !(w(first) > cutoff))
+            {
+                ++first;
+            }
+            std::size_t r = k - first;
+            if (r == 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "nystrom: the sampled core is zero.");
+            }
+            matrix_type Vr = xt::view(W, all(), range(first, k));
+            for (std::size_t j = 0; j < r; ++j)
+            {
+                T scale = T(1) / std::sqrt(w(first + j));
+                for (std::size_t i = 0; i < k; ++i)
+                {
+                    Vr(i, j) *= scale;
+                }
+            }
+            matrix_type F = matrix_type::from_shape({C.shape()[0], r});
+            blas::gemm(C, Vr, F);
+            return F;
+        }
+
+        template <class T, class F>
+        inline nystrom_approximation<T> nystrom_impl(std::size_t n, std::size_t k, F&& columns,
+                                                     const nystrom_options& options)
+        {
+            using matrix_type = xtensor<T, 2, layout_type::column_major>;
+            if (k == 0 || k > n)
+            {
+                XTENSOR_THROW(std::runtime_error, "nystrom: the rank must be between 1 and the size of the matrix.");
+            }
+            std::mt19937 engine(options.seed);
+            std::vector<std::size_t> indices = sample_uniform(n, k, engine);
+            matrix_type C = columns(indices);
+
+            if (options.sampling == nystrom_sampling::leverage)
+            {
+                // leverage scores of the range of the pilot factor: squared
+                // row norms of an orthonormal basis of it, mixed with uniform
+                // weights so that every column can be drawn
+                matrix_type Q = nystrom_factor(C, indices, options.rcond);
+                orthonormalize(Q);
+                xtensor<double, 1> weights = xtensor<double, 1>::from_shape({n});
+                double total = 0.;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    double s = 0.;
+                    for (std::size_t j = 0; j < Q.shape()[1]; ++j)
+                    {
+                        s += double(Q(i, j)) * double(Q(i, j));
+                    }
+                    weights(i) = s;
+                    total += s;
+                }
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    weights(i) = 0.9 * weights(i) / total + 0.1 / double(n);
+                }
+                indices = sample_weighted(weights, k, engine);
+                C = columns(indices);
+            }
+            return nystrom_approximation<T>(nystrom_factor(C, indices, options.rcond), std::move(indices));
+        }
+    }
+
+    /**
+     * Nystrom approximation A ~ C W^+ C^T of a symmetric positive
+     * semidefinite matrix from \em k of its columns C = A(:, I), with
+     * W = A(I, I), returned as a factor F = C V L^-1/2 of rank r <= k from
+     * the eigendecomposition W = V L V^T; see nystrom_approximation for the
+     * solves and log-determinants. Only the k sampled columns are read.
+     *
+     * @param A symmetric positive semidefinite n x n matrix expression
+     * @param k number of sampled columns
+     * @param options sampling, cut-off of the core eigenvalues and seed
+     * @return the approximation
+     */
+    template <class E>
+    auto nystrom(const xexpression<E>& A, std::size_t k, const nystrom_options& options = nystrom_options())
+    {
+        using value_type = typename E::value_type;
+        static_assert(!xtl::is_complex<value_type>::value, "nystrom: expected a real matrix.");
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& a = A.derived_cast();
+        assert_nd_square(a);
+        std::size_t n = a.shape()[0];
+        return detail::nystrom_impl<value_type>(n, k, [&a, n](const std::vector<std::size_t>& indices)
+        {
+            matrix_type C = matrix_type::from_shape({n, indices.size()});
+            for (std::size_t q = 0; q < indices.size(); ++q)
+            {
+                noalias(xt::view(C, all(), q)) = xt::view(a, all(), indices[q]);
+            }
+            return C;
+        }, options);
+    }
+
+    /**
+     * Nystrom approximation of the n x n kernel matrix of elements
+     * kernel(i, j), e.g. a Gaussian process covariance, evaluating only
+     * the n k elements of the sampled columns, in parallel over the
+     * columns when XTENSOR_USE_OPENMP is defined; \em kernel must then be
+     * safe to call concurrently. See nystrom(const xexpression<E>&, std::size_t, const nystrom_options&).
+     *
+     * @param n order of the kernel matrix
+     * @param kernel function of (i, j) returning a real element, symmetric
+     *        positive semidefinite
+     * @param k number of sampled columns
+     * @param options sampling, cut-off of the core eigenvalues and seed
+     * @return the approximation
+     */
+    template <class K>
+    auto nystrom(std::size_t n, K&& kernel, std::size_t k, const nystrom_options& options = nystrom_options())
+    {
+        using value_type = std::decay_t<decltype(kernel(std::size_t(0), std::size_t(0)))>;
+        static_assert(!xtl::is_complex<value_type>::value, "nystrom: expected a real kernel.");
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        return detail::nystrom_impl<value_type>(n, k, [&kernel, n](const std::vector<std::size_t>& indices)
+        {
+            matrix_type C = matrix_type::from_shape({n, indices.size()});
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for
+#endif
+            for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(indices.size()); ++p)
+            {
+                std::size_t q = static_cast<std::size_t>(p);
+                value_type* column = C.data() + q * n;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    column[i] = kernel(i, indices[q]);
+                }
+            }
+            return C;
+        }, options);
+    }
+
+    /**
+     * Takes the n x r factor F of A ~ F F^T and the sampled columns.
+     */
+    template <class T>
+    inline nystrom_approximation<T>::nystrom_approximation(matrix_type factor, std::vector<std::size_t> indices)
+        : m_factor(std::move(factor)), m_indices(std::move(indices))
+    {
+        std::size_t r = m_factor.shape()[1];
+        m_gram = matrix_type::from_shape({r, r});
+        m_gram.fill(value_type(0));
+        blas::syrk(m_factor, m_gram, 'L', true);
+        for (std::size_t j = 0; j < r; ++j)
+        {
+            for (std::size_t i = j + 1; i < r; ++i)
+            {
+                m_gram(j, i) = m_gram(i, j);
+            }
+        }
+    }
+
+    /**
+     * @return F F^T x, by two GEMMs through the rank r
+     */
+    template <class T>
+    template <class E>
+    inline auto nystrom_approximation<T>::dot(const xexpression<E>& x) const
+    {
+        return linalg::dot(m_factor, linalg::dot(xt::transpose(m_factor), x.derived_cast()));
+    }
+
+    /**
+     * Solves (F F^T + shift I) x = b by the Woodbury identity.
+     * @param b vector of size n or n x p matrix
+     * @param shift positive diagonal shift, e.g. a noise variance
+     * @return x, of the shape of \em b
+     */
+    template <class T>
+    template <class E>
+    inline auto nystrom_approximation<T>::solve(const xexpression<E>& b, value_type shift) const
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        if (x.dimension() == 0 || x.shape()[0] != size())
+        {
+            XTENSOR_THROW(std::runtime_error, "nystrom_approximation::solve: shape mismatch.");
+        }
+        auto z = core(shift).solve(linalg::dot(xt::transpose(m_factor), x));
+        x -= linalg::dot(m_factor, z);
+        x /= shift;
+        return x;
+    }
+
+    /**
+     * @return log det(F F^T + shift I), by the Woodbury determinant identity
+     */
+    template <class T>
+    inline auto nystrom_approximation<T>::logdet(value_type shift) const -> value_type
+    {
+        return value_type(size() - rank()) * std::log(shift) + core(shift).logdet();
+    }
+
+    /// @return n, the order of the approximated matrix
+    template <class T>
+    inline std::size_t nystrom_approximation<T>::size() const noexcept
+    {
+        return m_factor.shape()[0];
+    }
+
+    /// @return r, the rank of the approximation
+    template <class T>
+    inline std::size_t nystrom_approximation<T>::rank() const noexcept
+    {
+        return m_factor.shape()[1];
+    }
+
+    /// @return the n x r factor F of A ~ F F^T
+    template <class T>
+    inline auto nystrom_approximation<T>::factor() const noexcept -> const matrix_type&
+    {
+        return m_factor;
+    }
+
+    /// @return the sampled columns, in increasing order
+    template <class T>
+    inline auto nystrom_approximation<T>::indices() const noexcept -> const std::vector<std::size_t>&
+    {
+        return m_indices;
+    }
+
+    template <class T>
+    inline auto nystrom_approximation<T>::core(value_type shift) const -> cholesky_factorization<value_type>
+    {
+        if (!(shift > value_type(0)))
+        {
+            XTENSOR_THROW(std::runtime_error, "nystrom_approximation: the shift must be positive.");
+        }
+        matrix_type K = m_gram;
+        for (std::size_t i = 0; i < K.shape()[0]; ++i)
+        {
+            K(i, i) += shift;
+        }
+        return cholesky_factorization<value_type>(K);
+    }
+
+    /**
+     * Calculate Moore-Rose pseudo inverse using LAPACK SVD.
+     * The rows of Vt belonging to singular values above the cut-off are
+     * scaled in place, and the pseudo-inverse is formed with a single GEMM
+     * restricted to these rows.
+     *
+     * @param A matrix to invert
+     * @param rcond cut-off ratio for small singular values
+     * @param driver LAPACK routine used for the SVD
+     * @return pseudo-inverse of shape (n, m)
+     */
+    template <class T>
+    auto pinv(const xexpression<T>& A, double rcond = 1e-15, svd_driver driver = svd_driver::gesdd)
+    {
+        using value_type = typename T::value_type;
+        const auto& dA = A.derived_cast();
+
+        // with conj(A) = U S Vt, pinv(A) = Vt^T S^+ U^T needs no conjugation
+        xtensor<value_type, 2, layout_type::column_major> M = xt::conj(dA);
+
+        auto gesdd_res = svd_inplace(M, false, true, driver);
+
+        auto& u = std::get<0>(gesdd_res);
+        auto& s = std::get<1>(gesdd_res);
+        auto& vt = std::get<2>(gesdd_res);
+
+        using real_value_type = typename std::decay_t<decltype(s)>::value_type;
+        real_value_type cutoff = static_cast<real_value_type>(rcond) * (*std::max_element(s.begin(), s.end()));
+
+        // singular values are in descending order
+        std::size_t rank = 0;
+        while (rank < s.size() && s(rank) > cutoff)
+        {
+            ++rank;
+        }
+
+        for (std::size_t j = 0; j < vt.shape()[1]; ++j)
+        {
+            for (std::size_t i = 0; i < rank; ++i)
+            {
+                vt(i, j) *= real_value_type(1) / s(i);
+            }
+        }
+
+        std::array<std::size_t, 2> shp = {dA.shape()[1], dA.shape()[0]};
+        xtensor<value_type, 2> result(shp, value_type(0));
+        if (rank != 0)
+        {
+            blas::gemm(xt::view(vt, range(0, rank), all()), xt::view(u, all(), range(0, rank)), result, true, true);
+        }
+        return result;
+    }
+
+    namespace detail
+    {
+        /**
+         * Computes base**n, n >= 1, into \em result by binary decomposition,
+         * overwriting \em base. Each product goes into \em scratch, which is
+         * then swapped with its destination, so that no matrix is copied
+         * except base into result for the lowest set bit of n.
+         */
+        template <class M>
+        inline void matrix_power_binary(M& base, unsigned long n, M& result, M& scratch)
+        {
+            bool first = true;
+            while (true)
+            {
+                if (n & 1ul)
+                {
+                    if (first)
+                    {
+                        std::copy(base.storage().cbegin(), base.storage().cend(), result.storage().begin());
+                        first = false;
+                    }
+                    else
+                    {
+                        blas::gemm(result, base, scratch);
+                        std::swap(result, scratch);
+                    }
+                }
+                n >>= 1;
+                if (n == 0)
+                {
+                    break;
+                }
+                blas::gemm(base, base, scratch);
+                std::swap(base, scratch);
+            }
+        }
+
+        /// Number of matrix products of matrix_power_binary for the exponent n.
+        inline std::size_t matrix_power_products(unsigned long n)
+        {
+            // one squaring per bit but the highest, one product per set bit but the lowest
+            std::size_t bits = 0, ones = 0;
+            for (; n != 0; n >>= 1)
+            {
+                ++bits;
+                ones += n & 1ul;
+            }
+            return bits == 0 ? 0 : bits + ones - 2;
+        }
+
+        /**
+         * Above this many products of the binary decomposition, a symmetric
+         * or Hermitian matrix is raised to its power through its
+         * eigendecomposition, which costs about as much as six products.
+         */
+        constexpr std::size_t matrix_power_eigh_min_products = 6;
+
+        template <class T>
+        inline bool matrix_power_use_eigh(assume_a structure, std::size_t products)
+        {
+            bool hermitian = structure == assume_a::hermitian || structure == assume_a::positive_definite
+                || (structure == assume_a::symmetric && !xtl::is_complex<T>::value);
+            return hermitian && products >= matrix_power_eigh_min_products;
+        }
+
+        template <class M>
+        inline const M& conj_matrix(const M& m, std::false_type /*is_complex*/)
+        {
+            return m;
+        }
+
+        template <class M>
+        inline M conj_matrix(const M& m, std::true_type /*is_complex*/)
+        {
+            M result = xt::conj(m);
+            return result;
+        }
+
+        /// A**n = V diag(w**n) V^H for the Hermitian matrix A = V diag(w) V^H.
+        template <class E, class M>
+        inline void matrix_power_eigh(const E& A, long n, M& result, std::true_type /*is_inexact*/)
+        {
+            using value_type = typename M::value_type;
+            auto eig = eigh(A);
+            const auto& w = std::get<0>(eig);
+            const auto& V = std::get<1>(eig);
+
+            auto scaled = V;
+            for (std::size_t j = 0; j < w.size(); ++j)
+            {
+                value_type p = value_type(std::pow(w(j), static_cast<int>(n)));
+                for (std::size_t i = 0; i < scaled.shape()[0]; ++i)
+                {
+                    scaled(i, j) *= p;
+                }
+            }
+            const auto& Vc = conj_matrix(V, xtl::is_complex<value_type>());
+            blas::gemm(scaled, Vc, result, false, true);
+        }
+
+        template <class E, class M>
+        inline void matrix_power_eigh(const E&, long, M&, std::false_type /*is_inexact*/)
+        {
+        }
+
+        template <class T>
+        using is_inexact = std::integral_constant<bool, std::is_floating_point<T>::value || xtl::is_complex<T>::value>;
+
+        template <class M, class E>
+        inline M matrix_power_base(const E& A, long n, std::true_type /*is_inexact*/)
+        {
+            return n < 0 ? M(inv(A)) : M(A);
+        }
+
+        template <class M, class E>
+        inline M matrix_power_base(const E& A, long n, std::false_type /*is_inexact*/)
+        {
+            if (n < 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "matrix_power: negative exponents require a floating point matrix.");
+            }
+            return M(A);
+        }
+
+        /**
+         * Computes A**n into \em result, a square matrix of the order of
+         * \em A.
+         */
+        template <class E, class M>
+        inline void matrix_power_impl(const E& A, long n, M& result, assume_a structure)
+        {
+            using value_type = typename M::value_type;
+            std::size_t order = A.shape()[0];
+            if (n == 0)
+            {
+                result = eye<value_type>(order);
+                return;
+            }
+
+            unsigned long e = static_cast<unsigned long>(n < 0 ? -n : n);
+            if (structure == assume_a::detect)
+            {
+                structure = detect_structure(A);
+            }
+            if (is_inexact<value_type>::value && matrix_power_use_eigh<value_type>(structure, matrix_power_products(e)))
+            {
+                matrix_power_eigh(A, n, result, is_inexact<value_type>());
+                return;
+            }
+
+            M base = matrix_power_base<M>(A, n, is_inexact<value_type>());
+            M scratch = M::from_shape(base.shape());
+            matrix_power_binary(base, e, result, scratch);
+        }
+
+        template <class E, class R>
+        inline void matrix_power_into(const E& A, long n, R& result, assume_a structure, std::true_type /*is_buffer*/)
+        {
+            matrix_power_impl(A, n, result, structure);
+        }
+
+        template <class E, class R>
+        inline void matrix_power_into(const E& A, long n, R& result, assume_a structure, std::false_type /*is_buffer*/)
+        {
+            constexpr layout_type L = R::static_layout == layout_type::column_major ? layout_type::column_major
+                                                                                    : layout_type::row_major;
+            using xtype = xtensor<typename R::value_type, 2, L>;
+            xtype res = xtype::from_shape({A.shape()[0], A.shape()[1]});
+            matrix_power_impl(A, n, res, structure);
+            noalias(result) = res;
+        }
+    }
+
+    /**
+     * Calculate matrix power A**n
+     *
+     * The power is computed by binary decomposition of \em n, with the
+     * products ping-ponging between preallocated buffers. If \em structure
+     * says that \em A is Hermitian (real symmetric, Hermitian or positive
+     * definite) and the exponent needs more than a few products, A**n is
+     * computed from the eigendecomposition of \em A instead.
+     *
+     * @param A  The matrix
+     * @param n  The exponent, A**n = inv(A)**(-n) if n < 0
+     * @param structure structure of \em A, or assume_a::detect
+     *
+     * @return resulting array
+     */
+    template <class E>
+    auto matrix_power(const xexpression<E>& A, long n, assume_a structure = assume_a::general)
+    {
+        using value_type = typename E::value_type;
+        using xtype = xtensor<value_type, 2>;
+
+        const auto& dA = A.derived_cast();
+        XTENSOR_ASSERT(dA.dimension() == 2);
+        XTENSOR_ASSERT(dA.shape()[0] == dA.shape()[1]);
+
+        xtype res = xtype::from_shape({dA.shape()[0], dA.shape()[1]});
+        detail::matrix_power_impl(dA, n, res, structure);
+        return res;
+    }
+
+    /**
+     * Calculate matrix power A**n into the buffer of the caller, see
+     * matrix_power.
+     *
+     * @param A  The matrix
+     * @param n  The exponent
+     * @param result square matrix of the order of \em A, receives A**n
+     * @param structure structure of \em A, or assume_a::detect
+     */
+    template <class E, class R>
+    void matrix_power(const xexpression<E>& A, long n, R& result, assume_a structure = assume_a::general)
+    {
+        constexpr layout_type L = R::static_layout == layout_type::column_major ? layout_type::column_major
+                                                                                : layout_type::row_major;
+        using xtype = xtensor<typename R::value_type, 2, L>;
+
+        const auto& dA = A.derived_cast();
+        assert_nd_square(dA);
+        if (result.dimension() != 2 || result.shape()[0] != dA.shape()[0] || result.shape()[1] != dA.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "matrix_power: result must have the shape of A.");
+        }
+
+        // a result of the buffer type is used as one of the buffers
+        detail::matrix_power_into(dA, n, result, structure, std::is_same<R, xtype>());
+    }
+
+    /**
+     * Raise each matrix of a stack of square matrices to the power \em n.
+     * The loop over the stack is parallel when XTENSOR_USE_OPENMP is defined.
+     *
+     * @param A xexpression of shape (..., m, m)
+     * @param n The exponent, negative exponents invert the matrices first
+     * @return array of the shape of \em A containing the powers
+     */
+    template <class E>
+    auto batch_matrix_power(const xexpression<E>& A, long n)
+    {
+        using value_type = typename E::value_type;
+        using matrix_type = xtensor<value_type, 2>;
+
+        const auto& dA = A.derived_cast();
+        detail::check_batch_square(dA, "batch_matrix_power");
+
+        xarray<value_type, layout_type::row_major> stack = n < 0
+            ? xarray<value_type, layout_type::row_major>(batch_inv(dA))
+            : xarray<value_type, layout_type::row_major>(dA);
+        std::size_t m = stack.shape()[stack.dimension() - 1];
+        std::size_t batch_size = m == 0 ? 0 : stack.size() / (m * m);
+        unsigned long e = static_cast<unsigned long>(n < 0 ? -n : n);
+        value_type* data = stack.data();
+
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            value_type* a = data + static_cast<std::size_t>(p) * m * m;
+            if (e == 0)
+            {
+                std::fill(a, a + m * m, value_type(0));
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    a[i * m + i] = value_type(1);
+                }
+                continue;
+            }
+            auto base = matrix_type::from_shape({m, m});
+            auto result = matrix_type::from_shape({m, m});
+            auto scratch = matrix_type::from_shape({m, m});
+            std::copy(a, a + m * m, base.data());
+            detail::matrix_power_binary(base, e, result, scratch);
+            std::copy(result.data(), result.data() + m * m, a);
+        }
+        return stack;
+    }
+
+    /********************
+     * matrix functions *
+     ********************/
+
+    namespace detail
+    {
+        /// Largest absolute column sum of the matrix \em A.
+        template <class M>
+        inline double matrix_norm1(const M& A)
+        {
+            double result = 0.;
+            for (std::size_t j = 0; j < A.shape()[1]; ++j)
+            {
+                double sum = 0.;
+                for (std::size_t i = 0; i < A.shape()[0]; ++i)
+                {
+                    sum += static_cast<double>(std::abs(A(i, j)));
+                }
+                result = std::max(result, sum);
+            }
+            return result;
+        }
+
+        /// Largest absolute row sum of the vector or matrix \em B.
+        template <class M>
+        inline double matrix_norm_inf(const M& B)
+        {
+            double result = 0.;
+            std::size_t cols = B.dimension() == 1 ? 1 : B.shape()[1];
+            for (std::size_t i = 0; i < B.shape()[0]; ++i)
+            {
+                double sum = 0.;
+                for (std::size_t j = 0; j < cols; ++j)
+                {
+                    sum += static_cast<double>(std::abs(B.dimension() == 1 ? B(i) : B(i, j)));
+                }
+                result = std::max(result, sum);
+            }
+            return result;
+        }
+
+        template <class M, class V>
+        inline void add_to_diagonal(M& A, const V& value)
+        {
+            for (std::size_t i = 0; i < A.shape()[0]; ++i)
+            {
+                A(i, i) += value;
+            }
+        }
+
+        /// Coefficients of the [m/m] Pade approximant of exp, lowest order first.
+        inline const double* expm_pade_coefficients(std::size_t m)
+        {
+            static const double b3[] = {120., 60., 12., 1.};
+            static const double b5[] = {30240., 15120., 3360., 420., 30., 1.};
+            static const double b7[] = {17297280., 8648640., 1995840., 277200., 25200., 1512., 56., 1.};
+            static const double b9[] = {17643225600., 8821612800., 2075673600., 302702400., 30270240.,
+                                        2162160., 110880., 3960., 90., 1.};
+            static const double b13[] = {64764752532480000., 32382376266240000., 7771770303897600.,
+                                         1187353796428800., 129060195264000., 10559470521600.,
+                                         670442572800., 33522128640., 1323241920., 40840800., 960960.,
+                                         16380., 182., 1.};
+            return m == 3 ? b3 : m == 5 ? b5 : m == 7 ? b7 : m == 9 ? b9 : b13;
+        }
+
+        /**
+         * Sets u and v to the odd and even parts of the [m/m] Pade
+         * approximant, m in {3, 5, 7, 9}, from A and A^2, with m / 2 matrix
+         * products.
+         */
+        template <class M>
+        inline void expm_pade_low(const M& a, const M& a2, std::size_t m, M& u, M& v, M& scratch)
+        {
+            using value_type = typename M::value_type;
+            const double* b = expm_pade_coefficients(m);
+
+            std::fill(scratch.begin(), scratch.end(), value_type(0));
+            std::fill(v.begin(), v.end(), value_type(0));
+            add_to_diagonal(scratch, value_type(b[1]));
+            add_to_diagonal(v, value_type(b[0]));
+
+            M power = a2;
+            M next = M::from_shape(a2.shape());
+            for (std::size_t k = 1; 2 * k <= m; ++k)
+            {
+                if (k > 1)
+                {
+                    blas::gemm(power, a2, next);
+                    std::swap(power, next);
+                }
+                noalias(scratch) += value_type(b[2 * k + 1]) * power;
+                noalias(v) += value_type(b[2 * k]) * power;
+            }
+            blas::gemm(a, scratch, u);
+        }
+
+        /**
+         * Sets u and v to the odd and even parts of the [13/13] Pade
+         * approximant from A and A^2, with 5 matrix products (Higham 2005).
+         */
+        template <class M>
+        inline void expm_pade13(const M& a, const M& a2, M& u, M& v, M& scratch)
+        {
+            using value_type = typename M::value_type;
+            const double* b = expm_pade_coefficients(13);
+            auto c = [b](std::size_t i) { return value_type(b[i]); };
+
+            M a4 = M::from_shape(a.shape());
+            M a6 = M::from_shape(a.shape());
+            blas::gemm(a2, a2, a4);
+            blas::gemm(a4, a2, a6);
+
+            noalias(scratch) = c(13) * a6 + c(11) * a4 + c(9) * a2;
+            blas::gemm(a6, scratch, u);
+            noalias(u) += c(7) * a6 + c(5) * a4 + c(3) * a2;
+            add_to_diagonal(u, c(1));
+            blas::gemm(a, u, scratch);
+            std::swap(u, scratch);
+
+            noalias(scratch) = c(12) * a6 + c(10) * a4 + c(8) * a2;
+            blas::gemm(a6, scratch, v);
+            noalias(v) += c(6) * a6 + c(4) * a4 + c(2) * a2;
+            add_to_diagonal(v, c(0));
+        }
+
+        /// result := (v - u)^-1 (v + u), overwriting v.
+        template <class M>
+        inline void expm_pade_solve(M& u, M& v, M& result)
+        {
+            noalias(result) = v + u;
+            noalias(v) -= u;
+            int info = lapack::gesv(v, result);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "expm: singular Pade denominator.");
+            }
+        }
+    }
+
+    /**
+     * Compute the matrix exponential of a square matrix with the scaling and
+     * squaring method of Higham (2005).
+     *
+     * Matrices of small 1-norm get a Pade approximant of degree 3 to 9
+     * without scaling. Otherwise the matrix is scaled by 2^-s to a 1-norm
+     * below 5.37, the degree 13 approximant is evaluated with 6 matrix
+     * products and the result is squared s times. The products alternate
+     * between preallocated buffers.
+     *
+     * @param A square matrix
+     * @return column-major matrix exp(A)
+     */
+    template <class E>
+    auto expm(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        assert_nd_square(A);
+        matrix_type a = A.derived_cast();
+        std::size_t n = a.shape()[0];
+        matrix_type result = matrix_type::from_shape({n, n});
+        if (n == 0)
+        {
+            return result;
+        }
+
+        static const std::size_t degrees[] = {3, 5, 7, 9};
+        static const double theta[] = {1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+                                       2.097847961257068e0};
+        constexpr double theta13 = 5.371920351148152e0;
+
+        matrix_type a2 = matrix_type::from_shape({n, n});
+        matrix_type u = matrix_type::from_shape({n, n});
+        matrix_type v = matrix_type::from_shape({n, n});
+        matrix_type scratch = matrix_type::from_shape({n, n});
+
+        double norm = detail::matrix_norm1(a);
+        for (std::size_t k = 0; k < 4; ++k)
+        {
+            if (norm <= theta[k])
+            {
+                blas::gemm(a, a, a2);
+                detail::expm_pade_low(a, a2, degrees[k], u, v, scratch);
+                detail::expm_pade_solve(u, v, result);
+                return result;
+            }
+        }
+
+        int s = norm > theta13 ? static_cast<int>(std::ceil(std::log2(norm / theta13))) : 0;
+        if (s > 0)
+        {
+            a *= value_type(std::ldexp(1., -s));
+        }
+        blas::gemm(a, a, a2);
+        detail::expm_pade13(a, a2, u, v, scratch);
+        detail::expm_pade_solve(u, v, result);
+        for (int i = 0; i < s; ++i)
+        {
+            blas::gemm(result, result, scratch);
+            std::swap(result, scratch);
+        }
+        return result;
+    }
+
+    namespace detail
+    {
+        template <class T>
+        inline T sqrtm_diagonal(const T& x, std::false_type /*is_complex*/)
+        {
+            if (x < T(0))
+            {
+                XTENSOR_THROW(std::runtime_error, "sqrtm: real matrix with negative real eigenvalues, use a complex matrix.");
+            }
+            return std::sqrt(x);
+        }
+
+        template <class T>
+        inline T sqrtm_diagonal(const T& x, std::true_type /*is_complex*/)
+        {
+            return std::sqrt(x);
+        }
+
+        /**
+         * Principal square root of the 2 x 2 block [a b; c d] of a real
+         * Schur form, whose eigenvalues are theta +- i mu: with
+         * alpha = Re sqrt(theta + i mu), R = alpha I + (T - theta I) / (2 alpha).
+         */
+        template <class T>
+        inline void sqrtm_block2(const T* t, T* r, blas_index_t ld, std::false_type /*is_complex*/)
+        {
+            T a = t[0], c = t[1], b = t[ld], d = t[ld + 1];
+            T theta = (a + d) / T(2);
+            T mu = std::sqrt(-(a - d) * (a - d) / T(4) - b * c);
+            T alpha = std::sqrt((std::hypot(theta, mu) + theta) / T(2));
+            r[0] = alpha + (a - theta) / (T(2) * alpha);
+            r[1] = c / (T(2) * alpha);
+            r[ld] = b / (T(2) * alpha);
+            r[ld + 1] = alpha + (d - theta) / (T(2) * alpha);
+        }
+
+        // complex Schur forms are triangular
+        template <class T>
+        inline void sqrtm_block2(const T*, T*, blas_index_t, std::true_type /*is_complex*/)
+        {
+        }
+
+        /**
+         * Square root R of the n x n upper (quasi) triangular column-major
+         * matrix at \em t into \em r: the diagonal blocks are split in two,
+         * never inside a 2 x 2 block, and the off-diagonal block of R solves
+         * the Sylvester equation R11 X + X R22 = T12 (LAPACK trsyl).
+         */
+        template <class T>
+        inline void sqrtm_triangular(const T* t, T* r, std::size_t n, blas_index_t ld)
+        {
+            using is_complex = xtl::is_complex<T>;
+            if (n == 1)
+            {
+                r[0] = sqrtm_diagonal(t[0], is_complex());
+                return;
+            }
+            if (!is_complex::value && n == 2 && t[1] != T(0))
+            {
+                sqrtm_block2(t, r, ld, is_complex());
+                return;
+            }
+
+            std::size_t h = n / 2;
+            if (!is_complex::value && t[h + (h - 1) * static_cast<std::size_t>(ld)] != T(0))
+            {
+                ++h;
+            }
+            std::size_t off = h + h * static_cast<std::size_t>(ld);
+            sqrtm_triangular(t, r, h, ld);
+            sqrtm_triangular(t + off, r + off, n - h, ld);
+
+            T* x = r + h * static_cast<std::size_t>(ld);
+            for (std::size_t j = 0; j < n - h; ++j)
+            {
+                std::copy(t + (h + j) * static_cast<std::size_t>(ld), t + (h + j) * static_cast<std::size_t>(ld) + h,
+                          x + j * static_cast<std::size_t>(ld));
+            }
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("trsyl", h, n - h, 0, layout_type::column_major, 'N', 'N',
+                                         instrument::fma_flops<T>(double(h) * double(n - h) * double(n)));
+            xtl::complex_value_type_t<T> scale(1);
+            int info = cxxlapack::trsyl<blas_index_t>('N', 'N', 1, to_blas_index(h), to_blas_index(n - h),
+                                                      r, ld, r + off, ld, x, ld, scale);
+            if (info < 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "sqrtm: invalid argument to trsyl.");
+            }
+            if (scale != xtl::complex_value_type_t<T>(1))
+            {
+                for (std::size_t j = 0; j < n - h; ++j)
+                {
+                    for (std::size_t i = 0; i < h; ++i)
+                    {
+                        x[i + j * static_cast<std::size_t>(ld)] /= scale;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Compute the principal square root of a square matrix, the matrix R
+     * with R R = A whose eigenvalues have positive real parts.
+     *
+     * A is reduced to Schur form A = Z T Z^H, the square root of T is
+     * computed by a recursive blocking of T that solves one Sylvester
+     * equation (trsyl) per split (Deadman, Higham and Ralha 2013), and
+     * R = Z sqrt(T) Z^H. Real matrices use the real Schur form and get a
+     * real square root, which requires that no eigenvalue is real and
+     * negative.
+     *
+     * @param A square matrix
+     * @return column-major matrix sqrt(A)
+     */
+    template <class E>
+    auto sqrtm(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        assert_nd_square(A);
+        auto decomposition = schur(A);
+        const auto& T = std::get<0>(decomposition);
+        const auto& Z = std::get<1>(decomposition);
+        std::size_t n = T.shape()[0];
+
+        matrix_type R = zeros<value_type>({n, n});
+        matrix_type result = matrix_type::from_shape({n, n});
+        if (n == 0)
+        {
+            return result;
+        }
+        detail::sqrtm_triangular(T.data(), R.data(), n, to_blas_index(n));
+
+        matrix_type ZR = matrix_type::from_shape({n, n});
+        blas::gemm(Z, R, ZR);
+        const auto& Zc = detail::conj_matrix(Z, xtl::is_complex<value_type>());
+        blas::gemm(ZR, Zc, result, false, true);
+        return result;
+    }
+
+    namespace detail
+    {
+        // lower triangle of C := A A^H for the column-major n x k matrix A
+        template <class T>
+        inline void lower_outer_product(blas_index_t n, blas_index_t k, const T* A, T* C, std::false_type /*is_complex*/)
+        {
+            blas_index_t ld = std::max(blas_index_t(1), n);
+            cxxblas::syrk<blas_index_t>(cxxblas::ColMajor, xt::detail::blas_uplo('L'), cxxblas::NoTrans, n, k,
+                                        T(1), A, ld, T(0), C, ld);
+        }
+
+        template <class T>
+        inline void lower_outer_product(blas_index_t n, blas_index_t k, const T* A, T* C, std::true_type /*is_complex*/)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            blas_index_t ld = std::max(blas_index_t(1), n);
+            cxxblas::herk<blas_index_t>(cxxblas::ColMajor, xt::detail::blas_uplo('L'), cxxblas::NoTrans, n, k,
+                                        real_type(1), A, ld, real_type(0), C, ld);
+        }
+
+        /**
+         * Lower triangle of (A + eps I)^{-1/2} = (V S)(V S)^H into the
+         * column-major \em out, from the eigenvectors of A in the columns of
+         * the column-major \em v, which are scaled in place, and the
+         * ascending eigenvalues \em w, with S = diag((w + eps)^{-1/4}). The
+         * eigenvalues with w + eps up to n machine epsilons of the largest
+         * are left out, as pinv does.
+         */
+        template <class T, class R>
+        inline void inv_sqrtm_from_eigh(T* v, const R* w, std::size_t n, R eps, T* out)
+        {
+            R largest = std::max(std::abs(w[0] + eps), std::abs(w[n - 1] + eps));
+            R cutoff = R(n) * std::numeric_limits<R>::epsilon() * largest;
+            std::size_t first = 0;
+            while (first < n && !(w[first] + eps > cutoff))
+            {
+                ++first;
+            }
+            for (std::size_t j = first; j < n; ++j)
+            {
+                T scale = T(R(1) / std::sqrt(std::sqrt(w[j] + eps)));
+                T* col = v + j * n;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    col[i] *= scale;
+                }
+            }
+            XTENSOR_BLAS_INSTRUMENT_CALL(xtl::is_complex<T>::value ? "herk" : "syrk", n, n - first, 0,
+                                         layout_type::column_major, 'L', 'N',
+                                         instrument::fma_flops<T>(0.5 * double(n) * double(n) * double(n - first)));
+            lower_outer_product(to_blas_index(n), to_blas_index(n - first), v + first * n, out, xtl::is_complex<T>());
+        }
+    }
+
+    /**
+     * Compute the inverse square root ``(A + eps I)^{-1/2}`` of a symmetric
+     * (Hermitian) positive semidefinite matrix, as needed by ZCA whitening
+     * and Loewdin's symmetric orthogonalization.
+     *
+     * From A = V diag(w) V^H (syevd, heevd), the columns of V are scaled in
+     * place by (w + eps)^{-1/4}, and the result is the product of the scaled
+     * V with its conjugate transpose: one syrk (herk), half the flops of the
+     * gemm of V diag((w + eps)^{-1/2}) with V^H and without its temporary.
+     * Eigenvalues with w + eps negligible against the largest are left out,
+     * which gives the pseudo-inverse square root of a singular matrix.
+     *
+     * @param A symmetric or Hermitian matrix
+     * @param eps regularization added to the eigenvalues
+     * @param uplo 'L' or 'U', the triangle of \em A that is read
+     * @return column-major matrix (A + eps I)^{-1/2}
+     */
+    template <class E>
+    auto inv_sqrtm_sym(const xexpression<E>& A, double eps = 0., char uplo = 'L')
+    {
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        assert_nd_square(A);
+        matrix_type V = A.derived_cast();
+        auto w = eigh_inplace(V, uplo);
+        std::size_t n = V.shape()[0];
+        matrix_type result = matrix_type::from_shape({n, n});
+        if (n == 0)
+        {
+            return result;
+        }
+        detail::inv_sqrtm_from_eigh(V.data(), w.data(), n, real_type(eps), result.data());
+        detail::mirror_triangle(result, 'L', xtl::is_complex<value_type>::value);
+        return result;
+    }
+
+    /**
+     * Compute the inverse square roots of a stack of symmetric (Hermitian)
+     * positive semidefinite matrices, see inv_sqrtm_sym. Each thread
+     * reuses its column-major buffers for all its matrices, and the loop
+     * over the stack is parallel with BLAS pinned to one thread when
+     * XTENSOR_USE_OPENMP is defined.
+     *
+     * @param A xexpression of shape (..., n, n)
+     * @param eps regularization added to the eigenvalues
+     * @param uplo 'L' or 'U', the triangle of the matrices that is read
+     * @return row-major array of shape (..., n, n)
+     */
+    template <class E>
+    auto batch_inv_sqrtm_sym(const xexpression<E>& A, double eps = 0., char uplo = 'L')
+    {
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& dA = A.derived_cast();
+        detail::check_batch_square(dA, "batch_inv_sqrtm_sym");
+
+        xarray<value_type, layout_type::row_major> result = dA;
+        std::size_t n = result.shape()[result.dimension() - 1];
+        std::size_t batch_size = n == 0 ? 0 : result.size() / (n * n);
+        value_type* data = result.data();
+
+        int failed = 0;
+#if defined(XTENSOR_USE_OPENMP)
+        blas::scoped_num_threads guard(1);
+        #pragma omp parallel reduction(+:failed)
+#endif
+        {
+#if defined(XTENSOR_USE_OPENMP)
+            blas::scoped_num_threads worker_guard(1);
+#endif
+            matrix_type M = matrix_type::from_shape({n, n});
+            matrix_type R = matrix_type::from_shape({n, n});
+            auto w = xtensor<real_type, 1, layout_type::column_major>::from_shape({n});
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp for schedule(static)
+#endif
+            for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+            {
+                value_type* a = data + static_cast<std::size_t>(p) * n * n;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    for (std::size_t j = 0; j < n; ++j)
+                    {
+                        M(i, j) = a[i * n + j];
+                    }
+                }
+                if (detail::call_evd(M, uplo, w, xtl::is_complex<value_type>()) != 0)
+                {
+                    ++failed;
+                    continue;
+                }
+                detail::inv_sqrtm_from_eigh(M.data(), w.data(), n, real_type(eps), R.data());
+                detail::mirror_triangle(R, 'L', xtl::is_complex<value_type>::value);
+                detail::store_row_major(R, a);
+            }
+        }
+
+        if (failed != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_inv_sqrtm_sym: eigenvalue computation did not converge.");
+        }
+        return result;
+    }
+
+    /// Whitening transform computed by whiten
+    enum class whitening
+    {
+        zca,      ///< W = C^{-1/2}: the whitened data closest to the centered data
+        cholesky  ///< W = L^{-H} with C = L L^H: one Cholesky factorization and a triangular solve
+    };
+
+    /**
+     * Whiten the observations in the rows of \em X: returns (Z, W, mean)
+     * with Z = (X - mean) W, of identity sample covariance. W is computed
+     * from the covariance C = (X - mean)^H (X - mean) / (N - 1), formed with
+     * one syrk (herk) on the centered copy of \em X, and is
+     * (C + eps I)^{-1/2} for whitening::zca (see inv_sqrtm_sym) or the
+     * upper triangular L^{-H} of the Cholesky factor of C + eps I for
+     * whitening::cholesky, which needs no eigendecomposition: Z is then one
+     * triangular solve (trsm) on the centered data.
+     *
+     * @param X matrix of N x d elements, N >= 2 observations by rows
+     * @param eps regularization added to the diagonal of the covariance
+     * @param method the whitening transform
+     * @return tuple (Z, W, mean) of the column-major N x d whitened data,
+     *         the column-major d x d transform and the d column means
+     */
+    template <class E>
+    auto whiten(const xexpression<E>& X, double eps = 0., whitening method = whitening::zca)
+    {
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using is_complex = xtl::is_complex<value_type>;
+
+        const auto& dX = X.derived_cast();
+        if (dX.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "whiten: expected a matrix of observations by rows.");
+        }
+        std::size_t N = dX.shape()[0];
+        std::size_t d = dX.shape()[1];
+        if (N < 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "whiten: at least two observations are needed.");
+        }
+
+        matrix_type Z = dX;
+        xtensor<value_type, 1> mean = xtensor<value_type, 1>::from_shape({d});
+        for (std::size_t j = 0; j < d; ++j)
+        {
+            value_type* col = Z.data() + j * N;
+            value_type sum = std::accumulate(col, col + N, value_type(0));
+            mean(j) = sum / real_type(N);
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                col[i] -= mean(j);
+            }
+        }
+
+        matrix_type C = matrix_type::from_shape({d, d});
+        C.fill(value_type(0));
+        detail::rank_k_update('L', to_blas_index(d), to_blas_index(N), Z.data(), to_blas_index(N), C.data(),
+                              std::max(blas_index_t(1), to_blas_index(d)), is_complex());
+        real_type scale = real_type(1) / real_type(N - 1);
+        for (std::size_t j = 0; j < d; ++j)
+        {
+            for (std::size_t i = j; i < d; ++i)
+            {
+                C(i, j) *= scale;
+            }
+        }
+
+        matrix_type W = matrix_type::from_shape({d, d});
+        if (d == 0)
+        {
+            return std::make_tuple(std::move(Z), std::move(W), std::move(mean));
+        }
+        if (method == whitening::zca)
+        {
+            auto w = eigh_inplace(C, 'L');
+            detail::inv_sqrtm_from_eigh(C.data(), w.data(), d, real_type(eps), W.data());
+            detail::mirror_triangle(W, 'L', is_complex::value);
+            matrix_type ZW = matrix_type::from_shape({N, d});
+            blas::gemm(Z, W, ZW);
+            return std::make_tuple(std::move(ZW), std::move(W), std::move(mean));
+        }
+
+        for (std::size_t j = 0; j < d; ++j)
+        {
+            C(j, j) += value_type(eps);
+        }
+        if (lapack::potr(C, 'L') != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "whiten: the covariance is not positive definite, pass a positive eps.");
+        }
+        // Z := Z L^{-H}
+        cxxblas::trsm<blas_index_t>(cxxblas::StorageOrder::ColMajor, cxxblas::Side::Right,
+                                    cxxblas::StorageUpLo::Lower, cxxblas::Transpose::ConjTrans, cxxblas::Diag::NonUnit,
+                                    to_blas_index(N), to_blas_index(d), value_type(1), C.data(), to_blas_index(d),
+                                    Z.data(), to_blas_index(N));
+        lapack::trtri(C, 'L', 'N');
+        for (std::size_t j = 0; j < d; ++j)
+        {
+            for (std::size_t i = 0; i < d; ++i)
+            {
+                W(i, j) = i <= j ? detail::conj_value(C(j, i)) : value_type(0);
+            }
+        }
+        return std::make_tuple(std::move(Z), std::move(W), std::move(mean));
+    }
+
+    /***********************
+     * polar decomposition *
+     ***********************/
+
+    namespace detail
+    {
+        /**
+         * Cyclic Jacobi iteration on the symmetric 4 x 4 matrix \em a, which
+         * is left with its eigenvalues on the diagonal; the columns of \em v
+         * are the eigenvectors.
+         */
+        template <class T>
+        inline void jacobi_eigen4(T (&a)[4][4], T (&v)[4][4])
+        {
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                for (std::size_t j = 0; j < 4; ++j)
+                {
+                    v[i][j] = T(i == j);
+                }
+            }
+            const T eps = std::numeric_limits<T>::epsilon();
+            for (std::size_t sweep = 0; sweep < 32; ++sweep)
+            {
+                T off = 0, total = 0;
+                for (std::size_t i = 0; i < 4; ++i)
+                {
+                    total += a[i][i] * a[i][i];
+                    for (std::size_t j = i + 1; j < 4; ++j)
+                    {
+                        off += a[i][j] * a[i][j];
+                    }
+                }
+                if (off <= eps * eps * (total + off))
+                {
+                    return;
+                }
+                for (std::size_t p = 0; p < 3; ++p)
+                {
+                    for (std::size_t q = p + 1; q < 4; ++q)
+                    {
+                        if (a[p][q] == T(0))
+                        {
+                            continue;
+                        }
+                        // rotation in the (p, q) plane that zeroes a[p][q]
+                        T theta = (a[q][q] - a[p][p]) / (T(2) * a[p][q]);
+                        T t = T(1) / (std::abs(theta) + std::hypot(theta, T(1)));
+                        t = theta < T(0) ? -t : t;
+                        T c = T(1) / std::hypot(t, T(1));
+                        T s = t * c;
+                        for (std::size_t k = 0; k < 4; ++k)
+                        {
+                            T akp = a[k][p], akq = a[k][q];
+                            a[k][p] = c * akp - s * akq;
+                            a[k][q] = s * akp + c * akq;
+                        }
+                        for (std::size_t k = 0; k < 4; ++k)
+                        {
+                            T apk = a[p][k], aqk = a[q][k];
+                            a[p][k] = c * apk - s * aqk;
+                            a[q][k] = s * apk + c * aqk;
+                        }
+                        for (std::size_t k = 0; k < 4; ++k)
+                        {
+                            T vkp = v[k][p], vkq = v[k][q];
+                            v[k][p] = c * vkp - s * vkq;
+                            v[k][q] = s * vkp + c * vkq;
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * Orthogonal polar factor of the real 3 x 3 column-major matrix \em a,
+         * written to \em u, in closed form: the rotation R maximizing
+         * trace(R^T a) is given by the unit quaternion q maximizing q^T N q
+         * for a symmetric 4 x 4 matrix N built from a (Horn 1987), so it is
+         * the dominant eigenvector of N. The polar factor is R for det(a) >= 0
+         * and -R(-a) otherwise; with \em proper, the rotation R is returned
+         * whatever the sign of the determinant.
+         */
+        template <class T>
+        inline void polar3(const T* a, T* u, bool proper)
+        {
+            auto at = [a](std::size_t i, std::size_t j) { return a[i + 3 * j]; };
+            T determinant = at(0, 0) * (at(1, 1) * at(2, 2) - at(2, 1) * at(1, 2))
+                            - at(0, 1) * (at(1, 0) * at(2, 2) - at(2, 0) * at(1, 2))
+                            + at(0, 2) * (at(1, 0) * at(2, 1) - at(2, 0) * at(1, 1));
+            T sign = (!proper && determinant < T(0)) ? T(-1) : T(1);
+            T s[3][3];
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                for (std::size_t j = 0; j < 3; ++j)
+                {
+                    s[i][j] = sign * at(i, j);
+                }
+            }
+
+            T n[4][4] = {{s[0][0] + s[1][1] + s[2][2], s[2][1] - s[1][2], s[0][2] - s[2][0], s[1][0] - s[0][1]},
+                         {s[2][1] - s[1][2], s[0][0] - s[1][1] - s[2][2], s[0][1] + s[1][0], s[0][2] + s[2][0]},
+                         {s[0][2] - s[2][0], s[0][1] + s[1][0], s[1][1] - s[0][0] - s[2][2], s[1][2] + s[2][1]},
+                         {s[1][0] - s[0][1], s[0][2] + s[2][0], s[1][2] + s[2][1], s[2][2] - s[0][0] - s[1][1]}};
+            T v[4][4];
+            jacobi_eigen4(n, v);
+            std::size_t k = 0;
+            for (std::size_t i = 1; i < 4; ++i)
+            {
+                k = n[i][i] > n[k][k] ? i : k;
+            }
+            T w = v[0][k], x = v[1][k], y = v[2][k], z = v[3][k];
+            T scale = T(2) / (w * w + x * x + y * y + z * z);
+            T r[3][3] = {{T(1) - scale * (y * y + z * z), scale * (x * y - w * z), scale * (x * z + w * y)},
+                         {scale * (x * y + w * z), T(1) - scale * (x * x + z * z), scale * (y * z - w * x)},
+                         {scale * (x * z - w * y), scale * (y * z + w * x), T(1) - scale * (x * x + y * y)}};
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                for (std::size_t j = 0; j < 3; ++j)
+                {
+                    u[i + 3 * j] = sign * r[i][j];
+                }
+            }
+        }
+
+        /**
+         * Overwrites the column-major m x n matrix \em X, m >= n, with its
+         * unitary polar factor by the QR-based dynamically weighted Halley
+         * iteration (QDWH) of Nakatsukasa, Bai and Gygi (2010). The weights
+         * come from a lower bound l on the smallest singular value of the
+         * scaled X, estimated from the condition number of its R factor;
+         * with double precision at most 6 iterations are needed for any
+         * condition number below 1e16. An iteration is a QR factorization of
+         * [sqrt(c) X; I] and one GEMM while c > 100, and a Cholesky
+         * factorization of I + c X^H X, two triangular solves and one GEMM
+         * otherwise, all level 3.
+         */
+        template <class M>
+        inline void qdwh(M& X)
+        {
+            using value_type = typename M::value_type;
+            using real_type = xtl::complex_value_type_t<value_type>;
+            std::size_t m = X.shape()[0];
+            std::size_t n = X.shape()[1];
+            const double eps = double(std::numeric_limits<real_type>::epsilon());
+
+            double alpha = double(linalg::norm(X, normorder::frob));
+            if (alpha == 0.)
+            {
+                X = xt::eye<value_type>({m, n});
+                return;
+            }
+            X /= value_type(alpha);
+
+            // sigma_min(X) >= 1 / (sqrt(n) ||R^-1||_1) for X = Q R
+            double l;
+            {
+                M QR = X;
+                std::array<std::size_t, 1> tau_shape = {n};
+                xtensor<value_type, 1, layout_type::column_major> tau(tau_shape);
+                if (lapack::geqrf(QR, tau) != 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "polar: QR decomposition failed.");
+                }
+                M R = xt::triu(xt::view(QR, range(0, n), all()));
+                real_type rcond = 0;
+                lapack::trcon(R, '1', 'U', 'N', rcond);
+                l = double(rcond) * matrix_norm1(R) / std::sqrt(double(n));
+            }
+            l = std::min(std::max(l, eps), 1.);
+
+            std::array<std::size_t, 2> stacked_shape = {m + n, n};
+            std::array<std::size_t, 2> square_shape = {n, n};
+            M W(stacked_shape);
+            M Z(square_shape);
+            M Y = M::from_shape(X.shape());
+            for (std::size_t iteration = 0; iteration < 20; ++iteration)
+            {
+                double l2 = l * l;
+                double d = std::cbrt(4. * (1. - l2) / (l2 * l2));
+                double a = std::sqrt(1. + d) + 0.5 * std::sqrt(8. - 4. * d + 8. * (2. - l2) / (l2 * std::sqrt(1. + d)));
+                double b = (a - 1.) * (a - 1.) / 4.;
+                double c = a + b - 1.;
+                l = std::min(l * (a + b * l2) / (1. + c * l2), 1.);
+
+                bool cholesky = false;
+                if (c <= 100.)
+                {
+                    // Z = I + c X^H X = W^H W, Y = X W^-1 W^-H
+                    Z = xt::eye<value_type>(n);
+                    XTENSOR_BLAS_INSTRUMENT_CALL("qdwh", m, n, n, layout_type::column_major, 'P', 0,
+                                                 instrument::fma_flops<value_type>(2. * double(m) * double(n) * double(n)));
+                    cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::ColMajor, cxxblas::Transpose::ConjTrans,
+                                                cxxblas::Transpose::NoTrans, to_blas_index(n), to_blas_index(n),
+                                                to_blas_index(m), value_type(c), X.data(), to_blas_index(m), X.data(),
+                                                to_blas_index(m), value_type(1), Z.data(), to_blas_index(n));
+                    cholesky = lapack::potr(Z, 'U') == 0;
+                    if (cholesky)
+                    {
+                        Y = X;
+                        for (auto trans : {cxxblas::Transpose::NoTrans, cxxblas::Transpose::ConjTrans})
+                        {
+                            cxxblas::trsm<blas_index_t>(cxxblas::StorageOrder::ColMajor, cxxblas::Side::Right,
+                                                        cxxblas::StorageUpLo::Upper, trans, cxxblas::Diag::NonUnit,
+                                                        to_blas_index(m), to_blas_index(n), value_type(1), Z.data(),
+                                                        to_blas_index(n), Y.data(), to_blas_index(m));
+                        }
+                        Y = value_type(b / c) * X + value_type(a - b / c) * Y;
+                    }
+                }
+                if (!cholesky)
+                {
+                    // [sqrt(c) X; I] = [Q1; Q2] R, Y = b / c X + (a - b / c) / sqrt(c) Q1 Q2^H
+                    xt::view(W, range(0, m), all()) = value_type(std::sqrt(c)) * X;
+                    xt::view(W, range(m, m + n), all()) = xt::eye<value_type>(n);
+                    orthonormalize(W);
+                    Y = X;
+                    XTENSOR_BLAS_INSTRUMENT_CALL("qdwh", m, n, n, layout_type::column_major, 'Q', 0,
+                                                 instrument::fma_flops<value_type>(double(m) * double(n) * double(n)));
+                    cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::ColMajor, cxxblas::Transpose::NoTrans,
+                                                cxxblas::Transpose::ConjTrans, to_blas_index(m), to_blas_index(n),
+                                                to_blas_index(n), value_type((a - b / c) / std::sqrt(c)), W.data(),
+                                                to_blas_index(m + n), W.data() + m, to_blas_index(m + n),
+                                                value_type(b / c), Y.data(), to_blas_index(m));
+                }
+
+                std::swap(X, Y);
+                Y -= X;
+                double change = double(linalg::norm(Y, normorder::frob));
+                if (1. - l <= 10. * eps && change <= std::cbrt(5. * eps))
+                {
+                    break;
+                }
+            }
+        }
+
+        template <class M>
+        inline void polar_factor(M& X, std::false_type /*is_complex*/)
+        {
+            if (X.shape()[0] == 3 && X.shape()[1] == 3)
+            {
+                M U = M::from_shape(X.shape());
+                polar3(X.data(), U.data(), false);
+                X = std::move(U);
+            }
+            else
+            {
+                qdwh(X);
+            }
+        }
+
+        template <class M>
+        inline void polar_factor(M& X, std::true_type /*is_complex*/)
+        {
+            qdwh(X);
+        }
+
+        /// Hermitian part (H + H^H) / 2 of the square matrix \em H, in place.
+        template <class M>
+        inline void hermitian_part(M& H)
+        {
+            for (std::size_t j = 0; j < H.shape()[1]; ++j)
+            {
+                H(j, j) = std::real(H(j, j));
+                for (std::size_t i = j + 1; i < H.shape()[0]; ++i)
+                {
+                    auto h = (H(i, j) + conj_value(H(j, i))) / typename M::value_type(2);
+                    H(i, j) = h;
+                    H(j, i) = conj_value(h);
+                }
+            }
+        }
+    }
+
+    /**
+     * Polar decomposition A = U H of an m x n matrix, where U has
+     * orthonormal columns (rows if m < n) and H = U^H A is Hermitian
+     * positive semidefinite of n x n elements.
+     *
+     * The unitary factor of a real 3 x 3 matrix is computed in closed form
+     * from the dominant eigenvector of a 4 x 4 symmetric matrix (quaternion
+     * method). Other matrices go through the QDWH iteration, which needs at
+     * most 6 iterations made of QR or Cholesky factorizations and matrix
+     * products, so that it scales with the level 3 BLAS rather than as a
+     * full SVD. Wide matrices are handled through the polar decomposition
+     * of A^H.
+     *
+     * @param A matrix of m-by-n elements
+     * @return tuple (U, H) of column-major matrices
+     */
+    template <class E>
+    auto polar(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& a = A.derived_cast();
+        if (a.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "polar: input must be a matrix.");
+        }
+        std::size_t m = a.shape()[0];
+        std::size_t n = a.shape()[1];
+
+        matrix_type U;
+        if (m >= n)
+        {
+            U = a;
+            if (n != 0)
+            {
+                detail::polar_factor(U, xtl::is_complex<value_type>());
+            }
+        }
+        else
+        {
+            U = xt::conj(xt::transpose(a));
+            if (m != 0)
+            {
+                detail::polar_factor(U, xtl::is_complex<value_type>());
+            }
+            matrix_type V = xt::conj(xt::transpose(U));
+            U = std::move(V);
+        }
+
+        std::array<std::size_t, 2> shape = {n, n};
+        matrix_type H(shape);
+        matrix_type Ma = a;
+        const auto& Uc = detail::conj_matrix(U, xtl::is_complex<value_type>());
+        blas::gemm(Uc, Ma, H, true, false);
+        detail::hermitian_part(H);
+        return std::make_tuple(std::move(U), std::move(H));
+    }
+
+    namespace detail
+    {
+        template <class M>
+        inline auto procrustes_polar(const M& MtB, bool proper, std::false_type /*is_complex*/)
+        {
+            using value_type = typename M::value_type;
+            std::size_t n = MtB.shape()[0];
+            value_type scale = 0;
+            if (proper && n == 3)
+            {
+                M R = M::from_shape(MtB.shape());
+                polar3(MtB.data(), R.data(), true);
+                for (std::size_t j = 0; j < 3; ++j)
+                {
+                    for (std::size_t i = 0; i < 3; ++i)
+                    {
+                        scale += R(i, j) * MtB(i, j);
+                    }
+                }
+                return std::make_tuple(std::move(R), scale);
+            }
+
+            auto decomposition = polar(MtB);
+            M R = std::move(std::get<0>(decomposition));
+            const M& H = std::get<1>(decomposition);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                scale += H(i, i);
+            }
+            if (proper && n != 0 && det(R) < 0)
+            {
+                // R (I - 2 v v^T), v the eigenvector of the smallest eigenvalue of H
+                auto eig = eigh(H, select_index{0, 0});
+                const auto& v = std::get<1>(eig);
+                std::array<std::size_t, 2> shape = {n, 1};
+                M Rv(shape);
+                blas::gemm(R, v, Rv);
+                blas::gemm(Rv, v, R, false, true, value_type(-2), value_type(1));
+                scale -= value_type(2) * std::get<0>(eig)(0);
+            }
+            return std::make_tuple(std::move(R), scale);
+        }
+
+        template <class M>
+        inline auto procrustes_polar(const M& MtB, bool proper, std::true_type /*is_complex*/)
+        {
+            if (proper)
+            {
+                XTENSOR_THROW(std::runtime_error, "procrustes: proper rotations are only defined for real matrices.");
+            }
+            auto decomposition = polar(MtB);
+            xtl::complex_value_type_t<typename M::value_type> scale = 0;
+            for (std::size_t i = 0; i < MtB.shape()[0]; ++i)
+            {
+                scale += std::real(std::get<1>(decomposition)(i, i));
+            }
+            return std::make_tuple(std::move(std::get<0>(decomposition)), scale);
+        }
+    }
+
+    /**
+     * Orthogonal Procrustes problem: the matrix R with orthonormal columns
+     * minimizing ||A R - B||_F, the unitary polar factor of A^H B, and the
+     * sum of the singular values of A^H B.
+     *
+     * With \em proper, R is constrained to a rotation, det(R) = 1 (the
+     * Kabsch algorithm), for real matrices. Point sets in 3 dimensions,
+     * A and B of m x 3 elements, take the closed form quaternion path.
+     *
+     * @param A matrix of m-by-n elements
+     * @param B matrix of m-by-n elements
+     * @param proper constrain R to a rotation
+     * @return tuple (R, scale) with R a column-major n-by-n matrix
+     */
+    template <class E, class F>
+    auto procrustes(const xexpression<E>& A, const xexpression<F>& B, bool proper = false)
+    {
+        using value_type = std::common_type_t<typename E::value_type, typename F::value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& a = A.derived_cast();
+        const auto& b = B.derived_cast();
+        if (a.dimension() != 2 || b.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "procrustes: inputs must be matrices.");
+        }
+        if (a.shape()[0] != b.shape()[0] || a.shape()[1] != b.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "procrustes: shape mismatch.");
+        }
+
+        std::size_t n = a.shape()[1];
+        std::array<std::size_t, 2> shape = {n, n};
+        matrix_type Ma = a;
+        matrix_type Mb = b;
+        matrix_type M(shape);
+        const auto& Ac = detail::conj_matrix(Ma, xtl::is_complex<value_type>());
+        blas::gemm(Ac, Mb, M, true, false);
+
+        return detail::procrustes_polar(M, proper, xtl::is_complex<value_type>());
+    }
+
+    /**
+     * Schur decomposition A = Z T Z^H of a square matrix, as returned by
+     * schur_factor, for Sylvester and Lyapunov equations with the
+     * Bartels-Stewart method.
+     *
+     * The decomposition is computed once (gees). A solve then transforms
+     * the right hand side to the Schur bases, solves the triangular
+     * equation with trsyl and transforms back, in O(n^3) with four matrix
+     * products, instead of the O(n^6) of the Kronecker product form of the
+     * equation. Real matrices use the real Schur form.
+     */
+    template <class T>
+    class schur_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        template <class E>
+        explicit schur_factorization(const xexpression<E>& A);
+
+        template <class E>
+        matrix_type solve_sylvester(const schur_factorization& B, const xexpression<E>& C) const;
+
+        template <class E>
+        matrix_type solve_lyapunov(const xexpression<E>& Q) const;
+
+        const matrix_type& matrix() const noexcept;
+        const matrix_type& vectors() const noexcept;
+
+    private:
+
+        template <class E>
+        matrix_type solve(const schur_factorization& B, const E& C, char tranb) const;
+
+        matrix_type m_t;
+        matrix_type m_z;
+    };
+
+    template <class T>
+    template <class E>
+    inline schur_factorization<T>::schur_factorization(const xexpression<E>& A)
+        : m_t(A.derived_cast())
+    {
+        assert_nd_square(A);
+        auto res = detail::schur_impl(m_t, schur_sort::none, true, xtl::is_complex<value_type>());
+        m_z = std::move(std::get<0>(res));
+    }
+
+    /**
+     * Solves T Y + Y op(S) = Z^H C V for the Schur forms A = Z T Z^H and
+     * B = V S V^H, and returns X = Z Y V^H.
+     */
+    template <class T>
+    template <class E>
+    inline auto schur_factorization<T>::solve(const schur_factorization& B, const E& C, char tranb) const
+        -> matrix_type
+    {
+        std::size_t m = m_t.shape()[0];
+        std::size_t n = B.m_t.shape()[0];
+        if (C.dimension() != 2 || C.shape()[0] != m || C.shape()[1] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "solve_sylvester: C must have the shape (rows of A, rows of B).");
+        }
+
+        matrix_type X = matrix_type::from_shape({m, n});
+        if (m == 0 || n == 0)
+        {
+            return X;
+        }
+
+        using is_complex = xtl::is_complex<value_type>;
+        const auto& Zc = detail::conj_matrix(m_z, is_complex());
+        const auto& Vc = detail::conj_matrix(B.m_z, is_complex());
+
+        matrix_type c = C;
+        matrix_type tmp = matrix_type::from_shape({m, n});
+        blas::gemm(Zc, c, tmp, true);
+        blas::gemm(tmp, B.m_z, X);
+
+        real_type scale(1);
+        int info = lapack::trsyl(m_t, B.m_t, X, 'N', tranb, 1, scale);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "solve_sylvester: A and -B have common or close eigenvalues.");
+        }
+        if (scale != real_type(1))
+        {
+            X /= value_type(scale);
+        }
+
+        blas::gemm(m_z, X, tmp);
+        blas::gemm(tmp, Vc, X, false, true);
+        return X;
+    }
+
+    /**
+     * Solve the Sylvester equation A X + X B = C.
+     * @param B Schur factorization of the n x n matrix B
+     * @param C m x n right hand side
+     * @return X, column-major
+     */
+    template <class T>
+    template <class E>
+    inline auto schur_factorization<T>::solve_sylvester(const schur_factorization& B, const xexpression<E>& C) const
+        -> matrix_type
+    {
+        return solve(B, C.derived_cast(), 'N');
+    }
+
+    /**
+     * Solve the continuous Lyapunov equation A X + X A^H = Q, with the
+     * Schur decomposition of A alone.
+     * @param Q n x n right hand side
+     * @return X, column-major
+     */
+    template <class T>
+    template <class E>
+    inline auto schur_factorization<T>::solve_lyapunov(const xexpression<E>& Q) const -> matrix_type
+    {
+        return solve(*this, Q.derived_cast(), xtl::is_complex<value_type>::value ? 'C' : 'T');
+    }
+
+    /**
+     * @return the (quasi) upper triangular Schur form T
+     */
+    template <class T>
+    inline auto schur_factorization<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_t;
+    }
+
+    /**
+     * @return the unitary Schur vectors Z
+     */
+    template <class T>
+    inline auto schur_factorization<T>::vectors() const noexcept -> const matrix_type&
+    {
+        return m_z;
+    }
+
+    /**
+     * Compute the Schur decomposition of \em A once, for repeated Sylvester
+     * and Lyapunov solves.
+     * @param A square matrix
+     * @return schur_factorization of \em A
+     */
+    template <class E>
+    inline auto schur_factor(const xexpression<E>& A)
+    {
+        return schur_factorization<typename E::value_type>(A);
+    }
+
+    /**
+     * Solve the Sylvester equation A X + X B = C with the Bartels-Stewart
+     * method. To solve for several B or C with the same A, use
+     * schur_factor(A).solve_sylvester.
+     *
+     * @param A m x m matrix
+     * @param B n x n matrix
+     * @param C m x n right hand side
+     * @return X, column-major
+     */
+    template <class E1, class E2, class E3>
+    auto solve_sylvester(const xexpression<E1>& A, const xexpression<E2>& B, const xexpression<E3>& C)
+    {
+        using value_type = typename E1::value_type;
+        return schur_factor(A).solve_sylvester(schur_factorization<value_type>(B), C);
+    }
+
+    /**
+     * Solve the continuous Lyapunov equation A X + X A^H = Q with the
+     * Bartels-Stewart method. To solve for several Q with the same A, use
+     * schur_factor(A).solve_lyapunov.
+     *
+     * @param A n x n matrix
+     * @param Q n x n right hand side
+     * @return X, column-major
+     */
+    template <class E1, class E2>
+    auto solve_lyapunov(const xexpression<E1>& A, const xexpression<E2>& Q)
+    {
+        return schur_factor(A).solve_lyapunov(Q);
+    }
+
+    namespace detail
+    {
+        /**
+         * Overwrites \em x with the solution of (H - shift I) y = x for the
+         * upper Hessenberg part of \em H, by Gaussian elimination with
+         * pivoting between adjacent rows, in O(n^2) per right hand side.
+         */
+        template <class M, class X>
+        inline void hessenberg_shifted_solve(const M& H, typename M::value_type shift, X& x)
+        {
+            using value_type = typename M::value_type;
+            std::size_t n = H.shape()[0];
+            std::size_t nrhs = x.dimension() > 1 ? x.shape()[1] : 1;
+            value_type* b = x.data();
+
+            // the reflectors below the subdiagonal are never read
+            M W = H;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                W(i, i) -= shift;
+            }
+            for (std::size_t k = 0; k + 1 < n; ++k)
+            {
+                if (std::abs(W(k + 1, k)) > std::abs(W(k, k)))
+                {
+                    for (std::size_t j = k; j < n; ++j)
+                    {
+                        std::swap(W(k, j), W(k + 1, j));
+                    }
+                    for (std::size_t c = 0; c < nrhs; ++c)
+                    {
+                        std::swap(b[k + c * n], b[k + 1 + c * n]);
+                    }
+                }
+                if (W(k, k) == value_type(0))
+                {
+                    continue;
+                }
+                value_type l = W(k + 1, k) / W(k, k);
+                for (std::size_t j = k + 1; j < n; ++j)
+                {
+                    W(k + 1, j) -= l * W(k, j);
+                }
+                for (std::size_t c = 0; c < nrhs; ++c)
+                {
+                    b[k + 1 + c * n] -= l * b[k + c * n];
+                }
+            }
+            for (std::size_t j = n; j-- > 0;)
+            {
+                if (W(j, j) == value_type(0))
+                {
+                    XTENSOR_THROW(std::runtime_error, "solve_shifted: A - shift I is singular.");
+                }
+                for (std::size_t c = 0; c < nrhs; ++c)
+                {
+                    value_type* bc = b + c * n;
+                    bc[j] /= W(j, j);
+                    for (std::size_t i = 0; i < j; ++i)
+                    {
+                        bc[i] -= W(i, j) * bc[j];
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Reduction A = Q H Q^H of a square matrix to upper Hessenberg form, as
+     * returned by hessenberg.
+     *
+     * The factorization keeps the compact form of gehrd: H in the upper
+     * Hessenberg part of matrix(), and Q as elementary reflectors below the
+     * subdiagonal and in tau(). After the O(n^3) reduction, each shifted
+     * system (A - s I) x = b is solved in O(n^2): two reflector
+     * applications and an elimination along the single subdiagonal of H.
+     */
+    template <class T>
+    class hessenberg_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1, layout_type::column_major>;
+
+        template <class E>
+        explicit hessenberg_factorization(const xexpression<E>& A);
+
+        template <class E>
+        auto solve_shifted(const value_type& shift, const xexpression<E>& b) const;
+
+        matrix_type h() const;
+        matrix_type q() const;
+
+        const matrix_type& matrix() const noexcept;
+        const vector_type& tau() const noexcept;
+
+    private:
+
+        matrix_type m_a;
+        vector_type m_tau;
+    };
+
+    template <class T>
+    template <class E>
+    inline hessenberg_factorization<T>::hessenberg_factorization(const xexpression<E>& A)
+        : m_a(A.derived_cast())
+    {
+        assert_nd_square(A);
+        std::size_t n = m_a.shape()[0];
+        m_tau = vector_type::from_shape({n > 0 ? n - 1 : 0});
+        if (n > 0)
+        {
+            lapack::gehrd(m_a, m_tau);
+        }
+    }
+
+    /**
+     * Solve (A - shift I) x = b.
+     * @param shift scalar subtracted from the diagonal of A
+     * @param b right hand side, a vector or a matrix of one column each
+     * @return x, column-major
+     */
+    template <class T>
+    template <class E>
+    inline auto hessenberg_factorization<T>::solve_shifted(const value_type& shift, const xexpression<E>& b) const
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        if (x.dimension() == 0 || x.dimension() > 2 || x.shape()[0] != m_a.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "solve_shifted: shape mismatch.");
+        }
+        if (x.size() == 0)
+        {
+            return x;
+        }
+        lapack::ormhr(m_a, m_tau, x, 'L', 'T');
+        detail::hessenberg_shifted_solve(m_a, shift, x);
+        lapack::ormhr(m_a, m_tau, x, 'L', 'N');
+        return x;
+    }
+
+    /**
+     * @return the upper Hessenberg matrix H
+     */
+    template <class T>
+    inline auto hessenberg_factorization<T>::h() const -> matrix_type
+    {
+        matrix_type H = m_a;
+        std::size_t n = H.shape()[0];
+        for (std::size_t j = 0; j + 2 < n; ++j)
+        {
+            std::fill(&H(j + 2, j), &H(0, j + 1), value_type(0));
+        }
+        return H;
+    }
+
+    /**
+     * @return the unitary matrix Q, formed by applying the reflectors to the
+     *         identity
+     */
+    template <class T>
+    inline auto hessenberg_factorization<T>::q() const -> matrix_type
+    {
+        std::size_t n = m_a.shape()[0];
+        matrix_type Q = xt::eye<value_type>(n);
+        if (n > 0)
+        {
+            lapack::ormhr(m_a, m_tau, Q, 'L', 'N');
+        }
+        return Q;
+    }
+
+    /**
+     * @return the compact gehrd form: H on and above the subdiagonal, the
+     *         reflectors of Q below it
+     */
+    template <class T>
+    inline auto hessenberg_factorization<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_a;
+    }
+
+    /**
+     * @return the n - 1 scalar factors of the reflectors of Q
+     */
+    template <class T>
+    inline auto hessenberg_factorization<T>::tau() const noexcept -> const vector_type&
+    {
+        return m_tau;
+    }
+
+    /**
+     * Reduce a square matrix to upper Hessenberg form A = Q H Q^H with
+     * LAPACK gehrd, for repeated shifted solves or custom eigenvalue
+     * iterations.
+     * @param A square matrix
+     * @return hessenberg_factorization of \em A
+     */
+    template <class E>
+    inline auto hessenberg(const xexpression<E>& A)
+    {
+        return hessenberg_factorization<typename E::value_type>(A);
+    }
+
+    /**
+     * Reduction A = Q T Q^H of a symmetric (Hermitian) matrix to real
+     * symmetric tridiagonal form, as returned by tridiagonalize.
+     *
+     * The factorization keeps the compact form of sytrd (hetrd): Q as
+     * elementary reflectors in the \em UPLO triangle of matrix() and in
+     * tau(), and T as its real diagonal and off-diagonal. After the O(n^3)
+     * reduction, each shifted system (A - s I) x = b is solved in O(n^2):
+     * two reflector applications and a tridiagonal solve (gtsv).
+     */
+    template <class T>
+    class tridiagonal_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1, layout_type::column_major>;
+        using real_vector_type = xtensor<real_type, 1, layout_type::column_major>;
+
+        template <class E>
+        explicit tridiagonal_factorization(const xexpression<E>& A, char UPLO = 'L');
+
+        template <class E>
+        auto solve_shifted(const value_type& shift, const xexpression<E>& b) const;
+
+        matrix_type q() const;
+
+        const real_vector_type& diagonal() const noexcept;
+        const real_vector_type& off_diagonal() const noexcept;
+        const matrix_type& matrix() const noexcept;
+        const vector_type& tau() const noexcept;
+        char uplo() const noexcept;
+
+    private:
+
+        matrix_type m_a;
+        real_vector_type m_d;
+        real_vector_type m_e;
+        vector_type m_tau;
+        char m_uplo;
+    };
+
+    template <class T>
+    template <class E>
+    inline tridiagonal_factorization<T>::tridiagonal_factorization(const xexpression<E>& A, char UPLO)
+        : m_a(A.derived_cast()), m_uplo(UPLO)
+    {
+        assert_nd_square(A);
+        std::size_t n = m_a.shape()[0];
+        std::size_t ne = n > 0 ? n - 1 : 0;
+        m_d = real_vector_type::from_shape({n});
+        m_e = real_vector_type::from_shape({ne});
+        m_tau = vector_type::from_shape({ne});
+        if (n > 0)
+        {
+            lapack::sytrd(m_a, m_d, m_e, m_tau, m_uplo);
+        }
+    }
+
+    /**
+     * Solve (A - shift I) x = b.
+     * @param shift scalar subtracted from the diagonal of A
+     * @param b right hand side, a vector or a matrix of one column each
+     * @return x, column-major
+     */
+    template <class T>
+    template <class E>
+    inline auto tridiagonal_factorization<T>::solve_shifted(const value_type& shift, const xexpression<E>& b) const
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        std::size_t n = m_d.size();
+        if (x.dimension() == 0 || x.dimension() > 2 || x.shape()[0] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "solve_shifted: shape mismatch.");
+        }
+        if (x.size() == 0)
+        {
+            return x;
+        }
+        lapack::ormtr(m_a, m_tau, x, 'L', m_uplo, 'T');
+
+        // gtsv overwrites the diagonals, which the same factor serves for every shift
+        vector_type d = m_d - shift;
+        vector_type dl = m_e;
+        vector_type du = m_e;
+        int info = lapack::gtsv(dl, d, du, x);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "solve_shifted: A - shift I is singular.");
+        }
+
+        lapack::ormtr(m_a, m_tau, x, 'L', m_uplo, 'N');
+        return x;
+    }
+
+    /**
+     * @return the unitary matrix Q, formed by applying the reflectors to the
+     *         identity
+     */
+    template <class T>
+    inline auto tridiagonal_factorization<T>::q() const -> matrix_type
+    {
+        std::size_t n = m_a.shape()[0];
+        matrix_type Q = xt::eye<value_type>(n);
+        if (n > 0)
+        {
+            lapack::ormtr(m_a, m_tau, Q, 'L', m_uplo, 'N');
+        }
+        return Q;
+    }
+
+    /**
+     * @return the n diagonal elements of T
+     */
+    template <class T>
+    inline auto tridiagonal_factorization<T>::diagonal() const noexcept -> const real_vector_type&
+    {
+        return m_d;
+    }
+
+    /**
+     * @return the n - 1 off-diagonal elements of T
+     */
+    template <class T>
+    inline auto tridiagonal_factorization<T>::off_diagonal() const noexcept -> const real_vector_type&
+    {
+        return m_e;
+    }
+
+    /**
+     * @return the compact sytrd form, with the reflectors of Q in the
+     *         \em UPLO triangle
+     */
+    template <class T>
+    inline auto tridiagonal_factorization<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_a;
+    }
+
+    /**
+     * @return the n - 1 scalar factors of the reflectors of Q
+     */
+    template <class T>
+    inline auto tridiagonal_factorization<T>::tau() const noexcept -> const vector_type&
+    {
+        return m_tau;
+    }
+
+    template <class T>
+    inline char tridiagonal_factorization<T>::uplo() const noexcept
+    {
+        return m_uplo;
+    }
+
+    /**
+     * Reduce a symmetric (Hermitian) matrix to real symmetric tridiagonal
+     * form A = Q T Q^H with LAPACK sytrd (hetrd), for repeated shifted
+     * solves or custom eigenvalue iterations.
+     * @param A symmetric (Hermitian) matrix
+     * @param UPLO triangle of \em A that is read, 'L' or 'U'
+     * @return tridiagonal_factorization of \em A
+     */
+    template <class E>
+    inline auto tridiagonalize(const xexpression<E>& A, char UPLO = 'L')
+    {
+        return tridiagonal_factorization<typename E::value_type>(A, UPLO);
+    }
+
+    namespace detail
+    {
+        /**
+         * Computes exp(t A') B for A' = A - mu I, where \em product(X)
+         * returns A' X and \em norm1 is the 1-norm of A', with the truncated
+         * Taylor series of Al-Mohy and Higham (2011): exp(t A) B =
+         * exp(t mu) (T_m(t A' / s))^s B, with the degree m and the number of
+         * steps s that minimize the number of products m s.
+         */
+        template <class V, class P, class F>
+        inline auto expm_multiply_impl(const P& product, double norm1, const V& mu, const F& b, double t)
+        {
+            using real_type = xtl::complex_value_type_t<V>;
+            using result_type = xarray<V, layout_type::column_major>;
+
+            // Largest t ||A'||_1 for which T_m(t A') is exact to double precision
+            // (Al-Mohy and Higham 2011, table 3.1)
+            static const std::size_t degrees[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+                                                  20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 35, 40, 45, 50, 55};
+            static const double theta[] = {2.29e-16, 2.58e-8, 1.39e-5, 3.40e-4, 2.40e-3, 9.07e-3, 2.38e-2, 5.00e-2,
+                                           8.96e-2, 1.44e-1, 2.14e-1, 3.00e-1, 4.00e-1, 5.14e-1, 6.41e-1, 7.81e-1,
+                                           9.31e-1, 1.09, 1.26, 1.44, 1.62, 1.82, 2.01, 2.22, 2.43, 2.64, 2.86,
+                                           3.08, 3.31, 3.54, 4.7, 6.0, 7.2, 8.5, 9.9};
+
+            double norm = norm1 * std::abs(t);
+            std::size_t m = 0, s = 1;
+            if (norm > 0.)
+            {
+                double best = std::numeric_limits<double>::infinity();
+                for (std::size_t k = 0; k < sizeof(degrees) / sizeof(degrees[0]); ++k)
+                {
+                    double steps = std::max(std::ceil(norm / theta[k]), 1.);
+                    if (double(degrees[k]) * steps < best)
+                    {
+                        best = double(degrees[k]) * steps;
+                        m = degrees[k];
+                        s = static_cast<std::size_t>(steps);
+                    }
+                }
+            }
+
+            double tol = std::ldexp(1., -std::numeric_limits<real_type>::digits);
+            result_type B = b;
+            result_type F = B;
+            V eta = std::exp(V(t) * mu / V(real_type(s)));
+            for (std::size_t i = 0; i < s; ++i)
+            {
+                double c1 = matrix_norm_inf(B);
+                for (std::size_t j = 1; j <= m; ++j)
+                {
+                    result_type next = product(B);
+                    next *= V(real_type(t / (double(s) * double(j))));
+                    B = std::move(next);
+                    double c2 = matrix_norm_inf(B);
+                    noalias(F) += B;
+                    if (c1 + c2 <= tol * matrix_norm_inf(F))
+                    {
+                        break;
+                    }
+                    c1 = c2;
+                }
+                F *= eta;
+                B = F;
+            }
+            return F;
+        }
+    }
+
+    /**
+     * Compute exp(t A) B without forming exp(A), with the truncated
+     * Taylor series method of Al-Mohy and Higham (2011). Only products of
+     * A with blocks of the shape of B are computed, so this is much cheaper
+     * than expm when B has few columns. Overloads for sparse matrices are
+     * in xsparse.hpp.
+     *
+     * @param A square matrix
+     * @param B vector or matrix
+     * @param t scale factor of A
+     * @return column-major array exp(t A) B of the shape of B
+     */
+    template <class E, class F>
+    auto expm_multiply(const xexpression<E>& A, const xexpression<F>& B, double t = 1.)
+    {
+        using value_type = std::common_type_t<typename E::value_type, typename F::value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        assert_nd_square(A);
+        matrix_type shifted = A.derived_cast();
+        std::size_t n = shifted.shape()[0];
+        if (B.derived_cast().shape()[0] != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "expm_multiply: shape mismatch.");
+        }
+
+        // shifting by the mean eigenvalue reduces the norm for free
+        value_type mu(0);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            mu += shifted(i, i);
+        }
+        mu = n == 0 ? value_type(0) : mu / value_type(xtl::complex_value_type_t<value_type>(n));
+        detail::add_to_diagonal(shifted, -mu);
+
+        auto product = [&shifted](const auto& X) { return dot(shifted, X); };
+        return detail::expm_multiply_impl<value_type>(product, detail::matrix_norm1(shifted), mu, B.derived_cast(), t);
+    }
+
+    namespace detail
+    {
+        /// Scalar for matrices of static rank, xtensor for static rank N > 2, xarray otherwise.
+        template <class V, class S>
+        struct trace_result
+        {
+            using type = xarray<V, layout_type::row_major>;
+        };
+
+        template <class V, class I, std::size_t N>
+        struct trace_result<V, std::array<I, N>>
+        {
+            using type = xtensor<V, (N > 2 ? N - 2 : 0), layout_type::row_major>;
+        };
+
+        template <class V, class I>
+        struct trace_result<V, std::array<I, 2>>
+        {
+            using type = V;
+        };
+
+        template <class V, std::size_t M, std::size_t N>
+        struct trace_result<V, fixed_shape<M, N>>
+        {
+            using type = V;
+        };
+
+        inline std::size_t trace_axis(int axis, std::size_t dim)
+        {
+            int ax = axis < 0 ? axis + static_cast<int>(dim) : axis;
+            if (ax < 0 || ax >= static_cast<int>(dim))
+            {
+                XTENSOR_THROW(std::runtime_error, "trace: axis out of range.");
+            }
+            return static_cast<std::size_t>(ax);
+        }
+
+        /**
+         * Writes the sums of the diagonals of \em e, with the given offset
+         * over axes \em axis1 and \em axis2, to \em out in the row-major
+         * order of the remaining axes. Each diagonal is read with the stride
+         * strides[axis1] + strides[axis2] of its elements.
+         */
+        template <class V, class E>
+        inline void trace_kernel(const E& e, int offset, std::size_t axis1, std::size_t axis2, V* out)
+        {
+            std::ptrdiff_t s1 = static_cast<std::ptrdiff_t>(e.strides()[axis1]);
+            std::ptrdiff_t s2 = static_cast<std::ptrdiff_t>(e.strides()[axis2]);
+            std::ptrdiff_t n1 = static_cast<std::ptrdiff_t>(e.shape()[axis1]);
+            std::ptrdiff_t n2 = static_cast<std::ptrdiff_t>(e.shape()[axis2]);
+            std::ptrdiff_t k = offset;
+            std::ptrdiff_t n = std::max(std::min(n1 - std::max(-k, std::ptrdiff_t(0)), n2 - std::max(k, std::ptrdiff_t(0))),
+                                        std::ptrdiff_t(0));
+            std::ptrdiff_t step = s1 + s2;
+            const auto* first = e.data() + e.data_offset() + (k > 0 ? k * s2 : -k * s1);
+
+            std::vector<std::size_t> shape;
+            std::vector<std::ptrdiff_t> strides;
+            for (std::size_t d = 0; d < e.dimension(); ++d)
+            {
+                if (d != axis1 && d != axis2)
+                {
+                    shape.push_back(e.shape()[d]);
+                    strides.push_back(static_cast<std::ptrdiff_t>(e.strides()[d]));
+                }
+            }
+            std::size_t count = std::accumulate(shape.begin(), shape.end(), std::size_t(1), std::multiplies<std::size_t>());
+
+            for (std::size_t p = 0; p < count; ++p)
+            {
+                std::size_t rest = p;
+                std::ptrdiff_t base = 0;
+                for (std::size_t d = shape.size(); d-- > 0;)
+                {
+                    base += static_cast<std::ptrdiff_t>(rest % shape[d]) * strides[d];
+                    rest /= shape[d];
+                }
+                V sum(0);
+                for (std::ptrdiff_t i = 0; i < n; ++i)
+                {
+                    sum += V(first[base + i * step]);
+                }
+                out[p] = sum;
+            }
+        }
+
+        template <class R, class E>
+        inline R trace_impl(const E& e, int offset, std::size_t axis1, std::size_t axis2,
+                            std::true_type /*has_data_interface*/, std::true_type /*is_scalar*/)
+        {
+            R result;
+            trace_kernel(e, offset, axis1, axis2, &result);
+            return result;
+        }
+
+        template <class R, class E>
+        inline R trace_impl(const E& e, int offset, std::size_t axis1, std::size_t axis2,
+                            std::true_type /*has_data_interface*/, std::false_type /*is_scalar*/)
+        {
+            std::vector<std::size_t> shape;
+            for (std::size_t d = 0; d < e.dimension(); ++d)
+            {
+                if (d != axis1 && d != axis2)
+                {
+                    shape.push_back(e.shape()[d]);
+                }
+            }
+            R result;
+            result.resize(shape);
+            trace_kernel(e, offset, axis1, axis2, result.data());
+            return result;
+        }
+
+        template <class R, class E>
+        inline R trace_impl(const E& e, int offset, std::size_t axis1, std::size_t axis2,
+                            std::false_type /*has_data_interface*/, std::true_type /*is_scalar*/)
+        {
+            return xt::sum<R>(xt::diagonal(e, offset, axis1, axis2))();
+        }
+
+        template <class R, class E>
+        inline R trace_impl(const E& e, int offset, std::size_t axis1, std::size_t axis2,
+                            std::false_type /*has_data_interface*/, std::false_type /*is_scalar*/)
+        {
+            auto d = xt::diagonal(e, offset, axis1, axis2);
+            return xt::sum<typename R::value_type>(d, {d.dimension() - 1});
+        }
+    }
+
+    /**
+     * Compute the trace of a xexpression, the sum of its diagonal with the
+     * given offset over axes \em axis1 and \em axis2, in its value type.
+     *
+     * The trace of a matrix of static rank is a scalar. Higher ranks give
+     * the traces over the remaining axes, an xtensor of rank N - 2 for
+     * static ranks and an xarray otherwise (0-D for a matrix). Containers
+     * are summed in place with the stride of the diagonal.
+     *
+     * @param M input array of at least two dimensions
+     * @param offset offset of the diagonal, positive above the main diagonal
+     * @param axis1 first axis of the 2-D sub-arrays, negative values count from the end
+     * @param axis2 second axis of the 2-D sub-arrays
+     * @return trace(s) of \em M
+     */
+    template <class T>
+    auto trace(const xexpression<T>& M, int offset = 0, int axis1 = 0, int axis2 = 1)
+    {
+        using value_type = typename T::value_type;
+        using result_type = typename detail::trace_result<value_type, typename T::shape_type>::type;
+        const auto& dM = M.derived_cast();
+
+        std::size_t a1 = detail::trace_axis(axis1, dM.dimension());
+        std::size_t a2 = detail::trace_axis(axis2, dM.dimension());
+        if (a1 == a2)
+        {
+            XTENSOR_THROW(std::runtime_error, "trace: axis1 and axis2 must be distinct.");
+        }
+        return detail::trace_impl<result_type>(dM, offset, a1, a2, has_data_interface<T>(),
+                                               std::is_same<result_type, value_type>());
+    }
+
+    namespace detail
+    {
+        template <class V, class S1, class S2>
+        struct kron_result
+        {
+            using type = xarray<V>;
+        };
+
+        template <class V, class T1, std::size_t N1, class T2, std::size_t N2>
+        struct kron_result<V, std::array<T1, N1>, std::array<T2, N2>>
+        {
+            using type = xtensor<V, (N1 > N2 ? N1 : N2)>;
+        };
+
+        // the shape of e padded on the left with ones to dim axes
+        template <class E>
+        inline std::vector<std::size_t> kron_shape(const E& e, std::size_t dim)
+        {
+            std::vector<std::size_t> shape(dim - e.dimension(), std::size_t(1));
+            shape.insert(shape.end(), e.shape().begin(), e.shape().end());
+            return shape;
+        }
+
+        // sum_d i_d * strides[d] for the multi-indices i of the first
+        // \em dim axes of \em shape, in row major order
+        inline std::vector<std::size_t> kron_offsets(const std::vector<std::size_t>& shape,
+                                                     const std::vector<std::size_t>& strides, std::size_t dim)
+        {
+            std::vector<std::size_t> offsets(1, std::size_t(0));
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                std::vector<std::size_t> next;
+                next.reserve(offsets.size() * shape[d]);
+                for (std::size_t o : offsets)
+                {
+                    for (std::size_t i = 0; i < shape[d]; ++i)
+                    {
+                        next.push_back(o + i * strides[d]);
+                    }
+                }
+                offsets.swap(next);
+            }
+            return offsets;
+        }
+
+        /**
+         * Writes kron(a, b) into the row-major buffer \em res. \em a and \em b
+         * are row-major buffers of the shapes \em sa and \em sb, of the same
+         * rank. Every element of \em a scales a copy of \em b into its block
+         * of the result, one contiguous row of \em b at a time.
+         */
+        template <class V, class A, class B>
+        inline void kron_blocks(const A* a, const std::vector<std::size_t>& sa,
+                                const B* b, const std::vector<std::size_t>& sb, V* res)
+        {
+            std::size_t dim = sa.size();
+            std::vector<std::size_t> strides(dim), block_strides(dim);
+            std::size_t stride = 1;
+            for (std::size_t d = dim; d-- > 0;)
+            {
+                strides[d] = stride;
+                block_strides[d] = stride * sb[d];
+                stride *= sa[d] * sb[d];
+            }
+
+            std::size_t row = dim > 0 ? sb[dim - 1] : 1;
+            std::vector<std::size_t> blocks = kron_offsets(sa, block_strides, dim);
+            std::vector<std::size_t> rows = kron_offsets(sb, strides, dim > 0 ? dim - 1 : 0);
+            if (row == 0)
+            {
+                return;
+            }
+            for (std::size_t i = 0; i < blocks.size(); ++i)
+            {
+                V s = static_cast<V>(a[i]);
+                V* block = res + blocks[i];
+                for (std::size_t k = 0; k < rows.size(); ++k)
+                {
+                    const B* b_row = b + k * row;
+                    V* out = block + rows[k];
+                    for (std::size_t h = 0; h < row; ++h)
+                    {
+                        out[h] = s * static_cast<V>(b_row[h]);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Calculate the Kronecker product between two xexpressions.
+     *
+     * As in NumPy, the shape with fewer dimensions is padded on the left
+     * with ones, and the result has the product of the shapes. The result
+     * is written block by block, each block a scaled copy of \em b.
+     *
+     * @param a input array
+     * @param b input array
+     * @return xtensor of the larger rank if both ranks are fixed, else xarray
+     */
+    template <class T, class E>
+    auto kron(const xexpression<T>& a, const xexpression<E>& b)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename E::value_type>;
+        using result_type = typename detail::kron_result<value_type, typename T::shape_type, typename E::shape_type>::type;
+
+        auto&& da = view_eval<layout_type::row_major>(a.derived_cast());
+        auto&& db = view_eval<layout_type::row_major>(b.derived_cast());
+
+        std::size_t dim = std::max(da.dimension(), db.dimension());
+        std::vector<std::size_t> sa = detail::kron_shape(da, dim);
+        std::vector<std::size_t> sb = detail::kron_shape(db, dim);
+        std::vector<std::size_t> shape(dim);
+        for (std::size_t d = 0; d < dim; ++d)
+        {
+            shape[d] = sa[d] * sb[d];
+        }
+
+        result_type res;
+        res.resize(shape);
+        detail::kron_blocks(da.data() + da.data_offset(), sa, db.data() + db.data_offset(), sb, res.data());
+        return res;
+    }
+
+    /**
+     * Calculate the Kronecker products of two stacks of matrices, in
+     * parallel when XTENSOR_USE_OPENMP is defined.
+     *
+     * @param a xexpression of shape (..., m, n)
+     * @param b xexpression of shape (..., p, q), with the batch shape of \em a
+     * @return array of shape (..., m p, n q)
+     */
+    template <class T, class E>
+    auto batch_kron(const xexpression<T>& a, const xexpression<E>& b)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename E::value_type>;
+
+        xarray<typename T::value_type, layout_type::row_major> da = a.derived_cast();
+        xarray<typename E::value_type, layout_type::row_major> db = b.derived_cast();
+        std::size_t dim = da.dimension();
+        if (dim < 2 || db.dimension() != dim || !std::equal(da.shape().begin(), da.shape().end() - 2, db.shape().begin()))
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_kron: expected stacks of matrices with the same batch shape.");
+        }
+
+        std::vector<std::size_t> sa = {da.shape()[dim - 2], da.shape()[dim - 1]};
+        std::vector<std::size_t> sb = {db.shape()[dim - 2], db.shape()[dim - 1]};
+        auto shape = detail::batch_shape(da, 2);
+        shape.push_back(sa[0] * sb[0]);
+        shape.push_back(sa[1] * sb[1]);
+        xarray<value_type, layout_type::row_major> result = xarray<value_type>::from_shape(shape);
+
+        std::size_t size_a = sa[0] * sa[1], size_b = sb[0] * sb[1];
+        std::size_t batch_size = size_a == 0 || size_b == 0 ? 0 : da.size() / size_a;
+        const auto* a_data = da.data();
+        const auto* b_data = db.data();
+        value_type* res_data = result.data();
+
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for
+#endif
+        for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+        {
+            std::size_t i = static_cast<std::size_t>(p);
+            detail::kron_blocks(a_data + i * size_a, sa, b_data + i * size_b, sb, res_data + i * size_a * size_b);
+        }
+        return result;
+    }
+
+    /**
+     * Kronecker product kron(A, B) of two matrices, returned by lazy_kron
+     * and never formed.
+     *
+     * Its products with vectors and matrices use kron(A, B) vec(X) =
+     * vec(A X B^T), where vec stacks the rows of X: two GEMMs with
+     * (m n q + m p q) r multiply-adds instead of the (m p) (n q) r of the
+     * explicit product, for A of shape (m, n), B of shape (p, q) and r
+     * right-hand sides. The operands are held by reference and must
+     * outlive the operator.
+     */
+    template <class T, class O>
+    class kron_operator
+    {
+    public:
+
+        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
+        using shape_type = std::array<std::size_t, 2>;
+
+        kron_operator(const T& a, const O& b)
+            : m_a(a), m_b(b)
+        {
+        }
+
+        const T& lhs() const noexcept
+        {
+            return m_a;
+        }
+
+        const O& rhs() const noexcept
+        {
+            return m_b;
+        }
+
+        shape_type shape() const
+        {
+            return {m_a.shape()[0] * m_b.shape()[0], m_a.shape()[1] * m_b.shape()[1]};
+        }
+
+        /**
+         * @return a new matrix holding kron(A, B)
+         */
+        auto evaluate() const
+        {
+            return kron(m_a, m_b);
+        }
+
+    private:
+
+        const T& m_a;
+        const O& m_b;
+    };
+
+    /**
+     * Returns the Kronecker product of the matrices \em a and \em b as an
+     * operator, see kron_operator.
+     *
+     * \code{.cpp}
+     * // kron(A, B) x with two GEMMs, without forming kron(A, B)
+     * auto y = linalg::dot(linalg::lazy_kron(A, B), x);
+     * \endcode
+     *
+     * @param a matrix
+     * @param b matrix
+     * @return the unevaluated product
+     */
+    template <class T, class O>
+    inline auto lazy_kron(const xexpression<T>& a, const xexpression<O>& b)
+    {
+        if (a.derived_cast().dimension() != 2 || b.derived_cast().dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "lazy_kron: expected two matrices.");
+        }
+        return kron_operator<T, O>(a.derived_cast(), b.derived_cast());
+    }
+
+    /**
+     * Product of a Kronecker product with a vector or a matrix, see
+     * kron_operator.
+     *
+     * @param k kron(A, B) for A of shape (m, n) and B of shape (p, q)
+     * @param x vector of n q elements or matrix of n q rows
+     * @return array of m p elements, or of m p rows
+     */
+    template <class T, class O, class E>
+    auto dot(const kron_operator<T, O>& k, const xexpression<E>& x)
+    {
+        using value_type = std::common_type_t<typename kron_operator<T, O>::value_type, typename E::value_type>;
+        using array_type = xarray<value_type, layout_type::row_major>;
+
+        const auto& a = k.lhs();
+        const auto& b = k.rhs();
+        const auto& dx = x.derived_cast();
+        std::size_t m = a.shape()[0], n = a.shape()[1], p = b.shape()[0], q = b.shape()[1];
+        if (dx.dimension() < 1 || dx.dimension() > 2 || dx.shape()[0] != n * q)
+        {
+            XTENSOR_THROW(std::runtime_error, "dot: x must have as many rows as kron(A, B) has columns.");
+        }
+        std::size_t r = dx.dimension() == 2 ? dx.shape()[1] : 1;
+
+        // row j q + h of x is X(j, h, :), and A X is one GEMM over all h
+        array_type X = dx;
+        X.reshape(std::vector<std::size_t>{n, q * r});
+        array_type AX = array_type::from_shape({m, q * r});
+        dot_into(a, X, AX);
+
+        array_type result;
+        if (r == 1)
+        {
+            result = array_type::from_shape({m, p});
+            dot_into(AX, xt::transpose(b), result);
+            result.reshape(std::vector<std::size_t>{m * p});
+        }
+        else
+        {
+            AX.reshape(std::vector<std::size_t>{m, q, r});
+            result = matmul(b, AX);
+            result.reshape(std::vector<std::size_t>{m * p, r});
+        }
+        return result;
+    }
+
+    /**
+     * Calculate the matrix rank of \ref m.
+     * If tol == -1, the tolerance is automatically computed.
+     *
+     * @param m matrix for which rank is calculated
+     * @param tol tolerance for finding rank
+     */
+    template <class T>
+    int matrix_rank(const xexpression<T>& m, double tol = -1.0)
+    {
+        using value_type = typename T::value_type;
+        using real_value_type = xtl::complex_value_type_t<value_type>;
+        xtensor<value_type, 2, layout_type::column_major> M = m.derived_cast();
+        std::size_t max_dim = std::max(M.shape()[0], M.shape()[1]);
+
+        xtensor<real_value_type, 1, layout_type::column_major> s
+            = xtensor<real_value_type, 1, layout_type::column_major>::from_shape({std::min(M.shape()[0], M.shape()[1])});
+        svdvals_inplace(M, s);
+        if (s.size() == 0)
+        {
+            return 0;
+        }
+        auto max_el = std::max_element(s.begin(), s.end());
+
+        if (tol == -1.0)
+        {
+            tol = (*max_el) * static_cast<double>(max_dim) * std::numeric_limits<real_value_type>::epsilon();
+        }
+
+        int sm = 0;
+        for (const auto& el : s)
+        {
+            if (el > tol)
+            {
+                ++sm;
+            }
+        }
+        return sm;
+    }
+
+    /**
+     * Estimate the matrix rank of \ref m from a QR factorization with column
+     * pivoting (geqp3), as the number of diagonal entries of R larger than
+     * \em tol in magnitude. This is cheaper than the SVD of matrix_rank,
+     * but can overestimate the numerical rank of a few pathological matrices.
+     * If tol == -1, the tolerance is |R(0, 0)| max(m, n) eps.
+     *
+     * @param m matrix for which rank is calculated
+     * @param tol tolerance for finding rank
+     */
+    template <class T>
+    int matrix_rank_qr(const xexpression<T>& m, double tol = -1.0)
+    {
+        using value_type = typename T::value_type;
+        using real_value_type = xtl::complex_value_type_t<value_type>;
+        xtensor<value_type, 2, layout_type::column_major> M = m.derived_cast();
+
+        std::size_t k = std::min(M.shape()[0], M.shape()[1]);
+        if (k == 0)
+        {
+            return 0;
+        }
+        uvector<blas_index_t> jpvt(M.shape()[1], 0);
+        std::array<std::size_t, 1> tau_shp = {k};
+        xtensor<value_type, 1, layout_type::column_major> tau(tau_shp);
+
+        int info = lapack::geqp3(M, jpvt, tau);
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Pivoted QR decomposition failed.");
+        }
+
+        if (tol == -1.0)
+        {
+            tol = std::abs(M(0, 0)) * static_cast<double>(std::max(M.shape()[0], M.shape()[1])) * std::numeric_limits<real_value_type>::epsilon();
+        }
+
+        // |R(i, i)| is non-increasing
+        int rank = 0;
+        while (static_cast<std::size_t>(rank) < k && std::abs(M(rank, rank)) > tol)
+        {
+            ++rank;
+        }
+        return rank;
+    }
+
+    namespace detail
+    {
+        /// R factor of the QR factorization of the tall matrix \em A, which is overwritten by geqrf.
+        template <class M, class T>
+        inline M qr_triangle(M& A, T& tau)
+        {
+            std::size_t k = A.shape()[1];
+            int info = lapack::geqrf(A, tau);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "QR decomposition failed.");
+            }
+            M R = xt::triu(xt::view(A, range(0, k), all()));
+            return R;
+        }
+
+        /// Number of singular values \em s above rcond times the largest, rcond < 0 being max(m, n) eps.
+        template <class V>
+        inline std::size_t numerical_rank(const V& s, std::size_t m, std::size_t n, double rcond)
+        {
+            using real_type = typename V::value_type;
+            if (rcond < 0.)
+            {
+                rcond = double(std::max(m, n)) * double(std::numeric_limits<real_type>::epsilon());
+            }
+            double tol = rcond * (s.size() == 0 ? 0. : double(s(0)));
+            std::size_t rank = 0;
+            while (rank < s.size() && double(s(rank)) > tol)
+            {
+                ++rank;
+            }
+            return rank;
+        }
+    }
+
+    /**
+     * Orthonormal basis of the range of \em A, as the left singular vectors
+     * of the singular values above \em rcond times the largest.
+     *
+     * Only the triangular factor of a QR factorization of A (of A^H if A is
+     * wide) goes through the SVD, so that neither the singular vectors of
+     * the long side nor the full V are computed.
+     *
+     * @param A matrix of m-by-n elements
+     * @param rcond relative cutoff of the singular values, max(m, n) eps if negative
+     * @return column-major matrix with orthonormal columns, m-by-rank
+     */
+    template <class E>
+    auto orth(const xexpression<E>& A, double rcond = -1.)
+    {
+        using value_type = typename E::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1, layout_type::column_major>;
+
+        const auto& a = A.derived_cast();
+        if (a.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "orth: input must be a matrix.");
+        }
+        std::size_t m = a.shape()[0];
+        std::size_t n = a.shape()[1];
+        std::size_t k = std::min(m, n);
+        if (k == 0)
+        {
+            return matrix_type::from_shape({m, 0});
+        }
+
+        if (m >= n)
+        {
+            // A = Q R = (Q U) S V^H
+            matrix_type Q = a;
+            vector_type tau = vector_type::from_shape({n});
+            matrix_type R = detail::qr_triangle(Q, tau);
+            auto decomposition = svd_inplace(R, false, true);
+            std::size_t rank = detail::numerical_rank(std::get<1>(decomposition), m, n, rcond);
+            detail::call_gqr(Q, tau, to_blas_index(n));
+            matrix_type U = xt::view(std::get<0>(decomposition), all(), range(0, rank));
+            matrix_type result = matrix_type::from_shape({m, rank});
+            if (rank != 0)
+            {
+                blas::gemm(Q, U, result);
+            }
+            return result;
+        }
+
+        // A^H = Q R, A = R^H Q^H, and the range of A is that of R^H
+        matrix_type Ah = xt::conj(xt::transpose(a));
+        vector_type tau = vector_type::from_shape({m});
+        matrix_type Rh = xt::conj(xt::transpose(detail::qr_triangle(Ah, tau)));
+        auto decomposition = svd_inplace(Rh, false, true);
+        std::size_t rank = detail::numerical_rank(std::get<1>(decomposition), m, n, rcond);
+        matrix_type result = xt::view(std::get<0>(decomposition), all(), range(0, rank));
+        return result;
+    }
+
+    /**
+     * Orthonormal basis of the null space of \em A, the right singular
+     * vectors of the singular values at most \em rcond times the largest.
+     *
+     * A tall A is reduced to the triangular factor R of its QR
+     * factorization, which has the same V, and only R goes through the
+     * SVD. For a wide A, A^H = [Q1 Q2] R gives A = R^H Q1^H: the null space
+     * is spanned by Q2 and by Q1 times the null vectors of the small R^H,
+     * so only these are computed, not the n-by-n V of a full SVD.
+     *
+     * @param A matrix of m-by-n elements
+     * @param rcond relative cutoff of the singular values, max(m, n) eps if negative
+     * @return column-major matrix with orthonormal columns, n-by-(n - rank)
+     */
+    template <class E>
+    auto null_space(const xexpression<E>& A, double rcond = -1.)
+    {
+        using value_type = typename E::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using vector_type = xtensor<value_type, 1, layout_type::column_major>;
+
+        const auto& a = A.derived_cast();
+        if (a.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "null_space: input must be a matrix.");
+        }
+        std::size_t m = a.shape()[0];
+        std::size_t n = a.shape()[1];
+        if (m == 0 || n == 0)
+        {
+            matrix_type result = xt::eye<value_type>(n);
+            return result;
+        }
+
+        if (m >= n)
+        {
+            matrix_type Q = a;
+            vector_type tau = vector_type::from_shape({n});
+            matrix_type R = detail::qr_triangle(Q, tau);
+            auto decomposition = svd_inplace(R, false, true);
+            std::size_t rank = detail::numerical_rank(std::get<1>(decomposition), m, n, rcond);
+            matrix_type result = xt::conj(xt::transpose(xt::view(std::get<2>(decomposition), range(rank, n), all())));
+            return result;
+        }
+
+        matrix_type Ah = xt::conj(xt::transpose(a));
+        vector_type tau = vector_type::from_shape({m});
+        matrix_type Rh = xt::conj(xt::transpose(detail::qr_triangle(Ah, tau)));
+        auto decomposition = svd_inplace(Rh, false, true);
+        std::size_t rank = detail::numerical_rank(std::get<1>(decomposition), m, n, rcond);
+
+        // the n x n Q of A^H from its m reflectors
+        matrix_type Q = xt::zeros<value_type>({n, n});
+        xt::view(Q, all(), range(0, m)) = Ah;
+        detail::call_gqr(Q, tau, to_blas_index(n));
+
+        matrix_type result = matrix_type::from_shape({n, n - rank});
+        xt::view(result, all(), range(m - rank, n - rank)) = xt::view(Q, all(), range(m, n));
+        if (rank < m)
+        {
+            matrix_type Q1 = xt::view(Q, all(), range(0, m));
+            matrix_type W = xt::conj(xt::transpose(xt::view(std::get<2>(decomposition), range(rank, m), all())));
+            matrix_type Q1W = matrix_type::from_shape({n, m - rank});
+            blas::gemm(Q1, W, Q1W);
+            xt::view(result, all(), range(0, m - rank)) = Q1W;
+        }
+        return result;
+    }
+
+    namespace detail
+    {
+        /**
+         * One Cholesky QR pass: Q := Q R^-1 with R^H R = Q^H Q + shift I,
+         * from syrk (herk), potrf and trsm. Returns false, leaving Q
+         * untouched, if the Cholesky factorization breaks down.
+         */
+        template <class M>
+        inline bool cholqr_pass(M& Q, M& R, double shift)
+        {
+            using value_type = typename M::value_type;
+            R = gram(Q, 'U');
+            if (shift != 0.)
+            {
+                add_to_diagonal(R, value_type(shift));
+            }
+            if (lapack::potr(R, 'U') != 0)
+            {
+                return false;
+            }
+            blas::trsm(R, Q, 'R', 'U');
+            return true;
+        }
+
+        /// max |R(i, i)| / min |R(i, i)|, a lower bound on the condition number of the triangular R.
+        template <class M>
+        inline double diagonal_condition(const M& R)
+        {
+            double lo = std::numeric_limits<double>::infinity(), hi = 0.;
+            for (std::size_t i = 0; i < R.shape()[0]; ++i)
+            {
+                double d = double(std::abs(R(i, i)));
+                lo = std::min(lo, d);
+                hi = std::max(hi, d);
+            }
+            return lo == 0. ? std::numeric_limits<double>::infinity() : hi / lo;
+        }
+    }
+
+    /**
+     * QR factorization A = Q R of a tall matrix of full column rank by
+     * Cholesky QR done twice (CholQR2): each pass is one syrk (herk), a
+     * small Cholesky factorization and one trsm, so the work is level 3
+     * BLAS and communication avoiding, with orthogonality to machine
+     * precision for condition numbers up to about eps^-1/2. If the first
+     * Cholesky factorization breaks down, or its diagonal shows a condition
+     * number above 0.1 eps^-1/2, the first pass is redone shifted by
+     * 11 (m n + n (n + 1)) eps ||A||^2 and a third pass is added, the
+     * shifted CholQR3 of Fukaya et al. (2020), valid up to eps^-1.
+     *
+     * @param A matrix of m-by-n elements, m >= n
+     * @return tuple (Q, R) of column-major matrices, m-by-n and upper triangular n-by-n
+     */
+    template <class E>
+    auto cholqr(const xexpression<E>& A)
+    {
+        using value_type = typename E::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& a = A.derived_cast();
+        if (a.dimension() != 2 || a.shape()[0] < a.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "cholqr: input must be a tall matrix.");
+        }
+        std::size_t m = a.shape()[0];
+        std::size_t n = a.shape()[1];
+
+        matrix_type Q = a;
+        matrix_type R;
+        matrix_type Rk;
+        std::size_t passes = 2;
+        const double eps = double(std::numeric_limits<real_type>::epsilon());
+        if (!detail::cholqr_pass(Q, R, 0.) || detail::diagonal_condition(R) > 0.1 / std::sqrt(eps))
+        {
+            Q = a;
+            double norm2 = double(norm(Q, normorder::frob));
+            double shift = 11. * double(m * n + n * (n + 1)) * eps * norm2 * norm2;
+            if (!detail::cholqr_pass(Q, R, shift))
+            {
+                XTENSOR_THROW(std::runtime_error, "cholqr: matrix is numerically rank deficient.");
+            }
+            passes = 3;
+        }
+        for (std::size_t pass = 1; pass < passes; ++pass)
+        {
+            if (!detail::cholqr_pass(Q, Rk, 0.))
+            {
+                XTENSOR_THROW(std::runtime_error, "cholqr: matrix is numerically rank deficient.");
+            }
+            // R := Rk R
+            blas::trmm(Rk, R, 'L', 'U');
+        }
+        return std::make_tuple(std::move(Q), std::move(R));
+    }
+
+    /**
+     * Block classical Gram-Schmidt with reorthogonalization (BCGS2):
+     * orthogonalizes the block \em X against the orthonormal columns of
+     * \em Q and then within itself, for block Krylov methods.
+     *
+     * The projection C = Q^H X, X := X - Q C is done twice, each pass two
+     * gemm, and the result is orthonormalized by cholqr, so that
+     * X = Q C + X_orth R with [Q X_orth] orthonormal to machine precision.
+     *
+     * @param Q matrix of n-by-k elements with orthonormal columns
+     * @param X matrix of n-by-p elements, [Q X] of full column rank
+     * @return tuple (X_orth, C, R) of column-major matrices, n-by-p, k-by-p
+     *         and upper triangular p-by-p
+     */
+    template <class E, class F>
+    auto block_gram_schmidt(const xexpression<E>& Q, const xexpression<F>& X)
+    {
+        using value_type = std::common_type_t<typename E::value_type, typename F::value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& q = Q.derived_cast();
+        const auto& x = X.derived_cast();
+        if (q.dimension() != 2 || x.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "block_gram_schmidt: inputs must be matrices.");
+        }
+        if (q.shape()[0] != x.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "block_gram_schmidt: shape mismatch.");
+        }
+
+        matrix_type Qm = q;
+        matrix_type Xm = x;
+        std::size_t k = Qm.shape()[1];
+        std::size_t p = Xm.shape()[1];
+        matrix_type C = xt::zeros<value_type>({k, p});
+        if (k != 0)
+        {
+            const auto& Qc = detail::conj_matrix(Qm, xtl::is_complex<value_type>());
+            matrix_type Cp = matrix_type::from_shape({k, p});
+            for (std::size_t pass = 0; pass < 2; ++pass)
+            {
+                blas::gemm(Qc, Xm, Cp, true, false);
+                blas::gemm(Qm, Cp, Xm, false, false, value_type(-1), value_type(1));
+                C += Cp;
+            }
+        }
+        auto qr = cholqr(Xm);
+        return std::make_tuple(std::move(std::get<0>(qr)), std::move(C), std::move(std::get<1>(qr)));
+    }
+
+    /**
+     * LAPACK driver used by lstsq.
+     */
+    enum class lstsq_driver {
+        gelsd,    ///< SVD, divide and conquer (default)
+        gelss,    ///< SVD, QR iteration
+        gelsy,    ///< complete orthogonal factorization, no singular values
+        gels,     ///< QR or LQ factorization, A must have full rank
+        cholesky  ///< normal equations, fastest for tall well-conditioned A
+    };
 
-        return std::make_tuple(std::move(eig_vals), std::move(eig_vecs));
+    namespace detail
+    {
+        template <class E, class G>
+        inline void gram_lower(const E& A, G& gram, std::false_type /*is_complex*/)
+        {
+            blas::syrk(A, gram, 'L', true);
+        }
+
+        template <class E, class G>
+        inline void gram_lower(const E& A, G& gram, std::true_type /*is_complex*/)
+        {
+            blas::herk(A, gram, 'L', true);
+        }
+
+        // Solves the normal equations A^H A x = A^H b with a Cholesky
+        // factorization. For M > N, b is overwritten with b - A x.
+        template <class T, class B>
+        inline auto lstsq_cholesky(const T& dA, B& db)
+        {
+            using value_type = typename T::value_type;
+            std::size_t M = dA.shape()[0];
+            std::size_t N = dA.shape()[1];
+
+            if (M < N)
+            {
+                XTENSOR_THROW(std::runtime_error, "lstsq: the cholesky driver needs at least as many rows as columns.");
+            }
+
+            std::array<std::size_t, 2> gshp = {N, N};
+            xtensor<value_type, 2, layout_type::column_major> gram(gshp);
+            gram_lower(dA, gram, xtl::is_complex<value_type>());
+
+            xtensor<value_type, 2, layout_type::column_major> x = adjoint_product(dA, db);
+            if (lapack::posv(gram, x, 'L') != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "lstsq: A^H A is not positive definite, use another driver.");
+            }
+
+            if (M > N)
+            {
+                blas::gemm(dA, x, db, false, false, value_type(-1), value_type(1));
+            }
+            return x;
+        }
+
+        // Squared 2-norm of each column of rows [first, end) of b
+        template <class B, class R>
+        inline void column_sq_norms(const B& b, std::size_t first, R& result)
+        {
+            using real_type = typename R::value_type;
+            result.resize({ b.shape()[1] });
+            for (std::size_t i = 0; i < b.shape()[1]; ++i)
+            {
+                real_type nrm = 0;
+                blas::nrm2(xt::view(b, range(first, b.shape()[0]), i), nrm);
+                result(i) = nrm * nrm;
+            }
+        }
     }
 
-    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eig(const xexpression<E>& A)
+    /**
+     * Calculate the least-squares solution to a linear matrix equation.
+     *
+     * @param A coefficient matrix
+     * @param b Ordinate, or dependent variable values. If b is two-dimensional,
+     *          the least-squares solution is calculated for each of the K columns of b.
+     * @param rcond Cut-off ratio for small singular values of \em A.
+     *              For the purposes of rank determination, singular values are treated
+     *              as zero if they are smaller than rcond times the largest singular value of a.
+     *              Ignored by the gels and cholesky drivers.
+     * @param driver the LAPACK driver. gelsd and gelss handle any \em A; gelsy
+     *               is cheaper and still rank revealing; gels and cholesky
+     *               assume \em A has full column rank (full row rank for gels
+     *               with M < N) and report rank min(M, N). cholesky squares the
+     *               condition number of \em A and needs M >= N.
+     *
+     * @return tuple containing (x, residuals, rank, s) where:
+     *         \em x is the least squares solution. Note that the solution is always returned as
+     *               a 2D matrix where the columns are the solutions (even for a 1D \em b).
+     *         \em s Sums of residuals; squared Euclidean 2-norm for each column in b - a*x.
+     *               If the rank of \em A is < N or M <= N, this is an empty xtensor.
+     *         \em rank the rank of \em A
+     *         \em s singular values of \em A, empty for the gelsy, gels and
+     *               cholesky drivers
+     */
+    template <class T, class E>
+    auto lstsq(const xexpression<T>& A, const xexpression<E>& b, double rcond = -1.0,
+               lstsq_driver driver = lstsq_driver::gelsd)
     {
-        using value_type = typename E::value_type;
+        using value_type = typename T::value_type;
+        using underlying_value_type = xtl::complex_value_type_t<typename T::value_type>;
 
-        assert_nd_square(A);
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+        xtensor<value_type, 2, layout_type::column_major> dA = A.derived_cast();
 
-        std::size_t N = M.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<value_type, 1, layout_type::column_major> w(vN);
+        std::size_t M = dA.shape()[0];
+        std::size_t N = dA.shape()[1];
+
+        auto& b_ref = b.derived_cast();
+
+        if (dA.dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "Expected 2D expression for A");
+        }
+
+        if (!(b_ref.dimension() <= 2))
+        {
+            XTENSOR_THROW(std::runtime_error, "Expected 1- or 2D expression for A.");
+        }
+
+        if (b_ref.shape()[0] != M)
+        {
+            XTENSOR_THROW(std::runtime_error, "Shape of 'b' for lstsq does not match.");
+        }
+
+        // find number of rhs
+        std::size_t nrhs = (b_ref.dimension() == 1) ? 1 : b_ref.shape()[1];
+
+        // as the dgelsd docs say, on entry it's M-by-nrhs, then result N-by-nrhs
+        // that is why we need to allocate *MORE* space than just b here for M > N
+        auto db = xarray<value_type, layout_type::column_major>::from_shape({ std::max(M, N), nrhs });
+
+        // b is evaluated straight into the first M rows of db, without the
+        // temporary of a view assignment
+        bool is_1d = false;
+        if (b_ref.dimension() == 1)
+        {
+            is_1d = true;
+            noalias(xt::view(db, range(0, M), xt::all())) = xt::view(b_ref, xt::all(), xt::newaxis());
+        }
+        else
+        {
+            noalias(xt::view(db, range(0, M), xt::all())) = b_ref;
+        }
+
+        auto s = xtensor<underlying_value_type, 1, layout_type::column_major>::from_shape({ std::size_t(0) });
+        auto residuals = xtensor<underlying_value_type, 1>::from_shape({0});
+
+        blas_index_t rank = to_blas_index(std::min(M, N));
+        int info = 0;
+
+        if (driver == lstsq_driver::cholesky)
+        {
+            auto x = detail::lstsq_cholesky(dA, db);
+            if (M > N)
+            {
+                // db now holds b - A x
+                detail::column_sq_norms(db, 0, residuals);
+            }
+            db = x;
+        }
+        else
+        {
+            if (driver == lstsq_driver::gelsd || driver == lstsq_driver::gelss)
+            {
+                s.resize({ std::min(M, N) });
+            }
+
+            switch (driver)
+            {
+                case lstsq_driver::gelss:
+                    info = lapack::gelss(dA, db, s, rank, rcond);
+                    break;
+                case lstsq_driver::gelsy:
+                {
+                    // gelsy takes a negative rcond literally and its condition
+                    // estimate is looser than the SVD, so default to max(M, N) * eps
+                    uvector<blas_index_t> jpvt(N, 0);
+                    double eps = static_cast<double>(std::max(M, N)) *
+                                 static_cast<double>(std::numeric_limits<underlying_value_type>::epsilon());
+                    info = lapack::gelsy(dA, db, jpvt, rank, rcond < 0 ? eps : rcond);
+                    break;
+                }
+                case lstsq_driver::gels:
+                    info = lapack::gels(dA, db);
+                    if (info > 0)
+                    {
+                        XTENSOR_THROW(std::runtime_error, "lstsq: A does not have full rank, use another driver.");
+                    }
+                    break;
+                default:
+                    info = lapack::gelsd(dA, db, s, rank, rcond);
+                    break;
+            }
+
+            if (info > 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "lstsq: SVD did not converge.");
+            }
+
+            // the rows below N hold the components of b orthogonal to the range of A
+            if (std::size_t(rank) == N && M > N)
+            {
+                detail::column_sq_norms(db, N, residuals);
+            }
+
+            auto vdb = view(db, range(std::size_t(0), N), xt::all());
+            db = vdb;
+        }
+
+        if (is_1d)
+        {
+            db = xt::squeeze(db);
+        }
+
+        return std::make_tuple(std::move(db), std::move(residuals), std::move(rank), std::move(s));
+    }
+
+    namespace detail
+    {
+        /**
+         * Least squares solution of the row-major m x N system \em a x = \em b
+         * with k right-hand sides, m >= N, by the normal equations and the
+         * unrolled Cholesky kernel. \em x receives the row-major N x k
+         * solution and, for m > N, \em res the squared residual norms.
+         * @return false if A^H A is not positive definite
+         */
+        template <std::size_t N, class T, class R>
+        inline bool small_normal_lstsq(const T* a, const T* b, std::size_t m, std::size_t k, T* x, R* res)
+        {
+            std::array<T, N * N> g = {};
+            for (std::size_t r = 0; r < m; ++r)
+            {
+                const T* row = a + r * N;
+                for (std::size_t i = 0; i < N; ++i)
+                {
+                    T ci = conj_value(row[i]);
+                    for (std::size_t j = 0; j <= i; ++j)
+                    {
+                        g[i * N + j] += ci * row[j];
+                    }
+                }
+            }
+            if (!small_potrf<N>(g.data()))
+            {
+                return false;
+            }
+
+            for (std::size_t c = 0; c < k; ++c)
+            {
+                std::array<T, N> y = {};
+                for (std::size_t r = 0; r < m; ++r)
+                {
+                    T br = b[r * k + c];
+                    for (std::size_t i = 0; i < N; ++i)
+                    {
+                        y[i] += conj_value(a[r * N + i]) * br;
+                    }
+                }
+                // L y = A^H b, then L^H x = y
+                for (std::size_t i = 0; i < N; ++i)
+                {
+                    T t = y[i];
+                    for (std::size_t j = 0; j < i; ++j)
+                    {
+                        t -= g[i * N + j] * y[j];
+                    }
+                    y[i] = t / g[i * N + i];
+                }
+                for (std::size_t i = N; i-- > 0;)
+                {
+                    T t = y[i];
+                    for (std::size_t j = i + 1; j < N; ++j)
+                    {
+                        t -= conj_value(g[j * N + i]) * y[j];
+                    }
+                    y[i] = t / g[i * N + i];
+                    x[i * k + c] = y[i];
+                }
+                if (m > N)
+                {
+                    R sum = 0;
+                    for (std::size_t r = 0; r < m; ++r)
+                    {
+                        T e = b[r * k + c];
+                        for (std::size_t i = 0; i < N; ++i)
+                        {
+                            e -= a[r * N + i] * y[i];
+                        }
+                        sum += std::norm(e);
+                    }
+                    res[c] = sum;
+                }
+            }
+            return true;
+        }
+
+        /// Buffers of one thread of batch_lstsq, reused for all its slices.
+        template <class T>
+        struct batch_lstsq_workspace
+        {
+            using matrix_type = xtensor<T, 2, layout_type::column_major>;
+            using real_type = xtl::complex_value_type_t<T>;
+
+            batch_lstsq_workspace(std::size_t m, std::size_t n, std::size_t k)
+                : a(matrix_type::from_shape({m, n})),
+                  b(matrix_type::from_shape({std::max(m, n), k})),
+                  s(xtensor<real_type, 1, layout_type::column_major>::from_shape({std::min(m, n)})),
+                  jpvt(n)
+            {
+            }
+
+            matrix_type a;
+            matrix_type b;
+            xtensor<real_type, 1, layout_type::column_major> s;
+            uvector<blas_index_t> jpvt;
+        };
+
+        /**
+         * Solves the slice \em p of batch_lstsq with LAPACK in the buffers
+         * of \em ws. Writes the solution, the rank, and the squared
+         * residual norms if m > n and the rank is n, NaN otherwise.
+         * @return false if the driver failed
+         */
+        template <class T, class R>
+        inline bool batch_lstsq_slice(const T* a, const T* b, std::size_t m, std::size_t n, std::size_t k,
+                                      double rcond, lstsq_driver driver, batch_lstsq_workspace<T>& ws,
+                                      T* x, R* res, blas_index_t& rank)
+        {
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    ws.a(i, j) = a[i * n + j];
+                }
+            }
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    ws.b(i, j) = b[i * k + j];
+                }
+            }
+
+            rank = to_blas_index(std::min(m, n));
+            int info = 0;
+            switch (driver)
+            {
+                case lstsq_driver::gelss:
+                    info = lapack::gelss(ws.a, ws.b, ws.s, rank, rcond);
+                    break;
+                case lstsq_driver::gelsy:
+                {
+                    std::fill(ws.jpvt.begin(), ws.jpvt.end(), blas_index_t(0));
+                    double eps = static_cast<double>(std::max(m, n)) * static_cast<double>(std::numeric_limits<R>::epsilon());
+                    info = lapack::gelsy(ws.a, ws.b, ws.jpvt, rank, rcond < 0 ? eps : rcond);
+                    break;
+                }
+                case lstsq_driver::gels:
+                    info = lapack::gels(ws.a, ws.b);
+                    break;
+                case lstsq_driver::cholesky:
+                {
+                    // runs on an OpenMP worker: report failure instead of throwing
+                    xtensor<T, 2, layout_type::column_major> sol;
+                    try
+                    {
+                        sol = lstsq_cholesky(ws.a, ws.b);
+                    }
+                    catch (const std::runtime_error&)
+                    {
+                        return false;
+                    }
+                    // ws.b now holds b - A x
+                    for (std::size_t j = 0; j < k; ++j)
+                    {
+                        for (std::size_t i = 0; i < n; ++i)
+                        {
+                            x[i * k + j] = sol(i, j);
+                        }
+                        R sum = 0;
+                        for (std::size_t i = 0; i < m; ++i)
+                        {
+                            sum += std::norm(ws.b(i, j));
+                        }
+                        res[j] = m > n ? sum : std::numeric_limits<R>::quiet_NaN();
+                    }
+                    return true;
+                }
+                default:
+                    info = lapack::gelsd(ws.a, ws.b, ws.s, rank, rcond);
+                    break;
+            }
+            if (info != 0)
+            {
+                return false;
+            }
+
+            bool residual_rows = std::size_t(rank) == n && m > n;
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    x[i * k + j] = ws.b(i, j);
+                }
+                R sum = 0;
+                for (std::size_t i = n; residual_rows && i < m; ++i)
+                {
+                    sum += std::norm(ws.b(i, j));
+                }
+                res[j] = residual_rows ? sum : std::numeric_limits<R>::quiet_NaN();
+            }
+            return true;
+        }
+    }
+
+    /**
+     * Least squares solutions of a stack of independent systems, e.g. many
+     * small regressions, in one call.
+     *
+     * Each thread copies its slices into column-major buffers allocated
+     * once, and calls the LAPACK driver with the thread-local workspace of
+     * the wrappers, whose size query is made once per thread; the loop over
+     * the stack is parallel when XTENSOR_USE_OPENMP is defined, with BLAS
+     * pinned to one thread. With lstsq_driver::cholesky and n up to 8 the
+     * slices are solved by the normal equations with the unrolled Cholesky
+     * kernel of batch_cholesky, without LAPACK; the condition number of
+     * each A is squared, see lstsq.
+     *
+     * @param A xexpression of shape (..., m, n)
+     * @param b xexpression of shape (..., m) or (..., m, k), with the same
+     *          leading dimensions as \em A
+     * @param rcond cut-off ratio for small singular values, see lstsq
+     * @param driver the LAPACK driver, see lstsq
+     * @return tuple of (x, residuals, rank): \em x of shape (..., n) or
+     *         (..., n, k), the squared residual norms, of shape (...) or
+     *         (..., k), NaN for the slices where lstsq leaves them out
+     *         (m <= n or rank < n), and the ranks, of shape (...)
+     */
+    template <class T, class E>
+    auto batch_lstsq(const xexpression<T>& A, const xexpression<E>& b, double rcond = -1.0,
+                     lstsq_driver driver = lstsq_driver::gelsd)
+    {
+        using value_type = std::common_type_t<typename T::value_type, typename E::value_type>;
+        using real_type = xtl::complex_value_type_t<value_type>;
+
+        const auto& dA = A.derived_cast();
+        const auto& db = b.derived_cast();
+        detail::check_batch_matrix(dA, "batch_lstsq");
+
+        std::size_t a_dim = dA.dimension();
+        std::size_t m = dA.shape()[a_dim - 2];
+        std::size_t n = dA.shape()[a_dim - 1];
+        bool vector_rhs = db.dimension() == a_dim - 1;
+        if (!vector_rhs && db.dimension() != a_dim)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_lstsq: b must have shape (..., m) or (..., m, k).");
+        }
+        if (!std::equal(dA.shape().begin(), dA.shape().end() - 2, db.shape().begin()) ||
+            db.shape()[a_dim - 2] != m)
+        {
+            XTENSOR_THROW(std::runtime_error, "batch_lstsq: shape mismatch.");
+        }
+        if (driver == lstsq_driver::cholesky && m < n)
+        {
+            XTENSOR_THROW(std::runtime_error, "lstsq: the cholesky driver needs at least as many rows as columns.");
+        }
+
+        xarray<value_type, layout_type::row_major> a = dA;
+        xarray<value_type, layout_type::row_major> rb = db;
+        std::size_t nrhs = vector_rhs ? 1 : db.shape()[a_dim - 1];
+
+        auto batch = detail::batch_shape(a, 2);
+        auto x_shape = batch;
+        auto res_shape = batch;
+        x_shape.push_back(n);
+        if (!vector_rhs)
+        {
+            x_shape.push_back(nrhs);
+            res_shape.push_back(nrhs);
+        }
+        xarray<value_type, layout_type::row_major> x = xarray<value_type>::from_shape(x_shape);
+        xarray<real_type, layout_type::row_major> residuals = xarray<real_type>::from_shape(res_shape);
+        xarray<blas_index_t, layout_type::row_major> rank = xarray<blas_index_t>::from_shape(batch);
+
+        std::size_t batch_size = rank.size();
+        const value_type* a_data = a.data();
+        const value_type* b_data = rb.data();
+        value_type* x_data = x.data();
+        real_type* res_data = residuals.data();
+        blas_index_t* rank_data = rank.data();
+        bool small = driver == lstsq_driver::cholesky && n != 0 && n <= detail::small_matrix_order;
+
+        int failed = 0;
+#if defined(XTENSOR_USE_OPENMP)
+        blas::scoped_num_threads guard(1);
+        #pragma omp parallel reduction(+:failed)
+#endif
+        {
+#if defined(XTENSOR_USE_OPENMP)
+            blas::scoped_num_threads worker_guard(1);
+#endif
+            std::unique_ptr<detail::batch_lstsq_workspace<value_type>> ws;
+            if (!small)
+            {
+                ws.reset(new detail::batch_lstsq_workspace<value_type>(m, n, nrhs));
+            }
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp for schedule(static)
+#endif
+            for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(batch_size); ++p)
+            {
+                std::size_t q = static_cast<std::size_t>(p);
+                const value_type* ap = a_data + q * m * n;
+                const value_type* bp = b_data + q * m * nrhs;
+                value_type* xp = x_data + q * n * nrhs;
+                real_type* rp = res_data + q * nrhs;
+                if (small)
+                {
+                    rank_data[q] = to_blas_index(n);
+                    failed += !detail::dispatch_small_size(n, [&](auto N) {
+                        return detail::small_normal_lstsq<decltype(N)::value>(ap, bp, m, nrhs, xp, rp);
+                    });
+                    if (m == n)
+                    {
+                        std::fill(rp, rp + nrhs, std::numeric_limits<real_type>::quiet_NaN());
+                    }
+                }
+                else
+                {
+                    failed += !detail::batch_lstsq_slice(ap, bp, m, n, nrhs, rcond, driver, *ws, xp, rp, rank_data[q]);
+                }
+            }
+        }
+
+        if (failed != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, driver == lstsq_driver::cholesky
+                ? "batch_lstsq: A^H A is not positive definite, use another driver."
+                : "batch_lstsq: the least squares solution could not be computed.");
+        }
+        return std::make_tuple(std::move(x), std::move(residuals), std::move(rank));
+    }
+
+    namespace detail
+    {
+        /// Products of a stack handled together by the small batched kernels.
+        constexpr std::size_t batch_lanes = 64;
+
+        /**
+         * y_l = A_l x_l for \em lanes <= batch_lanes row-major m x N matrices
+         * at \em a, m, N <= small_matrix_order. The tile is transposed into
+         * \em scratch, (m N + N + 1) batch_lanes elements, so that each
+         * element of the products is a SIMD loop across the stack.
+         */
+        template <std::size_t N, class T>
+        inline void small_batched_gemv(const T* a, const T* x, T* y, std::size_t lanes, std::size_t m, T* scratch)
+        {
+            constexpr std::size_t L = batch_lanes;
+            std::size_t mn = m * N;
+            T* ta = scratch;
+            T* tx = ta + mn * L;
+            T* ty = tx + N * L;
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+                const T* al = a + l * mn;
+                for (std::size_t k = 0; k < mn; ++k)
+                {
+                    ta[k * L + l] = al[k];
+                }
+                for (std::size_t j = 0; j < N; ++j)
+                {
+                    tx[j * L + l] = x[l * N + j];
+                }
+            }
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                const T* ai = ta + i * N * L;
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp simd
+#endif
+                for (std::size_t l = 0; l < lanes; ++l)
+                {
+                    ty[l] = ai[l] * tx[l];
+                }
+                for (std::size_t j = 1; j < N; ++j)
+                {
+                    const T* aij = ai + j * L;
+                    const T* xj = tx + j * L;
+#if defined(XTENSOR_USE_OPENMP)
+                    #pragma omp simd
+#endif
+                    for (std::size_t l = 0; l < lanes; ++l)
+                    {
+                        ty[l] += aij[l] * xj[l];
+                    }
+                }
+                for (std::size_t l = 0; l < lanes; ++l)
+                {
+                    y[l * m + i] = ty[l];
+                }
+            }
+        }
 
-        std::array<std::size_t, 2> shp = {N, N};
-        xtensor<value_type, 2, layout_type::column_major> VL(shp), VR(shp);
+        /// y_p = A_p x_p for the \em count row-major m x n matrices at \em a.
+        template <class T>
+        inline void batched_gemv_impl(std::size_t count, std::size_t m, std::size_t n, const T* a, const T* x, T* y)
+        {
+            XTENSOR_BLAS_INSTRUMENT_CALL("gemv_batch", m, n, 0, layout_type::row_major, 'N', 0,
+                                         instrument::fma_flops<T>(double(count) * double(m) * double(n)));
+            if (m <= small_matrix_order && n <= small_matrix_order)
+            {
+                std::size_t tiles = (count + batch_lanes - 1) / batch_lanes;
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp parallel
+#endif
+                {
+                    uvector<T> scratch((m * n + n + 1) * batch_lanes);
+#if defined(XTENSOR_USE_OPENMP)
+                    #pragma omp for schedule(static)
+#endif
+                    for (std::ptrdiff_t t = 0; t < static_cast<std::ptrdiff_t>(tiles); ++t)
+                    {
+                        std::size_t p0 = static_cast<std::size_t>(t) * batch_lanes;
+                        std::size_t lanes = std::min(batch_lanes, count - p0);
+                        dispatch_small_size(n, [&](auto N) {
+                            small_batched_gemv<decltype(N)::value>(a + p0 * m * n, x + p0 * n, y + p0 * m, lanes, m,
+                                                                   scratch.data());
+                        });
+                    }
+                }
+                return;
+            }
 
-        // jobvl N: left eigenvectors of A are not computed
-        // jobvr V: then right eigenvectors of A are computed
-        int info = lapack::geev(M, 'N', 'V', w, VL, VR);
+#if defined(XTENSOR_USE_OPENMP) && !defined(HAVE_CBLAS_GEMV_BATCH)
+            blas::scoped_num_threads guard(1);
+            #pragma omp parallel
+            {
+                blas::scoped_num_threads worker_guard(1);
+                #pragma omp for schedule(static)
+                for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(count); ++p)
+                {
+                    std::size_t q = static_cast<std::size_t>(p);
+                    cxxblas::gemv<blas_index_t>(cxxblas::RowMajor, cxxblas::NoTrans, to_blas_index(m), to_blas_index(n),
+                                                T(1), a + q * m * n, to_blas_index(n), x + q * n, 1,
+                                                T(0), y + q * m, 1);
+                }
+            }
+#else
+            cxxblas::gemv_batch<blas_index_t>(cxxblas::RowMajor, cxxblas::NoTrans, to_blas_index(m), to_blas_index(n),
+                                              T(1), a, to_blas_index(n), to_blas_index(m * n),
+                                              x, 1, to_blas_index(n),
+                                              T(0), y, 1, to_blas_index(m),
+                                              to_blas_index(count));
+#endif
+        }
 
-        if (info != 0)
+        /**
+         * d_l = a_l^T b_l for \em lanes <= batch_lanes vectors of N <=
+         * small_matrix_order elements: one SIMD product over the whole tile
+         * into \em scratch, N batch_lanes elements, then unrolled sums.
+         */
+        template <std::size_t N, class T>
+        inline void small_batched_dot(const T* a, const T* b, T* d, std::size_t lanes, T* scratch)
         {
-            XTENSOR_THROW(std::runtime_error, "Eigenvalue calculation did not converge.");
+            std::size_t size = lanes * N;
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp simd
+#endif
+            for (std::size_t k = 0; k < size; ++k)
+            {
+                scratch[k] = a[k] * b[k];
+            }
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+                const T* sl = scratch + l * N;
+                T acc = sl[0];
+                for (std::size_t j = 1; j < N; ++j)
+                {
+                    acc += sl[j];
+                }
+                d[l] = acc;
+            }
         }
 
-        return std::make_tuple(std::move(w), std::move(VR));
+        /// d_p = a_p^T b_p, unconjugated, for the \em count vectors of n elements at \em a and \em b.
+        template <class T>
+        inline void batched_dot_impl(std::size_t count, std::size_t n, const T* a, const T* b, T* d)
+        {
+            XTENSOR_BLAS_INSTRUMENT_CALL("dot_batch", n, 0, 0, layout_type::row_major, 0, 0,
+                                         instrument::fma_flops<T>(double(count) * double(n)));
+            bool small = n <= small_matrix_order;
+            std::size_t tiles = (count + batch_lanes - 1) / batch_lanes;
+#if defined(XTENSOR_USE_OPENMP)
+            blas::scoped_num_threads guard(1);
+            #pragma omp parallel
+#endif
+            {
+#if defined(XTENSOR_USE_OPENMP)
+                blas::scoped_num_threads worker_guard(1);
+#endif
+                uvector<T> scratch(small ? n * batch_lanes : 0);
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp for schedule(static)
+#endif
+                for (std::ptrdiff_t t = 0; t < static_cast<std::ptrdiff_t>(tiles); ++t)
+                {
+                    std::size_t p0 = static_cast<std::size_t>(t) * batch_lanes;
+                    std::size_t lanes = std::min(batch_lanes, count - p0);
+                    if (small)
+                    {
+                        dispatch_small_size(n, [&](auto N) {
+                            small_batched_dot<decltype(N)::value>(a + p0 * n, b + p0 * n, d + p0, lanes, scratch.data());
+                        });
+                        continue;
+                    }
+                    for (std::size_t l = p0; l < p0 + lanes; ++l)
+                    {
+                        if (xtl::is_complex<T>::value)
+                        {
+                            cxxblas::dotu<blas_index_t>(to_blas_index(n), a + l * n, 1, b + l * n, 1, d[l]);
+                        }
+                        else
+                        {
+                            cxxblas::dot<blas_index_t>(to_blas_index(n), a + l * n, 1, b + l * n, 1, d[l]);
+                        }
+                    }
+                }
+            }
+        }
     }
 
     /**
-     * Compute the eigenvalues and eigenvectors of a square Hermitian or real symmetric xexpression.
+     * Products ``y_p = A_p x_p`` of a stack of matrices with a stack of
+     * vectors, e.g. the small per-particle operators of a simulation,
+     * without the cost of one dot call per product.
      *
-     * @param A Matrix for which the eigenvalues and right eigenvectors are computed
-     * @return xtensor containing the eigenvalues.
+     * With m and n up to 8, tiles of 64 products are transposed so that
+     * each element of the products is one SIMD loop across the tile, and
+     * the tiles are split between the threads. Larger products are issued
+     * as one ``cblas_?gemv_batch_strided`` call with MKL, else as one gemv
+     * per product, in parallel with BLAS pinned to one thread, when
+     * XTENSOR_USE_OPENMP is defined.
+     *
+     * @param A xexpression of shape (..., m, n)
+     * @param x xexpression of shape (..., n), with the same leading
+     *          dimensions as \em A
+     * @return row-major array of shape (..., m)
      */
-    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eigh(const xexpression<E>& A, char UPLO = 'L')
+    template <class T, class E>
+    auto batched_gemv(const xexpression<T>& A, const xexpression<E>& x)
     {
-        using value_type = typename E::value_type;
-
-        assert_nd_square(A);
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
-
-        std::size_t N = M.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<value_type, 1, layout_type::column_major> w(vN);
+        using value_type = std::common_type_t<typename T::value_type, typename E::value_type>;
+        const auto& dA = A.derived_cast();
+        const auto& dx = x.derived_cast();
+        detail::check_batch_matrix(dA, "batched_gemv");
 
-        int info = lapack::syevd(M, 'V', UPLO, w);
-        if (info != 0)
+        std::size_t a_dim = dA.dimension();
+        std::size_t m = dA.shape()[a_dim - 2];
+        std::size_t n = dA.shape()[a_dim - 1];
+        if (dx.dimension() != a_dim - 1 || !std::equal(dA.shape().begin(), dA.shape().end() - 2, dx.shape().begin())
+            || dx.shape()[a_dim - 2] != n)
         {
-            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+            XTENSOR_THROW(std::runtime_error, "batched_gemv: expected A of shape (..., m, n) and x of shape (..., n).");
         }
 
-        return std::make_tuple(std::move(w), std::move(M));
+        auto shape = detail::batch_shape(dA, 2);
+        shape.push_back(m);
+        xarray<value_type, layout_type::row_major> result = xarray<value_type, layout_type::row_major>::from_shape(shape);
+        if (result.size() == 0)
+        {
+            return result;
+        }
+        if (n == 0)
+        {
+            result.fill(value_type(0));
+            return result;
+        }
+        uvector<value_type> a_copy, x_copy;
+        const value_type* pa = detail::row_major_elements(dA, a_copy);
+        const value_type* px = detail::row_major_elements(dx, x_copy);
+        detail::batched_gemv_impl(result.size() / m, m, n, pa, px, result.data());
+        return result;
     }
 
-    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eigh(const xexpression<E>& A, char UPLO = 'L')
+    /**
+     * Dot products ``a_p^T b_p`` (unconjugated, as \ref dot) of two stacks
+     * of vectors along their last dimension. Vectors of up to 8 elements
+     * are multiplied by tiles of 64 in one SIMD loop and summed unrolled;
+     * longer ones go to the BLAS dot (dotu) one by one. The stack is split
+     * between the threads when XTENSOR_USE_OPENMP is defined.
+     *
+     * @param a xexpression of shape (..., n)
+     * @param b xexpression of the shape of \em a
+     * @return row-major array of shape (...)
+     */
+    template <class T, class E>
+    auto batched_dot(const xexpression<T>& a, const xexpression<E>& b)
     {
-        using value_type = typename E::value_type;
-        using underlying_value_type = typename value_type::value_type;
-
-        assert_nd_square(A);
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
-
-        std::size_t N = M.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<underlying_value_type, 1, layout_type::column_major> w(vN);
-
-        int info = lapack::heevd(M, 'V', UPLO, w);
-        if (info != 0)
+        using value_type = std::common_type_t<typename T::value_type, typename E::value_type>;
+        const auto& da = a.derived_cast();
+        const auto& db = b.derived_cast();
+        if (da.dimension() == 0 || da.dimension() != db.dimension()
+            || !std::equal(da.shape().begin(), da.shape().end(), db.shape().begin()))
         {
-            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+            XTENSOR_THROW(std::runtime_error, "batched_dot: expected a and b of the same shape (..., n).");
         }
 
-        return std::make_tuple(std::move(w), std::move(M));
+        std::size_t n = da.shape()[da.dimension() - 1];
+        xarray<value_type, layout_type::row_major> result
+            = xarray<value_type, layout_type::row_major>::from_shape(detail::batch_shape(da, 1));
+        if (result.size() == 0)
+        {
+            return result;
+        }
+        if (n == 0)
+        {
+            result.fill(value_type(0));
+            return result;
+        }
+        uvector<value_type> a_copy, b_copy;
+        const value_type* pa = detail::row_major_elements(da, a_copy);
+        bool same = static_cast<const void*>(&db) == static_cast<const void*>(&da);
+        const value_type* pb = same ? pa : detail::row_major_elements(db, b_copy);
+        detail::batched_dot_impl(result.size(), n, pa, pb, result.data());
+        return result;
     }
 
     /**
-     * Compute the generalized eigenvalues and eigenvectors of a square Hermitian or real symmetric
-     * xexpression.
+     * Least squares solution of A X = B, kept up to date as rows of A and B
+     * are added or removed, for online and sliding window regression.
      *
-     * @param A,B Matrices for which the generalized eigenvalues and right eigenvectors are computed
-     * @return xtensor containing the eigenvalues.
+     * Only the N x N triangular factor R of A = Q R, Q^H B and the residual
+     * sums of squares are stored. Adding p rows costs O(p N^2) with geqrf on
+     * [R; new rows], removing a row O(N^2) with Givens rotations (the LINPACK
+     * downdate), and solve O(N^2) per right-hand side.
      */
-    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eigh(const xexpression<E>& A, const xexpression<E>& B, const char UPLO = 'L')
+    template <class T>
+    class incremental_lstsq
     {
-        using value_type = typename E::value_type;
+    public:
 
-        assert_nd_square(A);
-        auto M1 = copy_to_layout<layout_type::column_major>(A.derived_cast());
-        auto M2 = copy_to_layout<layout_type::column_major>(B.derived_cast());
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        using residuals_type = xtensor<real_type, 1>;
 
-        std::size_t N = M1.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<value_type, 1, layout_type::column_major> w(vN);
+        explicit incremental_lstsq(std::size_t n, std::size_t nrhs = 1);
 
-        int info = lapack::sygvd(M1, M2, 1, 'V', UPLO, w);
-        if (info != 0)
-        {
-            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
-        }
+        template <class E, class F>
+        void add_rows(const xexpression<E>& A, const xexpression<F>& b);
 
-        return std::make_tuple(std::move(w), std::move(M1));
-    }
+        template <class E, class F>
+        void remove_rows(const xexpression<E>& A, const xexpression<F>& b);
 
-    #if 0
-    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eigh(const xexpression<E>& A, char UPLO = 'L')
-    {
-        using value_type = typename E::value_type;
-        using underlying_value_type = typename value_type::value_type;
+        matrix_type solve() const;
 
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+        const residuals_type& residuals() const noexcept;
+        std::size_t rows() const noexcept;
+        const matrix_type& matrix() const noexcept;
 
-        std::size_t N = M.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<underlying_value_type, 1, layout_type::column_major> w(vN);
+    private:
 
-        int info = lapack::heevd(M, 'V', UPLO, w);
-        if (info != 0)
+        template <class E, class F>
+        std::pair<matrix_type, matrix_type> load_rows(const E& A, const F& b) const;
+
+        matrix_type m_r;
+        matrix_type m_z;
+        residuals_type m_rss;
+        std::size_t m_rows;
+    };
+
+    /************************************
+     * incremental_lstsq implementation *
+     ************************************/
+
+    /**
+     * @param n number of columns of A
+     * @param nrhs number of columns of B
+     */
+    template <class T>
+    inline incremental_lstsq<T>::incremental_lstsq(std::size_t n, std::size_t nrhs)
+        : m_r(std::array<std::size_t, 2>{n, n}, value_type(0)),
+          m_z(std::array<std::size_t, 2>{n, nrhs}, value_type(0)),
+          m_rss(std::array<std::size_t, 1>{nrhs}, real_type(0)),
+          m_rows(0)
+    {
+        if (n == 0 || nrhs == 0)
         {
-            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+            XTENSOR_THROW(std::runtime_error, "incremental_lstsq: A and B need at least one column.");
         }
+    }
 
-        return std::make_tuple(std::move(w), std::move(M));
+    template <class T>
+    template <class E, class F>
+    inline auto incremental_lstsq<T>::load_rows(const E& A, const F& b) const -> std::pair<matrix_type, matrix_type>
+    {
+        if (A.dimension() != 2 || A.shape()[1] != m_r.shape()[0] ||
+            b.dimension() < 1 || b.dimension() > 2 || b.shape()[0] != A.shape()[0] ||
+            (b.dimension() == 1 ? std::size_t(1) : b.shape()[1]) != m_z.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "incremental_lstsq: shape mismatch.");
+        }
+        matrix_type a = A;
+        matrix_type rhs;
+        if (b.dimension() == 1)
+        {
+            rhs = xt::view(b, xt::all(), xt::newaxis());
+        }
+        else
+        {
+            rhs = b;
+        }
+        return std::make_pair(std::move(a), std::move(rhs));
     }
-    #endif
 
     /**
-     * Compute the eigenvalues of a square xexpression.
-     *
-     * @param A Matrix for which the eigenvalues are computed
-     * @return xtensor containing the eigenvalues.
+     * Add rows to A and B.
+     * @param A matrix of shape (p, N)
+     * @param b vector of p elements, or matrix of shape (p, nrhs)
      */
-    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eigvals(const xexpression<E>& A)
+    template <class T>
+    template <class E, class F>
+    inline void incremental_lstsq<T>::add_rows(const xexpression<E>& A, const xexpression<F>& b)
     {
-        using value_type = typename E::value_type;
-
-        assert_nd_square(A);
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
-
-        std::size_t N = M.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<value_type, 1, layout_type::column_major> wr(vN);
-        xtensor<value_type, 1, layout_type::column_major> wi(vN);
+        auto rows = load_rows(A.derived_cast(), b.derived_cast());
+        std::size_t n = m_r.shape()[0];
+        std::size_t p = rows.first.shape()[0];
+        if (p == 0)
+        {
+            return;
+        }
 
-        // TODO check if we can remove allocation and pass nullptr as VL / VR
-        std::array<std::size_t, 2> shp = {N, N};
-        xtensor<value_type, 2, layout_type::column_major> VL(shp);
-        xtensor<value_type, 2, layout_type::column_major> VR(shp);
+        // QR of [R; A_new], whose Q^H also turns [Q^H B; B_new] into the
+        // new Q^H B and the residuals of the added rows
+        matrix_type stacked(std::array<std::size_t, 2>{n + p, n});
+        xt::view(stacked, range(0, n), xt::all()) = m_r;
+        xt::view(stacked, range(n, n + p), xt::all()) = rows.first;
+        matrix_type rhs(std::array<std::size_t, 2>{n + p, m_z.shape()[1]});
+        xt::view(rhs, range(0, n), xt::all()) = m_z;
+        xt::view(rhs, range(n, n + p), xt::all()) = rows.second;
 
-        auto info = lapack::geev(M, 'N', 'N', wr, wi, VL, VR);
-        if (info != 0)
+        xtensor<value_type, 1, layout_type::column_major> tau(std::array<std::size_t, 1>{n});
+        if (lapack::geqrf(stacked, tau) != 0 || lapack::ormqr(stacked, tau, rhs, 'L', 'T') != 0)
         {
-            XTENSOR_THROW(std::runtime_error, "Failed to compute eigenvalue " +
-                std::to_string(std::abs(info)) + ".");
+            XTENSOR_THROW(std::runtime_error, "incremental_lstsq: QR update failed.");
         }
 
-        xtensor<std::complex<value_type>, 1> eig_vals;
-        eig_vals.resize({N});
-
-        xt::real(eig_vals) = wr;
-        xt::imag(eig_vals) = wi;
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                m_r(i, j) = i <= j ? stacked(i, j) : value_type(0);
+            }
+        }
+        m_z = xt::view(rhs, range(0, n), xt::all());
 
-        return eig_vals;
+        residuals_type added;
+        detail::column_sq_norms(rhs, n, added);
+        m_rss += added;
+        m_rows += p;
     }
 
-    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eigvals(const xexpression<E>& A)
+    /**
+     * Remove rows, previously added, from A and B. The rows are downdated one
+     * at a time; if one fails, the object is left unchanged.
+     * @param A matrix of shape (p, N)
+     * @param b vector of p elements, or matrix of shape (p, nrhs)
+     */
+    template <class T>
+    template <class E, class F>
+    inline void incremental_lstsq<T>::remove_rows(const xexpression<E>& A, const xexpression<F>& b)
     {
-        using value_type = typename E::value_type;
-
-        assert_nd_square(A);
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+        auto rows = load_rows(A.derived_cast(), b.derived_cast());
+        std::size_t n = m_r.shape()[0];
+        std::size_t nrhs = m_z.shape()[1];
+        std::size_t p = rows.first.shape()[0];
+        if (p > m_rows)
+        {
+            XTENSOR_THROW(std::runtime_error, "incremental_lstsq: cannot remove more rows than were added.");
+        }
 
-        std::size_t N = M.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<value_type, 1, layout_type::column_major> w(vN);
+        matrix_type r = m_r;
+        matrix_type z = m_z;
+        residuals_type rss = m_rss;
+        blas_index_t ld = to_blas_index(n);
 
-        // TODO check if we can remove allocation and pass nullptr as VL / VR
-        std::array<std::size_t, 2> shp = {N, N};
-        xtensor<value_type, 2, layout_type::column_major> VL(shp);
-        xtensor<value_type, 2, layout_type::column_major> VR(shp);
+        xtensor<value_type, 1, layout_type::column_major> u(std::array<std::size_t, 1>{n});
+        xtensor<value_type, 1, layout_type::column_major> bottom(std::array<std::size_t, 1>{n});
+        uvector<real_type> c(n);
+        uvector<value_type> s(n);
 
-        auto info = lapack::geev(M, 'N', 'N', w, VL, VR);
-        if (info != 0)
+        for (std::size_t k = 0; k < p; ++k)
         {
-            XTENSOR_THROW(std::runtime_error, "Failed to compute eigenvalue " +
-                std::to_string(std::abs(info)) + ".");
-        }
-
-        using value_type = typename E::value_type;
+            // u solves R^H u = a^H, and the removed row is a = u^H R
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                u(j) = detail::conj_value(rows.first(k, j));
+            }
+            if (lapack::trtrs(r, u, 'U', 'C', 'N') != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "incremental_lstsq: R is singular, cannot remove rows.");
+            }
+            real_type alpha(0);
+            blas::nrm2(u, alpha);
+            if (!(alpha < real_type(1)))
+            {
+                XTENSOR_THROW(std::runtime_error, "incremental_lstsq: removing the rows leaves A rank deficient.");
+            }
+            alpha = std::sqrt((real_type(1) - alpha) * (real_type(1) + alpha));
 
-        return w;
-    }
+            // rotations in the planes (i, N) mapping [u; alpha] to e_N, last to first
+            for (std::size_t i = n; i-- > 0;)
+            {
+                real_type scale = alpha + std::abs(u(i));
+                real_type a = alpha / scale;
+                value_type v = u(i) / scale;
+                real_type norm = std::sqrt(a * a + std::norm(v));
+                c[i] = a / norm;
+                s[i] = detail::conj_value(v) / norm;
+                alpha = scale * norm;
+            }
 
-    /**
-     * Compute the eigenvalues of a Hermitian or real symmetric matrix xexpression.
-     *
-     * @param Matrix for which the eigenvalues are computed
-     * @return xtensor containing the eigenvalues.
-     */
-    template <class E, std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eigvalsh(const xexpression<E>& A, char UPLO = 'L')
-    {
-        using value_type = typename E::value_type;
+            // applied to [R; 0], they give [R'; a]. Row i of R is zero left
+            // of the diagonal, and so is the bottom row in those positions.
+            bottom.fill(value_type(0));
+            for (std::size_t i = n; i-- > 0;)
+            {
+                cxxblas::rot<blas_index_t>(
+                    to_blas_index(n - i),
+                    bottom.data() + i, 1,
+                    r.data() + i * (n + 1), ld,
+                    c[i], s[i]
+                );
+            }
 
-        assert_nd_square(A);
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+            // [Q^H b; residual] must map to [z'; beta]: run the rotations
+            // backwards from the known bottom entry beta. What is left is the
+            // residual component of the removed row.
+            for (std::size_t j = 0; j < nrhs; ++j)
+            {
+                value_type zeta = rows.second(k, j);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    value_type prev = (zeta - s[i] * z(i, j)) / c[i];
+                    z(i, j) = c[i] * z(i, j) - detail::conj_value(s[i]) * prev;
+                    zeta = prev;
+                }
+                rss(j) = std::max(rss(j) - std::norm(zeta), real_type(0));
+            }
+        }
 
-        std::size_t N = M.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<value_type, 1, layout_type::column_major> w(vN);
+        m_r = std::move(r);
+        m_z = std::move(z);
+        m_rss = std::move(rss);
+        m_rows -= p;
+    }
 
-        int info = lapack::syevd(M, 'N', UPLO, w);
-        if (info != 0)
+    /**
+     * @return least squares solution of shape (N, nrhs) for the rows added so far
+     */
+    template <class T>
+    inline auto incremental_lstsq<T>::solve() const -> matrix_type
+    {
+        matrix_type r = m_r;
+        matrix_type x = m_z;
+        if (lapack::trtrs(r, x, 'U', 'N', 'N') != 0)
         {
-            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+            XTENSOR_THROW(std::runtime_error, "incremental_lstsq: R is singular, add more rows before solving.");
         }
+        return x;
+    }
 
-        return w;
+    /**
+     * @return squared 2-norm of the residual b - A x of each column of B
+     */
+    template <class T>
+    inline auto incremental_lstsq<T>::residuals() const noexcept -> const residuals_type&
+    {
+        return m_rss;
     }
 
-    template <class E, std::enable_if_t<xtl::is_complex<typename E::value_type>::value>* = nullptr>
-    auto eigvalsh(const xexpression<E>& A, char UPLO = 'L')
+    /**
+     * @return number of rows currently in A
+     */
+    template <class T>
+    inline std::size_t incremental_lstsq<T>::rows() const noexcept
     {
-        using value_type = typename E::value_type;
-        using underlying_value_type = typename value_type::value_type;
+        return m_rows;
+    }
 
-        assert_nd_square(A);
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
+    /**
+     * @return the upper triangular factor R, with A^H A = R^H R
+     */
+    template <class T>
+    inline auto incremental_lstsq<T>::matrix() const noexcept -> const matrix_type&
+    {
+        return m_r;
+    }
 
-        std::size_t N = M.shape()[0];
-        std::array<std::size_t, 1> vN = {N};
-        xtensor<underlying_value_type, 1, layout_type::column_major> w(vN);
+    namespace detail
+    {
+        template <class R>
+        inline R make_cross_result(std::true_type /*is_fixed*/)
+        {
+            return R();
+        }
 
-        int info = lapack::heevd(M, 'N', UPLO, w);
-        if (info != 0)
+        template <class R>
+        inline R make_cross_result(std::false_type /*is_fixed*/)
         {
-            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+            return R::from_shape({ 3 });
         }
 
-        return w;
-    }
+        /// Vectors per chunk of the batched cross product, the unit of work of its parallel loop.
+        constexpr std::size_t cross_chunk_size = 4096;
 
-    namespace detail
-    {
-        template <class A>
-        struct offset_iter_without_axis
+        inline std::size_t cross_axis(std::ptrdiff_t axis, std::size_t dim)
         {
+            std::ptrdiff_t ax = axis < 0 ? axis + static_cast<std::ptrdiff_t>(dim) : axis;
+            if (ax < 0 || ax >= static_cast<std::ptrdiff_t>(dim))
+            {
+                XTENSOR_THROW(std::runtime_error, "cross: axis out of range.");
+            }
+            return static_cast<std::size_t>(ax);
+        }
 
-            using shape_type = typename A::shape_type;
-            using size_type = typename A::size_type;
-            using index_type = xindex_type_t<shape_type>;
+        /**
+         * Shape and strides, along the broadcast batch axes, of an operand of
+         * the batched cross product with its vectors along \em axis. Axes of
+         * extent one get a zero stride.
+         */
+        struct cross_operand
+        {
+            std::vector<std::size_t> shape;
+            std::vector<std::ptrdiff_t> strides;
+            std::ptrdiff_t components_stride;
+            std::size_t components;
+        };
 
-            offset_iter_without_axis(const A& a, std::size_t axis)
-                : m_a(a), m_axis(axis)
+        template <class E>
+        inline cross_operand make_cross_operand(const E& e, std::size_t axis)
+        {
+            cross_operand op;
+            op.components = e.shape()[axis];
+            if (op.components != 2 && op.components != 3)
             {
-                resize_container(m_idx, a.dimension());
-                std::fill(m_idx.begin(), m_idx.end(), 0);
-                m_offset = 0;
+                XTENSOR_THROW(std::runtime_error, "cross: the vectors must have 2 or 3 components along the axis.");
             }
-
-            #define SC(X) static_cast<std::size_t>(X)
-            inline bool next()
+            op.components_stride = static_cast<std::ptrdiff_t>(e.strides()[axis]);
+            for (std::size_t d = 0; d < e.dimension(); ++d)
             {
-                size_type dim = static_cast<size_type>(m_a.dimension());
-                for (size_type j = dim; j != 0; --j)
+                if (d != axis)
                 {
-                    size_type i = j - 1;
-                    if (i == m_axis)
-                    {
-                        // skip
-                    }
-                    else if (m_idx[SC(i)] == m_a.shape()[SC(i)] - 1)
-                    {
-                        m_offset -= static_cast<std::ptrdiff_t>(m_idx[i]) * m_a.strides()[i];
-                        m_idx[i] = size_type(0);
-                        if (i == 0 || m_axis == 0 && i == 1)
-                        {
-                            return false;
-                        }
-                    }
-                    else
-                    {
-                        ++m_idx[i];
-                        m_offset += m_a.strides()[i];
-                        return true;
-                    }
+                    op.shape.push_back(e.shape()[d]);
+                    op.strides.push_back(e.shape()[d] == 1 ? 0 : static_cast<std::ptrdiff_t>(e.strides()[d]));
                 }
-                return false;
-            }
-            #undef SC
-            inline std::ptrdiff_t offset() const
-            {
-                return m_offset;
             }
+            return op;
+        }
 
-        private:
-            const A& m_a;
-            index_type m_idx;
-            size_type m_axis;
-            std::ptrdiff_t m_offset;
-        };
-    }
-
-    /**
-     * Non-broadcasting dot function.
-     * In the case of two 1D vectors, computes the vector dot
-     * product. In the case of complex vectors, computes the dot
-     * product without conjugating the first argument.
-     * If \em t or \em o is a 2D matrix, computes the matrix-times-vector
-     * product. If both \em t and \em o ar 2D matrices, computes
-     * the matrix-product.
-     *
-     * @param t input array
-     * @param o input array
-     *
-     * @return resulting array
-     */
-    template <class T, class O>
-    auto dot(const xexpression<T>& xt, const xexpression<O>& xo)
-    {
-        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
-
-        using return_type = std::conditional_t<(T::static_layout == O::static_layout) &&
-                                               (T::static_layout != layout_type::dynamic && T::static_layout != layout_type::any),
-                                               xarray<value_type, T::static_layout>,
-                                               xarray<value_type, XTENSOR_DEFAULT_LAYOUT>>;
-        return_type result;
-
-        auto&& t = view_eval<T::static_layout>(xt.derived_cast());
-        auto&& o = view_eval<O::static_layout>(xo.derived_cast());
+        // right-aligns the batch axes of op on those of a result with dim batch axes
+        inline void align_cross_operand(cross_operand& op, std::size_t dim)
+        {
+            op.shape.insert(op.shape.begin(), dim - op.shape.size(), std::size_t(1));
+            op.strides.insert(op.strides.begin(), dim - op.strides.size(), std::ptrdiff_t(0));
+        }
 
-        // is one of each a scalar? just multiply
-        if (t.dimension() == 0 || o.dimension() == 0)
+        inline std::vector<std::size_t> cross_batch_shape(const cross_operand& a, const cross_operand& b)
         {
-            return return_type(t * o);
+            std::size_t dim = std::max(a.shape.size(), b.shape.size());
+            std::vector<std::size_t> shape(dim);
+            for (std::size_t d = 0; d < dim; ++d)
+            {
+                std::size_t na = d + a.shape.size() < dim ? 1 : a.shape[d + a.shape.size() - dim];
+                std::size_t nb = d + b.shape.size() < dim ? 1 : b.shape[d + b.shape.size() - dim];
+                if (na != nb && na != 1 && nb != 1)
+                {
+                    XTENSOR_THROW(std::runtime_error, "cross: the shapes of a and b do not broadcast.");
+                }
+                shape[d] = na == 1 ? nb : na;
+            }
+            return shape;
         }
-        if (t.dimension() == 1 && o.dimension() == 1)
+
+        /**
+         * z_i = x_i \times y_i for the m vectors x_i = x + i sx, ..., whose
+         * components are cx, cy and cz apart. The components of x and y past
+         * KX and KY are zero.
+         */
+        template <std::size_t KX, std::size_t KY, class T>
+        inline void cross_run(const T* x, std::ptrdiff_t sx, std::ptrdiff_t cx,
+                              const T* y, std::ptrdiff_t sy, std::ptrdiff_t cy,
+                              T* z, std::ptrdiff_t sz, std::ptrdiff_t cz, std::size_t m)
         {
-            result.resize(std::vector<std::size_t>{1});
-            if (t.shape()[0] != o.shape()[0])
+            for (std::size_t i = 0; i < m; ++i)
             {
-                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+                const T* u = x + static_cast<std::ptrdiff_t>(i) * sx;
+                const T* v = y + static_cast<std::ptrdiff_t>(i) * sy;
+                T* w = z + static_cast<std::ptrdiff_t>(i) * sz;
+                T u0 = u[0], u1 = u[cx], u2 = KX == 3 ? u[2 * cx] : T(0);
+                T v0 = v[0], v1 = v[cy], v2 = KY == 3 ? v[2 * cy] : T(0);
+                w[0] = u1 * v2 - u2 * v1;
+                w[cz] = u2 * v0 - u0 * v2;
+                w[2 * cz] = u0 * v1 - u1 * v0;
             }
+        }
 
-            if (xtl::is_complex<typename T::value_type>::value)
+        template <class T>
+        inline void cross_run(std::size_t kx, std::size_t ky,
+                              const T* x, std::ptrdiff_t sx, std::ptrdiff_t cx,
+                              const T* y, std::ptrdiff_t sy, std::ptrdiff_t cy,
+                              T* z, std::ptrdiff_t sz, std::ptrdiff_t cz, std::size_t m)
+        {
+            if (kx == 3 && ky == 3)
+            {
+                cross_run<3, 3>(x, sx, cx, y, sy, cy, z, sz, cz, m);
+            }
+            else if (kx == 3)
+            {
+                cross_run<3, 2>(x, sx, cx, y, sy, cy, z, sz, cz, m);
+            }
+            else if (ky == 3)
             {
-                blas::dotu(t, o, result(0));
+                cross_run<2, 3>(x, sx, cx, y, sy, cy, z, sz, cz, m);
             }
             else
             {
-                blas::dot(t, o, result(0));
+                cross_run<2, 2>(x, sx, cx, y, sy, cy, z, sz, cz, m);
             }
-            return result;
         }
-        else
+
+        /**
+         * Batched cross product of the strided operands at \em x and \em y
+         * into \em z, all aligned on the same batch axes. The innermost batch
+         * axis is split in chunks of cross_chunk_size vectors, which run in
+         * parallel when XTENSOR_USE_OPENMP is defined, each one a strided
+         * loop the compiler can vectorize.
+         */
+        template <class T>
+        inline void cross_batch(const cross_operand& a, const T* x, const cross_operand& b, const T* y,
+                                const cross_operand& r, T* z)
         {
-            if (t.dimension() == 2 && o.dimension() == 1)
+            std::size_t dim = r.shape.size();
+            std::size_t count = std::accumulate(r.shape.begin(), r.shape.end(), std::size_t(1), std::multiplies<std::size_t>());
+            if (count == 0)
             {
-                XTENSOR_ASSERT(t.layout() == layout_type::row_major || t.layout() == layout_type::column_major);
-                XTENSOR_ASSERT(std::min(t.strides()[0], t.strides()[1]) <= 1);
+                return;
+            }
+            std::size_t m = dim == 0 ? 1 : r.shape[dim - 1];
+            std::size_t runs = count / m;
+            std::size_t chunks = (m + cross_chunk_size - 1) / cross_chunk_size;
+            std::ptrdiff_t sa = dim == 0 ? 0 : a.strides[dim - 1];
+            std::ptrdiff_t sb = dim == 0 ? 0 : b.strides[dim - 1];
+            std::ptrdiff_t sr = dim == 0 ? 0 : r.strides[dim - 1];
 
-                if (t.shape()[1] != o.shape()[0])
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for
+#endif
+            for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(runs * chunks); ++p)
+            {
+                std::size_t run = static_cast<std::size_t>(p) / chunks;
+                std::size_t first = (static_cast<std::size_t>(p) % chunks) * cross_chunk_size;
+                std::ptrdiff_t oa = 0, ob = 0, orr = 0;
+                for (std::size_t d = dim > 0 ? dim - 1 : 0; d-- > 0;)
                 {
-                    XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+                    std::ptrdiff_t i = static_cast<std::ptrdiff_t>(run % r.shape[d]);
+                    run /= r.shape[d];
+                    oa += i * a.strides[d];
+                    ob += i * b.strides[d];
+                    orr += i * r.strides[d];
                 }
+                std::ptrdiff_t f = static_cast<std::ptrdiff_t>(first);
+                cross_run(a.components, b.components,
+                          x + oa + f * sa, sa, a.components_stride,
+                          y + ob + f * sb, sb, b.components_stride,
+                          z + orr + f * sr, sr, r.components_stride,
+                          std::min(cross_chunk_size, m - first));
+            }
+        }
 
-                result.resize({static_cast<std::size_t>(t.shape()[0])});
+        template <class V, class E>
+        inline auto cross_eval(const E& e)
+            -> std::enable_if_t<std::is_same<typename E::value_type, V>::value, decltype(view_eval<layout_type::row_major>(e))>
+        {
+            return view_eval<layout_type::row_major>(e);
+        }
 
-                blas_index_t shape_x, shape_y;
-                cxxblas::Transpose trans;
-                if (result.layout() != t.layout())
-                {
-                    shape_x = static_cast<blas_index_t>(t.shape()[1]);
-                    shape_y = static_cast<blas_index_t>(t.shape()[0]);
-                    trans = cxxblas::Transpose::Trans;
-                }
-                else
-                {
-                    shape_x = static_cast<blas_index_t>(t.shape()[0]);
-                    shape_y = static_cast<blas_index_t>(t.shape()[1]);
-                    trans = cxxblas::Transpose::NoTrans;
-                }
+        template <class V, class E>
+        inline auto cross_eval(const E& e)
+            -> std::enable_if_t<!std::is_same<typename E::value_type, V>::value, xarray<V, layout_type::row_major>>
+        {
+            return e;
+        }
 
-                cxxblas::gemv<blas_index_t>(
-                    get_blas_storage_order(result),
-                    trans,
-                    shape_x,
-                    shape_y,
-                    value_type(1.0),
-                    t.data() + t.data_offset(),
-                    get_leading_stride(t),
-                    o.data() + o.data_offset(),
-                    get_leading_stride(o),
-                    value_type(0.0),
-                    result.data(),
-                    get_leading_stride(result)
-                );
-            }
-            else if (t.dimension() == 1 && o.dimension() == 2)
-            {
-                XTENSOR_ASSERT(o.layout() == layout_type::row_major || o.layout() == layout_type::column_major);
-                XTENSOR_ASSERT(std::min(o.strides()[0], o.strides()[1]) <= 1);
+        template <class E1, class E2>
+        inline std::vector<std::size_t> cross_shape(const E1& a, const E2& b, std::ptrdiff_t axis)
+        {
+            auto oa = make_cross_operand(a, cross_axis(axis, a.dimension()));
+            auto ob = make_cross_operand(b, cross_axis(axis, b.dimension()));
+            auto shape = cross_batch_shape(oa, ob);
+            std::size_t ax = cross_axis(axis, shape.size() + 1);
+            shape.insert(shape.begin() + static_cast<std::ptrdiff_t>(ax), std::size_t(3));
+            return shape;
+        }
 
-                if (t.shape()[0] != o.shape()[0])
-                {
-                    XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
-                }
+        template <class E1, class E2, class R>
+        inline void cross_into_impl(const E1& a, const E2& b, R& r, std::ptrdiff_t axis)
+        {
+            using value_type = typename R::value_type;
+            auto oa = make_cross_operand(a, cross_axis(axis, a.dimension()));
+            auto ob = make_cross_operand(b, cross_axis(axis, b.dimension()));
+            auto orr = make_cross_operand(r, cross_axis(axis, r.dimension()));
+            std::size_t dim = orr.shape.size();
+            align_cross_operand(oa, dim);
+            align_cross_operand(ob, dim);
+            cross_batch<value_type>(oa, a.data() + a.data_offset(), ob, b.data() + b.data_offset(), orr, r.data() + r.data_offset());
+        }
+    }
+
+    /**
+     * @brief Non-broadcasting cross product between two vectors.
+     *
+     * Calculate cross product between two 1D vectors with 2- or 3 entries.
+     * If only two entries are available, the third entry is assumed to be 0.
+     * The result is an xtensor_fixed when both shapes are known at compile time.
+     *
+     * @param a input vector
+     * @param b input vector
+     * @return resulting array
+     */
+    template <class E1, class E2>
+    auto cross(const xexpression<E1>& a, const xexpression<E2>& b)
+    {
+        using is_fixed = std::integral_constant<bool, detail::is_fixed_shape<typename E1::shape_type>::value &&
+                                                      detail::is_fixed_shape<typename E2::shape_type>::value>;
+        using return_type = std::conditional_t<is_fixed::value,
+                                               xtensor_fixed<typename E1::value_type, xshape<3>>,
+                                               xtensor<typename E1::value_type, 1>>;
+        auto res = detail::make_cross_result<return_type>(is_fixed());
+        const E1& da = a.derived_cast();
+        const E2& db = b.derived_cast();
+
+        if (da.size() == 3 && db.size() == 3)
+        {
+            res(0) = da(1) * db(2) - da(2) * db(1);
+            res(1) = da(2) * db(0) - da(0) * db(2);
+            res(2) = da(0) * db(1) - da(1) * db(0);
+        }
+        else if (da.size() == 2 && db.size() == 3)
+        {
+            res(0) =   da(1) * db(2);
+            res(1) = -(da(0) * db(2));
+            res(2) =   da(0) * db(1) - da(1) * db(0);
+        }
+        else if (da.size() == 3 && db.size() == 2)
+        {
+            res(0) = -(da(2) * db(1));
+            res(1) =   da(2) * db(0);
+            res(2) =   da(0) * db(1) - da(1) * db(0);
+        }
+        else if (da.size() == 2 && db.size() == 2)
+        {
+            res(0) = 0;
+            res(1) = 0;
+            res(2) = da(0) * db(1) - da(1) * db(0);
+        }
+        else
+        {
+            XTENSOR_THROW(std::runtime_error, "a or b did not have appropriate size 2 or 3.");
+        }
+        return res;
+    }
 
-                result.resize({static_cast<std::size_t>(o.shape()[1])});
+    /**
+     * Broadcasting cross product of the vectors along \em axis of \em a
+     * and \em b, as numpy.cross with axisa = axisb = axisc = axis.
+     *
+     * The other axes broadcast against each other. As in the two-argument
+     * form, vectors of 2 components have a third component of zero and the
+     * result always has 3 components along \em axis. For an (N, 3) array
+     * the default axis gives N cross products.
+     *
+     * @param a input array with 2 or 3 components along \em axis
+     * @param b input array with 2 or 3 components along \em axis
+     * @param axis axis of the vectors, negative values count from the end
+     * @return array of the cross products, xtensor when both ranks are static
+     */
+    template <class E1, class E2>
+    auto cross(const xexpression<E1>& a, const xexpression<E2>& b, std::ptrdiff_t axis)
+    {
+        using value_type = std::common_type_t<typename E1::value_type, typename E2::value_type>;
+        using result_type = typename detail::kron_result<value_type, typename E1::shape_type,
+                                                         typename E2::shape_type>::type;
+        const auto& da = detail::cross_eval<value_type>(a.derived_cast());
+        const auto& db = detail::cross_eval<value_type>(b.derived_cast());
 
-                blas_index_t shape_x, shape_y;
-                cxxblas::Transpose trans;
-                if (result.layout() != o.layout())
-                {
-                    shape_x = static_cast<blas_index_t>(o.shape()[1]);
-                    shape_y = static_cast<blas_index_t>(o.shape()[0]);
-                    trans = cxxblas::Transpose::NoTrans;
-                }
-                else
-                {
-                    shape_x = static_cast<blas_index_t>(o.shape()[0]);
-                    shape_y = static_cast<blas_index_t>(o.shape()[1]);
-                    trans = cxxblas::Transpose::Trans;
-                }
+        result_type res;
+        res.resize(detail::cross_shape(da, db, axis));
+        detail::cross_into_impl(da, db, res, axis);
+        return res;
+    }
 
-                cxxblas::gemv<blas_index_t>(
-                    get_blas_storage_order(result),
-                    trans,
-                    shape_x,
-                    shape_y,
-                    value_type(1.0),
-                    o.data() + o.data_offset(),
-                    get_leading_stride(o),
-                    t.data() + t.data_offset(),
-                    get_leading_stride(t),
-                    value_type(0.0),
-                    result.data(),
-                    get_leading_stride(result)
-                );
-            }
-            else if (t.dimension() == 2 && o.dimension() == 2)
-            {
-                XTENSOR_ASSERT(o.layout() == layout_type::row_major || o.layout() == layout_type::column_major);
-                XTENSOR_ASSERT(std::min(o.strides()[0], o.strides()[1]) <= 1);
-                XTENSOR_ASSERT(t.layout() == layout_type::row_major || t.layout() == layout_type::column_major);
-                XTENSOR_ASSERT(std::min(t.strides()[0], t.strides()[1]) <= 1);
+    /**
+     * Broadcasting cross product written into \em r, see cross(a, b, axis).
+     *
+     * @param a input array with 2 or 3 components along \em axis
+     * @param b input array with 2 or 3 components along \em axis
+     * @param r container with the shape of the result, overwritten
+     * @param axis axis of the vectors, negative values count from the end
+     * @return reference to \em r
+     */
+    template <class E1, class E2, class R>
+    R& cross_into(const xexpression<E1>& a, const xexpression<E2>& b, R& r, std::ptrdiff_t axis = -1)
+    {
+        using value_type = typename R::value_type;
+        const auto& da = detail::cross_eval<value_type>(a.derived_cast());
+        const auto& db = detail::cross_eval<value_type>(b.derived_cast());
+
+        auto shape = detail::cross_shape(da, db, axis);
+        if (r.dimension() != shape.size() || !std::equal(shape.begin(), shape.end(), r.shape().begin()))
+        {
+            XTENSOR_THROW(std::runtime_error, "cross_into: r must have the shape of the broadcast cross product.");
+        }
+        detail::cross_into_impl(da, db, r, axis);
+        return r;
+    }
 
-                if (t.shape()[1] != o.shape()[0])
-                {
-                    XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
-                }
+    namespace detail
+    {
+        constexpr std::ptrdiff_t tensordot_result_dimension(std::ptrdiff_t a_dim, std::ptrdiff_t b_dim, std::size_t naxes)
+        {
+            return (a_dim < 0 || b_dim < 0) ? -1 :
+                   (a_dim + b_dim - 2 * static_cast<std::ptrdiff_t>(naxes) > 1) ?
+                   a_dim + b_dim - 2 * static_cast<std::ptrdiff_t>(naxes) : 1;
+        }
+
+        template <class V, class E>
+        inline const V* matrix_data(const E& e, std::true_type)
+        {
+            return e.data() + e.data_offset();
+        }
 
-                cxxblas::Transpose transpose_A = cxxblas::Transpose::NoTrans,
-                                   transpose_B = cxxblas::Transpose::NoTrans;
+        template <class V, class E>
+        inline const V* matrix_data(const E&, std::false_type)
+        {
+            return nullptr;
+        }
 
-                if (result.layout() != t.layout())
+        /**
+         * Computes the single stride with which the axes [\em first, \em last)
+         * of \em e can be traversed when flattened in order \em l. Returns
+         * false if these axes do not collapse. Groups without non-trivial axes
+         * get a stride of 0.
+         */
+        template <class E>
+        inline bool collapse_axes(const E& e, std::size_t first, std::size_t last, layout_type l,
+                                  std::ptrdiff_t& stride)
+        {
+            stride = 0;
+            std::ptrdiff_t expected = 0;
+            for (std::size_t j = first; j < last; ++j)
+            {
+                std::size_t i = l == layout_type::row_major ? last - 1 - (j - first) : j;
+                if (e.shape()[i] == 1)
                 {
-                    transpose_A = cxxblas::Transpose::Trans;
+                    continue;
                 }
-                if (result.layout() != o.layout())
+                std::ptrdiff_t st = static_cast<std::ptrdiff_t>(e.strides()[i]);
+                if (st <= 0 || (expected != 0 && st != expected))
                 {
-                    transpose_B = cxxblas::Transpose::Trans;
+                    return false;
                 }
-
-                // This adds a fast path for A * A' by calling SYRK and only computing
-                // the upper triangle
-                if (std::is_same<typename T::value_type, typename O::value_type>::value &&
-                    (static_cast<const void*>(t.data() + t.data_offset()) == static_cast<const void*>(o.data() + o.data_offset())) &&
-                    ((transpose_A == cxxblas::Transpose::Trans && transpose_B == cxxblas::Transpose::NoTrans) ||
-                     (transpose_A == cxxblas::Transpose::NoTrans && transpose_B == cxxblas::Transpose::Trans)))
+                if (expected == 0)
                 {
-                    // TODO add check to compare strides & shape
-
-                    result.resize({static_cast<std::size_t>(t.shape()[0]), static_cast<std::size_t>(t.shape()[0])});
-
-                    cxxblas::syrk<blas_index_t>(
-                        get_blas_storage_order(result),
-                        cxxblas::StorageUpLo::Upper,
-                        transpose_A,
-                        static_cast<blas_index_t>(t.shape()[0]),
-                        static_cast<blas_index_t>(t.shape()[1]),
-                        value_type(1.0),
-                        t.data() + t.data_offset(),
-                        get_leading_stride(t),
-                        value_type(0.0),
-                        result.data(),
-                        get_leading_stride(result)
-                    );
-
-                    for (std::size_t i = 0; i < t.shape()[0]; ++i)
-                    {
-                        for (std::size_t j = i + 1; j < t.shape()[0]; ++j)
-                        {
-                            result(j, i) = result(i, j);
-                        }
-                    }
-                    return result;
+                    stride = st;
                 }
+                expected = st * static_cast<std::ptrdiff_t>(e.shape()[i]);
+            }
+            return true;
+        }
 
-                result.resize({static_cast<std::size_t>(t.shape()[0]), static_cast<std::size_t>(o.shape()[1])});
-
-                cxxblas::gemm<blas_index_t>(
-                    get_blas_storage_order(result),
-                    transpose_A,
-                    transpose_B,
-                    static_cast<blas_index_t>(t.shape()[0]),
-                    static_cast<blas_index_t>(o.shape()[1]),
-                    static_cast<blas_index_t>(o.shape()[0]),
-                    value_type(1.0),
-                    t.data() + t.data_offset(),
-                    get_leading_stride(t),
-                    o.data() + o.data_offset(),
-                    get_leading_stride(o),
-                    value_type(0.0),
-                    result.data(),
-                    get_leading_stride(result)
-                );
+        /**
+         * Checks whether \em e, with its first \em split axes flattened into
+         * \em rows and the remaining ones into \em cols, can be passed to GEMM
+         * as is for a product computed in storage order \em l. This covers
+         * transposed views and padded strides as long as each axis group
+         * collapses. On success, \em trans and \em ld describe the matrix to BLAS.
+         */
+        template <class E>
+        inline bool use_matrix_in_place(const E& e, std::size_t split, std::size_t rows, std::size_t cols, layout_type l,
+                                        cxxblas::Transpose& trans, blas_index_t& ld)
+        {
+            if (l != layout_type::row_major && l != layout_type::column_major)
+            {
+                return false;
             }
-            else
+            std::ptrdiff_t rs, cs;
+            if (!collapse_axes(e, 0, split, l, rs) || !collapse_axes(e, split, e.dimension(), l, cs))
             {
-                // TODO more testing for different layouts!
-                std::size_t l = t.shape().back();
-                std::size_t match_dim = 0;
-
-                if (o.dimension() > 1)
-                {
-                    match_dim = o.dimension() - 2;
-                }
-                if (o.shape()[match_dim] != l)
-                {
-                    XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
-                }
+                return false;
+            }
 
-                blas_index_t a_dim = static_cast<blas_index_t>(t.dimension());
-                blas_index_t b_dim = static_cast<blas_index_t>(o.dimension());
+            // In storage order l, the contiguous axis of the (rows, cols)
+            // matrix is cols for row major and rows for column major. The
+            // other axis gives the leading dimension.
+            bool row_major = l == layout_type::row_major;
+            std::ptrdiff_t fast = row_major ? cs : rs, slow = row_major ? rs : cs;
+            std::ptrdiff_t fast_len = static_cast<std::ptrdiff_t>(row_major ? cols : rows);
+            std::ptrdiff_t slow_len = static_cast<std::ptrdiff_t>(row_major ? rows : cols);
+            if (fast <= 1 && (slow == 0 || slow >= fast_len))
+            {
+                trans = cxxblas::Transpose::NoTrans;
+                ld = to_blas_index(std::max(std::max(slow, fast_len), std::ptrdiff_t(1)));
+                return true;
+            }
+            if (slow <= 1 && (fast == 0 || fast >= slow_len))
+            {
+                trans = cxxblas::Transpose::Trans;
+                ld = to_blas_index(std::max(std::max(fast, slow_len), std::ptrdiff_t(1)));
+                return true;
+            }
+            return false;
+        }
 
-                blas_index_t nd = a_dim + b_dim - 2;
+        /**
+         * Sum of products over the last \em naxes axes of \em a and the first
+         * \em naxes axes of \em b. The product is computed as a single matrix
+         * product written directly into the memory of the result.
+         */
+        template <class R, class A, class B>
+        inline R tensordot_impl(const A& a, const B& b, std::size_t naxes)
+        {
+            using value_type = typename R::value_type;
+            constexpr layout_type L = R::static_layout;
 
-                std::size_t j = 0;
-                std::vector<std::size_t> dimensions(static_cast<std::size_t>(nd));
+            XTENSOR_ASSERT(a.dimension() >= naxes);
+            XTENSOR_ASSERT(b.dimension() >= naxes);
 
-                for (blas_index_t i = 0; i < a_dim - 1; ++i)
-                {
-                    dimensions[j++] = t.shape()[static_cast<std::size_t>(i)];
-                }
-                for (blas_index_t i = 0; i < b_dim - 2; ++i)
-                {
-                    dimensions[j++] = o.shape()[static_cast<std::size_t>(i)];
-                }
-                if (b_dim > 1)
+            std::size_t a_keep = a.dimension() - naxes;
+            std::size_t sum_len = 1;
+            for (std::size_t i = 0; i < naxes; ++i)
+            {
+                // check for axes size match
+                if (a.shape()[a_keep + i] != b.shape()[i])
                 {
-                    dimensions[j++] = o.shape().back();
+                    XTENSOR_THROW(std::runtime_error, "Shape mismatch for sum");
                 }
+                sum_len *= a.shape()[i + a_keep];
+            }
 
-                result.resize(dimensions);
-
-                blas_index_t a_stride = static_cast<blas_index_t>(t.strides().back());
-                blas_index_t b_stride = static_cast<blas_index_t>(o.strides()[match_dim]);
-
-                auto a_iter = detail::offset_iter_without_axis<std::decay_t<decltype(t)>>(t, t.dimension() - 1);
-                auto b_iter = detail::offset_iter_without_axis<std::decay_t<decltype(o)>>(o, match_dim);
+            std::size_t b_keep = b.dimension() - naxes;
+            std::size_t result_dim = std::max(a_keep + b_keep, std::size_t(1));
+            auto result_shape = xtl::make_sequence<typename R::shape_type>(result_dim, std::size_t(1));
 
-                value_type temp;
-                auto result_it = result.begin();
+            std::size_t keep_a_len = 1;
+            for (std::size_t i = 0; i < a_keep; ++i)
+            {
+                keep_a_len *= a.shape()[i];
+                result_shape[i] = a.shape()[i];
+            }
+            std::size_t keep_b_len = 1;
+            for (std::size_t i = 0; i < b_keep; ++i)
+            {
+                keep_b_len *= b.shape()[naxes + i];
+                result_shape[a_keep + i] = b.shape()[naxes + i];
+            }
 
-                do
-                {
-                    do
-                    {
-                        cxxblas::dot<blas_index_t>(
-                            static_cast<blas_index_t>(l),
-                            t.data() + a_iter.offset(),
-                            a_stride,
-                            o.data() + b_iter.offset(),
-                            b_stride,
-                            temp
-                        );
-                        *(result_it++) = temp;
+            R result = R::from_shape(result_shape);
+            if (result.size() == 0)
+            {
+                return result;
+            }
+            if (sum_len == 0)
+            {
+                std::fill(result.begin(), result.end(), value_type(0));
+                return result;
+            }
 
-                    } while (b_iter.next());
+            // Operands whose axes already flatten to the required matrices are
+            // handed to GEMM directly, the others are copied into layout L.
+            xarray<value_type, L> a_copy, b_copy;
+            const value_type* a_ptr = nullptr;
+            const value_type* b_ptr = nullptr;
+            cxxblas::Transpose a_trans, b_trans;
+            blas_index_t lda, ldb;
 
-                } while (a_iter.next());
+            using a_same = std::is_same<typename A::value_type, value_type>;
+            using b_same = std::is_same<typename B::value_type, value_type>;
 
+            if (a_same::value && use_matrix_in_place(a, a_keep, keep_a_len, sum_len, L, a_trans, lda))
+            {
+                a_ptr = matrix_data<value_type>(a, a_same());
+            }
+            else
+            {
+                a_copy = a;
+                use_matrix_in_place(a_copy, a_keep, keep_a_len, sum_len, L, a_trans, lda);
+                a_ptr = a_copy.data();
+            }
+            if (b_same::value && use_matrix_in_place(b, naxes, sum_len, keep_b_len, L, b_trans, ldb))
+            {
+                b_ptr = matrix_data<value_type>(b, b_same());
             }
+            else
+            {
+                b_copy = b;
+                use_matrix_in_place(b_copy, naxes, sum_len, keep_b_len, L, b_trans, ldb);
+                b_ptr = b_copy.data();
+            }
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("tensordot", keep_a_len, keep_b_len, sum_len, L,
+                                         a_trans == cxxblas::Transpose::NoTrans ? 'N' : 'T',
+                                         b_trans == cxxblas::Transpose::NoTrans ? 'N' : 'T',
+                                         instrument::fma_flops<value_type>(double(keep_a_len) * double(keep_b_len) * double(sum_len)));
+            cxxblas::gemm<blas_index_t>(
+                L == layout_type::row_major ? cxxblas::StorageOrder::RowMajor : cxxblas::StorageOrder::ColMajor,
+                a_trans,
+                b_trans,
+                to_blas_index(keep_a_len),
+                to_blas_index(keep_b_len),
+                to_blas_index(sum_len),
+                value_type(1.0),
+                a_ptr,
+                lda,
+                b_ptr,
+                ldb,
+                value_type(0.0),
+                result.data(),
+                to_blas_index(L == layout_type::row_major ? keep_b_len : keep_a_len)
+            );
             return result;
         }
     }
 
     /**
-     * Computes the dot product for two vectors.
-     *
-     * Behaves different from \ref dot in the case of complex
-     * vectors. If vectors are complex, vdot conjugates the first
-     * argument \em t.
-     * Note: Unlike NumPy, xtensor-blas currently doesn't flatten
-     * the input arguments.
+     * @brief Compute tensor dot product along specified axes for arrays
      *
-     * @param t input vector (1D)
-     * @param o input vector (1D)
+     * Compute the sum of products along the last \em naxes axes of a and first
+     * \em naxes axes of b.
      *
+     * @param xa input array
+     * @param xb input array
+     * @param naxes the number of axes to sum over
      * @return resulting array
      */
     template <class T, class O>
-    auto vdot(const xexpression<T>& a, const xexpression<O>& b) {
-
-        using common_type = std::common_type_t<typename T::value_type, typename O::value_type>;
-
-        XTENSOR_ASSERT(a.derived_cast().dimension() == 1);
-        XTENSOR_ASSERT(b.derived_cast().dimension() == 1);
-
-        common_type result = 0;
-        blas::dot(a, b, result);
+    auto tensordot(const xexpression<T>& xa, const xexpression<O>& xb, std::size_t naxes = 2)
+    {
+        using traits = detail::dot_traits<T, O>;
+        using result_type = xarray<typename traits::value_type, traits::layout>;
 
-        return result;
+        auto&& a = view_eval<T::static_layout>(xa.derived_cast());
+        auto&& b = view_eval<O::static_layout>(xb.derived_cast());
+        return detail::tensordot_impl<result_type>(a, b, naxes);
     }
 
     /**
-     * Compute the outer product of two vectors.
+     * @brief Compute tensor dot product along the last \em N axes of a and the first
+     * \em N axes of b, with \em N known at compile time.
      *
-     * @param t input vector (1D)
-     * @param o input vector (1D)
+     * If the ranks of \em xa and \em xb are known at compile time as well, the
+     * result is an xtensor of rank ``max(dim(a) + dim(b) - 2 * N, 1)``.
      *
+     * @param xa input array
+     * @param xb input array
+     * @tparam N the number of axes to sum over
      * @return resulting array
      */
-    template <class T, class O>
-    auto outer(const xexpression<T>& a, const xexpression<O>& b) {
-        using common_type = std::common_type_t<typename T::value_type, typename O::value_type>;
-        using return_type = xtensor<common_type, 2>;
-
-        XTENSOR_ASSERT(a.derived_cast().dimension() == 1);
-        XTENSOR_ASSERT(b.derived_cast().dimension() == 1);
-
-        typename return_type::shape_type s = {a.derived_cast().shape()[0], b.derived_cast().shape()[0]};
-        return_type result(s, common_type(0));
-
-        blas::ger(a, b, result);
+    template <std::size_t N, class T, class O>
+    auto tensordot(const xexpression<T>& xa, const xexpression<O>& xb)
+    {
+        using traits = detail::dot_traits<T, O>;
+        using result_type = typename detail::fixed_rank_result<typename traits::value_type, traits::layout,
+                                                               detail::tensordot_result_dimension(traits::t_dim, traits::o_dim, N)>::type;
 
-        return result;
+        auto&& a = view_eval<T::static_layout>(xa.derived_cast());
+        auto&& b = view_eval<O::static_layout>(xb.derived_cast());
+        return detail::tensordot_impl<result_type>(a, b, N);
     }
 
     /**
-     * Compute the determinant by utilizing LU factorization
-     *
-     * @param A matrix for which determinant is to be computed
-     * @returns determinant of the \em A
+     * Axis permutations bringing the contracted axes of the operands of
+     * tensordot to the end of \em a and to the front of \em b. A plan only
+     * depends on the ranks of the operands and on the contracted axes, so it
+     * can be computed once and reused for repeated contractions.
      */
-    template <class T>
-    auto det(const xexpression<T>& A)
+    struct tensordot_plan
     {
-        using value_type = typename T::value_type;
-        assert_nd_square(A);
-
-        xtensor<value_type, 2, layout_type::column_major> LU = A.derived_cast();
-        uvector<blas_index_t> piv(std::min(LU.shape()[0], LU.shape()[1]));
-
-        lapack::getrf(LU, piv);
-
-        value_type result(1);
-        for (std::size_t i = 0; i < piv.size(); ++i)
-        {
-            if (piv[i] != int(i + 1))
-            {
-                result *= value_type(-1);
-            }
-        }
-
-        for (std::size_t i = 0; i < LU.shape()[0]; ++i)
-        {
-            result *= LU(i, i);
-        }
-        return result;
-    }
+        std::vector<std::size_t> perm_a;
+        std::vector<std::size_t> perm_b;
+        std::size_t naxes = 0;
+        bool permute_a = false;
+        bool permute_b = false;
+    };
 
     /**
-     * Compute the sign and (natural) logarithm of the determinant of an xexpression.
-     *
-     * If an array has a very small or very large determinant, then a call to det may
-     * overflow or underflow. This routine is more robust against such issues, because
-     * it computes the logarithm of the determinant rather than the determinant itself.
+     * @brief Plan a tensor dot product along the axes \em ax_a for a and \em ax_b for b
      *
-     * @param A matrix for which determinant is to be computed
-     * @returns tuple containing (sign, determinant)
+     * @param a_dim dimension of the first operand
+     * @param b_dim dimension of the second operand
+     * @param ax_a axes to sum over for \em a
+     * @param ax_b axes to sum over for \em b
+     * @return plan to pass to tensordot
      */
-    template <class T, std::enable_if_t<xtl::is_complex<typename T::value_type>::value, int> = 0>
-    auto slogdet(const xexpression<T>& A)
+    inline tensordot_plan make_tensordot_plan(std::size_t a_dim, std::size_t b_dim, const std::vector<std::size_t>& ax_a,
+                                              const std::vector<std::size_t>& ax_b)
     {
-        using value_type = typename T::value_type;
-        assert_nd_square(A);
-
-        xtensor<value_type, 2, layout_type::column_major> LU = A.derived_cast();
-        uvector<blas_index_t> piv(std::min(LU.shape()[0], LU.shape()[1]));
-
-        int info = lapack::getrf(LU, piv);
-
-        if (info != 0)
-        {
-            XTENSOR_THROW(std::runtime_error, "LU factorization did not compute.");
-        }
-
-        value_type result(0);
-        int sign = 0;
-        for (std::size_t i = 0; i < piv.size(); ++i)
+        XTENSOR_ASSERT(ax_a.size() == ax_b.size());
+        XTENSOR_ASSERT(ax_a.size() < a_dim);
+        XTENSOR_ASSERT(ax_b.size() < b_dim);
+        tensordot_plan plan;
+        plan.naxes = ax_a.size();
+        for (std::size_t i = 0; i < plan.naxes; ++i)
         {
-            sign += (piv[i] != int(i + 1));
+            XTENSOR_ASSERT(ax_a[i] < a_dim);
+            XTENSOR_ASSERT(ax_b[i] < b_dim);
         }
 
-        value_type v_sign = (sign % 2) ? -1 : 1;
-
-        for (std::size_t i = 0; i < LU.shape()[0]; ++i)
+        // Move the axes to sum over to the end of a
+        for (std::size_t i = 0; i < a_dim; ++i)
         {
-            auto abs_elem = std::abs(LU(i, i));
-            v_sign *= (LU(i, i) / abs_elem);
-            result += std::log(abs_elem);
+            if (std::find(ax_a.begin(), ax_a.end(), i) == ax_a.end())
+            {
+                plan.perm_a.push_back(i);
+            }
         }
-        return std::make_tuple(std::move(v_sign), std::move(result));
-    }
+        plan.perm_a.insert(plan.perm_a.end(), ax_a.begin(), ax_a.end());
 
-    /// @cond DOXYGEN_INCLUDE_SFINAE
-    template <class T, std::enable_if_t<!xtl::is_complex<typename T::value_type>::value, int> = 0>
-    auto slogdet(const xexpression<T>& A)
-    {
-        using value_type = typename T::value_type;
-        assert_nd_square(A);
-
-        xtensor<value_type, 2, layout_type::column_major> LU = A.derived_cast();
-        uvector<blas_index_t> piv(std::min(LU.shape()[0], LU.shape()[1]));
-
-        int info = lapack::getrf(LU, piv);
-
-        if (info != 0)
+        // Move the axes to sum over to the start of b
+        plan.perm_b.assign(ax_b.begin(), ax_b.end());
+        for (std::size_t i = 0; i < b_dim; ++i)
         {
-            return std::make_tuple(value_type(0),
-                                   -std::numeric_limits<value_type>::infinity());
+            if (std::find(ax_b.begin(), ax_b.end(), i) == ax_b.end())
+            {
+                plan.perm_b.push_back(i);
+            }
         }
 
-        value_type result(0);
-        int sign = 0;
-
-        for (std::size_t i = 0; i < piv.size(); ++i)
+        for (std::size_t i = 0; i < a_dim; ++i)
         {
-            sign += (piv[i] != int(i + 1));
+            plan.permute_a = plan.permute_a || plan.perm_a[i] != i;
         }
-
-        for (std::size_t i = 0; i < LU.shape()[0]; ++i)
+        for (std::size_t i = 0; i < b_dim; ++i)
         {
-            value_type abs_el = LU(i, i);
-            if (abs_el < 0)
-            {
-                sign += 1;
-                abs_el = -abs_el;
-            }
-            result += std::log(abs_el);
+            plan.permute_b = plan.permute_b || plan.perm_b[i] != i;
         }
-
-        value_type v_sign = (sign % 2) ? -1 : 1;
-        return std::make_tuple(std::move(v_sign), std::move(result));
+        return plan;
     }
-    /// @endcond
 
     namespace detail
     {
-        template <class E, class T>
-        inline auto call_gqr(E& A, T& tau, blas_index_t n)
-            -> std::enable_if_t<!xtl::is_complex<typename E::value_type>::value>
+        /**
+         * Element offsets, from the first element of \em e, of all the index
+         * combinations of the \em count axes \em axes, the last axis varying
+         * fastest if \em row_major and the first one otherwise. These are the
+         * scatter vectors of cxxblas::gemm_scatter.
+         */
+        template <class E>
+        inline std::vector<blas_index_t> scatter_offsets(const E& e, const std::size_t* axes, std::size_t count,
+                                                         bool row_major)
         {
-            int info = lapack::orgqr(A, tau, n);
-            if (info > 0)
+            std::vector<blas_index_t> offsets(1, 0);
+            for (std::size_t t = 0; t < count; ++t)
             {
-                XTENSOR_THROW(std::runtime_error, "Could not find Q (orgqr).");
+                std::size_t axis = axes[row_major ? t : count - 1 - t];
+                std::ptrdiff_t stride = static_cast<std::ptrdiff_t>(e.strides()[axis]);
+                std::size_t len = e.shape()[axis];
+                std::vector<blas_index_t> next;
+                next.reserve(offsets.size() * len);
+                for (blas_index_t o : offsets)
+                {
+                    for (std::size_t i = 0; i < len; ++i)
+                    {
+                        next.push_back(to_blas_index(o + stride * static_cast<std::ptrdiff_t>(i)));
+                    }
+                }
+                offsets.swap(next);
             }
+            return offsets;
         }
 
-        template <class E, class T>
-        inline auto call_gqr(E& A, T& tau, blas_index_t n)
-            -> std::enable_if_t<xtl::is_complex<typename E::value_type>::value>
+        /**
+         * Contraction of \em a and \em b according to \em plan with the
+         * operands read through scatter vectors: the generic GEMM kernel packs
+         * them from their own strides, so that neither is permuted or copied.
+         */
+        template <class R, class A, class B>
+        inline R tensordot_scatter(const A& a, const B& b, const tensordot_plan& plan)
         {
-            int info = lapack::ungqr(A, tau, n);
-            if (info > 0)
-            {
-                XTENSOR_THROW(std::runtime_error, "Could not find Q (ungqr).");
-            }
-        }
-    }
+            using value_type = typename R::value_type;
+            constexpr bool row_major = R::static_layout == layout_type::row_major;
 
-    namespace xblas_detail
-    {
-        template <class T>
-        inline void triu_inplace(T& R)
-        {
-            for (std::size_t i = 0; i < R.shape()[0]; ++i)
+            std::size_t naxes = plan.naxes;
+            std::size_t a_keep = a.dimension() - naxes;
+            std::size_t b_keep = b.dimension() - naxes;
+            const std::size_t* free_a = plan.perm_a.data();
+            const std::size_t* sum_a = free_a + a_keep;
+            const std::size_t* sum_b = plan.perm_b.data();
+            const std::size_t* free_b = sum_b + naxes;
+            for (std::size_t i = 0; i < naxes; ++i)
             {
-                for (std::size_t j = 0; j < i && j < R.shape()[1]; j++)
+                if (a.shape()[sum_a[i]] != b.shape()[sum_b[i]])
                 {
-                    R(i, j) = 0;
+                    XTENSOR_THROW(std::runtime_error, "Shape mismatch for sum");
                 }
             }
-        }
-    }
 
-    /// Select the mode for the qr decomposition ``K = min(M, K)``
-    enum class qrmode {
-        reduced,  ///< return Q, R with dimensions (M, K), (K, N) (default)
-        complete, ///< return Q, R with dimensions (M, M), (M, N)
-        r,        ///< return empty Q and R with dimensions (0, 0), (K, N)
-        raw       ///< return H, Tau with dimensions (N, M), (K, 1)
-    };
-
-    /**
-     * Compute the QR decomposition of \em A.
-     * @param t The matrix to calculate Q and R for
-     * @return std::tuple with Q and R
-     */
-    template <class T>
-    auto qr(const xexpression<T>& A, qrmode mode = qrmode::reduced)
-    {
-        using value_type = typename T::value_type;
-        using xtype = xarray<value_type, layout_type::column_major>;
-
-        xtype R = A.derived_cast();
-
-        std::size_t M = R.shape()[0];
-        std::size_t N = R.shape()[1];
-        std::size_t K = std::min(M, N);
+            auto result_shape = xtl::make_sequence<typename R::shape_type>(std::max(a_keep + b_keep, std::size_t(1)),
+                                                                           std::size_t(1));
+            for (std::size_t i = 0; i < a_keep; ++i)
+            {
+                result_shape[i] = a.shape()[free_a[i]];
+            }
+            for (std::size_t i = 0; i < b_keep; ++i)
+            {
+                result_shape[a_keep + i] = b.shape()[free_b[i]];
+            }
+            R result = R::from_shape(result_shape);
+            if (result.size() == 0)
+            {
+                return result;
+            }
 
-        auto tau = xarray<value_type, layout_type::column_major>::from_shape({K});
-        int info = lapack::geqrf(R, tau);
+            // the contracted axes are enumerated in the same order for both
+            auto rows_a = scatter_offsets(a, free_a, a_keep, row_major);
+            auto cols_a = scatter_offsets(a, sum_a, naxes, true);
+            auto rows_b = scatter_offsets(b, sum_b, naxes, true);
+            auto cols_b = scatter_offsets(b, free_b, b_keep, row_major);
+            blas_index_t m = to_blas_index(rows_a.size());
+            blas_index_t n = to_blas_index(cols_b.size());
+            blas_index_t k = to_blas_index(cols_a.size());
+            const value_type* pa = a.data() + a.data_offset();
+            const value_type* pb = b.data() + b.data_offset();
 
-        if (info != 0)
-        {
-            XTENSOR_THROW(std::runtime_error, "QR decomposition failed.");
+            XTENSOR_BLAS_INSTRUMENT_CALL("contract", rows_a.size(), cols_b.size(), cols_a.size(), R::static_layout, 'N', 'N',
+                                         instrument::fma_flops<value_type>(double(m) * double(n) * double(k)));
+            if (row_major)
+            {
+                // the row major result is the column major B^T A^T
+                cxxblas::gemm_scatter(n, m, k, value_type(1), pb, cols_b.data(), rows_b.data(),
+                                      pa, cols_a.data(), rows_a.data(), value_type(0), result.data(), n);
+            }
+            else
+            {
+                cxxblas::gemm_scatter(m, n, k, value_type(1), pa, rows_a.data(), cols_a.data(),
+                                      pb, rows_b.data(), cols_b.data(), value_type(0), result.data(), m);
+            }
+            return result;
         }
 
-        // explicitly set shape/size == 0!
-        auto Q = xtype::from_shape({0});
+        // whether the operand \em E of a contraction with value type \em V can be read in place
+        template <class V, class E>
+        using scatter_operand = std::integral_constant<bool, has_data_interface<E>::value &&
+                                                             std::is_same<typename E::value_type, V>::value>;
 
-        if (mode == qrmode::r)
+        template <class R, class A, class B>
+        inline R tensordot_permuted(const A& a, const B& b, const tensordot_plan& plan, std::true_type /*scatter*/)
         {
-            R = xt::view(R, range(0, K), all());
-            xblas_detail::triu_inplace(R);
-            return std::make_tuple(std::move(Q), std::move(R));
+            return tensordot_scatter<R>(a, b, plan);
         }
 
-        if (mode == qrmode::raw)
+        template <class R, class A, class B>
+        inline R tensordot_permuted(const A& a, const B& b, const tensordot_plan& plan, std::false_type /*scatter*/)
         {
-            R = transpose(R);
-            return std::make_tuple(std::move(R), std::move(tau));
+            return tensordot_impl<R>(xt::transpose(a, plan.perm_a), xt::transpose(b, plan.perm_b), plan.naxes);
         }
 
-        blas_index_t mc;
-
-        if (mode == qrmode::complete && M > N)
+        template <class V, class E>
+        inline const E& contract_operand(const E& e, std::true_type /*in place*/)
         {
-            mc = static_cast<blas_index_t>(M);
-            Q.resize({M, M});
+            return e;
         }
-        else
+
+        template <class V, class E>
+        inline xarray<V> contract_operand(const E& e, std::false_type /*in place*/)
         {
-            mc = static_cast<blas_index_t>(K);
-            Q.resize({M, N});
+            return xarray<V>(e);
         }
-
-        xt::view(Q, all(), range(0, N)) = R;
-        detail::call_gqr(Q, tau, mc);
-
-        Q = xt::view(Q, all(), range(0, mc));
-        R = xt::view(R, range(0, mc), all());
-
-        xblas_detail::triu_inplace(R);
-
-        return std::make_tuple(std::move(Q), std::move(R));
     }
 
     /**
-     * Compute the Cholesky decomposition of \em A.
-     * @return the decomposed matrix
+     * @brief Compute tensor dot product according to a precomputed plan
+     *
+     * The permutations of the plan are applied as strided views. Operands
+     * whose permuted axes still collapse to a (possibly transposed) matrix
+     * are passed to GEMM without being copied. When GEMM runs on the generic
+     * kernel, which packs its operands anyway, the other ones are packed
+     * from their own strides as in contract.
+     *
+     * @param xa input array
+     * @param xb input array
+     * @param plan plan returned by make_tensordot_plan
+     * @return resulting array
      */
-    template <class T>
-    auto cholesky(const xexpression<T>& A)
+    template <class T, class O>
+    auto tensordot(const xexpression<T>& xa, const xexpression<O>& xb, const tensordot_plan& plan)
     {
-        assert_nd_square(A);
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
-
-        int info = lapack::potr(M, 'L');
-
-        if (info > 0)
-        {
-            XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
-        }
+        using traits = detail::dot_traits<T, O>;
+        using result_type = xarray<typename traits::value_type, traits::layout>;
 
-        // delete upper triangle
-        XTENSOR_ASSERT(M.shape()[0] > 1 && M.shape()[1] > 1);
+        auto&& a = view_eval<T::static_layout>(xa.derived_cast());
+        auto&& b = view_eval<O::static_layout>(xb.derived_cast());
+        XTENSOR_ASSERT(plan.perm_a.size() == a.dimension());
+        XTENSOR_ASSERT(plan.perm_b.size() == b.dimension());
 
-        for (std::size_t i = 0; i < M.shape()[0]; ++i)
+        if (!plan.permute_a && !plan.permute_b)
         {
-            for (std::size_t j = i + 1; j < M.shape()[1]; ++j)
-            {
-                M(i, j) = 0;
-            }
+            return detail::tensordot_impl<result_type>(a, b, plan.naxes);
         }
-
-        return M;
+        using value_type = typename result_type::value_type;
+        using scatter = std::integral_constant<bool, cxxblas::GemmPackPanels<value_type>::value &&
+            detail::scatter_operand<value_type, std::decay_t<decltype(a)>>::value &&
+            detail::scatter_operand<value_type, std::decay_t<decltype(b)>>::value>;
+        return detail::tensordot_permuted<result_type>(a, b, plan, scatter());
     }
 
     /**
-    * Solves a system of linear equations M*X = B with a symmetric
-    * where M = A*A**T if uplo is L.
-    * Factorization of M can be computed with cholesky.
-    * @return solution X
-    */
-    template <class T, class D>
-    auto solve_cholesky(const xexpression<T>& A, const xexpression<D>& b)
+     * @brief Compute tensor dot product along specified axes for arrays
+     *
+     * Compute the sum of products along the axes \em ax_a for a and \em ax_b for b
+     *
+     * @param xa input array
+     * @param xb input array
+     * @param ax_a axes to sum over for \em a
+     * @param ax_b axes to sum over for \em b
+     * @return resulting array
+     */
+    template <class T, class O>
+    auto tensordot(const xexpression<T>& xa, const xexpression<O>& xb, const std::vector<std::size_t>& ax_a,
+                   const std::vector<std::size_t>& ax_b)
     {
-      assert_nd_square(A);
-      auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
-      auto p = copy_to_layout<layout_type::column_major>(b.derived_cast());
-
-      int info = lapack::potrs(M, p, 'L');
-
-      if (info > 0)
-      {
-        XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
-      }
-
-      return p;
+        std::size_t a_dim = xa.derived_cast().dimension();
+        std::size_t b_dim = xb.derived_cast().dimension();
+        return tensordot(xa, xb, make_tensordot_plan(a_dim, b_dim, ax_a, ax_b));
     }
 
     /**
-    * Solves Ax = b, where A is a lower triangular matrix
-    * @return solution x
-    */
-    template <class T, class D>
-    auto solve_triangular(const xexpression<T>& A, const xexpression<D>& b)
+     * @brief Tensor contraction without permuted copies of the operands
+     *
+     * Computes the same sum of products as tensordot, whatever the positions
+     * and strides of the contracted axes, by feeding the strided operands to
+     * the packing of the generic GEMM kernel (cxxblas::gemm_scatter): only
+     * the element offsets of their free and contracted index combinations
+     * are tabulated. This is used even with a BLAS driver, whose GEMM may be
+     * faster on matrices but would first need the operands permuted; only
+     * operands of another value type than the result are converted.
+     *
+     * @param xa input array
+     * @param xb input array
+     * @param plan plan returned by make_tensordot_plan
+     * @return resulting array, the free axes of \em a followed by those of \em b
+     */
+    template <class T, class O>
+    auto contract(const xexpression<T>& xa, const xexpression<O>& xb, const tensordot_plan& plan)
     {
-      assert_nd_square(A);
-      auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
-      auto p = copy_to_layout<layout_type::column_major>(b.derived_cast());
-
-      int info = lapack::trtrs(M, p, 'L', 'N');
+        using traits = detail::dot_traits<T, O>;
+        using result_type = xarray<typename traits::value_type, traits::layout>;
+        using value_type = typename result_type::value_type;
 
-      if (info > 0)
-      {
-        XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
-      }
+        auto&& ea = view_eval<T::static_layout>(xa.derived_cast());
+        auto&& eb = view_eval<O::static_layout>(xb.derived_cast());
+        using A = std::decay_t<decltype(ea)>;
+        using B = std::decay_t<decltype(eb)>;
+        XTENSOR_ASSERT(plan.perm_a.size() == ea.dimension());
+        XTENSOR_ASSERT(plan.perm_b.size() == eb.dimension());
 
-      return p;
+        const auto& a = detail::contract_operand<value_type>(ea, detail::scatter_operand<value_type, A>());
+        const auto& b = detail::contract_operand<value_type>(eb, detail::scatter_operand<value_type, B>());
+        return detail::tensordot_scatter<result_type>(a, b, plan);
     }
 
     /**
-     * Compute the SVD decomposition of \em A.
-     * @return tuple containing S, V, and D
+     * @brief Tensor contraction along the axes \em ax_a for a and \em ax_b for b
+     * without permuted copies of the operands, see contract with a plan
+     *
+     * @param xa input array
+     * @param xb input array
+     * @param ax_a axes to sum over for \em a
+     * @param ax_b axes to sum over for \em b
+     * @return resulting array
      */
-    template <class T>
-    auto svd(const xexpression<T>& A, bool full_matrices = true, bool compute_uv = true)
+    template <class T, class O>
+    auto contract(const xexpression<T>& xa, const xexpression<O>& xb, const std::vector<std::size_t>& ax_a,
+                  const std::vector<std::size_t>& ax_b)
     {
-        auto M = copy_to_layout<layout_type::column_major>(A.derived_cast());
-
-        char job_type = 'A';
-        if (!compute_uv)
-        {
-            job_type = 'N';
-        }
-        else if (!full_matrices && compute_uv)
-        {
-            job_type = 'S';
-        }
-
-        auto result = lapack::gesdd(M, job_type);
-
-        if (std::get<0>(result) > 0)
-        {
-            XTENSOR_THROW(std::runtime_error, "SVD decomposition failed.");
-        }
-
-        return std::make_tuple(std::move(std::get<1>(result)), std::move(std::get<2>(result)), std::move(std::get<3>(result)));
+        std::size_t a_dim = xa.derived_cast().dimension();
+        std::size_t b_dim = xb.derived_cast().dimension();
+        return contract(xa, xb, make_tensordot_plan(a_dim, b_dim, ax_a, ax_b));
     }
 
     /**
-     * Calculate Moore-Rose pseudo inverse using LAPACK SVD.
+     * Contraction order of an einsum: the subscripts of the operands and of
+     * the result, and the pairwise contractions to perform. Each step
+     * contracts the terms at positions first and second (first < second) of
+     * the current list of terms, removes them and appends the result to the
+     * list, as in opt_einsum. A plan depends on the subscripts and on the
+     * shapes of the operands only.
      */
-    template <class T>
-    auto pinv(const xexpression<T>& A, double rcond = 1e-15)
+    struct einsum_plan
     {
-        using value_type = typename T::value_type;
-        const auto& dA = A.derived_cast();
-
-        xtensor<value_type, 2, layout_type::column_major> M = xt::conj(dA);
-
-        auto gesdd_res = svd(M, false, true);
-
-        auto u = std::move(std::get<0>(gesdd_res));
-        auto s = std::move(std::get<1>(gesdd_res));
-        auto vt = std::move(std::get<2>(gesdd_res));
+        std::vector<std::string> inputs;
+        std::string output;
+        std::vector<std::pair<std::size_t, std::size_t>> path;
+        double flops = 0.;  ///< multiply-adds of the path
+    };
 
-        using real_value_type = typename decltype(s)::value_type;
-        real_value_type cutoff = static_cast<real_value_type>(rcond) * (*std::max_element(s.begin(), s.end()));
+    namespace detail
+    {
+        using einsum_dims = std::map<char, std::size_t>;
 
-        for (std::size_t i = 0; i < s.size(); ++i)
+        /**
+         * Returns the size of each label, checking that the subscripts match
+         * the shapes.
+         */
+        inline einsum_dims einsum_label_dims(const std::vector<std::string>& inputs,
+                                             const std::vector<std::vector<std::size_t>>& shapes)
         {
-            if (s(i) > cutoff)
+            if (inputs.size() != shapes.size())
             {
-                s(i) = real_value_type(1.) / s(i);
+                XTENSOR_THROW(std::runtime_error, "einsum: the number of operands does not match the subscripts.");
             }
-            else
+            einsum_dims dims;
+            for (std::size_t i = 0; i < inputs.size(); ++i)
             {
-                s(i) = 0;
+                if (inputs[i].size() != shapes[i].size())
+                {
+                    XTENSOR_THROW(std::runtime_error, "einsum: subscripts do not match the dimension of an operand.");
+                }
+                for (std::size_t j = 0; j < inputs[i].size(); ++j)
+                {
+                    auto it = dims.emplace(inputs[i][j], shapes[i][j]).first;
+                    if (it->second != shapes[i][j])
+                    {
+                        XTENSOR_THROW(std::runtime_error, "einsum: size mismatch for a label.");
+                    }
+                }
             }
+            return dims;
         }
-        auto ut = xt::transpose(u);
-        auto vww = xt::view(s, xt::all(), xt::newaxis());
-        auto m = xt::eval(vww * ut);
-        auto vtt = xt::transpose(vt);
-        auto result = dot(vtt, m);
-        return result;
-    }
-
-    /**
-     * Calculate matrix power A**n
-     *
-     * @param mat  The matrix
-     * @param n    The exponent
-     *
-     * @return resulting array
-     */
-    template <class E>
-    auto matrix_power(const xexpression<E>& A, long n)
-    {
-        using input_type = std::decay_t<E>;
-        using value_type = typename input_type::value_type;
-        using xtype = xtensor<value_type, 2>;
-
-        // copy input matrix
-        xtype mat = A.derived_cast();
 
-        XTENSOR_ASSERT(mat.dimension() == 2);
-        XTENSOR_ASSERT(mat.shape()[0] == mat.shape()[1]);
-
-        xtype res(mat.shape());
-        if (n == 0)
+        /**
+         * Parses ``"ij,jk->ik"``. Without ``->``, the output holds the labels
+         * that appear once, in alphabetical order.
+         */
+        inline void einsum_parse(const std::string& subscripts, std::vector<std::string>& inputs, std::string& output)
         {
-            res = eye(mat.shape()[0]);
-            return res;
-        }
-        else if (n < 0)
-        {
-            mat = inv(mat);
-            n = -n;
-        }
+            std::string s;
+            for (char c : subscripts)
+            {
+                if (c == '.')
+                {
+                    XTENSOR_THROW(std::runtime_error, "einsum: ellipsis is not supported.");
+                }
+                if (c != ' ')
+                {
+                    s.push_back(c);
+                }
+            }
+            std::size_t arrow = s.find("->");
+            std::string lhs = s.substr(0, arrow);
+            inputs.clear();
+            std::size_t start = 0;
+            while (true)
+            {
+                std::size_t comma = lhs.find(',', start);
+                inputs.push_back(lhs.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+                if (comma == std::string::npos)
+                {
+                    break;
+                }
+                start = comma + 1;
+            }
 
+            std::map<char, std::size_t> count;
+            for (const auto& in : inputs)
+            {
+                for (char c : in)
+                {
+                    if (!std::isalpha(static_cast<unsigned char>(c)))
+                    {
+                        XTENSOR_THROW(std::runtime_error, "einsum: invalid character in subscripts.");
+                    }
+                    ++count[c];
+                }
+            }
 
-        xtype temp(mat.shape());
-        res = mat;
-        if (n <= 3)
-        {
-            for (int i = 0; i < n - 1; ++i)
+            output.clear();
+            if (arrow == std::string::npos)
+            {
+                for (const auto& c : count)
+                {
+                    if (c.second == 1)
+                    {
+                        output.push_back(c.first);
+                    }
+                }
+                return;
+            }
+            output = s.substr(arrow + 2);
+            for (std::size_t i = 0; i < output.size(); ++i)
             {
-                blas::gemm(res, mat, temp);
-                res = temp;
+                if (count.find(output[i]) == count.end() || output.find(output[i]) != i)
+                {
+                    XTENSOR_THROW(std::runtime_error, "einsum: invalid output subscripts.");
+                }
             }
-            return res;
         }
 
-        // if n > 3, do a binary decomposition (copied from NumPy)
-        long bits, var = n, i = 0;
-        for(bits = 0; var != 0; ++bits)
-        {
-            var >>= 1;
-        }
-        while (~n & (1 << i))
+        /// Labels of \em labels that are in \em keep, without repetitions.
+        inline std::string einsum_kept_labels(const std::string& labels, const std::string& keep)
         {
-            blas::gemm(mat, mat, temp);
-            temp = res;
-            ++i;
-        }
-        ++i;
-        res = mat;
-        for (; i < bits; ++i)
-        {
-            blas::gemm(mat, mat, temp);
-            mat = temp;
-            if (n & (1 << i))
+            std::string result;
+            for (char c : labels)
             {
-                blas::gemm(res, mat, temp);
-                res = temp;
+                if (keep.find(c) != std::string::npos && result.find(c) == std::string::npos)
+                {
+                    result.push_back(c);
+                }
             }
+            return result;
         }
-        return res;
-    }
-
 
-    /**
-     * Compute the trace of a xexpression.
-     */
-    template <class T>
-    auto trace(const xexpression<T>& M, int offset = 0, int axis1 = 0, int axis2 = 1)
-    {
-        const auto& dM = M.derived_cast();
-        auto d = xt::diagonal(dM, offset, std::size_t(axis1), std::size_t(axis2));
-
-        std::size_t dim = d.dimension();
-        if (dim == 1)
+        /// Labels of all terms but \em i and \em j, followed by the output.
+        inline std::string einsum_other_labels(const std::vector<std::string>& terms, std::size_t i, std::size_t j,
+                                               const std::string& output)
         {
-            return xt::xarray<double>(xt::sum(d)());
+            std::string result = output;
+            for (std::size_t t = 0; t < terms.size(); ++t)
+            {
+                if (t != i && t != j)
+                {
+                    result += terms[t];
+                }
+            }
+            return result;
         }
-        else
+
+        inline double einsum_pair_flops(const std::string& x, const std::string& y, const einsum_dims& dims)
         {
-            return xt::xarray<double>(xt::sum(d, {dim - 1}));
+            std::string all = einsum_kept_labels(x + y, x + y);
+            double flops = 1.;
+            for (char c : all)
+            {
+                flops *= double(dims.at(c));
+            }
+            return flops;
         }
-    }
-
-    /**
-     * Calculate the Kronecker product between two 2D xexpressions.
-     */
-    template <class T, class E>
-    auto kron(const xexpression<T>& a, const xexpression<E>& b)
-    {
-        using value_type = std::common_type_t<typename T::value_type, typename E::value_type>;
 
-        const auto& da = a.derived_cast();
-        const auto& db = b.derived_cast();
-
-        XTENSOR_ASSERT(da.dimension() == 2);
-        XTENSOR_ASSERT(db.dimension() == 2);
-
-        std::array<std::size_t, 2> shp = {da.shape()[0] * db.shape()[0], da.shape()[1] * db.shape()[1]};
-        xtensor<value_type, 2> res(shp);
-
-        for (std::size_t i = 0; i < da.shape()[0]; ++i)
+        /**
+         * Searches the cheapest path by exhaustive search, the number of
+         * paths grows as (n!)^2 / 2^n so this is limited to a few terms.
+         */
+        inline void einsum_optimal_path(std::vector<std::string>& terms, const std::string& output,
+                                        const einsum_dims& dims, double cost,
+                                        std::vector<std::pair<std::size_t, std::size_t>>& path,
+                                        std::vector<std::pair<std::size_t, std::size_t>>& best_path,
+                                        double& best_cost)
         {
-            for (std::size_t j = 0; j < da.shape()[1]; ++j)
+            if (terms.size() == 1)
+            {
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_path = path;
+                }
+                return;
+            }
+            for (std::size_t i = 0; i + 1 < terms.size(); ++i)
             {
-                for (std::size_t k = 0; k < db.shape()[0]; ++k)
+                for (std::size_t j = i + 1; j < terms.size(); ++j)
                 {
-                    for (std::size_t h = 0; h < db.shape()[1]; ++h)
+                    double c = cost + einsum_pair_flops(terms[i], terms[j], dims);
+                    if (c >= best_cost)
                     {
-                        res(i * db.shape()[0] + k, j * db.shape()[1] + h) = da(i, j) * db(k, h);
+                        continue;
                     }
+                    std::string x = terms[i], y = terms[j];
+                    std::string r = einsum_kept_labels(x + y, einsum_other_labels(terms, i, j, output));
+                    terms.erase(terms.begin() + std::ptrdiff_t(j));
+                    terms.erase(terms.begin() + std::ptrdiff_t(i));
+                    terms.push_back(r);
+                    path.emplace_back(i, j);
+                    einsum_optimal_path(terms, output, dims, c, path, best_path, best_cost);
+                    path.pop_back();
+                    terms.pop_back();
+                    terms.insert(terms.begin() + std::ptrdiff_t(i), x);
+                    terms.insert(terms.begin() + std::ptrdiff_t(j), y);
                 }
             }
         }
 
-        return res;
-    }
-
-    /**
-     * Calculate the matrix rank of \ref m.
-     * If tol == -1, the tolerance is automatically computed.
-     *
-     * @param m matrix for which rank is calculated
-     * @param tol tolerance for finding rank
-     */
-    template <class T>
-    int matrix_rank(const xexpression<T>& m, double tol = -1.0)
-    {
-        using value_type = typename T::value_type;
-        xtensor<value_type, 2, layout_type::column_major> M = m.derived_cast();
-
-        auto svd_res = svd(m, true, false);
-        auto s = std::get<1>(svd_res);
-        auto max_el = std::max_element(s.begin(), s.end());
-
-        if (tol == -1.0)
-        {
-            tol = (*max_el) * static_cast<double>(std::max(M.shape()[0], M.shape()[1])) * std::numeric_limits<value_type>::epsilon();
-        }
-
-        int sm = 0;
-        for (const auto& el : s)
+        /// Contracts the cheapest pair first.
+        inline double einsum_greedy_path(std::vector<std::string> terms, const std::string& output,
+                                         const einsum_dims& dims,
+                                         std::vector<std::pair<std::size_t, std::size_t>>& path)
         {
-            if (el > tol)
+            double cost = 0.;
+            while (terms.size() > 1)
             {
-                ++sm;
+                std::size_t bi = 0, bj = 1;
+                double best = std::numeric_limits<double>::infinity();
+                for (std::size_t i = 0; i + 1 < terms.size(); ++i)
+                {
+                    for (std::size_t j = i + 1; j < terms.size(); ++j)
+                    {
+                        double c = einsum_pair_flops(terms[i], terms[j], dims);
+                        if (c < best)
+                        {
+                            best = c;
+                            bi = i;
+                            bj = j;
+                        }
+                    }
+                }
+                std::string r = einsum_kept_labels(terms[bi] + terms[bj], einsum_other_labels(terms, bi, bj, output));
+                terms.erase(terms.begin() + std::ptrdiff_t(bj));
+                terms.erase(terms.begin() + std::ptrdiff_t(bi));
+                terms.push_back(r);
+                path.emplace_back(bi, bj);
+                cost += best;
             }
+            return cost;
         }
-        return sm;
-    }
 
-    /**
-     * Calculate the least-squares solution to a linear matrix equation.
-     *
-     * @param A coefficient matrix
-     * @param b Ordinate, or dependent variable values. If b is two-dimensional,
-     *          the least-squares solution is calculated for each of the K columns of b.
-     * @param rcond Cut-off ratio for small singular values of \em A.
-     *              For the purposes of rank determination, singular values are treated
-     *              as zero if they are smaller than rcond times the largest singular value of a.
-     *
-     * @return tuple containing (x, residuals, rank, s) where:
-     *         \em x is the least squares solution. Note that the solution is always returned as
-     *               a 2D matrix where the columns are the solutions (even for a 1D \em b).
-     *         \em s Sums of residuals; squared Euclidean 2-norm for each column in b - a*x.
-     *               If the rank of \em A is < N or M <= N, this is an empty xtensor.
-     *         \em rank the rank of \em A
-     *         \em s singular values of \em A
-     */
-    template <class T, class E>
-    auto lstsq(const xexpression<T>& A, const xexpression<E>& b, double rcond = -1.0)
-    {
-        using value_type = typename T::value_type;
-        using underlying_value_type = xtl::complex_value_type_t<typename T::value_type>;
+        constexpr std::size_t einsum_optimal_max_terms = 5;
 
-        xtensor<value_type, 2, layout_type::column_major> dA = A.derived_cast();
+        /**
+         * Sums over the labels of \em in missing from \em out, takes the
+         * diagonal of repeated labels and orders the axes as \em out.
+         */
+        template <class V>
+        inline xarray<V> einsum_unary(const xarray<V>& src, const std::string& in, const std::string& out,
+                                      const einsum_dims& dims)
+        {
+            std::string loop = einsum_kept_labels(in, in);
+            std::vector<std::size_t> out_shape;
+            for (char c : out)
+            {
+                out_shape.push_back(dims.at(c));
+            }
+            xarray<V> result = xarray<V>::from_shape(out_shape);
+            std::fill(result.begin(), result.end(), V(0));
 
-        std::size_t M = dA.shape()[0];
-        std::size_t N = dA.shape()[1];
+            // offsets of one step of each loop label in src and result
+            std::vector<std::ptrdiff_t> src_step(loop.size(), 0), out_step(loop.size(), 0);
+            std::vector<std::size_t> extent(loop.size());
+            std::size_t total = 1;
+            for (std::size_t l = 0; l < loop.size(); ++l)
+            {
+                for (std::size_t i = 0; i < in.size(); ++i)
+                {
+                    if (in[i] == loop[l])
+                    {
+                        src_step[l] += static_cast<std::ptrdiff_t>(src.strides()[i]);
+                    }
+                }
+                std::size_t o = out.find(loop[l]);
+                if (o != std::string::npos)
+                {
+                    out_step[l] = static_cast<std::ptrdiff_t>(result.strides()[o]);
+                }
+                extent[l] = dims.at(loop[l]);
+                total *= extent[l];
+            }
 
-        auto& b_ref = b.derived_cast();
+            const V* src_data = src.data() + src.data_offset();
+            V* out_data = result.data();
+            std::vector<std::size_t> idx(loop.size(), 0);
+            std::ptrdiff_t src_offset = 0, out_offset = 0;
+            for (std::size_t p = 0; p < total; ++p)
+            {
+                out_data[out_offset] += src_data[src_offset];
+                for (std::size_t l = loop.size(); l != 0; --l)
+                {
+                    if (++idx[l - 1] < extent[l - 1])
+                    {
+                        src_offset += src_step[l - 1];
+                        out_offset += out_step[l - 1];
+                        break;
+                    }
+                    src_offset -= static_cast<std::ptrdiff_t>(idx[l - 1] - 1) * src_step[l - 1];
+                    out_offset -= static_cast<std::ptrdiff_t>(idx[l - 1] - 1) * out_step[l - 1];
+                    idx[l - 1] = 0;
+                }
+            }
+            return result;
+        }
 
-        if (dA.dimension() != 2)
+        template <class V, class E>
+        inline xarray<V> einsum_unary(const E& e, const std::string& in, const std::string& out,
+                                      const einsum_dims& dims)
         {
-            XTENSOR_THROW(std::runtime_error, "Expected 2D expression for A");
+            xarray<V> src = e;
+            return einsum_unary<V>(src, in, out, dims);
         }
 
-        if (!(b_ref.dimension() <= 2))
+        inline std::vector<std::size_t> einsum_axes(const std::string& labels, const std::string& selected)
         {
-            XTENSOR_THROW(std::runtime_error, "Expected 1- or 2D expression for A.");
+            std::vector<std::size_t> axes;
+            for (char c : selected)
+            {
+                axes.push_back(labels.find(c));
+            }
+            return axes;
         }
 
-        if (b_ref.shape()[0] != M)
+        /**
+         * Contracts the terms \em a with labels \em x and \em b with labels
+         * \em y, keeping the labels of \em keep. Labels of a single term that
+         * are not kept are summed first. Without batch labels (in x, y and
+         * keep) the contraction is a tensordot, which hands operands whose
+         * axes collapse to GEMM without copying them, otherwise the
+         * operands are copied to stacks of matrices for a batched GEMM.
+         * Sets \em labels to the labels of the result.
+         */
+        template <class V, class A, class B>
+        inline xarray<V> einsum_pair(const std::string& x, const A& a, const std::string& y, const B& b,
+                                     const std::string& keep, const einsum_dims& dims, std::string& labels)
         {
-            XTENSOR_THROW(std::runtime_error, "Shape of 'b' for lstsq does not match.");
-        }
+            std::string xr = einsum_kept_labels(x, y + keep);
+            if (xr != x)
+            {
+                xarray<V> ra = einsum_unary<V>(a, x, xr, dims);
+                return einsum_pair<V>(xr, ra, y, b, keep, dims, labels);
+            }
+            std::string yr = einsum_kept_labels(y, x + keep);
+            if (yr != y)
+            {
+                xarray<V> rb = einsum_unary<V>(b, y, yr, dims);
+                return einsum_pair<V>(x, a, yr, rb, keep, dims, labels);
+            }
 
-        // find number of rhs
-        std::size_t nrhs = (b_ref.dimension() == 1) ? 1 : b_ref.shape()[1];
+            std::string batch, contracted, free_a, free_b;
+            for (char c : x)
+            {
+                bool in_b = y.find(c) != std::string::npos;
+                bool kept = keep.find(c) != std::string::npos;
+                (in_b ? (kept ? batch : contracted) : free_a).push_back(c);
+            }
+            for (char c : y)
+            {
+                if (x.find(c) == std::string::npos)
+                {
+                    free_b.push_back(c);
+                }
+            }
 
-        // as the dgelsd docs say, on entry it's M-by-nrhs, then result N-by-nrhs
-        // that is why we need to allocate *MORE* space than just b here for M > N
-        auto db = xarray<value_type, layout_type::column_major>::from_shape({ std::max(M, N), nrhs });
+            auto&& ea = view_eval<A::static_layout>(a);
+            auto&& eb = view_eval<B::static_layout>(b);
+            if (batch.empty())
+            {
+                labels = free_a + free_b;
+                xarray<V> result = tensordot_impl<xarray<V>>(xt::transpose(ea, einsum_axes(x, free_a + contracted)),
+                                                             xt::transpose(eb, einsum_axes(y, contracted + free_b)),
+                                                             contracted.size());
+                if (labels.empty())
+                {
+                    result.reshape(std::vector<std::size_t>());
+                }
+                return result;
+            }
 
-        bool is_1d = false;
-        if (b_ref.dimension() == 1)
-        {
-            is_1d = true;
-            xt::view(db, range(0, M), xt::all()) = xt::view(b_ref, xt::all(), xt::newaxis());
-        }
-        else
-        {
-            xt::view(db, range(0, M), xt::all()) = b_ref;
+            auto extent = [&dims](const std::string& l) {
+                std::size_t n = 1;
+                for (char c : l)
+                {
+                    n *= dims.at(c);
+                }
+                return n;
+            };
+            std::size_t nb = extent(batch), m = extent(free_a), k = extent(contracted), n = extent(free_b);
+            xarray<V> sa = xt::transpose(ea, einsum_axes(x, batch + free_a + contracted));
+            xarray<V> sb = xt::transpose(eb, einsum_axes(y, batch + contracted + free_b));
+            sa.reshape(std::vector<std::size_t>{nb, m, k});
+            sb.reshape(std::vector<std::size_t>{nb, k, n});
+            xarray<V> result = matmul(sa, sb);
+
+            labels = batch + free_a + free_b;
+            std::vector<std::size_t> shape;
+            for (char c : labels)
+            {
+                shape.push_back(dims.at(c));
+            }
+            result.reshape(shape);
+            return result;
         }
 
-        auto s = xtensor<underlying_value_type, 1, layout_type::column_major>::from_shape({ std::min(M, N) });
+        /**
+         * Runs the path of \em plan. \em operand(i, f) calls f with the i-th
+         * operand.
+         */
+        template <class V, class F>
+        inline xarray<V> einsum_impl(const einsum_plan& plan, const std::vector<std::vector<std::size_t>>& shapes,
+                                     const F& operand)
+        {
+            einsum_dims dims = einsum_label_dims(plan.inputs, shapes);
 
-        blas_index_t rank;
+            // a term is an operand (index < #operands) or an intermediate result
+            std::size_t n = plan.inputs.size();
+            std::vector<std::string> labels = plan.inputs;
+            std::vector<std::size_t> terms(n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                terms[i] = i;
+            }
+            std::vector<xarray<V>> results;
+            results.reserve(plan.path.size());
 
-        lapack::gelsd(dA, db, s, rank, rcond);
-        auto residuals = xtensor<underlying_value_type, 1>::from_shape({0});
+            auto with_term = [&](std::size_t t, auto&& f) {
+                if (t < n)
+                {
+                    operand(t, f);
+                }
+                else
+                {
+                    f(results[t - n]);
+                }
+            };
 
-        if (std::size_t(rank) == N && M > N)
-        {
-            residuals.resize({ db.shape()[1] });
-            for (std::size_t i = 0; i < db.shape()[1]; ++i)
+            for (const auto& step : plan.path)
             {
-                underlying_value_type temp = 0;
-                for (std::size_t j = N; j < db.shape()[0]; ++j)
+                std::size_t i = step.first, j = step.second;
+                std::string keep = einsum_other_labels(labels, i, j, plan.output);
+                std::string r;
+                xarray<V> result;
+                with_term(terms[i], [&](const auto& a) {
+                    with_term(terms[j], [&](const auto& b) {
+                        result = einsum_pair<V>(labels[i], a, labels[j], b, keep, dims, r);
+                    });
+                });
+
+                // intermediates are not used again once contracted
+                if (terms[i] >= n)
+                {
+                    results[terms[i] - n] = xarray<V>();
+                }
+                if (terms[j] >= n)
                 {
-                    temp += std::pow(std::abs(db(j, i)), 2);
+                    results[terms[j] - n] = xarray<V>();
                 }
-                residuals(i) = temp;
+                results.push_back(std::move(result));
+                labels.erase(labels.begin() + std::ptrdiff_t(j));
+                labels.erase(labels.begin() + std::ptrdiff_t(i));
+                terms.erase(terms.begin() + std::ptrdiff_t(j));
+                terms.erase(terms.begin() + std::ptrdiff_t(i));
+                labels.push_back(r);
+                terms.push_back(n + results.size() - 1);
+            }
+
+            if (terms[0] >= n && labels[0] == plan.output)
+            {
+                return std::move(results.back());
             }
+            xarray<V> result;
+            with_term(terms[0], [&](const auto& a) {
+                result = einsum_unary<V>(a, labels[0], plan.output, dims);
+            });
+            return result;
         }
 
-        auto vdb = view(db, range(std::size_t(0), N), xt::all());
-        db = vdb;
-        if (is_1d)
+        template <class E>
+        inline std::vector<std::size_t> einsum_shape(const E& e)
         {
-            db = xt::squeeze(db);
+            return std::vector<std::size_t>(e.shape().begin(), e.shape().end());
         }
 
-        return std::make_tuple(std::move(db), std::move(residuals), std::move(rank), std::move(s));
+        inline std::map<std::string, einsum_plan>& einsum_plan_cache()
+        {
+            thread_local std::map<std::string, einsum_plan> cache;
+            return cache;
+        }
+
+        constexpr std::size_t einsum_plan_cache_capacity = 256;
     }
 
     /**
-     * @brief Non-broadcasting cross product between two vectors.
+     * @brief Plan an einsum contraction
      *
-     * Calculate cross product between two 1D vectors with 2- or 3 entries.
-     * If only two entries are available, the third entry is assumed to be 0.
+     * Parses the subscripts and searches the order of pairwise contractions
+     * with the fewest multiply-adds: by exhaustive search up to five
+     * operands, else greedily.
      *
-     * @param a input vector
-     * @param b input vector
-     * @return resulting array
+     * @param subscripts subscripts as for NumPy's einsum, without ellipsis
+     * @param shapes shapes of the operands
+     * @return plan to pass to einsum
      */
-    template <class E1, class E2>
-    auto cross(const xexpression<E1>& a, const xexpression<E2>& b)
+    inline einsum_plan make_einsum_plan(const std::string& subscripts,
+                                        const std::vector<std::vector<std::size_t>>& shapes)
     {
-        using return_type = xtensor<typename E1::value_type, 1>;
-        auto res = return_type::from_shape({ 3 });
-        const E1& da = a.derived_cast();
-        const E2& db = b.derived_cast();
-
-        if (da.size() == 3 && db.size() == 3)
-        {
-            res(0) = da(1) * db(2) - da(2) * db(1);
-            res(1) = da(2) * db(0) - da(0) * db(2);
-            res(2) = da(0) * db(1) - da(1) * db(0);
-        }
-        else if (da.size() == 2 && db.size() == 3)
-        {
-            res(0) =   da(1) * db(2);
-            res(1) = -(da(0) * db(2));
-            res(2) =   da(0) * db(1) - da(1) * db(0);
-        }
-        else if (da.size() == 3 && db.size() == 2)
-        {
-            res(0) = -(da(2) * db(1));
-            res(1) =   da(2) * db(0);
-            res(2) =   da(0) * db(1) - da(1) * db(0);
-        }
-        else if (da.size() == 2 && db.size() == 2)
+        einsum_plan plan;
+        detail::einsum_parse(subscripts, plan.inputs, plan.output);
+        auto dims = detail::einsum_label_dims(plan.inputs, shapes);
+        if (plan.inputs.size() <= detail::einsum_optimal_max_terms)
         {
-            res(0) = 0;
-            res(1) = 0;
-            res(2) = da(0) * db(1) - da(1) * db(0);
+            std::vector<std::string> terms = plan.inputs;
+            std::vector<std::pair<std::size_t, std::size_t>> path;
+            plan.flops = std::numeric_limits<double>::infinity();
+            detail::einsum_optimal_path(terms, plan.output, dims, 0., path, plan.path, plan.flops);
         }
         else
         {
-            XTENSOR_THROW(std::runtime_error, "a or b did not have appropriate size 2 or 3.");
+            plan.flops = detail::einsum_greedy_path(plan.inputs, plan.output, dims, plan.path);
         }
-        return res;
+        return plan;
     }
 
     /**
-     * @brief Compute tensor dot product along specified axes for arrays
-     *
-     * Compute the sum of products along the last \em naxes axes of a and first
-     * \em naxes axes of b.
+     * @brief Evaluate an einsum contraction according to a precomputed plan
      *
-     * @param xa input array
-     * @param xb input array
-     * @param naxes the number of axes to sum over
+     * @param plan plan returned by make_einsum_plan
+     * @param operands input arrays
      * @return resulting array
      */
-    template <class T, class O>
-    auto tensordot(const xexpression<T>& xa, const xexpression<O>& xb, std::size_t naxes = 2)
+    template <class... E>
+    auto einsum(const einsum_plan& plan, const xexpression<E>&... operands)
     {
-        using value_type = std::common_type_t<typename T::value_type, typename O::value_type>;
-        using result_type = std::conditional_t<T::static_layout == O::static_layout &&
-                                               (T::static_layout != layout_type::dynamic && T::static_layout != layout_type::any),
-                                               xarray<value_type, T::static_layout>,
-                                               xarray<value_type, XTENSOR_DEFAULT_LAYOUT>>;
+        using value_type = std::common_type_t<typename E::value_type...>;
+        auto args = std::forward_as_tuple(operands.derived_cast()...);
+        auto operand = [&args](std::size_t i, auto& f) { detail::visit_operand(args, i, f); };
+        return detail::einsum_impl<value_type>(plan, {detail::einsum_shape(operands.derived_cast())...}, operand);
+    }
 
-        result_type result;
-        auto&& a = view_eval<T::static_layout>(xa.derived_cast());
-        auto&& b = view_eval<O::static_layout>(xb.derived_cast());
-        if (naxes == 0)
+    /**
+     * @brief Evaluate the Einstein summation convention on the operands
+     *
+     * \code{.cpp}
+     * // batched matrix product over i
+     * auto c = linalg::einsum("ijk,ikl->ijl", a, b);
+     * \endcode
+     *
+     * Contractions are evaluated pairwise in the order of make_einsum_plan,
+     * each step as a single GEMM, or a batched GEMM for labels shared by
+     * both terms and the result. The plans are cached per thread for each
+     * subscripts and shapes.
+     *
+     * @param subscripts subscripts as for NumPy's einsum, without ellipsis
+     * @param operands input arrays
+     * @return resulting array
+     */
+    template <class... E>
+    auto einsum(const std::string& subscripts, const xexpression<E>&... operands)
+    {
+        std::vector<std::vector<std::size_t>> shapes = {detail::einsum_shape(operands.derived_cast())...};
+        std::string key = subscripts;
+        for (const auto& s : shapes)
         {
-            // special case tensor outer product product
-            xt::dynamic_shape<std::size_t> result_shape(a.dimension() + b.dimension());
-            std::size_t j = 0;
-            for (std::size_t i = 0; i < a.dimension(); ++i)
-            {
-                result_shape[j++] = a.shape()[i];
-            }
-
-            for (std::size_t i = 0; i < b.dimension(); ++i)
+            key.push_back('|');
+            for (std::size_t d : s)
             {
-                result_shape[j++] = b.shape()[i];
+                key += std::to_string(d) + ',';
             }
-            // flatten a/b
-            auto vec_a = xt::ravel<result_type::static_layout>(a);
-            auto vec_b = xt::ravel<result_type::static_layout>(b);
-            // take the outer product of the two vectors
-            result = outer(vec_a, vec_b);
-            // reshape the result
-            result.reshape(result_shape);
         }
-        else
+        auto& cache = detail::einsum_plan_cache();
+        auto it = cache.find(key);
+        if (it == cache.end())
         {
-            // Sum of products over last n axes of A and the first n axis of b
-            XTENSOR_ASSERT(a.dimension() >= naxes);
-            XTENSOR_ASSERT(b.dimension() >= naxes);
-
-            auto as_it = a.shape().begin() + (a.dimension() - naxes);
-            auto bs_it = b.shape().begin();
-            std::size_t sum_len = 1;
-            for (std::size_t i = 0; i < naxes; ++i)
-            {
-                auto a_val = *as_it;
-                auto b_val = *bs_it;
-                // check for axes size match
-                if (a_val != b_val)
-                {
-                    XTENSOR_THROW(std::runtime_error, "Shape mismatch for sum");
-                }
-                else
-                {
-                    sum_len *= a_val;
-                }
-                ++as_it;
-                ++bs_it;
-            }
-            xt::dynamic_shape<std::size_t> result_shape;
-            std::size_t keep_a_len = 1;
-            for (auto it = a.shape().begin(); it != a.shape().begin() + (a.dimension() - naxes); ++it)
-            {
-                std::size_t len = *it;
-                keep_a_len *= len;
-                result_shape.push_back(len);
-            }
-            std::size_t keep_b_len = 1;
-            for (auto it = b.shape().begin() + naxes; it != b.shape().end(); ++it)
+            if (cache.size() >= detail::einsum_plan_cache_capacity)
             {
-                std::size_t len = *it;
-                keep_b_len *= len;
-                result_shape.push_back(len);
+                cache.clear();
             }
-            xarray<value_type, T::static_layout> a_mat = a;
-            a_mat.reshape({keep_a_len, sum_len});
-            xarray<value_type, O::static_layout> b_mat = b;
-            b_mat.reshape({sum_len, keep_b_len});
-            result = dot(a_mat, b_mat);
-            if(result_shape.empty())
+            it = cache.emplace(key, make_einsum_plan(subscripts, shapes)).first;
+        }
+        return einsum(it->second, operands...);
+    }
+
+    /****************************
+     * random matrix generators *
+     ****************************/
+
+    /**
+     * Distribution of the entries of linalg::random_matrix, those of the
+     * LAPACK larnv generator. For complex matrices the real and imaginary
+     * parts are drawn independently from it.
+     */
+    enum class random_distribution {
+        uniform = 1,            ///< uniform on (0, 1)
+        symmetric_uniform = 2,  ///< uniform on (-1, 1)
+        normal = 3              ///< standard normal
+    };
+
+    namespace detail
+    {
+        /// Entries drawn from one larnv stream; a fixed size, so that the values do not depend on the thread count.
+        constexpr std::size_t random_chunk_size = std::size_t(1) << 14;
+
+        /// larnv seed of the stream \em chunk: four 12-bit integers, the last one odd.
+        inline std::array<blas_index_t, 4> random_stream_seed(std::uint64_t seed, std::uint64_t chunk)
+        {
+            // splitmix64, so that neighbouring seeds and chunks give unrelated streams
+            std::uint64_t z = seed + 0x9E3779B97F4A7C15ull * (chunk + 1);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            std::array<blas_index_t, 4> iseed;
+            for (std::size_t i = 0; i < 4; ++i)
             {
-                result.reshape({1});
+                iseed[i] = static_cast<blas_index_t>((z >> (12 * i)) & 0xFFF);
             }
-            else
+            iseed[3] |= 1;
+            return iseed;
+        }
+
+        /// Fills \em size contiguous values with independent larnv streams, in parallel with XTENSOR_USE_OPENMP.
+        template <class T>
+        inline void random_fill(T* data, std::size_t size, random_distribution dist, std::uint64_t seed)
+        {
+            std::size_t chunks = (size + random_chunk_size - 1) / random_chunk_size;
+            blas_index_t idist = static_cast<blas_index_t>(dist);
+
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for
+#endif
+            for (std::ptrdiff_t p = 0; p < static_cast<std::ptrdiff_t>(chunks); ++p)
             {
-                result.reshape(result_shape);
+                std::size_t begin = static_cast<std::size_t>(p) * random_chunk_size;
+                std::size_t count = std::min(random_chunk_size, size - begin);
+                std::array<blas_index_t, 4> iseed = random_stream_seed(seed, static_cast<std::uint64_t>(p));
+                cxxlapack::larnv<blas_index_t>(idist, iseed.data(), static_cast<blas_index_t>(count), data + begin);
             }
+        }
 
+        template <class T>
+        inline T unit_phase(const T& x, std::false_type /*is_complex*/)
+        {
+            return x < T(0) ? T(-1) : T(1);
+        }
+
+        template <class T>
+        inline T unit_phase(const T& x, std::true_type /*is_complex*/)
+        {
+            auto r = std::abs(x);
+            return r == 0 ? T(1) : x / r;
         }
-        return result;
     }
 
     /**
-     * @brief Compute tensor dot product along specified axes for arrays
+     * Matrix of independent random entries, generated by LAPACK larnv.
      *
-     * Compute the sum of products along the axes \em ax_a for a and \em ax_b for b
+     * The matrix is filled by blocks of consecutive entries, each from its
+     * own stream seeded from \em seed and the block index, in parallel when
+     * XTENSOR_USE_OPENMP is defined. The values only depend on the shape,
+     * the distribution and \em seed, not on the number of threads.
      *
-     * @param xa input array
-     * @param xb input array
-     * @param ax_a axes to sum over for \em a
-     * @param ax_b axes to sum over for \em b
-     * @return resulting array
+     * @param m number of rows
+     * @param n number of columns
+     * @param dist distribution of the entries
+     * @param seed seed of the streams
+     * @return column-major matrix of m-by-n elements
      */
-    template <class T, class O>
-    auto tensordot(const xexpression<T>& xa, const xexpression<O>& xb, const std::vector<std::size_t>& ax_a,
-                   const std::vector<std::size_t>& ax_b)
+    template <class T = double>
+    auto random_matrix(std::size_t m, std::size_t n, random_distribution dist = random_distribution::normal,
+                       std::uint64_t seed = 0)
     {
-        auto&& a = view_eval<T::static_layout>(xa.derived_cast());
-        auto&& b = view_eval<O::static_layout>(xb.derived_cast());
-        XTENSOR_ASSERT(ax_a.size() == ax_b.size());
-        XTENSOR_ASSERT(ax_a.size() < a.dimension());
-        XTENSOR_ASSERT(ax_b.size() < b.dimension());
-        std::size_t n_ax = ax_a.size();
-        for (std::size_t i = 0; i < n_ax; ++i)
+        auto result = xtensor<T, 2, layout_type::column_major>::from_shape({m, n});
+        detail::random_fill(result.data(), result.size(), dist, seed);
+        return result;
+    }
+
+    /**
+     * Random orthogonal (unitary for complex \em T) matrix, distributed
+     * according to the Haar measure: the Q factor of the QR factorization
+     * of a normal random_matrix, its columns multiplied by the phases of
+     * the diagonal of R.
+     *
+     * @param n order of the matrix
+     * @param seed seed of the streams of random_matrix
+     * @return column-major matrix of n-by-n elements
+     */
+    template <class T = double>
+    auto random_orthogonal(std::size_t n, std::uint64_t seed = 0)
+    {
+        using matrix_type = xtensor<T, 2, layout_type::column_major>;
+        matrix_type Q = random_matrix<T>(n, n, random_distribution::normal, seed);
+        if (n == 0)
         {
-            XTENSOR_ASSERT(ax_a[i] < a.dimension());
-            XTENSOR_ASSERT(ax_b[i] < b.dimension());
+            return Q;
         }
-
-        // Move the axes to sum over to the end of a
-        xt::dynamic_shape<std::size_t> newaxes_a;
-        xt::dynamic_shape<std::size_t> result_shape;
-        for (std::size_t i = 0; i < a.dimension(); ++i)
+        auto tau = xtensor<T, 1, layout_type::column_major>::from_shape({n});
+        int info = lapack::geqrf(Q, tau);
+        if (info != 0)
         {
-            auto a_ax_it = std::find(ax_a.begin(), ax_a.end(), i);
-            // first pass if i is not in ax_a, add to newaxes_a
-            if (a_ax_it == ax_a.end())
-            {
-                newaxes_a.push_back(i);
-            }
+            XTENSOR_THROW(std::runtime_error, "random_orthogonal: QR decomposition failed.");
+        }
+        std::vector<T> phase(n);
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            phase[j] = detail::unit_phase(Q(j, j), xtl::is_complex<T>());
         }
-        for (auto& a_ax_it : ax_a)
+        detail::call_gqr(Q, tau, to_blas_index(n));
+        for (std::size_t j = 0; j < n; ++j)
         {
-            newaxes_a.push_back(a_ax_it);
+            auto col = xt::view(Q, all(), j);
+            col *= phase[j];
         }
+        return Q;
+    }
 
-        // Move the axes to sum over to the start of b
-        xt::dynamic_shape<std::size_t> newaxes_b;
-        for(auto& b_ax_it : ax_b)
+    /**
+     * Random symmetric (Hermitian for complex \em T) positive definite
+     * matrix of 2-norm condition number \em cond: Q diag(d) Q^H with Q
+     * from random_orthogonal and eigenvalues d geometrically spaced from 1
+     * down to 1 / cond.
+     *
+     * @param n order of the matrix
+     * @param cond condition number, at least 1
+     * @param seed seed of the streams of random_matrix
+     * @return column-major matrix of n-by-n elements
+     */
+    template <class T = double>
+    auto random_spd(std::size_t n, double cond = 10., std::uint64_t seed = 0)
+    {
+        using real_type = xtl::complex_value_type_t<T>;
+        using matrix_type = xtensor<T, 2, layout_type::column_major>;
+        if (!(cond >= 1.))
         {
-            newaxes_b.push_back(b_ax_it);
+            XTENSOR_THROW(std::runtime_error, "random_spd: the condition number must be at least 1.");
         }
-        for (std::size_t i = 0; i < b.dimension(); ++i)
+        // A = W^H W with W = diag(sqrt(d)) Q^H
+        matrix_type W = xt::conj(xt::transpose(random_orthogonal<T>(n, seed)));
+        for (std::size_t i = 0; i < n; ++i)
         {
-            auto b_ax_it = std::find(ax_b.begin(), ax_b.end(), i);
-            // second pass if i is not in ax_b add to newaxes_b
-            if (b_ax_it == ax_b.end())
-            {
-                newaxes_b.push_back(i);
-            }
+            double exponent = n == 1 ? 0. : double(i) / double(n - 1);
+            auto row = xt::view(W, i, all());
+            row *= T(real_type(std::sqrt(std::pow(cond, -exponent))));
         }
-        auto a_t = xt::transpose(a, newaxes_a);
-        auto b_t = xt::transpose(b, newaxes_b);
-
-        // the integer arg form of tensordot will handle the reshape of output for us
-        return tensordot(a_t, b_t, n_ax);
+        matrix_type result = gram(W, 'L', true);
+        return result;
     }
 }
 }
+
+#if defined(XTENSOR_BLAS_EXTERN_TEMPLATES)
+#include "xtensor-blas/xlinalg_instantiations.hpp"
+#endif
+
 #endif
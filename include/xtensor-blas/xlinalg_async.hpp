@@ -0,0 +1,300 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XLINALG_ASYNC_HPP
+#define XLINALG_ASYNC_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xeval.hpp"
+#include "xtensor/xexpression.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_threads.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+namespace async
+{
+    /**
+     * Fixed pool of worker threads running linalg calls in the background.
+     *
+     * Tasks wait in a queue of bounded depth: submit blocks while the queue
+     * is full, which throttles a producer that reads matrices faster than
+     * they are decomposed. Tasks must not submit to their own executor and
+     * wait for the result, which can deadlock once the queue is full.
+     *
+     * Each worker keeps the thread-local LAPACK workspaces of the wrappers
+     * for its whole lifetime, so repeated calls of the same shapes do not
+     * allocate work arrays.
+     */
+    class executor
+    {
+    public:
+
+        /**
+         * @param threads number of workers, 0 for std::thread::hardware_concurrency
+         * @param queue_depth number of queued tasks after which submit blocks,
+         *        0 for twice the number of workers
+         * @param blas_threads BLAS threads of each worker, 0 to leave the
+         *        setting alone; 1 keeps the workers from oversubscribing the
+         *        cores. Per worker with MKL; with the other libraries the
+         *        setting is process-wide and lasts as long as the executor.
+         */
+        explicit executor(std::size_t threads = 0, std::size_t queue_depth = 0, int blas_threads = 0);
+
+        /// Runs the queued tasks, then joins the workers.
+        ~executor();
+
+        executor(const executor&) = delete;
+        executor& operator=(const executor&) = delete;
+
+        /**
+         * Queues \em f, blocking while the queue is full.
+         * @return future of the result of f(), holding its exception if it throws
+         */
+        template <class F>
+        auto submit(F&& f) -> std::future<decltype(std::declval<std::decay_t<F>&>()())>;
+
+        std::size_t size() const noexcept;
+        std::size_t queue_depth() const noexcept;
+
+    private:
+
+        void run();
+
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()>> m_queue;
+        std::mutex m_mutex;
+        std::condition_variable m_not_empty;
+        std::condition_variable m_not_full;
+        std::size_t m_queue_depth;
+        int m_blas_threads;
+        bool m_stop = false;
+        std::unique_ptr<blas::scoped_num_threads> m_blas_guard;
+    };
+
+    inline executor::executor(std::size_t threads, std::size_t queue_depth, int blas_threads)
+        : m_blas_threads(blas_threads)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1));
+        }
+        m_queue_depth = queue_depth == 0 ? 2 * threads : queue_depth;
+#if !defined(WITH_MKLBLAS)
+        // a process-wide setting, held until the workers are joined
+        if (blas_threads > 0)
+        {
+            m_blas_guard.reset(new blas::scoped_num_threads(blas_threads));
+        }
+#endif
+        m_workers.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            m_workers.emplace_back([this]() { run(); });
+        }
+    }
+
+    inline executor::~executor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_not_empty.notify_all();
+        for (auto& w : m_workers)
+        {
+            w.join();
+        }
+    }
+
+    template <class F>
+    inline auto executor::submit(F&& f) -> std::future<decltype(std::declval<std::decay_t<F>&>()())>
+    {
+        using result_type = decltype(std::declval<std::decay_t<F>&>()());
+        // std::function needs a copyable target
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+        auto result = task->get_future();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_full.wait(lock, [this]() { return m_queue.size() < m_queue_depth; });
+            m_queue.emplace_back([task]() { (*task)(); });
+        }
+        m_not_empty.notify_one();
+        return result;
+    }
+
+    inline std::size_t executor::size() const noexcept
+    {
+        return m_workers.size();
+    }
+
+    inline std::size_t executor::queue_depth() const noexcept
+    {
+        return m_queue_depth;
+    }
+
+    inline void executor::run()
+    {
+        std::unique_ptr<blas::scoped_num_threads> guard;
+#if defined(WITH_MKLBLAS)
+        // a setting of each thread
+        if (m_blas_threads > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            guard.reset(new blas::scoped_num_threads(m_blas_threads));
+        }
+#endif
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_not_empty.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+                if (m_queue.empty())
+                {
+                    guard.reset();
+                    return;
+                }
+                task = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            m_not_full.notify_one();
+            task();
+        }
+    }
+
+    /**
+     * Returns the executor used by the functions of this namespace when none
+     * is passed: one worker per core, BLAS single-threaded in the workers,
+     * created on first use.
+     */
+    inline executor& default_executor()
+    {
+        static executor ex(0, 0, 1);
+        return ex;
+    }
+
+    namespace detail
+    {
+        // xexpressions are evaluated into containers owned by the task, so
+        // that the caller's operands may go away before the task runs
+        template <class T>
+        inline auto capture(T&& t, std::true_type /*is_xexpression*/)
+        {
+            using container_type = std::decay_t<decltype(xt::eval(std::forward<T>(t)))>;
+            return container_type(xt::eval(std::forward<T>(t)));
+        }
+
+        template <class T>
+        inline std::decay_t<T> capture(T&& t, std::false_type /*is_xexpression*/)
+        {
+            return std::forward<T>(t);
+        }
+
+        template <class F, class Tuple, std::size_t... I>
+        inline decltype(auto) apply_captured(F& f, Tuple& args, std::index_sequence<I...>)
+        {
+            return f(std::get<I>(args)...);
+        }
+
+        template <class F, class... Args>
+        inline auto submit_call(executor& ex, F f, Args&&... args)
+        {
+            auto captured = std::make_tuple(capture(std::forward<Args>(args), is_xexpression<Args>())...);
+            using tuple_type = decltype(captured);
+            return ex.submit([f, captured = std::move(captured)]() mutable {
+                return apply_captured(f, captured, std::make_index_sequence<std::tuple_size<tuple_type>::value>());
+            });
+        }
+    }
+
+    /**
+     * Computes linalg::svd(args...) on \em ex.
+     *
+     * The xexpression arguments are evaluated into copies owned by the task
+     * before submit returns, the other arguments are copied.
+     *
+     * @return future of the result of linalg::svd
+     */
+    template <class... Args>
+    inline auto svd(executor& ex, Args&&... args)
+    {
+        return detail::submit_call(ex, [](auto&... a) { return linalg::svd(a...); }, std::forward<Args>(args)...);
+    }
+
+    /// Computes linalg::eigh(args...) on \em ex, see svd.
+    template <class... Args>
+    inline auto eigh(executor& ex, Args&&... args)
+    {
+        return detail::submit_call(ex, [](auto&... a) { return linalg::eigh(a...); }, std::forward<Args>(args)...);
+    }
+
+    /// Computes linalg::solve(args...) on \em ex, see svd.
+    template <class... Args>
+    inline auto solve(executor& ex, Args&&... args)
+    {
+        return detail::submit_call(ex, [](auto&... a) { return linalg::solve(a...); }, std::forward<Args>(args)...);
+    }
+
+    /// Computes linalg::dot(args...) on \em ex, see svd.
+    template <class... Args>
+    inline auto dot(executor& ex, Args&&... args)
+    {
+        return detail::submit_call(ex, [](auto&... a) { return linalg::dot(a...); }, std::forward<Args>(args)...);
+    }
+
+    /// Computes linalg::svd(args...) on the default_executor.
+    template <class... Args>
+    inline auto svd(Args&&... args)
+    {
+        return async::svd(default_executor(), std::forward<Args>(args)...);
+    }
+
+    /// Computes linalg::eigh(args...) on the default_executor.
+    template <class... Args>
+    inline auto eigh(Args&&... args)
+    {
+        return async::eigh(default_executor(), std::forward<Args>(args)...);
+    }
+
+    /// Computes linalg::solve(args...) on the default_executor.
+    template <class... Args>
+    inline auto solve(Args&&... args)
+    {
+        return async::solve(default_executor(), std::forward<Args>(args)...);
+    }
+
+    /// Computes linalg::dot(args...) on the default_executor.
+    template <class... Args>
+    inline auto dot(Args&&... args)
+    {
+        return async::dot(default_executor(), std::forward<Args>(args)...);
+    }
+}
+}
+}
+
+#endif
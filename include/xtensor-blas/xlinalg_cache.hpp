@@ -0,0 +1,364 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XLINALG_CACHE_HPP
+#define XLINALG_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xarray.hpp"
+#include "xtensor/xeval.hpp"
+#include "xtensor/xexpression.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+    namespace detail
+    {
+        /// 64-bit hash of \em n bytes at \em data, read eight at a time.
+        inline std::uint64_t hash_bytes(const void* data, std::size_t n)
+        {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            std::uint64_t h = 0xcbf29ce484222325ULL ^ (n * 0x9e3779b97f4a7c15ULL);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                std::uint64_t k;
+                std::memcpy(&k, p + i, 8);
+                k *= 0x87c37b91114253d5ULL;
+                k = (k << 31) | (k >> 33);
+                h ^= k * 0x4cf5ad432745937fULL;
+                h = ((h << 27) | (h >> 37)) * 5 + 0x52dce729;
+            }
+            for (; i < n; ++i)
+            {
+                h = (h ^ p[i]) * 0x100000001b3ULL;
+            }
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        /// Bytes held by a cached result: the elements of its arrays.
+        template <class R>
+        inline auto cached_bytes(const R& r) -> decltype(r.size(), std::size_t())
+        {
+            return r.size() * sizeof(typename R::value_type);
+        }
+
+        template <class R>
+        inline auto cached_bytes(const R&) -> std::enable_if_t<std::is_arithmetic<R>::value, std::size_t>
+        {
+            return sizeof(R);
+        }
+
+        template <class... R, std::size_t... I>
+        inline std::size_t cached_tuple_bytes(const std::tuple<R...>& r, std::index_sequence<I...>)
+        {
+            std::size_t result = 0;
+            using expand = int[];
+            (void) expand{0, (result += cached_bytes(std::get<I>(r)), 0)...};
+            return result;
+        }
+
+        template <class... R>
+        inline std::size_t cached_bytes(const std::tuple<R...>& r)
+        {
+            return cached_tuple_bytes(r, std::index_sequence_for<R...>());
+        }
+    }
+
+    /**
+     * Memoizes decompositions of matrices that are passed again unchanged.
+     *
+     * A result is looked up by the name of the operation, the value type and
+     * shape of the input and either a hash of its elements, in row-major
+     * order, or a version tag given by the caller. With the hash the input is
+     * kept and compared element by element on a hit, so a collision never
+     * returns a wrong result; a tag is trusted, which saves the hash, the
+     * comparison and the copy. The least recently used results are evicted
+     * once the elements of the inputs and results exceed the memory budget.
+     *
+     * Lookups are serialized by a mutex, and a missing result is computed
+     * outside of it, so the cache can be shared by several threads. Results
+     * are returned by value.
+     *
+     * \code{.cpp}
+     * xt::linalg::cache c(64 << 20);
+     * auto L = c.cholesky(A);    // computed
+     * auto L2 = c.cholesky(A);   // copied from the cache
+     * \endcode
+     */
+    class cache
+    {
+    public:
+
+        /// @param max_bytes memory budget of the inputs and results held
+        explicit cache(std::size_t max_bytes = std::size_t(256) << 20);
+
+        cache(const cache&) = delete;
+        cache& operator=(const cache&) = delete;
+
+        /**
+         * Returns the result of f(A) for the operation \em op, computing it
+         * only if \em A was not seen since it was last evicted.
+         * @param f callable taking the row-major evaluation of \em A
+         */
+        template <class E, class F>
+        auto memoize(const std::string& op, const xexpression<E>& A, F&& f);
+
+        /**
+         * Returns the result of f(A) for the operation \em op, looked up by
+         * \em version instead of the elements of \em A: the caller changes
+         * the version whenever it changes the matrix.
+         */
+        template <class E, class F>
+        auto memoize(const std::string& op, const xexpression<E>& A, std::uint64_t version, F&& f);
+
+        template <class E>
+        auto inv(const xexpression<E>& A);
+
+        template <class E>
+        auto cholesky(const xexpression<E>& A);
+
+        template <class E>
+        auto eigh(const xexpression<E>& A, char UPLO = 'L');
+
+        std::size_t size() const;
+        std::size_t bytes() const;
+        std::size_t max_bytes() const;
+        void set_max_bytes(std::size_t max_bytes);
+        std::size_t hits() const;
+        std::size_t misses() const;
+        void clear();
+
+    private:
+
+        struct entry
+        {
+            std::string op;
+            std::type_index value_type;
+            std::vector<std::size_t> shape;
+            std::uint64_t key;
+            bool tagged;
+            std::shared_ptr<const void> input;
+            std::type_index result_type;
+            std::shared_ptr<const void> result;
+            std::size_t bytes;
+        };
+
+        using list_type = std::list<entry>;
+
+        template <class E, class F>
+        auto lookup(const std::string& op, const E& A, bool tagged, std::uint64_t key, F&& f);
+
+        void insert(entry&& e);
+        void evict();
+
+        list_type m_entries;
+        std::unordered_multimap<std::uint64_t, list_type::iterator> m_index;
+        std::size_t m_bytes = 0;
+        std::size_t m_max_bytes;
+        std::size_t m_hits = 0;
+        std::size_t m_misses = 0;
+        mutable std::mutex m_mutex;
+    };
+
+    /************************
+     * cache implementation *
+     ************************/
+
+    inline cache::cache(std::size_t max_bytes)
+        : m_max_bytes(max_bytes)
+    {
+    }
+
+    template <class E, class F>
+    inline auto cache::memoize(const std::string& op, const xexpression<E>& A, F&& f)
+    {
+        const auto& a = view_eval<layout_type::row_major>(A.derived_cast());
+        std::uint64_t key = detail::hash_bytes(a.data(), a.size() * sizeof(typename E::value_type));
+        return lookup(op, a, false, key, std::forward<F>(f));
+    }
+
+    template <class E, class F>
+    inline auto cache::memoize(const std::string& op, const xexpression<E>& A, std::uint64_t version, F&& f)
+    {
+        return lookup(op, A.derived_cast(), true, version, std::forward<F>(f));
+    }
+
+    /// Memoized linalg::inv
+    template <class E>
+    inline auto cache::inv(const xexpression<E>& A)
+    {
+        return memoize("inv", A, [](const auto& a) { return linalg::inv(a); });
+    }
+
+    /// Memoized linalg::cholesky
+    template <class E>
+    inline auto cache::cholesky(const xexpression<E>& A)
+    {
+        return memoize("cholesky", A, [](const auto& a) { return linalg::cholesky(a); });
+    }
+
+    /// Memoized linalg::eigh; the triangle read is part of the key
+    template <class E>
+    inline auto cache::eigh(const xexpression<E>& A, char UPLO)
+    {
+        return memoize(std::string("eigh") + UPLO, A, [UPLO](const auto& a) { return linalg::eigh(a, UPLO); });
+    }
+
+    template <class E, class F>
+    inline auto cache::lookup(const std::string& op, const E& A, bool tagged, std::uint64_t key, F&& f)
+    {
+        using value_type = typename E::value_type;
+        using input_type = xarray<value_type, layout_type::row_major>;
+        using result_type = std::decay_t<decltype(f(std::declval<const input_type&>()))>;
+
+        std::vector<std::size_t> shape(A.shape().begin(), A.shape().end());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto range = m_index.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                entry& e = *(it->second);
+                if (e.tagged != tagged || e.op != op || e.value_type != std::type_index(typeid(value_type)) ||
+                    e.shape != shape || e.result_type != std::type_index(typeid(result_type)))
+                {
+                    continue;
+                }
+                if (!tagged && *static_cast<const input_type*>(e.input.get()) != A)
+                {
+                    continue;
+                }
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                ++m_hits;
+                return *static_cast<const result_type*>(e.result.get());
+            }
+            ++m_misses;
+        }
+
+        auto input = std::make_shared<input_type>(A);
+        auto result = std::make_shared<result_type>(f(static_cast<const input_type&>(*input)));
+        std::size_t bytes = detail::cached_bytes(*result);
+        if (!tagged)
+        {
+            bytes += input->size() * sizeof(value_type);
+        }
+        else
+        {
+            input.reset();
+        }
+        insert(entry{op, std::type_index(typeid(value_type)), std::move(shape), key, tagged,
+                     std::move(input), std::type_index(typeid(result_type)), result, bytes});
+        return *result;
+    }
+
+    inline void cache::insert(entry&& e)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (e.bytes > m_max_bytes)
+        {
+            return;
+        }
+        std::uint64_t key = e.key;
+        m_bytes += e.bytes;
+        m_entries.push_front(std::move(e));
+        m_index.emplace(key, m_entries.begin());
+        evict();
+    }
+
+    /// Drops the least recently used entries until the budget holds, with the mutex held.
+    inline void cache::evict()
+    {
+        while (m_bytes > m_max_bytes && !m_entries.empty())
+        {
+            auto last = std::prev(m_entries.end());
+            auto range = m_index.equal_range(last->key);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second == last)
+                {
+                    m_index.erase(it);
+                    break;
+                }
+            }
+            m_bytes -= last->bytes;
+            m_entries.erase(last);
+        }
+    }
+
+    /// Number of results held
+    inline std::size_t cache::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    /// Bytes of the inputs and results held
+    inline std::size_t cache::bytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_bytes;
+    }
+
+    inline std::size_t cache::max_bytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_max_bytes;
+    }
+
+    /// Changes the memory budget, evicting entries if it shrinks.
+    inline void cache::set_max_bytes(std::size_t max_bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_max_bytes = max_bytes;
+        evict();
+    }
+
+    inline std::size_t cache::hits() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hits;
+    }
+
+    inline std::size_t cache::misses() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_misses;
+    }
+
+    /// Drops all results; the hit and miss counts are kept
+    inline void cache::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_index.clear();
+        m_entries.clear();
+        m_bytes = 0;
+    }
+}
+}
+
+#endif
@@ -0,0 +1,274 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XLINALG_CUDA_HPP
+#define XLINALG_CUDA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xexpression.hpp"
+
+#include "xtensor-blas/xblas_cuda.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+    namespace detail
+    {
+        template <class T>
+        inline cuda::device_matrix<T> device_copy(const cuda::device_matrix<T>& A)
+        {
+            cuda::device_matrix<T> result(A.rows(), A.cols());
+            auto& ctx = cuda::detail::context::thread_local_instance();
+            cuda::detail::check(cudaMemcpyAsync(result.data(), A.data(), A.rows() * A.cols() * sizeof(T),
+                                                cudaMemcpyDeviceToDevice, ctx.stream),
+                                "cudaMemcpyAsync");
+            return result;
+        }
+
+        /// A^T, or A^H for complex types, computed on the device.
+        template <class T>
+        inline cuda::device_matrix<T> device_adjoint(const cuda::device_matrix<T>& A)
+        {
+            cuda::device_matrix<T> result(A.cols(), A.rows());
+            auto& ctx = cuda::detail::context::thread_local_instance();
+            T one(1), zero(0);
+            int ld = int(std::max(result.rows(), std::size_t(1)));
+            // B is not read with beta = 0
+            cuda::detail::check(cuda::detail::routines<T>::geam(
+                                    ctx.blas, xtl::is_complex<T>::value ? CUBLAS_OP_C : CUBLAS_OP_T, CUBLAS_OP_N,
+                                    int(result.rows()), int(result.cols()), &one, A.data(),
+                                    int(std::max(A.rows(), std::size_t(1))), &zero, result.data(), ld,
+                                    result.data(), ld),
+                                "geam");
+            return result;
+        }
+
+        /// Waits for the info word of a cuSOLVER call queued on \em ctx.
+        inline int device_info(cuda::detail::context& ctx, const int* info)
+        {
+            int* host = reinterpret_cast<int*>(ctx.host.get(sizeof(int)));
+            cuda::detail::download(ctx, info, 1, 1, host);
+            ctx.synchronize();
+            return *host;
+        }
+
+        template <class T>
+        inline void check_device_size(const cuda::device_matrix<T>& A)
+        {
+            if (!cuda::detail::fits_int(A.rows(), A.cols()))
+            {
+                XTENSOR_THROW(std::runtime_error, "Device matrix too large for cuSOLVER.");
+            }
+        }
+
+        template <class T>
+        inline auto device_gesvd(cuda::device_matrix<T> A, char job)
+        {
+            using real_type = typename cuda::detail::routines<T>::real_type;
+            std::size_t m = A.rows(), n = A.cols(), mn = std::min(m, n);
+            bool vectors = job != 'N';
+            auto& ctx = cuda::detail::context::thread_local_instance();
+
+            cuda::device_matrix<real_type> s(mn, 1);
+            cuda::device_matrix<T> u, vt;
+            if (vectors)
+            {
+                u = cuda::device_matrix<T>(m, job == 'A' ? m : mn);
+                vt = cuda::device_matrix<T>(n, n);
+            }
+
+            int lwork = 0;
+            cuda::detail::check(cuda::detail::routines<T>::gesvd_buffer_size(ctx.solver, int(m), int(n), &lwork),
+                                "gesvd_bufferSize");
+            cuda::detail::arena_layout layout;
+            std::size_t ok = layout.add<T>(std::size_t(lwork));
+            std::size_t orw = layout.add<real_type>(mn);
+            std::size_t oi = layout.add<int>(1);
+            char* dev = ctx.device.get(layout.size());
+
+            // the device buffers are not referenced without vectors
+            T* u_data = vectors ? u.data() : cuda::detail::at<T>(dev, ok);
+            T* vt_data = vectors ? vt.data() : cuda::detail::at<T>(dev, ok);
+            cuda::detail::check(cuda::detail::routines<T>::gesvd(
+                                    ctx.solver, static_cast<signed char>(job), static_cast<signed char>(job),
+                                    int(m), int(n), A.data(), int(std::max(m, std::size_t(1))), s.data(), u_data,
+                                    int(std::max(m, std::size_t(1))), vt_data, int(std::max(n, std::size_t(1))),
+                                    cuda::detail::at<T>(dev, ok), lwork, cuda::detail::at<real_type>(dev, orw),
+                                    cuda::detail::at<int>(dev, oi)),
+                                "gesvd");
+            if (device_info(ctx, cuda::detail::at<int>(dev, oi)) > 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "SVD decomposition failed.");
+            }
+            return std::make_tuple(std::move(u), std::move(s), std::move(vt));
+        }
+    }
+
+    /**
+     * Matrix product of two device matrices, computed and left on the
+     * device.
+     */
+    template <class T>
+    auto dot(const cuda::device_matrix<T>& A, const cuda::device_matrix<T>& B)
+    {
+        return cuda::dot(A, B);
+    }
+
+    /**
+     * Matrix product of a device matrix and a 2-D expression, which is
+     * copied to the device first.
+     * @return the product, on the device
+     */
+    template <class T, class E>
+    auto dot(const cuda::device_matrix<T>& A, const xexpression<E>& B)
+    {
+        return cuda::dot(A, cuda::to_device(B));
+    }
+
+    /// See dot(const cuda::device_matrix<T>&, const xexpression<E>&).
+    template <class E, class T>
+    auto dot(const xexpression<E>& A, const cuda::device_matrix<T>& B)
+    {
+        return cuda::dot(cuda::to_device(A), B);
+    }
+
+    /**
+     * Solves A X = B on the device by LU factorization.
+     * @param A square device matrix
+     * @param B right hand sides, one column each
+     * @return X, on the device
+     */
+    template <class T>
+    auto solve(const cuda::device_matrix<T>& A, const cuda::device_matrix<T>& B)
+    {
+        std::size_t n = A.rows();
+        if (A.cols() != n || B.rows() != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "solve: A must be square with as many rows as b.");
+        }
+        detail::check_device_size(B);
+
+        auto lu = detail::device_copy(A);
+        auto x = detail::device_copy(B);
+        auto& ctx = cuda::detail::context::thread_local_instance();
+        int ld = int(std::max(n, std::size_t(1)));
+
+        int lwork = 0;
+        cuda::detail::check(cuda::detail::routines<T>::getrf_buffer_size(ctx.solver, int(n), lu.data(), ld, &lwork),
+                            "getrf_bufferSize");
+        cuda::detail::arena_layout layout;
+        std::size_t ow = layout.add<T>(std::size_t(lwork));
+        std::size_t op = layout.add<int>(n);
+        std::size_t oi = layout.add<int>(1);
+        char* dev = ctx.device.get(layout.size());
+
+        cuda::detail::check(cuda::detail::routines<T>::getrf(ctx.solver, int(n), lu.data(), ld, cuda::detail::at<T>(dev, ow),
+                                                             cuda::detail::at<int>(dev, op), cuda::detail::at<int>(dev, oi)),
+                            "getrf");
+        if (detail::device_info(ctx, cuda::detail::at<int>(dev, oi)) != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        cuda::detail::check(cuda::detail::routines<T>::getrs(ctx.solver, int(n), int(x.cols()), lu.data(), ld,
+                                                             cuda::detail::at<int>(dev, op), x.data(), ld,
+                                                             cuda::detail::at<int>(dev, oi)),
+                            "getrs");
+        return x;
+    }
+
+    /**
+     * Computes the eigenvalues and eigenvectors of a symmetric (Hermitian)
+     * device matrix.
+     * @param A square device matrix
+     * @param UPLO triangle of \em A that is read, 'L' or 'U'
+     * @return tuple of the ascending eigenvalues, as a device matrix of one
+     *         column, and the eigenvectors, both on the device
+     */
+    template <class T>
+    auto eigh(const cuda::device_matrix<T>& A, char UPLO = 'L')
+    {
+        using real_type = typename cuda::detail::routines<T>::real_type;
+        std::size_t n = A.rows();
+        if (A.cols() != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "Last 2 dimensions of the array must be square.");
+        }
+        detail::check_device_size(A);
+
+        auto v = detail::device_copy(A);
+        cuda::device_matrix<real_type> w(n, 1);
+        auto& ctx = cuda::detail::context::thread_local_instance();
+        auto fill = UPLO == 'U' ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER;
+        int ld = int(std::max(n, std::size_t(1)));
+
+        int lwork = 0;
+        cuda::detail::check(cuda::detail::routines<T>::eigh_buffer_size(ctx.solver, CUSOLVER_EIG_MODE_VECTOR, fill, int(n),
+                                                                        v.data(), ld, w.data(), &lwork),
+                            "evd_bufferSize");
+        cuda::detail::arena_layout layout;
+        std::size_t ok = layout.add<T>(std::size_t(lwork));
+        std::size_t oi = layout.add<int>(1);
+        char* dev = ctx.device.get(layout.size());
+
+        cuda::detail::check(cuda::detail::routines<T>::eigh(ctx.solver, CUSOLVER_EIG_MODE_VECTOR, fill, int(n), v.data(), ld,
+                                                            w.data(), cuda::detail::at<T>(dev, ok), lwork,
+                                                            cuda::detail::at<int>(dev, oi)),
+                            "evd");
+        if (detail::device_info(ctx, cuda::detail::at<int>(dev, oi)) > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+        return std::make_tuple(std::move(w), std::move(v));
+    }
+
+    /**
+     * Computes the SVD decomposition of a device matrix on the device.
+     * Matrices with more columns than rows are decomposed through their
+     * adjoint, as cuSOLVER requires m >= n.
+     *
+     * @param A device matrix
+     * @param full_matrices compute all columns of U and rows of Vt
+     * @param compute_uv compute the singular vectors; U and Vt are empty
+     *        device matrices otherwise
+     * @return tuple of U, the singular values as a device matrix of one
+     *         column, and Vt, all on the device
+     */
+    template <class T>
+    auto svd(const cuda::device_matrix<T>& A, bool full_matrices = true, bool compute_uv = true)
+    {
+        detail::check_device_size(A);
+        char job = !compute_uv ? 'N' : (full_matrices ? 'A' : 'S');
+        if (A.rows() >= A.cols())
+        {
+            return detail::device_gesvd(detail::device_copy(A), job);
+        }
+        // A^H = U' S V'^H, so A = V' S U'^H
+        auto result = detail::device_gesvd(detail::device_adjoint(A), job);
+        if (compute_uv)
+        {
+            auto u = detail::device_adjoint(std::get<2>(result));
+            auto vt = detail::device_adjoint(std::get<0>(result));
+            std::get<0>(result) = std::move(u);
+            std::get<2>(result) = std::move(vt);
+        }
+        return result;
+    }
+}
+}
+
+#endif
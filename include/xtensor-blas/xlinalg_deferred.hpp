@@ -0,0 +1,695 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XLINALG_DEFERRED_HPP
+#define XLINALG_DEFERRED_HPP
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xadapt.hpp"
+#include "xtensor/xexpression.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+namespace deferred
+{
+    /**
+     * Pool of the buffers holding the intermediate results of a deferred
+     * expression. A buffer is returned to the pool as soon as the node
+     * consuming it has run, and handed to the next node needing one, so a
+     * chain of products allocates about as many buffers as it has results
+     * alive at the same time. A workspace may be kept across evaluations
+     * of expressions of the same shapes to allocate nothing at all.
+     */
+    template <class T>
+    class workspace
+    {
+    public:
+
+        using value_type = T;
+
+        /**
+         * @return a buffer of \em n elements, the smallest free one that is
+         *         large enough, or else a new one
+         */
+        std::vector<T> acquire(std::size_t n)
+        {
+            std::size_t best = m_free.size();
+            for (std::size_t i = 0; i < m_free.size(); ++i)
+            {
+                if (m_free[i].capacity() >= n &&
+                    (best == m_free.size() || m_free[i].capacity() < m_free[best].capacity()))
+                {
+                    best = i;
+                }
+            }
+            std::vector<T> buffer;
+            if (best != m_free.size())
+            {
+                std::swap(buffer, m_free[best]);
+                m_free.erase(m_free.begin() + static_cast<std::ptrdiff_t>(best));
+            }
+            else
+            {
+                ++m_allocations;
+            }
+            buffer.resize(n);
+            return buffer;
+        }
+
+        void release(std::vector<T>&& buffer)
+        {
+            m_free.push_back(std::move(buffer));
+        }
+
+        /**
+         * @return the number of buffers allocated so far
+         */
+        std::size_t allocations() const noexcept
+        {
+            return m_allocations;
+        }
+
+    private:
+
+        std::vector<std::vector<T>> m_free;
+        std::size_t m_allocations = 0;
+    };
+
+    namespace detail
+    {
+        /// Buffer of a workspace, given back to it on destruction.
+        template <class T>
+        class lease
+        {
+        public:
+
+            lease(workspace<T>& ws, std::size_t n)
+                : p_ws(&ws), m_buffer(ws.acquire(n))
+            {
+            }
+
+            lease(lease&& rhs) noexcept
+                : p_ws(rhs.p_ws), m_buffer(std::move(rhs.m_buffer))
+            {
+                rhs.p_ws = nullptr;
+            }
+
+            lease(const lease&) = delete;
+            lease& operator=(const lease&) = delete;
+            lease& operator=(lease&&) = delete;
+
+            ~lease()
+            {
+                if (p_ws != nullptr)
+                {
+                    p_ws->release(std::move(m_buffer));
+                }
+            }
+
+            T* data() noexcept
+            {
+                return m_buffer.data();
+            }
+
+        private:
+
+            workspace<T>* p_ws;
+            std::vector<T> m_buffer;
+        };
+
+        /**
+         * Contiguous matrix a node writes its result into. The transpose of
+         * a row-major target is the same memory read column-major, so a
+         * transpose costs nothing when it reaches a target.
+         */
+        template <class T>
+        struct target
+        {
+            T* data;
+            std::size_t rows;
+            std::size_t cols;
+            layout_type layout;
+
+            target transposed() const noexcept
+            {
+                return {data, cols, rows,
+                        layout == layout_type::row_major ? layout_type::column_major : layout_type::row_major};
+            }
+        };
+
+        /// Calls \em f with an adaptor of \em t of its static layout.
+        template <class T, class F>
+        inline void with_view(const target<T>& t, F&& f)
+        {
+            std::array<std::size_t, 2> shape = {t.rows, t.cols};
+            if (t.layout == layout_type::column_major)
+            {
+                auto v = xt::adapt<layout_type::column_major>(t.data, t.rows * t.cols, xt::no_ownership(), shape);
+                f(v);
+            }
+            else
+            {
+                auto v = xt::adapt<layout_type::row_major>(t.data, t.rows * t.cols, xt::no_ownership(), shape);
+                f(v);
+            }
+        }
+
+        /// GEMM operand read straight from the user's expression.
+        template <class E>
+        struct source_operand
+        {
+            const E& e;
+            bool transposed;
+
+            const E& expression() const noexcept
+            {
+                return e;
+            }
+        };
+
+        /// GEMM operand held in a column-major workspace buffer.
+        template <class T>
+        struct buffer_operand
+        {
+            lease<T> buffer;
+            std::size_t rows;
+            std::size_t cols;
+            bool transposed;
+
+            auto expression()
+            {
+                return xt::adapt<layout_type::column_major>(buffer.data(), rows * cols, xt::no_ownership(),
+                                                            std::array<std::size_t, 2>{rows, cols});
+            }
+        };
+
+        template <class T>
+        inline void check_matrix(const T& t, const char* what)
+        {
+            if (t.dimension() != 2)
+            {
+                XTENSOR_THROW(std::runtime_error, what);
+            }
+        }
+    }
+
+    template <class N>
+    struct is_node : std::false_type
+    {
+    };
+
+    /**
+     * Operand of a deferred expression, held by reference: it must outlive
+     * the expression.
+     */
+    template <class E>
+    class leaf
+    {
+    public:
+
+        using value_type = typename E::value_type;
+        static constexpr bool is_source = true;
+
+        explicit leaf(const E& e)
+            : m_e(e)
+        {
+            detail::check_matrix(e, "deferred: operands have to be matrices.");
+        }
+
+        std::size_t rows() const
+        {
+            return m_e.shape()[0];
+        }
+
+        std::size_t cols() const
+        {
+            return m_e.shape()[1];
+        }
+
+        template <class R>
+        bool aliases(const R& result) const
+        {
+            return linalg::detail::dot_operand_aliases(result, m_e);
+        }
+
+        template <class T>
+        detail::source_operand<E> operand(workspace<T>&) const
+        {
+            return {m_e, false};
+        }
+
+        template <class T>
+        void produce_into(const detail::target<T>& t, workspace<T>&) const
+        {
+            detail::with_view(t, [&](auto& v) { noalias(v) = m_e; });
+        }
+
+    private:
+
+        const E& m_e;
+    };
+
+    /// Transpose of a node, folded into the op flags or the layout of its consumer.
+    template <class N>
+    class transpose_node
+    {
+    public:
+
+        using value_type = typename N::value_type;
+        static constexpr bool is_source = N::is_source;
+
+        explicit transpose_node(const N& n)
+            : m_n(n)
+        {
+        }
+
+        std::size_t rows() const
+        {
+            return m_n.cols();
+        }
+
+        std::size_t cols() const
+        {
+            return m_n.rows();
+        }
+
+        template <class R>
+        bool aliases(const R& result) const
+        {
+            return m_n.aliases(result);
+        }
+
+        template <class T>
+        auto operand(workspace<T>& ws) const
+        {
+            auto op = m_n.operand(ws);
+            op.transposed = !op.transposed;
+            return op;
+        }
+
+        template <class T>
+        void produce_into(const detail::target<T>& t, workspace<T>& ws) const
+        {
+            m_n.produce_into(t.transposed(), ws);
+        }
+
+    private:
+
+        N m_n;
+    };
+
+    /**
+     * Base of the nodes that compute their result: used as an operand, it
+     * is written into a column-major workspace buffer.
+     */
+    template <class D>
+    class computed_node
+    {
+    public:
+
+        static constexpr bool is_source = false;
+
+        template <class T>
+        detail::buffer_operand<T> operand(workspace<T>& ws) const
+        {
+            const D& d = static_cast<const D&>(*this);
+            detail::buffer_operand<T> op = {detail::lease<T>(ws, d.rows() * d.cols()), d.rows(), d.cols(), false};
+            d.produce_into(detail::target<T>{op.buffer.data(), d.rows(), d.cols(), layout_type::column_major}, ws);
+            return op;
+        }
+    };
+
+    /// Product ``alpha * A * B``, computed by one GEMM into its target.
+    template <class N1, class N2>
+    class dot_node : public computed_node<dot_node<N1, N2>>
+    {
+    public:
+
+        using value_type = std::common_type_t<typename N1::value_type, typename N2::value_type>;
+
+        dot_node(const N1& a, const N2& b, const value_type& alpha = value_type(1))
+            : m_a(a), m_b(b), m_alpha(alpha)
+        {
+            if (a.cols() != b.rows())
+            {
+                XTENSOR_THROW(std::runtime_error, "deferred::dot: shape mismatch.");
+            }
+        }
+
+        std::size_t rows() const
+        {
+            return m_a.rows();
+        }
+
+        std::size_t cols() const
+        {
+            return m_b.cols();
+        }
+
+        const N1& lhs() const noexcept
+        {
+            return m_a;
+        }
+
+        const N2& rhs() const noexcept
+        {
+            return m_b;
+        }
+
+        const value_type& alpha() const noexcept
+        {
+            return m_alpha;
+        }
+
+        template <class R>
+        bool aliases(const R& result) const
+        {
+            return m_a.aliases(result) || m_b.aliases(result);
+        }
+
+        template <class T>
+        void produce_into(const detail::target<T>& t, workspace<T>& ws) const
+        {
+            auto op_a = m_a.operand(ws);
+            auto op_b = m_b.operand(ws);
+            detail::with_view(t, [&](auto& v)
+            {
+                blas::gemm(op_a.expression(), op_b.expression(), v, op_a.transposed, op_b.transposed,
+                           T(m_alpha), T(0));
+            });
+        }
+
+    private:
+
+        N1 m_a;
+        N2 m_b;
+        value_type m_alpha;
+    };
+
+    /**
+     * Solution of ``A X = B``. B is computed straight into the column-major
+     * buffer LAPACK overwrites with X; a computed A is written column-major
+     * into a workspace buffer that is factored in place, an operand of the
+     * user is copied once (see linalg::solve).
+     */
+    template <class N1, class N2>
+    class solve_node : public computed_node<solve_node<N1, N2>>
+    {
+    public:
+
+        using value_type = std::common_type_t<typename N1::value_type, typename N2::value_type>;
+
+        solve_node(const N1& a, const N2& b)
+            : m_a(a), m_b(b)
+        {
+            if (a.rows() != a.cols() || a.cols() != b.rows())
+            {
+                XTENSOR_THROW(std::runtime_error, "deferred::solve: shape mismatch.");
+            }
+        }
+
+        std::size_t rows() const
+        {
+            return m_b.rows();
+        }
+
+        std::size_t cols() const
+        {
+            return m_b.cols();
+        }
+
+        template <class R>
+        bool aliases(const R& result) const
+        {
+            return m_a.aliases(result) || m_b.aliases(result);
+        }
+
+        template <class T>
+        void produce_into(const detail::target<T>& t, workspace<T>& ws) const
+        {
+            if (t.layout == layout_type::column_major)
+            {
+                solve_into(t, ws, std::integral_constant<bool, N1::is_source>());
+                return;
+            }
+            detail::lease<T> x(ws, rows() * cols());
+            detail::target<T> tx = {x.data(), rows(), cols(), layout_type::column_major};
+            solve_into(tx, ws, std::integral_constant<bool, N1::is_source>());
+            detail::with_view(tx, [&](auto& vx) { detail::with_view(t, [&](auto& v) { noalias(v) = vx; }); });
+        }
+
+    private:
+
+        template <class T>
+        void solve_into(const detail::target<T>& t, workspace<T>& ws, std::true_type /*user operand*/) const
+        {
+            m_b.produce_into(t, ws);
+            auto op_a = m_a.operand(ws);
+            auto x = xt::adapt<layout_type::column_major>(t.data, t.rows * t.cols, xt::no_ownership(),
+                                                          std::array<std::size_t, 2>{t.rows, t.cols});
+            if (op_a.transposed)
+            {
+                linalg::detail::solve_into(xt::transpose(op_a.expression()), x);
+            }
+            else
+            {
+                linalg::detail::solve_into(op_a.expression(), x);
+            }
+        }
+
+        template <class T>
+        void solve_into(const detail::target<T>& t, workspace<T>& ws, std::false_type /*computed*/) const
+        {
+            std::size_t n = m_a.rows();
+            detail::lease<T> a(ws, n * n);
+            m_a.produce_into(detail::target<T>{a.data(), n, n, layout_type::column_major}, ws);
+            m_b.produce_into(t, ws);
+            auto va = xt::adapt<layout_type::column_major>(a.data(), n * n, xt::no_ownership(),
+                                                           std::array<std::size_t, 2>{n, n});
+            auto x = xt::adapt<layout_type::column_major>(t.data, t.rows * t.cols, xt::no_ownership(),
+                                                          std::array<std::size_t, 2>{t.rows, t.cols});
+            if (lapack::gesv(va, x) != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+            }
+        }
+
+        N1 m_a;
+        N2 m_b;
+    };
+
+    template <class E>
+    struct is_node<leaf<E>> : std::true_type
+    {
+    };
+
+    template <class N>
+    struct is_node<transpose_node<N>> : std::true_type
+    {
+    };
+
+    template <class N1, class N2>
+    struct is_node<dot_node<N1, N2>> : std::true_type
+    {
+    };
+
+    template <class N1, class N2>
+    struct is_node<solve_node<N1, N2>> : std::true_type
+    {
+    };
+
+    namespace detail
+    {
+        template <class E>
+        inline const E& as_node(const E& e, std::true_type /*is_node*/)
+        {
+            return e;
+        }
+
+        template <class E>
+        inline leaf<E> as_node(const E& e, std::false_type /*is_node*/)
+        {
+            return leaf<E>(e);
+        }
+
+        template <class E>
+        inline decltype(auto) as_node(const E& e)
+        {
+            return as_node(e, is_node<E>());
+        }
+
+        template <class E>
+        using node_t = std::decay_t<decltype(as_node(std::declval<const E&>()))>;
+    }
+
+    /**
+     * Deferred transpose of \em a, an expression or a node. It is never
+     * computed: GEMM reads it through its op flags, and a computed node
+     * writes it by filling its target in the other storage order.
+     */
+    template <class A>
+    inline transpose_node<detail::node_t<A>> transpose(const A& a)
+    {
+        return transpose_node<detail::node_t<A>>(detail::as_node(a));
+    }
+
+    /**
+     * Deferred matrix product of \em a and \em b, expressions or nodes.
+     */
+    template <class A, class B>
+    inline dot_node<detail::node_t<A>, detail::node_t<B>> dot(const A& a, const B& b)
+    {
+        return dot_node<detail::node_t<A>, detail::node_t<B>>(detail::as_node(a), detail::as_node(b));
+    }
+
+    /**
+     * Deferred solution of ``a x = b``, \em a and \em b expressions or nodes.
+     */
+    template <class A, class B>
+    inline solve_node<detail::node_t<A>, detail::node_t<B>> solve(const A& a, const B& b)
+    {
+        return solve_node<detail::node_t<A>, detail::node_t<B>>(detail::as_node(a), detail::as_node(b));
+    }
+
+    template <class S, class N1, class N2, class V = typename dot_node<N1, N2>::value_type,
+              class = std::enable_if_t<std::is_convertible<S, V>::value>>
+    inline dot_node<N1, N2> operator*(const S& s, const dot_node<N1, N2>& d)
+    {
+        return dot_node<N1, N2>(d.lhs(), d.rhs(), V(s) * d.alpha());
+    }
+
+    template <class S, class N1, class N2, class V = typename dot_node<N1, N2>::value_type,
+              class = std::enable_if_t<std::is_convertible<S, V>::value>>
+    inline dot_node<N1, N2> operator*(const dot_node<N1, N2>& d, const S& s)
+    {
+        return dot_node<N1, N2>(d.lhs(), d.rhs(), d.alpha() * V(s));
+    }
+
+    namespace detail
+    {
+        template <class R>
+        inline bool is_contiguous_matrix(const R& r, std::true_type /*has_data_interface*/)
+        {
+            if (r.dimension() != 2)
+            {
+                return false;
+            }
+            auto rows = r.shape()[0];
+            auto cols = r.shape()[1];
+            if (r.layout() == layout_type::row_major)
+            {
+                return (cols < 2 || r.strides()[1] == 1) && (rows < 2 || std::size_t(r.strides()[0]) == cols);
+            }
+            if (r.layout() == layout_type::column_major)
+            {
+                return (rows < 2 || r.strides()[0] == 1) && (cols < 2 || std::size_t(r.strides()[1]) == rows);
+            }
+            return false;
+        }
+
+        template <class R>
+        inline bool is_contiguous_matrix(const R&, std::false_type /*has_data_interface*/)
+        {
+            return false;
+        }
+
+        template <class R>
+        inline target<typename R::value_type> target_of(R& r, std::true_type /*has_data_interface*/)
+        {
+            return {r.data() + r.data_offset(), r.shape()[0], r.shape()[1], r.layout()};
+        }
+
+        template <class R>
+        inline target<typename R::value_type> target_of(R&, std::false_type /*has_data_interface*/)
+        {
+            return {nullptr, 0, 0, layout_type::column_major};
+        }
+    }
+
+    /**
+     * Evaluates the deferred expression \em n into \em result, which must
+     * have its shape. A contiguous row- or column-major \em result is the
+     * target of the root node, written directly: a product in either
+     * layout, a solution in place if \em result is column-major. Other
+     * results, or results sharing memory with an operand, are assigned
+     * from a workspace buffer.
+     *
+     * @param result destination matrix
+     * @param n deferred expression
+     * @param ws workspace for the intermediate results
+     */
+    template <class R, class N, class = std::enable_if_t<is_node<N>::value>>
+    void assign(R& result, const N& n, workspace<typename R::value_type>& ws)
+    {
+        using value_type = typename R::value_type;
+        std::array<std::size_t, 2> shape = {n.rows(), n.cols()};
+        linalg::detail::check_dot_out_shape(result, shape);
+        if (detail::is_contiguous_matrix(result, has_data_interface<R>()) && !n.aliases(result))
+        {
+            n.produce_into(detail::target_of(result, has_data_interface<R>()), ws);
+            return;
+        }
+        detail::lease<value_type> buffer(ws, n.rows() * n.cols());
+        detail::target<value_type> t = {buffer.data(), n.rows(), n.cols(), layout_type::column_major};
+        n.produce_into(t, ws);
+        detail::with_view(t, [&](auto& v) { noalias(result) = v; });
+    }
+
+    /**
+     * Evaluates the deferred expression \em n into \em result with a
+     * workspace of its own.
+     */
+    template <class R, class N, class = std::enable_if_t<is_node<N>::value>>
+    void assign(R& result, const N& n)
+    {
+        workspace<typename R::value_type> ws;
+        assign(result, n, ws);
+    }
+
+    /**
+     * Evaluates the deferred expression \em n into a new matrix of layout
+     * \em L, column-major by default: the layout LAPACK writes solutions
+     * in, so that a solve at the root is computed in place.
+     *
+     * \code{.cpp}
+     * namespace ld = xt::linalg::deferred;
+     * // B^T C is computed by one GEMM straight into the buffer of X,
+     * // which GESV then overwrites with the solution
+     * auto X = ld::evaluate(ld::solve(A, ld::dot(ld::transpose(B), C)));
+     * \endcode
+     *
+     * @param n deferred expression
+     * @return the value of \em n
+     */
+    template <layout_type L = layout_type::column_major, class N, class = std::enable_if_t<is_node<N>::value>>
+    xtensor<typename N::value_type, 2, L> evaluate(const N& n)
+    {
+        using result_type = xtensor<typename N::value_type, 2, L>;
+        result_type result = result_type::from_shape({n.rows(), n.cols()});
+        assign(result, n);
+        return result;
+    }
+}
+}
+}
+
+#endif
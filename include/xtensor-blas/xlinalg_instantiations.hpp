@@ -0,0 +1,104 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XLINALG_INSTANTIATIONS_HPP
+#define XLINALG_INSTANTIATIONS_HPP
+
+#include <complex>
+
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+/**
+ * Explicit instantiations of the linalg functions for float, double,
+ * complex<float> and complex<double>, with xarray, 2-D xtensor and, for
+ * right-hand sides, 1-D xtensor operands.
+ *
+ * The xtensor-blas-instantiations library (CMake option
+ * XTENSOR_BLAS_BUILD_INSTANTIATIONS) compiles them once. Its users define
+ * XTENSOR_BLAS_EXTERN_TEMPLATES, with which xlinalg.hpp includes this header
+ * and the instantiations below are declared extern: the functions are still
+ * instantiated to deduce their return types, but no longer optimized and
+ * emitted in every translation unit. Both have to be built with the same
+ * BLAS driver and xtensor definitions.
+ */
+
+namespace xt
+{
+namespace linalg
+{
+namespace instantiation
+{
+    template <class T>
+    using array = xarray<T>;
+
+    template <class T>
+    using matrix = xtensor<T, 2>;
+
+    template <class T>
+    using vector = xtensor<T, 1>;
+}
+}
+}
+
+#define XTENSOR_BLAS_WORKSPACE_TEMPLATES(EXTERN, T)                                                                  \
+    EXTERN template class lapack::workspace<T>;
+
+#define XTENSOR_BLAS_LINALG_MATRIX_TEMPLATES(EXTERN, M)                                                              \
+    EXTERN template auto inv<M>(const xexpression<M>&);                                                              \
+    EXTERN template auto det<M>(const xexpression<M>&);                                                              \
+    EXTERN template auto slogdet<M>(const xexpression<M>&);                                                          \
+    EXTERN template auto cholesky<M>(const xexpression<M>&, bool);                                                   \
+    EXTERN template auto svd<M>(const xexpression<M>&, bool, bool, svd_driver);                                      \
+    EXTERN template auto eigh<M>(const xexpression<M>&, char);                                                       \
+    EXTERN template auto eigvalsh<M>(const xexpression<M>&, char);                                                   \
+    EXTERN template auto eig<M>(const xexpression<M>&);                                                              \
+    EXTERN template auto eigvals<M>(const xexpression<M>&);                                                          \
+    EXTERN template auto qr<M>(const xexpression<M>&, qrmode);                                                       \
+    EXTERN template auto pinv<M>(const xexpression<M>&, double, svd_driver);                                         \
+    EXTERN template int matrix_rank<M>(const xexpression<M>&, double);                                               \
+    EXTERN template auto dot<M, M>(const xexpression<M>&, const xexpression<M>&);                                    \
+    EXTERN template auto matmul<M, M>(const xexpression<M>&, const xexpression<M>&);                                 \
+    EXTERN template auto solve<M, M>(const xexpression<M>&, const xexpression<M>&);                                  \
+    EXTERN template auto lstsq<M, M>(const xexpression<M>&, const xexpression<M>&, double, lstsq_driver);
+
+#define XTENSOR_BLAS_LINALG_VECTOR_TEMPLATES(EXTERN, M, V)                                                           \
+    EXTERN template auto dot<M, V>(const xexpression<M>&, const xexpression<V>&);                                    \
+    EXTERN template auto solve<M, V>(const xexpression<M>&, const xexpression<V>&);                                  \
+    EXTERN template auto lstsq<M, V>(const xexpression<M>&, const xexpression<V>&, double, lstsq_driver);
+
+#define XTENSOR_BLAS_LINALG_TEMPLATES(EXTERN, T)                                                                     \
+    XTENSOR_BLAS_LINALG_MATRIX_TEMPLATES(EXTERN, instantiation::array<T>)                                            \
+    XTENSOR_BLAS_LINALG_MATRIX_TEMPLATES(EXTERN, instantiation::matrix<T>)                                           \
+    XTENSOR_BLAS_LINALG_VECTOR_TEMPLATES(EXTERN, instantiation::matrix<T>, instantiation::vector<T>)
+
+#if defined(XTENSOR_BLAS_EXTERN_TEMPLATES)
+
+namespace xt
+{
+    XTENSOR_BLAS_WORKSPACE_TEMPLATES(extern, float)
+    XTENSOR_BLAS_WORKSPACE_TEMPLATES(extern, double)
+    XTENSOR_BLAS_WORKSPACE_TEMPLATES(extern, std::complex<float>)
+    XTENSOR_BLAS_WORKSPACE_TEMPLATES(extern, std::complex<double>)
+
+namespace linalg
+{
+    XTENSOR_BLAS_LINALG_TEMPLATES(extern, float)
+    XTENSOR_BLAS_LINALG_TEMPLATES(extern, double)
+    XTENSOR_BLAS_LINALG_TEMPLATES(extern, std::complex<float>)
+    XTENSOR_BLAS_LINALG_TEMPLATES(extern, std::complex<double>)
+}
+}
+
+#endif
+
+#endif
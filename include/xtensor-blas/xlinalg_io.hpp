@@ -0,0 +1,1148 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XLINALG_IO_HPP
+#define XLINALG_IO_HPP
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "xtensor/xadapt.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+    /// Factorization stored in a file written by save_factorization or save_eigh
+    enum class factorization_kind : std::uint32_t {
+        lu = 1,        ///< getrf factors and pivots
+        cholesky = 2,  ///< potrf lower triangular factor
+        qr = 3,        ///< geqrf reflectors, R and tau
+        eigh = 4       ///< eigenvalues and eigenvectors of a Hermitian matrix
+    };
+
+    /// How the pages of a mapped file may be written
+    enum class mapping_mode {
+        read,           ///< Read-only pages: the mapped arrays must not be written
+        copy_on_write,  ///< Private writable pages, e.g. to factor in place; the file is unchanged
+        write_through   ///< Shared writable pages: writes go to the file
+    };
+
+    namespace detail
+    {
+        /**
+         * Header of a factorization file, in the byte order of the machine
+         * that wrote it. It is followed by up to two sections at offsets
+         * that are multiples of io_alignment: the column-major factor, and
+         * the pivots, tau or eigenvalues.
+         */
+        struct factor_file_header
+        {
+            char magic[8];
+            std::uint32_t byte_order;
+            std::uint32_t version;
+            std::uint32_t kind;
+            std::uint32_t value_type;
+            std::uint32_t index_bytes;
+            std::uint32_t reserved;
+            std::uint64_t rows;
+            std::uint64_t cols;
+            double norm;
+            double norm_inf;
+            std::int64_t info;
+            std::uint64_t offset[2];
+            std::uint64_t bytes[2];
+            char padding[152];
+        };
+
+        static_assert(sizeof(factor_file_header) == 256, "factor_file_header must have 256 bytes.");
+
+        /// Sections start on page boundaries, so that a mapping aligns them for BLAS
+        constexpr std::uint64_t io_alignment = 4096;
+        constexpr char io_magic[8] = {'X', 'B', 'L', 'A', 'S', 'F', 'A', 'C'};
+        constexpr std::uint32_t io_byte_order = 0x01020304;
+        constexpr std::uint32_t io_version = 1;
+
+        template <class T>
+        struct io_type_code;
+
+        template <>
+        struct io_type_code<float> : std::integral_constant<std::uint32_t, 1>
+        {
+        };
+
+        template <>
+        struct io_type_code<double> : std::integral_constant<std::uint32_t, 2>
+        {
+        };
+
+        template <>
+        struct io_type_code<std::complex<float>> : std::integral_constant<std::uint32_t, 3>
+        {
+        };
+
+        template <>
+        struct io_type_code<std::complex<double>> : std::integral_constant<std::uint32_t, 4>
+        {
+        };
+
+        inline std::uint64_t io_align(std::uint64_t n)
+        {
+            return (n + io_alignment - 1) / io_alignment * io_alignment;
+        }
+
+        template <class T>
+        inline factor_file_header make_header(factorization_kind kind, std::size_t rows, std::size_t cols,
+                                              std::size_t second_bytes)
+        {
+            factor_file_header h;
+            std::memset(&h, 0, sizeof(h));
+            std::memcpy(h.magic, io_magic, sizeof(io_magic));
+            h.byte_order = io_byte_order;
+            h.version = io_version;
+            h.kind = static_cast<std::uint32_t>(kind);
+            h.value_type = io_type_code<T>::value;
+            h.index_bytes = sizeof(blas_index_t);
+            h.rows = rows;
+            h.cols = cols;
+            h.offset[0] = io_align(sizeof(factor_file_header));
+            h.bytes[0] = rows * cols * sizeof(T);
+            h.offset[1] = io_align(h.offset[0] + h.bytes[0]);
+            h.bytes[1] = second_bytes;
+            return h;
+        }
+
+        inline void write_section(std::ofstream& out, std::uint64_t offset, const void* data, std::uint64_t bytes)
+        {
+            // the gap up to the aligned offset is zero filled
+            std::uint64_t pos = static_cast<std::uint64_t>(out.tellp());
+            static const char zeros[io_alignment] = {};
+            while (pos < offset)
+            {
+                std::uint64_t n = std::min<std::uint64_t>(offset - pos, io_alignment);
+                out.write(zeros, static_cast<std::streamsize>(n));
+                pos += n;
+            }
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        }
+
+        template <class T, class S>
+        inline void write_factor_file(const std::string& path, const factor_file_header& h,
+                                      const T* factor, const S* second)
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                XTENSOR_THROW(std::runtime_error, "save_factorization: cannot open " + path + ".");
+            }
+            out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            write_section(out, h.offset[0], factor, h.bytes[0]);
+            write_section(out, h.offset[1], second, h.bytes[1]);
+            if (!out)
+            {
+                XTENSOR_THROW(std::runtime_error, "save_factorization: cannot write " + path + ".");
+            }
+        }
+
+        /**
+         * RAII mapping of a whole file. On Windows the file is read into an
+         * aligned buffer instead, and write_through writes it back when
+         * the mapping is destroyed.
+         */
+        class file_mapping
+        {
+        public:
+
+            file_mapping(const std::string& path, mapping_mode mode);
+            ~file_mapping();
+
+            file_mapping(const file_mapping&) = delete;
+            file_mapping& operator=(const file_mapping&) = delete;
+            file_mapping(file_mapping&& rhs) noexcept;
+            file_mapping& operator=(file_mapping&& rhs) = delete;
+
+            char* data() const noexcept;
+            std::size_t size() const noexcept;
+
+        private:
+
+            void release() noexcept;
+
+            std::string m_path;
+            char* m_data = nullptr;
+            std::size_t m_size = 0;
+            mapping_mode m_mode;
+            std::vector<char> m_buffer;
+        };
+
+        inline file_mapping::file_mapping(const std::string& path, mapping_mode mode)
+            : m_path(path), m_mode(mode)
+        {
+#if !defined(_WIN32)
+            int fd = ::open(path.c_str(), mode == mapping_mode::write_through ? O_RDWR : O_RDONLY);
+            if (fd < 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "cannot open " + path + ".");
+            }
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                XTENSOR_THROW(std::runtime_error, "cannot stat " + path + ".");
+            }
+            m_size = static_cast<std::size_t>(st.st_size);
+            if (m_size != 0)
+            {
+                int prot = mode == mapping_mode::read ? PROT_READ : PROT_READ | PROT_WRITE;
+                int flags = mode == mapping_mode::write_through ? MAP_SHARED : MAP_PRIVATE;
+                void* p = ::mmap(nullptr, m_size, prot, flags, fd, 0);
+                if (p == MAP_FAILED)
+                {
+                    ::close(fd);
+                    XTENSOR_THROW(std::runtime_error, "cannot map " + path + ".");
+                }
+                m_data = static_cast<char*>(p);
+            }
+            ::close(fd);
+#else
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in)
+            {
+                XTENSOR_THROW(std::runtime_error, "cannot open " + path + ".");
+            }
+            m_size = static_cast<std::size_t>(in.tellg());
+            m_buffer.resize(m_size + io_alignment);
+            // align the buffer as a mapping would be
+            std::size_t shift = (io_alignment - reinterpret_cast<std::uintptr_t>(m_buffer.data()) % io_alignment)
+                                % io_alignment;
+            m_data = m_buffer.data() + shift;
+            in.seekg(0);
+            in.read(m_data, static_cast<std::streamsize>(m_size));
+#endif
+        }
+
+        inline file_mapping::file_mapping(file_mapping&& rhs) noexcept
+            : m_path(std::move(rhs.m_path)), m_data(rhs.m_data), m_size(rhs.m_size), m_mode(rhs.m_mode),
+              m_buffer(std::move(rhs.m_buffer))
+        {
+            rhs.m_data = nullptr;
+            rhs.m_size = 0;
+        }
+
+        inline file_mapping::~file_mapping()
+        {
+            release();
+        }
+
+        inline void file_mapping::release() noexcept
+        {
+            if (m_data == nullptr)
+            {
+                return;
+            }
+#if !defined(_WIN32)
+            ::munmap(m_data, m_size);
+#else
+            if (m_mode == mapping_mode::write_through)
+            {
+                std::ofstream out(m_path, std::ios::binary | std::ios::in | std::ios::out);
+                out.write(m_data, static_cast<std::streamsize>(m_size));
+            }
+#endif
+            m_data = nullptr;
+        }
+
+        inline char* file_mapping::data() const noexcept
+        {
+            return m_data;
+        }
+
+        inline std::size_t file_mapping::size() const noexcept
+        {
+            return m_size;
+        }
+
+        /// Checks that \em h describes a factorization of \em kind with value type \em T held in \em size bytes.
+        template <class T>
+        inline void check_header(const factor_file_header& h, factorization_kind kind, std::uint64_t size,
+                                 const std::string& path)
+        {
+            if (std::memcmp(h.magic, io_magic, sizeof(io_magic)) != 0 || h.version != io_version)
+            {
+                XTENSOR_THROW(std::runtime_error, "load_factorization: " + path + " is not a factorization file.");
+            }
+            if (h.byte_order != io_byte_order)
+            {
+                XTENSOR_THROW(std::runtime_error, "load_factorization: " + path + " was written with another byte order.");
+            }
+            if (h.kind != static_cast<std::uint32_t>(kind) || h.value_type != io_type_code<T>::value)
+            {
+                XTENSOR_THROW(std::runtime_error, "load_factorization: " + path + " holds another factorization or value type.");
+            }
+            if (kind == factorization_kind::lu && h.index_bytes != sizeof(blas_index_t))
+            {
+                XTENSOR_THROW(std::runtime_error, "load_factorization: the pivots of " + path + " have another integer size.");
+            }
+            if (h.bytes[0] != h.rows * h.cols * sizeof(T) || h.offset[0] + h.bytes[0] > size
+                || h.offset[1] + h.bytes[1] > size || h.offset[0] % io_alignment != 0 || h.offset[1] % io_alignment != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "load_factorization: " + path + " is truncated.");
+            }
+        }
+
+        /// Size in elements of the second section of a factorization of \em kind
+        inline std::uint64_t second_section_size(const factor_file_header& h, factorization_kind kind)
+        {
+            switch (kind)
+            {
+                case factorization_kind::lu:
+                    return h.rows;
+                case factorization_kind::cholesky:
+                    return 0;
+                default:
+                    return h.cols;
+            }
+        }
+
+        /**
+         * Reads a factorization file into an owning factor and second
+         * section: one read call per section, and no pass over the values.
+         */
+        template <class T, class S>
+        inline auto read_factor_file(const std::string& path, factorization_kind kind)
+        {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in)
+            {
+                XTENSOR_THROW(std::runtime_error, "load_factorization: cannot open " + path + ".");
+            }
+            std::uint64_t size = static_cast<std::uint64_t>(in.tellg());
+            factor_file_header h;
+            in.seekg(0);
+            if (size < sizeof(h) || !in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+            {
+                XTENSOR_THROW(std::runtime_error, "load_factorization: " + path + " is not a factorization file.");
+            }
+            check_header<T>(h, kind, size, path);
+            std::size_t ns = static_cast<std::size_t>(second_section_size(h, kind));
+            if (h.bytes[1] != ns * sizeof(S))
+            {
+                XTENSOR_THROW(std::runtime_error, "load_factorization: " + path + " is truncated.");
+            }
+
+            using matrix_type = xtensor<T, 2, layout_type::column_major>;
+            matrix_type factor = matrix_type::from_shape({static_cast<std::size_t>(h.rows), static_cast<std::size_t>(h.cols)});
+            uvector<S> second(ns);
+            in.seekg(static_cast<std::streamoff>(h.offset[0]));
+            in.read(reinterpret_cast<char*>(factor.data()), static_cast<std::streamsize>(h.bytes[0]));
+            in.seekg(static_cast<std::streamoff>(h.offset[1]));
+            in.read(reinterpret_cast<char*>(second.data()), static_cast<std::streamsize>(h.bytes[1]));
+            if (!in)
+            {
+                XTENSOR_THROW(std::runtime_error, "load_factorization: cannot read " + path + ".");
+            }
+            return std::make_tuple(h, std::move(factor), std::move(second));
+        }
+    }
+
+    /**
+     * Write an LU factorization to \em path: a 256-byte header giving the
+     * kind, value type, shape and norms, then the column-major factors and
+     * the pivots, each at an offset aligned on a page. The factorization is
+     * read back by load_lu, or mapped by mapped_factorization.
+     */
+    template <class T>
+    void save_factorization(const std::string& path, const lu_factorization<T>& f)
+    {
+        const auto& lu = f.matrix();
+        const auto& piv = f.pivots();
+        auto h = detail::make_header<T>(factorization_kind::lu, lu.shape()[0], lu.shape()[1], piv.size() * sizeof(blas_index_t));
+        h.norm = static_cast<double>(f.norm('1'));
+        h.norm_inf = static_cast<double>(f.norm('I'));
+        h.info = f.info();
+        detail::write_factor_file(path, h, lu.data(), piv.data());
+    }
+
+    /// Write a Cholesky factorization to \em path; see save_factorization(path, lu_factorization)
+    template <class T>
+    void save_factorization(const std::string& path, const cholesky_factorization<T>& f)
+    {
+        const auto& l = f.matrix();
+        auto h = detail::make_header<T>(factorization_kind::cholesky, l.shape()[0], l.shape()[1], 0);
+        h.norm = static_cast<double>(f.norm());
+        detail::write_factor_file(path, h, l.data(), static_cast<const T*>(nullptr));
+    }
+
+    /// Write a QR factorization to \em path; see save_factorization(path, lu_factorization)
+    template <class T>
+    void save_factorization(const std::string& path, const qr_factorization<T>& f)
+    {
+        const auto& qr = f.matrix();
+        const auto& tau = f.tau();
+        auto h = detail::make_header<T>(factorization_kind::qr, qr.shape()[0], qr.shape()[1], tau.size() * sizeof(T));
+        detail::write_factor_file(path, h, qr.data(), tau.data());
+    }
+
+    /**
+     * Write the eigendecomposition (w, V) returned by eigh to \em path; see
+     * save_factorization(path, lu_factorization).
+     */
+    template <class EW, class EV>
+    void save_eigh(const std::string& path, const xexpression<EW>& w, const xexpression<EV>& V)
+    {
+        using value_type = typename EV::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        xtensor<real_type, 1> wv = w.derived_cast();
+        xtensor<value_type, 2, layout_type::column_major> vm = V.derived_cast();
+        if (vm.shape()[1] != wv.size())
+        {
+            XTENSOR_THROW(std::runtime_error, "save_eigh: V must have one column per eigenvalue.");
+        }
+        auto h = detail::make_header<value_type>(factorization_kind::eigh, vm.shape()[0], vm.shape()[1], wv.size() * sizeof(real_type));
+        detail::write_factor_file(path, h, vm.data(), wv.data());
+    }
+
+    /// Read an LU factorization written by save_factorization, without factoring again.
+    template <class T>
+    lu_factorization<T> load_lu(const std::string& path)
+    {
+        auto r = detail::read_factor_file<T, blas_index_t>(path, factorization_kind::lu);
+        const auto& h = std::get<0>(r);
+        using real_type = xtl::complex_value_type_t<T>;
+        return lu_factorization<T>(std::move(std::get<1>(r)), std::move(std::get<2>(r)),
+                                   static_cast<real_type>(h.norm), static_cast<real_type>(h.norm_inf),
+                                   static_cast<int>(h.info));
+    }
+
+    /// Read a Cholesky factorization written by save_factorization, without factoring again.
+    template <class T>
+    cholesky_factorization<T> load_cholesky(const std::string& path)
+    {
+        auto r = detail::read_factor_file<T, T>(path, factorization_kind::cholesky);
+        using real_type = xtl::complex_value_type_t<T>;
+        return cholesky_factorization<T>(std::move(std::get<1>(r)), static_cast<real_type>(std::get<0>(r).norm));
+    }
+
+    /// Read a QR factorization written by save_factorization, without factoring again.
+    template <class T>
+    qr_factorization<T> load_qr(const std::string& path)
+    {
+        auto r = detail::read_factor_file<T, T>(path, factorization_kind::qr);
+        const auto& t = std::get<2>(r);
+        xtensor<T, 1, layout_type::column_major> tau = xtensor<T, 1, layout_type::column_major>::from_shape({t.size()});
+        std::copy(t.begin(), t.end(), tau.begin());
+        return qr_factorization<T>(std::move(std::get<1>(r)), std::move(tau));
+    }
+
+    /// Read an eigendecomposition written by save_eigh: a tuple (w, V) as returned by eigh.
+    template <class T>
+    auto load_eigh(const std::string& path)
+    {
+        using real_type = xtl::complex_value_type_t<T>;
+        auto r = detail::read_factor_file<T, real_type>(path, factorization_kind::eigh);
+        const auto& s = std::get<2>(r);
+        xtensor<real_type, 1> w = xtensor<real_type, 1>::from_shape({s.size()});
+        std::copy(s.begin(), s.end(), w.begin());
+        return std::make_tuple(std::move(w), std::move(std::get<1>(r)));
+    }
+
+    /**
+     * A factorization file mapped in memory: the factors are used in place
+     * by getrs, potrs or ormqr and trtrs, so opening a factorization of
+     * 40k x 40k costs a mapping instead of a read. Only the header is
+     * checked; the pages are read by the first solves that touch them.
+     *
+     * The mapping is private and writable, as LAPACK takes the factors by
+     * non-const pointer, although the solves do not change them; ormqr
+     * swaps the diagonal of the reflectors and back, which is why solve on
+     * a QR factorization cannot run concurrently on one object. On Windows
+     * the file is read into memory instead. The object can be moved.
+     *
+     * \code{.cpp}
+     * xt::linalg::save_factorization("a.fac", xt::linalg::cholesky_factor(A));
+     * xt::linalg::mapped_factorization<double> f("a.fac");
+     * auto x = f.solve(b);
+     * \endcode
+     */
+    template <class T>
+    class mapped_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+
+        explicit mapped_factorization(const std::string& path);
+
+        template <class E>
+        auto solve(const xexpression<E>& b) const;
+
+        factorization_kind kind() const noexcept;
+        std::size_t rows() const noexcept;
+        std::size_t cols() const noexcept;
+        real_type norm() const noexcept;
+
+        auto matrix() const;
+        auto pivots() const;
+        auto tau() const;
+        auto eigenvalues() const;
+
+    private:
+
+        const char* section(std::size_t i) const noexcept;
+        auto mutable_matrix() const;
+
+        detail::file_mapping m_file;
+        detail::factor_file_header m_header;
+    };
+
+    /**************************************
+     * mapped_factorization implementation *
+     **************************************/
+
+    /**
+     * Maps the file written by save_factorization or save_eigh at
+     * \em path, whose value type must be \em T.
+     */
+    template <class T>
+    inline mapped_factorization<T>::mapped_factorization(const std::string& path)
+        : m_file(path, mapping_mode::copy_on_write)
+    {
+        std::size_t size = m_file.size();
+        auto kind = static_cast<factorization_kind>(0);
+        if (size >= sizeof(m_header))
+        {
+            std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+            kind = static_cast<factorization_kind>(m_header.kind);
+        }
+        if (size < sizeof(m_header) || kind < factorization_kind::lu || kind > factorization_kind::eigh)
+        {
+            XTENSOR_THROW(std::runtime_error, "mapped_factorization: " + path + " is not a factorization file.");
+        }
+        detail::check_header<T>(m_header, kind, size, path);
+        std::size_t element = kind == factorization_kind::lu ? sizeof(blas_index_t)
+                              : (kind == factorization_kind::eigh ? sizeof(real_type) : sizeof(T));
+        if (m_header.bytes[1] != detail::second_section_size(m_header, kind) * element)
+        {
+            XTENSOR_THROW(std::runtime_error, "mapped_factorization: " + path + " is truncated.");
+        }
+    }
+
+    /**
+     * Solve A x = b with the mapped factors: getrs, potrs, ormqr and trtrs
+     * (in the least squares sense for a rectangular QR), or V diag(w)^-1 V^H b
+     * for an eigendecomposition.
+     * @return solution, column-major, with the shape of \em b (N rows for QR)
+     */
+    template <class T>
+    template <class E>
+    inline auto mapped_factorization<T>::solve(const xexpression<E>& b) const
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        std::size_t m = rows();
+        std::size_t n = cols();
+        if (x.dimension() < 1 || x.dimension() > 2 || x.shape()[0] != m)
+        {
+            XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+        }
+        auto a = mutable_matrix();
+        int info = 0;
+        switch (kind())
+        {
+            case factorization_kind::lu:
+            {
+                if (m_header.info > 0)
+                {
+                    XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+                }
+                auto piv = xt::adapt(reinterpret_cast<blas_index_t*>(const_cast<char*>(section(1))), m,
+                                     no_ownership(), std::array<std::size_t, 1>{m});
+                info = lapack::getrs(a, piv, x);
+                break;
+            }
+            case factorization_kind::cholesky:
+                info = lapack::potrs(a, x, 'L');
+                break;
+            case factorization_kind::qr:
+            {
+                auto t = xt::adapt(reinterpret_cast<T*>(const_cast<char*>(section(1))), n,
+                                   no_ownership(), std::array<std::size_t, 1>{n});
+                info = lapack::ormqr(a, t, x, 'L', 'T');
+                if (info == 0)
+                {
+                    blas_index_t nrhs = x.dimension() > 1 ? to_blas_index(x.shape()[1]) : 1;
+                    info = cxxlapack::trtrs<blas_index_t>('U', 'N', 'N', to_blas_index(n), nrhs,
+                                                          a.data(), to_blas_index(std::max(m, std::size_t(1))),
+                                                          x.data(), to_blas_index(std::max(m, std::size_t(1))));
+                }
+                if (info == 0)
+                {
+                    x = view(x, range(0, n));
+                }
+                break;
+            }
+            case factorization_kind::eigh:
+            {
+                if (m != n)
+                {
+                    XTENSOR_THROW(std::runtime_error, "Solve: the eigendecomposition is truncated.");
+                }
+                auto w = eigenvalues();
+                if (std::find(w.begin(), w.end(), real_type(0)) != w.end())
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+                }
+                auto c = xt::eval(dot(conj(transpose(a)), x));
+                if (c.dimension() == 1)
+                {
+                    c /= w;
+                }
+                else
+                {
+                    c /= view(w, all(), newaxis());
+                }
+                x = dot(a, c);
+                break;
+            }
+        }
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        return x;
+    }
+
+    template <class T>
+    inline factorization_kind mapped_factorization<T>::kind() const noexcept
+    {
+        return static_cast<factorization_kind>(m_header.kind);
+    }
+
+    template <class T>
+    inline std::size_t mapped_factorization<T>::rows() const noexcept
+    {
+        return static_cast<std::size_t>(m_header.rows);
+    }
+
+    template <class T>
+    inline std::size_t mapped_factorization<T>::cols() const noexcept
+    {
+        return static_cast<std::size_t>(m_header.cols);
+    }
+
+    /// @return the 1-norm of the factored matrix, for LU and Cholesky factorizations
+    template <class T>
+    inline auto mapped_factorization<T>::norm() const noexcept -> real_type
+    {
+        return static_cast<real_type>(m_header.norm);
+    }
+
+    /**
+     * @return column-major adaptor on the mapped factor: L and U packed for
+     *         LU, L for Cholesky, the reflectors and R for QR and the
+     *         eigenvectors for an eigendecomposition
+     */
+    template <class T>
+    inline auto mapped_factorization<T>::matrix() const
+    {
+        return xt::adapt<layout_type::column_major>(reinterpret_cast<const T*>(section(0)), rows() * cols(),
+                                                    no_ownership(), std::array<std::size_t, 2>{rows(), cols()});
+    }
+
+    /// @return adaptor on the (1-based) pivots of an LU factorization
+    template <class T>
+    inline auto mapped_factorization<T>::pivots() const
+    {
+        std::size_t n = kind() == factorization_kind::lu ? rows() : 0;
+        return xt::adapt(reinterpret_cast<const blas_index_t*>(section(1)), n, no_ownership(), std::array<std::size_t, 1>{n});
+    }
+
+    /// @return adaptor on the scalar factors of the reflectors of a QR factorization
+    template <class T>
+    inline auto mapped_factorization<T>::tau() const
+    {
+        std::size_t n = kind() == factorization_kind::qr ? cols() : 0;
+        return xt::adapt(reinterpret_cast<const T*>(section(1)), n, no_ownership(), std::array<std::size_t, 1>{n});
+    }
+
+    /// @return adaptor on the eigenvalues of an eigendecomposition, in ascending order
+    template <class T>
+    inline auto mapped_factorization<T>::eigenvalues() const
+    {
+        std::size_t n = kind() == factorization_kind::eigh ? cols() : 0;
+        return xt::adapt(reinterpret_cast<const real_type*>(section(1)), n, no_ownership(), std::array<std::size_t, 1>{n});
+    }
+
+    template <class T>
+    inline const char* mapped_factorization<T>::section(std::size_t i) const noexcept
+    {
+        return m_file.data() + m_header.offset[i];
+    }
+
+    template <class T>
+    inline auto mapped_factorization<T>::mutable_matrix() const
+    {
+        return xt::adapt<layout_type::column_major>(reinterpret_cast<T*>(m_file.data() + m_header.offset[0]), rows() * cols(),
+                                                    no_ownership(), std::array<std::size_t, 2>{rows(), cols()});
+    }
+
+    /*****************************************
+     * column-major matrices in binary files *
+     *****************************************/
+
+    namespace detail
+    {
+        template <class T>
+        struct npy_descr;
+
+        template <>
+        struct npy_descr<float>
+        {
+            static constexpr const char* value = "f4";
+        };
+
+        template <>
+        struct npy_descr<double>
+        {
+            static constexpr const char* value = "f8";
+        };
+
+        template <>
+        struct npy_descr<std::complex<float>>
+        {
+            static constexpr const char* value = "c8";
+        };
+
+        template <>
+        struct npy_descr<std::complex<double>>
+        {
+            static constexpr const char* value = "c16";
+        };
+
+        inline bool little_endian() noexcept
+        {
+            std::uint16_t one = 1;
+            unsigned char first;
+            std::memcpy(&first, &one, 1);
+            return first == 1;
+        }
+
+        /// Layout of the array of an .npy file
+        struct npy_header
+        {
+            std::string descr;
+            bool fortran_order = false;
+            std::vector<std::size_t> shape;
+            std::size_t data_offset = 0;
+        };
+
+        /// Value of \em key in the Python dict literal of an .npy header
+        inline std::string npy_dict_value(const std::string& dict, const std::string& key, const std::string& path)
+        {
+            std::size_t k = dict.find("'" + key + "'");
+            std::size_t colon = k == std::string::npos ? k : dict.find(':', k);
+            if (colon == std::string::npos)
+            {
+                XTENSOR_THROW(std::runtime_error, "map_npy: no " + key + " in the header of " + path + ".");
+            }
+            std::size_t begin = dict.find_first_not_of(' ', colon + 1);
+            std::size_t end = dict[begin] == '(' ? dict.find(')', begin) + 1
+                              : (dict[begin] == '\'' ? dict.find('\'', begin + 1) + 1 : dict.find(',', begin));
+            return dict.substr(begin, end - begin);
+        }
+
+        inline npy_header parse_npy_header(const char* data, std::size_t size, const std::string& path)
+        {
+            static const char magic[6] = {'\x93', 'N', 'U', 'M', 'P', 'Y'};
+            if (size < 10 || std::memcmp(data, magic, 6) != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "map_npy: " + path + " is not an .npy file.");
+            }
+            unsigned char major = static_cast<unsigned char>(data[6]);
+            std::size_t header_len = 0;
+            std::size_t start = 0;
+            if (major == 1)
+            {
+                header_len = static_cast<unsigned char>(data[8]) | (std::size_t(static_cast<unsigned char>(data[9])) << 8);
+                start = 10;
+            }
+            else
+            {
+                if (size < 12)
+                {
+                    XTENSOR_THROW(std::runtime_error, "map_npy: " + path + " is not an .npy file.");
+                }
+                for (std::size_t i = 0; i < 4; ++i)
+                {
+                    header_len |= std::size_t(static_cast<unsigned char>(data[8 + i])) << (8 * i);
+                }
+                start = 12;
+            }
+            if (start + header_len > size)
+            {
+                XTENSOR_THROW(std::runtime_error, "map_npy: " + path + " is truncated.");
+            }
+
+            std::string dict(data + start, header_len);
+            npy_header h;
+            std::string descr = npy_dict_value(dict, "descr", path);
+            h.descr = descr.size() >= 2 ? descr.substr(1, descr.size() - 2) : descr;
+            h.fortran_order = npy_dict_value(dict, "fortran_order", path).find("True") != std::string::npos;
+            std::string shape = npy_dict_value(dict, "shape", path);
+            for (std::size_t i = 0; i < shape.size();)
+            {
+                if (shape[i] >= '0' && shape[i] <= '9')
+                {
+                    std::size_t len = 0;
+                    h.shape.push_back(static_cast<std::size_t>(std::stoull(shape.substr(i), &len)));
+                    i += len;
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+            h.data_offset = start + header_len;
+            return h;
+        }
+
+        /// Writes the version 1.0 header of a Fortran-ordered .npy array, padded to 64 bytes.
+        template <class T>
+        inline void write_npy_header(std::ofstream& out, std::size_t rows, std::size_t cols, bool matrix)
+        {
+            std::string dict = std::string("{'descr': '") + (little_endian() ? '<' : '>') + npy_descr<T>::value
+                               + "', 'fortran_order': True, 'shape': (" + std::to_string(rows)
+                               + (matrix ? ", " + std::to_string(cols) + ")" : ",)") + ", }";
+            std::size_t total = 10 + dict.size() + 1;
+            dict.append((64 - total % 64) % 64, ' ');
+            dict.push_back('\n');
+            const char magic[8] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0};
+            std::uint16_t len = static_cast<std::uint16_t>(dict.size());
+            unsigned char len_bytes[2] = {static_cast<unsigned char>(len & 0xff), static_cast<unsigned char>(len >> 8)};
+            out.write(magic, 8);
+            out.write(reinterpret_cast<const char*>(len_bytes), 2);
+            out.write(dict.data(), static_cast<std::streamsize>(dict.size()));
+        }
+
+        /// Writes the elements of the matrix or vector \em e in column-major order, by chunks.
+        template <class T, class E>
+        inline void write_column_major(std::ofstream& out, const E& e)
+        {
+            if (is_dense_buffer<layout_type::column_major, T>(e, has_data_interface<E>()))
+            {
+                out.write(reinterpret_cast<const char*>(buffer_data<T>(e, has_data_interface<E>())),
+                          static_cast<std::streamsize>(e.size() * sizeof(T)));
+                return;
+            }
+            std::vector<T> chunk(std::min(e.size(), std::size_t(1) << 16));
+            auto it = e.template cbegin<layout_type::column_major>();
+            for (std::size_t done = 0; done < e.size();)
+            {
+                std::size_t n = std::min(chunk.size(), e.size() - done);
+                for (std::size_t i = 0; i < n; ++i, ++it)
+                {
+                    chunk[i] = static_cast<T>(*it);
+                }
+                out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(n * sizeof(T)));
+                done += n;
+            }
+        }
+
+        template <class T>
+        inline void read_mm_value(std::istream& in, T& v, bool complex_field)
+        {
+            double re = 0;
+            in >> re;
+            if (complex_field)
+            {
+                double im;
+                in >> im;
+            }
+            v = static_cast<T>(re);
+        }
+
+        template <class T>
+        inline void read_mm_value(std::istream& in, std::complex<T>& v, bool complex_field)
+        {
+            double re = 0, im = 0;
+            in >> re;
+            if (complex_field)
+            {
+                in >> im;
+            }
+            v = std::complex<T>(static_cast<T>(re), static_cast<T>(im));
+        }
+    }
+
+    /**
+     * A matrix held in a mapped file, seen as a column-major
+     * xtensor_adaptor on the mapped elements: BLAS and LAPACK read it in
+     * place, and linalg functions that take a copy of their operand because
+     * LAPACK overwrites it (solve, cholesky, svd) copy it with a memcpy
+     * instead of a transposition. With mapping_mode::copy_on_write, lapack
+     * routines can also factor it in place without touching the file.
+     * Returned by map_npy and map_raw; a vector is mapped as one column.
+     */
+    template <class T>
+    class mapped_matrix
+    {
+    public:
+
+        using value_type = T;
+        using adaptor_type = decltype(xt::adapt<layout_type::column_major>(
+            std::declval<T*>(), std::size_t(0), no_ownership(), std::declval<std::array<std::size_t, 2>>()));
+
+        mapped_matrix(const std::string& path, std::size_t offset, std::size_t rows, std::size_t cols, mapping_mode mode);
+
+        adaptor_type& matrix() noexcept;
+        const adaptor_type& matrix() const noexcept;
+
+        std::size_t rows() const noexcept;
+        std::size_t cols() const noexcept;
+
+    private:
+
+        detail::file_mapping m_file;
+        adaptor_type m_matrix;
+    };
+
+    /**
+     * Maps the \em rows x \em cols column-major elements of type \em T at
+     * byte \em offset of the file \em path, which must be a multiple of the
+     * alignment of \em T.
+     */
+    template <class T>
+    inline mapped_matrix<T>::mapped_matrix(const std::string& path, std::size_t offset, std::size_t rows,
+                                           std::size_t cols, mapping_mode mode)
+        : m_file(path, mode),
+          m_matrix(xt::adapt<layout_type::column_major>(reinterpret_cast<T*>(m_file.data() + offset), rows * cols,
+                                                        no_ownership(), std::array<std::size_t, 2>{rows, cols}))
+    {
+        if (offset + rows * cols * sizeof(T) > m_file.size())
+        {
+            XTENSOR_THROW(std::runtime_error, "mapped_matrix: " + path + " is smaller than the matrix.");
+        }
+        if (offset % alignof(T) != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "mapped_matrix: the offset of the matrix in " + path + " is misaligned.");
+        }
+    }
+
+    /// @return column-major adaptor on the mapped elements
+    template <class T>
+    inline auto mapped_matrix<T>::matrix() noexcept -> adaptor_type&
+    {
+        return m_matrix;
+    }
+
+    template <class T>
+    inline auto mapped_matrix<T>::matrix() const noexcept -> const adaptor_type&
+    {
+        return m_matrix;
+    }
+
+    template <class T>
+    inline std::size_t mapped_matrix<T>::rows() const noexcept
+    {
+        return m_matrix.shape()[0];
+    }
+
+    template <class T>
+    inline std::size_t mapped_matrix<T>::cols() const noexcept
+    {
+        return m_matrix.shape()[1];
+    }
+
+    /**
+     * Map a Fortran-ordered (column-major) 1-D or 2-D .npy file, as written
+     * by ``numpy.save(path, numpy.asfortranarray(a))`` or save_npy, whose
+     * elements have type \em T in the byte order of the machine. A C-ordered
+     * matrix is rejected, as it would have to be transposed.
+     */
+    template <class T>
+    mapped_matrix<T> map_npy(const std::string& path, mapping_mode mode = mapping_mode::read)
+    {
+        detail::npy_header h;
+        {
+            detail::file_mapping probe(path, mapping_mode::read);
+            h = detail::parse_npy_header(probe.data(), probe.size(), path);
+        }
+        std::string native = std::string(detail::little_endian() ? "<" : ">") + detail::npy_descr<T>::value;
+        if (h.descr != native && h.descr != std::string("=") + detail::npy_descr<T>::value)
+        {
+            XTENSOR_THROW(std::runtime_error, "map_npy: " + path + " holds '" + h.descr + "' elements, expected '" + native + "'.");
+        }
+        if (h.shape.empty() || h.shape.size() > 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "map_npy: " + path + " does not hold a vector or a matrix.");
+        }
+        std::size_t rows = h.shape[0];
+        std::size_t cols = h.shape.size() == 2 ? h.shape[1] : 1;
+        if (!h.fortran_order && rows > 1 && cols > 1)
+        {
+            XTENSOR_THROW(std::runtime_error, "map_npy: " + path + " is C-ordered; save it with numpy.asfortranarray.");
+        }
+        return mapped_matrix<T>(path, h.data_offset, rows, cols, mode);
+    }
+
+    /// Map \em rows x \em cols column-major elements of type \em T at byte \em offset of a raw binary file.
+    template <class T>
+    mapped_matrix<T> map_raw(const std::string& path, std::size_t rows, std::size_t cols, std::size_t offset = 0,
+                             mapping_mode mode = mapping_mode::read)
+    {
+        return mapped_matrix<T>(path, offset, rows, cols, mode);
+    }
+
+    /**
+     * Write the vector or matrix \em e to \em path as a Fortran-ordered .npy
+     * file, which map_npy maps back. Column-major contiguous data is written
+     * with one call; other expressions are evaluated in column-major order
+     * by chunks, without a temporary of their size.
+     */
+    template <class E>
+    void save_npy(const std::string& path, const xexpression<E>& e)
+    {
+        using value_type = typename E::value_type;
+        const auto& de = e.derived_cast();
+        if (de.dimension() < 1 || de.dimension() > 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "save_npy: expected a vector or a matrix.");
+        }
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            XTENSOR_THROW(std::runtime_error, "save_npy: cannot open " + path + ".");
+        }
+        detail::write_npy_header<value_type>(out, de.shape()[0], de.dimension() == 2 ? de.shape()[1] : 1, de.dimension() == 2);
+        detail::write_column_major<value_type>(out, de);
+        if (!out)
+        {
+            XTENSOR_THROW(std::runtime_error, "save_npy: cannot write " + path + ".");
+        }
+    }
+
+    /// Write the elements of \em e to \em path in column-major order, without a header; see map_raw.
+    template <class E>
+    void save_raw(const std::string& path, const xexpression<E>& e)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            XTENSOR_THROW(std::runtime_error, "save_raw: cannot open " + path + ".");
+        }
+        detail::write_column_major<typename E::value_type>(out, e.derived_cast());
+        if (!out)
+        {
+            XTENSOR_THROW(std::runtime_error, "save_raw: cannot write " + path + ".");
+        }
+    }
+
+    /**
+     * Read a dense Matrix Market file (``%%MatrixMarket matrix array``),
+     * general, symmetric, skew-symmetric or Hermitian. The format is text,
+     * so it is parsed rather than mapped, but its values are listed by
+     * columns and are stored straight into the column-major result.
+     */
+    template <class T>
+    xtensor<T, 2, layout_type::column_major> load_matrix_market_dense(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_dense: cannot open " + path + ".");
+        }
+        std::string banner, object, format, field, symmetry;
+        in >> banner >> object >> format >> field >> symmetry;
+        auto lower = [](std::string str) {
+            std::transform(str.begin(), str.end(), str.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+            return str;
+        };
+        format = lower(format);
+        field = lower(field);
+        symmetry = lower(symmetry);
+        if (banner != "%%MatrixMarket" || lower(object) != "matrix" || format != "array" || field == "pattern")
+        {
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_dense: " + path + " is not a dense Matrix Market matrix.");
+        }
+        bool complex_field = field == "complex";
+        if (complex_field && !xtl::is_complex<T>::value)
+        {
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_dense: " + path + " holds complex values.");
+        }
+
+        std::string line;
+        std::getline(in, line);
+        while (in.peek() == '%' || in.peek() == '\n' || in.peek() == '\r')
+        {
+            std::getline(in, line);
+        }
+        std::size_t rows = 0, cols = 0;
+        in >> rows >> cols;
+        bool general = symmetry == "general";
+        if (!general && rows != cols)
+        {
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_dense: a symmetric matrix must be square.");
+        }
+
+        using matrix_type = xtensor<T, 2, layout_type::column_major>;
+        matrix_type result = matrix_type::from_shape({rows, cols});
+        bool skew = symmetry == "skew-symmetric";
+        bool hermitian = symmetry == "hermitian";
+        for (std::size_t j = 0; j < cols; ++j)
+        {
+            // symmetric formats list the lower triangle, without the diagonal if skew
+            std::size_t first = general ? 0 : (skew ? j + 1 : j);
+            if (skew)
+            {
+                result(j, j) = T(0);
+            }
+            for (std::size_t i = first; i < rows; ++i)
+            {
+                T v;
+                detail::read_mm_value(in, v, complex_field);
+                result(i, j) = v;
+                if (!general && i != j)
+                {
+                    result(j, i) = skew ? T(-v) : (hermitian ? detail::conj_value(v) : v);
+                }
+            }
+        }
+        if (!in)
+        {
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_dense: " + path + " is truncated.");
+        }
+        return result;
+    }
+}
+}
+
+#endif
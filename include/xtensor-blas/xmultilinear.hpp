@@ -0,0 +1,758 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+
+#ifndef XMULTILINEAR_HPP
+#define XMULTILINEAR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+    /**
+     * Tucker decomposition X ~ core x_0 U_0 x_1 U_1 ... x_{N-1} U_{N-1} of
+     * an N-dimensional tensor, with orthonormal factors U_n of shape
+     * (I_n, R_n). The core is stored in the layout of the decomposed tensor.
+     */
+    template <class T, layout_type L = XTENSOR_DEFAULT_LAYOUT>
+    struct tucker_decomposition
+    {
+        using value_type = T;
+        using matrix_type = xtensor<T, 2, layout_type::column_major>;
+
+        xarray<T, L> core;                ///< Core tensor of shape (R_0, ..., R_{N-1})
+        std::vector<matrix_type> factors;  ///< Factor matrices, one per mode
+        std::size_t iterations = 0;       ///< HOOI sweeps, 0 for hosvd
+        double relative_error = 0.;       ///< ||X - reconstruction|| / ||X||
+    };
+
+    /**
+     * CP (CANDECOMP/PARAFAC) decomposition X ~ sum_r weights(r) a_0r o a_1r
+     * o ... o a_{N-1}r of an N-dimensional tensor, with factors of shape
+     * (I_n, R) whose columns have unit norm.
+     */
+    template <class T>
+    struct cp_decomposition
+    {
+        using value_type = T;
+        using matrix_type = xtensor<T, 2, layout_type::column_major>;
+
+        xtensor<T, 1> weights;            ///< Weight of each rank one term
+        std::vector<matrix_type> factors;  ///< Factor matrices, one per mode
+        std::size_t iterations = 0;       ///< ALS sweeps
+        double relative_error = 0.;       ///< ||X - reconstruction|| / ||X||
+    };
+
+    namespace detail
+    {
+        /// Rows of the blocks of Khatri-Rao products formed by cp_als.
+        constexpr std::size_t khatri_rao_block_rows = 1024;
+
+        // Layout in which a tensor is read: its own if it is row or column major.
+        template <class E>
+        struct multilinear_layout
+            : std::integral_constant<layout_type, E::static_layout == layout_type::column_major ? layout_type::column_major
+                                                                                               : layout_type::row_major>
+        {
+        };
+
+        template <class V, layout_type L, class E>
+        using multilinear_in_place = std::integral_constant<bool, has_data_interface<E>::value && E::static_layout == L &&
+                                                                  std::is_same<typename E::value_type, V>::value>;
+
+        template <class V, layout_type L, class E>
+        inline const E& multilinear_operand(const E& e, std::true_type /*in place*/)
+        {
+            return e;
+        }
+
+        template <class V, layout_type L, class E>
+        inline xarray<V, L> multilinear_operand(const E& e, std::false_type /*in place*/)
+        {
+            return xarray<V, L>(e);
+        }
+
+        /**
+         * Tensor of layout L read around mode n: element (l, i, p) is at
+         * l * extent * inner + i * inner + p, where i is the index of mode n,
+         * and p and l the flat indices of the modes stored faster and slower
+         * than n. Each l gives an extent x inner row major matrix.
+         */
+        struct mode_split
+        {
+            std::size_t outer = 1;
+            std::size_t extent = 1;
+            std::size_t inner = 1;
+            std::vector<std::size_t> outer_modes;  // slowest first
+            std::vector<std::size_t> inner_modes;  // slowest first
+        };
+
+        template <class S>
+        inline mode_split split_mode(const S& shape, std::size_t mode, layout_type L)
+        {
+            mode_split split;
+            std::size_t dim = shape.size();
+            split.extent = shape[mode];
+            for (std::size_t t = 0; t < dim; ++t)
+            {
+                // modes in storage order, slowest first
+                std::size_t m = L == layout_type::row_major ? t : dim - 1 - t;
+                if (m == mode)
+                {
+                    continue;
+                }
+                bool outer = L == layout_type::row_major ? m < mode : m > mode;
+                (outer ? split.outer_modes : split.inner_modes).push_back(m);
+                (outer ? split.outer : split.inner) *= shape[m];
+            }
+            return split;
+        }
+
+        template <class E>
+        inline void check_multilinear_mode(const E& x, std::size_t mode, const char* name)
+        {
+            if (mode >= x.dimension())
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": mode out of range.");
+            }
+        }
+
+        /**
+         * Mode-n product X x_n M of the tensor at \em x with the column major
+         * matrix \em M, whose number of columns is the extent of mode n. The
+         * tensor is read in place: the slices of the outer modes are the
+         * right operands of one batched GEMM, or, if no mode is stored
+         * faster than n, the whole tensor is the left operand of one GEMM.
+         */
+        template <layout_type L, class T, class S, class M>
+        inline xarray<T, L> mode_product_impl(const T* x, const S& shape, std::size_t mode, const M& m)
+        {
+            auto split = split_mode(shape, mode, L);
+            std::size_t rows = m.shape()[0];
+            std::vector<std::size_t> result_shape(shape.begin(), shape.end());
+            result_shape[mode] = rows;
+            xarray<T, L> result = xarray<T, L>::from_shape(result_shape);
+            if (result.size() == 0)
+            {
+                return result;
+            }
+            if (split.extent == 0)
+            {
+                std::fill(result.begin(), result.end(), T(0));
+                return result;
+            }
+
+            if (split.inner == 1)
+            {
+                // Y (outer x rows) = X (outer x extent) M^T, M^T being M read as row major
+                XTENSOR_BLAS_INSTRUMENT_CALL("mode_product", split.outer, rows, split.extent, layout_type::row_major, 'N', 'N',
+                                             instrument::fma_flops<T>(double(split.outer) * double(rows) * double(split.extent)));
+                cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::RowMajor, cxxblas::Transpose::NoTrans,
+                                            cxxblas::Transpose::NoTrans, to_blas_index(split.outer), to_blas_index(rows),
+                                            to_blas_index(split.extent), T(1), x, to_blas_index(split.extent), m.data(),
+                                            to_blas_index(rows), T(0), result.data(), to_blas_index(rows));
+                return result;
+            }
+
+            // Y_l (rows x inner) = M X_l for every slice l of the outer modes
+            std::vector<const T*> a_ptrs(split.outer, m.data());
+            std::vector<const T*> b_ptrs(split.outer);
+            std::vector<T*> c_ptrs(split.outer);
+            for (std::size_t l = 0; l < split.outer; ++l)
+            {
+                b_ptrs[l] = x + l * split.extent * split.inner;
+                c_ptrs[l] = result.data() + l * rows * split.inner;
+            }
+            XTENSOR_BLAS_INSTRUMENT_CALL("mode_product", rows, split.inner, split.extent, layout_type::row_major, 'T', 'N',
+                                         instrument::fma_flops<T>(double(split.outer) * double(rows) * double(split.inner)
+                                                                  * double(split.extent)));
+            cxxblas::gemm_batch<blas_index_t>(cxxblas::StorageOrder::RowMajor, cxxblas::Transpose::Trans,
+                                              cxxblas::Transpose::NoTrans, to_blas_index(rows), to_blas_index(split.inner),
+                                              to_blas_index(split.extent), T(1), a_ptrs.data(), to_blas_index(rows),
+                                              b_ptrs.data(), to_blas_index(split.inner), T(0), c_ptrs.data(),
+                                              to_blas_index(split.inner), to_blas_index(split.outer));
+            return result;
+        }
+
+        /**
+         * Gram matrix X_(n) X_(n)^H of the mode-n unfolding of the tensor at
+         * \em x, accumulated slice by slice without forming the unfolding.
+         * The result has the conjugate of the Gram matrix in its place for
+         * complex tensors when some mode is stored faster than n, which has
+         * the conjugate eigenvectors.
+         */
+        template <layout_type L, class T, class S>
+        inline xtensor<T, 2, layout_type::column_major> mode_gram(const T* x, const S& shape, std::size_t mode)
+        {
+            auto split = split_mode(shape, mode, L);
+            std::size_t n = split.extent;
+            std::array<std::size_t, 2> shp = {n, n};
+            xtensor<T, 2, layout_type::column_major> G(shp, T(0));
+            if (n == 0 || split.outer * split.inner == 0)
+            {
+                return G;
+            }
+
+            if (split.inner == 1)
+            {
+                // the tensor is the column major n x outer unfolding itself
+                XTENSOR_BLAS_INSTRUMENT_CALL("mode_gram", n, n, split.outer, layout_type::column_major, 'N', 'C',
+                                             instrument::fma_flops<T>(double(n) * double(n) * double(split.outer)));
+                cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::ColMajor, cxxblas::Transpose::NoTrans,
+                                            cxxblas::Transpose::ConjTrans, to_blas_index(n), to_blas_index(n),
+                                            to_blas_index(split.outer), T(1), x, to_blas_index(n), x, to_blas_index(n), T(0),
+                                            G.data(), to_blas_index(n));
+                return G;
+            }
+
+            // slice l is the column major inner x n matrix W_l, and
+            // sum_l W_l^H W_l is the conjugate of the Gram matrix
+            XTENSOR_BLAS_INSTRUMENT_CALL("mode_gram", n, n, split.inner, layout_type::column_major, 'C', 'N',
+                                         instrument::fma_flops<T>(double(split.outer) * double(n) * double(n)
+                                                                  * double(split.inner)));
+            for (std::size_t l = 0; l < split.outer; ++l)
+            {
+                const T* w = x + l * n * split.inner;
+                cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::ColMajor, cxxblas::Transpose::ConjTrans,
+                                            cxxblas::Transpose::NoTrans, to_blas_index(n), to_blas_index(n),
+                                            to_blas_index(split.inner), T(1), w, to_blas_index(split.inner), w,
+                                            to_blas_index(split.inner), l == 0 ? T(0) : T(1), G.data(), to_blas_index(n));
+            }
+            return G;
+        }
+
+        // The r eigenvectors of the largest eigenvalues of the Hermitian G, largest first
+        template <class M>
+        inline M leading_eigenvectors(const M& G, std::size_t r)
+        {
+            std::size_t n = G.shape()[0];
+            auto eig = eigh(G, select_index{n - r, n - 1});
+            auto& W = std::get<1>(eig);
+            std::array<std::size_t, 2> shp = {n, r};
+            M U(shp);
+            for (std::size_t j = 0; j < r; ++j)
+            {
+                xt::view(U, all(), j) = xt::view(W, all(), r - 1 - j);
+            }
+            return U;
+        }
+
+        // Leading left singular vectors of the mode-n unfolding
+        template <layout_type L, class T, class S>
+        inline xtensor<T, 2, layout_type::column_major> mode_factor(const T* x, const S& shape, std::size_t mode,
+                                                                     std::size_t rank)
+        {
+            auto U = leading_eigenvectors(mode_gram<L>(x, shape, mode), rank);
+            if (split_mode(shape, mode, L).inner != 1)
+            {
+                U = xt::conj(U);
+            }
+            return U;
+        }
+
+        template <class M>
+        inline M adjoint_matrix(const M& U)
+        {
+            return xt::conj(xt::transpose(U));
+        }
+
+        template <class T>
+        inline double squared_norm(const T* x, std::size_t size)
+        {
+            double sum = 0.;
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                sum += static_cast<double>(std::norm(x[i]));
+            }
+            return sum;
+        }
+
+        template <class E>
+        inline void check_tucker_ranks(const E& x, const std::vector<std::size_t>& ranks, const char* name)
+        {
+            if (x.dimension() == 0 || ranks.size() != x.dimension())
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": expected one rank per mode.");
+            }
+            for (std::size_t n = 0; n < ranks.size(); ++n)
+            {
+                if (ranks[n] == 0 || ranks[n] > x.shape()[n])
+                {
+                    XTENSOR_THROW(std::runtime_error, std::string(name) + ": rank out of range.");
+                }
+            }
+        }
+
+        /**
+         * X x_0 U_0^H ... x_{N-1} U_{N-1}^H, skipping mode \em skip (none if
+         * it is the dimension), with the modes that shrink the most first.
+         */
+        template <layout_type L, class T, class S, class F>
+        inline xarray<T, L> project_modes(const T* x, const S& shape, const std::vector<F>& factors, std::size_t skip)
+        {
+            std::vector<std::size_t> order;
+            for (std::size_t n = 0; n < shape.size(); ++n)
+            {
+                if (n != skip)
+                {
+                    order.push_back(n);
+                }
+            }
+            std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                return double(factors[a].shape()[1]) / double(shape[a]) < double(factors[b].shape()[1]) / double(shape[b]);
+            });
+
+            xarray<T, L> y;
+            if (order.empty())
+            {
+                std::vector<std::size_t> shp(shape.begin(), shape.end());
+                y = xarray<T, L>::from_shape(shp);
+                std::copy(x, x + y.size(), y.begin());
+                return y;
+            }
+            for (std::size_t t = 0; t < order.size(); ++t)
+            {
+                std::size_t n = order[t];
+                auto m = adjoint_matrix(factors[n]);
+                y = t == 0 ? mode_product_impl<L>(x, shape, n, m) : mode_product_impl<L>(y.data(), y.shape(), n, m);
+            }
+            return y;
+        }
+
+        template <class R, layout_type L, class T, class S>
+        inline R hosvd_impl(const T* x, const S& shape, const std::vector<std::size_t>& ranks)
+        {
+            R result;
+            for (std::size_t n = 0; n < shape.size(); ++n)
+            {
+                result.factors.push_back(mode_factor<L>(x, shape, n, ranks[n]));
+            }
+            result.core = project_modes<L>(x, shape, result.factors, shape.size());
+            return result;
+        }
+
+        inline double tucker_error(double norm_x2, double norm_core2)
+        {
+            return norm_x2 == 0. ? 0. : std::sqrt(std::max(norm_x2 - norm_core2, 0.) / norm_x2);
+        }
+
+        /**
+         * Rows [first, last) of the Khatri-Rao product of the factors of the
+         * modes \em modes (slowest first), written row major with \em rank
+         * columns into \em out: row q is the elementwise product of the rows
+         * i_m(q) of the factors, the last mode varying fastest.
+         */
+        template <class T, class F>
+        inline void khatri_rao_rows(const std::vector<F>& factors, const std::vector<std::size_t>& modes,
+                                    std::size_t first, std::size_t last, std::size_t rank, T* out)
+        {
+            for (std::size_t q = first; q < last; ++q)
+            {
+                T* row = out + (q - first) * rank;
+                std::fill(row, row + rank, T(1));
+                std::size_t rem = q;
+                for (std::size_t t = modes.size(); t-- > 0;)
+                {
+                    const auto& A = factors[modes[t]];
+                    std::size_t i = rem % A.shape()[0];
+                    rem /= A.shape()[0];
+                    for (std::size_t r = 0; r < rank; ++r)
+                    {
+                        row[r] *= A(i, r);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Matricized tensor times Khatri-Rao product X_(n) (A_{N-1} kr ... kr
+         * A_{n+1} kr A_{n-1} kr ... kr A_0) for the tensor at \em x, of shape
+         * (I_n, R). The Khatri-Rao product is formed in blocks of
+         * khatri_rao_block_rows rows of the modes stored on the larger side
+         * of n, each multiplied with the matching (strided, in place) block
+         * of the tensor by GEMM.
+         */
+        template <layout_type L, class T, class S, class F>
+        inline xtensor<T, 2, layout_type::column_major> mttkrp(const T* x, const S& shape, const std::vector<F>& factors,
+                                                                std::size_t mode, std::size_t rank)
+        {
+            auto split = split_mode(shape, mode, L);
+            std::size_t n = split.extent;
+            std::array<std::size_t, 2> shp = {n, rank};
+            xtensor<T, 2, layout_type::column_major> M(shp, T(0));
+            if (n == 0 || split.outer * split.inner == 0)
+            {
+                return M;
+            }
+
+            XTENSOR_BLAS_INSTRUMENT_CALL("mttkrp", n, rank, split.outer * split.inner, L, 'N', 'N',
+                                         instrument::fma_flops<T>(double(n) * double(rank) * double(split.outer)
+                                                                  * double(split.inner)));
+            std::vector<T> kr, other(rank);
+            if (split.inner >= split.outer)
+            {
+                // T_l = X_l[:, block] KR_inner[block, :] for each outer slice l,
+                // then M += T_l scaled columnwise by row l of KR_outer
+                std::size_t block = std::min(split.inner, khatri_rao_block_rows);
+                kr.resize(block * rank);
+                std::vector<T> t(n * rank);
+                for (std::size_t p0 = 0; p0 < split.inner; p0 += block)
+                {
+                    std::size_t width = std::min(block, split.inner - p0);
+                    khatri_rao_rows(factors, split.inner_modes, p0, p0 + width, rank, kr.data());
+                    for (std::size_t l = 0; l < split.outer; ++l)
+                    {
+                        khatri_rao_rows(factors, split.outer_modes, l, l + 1, rank, other.data());
+                        cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::RowMajor, cxxblas::Transpose::NoTrans,
+                                                    cxxblas::Transpose::NoTrans, to_blas_index(n), to_blas_index(rank),
+                                                    to_blas_index(width), T(1), x + l * n * split.inner + p0,
+                                                    to_blas_index(split.inner), kr.data(), to_blas_index(rank), T(0),
+                                                    t.data(), to_blas_index(rank));
+                        for (std::size_t r = 0; r < rank; ++r)
+                        {
+                            for (std::size_t i = 0; i < n; ++i)
+                            {
+                                M(i, r) += t[i * rank + r] * other[r];
+                            }
+                        }
+                    }
+                }
+                return M;
+            }
+
+            // W = X^T KR_outer with X read as the row major outer x (n inner)
+            // matrix, accumulated over blocks of outer rows, then
+            // M(i, r) = sum_p W(i inner + p, r) KR_inner(p, r)
+            std::size_t block = std::min(split.outer, khatri_rao_block_rows);
+            kr.resize(block * rank);
+            std::vector<T> w(n * split.inner * rank);
+            for (std::size_t l0 = 0; l0 < split.outer; l0 += block)
+            {
+                std::size_t height = std::min(block, split.outer - l0);
+                khatri_rao_rows(factors, split.outer_modes, l0, l0 + height, rank, kr.data());
+                cxxblas::gemm<blas_index_t>(cxxblas::StorageOrder::RowMajor, cxxblas::Transpose::Trans,
+                                            cxxblas::Transpose::NoTrans, to_blas_index(n * split.inner),
+                                            to_blas_index(rank), to_blas_index(height), T(1),
+                                            x + l0 * n * split.inner, to_blas_index(n * split.inner), kr.data(),
+                                            to_blas_index(rank), l0 == 0 ? T(0) : T(1), w.data(), to_blas_index(rank));
+            }
+            for (std::size_t p = 0; p < split.inner; ++p)
+            {
+                khatri_rao_rows(factors, split.inner_modes, p, p + 1, rank, other.data());
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    const T* wrow = w.data() + (i * split.inner + p) * rank;
+                    for (std::size_t r = 0; r < rank; ++r)
+                    {
+                        M(i, r) += wrow[r] * other[r];
+                    }
+                }
+            }
+            return M;
+        }
+
+        // Elementwise product of the Gram matrices A_m^T A_m of all factors but \em skip
+        template <class F>
+        inline F factor_gram_product(const std::vector<F>& factors, std::size_t skip, std::size_t rank)
+        {
+            std::array<std::size_t, 2> shp = {rank, rank};
+            F V(shp, typename F::value_type(1));
+            for (std::size_t m = 0; m < factors.size(); ++m)
+            {
+                if (m != skip)
+                {
+                    F G = gram(factors[m], 'L', true);
+                    V *= G;
+                }
+            }
+            return V;
+        }
+    }
+
+    /**
+     * Mode-n product X x_n U of the tensor \em X with the matrix \em U of
+     * shape (J, I_n), or with U^H (U of shape (I_n, J)) if \em adjoint.
+     * Row and column major tensors are read in place by GEMM on their own
+     * layout, without unfolding: the slices of the modes stored slower than
+     * n go through one batched GEMM.
+     *
+     * @param X tensor of any dimension
+     * @param U matrix
+     * @param mode index n of the mode to multiply
+     * @param adjoint multiply by U^H instead of U
+     * @return tensor of the layout of \em X with mode n of extent J
+     */
+    template <class E, class M>
+    auto mode_product(const xexpression<E>& X, const xexpression<M>& U, std::size_t mode, bool adjoint = false)
+    {
+        using value_type = typename E::value_type;
+        constexpr layout_type L = detail::multilinear_layout<E>::value;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        const auto& x = detail::multilinear_operand<value_type, L>(X.derived_cast(),
+                                                                   detail::multilinear_in_place<value_type, L, E>());
+        detail::check_multilinear_mode(x, mode, "mode_product");
+        matrix_type m = adjoint ? matrix_type(xt::conj(xt::transpose(U.derived_cast()))) : matrix_type(U.derived_cast());
+        if (m.shape()[1] != x.shape()[mode])
+        {
+            XTENSOR_THROW(std::runtime_error, "mode_product: shape mismatch.");
+        }
+        return detail::mode_product_impl<L>(x.data() + x.data_offset(), x.shape(), mode, m);
+    }
+
+    /**
+     * Truncated higher-order SVD of the tensor \em X: factor n holds the
+     * ranks[n] leading left singular vectors of the mode-n unfolding, taken
+     * from the eigenvectors of its Gram matrix, which is accumulated from
+     * the slices of the tensor without forming the unfolding. The core is
+     * X x_0 U_0^H ... x_{N-1} U_{N-1}^H, computed by mode products in the
+     * order that shrinks the tensor the fastest.
+     *
+     * @param X tensor of dimension N
+     * @param ranks multilinear rank, 1 <= ranks[n] <= I_n
+     * @return the Tucker decomposition, with the core in the layout of \em X
+     */
+    template <class E>
+    auto hosvd(const xexpression<E>& X, const std::vector<std::size_t>& ranks)
+    {
+        using value_type = typename E::value_type;
+        constexpr layout_type L = detail::multilinear_layout<E>::value;
+        using result_type = tucker_decomposition<value_type, L>;
+
+        const auto& x = detail::multilinear_operand<value_type, L>(X.derived_cast(),
+                                                                   detail::multilinear_in_place<value_type, L, E>());
+        detail::check_tucker_ranks(x, ranks, "hosvd");
+        const value_type* data = x.data() + x.data_offset();
+        auto result = detail::hosvd_impl<result_type, L>(data, x.shape(), ranks);
+        result.relative_error = detail::tucker_error(detail::squared_norm(data, x.size()),
+                                                     detail::squared_norm(result.core.data(), result.core.size()));
+        return result;
+    }
+
+    /**
+     * Tucker decomposition of the tensor \em X by higher-order orthogonal
+     * iteration, starting from hosvd. Each sweep updates factor n from the
+     * projection of X on all the other factors, so only tensors with
+     * one full mode are formed. It stops when the relative error changes
+     * by less than \em tol or after \em max_iter sweeps.
+     *
+     * @param X tensor of dimension N
+     * @param ranks multilinear rank, 1 <= ranks[n] <= I_n
+     * @param max_iter maximum number of sweeps
+     * @param tol tolerance on the change of the relative error
+     * @return the Tucker decomposition, with the core in the layout of \em X
+     */
+    template <class E>
+    auto tucker_hooi(const xexpression<E>& X, const std::vector<std::size_t>& ranks, std::size_t max_iter = 50,
+                     double tol = 1e-10)
+    {
+        using value_type = typename E::value_type;
+        constexpr layout_type L = detail::multilinear_layout<E>::value;
+        using result_type = tucker_decomposition<value_type, L>;
+
+        const auto& x = detail::multilinear_operand<value_type, L>(X.derived_cast(),
+                                                                   detail::multilinear_in_place<value_type, L, E>());
+        detail::check_tucker_ranks(x, ranks, "tucker_hooi");
+        const value_type* data = x.data() + x.data_offset();
+        const auto& shape = x.shape();
+        std::size_t dim = x.dimension();
+
+        auto result = detail::hosvd_impl<result_type, L>(data, shape, ranks);
+        double norm_x2 = detail::squared_norm(data, x.size());
+        result.relative_error = detail::tucker_error(norm_x2, detail::squared_norm(result.core.data(), result.core.size()));
+
+        for (std::size_t it = 0; it < max_iter; ++it)
+        {
+            xarray<value_type, L> y;
+            for (std::size_t n = 0; n < dim; ++n)
+            {
+                y = detail::project_modes<L>(data, shape, result.factors, n);
+                result.factors[n] = detail::mode_factor<L>(y.data(), y.shape(), n, ranks[n]);
+            }
+            result.core = detail::mode_product_impl<L>(y.data(), y.shape(), dim - 1,
+                                                       detail::adjoint_matrix(result.factors[dim - 1]));
+            double error = detail::tucker_error(norm_x2, detail::squared_norm(result.core.data(), result.core.size()));
+            bool converged = std::abs(result.relative_error - error) <= tol;
+            result.relative_error = error;
+            result.iterations = it + 1;
+            if (converged)
+            {
+                break;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Expands a Tucker decomposition into the full tensor
+     * core x_0 U_0 ... x_{N-1} U_{N-1}.
+     */
+    template <class T, layout_type L>
+    xarray<T, L> tucker_to_tensor(const tucker_decomposition<T, L>& t)
+    {
+        xarray<T, L> y = t.core;
+        for (std::size_t n = 0; n < t.factors.size(); ++n)
+        {
+            y = detail::mode_product_impl<L>(y.data(), y.shape(), n, t.factors[n]);
+        }
+        return y;
+    }
+
+    /**
+     * Rank \em rank CP decomposition of the real tensor \em X by alternating
+     * least squares. Factor n is updated as X_(n) K (V)^+, where K is the
+     * Khatri-Rao product of the other factors, never formed in full: X_(n) K
+     * is accumulated by GEMMs of blocks of K with the matching slices of X,
+     * in place, and V is the elementwise product of the rank x rank Gram
+     * matrices of the other factors. The factors start from Gaussian
+     * matrices drawn from a std::mt19937 seeded with \em seed. It stops when
+     * the relative error changes by less than \em tol or after \em max_iter
+     * sweeps.
+     *
+     * @param X real tensor of dimension N
+     * @param rank number of rank one terms
+     * @param max_iter maximum number of sweeps
+     * @param tol tolerance on the change of the relative error
+     * @param seed seed of the initial factors
+     * @return the CP decomposition
+     */
+    template <class E>
+    auto cp_als(const xexpression<E>& X, std::size_t rank, std::size_t max_iter = 200, double tol = 1e-10,
+                std::mt19937::result_type seed = 0)
+    {
+        using value_type = typename E::value_type;
+        static_assert(!xtl::is_complex<value_type>::value, "cp_als: complex tensors are not supported.");
+        constexpr layout_type L = detail::multilinear_layout<E>::value;
+        using result_type = cp_decomposition<value_type>;
+        using matrix_type = typename result_type::matrix_type;
+
+        const auto& x = detail::multilinear_operand<value_type, L>(X.derived_cast(),
+                                                                   detail::multilinear_in_place<value_type, L, E>());
+        if (x.dimension() == 0 || rank == 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "cp_als: expected a tensor and a positive rank.");
+        }
+        const value_type* data = x.data() + x.data_offset();
+        const auto& shape = x.shape();
+        std::size_t dim = x.dimension();
+        double norm_x2 = detail::squared_norm(data, x.size());
+
+        result_type result;
+        std::mt19937 engine(seed);
+        for (std::size_t n = 0; n < dim; ++n)
+        {
+            std::array<std::size_t, 2> shp = {shape[n], rank};
+            matrix_type A(shp);
+            detail::fill_gaussian(A, engine, std::false_type());
+            for (std::size_t r = 0; r < rank; ++r)
+            {
+                auto column = xt::view(A, all(), r);
+                value_type nrm = xt::linalg::norm(column, 2);
+                column /= nrm == value_type(0) ? value_type(1) : nrm;
+            }
+            result.factors.push_back(std::move(A));
+        }
+        std::array<std::size_t, 1> w_shp = {rank};
+        result.weights = xtensor<value_type, 1>(w_shp, value_type(1));
+        result.relative_error = 1.;
+
+        for (std::size_t it = 0; it < max_iter; ++it)
+        {
+            double inner = 0.;
+            for (std::size_t n = 0; n < dim; ++n)
+            {
+                matrix_type M = detail::mttkrp<L>(data, shape, result.factors, n, rank);
+                matrix_type V = detail::factor_gram_product(result.factors, n, rank);
+                matrix_type A = xt::linalg::dot(M, xt::linalg::pinv(V));
+                if (n + 1 == dim)
+                {
+                    // <X, reconstruction> with the unnormalized last factor
+                    inner = static_cast<double>(xt::sum(M * A)());
+                }
+                for (std::size_t r = 0; r < rank; ++r)
+                {
+                    auto column = xt::view(A, all(), r);
+                    value_type nrm = xt::linalg::norm(column, 2);
+                    result.weights(r) = nrm;
+                    column /= nrm == value_type(0) ? value_type(1) : nrm;
+                }
+                result.factors[n] = std::move(A);
+            }
+
+            // ||reconstruction||^2 = w^T (*_m A_m^T A_m) w
+            matrix_type V = detail::factor_gram_product(result.factors, dim, rank);
+            xtensor<value_type, 1> vw = xt::linalg::dot(V, result.weights);
+            double norm_y2 = static_cast<double>(xt::linalg::vdot(result.weights, vw));
+            double error = norm_x2 == 0. ? 0. : std::sqrt(std::max(norm_x2 + norm_y2 - 2. * inner, 0.) / norm_x2);
+            bool converged = std::abs(result.relative_error - error) <= tol;
+            result.relative_error = error;
+            result.iterations = it + 1;
+            if (converged)
+            {
+                break;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Expands a CP decomposition into the full tensor, in layout \em L.
+     */
+    template <layout_type L = XTENSOR_DEFAULT_LAYOUT, class T>
+    xarray<T, L> cp_to_tensor(const cp_decomposition<T>& c)
+    {
+        // the r x ... x r diagonal core of the weights, as a Tucker core
+        std::size_t dim = c.factors.size();
+        std::size_t rank = c.weights.size();
+        std::vector<std::size_t> shp(dim, rank);
+        xarray<T, L> core(shp, T(0));
+        std::size_t stride = 0;
+        for (std::size_t n = 0, s = 1; n < dim; ++n, s *= rank)
+        {
+            stride += s;
+        }
+        for (std::size_t r = 0; r < rank; ++r)
+        {
+            core.data()[r * stride] = c.weights(r);
+        }
+        xarray<T, L> y = core;
+        for (std::size_t n = 0; n < dim; ++n)
+        {
+            y = detail::mode_product_impl<L>(y.data(), y.shape(), n, c.factors[n]);
+        }
+        return y;
+    }
+}
+}
+
+#endif
@@ -0,0 +1,414 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+
+#ifndef XOUT_OF_CORE_HPP
+#define XOUT_OF_CORE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_instrument.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+    /**
+     * Selects the out-of-core dot_into and cholesky_inplace, for matrices
+     * larger than the memory, e.g. adapted with xt::adapt over a memory
+     * mapped file. Blocks of the operands are copied to buffers of at most
+     * \em memory_budget bytes in total and multiplied there, while the
+     * next blocks are read by a second thread.
+     */
+    struct out_of_core_t
+    {
+        std::size_t memory_budget = std::size_t(1) << 30;  ///< Bytes of the in-memory buffers
+        bool prefetch = true;                               ///< Read the next blocks while multiplying
+    };
+
+    constexpr out_of_core_t out_of_core = {};
+
+    namespace detail
+    {
+        // element (i, j) of a strided matrix is data[i * rs + j * cs]
+        template <class P>
+        struct ooc_matrix
+        {
+            P data;
+            std::size_t rows;
+            std::size_t cols;
+            std::ptrdiff_t rs;
+            std::ptrdiff_t cs;
+        };
+
+        template <class E>
+        inline auto make_ooc_matrix(E& e, const char* name)
+        {
+            static_assert(has_data_interface<std::decay_t<E>>::value,
+                          "out_of_core: the operands must expose their data, e.g. xt::adapt over a mapping.");
+            if (e.dimension() != 2)
+            {
+                XTENSOR_THROW(std::runtime_error, std::string(name) + ": expected matrices.");
+            }
+            using pointer = decltype(e.data());
+            return ooc_matrix<pointer>{e.data() + e.data_offset(), e.shape()[0], e.shape()[1],
+                                       static_cast<std::ptrdiff_t>(e.strides()[0]),
+                                       static_cast<std::ptrdiff_t>(e.strides()[1])};
+        }
+
+        // copies the block at (r0, c0) of nr x nc to the column-major buf;
+        // the inner loop runs along the contiguous dimension of the mapping
+        template <class P, class T>
+        inline void ooc_load(const ooc_matrix<P>& a, std::size_t r0, std::size_t c0, std::size_t nr,
+                             std::size_t nc, T* buf)
+        {
+            if (std::abs(a.cs) < std::abs(a.rs) || nr == 1)
+            {
+                for (std::size_t i = 0; i < nr; ++i)
+                {
+                    auto row = a.data + std::ptrdiff_t(r0 + i) * a.rs + std::ptrdiff_t(c0) * a.cs;
+                    for (std::size_t j = 0; j < nc; ++j)
+                    {
+                        buf[j * nr + i] = row[std::ptrdiff_t(j) * a.cs];
+                    }
+                }
+                return;
+            }
+            for (std::size_t j = 0; j < nc; ++j)
+            {
+                auto col = a.data + std::ptrdiff_t(r0) * a.rs + std::ptrdiff_t(c0 + j) * a.cs;
+                for (std::size_t i = 0; i < nr; ++i)
+                {
+                    buf[j * nr + i] = col[std::ptrdiff_t(i) * a.rs];
+                }
+            }
+        }
+
+        // writes the column-major buf back, only the rows i >= j of column
+        // j when lower is set
+        template <class P, class T>
+        inline void ooc_store(ooc_matrix<P>& a, std::size_t r0, std::size_t c0, std::size_t nr,
+                              std::size_t nc, const T* buf, bool lower = false)
+        {
+            for (std::size_t j = 0; j < nc; ++j)
+            {
+                std::size_t first = lower ? std::min(j, nr) : 0;
+                auto col = a.data + std::ptrdiff_t(r0) * a.rs + std::ptrdiff_t(c0 + j) * a.cs;
+                for (std::size_t i = first; i < nr; ++i)
+                {
+                    col[std::ptrdiff_t(i) * a.rs] = buf[j * nr + i];
+                }
+            }
+        }
+
+        // runs the reads of the next step on a second thread, or right away
+        class ooc_prefetcher
+        {
+        public:
+
+            explicit ooc_prefetcher(bool async)
+                : m_async(async)
+            {
+            }
+
+            ~ooc_prefetcher()
+            {
+                if (m_pending.valid())
+                {
+                    m_pending.wait();
+                }
+            }
+
+            template <class F>
+            void start(F&& f)
+            {
+                if (m_async)
+                {
+                    m_pending = std::async(std::launch::async, std::forward<F>(f));
+                }
+                else
+                {
+                    f();
+                }
+            }
+
+            void wait()
+            {
+                if (m_pending.valid())
+                {
+                    m_pending.get();
+                }
+            }
+
+        private:
+
+            bool m_async;
+            std::future<void> m_pending;
+        };
+
+        struct ooc_gemm_step
+        {
+            std::size_t i0, j0, k0;
+            bool first;
+            bool last;
+            bool load_a;
+        };
+
+        // the blocks of C in row order, the panels of K forward and backward
+        // in turn, so that the A panel closing a block opens the next one
+        inline std::vector<ooc_gemm_step> ooc_gemm_schedule(std::size_t m, std::size_t n, std::size_t k,
+                                                            std::size_t b, std::size_t bk)
+        {
+            std::vector<std::size_t> panels;
+            for (std::size_t k0 = 0; k0 < k; k0 += bk)
+            {
+                panels.push_back(k0);
+            }
+            std::vector<ooc_gemm_step> steps;
+            bool forward = true;
+            for (std::size_t i0 = 0; i0 < m; i0 += b)
+            {
+                for (std::size_t j0 = 0; j0 < n; j0 += b)
+                {
+                    for (std::size_t p = 0; p < panels.size(); ++p)
+                    {
+                        std::size_t k0 = forward ? panels[p] : panels[panels.size() - 1 - p];
+                        bool load_a = steps.empty() || steps.back().i0 != i0 || steps.back().k0 != k0;
+                        steps.push_back(ooc_gemm_step{i0, j0, k0, p == 0, p + 1 == panels.size(), load_a});
+                    }
+                    forward = !forward;
+                }
+            }
+            return steps;
+        }
+    }
+
+    /**
+     * Out-of-core dot_into: ``result := alpha * dot(a, b) + beta * result``
+     * for matrices that do not fit in memory, read and written in place
+     * through their data, e.g. xt::adapt over memory mapped files. The
+     * operands may have any strides, so ``transpose(x)`` of a mapping
+     * gives the Gram matrix ``x^T x`` without copying x.
+     *
+     * \em result is computed by square blocks, each multiplied by GEMM
+     * panel after panel of the inner dimension; the block order is chosen
+     * so that consecutive blocks share an A panel. The budget is split
+     * into one block of \em result and two A and B panels each, so that the
+     * next panels are read while GEMM runs on the current ones.
+     *
+     * @param a matrix of shape (m, k)
+     * @param b matrix of shape (k, n)
+     * @param result matrix of shape (m, n)
+     * @param options memory budget and prefetching
+     * @param alpha scale factor for the product
+     * @param beta scale factor for \em result
+     */
+    template <class T, class O, class R, class value_type = typename R::value_type>
+    void dot_into(const xexpression<T>& a, const xexpression<O>& b, R& result, const out_of_core_t& options,
+                  const value_type& alpha = value_type(1.0), const value_type& beta = value_type(0.0))
+    {
+        auto A = detail::make_ooc_matrix(a.derived_cast(), "dot_into");
+        auto B = detail::make_ooc_matrix(b.derived_cast(), "dot_into");
+        auto C = detail::make_ooc_matrix(result, "dot_into");
+        std::size_t m = A.rows, k = A.cols, n = B.cols;
+        if (B.rows != k || C.rows != m || C.cols != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "dot_into: shape mismatch.");
+        }
+        if (m == 0 || n == 0)
+        {
+            return;
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("gemm_out_of_core", m, n, k, layout_type::column_major);
+
+        // b^2 for the block of result, and 2 b/2 x b panels each for A and B
+        std::size_t words = options.memory_budget / sizeof(value_type);
+        std::size_t b_size = static_cast<std::size_t>(std::sqrt(double(words) / 3.));
+        if (b_size < 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "dot_into: the memory budget is too small.");
+        }
+        std::size_t bk = std::min(std::max(b_size / 2, std::size_t(1)), std::max(k, std::size_t(1)));
+        std::size_t bm = std::min(b_size, m), bn = std::min(b_size, n);
+
+        blas_buffer<value_type> c(bm * bn);
+        auto start_block = [&](std::size_t i0, std::size_t j0, std::size_t mi, std::size_t nj) {
+            if (beta == value_type(0))
+            {
+                std::fill(c.begin(), c.end(), value_type(0));
+                return;
+            }
+            detail::ooc_load(C, i0, j0, mi, nj, c.data());
+            std::for_each(c.begin(), c.begin() + std::ptrdiff_t(mi * nj), [&](value_type& v) { v *= beta; });
+        };
+        if (k == 0)
+        {
+            for (std::size_t i0 = 0; i0 < m; i0 += bm)
+            {
+                for (std::size_t j0 = 0; j0 < n; j0 += bn)
+                {
+                    std::size_t mi = std::min(bm, m - i0), nj = std::min(bn, n - j0);
+                    start_block(i0, j0, mi, nj);
+                    detail::ooc_store(C, i0, j0, mi, nj, c.data());
+                }
+            }
+            return;
+        }
+
+        auto steps = detail::ooc_gemm_schedule(m, n, k, b_size, bk);
+        blas_buffer<value_type> pa[2] = {blas_buffer<value_type>(bm * bk), blas_buffer<value_type>(bm * bk)};
+        blas_buffer<value_type> pb[2] = {blas_buffer<value_type>(bk * bn), blas_buffer<value_type>(bk * bn)};
+        std::vector<int> slot_a(steps.size());
+        detail::ooc_prefetcher prefetcher(options.prefetch);
+
+        auto load = [&](std::size_t s) {
+            const auto& st = steps[s];
+            std::size_t mi = std::min(bm, m - st.i0), nj = std::min(bn, n - st.j0), kp = std::min(bk, k - st.k0);
+            slot_a[s] = s == 0 ? 0 : (st.load_a ? 1 - slot_a[s - 1] : slot_a[s - 1]);
+            if (st.load_a)
+            {
+                detail::ooc_load(A, st.i0, st.k0, mi, kp, pa[slot_a[s]].data());
+            }
+            detail::ooc_load(B, st.k0, st.j0, kp, nj, pb[s % 2].data());
+        };
+
+        load(0);
+        for (std::size_t s = 0; s < steps.size(); ++s)
+        {
+            prefetcher.wait();
+            if (s + 1 < steps.size())
+            {
+                // slot_a[s + 1] is written here, before the next wait
+                prefetcher.start([&load, s]() { load(s + 1); });
+            }
+            const auto& st = steps[s];
+            std::size_t mi = std::min(bm, m - st.i0), nj = std::min(bn, n - st.j0), kp = std::min(bk, k - st.k0);
+            if (st.first)
+            {
+                start_block(st.i0, st.j0, mi, nj);
+            }
+            cxxblas::gemm<blas_index_t>(cxxblas::ColMajor, cxxblas::NoTrans, cxxblas::NoTrans,
+                                        to_blas_index(mi), to_blas_index(nj), to_blas_index(kp),
+                                        alpha, pa[slot_a[s]].data(), to_blas_index(mi),
+                                        pb[s % 2].data(), to_blas_index(kp),
+                                        value_type(1), c.data(), to_blas_index(mi));
+            if (st.last)
+            {
+                detail::ooc_store(C, st.i0, st.j0, mi, nj, c.data());
+            }
+        }
+    }
+
+    /**
+     * Out-of-core Cholesky factorization A = L L^H of a Hermitian positive
+     * definite matrix that does not fit in memory, in place: the lower
+     * triangle of \em A is overwritten with L, its strict upper triangle is
+     * left untouched, as by LAPACK potrf.
+     *
+     * Left-looking by panels of columns: each panel is updated with the
+     * panels of L left of it, streamed through two buffers so that the
+     * next one is read while GEMM runs, then factored by potrf and trsm
+     * and written back. The panel width is the largest with three panels
+     * of the height of \em A in the budget.
+     *
+     * @param A square matrix exposing its data, e.g. xt::adapt over a mapping
+     * @param options memory budget and prefetching
+     * @return reference to \em A
+     */
+    template <class E>
+    E& cholesky_inplace(E& A, const out_of_core_t& options)
+    {
+        using value_type = typename E::value_type;
+        auto M = detail::make_ooc_matrix(A, "cholesky_inplace");
+        std::size_t n = M.rows;
+        if (M.cols != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "cholesky_inplace: expected a square matrix.");
+        }
+        if (n == 0)
+        {
+            return A;
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("potrf_out_of_core", n, n, 0, layout_type::column_major);
+
+        std::size_t b_size = std::min(options.memory_budget / sizeof(value_type) / (3 * n), n);
+        if (b_size == 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "cholesky_inplace: the memory budget is too small.");
+        }
+
+        blas_buffer<value_type> panel(n * b_size);
+        blas_buffer<value_type> left[2] = {blas_buffer<value_type>(n * b_size), blas_buffer<value_type>(n * b_size)};
+        detail::ooc_prefetcher prefetcher(options.prefetch);
+
+        // the panels of L left of column j0, below row j0
+        auto load = [&](std::size_t j0, std::size_t p0, int slot) {
+            detail::ooc_load(M, j0, p0, n - j0, std::min(b_size, n - p0), left[slot].data());
+        };
+
+        int slot = 0;
+        for (std::size_t j0 = 0; j0 < n; j0 += b_size)
+        {
+            std::size_t w = std::min(b_size, n - j0);
+            std::size_t rows = n - j0;
+            blas_index_t brows = to_blas_index(rows), bw = to_blas_index(w);
+            detail::ooc_load(M, j0, j0, rows, w, panel.data());
+
+            if (j0 != 0)
+            {
+                load(j0, 0, slot);
+            }
+            for (std::size_t p0 = 0; p0 < j0; p0 += b_size)
+            {
+                prefetcher.wait();
+                if (p0 + b_size < j0)
+                {
+                    prefetcher.start([&load, j0, p0, b_size, slot]() { load(j0, p0 + b_size, 1 - slot); });
+                }
+                std::size_t wp = std::min(b_size, j0 - p0);
+                cxxblas::gemm<blas_index_t>(cxxblas::ColMajor, cxxblas::NoTrans, cxxblas::ConjTrans,
+                                            brows, bw, to_blas_index(wp), value_type(-1),
+                                            left[slot].data(), brows, left[slot].data(), brows,
+                                            value_type(1), panel.data(), brows);
+                slot = 1 - slot;
+            }
+            prefetcher.wait();
+
+            blas_index_t info = cxxlapack::potrf<blas_index_t>('L', bw, panel.data(), brows);
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is not positive definite.");
+            }
+            if (rows > w)
+            {
+                cxxblas::trsm<blas_index_t>(cxxblas::ColMajor, cxxblas::Right, cxxblas::Lower, cxxblas::ConjTrans,
+                                            cxxblas::NonUnit, brows - bw, bw, value_type(1), panel.data(), brows,
+                                            panel.data() + w, brows);
+            }
+            detail::ooc_store(M, j0, j0, rows, w, panel.data(), true);
+        }
+        return A;
+    }
+}
+}
+
+#endif
@@ -0,0 +1,701 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XPACKED_HPP
+#define XPACKED_HPP
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xstorage.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+    namespace detail
+    {
+        /****************
+         * xpacked_base *
+         ****************/
+
+        /**
+         * One triangle of an n by n matrix, packed column by column in n (n + 1) / 2
+         * elements as the LAPACK packed routines expect: element (i, j) of the
+         * upper triangle (i <= j) is stored at i + j (j + 1) / 2, element (i, j)
+         * of the lower triangle (i >= j) at i + j (2 n - j - 1) / 2.
+         */
+        template <class T>
+        class xpacked_base
+        {
+        public:
+
+            using value_type = T;
+            using storage_type = uvector<T>;
+            using size_type = std::size_t;
+            using shape_type = std::array<size_type, 2>;
+
+            size_type order() const noexcept;
+            shape_type shape() const noexcept;
+            size_type dimension() const noexcept;
+            char uplo() const noexcept;
+
+            bool in_triangle(size_type i, size_type j) const noexcept;
+            value_type& stored(size_type i, size_type j);
+            const value_type& stored(size_type i, size_type j) const;
+
+            storage_type& storage() noexcept;
+            const storage_type& storage() const noexcept;
+            value_type* data() noexcept;
+            const value_type* data() const noexcept;
+
+        protected:
+
+            xpacked_base() = default;
+            xpacked_base(size_type n, char uplo, const value_type& value);
+
+            template <class E>
+            void pack(const E& e);
+
+        private:
+
+            size_type index(size_type i, size_type j) const noexcept;
+
+            storage_type m_storage;
+            size_type m_order = 0;
+            char m_uplo = 'L';
+        };
+    }
+
+    /*********************
+     * xpacked_symmetric *
+     *********************/
+
+    /**
+     * Symmetric matrix, Hermitian for complex value types, of which only the
+     * \em uplo triangle is stored, packed.
+     *
+     * It is not an xexpression: the overloads of linalg::cholesky, solve, dot,
+     * eigh and eigvalsh taking it work on the packed storage directly, and
+     * dense() expands it when an xtensor is needed.
+     */
+    template <class T>
+    class xpacked_symmetric : public detail::xpacked_base<T>
+    {
+    public:
+
+        using base_type = detail::xpacked_base<T>;
+        using value_type = typename base_type::value_type;
+        using size_type = typename base_type::size_type;
+
+        xpacked_symmetric() = default;
+        explicit xpacked_symmetric(size_type n, char uplo = 'L', const value_type& value = value_type(0));
+
+        template <class E>
+        explicit xpacked_symmetric(const xexpression<E>& e, char uplo = 'L');
+
+        value_type operator()(size_type i, size_type j) const;
+        xtensor<value_type, 2, layout_type::column_major> dense() const;
+    };
+
+    /**********************
+     * xpacked_triangular *
+     **********************/
+
+    /**
+     * Triangular matrix of which only the \em uplo triangle is stored, packed.
+     * With \em diag 'U' the diagonal is taken as unit and not read from the
+     * storage.
+     */
+    template <class T>
+    class xpacked_triangular : public detail::xpacked_base<T>
+    {
+    public:
+
+        using base_type = detail::xpacked_base<T>;
+        using value_type = typename base_type::value_type;
+        using size_type = typename base_type::size_type;
+
+        xpacked_triangular() = default;
+        explicit xpacked_triangular(size_type n, char uplo = 'L', char diag = 'N',
+                                    const value_type& value = value_type(0));
+
+        template <class E>
+        explicit xpacked_triangular(const xexpression<E>& e, char uplo = 'L', char diag = 'N');
+
+        char diag() const noexcept;
+
+        value_type operator()(size_type i, size_type j) const;
+        xtensor<value_type, 2, layout_type::column_major> dense() const;
+
+    private:
+
+        char m_diag = 'N';
+    };
+
+    /*******************************
+     * xpacked_base implementation *
+     *******************************/
+
+    namespace detail
+    {
+        template <class T>
+        inline xpacked_base<T>::xpacked_base(size_type n, char uplo, const value_type& value)
+            : m_storage(n * (n + 1) / 2, value), m_order(n), m_uplo(uplo)
+        {
+            if (uplo != 'L' && uplo != 'U')
+            {
+                XTENSOR_THROW(std::runtime_error, "Packed storage: uplo must be 'L' or 'U'.");
+            }
+        }
+
+        template <class T>
+        template <class E>
+        inline void xpacked_base<T>::pack(const E& e)
+        {
+            for (size_type j = 0; j < m_order; ++j)
+            {
+                size_type first = m_uplo == 'U' ? 0 : j;
+                size_type last = m_uplo == 'U' ? j + 1 : m_order;
+                for (size_type i = first; i < last; ++i)
+                {
+                    m_storage[index(i, j)] = e(i, j);
+                }
+            }
+        }
+
+        template <class T>
+        inline auto xpacked_base<T>::order() const noexcept -> size_type
+        {
+            return m_order;
+        }
+
+        template <class T>
+        inline auto xpacked_base<T>::shape() const noexcept -> shape_type
+        {
+            return {m_order, m_order};
+        }
+
+        template <class T>
+        inline auto xpacked_base<T>::dimension() const noexcept -> size_type
+        {
+            return 2;
+        }
+
+        template <class T>
+        inline char xpacked_base<T>::uplo() const noexcept
+        {
+            return m_uplo;
+        }
+
+        /**
+         * Returns true when element (i, j) lies in the stored triangle.
+         */
+        template <class T>
+        inline bool xpacked_base<T>::in_triangle(size_type i, size_type j) const noexcept
+        {
+            return m_uplo == 'U' ? i <= j : i >= j;
+        }
+
+        /**
+         * Returns a reference to element (i, j) of the stored triangle.
+         */
+        template <class T>
+        inline auto xpacked_base<T>::stored(size_type i, size_type j) -> value_type&
+        {
+            XTENSOR_ASSERT(in_triangle(i, j));
+            return m_storage[index(i, j)];
+        }
+
+        template <class T>
+        inline auto xpacked_base<T>::stored(size_type i, size_type j) const -> const value_type&
+        {
+            XTENSOR_ASSERT(in_triangle(i, j));
+            return m_storage[index(i, j)];
+        }
+
+        template <class T>
+        inline auto xpacked_base<T>::storage() noexcept -> storage_type&
+        {
+            return m_storage;
+        }
+
+        template <class T>
+        inline auto xpacked_base<T>::storage() const noexcept -> const storage_type&
+        {
+            return m_storage;
+        }
+
+        template <class T>
+        inline auto xpacked_base<T>::data() noexcept -> value_type*
+        {
+            return m_storage.data();
+        }
+
+        template <class T>
+        inline auto xpacked_base<T>::data() const noexcept -> const value_type*
+        {
+            return m_storage.data();
+        }
+
+        template <class T>
+        inline auto xpacked_base<T>::index(size_type i, size_type j) const noexcept -> size_type
+        {
+            return m_uplo == 'U' ? i + j * (j + 1) / 2 : i + j * (2 * m_order - j - 1) / 2;
+        }
+    }
+
+    /************************************
+     * xpacked_symmetric implementation *
+     ************************************/
+
+    /**
+     * Builds a packed symmetric matrix of order \em n with every stored
+     * element set to \em value.
+     */
+    template <class T>
+    inline xpacked_symmetric<T>::xpacked_symmetric(size_type n, char uplo, const value_type& value)
+        : base_type(n, uplo, value)
+    {
+    }
+
+    /**
+     * Packs the \em uplo triangle of the square matrix \em e. The other
+     * triangle is not read.
+     */
+    template <class T>
+    template <class E>
+    inline xpacked_symmetric<T>::xpacked_symmetric(const xexpression<E>& e, char uplo)
+        : base_type(e.derived_cast().shape()[0], uplo, value_type(0))
+    {
+        const auto& de = e.derived_cast();
+        XTENSOR_ASSERT(de.dimension() == 2 && de.shape()[0] == de.shape()[1]);
+        this->pack(de);
+    }
+
+    /**
+     * Returns element (i, j) of the full matrix.
+     */
+    template <class T>
+    inline auto xpacked_symmetric<T>::operator()(size_type i, size_type j) const -> value_type
+    {
+        return this->in_triangle(i, j) ? this->stored(i, j) : linalg::detail::conj_value(this->stored(j, i));
+    }
+
+    /**
+     * Returns the full matrix as a column major xtensor.
+     */
+    template <class T>
+    inline auto xpacked_symmetric<T>::dense() const -> xtensor<value_type, 2, layout_type::column_major>
+    {
+        xtensor<value_type, 2, layout_type::column_major> result(this->shape());
+        for (size_type j = 0; j < this->order(); ++j)
+        {
+            for (size_type i = 0; i < this->order(); ++i)
+            {
+                result(i, j) = (*this)(i, j);
+            }
+        }
+        return result;
+    }
+
+    /*************************************
+     * xpacked_triangular implementation *
+     *************************************/
+
+    /**
+     * Builds a packed triangular matrix of order \em n with every stored
+     * element set to \em value.
+     */
+    template <class T>
+    inline xpacked_triangular<T>::xpacked_triangular(size_type n, char uplo, char diag, const value_type& value)
+        : base_type(n, uplo, value), m_diag(diag)
+    {
+    }
+
+    /**
+     * Packs the \em uplo triangle of the square matrix \em e.
+     */
+    template <class T>
+    template <class E>
+    inline xpacked_triangular<T>::xpacked_triangular(const xexpression<E>& e, char uplo, char diag)
+        : base_type(e.derived_cast().shape()[0], uplo, value_type(0)), m_diag(diag)
+    {
+        const auto& de = e.derived_cast();
+        XTENSOR_ASSERT(de.dimension() == 2 && de.shape()[0] == de.shape()[1]);
+        this->pack(de);
+    }
+
+    template <class T>
+    inline char xpacked_triangular<T>::diag() const noexcept
+    {
+        return m_diag;
+    }
+
+    /**
+     * Returns element (i, j) of the full matrix: zero outside the stored
+     * triangle, one on the diagonal of a unit triangular matrix.
+     */
+    template <class T>
+    inline auto xpacked_triangular<T>::operator()(size_type i, size_type j) const -> value_type
+    {
+        if (i == j && m_diag == 'U')
+        {
+            return value_type(1);
+        }
+        return this->in_triangle(i, j) ? this->stored(i, j) : value_type(0);
+    }
+
+    /**
+     * Returns the full matrix as a column major xtensor.
+     */
+    template <class T>
+    inline auto xpacked_triangular<T>::dense() const -> xtensor<value_type, 2, layout_type::column_major>
+    {
+        xtensor<value_type, 2, layout_type::column_major> result(this->shape());
+        for (size_type j = 0; j < this->order(); ++j)
+        {
+            for (size_type i = 0; i < this->order(); ++i)
+            {
+                result(i, j) = (*this)(i, j);
+            }
+        }
+        return result;
+    }
+
+namespace linalg
+{
+    namespace detail
+    {
+        template <class AP, class P, class B>
+        inline int packed_symmetric_solve(AP& ap, P& piv, B& b, char uplo, std::false_type /*is_complex*/)
+        {
+            return lapack::spsv(ap, piv, b, uplo);
+        }
+
+        template <class AP, class P, class B>
+        inline int packed_symmetric_solve(AP& ap, P& piv, B& b, char uplo, std::true_type /*is_complex*/)
+        {
+            return lapack::hpsv(ap, piv, b, uplo);
+        }
+
+        template <class T>
+        inline void packed_symmetric_mv(const xpacked_symmetric<T>& A, const T* x, T* y, std::false_type /*is_complex*/)
+        {
+            cxxblas::spmv<blas_index_t>(cxxblas::StorageOrder::ColMajor, xt::detail::blas_uplo(A.uplo()),
+                                        to_blas_index(A.order()), T(1), A.data(),
+                                        x, blas_index_t(1), T(0), y, blas_index_t(1));
+        }
+
+        template <class T>
+        inline void packed_symmetric_mv(const xpacked_symmetric<T>& A, const T* x, T* y, std::true_type /*is_complex*/)
+        {
+            cxxblas::hpmv<blas_index_t>(cxxblas::StorageOrder::ColMajor, xt::detail::blas_uplo(A.uplo()),
+                                        to_blas_index(A.order()), T(1), A.data(),
+                                        x, blas_index_t(1), T(0), y, blas_index_t(1));
+        }
+
+        template <class AP, class W, class Z>
+        inline int packed_evd(AP& ap, char jobz, char uplo, W& w, Z& z, std::false_type /*is_complex*/)
+        {
+            return lapack::spevd(ap, jobz, uplo, w, z);
+        }
+
+        template <class AP, class W, class Z>
+        inline int packed_evd(AP& ap, char jobz, char uplo, W& w, Z& z, std::true_type /*is_complex*/)
+        {
+            return lapack::hpevd(ap, jobz, uplo, w, z);
+        }
+
+        template <class AP, class W, class Z, class R>
+        inline int packed_evx(AP& ap, char jobz, char range, char uplo, R vl, R vu, blas_index_t il,
+                              blas_index_t iu, blas_index_t& m, W& w, Z& z, std::false_type /*is_complex*/)
+        {
+            return lapack::spevx(ap, jobz, range, uplo, vl, vu, il, iu, m, w, z);
+        }
+
+        template <class AP, class W, class Z, class R>
+        inline int packed_evx(AP& ap, char jobz, char range, char uplo, R vl, R vu, blas_index_t il,
+                              blas_index_t iu, blas_index_t& m, W& w, Z& z, std::true_type /*is_complex*/)
+        {
+            return lapack::hpevx(ap, jobz, range, uplo, vl, vu, il, iu, m, w, z);
+        }
+
+        /**
+         * Runs spevx / hpevx on a copy of the storage of \em A, as
+         * eigh_subset_inplace does syevr / heevr on a dense matrix.
+         */
+        template <class T>
+        inline auto packed_eigh_subset(const xpacked_symmetric<T>& A, char jobz, char range, double vl, double vu,
+                                       std::size_t first, std::size_t last)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+
+            std::size_t N = A.order();
+            check_eigen_selection(range, vl, vu, first, last, N);
+            auto out = eigen_subset_outputs<T>(N, jobz, range, first, last);
+            auto& w = std::get<0>(out);
+            auto& z = std::get<1>(out);
+
+            auto ap = A.storage();
+            blas_index_t m = 0;
+            int info = packed_evx(ap, jobz, range, A.uplo(),
+                                  static_cast<real_type>(vl), static_cast<real_type>(vu),
+                                  to_blas_index(first + 1), to_blas_index(last + 1),
+                                  m, w, z, xtl::is_complex<T>());
+            if (info != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+            }
+            return leading_eigenpairs(w, z, m, N, jobz);
+        }
+
+        /**
+         * Number of right hand sides of \em b, one column per right hand side.
+         */
+        template <class E>
+        inline std::size_t packed_rhs_count(const E& b, std::size_t n)
+        {
+            if (b.dimension() > 2 || b.shape()[0] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, "Packed storage: right hand side has the wrong shape.");
+            }
+            return b.dimension() == 2 ? b.shape()[1] : 1;
+        }
+    }
+
+    /**
+     * Computes the Cholesky factorization of the packed positive definite
+     * matrix \em A, A = L L^H with the lower triangle stored, A = U^H U with
+     * the upper one.
+     * @return the factor, packed in the triangle of \em A
+     */
+    template <class T>
+    auto cholesky(const xpacked_symmetric<T>& A)
+    {
+        xpacked_triangular<T> L(A.order(), A.uplo());
+        L.storage() = A.storage();
+
+        int info = lapack::pptrf(L.storage(), A.uplo());
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
+        }
+        return L;
+    }
+
+    /**
+     * Solves A x = b for the packed symmetric (Hermitian) matrix \em A, which
+     * need not be definite.
+     * @param A packed matrix
+     * @param b right hand side, a vector or one column per right hand side
+     * @return solution x, with the shape of \em b
+     */
+    template <class T, class E>
+    auto solve(const xpacked_symmetric<T>& A, const xexpression<E>& b)
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        detail::packed_rhs_count(x, A.order());
+
+        auto ap = A.storage();
+        uvector<blas_index_t> piv(std::max(A.order(), std::size_t(1)));
+        int info = detail::packed_symmetric_solve(ap, piv, x, A.uplo(), xtl::is_complex<T>());
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+        }
+        return x;
+    }
+
+    /**
+     * Solves A x = b for the packed triangular matrix \em A.
+     * @return solution x, with the shape of \em b
+     */
+    template <class T, class E>
+    auto solve(const xpacked_triangular<T>& A, const xexpression<E>& b)
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        detail::packed_rhs_count(x, A.order());
+
+        int info = lapack::tptrs(A.storage(), x, A.uplo(), 'N', A.diag());
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+        }
+        return x;
+    }
+
+    /**
+     * Solves A x = b with the packed Cholesky factor of A returned by
+     * cholesky.
+     * @return solution x, with the shape of \em b
+     */
+    template <class T, class E>
+    auto solve_cholesky(const xpacked_triangular<T>& L, const xexpression<E>& b)
+    {
+        auto x = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        detail::packed_rhs_count(x, L.order());
+
+        int info = lapack::pptrs(L.storage(), x, L.uplo());
+        if (info > 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
+        }
+        return x;
+    }
+
+    /**
+     * Matrix product of the packed symmetric (Hermitian) matrix \em A with
+     * the vector or matrix \em x, computed by spmv (hpmv) column by column.
+     * @return the product, with the shape of \em x
+     */
+    template <class T, class E>
+    auto dot(const xpacked_symmetric<T>& A, const xexpression<E>& x)
+    {
+        auto p = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        std::size_t k = detail::packed_rhs_count(p, A.order());
+
+        auto result = decltype(p)::from_shape(p.shape());
+        std::size_t n = A.order();
+        for (std::size_t j = 0; j < k; ++j)
+        {
+            detail::packed_symmetric_mv(A, p.data() + j * n, result.data() + j * n, xtl::is_complex<T>());
+        }
+        return result;
+    }
+
+    /**
+     * Matrix product of the packed triangular matrix \em A with the vector or
+     * matrix \em x, computed by tpmv column by column.
+     * @return the product, with the shape of \em x
+     */
+    template <class T, class E>
+    auto dot(const xpacked_triangular<T>& A, const xexpression<E>& x)
+    {
+        auto result = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        std::size_t k = detail::packed_rhs_count(result, A.order());
+
+        std::size_t n = A.order();
+        for (std::size_t j = 0; j < k; ++j)
+        {
+            cxxblas::tpmv<blas_index_t>(cxxblas::StorageOrder::ColMajor, xt::detail::blas_uplo(A.uplo()), cxxblas::Transpose::NoTrans,
+                                        xt::detail::blas_diag(A.diag()), to_blas_index(n),
+                                        A.data(), result.data() + j * n, blas_index_t(1));
+        }
+        return result;
+    }
+
+    /**
+     * Computes the eigenvalues and eigenvectors of the packed symmetric
+     * (Hermitian) matrix \em A with spevd (hpevd).
+     * @return tuple of the eigenvalues, in ascending order, and the
+     *         eigenvectors in columns
+     */
+    template <class T>
+    auto eigh(const xpacked_symmetric<T>& A)
+    {
+        using real_type = xtl::complex_value_type_t<T>;
+
+        std::size_t n = A.order();
+        auto ap = A.storage();
+        xtensor<real_type, 1, layout_type::column_major> w(std::array<std::size_t, 1>{n});
+        xtensor<T, 2, layout_type::column_major> Z(std::array<std::size_t, 2>{n, n});
+
+        int info = detail::packed_evd(ap, 'V', A.uplo(), w, Z, xtl::is_complex<T>());
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+        return std::make_tuple(std::move(w), std::move(Z));
+    }
+
+    /**
+     * Computes the eigenvalues of the packed symmetric (Hermitian) matrix
+     * \em A with spevd (hpevd).
+     * @return eigenvalues in ascending order
+     */
+    template <class T>
+    auto eigvalsh(const xpacked_symmetric<T>& A)
+    {
+        using real_type = xtl::complex_value_type_t<T>;
+
+        auto ap = A.storage();
+        xtensor<real_type, 1, layout_type::column_major> w(std::array<std::size_t, 1>{A.order()});
+        xtensor<T, 2, layout_type::column_major> Z(std::array<std::size_t, 2>{1, 1});
+
+        int info = detail::packed_evd(ap, 'N', A.uplo(), w, Z, xtl::is_complex<T>());
+        if (info != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Eigenvalue computation did not converge.");
+        }
+        return w;
+    }
+
+    /**
+     * Computes selected eigenvalues and their eigenvectors of the packed
+     * symmetric (Hermitian) matrix \em A with spevx (hpevx). Only the
+     * selected eigenvectors are stored.
+     * @param select ascending indices of the eigenvalues to compute
+     * @return tuple of the eigenvalues, in ascending order, and the
+     *         eigenvectors in columns
+     */
+    template <class T>
+    auto eigh(const xpacked_symmetric<T>& A, select_index select)
+    {
+        return detail::packed_eigh_subset(A, 'V', 'I', 0., 0., select.first, select.last);
+    }
+
+    /**
+     * Computes the eigenvalues in (select.lower, select.upper] and their
+     * eigenvectors of the packed symmetric (Hermitian) matrix \em A with
+     * spevx (hpevx).
+     * @return tuple of the eigenvalues, in ascending order, and the
+     *         eigenvectors in columns
+     */
+    template <class T>
+    auto eigh(const xpacked_symmetric<T>& A, select_range select)
+    {
+        return detail::packed_eigh_subset(A, 'V', 'V', select.lower, select.upper, 0, 0);
+    }
+
+    /**
+     * Computes selected eigenvalues of the packed symmetric (Hermitian)
+     * matrix \em A with spevx (hpevx).
+     * @param select ascending indices of the eigenvalues to compute
+     * @return eigenvalues in ascending order
+     */
+    template <class T>
+    auto eigvalsh(const xpacked_symmetric<T>& A, select_index select)
+    {
+        return std::get<0>(detail::packed_eigh_subset(A, 'N', 'I', 0., 0., select.first, select.last));
+    }
+
+    /**
+     * Computes the eigenvalues in (select.lower, select.upper] of the packed
+     * symmetric (Hermitian) matrix \em A with spevx (hpevx).
+     * @return eigenvalues in ascending order
+     */
+    template <class T>
+    auto eigvalsh(const xpacked_symmetric<T>& A, select_range select)
+    {
+        return std::get<0>(detail::packed_eigh_subset(A, 'N', 'V', select.lower, select.upper, 0, 0));
+    }
+}
+}
+
+#endif
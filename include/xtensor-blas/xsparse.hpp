@@ -0,0 +1,1513 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XSPARSE_HPP
+#define XSPARSE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xstorage.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+#include "xflens/cxxblas/sparselevel2/sparselevel2.h"
+#include "xflens/cxxblas/sparselevel3/sparselevel3.h"
+#include "xflens/cxxblas/sparselevel2/sparselevel2.tcc"
+#include "xflens/cxxblas/sparselevel3/sparselevel3.tcc"
+
+namespace xt
+{
+    namespace detail
+    {
+        /**********************
+         * xsparse_compressed *
+         **********************/
+
+        /**
+         * Compressed sparse storage shared by xsparse_csr and xsparse_ccs.
+         *
+         * The nonzeros of outer slice k (row k for CSR, column k for CCS) are
+         * values()[offsets()[k]] to values()[offsets()[k + 1] - 1], and their
+         * inner indices (columns for CSR, rows for CCS) are the corresponding
+         * entries of indices(). Offsets and indices are zero based.
+         */
+        template <class T>
+        class xsparse_compressed
+        {
+        public:
+
+            using value_type = T;
+            using index_type = blas_index_t;
+            using size_type = std::size_t;
+            using shape_type = std::array<size_type, 2>;
+            using value_storage = uvector<value_type>;
+            using index_storage = uvector<index_type>;
+
+            shape_type shape() const noexcept;
+            size_type dimension() const noexcept;
+            size_type nnz() const noexcept;
+
+            value_storage& values() noexcept;
+            const value_storage& values() const noexcept;
+            const index_storage& offsets() const noexcept;
+            const index_storage& indices() const noexcept;
+
+        protected:
+
+            xsparse_compressed();
+            xsparse_compressed(const shape_type& shape, bool by_rows, value_storage values,
+                               index_storage offsets, index_storage indices);
+
+            template <class E>
+            void compress(const E& e);
+
+            template <class O, class I, class V>
+            void assemble(const O& outer, const I& inner, const V& values);
+
+            value_type find(size_type outer, size_type inner) const;
+            size_type outer_size() const noexcept;
+            size_type inner_size() const noexcept;
+
+        private:
+
+            value_storage m_values;
+            index_storage m_offsets;
+            index_storage m_indices;
+            shape_type m_shape;
+            bool m_by_rows;
+        };
+    }
+
+    template <class T>
+    class xsparse_ccs;
+
+    namespace linalg
+    {
+        template <class T>
+        class sparse_triangular_solver;
+    }
+
+    /***************
+     * xsparse_csr *
+     ***************/
+
+    /**
+     * Sparse matrix in compressed sparse row format.
+     *
+     * It is not an xexpression: linalg::dot, dot_symmetric and
+     * solve_triangular have overloads taking it, and dense() expands it when
+     * an xtensor is needed.
+     */
+    template <class T>
+    class xsparse_csr : public detail::xsparse_compressed<T>
+    {
+    public:
+
+        using base_type = detail::xsparse_compressed<T>;
+        using value_type = typename base_type::value_type;
+        using size_type = typename base_type::size_type;
+        using value_storage = typename base_type::value_storage;
+        using index_storage = typename base_type::index_storage;
+
+        xsparse_csr() = default;
+        xsparse_csr(size_type m, size_type n, value_storage values,
+                    index_storage row_offsets, index_storage column_indices);
+
+        template <class E>
+        explicit xsparse_csr(const xexpression<E>& e);
+
+        template <class R, class C, class V>
+        static xsparse_csr from_triplets(size_type m, size_type n, const R& rows, const C& columns, const V& values);
+
+        const index_storage& row_offsets() const noexcept;
+        const index_storage& column_indices() const noexcept;
+
+        value_type operator()(size_type i, size_type j) const;
+        xtensor<value_type, 2, layout_type::column_major> dense() const;
+        xsparse_ccs<T> transpose() const;
+
+        linalg::sparse_triangular_solver<T> triangular_solver(char uplo = 'L', bool unit_diagonal = false) const;
+    };
+
+    /***************
+     * xsparse_ccs *
+     ***************/
+
+    /**
+     * Sparse matrix in compressed sparse column format.
+     */
+    template <class T>
+    class xsparse_ccs : public detail::xsparse_compressed<T>
+    {
+    public:
+
+        using base_type = detail::xsparse_compressed<T>;
+        using value_type = typename base_type::value_type;
+        using size_type = typename base_type::size_type;
+        using value_storage = typename base_type::value_storage;
+        using index_storage = typename base_type::index_storage;
+
+        xsparse_ccs() = default;
+        xsparse_ccs(size_type m, size_type n, value_storage values,
+                    index_storage column_offsets, index_storage row_indices);
+
+        template <class E>
+        explicit xsparse_ccs(const xexpression<E>& e);
+
+        template <class R, class C, class V>
+        static xsparse_ccs from_triplets(size_type m, size_type n, const R& rows, const C& columns, const V& values);
+
+        const index_storage& column_offsets() const noexcept;
+        const index_storage& row_indices() const noexcept;
+
+        value_type operator()(size_type i, size_type j) const;
+        xtensor<value_type, 2, layout_type::column_major> dense() const;
+        xsparse_csr<T> transpose() const;
+
+        linalg::sparse_triangular_solver<T> triangular_solver(char uplo = 'L', bool unit_diagonal = false) const;
+    };
+
+    /*************************************
+     * xsparse_compressed implementation *
+     *************************************/
+
+    namespace detail
+    {
+        template <class T>
+        inline xsparse_compressed<T>::xsparse_compressed()
+            : m_offsets(1, index_type(0)), m_shape{0, 0}, m_by_rows(true)
+        {
+        }
+
+        template <class T>
+        inline xsparse_compressed<T>::xsparse_compressed(const shape_type& shape, bool by_rows, value_storage values,
+                                                         index_storage offsets, index_storage indices)
+            : m_values(std::move(values)), m_offsets(std::move(offsets)), m_indices(std::move(indices)),
+              m_shape(shape), m_by_rows(by_rows)
+        {
+            if (m_offsets.size() != outer_size() + 1 || m_offsets[0] != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Sparse matrix: offsets must have one entry per slice plus one, starting at 0.");
+            }
+            for (size_type k = 0; k < outer_size(); ++k)
+            {
+                if (m_offsets[k + 1] < m_offsets[k])
+                {
+                    XTENSOR_THROW(std::runtime_error, "Sparse matrix: offsets must not decrease.");
+                }
+            }
+            if (static_cast<size_type>(m_offsets.back()) != m_values.size() || m_indices.size() != m_values.size())
+            {
+                XTENSOR_THROW(std::runtime_error, "Sparse matrix: values and indices must have one entry per nonzero.");
+            }
+            for (auto idx : m_indices)
+            {
+                if (idx < 0 || static_cast<size_type>(idx) >= inner_size())
+                {
+                    XTENSOR_THROW(std::runtime_error, "Sparse matrix: index out of range.");
+                }
+            }
+        }
+
+        /**
+         * Keeps the nonzeros of the dense matrix \em e.
+         */
+        template <class T>
+        template <class E>
+        inline void xsparse_compressed<T>::compress(const E& e)
+        {
+            std::vector<value_type> values;
+            std::vector<index_type> indices;
+            m_offsets.resize(outer_size() + 1);
+            m_offsets[0] = 0;
+            for (size_type o = 0; o < outer_size(); ++o)
+            {
+                for (size_type i = 0; i < inner_size(); ++i)
+                {
+                    value_type v = m_by_rows ? e(o, i) : e(i, o);
+                    if (v != value_type(0))
+                    {
+                        values.push_back(v);
+                        indices.push_back(static_cast<index_type>(i));
+                    }
+                }
+                m_offsets[o + 1] = static_cast<index_type>(values.size());
+            }
+            m_values = value_storage(values.begin(), values.end());
+            m_indices = index_storage(indices.begin(), indices.end());
+        }
+
+        /**
+         * Builds the storage from (outer, inner, value) triplets in any order.
+         * Inner indices end up sorted within each slice, and duplicated
+         * entries are summed.
+         */
+        template <class T>
+        template <class O, class I, class V>
+        inline void xsparse_compressed<T>::assemble(const O& outer, const I& inner, const V& values)
+        {
+            size_type count = values.size();
+            if (outer.size() != count || inner.size() != count)
+            {
+                XTENSOR_THROW(std::runtime_error, "Sparse matrix: triplet arrays must have the same size.");
+            }
+
+            std::vector<size_type> start(outer_size() + 1, 0);
+            for (size_type k = 0; k < count; ++k)
+            {
+                if (static_cast<size_type>(outer[k]) >= outer_size() || static_cast<size_type>(inner[k]) >= inner_size())
+                {
+                    XTENSOR_THROW(std::runtime_error, "Sparse matrix: index out of range.");
+                }
+                ++start[static_cast<size_type>(outer[k]) + 1];
+            }
+            std::partial_sum(start.begin(), start.end(), start.begin());
+
+            std::vector<std::pair<index_type, value_type>> entries(count);
+            std::vector<size_type> next(start.begin(), start.end() - 1);
+            for (size_type k = 0; k < count; ++k)
+            {
+                entries[next[static_cast<size_type>(outer[k])]++] =
+                    std::make_pair(static_cast<index_type>(inner[k]), value_type(values[k]));
+            }
+
+            std::vector<value_type> merged_values;
+            std::vector<index_type> merged_indices;
+            merged_values.reserve(count);
+            merged_indices.reserve(count);
+            m_offsets.resize(outer_size() + 1);
+            m_offsets[0] = 0;
+            for (size_type o = 0; o < outer_size(); ++o)
+            {
+                auto first = entries.begin() + static_cast<std::ptrdiff_t>(start[o]);
+                auto last = entries.begin() + static_cast<std::ptrdiff_t>(start[o + 1]);
+                std::sort(first, last, [](const auto& a, const auto& b) { return a.first < b.first; });
+                for (auto it = first; it != last; ++it)
+                {
+                    if (it != first && it->first == merged_indices.back())
+                    {
+                        merged_values.back() += it->second;
+                    }
+                    else
+                    {
+                        merged_indices.push_back(it->first);
+                        merged_values.push_back(it->second);
+                    }
+                }
+                m_offsets[o + 1] = static_cast<index_type>(merged_values.size());
+            }
+            m_values = value_storage(merged_values.begin(), merged_values.end());
+            m_indices = index_storage(merged_indices.begin(), merged_indices.end());
+        }
+
+        template <class T>
+        inline auto xsparse_compressed<T>::find(size_type outer, size_type inner) const -> value_type
+        {
+            value_type result(0);
+            for (index_type k = m_offsets[outer]; k < m_offsets[outer + 1]; ++k)
+            {
+                if (static_cast<size_type>(m_indices[static_cast<size_type>(k)]) == inner)
+                {
+                    result += m_values[static_cast<size_type>(k)];
+                }
+            }
+            return result;
+        }
+
+        template <class T>
+        inline auto xsparse_compressed<T>::shape() const noexcept -> shape_type
+        {
+            return m_shape;
+        }
+
+        template <class T>
+        inline auto xsparse_compressed<T>::dimension() const noexcept -> size_type
+        {
+            return 2;
+        }
+
+        /**
+         * Returns the number of stored elements.
+         */
+        template <class T>
+        inline auto xsparse_compressed<T>::nnz() const noexcept -> size_type
+        {
+            return m_values.size();
+        }
+
+        template <class T>
+        inline auto xsparse_compressed<T>::values() noexcept -> value_storage&
+        {
+            return m_values;
+        }
+
+        template <class T>
+        inline auto xsparse_compressed<T>::values() const noexcept -> const value_storage&
+        {
+            return m_values;
+        }
+
+        template <class T>
+        inline auto xsparse_compressed<T>::offsets() const noexcept -> const index_storage&
+        {
+            return m_offsets;
+        }
+
+        template <class T>
+        inline auto xsparse_compressed<T>::indices() const noexcept -> const index_storage&
+        {
+            return m_indices;
+        }
+
+        template <class T>
+        inline auto xsparse_compressed<T>::outer_size() const noexcept -> size_type
+        {
+            return m_by_rows ? m_shape[0] : m_shape[1];
+        }
+
+        template <class T>
+        inline auto xsparse_compressed<T>::inner_size() const noexcept -> size_type
+        {
+            return m_by_rows ? m_shape[1] : m_shape[0];
+        }
+    }
+
+    /******************************
+     * xsparse_csr implementation *
+     ******************************/
+
+    /**
+     * Builds an m by n matrix from its CSR arrays, which are checked for
+     * consistency.
+     */
+    template <class T>
+    inline xsparse_csr<T>::xsparse_csr(size_type m, size_type n, value_storage values,
+                                       index_storage row_offsets, index_storage column_indices)
+        : base_type({m, n}, true, std::move(values), std::move(row_offsets), std::move(column_indices))
+    {
+    }
+
+    /**
+     * Keeps the nonzeros of the dense matrix \em e.
+     */
+    template <class T>
+    template <class E>
+    inline xsparse_csr<T>::xsparse_csr(const xexpression<E>& e)
+        : base_type({e.derived_cast().shape()[0], e.derived_cast().shape()[1]}, true,
+                    value_storage(), index_storage(e.derived_cast().shape()[0] + 1, 0), index_storage())
+    {
+        XTENSOR_ASSERT(e.derived_cast().dimension() == 2);
+        this->compress(e.derived_cast());
+    }
+
+    /**
+     * Builds an m by n matrix from (row, column, value) triplets in any
+     * order. Duplicated entries are summed.
+     */
+    template <class T>
+    template <class R, class C, class V>
+    inline auto xsparse_csr<T>::from_triplets(size_type m, size_type n, const R& rows, const C& columns,
+                                              const V& values) -> xsparse_csr
+    {
+        xsparse_csr result(m, n, value_storage(), index_storage(m + 1, 0), index_storage());
+        result.assemble(rows, columns, values);
+        return result;
+    }
+
+    template <class T>
+    inline auto xsparse_csr<T>::row_offsets() const noexcept -> const index_storage&
+    {
+        return this->offsets();
+    }
+
+    template <class T>
+    inline auto xsparse_csr<T>::column_indices() const noexcept -> const index_storage&
+    {
+        return this->indices();
+    }
+
+    /**
+     * Returns element (i, j), zero when it is not stored.
+     */
+    template <class T>
+    inline auto xsparse_csr<T>::operator()(size_type i, size_type j) const -> value_type
+    {
+        return this->find(i, j);
+    }
+
+    /**
+     * Returns the full matrix as a column major xtensor.
+     */
+    template <class T>
+    inline auto xsparse_csr<T>::dense() const -> xtensor<value_type, 2, layout_type::column_major>
+    {
+        xtensor<value_type, 2, layout_type::column_major> result(this->shape(), value_type(0));
+        for (size_type i = 0; i < this->shape()[0]; ++i)
+        {
+            for (auto k = this->offsets()[i]; k < this->offsets()[i + 1]; ++k)
+            {
+                result(i, static_cast<size_type>(this->indices()[static_cast<size_type>(k)])) += this->values()[static_cast<size_type>(k)];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns the transpose, which shares the arrays of this matrix read as
+     * compressed columns.
+     */
+    template <class T>
+    inline auto xsparse_csr<T>::transpose() const -> xsparse_ccs<T>
+    {
+        return xsparse_ccs<T>(this->shape()[1], this->shape()[0], this->values(), this->offsets(), this->indices());
+    }
+
+    /******************************
+     * xsparse_ccs implementation *
+     ******************************/
+
+    /**
+     * Builds an m by n matrix from its CCS arrays, which are checked for
+     * consistency.
+     */
+    template <class T>
+    inline xsparse_ccs<T>::xsparse_ccs(size_type m, size_type n, value_storage values,
+                                       index_storage column_offsets, index_storage row_indices)
+        : base_type({m, n}, false, std::move(values), std::move(column_offsets), std::move(row_indices))
+    {
+    }
+
+    /**
+     * Keeps the nonzeros of the dense matrix \em e.
+     */
+    template <class T>
+    template <class E>
+    inline xsparse_ccs<T>::xsparse_ccs(const xexpression<E>& e)
+        : base_type({e.derived_cast().shape()[0], e.derived_cast().shape()[1]}, false,
+                    value_storage(), index_storage(e.derived_cast().shape()[1] + 1, 0), index_storage())
+    {
+        XTENSOR_ASSERT(e.derived_cast().dimension() == 2);
+        this->compress(e.derived_cast());
+    }
+
+    /**
+     * Builds an m by n matrix from (row, column, value) triplets in any
+     * order. Duplicated entries are summed.
+     */
+    template <class T>
+    template <class R, class C, class V>
+    inline auto xsparse_ccs<T>::from_triplets(size_type m, size_type n, const R& rows, const C& columns,
+                                              const V& values) -> xsparse_ccs
+    {
+        xsparse_ccs result(m, n, value_storage(), index_storage(n + 1, 0), index_storage());
+        result.assemble(columns, rows, values);
+        return result;
+    }
+
+    template <class T>
+    inline auto xsparse_ccs<T>::column_offsets() const noexcept -> const index_storage&
+    {
+        return this->offsets();
+    }
+
+    template <class T>
+    inline auto xsparse_ccs<T>::row_indices() const noexcept -> const index_storage&
+    {
+        return this->indices();
+    }
+
+    /**
+     * Returns element (i, j), zero when it is not stored.
+     */
+    template <class T>
+    inline auto xsparse_ccs<T>::operator()(size_type i, size_type j) const -> value_type
+    {
+        return this->find(j, i);
+    }
+
+    /**
+     * Returns the full matrix as a column major xtensor.
+     */
+    template <class T>
+    inline auto xsparse_ccs<T>::dense() const -> xtensor<value_type, 2, layout_type::column_major>
+    {
+        xtensor<value_type, 2, layout_type::column_major> result(this->shape(), value_type(0));
+        for (size_type j = 0; j < this->shape()[1]; ++j)
+        {
+            for (auto k = this->offsets()[j]; k < this->offsets()[j + 1]; ++k)
+            {
+                result(static_cast<size_type>(this->indices()[static_cast<size_type>(k)]), j) += this->values()[static_cast<size_type>(k)];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns the transpose, which shares the arrays of this matrix read as
+     * compressed rows.
+     */
+    template <class T>
+    inline auto xsparse_ccs<T>::transpose() const -> xsparse_csr<T>
+    {
+        return xsparse_csr<T>(this->shape()[1], this->shape()[0], this->values(), this->offsets(), this->indices());
+    }
+
+namespace linalg
+{
+    namespace detail
+    {
+        /// Number of nonzeros per chunk of rows in the parallel CSR product.
+        constexpr std::size_t sparse_chunk_nnz = 16384;
+
+        /**
+         * y = A x for rows [first, last) of a CSR matrix.
+         */
+        template <class T>
+        inline void csr_mv_rows(const xsparse_csr<T>& A, const T* x, T* y, std::size_t first, std::size_t last)
+        {
+            const auto* ia = A.row_offsets().data();
+            const auto* ja = A.column_indices().data();
+            const T* a = A.values().data();
+            for (std::size_t i = first; i < last; ++i)
+            {
+                T sum(0);
+                for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                {
+                    sum += a[k] * x[ja[k]];
+                }
+                y[i] = sum;
+            }
+        }
+
+        /**
+         * Boundaries of chunks of consecutive slices holding about
+         * sparse_chunk_nnz stored elements each, given the \em count + 1
+         * offsets of the slices.
+         */
+        inline std::vector<std::size_t> partition_offsets(const blas_index_t* offsets, std::size_t count)
+        {
+            std::size_t total = static_cast<std::size_t>(offsets[count]);
+            std::size_t chunks = std::max((total + sparse_chunk_nnz - 1) / sparse_chunk_nnz, std::size_t(1));
+
+            std::vector<std::size_t> bounds(chunks + 1, count);
+            bounds[0] = 0;
+            for (std::size_t c = 1; c < chunks; ++c)
+            {
+                auto target = to_blas_index(c * total / chunks);
+                bounds[c] = static_cast<std::size_t>(std::upper_bound(offsets, offsets + count, target) - offsets);
+                bounds[c] = std::max(bounds[c], bounds[c - 1]);
+            }
+            return bounds;
+        }
+
+        /**
+         * y = A x, row partitioned in chunks of about sparse_chunk_nnz
+         * nonzeros which run in parallel when XTENSOR_USE_OPENMP is defined.
+         */
+        template <class T>
+        inline void csr_mv_partitioned(const xsparse_csr<T>& A, const T* x, T* y)
+        {
+            std::vector<std::size_t> bounds = partition_offsets(A.row_offsets().data(), A.shape()[0]);
+            std::size_t chunks = bounds.size() - 1;
+
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for schedule(dynamic)
+#endif
+            for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t>(chunks); ++c)
+            {
+                csr_mv_rows(A, x, y, bounds[static_cast<std::size_t>(c)], bounds[static_cast<std::size_t>(c) + 1]);
+            }
+        }
+
+        /**
+         * y = A x for a CSR matrix. Goes to the sparse BLAS when available,
+         * to the partitioned kernel for large matrices in OpenMP builds, and
+         * to the cxxblas kernel otherwise.
+         */
+        template <class T>
+        inline void csr_mv(const xsparse_csr<T>& A, const T* x, T* y)
+        {
+#if defined(XTENSOR_USE_OPENMP) && !defined(HAVE_SPARSEBLAS)
+            if (A.nnz() > sparse_chunk_nnz)
+            {
+                csr_mv_partitioned(A, x, y);
+                return;
+            }
+#endif
+            cxxblas::gecrsmv<blas_index_t>(
+                cxxblas::Transpose::NoTrans,
+                to_blas_index(A.shape()[0]),
+                to_blas_index(A.shape()[1]),
+                T(1),
+                A.values().data(),
+                A.row_offsets().data(),
+                A.column_indices().data(),
+                x,
+                T(0),
+                y
+            );
+        }
+
+        /**
+         * y = A x for a CCS matrix, read as the CSR storage of its transpose.
+         */
+        template <class T>
+        inline void ccs_mv(const xsparse_ccs<T>& A, const T* x, T* y)
+        {
+            cxxblas::gecrsmv<blas_index_t>(
+                cxxblas::Transpose::Trans,
+                to_blas_index(A.shape()[1]),
+                to_blas_index(A.shape()[0]),
+                T(1),
+                A.values().data(),
+                A.column_offsets().data(),
+                A.row_indices().data(),
+                x,
+                T(0),
+                y
+            );
+        }
+
+        template <class T>
+        inline void csr_symmetric_mv(const xsparse_csr<T>& A, char uplo, const T* x, T* y, std::false_type /*is_complex*/)
+        {
+            cxxblas::sycrsmv<blas_index_t>(xt::detail::blas_uplo(uplo), to_blas_index(A.shape()[0]), T(1),
+                                           A.values().data(), A.row_offsets().data(), A.column_indices().data(),
+                                           x, T(0), y);
+        }
+
+        template <class T>
+        inline void csr_symmetric_mv(const xsparse_csr<T>& A, char uplo, const T* x, T* y, std::true_type /*is_complex*/)
+        {
+            cxxblas::hecrsmv<blas_index_t>(xt::detail::blas_uplo(uplo), to_blas_index(A.shape()[0]), T(1),
+                                           A.values().data(), A.row_offsets().data(), A.column_indices().data(),
+                                           x, T(0), y);
+        }
+
+        // The CCS kernels take the row indices before the column offsets.
+        template <class T>
+        inline void ccs_symmetric_mv(const xsparse_ccs<T>& A, char uplo, const T* x, T* y, std::false_type /*is_complex*/)
+        {
+            cxxblas::syccsmv<blas_index_t>(xt::detail::blas_uplo(uplo), to_blas_index(A.shape()[0]), T(1),
+                                           A.values().data(), A.row_indices().data(), A.column_offsets().data(),
+                                           x, T(0), y);
+        }
+
+        template <class T>
+        inline void ccs_symmetric_mv(const xsparse_ccs<T>& A, char uplo, const T* x, T* y, std::true_type /*is_complex*/)
+        {
+            cxxblas::heccsmv<blas_index_t>(xt::detail::blas_uplo(uplo), to_blas_index(A.shape()[0]), T(1),
+                                           A.values().data(), A.row_indices().data(), A.column_offsets().data(),
+                                           x, T(0), y);
+        }
+
+        /**
+         * Applies \em mv to every column of \em x, which has one row per
+         * column of \em A. The result has \em m rows.
+         */
+        template <class T, class E, class F>
+        inline auto sparse_product(const E& x, std::size_t m, std::size_t n, F&& mv)
+        {
+            static_assert(std::is_same<T, typename E::value_type>::value,
+                          "Sparse products need operands of the same value type.");
+
+            auto p = copy_to_layout<layout_type::column_major>(x);
+            if (p.dimension() > 2 || p.shape()[0] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+            }
+
+            auto shape = p.shape();
+            shape[0] = m;
+            auto result = decltype(p)::from_shape(shape);
+            std::size_t k = p.dimension() == 2 ? p.shape()[1] : 1;
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                mv(p.data() + j * n, result.data() + j * m);
+            }
+            return result;
+        }
+
+        inline void check_sparse_square(std::size_t m, std::size_t n)
+        {
+            if (m != n)
+            {
+                XTENSOR_THROW(std::runtime_error, "Sparse matrix is not square.");
+            }
+        }
+
+        /**
+         * Returns mu = trace(A) / n and the 1-norm of A - mu I for the square
+         * matrix \em A, whose outer slices are columns if \em by_columns.
+         */
+        template <class T>
+        inline std::pair<T, double> sparse_shifted_norm1(const xt::detail::xsparse_compressed<T>& A, bool by_columns)
+        {
+            std::size_t n = A.shape()[0];
+            const auto& offsets = A.offsets();
+            const auto& indices = A.indices();
+            const auto& values = A.values();
+
+            T mu(0);
+            for (std::size_t o = 0; o < n; ++o)
+            {
+                for (auto k = offsets[o]; k < offsets[o + 1]; ++k)
+                {
+                    mu += static_cast<std::size_t>(indices[k]) == o ? values[k] : T(0);
+                }
+            }
+            mu = n == 0 ? T(0) : mu / T(xtl::complex_value_type_t<T>(n));
+
+            // diagonal elements that are not stored contribute |mu|
+            std::vector<double> column_sums(n, static_cast<double>(std::abs(mu)));
+            for (std::size_t o = 0; o < n; ++o)
+            {
+                for (auto k = offsets[o]; k < offsets[o + 1]; ++k)
+                {
+                    std::size_t i = static_cast<std::size_t>(indices[k]);
+                    std::size_t column = by_columns ? o : i;
+                    if (i == o)
+                    {
+                        column_sums[column] += static_cast<double>(std::abs(values[k] - mu) - std::abs(mu));
+                    }
+                    else
+                    {
+                        column_sums[column] += static_cast<double>(std::abs(values[k]));
+                    }
+                }
+            }
+            double norm = 0.;
+            for (double c : column_sums)
+            {
+                norm = std::max(norm, c);
+            }
+            return std::make_pair(mu, norm);
+        }
+    }
+
+    /**
+     * Matrix product of the CSR matrix \em A with the vector or matrix \em x.
+     * Large products are split into row blocks of equal nonzero count, which
+     * run in parallel when XTENSOR_USE_OPENMP is defined.
+     * @return the product, with one row per row of \em A
+     */
+    template <class T, class E>
+    auto dot(const xsparse_csr<T>& A, const xexpression<E>& x)
+    {
+        return detail::sparse_product<T>(x.derived_cast(), A.shape()[0], A.shape()[1],
+                                         [&A](const T* in, T* out) { detail::csr_mv(A, in, out); });
+    }
+
+    /**
+     * Matrix product of the CCS matrix \em A with the vector or matrix \em x.
+     * @return the product, with one row per row of \em A
+     */
+    template <class T, class E>
+    auto dot(const xsparse_ccs<T>& A, const xexpression<E>& x)
+    {
+        return detail::sparse_product<T>(x.derived_cast(), A.shape()[0], A.shape()[1],
+                                         [&A](const T* in, T* out) { detail::ccs_mv(A, in, out); });
+    }
+
+    namespace detail
+    {
+        // after the sparse products, which it calls
+        template <class M, class E>
+        inline auto sparse_expm_multiply(const M& A, const E& b, double t, bool by_columns)
+        {
+            using value_type = typename M::value_type;
+            check_sparse_square(A.shape()[0], A.shape()[1]);
+            if (b.shape()[0] != A.shape()[0])
+            {
+                XTENSOR_THROW(std::runtime_error, "expm_multiply: shape mismatch.");
+            }
+            auto shift = sparse_shifted_norm1(A, by_columns);
+            value_type mu = shift.first;
+            auto product = [&A, mu](const auto& X) {
+                xarray<value_type, layout_type::column_major> AX = dot(A, X);
+                AX -= mu * X;
+                return AX;
+            };
+            return expm_multiply_impl<value_type>(product, shift.second, mu, b, t);
+        }
+    }
+
+    /**
+     * Compute exp(t A) B for the square CSR matrix \em A, see the dense
+     * expm_multiply. Only sparse products A X are computed, \em B is
+     * converted to the value type of \em A.
+     * @return column-major array exp(t A) B of the shape of \em B
+     */
+    template <class T, class E>
+    auto expm_multiply(const xsparse_csr<T>& A, const xexpression<E>& B, double t = 1.)
+    {
+        return detail::sparse_expm_multiply(A, B.derived_cast(), t, false);
+    }
+
+    /**
+     * Compute exp(t A) B for the square CCS matrix \em A, see the dense
+     * expm_multiply.
+     * @return column-major array exp(t A) B of the shape of \em B
+     */
+    template <class T, class E>
+    auto expm_multiply(const xsparse_ccs<T>& A, const xexpression<E>& B, double t = 1.)
+    {
+        return detail::sparse_expm_multiply(A, B.derived_cast(), t, true);
+    }
+
+    /**
+     * Matrix product of the symmetric (Hermitian for complex values) matrix
+     * whose \em uplo triangle, diagonal included, is stored in \em A. Column
+     * indices must be sorted within each row.
+     * @return the product, with the shape of \em x
+     */
+    template <class T, class E>
+    auto dot_symmetric(const xsparse_csr<T>& A, const xexpression<E>& x, char uplo = 'U')
+    {
+        detail::check_sparse_square(A.shape()[0], A.shape()[1]);
+        return detail::sparse_product<T>(x.derived_cast(), A.shape()[0], A.shape()[1], [&A, uplo](const T* in, T* out) {
+            detail::csr_symmetric_mv(A, uplo, in, out, xtl::is_complex<T>());
+        });
+    }
+
+    /**
+     * Matrix product of the symmetric (Hermitian for complex values) matrix
+     * whose \em uplo triangle, diagonal included, is stored in \em A. Row
+     * indices must be sorted within each column.
+     * @return the product, with the shape of \em x
+     */
+    template <class T, class E>
+    auto dot_symmetric(const xsparse_ccs<T>& A, const xexpression<E>& x, char uplo = 'U')
+    {
+        detail::check_sparse_square(A.shape()[0], A.shape()[1]);
+        return detail::sparse_product<T>(x.derived_cast(), A.shape()[0], A.shape()[1], [&A, uplo](const T* in, T* out) {
+            detail::ccs_symmetric_mv(A, uplo, in, out, xtl::is_complex<T>());
+        });
+    }
+
+    /**
+     * Solves A x = b for the triangular CSR matrix \em A by substitution.
+     * Elements outside the \em uplo triangle are ignored. For repeated
+     * solves with the same matrix, see A.triangular_solver().
+     * @param unit_diagonal take the diagonal of A as one instead of reading it
+     * @return solution x, with the shape of \em b
+     */
+    template <class T, class E>
+    auto solve_triangular(const xsparse_csr<T>& A, const xexpression<E>& b, char uplo = 'L', bool unit_diagonal = false)
+    {
+        detail::check_sparse_square(A.shape()[0], A.shape()[1]);
+        std::size_t n = A.shape()[0];
+        const auto& ia = A.row_offsets();
+        const auto& ja = A.column_indices();
+        const auto& a = A.values();
+
+        return detail::sparse_product<T>(b.derived_cast(), n, n, [&](const T* in, T* out) {
+            for (std::size_t r = 0; r < n; ++r)
+            {
+                std::size_t i = uplo == 'L' ? r : n - 1 - r;
+                T sum = in[i];
+                T diag(unit_diagonal ? 1 : 0);
+                for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                {
+                    std::size_t j = static_cast<std::size_t>(ja[static_cast<std::size_t>(k)]);
+                    if (j == i)
+                    {
+                        diag = unit_diagonal ? diag : diag + a[static_cast<std::size_t>(k)];
+                    }
+                    else if (uplo == 'L' ? j < i : j > i)
+                    {
+                        sum -= a[static_cast<std::size_t>(k)] * out[j];
+                    }
+                }
+                if (diag == T(0))
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+                }
+                out[i] = sum / diag;
+            }
+        });
+    }
+
+    /**
+     * Solves A x = b for the triangular CCS matrix \em A by substitution.
+     * Elements outside the \em uplo triangle are ignored.
+     * @param unit_diagonal take the diagonal of A as one instead of reading it
+     * @return solution x, with the shape of \em b
+     */
+    template <class T, class E>
+    auto solve_triangular(const xsparse_ccs<T>& A, const xexpression<E>& b, char uplo = 'L', bool unit_diagonal = false)
+    {
+        detail::check_sparse_square(A.shape()[0], A.shape()[1]);
+        std::size_t n = A.shape()[0];
+        const auto& ia = A.column_offsets();
+        const auto& ja = A.row_indices();
+        const auto& a = A.values();
+
+        return detail::sparse_product<T>(b.derived_cast(), n, n, [&](const T* in, T* out) {
+            std::copy(in, in + n, out);
+            for (std::size_t r = 0; r < n; ++r)
+            {
+                std::size_t j = uplo == 'L' ? r : n - 1 - r;
+                T diag(unit_diagonal ? 1 : 0);
+                if (!unit_diagonal)
+                {
+                    for (auto k = ia[j]; k < ia[j + 1]; ++k)
+                    {
+                        if (static_cast<std::size_t>(ja[static_cast<std::size_t>(k)]) == j)
+                        {
+                            diag += a[static_cast<std::size_t>(k)];
+                        }
+                    }
+                }
+                if (diag == T(0))
+                {
+                    XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+                }
+                out[j] /= diag;
+                for (auto k = ia[j]; k < ia[j + 1]; ++k)
+                {
+                    std::size_t i = static_cast<std::size_t>(ja[static_cast<std::size_t>(k)]);
+                    if (uplo == 'L' ? i > j : i < j)
+                    {
+                        out[i] -= a[static_cast<std::size_t>(k)] * out[j];
+                    }
+                }
+            }
+        });
+    }
+
+    namespace detail
+    {
+        /**
+         * Returns the CSR storage of the transpose (or conjugate transpose)
+         * of the CSR matrix \em A, by a counting sort on the columns, so
+         * that the indices of the result come out sorted.
+         */
+        template <class T>
+        inline xsparse_csr<T> csr_transpose_storage(const xsparse_csr<T>& A, bool conjugate)
+        {
+            using index_storage = typename xsparse_csr<T>::index_storage;
+            using value_storage = typename xsparse_csr<T>::value_storage;
+            std::size_t m = A.shape()[0];
+            std::size_t n = A.shape()[1];
+            const auto& ia = A.row_offsets();
+            const auto& ja = A.column_indices();
+            const auto& a = A.values();
+
+            index_storage offsets(n + 1, 0);
+            for (std::size_t k = 0; k < A.nnz(); ++k)
+            {
+                ++offsets[static_cast<std::size_t>(ja[k]) + 1];
+            }
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            std::vector<blas_index_t> next(offsets.begin(), offsets.end() - 1);
+            index_storage indices(A.nnz());
+            value_storage values(A.nnz());
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                {
+                    auto p = static_cast<std::size_t>(next[static_cast<std::size_t>(ja[static_cast<std::size_t>(k)])]++);
+                    indices[p] = to_blas_index(i);
+                    values[p] = conjugate ? conj_value(a[static_cast<std::size_t>(k)]) : a[static_cast<std::size_t>(k)];
+                }
+            }
+            return xsparse_csr<T>(n, m, std::move(values), std::move(offsets), std::move(indices));
+        }
+
+        /**
+         * C = L R for CSR matrices, row by row (Gustavson). Element (i, j) of
+         * C is kept when j - i has the sign of \em triangle (all elements
+         * when it is 0, j <= i when it is negative, j >= i when positive).
+         *
+         * A symbolic pass counts the nonzeros of every row, then a numeric
+         * pass accumulates each row into a dense accumulator with a marker
+         * array, O(n) per thread, and writes it with sorted columns. Both
+         * passes run over the rows in parallel when XTENSOR_USE_OPENMP is
+         * defined.
+         */
+        template <class T>
+        inline xsparse_csr<T> csr_spgemm(const xsparse_csr<T>& L, const xsparse_csr<T>& R, int triangle)
+        {
+            using index_storage = typename xsparse_csr<T>::index_storage;
+            using value_storage = typename xsparse_csr<T>::value_storage;
+            if (L.shape()[1] != R.shape()[0])
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+            }
+            std::size_t m = L.shape()[0];
+            std::size_t n = R.shape()[1];
+            const auto* il = L.row_offsets().data();
+            const auto* jl = L.column_indices().data();
+            const T* l = L.values().data();
+            const auto* ir = R.row_offsets().data();
+            const auto* jr = R.column_indices().data();
+            const T* r = R.values().data();
+            auto keep = [triangle](std::size_t i, std::size_t j) {
+                return triangle == 0 || (triangle < 0 ? j <= i : j >= i);
+            };
+            constexpr std::size_t unmarked = std::numeric_limits<std::size_t>::max();
+
+            index_storage offsets(m + 1, 0);
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel
+#endif
+            {
+                std::vector<std::size_t> marker(n, unmarked);
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp for schedule(dynamic, 64)
+#endif
+                for (std::ptrdiff_t row = 0; row < static_cast<std::ptrdiff_t>(m); ++row)
+                {
+                    std::size_t i = static_cast<std::size_t>(row);
+                    blas_index_t count = 0;
+                    for (auto p = il[i]; p < il[i + 1]; ++p)
+                    {
+                        auto k = static_cast<std::size_t>(jl[p]);
+                        for (auto q = ir[k]; q < ir[k + 1]; ++q)
+                        {
+                            auto j = static_cast<std::size_t>(jr[q]);
+                            if (marker[j] != i && keep(i, j))
+                            {
+                                marker[j] = i;
+                                ++count;
+                            }
+                        }
+                    }
+                    offsets[i + 1] = count;
+                }
+            }
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            std::size_t nnz = static_cast<std::size_t>(offsets[m]);
+            index_storage indices(nnz);
+            value_storage values(nnz);
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel
+#endif
+            {
+                std::vector<std::size_t> marker(n, unmarked);
+                std::vector<T> accumulator(n);
+#if defined(XTENSOR_USE_OPENMP)
+                #pragma omp for schedule(dynamic, 64)
+#endif
+                for (std::ptrdiff_t row = 0; row < static_cast<std::ptrdiff_t>(m); ++row)
+                {
+                    std::size_t i = static_cast<std::size_t>(row);
+                    auto* columns = indices.data() + offsets[i];
+                    std::size_t count = 0;
+                    for (auto p = il[i]; p < il[i + 1]; ++p)
+                    {
+                        auto k = static_cast<std::size_t>(jl[p]);
+                        for (auto q = ir[k]; q < ir[k + 1]; ++q)
+                        {
+                            auto j = static_cast<std::size_t>(jr[q]);
+                            if (!keep(i, j))
+                            {
+                                continue;
+                            }
+                            if (marker[j] != i)
+                            {
+                                marker[j] = i;
+                                accumulator[j] = T(0);
+                                columns[count++] = to_blas_index(j);
+                            }
+                            accumulator[j] += l[p] * r[q];
+                        }
+                    }
+                    std::sort(columns, columns + count);
+                    for (std::size_t c = 0; c < count; ++c)
+                    {
+                        values[static_cast<std::size_t>(offsets[i]) + c] = accumulator[static_cast<std::size_t>(columns[c])];
+                    }
+                }
+            }
+            return xsparse_csr<T>(m, n, std::move(values), std::move(offsets), std::move(indices));
+        }
+
+        inline int gram_triangle(char uplo, bool full)
+        {
+            if (uplo != 'L' && uplo != 'U')
+            {
+                XTENSOR_THROW(std::runtime_error, "Gram: uplo must be 'L' or 'U'.");
+            }
+            return full ? 0 : (uplo == 'L' ? -1 : 1);
+        }
+    }
+
+    /**
+     * Sparse product of the CSR matrices \em A and \em B. Entries that
+     * cancel numerically are kept as explicit zeros.
+     * @return the product as a CSR matrix with sorted column indices
+     */
+    template <class T>
+    xsparse_csr<T> dot(const xsparse_csr<T>& A, const xsparse_csr<T>& B)
+    {
+        return detail::csr_spgemm(A, B, 0);
+    }
+
+    /**
+     * Sparse product of the CCS matrices \em A and \em B, computed as the
+     * CSR product B^T A^T on the same arrays.
+     * @return the product as a CCS matrix with sorted row indices
+     */
+    template <class T>
+    xsparse_ccs<T> dot(const xsparse_ccs<T>& A, const xsparse_ccs<T>& B)
+    {
+        return detail::csr_spgemm(B.transpose(), A.transpose(), 0).transpose();
+    }
+
+    /**
+     * Sparse Gram matrix A^H A of the CSR matrix \em A, see the dense gram.
+     * Only the \em uplo triangle is computed and stored unless \em full is
+     * true, so the result can go to dot_symmetric as is.
+     * @return the n by n Gram matrix as a CSR matrix with sorted column
+     *         indices, n being the number of columns of \em A
+     */
+    template <class T>
+    xsparse_csr<T> gram(const xsparse_csr<T>& A, char uplo = 'L', bool full = false)
+    {
+        int triangle = detail::gram_triangle(uplo, full);
+        return detail::csr_spgemm(detail::csr_transpose_storage(A, true), A, triangle);
+    }
+
+    /**
+     * Sparse Gram matrix A^H A of the CCS matrix \em A, see the CSR
+     * overload. It is computed as the CSR product A^T conj(A), whose
+     * storage is the CCS storage of A^H A.
+     * @return the n by n Gram matrix as a CCS matrix with sorted row indices
+     */
+    template <class T>
+    xsparse_ccs<T> gram(const xsparse_ccs<T>& A, char uplo = 'L', bool full = false)
+    {
+        // the lower triangle of A^H A is the upper one of its transpose
+        int triangle = -detail::gram_triangle(uplo, full);
+        auto At = A.transpose();
+        return detail::csr_spgemm(At, detail::csr_transpose_storage(At, true), triangle).transpose();
+    }
+
+    /****************************
+     * sparse_triangular_solver *
+     ****************************/
+
+    namespace detail
+    {
+        /// Mean rows per level below which a level-scheduled solve runs on one thread
+        constexpr std::size_t sparse_level_min_rows = 64;
+    }
+
+    /**
+     * Triangular solver for a sparse matrix, scheduled by levels.
+     *
+     * Row i of a lower triangular matrix can be solved once the rows of the
+     * nonzeros left of its diagonal are, so it is put on level 1 + the
+     * highest of their levels; all rows of a level are independent. The
+     * schedule is computed once, when the solver is built, and the rows are
+     * copied in level order, with only their off-diagonal elements of the
+     * triangle and the inverse of their diagonal, so that a solve streams
+     * through the matrix. With XTENSOR_USE_OPENMP, the rows of each level
+     * are shared between the threads of a single parallel region, with a
+     * barrier between levels, unless the levels hold fewer than
+     * sparse_level_min_rows rows on average, as for banded matrices, where
+     * the barriers would cost more than the row updates.
+     *
+     * It is an operator for the Krylov solvers applying the inverse of the
+     * matrix, e.g. as the two halves of an incomplete factorization.
+     *
+     * \code{.cpp}
+     * auto lower = L.triangular_solver('L');
+     * for (...)
+     * {
+     *     y = lower.solve(r);
+     * }
+     * \endcode
+     */
+    template <class T>
+    class sparse_triangular_solver
+    {
+    public:
+
+        using value_type = T;
+        using index_type = blas_index_t;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+
+        sparse_triangular_solver() = default;
+        sparse_triangular_solver(const xsparse_csr<T>& A, char uplo = 'L', bool unit_diagonal = false);
+        sparse_triangular_solver(const xsparse_ccs<T>& A, char uplo = 'L', bool unit_diagonal = false);
+
+        shape_type shape() const noexcept;
+        size_type levels() const noexcept;
+        const std::vector<index_type>& level_offsets() const noexcept;
+        const std::vector<index_type>& rows() const noexcept;
+        bool parallel() const noexcept;
+
+        template <class E>
+        auto solve(const xexpression<E>& b) const;
+
+        void solve(const T* b, T* x) const;
+
+        template <class V>
+        void apply(const V& x, V& y) const;
+
+    private:
+
+        void solve_row(size_type p, const T* b, T* x) const;
+
+        std::vector<index_type> m_level_offsets = std::vector<index_type>(1, 0);
+        std::vector<index_type> m_rows;
+        std::vector<index_type> m_offsets = std::vector<index_type>(1, 0);
+        std::vector<index_type> m_indices;
+        std::vector<T> m_values;
+        std::vector<T> m_inverse_diagonal;
+        size_type m_size = 0;
+        bool m_parallel = false;
+    };
+
+    /**
+     * Computes the level schedule of the \em uplo triangle of \em A.
+     * Elements outside the triangle are ignored.
+     * @param unit_diagonal take the diagonal of A as one instead of reading it
+     */
+    template <class T>
+    inline sparse_triangular_solver<T>::sparse_triangular_solver(const xsparse_csr<T>& A, char uplo, bool unit_diagonal)
+        : m_size(A.shape()[0])
+    {
+        detail::check_sparse_square(A.shape()[0], A.shape()[1]);
+        if (uplo != 'L' && uplo != 'U')
+        {
+            XTENSOR_THROW(std::runtime_error, "Triangular solver: uplo must be 'L' or 'U'.");
+        }
+        size_type n = m_size;
+        bool lower = uplo == 'L';
+        const auto& ia = A.row_offsets();
+        const auto& ja = A.column_indices();
+        const auto& a = A.values();
+        auto in_triangle = [lower](size_type i, size_type j) { return lower ? j < i : j > i; };
+
+        std::vector<size_type> level(n, 0);
+        size_type depth = 0;
+        size_type count = 0;
+        for (size_type r = 0; r < n; ++r)
+        {
+            size_type i = lower ? r : n - 1 - r;
+            size_type l = 0;
+            for (auto k = ia[i]; k < ia[i + 1]; ++k)
+            {
+                size_type j = static_cast<size_type>(ja[static_cast<size_type>(k)]);
+                if (in_triangle(i, j))
+                {
+                    l = std::max(l, level[j] + 1);
+                    ++count;
+                }
+            }
+            level[i] = l;
+            depth = std::max(depth, l + 1);
+        }
+
+        // counting sort of the rows by level, in solve order within a level
+        m_level_offsets.assign(depth + 1, 0);
+        for (size_type i = 0; i < n; ++i)
+        {
+            ++m_level_offsets[level[i] + 1];
+        }
+        std::partial_sum(m_level_offsets.begin(), m_level_offsets.end(), m_level_offsets.begin());
+        std::vector<index_type> next(m_level_offsets.begin(), m_level_offsets.end() - 1);
+        m_rows.resize(n);
+        for (size_type r = 0; r < n; ++r)
+        {
+            size_type i = lower ? r : n - 1 - r;
+            m_rows[static_cast<size_type>(next[level[i]]++)] = static_cast<index_type>(i);
+        }
+
+        m_offsets.assign(n + 1, 0);
+        m_indices.resize(count);
+        m_values.resize(count);
+        m_inverse_diagonal.resize(n);
+        size_type q = 0;
+        for (size_type p = 0; p < n; ++p)
+        {
+            size_type i = static_cast<size_type>(m_rows[p]);
+            T diag(unit_diagonal ? 1 : 0);
+            for (auto k = ia[i]; k < ia[i + 1]; ++k)
+            {
+                size_type j = static_cast<size_type>(ja[static_cast<size_type>(k)]);
+                if (in_triangle(i, j))
+                {
+                    m_indices[q] = static_cast<index_type>(j);
+                    m_values[q] = a[static_cast<size_type>(k)];
+                    ++q;
+                }
+                else if (j == i && !unit_diagonal)
+                {
+                    diag += a[static_cast<size_type>(k)];
+                }
+            }
+            if (diag == T(0))
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+            }
+            m_inverse_diagonal[p] = T(1) / diag;
+            m_offsets[p + 1] = static_cast<index_type>(q);
+        }
+        m_parallel = depth != 0 && n / depth >= detail::sparse_level_min_rows;
+    }
+
+    /**
+     * Computes the level schedule of the \em uplo triangle of the CCS
+     * matrix \em A, from its CSR storage.
+     */
+    template <class T>
+    inline sparse_triangular_solver<T>::sparse_triangular_solver(const xsparse_ccs<T>& A, char uplo, bool unit_diagonal)
+        : sparse_triangular_solver(detail::csr_transpose_storage(A.transpose(), false), uplo, unit_diagonal)
+    {
+    }
+
+    template <class T>
+    inline auto sparse_triangular_solver<T>::shape() const noexcept -> shape_type
+    {
+        return {m_size, m_size};
+    }
+
+    /// Number of levels, the length of the longest chain of dependent rows
+    template <class T>
+    inline auto sparse_triangular_solver<T>::levels() const noexcept -> size_type
+    {
+        return m_level_offsets.size() - 1;
+    }
+
+    /// The rows of level l are rows()[level_offsets()[l]] to rows()[level_offsets()[l + 1] - 1]
+    template <class T>
+    inline auto sparse_triangular_solver<T>::level_offsets() const noexcept -> const std::vector<index_type>&
+    {
+        return m_level_offsets;
+    }
+
+    template <class T>
+    inline auto sparse_triangular_solver<T>::rows() const noexcept -> const std::vector<index_type>&
+    {
+        return m_rows;
+    }
+
+    /// Whether the levels are solved in parallel
+    template <class T>
+    inline bool sparse_triangular_solver<T>::parallel() const noexcept
+    {
+        return m_parallel;
+    }
+
+    /**
+     * Solves A x = b for the vector or matrix \em b.
+     * @return solution x, with the shape of \em b
+     */
+    template <class T>
+    template <class E>
+    inline auto sparse_triangular_solver<T>::solve(const xexpression<E>& b) const
+    {
+        return detail::sparse_product<T>(b.derived_cast(), m_size, m_size, [this](const T* in, T* out) {
+            solve(in, out);
+        });
+    }
+
+    /**
+     * Solves A x = b for the vectors of size() elements at \em b and \em x,
+     * which must not overlap.
+     */
+    template <class T>
+    inline void sparse_triangular_solver<T>::solve(const T* b, T* x) const
+    {
+#if defined(XTENSOR_USE_OPENMP)
+        if (m_parallel)
+        {
+            size_type depth = levels();
+            #pragma omp parallel
+            {
+                for (size_type l = 0; l < depth; ++l)
+                {
+                    std::ptrdiff_t first = static_cast<std::ptrdiff_t>(m_level_offsets[l]);
+                    std::ptrdiff_t last = static_cast<std::ptrdiff_t>(m_level_offsets[l + 1]);
+                    #pragma omp for schedule(static)
+                    for (std::ptrdiff_t p = first; p < last; ++p)
+                    {
+                        solve_row(static_cast<size_type>(p), b, x);
+                    }
+                }
+            }
+            return;
+        }
+#endif
+        // the rows are stored in an order that solves them one after the other
+        for (size_type p = 0; p < m_size; ++p)
+        {
+            solve_row(p, b, x);
+        }
+    }
+
+    /// Solves the row at position \em p of the schedule
+    template <class T>
+    inline void sparse_triangular_solver<T>::solve_row(size_type p, const T* b, T* x) const
+    {
+        size_type i = static_cast<size_type>(m_rows[p]);
+        T sum = b[i];
+        for (auto k = static_cast<size_type>(m_offsets[p]); k < static_cast<size_type>(m_offsets[p + 1]); ++k)
+        {
+            sum -= m_values[k] * x[static_cast<size_type>(m_indices[k])];
+        }
+        x[i] = sum * m_inverse_diagonal[p];
+    }
+
+    /**
+     * y = A^-1 x for contiguous vectors, as the Krylov solvers apply their
+     * operators and preconditioners.
+     */
+    template <class T>
+    template <class V>
+    inline void sparse_triangular_solver<T>::apply(const V& x, V& y) const
+    {
+        solve(x.data(), y.data());
+    }
+}
+
+    /**
+     * Returns the solver of A x = b for the \em uplo triangle of this
+     * matrix, whose level schedule is computed once for all the solves.
+     * @param unit_diagonal take the diagonal as one instead of reading it
+     */
+    template <class T>
+    inline auto xsparse_csr<T>::triangular_solver(char uplo, bool unit_diagonal) const -> linalg::sparse_triangular_solver<T>
+    {
+        return linalg::sparse_triangular_solver<T>(*this, uplo, unit_diagonal);
+    }
+
+    /**
+     * Returns the solver of A x = b for the \em uplo triangle of this
+     * matrix, see xsparse_csr::triangular_solver.
+     */
+    template <class T>
+    inline auto xsparse_ccs<T>::triangular_solver(char uplo, bool unit_diagonal) const -> linalg::sparse_triangular_solver<T>
+    {
+        return linalg::sparse_triangular_solver<T>(*this, uplo, unit_diagonal);
+    }
+}
+
+#endif
@@ -0,0 +1,1083 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XSPARSE_DIRECT_HPP
+#define XSPARSE_DIRECT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cholmod.h>
+#include <umfpack.h>
+
+#include "xtensor/xstorage.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xkrylov.hpp"
+#include "xtensor-blas/xsparse.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+    namespace detail
+    {
+        /**
+         * Copy of the compressed storage of an xsparse_ccs, or of an
+         * xsparse_csr read as the CCS storage of its transpose. The
+         * pattern is kept to recognize a matrix with the same sparsity.
+         */
+        template <class T>
+        struct sparse_direct_operand
+        {
+            using index_storage = uvector<blas_index_t>;
+            using value_storage = uvector<T>;
+
+            template <class S>
+            sparse_direct_operand(const S& A, bool transposed);
+
+            template <class S>
+            bool same_pattern(const S& A, bool A_transposed) const noexcept;
+
+            bool sorted() const noexcept;
+
+            std::size_t rows;
+            std::size_t cols;
+            index_storage offsets;
+            index_storage indices;
+            value_storage values;
+            bool transposed;
+        };
+
+        template <class T>
+        template <class S>
+        inline sparse_direct_operand<T>::sparse_direct_operand(const S& A, bool t)
+            : rows(A.shape()[t ? 1 : 0]), cols(A.shape()[t ? 0 : 1]),
+              offsets(A.offsets()), indices(A.indices()), values(A.values()), transposed(t)
+        {
+        }
+
+        template <class T>
+        template <class S>
+        inline bool sparse_direct_operand<T>::same_pattern(const S& A, bool A_transposed) const noexcept
+        {
+            return A_transposed == transposed && A.shape()[transposed ? 1 : 0] == rows &&
+                   A.offsets().size() == offsets.size() && A.indices().size() == indices.size() &&
+                   std::equal(offsets.cbegin(), offsets.cend(), A.offsets().cbegin()) &&
+                   std::equal(indices.cbegin(), indices.cend(), A.indices().cbegin());
+        }
+
+        template <class T>
+        inline bool sparse_direct_operand<T>::sorted() const noexcept
+        {
+            for (std::size_t k = 0; k + 1 < offsets.size(); ++k)
+            {
+                for (auto p = offsets[k] + 1; p < offsets[k + 1]; ++p)
+                {
+                    if (indices[static_cast<std::size_t>(p)] <= indices[static_cast<std::size_t>(p - 1)])
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        template <class T>
+        inline void check_sparse_direct_types()
+        {
+            static_assert(std::is_same<T, double>::value,
+                          "sparse direct solvers: CHOLMOD and UMFPACK are used for double values.");
+            static_assert(std::is_same<blas_index_t, int>::value,
+                          "sparse direct solvers: the int interface of CHOLMOD and UMFPACK needs a 32 bit blas_index_t.");
+        }
+
+        template <class E>
+        inline auto sparse_direct_rhs(const E& b, std::size_t n)
+        {
+            auto x = copy_to_layout<layout_type::column_major>(b);
+            if (x.dimension() < 1 || x.dimension() > 2 || x.shape()[0] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, "Solve: shape mismatch.");
+            }
+            return x;
+        }
+    }
+
+    /**
+     * Sparse Cholesky factorization P A P^T = L L^T of a symmetric positive
+     * definite matrix by CHOLMOD, as returned by cholesky_factor for
+     * sparse matrices.
+     *
+     * The fill-reducing ordering and the symbolic factorization are
+     * computed once: refactor with a matrix of the same sparsity pattern,
+     * such as the stiffness matrix of the next time step, only repeats the
+     * numerical factorization.
+     *
+     * The CHOLMOD workspace lives in the factorization object, so that
+     * solve cannot run concurrently on one object.
+     */
+    template <class T>
+    class sparse_cholesky_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+
+        template <class S>
+        sparse_cholesky_factorization(const S& A, char uplo, bool transposed);
+
+        sparse_cholesky_factorization(sparse_cholesky_factorization&& rhs) noexcept;
+        sparse_cholesky_factorization& operator=(sparse_cholesky_factorization&& rhs) noexcept;
+
+        ~sparse_cholesky_factorization();
+
+        void refactor(const xsparse_ccs<T>& A);
+        void refactor(const xsparse_csr<T>& A);
+
+        template <class E>
+        auto solve(const xexpression<E>& b) const;
+
+        real_type rcond() const;
+        std::size_t size() const noexcept;
+        std::size_t analyses() const noexcept;
+
+    private:
+
+        template <class S>
+        const char* factorize(const S& A, bool transposed);
+
+        cholmod_sparse view();
+        void release() noexcept;
+
+        std::unique_ptr<detail::sparse_direct_operand<T>> m_a;
+        std::unique_ptr<cholmod_common> m_common;
+        cholmod_factor* m_factor;
+        int m_stype;
+        std::size_t m_analyses;
+        bool m_factored;
+    };
+
+    /**
+     * Sparse LU factorization of a square matrix by UMFPACK, as returned
+     * by lu_factor for sparse matrices.
+     *
+     * As for sparse_cholesky_factorization, the column ordering and the
+     * symbolic analysis are reused by refactor with a matrix of the same
+     * sparsity pattern. solve may run concurrently.
+     */
+    template <class T>
+    class sparse_lu_factorization
+    {
+    public:
+
+        using value_type = T;
+        using real_type = xtl::complex_value_type_t<T>;
+
+        template <class S>
+        sparse_lu_factorization(const S& A, bool transposed);
+
+        sparse_lu_factorization(sparse_lu_factorization&& rhs) noexcept;
+        sparse_lu_factorization& operator=(sparse_lu_factorization&& rhs) noexcept;
+
+        ~sparse_lu_factorization();
+
+        void refactor(const xsparse_ccs<T>& A);
+        void refactor(const xsparse_csr<T>& A);
+
+        template <class E>
+        auto solve(const xexpression<E>& b, char trans = 'N') const;
+
+        std::tuple<value_type, real_type> logdet() const;
+        real_type rcond() const;
+        bool singular() const noexcept;
+        std::size_t size() const noexcept;
+        std::size_t analyses() const noexcept;
+
+    private:
+
+        template <class S>
+        const char* factorize(const S& A, bool transposed);
+
+        void release() noexcept;
+
+        std::unique_ptr<detail::sparse_direct_operand<T>> m_a;
+        void* m_symbolic;
+        void* m_numeric;
+        double m_control[UMFPACK_CONTROL];
+        double m_info[UMFPACK_INFO];
+        bool m_singular;
+        std::size_t m_analyses;
+    };
+
+    /************************************************
+     * sparse_cholesky_factorization implementation *
+     ************************************************/
+
+    /**
+     * Factorize the matrix \em A, of which only the triangle \em uplo is
+     * read; \em transposed for CSR storage, read as the CCS storage of
+     * the transpose.
+     */
+    template <class T>
+    template <class S>
+    inline sparse_cholesky_factorization<T>::sparse_cholesky_factorization(const S& A, char uplo, bool transposed)
+        : m_common(new cholmod_common), m_factor(nullptr), m_analyses(0), m_factored(false)
+    {
+        detail::check_sparse_direct_types<T>();
+        if (A.shape()[0] != A.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "cholesky_factor: the sparse matrix must be square.");
+        }
+        // the triangle uplo of A is the other one of the transpose
+        bool lower = (uplo == 'L' || uplo == 'l') != transposed;
+        m_stype = lower ? -1 : 1;
+        cholmod_start(m_common.get());
+        // the destructor does not run if the constructor throws
+        if (const char* error = factorize(A, transposed))
+        {
+            release();
+            XTENSOR_THROW(std::runtime_error, error);
+        }
+    }
+
+    template <class T>
+    inline sparse_cholesky_factorization<T>::sparse_cholesky_factorization(sparse_cholesky_factorization&& rhs) noexcept
+        : m_a(std::move(rhs.m_a)), m_common(std::move(rhs.m_common)), m_factor(rhs.m_factor),
+          m_stype(rhs.m_stype), m_analyses(rhs.m_analyses), m_factored(rhs.m_factored)
+    {
+        rhs.m_factor = nullptr;
+    }
+
+    template <class T>
+    inline auto sparse_cholesky_factorization<T>::operator=(sparse_cholesky_factorization&& rhs) noexcept
+        -> sparse_cholesky_factorization&
+    {
+        if (this != &rhs)
+        {
+            release();
+            m_a = std::move(rhs.m_a);
+            m_common = std::move(rhs.m_common);
+            m_factor = rhs.m_factor;
+            m_stype = rhs.m_stype;
+            m_analyses = rhs.m_analyses;
+            m_factored = rhs.m_factored;
+            rhs.m_factor = nullptr;
+        }
+        return *this;
+    }
+
+    template <class T>
+    inline sparse_cholesky_factorization<T>::~sparse_cholesky_factorization()
+    {
+        release();
+    }
+
+    template <class T>
+    inline void sparse_cholesky_factorization<T>::release() noexcept
+    {
+        if (m_common)
+        {
+            cholmod_free_factor(&m_factor, m_common.get());
+            cholmod_finish(m_common.get());
+            m_common.reset();
+        }
+    }
+
+    /**
+     * Factorize \em A, with the ordering and symbolic factorization
+     * of the previous matrix if \em A has the same sparsity pattern.
+     * If \em A is not positive definite, this throws, and solve throws
+     * until a successful refactor.
+     */
+    template <class T>
+    inline void sparse_cholesky_factorization<T>::refactor(const xsparse_ccs<T>& A)
+    {
+        if (const char* error = factorize(A, false))
+        {
+            XTENSOR_THROW(std::runtime_error, error);
+        }
+    }
+
+    template <class T>
+    inline void sparse_cholesky_factorization<T>::refactor(const xsparse_csr<T>& A)
+    {
+        if (const char* error = factorize(A, true))
+        {
+            XTENSOR_THROW(std::runtime_error, error);
+        }
+    }
+
+    template <class T>
+    inline cholmod_sparse sparse_cholesky_factorization<T>::view()
+    {
+        cholmod_sparse a;
+        a.nrow = m_a->rows;
+        a.ncol = m_a->cols;
+        a.nzmax = m_a->values.size();
+        a.p = m_a->offsets.data();
+        a.i = m_a->indices.data();
+        a.nz = nullptr;
+        a.x = m_a->values.data();
+        a.z = nullptr;
+        a.stype = m_stype;
+        a.itype = CHOLMOD_INT;
+        a.xtype = CHOLMOD_REAL;
+        a.dtype = CHOLMOD_DOUBLE;
+        a.sorted = m_a->sorted() ? 1 : 0;
+        a.packed = 1;
+        return a;
+    }
+
+    template <class T>
+    template <class S>
+    inline const char* sparse_cholesky_factorization<T>::factorize(const S& A, bool transposed)
+    {
+        bool reuse = m_factor != nullptr && m_a->same_pattern(A, transposed);
+        m_a = std::make_unique<detail::sparse_direct_operand<T>>(A, transposed);
+        m_factored = false;
+        cholmod_sparse view_a = view();
+        if (!reuse)
+        {
+            cholmod_free_factor(&m_factor, m_common.get());
+            m_factor = cholmod_analyze(&view_a, m_common.get());
+            if (m_factor == nullptr)
+            {
+                return "cholesky_factor: CHOLMOD analysis failed.";
+            }
+            ++m_analyses;
+        }
+        cholmod_factorize(&view_a, m_factor, m_common.get());
+        if (m_common->status == CHOLMOD_NOT_POSDEF)
+        {
+            return "cholesky_factor: the sparse matrix is not positive definite.";
+        }
+        if (m_common->status < CHOLMOD_OK)
+        {
+            return "cholesky_factor: CHOLMOD factorization failed.";
+        }
+        m_factored = true;
+        return nullptr;
+    }
+
+    /**
+     * Solve A x = b.
+     * @return solution with the shape of \em b
+     */
+    template <class T>
+    template <class E>
+    inline auto sparse_cholesky_factorization<T>::solve(const xexpression<E>& b) const
+    {
+        if (!m_factored)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        auto x = detail::sparse_direct_rhs(b.derived_cast(), size());
+        std::size_t n = size();
+        std::size_t nrhs = x.dimension() > 1 ? x.shape()[1] : 1;
+        if (n == 0 || nrhs == 0)
+        {
+            return x;
+        }
+
+        cholmod_dense rhs;
+        rhs.nrow = n;
+        rhs.ncol = nrhs;
+        rhs.nzmax = n * nrhs;
+        rhs.d = n;
+        rhs.x = x.data();
+        rhs.z = nullptr;
+        rhs.xtype = CHOLMOD_REAL;
+        rhs.dtype = CHOLMOD_DOUBLE;
+        cholmod_dense* solution = cholmod_solve(CHOLMOD_A, m_factor, &rhs, m_common.get());
+        if (solution == nullptr)
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        const T* s = static_cast<const T*>(solution->x);
+        std::copy(s, s + n * nrhs, x.data());
+        cholmod_free_dense(&solution, m_common.get());
+        return x;
+    }
+
+    /**
+     * @return CHOLMOD's rough estimate of the reciprocal condition number,
+     *         the ratio of the smallest to the largest diagonal entry of L
+     *         squared; 0 for a singular matrix
+     */
+    template <class T>
+    inline auto sparse_cholesky_factorization<T>::rcond() const -> real_type
+    {
+        if (!m_factored)
+        {
+            return real_type(0);
+        }
+        return size() == 0 ? real_type(1) : real_type(cholmod_rcond(m_factor, m_common.get()));
+    }
+
+    template <class T>
+    inline std::size_t sparse_cholesky_factorization<T>::size() const noexcept
+    {
+        return m_a->rows;
+    }
+
+    /**
+     * @return number of symbolic analyses, one more for each refactor
+     *         with a new sparsity pattern
+     */
+    template <class T>
+    inline std::size_t sparse_cholesky_factorization<T>::analyses() const noexcept
+    {
+        return m_analyses;
+    }
+
+    /******************************************
+     * sparse_lu_factorization implementation *
+     ******************************************/
+
+    /**
+     * Factorize the square matrix \em A; \em transposed for CSR storage,
+     * read as the CCS storage of the transpose.
+     */
+    template <class T>
+    template <class S>
+    inline sparse_lu_factorization<T>::sparse_lu_factorization(const S& A, bool transposed)
+        : m_symbolic(nullptr), m_numeric(nullptr), m_singular(false), m_analyses(0)
+    {
+        detail::check_sparse_direct_types<T>();
+        if (A.shape()[0] != A.shape()[1])
+        {
+            XTENSOR_THROW(std::runtime_error, "lu_factor: the sparse matrix must be square.");
+        }
+        umfpack_di_defaults(m_control);
+        // the destructor does not run if the constructor throws
+        if (const char* error = factorize(A, transposed))
+        {
+            release();
+            XTENSOR_THROW(std::runtime_error, error);
+        }
+    }
+
+    template <class T>
+    inline sparse_lu_factorization<T>::sparse_lu_factorization(sparse_lu_factorization&& rhs) noexcept
+        : m_a(std::move(rhs.m_a)), m_symbolic(rhs.m_symbolic), m_numeric(rhs.m_numeric),
+          m_singular(rhs.m_singular), m_analyses(rhs.m_analyses)
+    {
+        std::copy(rhs.m_control, rhs.m_control + UMFPACK_CONTROL, m_control);
+        std::copy(rhs.m_info, rhs.m_info + UMFPACK_INFO, m_info);
+        rhs.m_symbolic = nullptr;
+        rhs.m_numeric = nullptr;
+    }
+
+    template <class T>
+    inline auto sparse_lu_factorization<T>::operator=(sparse_lu_factorization&& rhs) noexcept
+        -> sparse_lu_factorization&
+    {
+        if (this != &rhs)
+        {
+            release();
+            m_a = std::move(rhs.m_a);
+            std::swap(m_symbolic, rhs.m_symbolic);
+            std::swap(m_numeric, rhs.m_numeric);
+            std::copy(rhs.m_control, rhs.m_control + UMFPACK_CONTROL, m_control);
+            std::copy(rhs.m_info, rhs.m_info + UMFPACK_INFO, m_info);
+            m_singular = rhs.m_singular;
+            m_analyses = rhs.m_analyses;
+        }
+        return *this;
+    }
+
+    template <class T>
+    inline sparse_lu_factorization<T>::~sparse_lu_factorization()
+    {
+        release();
+    }
+
+    template <class T>
+    inline void sparse_lu_factorization<T>::release() noexcept
+    {
+        if (m_numeric != nullptr)
+        {
+            umfpack_di_free_numeric(&m_numeric);
+        }
+        if (m_symbolic != nullptr)
+        {
+            umfpack_di_free_symbolic(&m_symbolic);
+        }
+    }
+
+    /**
+     * Factorize \em A, with the ordering and symbolic analysis of the
+     * previous matrix if \em A has the same sparsity pattern.
+     */
+    template <class T>
+    inline void sparse_lu_factorization<T>::refactor(const xsparse_ccs<T>& A)
+    {
+        if (const char* error = factorize(A, false))
+        {
+            XTENSOR_THROW(std::runtime_error, error);
+        }
+    }
+
+    template <class T>
+    inline void sparse_lu_factorization<T>::refactor(const xsparse_csr<T>& A)
+    {
+        if (const char* error = factorize(A, true))
+        {
+            XTENSOR_THROW(std::runtime_error, error);
+        }
+    }
+
+    template <class T>
+    template <class S>
+    inline const char* sparse_lu_factorization<T>::factorize(const S& A, bool transposed)
+    {
+        bool reuse = m_symbolic != nullptr && m_a->same_pattern(A, transposed);
+        m_a = std::make_unique<detail::sparse_direct_operand<T>>(A, transposed);
+        if (m_numeric != nullptr)
+        {
+            umfpack_di_free_numeric(&m_numeric);
+        }
+
+        const int* ap = m_a->offsets.data();
+        const int* ai = m_a->indices.data();
+        const double* ax = m_a->values.data();
+        int n = static_cast<int>(m_a->rows);
+        if (!reuse)
+        {
+            if (m_symbolic != nullptr)
+            {
+                umfpack_di_free_symbolic(&m_symbolic);
+            }
+            int status = umfpack_di_symbolic(n, n, ap, ai, ax, &m_symbolic, m_control, m_info);
+            if (status != UMFPACK_OK)
+            {
+                m_symbolic = nullptr;
+                m_singular = true;
+                return "lu_factor: UMFPACK analysis failed; the column indices must be sorted.";
+            }
+            ++m_analyses;
+        }
+
+        int status = umfpack_di_numeric(ap, ai, ax, m_symbolic, &m_numeric, m_control, m_info);
+        if (status != UMFPACK_OK && status != UMFPACK_WARNING_singular_matrix)
+        {
+            m_numeric = nullptr;
+            m_singular = true;
+            return "lu_factor: UMFPACK factorization failed.";
+        }
+        m_singular = status == UMFPACK_WARNING_singular_matrix;
+        return nullptr;
+    }
+
+    /**
+     * Solve A x = b (A^T x = b for \em trans = 'T' or 'C').
+     * @return solution with the shape of \em b
+     */
+    template <class T>
+    template <class E>
+    inline auto sparse_lu_factorization<T>::solve(const xexpression<E>& b, char trans) const
+    {
+        if (singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+        }
+        if (trans != 'N' && trans != 'T' && trans != 'C')
+        {
+            XTENSOR_THROW(std::runtime_error, "solve: trans must be 'N', 'T' or 'C'.");
+        }
+        auto x = detail::sparse_direct_rhs(b.derived_cast(), size());
+        auto rhs = x;
+        std::size_t n = size();
+        std::size_t nrhs = x.dimension() > 1 ? x.shape()[1] : 1;
+
+        // the stored matrix is A^T for CSR storage
+        bool transpose = (trans != 'N') != m_a->transposed;
+        double info[UMFPACK_INFO];
+        for (std::size_t c = 0; c < nrhs; ++c)
+        {
+            int status = umfpack_di_solve(transpose ? UMFPACK_At : UMFPACK_A, m_a->offsets.data(),
+                                          m_a->indices.data(), m_a->values.data(), x.data() + c * n,
+                                          rhs.data() + c * n, m_numeric, m_control, info);
+            if (status != UMFPACK_OK)
+            {
+                XTENSOR_THROW(std::runtime_error, "The solution could not be computed");
+            }
+        }
+        return x;
+    }
+
+    /**
+     * @return (sign, log(abs(det))) of A, (0, -inf) for singular matrices
+     */
+    template <class T>
+    inline auto sparse_lu_factorization<T>::logdet() const -> std::tuple<value_type, real_type>
+    {
+        if (singular())
+        {
+            return std::make_tuple(value_type(0), -std::numeric_limits<real_type>::infinity());
+        }
+        double mantissa = 0., exponent = 0.;
+        double info[UMFPACK_INFO];
+        umfpack_di_get_determinant(&mantissa, &exponent, m_numeric, info);
+        // det = mantissa * 10^exponent
+        return std::make_tuple(mantissa < 0. ? value_type(-1) : value_type(1),
+                               std::log(std::abs(mantissa)) + exponent * std::log(10.));
+    }
+
+    /**
+     * @return UMFPACK's estimate of the reciprocal condition number, the
+     *         ratio of the smallest to the largest pivot; 0 for singular A
+     */
+    template <class T>
+    inline auto sparse_lu_factorization<T>::rcond() const -> real_type
+    {
+        return singular() ? real_type(0) : real_type(m_info[UMFPACK_RCOND]);
+    }
+
+    /**
+     * @return true if U has an exact zero on its diagonal, or if the last
+     *         refactor failed
+     */
+    template <class T>
+    inline bool sparse_lu_factorization<T>::singular() const noexcept
+    {
+        return m_singular;
+    }
+
+    template <class T>
+    inline std::size_t sparse_lu_factorization<T>::size() const noexcept
+    {
+        return m_a->rows;
+    }
+
+    /**
+     * @return number of symbolic analyses, one more for each refactor
+     *         with a new sparsity pattern
+     */
+    template <class T>
+    inline std::size_t sparse_lu_factorization<T>::analyses() const noexcept
+    {
+        return m_analyses;
+    }
+
+    /**
+     * Sparse Cholesky factorization of the symmetric positive definite
+     * matrix \em A by CHOLMOD, for repeated solves and refactorizations.
+     * @param A CCS matrix; only its triangle \em uplo is read
+     * @param uplo 'L' or 'U'
+     * @return sparse_cholesky_factorization of \em A
+     */
+    template <class T>
+    inline auto cholesky_factor(const xsparse_ccs<T>& A, char uplo = 'L')
+    {
+        return sparse_cholesky_factorization<T>(A, uplo, false);
+    }
+
+    /**
+     * Sparse Cholesky factorization of a CSR matrix, see the CCS overload.
+     */
+    template <class T>
+    inline auto cholesky_factor(const xsparse_csr<T>& A, char uplo = 'L')
+    {
+        return sparse_cholesky_factorization<T>(A, uplo, true);
+    }
+
+    /**
+     * Sparse LU factorization of the square matrix \em A by UMFPACK, for
+     * repeated solves and refactorizations.
+     * @param A CCS matrix with sorted row indices
+     * @return sparse_lu_factorization of \em A
+     */
+    template <class T>
+    inline auto lu_factor(const xsparse_ccs<T>& A)
+    {
+        return sparse_lu_factorization<T>(A, false);
+    }
+
+    /**
+     * Sparse LU factorization of a CSR matrix, see the CCS overload.
+     */
+    template <class T>
+    inline auto lu_factor(const xsparse_csr<T>& A)
+    {
+        return sparse_lu_factorization<T>(A, true);
+    }
+
+    /**
+     * Solve A x = b for the sparse square matrix \em A, by UMFPACK.
+     */
+    template <class T, class E>
+    inline auto solve(const xsparse_ccs<T>& A, const xexpression<E>& b)
+    {
+        return lu_factor(A).solve(b);
+    }
+
+    template <class T, class E>
+    inline auto solve(const xsparse_csr<T>& A, const xexpression<E>& b)
+    {
+        return lu_factor(A).solve(b);
+    }
+
+    /*************************
+     * shift_invert_operator *
+     *************************/
+
+    /// Spectral transformation applied by shift_invert_operator
+    enum class spectral_transform
+    {
+        shift_invert,  ///< (A - sigma I)^-1, of eigenvalues 1 / (lambda - sigma)
+        cayley         ///< (A - sigma I)^-1 (A + sigma I), of eigenvalues (lambda + sigma) / (lambda - sigma)
+    };
+
+    namespace detail
+    {
+        /*
+         * Copy of the square matrix A with an explicit entry on every
+         * diagonal position, zero where A has none, so that the pattern of
+         * A - sigma I does not depend on sigma. The positions of the
+         * diagonal entries in the values are stored in diagonal.
+         */
+        template <class S>
+        inline S sparse_with_diagonal(const S& A, std::vector<std::size_t>& diagonal)
+        {
+            using index_type = blas_index_t;
+            using index_storage = typename S::index_storage;
+            using value_storage = typename S::value_storage;
+            using value_type = typename S::value_type;
+
+            std::size_t n = A.shape()[0];
+            const auto& offsets = A.offsets();
+            const auto& indices = A.indices();
+            const auto& values = A.values();
+            std::size_t missing = 0;
+            for (std::size_t k = 0; k < n; ++k)
+            {
+                auto first = indices.cbegin() + offsets[k];
+                auto last = indices.cbegin() + offsets[k + 1];
+                missing += std::find(first, last, index_type(k)) == last ? 1 : 0;
+            }
+
+            index_storage new_offsets(n + 1);
+            index_storage new_indices(A.nnz() + missing);
+            value_storage new_values(A.nnz() + missing);
+            diagonal.resize(n);
+            std::size_t q = 0;
+            for (std::size_t k = 0; k < n; ++k)
+            {
+                new_offsets[k] = index_type(q);
+                bool placed = false;
+                for (auto p = static_cast<std::size_t>(offsets[k]); p < static_cast<std::size_t>(offsets[k + 1]); ++p)
+                {
+                    std::size_t i = static_cast<std::size_t>(indices[p]);
+                    if (!placed && i >= k)
+                    {
+                        diagonal[k] = q;
+                        if (i != k)
+                        {
+                            new_indices[q] = index_type(k);
+                            new_values[q++] = value_type(0);
+                        }
+                        placed = true;
+                    }
+                    new_indices[q] = indices[p];
+                    new_values[q++] = values[p];
+                }
+                if (!placed)
+                {
+                    diagonal[k] = q;
+                    new_indices[q] = index_type(k);
+                    new_values[q++] = value_type(0);
+                }
+            }
+            new_offsets[n] = index_type(q);
+            return S(n, n, std::move(new_values), std::move(new_offsets), std::move(new_indices));
+        }
+    }
+
+    /**
+     * Spectral transformation of a sparse matrix for computing its
+     * eigenvalues closest to a shift sigma with eigsh: the Krylov
+     * iteration finds the largest eigenvalues of the transformed
+     * operator, which are those of A nearest to sigma.
+     *
+     * A - sigma I is factorized once by UMFPACK when the operator is
+     * built, and every apply is a pair of triangular solves with the
+     * factors. The operator keeps the factorization between calls:
+     * set_shift with the current shift does nothing, and a new shift only
+     * repeats the numerical factorization, the shifted matrix keeping the
+     * sparsity pattern of A with its whole diagonal.
+     *
+     * @tparam S xsparse_ccs<double> or xsparse_csr<double> with sorted
+     *           indices
+     */
+    template <class S>
+    class shift_invert_operator
+    {
+    public:
+
+        using matrix_type = S;
+        using value_type = typename S::value_type;
+        using vector_type = xtensor<value_type, 1>;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+
+        shift_invert_operator(const S& A, value_type sigma,
+                              spectral_transform mode = spectral_transform::shift_invert);
+
+        void set_shift(value_type sigma);
+        value_type shift() const noexcept;
+        spectral_transform mode() const noexcept;
+        size_type factorizations() const noexcept;
+
+        shape_type shape() const noexcept;
+        void apply(const vector_type& x, vector_type& y) const;
+
+        value_type eigenvalue(value_type theta) const noexcept;
+
+    private:
+
+        void check_shift(value_type sigma) const;
+        void shift_diagonal(value_type sigma);
+
+        std::vector<std::size_t> m_diagonal;
+        xtensor<value_type, 1> m_diagonal_values;
+        S m_shifted;
+        value_type m_sigma;
+        spectral_transform m_mode;
+        sparse_lu_factorization<value_type> m_lu;
+        size_type m_factorizations;
+    };
+
+    /**
+     * Builds the operator and factorizes A - \em sigma I.
+     * @param A square sparse matrix
+     * @param sigma shift, nonzero for the Cayley transformation
+     * @param mode spectral transformation
+     */
+    template <class S>
+    inline shift_invert_operator<S>::shift_invert_operator(const S& A, value_type sigma, spectral_transform mode)
+        : m_shifted(detail::sparse_with_diagonal(A, m_diagonal)),
+          m_sigma(sigma), m_mode(mode),
+          m_lu((check_shift(sigma), shift_diagonal(sigma), lu_factor(m_shifted))),
+          m_factorizations(1)
+    {
+        if (m_lu.singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "shift_invert_operator: A - sigma I is singular.");
+        }
+    }
+
+    /**
+     * Moves the shift to \em sigma, refactorizing A - \em sigma I unless
+     * it is the current shift.
+     */
+    template <class S>
+    inline void shift_invert_operator<S>::set_shift(value_type sigma)
+    {
+        if (sigma == m_sigma)
+        {
+            return;
+        }
+        check_shift(sigma);
+        shift_diagonal(sigma);
+        m_sigma = sigma;
+        m_lu.refactor(m_shifted);
+        ++m_factorizations;
+        if (m_lu.singular())
+        {
+            XTENSOR_THROW(std::runtime_error, "shift_invert_operator: A - sigma I is singular.");
+        }
+    }
+
+    template <class S>
+    inline auto shift_invert_operator<S>::shift() const noexcept -> value_type
+    {
+        return m_sigma;
+    }
+
+    template <class S>
+    inline spectral_transform shift_invert_operator<S>::mode() const noexcept
+    {
+        return m_mode;
+    }
+
+    /**
+     * @return number of numerical factorizations, one more for each new
+     *         shift
+     */
+    template <class S>
+    inline auto shift_invert_operator<S>::factorizations() const noexcept -> size_type
+    {
+        return m_factorizations;
+    }
+
+    template <class S>
+    inline auto shift_invert_operator<S>::shape() const noexcept -> shape_type
+    {
+        return m_shifted.shape();
+    }
+
+    /**
+     * y := (A - sigma I)^-1 x, or for the Cayley transformation
+     * y := (A - sigma I)^-1 (A + sigma I) x = x + 2 sigma (A - sigma I)^-1 x,
+     * which needs no product with A.
+     */
+    template <class S>
+    inline void shift_invert_operator<S>::apply(const vector_type& x, vector_type& y) const
+    {
+        y = m_lu.solve(x);
+        if (m_mode == spectral_transform::cayley)
+        {
+            detail::krylov_axpby(value_type(1), x, value_type(2) * m_sigma, y);
+        }
+    }
+
+    /**
+     * @return eigenvalue of A of which \em theta is the eigenvalue of the
+     *         transformed operator
+     */
+    template <class S>
+    inline auto shift_invert_operator<S>::eigenvalue(value_type theta) const noexcept -> value_type
+    {
+        if (m_mode == spectral_transform::cayley)
+        {
+            return m_sigma * (theta + value_type(1)) / (theta - value_type(1));
+        }
+        return m_sigma + value_type(1) / theta;
+    }
+
+    template <class S>
+    inline void shift_invert_operator<S>::check_shift(value_type sigma) const
+    {
+        if (m_mode == spectral_transform::cayley && sigma == value_type(0))
+        {
+            XTENSOR_THROW(std::runtime_error, "shift_invert_operator: the Cayley transformation needs a nonzero shift.");
+        }
+    }
+
+    template <class S>
+    inline void shift_invert_operator<S>::shift_diagonal(value_type sigma)
+    {
+        auto& values = m_shifted.values();
+        if (m_diagonal_values.size() != m_diagonal.size())
+        {
+            m_diagonal_values = xtensor<value_type, 1>::from_shape({m_diagonal.size()});
+            for (std::size_t k = 0; k < m_diagonal.size(); ++k)
+            {
+                m_diagonal_values(k) = values[m_diagonal[k]];
+            }
+        }
+        for (std::size_t k = 0; k < m_diagonal.size(); ++k)
+        {
+            values[m_diagonal[k]] = m_diagonal_values(k) - sigma;
+        }
+    }
+
+    /**
+     * @return shift_invert_operator of the CCS matrix \em A
+     */
+    template <class T>
+    inline auto make_shift_invert(const xsparse_ccs<T>& A, T sigma,
+                                  spectral_transform mode = spectral_transform::shift_invert)
+    {
+        return shift_invert_operator<xsparse_ccs<T>>(A, sigma, mode);
+    }
+
+    /**
+     * @return shift_invert_operator of the CSR matrix \em A
+     */
+    template <class T>
+    inline auto make_shift_invert(const xsparse_csr<T>& A, T sigma,
+                                  spectral_transform mode = spectral_transform::shift_invert)
+    {
+        return shift_invert_operator<xsparse_csr<T>>(A, sigma, mode);
+    }
+
+    /**
+     * Computes the \em nev eigenvalues of the symmetric sparse matrix
+     * transformed by \em op that are closest to its shift, and their
+     * eigenvectors, by Lanczos iterations on the transformed operator.
+     * Every iteration reuses the factorization held by \em op, which can
+     * be kept for later calls with the same or a nearby shift.
+     *
+     * @return tuple (w, V) of the ascending eigenvalues of A and the
+     *         orthonormal eigenvectors as columns of V
+     */
+    template <class S>
+    auto eigsh(const shift_invert_operator<S>& op, std::size_t nev,
+               const krylov_eigen_options& options = krylov_eigen_options())
+    {
+        using value_type = typename S::value_type;
+        auto result = eigsh(op, nev, eigen_target::largest_magnitude, options);
+        const auto& theta = std::get<0>(result);
+        const auto& vectors = std::get<1>(result);
+
+        std::vector<value_type> lambda(nev);
+        std::transform(theta.cbegin(), theta.cend(), lambda.begin(),
+                       [&op](value_type t) { return op.eigenvalue(t); });
+        std::vector<std::size_t> order(nev);
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::sort(order.begin(), order.end(), [&lambda](std::size_t i, std::size_t j) {
+            return lambda[i] < lambda[j];
+        });
+
+        std::size_t n = op.shape()[0];
+        xtensor<value_type, 1> eigenvalues = xtensor<value_type, 1>::from_shape({nev});
+        xtensor<value_type, 2, layout_type::column_major> eigenvectors
+            = xtensor<value_type, 2, layout_type::column_major>::from_shape({n, nev});
+        for (std::size_t i = 0; i < nev; ++i)
+        {
+            eigenvalues(i) = lambda[order[i]];
+            std::copy(vectors.data() + order[i] * n, vectors.data() + (order[i] + 1) * n,
+                      eigenvectors.data() + i * n);
+        }
+        return std::make_tuple(std::move(eigenvalues), std::move(eigenvectors));
+    }
+
+    /**
+     * Computes the \em nev eigenvalues of the symmetric CCS matrix \em A
+     * closest to \em sigma, and their eigenvectors, in shift-invert or
+     * Cayley mode. The factorization of A - sigma I is made once for all
+     * the iterations; build a shift_invert_operator to keep it across calls.
+     */
+    template <class T>
+    auto eigsh(const xsparse_ccs<T>& A, std::size_t nev, T sigma,
+               spectral_transform mode = spectral_transform::shift_invert,
+               const krylov_eigen_options& options = krylov_eigen_options())
+    {
+        return eigsh(make_shift_invert(A, sigma, mode), nev, options);
+    }
+
+    /**
+     * Shift-invert eigenvalues of a symmetric CSR matrix, see the CCS
+     * overload.
+     */
+    template <class T>
+    auto eigsh(const xsparse_csr<T>& A, std::size_t nev, T sigma,
+               spectral_transform mode = spectral_transform::shift_invert,
+               const krylov_eigen_options& options = krylov_eigen_options())
+    {
+        return eigsh(make_shift_invert(A, sigma, mode), nev, options);
+    }
+}
+}
+
+#endif
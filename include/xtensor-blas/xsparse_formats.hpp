@@ -0,0 +1,1245 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XSPARSE_FORMATS_HPP
+#define XSPARSE_FORMATS_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xtensor/xstorage.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xsparse.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+    /// Storage formats of the sparse matrix-vector products
+    enum class sparse_format {
+        csr,   ///< xsparse_csr, one row after the other
+        sell,  ///< xsparse_sell, slices of rows of similar length stored by columns
+        bcsr   ///< xsparse_bcsr, small dense blocks
+    };
+
+    /**
+     * Format chosen by analyze_spmv for the products with a CSR matrix, and
+     * the statistics it was chosen from.
+     */
+    struct spmv_analysis
+    {
+        sparse_format format = sparse_format::csr;
+        std::size_t chunk_height = 0;  ///< C of the SELL candidate
+        std::size_t sigma = 0;         ///< sorting window of the SELL candidate
+        std::size_t block_size = 0;    ///< order of the blocks of the BCSR candidate
+        double mean_row_nnz = 0.;      ///< nonzeros per row
+        double sell_fill = 0.;         ///< nonzeros over stored elements of the SELL candidate
+        double bcsr_fill = 0.;         ///< nonzeros over stored elements of the BCSR candidate
+        /// bytes per nonzero of the model, or seconds per product if measured, by sparse_format
+        std::array<double, 3> cost = {{0., 0., 0.}};
+    };
+}
+
+    /****************
+     * xsparse_sell *
+     ****************/
+
+    /**
+     * Sparse matrix in SELL-C-sigma format.
+     *
+     * Within windows of \em sigma rows the rows are sorted by decreasing
+     * length, then cut into slices of C rows. A slice is stored by columns,
+     * padded with zeros to its longest row: element j of the rows of slice s
+     * are values()[slice_offsets()[s] + j * C + lane] for lane in [0, C), so
+     * that the product handles C rows at once in SIMD lanes with contiguous
+     * loads. Row permutation()[s * C + lane] of the matrix is held in the
+     * lane. Padding elements have a zero value and a valid column index.
+     */
+    template <class T>
+    class xsparse_sell
+    {
+    public:
+
+        using value_type = T;
+        using index_type = blas_index_t;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+        using value_storage = uvector<value_type>;
+        using index_storage = uvector<index_type>;
+
+        xsparse_sell();
+        explicit xsparse_sell(const xsparse_csr<T>& A, size_type C = default_chunk_height(), size_type sigma = 0);
+
+        static constexpr size_type default_chunk_height() noexcept
+        {
+            // a cache line of values per column of a slice
+            return 64 / sizeof(T) < 2 ? 2 : (64 / sizeof(T) > 32 ? 32 : 64 / sizeof(T));
+        }
+
+        shape_type shape() const noexcept;
+        size_type nnz() const noexcept;
+        size_type stored() const noexcept;
+        size_type chunk_height() const noexcept;
+        size_type sigma() const noexcept;
+
+        const index_storage& slice_offsets() const noexcept;
+        const index_storage& column_indices() const noexcept;
+        const value_storage& values() const noexcept;
+        const index_storage& permutation() const noexcept;
+
+        template <class V>
+        void apply(const V& x, V& y) const;
+
+    private:
+
+        value_storage m_values;
+        index_storage m_indices;
+        index_storage m_slice_offsets;
+        index_storage m_permutation;
+        shape_type m_shape;
+        size_type m_nnz;
+        size_type m_chunk;
+        size_type m_sigma;
+    };
+
+    /****************
+     * xsparse_bcsr *
+     ****************/
+
+    /**
+     * Sparse matrix in block compressed sparse row format.
+     *
+     * The matrix is cut into blocks of r by c elements, and the blocks
+     * holding a nonzero are stored dense, row by row: block k of block row I
+     * is at block column block_column_indices()[k], for k in
+     * [block_row_offsets()[I], block_row_offsets()[I + 1]), and its element
+     * (i, j) is values()[(k * r + i) * c + j]. One index per block instead of
+     * per element reduces the memory traffic of the product when the blocks
+     * are mostly full, as with the degrees of freedom of finite elements.
+     */
+    template <class T>
+    class xsparse_bcsr
+    {
+    public:
+
+        using value_type = T;
+        using index_type = blas_index_t;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+        using value_storage = uvector<value_type>;
+        using index_storage = uvector<index_type>;
+
+        xsparse_bcsr();
+        xsparse_bcsr(const xsparse_csr<T>& A, size_type r, size_type c);
+
+        shape_type shape() const noexcept;
+        size_type nnz() const noexcept;
+        size_type stored() const noexcept;
+        size_type blocks() const noexcept;
+        size_type block_rows() const noexcept;
+        size_type block_cols() const noexcept;
+
+        const index_storage& block_row_offsets() const noexcept;
+        const index_storage& block_column_indices() const noexcept;
+        const value_storage& values() const noexcept;
+
+        template <class V>
+        void apply(const V& x, V& y) const;
+
+    private:
+
+        value_storage m_values;
+        index_storage m_indices;
+        index_storage m_offsets;
+        shape_type m_shape;
+        size_type m_nnz;
+        size_type m_r;
+        size_type m_c;
+    };
+
+    /*****************
+     * xsparse_tuned *
+     *****************/
+
+    /**
+     * Sparse matrix held in the format analyze_spmv finds best for its
+     * products: the analysis runs once, when it is built, and dot and the
+     * Krylov solvers then use the chosen storage.
+     */
+    template <class T>
+    class xsparse_tuned
+    {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+
+        explicit xsparse_tuned(const xsparse_csr<T>& A, bool measure = false);
+        xsparse_tuned(const xsparse_csr<T>& A, const linalg::spmv_analysis& analysis);
+
+        shape_type shape() const noexcept;
+        size_type nnz() const noexcept;
+        linalg::sparse_format format() const noexcept;
+        const linalg::spmv_analysis& analysis() const noexcept;
+
+        const xsparse_csr<T>& csr() const noexcept;
+        const xsparse_sell<T>& sell() const noexcept;
+        const xsparse_bcsr<T>& bcsr() const noexcept;
+
+        template <class V>
+        void apply(const V& x, V& y) const;
+
+    private:
+
+        linalg::spmv_analysis m_analysis;
+        xsparse_csr<T> m_csr;
+        xsparse_sell<T> m_sell;
+        xsparse_bcsr<T> m_bcsr;
+    };
+
+namespace linalg
+{
+    namespace detail
+    {
+        /// Right-hand sides handled together by the sparse matrix-matrix kernels
+        constexpr std::size_t sparse_rhs_block = 4;
+
+        /***************
+         * SELL kernels *
+         ***************/
+
+        /**
+         * Y = A X for slices [first, last) of a SELL matrix with C rows per
+         * slice and K columns of X, of leading dimension ldx, into Y, of
+         * leading dimension ldy. Each element of A is loaded once for the K
+         * columns, and the C lanes of a slice are independent.
+         */
+        template <std::size_t C, std::size_t K, class T>
+        inline void sell_mm_slices(const xsparse_sell<T>& A, const T* x, std::size_t ldx, T* y, std::size_t ldy,
+                                   std::size_t first, std::size_t last)
+        {
+            const blas_index_t* so = A.slice_offsets().data();
+            const blas_index_t* ja = A.column_indices().data();
+            const T* a = A.values().data();
+            const blas_index_t* perm = A.permutation().data();
+            std::size_t m = A.shape()[0];
+            for (std::size_t s = first; s < last; ++s)
+            {
+                T sum[K][C];
+                for (std::size_t r = 0; r < K; ++r)
+                {
+                    for (std::size_t lane = 0; lane < C; ++lane)
+                    {
+                        sum[r][lane] = T(0);
+                    }
+                }
+                std::size_t begin = static_cast<std::size_t>(so[s]);
+                std::size_t width = (static_cast<std::size_t>(so[s + 1]) - begin) / C;
+                for (std::size_t j = 0; j < width; ++j)
+                {
+                    const T* v = a + begin + j * C;
+                    const blas_index_t* col = ja + begin + j * C;
+                    for (std::size_t r = 0; r < K; ++r)
+                    {
+                        const T* xr = x + r * ldx;
+#if defined(XTENSOR_USE_OPENMP)
+                        #pragma omp simd
+#endif
+                        for (std::size_t lane = 0; lane < C; ++lane)
+                        {
+                            sum[r][lane] += v[lane] * xr[col[lane]];
+                        }
+                    }
+                }
+                std::size_t rows = std::min(C, m - s * C);
+                for (std::size_t r = 0; r < K; ++r)
+                {
+                    for (std::size_t lane = 0; lane < rows; ++lane)
+                    {
+                        y[r * ldy + static_cast<std::size_t>(perm[s * C + lane])] = sum[r][lane];
+                    }
+                }
+            }
+        }
+
+        template <std::size_t K, class T>
+        inline void sell_mm_dispatch(const xsparse_sell<T>& A, const T* x, std::size_t ldx, T* y, std::size_t ldy,
+                                     std::size_t first, std::size_t last)
+        {
+            switch (A.chunk_height())
+            {
+                case 2:
+                    sell_mm_slices<2, K>(A, x, ldx, y, ldy, first, last);
+                    break;
+                case 4:
+                    sell_mm_slices<4, K>(A, x, ldx, y, ldy, first, last);
+                    break;
+                case 8:
+                    sell_mm_slices<8, K>(A, x, ldx, y, ldy, first, last);
+                    break;
+                case 16:
+                    sell_mm_slices<16, K>(A, x, ldx, y, ldy, first, last);
+                    break;
+                default:
+                    sell_mm_slices<32, K>(A, x, ldx, y, ldy, first, last);
+                    break;
+            }
+        }
+
+        /**
+         * Y = A X for the \em k columns of X, the slices partitioned in chunks
+         * of about sparse_chunk_nnz stored elements which run in parallel
+         * when XTENSOR_USE_OPENMP is defined.
+         */
+        template <class T>
+        inline void sell_mm(const xsparse_sell<T>& A, const T* x, std::size_t ldx, T* y, std::size_t ldy, std::size_t k)
+        {
+            std::size_t C = A.chunk_height();
+            std::size_t slices = (A.shape()[0] + C - 1) / C;
+            std::vector<std::size_t> bounds = partition_offsets(A.slice_offsets().data(), slices);
+            std::size_t chunks = bounds.size() - 1;
+
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for schedule(dynamic)
+#endif
+            for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t>(chunks); ++c)
+            {
+                std::size_t first = bounds[static_cast<std::size_t>(c)];
+                std::size_t last = bounds[static_cast<std::size_t>(c) + 1];
+                std::size_t j = 0;
+                for (; j + sparse_rhs_block <= k; j += sparse_rhs_block)
+                {
+                    sell_mm_dispatch<sparse_rhs_block>(A, x + j * ldx, ldx, y + j * ldy, ldy, first, last);
+                }
+                for (; j < k; ++j)
+                {
+                    sell_mm_dispatch<1>(A, x + j * ldx, ldx, y + j * ldy, ldy, first, last);
+                }
+            }
+        }
+
+        /****************
+         * BCSR kernels *
+         ****************/
+
+        /**
+         * Y = A X for block rows [first, last) of a BCSR matrix with R by B
+         * blocks and K columns of X. X has a multiple of B rows and Y a
+         * multiple of R rows.
+         */
+        template <std::size_t R, std::size_t B, std::size_t K, class T>
+        inline void bcsr_mm_rows(const xsparse_bcsr<T>& A, const T* x, std::size_t ldx, T* y, std::size_t ldy,
+                                 std::size_t first, std::size_t last)
+        {
+            const blas_index_t* ib = A.block_row_offsets().data();
+            const blas_index_t* jb = A.block_column_indices().data();
+            const T* a = A.values().data();
+            for (std::size_t I = first; I < last; ++I)
+            {
+                T sum[K][R];
+                for (std::size_t r = 0; r < K; ++r)
+                {
+                    for (std::size_t i = 0; i < R; ++i)
+                    {
+                        sum[r][i] = T(0);
+                    }
+                }
+                for (auto p = static_cast<std::size_t>(ib[I]); p < static_cast<std::size_t>(ib[I + 1]); ++p)
+                {
+                    const T* block = a + p * R * B;
+                    const T* xb = x + static_cast<std::size_t>(jb[p]) * B;
+                    for (std::size_t r = 0; r < K; ++r)
+                    {
+                        for (std::size_t i = 0; i < R; ++i)
+                        {
+                            T s(0);
+                            for (std::size_t j = 0; j < B; ++j)
+                            {
+                                s += block[i * B + j] * xb[r * ldx + j];
+                            }
+                            sum[r][i] += s;
+                        }
+                    }
+                }
+                for (std::size_t r = 0; r < K; ++r)
+                {
+                    for (std::size_t i = 0; i < R; ++i)
+                    {
+                        y[r * ldy + I * R + i] = sum[r][i];
+                    }
+                }
+            }
+        }
+
+        /// Y = A X for block rows [first, last), for any block size
+        template <class T>
+        inline void bcsr_mm_rows(const xsparse_bcsr<T>& A, const T* x, std::size_t ldx, T* y, std::size_t ldy,
+                                 std::size_t k, std::size_t first, std::size_t last)
+        {
+            const blas_index_t* ib = A.block_row_offsets().data();
+            const blas_index_t* jb = A.block_column_indices().data();
+            const T* a = A.values().data();
+            std::size_t R = A.block_rows();
+            std::size_t B = A.block_cols();
+            for (std::size_t r = 0; r < k; ++r)
+            {
+                for (std::size_t I = first; I < last; ++I)
+                {
+                    T* yb = y + r * ldy + I * R;
+                    std::fill(yb, yb + R, T(0));
+                    for (auto p = static_cast<std::size_t>(ib[I]); p < static_cast<std::size_t>(ib[I + 1]); ++p)
+                    {
+                        const T* block = a + p * R * B;
+                        const T* xb = x + r * ldx + static_cast<std::size_t>(jb[p]) * B;
+                        for (std::size_t i = 0; i < R; ++i)
+                        {
+                            for (std::size_t j = 0; j < B; ++j)
+                            {
+                                yb[i] += block[i * B + j] * xb[j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        template <std::size_t S, class T>
+        inline void bcsr_mm_square(const xsparse_bcsr<T>& A, const T* x, std::size_t ldx, T* y, std::size_t ldy,
+                                   std::size_t k, std::size_t first, std::size_t last)
+        {
+            std::size_t j = 0;
+            for (; j + sparse_rhs_block <= k; j += sparse_rhs_block)
+            {
+                bcsr_mm_rows<S, S, sparse_rhs_block>(A, x + j * ldx, ldx, y + j * ldy, ldy, first, last);
+            }
+            for (; j < k; ++j)
+            {
+                bcsr_mm_rows<S, S, 1>(A, x + j * ldx, ldx, y + j * ldy, ldy, first, last);
+            }
+        }
+
+        template <class T>
+        inline void bcsr_mm_dispatch(const xsparse_bcsr<T>& A, const T* x, std::size_t ldx, T* y, std::size_t ldy,
+                                     std::size_t k, std::size_t first, std::size_t last)
+        {
+            std::size_t size = A.block_rows() == A.block_cols() ? A.block_rows() : 0;
+            switch (size)
+            {
+                case 2:
+                    bcsr_mm_square<2>(A, x, ldx, y, ldy, k, first, last);
+                    break;
+                case 3:
+                    bcsr_mm_square<3>(A, x, ldx, y, ldy, k, first, last);
+                    break;
+                case 4:
+                    bcsr_mm_square<4>(A, x, ldx, y, ldy, k, first, last);
+                    break;
+                case 8:
+                    bcsr_mm_square<8>(A, x, ldx, y, ldy, k, first, last);
+                    break;
+                default:
+                    bcsr_mm_rows(A, x, ldx, y, ldy, k, first, last);
+                    break;
+            }
+        }
+
+        /**
+         * Y = A X for the \em k columns of X. X and Y are copied to buffers
+         * padded to whole blocks when the shape of A is not a multiple of
+         * the block size.
+         */
+        template <class T>
+        inline void bcsr_mm(const xsparse_bcsr<T>& A, const T* x, std::size_t ldx, T* y, std::size_t ldy, std::size_t k)
+        {
+            std::size_t m = A.shape()[0];
+            std::size_t n = A.shape()[1];
+            std::size_t R = A.block_rows();
+            std::size_t B = A.block_cols();
+            std::size_t mb = (m + R - 1) / R;
+            std::size_t nb = (n + B - 1) / B;
+
+            std::vector<T> xpad, ypad;
+            const T* xp = x;
+            std::size_t ldxp = ldx;
+            if (n % B != 0)
+            {
+                xpad.assign(nb * B * k, T(0));
+                for (std::size_t r = 0; r < k; ++r)
+                {
+                    std::copy(x + r * ldx, x + r * ldx + n, xpad.begin() + static_cast<std::ptrdiff_t>(r * nb * B));
+                }
+                xp = xpad.data();
+                ldxp = nb * B;
+            }
+            T* yp = y;
+            std::size_t ldyp = ldy;
+            if (m % R != 0)
+            {
+                ypad.resize(mb * R * k);
+                yp = ypad.data();
+                ldyp = mb * R;
+            }
+
+            std::vector<std::size_t> bounds = partition_offsets(A.block_row_offsets().data(), mb);
+            std::size_t chunks = bounds.size() - 1;
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for schedule(dynamic)
+#endif
+            for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t>(chunks); ++c)
+            {
+                bcsr_mm_dispatch(A, xp, ldxp, yp, ldyp, k, bounds[static_cast<std::size_t>(c)],
+                                 bounds[static_cast<std::size_t>(c) + 1]);
+            }
+
+            if (m % R != 0)
+            {
+                for (std::size_t r = 0; r < k; ++r)
+                {
+                    std::copy(yp + r * ldyp, yp + r * ldyp + m, y + r * ldy);
+                }
+            }
+        }
+
+        /**
+         * Y = A X for a CSR matrix, one column of X after the other.
+         */
+        template <class T>
+        inline void csr_mm(const xsparse_csr<T>& A, const T* x, std::size_t ldx, T* y, std::size_t ldy, std::size_t k)
+        {
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                csr_mv(A, x + j * ldx, y + j * ldy);
+            }
+        }
+
+        /**
+         * Applies \em mm, called as mm(x, ldx, y, ldy, k), to the columns of
+         * \em x, which has one row per column of \em A. The result has \em m
+         * rows.
+         */
+        template <class T, class E, class F>
+        inline auto sparse_block_product(const E& x, std::size_t m, std::size_t n, F&& mm)
+        {
+            static_assert(std::is_same<T, typename E::value_type>::value,
+                          "Sparse products need operands of the same value type.");
+
+            auto p = copy_to_layout<layout_type::column_major>(x);
+            if (p.dimension() > 2 || p.shape()[0] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+            }
+
+            auto shape = p.shape();
+            shape[0] = m;
+            auto result = decltype(p)::from_shape(shape);
+            std::size_t k = p.dimension() == 2 ? p.shape()[1] : 1;
+            mm(p.data(), n, result.data(), m, k);
+            return result;
+        }
+
+        /************
+         * Analysis *
+         ************/
+
+        /**
+         * Nonzeros over stored elements of the SELL-C-sigma storage of the
+         * matrix whose rows have \em lengths.
+         */
+        inline double sell_fill(const std::vector<std::size_t>& lengths, std::size_t C, std::size_t sigma)
+        {
+            std::size_t m = lengths.size();
+            std::vector<std::size_t> sorted(lengths);
+            std::size_t window = std::max(sigma, std::size_t(1));
+            for (std::size_t w = 0; w < m; w += window)
+            {
+                std::sort(sorted.begin() + static_cast<std::ptrdiff_t>(w),
+                          sorted.begin() + static_cast<std::ptrdiff_t>(std::min(w + window, m)), std::greater<std::size_t>());
+            }
+            std::size_t nnz = 0, stored = 0;
+            for (std::size_t s = 0; s < m; s += C)
+            {
+                std::size_t width = 0;
+                for (std::size_t i = s; i < std::min(s + C, m); ++i)
+                {
+                    width = std::max(width, sorted[i]);
+                    nnz += sorted[i];
+                }
+                stored += width * C;
+            }
+            return stored == 0 ? 1. : static_cast<double>(nnz) / static_cast<double>(stored);
+        }
+
+        /// Number of b by b blocks holding a nonzero of \em A
+        template <class T>
+        inline std::size_t count_blocks(const xsparse_csr<T>& A, std::size_t b)
+        {
+            std::size_t m = A.shape()[0];
+            std::size_t nb = (A.shape()[1] + b - 1) / b;
+            const auto& ia = A.row_offsets();
+            const auto& ja = A.column_indices();
+            std::vector<std::size_t> marker(nb, std::numeric_limits<std::size_t>::max());
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                {
+                    std::size_t J = static_cast<std::size_t>(ja[static_cast<std::size_t>(k)]) / b;
+                    if (marker[J] != i / b)
+                    {
+                        marker[J] = i / b;
+                        ++count;
+                    }
+                }
+            }
+            return count;
+        }
+
+        /// Seconds per product y = A x, the best of a few after a first one
+        template <class A, class T>
+        inline double time_spmv(const A& a, const xtensor<T, 1>& x, xtensor<T, 1>& y)
+        {
+            a.apply(x, y);
+            double best = std::numeric_limits<double>::max();
+            for (int rep = 0; rep < 5; ++rep)
+            {
+                auto start = std::chrono::steady_clock::now();
+                a.apply(x, y);
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                best = std::min(best, elapsed.count());
+            }
+            return best;
+        }
+
+        template <class T>
+        struct csr_apply
+        {
+            const xsparse_csr<T>& A;
+
+            void apply(const xtensor<T, 1>& x, xtensor<T, 1>& y) const
+            {
+                csr_mv(A, x.data(), y.data());
+            }
+        };
+    }
+
+    /**
+     * Chooses the storage format of the products with the CSR matrix \em A.
+     *
+     * The candidates are A itself, SELL-C-sigma with the default C and the
+     * smallest sorting window among C, 32 C and 1024 C that pads the slices
+     * by less than 10 %, and BCSR with the square blocks of order 2, 3, 4 or
+     * 8 holding the most nonzeros per stored element. The model counts the
+     * bytes read per nonzero: a value and an index for CSR, plus the cost of
+     * a row, about that of 32 bytes as short rows do not fill the SIMD lanes;
+     * a value and an index per stored element for SELL; a value per stored
+     * element and an index per block for BCSR. The cheapest format is
+     * chosen.
+     *
+     * With \em measure, the three candidates are built and the product with
+     * each is timed instead, which takes a few products of each format.
+     */
+    template <class T>
+    spmv_analysis analyze_spmv(const xsparse_csr<T>& A, bool measure = false)
+    {
+        spmv_analysis result;
+        std::size_t m = A.shape()[0];
+        const auto& ia = A.row_offsets();
+        std::vector<std::size_t> lengths(m);
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            lengths[i] = static_cast<std::size_t>(ia[i + 1] - ia[i]);
+        }
+        result.mean_row_nnz = m == 0 ? 0. : static_cast<double>(A.nnz()) / static_cast<double>(m);
+
+        std::size_t C = xsparse_sell<T>::default_chunk_height();
+        result.chunk_height = C;
+        for (std::size_t sigma : {C, 32 * C, 1024 * C})
+        {
+            double fill = detail::sell_fill(lengths, C, sigma);
+            if (fill > result.sell_fill)
+            {
+                result.sell_fill = fill;
+                result.sigma = sigma;
+            }
+            if (fill >= 0.9)
+            {
+                break;
+            }
+        }
+
+        double value_bytes = static_cast<double>(sizeof(T));
+        double index_bytes = static_cast<double>(sizeof(blas_index_t));
+        double bcsr_cost = std::numeric_limits<double>::max();
+        for (std::size_t b : {std::size_t(2), std::size_t(3), std::size_t(4), std::size_t(8)})
+        {
+            std::size_t blocks = detail::count_blocks(A, b);
+            double fill = blocks == 0 ? 1. : static_cast<double>(A.nnz()) / static_cast<double>(blocks * b * b);
+            double cost = (value_bytes + index_bytes / static_cast<double>(b * b)) / fill;
+            if (cost < bcsr_cost)
+            {
+                bcsr_cost = cost;
+                result.block_size = b;
+                result.bcsr_fill = fill;
+            }
+        }
+
+        if (!measure)
+        {
+            double row_cost = result.mean_row_nnz == 0. ? 0. : (index_bytes + 32.) / result.mean_row_nnz;
+            result.cost[static_cast<std::size_t>(sparse_format::csr)] = value_bytes + index_bytes + row_cost;
+            result.cost[static_cast<std::size_t>(sparse_format::sell)] = (value_bytes + index_bytes) / result.sell_fill;
+            result.cost[static_cast<std::size_t>(sparse_format::bcsr)] = bcsr_cost;
+        }
+        else
+        {
+            xtensor<T, 1> x = xtensor<T, 1>::from_shape({A.shape()[1]});
+            std::fill(x.begin(), x.end(), T(1));
+            xtensor<T, 1> y = xtensor<T, 1>::from_shape({m});
+            result.cost[static_cast<std::size_t>(sparse_format::csr)] = detail::time_spmv(detail::csr_apply<T>{A}, x, y);
+            result.cost[static_cast<std::size_t>(sparse_format::sell)] =
+                detail::time_spmv(xsparse_sell<T>(A, result.chunk_height, result.sigma), x, y);
+            result.cost[static_cast<std::size_t>(sparse_format::bcsr)] =
+                detail::time_spmv(xsparse_bcsr<T>(A, result.block_size, result.block_size), x, y);
+        }
+
+        auto best = std::min_element(result.cost.begin(), result.cost.end());
+        result.format = static_cast<sparse_format>(best - result.cost.begin());
+        return result;
+    }
+
+    /**
+     * Matrix product of the SELL matrix \em A with the vector or matrix \em x.
+     * Up to four columns of \em x are multiplied at once.
+     * @return the product, with one row per row of \em A
+     */
+    template <class T, class E>
+    auto dot(const xsparse_sell<T>& A, const xexpression<E>& x)
+    {
+        return detail::sparse_block_product<T>(x.derived_cast(), A.shape()[0], A.shape()[1],
+            [&A](const T* in, std::size_t ldx, T* out, std::size_t ldy, std::size_t k) {
+                detail::sell_mm(A, in, ldx, out, ldy, k);
+            });
+    }
+
+    /**
+     * Matrix product of the BCSR matrix \em A with the vector or matrix \em x.
+     * Up to four columns of \em x are multiplied at once.
+     * @return the product, with one row per row of \em A
+     */
+    template <class T, class E>
+    auto dot(const xsparse_bcsr<T>& A, const xexpression<E>& x)
+    {
+        return detail::sparse_block_product<T>(x.derived_cast(), A.shape()[0], A.shape()[1],
+            [&A](const T* in, std::size_t ldx, T* out, std::size_t ldy, std::size_t k) {
+                detail::bcsr_mm(A, in, ldx, out, ldy, k);
+            });
+    }
+
+    /**
+     * Matrix product of \em A, in the format chosen for it, with the vector
+     * or matrix \em x.
+     * @return the product, with one row per row of \em A
+     */
+    template <class T, class E>
+    auto dot(const xsparse_tuned<T>& A, const xexpression<E>& x)
+    {
+        return detail::sparse_block_product<T>(x.derived_cast(), A.shape()[0], A.shape()[1],
+            [&A](const T* in, std::size_t ldx, T* out, std::size_t ldy, std::size_t k) {
+                switch (A.format())
+                {
+                    case sparse_format::sell:
+                        detail::sell_mm(A.sell(), in, ldx, out, ldy, k);
+                        break;
+                    case sparse_format::bcsr:
+                        detail::bcsr_mm(A.bcsr(), in, ldx, out, ldy, k);
+                        break;
+                    default:
+                        detail::csr_mm(A.csr(), in, ldx, out, ldy, k);
+                        break;
+                }
+            });
+    }
+}
+
+    /*******************************
+     * xsparse_sell implementation *
+     *******************************/
+
+    template <class T>
+    inline xsparse_sell<T>::xsparse_sell()
+        : m_slice_offsets(1, index_type(0)), m_shape{0, 0}, m_nnz(0), m_chunk(default_chunk_height()), m_sigma(1)
+    {
+    }
+
+    /**
+     * Builds the SELL-C-sigma storage of \em A.
+     * @param C rows per slice: 2, 4, 8, 16 or 32
+     * @param sigma rows of the windows sorted by length, 0 for the whole
+     *        matrix. Larger windows pad less but scatter the rows of the
+     *        result further apart.
+     */
+    template <class T>
+    inline xsparse_sell<T>::xsparse_sell(const xsparse_csr<T>& A, size_type C, size_type sigma)
+        : m_shape(A.shape()), m_nnz(A.nnz()), m_chunk(C), m_sigma(sigma == 0 ? std::max(A.shape()[0], size_type(1)) : sigma)
+    {
+        if (C != 2 && C != 4 && C != 8 && C != 16 && C != 32)
+        {
+            XTENSOR_THROW(std::runtime_error, "xsparse_sell: C must be 2, 4, 8, 16 or 32.");
+        }
+        size_type m = m_shape[0];
+        const auto& ia = A.row_offsets();
+        const auto& ja = A.column_indices();
+        const auto& a = A.values();
+        auto length = [&ia](size_type i) { return static_cast<size_type>(ia[i + 1] - ia[i]); };
+
+        std::vector<index_type> perm(m);
+        std::iota(perm.begin(), perm.end(), index_type(0));
+        for (size_type w = 0; w < m; w += m_sigma)
+        {
+            std::stable_sort(perm.begin() + static_cast<std::ptrdiff_t>(w),
+                             perm.begin() + static_cast<std::ptrdiff_t>(std::min(w + m_sigma, m)),
+                             [&length](index_type i, index_type j) {
+                                 return length(static_cast<size_type>(i)) > length(static_cast<size_type>(j));
+                             });
+        }
+        m_permutation = index_storage(perm.begin(), perm.end());
+
+        size_type slices = (m + C - 1) / C;
+        m_slice_offsets = index_storage(slices + 1);
+        m_slice_offsets[0] = 0;
+        size_type stored = 0;
+        for (size_type s = 0; s < slices; ++s)
+        {
+            // rows are sorted within windows, but a slice may straddle two
+            size_type width = 0;
+            for (size_type p = s * C; p < std::min(s * C + C, m); ++p)
+            {
+                width = std::max(width, length(static_cast<size_type>(perm[p])));
+            }
+            stored += width * C;
+            if (stored > static_cast<size_type>(std::numeric_limits<index_type>::max()))
+            {
+                XTENSOR_THROW(std::runtime_error, "xsparse_sell: too many stored elements for blas_index_t.");
+            }
+            m_slice_offsets[s + 1] = static_cast<index_type>(stored);
+        }
+
+        m_values = value_storage(stored);
+        m_indices = index_storage(stored);
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for (std::ptrdiff_t sp = 0; sp < static_cast<std::ptrdiff_t>(slices); ++sp)
+        {
+            size_type s = static_cast<size_type>(sp);
+            size_type begin = static_cast<size_type>(m_slice_offsets[s]);
+            size_type width = (static_cast<size_type>(m_slice_offsets[s + 1]) - begin) / C;
+            for (size_type lane = 0; lane < C; ++lane)
+            {
+                size_type p = s * C + lane;
+                size_type row_length = p < m ? length(static_cast<size_type>(perm[p])) : 0;
+                size_type start = p < m ? static_cast<size_type>(ia[static_cast<size_type>(perm[p])]) : 0;
+                index_type pad = row_length == 0 ? index_type(0) : ja[start + row_length - 1];
+                for (size_type j = 0; j < width; ++j)
+                {
+                    size_type q = begin + j * C + lane;
+                    m_indices[q] = j < row_length ? ja[start + j] : pad;
+                    m_values[q] = j < row_length ? a[start + j] : value_type(0);
+                }
+            }
+        }
+    }
+
+    template <class T>
+    inline auto xsparse_sell<T>::shape() const noexcept -> shape_type
+    {
+        return m_shape;
+    }
+
+    /**
+     * Returns the number of nonzeros of the matrix, the padding excluded.
+     */
+    template <class T>
+    inline auto xsparse_sell<T>::nnz() const noexcept -> size_type
+    {
+        return m_nnz;
+    }
+
+    /**
+     * Returns the number of stored elements, the padding included.
+     */
+    template <class T>
+    inline auto xsparse_sell<T>::stored() const noexcept -> size_type
+    {
+        return m_values.size();
+    }
+
+    template <class T>
+    inline auto xsparse_sell<T>::chunk_height() const noexcept -> size_type
+    {
+        return m_chunk;
+    }
+
+    template <class T>
+    inline auto xsparse_sell<T>::sigma() const noexcept -> size_type
+    {
+        return m_sigma;
+    }
+
+    template <class T>
+    inline auto xsparse_sell<T>::slice_offsets() const noexcept -> const index_storage&
+    {
+        return m_slice_offsets;
+    }
+
+    template <class T>
+    inline auto xsparse_sell<T>::column_indices() const noexcept -> const index_storage&
+    {
+        return m_indices;
+    }
+
+    template <class T>
+    inline auto xsparse_sell<T>::values() const noexcept -> const value_storage&
+    {
+        return m_values;
+    }
+
+    template <class T>
+    inline auto xsparse_sell<T>::permutation() const noexcept -> const index_storage&
+    {
+        return m_permutation;
+    }
+
+    /**
+     * y = A x for contiguous vectors, as the Krylov solvers apply their
+     * operators.
+     */
+    template <class T>
+    template <class V>
+    inline void xsparse_sell<T>::apply(const V& x, V& y) const
+    {
+        linalg::detail::sell_mm(*this, x.data(), m_shape[1], y.data(), m_shape[0], 1);
+    }
+
+    /*******************************
+     * xsparse_bcsr implementation *
+     *******************************/
+
+    template <class T>
+    inline xsparse_bcsr<T>::xsparse_bcsr()
+        : m_offsets(1, index_type(0)), m_shape{0, 0}, m_nnz(0), m_r(1), m_c(1)
+    {
+    }
+
+    /**
+     * Builds the BCSR storage of \em A with blocks of \em r by \em c
+     * elements. The last block row and column are padded with zeros when
+     * the shape of \em A is not a multiple of the block size.
+     */
+    template <class T>
+    inline xsparse_bcsr<T>::xsparse_bcsr(const xsparse_csr<T>& A, size_type r, size_type c)
+        : m_shape(A.shape()), m_nnz(A.nnz()), m_r(r), m_c(c)
+    {
+        if (r == 0 || c == 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "xsparse_bcsr: blocks must not be empty.");
+        }
+        size_type m = m_shape[0];
+        size_type mb = (m + r - 1) / r;
+        size_type nb = (m_shape[1] + c - 1) / c;
+        const auto& ia = A.row_offsets();
+        const auto& ja = A.column_indices();
+        const auto& a = A.values();
+        constexpr size_type unmarked = std::numeric_limits<size_type>::max();
+
+        // a symbolic pass counts the blocks of every block row, a numeric one fills them
+        m_offsets = index_storage(mb + 1, index_type(0));
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel
+#endif
+        {
+            std::vector<size_type> marker(nb, unmarked);
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp for schedule(dynamic, 64)
+#endif
+            for (std::ptrdiff_t row = 0; row < static_cast<std::ptrdiff_t>(mb); ++row)
+            {
+                size_type I = static_cast<size_type>(row);
+                index_type count = 0;
+                for (size_type i = I * r; i < std::min(I * r + r, m); ++i)
+                {
+                    for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                    {
+                        size_type J = static_cast<size_type>(ja[static_cast<size_type>(k)]) / c;
+                        if (marker[J] != I)
+                        {
+                            marker[J] = I;
+                            ++count;
+                        }
+                    }
+                }
+                m_offsets[I + 1] = count;
+            }
+        }
+        std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+
+        size_type blocks = static_cast<size_type>(m_offsets[mb]);
+        m_indices = index_storage(blocks);
+        m_values = value_storage(blocks * r * c, value_type(0));
+#if defined(XTENSOR_USE_OPENMP)
+        #pragma omp parallel
+#endif
+        {
+            std::vector<size_type> marker(nb, unmarked);
+            std::vector<size_type> position(nb);
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp for schedule(dynamic, 64)
+#endif
+            for (std::ptrdiff_t row = 0; row < static_cast<std::ptrdiff_t>(mb); ++row)
+            {
+                size_type I = static_cast<size_type>(row);
+                index_type* columns = m_indices.data() + m_offsets[I];
+                size_type count = 0;
+                for (size_type i = I * r; i < std::min(I * r + r, m); ++i)
+                {
+                    for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                    {
+                        size_type J = static_cast<size_type>(ja[static_cast<size_type>(k)]) / c;
+                        if (marker[J] != I)
+                        {
+                            marker[J] = I;
+                            columns[count++] = static_cast<index_type>(J);
+                        }
+                    }
+                }
+                std::sort(columns, columns + count);
+                for (size_type p = 0; p < count; ++p)
+                {
+                    position[static_cast<size_type>(columns[p])] = static_cast<size_type>(m_offsets[I]) + p;
+                }
+                for (size_type i = I * r; i < std::min(I * r + r, m); ++i)
+                {
+                    for (auto k = ia[i]; k < ia[i + 1]; ++k)
+                    {
+                        size_type j = static_cast<size_type>(ja[static_cast<size_type>(k)]);
+                        size_type p = position[j / c];
+                        m_values[(p * r + i - I * r) * c + j % c] += a[static_cast<size_type>(k)];
+                    }
+                }
+            }
+        }
+    }
+
+    template <class T>
+    inline auto xsparse_bcsr<T>::shape() const noexcept -> shape_type
+    {
+        return m_shape;
+    }
+
+    /**
+     * Returns the number of nonzeros of the matrix, the zeros of the blocks
+     * excluded.
+     */
+    template <class T>
+    inline auto xsparse_bcsr<T>::nnz() const noexcept -> size_type
+    {
+        return m_nnz;
+    }
+
+    /**
+     * Returns the number of stored elements, blocks() * block_rows() *
+     * block_cols().
+     */
+    template <class T>
+    inline auto xsparse_bcsr<T>::stored() const noexcept -> size_type
+    {
+        return m_values.size();
+    }
+
+    template <class T>
+    inline auto xsparse_bcsr<T>::blocks() const noexcept -> size_type
+    {
+        return m_indices.size();
+    }
+
+    template <class T>
+    inline auto xsparse_bcsr<T>::block_rows() const noexcept -> size_type
+    {
+        return m_r;
+    }
+
+    template <class T>
+    inline auto xsparse_bcsr<T>::block_cols() const noexcept -> size_type
+    {
+        return m_c;
+    }
+
+    template <class T>
+    inline auto xsparse_bcsr<T>::block_row_offsets() const noexcept -> const index_storage&
+    {
+        return m_offsets;
+    }
+
+    template <class T>
+    inline auto xsparse_bcsr<T>::block_column_indices() const noexcept -> const index_storage&
+    {
+        return m_indices;
+    }
+
+    template <class T>
+    inline auto xsparse_bcsr<T>::values() const noexcept -> const value_storage&
+    {
+        return m_values;
+    }
+
+    /**
+     * y = A x for contiguous vectors, as the Krylov solvers apply their
+     * operators.
+     */
+    template <class T>
+    template <class V>
+    inline void xsparse_bcsr<T>::apply(const V& x, V& y) const
+    {
+        linalg::detail::bcsr_mm(*this, x.data(), m_shape[1], y.data(), m_shape[0], 1);
+    }
+
+    /********************************
+     * xsparse_tuned implementation *
+     ********************************/
+
+    /**
+     * Analyzes \em A with analyze_spmv and keeps it in the chosen format.
+     * @param measure time the products of the candidates instead of
+     *        comparing their modelled memory traffic
+     */
+    template <class T>
+    inline xsparse_tuned<T>::xsparse_tuned(const xsparse_csr<T>& A, bool measure)
+        : xsparse_tuned(A, linalg::analyze_spmv(A, measure))
+    {
+    }
+
+    /**
+     * Keeps \em A in the format of a previous \em analysis, e.g. of a matrix
+     * of the same structure.
+     */
+    template <class T>
+    inline xsparse_tuned<T>::xsparse_tuned(const xsparse_csr<T>& A, const linalg::spmv_analysis& analysis)
+        : m_analysis(analysis)
+    {
+        switch (analysis.format)
+        {
+            case linalg::sparse_format::sell:
+                m_sell = xsparse_sell<T>(A, analysis.chunk_height, analysis.sigma);
+                break;
+            case linalg::sparse_format::bcsr:
+                m_bcsr = xsparse_bcsr<T>(A, analysis.block_size, analysis.block_size);
+                break;
+            default:
+                m_csr = A;
+                break;
+        }
+    }
+
+    template <class T>
+    inline auto xsparse_tuned<T>::shape() const noexcept -> shape_type
+    {
+        switch (m_analysis.format)
+        {
+            case linalg::sparse_format::sell:
+                return m_sell.shape();
+            case linalg::sparse_format::bcsr:
+                return m_bcsr.shape();
+            default:
+                return m_csr.shape();
+        }
+    }
+
+    template <class T>
+    inline auto xsparse_tuned<T>::nnz() const noexcept -> size_type
+    {
+        switch (m_analysis.format)
+        {
+            case linalg::sparse_format::sell:
+                return m_sell.nnz();
+            case linalg::sparse_format::bcsr:
+                return m_bcsr.nnz();
+            default:
+                return m_csr.nnz();
+        }
+    }
+
+    template <class T>
+    inline linalg::sparse_format xsparse_tuned<T>::format() const noexcept
+    {
+        return m_analysis.format;
+    }
+
+    template <class T>
+    inline auto xsparse_tuned<T>::analysis() const noexcept -> const linalg::spmv_analysis&
+    {
+        return m_analysis;
+    }
+
+    /// The matrix, empty unless format() is sparse_format::csr
+    template <class T>
+    inline auto xsparse_tuned<T>::csr() const noexcept -> const xsparse_csr<T>&
+    {
+        return m_csr;
+    }
+
+    /// The matrix, empty unless format() is sparse_format::sell
+    template <class T>
+    inline auto xsparse_tuned<T>::sell() const noexcept -> const xsparse_sell<T>&
+    {
+        return m_sell;
+    }
+
+    /// The matrix, empty unless format() is sparse_format::bcsr
+    template <class T>
+    inline auto xsparse_tuned<T>::bcsr() const noexcept -> const xsparse_bcsr<T>&
+    {
+        return m_bcsr;
+    }
+
+    /**
+     * y = A x for contiguous vectors, as the Krylov solvers apply their
+     * operators.
+     */
+    template <class T>
+    template <class V>
+    inline void xsparse_tuned<T>::apply(const V& x, V& y) const
+    {
+        switch (m_analysis.format)
+        {
+            case linalg::sparse_format::sell:
+                m_sell.apply(x, y);
+                break;
+            case linalg::sparse_format::bcsr:
+                m_bcsr.apply(x, y);
+                break;
+            default:
+                linalg::detail::csr_mv(m_csr, x.data(), y.data());
+                break;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,610 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XSPARSE_IO_HPP
+#define XSPARSE_IO_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlinalg_io.hpp"
+#include "xtensor-blas/xsparse.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+    namespace detail
+    {
+        /**
+         * Header of a binary CSR file, in the byte order of the machine that
+         * wrote it. The row offsets, column indices and values follow in
+         * three sections at offsets that are multiples of io_alignment.
+         */
+        struct sparse_file_header
+        {
+            char magic[8];
+            std::uint32_t byte_order;
+            std::uint32_t version;
+            std::uint32_t value_type;
+            std::uint32_t index_bytes;
+            std::uint64_t rows;
+            std::uint64_t cols;
+            std::uint64_t nnz;
+            std::uint64_t offset[3];
+            std::uint64_t bytes[3];
+            char padding[160];
+        };
+
+        static_assert(sizeof(sparse_file_header) == 256, "sparse_file_header must have 256 bytes.");
+
+        constexpr char sparse_magic[8] = {'X', 'B', 'L', 'A', 'S', 'C', 'S', 'R'};
+
+        /// Smallest chunk of a Matrix Market file given to a parsing thread
+        constexpr std::size_t mm_chunk_bytes = std::size_t(1) << 16;
+
+        /**
+         * Runs f(t) for t in [0, threads), with OpenMP when XTENSOR_USE_OPENMP
+         * is defined and std::thread otherwise. \em f must not throw.
+         */
+        template <class F>
+        inline void run_parallel(std::size_t threads, F&& f)
+        {
+            if (threads <= 1)
+            {
+                f(std::size_t(0));
+                return;
+            }
+#if defined(XTENSOR_USE_OPENMP)
+            #pragma omp parallel for schedule(static) num_threads(static_cast<int>(threads))
+            for (std::ptrdiff_t t = 0; t < static_cast<std::ptrdiff_t>(threads); ++t)
+            {
+                f(static_cast<std::size_t>(t));
+            }
+#else
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+            for (std::size_t t = 1; t < threads; ++t)
+            {
+                workers.emplace_back([&f, t]() { f(t); });
+            }
+            f(std::size_t(0));
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+#endif
+        }
+
+        inline std::size_t io_threads(std::size_t threads)
+        {
+            return threads == 0 ? std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1)) : threads;
+        }
+
+        /// memcpy of \em bytes split between \em threads, which fault the pages of a mapping in parallel
+        inline void parallel_copy(void* dst, const void* src, std::size_t bytes, std::size_t threads)
+        {
+            threads = std::max(std::min(threads, bytes / mm_chunk_bytes), std::size_t(1));
+            run_parallel(threads, [=](std::size_t t) {
+                std::size_t first = bytes * t / threads;
+                std::size_t last = bytes * (t + 1) / threads;
+                std::memcpy(static_cast<char*>(dst) + first, static_cast<const char*>(src) + first, last - first);
+            });
+        }
+
+        /**
+         * Boundaries of \em parts blocks of rows holding about the same number
+         * of entries, given the row offsets \em start.
+         */
+        inline std::vector<std::size_t> balanced_rows(const std::vector<std::size_t>& start, std::size_t parts)
+        {
+            std::size_t m = start.size() - 1;
+            std::vector<std::size_t> bounds(parts + 1, m);
+            bounds[0] = 0;
+            for (std::size_t p = 1; p < parts; ++p)
+            {
+                std::size_t target = start.back() * p / parts;
+                bounds[p] = static_cast<std::size_t>(std::upper_bound(start.begin(), start.end() - 1, target) - start.begin());
+                bounds[p] = std::max(bounds[p], bounds[p - 1]);
+            }
+            return bounds;
+        }
+
+        /*******************************
+         * Matrix Market entry parsing *
+         *******************************/
+
+        inline bool mm_blank(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        inline bool parse_mm_index(const char*& p, const char* end, std::uint64_t& v)
+        {
+            while (p < end && mm_blank(*p))
+            {
+                ++p;
+            }
+            const char* first = p;
+            v = 0;
+            while (p < end && *p >= '0' && *p <= '9')
+            {
+                v = v * 10 + static_cast<std::uint64_t>(*p - '0');
+                ++p;
+            }
+            return p != first;
+        }
+
+        // The mapping is not null terminated: a token is copied before strtod reads it.
+        inline bool parse_mm_real(const char*& p, const char* end, double& v)
+        {
+            while (p < end && mm_blank(*p))
+            {
+                ++p;
+            }
+            char token[64];
+            std::size_t n = 0;
+            while (p + n < end && n + 1 < sizeof(token) && !mm_blank(p[n]) && p[n] != '\n')
+            {
+                token[n] = p[n];
+                ++n;
+            }
+            token[n] = '\0';
+            char* stop = nullptr;
+            v = std::strtod(token, &stop);
+            p += n;
+            return n != 0 && stop == token + n;
+        }
+
+        template <class T>
+        inline T mm_complex_value(double re, double /*im*/, std::false_type)
+        {
+            return static_cast<T>(re);
+        }
+
+        template <class T>
+        inline T mm_complex_value(double re, double im, std::true_type)
+        {
+            using real_type = typename T::value_type;
+            return T(static_cast<real_type>(re), static_cast<real_type>(im));
+        }
+
+        /// Banner and size line of a coordinate Matrix Market file
+        struct mm_coordinate_info
+        {
+            std::size_t rows = 0;
+            std::size_t cols = 0;
+            std::size_t entries = 0;
+            bool pattern = false;
+            bool complex_field = false;
+            bool general = true;
+            bool skew = false;
+            bool hermitian = false;
+            std::size_t body = 0;
+        };
+
+        inline mm_coordinate_info parse_mm_coordinate_header(const char* data, std::size_t size, const std::string& path)
+        {
+            if (size == 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "load_matrix_market_sparse: " + path + " is empty.");
+            }
+            const char* end = data + size;
+            const char* eol = static_cast<const char*>(std::memchr(data, '\n', size));
+            eol = eol == nullptr ? end : eol;
+            std::istringstream banner_line(std::string(data, eol));
+            std::string banner, object, format, field, symmetry;
+            banner_line >> banner >> object >> format >> field >> symmetry;
+            auto lower = [](std::string str) {
+                std::transform(str.begin(), str.end(), str.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+                return str;
+            };
+            field = lower(field);
+            symmetry = lower(symmetry);
+            if (banner != "%%MatrixMarket" || lower(object) != "matrix" || lower(format) != "coordinate")
+            {
+                XTENSOR_THROW(std::runtime_error, "load_matrix_market_sparse: " + path + " is not a coordinate Matrix Market matrix.");
+            }
+
+            mm_coordinate_info info;
+            info.pattern = field == "pattern";
+            info.complex_field = field == "complex";
+            info.general = symmetry == "general";
+            info.skew = symmetry == "skew-symmetric";
+            info.hermitian = symmetry == "hermitian";
+
+            // comment and blank lines precede the size line
+            const char* p = eol;
+            while (p < end)
+            {
+                p = *p == '\n' ? p + 1 : p;
+                const char* line_end = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+                line_end = line_end == nullptr ? end : line_end;
+                const char* q = p;
+                while (q < line_end && mm_blank(*q))
+                {
+                    ++q;
+                }
+                if (q != line_end && *q != '%')
+                {
+                    std::uint64_t m = 0, n = 0, nnz = 0;
+                    if (!parse_mm_index(q, line_end, m) || !parse_mm_index(q, line_end, n) || !parse_mm_index(q, line_end, nnz))
+                    {
+                        break;
+                    }
+                    info.rows = static_cast<std::size_t>(m);
+                    info.cols = static_cast<std::size_t>(n);
+                    info.entries = static_cast<std::size_t>(nnz);
+                    info.body = static_cast<std::size_t>(std::min(line_end + 1, end) - data);
+                    if (!info.general && info.rows != info.cols)
+                    {
+                        XTENSOR_THROW(std::runtime_error, "load_matrix_market_sparse: a symmetric matrix must be square.");
+                    }
+                    return info;
+                }
+                p = line_end;
+            }
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_sparse: " + path + " has no size line.");
+        }
+
+        /// Entries parsed by one thread, with the mirrored entries of a symmetric file
+        template <class T>
+        struct mm_chunk
+        {
+            std::vector<blas_index_t> rows;
+            std::vector<blas_index_t> cols;
+            std::vector<T> values;
+            std::size_t lines = 0;
+            std::string error;
+        };
+
+        template <class T>
+        inline void parse_mm_chunk(const char* first, const char* last, const mm_coordinate_info& info, mm_chunk<T>& chunk)
+        {
+            const char* p = first;
+            while (p < last)
+            {
+                const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(last - p)));
+                eol = eol == nullptr ? last : eol;
+                const char* q = p;
+                p = eol + (eol < last ? 1 : 0);
+                while (q < eol && mm_blank(*q))
+                {
+                    ++q;
+                }
+                if (q == eol || *q == '%')
+                {
+                    continue;
+                }
+
+                const char* line = q;
+                std::uint64_t i = 0, j = 0;
+                double re = 1., im = 0.;
+                bool ok = parse_mm_index(q, eol, i) && parse_mm_index(q, eol, j);
+                if (ok && !info.pattern)
+                {
+                    ok = parse_mm_real(q, eol, re) && (!info.complex_field || parse_mm_real(q, eol, im));
+                }
+                if (!ok || i == 0 || j == 0 || i > info.rows || j > info.cols)
+                {
+                    chunk.error = "load_matrix_market_sparse: malformed or out of range entry \""
+                                  + std::string(line, eol) + "\".";
+                    return;
+                }
+                ++chunk.lines;
+
+                T v = mm_complex_value<T>(re, im, xtl::is_complex<T>());
+                auto r = static_cast<blas_index_t>(i - 1);
+                auto c = static_cast<blas_index_t>(j - 1);
+                chunk.rows.push_back(r);
+                chunk.cols.push_back(c);
+                chunk.values.push_back(v);
+                if (!info.general && r != c)
+                {
+                    chunk.rows.push_back(c);
+                    chunk.cols.push_back(r);
+                    chunk.values.push_back(info.skew ? T(-v) : (info.hermitian ? conj_value(v) : v));
+                }
+            }
+        }
+    }
+
+    /*****************************
+     * Matrix Market sparse file *
+     *****************************/
+
+    /**
+     * Read a coordinate Matrix Market file (``%%MatrixMarket matrix
+     * coordinate``) into a CSR matrix: real, integer, complex or pattern,
+     * general, symmetric, skew-symmetric or Hermitian, where both triangles
+     * are stored. Duplicated entries are summed, in the order of the file.
+     *
+     * The file is mapped and cut at line boundaries into chunks parsed by
+     * \em threads threads into their own COO buffers, which a counting sort
+     * by rows merges into the CSR arrays: each thread counts its entries per
+     * row, the counts give every thread its slot within each row, and the
+     * threads scatter their entries without synchronization. The result
+     * does not depend on the number of threads.
+     *
+     * @param threads number of threads, 0 for std::thread::hardware_concurrency.
+     *        Fewer are used on small files, and on files with few entries
+     *        per row, as the per-thread row counts would outgrow the entries.
+     */
+    template <class T>
+    xsparse_csr<T> load_matrix_market_sparse(const std::string& path, std::size_t threads = 0)
+    {
+        using index_type = blas_index_t;
+        using value_storage = typename xsparse_csr<T>::value_storage;
+        using index_storage = typename xsparse_csr<T>::index_storage;
+
+        detail::file_mapping file(path, mapping_mode::read);
+        const char* data = file.data();
+        detail::mm_coordinate_info info = detail::parse_mm_coordinate_header(data, file.size(), path);
+        if (info.complex_field && !xtl::is_complex<T>::value)
+        {
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_sparse: " + path + " holds complex values.");
+        }
+        if (info.rows > static_cast<std::size_t>(std::numeric_limits<index_type>::max())
+            || info.cols > static_cast<std::size_t>(std::numeric_limits<index_type>::max()))
+        {
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_sparse: the matrix is too large for blas_index_t.");
+        }
+
+        std::size_t m = info.rows;
+        const char* body = data + info.body;
+        std::size_t body_bytes = file.size() - info.body;
+        std::size_t stored = info.general ? info.entries : 2 * info.entries;
+        std::size_t parts = detail::io_threads(threads);
+        parts = std::min(parts, std::max(body_bytes / detail::mm_chunk_bytes, std::size_t(1)));
+        parts = std::min(parts, std::max(2 * stored / std::max(m, std::size_t(1)), std::size_t(1)));
+
+        // chunks start after a newline, so that no line is cut
+        std::vector<const char*> bounds(parts + 1, body + body_bytes);
+        bounds[0] = body;
+        for (std::size_t t = 1; t < parts; ++t)
+        {
+            const char* b = std::max(body + body_bytes * t / parts, bounds[t - 1]);
+            const char* eol = static_cast<const char*>(std::memchr(b, '\n', static_cast<std::size_t>(body + body_bytes - b)));
+            bounds[t] = eol == nullptr ? body + body_bytes : eol + 1;
+        }
+
+        std::vector<detail::mm_chunk<T>> chunks(parts);
+        std::vector<std::vector<std::size_t>> counts(parts);
+        detail::run_parallel(parts, [&](std::size_t t) {
+            auto& chunk = chunks[t];
+            std::size_t reserve = static_cast<std::size_t>(static_cast<double>(stored)
+                                  * static_cast<double>(bounds[t + 1] - bounds[t]) / static_cast<double>(std::max(body_bytes, std::size_t(1))));
+            chunk.rows.reserve(reserve + 16);
+            chunk.cols.reserve(reserve + 16);
+            chunk.values.reserve(reserve + 16);
+            detail::parse_mm_chunk(bounds[t], bounds[t + 1], info, chunk);
+            counts[t].assign(m, 0);
+            for (auto r : chunk.rows)
+            {
+                ++counts[t][static_cast<std::size_t>(r)];
+            }
+        });
+
+        std::size_t lines = 0;
+        for (const auto& chunk : chunks)
+        {
+            if (!chunk.error.empty())
+            {
+                XTENSOR_THROW(std::runtime_error, chunk.error);
+            }
+            lines += chunk.lines;
+        }
+        if (lines != info.entries)
+        {
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_sparse: " + path + " does not hold the number of entries of its size line.");
+        }
+
+        // the slot of thread t in row r follows those of threads 0 to t - 1
+        std::vector<std::size_t> start(m + 1, 0);
+        detail::run_parallel(parts, [&](std::size_t p) {
+            for (std::size_t r = m * p / parts; r < m * (p + 1) / parts; ++r)
+            {
+                std::size_t sum = 0;
+                for (std::size_t t = 0; t < parts; ++t)
+                {
+                    std::size_t c = counts[t][r];
+                    counts[t][r] = sum;
+                    sum += c;
+                }
+                start[r + 1] = sum;
+            }
+        });
+        for (std::size_t r = 0; r < m; ++r)
+        {
+            start[r + 1] += start[r];
+        }
+
+        std::vector<std::pair<index_type, T>> entries(start[m]);
+        detail::run_parallel(parts, [&](std::size_t t) {
+            auto& chunk = chunks[t];
+            auto& next = counts[t];
+            for (std::size_t k = 0; k < chunk.rows.size(); ++k)
+            {
+                std::size_t r = static_cast<std::size_t>(chunk.rows[k]);
+                entries[start[r] + next[r]++] = std::make_pair(chunk.cols[k], chunk.values[k]);
+            }
+            chunk = detail::mm_chunk<T>();
+            std::vector<std::size_t>().swap(next);
+        });
+
+        // rows are sorted by columns and their duplicates summed in place
+        std::vector<std::size_t> row_bounds = detail::balanced_rows(start, parts);
+        std::vector<std::size_t> unique(m, 0);
+        detail::run_parallel(parts, [&](std::size_t p) {
+            for (std::size_t r = row_bounds[p]; r < row_bounds[p + 1]; ++r)
+            {
+                auto first = entries.begin() + static_cast<std::ptrdiff_t>(start[r]);
+                auto last = entries.begin() + static_cast<std::ptrdiff_t>(start[r + 1]);
+                std::stable_sort(first, last, [](const auto& a, const auto& b) { return a.first < b.first; });
+                auto out = first;
+                for (auto it = first; it != last; ++it)
+                {
+                    if (it != first && it->first == std::prev(out)->first)
+                    {
+                        std::prev(out)->second += it->second;
+                    }
+                    else
+                    {
+                        *out++ = *it;
+                    }
+                }
+                unique[r] = static_cast<std::size_t>(out - first);
+            }
+        });
+
+        index_storage offsets(m + 1);
+        offsets[0] = 0;
+        for (std::size_t r = 0; r < m; ++r)
+        {
+            offsets[r + 1] = offsets[r] + static_cast<index_type>(unique[r]);
+        }
+        std::size_t nnz = static_cast<std::size_t>(offsets[m]);
+        if (nnz > static_cast<std::size_t>(std::numeric_limits<index_type>::max()))
+        {
+            XTENSOR_THROW(std::runtime_error, "load_matrix_market_sparse: the matrix has too many nonzeros for blas_index_t.");
+        }
+        value_storage values(nnz);
+        index_storage indices(nnz);
+        detail::run_parallel(parts, [&](std::size_t p) {
+            for (std::size_t r = row_bounds[p]; r < row_bounds[p + 1]; ++r)
+            {
+                std::size_t out = static_cast<std::size_t>(offsets[r]);
+                for (std::size_t k = 0; k < unique[r]; ++k)
+                {
+                    indices[out + k] = entries[start[r] + k].first;
+                    values[out + k] = entries[start[r] + k].second;
+                }
+            }
+        });
+        return xsparse_csr<T>(m, info.cols, std::move(values), std::move(offsets), std::move(indices));
+    }
+
+    /********************
+     * binary CSR files *
+     ********************/
+
+    /**
+     * Save the CSR matrix \em A as a binary file read back by load_csr: a
+     * 256 byte header followed by the row offsets, the column indices and
+     * the values, each starting on a page boundary. The file uses the byte
+     * order and blas_index_t of the machine that writes it.
+     */
+    template <class T>
+    void save_csr(const std::string& path, const xsparse_csr<T>& A)
+    {
+        detail::sparse_file_header h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, detail::sparse_magic, sizeof(detail::sparse_magic));
+        h.byte_order = detail::io_byte_order;
+        h.version = detail::io_version;
+        h.value_type = detail::io_type_code<T>::value;
+        h.index_bytes = sizeof(blas_index_t);
+        h.rows = A.shape()[0];
+        h.cols = A.shape()[1];
+        h.nnz = A.nnz();
+        h.bytes[0] = (h.rows + 1) * sizeof(blas_index_t);
+        h.bytes[1] = h.nnz * sizeof(blas_index_t);
+        h.bytes[2] = h.nnz * sizeof(T);
+        h.offset[0] = detail::io_align(sizeof(h));
+        h.offset[1] = detail::io_align(h.offset[0] + h.bytes[0]);
+        h.offset[2] = detail::io_align(h.offset[1] + h.bytes[1]);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            XTENSOR_THROW(std::runtime_error, "save_csr: cannot open " + path + ".");
+        }
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        detail::write_section(out, h.offset[0], A.row_offsets().data(), h.bytes[0]);
+        detail::write_section(out, h.offset[1], A.column_indices().data(), h.bytes[1]);
+        detail::write_section(out, h.offset[2], A.values().data(), h.bytes[2]);
+        if (!out)
+        {
+            XTENSOR_THROW(std::runtime_error, "save_csr: cannot write " + path + ".");
+        }
+    }
+
+    /**
+     * Load a CSR matrix saved by save_csr. The file is mapped and its three
+     * arrays are copied by \em threads threads straight into the storage of
+     * the matrix, so that no text is parsed and no entry is sorted; the
+     * arrays are only checked for consistency.
+     * @param threads number of threads, 0 for std::thread::hardware_concurrency
+     */
+    template <class T>
+    xsparse_csr<T> load_csr(const std::string& path, std::size_t threads = 0)
+    {
+        using value_storage = typename xsparse_csr<T>::value_storage;
+        using index_storage = typename xsparse_csr<T>::index_storage;
+
+        detail::file_mapping file(path, mapping_mode::read);
+        detail::sparse_file_header h;
+        if (file.size() < sizeof(h))
+        {
+            XTENSOR_THROW(std::runtime_error, "load_csr: " + path + " is not a CSR file.");
+        }
+        std::memcpy(&h, file.data(), sizeof(h));
+        if (std::memcmp(h.magic, detail::sparse_magic, sizeof(detail::sparse_magic)) != 0 || h.version != detail::io_version)
+        {
+            XTENSOR_THROW(std::runtime_error, "load_csr: " + path + " is not a CSR file.");
+        }
+        if (h.byte_order != detail::io_byte_order)
+        {
+            XTENSOR_THROW(std::runtime_error, "load_csr: " + path + " was written with another byte order.");
+        }
+        if (h.value_type != detail::io_type_code<T>::value || h.index_bytes != sizeof(blas_index_t))
+        {
+            XTENSOR_THROW(std::runtime_error, "load_csr: " + path + " holds another value or index type.");
+        }
+        if (h.bytes[0] != (h.rows + 1) * sizeof(blas_index_t) || h.bytes[1] != h.nnz * sizeof(blas_index_t)
+            || h.bytes[2] != h.nnz * sizeof(T))
+        {
+            XTENSOR_THROW(std::runtime_error, "load_csr: " + path + " is corrupted.");
+        }
+        for (std::size_t s = 0; s < 3; ++s)
+        {
+            if (h.offset[s] + h.bytes[s] > file.size())
+            {
+                XTENSOR_THROW(std::runtime_error, "load_csr: " + path + " is truncated.");
+            }
+        }
+
+        threads = detail::io_threads(threads);
+        index_storage offsets(static_cast<std::size_t>(h.rows + 1));
+        index_storage indices(static_cast<std::size_t>(h.nnz));
+        value_storage values(static_cast<std::size_t>(h.nnz));
+        detail::parallel_copy(offsets.data(), file.data() + h.offset[0], h.bytes[0], threads);
+        detail::parallel_copy(indices.data(), file.data() + h.offset[1], h.bytes[1], threads);
+        detail::parallel_copy(values.data(), file.data() + h.offset[2], h.bytes[2], threads);
+        return xsparse_csr<T>(static_cast<std::size_t>(h.rows), static_cast<std::size_t>(h.cols),
+                              std::move(values), std::move(offsets), std::move(indices));
+    }
+}
+}
+
+#endif
@@ -0,0 +1,1535 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#ifndef XSTRUCTURED_HPP
+#define XSTRUCTURED_HPP
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xarray.hpp"
+#include "xtensor/xstorage.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+    /*************
+     * xdiagonal *
+     *************/
+
+    /**
+     * n by n diagonal matrix, storing its diagonal only.
+     *
+     * Like xbanded, it is not an xexpression: linalg::dot, solve, inv and
+     * det have overloads taking it, in O(n) per column instead of the
+     * O(n^2) or O(n^3) of the expanded matrix, and dense() expands it.
+     */
+    template <class T>
+    class xdiagonal
+    {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+        using storage_type = xtensor<value_type, 1>;
+
+        xdiagonal() = default;
+        explicit xdiagonal(size_type n, const value_type& value = value_type(1));
+
+        template <class E>
+        explicit xdiagonal(const xexpression<E>& d);
+
+        shape_type shape() const noexcept;
+        size_type dimension() const noexcept;
+        value_type operator()(size_type i, size_type j) const;
+
+        storage_type& diagonal() noexcept;
+        const storage_type& diagonal() const noexcept;
+
+        xtensor<value_type, 2, layout_type::column_major> dense() const;
+
+    private:
+
+        storage_type m_diagonal;
+    };
+
+    /*******************
+     * xblock_diagonal *
+     *******************/
+
+    /**
+     * Block diagonal matrix: dense blocks along the diagonal, zero elsewhere.
+     * The blocks are stored column major and need not be square, though
+     * solve, inv and det require square blocks.
+     *
+     * Products apply one gemm per block, solves factorize each block on its
+     * own: O(sum n_i^3) instead of O((sum n_i)^3).
+     */
+    template <class T>
+    class xblock_diagonal
+    {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+        using block_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        xblock_diagonal() = default;
+        explicit xblock_diagonal(std::vector<block_type> blocks);
+
+        template <class E>
+        void push_back(const xexpression<E>& block);
+
+        shape_type shape() const noexcept;
+        size_type dimension() const noexcept;
+        value_type operator()(size_type i, size_type j) const;
+
+        size_type block_count() const noexcept;
+        const block_type& block(size_type k) const;
+        block_type& block(size_type k);
+        size_type row_offset(size_type k) const;
+        size_type column_offset(size_type k) const;
+        bool square_blocks() const noexcept;
+
+        xtensor<value_type, 2, layout_type::column_major> dense() const;
+
+    private:
+
+        std::vector<block_type> m_blocks;
+        std::vector<size_type> m_row_offsets = {0};
+        std::vector<size_type> m_column_offsets = {0};
+    };
+
+    /****************
+     * xpermutation *
+     ****************/
+
+    /**
+     * n by n permutation matrix P, with (P x)(i) = x(perm[i]), i.e. a one
+     * at (i, perm[i]).
+     *
+     * The permutation is kept as the row interchanges of LAPACK, so that
+     * products with P and P^T are one laswp call over all the columns,
+     * without forming P.
+     */
+    class xpermutation
+    {
+    public:
+
+        using size_type = std::size_t;
+        using shape_type = std::array<size_type, 2>;
+        using value_type = int;
+
+        xpermutation() = default;
+        explicit xpermutation(size_type n);
+
+        template <class E>
+        explicit xpermutation(const xexpression<E>& perm);
+
+        template <class P>
+        static xpermutation from_pivots(const P& pivots);
+
+        shape_type shape() const noexcept;
+        size_type dimension() const noexcept;
+        value_type operator()(size_type i, size_type j) const;
+
+        const std::vector<size_type>& indices() const noexcept;
+        const uvector<blas_index_t>& pivots() const noexcept;
+        int sign() const noexcept;
+
+        xpermutation transpose() const;
+
+        xtensor<double, 2, layout_type::column_major> dense() const;
+
+    private:
+
+        void compute_pivots();
+
+        std::vector<size_type> m_perm;
+        uvector<blas_index_t> m_piv;
+    };
+
+    /****************************
+     * xdiagonal implementation *
+     ****************************/
+
+    /**
+     * Builds the n by n diagonal matrix with every diagonal element set to
+     * \em value.
+     */
+    template <class T>
+    inline xdiagonal<T>::xdiagonal(size_type n, const value_type& value)
+        : m_diagonal(std::array<size_type, 1>{n}, value)
+    {
+    }
+
+    /**
+     * Builds the diagonal matrix with diagonal \em d.
+     */
+    template <class T>
+    template <class E>
+    inline xdiagonal<T>::xdiagonal(const xexpression<E>& d)
+    {
+        if (d.derived_cast().dimension() != 1)
+        {
+            XTENSOR_THROW(std::runtime_error, "xdiagonal: the diagonal must be a vector.");
+        }
+        m_diagonal = d.derived_cast();
+    }
+
+    template <class T>
+    inline auto xdiagonal<T>::shape() const noexcept -> shape_type
+    {
+        return {m_diagonal.size(), m_diagonal.size()};
+    }
+
+    template <class T>
+    inline auto xdiagonal<T>::dimension() const noexcept -> size_type
+    {
+        return 2;
+    }
+
+    template <class T>
+    inline auto xdiagonal<T>::operator()(size_type i, size_type j) const -> value_type
+    {
+        return i == j ? m_diagonal(i) : value_type(0);
+    }
+
+    template <class T>
+    inline auto xdiagonal<T>::diagonal() noexcept -> storage_type&
+    {
+        return m_diagonal;
+    }
+
+    template <class T>
+    inline auto xdiagonal<T>::diagonal() const noexcept -> const storage_type&
+    {
+        return m_diagonal;
+    }
+
+    /**
+     * Returns the full matrix as a column major xtensor.
+     */
+    template <class T>
+    inline auto xdiagonal<T>::dense() const -> xtensor<value_type, 2, layout_type::column_major>
+    {
+        xtensor<value_type, 2, layout_type::column_major> result(shape(), value_type(0));
+        for (size_type i = 0; i < m_diagonal.size(); ++i)
+        {
+            result(i, i) = m_diagonal(i);
+        }
+        return result;
+    }
+
+    /**********************************
+     * xblock_diagonal implementation *
+     **********************************/
+
+    /**
+     * Builds the block diagonal matrix with the blocks \em blocks, from the
+     * top left corner.
+     */
+    template <class T>
+    inline xblock_diagonal<T>::xblock_diagonal(std::vector<block_type> blocks)
+    {
+        m_blocks.reserve(blocks.size());
+        for (auto& b : blocks)
+        {
+            m_blocks.push_back(std::move(b));
+            m_row_offsets.push_back(m_row_offsets.back() + m_blocks.back().shape()[0]);
+            m_column_offsets.push_back(m_column_offsets.back() + m_blocks.back().shape()[1]);
+        }
+    }
+
+    /**
+     * Appends the matrix \em block below and to the right of the last block.
+     */
+    template <class T>
+    template <class E>
+    inline void xblock_diagonal<T>::push_back(const xexpression<E>& block)
+    {
+        if (block.derived_cast().dimension() != 2)
+        {
+            XTENSOR_THROW(std::runtime_error, "xblock_diagonal: a block must be a matrix.");
+        }
+        m_blocks.emplace_back(block.derived_cast());
+        m_row_offsets.push_back(m_row_offsets.back() + m_blocks.back().shape()[0]);
+        m_column_offsets.push_back(m_column_offsets.back() + m_blocks.back().shape()[1]);
+    }
+
+    template <class T>
+    inline auto xblock_diagonal<T>::shape() const noexcept -> shape_type
+    {
+        return {m_row_offsets.back(), m_column_offsets.back()};
+    }
+
+    template <class T>
+    inline auto xblock_diagonal<T>::dimension() const noexcept -> size_type
+    {
+        return 2;
+    }
+
+    template <class T>
+    inline auto xblock_diagonal<T>::operator()(size_type i, size_type j) const -> value_type
+    {
+        auto it = std::upper_bound(m_row_offsets.begin(), m_row_offsets.end(), i);
+        size_type k = static_cast<size_type>(it - m_row_offsets.begin()) - 1;
+        if (k >= m_blocks.size() || j < m_column_offsets[k] || j >= m_column_offsets[k + 1])
+        {
+            return value_type(0);
+        }
+        return m_blocks[k](i - m_row_offsets[k], j - m_column_offsets[k]);
+    }
+
+    template <class T>
+    inline auto xblock_diagonal<T>::block_count() const noexcept -> size_type
+    {
+        return m_blocks.size();
+    }
+
+    template <class T>
+    inline auto xblock_diagonal<T>::block(size_type k) const -> const block_type&
+    {
+        return m_blocks[k];
+    }
+
+    template <class T>
+    inline auto xblock_diagonal<T>::block(size_type k) -> block_type&
+    {
+        return m_blocks[k];
+    }
+
+    /**
+     * Index of the first row of the block \em k.
+     */
+    template <class T>
+    inline auto xblock_diagonal<T>::row_offset(size_type k) const -> size_type
+    {
+        return m_row_offsets[k];
+    }
+
+    /**
+     * Index of the first column of the block \em k.
+     */
+    template <class T>
+    inline auto xblock_diagonal<T>::column_offset(size_type k) const -> size_type
+    {
+        return m_column_offsets[k];
+    }
+
+    template <class T>
+    inline bool xblock_diagonal<T>::square_blocks() const noexcept
+    {
+        return std::all_of(m_blocks.begin(), m_blocks.end(),
+                           [](const block_type& b) { return b.shape()[0] == b.shape()[1]; });
+    }
+
+    /**
+     * Returns the full matrix as a column major xtensor.
+     */
+    template <class T>
+    inline auto xblock_diagonal<T>::dense() const -> xtensor<value_type, 2, layout_type::column_major>
+    {
+        xtensor<value_type, 2, layout_type::column_major> result(shape(), value_type(0));
+        for (size_type k = 0; k < m_blocks.size(); ++k)
+        {
+            const auto& b = m_blocks[k];
+            for (size_type j = 0; j < b.shape()[1]; ++j)
+            {
+                for (size_type i = 0; i < b.shape()[0]; ++i)
+                {
+                    result(m_row_offsets[k] + i, m_column_offsets[k] + j) = b(i, j);
+                }
+            }
+        }
+        return result;
+    }
+
+    /*******************************
+     * xpermutation implementation *
+     *******************************/
+
+    /**
+     * Builds the n by n identity permutation.
+     */
+    inline xpermutation::xpermutation(size_type n)
+        : m_perm(n)
+    {
+        std::iota(m_perm.begin(), m_perm.end(), size_type(0));
+        compute_pivots();
+    }
+
+    /**
+     * Builds the permutation matrix P with (P x)(i) = x(perm[i]).
+     * @param perm vector holding each of 0 .. n - 1 once
+     */
+    template <class E>
+    inline xpermutation::xpermutation(const xexpression<E>& perm)
+    {
+        const auto& p = perm.derived_cast();
+        if (p.dimension() != 1)
+        {
+            XTENSOR_THROW(std::runtime_error, "xpermutation: the indices must be a vector.");
+        }
+        size_type n = p.size();
+        std::vector<bool> seen(n, false);
+        m_perm.reserve(n);
+        for (auto v : p)
+        {
+            if (static_cast<std::ptrdiff_t>(v) < 0 || static_cast<size_type>(v) >= n || seen[static_cast<size_type>(v)])
+            {
+                XTENSOR_THROW(std::runtime_error, "xpermutation: the indices are not a permutation.");
+            }
+            seen[static_cast<size_type>(v)] = true;
+            m_perm.push_back(static_cast<size_type>(v));
+        }
+        compute_pivots();
+    }
+
+    /**
+     * Builds the permutation P of the pivots returned by getrf, or by
+     * lu_factorization::pivots, for which P A = L U.
+     * @param pivots one based row interchanges
+     */
+    template <class P>
+    inline xpermutation xpermutation::from_pivots(const P& pivots)
+    {
+        size_type n = pivots.size();
+        xpermutation result(n);
+        for (size_type i = 0; i < n; ++i)
+        {
+            auto r = static_cast<size_type>(pivots[i]) - 1;
+            if (r < i || r >= n)
+            {
+                XTENSOR_THROW(std::runtime_error, "xpermutation: invalid pivots.");
+            }
+            std::swap(result.m_perm[i], result.m_perm[r]);
+            result.m_piv[i] = static_cast<blas_index_t>(pivots[i]);
+        }
+        return result;
+    }
+
+    // the interchanges putting perm[i] in row i, for i = 0 .. n - 1
+    inline void xpermutation::compute_pivots()
+    {
+        size_type n = m_perm.size();
+        std::vector<size_type> current(n), where(n);
+        std::iota(current.begin(), current.end(), size_type(0));
+        std::iota(where.begin(), where.end(), size_type(0));
+        m_piv.resize(n);
+        for (size_type i = 0; i < n; ++i)
+        {
+            size_type r = where[m_perm[i]];
+            m_piv[i] = to_blas_index(r + 1);
+            std::swap(current[i], current[r]);
+            where[current[i]] = i;
+            where[current[r]] = r;
+        }
+    }
+
+    inline auto xpermutation::shape() const noexcept -> shape_type
+    {
+        return {m_perm.size(), m_perm.size()};
+    }
+
+    inline auto xpermutation::dimension() const noexcept -> size_type
+    {
+        return 2;
+    }
+
+    inline auto xpermutation::operator()(size_type i, size_type j) const -> value_type
+    {
+        return m_perm[i] == j ? 1 : 0;
+    }
+
+    /**
+     * @return perm, with (P x)(i) = x(perm[i])
+     */
+    inline auto xpermutation::indices() const noexcept -> const std::vector<size_type>&
+    {
+        return m_perm;
+    }
+
+    /**
+     * @return one based row interchanges of P, as taken by laswp
+     */
+    inline auto xpermutation::pivots() const noexcept -> const uvector<blas_index_t>&
+    {
+        return m_piv;
+    }
+
+    /**
+     * @return det(P), 1 for an even and -1 for an odd permutation
+     */
+    inline int xpermutation::sign() const noexcept
+    {
+        int result = 1;
+        for (size_type i = 0; i < m_piv.size(); ++i)
+        {
+            if (static_cast<size_type>(m_piv[i]) != i + 1)
+            {
+                result = -result;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @return P^T, which is also the inverse of P
+     */
+    inline xpermutation xpermutation::transpose() const
+    {
+        std::vector<size_type> inverse(m_perm.size());
+        for (size_type i = 0; i < m_perm.size(); ++i)
+        {
+            inverse[m_perm[i]] = i;
+        }
+        xpermutation result;
+        result.m_perm = std::move(inverse);
+        result.compute_pivots();
+        return result;
+    }
+
+    /**
+     * Returns the full matrix as a column major xtensor.
+     */
+    inline auto xpermutation::dense() const -> xtensor<double, 2, layout_type::column_major>
+    {
+        xtensor<double, 2, layout_type::column_major> result(shape(), 0.);
+        for (size_type i = 0; i < m_perm.size(); ++i)
+        {
+            result(i, m_perm[i]) = 1.;
+        }
+        return result;
+    }
+
+namespace linalg
+{
+    namespace detail
+    {
+        template <class E>
+        inline void check_structured_rhs(const E& x, std::size_t n, const char* message)
+        {
+            if (x.dimension() < 1 || x.dimension() > 2 || x.shape()[0] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, message);
+            }
+        }
+
+        template <class E>
+        inline void check_structured_lhs(const E& x, std::size_t n)
+        {
+            if (x.dimension() != 2 || x.shape()[1] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, "Dot: shape mismatch.");
+            }
+        }
+
+        // C = A B with column major A (m by k), B (k by n) and C (m by n)
+        template <class T>
+        inline void structured_gemm(std::size_t m, std::size_t n, std::size_t k,
+                                    const T* A, std::size_t lda, const T* B, std::size_t ldb,
+                                    T* C, std::size_t ldc)
+        {
+            if (m == 0 || n == 0)
+            {
+                return;
+            }
+            if (k == 0)
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    std::fill(C + j * ldc, C + j * ldc + m, T(0));
+                }
+                return;
+            }
+            cxxblas::gemm<blas_index_t>(
+                cxxblas::StorageOrder::ColMajor,
+                cxxblas::Transpose::NoTrans,
+                cxxblas::Transpose::NoTrans,
+                to_blas_index(m), to_blas_index(n), to_blas_index(k),
+                T(1),
+                A, to_blas_index(std::max(lda, std::size_t(1))),
+                B, to_blas_index(std::max(ldb, std::size_t(1))),
+                T(0),
+                C, to_blas_index(std::max(ldc, std::size_t(1)))
+            );
+        }
+
+        template <class T>
+        inline void check_square_blocks(const xblock_diagonal<T>& A)
+        {
+            if (!A.square_blocks())
+            {
+                XTENSOR_THROW(std::runtime_error, "xblock_diagonal: the blocks are not square.");
+            }
+        }
+    }
+
+    /*********************
+     * diagonal matrices *
+     *********************/
+
+    /**
+     * Matrix product of the diagonal matrix \em A with the vector or matrix
+     * \em x: the rows of \em x scaled by the diagonal, in O(n) per column.
+     * @return the product, with the shape of \em x
+     */
+    template <class T, class E>
+    auto dot(const xdiagonal<T>& A, const xexpression<E>& x)
+    {
+        auto p = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        std::size_t n = A.shape()[0];
+        detail::check_structured_rhs(p, n, "Dot: shape mismatch.");
+        auto* data = p.data();
+        for (std::size_t j = 0; j < p.size(); ++j)
+        {
+            data[j] *= A.diagonal()(j % n);
+        }
+        return p;
+    }
+
+    /**
+     * Matrix product of the matrix \em x with the diagonal matrix \em A:
+     * the columns of \em x scaled by the diagonal.
+     * @return the product, with the shape of \em x
+     */
+    template <class E, class T>
+    auto dot(const xexpression<E>& x, const xdiagonal<T>& A)
+    {
+        auto p = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        detail::check_structured_lhs(p, A.shape()[0]);
+        std::size_t m = p.shape()[0];
+        auto* data = p.data();
+        for (std::size_t j = 0; j < p.shape()[1]; ++j)
+        {
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                data[j * m + i] *= A.diagonal()(j);
+            }
+        }
+        return p;
+    }
+
+    /**
+     * Solves A x = b for the diagonal matrix \em A, dividing the rows of
+     * \em b by the diagonal. Throws for a zero on the diagonal.
+     * @return solution x, with the shape of \em b
+     */
+    template <class T, class E>
+    auto solve(const xdiagonal<T>& A, const xexpression<E>& b)
+    {
+        const auto& d = A.diagonal();
+        if (std::find(d.begin(), d.end(), T(0)) != d.end())
+        {
+            XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+        }
+        auto p = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        std::size_t n = A.shape()[0];
+        detail::check_structured_rhs(p, n, "Solve: shape mismatch.");
+        auto* data = p.data();
+        for (std::size_t j = 0; j < p.size(); ++j)
+        {
+            data[j] /= d(j % n);
+        }
+        return p;
+    }
+
+    /**
+     * @return the diagonal matrix of the reciprocals of the diagonal of \em A
+     */
+    template <class T>
+    xdiagonal<T> inv(const xdiagonal<T>& A)
+    {
+        xdiagonal<T> result = A;
+        for (auto& v : result.diagonal())
+        {
+            if (v == T(0))
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+            }
+            v = T(1) / v;
+        }
+        return result;
+    }
+
+    /**
+     * @return the product of the diagonal of \em A
+     */
+    template <class T>
+    T det(const xdiagonal<T>& A)
+    {
+        const auto& d = A.diagonal();
+        return std::accumulate(d.begin(), d.end(), T(1), std::multiplies<T>());
+    }
+
+    /***************************
+     * block diagonal matrices *
+     ***************************/
+
+    /**
+     * Matrix product of the block diagonal matrix \em A with the vector or
+     * matrix \em x, with one gemm per block.
+     * @return the product, with one row per row of \em A
+     */
+    template <class T, class E>
+    auto dot(const xblock_diagonal<T>& A, const xexpression<E>& x)
+    {
+        auto p = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        std::size_t m = A.shape()[0], n = A.shape()[1];
+        detail::check_structured_rhs(p, n, "Dot: shape mismatch.");
+
+        auto shape = p.shape();
+        shape[0] = m;
+        auto result = decltype(p)::from_shape(shape);
+        std::size_t k = p.dimension() == 2 ? p.shape()[1] : 1;
+        for (std::size_t b = 0; b < A.block_count(); ++b)
+        {
+            const auto& block = A.block(b);
+            detail::structured_gemm(block.shape()[0], k, block.shape()[1],
+                                    block.data(), block.shape()[0],
+                                    p.data() + A.column_offset(b), n,
+                                    result.data() + A.row_offset(b), m);
+        }
+        return result;
+    }
+
+    /**
+     * Matrix product of the matrix \em x with the block diagonal matrix
+     * \em A, with one gemm per block.
+     * @return the product, with one column per column of \em A
+     */
+    template <class E, class T>
+    auto dot(const xexpression<E>& x, const xblock_diagonal<T>& A)
+    {
+        auto p = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        detail::check_structured_lhs(p, A.shape()[0]);
+        std::size_t m = p.shape()[0];
+
+        auto result = decltype(p)::from_shape({m, A.shape()[1]});
+        for (std::size_t b = 0; b < A.block_count(); ++b)
+        {
+            const auto& block = A.block(b);
+            detail::structured_gemm(m, block.shape()[1], block.shape()[0],
+                                    p.data() + A.row_offset(b) * m, m,
+                                    block.data(), block.shape()[0],
+                                    result.data() + A.column_offset(b) * m, m);
+        }
+        return result;
+    }
+
+    /**
+     * Solves A x = b for the block diagonal matrix \em A of square blocks,
+     * with gesv on each block and the matching rows of \em b.
+     * @return solution x, with the shape of \em b
+     */
+    template <class T, class E>
+    auto solve(const xblock_diagonal<T>& A, const xexpression<E>& b)
+    {
+        using block_type = typename xblock_diagonal<T>::block_type;
+        detail::check_square_blocks(A);
+        auto p = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        std::size_t n = A.shape()[0];
+        detail::check_structured_rhs(p, n, "Solve: shape mismatch.");
+
+        std::size_t k = p.dimension() == 2 ? p.shape()[1] : 1;
+        for (std::size_t bk = 0; bk < A.block_count(); ++bk)
+        {
+            block_type lu = A.block(bk);
+            std::size_t size = lu.shape()[0], offset = A.row_offset(bk);
+            block_type rhs = block_type::from_shape({size, k});
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                std::copy(p.data() + j * n + offset, p.data() + j * n + offset + size, rhs.data() + j * size);
+            }
+            int info = lapack::gesv(lu, rhs);
+            if (info > 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+            }
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                std::copy(rhs.data() + j * size, rhs.data() + (j + 1) * size, p.data() + j * n + offset);
+            }
+        }
+        return p;
+    }
+
+    /**
+     * @return the block diagonal matrix of the inverses of the blocks of \em A
+     */
+    template <class T>
+    xblock_diagonal<T> inv(const xblock_diagonal<T>& A)
+    {
+        detail::check_square_blocks(A);
+        xblock_diagonal<T> result;
+        for (std::size_t k = 0; k < A.block_count(); ++k)
+        {
+            result.push_back(inv(A.block(k)));
+        }
+        return result;
+    }
+
+    /**
+     * @return the product of the determinants of the blocks of \em A
+     */
+    template <class T>
+    T det(const xblock_diagonal<T>& A)
+    {
+        detail::check_square_blocks(A);
+        T result(1);
+        for (std::size_t k = 0; k < A.block_count(); ++k)
+        {
+            result *= det(A.block(k));
+        }
+        return result;
+    }
+
+    /************************
+     * permutation matrices *
+     ************************/
+
+    /**
+     * Matrix product of the permutation matrix \em P with the vector or
+     * matrix \em x, permuting the rows of \em x with laswp.
+     * @return the product, with the shape of \em x
+     */
+    template <class E>
+    auto dot(const xpermutation& P, const xexpression<E>& x)
+    {
+        auto p = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        detail::check_structured_rhs(p, P.shape()[0], "Dot: shape mismatch.");
+        lapack::laswp(p, P.pivots());
+        return p;
+    }
+
+    /**
+     * Matrix product of the matrix \em x with the permutation matrix \em P,
+     * permuting the columns of \em x.
+     * @return the product, with the shape of \em x
+     */
+    template <class E>
+    auto dot(const xexpression<E>& x, const xpermutation& P)
+    {
+        auto p = copy_to_layout<layout_type::column_major>(x.derived_cast());
+        detail::check_structured_lhs(p, P.shape()[0]);
+        std::size_t m = p.shape()[0];
+        auto result = decltype(p)::from_shape(p.shape());
+        const auto& perm = P.indices();
+        for (std::size_t i = 0; i < perm.size(); ++i)
+        {
+            std::copy(p.data() + i * m, p.data() + (i + 1) * m, result.data() + perm[i] * m);
+        }
+        return result;
+    }
+
+    /**
+     * Solves P x = b, i.e. computes P^T b, undoing the interchanges of \em P
+     * with laswp.
+     * @return solution x, with the shape of \em b
+     */
+    template <class E>
+    auto solve(const xpermutation& P, const xexpression<E>& b)
+    {
+        auto p = copy_to_layout<layout_type::column_major>(b.derived_cast());
+        detail::check_structured_rhs(p, P.shape()[0], "Solve: shape mismatch.");
+        lapack::laswp(p, P.pivots(), false);
+        return p;
+    }
+
+    /**
+     * @return P^T, the inverse of \em P
+     */
+    inline xpermutation inv(const xpermutation& P)
+    {
+        return P.transpose();
+    }
+
+    /**
+     * @return det(P), 1 or -1
+     */
+    inline int det(const xpermutation& P)
+    {
+        return P.sign();
+    }
+
+    /***********************************
+     * Toeplitz and circulant matrices *
+     ***********************************/
+
+    namespace detail
+    {
+        /**
+         * Discrete Fourier transform of a fixed length, in O(n log n) for
+         * any n: iterative radix 2 for powers of two, Bluestein's chirp z
+         * transform on a radix 2 transform of at least 2 n - 1 otherwise.
+         * The twiddle factors are computed once, for all the columns of a
+         * batch.
+         */
+        template <class R>
+        class fft_plan
+        {
+        public:
+
+            using complex_type = std::complex<R>;
+
+            explicit fft_plan(std::size_t n);
+
+            void forward(complex_type* a) const;
+            void inverse(complex_type* a) const;
+            std::size_t size() const noexcept;
+
+        private:
+
+            void radix2(complex_type* a, bool inverse) const;
+
+            std::size_t m_n;
+            std::size_t m_m;
+            std::vector<complex_type> m_twiddle;
+            std::vector<complex_type> m_chirp;
+            std::vector<complex_type> m_chirp_fft;
+        };
+
+        inline std::size_t next_power_of_two(std::size_t n)
+        {
+            std::size_t result = 1;
+            while (result < n)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        template <class R>
+        inline fft_plan<R>::fft_plan(std::size_t n)
+            : m_n(n), m_m(n == next_power_of_two(n) ? n : next_power_of_two(2 * n - 1))
+        {
+            const R pi = R(3.141592653589793238462643383279502884L);
+            m_twiddle.resize(m_m / 2);
+            for (std::size_t k = 0; k < m_twiddle.size(); ++k)
+            {
+                m_twiddle[k] = std::polar(R(1), -R(2) * pi * R(k) / R(m_m));
+            }
+            if (m_m != m_n)
+            {
+                // w_k = exp(-i pi k^2 / n), from k^2 mod 2 n to keep the angle exact
+                m_chirp.resize(n);
+                m_chirp_fft.assign(m_m, complex_type(0));
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    std::size_t k2 = (k * k) % (2 * n);
+                    m_chirp[k] = std::polar(R(1), -pi * R(k2) / R(n));
+                    m_chirp_fft[k] = std::conj(m_chirp[k]);
+                    if (k != 0)
+                    {
+                        m_chirp_fft[m_m - k] = std::conj(m_chirp[k]);
+                    }
+                }
+                radix2(m_chirp_fft.data(), false);
+            }
+        }
+
+        template <class R>
+        inline void fft_plan<R>::radix2(complex_type* a, bool inverse) const
+        {
+            std::size_t m = m_m;
+            for (std::size_t i = 1, j = 0; i < m; ++i)
+            {
+                std::size_t bit = m >> 1;
+                for (; j & bit; bit >>= 1)
+                {
+                    j ^= bit;
+                }
+                j ^= bit;
+                if (i < j)
+                {
+                    std::swap(a[i], a[j]);
+                }
+            }
+            for (std::size_t len = 2; len <= m; len <<= 1)
+            {
+                std::size_t half = len / 2, step = m / len;
+                for (std::size_t i = 0; i < m; i += len)
+                {
+                    for (std::size_t j = 0; j < half; ++j)
+                    {
+                        complex_type w = inverse ? std::conj(m_twiddle[j * step]) : m_twiddle[j * step];
+                        complex_type u = a[i + j];
+                        complex_type v = a[i + j + half] * w;
+                        a[i + j] = u + v;
+                        a[i + j + half] = u - v;
+                    }
+                }
+            }
+        }
+
+        /**
+         * In place transform X_k = sum_j a_j exp(-2 i pi j k / n).
+         */
+        template <class R>
+        inline void fft_plan<R>::forward(complex_type* a) const
+        {
+            if (m_m == m_n)
+            {
+                radix2(a, false);
+                return;
+            }
+            std::vector<complex_type> work(m_m, complex_type(0));
+            for (std::size_t k = 0; k < m_n; ++k)
+            {
+                work[k] = a[k] * m_chirp[k];
+            }
+            radix2(work.data(), false);
+            for (std::size_t k = 0; k < m_m; ++k)
+            {
+                work[k] *= m_chirp_fft[k];
+            }
+            radix2(work.data(), true);
+            R scale = R(1) / R(m_m);
+            for (std::size_t k = 0; k < m_n; ++k)
+            {
+                a[k] = work[k] * m_chirp[k] * scale;
+            }
+        }
+
+        /**
+         * In place inverse of forward, including the division by n.
+         */
+        template <class R>
+        inline void fft_plan<R>::inverse(complex_type* a) const
+        {
+            std::transform(a, a + m_n, a, [](const complex_type& v) { return std::conj(v); });
+            forward(a);
+            R scale = R(1) / R(m_n);
+            std::transform(a, a + m_n, a, [scale](const complex_type& v) { return std::conj(v) * scale; });
+        }
+
+        template <class R>
+        inline std::size_t fft_plan<R>::size() const noexcept
+        {
+            return m_n;
+        }
+
+        template <class T, class R>
+        inline auto from_complex(const std::complex<R>& v) -> std::enable_if_t<!xtl::is_complex<T>::value, T>
+        {
+            return static_cast<T>(v.real());
+        }
+
+        template <class T, class R>
+        inline auto from_complex(const std::complex<R>& v) -> std::enable_if_t<xtl::is_complex<T>::value, T>
+        {
+            return static_cast<T>(v);
+        }
+
+        template <class T, class E>
+        inline xtensor<T, 1> toeplitz_vector(const E& e, const char* name)
+        {
+            if (e.dimension() != 1 || e.size() == 0)
+            {
+                std::string message = std::string(name) + ": the first column and row must be non-empty vectors.";
+                XTENSOR_THROW(std::runtime_error, message);
+            }
+            return e;
+        }
+
+        template <class T>
+        inline xtensor<T, 1> conj_vector(const xtensor<T, 1>& v)
+        {
+            xtensor<T, 1> result = xtensor<T, 1>::from_shape(v.shape());
+            std::transform(v.begin(), v.end(), result.begin(), [](const T& x) { return conj_value(x); });
+            return result;
+        }
+
+        // solves, for each of the nrhs columns of x with n rows, the
+        // Toeplitz system with t_k = c[k] and t_-k = r[k], overwriting x
+        template <class T>
+        inline void levinson(const T* c, const T* r, std::size_t n, T* x, std::size_t nrhs)
+        {
+            if (n == 0)
+            {
+                return;
+            }
+            if (c[0] == T(0))
+            {
+                XTENSOR_THROW(std::runtime_error, "solve_toeplitz: a leading principal submatrix is singular.");
+            }
+            // forward and backward vectors: T_m f = e_0 and T_m b = e_(m-1)
+            std::vector<T> f(n, T(0)), b(n, T(0));
+            f[0] = b[0] = T(1) / c[0];
+            for (std::size_t j = 0; j < nrhs; ++j)
+            {
+                x[j * n] /= c[0];
+            }
+
+            for (std::size_t m = 1; m < n; ++m)
+            {
+                T ef(0), eb(0);
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    ef += c[m - i] * f[i];
+                    eb += r[i + 1] * b[i];
+                }
+                T denom = T(1) - ef * eb;
+                if (denom == T(0))
+                {
+                    XTENSOR_THROW(std::runtime_error, "solve_toeplitz: a leading principal submatrix is singular.");
+                }
+                // downwards, so that f[i] and b[i - 1] are still the old values
+                for (std::size_t i = m + 1; i-- > 0;)
+                {
+                    T fi = i < m ? f[i] : T(0);
+                    T bi = i > 0 ? b[i - 1] : T(0);
+                    f[i] = (fi - ef * bi) / denom;
+                    b[i] = (bi - eb * fi) / denom;
+                }
+                for (std::size_t j = 0; j < nrhs; ++j)
+                {
+                    T* xj = x + j * n;
+                    T ex(0);
+                    for (std::size_t i = 0; i < m; ++i)
+                    {
+                        ex += c[m - i] * xj[i];
+                    }
+                    T scale = xj[m] - ex;
+                    xj[m] = T(0);
+                    for (std::size_t i = 0; i <= m; ++i)
+                    {
+                        xj[i] += scale * b[i];
+                    }
+                }
+            }
+        }
+
+        // products below this many elements of T are summed directly
+        constexpr std::size_t toeplitz_direct_size = 4096;
+    }
+
+    /**
+     * Solves T x = b for the Toeplitz matrix T with first column \em c and
+     * first row \em r, by Levinson recursion in O(n^2) plus O(n^2) per
+     * column of \em b, instead of the O(n^3) of forming T and calling solve.
+     *
+     * The recursion needs every leading principal submatrix of T to be
+     * nonsingular, and is only as stable as Gaussian elimination without
+     * pivoting: it is meant for the positive definite matrices of
+     * autocorrelations, for which it is stable.
+     *
+     * @param c first column of T, of size N
+     * @param r first row of T, of size N; r(0) is ignored for c(0)
+     * @param b vector of size N or matrix of shape (N, K)
+     * @return solution x, with the shape of \em b
+     */
+    template <class EC, class ER, class EB>
+    auto solve_toeplitz(const xexpression<EC>& c, const xexpression<ER>& r, const xexpression<EB>& b)
+    {
+        using value_type = std::common_type_t<typename EC::value_type, typename ER::value_type, typename EB::value_type>;
+        auto tc = detail::toeplitz_vector<value_type>(c.derived_cast(), "solve_toeplitz");
+        auto tr = detail::toeplitz_vector<value_type>(r.derived_cast(), "solve_toeplitz");
+        std::size_t n = tc.size();
+        if (tr.size() != n)
+        {
+            XTENSOR_THROW(std::runtime_error, "solve_toeplitz: the first column and row must have the same size.");
+        }
+        xarray<value_type, layout_type::column_major> x = b.derived_cast();
+        detail::check_structured_rhs(x, n, "Solve: shape mismatch.");
+        detail::levinson(tc.data(), tr.data(), n, x.data(), x.dimension() == 2 ? x.shape()[1] : 1);
+        return x;
+    }
+
+    /**
+     * Solves T x = b for the symmetric (Hermitian) Toeplitz matrix T with
+     * first column \em c, e.g. an autocorrelation matrix, by Levinson
+     * recursion in O(n^2).
+     *
+     * @param c first column of T, of size N; the first row is conj(c)
+     * @param b vector of size N or matrix of shape (N, K)
+     * @return solution x, with the shape of \em b
+     */
+    template <class EC, class EB>
+    auto solve_toeplitz(const xexpression<EC>& c, const xexpression<EB>& b)
+    {
+        auto tc = detail::toeplitz_vector<typename EC::value_type>(c.derived_cast(), "solve_toeplitz");
+        return solve_toeplitz(tc, detail::conj_vector(tc), b);
+    }
+
+    /**
+     * Solves C x = b for the circulant matrix C with first column \em c,
+     * i.e. C(i, j) = c((i - j) mod N), by FFT in O(N log N) per column of
+     * \em b. The eigenvalues of C are the discrete Fourier transform of
+     * \em c; throws if one of them is zero to working precision.
+     *
+     * @param c first column of C, of size N
+     * @param b vector of size N or matrix of shape (N, K)
+     * @return solution x, with the shape of \em b
+     */
+    template <class EC, class EB>
+    auto solve_circulant(const xexpression<EC>& c, const xexpression<EB>& b)
+    {
+        using value_type = std::common_type_t<typename EC::value_type, typename EB::value_type>;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using complex_type = std::complex<real_type>;
+
+        auto tc = detail::toeplitz_vector<value_type>(c.derived_cast(), "solve_circulant");
+        std::size_t n = tc.size();
+        xarray<value_type, layout_type::column_major> x = b.derived_cast();
+        detail::check_structured_rhs(x, n, "Solve: shape mismatch.");
+
+        detail::fft_plan<real_type> plan(n);
+        std::vector<complex_type> eigenvalues(tc.begin(), tc.end());
+        plan.forward(eigenvalues.data());
+        real_type largest(0);
+        for (const auto& v : eigenvalues)
+        {
+            largest = std::max(largest, std::abs(v));
+        }
+        real_type tol = real_type(n) * std::numeric_limits<real_type>::epsilon() * largest;
+        for (const auto& v : eigenvalues)
+        {
+            if (!(std::abs(v) > tol))
+            {
+                XTENSOR_THROW(std::runtime_error, "Matrix is singular.");
+            }
+        }
+
+        std::size_t nrhs = x.dimension() == 2 ? x.shape()[1] : 1;
+        std::vector<complex_type> work(n);
+        for (std::size_t j = 0; j < nrhs; ++j)
+        {
+            value_type* xj = x.data() + j * n;
+            std::copy(xj, xj + n, work.begin());
+            plan.forward(work.data());
+            for (std::size_t k = 0; k < n; ++k)
+            {
+                work[k] /= eigenvalues[k];
+            }
+            plan.inverse(work.data());
+            std::transform(work.begin(), work.end(), xj, [](const complex_type& v) { return detail::from_complex<value_type>(v); });
+        }
+        return x;
+    }
+
+    /**
+     * Product of the M by N Toeplitz matrix T with first column \em c and
+     * first row \em r with \em x, without forming T: T is embedded in a
+     * circulant matrix of order at least M + N - 1, applied by FFT in
+     * O((M + N) log(M + N)) per column of \em x. Small products are summed
+     * directly.
+     *
+     * @param c first column of T, of size M
+     * @param r first row of T, of size N; r(0) is ignored for c(0)
+     * @param x vector of size N or matrix of shape (N, K)
+     * @return the product, of shape (M) or (M, K)
+     */
+    template <class EC, class ER, class EX>
+    auto matmul_toeplitz(const xexpression<EC>& c, const xexpression<ER>& r, const xexpression<EX>& x)
+    {
+        using value_type = std::common_type_t<typename EC::value_type, typename ER::value_type, typename EX::value_type>;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using complex_type = std::complex<real_type>;
+        using result_type = xarray<value_type, layout_type::column_major>;
+
+        auto tc = detail::toeplitz_vector<value_type>(c.derived_cast(), "matmul_toeplitz");
+        auto tr = detail::toeplitz_vector<value_type>(r.derived_cast(), "matmul_toeplitz");
+        std::size_t m = tc.size(), n = tr.size();
+        result_type p = x.derived_cast();
+        detail::check_structured_rhs(p, n, "Dot: shape mismatch.");
+        std::size_t nrhs = p.dimension() == 2 ? p.shape()[1] : 1;
+
+        auto shape = p.shape();
+        shape[0] = m;
+        result_type result = result_type::from_shape(shape);
+        if (m * n <= detail::toeplitz_direct_size)
+        {
+            for (std::size_t j = 0; j < nrhs; ++j)
+            {
+                const value_type* pj = p.data() + j * n;
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    value_type sum(0);
+                    for (std::size_t l = 0; l < n; ++l)
+                    {
+                        sum += (i >= l ? tc(i - l) : tr(l - i)) * pj[l];
+                    }
+                    result.data()[j * m + i] = sum;
+                }
+            }
+            return result;
+        }
+
+        std::size_t size = detail::next_power_of_two(m + n - 1);
+        detail::fft_plan<real_type> plan(size);
+        std::vector<complex_type> eigenvalues(size, complex_type(0));
+        std::copy(tc.begin(), tc.end(), eigenvalues.begin());
+        for (std::size_t l = 1; l < n; ++l)
+        {
+            eigenvalues[size - l] = tr(l);
+        }
+        plan.forward(eigenvalues.data());
+
+        std::vector<complex_type> work(size);
+        for (std::size_t j = 0; j < nrhs; ++j)
+        {
+            const value_type* pj = p.data() + j * n;
+            std::fill(std::copy(pj, pj + n, work.begin()), work.end(), complex_type(0));
+            plan.forward(work.data());
+            for (std::size_t k = 0; k < size; ++k)
+            {
+                work[k] *= eigenvalues[k];
+            }
+            plan.inverse(work.data());
+            std::transform(work.begin(), work.begin() + static_cast<std::ptrdiff_t>(m), result.data() + j * m,
+                           [](const complex_type& v) { return detail::from_complex<value_type>(v); });
+        }
+        return result;
+    }
+}
+
+    /************************
+     * Vandermonde matrices *
+     ************************/
+
+    namespace detail
+    {
+        template <class T, class E>
+        inline xtensor<T, 1> point_vector(const E& e, const char* name)
+        {
+            if (e.dimension() != 1 || e.size() == 0)
+            {
+                std::string message = std::string(name) + ": the points must be a non-empty vector.";
+                XTENSOR_THROW(std::runtime_error, message);
+            }
+            return e;
+        }
+
+        /**
+         * Björck-Pereyra solution of V c = b in place for the Vandermonde
+         * matrix V(i, j) = x(i)^j: Newton divided differences, then the
+         * Newton form expanded into monomials, O(n^2) per column. The
+         * reciprocals of the differences of the points are computed once for
+         * all the columns. Returns false if two points coincide.
+         */
+        template <class T>
+        inline bool bjorck_pereyra(const T* x, std::size_t n, T* b, std::size_t nrhs)
+        {
+            if (n == 0)
+            {
+                return true;
+            }
+            std::vector<T> inv_diff(n * (n - 1) / 2);
+            std::size_t index = 0;
+            for (std::size_t k = 0; k + 1 < n; ++k)
+            {
+                for (std::size_t i = n - 1; i > k; --i)
+                {
+                    T diff = x[i] - x[i - k - 1];
+                    if (diff == T(0))
+                    {
+                        return false;
+                    }
+                    inv_diff[index++] = T(1) / diff;
+                }
+            }
+
+            for (std::size_t j = 0; j < nrhs; ++j)
+            {
+                T* c = b + j * n;
+                index = 0;
+                for (std::size_t k = 0; k + 1 < n; ++k)
+                {
+                    for (std::size_t i = n - 1; i > k; --i)
+                    {
+                        c[i] = (c[i] - c[i - 1]) * inv_diff[index++];
+                    }
+                }
+                for (std::size_t k = n - 1; k-- > 0;)
+                {
+                    for (std::size_t i = k; i + 1 < n; ++i)
+                    {
+                        c[i] -= x[k] * c[i + 1];
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    /**
+     * Vandermonde matrix of the points \em x with \em N columns, the powers
+     * decreasing from x^(N-1) as in numpy.vander, or increasing from x^0.
+     *
+     * @param x vector of M points
+     * @param N number of columns
+     * @param increasing whether the powers increase along the rows
+     * @return column-major matrix of M-by-N elements
+     */
+    template <class E>
+    auto vander(const xexpression<E>& x, std::size_t N, bool increasing = false)
+    {
+        using value_type = typename E::value_type;
+        auto points = detail::point_vector<value_type>(x.derived_cast(), "vander");
+        std::size_t m = points.size();
+        xtensor<value_type, 2, layout_type::column_major> V = xtensor<value_type, 2, layout_type::column_major>::from_shape({m, N});
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            value_type power(1);
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                V(i, increasing ? j : N - 1 - j) = power;
+                power *= points(i);
+            }
+        }
+        return V;
+    }
+
+    /**
+     * Solves V c = b for the square Vandermonde matrix V(i, j) = x(i)^j,
+     * i.e. the coefficients c(j) of the polynomial of degree N - 1
+     * interpolating the values \em b at the points \em x, by the
+     * Björck-Pereyra algorithm in O(N^2) per column of \em b instead of the
+     * O(N^3) of forming V and calling solve. The result is often more
+     * accurate than Gaussian elimination on the notoriously ill conditioned
+     * V, in particular for points in increasing order.
+     *
+     * @param x vector of N distinct points
+     * @param b vector of size N or matrix of shape (N, K)
+     * @return coefficients c in increasing powers, with the shape of \em b
+     */
+    template <class EX, class EB>
+    auto solve_vandermonde(const xexpression<EX>& x, const xexpression<EB>& b)
+    {
+        using value_type = std::common_type_t<typename EX::value_type, typename EB::value_type>;
+        auto points = detail::point_vector<value_type>(x.derived_cast(), "solve_vandermonde");
+        std::size_t n = points.size();
+        xarray<value_type, layout_type::column_major> c = b.derived_cast();
+        detail::check_structured_rhs(c, n, "Solve: shape mismatch.");
+        if (!detail::bjorck_pereyra(points.data(), n, c.data(), c.dimension() == 2 ? c.shape()[1] : 1))
+        {
+            XTENSOR_THROW(std::runtime_error, "solve_vandermonde: the points must be distinct.");
+        }
+        return c;
+    }
+
+    /**
+     * Least squares fit of polynomials of degree \em deg to the values \em y
+     * at the points \em x, as numpy.polyfit: minimizes
+     * sum_i |w(i) (p(x(i)) - y(i))|^2.
+     *
+     * The columns of the weighted Vandermonde matrix are scaled to unit norm
+     * and the problem is solved by one QR factorization with column
+     * pivoting (lstsq with the gelsy driver), all the columns of \em y
+     * sharing it, instead of the SVD of the default lstsq. With as many
+     * distinct points as coefficients the fit is the interpolating
+     * polynomial, found by solve_vandermonde in O(N^2) per column.
+     *
+     * @param x vector of M points
+     * @param y vector of size M, or matrix of shape (M, K) for K fits at once
+     * @param deg degree of the polynomials
+     * @param w vector of M weights, e.g. 1 / sigma; empty for unit weights
+     * @return coefficients in decreasing powers, shape (deg + 1) or (deg + 1, K)
+     */
+    template <class EX, class EY, class EW = xtensor<xtl::complex_value_type_t<typename EX::value_type>, 1>>
+    auto polyfit(const xexpression<EX>& x, const xexpression<EY>& y, std::size_t deg,
+                 const xexpression<EW>& w = EW())
+    {
+        using value_type = std::common_type_t<typename EX::value_type, typename EY::value_type, typename EW::value_type>;
+        using weight_type = typename EW::value_type;
+        using real_type = xtl::complex_value_type_t<value_type>;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        auto points = detail::point_vector<value_type>(x.derived_cast(), "polyfit");
+        const auto& dy = y.derived_cast();
+        const auto& dw = w.derived_cast();
+        std::size_t m = points.size();
+        std::size_t order = deg + 1;
+        detail::check_structured_rhs(dy, m, "polyfit: x and y must have the same number of points.");
+        if (dw.size() != 0 && (dw.dimension() != 1 || dw.size() != m))
+        {
+            XTENSOR_THROW(std::runtime_error, "polyfit: x and w must have the same number of points.");
+        }
+        bool is_1d = dy.dimension() == 1;
+        std::size_t nrhs = is_1d ? 1 : dy.shape()[1];
+        matrix_type Y = matrix_type::from_shape({m, nrhs});
+        if (is_1d)
+        {
+            xt::view(Y, all(), 0) = dy;
+        }
+        else
+        {
+            Y = dy;
+        }
+
+        // C(j, :) holds the coefficients of x^(deg - j)
+        matrix_type C = matrix_type::from_shape({order, nrhs});
+        bool nonzero_weights = std::none_of(dw.cbegin(), dw.cend(), [](const weight_type& v) { return v == weight_type(0); });
+        bool interpolated = false;
+        if (m == order && nonzero_weights)
+        {
+            // the interpolating polynomial, whatever the weights
+            matrix_type increasing = Y;
+            interpolated = detail::bjorck_pereyra(points.data(), m, increasing.data(), nrhs);
+            if (interpolated)
+            {
+                C = xt::flip(increasing, 0);
+            }
+        }
+
+        if (!interpolated)
+        {
+            matrix_type V = vander(points, order);
+            if (dw.size() != 0)
+            {
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    value_type weight = value_type(dw(i));
+                    xt::view(V, i, all()) *= weight;
+                    xt::view(Y, i, all()) *= weight;
+                }
+            }
+            xtensor<real_type, 1> scale = xt::sqrt(xt::sum(xt::square(xt::abs(V)), {0}));
+            for (std::size_t j = 0; j < order; ++j)
+            {
+                if (scale(j) == real_type(0))
+                {
+                    scale(j) = real_type(1);
+                }
+                xt::view(V, all(), j) /= scale(j);
+            }
+            C = std::get<0>(lstsq(V, Y, -1., lstsq_driver::gelsy));
+            C /= xt::view(scale, all(), xt::newaxis());
+        }
+
+        xarray<value_type, layout_type::column_major> result = C;
+        if (is_1d)
+        {
+            result = xt::view(C, all(), 0);
+        }
+        return result;
+    }
+}
+
+#endif
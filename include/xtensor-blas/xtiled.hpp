@@ -0,0 +1,1253 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+
+#ifndef XTILED_HPP
+#define XTILED_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "xtl/xcomplex.hpp"
+
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xblas.hpp"
+#include "xtensor-blas/xblas_instrument.hpp"
+#include "xtensor-blas/xblas_threads.hpp"
+#include "xtensor-blas/xblas_utils.hpp"
+#include "xtensor-blas/xlapack.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+namespace xt
+{
+namespace linalg
+{
+namespace parallel
+{
+    /**
+     * Selects the tile algorithms of cholesky, lu_factor and qr: the matrix
+     * is split into tiles of tile_size x tile_size, each step of the
+     * factorization into one task per tile, and the tasks run on
+     * \em threads workers as soon as the tiles they read are final.
+     */
+    struct tiled_t
+    {
+        std::size_t tile_size = 256;  ///< Order of the tiles
+        std::size_t threads = 0;      ///< Number of workers, 0 for std::thread::hardware_concurrency
+    };
+
+    /// Tile algorithm with the default tile size and all the cores
+    constexpr tiled_t tiled = {};
+}
+
+    namespace detail
+    {
+        /**
+         * Directed acyclic graph of tasks, run by a work-stealing pool.
+         *
+         * Each task declares the data it reads and writes, as addresses;
+         * a task runs after the tasks added before it that write what it
+         * reads (read after write), or that read or write what it writes.
+         * A worker runs the tasks made ready by its own tasks first, in
+         * last-in first-out order, and steals the oldest ready task of
+         * another worker when it has none.
+         */
+        class task_graph
+        {
+        public:
+
+            void add(std::function<void()> f, std::initializer_list<const void*> reads,
+                     std::initializer_list<const void*> writes);
+
+            template <class R, class W>
+            void add(std::function<void()> f, const R& reads, const W& writes);
+
+            std::size_t size() const noexcept;
+
+            /// Runs all the tasks and rethrows the first exception of a task.
+            void run(std::size_t threads);
+
+        private:
+
+            struct access
+            {
+                std::size_t writer = 0;  // writer + 1, 0 for none
+                std::vector<std::size_t> readers;
+            };
+
+            struct worker_queue
+            {
+                std::mutex mutex;
+                std::deque<std::size_t> tasks;
+            };
+
+            void depend(std::vector<std::size_t>& preds, std::size_t pred) const;
+            bool next_task(std::vector<worker_queue>& queues, std::size_t self, std::size_t& task) const;
+
+            std::vector<std::function<void()>> m_tasks;
+            std::vector<std::vector<std::size_t>> m_successors;
+            std::vector<std::size_t> m_dependencies;
+            std::unordered_map<const void*, access> m_access;
+        };
+
+        inline void task_graph::add(std::function<void()> f, std::initializer_list<const void*> reads,
+                                    std::initializer_list<const void*> writes)
+        {
+            add<std::initializer_list<const void*>, std::initializer_list<const void*>>(std::move(f), reads, writes);
+        }
+
+        template <class R, class W>
+        inline void task_graph::add(std::function<void()> f, const R& reads, const W& writes)
+        {
+            std::size_t id = m_tasks.size();
+            std::vector<std::size_t> preds;
+            for (const void* p : reads)
+            {
+                access& a = m_access[p];
+                if (a.writer != 0)
+                {
+                    depend(preds, a.writer - 1);
+                }
+                a.readers.push_back(id);
+            }
+            for (const void* p : writes)
+            {
+                access& a = m_access[p];
+                if (a.writer != 0)
+                {
+                    depend(preds, a.writer - 1);
+                }
+                for (std::size_t r : a.readers)
+                {
+                    if (r != id)
+                    {
+                        depend(preds, r);
+                    }
+                }
+                a.readers.clear();
+                a.writer = id + 1;
+            }
+            m_tasks.push_back(std::move(f));
+            m_successors.emplace_back();
+            m_dependencies.push_back(preds.size());
+            for (std::size_t p : preds)
+            {
+                m_successors[p].push_back(id);
+            }
+        }
+
+        inline void task_graph::depend(std::vector<std::size_t>& preds, std::size_t pred) const
+        {
+            if (std::find(preds.begin(), preds.end(), pred) == preds.end())
+            {
+                preds.push_back(pred);
+            }
+        }
+
+        inline std::size_t task_graph::size() const noexcept
+        {
+            return m_tasks.size();
+        }
+
+        inline bool task_graph::next_task(std::vector<worker_queue>& queues, std::size_t self, std::size_t& task) const
+        {
+            {
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                if (!queues[self].tasks.empty())
+                {
+                    task = queues[self].tasks.back();
+                    queues[self].tasks.pop_back();
+                    return true;
+                }
+            }
+            for (std::size_t k = 1; k < queues.size(); ++k)
+            {
+                worker_queue& victim = queues[(self + k) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty())
+                {
+                    task = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline void task_graph::run(std::size_t threads)
+        {
+            std::size_t n = m_tasks.size();
+            if (threads == 0)
+            {
+                threads = std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1));
+            }
+            threads = std::max(std::min(threads, n), std::size_t(1));
+
+            std::unique_ptr<std::atomic<std::size_t>[]> remaining(new std::atomic<std::size_t>[n]);
+            std::vector<worker_queue> queues(threads);
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                remaining[i].store(m_dependencies[i], std::memory_order_relaxed);
+                if (m_dependencies[i] == 0)
+                {
+                    queues[next++ % threads].tasks.push_back(i);
+                }
+            }
+
+            std::atomic<std::size_t> done(0);
+            std::atomic<bool> failed(false);
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            auto work = [&](std::size_t self)
+            {
+#if defined(WITH_MKLBLAS)
+                // BLAS inside the tasks runs on one thread
+                blas::scoped_num_threads guard(1);
+#endif
+                std::size_t task;
+                while (done.load(std::memory_order_acquire) < n && !failed.load(std::memory_order_relaxed))
+                {
+                    if (!next_task(queues, self, task))
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    try
+                    {
+                        m_tasks[task]();
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (!error)
+                        {
+                            error = std::current_exception();
+                        }
+                        failed.store(true);
+                        return;
+                    }
+                    for (std::size_t s : m_successors[task])
+                    {
+                        if (remaining[s].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        {
+                            std::lock_guard<std::mutex> lock(queues[self].mutex);
+                            queues[self].tasks.push_back(s);
+                        }
+                    }
+                    done.fetch_add(1, std::memory_order_release);
+                }
+            };
+
+            {
+#if !defined(WITH_MKLBLAS)
+                // a process-wide setting, held while the workers run
+                blas::scoped_num_threads guard(1);
+#endif
+                std::vector<std::thread> workers;
+                workers.reserve(threads - 1);
+                for (std::size_t i = 1; i < threads; ++i)
+                {
+                    workers.emplace_back(work, i);
+                }
+                work(0);
+                for (auto& w : workers)
+                {
+                    w.join();
+                }
+            }
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        /*
+         * Tiles of a column-major matrix of shape (m, n) and leading
+         * dimension ld, of order nb except in the last row and column.
+         */
+        template <class T>
+        struct tile_matrix
+        {
+            T* data;
+            std::size_t m;
+            std::size_t n;
+            std::size_t ld;
+            std::size_t nb;
+
+            std::size_t row_tiles() const
+            {
+                return (m + nb - 1) / nb;
+            }
+
+            std::size_t column_tiles() const
+            {
+                return (n + nb - 1) / nb;
+            }
+
+            std::size_t rows(std::size_t i) const
+            {
+                return std::min(nb, m - i * nb);
+            }
+
+            std::size_t columns(std::size_t j) const
+            {
+                return std::min(nb, n - j * nb);
+            }
+
+            T* operator()(std::size_t i, std::size_t j) const
+            {
+                return data + i * nb + j * nb * ld;
+            }
+        };
+
+        template <class T>
+        inline tile_matrix<T> make_tile_matrix(T* data, std::size_t m, std::size_t n, std::size_t ld,
+                                               const parallel::tiled_t& tiling)
+        {
+            if (tiling.tile_size == 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "tiled: the tile size must be positive.");
+            }
+            return {data, m, n, ld, tiling.tile_size};
+        }
+
+        // C := C - A A^H on the lower triangle, syrk or herk
+        template <class T>
+        inline void tile_rank_update(blas_index_t n, blas_index_t k, const T* A, blas_index_t ldA,
+                                     T* C, blas_index_t ldC, std::false_type /*is_complex*/)
+        {
+            cxxblas::syrk<blas_index_t>(cxxblas::ColMajor, cxxblas::Lower, cxxblas::NoTrans, n, k,
+                                        T(-1), A, ldA, T(1), C, ldC);
+        }
+
+        template <class T>
+        inline void tile_rank_update(blas_index_t n, blas_index_t k, const T* A, blas_index_t ldA,
+                                     T* C, blas_index_t ldC, std::true_type /*is_complex*/)
+        {
+            using real_type = xtl::complex_value_type_t<T>;
+            cxxblas::herk<blas_index_t>(cxxblas::ColMajor, cxxblas::Lower, cxxblas::NoTrans, n, k,
+                                        real_type(-1), A, ldA, real_type(1), C, ldC);
+        }
+
+        // C := op(Q) C for the k reflectors of geqrf in A, ormqr or unmqr
+        template <class T>
+        inline void tile_apply_q(char trans, blas_index_t m, blas_index_t n, blas_index_t k, T* A, blas_index_t ldA,
+                                 const T* tau, T* C, blas_index_t ldC, std::false_type /*is_complex*/)
+        {
+            uvector<T> work(static_cast<std::size_t>(std::max(n, blas_index_t(1))) * 64);
+            cxxlapack::ormqr<blas_index_t>('L', trans == 'N' ? 'N' : 'T', m, n, k, A, ldA, tau, C, ldC,
+                                           work.data(), to_blas_index(work.size()));
+        }
+
+        template <class T>
+        inline void tile_apply_q(char trans, blas_index_t m, blas_index_t n, blas_index_t k, T* A, blas_index_t ldA,
+                                 const T* tau, T* C, blas_index_t ldC, std::true_type /*is_complex*/)
+        {
+            uvector<T> work(static_cast<std::size_t>(std::max(n, blas_index_t(1))) * 64);
+            cxxlapack::unmqr<blas_index_t>('L', trans, m, n, k, A, ldA, tau, C, ldC,
+                                           work.data(), to_blas_index(work.size()));
+        }
+
+        template <class T>
+        inline void tile_geqrf(blas_index_t m, blas_index_t n, T* A, blas_index_t ldA, T* tau)
+        {
+            uvector<T> work(static_cast<std::size_t>(std::max(n, blas_index_t(1))) * 64);
+            cxxlapack::geqrf<blas_index_t>(m, n, A, ldA, tau, work.data(), to_blas_index(work.size()));
+        }
+
+        /*
+         * Tiled Cholesky factorization A = L L^H of the lower triangle, in
+         * place: potrf of the diagonal tiles, trsm of the tiles below them
+         * and syrk / gemm updates of the trailing tiles. Returns the order
+         * of the first non positive definite leading minor, 0 if none.
+         */
+        template <class T>
+        inline blas_index_t tiled_potrf(const tile_matrix<T>& A, std::size_t threads)
+        {
+            using is_complex = xtl::is_complex<T>;
+            blas_index_t ld = to_blas_index(A.ld);
+            std::size_t nt = A.row_tiles();
+            std::atomic<blas_index_t> failure(0);
+            task_graph graph;
+            for (std::size_t k = 0; k < nt; ++k)
+            {
+                blas_index_t nk = to_blas_index(A.columns(k));
+                graph.add([=, &failure]()
+                {
+                    if (failure.load() != 0)
+                    {
+                        return;
+                    }
+                    blas_index_t info = cxxlapack::potrf<blas_index_t>('L', nk, A(k, k), ld);
+                    if (info > 0)
+                    {
+                        failure.store(to_blas_index(k * A.nb) + info);
+                    }
+                }, {}, {A(k, k)});
+                for (std::size_t i = k + 1; i < nt; ++i)
+                {
+                    blas_index_t mi = to_blas_index(A.rows(i));
+                    graph.add([=, &failure]()
+                    {
+                        if (failure.load() == 0)
+                        {
+                            cxxblas::trsm<blas_index_t>(cxxblas::ColMajor, cxxblas::Right, cxxblas::Lower,
+                                                        cxxblas::ConjTrans, cxxblas::NonUnit, mi, nk,
+                                                        T(1), A(k, k), ld, A(i, k), ld);
+                        }
+                    }, {A(k, k)}, {A(i, k)});
+                }
+                for (std::size_t i = k + 1; i < nt; ++i)
+                {
+                    blas_index_t mi = to_blas_index(A.rows(i));
+                    graph.add([=, &failure]()
+                    {
+                        if (failure.load() == 0)
+                        {
+                            tile_rank_update(mi, nk, A(i, k), ld, A(i, i), ld, is_complex());
+                        }
+                    }, {A(i, k)}, {A(i, i)});
+                    for (std::size_t j = k + 1; j < i; ++j)
+                    {
+                        blas_index_t nj = to_blas_index(A.columns(j));
+                        graph.add([=, &failure]()
+                        {
+                            if (failure.load() == 0)
+                            {
+                                cxxblas::gemm<blas_index_t>(cxxblas::ColMajor, cxxblas::NoTrans, cxxblas::ConjTrans,
+                                                            mi, nj, nk, T(-1), A(i, k), ld, A(j, k), ld,
+                                                            T(1), A(i, j), ld);
+                            }
+                        }, {A(i, k), A(j, k)}, {A(i, j)});
+                    }
+                }
+            }
+            graph.run(threads);
+            return failure.load();
+        }
+
+        /*
+         * Tiled LU factorization with partial pivoting P A = L U of a square
+         * matrix, in place, with the LAPACK pivots in piv. Each panel of
+         * tile columns is factored by getrf as one task; its row swaps, the
+         * trsm of the tile row and the gemm updates of the trailing tiles
+         * are tasks per tile column and tile, so that the next panels start
+         * while the updates of the previous ones run. Returns the info of
+         * getrf.
+         */
+        template <class T>
+        inline blas_index_t tiled_getrf(const tile_matrix<T>& A, blas_index_t* piv, std::size_t threads)
+        {
+            blas_index_t ld = to_blas_index(A.ld);
+            std::size_t nt = A.column_tiles();
+            std::size_t mt = A.row_tiles();
+            std::atomic<blas_index_t> singular(0);
+            std::mutex singular_mutex;
+            task_graph graph;
+            std::vector<const void*> column;
+            for (std::size_t k = 0; k < nt; ++k)
+            {
+                blas_index_t first = to_blas_index(k * A.nb);
+                blas_index_t nk = to_blas_index(A.columns(k));
+                blas_index_t panel_rows = to_blas_index(A.m) - first;
+
+                column.clear();
+                for (std::size_t i = k; i < mt; ++i)
+                {
+                    column.push_back(A(i, k));
+                }
+                graph.add([=, &singular, &singular_mutex]()
+                {
+                    blas_index_t info = cxxlapack::getrf<blas_index_t>(panel_rows, nk, A(k, k), ld, piv + first);
+                    for (blas_index_t i = 0; i < std::min(panel_rows, nk); ++i)
+                    {
+                        piv[first + i] += first;
+                    }
+                    if (info > 0)
+                    {
+                        std::lock_guard<std::mutex> lock(singular_mutex);
+                        if (singular.load() == 0 || first + info < singular.load())
+                        {
+                            singular.store(first + info);
+                        }
+                    }
+                }, std::vector<const void*>(), column);
+
+                // row swaps of the other tile columns, and the trsm of the tile row
+                for (std::size_t j = 0; j < nt; ++j)
+                {
+                    if (j == k)
+                    {
+                        continue;
+                    }
+                    blas_index_t nj = to_blas_index(A.columns(j));
+                    column.clear();
+                    for (std::size_t i = k; i < mt; ++i)
+                    {
+                        column.push_back(A(i, j));
+                    }
+                    bool right = j > k;
+                    graph.add([=]()
+                    {
+                        cxxlapack::laswp<blas_index_t>(nj, A(0, j), ld, first + 1, first + nk, piv, 1);
+                        if (right)
+                        {
+                            cxxblas::trsm<blas_index_t>(cxxblas::ColMajor, cxxblas::Left, cxxblas::Lower,
+                                                        cxxblas::NoTrans, cxxblas::Unit, nk, nj,
+                                                        T(1), A(k, k), ld, A(k, j), ld);
+                        }
+                    }, std::vector<const void*>{A(k, k)}, column);
+                }
+
+                for (std::size_t j = k + 1; j < nt; ++j)
+                {
+                    blas_index_t nj = to_blas_index(A.columns(j));
+                    for (std::size_t i = k + 1; i < mt; ++i)
+                    {
+                        blas_index_t mi = to_blas_index(A.rows(i));
+                        graph.add([=]()
+                        {
+                            cxxblas::gemm<blas_index_t>(cxxblas::ColMajor, cxxblas::NoTrans, cxxblas::NoTrans,
+                                                        mi, nj, nk, T(-1), A(i, k), ld, A(k, j), ld,
+                                                        T(1), A(i, j), ld);
+                        }, {A(i, k), A(k, j)}, {A(i, j)});
+                    }
+                }
+            }
+            graph.run(threads);
+            return singular.load();
+        }
+
+        /*
+         * Tiled QR factorization of a matrix with at least as many rows as
+         * columns, with the triangle on triangle kernels of the tile
+         * algorithms of Buttari et al.: geqrf of the diagonal tile, then
+         * for each tile below it the QR factorization of the triangle R
+         * stacked on the tile (tsqrt), whose reflectors are 0 in the rows
+         * of R below the diagonal. The updates of the tiles to the right
+         * (ormqr, tsmqr) apply the same reflectors to the stacked tiles.
+         * The reflectors of the tile (i, k) and their tau stay in the
+         * tile and in taus(i, k).
+         *
+         * The stacked kernels run the LAPACK geqrf and ormqr on copies of
+         * the two tiles.
+         */
+        template <class T>
+        class tiled_qr
+        {
+        public:
+
+            tiled_qr(const tile_matrix<T>& A)
+                : m_a(A), m_taus(A.row_tiles() * A.column_tiles() * A.nb)
+            {
+            }
+
+            void factor(std::size_t threads)
+            {
+                task_graph graph;
+                std::size_t mt = m_a.row_tiles();
+                std::size_t nt = m_a.column_tiles();
+                for (std::size_t k = 0; k < nt; ++k)
+                {
+                    graph.add([=]()
+                    {
+                        tile_geqrf(to_blas_index(m_a.rows(k)), to_blas_index(m_a.columns(k)), m_a(k, k),
+                                   to_blas_index(m_a.ld), tau(k, k));
+                    }, {}, {m_a(k, k)});
+                    for (std::size_t j = k + 1; j < nt; ++j)
+                    {
+                        graph.add([=]() { apply_diagonal(k, 'C', m_a(k, j), to_blas_index(m_a.ld), m_a.columns(j)); },
+                                  {m_a(k, k)}, {m_a(k, j)});
+                    }
+                    for (std::size_t i = k + 1; i < mt; ++i)
+                    {
+                        graph.add([=]() { tsqrt(i, k); }, {}, {m_a(k, k), m_a(i, k)});
+                        for (std::size_t j = k + 1; j < nt; ++j)
+                        {
+                            graph.add([=]()
+                            {
+                                apply_stacked(i, k, 'C', m_a(k, j), m_a(i, j), to_blas_index(m_a.ld), m_a.columns(j));
+                            }, {m_a(i, k)}, {m_a(k, j), m_a(i, j)});
+                        }
+                    }
+                }
+                graph.run(threads);
+            }
+
+            // Q := the leading columns of the orthogonal factor, tiled as A
+            void form_q(const tile_matrix<T>& Q, std::size_t threads)
+            {
+                task_graph graph;
+                std::size_t mt = m_a.row_tiles();
+                std::size_t nt = m_a.column_tiles();
+                blas_index_t ld = to_blas_index(Q.ld);
+                for (std::size_t k = nt; k-- > 0;)
+                {
+                    for (std::size_t i = mt; i-- > k + 1;)
+                    {
+                        for (std::size_t j = k; j < nt; ++j)
+                        {
+                            graph.add([=]() { apply_stacked(i, k, 'N', Q(k, j), Q(i, j), ld, Q.columns(j)); },
+                                      {m_a(i, k)}, {Q(k, j), Q(i, j)});
+                        }
+                    }
+                    for (std::size_t j = k; j < nt; ++j)
+                    {
+                        graph.add([=]() { apply_diagonal(k, 'N', Q(k, j), ld, Q.columns(j)); },
+                                  {m_a(k, k)}, {Q(k, j)});
+                    }
+                }
+                graph.run(threads);
+            }
+
+        private:
+
+            using is_complex = xtl::is_complex<T>;
+
+            T* tau(std::size_t i, std::size_t k)
+            {
+                return m_taus.data() + (i + k * m_a.row_tiles()) * m_a.nb;
+            }
+
+            // C := op(Q_kk) C for the tile C of the tile row k
+            void apply_diagonal(std::size_t k, char trans, T* C, blas_index_t ldC, std::size_t columns)
+            {
+                tile_apply_q(trans, to_blas_index(m_a.rows(k)), to_blas_index(columns), to_blas_index(m_a.columns(k)),
+                             m_a(k, k), to_blas_index(m_a.ld), tau(k, k), C, ldC, is_complex());
+            }
+
+            // QR factorization of R_kk stacked on A_ik
+            void tsqrt(std::size_t i, std::size_t k)
+            {
+                std::size_t nk = m_a.columns(k), mi = m_a.rows(i), rows = nk + mi;
+                uvector<T> s(rows * nk, T(0));
+                for (std::size_t c = 0; c < nk; ++c)
+                {
+                    const T* r = m_a(k, k) + c * m_a.ld;
+                    std::copy(r, r + c + 1, s.data() + c * rows);
+                    const T* a = m_a(i, k) + c * m_a.ld;
+                    std::copy(a, a + mi, s.data() + c * rows + nk);
+                }
+                tile_geqrf(to_blas_index(rows), to_blas_index(nk), s.data(), to_blas_index(rows), tau(i, k));
+                for (std::size_t c = 0; c < nk; ++c)
+                {
+                    const T* col = s.data() + c * rows;
+                    std::copy(col, col + c + 1, m_a(k, k) + c * m_a.ld);
+                    std::copy(col + nk, col + rows, m_a(i, k) + c * m_a.ld);
+                }
+            }
+
+            // [C1; C2] := op(Q_ik) [C1; C2] for C1 in the tile row k and C2 in the tile row i
+            void apply_stacked(std::size_t i, std::size_t k, char trans, T* C1, T* C2, blas_index_t ldC,
+                               std::size_t columns)
+            {
+                std::size_t nk = m_a.columns(k), mi = m_a.rows(i), rows = nk + mi;
+                uvector<T> v(rows * nk, T(0));
+                uvector<T> c(rows * columns);
+                for (std::size_t q = 0; q < nk; ++q)
+                {
+                    const T* a = m_a(i, k) + q * m_a.ld;
+                    std::copy(a, a + mi, v.data() + q * rows + nk);
+                }
+                for (std::size_t q = 0; q < columns; ++q)
+                {
+                    std::copy(C1 + q * ldC, C1 + q * ldC + nk, c.data() + q * rows);
+                    std::copy(C2 + q * ldC, C2 + q * ldC + mi, c.data() + q * rows + nk);
+                }
+                tile_apply_q(trans, to_blas_index(rows), to_blas_index(columns), to_blas_index(nk), v.data(),
+                             to_blas_index(rows), tau(i, k), c.data(), to_blas_index(rows), is_complex());
+                for (std::size_t q = 0; q < columns; ++q)
+                {
+                    std::copy(c.data() + q * rows, c.data() + q * rows + nk, C1 + q * ldC);
+                    std::copy(c.data() + q * rows + nk, c.data() + (q + 1) * rows, C2 + q * ldC);
+                }
+            }
+
+            tile_matrix<T> m_a;
+            uvector<T> m_taus;
+        };
+    }
+
+    /**
+     * Computes the Cholesky factorization of \em A by the tile algorithm:
+     * potrf, trsm, syrk (herk) and gemm tasks on tiles, scheduled as a
+     * dependency graph on a pool of workers, each calling single-threaded
+     * BLAS. Scales past the parallelism of the panel factorization of
+     * LAPACK potrf on many-core machines; the result is that of cholesky.
+     *
+     * @param A Hermitian positive definite matrix, only its lower triangle is read
+     * @param tiling tile size and number of workers
+     * @return the lower triangular factor, with zeros above the diagonal
+     */
+    template <class E>
+    auto cholesky(const xexpression<E>& A, const parallel::tiled_t& tiling)
+    {
+        assert_nd_square(A);
+        using value_type = typename E::value_type;
+        xtensor<value_type, 2, layout_type::column_major> L = A.derived_cast();
+        std::size_t n = L.shape()[0];
+        XTENSOR_BLAS_INSTRUMENT_CALL("potrf_tiled", n, n, tiling.tile_size, layout_type::column_major, 'L');
+        auto tiles = detail::make_tile_matrix(L.data(), n, n, std::max(n, std::size_t(1)), tiling);
+        if (detail::tiled_potrf(tiles, tiling.threads) != 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "Cholesky decomposition failed.");
+        }
+        xblas_detail::zero_strict_triangle(L, true);
+        return L;
+    }
+
+    /**
+     * Computes the LU factorization with partial pivoting of \em A by the
+     * tile algorithm: the panels of tile columns are factored by getrf
+     * while the row swaps, trsm and gemm updates of the previous panels
+     * run as tasks of a dependency graph. The factors and pivots are
+     * those of getrf.
+     *
+     * @param A square matrix
+     * @param tiling tile size and number of workers
+     * @return lu_factorization of \em A
+     */
+    template <class E>
+    auto lu_factor(const xexpression<E>& A, const parallel::tiled_t& tiling)
+    {
+        assert_nd_square(A);
+        using value_type = typename E::value_type;
+        using result_type = lu_factorization<value_type>;
+        typename result_type::matrix_type LU = A.derived_cast();
+        std::size_t n = LU.shape()[0];
+        XTENSOR_BLAS_INSTRUMENT_CALL("getrf_tiled", n, n, tiling.tile_size, layout_type::column_major);
+        auto norm = lapack::lange(LU, '1');
+        auto norm_inf = lapack::lange(LU, 'I');
+        uvector<blas_index_t> piv(n);
+        auto tiles = detail::make_tile_matrix(LU.data(), n, n, std::max(n, std::size_t(1)), tiling);
+        int info = static_cast<int>(detail::tiled_getrf(tiles, piv.data(), tiling.threads));
+        return result_type(std::move(LU), std::move(piv), norm, norm_inf, info);
+    }
+
+    /**
+     * Computes the reduced QR decomposition of \em A, with at least as many
+     * rows as columns, by the tile algorithm (Buttari, Langou, Kurzak and
+     * Dongarra): each tile below the diagonal is eliminated against the
+     * triangle of the diagonal tile, so that the tiles of a column are
+     * factored in parallel with the updates of the previous columns.
+     * R has the same magnitudes as the R of qr, possibly with other signs
+     * of the rows. Wider matrices are decomposed by qr.
+     *
+     * @param A matrix of shape (m, n)
+     * @param tiling tile size and number of workers
+     * @return std::tuple with Q of shape (m, min(m, n)) and R of shape (min(m, n), n)
+     */
+    template <class E>
+    auto qr(const xexpression<E>& A, const parallel::tiled_t& tiling)
+    {
+        using value_type = typename E::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        matrix_type H = A.derived_cast();
+        std::size_t m = H.shape()[0];
+        std::size_t n = H.shape()[1];
+        if (m < n || n == 0)
+        {
+            auto res = qr(H);
+            return std::make_tuple(matrix_type(std::get<0>(res)), matrix_type(std::get<1>(res)));
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("geqrf_tiled", m, n, tiling.tile_size, layout_type::column_major);
+
+        auto tiles = detail::make_tile_matrix(H.data(), m, n, m, tiling);
+        detail::tiled_qr<value_type> factorization(tiles);
+        factorization.factor(tiling.threads);
+
+        matrix_type R = matrix_type::from_shape({n, n});
+        R.fill(value_type(0));
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            for (std::size_t i = 0; i <= j; ++i)
+            {
+                R(i, j) = H(i, j);
+            }
+        }
+        matrix_type Q = matrix_type::from_shape({m, n});
+        Q.fill(value_type(0));
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            Q(j, j) = value_type(1);
+        }
+        factorization.form_q(detail::make_tile_matrix(Q.data(), m, n, m, tiling), tiling.threads);
+        return std::make_tuple(std::move(Q), std::move(R));
+    }
+
+    /********
+     * TSQR *
+     ********/
+
+    /// Parameters of the tall-skinny QR factorization
+    struct tsqr_options
+    {
+        std::size_t block_rows = 0;  ///< Rows per leaf block, at least the number of columns; 0 for 4 blocks per worker
+        std::size_t threads = 0;     ///< Number of workers, 0 for std::thread::hardware_concurrency
+    };
+
+    /**
+     * Tall-skinny QR factorization A = Q R (Demmel, Grigori, Hoemmen and
+     * Langou) of a matrix of shape (m, n) with m >= n, as returned by
+     * tsqr_factor.
+     *
+     * The rows are split into blocks factored by geqrf in parallel, and
+     * the n x n R factors are reduced by pairs in a binary tree, each node
+     * factoring two stacked triangles. Every block is read once, so the
+     * factorization runs at the memory bandwidth of the cores instead of
+     * that of the panel of geqrf. Q is kept implicitly as the reflectors
+     * of the leaves and of the tree.
+     */
+    template <class T>
+    class tsqr_factorization
+    {
+    public:
+
+        using value_type = T;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+
+        template <class E>
+        explicit tsqr_factorization(const xexpression<E>& A, const tsqr_options& options = tsqr_options());
+
+        matrix_type r() const;
+        matrix_type q() const;
+
+        template <class E>
+        auto apply_qh(const xexpression<E>& b) const;
+
+        template <class E>
+        auto solve(const xexpression<E>& b) const;
+
+    private:
+
+        struct node
+        {
+            std::size_t left;
+            std::size_t right;
+            std::size_t row0;
+            std::size_t rows;
+            uvector<T> v;  // stacked reflectors of the inner nodes
+            uvector<T> tau;
+        };
+
+        bool leaf(std::size_t i) const;
+        const T* r_data(std::size_t i, std::size_t& ld) const;
+        matrix_type qh_columns(const matrix_type& b) const;
+
+        matrix_type m_a;
+        std::vector<node> m_nodes;
+        std::size_t m_root;
+        std::size_t m_threads;
+    };
+
+    /**
+     * Compute the tall-skinny QR factorization of \em A.
+     * @param A matrix with at least as many rows as columns
+     * @param options leaf block size and number of workers
+     * @return tsqr_factorization of \em A
+     */
+    template <class E>
+    inline auto tsqr_factor(const xexpression<E>& A, const tsqr_options& options = tsqr_options())
+    {
+        return tsqr_factorization<typename E::value_type>(A, options);
+    }
+
+    template <class T>
+    template <class E>
+    inline tsqr_factorization<T>::tsqr_factorization(const xexpression<E>& A, const tsqr_options& options)
+        : m_a(A.derived_cast()), m_threads(options.threads)
+    {
+        std::size_t m = m_a.shape()[0];
+        std::size_t n = m_a.shape()[1];
+        if (m < n || n == 0)
+        {
+            XTENSOR_THROW(std::runtime_error, "tsqr: A must have at least as many rows as columns.");
+        }
+        XTENSOR_BLAS_INSTRUMENT_CALL("geqrf_tsqr", m, n, 0, layout_type::column_major);
+
+        std::size_t threads = m_threads == 0 ? std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1))
+                                             : m_threads;
+        std::size_t block = options.block_rows == 0 ? (m + 4 * threads - 1) / (4 * threads) : options.block_rows;
+        block = std::max(block, n);
+        std::size_t leaves = std::max(m / block, std::size_t(1));
+
+        // the last block takes the remaining rows
+        for (std::size_t i = 0; i < leaves; ++i)
+        {
+            std::size_t row0 = i * block;
+            std::size_t rows = i + 1 == leaves ? m - row0 : block;
+            m_nodes.push_back(node{0, 0, row0, rows, uvector<T>(), uvector<T>(n)});
+        }
+        std::vector<std::size_t> level(leaves);
+        std::iota(level.begin(), level.end(), std::size_t(0));
+        while (level.size() > 1)
+        {
+            std::vector<std::size_t> next;
+            for (std::size_t i = 0; i + 1 < level.size(); i += 2)
+            {
+                next.push_back(m_nodes.size());
+                m_nodes.push_back(node{level[i], level[i + 1], 0, 0, uvector<T>(4 * n * n), uvector<T>(n)});
+            }
+            if (level.size() % 2 == 1)
+            {
+                next.push_back(level.back());
+            }
+            level.swap(next);
+        }
+        m_root = level[0];
+
+        detail::task_graph graph;
+        blas_index_t bm = to_blas_index(m), bn = to_blas_index(n);
+        for (std::size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            node* nd = &m_nodes[i];
+            if (leaf(i))
+            {
+                graph.add([=]()
+                {
+                    detail::tile_geqrf(to_blas_index(nd->rows), bn, m_a.data() + nd->row0, bm, nd->tau.data());
+                }, {}, {nd});
+                continue;
+            }
+            const node* l = &m_nodes[nd->left];
+            const node* r = &m_nodes[nd->right];
+            graph.add([=]()
+            {
+                // [R_left; R_right], zero below the diagonals
+                std::size_t ldl, ldr;
+                const T* rl = r_data(nd->left, ldl);
+                const T* rr = r_data(nd->right, ldr);
+                std::fill(nd->v.begin(), nd->v.end(), T(0));
+                for (std::size_t c = 0; c < n; ++c)
+                {
+                    std::copy(rl + c * ldl, rl + c * ldl + c + 1, nd->v.data() + c * 2 * n);
+                    std::copy(rr + c * ldr, rr + c * ldr + c + 1, nd->v.data() + c * 2 * n + n);
+                }
+                detail::tile_geqrf(2 * bn, bn, nd->v.data(), 2 * bn, nd->tau.data());
+            }, {l, r}, {nd});
+        }
+        graph.run(m_threads);
+    }
+
+    template <class T>
+    inline bool tsqr_factorization<T>::leaf(std::size_t i) const
+    {
+        return m_nodes[i].v.empty();
+    }
+
+    template <class T>
+    inline const T* tsqr_factorization<T>::r_data(std::size_t i, std::size_t& ld) const
+    {
+        if (leaf(i))
+        {
+            ld = m_a.shape()[0];
+            return m_a.data() + m_nodes[i].row0;
+        }
+        ld = 2 * m_a.shape()[1];
+        return m_nodes[i].v.data();
+    }
+
+    /**
+     * @return the upper triangular factor R, of shape (n, n)
+     */
+    template <class T>
+    inline auto tsqr_factorization<T>::r() const -> matrix_type
+    {
+        std::size_t n = m_a.shape()[1];
+        std::size_t ld;
+        const T* r = r_data(m_root, ld);
+        matrix_type R = matrix_type::from_shape({n, n});
+        R.fill(T(0));
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            std::copy(r + j * ld, r + j * ld + j + 1, R.data() + j * n);
+        }
+        return R;
+    }
+
+    /**
+     * Forms the orthonormal factor from the root of the tree to the
+     * leaves, in parallel.
+     * @return Q, of shape (m, n)
+     */
+    template <class T>
+    inline auto tsqr_factorization<T>::q() const -> matrix_type
+    {
+        using is_complex = xtl::is_complex<T>;
+        std::size_t m = m_a.shape()[0];
+        std::size_t n = m_a.shape()[1];
+        blas_index_t bm = to_blas_index(m), bn = to_blas_index(n);
+        matrix_type Q = matrix_type::from_shape({m, n});
+        Q.fill(T(0));
+
+        // the n x n block each node maps to its rows of Q, the identity at the root
+        std::vector<uvector<T>> inputs(m_nodes.size(), uvector<T>(n * n, T(0)));
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            inputs[m_root][j * n + j] = T(1);
+        }
+
+        detail::task_graph graph;
+        for (std::size_t i = m_nodes.size(); i-- > 0;)
+        {
+            const node* nd = &m_nodes[i];
+            uvector<T>* in = &inputs[i];
+            if (leaf(i))
+            {
+                T* block = Q.data() + nd->row0;
+                graph.add([=]()
+                {
+                    for (std::size_t c = 0; c < n; ++c)
+                    {
+                        std::copy(in->data() + c * n, in->data() + (c + 1) * n, block + c * m);
+                    }
+                    detail::tile_apply_q('N', to_blas_index(nd->rows), bn, bn, const_cast<T*>(m_a.data() + nd->row0), bm,
+                                         nd->tau.data(), block, bm, is_complex());
+                }, {in}, {nd});
+                continue;
+            }
+            uvector<T>* left = &inputs[nd->left];
+            uvector<T>* right = &inputs[nd->right];
+            graph.add([=]()
+            {
+                uvector<T> s(2 * n * n, T(0));
+                for (std::size_t c = 0; c < n; ++c)
+                {
+                    std::copy(in->data() + c * n, in->data() + (c + 1) * n, s.data() + c * 2 * n);
+                }
+                detail::tile_apply_q('N', 2 * bn, bn, bn, const_cast<T*>(nd->v.data()), 2 * bn, nd->tau.data(),
+                                     s.data(), 2 * bn, is_complex());
+                for (std::size_t c = 0; c < n; ++c)
+                {
+                    std::copy(s.data() + c * 2 * n, s.data() + c * 2 * n + n, left->data() + c * n);
+                    std::copy(s.data() + c * 2 * n + n, s.data() + (c + 1) * 2 * n, right->data() + c * n);
+                }
+            }, {in}, {left, right});
+        }
+        graph.run(m_threads);
+        return Q;
+    }
+
+    template <class T>
+    inline auto tsqr_factorization<T>::qh_columns(const matrix_type& b) const -> matrix_type
+    {
+        using is_complex = xtl::is_complex<T>;
+        std::size_t m = m_a.shape()[0];
+        std::size_t n = m_a.shape()[1];
+        std::size_t k = b.shape()[1];
+        blas_index_t bm = to_blas_index(m), bn = to_blas_index(n), bk = to_blas_index(k);
+        matrix_type c = b;
+
+        // the n leading rows of Q_node^H applied to the rows of the subtree
+        std::vector<uvector<T>> tops(m_nodes.size());
+        detail::task_graph graph;
+        for (std::size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            const node* nd = &m_nodes[i];
+            uvector<T>* top = &tops[i];
+            if (leaf(i))
+            {
+                T* block = c.data() + nd->row0;
+                graph.add([=]()
+                {
+                    detail::tile_apply_q('C', to_blas_index(nd->rows), bk, bn, const_cast<T*>(m_a.data() + nd->row0), bm,
+                                         nd->tau.data(), block, bm, is_complex());
+                    top->resize(n * k);
+                    for (std::size_t q = 0; q < k; ++q)
+                    {
+                        std::copy(block + q * m, block + q * m + n, top->data() + q * n);
+                    }
+                }, {}, {top});
+                continue;
+            }
+            const uvector<T>* left = &tops[nd->left];
+            const uvector<T>* right = &tops[nd->right];
+            graph.add([=]()
+            {
+                uvector<T> s(2 * n * k);
+                for (std::size_t q = 0; q < k; ++q)
+                {
+                    std::copy(left->data() + q * n, left->data() + (q + 1) * n, s.data() + q * 2 * n);
+                    std::copy(right->data() + q * n, right->data() + (q + 1) * n, s.data() + q * 2 * n + n);
+                }
+                detail::tile_apply_q('C', 2 * bn, bk, bn, const_cast<T*>(nd->v.data()), 2 * bn, nd->tau.data(),
+                                     s.data(), 2 * bn, is_complex());
+                top->resize(n * k);
+                for (std::size_t q = 0; q < k; ++q)
+                {
+                    std::copy(s.data() + q * 2 * n, s.data() + q * 2 * n + n, top->data() + q * n);
+                }
+            }, {left, right}, {top});
+        }
+        graph.run(m_threads);
+
+        matrix_type result = matrix_type::from_shape({n, k});
+        std::copy(tops[m_root].begin(), tops[m_root].end(), result.data());
+        return result;
+    }
+
+    /**
+     * @param b vector of m elements or matrix of m rows
+     * @return Q^H b, of n rows
+     */
+    template <class T>
+    template <class E>
+    inline auto tsqr_factorization<T>::apply_qh(const xexpression<E>& b) const
+    {
+        const auto& be = b.derived_cast();
+        if (be.dimension() < 1 || be.dimension() > 2 || be.shape()[0] != m_a.shape()[0])
+        {
+            XTENSOR_THROW(std::runtime_error, "tsqr: shape mismatch.");
+        }
+        std::size_t m = be.shape()[0];
+        std::size_t k = be.dimension() == 2 ? be.shape()[1] : 1;
+        matrix_type columns = matrix_type::from_shape({m, k});
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                columns(i, j) = be.dimension() == 2 ? be(i, j) : be(i);
+            }
+        }
+        matrix_type c = qh_columns(columns);
+        std::size_t n = c.shape()[0];
+        using result_type = xarray<T, layout_type::column_major>;
+        result_type result = be.dimension() == 2 ? result_type::from_shape({n, k}) : result_type::from_shape({n});
+        std::copy(c.begin(), c.end(), result.begin());
+        return result;
+    }
+
+    /**
+     * Solve the least squares problem min ||A x - b|| for the full rank
+     * \em A, by x = R^-1 Q^H b.
+     * @param b vector of m elements or matrix of m rows
+     * @return x, of n rows
+     */
+    template <class T>
+    template <class E>
+    inline auto tsqr_factorization<T>::solve(const xexpression<E>& b) const
+    {
+        auto x = apply_qh(b);
+        std::size_t ld;
+        const T* r = r_data(m_root, ld);
+        blas_index_t n = to_blas_index(m_a.shape()[1]);
+        for (blas_index_t i = 0; i < n; ++i)
+        {
+            if (r[std::size_t(i) * ld + std::size_t(i)] == T(0))
+            {
+                XTENSOR_THROW(std::runtime_error, "tsqr: A is rank deficient.");
+            }
+        }
+        blas_index_t k = x.dimension() == 2 ? to_blas_index(x.shape()[1]) : 1;
+        cxxblas::trsm<blas_index_t>(cxxblas::ColMajor, cxxblas::Left, cxxblas::Upper, cxxblas::NoTrans,
+                                    cxxblas::NonUnit, n, k, T(1), r, to_blas_index(ld), x.data(), n);
+        return x;
+    }
+
+    /**
+     * Triangular factor R of A = Q R, with A given as blocks of rows read
+     * one at a time, e.g. from a file by an input iterator. Only R and
+     * the current block are held: each block is factored stacked under R
+     * by geqrf, in O(k n^2) for k rows.
+     * @param first iterator to the first block, of shape (k, n)
+     * @param last past the end iterator
+     * @return R, of shape (n, n)
+     */
+    template <class It>
+    inline auto tsqr_r(It first, It last)
+    {
+        using block_type = std::decay_t<decltype(*first)>;
+        using value_type = typename block_type::value_type;
+        using matrix_type = xtensor<value_type, 2, layout_type::column_major>;
+        if (first == last)
+        {
+            XTENSOR_THROW(std::runtime_error, "tsqr_r: no blocks of rows.");
+        }
+
+        std::size_t n = (*first).shape()[1];
+        matrix_type R(std::array<std::size_t, 2>{n, n}, value_type(0));
+        xtensor<value_type, 1, layout_type::column_major> tau(std::array<std::size_t, 1>{n});
+        for (; first != last; ++first)
+        {
+            const auto& block = *first;
+            if (block.dimension() != 2 || block.shape()[1] != n)
+            {
+                XTENSOR_THROW(std::runtime_error, "tsqr_r: the blocks must have the same number of columns.");
+            }
+            std::size_t k = block.shape()[0];
+            matrix_type stacked(std::array<std::size_t, 2>{n + k, n});
+            xt::view(stacked, range(0, n), xt::all()) = R;
+            xt::view(stacked, range(n, n + k), xt::all()) = block;
+            if (lapack::geqrf(stacked, tau) != 0)
+            {
+                XTENSOR_THROW(std::runtime_error, "tsqr_r: QR update failed.");
+            }
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    R(i, j) = i <= j ? stacked(i, j) : value_type(0);
+                }
+            }
+        }
+        return R;
+    }
+
+    /**
+     * Streaming least squares: the pairs (A_k, B_k) of blocks of rows of A
+     * and B in [first, last) are added one at a time to an
+     * incremental_lstsq, which holds only R, Q^H B and the residuals.
+     * @param first iterator to the first pair, whose std::get<0> has shape
+     *        (k, n) and std::get<1> shape (k) or (k, nrhs)
+     * @param last past the end iterator
+     * @return the incremental_lstsq of the rows read, whose solve() is the
+     *         solution
+     */
+    template <class It>
+    inline auto lstsq_stream(It first, It last)
+    {
+        using block_type = std::decay_t<decltype(std::get<0>(*first))>;
+        using value_type = typename block_type::value_type;
+        if (first == last)
+        {
+            XTENSOR_THROW(std::runtime_error, "lstsq_stream: no blocks of rows.");
+        }
+
+        const auto& b = std::get<1>(*first);
+        incremental_lstsq<value_type> result(std::get<0>(*first).shape()[1],
+                                             b.dimension() == 1 ? std::size_t(1) : b.shape()[1]);
+        for (; first != last; ++first)
+        {
+            const auto& blocks = *first;
+            result.add_rows(std::get<0>(blocks), std::get<1>(blocks));
+        }
+        return result;
+    }
+}
+}
+
+#endif
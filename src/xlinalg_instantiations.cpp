@@ -0,0 +1,28 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <complex>
+
+#include "xtensor-blas/xlinalg_instantiations.hpp"
+
+namespace xt
+{
+    XTENSOR_BLAS_WORKSPACE_TEMPLATES(, float)
+    XTENSOR_BLAS_WORKSPACE_TEMPLATES(, double)
+    XTENSOR_BLAS_WORKSPACE_TEMPLATES(, std::complex<float>)
+    XTENSOR_BLAS_WORKSPACE_TEMPLATES(, std::complex<double>)
+
+namespace linalg
+{
+    XTENSOR_BLAS_LINALG_TEMPLATES(, float)
+    XTENSOR_BLAS_LINALG_TEMPLATES(, double)
+    XTENSOR_BLAS_LINALG_TEMPLATES(, std::complex<float>)
+    XTENSOR_BLAS_LINALG_TEMPLATES(, std::complex<double>)
+}
+}
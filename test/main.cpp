@@ -8,9 +8,20 @@
 
 #include "gtest/gtest.h"
 
+#if defined(XTENSOR_USE_SCALAPACK)
+#include <mpi.h>
+#endif
+
 int main(int argc, char* argv[])
 {
+#if defined(XTENSOR_USE_SCALAPACK)
+    MPI_Init(&argc, &argv);
+#endif
     ::testing::InitGoogleTest(&argc, argv);
-    return RUN_ALL_TESTS();
+    int result = RUN_ALL_TESTS();
+#if defined(XTENSOR_USE_SCALAPACK)
+    MPI_Finalize();
+#endif
+    return result;
 }
 
@@ -0,0 +1,92 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlinalg_async.hpp"
+
+namespace xt
+{
+    TEST(xlinalg_async, executor)
+    {
+        linalg::async::executor ex(2, 3, 1);
+        EXPECT_EQ(ex.size(), std::size_t(2));
+        EXPECT_EQ(ex.queue_depth(), std::size_t(3));
+
+        std::vector<std::future<int>> fs;
+        for (int i = 0; i < 20; ++i)
+        {
+            fs.push_back(ex.submit([i]() { return i * i; }));
+        }
+        for (int i = 0; i < 20; ++i)
+        {
+            EXPECT_EQ(fs[std::size_t(i)].get(), i * i);
+        }
+
+        auto f = ex.submit([]() -> int { throw std::runtime_error("task"); });
+        EXPECT_THROW(f.get(), std::runtime_error);
+    }
+
+    TEST(xlinalg_async, calls)
+    {
+        linalg::async::executor ex(2, 2, 1);
+
+        xarray<double> a = {{4., 1., 2.}, {1., 5., 3.}, {2., 3., 6.}};
+        xarray<double> b = {1., 2., 3.};
+
+        auto fdot = linalg::async::dot(ex, a, b);
+        auto fsolve = linalg::async::solve(ex, a, b);
+        auto feigh = linalg::async::eigh(ex, a);
+        auto fsvd = linalg::async::svd(ex, a, false);
+
+        // the operands were copied at submit
+        a.fill(0.);
+        b.fill(0.);
+
+        xarray<double> a0 = {{4., 1., 2.}, {1., 5., 3.}, {2., 3., 6.}};
+        xarray<double> b0 = {1., 2., 3.};
+
+        EXPECT_EQ(fdot.get(), linalg::dot(a0, b0));
+        EXPECT_TRUE(allclose(fsolve.get(), linalg::solve(a0, b0)));
+
+        auto eh = feigh.get();
+        auto eh0 = linalg::eigh(a0);
+        EXPECT_TRUE(allclose(std::get<0>(eh), std::get<0>(eh0)));
+
+        auto s = fsvd.get();
+        auto s0 = linalg::svd(a0, false);
+        EXPECT_TRUE(allclose(std::get<1>(s), std::get<1>(s0)));
+    }
+
+    TEST(xlinalg_async, expressions)
+    {
+        xtensor<double, 2> a = {{2., 0.}, {0., 4.}};
+        xtensor<double, 1> b = {2., 8.};
+
+        // the expressions are evaluated at submit
+        auto f = linalg::async::solve(2. * a, b + 0.);
+        a.fill(1.);
+        b.fill(0.);
+
+        xtensor<double, 1> expected = {0.5, 1.};
+        EXPECT_TRUE(allclose(f.get(), expected));
+
+        // a singular matrix, the exception reaches the caller through get
+        xarray<double> s = {{1., 2.}, {2., 4.}};
+        xarray<double> r = {1., 1.};
+        auto fs = linalg::async::solve(s, r);
+        EXPECT_THROW(fs.get(), std::runtime_error);
+    }
+}
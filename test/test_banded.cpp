@@ -0,0 +1,121 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <complex>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xcomplex.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xbanded.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+using namespace std::complex_literals;
+
+namespace xt
+{
+    TEST(xbanded, storage)
+    {
+        xarray<double> a = {{1., 2., 0., 0.},
+                            {3., 4., 5., 0.},
+                            {0., 6., 7., 8.},
+                            {0., 0., 9., 10.}};
+
+        xbanded<double> b(a, 1, 1);
+        EXPECT_EQ(b.kl(), 1u);
+        EXPECT_EQ(b.ku(), 1u);
+        EXPECT_EQ(b.storage().shape()[0], 3u);
+        EXPECT_EQ(b.storage()(0, 1), 2.);
+        EXPECT_EQ(b.storage()(1, 1), 4.);
+        EXPECT_EQ(b.storage()(2, 1), 6.);
+        EXPECT_EQ(b(3, 0), 0.);
+        EXPECT_EQ(b.dense(), a);
+
+        b.band(2, 3) = 11.;
+        EXPECT_EQ(b(2, 3), 11.);
+
+        xarray<double> r = {{1., 0., 0.},
+                            {2., 3., 0.},
+                            {0., 4., 5.},
+                            {0., 0., 6.},
+                            {0., 0., 0.}};
+        xbanded<double> rb(r, 1, 0);
+        EXPECT_EQ(rb.dense(), r);
+        xarray<double> v = {1., 2., 3.};
+        EXPECT_TRUE(allclose(linalg::dot(rb, v), linalg::dot(r, v)));
+    }
+
+    TEST(xbanded, solve)
+    {
+        xt::random::seed(0);
+        std::size_t n = 12;
+        xarray<double> rhs = xt::random::rand<double>({n, 3});
+        xarray<double> v = xt::random::rand<double>({n});
+
+        for (auto band : {std::make_pair(1, 1), std::make_pair(2, 1), std::make_pair(0, 3)})
+        {
+            std::size_t kl = static_cast<std::size_t>(band.first), ku = static_cast<std::size_t>(band.second);
+            xarray<double> r = xt::random::rand<double>({n, n}) + 4. * xt::eye<double>(n);
+            xarray<double> a = xt::zeros<double>({n, n});
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    if (i <= j + kl && j <= i + ku)
+                    {
+                        a(i, j) = r(i, j);
+                    }
+                }
+            }
+            xbanded<double> b(a, kl, ku);
+
+            EXPECT_TRUE(allclose(linalg::dot(b, rhs), linalg::dot(a, rhs)));
+            EXPECT_TRUE(allclose(linalg::dot(b, v), linalg::dot(a, v)));
+            EXPECT_TRUE(allclose(linalg::solve_banded(b, rhs), linalg::solve(a, rhs)));
+            EXPECT_TRUE(allclose(linalg::solve_banded(b, v), linalg::solve(a, v)));
+
+            auto lu = linalg::lu_factor(b);
+            EXPECT_FALSE(lu.singular());
+            EXPECT_TRUE(allclose(lu.solve(rhs), linalg::solve(a, rhs)));
+            EXPECT_TRUE(allclose(lu.solve(v, 'T'), linalg::solve(xt::transpose(a), v)));
+            EXPECT_NEAR(lu.det(), linalg::det(a), 1e-8 * std::abs(linalg::det(a)));
+            EXPECT_NEAR(lu.rcond(), linalg::lu_factor(a).rcond(), 1e-12);
+        }
+
+        xbanded<double> singular(3, 3, 1, 1, 0.);
+        EXPECT_THROW(linalg::solve_banded(singular, xarray<double>{1., 2., 3.}), std::runtime_error);
+        EXPECT_TRUE(linalg::lu_factor(singular).singular());
+    }
+
+    TEST(xbanded, tridiagonal)
+    {
+        xarray<double> dl = {1., 1.};
+        xarray<double> d = {4., 4., 4.};
+        xarray<double> du = {2., 2.};
+        xarray<double> b = {6., 7., 5.};
+        xarray<double> expected = {1., 1., 1.};
+        EXPECT_TRUE(allclose(linalg::solve_tridiagonal(dl, d, du, b), expected));
+
+        xarray<double> b_sym = {5., 6., 5.};
+        EXPECT_TRUE(allclose(linalg::solveh_tridiagonal(d, dl, b_sym), expected));
+
+        xarray<std::complex<double>> e = {1i, 1i};
+        xarray<std::complex<double>> h = {{4. + 0i, 0. - 1i, 0. + 0i},
+                                          {0. + 1i, 4. + 0i, 0. - 1i},
+                                          {0. + 0i, 0. + 1i, 4. + 0i}};
+        xarray<std::complex<double>> bh = {4. + 1i, 2. + 3i, 1. - 1i};
+        EXPECT_TRUE(allclose(linalg::solveh_tridiagonal(d, e, bh), linalg::solve(h, bh)));
+
+        xarray<double> not_definite = {-1., 4., 4.};
+        EXPECT_THROW(linalg::solveh_tridiagonal(not_definite, dl, b_sym), std::runtime_error);
+    }
+}
@@ -7,8 +7,13 @@
 * The full license is in the file LICENSE, distributed with this software. *
 ****************************************************************************/
 
+#include <cmath>
+#include <complex>
+#include <sstream>
+
 #include "gtest/gtest.h"
 #include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
 #include "xtensor/xview.hpp"
 #include "xtensor/xbuilder.hpp"
 #include "xtensor/xrandom.hpp"
@@ -142,6 +147,67 @@ namespace xt
         }
     }
 
+    TEST(xblas, outer_into)
+    {
+        xarray<double> a = {1., 2., 3.};
+        xarray<double> b = {4., -5.};
+        xarray<double> c = {{1., 0.}, {0., 1.}, {1., 1.}};
+        xarray<double> expected = c + 2. * linalg::outer(a, b);
+
+        linalg::outer_into(a, b, c, 2.);
+        EXPECT_TRUE(allclose(expected, c));
+
+        xtensor<double, 2, layout_type::column_major> cc = {{1., 0.}, {0., 1.}, {1., 1.}};
+        linalg::outer_into(a, view(b, range(xt::placeholders::_, xt::placeholders::_, -1)), cc);
+        EXPECT_DOUBLE_EQ(cc(2, 0), 1. - 15.);
+        EXPECT_DOUBLE_EQ(cc(1, 1), 1. + 8.);
+
+        xarray<double> wrong = zeros<double>({2, 2});
+        EXPECT_THROW(linalg::outer_into(a, b, wrong), std::runtime_error);
+    }
+
+    TEST(xblas, quad_form)
+    {
+        xt::random::seed(9);
+        xt::xtensor<double, 2> A = xt::random::randn<double>({5, 4});
+        xt::xtensor<double, 1> x = xt::random::randn<double>({5});
+        xt::xtensor<double, 1> y = xt::random::randn<double>({4});
+        double expected = linalg::vdot(x, linalg::dot(A, y));
+        EXPECT_NEAR(linalg::quad_form(x, A, y), expected, 1e-12);
+
+        // only the lower triangle of a symmetric A is read
+        xt::xtensor<double, 2> S = xt::random::randn<double>({4, 4});
+        S = S + xt::transpose(S);
+        xt::xtensor<double, 2> Sl = xt::tril(S) + 100. * xt::triu(xt::ones<double>({4, 4}), 1);
+        EXPECT_NEAR(linalg::quad_form(y, Sl, linalg::assume_a::symmetric), linalg::vdot(y, linalg::dot(S, y)), 1e-12);
+        EXPECT_THROW(linalg::quad_form(x, A, x), std::runtime_error);
+
+        // Mahalanobis distances of N points, across several blocks of rows
+        std::size_t N = 5000, n = 16;
+        xt::xtensor<double, 2> X = xt::random::randn<double>({N, n});
+        xt::xtensor<double, 2> W = xt::random::randn<double>({n, n});
+        xt::xtensor<double, 2> P = linalg::dot(W, xt::transpose(W));
+        xt::xtensor<double, 1> d = xt::sum(linalg::dot(X, P) * X, {1});
+        EXPECT_TRUE(xt::allclose(linalg::batched_quad_form(X, P), d));
+        EXPECT_TRUE(xt::allclose(linalg::batched_quad_form(X, P, linalg::assume_a::positive_definite), d));
+        xt::xtensor<double, 2> Y = xt::random::randn<double>({N, n});
+        EXPECT_TRUE(xt::allclose(linalg::batched_quad_form(X, W, Y), xt::sum(linalg::dot(X, W) * Y, {1})));
+
+        // the rows of X are conjugated, and a Hermitian A gives real forms
+        using cd = std::complex<double>;
+        xt::xtensor<cd, 2> H = {{cd(2, 0), cd(1, -1)}, {cd(1, 1), cd(3, 0)}};
+        xt::xtensor<cd, 2> Z = {{cd(1, 2), cd(0, 1)}, {cd(-1, 0), cd(2, -1)}};
+        auto h = linalg::batched_quad_form(Z, H, linalg::assume_a::hermitian);
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            xt::xtensor<cd, 1> z = xt::view(Z, i, xt::all());
+            cd e = linalg::vdot(z, linalg::dot(H, z));
+            EXPECT_NEAR(std::abs(h(i) - e), 0., 1e-12);
+            EXPECT_NEAR(h(i).imag(), 0., 1e-12);
+            EXPECT_NEAR(std::abs(linalg::quad_form(z, H, linalg::assume_a::hermitian) - e), 0., 1e-12);
+        }
+    }
+
     TEST(xblas, nan_result)
     {
         xt::xarray<double> X = {{1, 2, 3},
@@ -179,6 +245,238 @@ namespace xt
         EXPECT_TRUE(all(equal(expO, O)));
     }
 
+    TEST(xblas, gemm_dynamic_layout)
+    {
+        xt::random::seed(7);
+        xt::xtensor<double, 2> A = xt::random::randn<double>({20, 18});
+        xt::xtensor<double, 2, layout_type::column_major> B = xt::random::randn<double>({18, 21});
+        xt::xtensor<double, 2> expected = xt::zeros<double>({20, 21});
+        xt::blas::gemm(A, B, expected, false, false, 2.0, 0.0);
+
+        for (auto l : {layout_type::row_major, layout_type::column_major})
+        {
+            xt::xarray<double, layout_type::dynamic> R(std::vector<std::size_t>{20, 21}, l);
+            R.fill(1.0);
+            xt::blas::gemm(A, B, R, false, false, 2.0, 0.5);
+            EXPECT_EQ(R.layout(), l);
+            EXPECT_TRUE(xt::allclose(R, expected + 0.5));
+
+            xt::xarray<double, layout_type::dynamic> Rt(std::vector<std::size_t>{21, 20}, l);
+            xt::blas::gemm(B, A, Rt, true, true, 2.0, 0.0);
+            EXPECT_TRUE(xt::allclose(Rt, xt::transpose(expected)));
+        }
+    }
+
+    TEST(xblas, level3_dynamic_layout)
+    {
+        xt::random::seed(8);
+        xt::xtensor<double, 2> A = xt::random::randn<double>({12, 7});
+        xt::xtensor<double, 2> S = xt::random::randn<double>({12, 12});
+        S = S + xt::transpose(S);
+        xt::xtensor<double, 2> L = xt::tril(xt::random::randn<double>({12, 12})) + 12. * xt::eye<double>(12);
+        xt::xtensor<double, 2> B = xt::random::randn<double>({12, 7});
+        xt::xtensor<double, 2> AAt = linalg::dot(A, xt::transpose(A));
+
+        for (auto l : {layout_type::row_major, layout_type::column_major})
+        {
+            xt::xarray<double, layout_type::dynamic> C(std::vector<std::size_t>{12, 7}, l);
+            xt::blas::symm(S, B, C);
+            EXPECT_EQ(C.layout(), l);
+            EXPECT_TRUE(xt::allclose(C, linalg::dot(S, B)));
+
+            xt::xarray<double, layout_type::dynamic> G(std::vector<std::size_t>{12, 12}, l);
+            G.fill(0.);
+            xt::blas::syrk(A, G, 'L');
+            EXPECT_TRUE(xt::allclose(xt::tril(G), xt::tril(AAt)));
+
+            xt::xarray<double, layout_type::dynamic> X(std::vector<std::size_t>{12, 7}, l);
+            X = B;
+            xt::blas::trsm(L, X);
+            EXPECT_TRUE(xt::allclose(linalg::dot(L, X), B));
+
+            // a Fortran-ordered stack of matrices times a matrix is one GEMM
+            xt::xarray<double, layout_type::dynamic> T(std::vector<std::size_t>{3, 4, 7}, l);
+            T = xt::random::randn<double>({3, 4, 7});
+            xt::xarray<double> T_row = T;
+            xt::xtensor<double, 2> W = xt::random::randn<double>({7, 5});
+            EXPECT_TRUE(xt::allclose(linalg::dot(T, W), linalg::dot(T_row, W)));
+        }
+
+        // strided views of dynamic layout, with a leading dimension and
+        // without (computed in a temporary)
+        xt::xtensor<double, 3> P = xt::zeros<double>({12, 2, 7});
+        auto Pv = xt::view(P, xt::all(), 1, xt::all());
+        xt::blas::symm(S, B, Pv);
+        EXPECT_TRUE(xt::allclose(Pv, linalg::dot(S, B)));
+        xt::xtensor<double, 2> Q = xt::zeros<double>({12, 14});
+        auto Qv = xt::view(Q, xt::all(), xt::range(0, 14, 2));
+        xt::blas::symm(S, B, Qv);
+        EXPECT_TRUE(xt::allclose(Qv, linalg::dot(S, B)));
+    }
+
+    TEST(xblas, small_gemm)
+    {
+        std::size_t default_threshold = xt::blas::small_gemm_threshold();
+        EXPECT_EQ(default_threshold, 16u);
+
+        xt::random::seed(42);
+        for (std::size_t n : {1, 3, 4, 7, 16})
+        {
+            xt::xtensor<double, 2> A = xt::random::randn<double>({n, n + 1});
+            xt::xtensor<double, 2, layout_type::column_major> B = xt::random::randn<double>({n + 1, n});
+            xt::xtensor<double, 2> C0 = xt::random::randn<double>({n, n});
+
+            // inline kernel against BLAS, with mixed storage orders and
+            // the transposed product
+            xt::xtensor<double, 2> C = C0, expected = C0;
+            xt::blas::gemm(A, B, C, false, false, 2.0, 0.5);
+            xt::xtensor<double, 2, layout_type::column_major> Ct = xt::zeros<double>({n + 1, n + 1});
+            xt::blas::gemm(A, B, Ct, true, true);
+
+            xt::blas::set_small_gemm_threshold(0);
+            xt::blas::gemm(A, B, expected, false, false, 2.0, 0.5);
+            xt::xtensor<double, 2, layout_type::column_major> expected_t = xt::zeros<double>({n + 1, n + 1});
+            xt::blas::gemm(A, B, expected_t, true, true);
+            xt::xarray<double> expected_dot = xt::linalg::dot(A, xt::transpose(A));
+            xt::blas::set_small_gemm_threshold(default_threshold);
+
+            EXPECT_TRUE(xt::allclose(C, expected));
+            EXPECT_TRUE(xt::allclose(Ct, expected_t));
+            EXPECT_TRUE(xt::allclose(xt::linalg::dot(A, xt::transpose(A)), expected_dot));
+        }
+    }
+
+    TEST(xblas, complex_gemm_3m)
+    {
+        using cd = std::complex<double>;
+        EXPECT_FALSE(xt::blas::complex_gemm_3m());
+
+        xt::random::seed(11);
+        xt::xtensor<double, 2> a_re = xt::random::randn<double>({40, 30});
+        xt::xtensor<double, 2> a_im = xt::random::randn<double>({40, 30});
+        xt::xtensor<double, 2> b_re = xt::random::randn<double>({30, 35});
+        xt::xtensor<double, 2> b_im = xt::random::randn<double>({30, 35});
+        xt::xtensor<cd, 2> A = a_re + cd(0, 1) * a_im;
+        xt::xtensor<cd, 2, layout_type::column_major> B = b_re + cd(0, 1) * b_im;
+        xt::xtensor<cd, 2> expected = xt::linalg::dot(A, B);
+
+        xt::blas::set_complex_gemm_3m(true);
+        EXPECT_TRUE(xt::blas::complex_gemm_3m());
+        xt::xtensor<cd, 2> C = xt::linalg::dot(A, B);
+        xt::xtensor<cd, 2> Ch = xt::linalg::dot(xt::conj(xt::transpose(B)), xt::transpose(A));
+        xt::blas::set_complex_gemm_3m(false);
+
+        EXPECT_TRUE(xt::allclose(C, expected));
+        EXPECT_TRUE(xt::allclose(Ch, xt::conj(xt::transpose(expected))));
+    }
+
+    TEST(xblas, num_threads)
+    {
+        int threads = xt::blas::get_num_threads();
+        xt::xarray<double> a = {{1, 2}, {3, 4}};
+        xt::xarray<double> expected = {{7, 10}, {15, 22}};
+        {
+            xt::blas::scoped_num_threads guard(1);
+            EXPECT_EQ(xt::blas::get_num_threads(), 1);
+            EXPECT_TRUE(all(equal(xt::linalg::dot(a, a), expected)));
+        }
+        EXPECT_EQ(xt::blas::get_num_threads(), threads);
+
+        auto res = xt::blas::with_num_threads(1, [&]() { return xt::linalg::dot(a, a); });
+        EXPECT_TRUE(all(equal(res, expected)));
+        EXPECT_EQ(xt::blas::get_num_threads(), threads);
+    }
+
+    TEST(xblas, blas_index_overflow)
+    {
+        using limits = std::numeric_limits<xt::blas_index_t>;
+        EXPECT_EQ(xt::to_blas_index(std::size_t(42)), xt::blas_index_t(42));
+        EXPECT_EQ(xt::to_blas_index(std::ptrdiff_t(-3)), xt::blas_index_t(-3));
+        EXPECT_EQ(xt::to_blas_index(std::size_t(limits::max())), limits::max());
+        EXPECT_THROW(xt::to_blas_index(std::size_t(limits::max()) + 1), std::overflow_error);
+        if (sizeof(xt::blas_index_t) < sizeof(std::ptrdiff_t))
+        {
+            EXPECT_THROW(xt::to_blas_index(std::ptrdiff_t(limits::min()) - 1), std::overflow_error);
+        }
+    }
+
+    TEST(xblas, instrument_aggregator)
+    {
+        instrument::aggregator stats;
+        instrument::set_sink(stats.as_sink());
+        for (int i = 0; i < 3; ++i)
+        {
+            instrument::scoped_call call("gemm", 4, 5, 6, layout_type::row_major, 'N', 'T',
+                                         instrument::fma_flops<double>(4 * 5 * 6));
+        }
+        xtensor<float, 2> a = {{1, 2}, {3, 4}, {5, 6}};
+        {
+            instrument::scoped_call copy(instrument::copy_tag(), "copy_to_layout", a, layout_type::column_major);
+        }
+        instrument::set_sink({});
+        {
+            instrument::scoped_call ignored("gemm", 4, 5, 6, layout_type::row_major, 'N', 'T');
+        }
+
+        auto entries = stats.entries();
+        ASSERT_EQ(entries.size(), std::size_t(2));
+        auto gemm = entries.at(std::make_tuple(std::string("gemm"), std::size_t(4), std::size_t(5), std::size_t(6),
+                                               layout_type::row_major, 'N', 'T'));
+        EXPECT_EQ(gemm.calls, std::size_t(3));
+        EXPECT_EQ(gemm.flops, 3 * 240.);
+        auto copy = entries.at(std::make_tuple(std::string("copy_to_layout"), std::size_t(3), std::size_t(2),
+                                               std::size_t(0), layout_type::column_major, char(0), char(0)));
+        EXPECT_EQ(copy.calls, std::size_t(1));
+        EXPECT_EQ(copy.copy_bytes, 6 * sizeof(float));
+
+        std::stringstream out;
+        stats.dump(out);
+        EXPECT_NE(out.str().find("copy_to_layout"), std::string::npos);
+        stats.clear();
+        EXPECT_TRUE(stats.entries().empty());
+    }
+
+    TEST(xblas, copy_diagnostics)
+    {
+        using row_major = xtensor<double, 2, layout_type::row_major>;
+        using column_major = xtensor<double, 2, layout_type::column_major>;
+        EXPECT_FALSE((view_eval_copies<row_major>::value));
+        EXPECT_TRUE((view_eval_copies<row_major, layout_type::column_major>::value));
+        EXPECT_FALSE((view_eval_copies<column_major&, layout_type::column_major>::value));
+
+        reset_copy_statistics();
+        row_major a = {{1, 2, 3}, {4, 5, 6}};
+        detail::report_copy("copy_to_layout", a);
+        auto stats = get_copy_statistics();
+        EXPECT_EQ(stats.copies, std::size_t(1));
+        EXPECT_EQ(stats.bytes, 6 * sizeof(double));
+        reset_copy_statistics();
+        EXPECT_EQ(get_copy_statistics().copies, std::size_t(0));
+    }
+
+    TEST(xblas, layout_copy)
+    {
+        xt::random::seed(3);
+        // large enough for the tiled copy, with partial tiles
+        xt::xtensor<double, 2> a = xt::random::randn<double>({130, 75});
+        xt::xtensor<double, 2, layout_type::column_major> ac = copy_to_layout<layout_type::column_major>(a);
+        EXPECT_EQ(ac, a);
+        xt::xtensor<double, 2> back = copy_to_layout<layout_type::row_major>(ac);
+        EXPECT_EQ(back, a);
+
+        xt::xarray<double> x = a;
+        auto xc = copy_to_layout<layout_type::column_major>(x);
+        EXPECT_EQ(xc.layout(), layout_type::column_major);
+        EXPECT_EQ(xc, x);
+
+        // strided and transposed views
+        auto v = xt::view(a, xt::range(0, 130, 2), xt::all());
+        xt::xtensor<double, 2, layout_type::column_major> vc = view_eval<layout_type::column_major>(v);
+        EXPECT_EQ(vc, v);
+        auto t = xt::transpose(a);
+        EXPECT_EQ(copy_to_layout<layout_type::row_major>(t), t);
+    }
+
     TEST(xblas, gemv_transpose)
     {
         xt::xarray<double> X = {{1, 2, 3},
@@ -192,4 +490,366 @@ namespace xt
 
         EXPECT_TRUE(all(equal(expR, R)));
     }
+
+    TEST(xblas, strided_views)
+    {
+        xt::xtensor<double, 2> A = {{1, 2, 3, 4},
+                                    {5, 6, 7, 8},
+                                    {9, 10, 11, 12}};
+        xt::xtensor<double, 2> B = {{1, -1},
+                                    {2, 0},
+                                    {0, 3},
+                                    {1, 1}};
+
+        // leading dimension larger than the number of columns
+        auto A_sub = xt::view(A, xt::all(), xt::range(1, 4));
+        auto B_sub = xt::view(B, xt::range(0, 3), xt::all());
+        xt::xtensor<double, 2> A_sub_copy = A_sub;
+        xt::xtensor<double, 2> B_sub_copy = B_sub;
+
+        xt::xtensor<double, 2> M = xt::zeros<double>({3, 2});
+        xt::xtensor<double, 2> M_expected = xt::zeros<double>({3, 2});
+        xt::blas::gemm(A_sub, B_sub, M);
+        xt::blas::gemm(A_sub_copy, B_sub_copy, M_expected);
+        EXPECT_TRUE(xt::allclose(M_expected, M));
+
+        // transposed views are read in the opposite storage order
+        auto At = xt::transpose(A);
+        xt::xtensor<double, 2> At_copy = At;
+        xt::xtensor<double, 2> N = xt::zeros<double>({4, 4});
+        xt::xtensor<double, 2> N_expected = xt::zeros<double>({4, 4});
+        xt::blas::gemm(At, A, N);
+        xt::blas::gemm(At_copy, A, N_expected);
+        EXPECT_TRUE(xt::allclose(N_expected, N));
+
+        xt::xtensor<double, 2, xt::layout_type::column_major> P = xt::zeros<double>({2, 3});
+        xt::xtensor<double, 2, xt::layout_type::column_major> P_expected = xt::zeros<double>({2, 3});
+        xt::blas::gemm(B_sub, A_sub, P, true, true);
+        xt::blas::gemm(B_sub_copy, A_sub_copy, P_expected, true, true);
+        EXPECT_TRUE(xt::allclose(P_expected, P));
+
+        xt::xtensor<double, 1> x = {1, 2, -1};
+        xt::xtensor<double, 1> y = xt::zeros<double>({3});
+        xt::xtensor<double, 1> y_expected = xt::zeros<double>({3});
+        xt::blas::gemv(A_sub, x, y);
+        xt::blas::gemv(A_sub_copy, x, y_expected);
+        EXPECT_TRUE(xt::allclose(y_expected, y));
+
+        xt::xtensor<double, 1> z = xt::zeros<double>({4});
+        xt::xtensor<double, 1> z_expected = xt::zeros<double>({4});
+        xt::blas::gemv(At, x, z);
+        xt::blas::gemv(At_copy, x, z_expected);
+        EXPECT_TRUE(xt::allclose(z_expected, z));
+    }
+
+    TEST(xblas, packed_strided_gemm)
+    {
+        xt::random::seed(5);
+        // views with no unit stride, the inner dimension over two blocks
+        xt::xtensor<double, 2> A = xt::random::randn<double>({60, 900});
+        xt::xtensor<double, 2, xt::layout_type::column_major> B = xt::random::randn<double>({600, 20});
+        auto A_sub = xt::view(A, xt::range(0, 60, 2), xt::range(0, 900, 3));
+        auto B_sub = xt::view(B, xt::range(0, 600, 2), xt::range(1, 20, 2));
+        xt::xtensor<double, 2> A_sub_copy = A_sub;
+        xt::xtensor<double, 2> B_sub_copy = B_sub;
+
+        xt::xtensor<double, 2> M = xt::ones<double>({30, 10});
+        xt::xtensor<double, 2> M_expected = xt::ones<double>({30, 10});
+        xt::blas::gemm(A_sub, B_sub, M, false, false, 2.0, 0.5);
+        xt::blas::gemm(A_sub_copy, B_sub_copy, M_expected, false, false, 2.0, 0.5);
+        EXPECT_TRUE(xt::allclose(M_expected, M));
+
+        // one strided operand next to one read in place, transposed
+        xt::xtensor<double, 2, xt::layout_type::column_major> P = xt::zeros<double>({10, 30});
+        xt::xtensor<double, 2, xt::layout_type::column_major> P_expected = xt::zeros<double>({10, 30});
+        xt::blas::gemm(B_sub_copy, A_sub, P, true, true);
+        xt::blas::gemm(B_sub_copy, A_sub_copy, P_expected, true, true);
+        EXPECT_TRUE(xt::allclose(P_expected, P));
+
+        EXPECT_TRUE(xt::allclose(linalg::dot(A_sub, B_sub), linalg::dot(A_sub_copy, B_sub_copy)));
+        xt::xtensor<double, 2, xt::layout_type::column_major> D = xt::ones<double>({30, 10});
+        linalg::dot_into(A_sub, B_sub_copy, D, 2.0, 0.5);
+        EXPECT_TRUE(xt::allclose(D, M_expected));
+    }
+
+    TEST(xblas, negative_strides)
+    {
+        xt::xtensor<double, 1> a = {1, -2, 3, -4, 5, -6};
+        xt::xtensor<double, 2> m = {{1, 2, 3},
+                                    {4, 5, 6},
+                                    {7, 8, 9}};
+
+        auto rev = xt::view(a, xt::range(xt::placeholders::_, xt::placeholders::_, -1));
+        auto every_other = xt::view(a, xt::range(1, 6, 2));
+        auto col = xt::view(m, xt::all(), 1);
+        xt::xtensor<double, 1> rev_copy = rev;
+        xt::xtensor<double, 1> every_other_copy = every_other;
+        xt::xtensor<double, 1> col_copy = col;
+
+        double r1 = 0, r2 = 0;
+        xt::blas::asum(rev, r1);
+        xt::blas::asum(rev_copy, r2);
+        EXPECT_DOUBLE_EQ(r2, r1);
+
+        xt::blas::nrm2(rev, r1);
+        xt::blas::nrm2(rev_copy, r2);
+        EXPECT_DOUBLE_EQ(r2, r1);
+
+        auto rev_head = xt::view(a, xt::range(4, xt::placeholders::_, -2));
+        xt::xtensor<double, 1> rev_head_copy = rev_head;
+        xt::blas::dot(rev_head, every_other, r1);
+        xt::blas::dot(rev_head_copy, every_other_copy, r2);
+        EXPECT_DOUBLE_EQ(r2, r1);
+
+        xt::blas::dot(col, every_other, r1);
+        xt::blas::dot(col_copy, every_other_copy, r2);
+        EXPECT_DOUBLE_EQ(r2, r1);
+
+        xt::xtensor<double, 1> y = xt::zeros<double>({3});
+        xt::xtensor<double, 1> y_expected = xt::zeros<double>({3});
+        xt::blas::gemv(m, rev_head, y);
+        xt::blas::gemv(m, rev_head_copy, y_expected);
+        EXPECT_TRUE(xt::allclose(y_expected, y));
+
+        xt::xtensor<double, 2> o = xt::zeros<double>({3, 3});
+        xt::xtensor<double, 2> o_expected = xt::zeros<double>({3, 3});
+        xt::blas::ger(col, rev_head, o);
+        xt::blas::ger(col_copy, rev_head_copy, o_expected);
+        EXPECT_TRUE(xt::allclose(o_expected, o));
+    }
+
+    TEST(xblas, level1)
+    {
+        xt::xtensor<double, 1> x = {1, -2, 3, -4};
+        xt::xtensor<double, 1> y = {2, 2, 2, 2};
+
+        xt::blas::axpy(x, y, 2.0);
+        xt::xtensor<double, 1> exp_axpy = {4, -2, 8, -6};
+        EXPECT_EQ(exp_axpy, y);
+
+        xt::blas::axpby(x, y, 1.0, 0.5);
+        xt::xtensor<double, 1> exp_axpby = {3, -3, 7, -7};
+        EXPECT_EQ(exp_axpby, y);
+
+        xt::blas::scal(y, -1.0);
+        xt::xtensor<double, 1> exp_scal = {-3, 3, -7, 7};
+        EXPECT_EQ(exp_scal, y);
+
+        std::size_t idx = 0;
+        xt::blas::iamax(x, idx);
+        EXPECT_EQ(3u, idx);
+
+        auto rev = xt::view(x, xt::range(xt::placeholders::_, xt::placeholders::_, -1));
+        xt::blas::iamax(rev, idx);
+        EXPECT_EQ(0u, idx);
+
+        xt::blas::copy(rev, y);
+        xt::xtensor<double, 1> exp_copy = {-4, 3, -2, 1};
+        EXPECT_EQ(exp_copy, y);
+
+        xt::blas::swap(x, y);
+        xt::xtensor<double, 1> exp_x = {-4, 3, -2, 1};
+        xt::xtensor<double, 1> exp_y = {1, -2, 3, -4};
+        EXPECT_EQ(exp_x, x);
+        EXPECT_EQ(exp_y, y);
+
+        xt::xtensor<double, 1> u = {1, 0};
+        xt::xtensor<double, 1> v = {0, 1};
+        xt::blas::rot(u, v, 0.6, 0.8);
+        xt::xtensor<double, 1> exp_u = {0.6, 0.8};
+        xt::xtensor<double, 1> exp_v = {-0.8, 0.6};
+        EXPECT_TRUE(xt::allclose(exp_u, u));
+        EXPECT_TRUE(xt::allclose(exp_v, v));
+
+        double ga = 3, gb = 4, gc = 0, gs = 0;
+        xt::blas::rotg(ga, gb, gc, gs);
+        EXPECT_NEAR(5., ga, 1e-14);
+        EXPECT_NEAR(0.6, gc, 1e-14);
+        EXPECT_NEAR(0.8, gs, 1e-14);
+
+        double d1 = 1, d2 = 1, x1 = 3;
+        std::array<double, 5> param;
+        xt::blas::rotmg(d1, d2, x1, 4., param);
+        xt::xtensor<double, 1> mx = {3, 1};
+        xt::xtensor<double, 1> my = {4, 2};
+        xt::blas::rotm(mx, my, param);
+        EXPECT_NEAR(x1, mx(0), 1e-14);
+        EXPECT_NEAR(0., my(0), 1e-14);
+        EXPECT_NEAR(5., std::sqrt(d1) * x1, 1e-14);
+    }
+
+    TEST(xblas, structured)
+    {
+        xt::xtensor<double, 2> S = {{4, 1, 2},
+                                    {1, 5, 3},
+                                    {2, 3, 6}};
+        xt::xtensor<double, 2> L = {{2, 0, 0},
+                                    {1, 3, 0},
+                                    {4, -1, 5}};
+        xt::xtensor<double, 2> B = {{1, 2},
+                                    {-1, 0},
+                                    {3, 1}};
+        xt::xtensor<double, 1> x = {1, -2, 0.5};
+
+        // only the referenced triangle is read
+        xt::xtensor<double, 2> S_lower = S;
+        S_lower(0, 1) = S_lower(0, 2) = S_lower(1, 2) = 100;
+
+        xt::xtensor<double, 2> C = xt::zeros<double>({3, 2});
+        xt::blas::symm(S_lower, B, C, 'L', 'L');
+        EXPECT_TRUE(xt::allclose(linalg::dot(S, B), C));
+
+        xt::xtensor<double, 1> y = xt::zeros<double>({3});
+        xt::blas::symv(xt::transpose(S_lower), x, y, 'U');
+        EXPECT_TRUE(xt::allclose(linalg::dot(S, x), y));
+
+        xt::xtensor<double, 2> G = xt::zeros<double>({3, 3});
+        xt::blas::syrk(B, G, 'L');
+        xt::xtensor<double, 2> G_expected = linalg::dot(B, xt::transpose(B));
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            for (std::size_t j = 0; j <= i; ++j)
+            {
+                EXPECT_DOUBLE_EQ(G_expected(i, j), G(i, j));
+            }
+        }
+
+        xt::xtensor<double, 2> H = xt::zeros<double>({2, 2});
+        xt::blas::syr2k(B, B, H, 'U', true);
+        xt::xtensor<double, 2> H_expected = 2.0 * linalg::dot(xt::transpose(B), B);
+        EXPECT_DOUBLE_EQ(H_expected(0, 0), H(0, 0));
+        EXPECT_DOUBLE_EQ(H_expected(0, 1), H(0, 1));
+        EXPECT_DOUBLE_EQ(H_expected(1, 1), H(1, 1));
+
+        xt::xtensor<double, 2> X = B;
+        xt::blas::trmm(L, X);
+        EXPECT_TRUE(xt::allclose(linalg::dot(L, B), X));
+        xt::blas::trsm(L, X);
+        EXPECT_TRUE(xt::allclose(B, X));
+
+        xt::xtensor<double, 2, xt::layout_type::column_major> Xc = B;
+        xt::blas::trsm(xt::transpose(L), Xc, 'L', 'U', true);
+        EXPECT_TRUE(xt::allclose(linalg::solve(L, B), Xc));
+
+        xt::xtensor<double, 1> z = x;
+        xt::blas::trmv(L, z, 'L', true);
+        EXPECT_TRUE(xt::allclose(linalg::dot(xt::transpose(L), x), z));
+
+        // tridiagonal S in LAPACK band storage (kl = ku = 1)
+        xt::xtensor<double, 2, xt::layout_type::column_major> AB = {{0, 1, 3},
+                                                                    {4, 5, 6},
+                                                                    {1, 3, 0}};
+        xt::xtensor<double, 2> T = {{4, 1, 0},
+                                    {1, 5, 3},
+                                    {0, 3, 6}};
+        xt::xtensor<double, 1> w = xt::zeros<double>({3});
+        xt::blas::gbmv(AB, x, w, 1, 1);
+        EXPECT_TRUE(xt::allclose(linalg::dot(T, x), w));
+    }
+
+    TEST(xblas, gemmt)
+    {
+        xt::random::seed(13);
+        xt::xtensor<double, 2> A = xt::random::randn<double>({150, 40});
+        xt::xtensor<double, 2, layout_type::column_major> B = xt::random::randn<double>({150, 40});
+        xt::xtensor<double, 2> expected = linalg::dot(A, xt::transpose(B));
+
+        for (char uplo : {'L', 'U'})
+        {
+            // the other triangle is left untouched
+            xt::xtensor<double, 2> C = xt::ones<double>({150, 150});
+            xt::blas::gemmt(A, B, C, uplo, false, true, 2.0, 0.5);
+            for (std::size_t i = 0; i < 150; ++i)
+            {
+                for (std::size_t j = 0; j < 150; ++j)
+                {
+                    bool in_triangle = uplo == 'L' ? j <= i : i <= j;
+                    EXPECT_NEAR(in_triangle ? 2.0 * expected(i, j) + 0.5 : 1.0, C(i, j), 1e-10);
+                }
+            }
+        }
+
+        xt::xtensor<double, 2> W = xt::random::randn<double>({40, 40});
+        W = W + xt::transpose(W);
+        xt::xtensor<double, 2> S = linalg::sandwich(A, W);
+        EXPECT_TRUE(xt::allclose(S, linalg::dot(linalg::dot(A, W), xt::transpose(A))));
+        EXPECT_EQ(S, xt::transpose(S));
+    }
+
+    TEST(xblas, cpu_dispatch)
+    {
+        // every level the processor supports agrees with the baseline kernels
+        xt::xtensor<double, 2, layout_type::column_major> A = xt::random::rand<double>({67, 45});
+        xt::xtensor<double, 2, layout_type::column_major> B = xt::random::rand<double>({45, 38});
+        xt::xtensor<float, 2, layout_type::column_major> Af = xt::cast<float>(A);
+        xt::xtensor<float, 2, layout_type::column_major> Bf = xt::cast<float>(B);
+        xt::xtensor<double, 2, layout_type::column_major> expected = xt::zeros<double>({67, 38});
+        xt::xtensor<float, 2, layout_type::column_major> expected_f = xt::zeros<float>({67, 38});
+        double expected_dot = 0;
+
+        cxxblas::CpuLevel detected = cxxblas::detected_cpu_level();
+        for (int level = cxxblas::CpuBaseline; level <= detected; ++level)
+        {
+            cxxblas::set_cpu_level(cxxblas::CpuLevel(level));
+            EXPECT_EQ(cxxblas::cpu_level(), level);
+            xt::xtensor<double, 2, layout_type::column_major> C = xt::zeros<double>({67, 38});
+            xt::xtensor<float, 2, layout_type::column_major> Cf = xt::zeros<float>({67, 38});
+            cxxblas::gemm_generic(cxxblas::ColMajor, cxxblas::NoTrans, cxxblas::NoTrans, 67, 38, 45, 1.,
+                                  A.data(), 67, B.data(), 45, 0., C.data(), 67);
+            cxxblas::gemm_generic(cxxblas::ColMajor, cxxblas::NoTrans, cxxblas::NoTrans, 67, 38, 45, 1.f,
+                                  Af.data(), 67, Bf.data(), 45, 0.f, Cf.data(), 67);
+            double d;
+            cxxblas::dot(int(A.size()), A.data(), 1, A.data(), 1, d);
+            if (level == cxxblas::CpuBaseline)
+            {
+                expected = C;
+                expected_f = Cf;
+                expected_dot = d;
+            }
+            EXPECT_TRUE(xt::allclose(C, expected));
+            EXPECT_TRUE(xt::allclose(Cf, expected_f, 1e-4));
+            EXPECT_NEAR(d, expected_dot, 1e-10 * expected_dot);
+        }
+        cxxblas::set_cpu_level(detected);
+        EXPECT_EQ(cxxblas::cpu_level(), detected);
+    }
+
+    TEST(xblas, compensated)
+    {
+        // the plain sum cancels the 1
+        xt::xtensor<double, 1> x = {1e16, 1., -1e16, 3.};
+        xt::xtensor<double, 1> y = {1., 1., 1., 1.};
+        double d, s;
+        blas::dot(x, y, d, blas::compensated);
+        blas::sum(x, s, blas::compensated);
+        EXPECT_EQ(d, 4.);
+        EXPECT_EQ(s, 4.);
+        blas::dot(xt::view(x, xt::range(xt::placeholders::_, xt::placeholders::_, -1)), y, d, blas::compensated);
+        EXPECT_EQ(d, 4.);
+
+        xt::xtensor<double, 1> a = xt::random::randn<double>({1001});
+        xt::xtensor<double, 1> b = xt::random::randn<double>({1001});
+        long double ref = 0, squares = 0;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            ref += static_cast<long double>(a(i)) * b(i);
+            squares += static_cast<long double>(a(i)) * a(i);
+        }
+        blas::dot(a, b, d, blas::compensated);
+        EXPECT_NEAR(d, double(ref), 1e-15 * std::abs(double(ref)));
+        double n;
+        blas::nrm2(a, n, blas::compensated);
+        EXPECT_NEAR(n, std::sqrt(double(squares)), 1e-15 * n);
+        xt::xtensor<double, 1> huge = {3e300, 4e300};
+        blas::nrm2(huge, n, blas::compensated);
+        EXPECT_NEAR(n, 5e300, 1e285);
+
+        xt::xtensor<std::complex<double>, 1> cx = {{1., 1e16}, {2., -1e16}, {3., 1.}};
+        xt::xtensor<std::complex<double>, 1> cy = {{1., 0.}, {1., 0.}, {0., 1.}};
+        std::complex<double> c;
+        blas::dot(cx, cy, c, blas::compensated);
+        EXPECT_EQ(c, std::complex<double>(4., 3.));
+        blas::dotu(cx, cy, c, blas::compensated);
+        EXPECT_EQ(c, std::complex<double>(2., 3.));
+    }
 }
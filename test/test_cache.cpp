@@ -0,0 +1,88 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <tuple>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlinalg_cache.hpp"
+
+namespace xt
+{
+    TEST(xlinalg_cache, memoize)
+    {
+        linalg::cache c;
+        xarray<double> a = {{4., 1., 2.}, {1., 5., 3.}, {2., 3., 6.}};
+
+        EXPECT_TRUE(allclose(c.inv(a), linalg::inv(a)));
+        EXPECT_TRUE(allclose(c.inv(a), linalg::inv(a)));
+        EXPECT_EQ(c.misses(), std::size_t(1));
+        EXPECT_EQ(c.hits(), std::size_t(1));
+
+        auto L = c.cholesky(a);
+        EXPECT_TRUE(allclose(L, linalg::cholesky(a)));
+        auto eh = c.eigh(a);
+        EXPECT_TRUE(allclose(std::get<0>(eh), std::get<0>(linalg::eigh(a))));
+        EXPECT_EQ(c.size(), std::size_t(3));
+
+        // a changed element is a different input
+        a(0, 0) = 5.;
+        EXPECT_TRUE(allclose(c.inv(a), linalg::inv(a)));
+        EXPECT_EQ(c.misses(), std::size_t(4));
+
+        // an expression with the same elements hits
+        xtensor<double, 2, layout_type::column_major> ct = a;
+        c.inv(ct);
+        EXPECT_EQ(c.hits(), std::size_t(2));
+
+        int calls = 0;
+        auto twice = [&calls](const auto& m) { ++calls; return xarray<double>(2. * m); };
+        c.memoize("twice", a, 7, twice);
+        a(1, 1) = 0.;
+        // the version is trusted, whatever the elements
+        auto r = c.memoize("twice", a, 7, twice);
+        EXPECT_EQ(calls, 1);
+        EXPECT_EQ(r(1, 1), 10.);
+        c.memoize("twice", a, 8, twice);
+        EXPECT_EQ(calls, 2);
+    }
+
+    TEST(xlinalg_cache, eviction)
+    {
+        xarray<double> a = {{2., 0.}, {0., 3.}};
+        xarray<double> b = {{4., 1.}, {1., 3.}};
+
+        // an input and its inverse take 64 bytes
+        linalg::cache c(100);
+        c.inv(a);
+        c.inv(b);
+        EXPECT_EQ(c.size(), std::size_t(1));
+        EXPECT_LE(c.bytes(), c.max_bytes());
+
+        c.inv(b);
+        EXPECT_EQ(c.hits(), std::size_t(1));
+        c.inv(a);
+        EXPECT_EQ(c.misses(), std::size_t(3));
+
+        c.set_max_bytes(200);
+        c.inv(b);
+        c.inv(a);
+        EXPECT_EQ(c.size(), std::size_t(2));
+        EXPECT_EQ(c.hits(), std::size_t(2));
+
+        c.set_max_bytes(10);
+        EXPECT_EQ(c.size(), std::size_t(0));
+        c.inv(a);
+        EXPECT_EQ(c.size(), std::size_t(0));
+        c.clear();
+        EXPECT_EQ(c.bytes(), std::size_t(0));
+    }
+}
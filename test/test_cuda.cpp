@@ -0,0 +1,145 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#if defined(XTENSOR_USE_CUDA)
+
+#include <complex>
+#include <limits>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xlinalg_cuda.hpp"
+
+namespace xt
+{
+    // runs f with the given threshold and restores the default
+    template <class F>
+    void with_threshold(std::size_t n, F f)
+    {
+        std::size_t previous = cuda::offload_threshold();
+        cuda::set_offload_threshold(n);
+        f();
+        cuda::set_offload_threshold(previous);
+    }
+
+    TEST(xblas_cuda, dot)
+    {
+        xt::random::seed(0);
+        xarray<double> a = xt::random::rand<double>({40, 30});
+        xarray<double> b = xt::random::rand<double>({30, 20});
+        xarray<double, layout_type::column_major> bc = b;
+
+        xarray<double> expected;
+        with_threshold(std::numeric_limits<std::size_t>::max(), [&]() { expected = linalg::dot(a, b); });
+
+        with_threshold(8, [&]() {
+            EXPECT_TRUE(allclose(linalg::dot(a, b), expected));
+            EXPECT_TRUE(allclose(linalg::dot(a, bc), expected));
+            EXPECT_TRUE(allclose(linalg::dot(transpose(b), transpose(a)), transpose(expected)));
+        });
+
+        xarray<std::complex<double>> ca = a + std::complex<double>(0., 1.) * a;
+        xarray<std::complex<double>> cexpected;
+        with_threshold(std::numeric_limits<std::size_t>::max(), [&]() { cexpected = linalg::dot(ca, b); });
+        with_threshold(8, [&]() { EXPECT_TRUE(allclose(linalg::dot(ca, xarray<std::complex<double>>(b)), cexpected)); });
+    }
+
+    TEST(xblas_cuda, solvers)
+    {
+        xt::random::seed(1);
+        xarray<double> a = xt::random::rand<double>({24, 24});
+        xarray<double> spd = linalg::dot(a, transpose(a)) + 24. * eye<double>(24);
+        xarray<double> b = xt::random::rand<double>({24, 3});
+
+        with_threshold(8, [&]() {
+            auto x = linalg::solve(a, b);
+            EXPECT_TRUE(allclose(linalg::dot(a, x), b));
+
+            auto eh = linalg::eigh(spd);
+            auto& w = std::get<0>(eh);
+            auto& v = std::get<1>(eh);
+            EXPECT_TRUE(allclose(linalg::dot(spd, v), v * view(w, newaxis(), all())));
+
+            auto usv = linalg::svd(a, false);
+            auto& u = std::get<0>(usv);
+            auto& s = std::get<1>(usv);
+            auto& vt = std::get<2>(usv);
+            EXPECT_TRUE(allclose(linalg::dot(u * view(s, newaxis(), all()), vt), a));
+        });
+
+        xarray<double> singular = zeros<double>({16, 16});
+        with_threshold(8, [&]() { EXPECT_THROW(linalg::solve(singular, xarray<double>(ones<double>({16}))), std::runtime_error); });
+    }
+
+    TEST(xblas_cuda, device_matrix)
+    {
+        xtensor<double, 2> a = {{1., 2., 3.}, {4., 5., 6.}};
+        xtensor<double, 2> b = {{1., 0.}, {0., 1.}, {1., 1.}};
+
+        auto da = cuda::to_device(a);
+        auto db = cuda::to_device(b);
+        EXPECT_EQ(da.rows(), std::size_t(2));
+        EXPECT_EQ(da.cols(), std::size_t(3));
+
+        // (a b) a, without going through the host
+        auto dc = cuda::dot(cuda::dot(da, db), da);
+        xtensor<double, 2> expected = linalg::dot(linalg::dot(a, b), a);
+        EXPECT_TRUE(allclose(cuda::to_host(dc), expected));
+
+        cuda::device_matrix<double> ata(3, 3);
+        cuda::gemm(da, da, ata, true, false);
+        EXPECT_TRUE(allclose(cuda::to_host(ata), linalg::dot(transpose(a), a)));
+
+        EXPECT_THROW(cuda::gemm(da, da, ata), std::runtime_error);
+    }
+
+    TEST(xblas_cuda, device_linalg)
+    {
+        xtensor<double, 2> a = {{4., 1., 2.}, {1., 5., 3.}, {2., 3., 6.}};
+        xtensor<double, 2> b = {{1., 0.}, {2., 1.}, {3., 0.}};
+        xtensor<double, 2> wide = {{1., 2., 0., 1.}, {0., 1., 3., 1.}};
+
+        auto da = cuda::to_device(a);
+        auto db = cuda::to_device(b);
+
+        auto x = cuda::to_host(linalg::solve(da, db));
+        EXPECT_TRUE(allclose(linalg::dot(a, x), b));
+
+        auto e = linalg::eigh(da);
+        auto w = cuda::to_host_vector(std::get<0>(e));
+        auto v = cuda::to_host(std::get<1>(e));
+        EXPECT_TRUE(allclose(linalg::dot(a, v), v * view(w, newaxis(), all())));
+
+        // svd(dot(A, B)) with the product left on the device
+        auto usv = linalg::svd(linalg::dot(da, wide), false);
+        auto u = cuda::to_host(std::get<0>(usv));
+        auto s = cuda::to_host_vector(std::get<1>(usv));
+        auto vt = cuda::to_host(std::get<2>(usv));
+        xtensor<double, 2> expected = linalg::dot(a, wide);
+        EXPECT_EQ(u.shape()[1], std::size_t(3));
+        EXPECT_EQ(vt.shape()[0], std::size_t(3));
+        EXPECT_TRUE(allclose(linalg::dot(u * view(s, newaxis(), all()), vt), expected));
+
+        auto dw = cuda::to_device(wide);
+        auto wsv = linalg::svd(dw);
+        EXPECT_EQ(cuda::to_host(std::get<0>(wsv)).shape()[0], std::size_t(2));
+        EXPECT_EQ(cuda::to_host(std::get<2>(wsv)).shape()[0], std::size_t(4));
+        EXPECT_TRUE(allclose(cuda::to_host_vector(std::get<1>(wsv)), std::get<1>(linalg::svd(wide))));
+
+        xtensor<double, 2> singular = zeros<double>({3, 3});
+        EXPECT_THROW(linalg::solve(cuda::to_device(singular), db), std::runtime_error);
+    }
+}
+
+#endif
@@ -0,0 +1,83 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlinalg_deferred.hpp"
+
+namespace xt
+{
+    namespace ld = linalg::deferred;
+
+    TEST(xlinalg_deferred, solve_of_product)
+    {
+        xt::random::seed(3);
+        xtensor<double, 2> A = xt::random::randn<double>({20, 20});
+        A += 20.0 * xt::eye<double>(20);
+        xtensor<double, 2, layout_type::column_major> B = xt::random::randn<double>({15, 20});
+        xtensor<double, 2> C = xt::random::randn<double>({15, 6});
+
+        xtensor<double, 2> expected = linalg::solve(A, linalg::dot(xt::transpose(B), C));
+
+        auto e = ld::solve(A, ld::dot(ld::transpose(B), C));
+        EXPECT_EQ(e.rows(), std::size_t(20));
+        EXPECT_EQ(e.cols(), std::size_t(6));
+        auto X = ld::evaluate(e);
+        EXPECT_TRUE(allclose(X, expected));
+
+        // row-major destination: solved in a workspace buffer and copied
+        xtensor<double, 2> Xr = xtensor<double, 2>::from_shape({20, 6});
+        ld::assign(Xr, e);
+        EXPECT_TRUE(allclose(Xr, expected));
+
+        // computed and transposed coefficient matrix, factored in place
+        xtensor<double, 2> S = linalg::dot(xt::transpose(A), A);
+        xtensor<double, 2> es = linalg::solve(xt::transpose(S), X);
+        xtensor<double, 2> Xs = ld::evaluate<layout_type::row_major>(ld::solve(ld::transpose(ld::dot(ld::transpose(A), A)), X));
+        EXPECT_TRUE(allclose(Xs, es));
+
+        xtensor<double, 2> wrong = xt::zeros<double>({6, 20});
+        EXPECT_THROW(ld::assign(wrong, e), std::runtime_error);
+        EXPECT_THROW(ld::dot(B, C), std::runtime_error);
+    }
+
+    TEST(xlinalg_deferred, products)
+    {
+        xt::random::seed(5);
+        xtensor<double, 2> A = xt::random::randn<double>({8, 5});
+        xtensor<double, 2, layout_type::column_major> B = xt::random::randn<double>({5, 7});
+        xtensor<double, 2> C = xt::random::randn<double>({7, 4});
+        xtensor<double, 2> expected = 2.0 * linalg::dot(linalg::dot(A, B), C);
+
+        // (A B)^T and C^T A^T are written by filling the other layout
+        xtensor<double, 2> T = ld::evaluate<layout_type::row_major>(ld::transpose(ld::dot(A, B)));
+        EXPECT_TRUE(allclose(T, xt::transpose(linalg::dot(A, B))));
+
+        ld::workspace<double> ws;
+        xtensor<double, 2, layout_type::column_major> D = xtensor<double, 2, layout_type::column_major>::from_shape({8, 4});
+        ld::assign(D, 2.0 * ld::dot(ld::dot(A, B), C), ws);
+        EXPECT_TRUE(allclose(D, expected));
+        std::size_t allocations = ws.allocations();
+        ld::assign(D, ld::dot(ld::dot(A, B), C) * 2.0, ws);
+        EXPECT_TRUE(allclose(D, expected));
+        EXPECT_EQ(ws.allocations(), allocations);
+
+        // destination aliasing an operand goes through a buffer
+        xtensor<double, 2> S = xt::random::randn<double>({6, 6});
+        xtensor<double, 2> es = linalg::dot(xt::transpose(S), S);
+        ld::assign(S, ld::dot(ld::transpose(S), S));
+        EXPECT_TRUE(allclose(S, es));
+    }
+}
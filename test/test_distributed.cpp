@@ -0,0 +1,89 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#if defined(XTENSOR_USE_SCALAPACK)
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xdistributed.hpp"
+
+namespace xt
+{
+    // runs on any number of processes, the checks are made on rank 0
+
+    TEST(xdistributed, scatter_gather)
+    {
+        distributed::process_grid grid;
+        xtensor<double, 2> a = {{1., 2., 3., 4., 5.}, {6., 7., 8., 9., 10.}, {11., 12., 13., 14., 15.}};
+
+        auto da = distributed::scatter(grid, a, 0, 2, 2);
+        EXPECT_EQ(da.rows(), std::size_t(3));
+        EXPECT_EQ(da.cols(), std::size_t(5));
+        for (std::size_t j = 0; j < da.local().shape()[1]; ++j)
+        {
+            for (std::size_t i = 0; i < da.local().shape()[0]; ++i)
+            {
+                EXPECT_EQ(da.local()(i, j), a(da.global_row(i), da.global_col(j)));
+            }
+        }
+
+        auto back = distributed::gather(da);
+        if (grid.rank() == 0)
+        {
+            EXPECT_EQ(back, a);
+        }
+
+        distributed::block_cyclic_matrix<double> f(grid, 3, 5, 2, 2);
+        f.fill([](std::size_t i, std::size_t j) { return double(5 * i + j + 1); });
+        auto fb = distributed::gather(f);
+        if (grid.rank() == 0)
+        {
+            EXPECT_EQ(fb, a);
+        }
+    }
+
+    TEST(xdistributed, linalg)
+    {
+        distributed::process_grid grid;
+        xtensor<double, 2> a = {{4., 1., 2.}, {1., 5., 3.}, {2., 3., 6.}};
+        xtensor<double, 2> b = {{1.}, {2.}, {3.}};
+
+        auto da = distributed::scatter(grid, a, 0, 2, 2);
+        auto db = distributed::scatter(grid, b, 0, 2, 2);
+
+        auto p = distributed::gather(linalg::dot(da, da));
+        auto x = distributed::gather(linalg::solve(da, db));
+        auto l = distributed::gather(linalg::cholesky(da));
+        auto e = linalg::eigh(da);
+        auto z = distributed::gather(std::get<1>(e));
+        auto usv = linalg::svd(da);
+        auto u = distributed::gather(std::get<0>(usv));
+        auto vt = distributed::gather(std::get<2>(usv));
+
+        if (grid.rank() == 0)
+        {
+            EXPECT_TRUE(allclose(p, linalg::dot(a, a)));
+            EXPECT_TRUE(allclose(x, linalg::solve(a, b)));
+            EXPECT_TRUE(allclose(l, linalg::cholesky(a)));
+            EXPECT_TRUE(allclose(std::get<0>(e), std::get<0>(linalg::eigh(a))));
+            EXPECT_TRUE(allclose(linalg::dot(a, z), z * view(std::get<0>(e), newaxis(), all())));
+            EXPECT_TRUE(allclose(std::get<1>(usv), std::get<1>(linalg::svd(a))));
+            EXPECT_TRUE(allclose(linalg::dot(u * view(std::get<1>(usv), newaxis(), all()), vt), a));
+        }
+
+        xtensor<double, 2> zero = zeros<double>({3, 3});
+        auto dz = distributed::scatter(grid, zero, 0, 2, 2);
+        EXPECT_THROW(linalg::cholesky(dz), std::runtime_error);
+    }
+}
+
+#endif
@@ -7,16 +7,55 @@
 * The full license is in the file LICENSE, distributed with this software. *
 ****************************************************************************/
 
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <memory>
+
 #include "gtest/gtest.h"
 #include "xtensor/xarray.hpp"
 #include "xtensor/xview.hpp"
 #include "xtensor/xbuilder.hpp"
+#include "xtensor/xmath.hpp"
+#include "xtensor/xsort.hpp"
 #include "xtensor/xstrided_view.hpp"
+#include "xtensor/xrandom.hpp"
 
+#include "xtensor-blas/xgemm_packed.hpp"
 #include "xtensor-blas/xlinalg.hpp"
 
 namespace xt
 {
+    namespace
+    {
+        std::size_t counted_allocations = 0;
+
+        // std::allocator that counts its allocations
+        template <class T>
+        struct counting_allocator : std::allocator<T>
+        {
+            template <class U>
+            struct rebind
+            {
+                using other = counting_allocator<U>;
+            };
+
+            counting_allocator() = default;
+
+            template <class U>
+            counting_allocator(const counting_allocator<U>&) noexcept
+            {
+            }
+
+            T* allocate(std::size_t n)
+            {
+                ++counted_allocations;
+                return std::allocator<T>::allocate(n);
+            }
+        };
+    }
+
     TEST(xdot, matrix_times_vector)
     {
         xarray<float> a = xt::ones<float>({1, 4});
@@ -213,4 +252,648 @@ namespace xt
         EXPECT_EQ(res3.shape()[1], 3u);
     }
 
+    TEST(xdot, dot_into)
+    {
+        xarray<double> a = {{1, 2, 3}, {4, 5, 6}};
+        xarray<double> b = {{1, 2}, {3, 4}, {5, 6}};
+        xarray<double> expected = {{22, 28}, {49, 64}};
+
+        xtensor<double, 2> c = xt::zeros<double>({2, 2});
+        linalg::dot_into(a, b, c);
+        EXPECT_EQ(expected, c);
+
+        // accumulate: c := 2 * a * b + c
+        linalg::dot_into(a, b, c, 2.0, 1.0);
+        EXPECT_EQ(xarray<double>(3 * expected), c);
+
+        xtensor<double, 2, layout_type::column_major> c_cm = xt::zeros<double>({2, 2});
+        linalg::dot(a, b, c_cm);
+        EXPECT_EQ(expected, c_cm);
+
+        xtensor<double, 1> x = {1, 1, 1};
+        xtensor<double, 1> y = xt::zeros<double>({2});
+        linalg::dot_into(a, x, y);
+        xarray<double> ey = {6, 15};
+        EXPECT_EQ(ey, y);
+
+        xtensor<double, 2> wrong = xt::zeros<double>({3, 3});
+        EXPECT_THROW(linalg::dot_into(a, b, wrong), std::runtime_error);
+    }
+
+    TEST(xdot, lazy_dot)
+    {
+        xarray<double> a = {{1, 2, 3}, {4, 5, 6}};
+        xarray<double> b = {{1, 2}, {3, 4}, {5, 6}};
+        xarray<double> expected = {{22, 28}, {49, 64}};
+
+        xtensor<double, 2> c = xt::zeros<double>({2, 2});
+        linalg::assign(c, linalg::lazy_dot(a, b));
+        EXPECT_EQ(expected, c);
+
+        // c := 2 * a * b + 0.5 * c
+        linalg::assign(c, 2.0 * linalg::lazy_dot(a, b), 0.5);
+        EXPECT_EQ(xarray<double>(2.5 * expected), c);
+
+        linalg::add_assign(c, -linalg::lazy_dot(a, b) * 0.5);
+        EXPECT_EQ(xarray<double>(2 * expected), c);
+
+        auto d = 3.0 * linalg::lazy_dot(a, b);
+        EXPECT_EQ(xarray<double>(3 * expected), d.evaluate());
+
+        // destination aliasing an operand: s := s * s
+        xarray<double> s = {{1, 2}, {3, 4}};
+        xarray<double> es = {{7, 10}, {15, 22}};
+        linalg::assign(s, linalg::lazy_dot(s, s));
+        EXPECT_EQ(es, s);
+
+        xtensor<double, 2> wrong = xt::zeros<double>({3, 3});
+        EXPECT_THROW(linalg::assign(wrong, linalg::lazy_dot(a, b)), std::runtime_error);
+    }
+
+    TEST(xdot, dot_into_aliased)
+    {
+        xt::random::seed(7);
+        xtensor<double, 2> a = xt::random::randn<double>({70, 40});
+        xtensor<double, 2> b = xt::random::randn<double>({40, 40});
+        xtensor<double, 2, layout_type::column_major> s = xt::random::randn<double>({70, 70});
+
+        // a := a * b through row panels of a
+        xtensor<double, 2> expected = 2.0 * linalg::dot(a, b) + 0.5 * a;
+        linalg::dot_into(a, b, a, 2.0, 0.5);
+        EXPECT_TRUE(allclose(a, expected));
+
+        // a := s * a through column panels of a
+        expected = linalg::dot(s, a);
+        linalg::dot_into(s, a, a);
+        EXPECT_TRUE(allclose(a, expected));
+
+        // s := s^T * s and s := 2 s * s alias both operands
+        xtensor<double, 2, layout_type::column_major> es = linalg::dot(xt::transpose(s), s);
+        linalg::dot_into(xt::transpose(s), s, s);
+        EXPECT_TRUE(allclose(s, es));
+        es = 2.0 * linalg::dot(s, s);
+        linalg::assign(s, linalg::lazy_dot(2.0 * s, s));
+        EXPECT_TRUE(allclose(s, es));
+
+        xtensor<double, 1> x = xt::random::randn<double>({40});
+        xtensor<double, 1> ex = linalg::dot(b, x);
+        linalg::dot_into(b, x, x);
+        EXPECT_TRUE(allclose(x, ex));
+    }
+
+    TEST(xdot, multi_dot)
+    {
+        // (A * B) * C is 100 times cheaper than A * (B * C)
+        auto split = linalg::detail::multi_dot_order({10, 1000, 5, 500});
+        EXPECT_EQ(split[0][2], 1u);
+        split = linalg::detail::multi_dot_order({500, 5, 1000, 10});
+        EXPECT_EQ(split[0][2], 0u);
+
+        xarray<double> a = {{1, 2, 3}, {4, 5, 6}};
+        xarray<double> b = {{1, 2}, {3, 4}, {5, 6}};
+        xarray<double> c = {{1, 0, 2}, {0, 1, 1}};
+        xtensor<double, 2> d = {{2, 1}, {1, 0}, {0, 3}};
+
+        xarray<double> expected = linalg::dot(linalg::dot(linalg::dot(a, b), c), d);
+        EXPECT_EQ(expected, linalg::multi_dot(a, b, c, d));
+        EXPECT_EQ(xarray<double>(linalg::dot(a, b)), linalg::multi_dot(a, b));
+
+        std::vector<xarray<double>> chain = {a, b, c};
+        EXPECT_EQ(xarray<double>(linalg::dot(linalg::dot(a, b), c)), linalg::multi_dot(chain));
+
+        xarray<double> x = {1, 1};
+        xarray<double> y = {1, 2, 3};
+        xarray<double> ev = linalg::dot(linalg::dot(x, a), b);
+        EXPECT_EQ(ev, linalg::multi_dot(x, a, b));
+        xarray<double> ev2 = linalg::dot(linalg::dot(b, a), y);
+        EXPECT_EQ(ev2, linalg::multi_dot(b, a, y));
+
+        EXPECT_THROW(linalg::multi_dot(a, c), std::runtime_error);
+        EXPECT_THROW(linalg::multi_dot(std::vector<xarray<double>>{a}), std::runtime_error);
+    }
+
+    TEST(xdot, static_rank)
+    {
+        xtensor<double, 2> a = {{1, 2, 3}, {4, 5, 6}};
+        xtensor<double, 2> b = {{1, 2}, {3, 4}, {5, 6}};
+        xtensor<double, 1> x = {1, 1, 1};
+
+        auto r1 = linalg::dot(a, b);
+        auto r2 = linalg::dot(a, x);
+        auto r3 = linalg::dot(x, x);
+        bool r1_static = std::is_same<decltype(r1), xtensor<double, 2>>::value;
+        bool r2_static = std::is_same<decltype(r2), xtensor<double, 1>>::value;
+        bool r3_static = std::is_same<decltype(r3), xtensor<double, 1>>::value;
+        EXPECT_TRUE(r1_static);
+        EXPECT_TRUE(r2_static);
+        EXPECT_TRUE(r3_static);
+
+        xarray<double> e1 = {{22, 28}, {49, 64}};
+        xarray<double> e2 = {6, 15};
+        EXPECT_EQ(e1, r1);
+        EXPECT_EQ(e2, r2);
+        EXPECT_EQ(r3(0), 3.);
+
+        xarray<double> c = b;
+        auto r4 = linalg::dot(a, c);
+        bool r4_dynamic = std::is_same<decltype(r4), xarray<double>>::value;
+        EXPECT_TRUE(r4_dynamic);
+        EXPECT_EQ(e1, r4);
+    }
+
+    TEST(xdot, matmul)
+    {
+        xarray<double> a = reshape_view(arange<double>(2 * 2 * 3), {2, 2, 3});
+        xarray<double> b = reshape_view(arange<double>(2 * 3 * 4), {2, 3, 4});
+
+        auto r = linalg::matmul(a, b);
+        ASSERT_EQ(r.dimension(), 3u);
+        EXPECT_EQ(r.shape()[0], 2u);
+        EXPECT_EQ(r.shape()[1], 2u);
+        EXPECT_EQ(r.shape()[2], 4u);
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            xarray<double> e = linalg::dot(view(a, i), view(b, i));
+            EXPECT_EQ(e, view(r, i));
+        }
+
+        // broadcasting a single matrix against the stack
+        xarray<double> c = reshape_view(arange<double>(3 * 4), {3, 4});
+        auto rc = linalg::matmul(a, c);
+        xarray<double> ec = linalg::dot(view(a, 1), c);
+        EXPECT_EQ(ec, view(rc, 1));
+
+        xarray<double> d = ones<double>({3, 1, 3, 4});
+        auto rd = linalg::matmul(a, d);
+        EXPECT_EQ(rd.shape()[0], 3u);
+        EXPECT_EQ(rd.shape()[1], 2u);
+
+        xarray<double> wrong = ones<double>({3, 2, 4});
+        EXPECT_THROW(linalg::matmul(a, wrong), std::runtime_error);
+    }
+
+    TEST(xdot, nd_times_matrix)
+    {
+        xarray<double> a = reshape_view(arange<double>(2 * 3 * 4), {2, 3, 4});
+        xarray<double> b = reshape_view(arange<double>(4 * 5), {4, 5});
+        xarray<double, layout_type::column_major> a_cm = a;
+        xarray<double, layout_type::column_major> b_cm = b;
+
+        auto r = linalg::dot(a, b);
+        auto r_cm = linalg::dot(a_cm, b_cm);
+        auto r_mixed = linalg::dot(a, b_cm);
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            xarray<double> e = linalg::dot(xarray<double>(view(a, i)), b);
+            EXPECT_EQ(e, view(r, i));
+            EXPECT_EQ(e, view(r_cm, i));
+            EXPECT_EQ(e, view(r_mixed, i));
+        }
+
+        // non-contiguous leading dimensions take the element-wise path
+        auto a_strided = view(a, all(), range(0, 3, 2), all());
+        auto r_strided = linalg::dot(a_strided, b);
+        xarray<double> e_strided = linalg::dot(xarray<double>(view(a, 1, 2)), b);
+        EXPECT_EQ(e_strided, view(r_strided, 1, 1));
+    }
+
+    TEST(xdot, folded_operands)
+    {
+        xtensor<double, 2> a = {{1, 2, 3}, {4, 5, 6}};
+        xtensor<double, 2> b = {{1, 2}, {3, 4}, {5, 6}};
+        xtensor<double, 2> ab = {{22, 28}, {49, 64}};
+
+        EXPECT_EQ(xarray<double>(2.0 * ab), linalg::dot(2.0 * a, b));
+        EXPECT_EQ(xarray<double>(-ab), linalg::dot(a, b * -1.0));
+        xtensor<double, 2> ata = linalg::dot(xtensor<double, 2>(transpose(a)), a);
+        EXPECT_EQ(ata, linalg::dot(transpose(a), a));
+
+        using cd = std::complex<double>;
+        xtensor<cd, 2> c = {{cd(1, 1), cd(2, -1), cd(0, 3)},
+                            {cd(4, 0), cd(-1, 2), cd(1, 1)}};
+        xtensor<cd, 2> d = {{cd(1, 0), cd(0, 1)},
+                            {cd(2, 2), cd(1, -1)}};
+        xtensor<cd, 2> ch = xt::conj(transpose(c));
+        xtensor<cd, 2> expected = linalg::dot(ch, d);
+        EXPECT_TRUE(allclose(expected, linalg::dot(xt::conj(transpose(c)), d)));
+        xtensor<cd, 2> scaled = cd(0, 2) * expected;
+        EXPECT_TRUE(allclose(scaled, linalg::dot(cd(0, 2) * xt::conj(transpose(c)), d)));
+
+        // conj without transposition is evaluated first
+        xtensor<cd, 2> cc = xt::conj(c);
+        EXPECT_TRUE(allclose(linalg::dot(cc, ch), linalg::dot(xt::conj(c), ch)));
+    }
+
+    TEST(xdot, mixed_types)
+    {
+        using cd = std::complex<double>;
+        xt::random::seed(5);
+        xtensor<double, 2> a = xt::random::randn<double>({40, 30});
+        xtensor<double, 2> b_re = xt::random::randn<double>({30, 20});
+        xtensor<double, 2> b_im = xt::random::randn<double>({30, 20});
+        xtensor<cd, 2> b = b_re + cd(0, 1) * b_im;
+        xtensor<cd, 2, layout_type::column_major> b_cm = b;
+
+        // real times complex, with the complex operand in either order
+        xtensor<cd, 2> expected = linalg::dot(a, b_re) + cd(0, 1) * linalg::dot(a, b_im);
+        EXPECT_TRUE(allclose(expected, linalg::dot(a, b)));
+        EXPECT_TRUE(allclose(expected, linalg::dot(a, b_cm)));
+        xtensor<cd, 2> bt = transpose(b);
+        EXPECT_TRUE(allclose(xtensor<cd, 2>(transpose(expected)), linalg::dot(bt, transpose(a))));
+
+        // float operands are promoted block by block
+        xtensor<float, 2> f = xt::cast<float>(a);
+        xtensor<double, 2> fd = xt::cast<double>(f);
+        EXPECT_TRUE(allclose(linalg::dot(fd, b_re), linalg::dot(f, b_re)));
+        EXPECT_TRUE(allclose(linalg::dot(b_im, transpose(fd)), linalg::dot(b_im, transpose(f))));
+    }
+
+    TEST(xdot, reduced_precision)
+    {
+        EXPECT_EQ(bfloat16(1.0f).bits(), 0x3F80);
+        EXPECT_EQ(float(bfloat16(-2.5f)), -2.5f);
+        EXPECT_EQ(float16(1.0f).bits(), 0x3C00);
+        EXPECT_EQ(float(float16(65504.f)), 65504.f);
+        EXPECT_TRUE(std::isinf(float(float16(65520.f))));
+        EXPECT_EQ(float(float16(5.9604645e-8f)), 5.9604645e-8f);
+
+        xt::random::seed(7);
+        xtensor<float, 2> a = xt::random::randn<float>({70, 90});
+        xtensor<float, 2> b = xt::random::randn<float>({90, 33});
+        xtensor<bfloat16, 2> a16 = xt::cast<bfloat16>(a);
+        xtensor<bfloat16, 2> b16 = xt::cast<bfloat16>(b);
+        xtensor<float16, 2, layout_type::column_major> h16 = xt::cast<float16>(b);
+
+        // products of the rounded values, accumulated in float
+        auto r = linalg::dot(a16, b16);
+        static_assert(std::is_same<typename decltype(r)::value_type, float>::value, "accumulates in float");
+        xtensor<float, 2> expected = linalg::dot(xtensor<float, 2>(xt::cast<float>(a16)),
+                                                 xtensor<float, 2>(xt::cast<float>(b16)));
+        EXPECT_TRUE(allclose(expected, r, 1e-4, 1e-4));
+
+        xtensor<float16, 2> a16h = xt::cast<float16>(a);
+        expected = linalg::dot(xtensor<float, 2>(xt::cast<float>(a16h)), xtensor<float, 2>(xt::cast<float>(h16)));
+        EXPECT_TRUE(allclose(expected, linalg::dot(a16h, h16), 1e-4, 1e-4));
+    }
+
+    TEST(xdot, quantized)
+    {
+        xt::random::seed(9);
+        xtensor<int, 2> ai = xt::random::randint<int>({40, 300}, -128, 128);
+        xtensor<int, 2> bi = xt::random::randint<int>({300, 25}, 0, 256);
+        xtensor<std::int8_t, 2> a = xt::cast<std::int8_t>(ai);
+        xtensor<std::uint8_t, 2, layout_type::column_major> b = xt::cast<std::uint8_t>(bi);
+
+        // the exact integer product of the shifted operands
+        xtensor<int, 2> expected = linalg::dot(xtensor<int, 2>(ai - 3), xtensor<int, 2>(bi - 140));
+        EXPECT_EQ(expected, linalg::dot_quantized(a, 3, b, 140));
+        xtensor<std::uint8_t, 2> bt = transpose(b);
+        xtensor<std::int8_t, 2> at = transpose(a);
+        EXPECT_EQ(xtensor<int, 2>(transpose(expected)), linalg::dot_quantized(bt, 140, at, 3));
+
+        auto scaled = linalg::dot_quantized(a, 0.5f, 3, b, 0.25f, 140);
+        EXPECT_TRUE(allclose(xtensor<float, 2>(0.125f * xt::cast<float>(expected)), scaled));
+
+        // integer products are exact beyond the 24 bits of a float
+        xtensor<std::int64_t, 2> x = xt::random::randint<std::int64_t>({60, 70}, -100000, 100000);
+        xtensor<std::int64_t, 2> y = xt::random::randint<std::int64_t>({70, 50}, -100000, 100000);
+        auto xy = linalg::dot(x, y);
+        for (std::size_t i = 0; i < x.shape()[0]; ++i)
+        {
+            for (std::size_t j = 0; j < y.shape()[1]; ++j)
+            {
+                std::int64_t acc = 0;
+                for (std::size_t l = 0; l < x.shape()[1]; ++l)
+                {
+                    acc += x(i, l) * y(l, j);
+                }
+                EXPECT_EQ(acc, xy(i, j));
+            }
+        }
+    }
+
+    TEST(xdot, packed_operand)
+    {
+        xt::random::seed(11);
+        xtensor<double, 2> w = xt::random::rand<double>({300, 37});
+        xgemm_packed<double> packed(w);
+        xgemm_packed<double> packed_t(xtensor<double, 2>(transpose(w)), true);
+        EXPECT_EQ(w.shape()[0], packed.shape()[0]);
+        EXPECT_EQ(w.shape()[1], packed.shape()[1]);
+
+        for (std::size_t m : {1, 7, 200})
+        {
+            xtensor<double, 2> a = xt::random::rand<double>({m, 300});
+            xtensor<double, 2> expected = linalg::dot(a, w);
+            EXPECT_TRUE(allclose(expected, linalg::dot(a, packed)));
+            EXPECT_TRUE(allclose(expected, linalg::dot(a, packed_t)));
+
+            xtensor<double, 2> at = transpose(a);
+            xtensor<double, 2> c = xt::ones<double>({m, std::size_t(37)});
+            blas::gemm(at, packed, c, true, 2.0, 1.0);
+            EXPECT_TRUE(allclose(xtensor<double, 2>(2.0 * expected + 1.0), c));
+        }
+
+        // the format follows the layout of the result
+        xtensor<std::complex<double>, 2, layout_type::column_major> z = xt::random::rand<double>({20, 30});
+        xtensor<std::complex<double>, 2, layout_type::column_major> y = xt::random::rand<double>({30, 15});
+        xgemm_packed<std::complex<double>, layout_type::column_major> packed_y(y);
+        EXPECT_TRUE(allclose(xtensor<std::complex<double>, 2, layout_type::column_major>(linalg::dot(z, y)),
+                             linalg::dot(z, packed_y)));
+    }
+
+    TEST(xdot, epilogue)
+    {
+        xt::random::seed(13);
+        xtensor<double, 2> a = xt::random::randn<double>({120, 300});
+        xtensor<double, 2> w = xt::random::randn<double>({300, 45});
+        xtensor<double, 1> bias = xt::random::randn<double>({45});
+
+        xtensor<double, 2> product = linalg::dot(a, w);
+        auto relu = [](double x) { return x > 0. ? x : 0.; };
+        EXPECT_TRUE(allclose(xtensor<double, 2>(xt::maximum(product, 0.)), linalg::dot_epilogue(a, w, relu)));
+        xtensor<double, 2> biased = product + view(bias, newaxis(), all());
+        EXPECT_TRUE(allclose(xtensor<double, 2>(xt::tanh(biased)),
+                             linalg::dot_epilogue(a, w, bias, [](double x) { return std::tanh(x); })));
+
+        // the functor sees the indices of each element, exactly once
+        xtensor<int, 2> calls = xt::zeros<int>({std::size_t(120), std::size_t(45)});
+        xtensor<double, 2, layout_type::column_major> c = xt::ones<double>({std::size_t(120), std::size_t(45)});
+        blas::gemm_epilogue(a, w, c, [&calls](std::size_t i, std::size_t j, double x)
+        {
+            ++calls(i, j);
+            return x + double(j);
+        }, false, false, 2.0, 1.0);
+        EXPECT_EQ(xtensor<int, 2>(xt::ones<int>({std::size_t(120), std::size_t(45)})), calls);
+        xtensor<double, 2> expected = 2.0 * product + 1.0 + view(xt::arange<double>(45.), newaxis(), all());
+        EXPECT_TRUE(allclose(expected, c));
+
+        xtensor<double, 1> wrong = xt::zeros<double>({std::size_t(3)});
+        EXPECT_THROW(linalg::dot_epilogue(a, w, wrong, relu), std::runtime_error);
+    }
+
+    TEST(xdot, pairwise_sqdist)
+    {
+        xt::random::seed(14);
+        xtensor<double, 2> x = xt::random::randn<double>({300, 16});
+        xtensor<double, 2> y = xt::random::randn<double>({2100, 16});
+        xtensor<double, 3> diff = view(x, all(), newaxis(), all()) - view(y, newaxis(), all(), all());
+        xtensor<double, 2> expected = xt::sum(diff * diff, {2});
+
+        auto d = linalg::pairwise_sqdist(x, y);
+        EXPECT_TRUE(allclose(expected, d));
+        EXPECT_GE(xt::amin(d)(), 0.);
+
+        auto nearest = linalg::pairwise_topk(x, y, 5);
+        const auto& indices = std::get<0>(nearest);
+        const auto& distances = std::get<1>(nearest);
+        xtensor<std::size_t, 2> order = xt::argsort(expected, 1);
+        EXPECT_EQ(xtensor<std::size_t, 2>(view(order, all(), range(0, 5))), indices);
+        for (std::size_t i = 0; i < 300; ++i)
+        {
+            for (std::size_t q = 0; q < 5; ++q)
+            {
+                EXPECT_NEAR(expected(i, indices(i, q)), distances(i, q), 1e-10);
+            }
+        }
+
+        // every point is its own nearest neighbour
+        auto self = linalg::pairwise_topk(x, x, 1);
+        EXPECT_EQ(xtensor<std::size_t, 2>(view(xt::arange<std::size_t>(300), all(), newaxis())), std::get<0>(self));
+
+        xtensor<double, 2> other = xt::random::randn<double>({4, 3});
+        EXPECT_THROW(linalg::pairwise_sqdist(x, other), std::runtime_error);
+        EXPECT_THROW(linalg::pairwise_topk(x, y, 2101), std::runtime_error);
+    }
+
+    TEST(xdot, conv2d)
+    {
+        xt::random::seed(23);
+        // batch of 3 images of 2 channels, 4 filters; 2 x 3 kernels, strides and padding
+        xtensor<double, 4> x = xt::random::randn<double>({3, 2, 37, 29});
+        xtensor<double, 4> k = xt::random::randn<double>({4, 2, 2, 3});
+        std::array<std::size_t, 2> strides = {{2, 1}};
+        std::array<std::size_t, 2> padding = {{1, 2}};
+
+        auto r = linalg::correlate2d(x, k, strides, padding);
+        std::size_t oh = (37 + 2 - 2) / 2 + 1, ow = (29 + 4 - 3) + 1;
+        ASSERT_EQ(r.dimension(), 4u);
+        EXPECT_EQ(r.shape()[2], oh);
+        EXPECT_EQ(r.shape()[3], ow);
+        double max_err = 0.;
+        for (std::size_t n = 0; n < 3; ++n)
+        {
+            for (std::size_t f = 0; f < 4; ++f)
+            {
+                for (std::size_t oy = 0; oy < oh; ++oy)
+                {
+                    for (std::size_t ox = 0; ox < ow; ++ox)
+                    {
+                        double s = 0.;
+                        for (std::size_t c = 0; c < 2; ++c)
+                        {
+                            for (std::size_t i = 0; i < 2; ++i)
+                            {
+                                for (std::size_t j = 0; j < 3; ++j)
+                                {
+                                    std::ptrdiff_t iy = std::ptrdiff_t(oy * 2 + i) - 1;
+                                    std::ptrdiff_t ix = std::ptrdiff_t(ox + j) - 2;
+                                    if (iy >= 0 && iy < 37 && ix >= 0 && ix < 29)
+                                    {
+                                        s += k(f, c, i, j) * x(n, c, std::size_t(iy), std::size_t(ix));
+                                    }
+                                }
+                            }
+                        }
+                        max_err = std::max(max_err, std::abs(s - r(n, f, oy, ox)));
+                    }
+                }
+            }
+        }
+        EXPECT_LT(max_err, 1e-12);
+
+        // one (C, H, W) image gives the first slice of the batch
+        xtensor<double, 3> first = view(x, 0);
+        xtensor<double, 3> single = linalg::correlate2d(first, k, strides, padding);
+        EXPECT_TRUE(allclose(single, view(r, 0)));
+
+        // a 2-D convolution is the correlation with the flipped kernel
+        xtensor<double, 2> img = xt::random::randn<double>({20, 17});
+        xtensor<double, 2> w = {{1., 2., 3.}, {4., 5., 6.}};
+        xtensor<double, 2> flipped = {{6., 5., 4.}, {3., 2., 1.}};
+        xtensor<double, 2> conv = linalg::conv2d(img, w);
+        EXPECT_EQ(conv.shape()[0], 19u);
+        EXPECT_EQ(conv.shape()[1], 15u);
+        EXPECT_TRUE(allclose(conv, linalg::correlate2d(img, flipped)));
+        EXPECT_NEAR(conv(0, 0), 6. * img(0, 0) + 5. * img(0, 1) + 4. * img(0, 2) +
+                                3. * img(1, 0) + 2. * img(1, 1) + img(1, 2), 1e-12);
+
+        xtensor<double, 4> wrong_channels = xt::random::randn<double>({4, 3, 2, 3});
+        EXPECT_THROW(linalg::correlate2d(x, wrong_channels), std::runtime_error);
+        xtensor<double, 2> large = xt::ones<double>({21, 3});
+        EXPECT_THROW(linalg::conv2d(img, large), std::runtime_error);
+    }
+
+    TEST(xdot, strassen)
+    {
+        xt::random::seed(17);
+        xtensor<double, 2> a = xt::random::rand<double>({131, 97});
+        xtensor<double, 2, layout_type::column_major> b = xt::random::rand<double>({97, 110});
+        xtensor<double, 2> expected = linalg::dot(a, b);
+
+        std::size_t crossover = linalg::strassen_crossover();
+        linalg::set_strassen_crossover(20);
+        EXPECT_EQ(std::size_t(20), linalg::strassen_crossover());
+        // odd dimensions on every level
+        EXPECT_TRUE(allclose(expected, linalg::dot(a, b, linalg::dot_algorithm::strassen)));
+        EXPECT_TRUE(allclose(expected, linalg::dot(a, b, linalg::dot_algorithm::standard)));
+        linalg::set_strassen_crossover(crossover);
+
+        xtensor<double, 2> v = xt::ones<double>({std::size_t(3), std::size_t(1)});
+        EXPECT_THROW(linalg::dot(a, v, linalg::dot_algorithm::strassen), std::runtime_error);
+    }
+
+    TEST(xdot, result_as)
+    {
+        using pool_matrix = xtensor<double, 2, layout_type::row_major, counting_allocator<double>>;
+        using pool_matrix_cm = xtensor<double, 2, layout_type::column_major, counting_allocator<double>>;
+        using pool_vector = xtensor<double, 1, layout_type::row_major, counting_allocator<double>>;
+        using pool_array = xarray<double, layout_type::row_major, counting_allocator<double>>;
+
+        xt::random::seed(3);
+        xtensor<double, 2> a = xt::random::rand<double>({5, 5});
+        a += 5. * xt::eye<double>(5);
+        xtensor<double, 2, layout_type::column_major> b = xt::random::rand<double>({5, 3});
+        xtensor<double, 1> v = xt::random::rand<double>({5});
+
+        // a single allocation: the result is not copied after the call
+        counted_allocations = 0;
+        pool_matrix p = linalg::dot(a, b, linalg::result_as<pool_matrix>());
+        EXPECT_EQ(counted_allocations, 1u);
+        EXPECT_TRUE(allclose(p, linalg::dot(a, b)));
+        pool_matrix_cm pc = linalg::dot(a, b, linalg::result_as<pool_matrix_cm>());
+        EXPECT_TRUE(allclose(pc, linalg::dot(a, b)));
+        pool_vector pv = linalg::dot(a, v, linalg::result_as<pool_vector>());
+        EXPECT_TRUE(allclose(pv, linalg::dot(a, v)));
+        pool_vector inner = linalg::dot(v, v, linalg::result_as<pool_vector>());
+        EXPECT_NEAR(inner(0), linalg::vdot(v, v), 1e-12);
+
+        xarray<double> stack_a = xt::random::rand<double>({2, 4, 3});
+        xarray<double> stack_b = xt::random::rand<double>({2, 3, 5});
+        counted_allocations = 0;
+        pool_array m = linalg::matmul(stack_a, stack_b, linalg::result_as<pool_array>());
+        EXPECT_EQ(counted_allocations, 1u);
+        EXPECT_TRUE(allclose(m, linalg::matmul(stack_a, stack_b)));
+        EXPECT_THROW(linalg::matmul(stack_a, stack_b, linalg::result_as<xarray<double, layout_type::column_major>>()),
+                     std::runtime_error);
+
+        counted_allocations = 0;
+        pool_matrix_cm x = linalg::solve(a, b, linalg::result_as<pool_matrix_cm>());
+        EXPECT_EQ(counted_allocations, 1u);
+        EXPECT_TRUE(allclose(x, linalg::solve(a, b)));
+        pool_matrix xr = linalg::solve(a, b, linalg::result_as<pool_matrix>());
+        EXPECT_TRUE(allclose(xr, linalg::solve(a, b)));
+        pool_vector xv = linalg::solve(a, v, linalg::result_as<pool_vector>());
+        EXPECT_TRUE(allclose(xv, linalg::solve(a, v)));
+
+        counted_allocations = 0;
+        pool_matrix ai = linalg::inv(a, linalg::result_as<pool_matrix>());
+        EXPECT_EQ(counted_allocations, 1u);
+        EXPECT_TRUE(allclose(ai, linalg::inv(a)));
+        pool_matrix_cm aic = linalg::inv(a, linalg::result_as<pool_matrix_cm>());
+        EXPECT_TRUE(allclose(aic, linalg::inv(a)));
+
+        EXPECT_THROW(linalg::dot(a, b, linalg::result_as<xtensor<double, 1>>()), std::runtime_error);
+    }
+
+    TEST(xdot, dot_planar)
+    {
+        using cd = std::complex<double>;
+        xt::random::seed(7);
+        xtensor<double, 2> ar = xt::random::randn<double>({12, 9});
+        xtensor<double, 2> ai = xt::random::randn<double>({12, 9});
+        xtensor<double, 2, layout_type::column_major> br = xt::random::randn<double>({9, 7});
+        xtensor<double, 2, layout_type::column_major> bi = xt::random::randn<double>({9, 7});
+        xtensor<cd, 2> expected = linalg::dot(xtensor<cd, 2>(ar + cd(0, 1) * ai),
+                                              xtensor<cd, 2>(br + cd(0, 1) * bi));
+
+        xtensor<double, 2> cr = xtensor<double, 2>::from_shape({12, 7});
+        xtensor<double, 2> ci = xtensor<double, 2>::from_shape({12, 7});
+        linalg::dot_planar(ar, ai, br, bi, cr, ci);
+        EXPECT_TRUE(allclose(cr, xt::real(expected)));
+        EXPECT_TRUE(allclose(ci, xt::imag(expected)));
+
+        xtensor<double, 2, layout_type::column_major> cr3 = xtensor<double, 2, layout_type::column_major>::from_shape({12, 7});
+        xtensor<double, 2, layout_type::column_major> ci3 = xtensor<double, 2, layout_type::column_major>::from_shape({12, 7});
+        xt::blas::set_complex_gemm_3m(true);
+        linalg::dot_planar(ar, ai, br, bi, cr3, ci3);
+        xt::blas::set_complex_gemm_3m(false);
+        EXPECT_TRUE(allclose(cr3, xt::real(expected)));
+        EXPECT_TRUE(allclose(ci3, xt::imag(expected)));
+
+        EXPECT_THROW(linalg::dot_planar(ar, ai, br, bi, cr, cr), std::runtime_error);
+        xtensor<double, 2> bad = xtensor<double, 2>::from_shape({7, 12});
+        EXPECT_THROW(linalg::dot_planar(ar, ai, br, bi, bad, ci), std::runtime_error);
+    }
+
+    TEST(xdot, batched_gemv)
+    {
+        using cd = std::complex<double>;
+        xt::random::seed(11);
+        // small products (SIMD tiles, with a partial last tile) and BLAS-sized ones
+        for (auto dims : {std::array<std::size_t, 3>{{1000, 6, 6}}, std::array<std::size_t, 3>{{70, 3, 8}},
+                          std::array<std::size_t, 3>{{37, 20, 13}}})
+        {
+            std::size_t N = dims[0], m = dims[1], n = dims[2];
+            xtensor<double, 3> A = xt::random::randn<double>({N, m, n});
+            xtensor<double, 2> x = xt::random::randn<double>({N, n});
+            auto y = linalg::batched_gemv(A, x);
+            ASSERT_EQ(y.dimension(), 2u);
+            EXPECT_EQ(y.shape()[0], N);
+            EXPECT_EQ(y.shape()[1], m);
+            for (std::size_t p : {std::size_t(0), N / 2, N - 1})
+            {
+                xtensor<double, 1> expected = linalg::dot(xt::view(A, p), xt::view(x, p));
+                EXPECT_TRUE(allclose(xt::view(y, p), expected));
+            }
+        }
+
+        // several batch dimensions, column-major input, complex values
+        xtensor<cd, 4> Ac = xt::random::randn<double>({3, 5, 4, 4}) + cd(0, 1) * xt::random::randn<double>({3, 5, 4, 4});
+        xtensor<cd, 3, layout_type::column_major> xc = xt::random::randn<double>({3, 5, 4});
+        auto yc = linalg::batched_gemv(Ac, xc);
+        EXPECT_EQ(yc.dimension(), 3u);
+        xtensor<cd, 1> expected = linalg::dot(xt::view(Ac, 2, 4), xtensor<cd, 1>(xt::view(xc, 2, 4)));
+        EXPECT_TRUE(allclose(xt::view(yc, 2, 4), expected));
+
+        xtensor<double, 3> A = xt::random::randn<double>({10, 3, 3});
+        xtensor<double, 2> wrong = xt::random::randn<double>({9, 3});
+        EXPECT_THROW(linalg::batched_gemv(A, wrong), std::runtime_error);
+    }
+
+    TEST(xdot, batched_dot)
+    {
+        using cd = std::complex<double>;
+        xt::random::seed(12);
+        for (std::size_t n : {std::size_t(3), std::size_t(50)})
+        {
+            xtensor<double, 2> a = xt::random::randn<double>({130, n});
+            xtensor<double, 2> b = xt::random::randn<double>({130, n});
+            auto d = linalg::batched_dot(a, b);
+            ASSERT_EQ(d.dimension(), 1u);
+            EXPECT_TRUE(allclose(d, xt::sum(a * b, {1})));
+            EXPECT_TRUE(allclose(linalg::batched_dot(a, a), xt::sum(a * a, {1})));
+        }
+
+        // complex values are not conjugated, as dot
+        xtensor<cd, 3> ac = xt::random::randn<double>({2, 7, 5}) + cd(0, 1) * xt::random::randn<double>({2, 7, 5});
+        xtensor<cd, 3> bc = xt::random::randn<double>({2, 7, 5}) + cd(0, 1) * xt::random::randn<double>({2, 7, 5});
+        auto dc = linalg::batched_dot(ac, bc);
+        EXPECT_EQ(dc.dimension(), 2u);
+        EXPECT_TRUE(allclose(dc, xt::sum(ac * bc, {2})));
+
+        xtensor<double, 2> a = xt::random::randn<double>({4, 3});
+        xtensor<double, 2> b = xt::random::randn<double>({4, 2});
+        EXPECT_THROW(linalg::batched_dot(a, b), std::runtime_error);
+    }
 }
@@ -0,0 +1,162 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <cmath>
+#include <complex>
+
+#include "gtest/gtest.h"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xcomplex.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xhodlr.hpp"
+#include "xtensor-blas/xkrylov.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+
+using namespace std::complex_literals;
+
+namespace xt
+{
+    // exponential plus Cauchy kernel on points of [0, 10], shifted: SPD
+    // with smooth off-diagonal blocks
+    inline double hodlr_kernel(std::size_t i, std::size_t j, std::size_t n)
+    {
+        double d = 10. * (double(i) - double(j)) / double(n);
+        return std::exp(-std::abs(d)) + 1. / (1. + d * d) + (i == j ? 0.1 : 0.);
+    }
+
+    TEST(xhodlr, compression)
+    {
+        std::size_t n = 500;
+        auto entry = [n](std::size_t i, std::size_t j) { return hodlr_kernel(i, j, n); };
+        xtensor<double, 2> a = xtensor<double, 2>::from_shape({n, n});
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                a(i, j) = entry(i, j);
+            }
+        }
+
+        hodlr_options options;
+        options.leaf_size = 32;
+        options.tol = 1e-10;
+        xhodlr<double> h(n, entry, options);
+        EXPECT_EQ(h.levels(), 4u);
+        EXPECT_EQ(h.leaves().size(), 16u);
+        EXPECT_EQ(h.leaf_offsets().back(), n);
+        EXPECT_LT(h.max_rank(), 40u);
+        EXPECT_LT(h.stored_elements(), n * n);
+        EXPECT_LE(amax(abs(h.dense() - a))(), 1e-8);
+
+        // from an expression, the same matrix
+        xhodlr<double> g(a, options);
+        EXPECT_LE(amax(abs(g.dense() - a))(), 1e-8);
+
+        xtensor<double, 1> x = random::randn<double>({n});
+        xtensor<double, 2> X = random::randn<double>({n, std::size_t(3)});
+        EXPECT_LE(amax(abs(linalg::dot(h, x) - linalg::dot(a, x)))(), 1e-7);
+        EXPECT_LE(amax(abs(linalg::dot(h, X) - linalg::dot(a, X)))(), 1e-7);
+
+        xtensor<double, 1> y = xtensor<double, 1>::from_shape({n});
+        h.apply(x, y);
+        EXPECT_LE(amax(abs(y - linalg::dot(a, x)))(), 1e-7);
+
+        // a rank limit of 1 keeps the leaves exact
+        hodlr_options coarse = options;
+        coarse.max_rank = 1;
+        xhodlr<double> c(a, coarse);
+        EXPECT_EQ(c.max_rank(), 1u);
+        EXPECT_EQ(c.leaves()[0](3, 5), a(3, 5));
+    }
+
+    TEST(xhodlr, solve)
+    {
+        std::size_t n = 500;
+        auto entry = [n](std::size_t i, std::size_t j) { return hodlr_kernel(i, j, n); };
+        xtensor<double, 2> a = xtensor<double, 2>::from_shape({n, n});
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                a(i, j) = entry(i, j);
+            }
+        }
+
+        hodlr_options options;
+        options.leaf_size = 32;
+        options.tol = 1e-12;
+        xhodlr<double> h(n, entry, options);
+        auto lu = linalg::lu_factor(h);
+
+        xtensor<double, 1> b = random::randn<double>({n});
+        xtensor<double, 1> expected = linalg::solve(a, b);
+        xtensor<double, 1> x = lu.solve(b);
+        EXPECT_LE(amax(abs(x - expected))(), 1e-6);
+        xtensor<double, 1> x2 = linalg::solve(h, b);
+        EXPECT_LE(amax(abs(x2 - expected))(), 1e-6);
+
+        xtensor<double, 2> B = random::randn<double>({n, std::size_t(4)});
+        auto Y = lu.solve(B);
+        EXPECT_LE(amax(abs(linalg::dot(a, Y) - B))(), 1e-6);
+
+        auto ref = linalg::slogdet(a);
+        auto det = lu.slogdet();
+        EXPECT_EQ(std::get<0>(det), std::get<0>(ref));
+        EXPECT_NEAR(std::get<1>(det), std::get<1>(ref), 1e-6 * std::abs(std::get<1>(ref)));
+
+        // the HODLR matrix as the operator of cg
+        double nb = linalg::norm(b);
+        xtensor<double, 1> xc;
+        auto info = linalg::cg(h, b, xc);
+        EXPECT_TRUE(info.converged);
+        EXPECT_LE(linalg::norm(linalg::dot(h, xc) - b), 1e-7 * nb);
+
+        // a coarse factorization preconditions the dense system
+        hodlr_options coarse;
+        coarse.leaf_size = 32;
+        coarse.tol = 1e-3;
+        auto m = linalg::lu_factor(xhodlr<double>(a, coarse));
+        xtensor<double, 1> xg;
+        auto plain = linalg::gmres(a, b, xg);
+        xg = xtensor<double, 1>();
+        auto preconditioned = linalg::gmres(a, b, xg, linalg::krylov_options(), m);
+        EXPECT_TRUE(preconditioned.converged);
+        EXPECT_LT(preconditioned.iterations, plain.iterations);
+        EXPECT_LE(amax(abs(xg - expected))(), 1e-5);
+    }
+
+    TEST(xhodlr, complex)
+    {
+        std::size_t n = 200;
+        auto entry = [n](std::size_t i, std::size_t j)
+        {
+            return std::complex<double>(hodlr_kernel(i, j, n), 0.5 * hodlr_kernel(i, j, n) - (i == j ? 0.05 : 0.));
+        };
+        xtensor<std::complex<double>, 2> a = xtensor<std::complex<double>, 2>::from_shape({n, n});
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                a(i, j) = entry(i, j);
+            }
+        }
+
+        hodlr_options options;
+        options.leaf_size = 16;
+        options.tol = 1e-12;
+        xhodlr<std::complex<double>> h(n, entry, options);
+        EXPECT_LE(amax(abs(h.dense() - a))(), 1e-9);
+
+        xtensor<std::complex<double>, 1> b = random::randn<double>({n}) + 1i * random::randn<double>({n});
+        auto x = linalg::solve(h, b);
+        EXPECT_LE(amax(abs(linalg::dot(a, x) - b))(), 1e-7);
+    }
+}
@@ -0,0 +1,443 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xcomplex.hpp"
+#include "xtensor/xmath.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xkrylov.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xsparse.hpp"
+
+namespace xt
+{
+    namespace
+    {
+        template <class T>
+        xtensor<T, 2> krylov_spd(std::size_t n)
+        {
+            xtensor<double, 2> g = xt::random::randn<double>({n, n});
+            xtensor<T, 2> a = xt::linalg::dot(g, xt::transpose(g)) / double(n);
+            a += xt::diag(xt::arange<double>(1., double(n) + 1.));
+            return a;
+        }
+
+        template <class T>
+        double krylov_residual(const xtensor<T, 2>& a, const xtensor<T, 1>& b, const xtensor<T, 1>& x)
+        {
+            xtensor<T, 1> r = b - xt::linalg::dot(a, x);
+            return xt::linalg::norm(r);
+        }
+
+        // 5-point Laplacian on an m x m grid, with a convection term c along the rows
+        xsparse_csr<double> krylov_grid(std::size_t m, double c)
+        {
+            std::vector<std::size_t> rows, cols;
+            std::vector<double> values;
+            auto add = [&](std::size_t i, std::size_t j, double value)
+            {
+                rows.push_back(i);
+                cols.push_back(j);
+                values.push_back(value);
+            };
+            for (std::size_t p = 0; p < m; ++p)
+            {
+                for (std::size_t q = 0; q < m; ++q)
+                {
+                    std::size_t i = p * m + q;
+                    add(i, i, 4.);
+                    if (p > 0)
+                    {
+                        add(i, i - m, -1.);
+                    }
+                    if (p + 1 < m)
+                    {
+                        add(i, i + m, -1.);
+                    }
+                    if (q > 0)
+                    {
+                        add(i, i - 1, -1. - c);
+                    }
+                    if (q + 1 < m)
+                    {
+                        add(i, i + 1, -1. + c);
+                    }
+                }
+            }
+            return xsparse_csr<double>::from_triplets(m * m, m * m, rows, cols, values);
+        }
+    }
+
+    TEST(xkrylov, cg)
+    {
+        xt::random::seed(11);
+        std::size_t n = 50;
+        xtensor<double, 2> a = krylov_spd<double>(n);
+        xtensor<double, 1> b = xt::random::randn<double>({n});
+        double nb = xt::linalg::norm(b);
+
+        xtensor<double, 1> x;
+        auto info = xt::linalg::cg(a, b, x);
+        EXPECT_TRUE(info.converged);
+        EXPECT_LE(krylov_residual(a, b, x), 1e-7 * nb);
+        EXPECT_NEAR(info.residual_norm, krylov_residual(a, b, x), 1e-10);
+
+        xtensor<double, 1> y;
+        xt::linalg::jacobi_preconditioner<double> m(xt::diagonal(a));
+        auto pinfo = xt::linalg::cg(xsparse_csr<double>(a), b, y, xt::linalg::krylov_options(), m);
+        EXPECT_TRUE(pinfo.converged);
+        EXPECT_LE(krylov_residual(a, b, y), 1e-7 * nb);
+
+        xt::linalg::krylov_options options;
+        options.max_iterations = 3;
+        xtensor<double, 1> z;
+        auto limited = xt::linalg::cg(a, b, z, options);
+        EXPECT_FALSE(limited.converged);
+        EXPECT_EQ(limited.iterations, 3u);
+
+        xtensor<double, 1> wrong = xt::zeros<double>({n + 1});
+        EXPECT_THROW(xt::linalg::cg(a, b, wrong), std::runtime_error);
+    }
+
+    TEST(xkrylov, minres)
+    {
+        xt::random::seed(12);
+        std::size_t n = 50;
+        // symmetric indefinite
+        xtensor<double, 2> a = krylov_spd<double>(n) - 20. * xt::eye<double>(n);
+        xtensor<double, 1> b = xt::random::randn<double>({n});
+
+        xtensor<double, 1> x;
+        auto info = xt::linalg::minres(a, b, x);
+        EXPECT_TRUE(info.converged);
+        EXPECT_LE(krylov_residual(a, b, x), 1e-7 * xt::linalg::norm(b));
+    }
+
+    TEST(xkrylov, gmres_bicgstab)
+    {
+        xt::random::seed(13);
+        std::size_t n = 50;
+        xtensor<double, 2> a = krylov_spd<double>(n) + 0.3 * xt::random::randn<double>({n, n});
+        xtensor<double, 1> b = xt::random::randn<double>({n});
+        double nb = xt::linalg::norm(b);
+        xt::linalg::jacobi_preconditioner<double> m(xt::diagonal(a));
+
+        for (std::size_t restart : {5u, 30u})
+        {
+            xt::linalg::krylov_options options;
+            options.restart = restart;
+            xtensor<double, 1> x;
+            auto info = xt::linalg::gmres(a, b, x, options, m);
+            EXPECT_TRUE(info.converged);
+            EXPECT_LE(krylov_residual(a, b, x), 1e-7 * nb);
+        }
+
+        xtensor<double, 1> x;
+        auto info = xt::linalg::bicgstab(xsparse_ccs<double>(a), b, x);
+        EXPECT_TRUE(info.converged);
+        EXPECT_LE(krylov_residual(a, b, x), 1e-7 * nb);
+
+        // the solution as initial guess converges at once
+        xt::linalg::krylov_options loose;
+        loose.rtol = 1e-6;
+        auto again = xt::linalg::gmres(a, b, x, loose);
+        EXPECT_TRUE(again.converged);
+        EXPECT_EQ(again.iterations, 0u);
+    }
+
+    TEST(xkrylov, complex)
+    {
+        using value_type = std::complex<double>;
+        xt::random::seed(14);
+        std::size_t n = 40;
+        xtensor<double, 2> re = xt::random::randn<double>({n, n});
+        xtensor<double, 2> im = xt::random::randn<double>({n, n});
+        xtensor<value_type, 2> g = re + value_type(0., 1.) * im;
+        // Hermitian positive definite
+        xtensor<value_type, 2> a = xt::linalg::dot(g, xt::conj(xt::transpose(g))) / double(n);
+        a += xt::diag(xt::arange<double>(1., double(n) + 1.));
+        xtensor<value_type, 1> b = xt::random::randn<double>({n});
+        double nb = xt::linalg::norm(b);
+
+        xtensor<value_type, 1> x;
+        EXPECT_TRUE(xt::linalg::cg(a, b, x).converged);
+        EXPECT_LE(krylov_residual(a, b, x), 1e-7 * nb);
+
+        xtensor<value_type, 1> y;
+        EXPECT_TRUE(xt::linalg::minres(a, b, y).converged);
+        EXPECT_LE(krylov_residual(a, b, y), 1e-7 * nb);
+
+        xtensor<value_type, 2> c = a + value_type(0., 0.3) * xt::eye<value_type>(n);
+        xtensor<value_type, 1> z;
+        EXPECT_TRUE(xt::linalg::gmres(c, b, z).converged);
+        EXPECT_LE(krylov_residual(c, b, z), 1e-7 * nb);
+
+        xtensor<value_type, 1> w;
+        EXPECT_TRUE(xt::linalg::bicgstab(c, b, w).converged);
+        EXPECT_LE(krylov_residual(c, b, w), 1e-7 * nb);
+    }
+
+    TEST(xkrylov, linear_operator)
+    {
+        // matrix-free 1d Laplacian
+        std::size_t n = 64;
+        using vector_type = xtensor<double, 1>;
+        xt::linalg::linear_operator<double> laplacian(n, [n](const vector_type& x, vector_type& y)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                y(i) = 2. * x(i) - (i > 0 ? x(i - 1) : 0.) - (i + 1 < n ? x(i + 1) : 0.);
+            }
+        });
+        EXPECT_EQ(laplacian.shape()[0], n);
+
+        vector_type b = xt::ones<double>({n});
+        vector_type x;
+        xt::linalg::krylov_options options;
+        options.rtol = 1e-12;
+        auto info = xt::linalg::cg(laplacian, b, x, options);
+        EXPECT_TRUE(info.converged);
+        EXPECT_LE(info.iterations, 2 * n);
+        // x(i) = (i + 1) (n - i) / 2
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            EXPECT_NEAR(x(i), double((i + 1) * (n - i)) / 2., 1e-5);
+        }
+
+        xtensor<double, 2> a = krylov_spd<double>(20);
+        auto op = xt::linalg::make_linear_operator(a);
+        vector_type c = xt::ones<double>({20});
+        vector_type y;
+        EXPECT_TRUE(xt::linalg::minres(op, c, y).converged);
+        EXPECT_LE(krylov_residual(a, c, y), 1e-7 * xt::linalg::norm(c));
+    }
+    TEST(xkrylov, incomplete_factorizations)
+    {
+        xt::random::seed(5);
+        std::size_t m = 16, n = m * m;
+        auto laplacian = krylov_grid(m, 0.);
+        xtensor<double, 2> a = laplacian.dense();
+        xtensor<double, 1> b = xt::random::randn<double>({n});
+        double nb = xt::linalg::norm(b);
+
+        // L L^T equals the matrix on its nonzeros
+        xt::linalg::ic0_preconditioner<double> ic(laplacian);
+        xtensor<double, 2> l = ic.factor().dense();
+        xtensor<double, 2> llt = xt::linalg::dot(l, xt::transpose(l));
+        EXPECT_TRUE(xt::allclose(xt::where(xt::not_equal(a, 0.), llt, 0.), a));
+
+        xtensor<double, 1> x, y;
+        auto plain = xt::linalg::cg(laplacian, b, x);
+        auto preconditioned = xt::linalg::cg(laplacian, b, y, xt::linalg::krylov_options(), ic);
+        EXPECT_TRUE(preconditioned.converged);
+        EXPECT_LT(preconditioned.iterations, plain.iterations);
+        EXPECT_LE(krylov_residual(a, b, y), 1e-7 * nb);
+
+        // the fixed-point sweeps converge to the same factor
+        xt::linalg::ic0_preconditioner<double> swept(laplacian, 60);
+        EXPECT_TRUE(xt::allclose(swept.factor().dense(), l));
+        xtensor<double, 1> z;
+        EXPECT_TRUE(xt::linalg::cg(laplacian, b, z, xt::linalg::krylov_options(),
+                                   xt::linalg::ic0_preconditioner<double>(laplacian, 3)).converged);
+
+        auto convection = krylov_grid(m, 0.4);
+        xtensor<double, 2> c = convection.dense();
+        xt::linalg::ilu0_preconditioner<double> ilu(convection);
+        xtensor<double, 2> f = ilu.factors().dense();
+        xtensor<double, 2> lu = xt::linalg::dot(xt::tril(f, -1) + xt::eye<double>(n), xt::triu(f));
+        EXPECT_TRUE(xt::allclose(xt::where(xt::not_equal(c, 0.), lu, 0.), c));
+        xt::linalg::ilu0_preconditioner<double> ilu_swept(convection, 60);
+        EXPECT_TRUE(xt::allclose(ilu_swept.factors().dense(), f));
+
+        xtensor<double, 1> u, v;
+        auto unpreconditioned = xt::linalg::gmres(convection, b, u);
+        auto with_ilu = xt::linalg::gmres(convection, b, v, xt::linalg::krylov_options(), ilu);
+        EXPECT_TRUE(with_ilu.converged);
+        EXPECT_LT(with_ilu.iterations, unpreconditioned.iterations);
+        EXPECT_LE(krylov_residual(c, b, v), 1e-7 * nb);
+
+        // without dropping, ILUT is the complete LU factorization
+        xt::linalg::ilut_preconditioner<double> exact(convection, 0., n);
+        xtensor<double, 2> g = exact.factors().dense();
+        EXPECT_TRUE(xt::allclose(xt::linalg::dot(xt::tril(g, -1) + xt::eye<double>(n), xt::triu(g)), c));
+        xtensor<double, 1> w;
+        EXPECT_LE(xt::linalg::bicgstab(convection, b, w, xt::linalg::krylov_options(), exact).iterations, 2u);
+
+        xt::linalg::ilut_preconditioner<double> ilut(convection, 1e-2, 5);
+        EXPECT_LE(ilut.factors().nnz(), 11 * n);
+        xtensor<double, 1> s;
+        auto with_ilut = xt::linalg::bicgstab(convection, b, s, xt::linalg::krylov_options(), ilut);
+        EXPECT_TRUE(with_ilut.converged);
+        EXPECT_LE(krylov_residual(c, b, s), 1e-7 * nb);
+
+        xtensor<double, 2> no_diagonal = {{0., 1.}, {1., 2.}};
+        EXPECT_THROW(xt::linalg::ilu0_preconditioner<double>(xsparse_csr<double>(no_diagonal)), std::runtime_error);
+        xtensor<double, 2> indefinite = {{1., 2.}, {2., 1.}};
+        EXPECT_THROW(xt::linalg::ic0_preconditioner<double>(xsparse_csr<double>(indefinite)), std::runtime_error);
+    }
+
+    TEST(xkrylov, block_jacobi)
+    {
+        xt::random::seed(9);
+        std::size_t n = 10, bs = 3;
+        xtensor<double, 2> a = krylov_spd<double>(n);
+        // keep the diagonal blocks, the last of order 1
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                if (i / bs != j / bs)
+                {
+                    a(i, j) = 0.;
+                }
+            }
+        }
+        xsparse_csr<double> csr(a);
+        xt::linalg::block_jacobi_preconditioner<double> m(csr, bs);
+        EXPECT_EQ(m.inverse_blocks().shape()[0], 4u);
+
+        xtensor<double, 1> x = xt::random::randn<double>({n});
+        xtensor<double, 1> ax = xt::linalg::dot(a, x);
+        xtensor<double, 1> y = xt::zeros<double>({n});
+        m.apply(ax, y);
+        EXPECT_TRUE(xt::allclose(y, x));
+
+        xt::linalg::jacobi_preconditioner<double> d(csr);
+        xt::linalg::block_jacobi_preconditioner<double> scalar(csr, 1);
+        xtensor<double, 1> dy = xt::zeros<double>({n});
+        d.apply(x, dy);
+        scalar.apply(x, y);
+        EXPECT_TRUE(xt::allclose(dy, x / xt::diagonal(a)));
+        EXPECT_TRUE(xt::allclose(y, dy));
+
+        auto laplacian = krylov_grid(8, 0.);
+        xtensor<double, 1> b = xt::ones<double>({64});
+        xtensor<double, 1> s;
+        EXPECT_TRUE(xt::linalg::cg(laplacian, b, s, xt::linalg::krylov_options(),
+                                   xt::linalg::block_jacobi_preconditioner<double>(laplacian, 8)).converged);
+        EXPECT_THROW(xt::linalg::block_jacobi_preconditioner<double>(csr, 0), std::runtime_error);
+    }
+
+    TEST(xkrylov, lstsq_randomized)
+    {
+        // columns scaled over six orders of magnitude: cond(A) ~ 1e6
+        xt::random::seed(29);
+        std::size_t m = 3000, n = 25;
+        xtensor<double, 1> scales = xt::pow(10., xt::linspace<double>(0., 6., n));
+        xtensor<double, 2> a = xt::random::randn<double>({m, n}) * xt::view(scales, xt::newaxis(), xt::all());
+        xtensor<double, 1> b = xt::random::randn<double>({m});
+        xtensor<double, 1> expected = std::get<0>(xt::linalg::lstsq(a, b));
+        double expected_residual = krylov_residual(a, b, expected);
+
+        xt::linalg::krylov_options options;
+        options.rtol = 1e-12;
+        auto res = xt::linalg::lstsq_randomized(a, b, options);
+        const auto& info = std::get<1>(res);
+        EXPECT_TRUE(info.converged);
+        EXPECT_LT(info.iterations, 100u);
+        // compared in the scale of the columns, where the problem is well conditioned
+        EXPECT_TRUE(xt::allclose(std::get<0>(res) * scales, expected * scales, 1e-6, 1e-8));
+        EXPECT_NEAR(info.residual_norm, expected_residual, 1e-8 * expected_residual);
+
+        // a lazy expression, read in blocks of 128 rows
+        xt::linalg::lstsq_randomized_options sketch;
+        sketch.block_rows = 128;
+        sketch.seed = 7;
+        auto lazy = xt::linalg::lstsq_randomized(2. * a, b, options, sketch);
+        EXPECT_TRUE(xt::allclose(2. * std::get<0>(lazy) * scales, expected * scales, 1e-6, 1e-8));
+
+        // a consistent system converges to its exact solution
+        xtensor<double, 1> x0 = xt::random::randn<double>({n});
+        xtensor<double, 1> consistent = xt::linalg::dot(a, x0);
+        auto exact = xt::linalg::lstsq_randomized(a, consistent, options);
+        EXPECT_TRUE(xt::allclose(std::get<0>(exact) * scales, x0 * scales, 1e-6, 1e-6));
+
+        xtensor<double, 2> wide = xt::random::randn<double>({5, 8});
+        EXPECT_THROW(xt::linalg::lstsq_randomized(wide, xtensor<double, 1>(xt::zeros<double>({5}))), std::runtime_error);
+        xtensor<double, 2> deficient = a;
+        xt::view(deficient, xt::all(), 3) = xt::view(deficient, xt::all(), 4);
+        EXPECT_THROW(xt::linalg::lstsq_randomized(deficient, b), std::runtime_error);
+    }
+
+    TEST(xkrylov, eigsh)
+    {
+        // 1d Laplacian, of eigenvalues 2 - 2 cos(k pi / (n + 1))
+        std::size_t n = 300;
+        using vector_type = xtensor<double, 1>;
+        xt::linalg::linear_operator<double> laplacian(n, [n](const vector_type& x, vector_type& y)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                y(i) = 2. * x(i) - (i > 0 ? x(i - 1) : 0.) - (i + 1 < n ? x(i + 1) : 0.);
+            }
+        });
+        auto exact = [n](std::size_t k) { return 2. - 2. * std::cos(double(k) * xt::numeric_constants<double>::PI / double(n + 1)); };
+
+        xt::linalg::krylov_eigen_options options;
+        options.ncv = 40;
+        auto smallest = xt::linalg::eigsh(laplacian, 5, xt::linalg::eigen_target::smallest_real, options);
+        auto largest = xt::linalg::eigsh(laplacian, 4, xt::linalg::eigen_target::largest_real);
+        for (std::size_t i = 0; i < 5; ++i)
+        {
+            EXPECT_NEAR(std::get<0>(smallest)(i), exact(i + 1), 1e-8);
+        }
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            EXPECT_NEAR(std::get<0>(largest)(i), exact(n - 3 + i), 1e-8);
+        }
+        const auto& x = std::get<1>(smallest);
+        xtensor<double, 2> gram = xt::linalg::dot(xt::transpose(x), x);
+        EXPECT_TRUE(xt::allclose(gram, xt::eye<double>(5), 1e-8, 1e-8));
+
+        xt::random::seed(15);
+        xtensor<double, 2> g = xt::random::randn<double>({80, 80});
+        xtensor<double, 2> a = g + xt::transpose(g);
+        xtensor<double, 1> w = xt::linalg::eigvalsh(a);
+        auto sparse = xt::linalg::eigsh(xsparse_csr<double>(a), 6, xt::linalg::eigen_target::smallest_real);
+        EXPECT_TRUE(xt::allclose(std::get<0>(sparse), xt::view(w, xt::range(0, 6)), 1e-8, 1e-8));
+        xtensor<double, 2> v = std::get<1>(sparse);
+        EXPECT_TRUE(xt::allclose(xt::linalg::dot(a, v), v * std::get<0>(sparse), 1e-7, 1e-7));
+
+        EXPECT_THROW(xt::linalg::eigsh(a, 80), std::runtime_error);
+    }
+
+    TEST(xkrylov, eigs)
+    {
+        // 2 x 2 rotation blocks of eigenvalues re +- i im, with an upper coupling
+        xt::random::seed(16);
+        std::size_t n = 120;
+        xtensor<double, 2> a = 0.05 * xt::triu(xt::random::randn<double>({n, n}), 2);
+        for (std::size_t b = 0; b < n / 2; ++b)
+        {
+            double re = double(b) / 10., im = 0.5 + double(b % 3);
+            a(2 * b, 2 * b) = re;
+            a(2 * b + 1, 2 * b + 1) = re;
+            a(2 * b, 2 * b + 1) = im;
+            a(2 * b + 1, 2 * b) = -im;
+        }
+
+        auto result = xt::linalg::eigs(a, 4, xt::linalg::eigen_target::largest_real);
+        const auto& w = std::get<0>(result);
+        EXPECT_NEAR(w(0).real(), 5.9, 1e-8);
+        EXPECT_NEAR(w(2).real(), 5.8, 1e-8);
+        EXPECT_NEAR(std::abs(w(0).imag()), 0.5 + double(59 % 3), 1e-8);
+        xtensor<std::complex<double>, 2> v = std::get<1>(result);
+        xtensor<std::complex<double>, 2> ac = a;
+        EXPECT_TRUE(xt::allclose(xt::linalg::dot(ac, v), v * w, 1e-7, 1e-7));
+    }
+}
@@ -7,6 +7,9 @@
 * The full license is in the file LICENSE, distributed with this software. *
 ****************************************************************************/
 
+#include <algorithm>
+#include <cstdint>
+
 #include "gtest/gtest.h"
 #include "xtensor/xarray.hpp"
 #include "xtensor/xview.hpp"
@@ -52,6 +55,51 @@ namespace xt
         EXPECT_TRUE(allclose(xt::real(eigvals), xt::real(eig_expected_0)));
         EXPECT_TRUE(allclose(abs(imag(eigvecs)), abs(imag(eig_expected_1))));
         EXPECT_TRUE(allclose(abs(real(eigvecs)), abs(real(eig_expected_1))));
+
+        auto split = xt::linalg::eig_split(eig_arg_0);
+        auto& wr = std::get<0>(split);
+        auto& wi = std::get<1>(split);
+        auto& VR = std::get<2>(split);
+        EXPECT_TRUE(allclose(wr, xt::real(eigvals)));
+        EXPECT_TRUE(allclose(wi, xt::imag(eigvals)));
+        EXPECT_TRUE(allclose(xt::view(VR, xt::all(), 1), xt::real(xt::view(eigvecs, xt::all(), 1))));
+        EXPECT_TRUE(allclose(xt::view(VR, xt::all(), 2), xt::imag(xt::view(eigvecs, xt::all(), 1))));
+        EXPECT_TRUE(allclose(xt::view(VR, xt::all(), 3), xt::real(xt::view(eigvecs, xt::all(), 3))));
+    }
+
+    TEST(xlapack, eigenvalues_expert)
+    {
+        xarray<double> arg_0 = {{ 1., -1.,  2.},
+                                { 1.,  1.,  1.},
+                                { 0.,  0., -3.}};
+
+        auto res = xt::linalg::eig(arg_0, xt::linalg::eig_vectors::both, xt::linalg::eig_balance::none);
+        auto& w = std::get<0>(res);
+        auto& vl = std::get<1>(res);
+        auto& vr = std::get<2>(res);
+        xarray<std::complex<double>> carg_0 = arg_0;
+        EXPECT_TRUE(allclose(xt::linalg::dot(carg_0, vr), vr * xt::view(w, xt::newaxis(), xt::all())));
+        EXPECT_TRUE(allclose(xt::linalg::dot(xt::conj(xt::transpose(vl)), carg_0),
+                             xt::view(w, xt::all(), xt::newaxis()) * xt::conj(xt::transpose(vl))));
+
+        auto values = xt::linalg::eig(arg_0, xt::linalg::eig_vectors::none);
+        EXPECT_TRUE(allclose(std::get<0>(values), w));
+        EXPECT_EQ(std::get<1>(values).size(), 0u);
+        EXPECT_EQ(std::get<2>(values).size(), 0u);
+
+        auto cond = xt::linalg::eig_condition(arg_0);
+        EXPECT_TRUE(allclose(std::get<0>(cond), std::get<0>(xt::linalg::eig(arg_0))));
+        EXPECT_TRUE(xt::all(std::get<3>(cond) > 0. && std::get<3>(cond) <= 1. + 1e-12));
+        EXPECT_EQ(std::get<4>(cond).size(), 3u);
+
+        xarray<std::complex<double>> complarg_0 = {{ 1.+1.i, 2.+0.i},
+                                                   { 0.-1.i, 0.5+0.i}};
+        auto complres = xt::linalg::eig(complarg_0, xt::linalg::eig_vectors::left);
+        auto& cw = std::get<0>(complres);
+        auto& cvl = std::get<1>(complres);
+        EXPECT_EQ(std::get<2>(complres).size(), 0u);
+        EXPECT_TRUE(allclose(xt::linalg::dot(xt::conj(xt::transpose(cvl)), complarg_0),
+                             xt::view(cw, xt::all(), xt::newaxis()) * xt::conj(xt::transpose(cvl))));
     }
 
     TEST(xlapack, generalized_eigenvalues)
@@ -83,6 +131,105 @@ namespace xt
         EXPECT_TRUE(allclose(abs(eigvecs), abs(eig_expected_1)));
     }
 
+    TEST(xlapack, generalized_eigenvalues_subset)
+    {
+        xarray<double> a = {{  0.24,  0.39,  0.42, -0.16},
+                            {  0.39, -0.11,  0.79,  0.63},
+                            {  0.42,  0.79, -0.25,  0.48},
+                            { -0.16,  0.63,  0.48, -0.03}};
+        xarray<double> b = {{  4.16, -3.12,  0.56, -0.10},
+                            { -3.12,  5.03, -0.83,  1.09},
+                            {  0.56, -0.83,  0.76,  0.34},
+                            { -0.10,  1.09,  0.34,  1.18}};
+        xtensor<double, 1> expected = { -2.225448, -0.454756,  0.100076,  1.127039 };
+
+        auto top = linalg::eigh(a, b, linalg::select_index{2, 3});
+        EXPECT_TRUE(allclose(std::get<0>(top), xt::view(expected, xt::range(2, 4))));
+        auto& v = std::get<1>(top);
+        EXPECT_TRUE(allclose(linalg::dot(a, v), linalg::dot(linalg::dot(b, v), xt::diag(std::get<0>(top)))));
+
+        auto negative = linalg::eigh(a, b, linalg::select_range{-10., 0.}, 'U');
+        EXPECT_TRUE(allclose(std::get<0>(negative), xt::view(expected, xt::range(0, 2))));
+
+        // B is factored once, then reused for several A
+        auto factor = linalg::generalized_eigh_factor(b);
+        auto full = factor.eigh(a);
+        EXPECT_TRUE(allclose(std::get<0>(full), expected));
+        EXPECT_TRUE(allclose(linalg::dot(xt::transpose(std::get<1>(full)), linalg::dot(b, std::get<1>(full))),
+                             xt::eye<double>(4)));
+        xarray<double> a2 = a + xt::eye<double>(4);
+        EXPECT_TRUE(allclose(factor.eigvalsh(a2), std::get<0>(linalg::eigh(a2, b))));
+        EXPECT_TRUE(allclose(std::get<0>(factor.eigh(a, linalg::select_index{0, 0})), xt::view(expected, xt::range(0, 1))));
+        EXPECT_THROW(linalg::generalized_eigh_factor(a), std::runtime_error);
+        EXPECT_THROW(linalg::eigh(b, a), std::runtime_error);
+
+        xarray<std::complex<double>> ca = {{ 1. + 0i, 1. - 1i},
+                                           { 1. + 1i, -2. + 0i}};
+        xarray<std::complex<double>> cb = {{ 2. + 0i, 0. + 1i},
+                                           { 0. - 1i, 2. + 0i}};
+        auto cres = linalg::eigh(ca, cb);
+        auto& cv = std::get<1>(cres);
+        xarray<std::complex<double>> cw = std::get<0>(cres);
+        EXPECT_TRUE(allclose(linalg::dot(ca, cv), linalg::dot(linalg::dot(cb, cv), xt::diag(cw))));
+        EXPECT_TRUE(allclose(linalg::generalized_eigh_factor(cb, 'U').eigvalsh(ca), std::get<0>(cres)));
+    }
+
+    TEST(xlapack, generalized_nonsymmetric)
+    {
+        xarray<double> a = {{ 1., 2., 0.},
+                            {-1., 1., 3.},
+                            { 0., 2., 4.}};
+        xarray<double> b = {{ 2., 0., 1.},
+                            { 1., 3., 0.},
+                            { 0., 1., 1.}};
+
+        // same eigenvalues as inv(B) A
+        auto res = linalg::eig(a, b);
+        auto& w = std::get<0>(res);
+        auto& v = std::get<1>(res);
+        xarray<std::complex<double>> ca = a, cb = b;
+        EXPECT_TRUE(allclose(linalg::dot(ca, v), linalg::dot(linalg::dot(cb, v), xt::diag(w))));
+
+        xarray<double> singular = {{ 1., 0., 0.},
+                                   { 0., 1., 0.},
+                                   { 0., 0., 0.}};
+        auto inf = std::get<0>(linalg::eig(xt::eval(xt::eye<double>(3)), singular));
+        EXPECT_EQ(std::count_if(inf.begin(), inf.end(), [](std::complex<double> x) { return std::isinf(x.real()); }), 1);
+
+        auto q = linalg::qz(a, b, linalg::schur_sort::left_half_plane);
+        auto& S = std::get<0>(q);
+        auto& T = std::get<1>(q);
+        auto& Q = std::get<2>(q);
+        auto& Z = std::get<3>(q);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(Q, S), xt::transpose(Z)), a));
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(Q, T), xt::transpose(Z)), b));
+        std::size_t negative = std::size_t(std::count_if(w.begin(), w.end(), [](std::complex<double> x) { return x.real() < 0.; }));
+        EXPECT_EQ(std::get<4>(q), negative);
+
+        auto cq = linalg::qz(ca, cb);
+        EXPECT_EQ(std::get<4>(cq), 0u);
+        EXPECT_NEAR(std::abs(std::get<0>(cq)(2, 0)), 0., 1e-12);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(std::get<2>(cq), std::get<1>(cq)),
+                                         xt::conj(xt::transpose(std::get<3>(cq)))), cb));
+
+        std::size_t last = ca.shape()[0] - 1;
+        xtensor<bool, 1> select = xt::zeros<bool>({last + 1});
+        select(last) = true;
+        auto& cS = std::get<0>(cq);
+        auto& cT = std::get<1>(cq);
+        auto cord = linalg::ordqz(cS, cT, std::get<2>(cq), std::get<3>(cq), select);
+        EXPECT_EQ(std::get<4>(cord), 1u);
+        EXPECT_NEAR(std::abs(std::get<0>(cord)(0, 0) / std::get<1>(cord)(0, 0) - cS(last, last) / cT(last, last)), 0., 1e-10);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(std::get<2>(cord), std::get<0>(cord)),
+                                         xt::conj(xt::transpose(std::get<3>(cord)))), ca));
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(std::get<2>(cord), std::get<1>(cord)),
+                                         xt::conj(xt::transpose(std::get<3>(cord)))), cb));
+
+        auto novec = linalg::qz(a, b, linalg::schur_sort::none, false);
+        EXPECT_EQ(std::get<2>(novec).size(), 0u);
+        EXPECT_EQ(std::get<3>(novec).size(), 0u);
+    }
+
     TEST(xlapack, inverse)
     {
         xarray<double> a = {{ 2, 1, 1},
@@ -147,6 +294,190 @@ namespace xt
         EXPECT_EQ(expected3, res3);
     }
 
+    TEST(xlapack, solve_mixed_precision)
+    {
+        xarray<double> a = {{ 2, 1, 1},
+                            {-1, 1,-1},
+                            { 1, 2, 3}};
+        xarray<double> vec = {2, 3, -10};
+        xarray<double> expected = {3, 1, -5};
+
+        auto res = linalg::solve(a, vec, linalg::solve_mode::mixed_precision);
+        EXPECT_TRUE(allclose(std::get<0>(res), expected));
+
+        auto full = linalg::solve(a, vec, linalg::solve_mode::full_precision);
+        EXPECT_TRUE(allclose(std::get<0>(full), expected));
+        EXPECT_EQ(std::get<1>(full), 0);
+
+        xarray<float> af = a;
+        auto resf = linalg::solve(af, xarray<float>(vec), linalg::solve_mode::mixed_precision);
+        EXPECT_TRUE(allclose(std::get<0>(resf), xarray<float>(expected)));
+        EXPECT_EQ(std::get<1>(resf), 0);
+
+        xarray<double> spd = {{4, 1, 0},
+                              {1, 3, 1},
+                              {0, 1, 2}};
+        xarray<double> rhs = {{1, 2},
+                              {0, 1},
+                              {3, 0}};
+        for (auto mode : {linalg::solve_mode::full_precision, linalg::solve_mode::mixed_precision})
+        {
+            for (char uplo : {'L', 'U'})
+            {
+                auto r = linalg::solve_positive_definite(spd, rhs, mode, uplo);
+                EXPECT_TRUE(allclose(std::get<0>(r), linalg::solve(spd, rhs)));
+            }
+        }
+
+        xarray<std::complex<double>> h = {{ 4. + 0i, 1. - 1i},
+                                          { 1. + 1i, 3. + 0i}};
+        xarray<std::complex<double>> hb = {1. + 2i, 3. - 1i};
+        auto hr = linalg::solve_positive_definite(h, hb, linalg::solve_mode::mixed_precision);
+        EXPECT_TRUE(allclose(std::get<0>(hr), linalg::solve(h, hb)));
+        auto cr = linalg::solve(h, hb, linalg::solve_mode::mixed_precision);
+        EXPECT_TRUE(allclose(std::get<0>(cr), linalg::solve(h, hb)));
+
+        xarray<double> indefinite = {{0, 1},
+                                     {1, 0}};
+        EXPECT_THROW(linalg::solve_positive_definite(indefinite, xarray<double>{1, 1},
+                                                     linalg::solve_mode::mixed_precision),
+                     std::runtime_error);
+    }
+
+    TEST(xlapack, solve_structure)
+    {
+        xarray<double> rhs = {{1, 2},
+                              {0, 1},
+                              {3, 0}};
+        xarray<double> general = {{ 2, 1, 1},
+                                  {-1, 1,-1},
+                                  { 1, 2, 3}};
+        xarray<double> spd = {{4, 1, 0},
+                              {1, 3, 1},
+                              {0, 1, 2}};
+        xarray<double> indefinite = {{1, 2, 0},
+                                     {2, 1, 1},
+                                     {0, 1, -1}};
+        xarray<double> lower = {{2, 0, 0},
+                                {1, 4, 0},
+                                {0, 3, 5}};
+        xarray<double> upper = xt::transpose(lower);
+
+        EXPECT_EQ(linalg::detect_structure(general), linalg::assume_a::general);
+        EXPECT_EQ(linalg::detect_structure(spd), linalg::assume_a::positive_definite);
+        EXPECT_EQ(linalg::detect_structure(indefinite), linalg::assume_a::hermitian);
+        EXPECT_EQ(linalg::detect_structure(lower), linalg::assume_a::lower_triangular);
+        EXPECT_EQ(linalg::detect_structure(upper), linalg::assume_a::upper_triangular);
+
+        EXPECT_TRUE(allclose(linalg::solve(general, rhs, linalg::assume_a::general), linalg::solve(general, rhs)));
+        EXPECT_TRUE(allclose(linalg::solve(spd, rhs, linalg::assume_a::positive_definite), linalg::solve(spd, rhs)));
+        EXPECT_TRUE(allclose(linalg::solve(indefinite, rhs, linalg::assume_a::symmetric), linalg::solve(indefinite, rhs)));
+        EXPECT_TRUE(allclose(linalg::solve(lower, rhs, linalg::assume_a::lower_triangular), linalg::solve(lower, rhs)));
+        EXPECT_TRUE(allclose(linalg::solve(upper, rhs, linalg::assume_a::upper_triangular), linalg::solve(upper, rhs)));
+        for (const auto& a : {general, spd, indefinite, lower, upper})
+        {
+            EXPECT_TRUE(allclose(linalg::solve(a, rhs, linalg::assume_a::detect), linalg::solve(a, rhs)));
+        }
+        EXPECT_THROW(linalg::solve(indefinite, rhs, linalg::assume_a::positive_definite), std::runtime_error);
+
+        // positive diagonal, but not positive definite
+        xarray<double> not_spd = {{1, 2},
+                                  {2, 1}};
+        xarray<double> v = {1, 3};
+        EXPECT_EQ(linalg::detect_structure(not_spd), linalg::assume_a::positive_definite);
+        EXPECT_TRUE(allclose(linalg::solve(not_spd, v, linalg::assume_a::detect), linalg::solve(not_spd, v)));
+
+        xarray<std::complex<double>> h = {{ 1. + 0i, 1. - 1i},
+                                          { 1. + 1i, -2. + 0i}};
+        xarray<std::complex<double>> hb = {1. + 2i, 3. - 1i};
+        EXPECT_EQ(linalg::detect_structure(h), linalg::assume_a::hermitian);
+        EXPECT_TRUE(allclose(linalg::solve(h, hb, linalg::assume_a::hermitian), linalg::solve(h, hb)));
+        xarray<std::complex<double>> cs = {{ 1. + 1i, 2. - 1i},
+                                           { 2. - 1i, 0. + 3i}};
+        EXPECT_EQ(linalg::detect_structure(cs), linalg::assume_a::symmetric);
+        EXPECT_TRUE(allclose(linalg::solve(cs, hb, linalg::assume_a::detect), linalg::solve(cs, hb)));
+    }
+
+    TEST(xlapack, solve_refined)
+    {
+        // rows and columns scaled over twelve orders of magnitude
+        xarray<double> a = {{ 4e6, 1e3,  2e0},
+                            { 1e3, 5e0, -1e-3},
+                            {-2e0, 3e-3, 6e-6}};
+        xarray<double> b = {{1, 2},
+                            {0, 1},
+                            {3, 0}};
+
+        auto scaled = linalg::solve_refined(a, b);
+        auto unscaled = linalg::solve_refined(a, b, linalg::assume_a::general, false);
+        EXPECT_TRUE(allclose(linalg::dot(a, std::get<0>(scaled)), b));
+        EXPECT_GT(std::get<1>(scaled), 100. * std::get<1>(unscaled));
+        EXPECT_EQ(std::get<2>(scaled).size(), 2u);
+        EXPECT_LT(std::get<3>(scaled)(0), 1e-14);
+        EXPECT_LT(std::get<3>(scaled)(1), 1e-14);
+
+        xarray<double> spd = {{4e4, 1e2, 0},
+                              {1e2, 3e0, 1e-2},
+                              {0, 1e-2, 2e-4}};
+        xarray<double> v = {1, 2, 3};
+        auto p = linalg::solve_refined(spd, v, linalg::assume_a::positive_definite);
+        EXPECT_TRUE(allclose(linalg::dot(spd, std::get<0>(p)), v));
+        EXPECT_EQ(std::get<0>(p).dimension(), 1u);
+
+        // positive diagonal, but not positive definite
+        xarray<double> not_spd = {{1, 2},
+                                  {2, 1}};
+        xarray<double> w = {1, 3};
+        EXPECT_TRUE(allclose(std::get<0>(linalg::solve_refined(not_spd, w, linalg::assume_a::detect)),
+                             linalg::solve(not_spd, w)));
+        EXPECT_THROW(linalg::solve_refined(not_spd, w, linalg::assume_a::positive_definite), std::runtime_error);
+
+        xarray<double> singular = {{1, 2},
+                                   {2, 4}};
+        EXPECT_THROW(linalg::solve_refined(singular, w), std::runtime_error);
+    }
+
+    TEST(xlapack, inv_structure)
+    {
+        xarray<double> spd = {{4, 1, 0},
+                              {1, 3, 1},
+                              {0, 1, 2}};
+        xarray<double> indefinite = {{1, 2, 0},
+                                     {2, 1, 1},
+                                     {0, 1, -1}};
+        xarray<double> lower = {{2, 0, 0},
+                                {1, 4, 0},
+                                {0, 3, 5}};
+        xarray<double> upper = xt::transpose(lower);
+
+        EXPECT_TRUE(allclose(linalg::inv(spd, linalg::assume_a::positive_definite), linalg::inv(spd)));
+        EXPECT_TRUE(allclose(linalg::inv(indefinite, linalg::assume_a::symmetric), linalg::inv(indefinite)));
+        EXPECT_TRUE(allclose(linalg::inv(indefinite, linalg::assume_a::hermitian), linalg::inv(indefinite)));
+        EXPECT_TRUE(allclose(linalg::inv(lower, linalg::assume_a::lower_triangular), linalg::inv(lower)));
+        EXPECT_TRUE(allclose(linalg::inv(upper, linalg::assume_a::upper_triangular), linalg::inv(upper)));
+        for (const auto& a : {spd, indefinite, lower, upper})
+        {
+            EXPECT_TRUE(allclose(linalg::inv(a, linalg::assume_a::detect), linalg::inv(a)));
+        }
+        EXPECT_THROW(linalg::inv(indefinite, linalg::assume_a::positive_definite), std::runtime_error);
+
+        xarray<double> singular_lower = {{1, 0},
+                                         {1, 0}};
+        EXPECT_THROW(linalg::inv(singular_lower, linalg::assume_a::lower_triangular), std::runtime_error);
+
+        xarray<std::complex<double>> h = {{ 1. + 0i, 1. - 1i},
+                                          { 1. + 1i, -2. + 0i}};
+        EXPECT_TRUE(allclose(linalg::inv(h, linalg::assume_a::hermitian), linalg::inv(h)));
+        xarray<std::complex<double>> cs = {{ 1. + 1i, 2. - 1i},
+                                           { 2. - 1i, 0. + 3i}};
+        EXPECT_TRUE(allclose(linalg::inv(cs, linalg::assume_a::symmetric), linalg::inv(cs)));
+
+        // only the lower triangle of the inverse
+        auto chol = linalg::cholesky_factor(spd);
+        xarray<double> half = chol.inv(false);
+        EXPECT_TRUE(allclose(half, xt::tril(linalg::inv(spd))));
+    }
+
     TEST(xlapack, solveCholesky) {
 
         xarray<double> A =
@@ -185,6 +516,200 @@ namespace xt
         for (int i = 0; i < x_expected.shape()[0]; ++i) {
           EXPECT_DOUBLE_EQ(x_expected[i], x[i]);
         }
+
+        // upper and transposed systems read the row-major A in place
+        const xt::xtensor<double, 2> U = xt::transpose(A);
+        EXPECT_TRUE(allclose(linalg::solve_triangular(U, b, 'U', false, 'T'), x));
+        EXPECT_TRUE(allclose(linalg::dot(U, linalg::solve_triangular(U, b, 'U')), b));
+        xt::xtensor<double, 2> B = xt::stack(xt::xtuple(b, 2. * b), 1);
+        auto X = linalg::solve_triangular(A, B);
+        EXPECT_TRUE(allclose(linalg::dot(A, X), B));
+
+        xt::xtensor<double, 2> unit = A;
+        xt::diagonal(unit) = 5.;
+        xt::xtensor<double, 2> unit_expected = A;
+        xt::diagonal(unit_expected) = 1.;
+        EXPECT_TRUE(allclose(linalg::solve_triangular(unit, b, 'L', true), linalg::solve_triangular(unit_expected, b)));
+
+        xt::xtensor<std::complex<double>, 2> CA = {{ 2.+1.i, 0.+0.i},
+                                                   { 1.-1.i, 1.+2.i}};
+        xt::xtensor<std::complex<double>, 1> cb = {1.+0.i, 2.-1.i};
+        auto cx = linalg::solve_triangular(CA, cb, 'L', false, 'C');
+        EXPECT_TRUE(allclose(linalg::dot(xt::conj(xt::transpose(CA)), cx), cb));
+
+        xt::xtensor<double, 2> singular = {{1., 0.}, {1., 0.}};
+        EXPECT_THROW(linalg::solve_triangular(singular, xt::xtensor<double, 1>{1., 1.}), std::runtime_error);
+    }
+
+    TEST(xlapack, workspace_cache)
+    {
+        xarray<double> a = {{ 2., -1.,  0.},
+                            {-1.,  2., -1.},
+                            { 0., -1.,  2.}};
+        lapack::clear_workspace_cache<double>();
+
+        auto first = linalg::eigh(a);
+        auto& cache = lapack::workspace<double>::thread_local_instance();
+        const double* work = cache.work.data();
+        EXPECT_GT(cache.work.size(), 0u);
+
+        // same shape: the cached arrays are reused as is
+        auto second = linalg::eigh(a);
+        EXPECT_EQ(work, cache.work.data());
+        EXPECT_TRUE(allclose(std::get<0>(first), std::get<0>(second)));
+        EXPECT_TRUE(allclose(std::get<1>(first), std::get<1>(second)));
+
+        lapack::clear_workspace_cache<double>();
+        EXPECT_EQ(cache.work.size(), 0u);
+    }
+
+    TEST(xlapack, prepared_workspace)
+    {
+        using matrix_type = xtensor<double, 2, layout_type::column_major>;
+        matrix_type a = {{ 2., -1.,  0.},
+                         {-1.,  2., -1.},
+                         { 0., -1.,  2.}};
+        matrix_type b = a;
+        xtensor<double, 1, layout_type::column_major> w = zeros<double>({3});
+        xtensor<double, 1, layout_type::column_major> w_ref = zeros<double>({3});
+
+        lapack::workspace<double> ws;
+        auto sizes = ws.prepare<lapack::routine::syevd>({3}, {'V', 'L'});
+        auto expected = lapack::workspace_size<lapack::routine::syevd, double>({3}, {'V', 'L'});
+        EXPECT_EQ(sizes.work, expected.work);
+        EXPECT_EQ(sizes.iwork, expected.iwork);
+        EXPECT_GE(ws.work.size(), sizes.work);
+
+        const double* work = ws.work.data();
+        EXPECT_EQ(lapack::syevd(a, 'V', 'L', w, ws), 0);
+        EXPECT_EQ(work, ws.work.data());
+
+        EXPECT_EQ(lapack::syevd(b, 'V', 'L', w_ref), 0);
+        EXPECT_TRUE(allclose(w, w_ref));
+    }
+
+    TEST(xlapack, memory_budget)
+    {
+        xtensor<double, 2> a = {{ 4., -1.,  0.,  1.},
+                                {-1.,  4., -1.,  0.},
+                                { 0., -1.,  4., -1.},
+                                { 1.,  0., -1.,  4.}};
+        xtensor<double, 1> b = {1., 2., 3., 4.};
+
+        auto eigh_ref = linalg::eigh(a);
+        EXPECT_EQ(lapack::last_driver(), lapack::routine::syevd);
+        auto svd_ref = linalg::svd(a);
+        EXPECT_EQ(lapack::last_driver(), lapack::routine::gesdd);
+        auto lstsq_ref = linalg::lstsq(a, b);
+        EXPECT_EQ(lapack::last_driver(), lapack::routine::gelsd);
+
+        {
+            // no workspace fits in a byte
+            lapack::scoped_memory_budget budget(1);
+            EXPECT_EQ(lapack::memory_budget(), 1u);
+
+            auto e = linalg::eigh(a);
+            EXPECT_EQ(lapack::last_driver(), lapack::routine::syev);
+            EXPECT_TRUE(allclose(std::get<0>(e), std::get<0>(eigh_ref)));
+            EXPECT_TRUE(allclose(abs(std::get<1>(e)), abs(std::get<1>(eigh_ref))));
+
+            auto s = linalg::svd(a);
+            EXPECT_EQ(lapack::last_driver(), lapack::routine::gesvd);
+            EXPECT_TRUE(allclose(std::get<1>(s), std::get<1>(svd_ref)));
+
+            auto l = linalg::lstsq(a, b);
+            EXPECT_EQ(lapack::last_driver(), lapack::routine::gelss);
+            EXPECT_TRUE(allclose(std::get<0>(l), std::get<0>(lstsq_ref)));
+            EXPECT_EQ(std::get<2>(l), std::get<2>(lstsq_ref));
+        }
+        EXPECT_EQ(lapack::memory_budget(), 0u);
+
+        xtensor<std::complex<double>, 2> h = {{{2., 0.}, {0., -1.}}, {{0., 1.}, {2., 0.}}};
+        auto heigh_ref = linalg::eigh(h);
+        lapack::set_memory_budget(1);
+        auto he = linalg::eigh(h);
+        lapack::set_memory_budget(0);
+        EXPECT_EQ(lapack::last_driver(), lapack::routine::heev);
+        EXPECT_TRUE(allclose(std::get<0>(he), std::get<0>(heigh_ref)));
     }
 
+    TEST(xlapack, aligned_workspace)
+    {
+        auto is_aligned = [](const void* p, std::size_t alignment)
+        {
+            return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+        };
+
+        lapack::workspace<std::complex<double>> ws;
+        ws.prepare<lapack::routine::heevd>({9}, {'V', 'L'});
+        EXPECT_TRUE(is_aligned(ws.work.data(), 64));
+        EXPECT_TRUE(is_aligned(ws.rwork.data(), 64));
+        EXPECT_TRUE(is_aligned(ws.iwork.data(), 64));
+
+        // huge page alignment and the parallel first touch keep the buffer usable
+        std::size_t threshold = blas::huge_page_threshold();
+        bool first_touch = blas::parallel_first_touch();
+        blas::set_huge_page_threshold(std::size_t(4) << 20);
+        blas::set_parallel_first_touch(true);
+        EXPECT_TRUE(blas::parallel_first_touch());
+        {
+            blas_buffer<double> large(std::size_t(1) << 20);
+            EXPECT_TRUE(is_aligned(large.data(), std::size_t(2) << 20));
+            std::fill(large.begin(), large.end(), 1.);
+            EXPECT_EQ(large[large.size() - 1], 1.);
+
+            using aligned_matrix = xtensor<double, 2, layout_type::row_major, blas_allocator<double>>;
+            xarray<double> a = {{1., 2.}, {3., 4.}};
+            aligned_matrix product = linalg::dot(a, a, linalg::result_as<aligned_matrix>());
+            EXPECT_TRUE(is_aligned(product.data(), 64));
+            EXPECT_EQ(product(1, 1), 22.);
+        }
+        blas::set_huge_page_threshold(threshold);
+        blas::set_parallel_first_touch(first_touch);
+    }
+
+    TEST(xlapack, scratch_arena)
+    {
+        xtensor<double, 2> a = {{4., 1., 0.}, {1., 3., 1.}, {0., 1., 2.}};
+        xtensor<double, 1> b = {1., 2., 3.};
+        xtensor<double, 1> expected = linalg::dot(a + 1., b);
+
+        blas::release_scratch();
+        blas::reset_scratch_high_water_mark();
+        std::size_t capacity = 0;
+        {
+            blas::scratch_scope scope;
+            for (int i = 0; i < 4; ++i)
+            {
+                // a + 1 has no data interface and is copied by view_eval
+                xtensor<double, 1> r = linalg::dot(a + 1., b);
+                EXPECT_TRUE(allclose(r, expected));
+                if (i == 1)
+                {
+                    capacity = blas::scratch_capacity();
+                }
+            }
+            // the arena stops growing once a loop iteration fits in it
+            EXPECT_GT(capacity, 0u);
+            EXPECT_EQ(blas::scratch_capacity(), capacity);
+            EXPECT_GE(blas::scratch_high_water_mark(), 9 * sizeof(double));
+
+            // memory still in use when the arena is released stays valid
+            scratch_buffer<double> live(16);
+            blas::release_scratch();
+            EXPECT_EQ(blas::scratch_capacity(), capacity);
+            live[15] = 1.;
+        }
+        blas::release_scratch();
+        EXPECT_EQ(blas::scratch_capacity(), 0u);
+
+        // outside of a scope the allocator takes aligned heap memory
+        scratch_buffer<double> heap(8);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(heap.data()) % 64, 0u);
+        EXPECT_EQ(blas::scratch_capacity(), 0u);
+
+        blas::reserve_scratch(std::size_t(1) << 16);
+        EXPECT_GE(blas::scratch_capacity(), std::size_t(1) << 16);
+        blas::release_scratch();
+    }
 }
@@ -12,8 +12,10 @@
 #include "xtensor/xview.hpp"
 #include "xtensor/xbuilder.hpp"
 #include "xtensor/xcomplex.hpp"
+#include "xtensor/xfixed.hpp"
 #include "xtensor/xrandom.hpp"
 #include "xtensor/xio.hpp"
+#include "xtensor/xmath.hpp"
 #include "xtensor-blas/xblas.hpp"
 #include "xtensor-blas/xlapack.hpp"
 #include "xtensor-blas/xlinalg.hpp"
@@ -63,6 +65,373 @@ namespace xt
         EXPECT_TRUE(allclose(t5res, t5expected));
     }
 
+    TEST(xlinalg, matrixpower_paths)
+    {
+        EXPECT_EQ(linalg::detail::matrix_power_products(1), 0u);
+        EXPECT_EQ(linalg::detail::matrix_power_products(4), 2u);
+        EXPECT_EQ(linalg::detail::matrix_power_products(41), 7u);
+
+        xarray<double> a = {{0, 1, 2},
+                            {3, 4, 5},
+                            {6, 7, 8}};
+        xarray<double> a5 = {{ 32400,  41796,  51192},
+                             { 99468, 128304, 157140},
+                             {166536, 214812, 263088}};
+
+        xtensor<double, 2> r = zeros<double>({3, 3});
+        linalg::matrix_power(a, 5, r);
+        EXPECT_TRUE(allclose(r, a5));
+        xtensor<double, 2, layout_type::column_major> r_cm = zeros<double>({3, 3});
+        linalg::matrix_power(a, 5, r_cm);
+        EXPECT_TRUE(allclose(r_cm, a5));
+        linalg::matrix_power(a, 0, r);
+        EXPECT_EQ(r, xarray<double>(eye<double>(3)));
+
+        xtensor<double, 2> wrong = zeros<double>({2, 2});
+        EXPECT_THROW(linalg::matrix_power(a, 2, wrong), std::runtime_error);
+
+        // the eigendecomposition path for symmetric matrices
+        xarray<double> s = {{2, 1, 0},
+                            {1, 3, 1},
+                            {0, 1, 4}};
+        EXPECT_TRUE(allclose(linalg::matrix_power(s, 40), linalg::matrix_power(s, 40, linalg::assume_a::symmetric)));
+        EXPECT_TRUE(allclose(linalg::matrix_power(s, -33), linalg::matrix_power(s, -33, linalg::assume_a::detect)));
+        EXPECT_TRUE(allclose(linalg::matrix_power(s, 3), linalg::matrix_power(s, 3, linalg::assume_a::positive_definite)));
+
+        xarray<std::complex<double>> h = {{2.0 + 0i, 1.0 - 1i},
+                                          {1.0 + 1i, 3.0 + 0i}};
+        EXPECT_TRUE(allclose(linalg::matrix_power(h, 37), linalg::matrix_power(h, 37, linalg::assume_a::hermitian)));
+
+        xarray<int> ai = {{1, 1}, {1, 0}};
+        xarray<int> fib = {{89, 55}, {55, 34}};
+        EXPECT_EQ(fib, linalg::matrix_power(ai, 10, linalg::assume_a::symmetric));
+    }
+
+    TEST(xlinalg, batch_matrix_power)
+    {
+        xarray<double> a = {{{0, 1, 2}, {3, 4, 5}, {6, 7, 8}},
+                            {{-2, 1, 3}, {3, 2, 1}, {1, 2, 5}}};
+
+        auto r = linalg::batch_matrix_power(a, 5);
+        ASSERT_EQ(r.shape(), a.shape());
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            xarray<double> m = view(a, i);
+            EXPECT_TRUE(allclose(xarray<double>(view(r, i)), linalg::matrix_power(m, 5)));
+        }
+
+        auto ri = linalg::batch_matrix_power(view(a, range(1, 2)), -2);
+        xarray<double> t4expected = {{ 0.09259259,-0.09259259, 0.01851852},
+                                     { 0.35185185, 0.64814815,-0.46296296},
+                                     {-0.2037037 ,-0.2962963 , 0.25925926}};
+        EXPECT_TRUE(allclose(xarray<double>(view(ri, 0)), t4expected));
+
+        auto r0 = linalg::batch_matrix_power(a, 0);
+        EXPECT_EQ(xarray<double>(view(r0, 1)), xarray<double>(eye<double>(3)));
+    }
+
+    TEST(xlinalg, expm)
+    {
+        xarray<double> zero = zeros<double>({3, 3});
+        EXPECT_TRUE(allclose(linalg::expm(zero), eye<double>(3)));
+
+        xarray<double> nilpotent = {{0., 1.}, {0., 0.}};
+        xarray<double> e_nilpotent = {{1., 1.}, {0., 1.}};
+        EXPECT_TRUE(allclose(linalg::expm(nilpotent), e_nilpotent));
+
+        xarray<double> d = {{1., 0.}, {0., -2.}};
+        xarray<double> e_d = {{std::exp(1.), 0.}, {0., std::exp(-2.)}};
+        EXPECT_TRUE(allclose(linalg::expm(d), e_d));
+
+        // large norms are scaled and squared
+        double theta = 10.;
+        xarray<double> rotation = {{0., -theta}, {theta, 0.}};
+        xarray<double> e_rotation = {{std::cos(theta), -std::sin(theta)}, {std::sin(theta), std::cos(theta)}};
+        EXPECT_TRUE(allclose(linalg::expm(rotation), e_rotation));
+
+        xarray<double> a = {{0.5, 2., -1.}, {1., -3., 0.25}, {4., 0.3, 1.}};
+        xarray<double> minus_a = -a;
+        auto product = linalg::dot(linalg::expm(a), linalg::expm(minus_a));
+        EXPECT_TRUE(allclose(product, eye<double>(3), 1e-8, 1e-8));
+
+        xarray<std::complex<double>> c = {{0. + 1i, 0.}, {0., 2. - 1i}};
+        xarray<std::complex<double>> e_c = {{std::exp(1i), 0.}, {0., std::exp(2. - 1i)}};
+        EXPECT_TRUE(allclose(linalg::expm(c), e_c));
+    }
+
+    TEST(xlinalg, sqrtm)
+    {
+        xarray<double> spd = {{4., 1., 0.5}, {1., 3., 0.2}, {0.5, 0.2, 2.}};
+        auto r = linalg::sqrtm(spd);
+        EXPECT_TRUE(allclose(linalg::dot(r, r), spd));
+
+        // complex conjugate eigenvalues give 2 x 2 blocks in the real Schur form
+        xarray<double> a = {{1., -2., 0., 0.5}, {2., 1., 0.3, 0.}, {0., 0.1, 3., -1.}, {0.2, 0., 1., 3.}};
+        auto ra = linalg::sqrtm(a);
+        EXPECT_TRUE(allclose(linalg::dot(ra, ra), a));
+
+        xarray<std::complex<double>> c = {{-1. + 0i, 2. + 1i}, {0.5 - 1i, -3. + 0.5i}};
+        auto rc = linalg::sqrtm(c);
+        EXPECT_TRUE(allclose(linalg::dot(rc, rc), c));
+
+        xarray<double> negative = {{-1., 0.}, {0., 4.}};
+        EXPECT_THROW(linalg::sqrtm(negative), std::runtime_error);
+    }
+
+    TEST(xlinalg, inv_sqrtm_whiten)
+    {
+        xt::random::seed(3);
+        xarray<double> b = xt::random::randn<double>({6, 6});
+        xarray<double> spd = linalg::dot(b, xt::transpose(b)) + 0.5 * xt::eye<double>(6);
+        auto r = linalg::inv_sqrtm_sym(spd);
+        EXPECT_TRUE(allclose(r, xt::transpose(r)));
+        EXPECT_TRUE(allclose(linalg::dot(r, linalg::dot(spd, r)), xt::eye<double>(6), 1e-8, 1e-8));
+        EXPECT_TRUE(allclose(linalg::inv_sqrtm_sym(spd, 0.25),
+                             linalg::inv_sqrtm_sym(xarray<double>(spd + 0.25 * xt::eye<double>(6)))));
+
+        // pseudo-inverse square root of a singular matrix
+        xarray<double> thin = xt::random::randn<double>({6, 3});
+        xarray<double> psd = linalg::dot(thin, xt::transpose(thin));
+        auto rp = linalg::inv_sqrtm_sym(psd);
+        EXPECT_TRUE(allclose(linalg::dot(rp, rp), linalg::pinv(psd, 1e-10), 1e-6, 1e-8));
+
+        using cd = std::complex<double>;
+        xarray<cd> c = xt::random::randn<double>({4, 4}) + cd(0, 1) * xt::random::randn<double>({4, 4});
+        xarray<cd> hpd = linalg::dot(c, xt::conj(xt::transpose(c))) + xt::eye<double>(4);
+        auto rc = linalg::inv_sqrtm_sym(hpd);
+        EXPECT_TRUE(allclose(linalg::dot(rc, linalg::dot(hpd, rc)), xt::eye<cd>(4), 1e-8, 1e-8));
+
+        xarray<double> stack = xt::random::randn<double>({5, 4, 4});
+        for (std::size_t p = 0; p < 5; ++p)
+        {
+            auto slice = xt::view(stack, p);
+            slice = linalg::dot(slice, xt::transpose(slice)) + xt::eye<double>(4);
+        }
+        auto rs = linalg::batch_inv_sqrtm_sym(stack);
+        EXPECT_EQ(rs.shape(), stack.shape());
+        for (std::size_t p = 0; p < 5; ++p)
+        {
+            EXPECT_TRUE(allclose(xt::view(rs, p), linalg::inv_sqrtm_sym(xarray<double>(xt::view(stack, p)))));
+        }
+
+        // correlated observations with an offset
+        xarray<double> mixing = {{2., 0., 0.}, {1., 0.5, 0.}, {-1., 0.3, 0.2}};
+        xarray<double> X = linalg::dot(xt::random::randn<double>({400, 3}), mixing) + 5.;
+        for (auto method : {linalg::whitening::zca, linalg::whitening::cholesky})
+        {
+            auto res = linalg::whiten(X, 0., method);
+            const auto& Z = std::get<0>(res);
+            const auto& W = std::get<1>(res);
+            const auto& mean = std::get<2>(res);
+            EXPECT_TRUE(allclose(mean, xt::mean(X, {0})));
+            EXPECT_TRUE(allclose(linalg::dot(xt::transpose(Z), Z) / 399., xt::eye<double>(3), 1e-8, 1e-8));
+            EXPECT_TRUE(allclose(Z, linalg::dot(X - mean, W), 1e-8, 1e-8));
+            if (method == linalg::whitening::cholesky)
+            {
+                EXPECT_EQ(W(2, 0), 0.);
+            }
+            else
+            {
+                EXPECT_TRUE(allclose(W, xt::transpose(W)));
+            }
+        }
+
+        // a constant column has no variance
+        xarray<double> constant = xt::ones<double>({10, 2});
+        xt::view(constant, xt::all(), 1) = xt::arange<double>(10.);
+        EXPECT_THROW(linalg::whiten(constant, 0., linalg::whitening::cholesky), std::runtime_error);
+        EXPECT_NO_THROW(linalg::whiten(constant, 1e-3, linalg::whitening::cholesky));
+    }
+
+    TEST(xlinalg, polar_procrustes)
+    {
+        xt::random::seed(0);
+        // 3 x 3 (closed form), square with det < 0, tall, wide and complex
+        for (auto shape : {std::vector<std::size_t>{3, 3}, {40, 40}, {60, 25}, {4, 9}})
+        {
+            xarray<double> a = xt::random::randn<double>(shape);
+            auto p = linalg::polar(a);
+            const auto& u = std::get<0>(p);
+            const auto& h = std::get<1>(p);
+            std::size_t k = std::min(shape[0], shape[1]);
+            EXPECT_TRUE(allclose(linalg::dot(u, h), a));
+            EXPECT_TRUE(allclose(h, xt::transpose(h)));
+            EXPECT_GE(xt::amin(linalg::eigvalsh(h))(), -1e-10);
+            auto gram = shape[0] >= shape[1] ? linalg::dot(xt::transpose(u), u) : linalg::dot(u, xt::transpose(u));
+            EXPECT_TRUE(allclose(gram, xt::eye<double>(k)));
+        }
+        xarray<double> reflection = {{1., 0.2, 0.}, {0., -2., 0.1}, {0.3, 0., 0.5}};
+        auto pr = linalg::polar(reflection);
+        EXPECT_NEAR(linalg::det(std::get<0>(pr)), -1., 1e-12);
+        EXPECT_TRUE(allclose(linalg::dot(std::get<0>(pr), std::get<1>(pr)), reflection));
+
+        // ill-conditioned
+        xarray<double> ill = linalg::dot(xt::random::randn<double>({30, 30}), xt::diag(xt::logspace<double>(0., -12., 30)));
+        auto pi = linalg::polar(ill);
+        EXPECT_TRUE(allclose(linalg::dot(xt::transpose(std::get<0>(pi)), std::get<0>(pi)), xt::eye<double>(30)));
+        EXPECT_TRUE(allclose(linalg::dot(std::get<0>(pi), std::get<1>(pi)), ill, 1e-8, 1e-12));
+
+        xarray<std::complex<double>> c = xt::random::randn<double>({12, 8}) + 1i * xt::random::randn<double>({12, 8});
+        auto pc = linalg::polar(c);
+        auto uc = std::get<0>(pc);
+        auto ucu = linalg::dot(xt::conj(xt::transpose(uc)), uc);
+        EXPECT_TRUE(allclose(xt::real(ucu), xt::eye<double>(8)));
+        EXPECT_TRUE(allclose(xt::imag(ucu), xt::zeros<double>({8, 8}), 1e-5, 1e-10));
+        auto uh = linalg::dot(uc, std::get<1>(pc));
+        EXPECT_TRUE(allclose(xt::real(uh), xt::real(c)));
+        EXPECT_TRUE(allclose(xt::imag(uh), xt::imag(c)));
+
+        // point sets related by a rotation, with and without reflection
+        xarray<double> points = xt::random::randn<double>({50, 3});
+        xarray<double> q = std::get<0>(linalg::polar(xt::random::randn<double>({3, 3})));
+        if (linalg::det(q) < 0)
+        {
+            xt::view(q, xt::all(), 0) *= -1.;
+        }
+        xarray<double> moved = linalg::dot(points, q);
+        auto rs = linalg::procrustes(points, moved, true);
+        EXPECT_TRUE(allclose(std::get<0>(rs), q));
+        EXPECT_NEAR(std::get<1>(rs), linalg::norm(moved, linalg::normorder::frob) * linalg::norm(moved, linalg::normorder::frob), 1e-8);
+
+        xarray<double> mirrored = moved;
+        xt::view(mirrored, xt::all(), 2) *= -1.;
+        auto orthogonal = linalg::procrustes(points, mirrored);
+        EXPECT_NEAR(linalg::det(std::get<0>(orthogonal)), -1., 1e-12);
+        EXPECT_TRUE(allclose(linalg::dot(points, std::get<0>(orthogonal)), mirrored));
+        auto rotation = linalg::procrustes(points, mirrored, true);
+        EXPECT_NEAR(linalg::det(std::get<0>(rotation)), 1., 1e-12);
+        EXPECT_LT(std::get<1>(rotation), std::get<1>(orthogonal));
+
+        // the proper general path agrees with the closed form
+        xarray<double> a5 = xt::random::randn<double>({20, 5});
+        xarray<double> b5 = xt::random::randn<double>({20, 5});
+        auto r5 = std::get<0>(linalg::procrustes(a5, b5, true));
+        EXPECT_NEAR(linalg::det(r5), 1., 1e-10);
+        EXPECT_TRUE(allclose(linalg::dot(xt::transpose(r5), r5), xt::eye<double>(5)));
+        xarray<double> a3 = xt::view(a5, xt::all(), xt::range(0, 3));
+        xarray<double> b3 = xt::view(b5, xt::all(), xt::range(0, 3));
+        auto closed = linalg::procrustes(a3, b3, true);
+        xarray<double> m3 = linalg::dot(xt::transpose(a3), b3);
+        auto sigma = std::get<1>(linalg::svd(m3));
+        double expected_scale = xt::sum(sigma)() - (linalg::det(m3) >= 0 ? 0. : 2. * xt::amin(sigma)());
+        EXPECT_NEAR(std::get<1>(closed), expected_scale, 1e-10);
+        EXPECT_NEAR(linalg::det(std::get<0>(closed)), 1., 1e-12);
+
+        EXPECT_THROW(linalg::procrustes(a5, a3), std::runtime_error);
+        EXPECT_THROW(linalg::procrustes(c, c, true), std::runtime_error);
+    }
+
+    TEST(xlinalg, sylvester_lyapunov)
+    {
+        xarray<double> a = {{3., 1., 0.5}, {-1., 2., 0.2}, {0.4, 0., 4.}};
+        xarray<double> b = {{2., -1.}, {1., 1.5}};
+        xarray<double> c = {{1., 2.}, {0., -1.}, {3., 0.5}};
+        auto x = linalg::solve_sylvester(a, b, c);
+        EXPECT_TRUE(allclose(linalg::dot(a, x) + linalg::dot(x, b), c));
+
+        xarray<double> q = {{1., 0.5, 0.}, {0.5, 2., -1.}, {0., -1., 3.}};
+        auto y = linalg::solve_lyapunov(a, q);
+        EXPECT_TRUE(allclose(linalg::dot(a, y) + linalg::dot(y, xt::transpose(a)), q));
+
+        // one Schur decomposition of A for several right hand sides
+        auto fa = linalg::schur_factor(a);
+        xarray<double> q2 = {{0., 1., 0.}, {1., 0., 2.}, {0., 2., 1.}};
+        auto y2 = fa.solve_lyapunov(q2);
+        EXPECT_TRUE(allclose(linalg::dot(a, y2) + linalg::dot(y2, xt::transpose(a)), q2));
+
+        xarray<std::complex<double>> ca = {{2. + 1i, 1. - 0.5i}, {0.5i, 3. + 0i}};
+        xarray<std::complex<double>> cq = {{1. + 0i, 0.5 + 1i}, {-2. + 0i, 1. - 1i}};
+        auto cy = linalg::solve_lyapunov(ca, cq);
+        EXPECT_TRUE(allclose(linalg::dot(ca, cy) + linalg::dot(cy, xt::conj(xt::transpose(ca))), cq));
+
+        // A and -B share the eigenvalue 1
+        xarray<double> d = {{1., 0.}, {0., 2.}};
+        xarray<double> e = {{-1., 0.}, {0., 3.}};
+        xarray<double> f = {{1., 1.}, {1., 1.}};
+        EXPECT_THROW(linalg::solve_sylvester(d, e, f), std::runtime_error);
+    }
+
+    TEST(xlinalg, lazy_rhs)
+    {
+        // right-hand sides without a data interface, including ones of the
+        // static layout LAPACK uses, are evaluated into its buffer
+        xtensor<double, 2, layout_type::column_major> a = {{4., 1., 0.}, {1., 3., 1.}, {0., 1., 2.}};
+        xtensor<double, 2, layout_type::column_major> b = {{1., 0.}, {2., 1.}, {-1., 3.}};
+        xtensor<double, 2, layout_type::column_major> b2 = 2.0 * b;
+        xtensor<double, 2> b2r = b2;
+
+        EXPECT_TRUE(allclose(linalg::solve(a, 2.0 * b), linalg::solve(a, b2)));
+        EXPECT_TRUE(allclose(linalg::solve(a, b + b), linalg::solve(a, b2r)));
+
+        auto l = linalg::cholesky(a);
+        EXPECT_TRUE(allclose(linalg::solve_cholesky(l, 2.0 * b), linalg::solve_cholesky(l, b2)));
+        EXPECT_TRUE(allclose(linalg::solve_triangular(l, 2.0 * b), linalg::solve_triangular(l, b2)));
+
+        xtensor<double, 2, layout_type::column_major> t = {{1., 0.}, {1., 1.}, {1., 2.}, {1., 3.}};
+        xtensor<double, 1> y = {1., 2.9, 5.1, 7.};
+        auto expected = linalg::lstsq(t, xtensor<double, 1>(y - 1.0));
+        auto lazy = linalg::lstsq(t, y - 1.0);
+        EXPECT_TRUE(allclose(std::get<0>(lazy), std::get<0>(expected)));
+        EXPECT_TRUE(allclose(std::get<1>(lazy), std::get<1>(expected)));
+    }
+
+    TEST(xlinalg, shifted_solve)
+    {
+        xarray<double> a = {{4., 1., -2., 0.5}, {1., 3., 0., 1.}, {0.3, -1., 2., 0.2}, {2., 0., 1., 5.}};
+        xarray<double> b = {{1., 0.}, {2., 1.}, {-1., 3.}, {0.5, 0.}};
+        xarray<double> v = {1., 2., 3., 4.};
+
+        auto h = linalg::hessenberg(a);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(h.q(), h.h()), xt::transpose(h.q())), a));
+        EXPECT_EQ(h.h()(3, 0), 0.);
+        for (double s : {0.5, -1., 2.5})
+        {
+            xarray<double> as = a - s * xt::eye<double>(4);
+            EXPECT_TRUE(allclose(linalg::dot(as, h.solve_shifted(s, b)), b));
+            EXPECT_TRUE(allclose(linalg::dot(as, h.solve_shifted(s, v)), v));
+        }
+
+        xarray<double> sym = {{4., 1., -2., 0.5}, {1., 3., 0., 1.}, {-2., 0., 2., 0.2}, {0.5, 1., 0.2, 5.}};
+        auto t = linalg::tridiagonalize(sym, 'U');
+        EXPECT_EQ(t.diagonal().size(), 4u);
+        EXPECT_EQ(t.off_diagonal().size(), 3u);
+        for (double s : {0.5, -1.})
+        {
+            xarray<double> ss = sym - s * xt::eye<double>(4);
+            EXPECT_TRUE(allclose(linalg::dot(ss, t.solve_shifted(s, b)), b));
+        }
+
+        xarray<std::complex<double>> c = {{2. + 0i, 1. - 1i}, {1. + 1i, 3. + 0i}};
+        xarray<std::complex<double>> cb = {1. + 0i, 2.i};
+        std::complex<double> cs(0.5, 1.);
+        xarray<std::complex<double>> cc = c - cs * xt::eye<std::complex<double>>(2);
+        EXPECT_TRUE(allclose(linalg::dot(cc, linalg::hessenberg(c).solve_shifted(cs, cb)), cb));
+        EXPECT_TRUE(allclose(linalg::dot(cc, linalg::tridiagonalize(c).solve_shifted(cs, cb)), cb));
+
+        xarray<double> d = {{1., 0.}, {0., 2.}};
+        xarray<double> db = {1., 1.};
+        EXPECT_THROW(linalg::hessenberg(d).solve_shifted(2., db), std::runtime_error);
+        EXPECT_THROW(linalg::tridiagonalize(d).solve_shifted(1., db), std::runtime_error);
+    }
+
+    TEST(xlinalg, expm_multiply)
+    {
+        xarray<double> a = {{0.5, 2., -1.}, {1., -3., 0.25}, {4., 0.3, 1.}};
+        xarray<double> b = {{1., 0.}, {0., 2.}, {-1., 1.}};
+        xarray<double> v = {1., 2., 3.};
+
+        for (double t : {0.1, 1., 4.})
+        {
+            xarray<double> ta = t * a;
+            auto e = linalg::expm(ta);
+            EXPECT_TRUE(allclose(linalg::expm_multiply(a, b, t), linalg::dot(e, b)));
+            EXPECT_TRUE(allclose(linalg::expm_multiply(a, v, t), linalg::dot(e, v)));
+        }
+        xarray<double> zero = zeros<double>({3, 3});
+        EXPECT_TRUE(allclose(linalg::expm_multiply(zero, b), b));
+        EXPECT_THROW(linalg::expm_multiply(a, xarray<double>(zeros<double>({2}))), std::runtime_error);
+    }
+
     TEST(xlinalg, det)
     {
         xarray<double> a = {{1,2}, {3,4}};
@@ -134,6 +503,28 @@ namespace xt
         EXPECT_TRUE(allclose(std::get<2>(res), expected_2));
     }
 
+    TEST(xlinalg, svdvals)
+    {
+        xarray<double> arg_0 = {{0,1,2},
+                                {3,4,5},
+                                {6,7,8},
+                                {1,0,1}};
+        auto s = linalg::svdvals(arg_0);
+        EXPECT_EQ(s.size(), 3u);
+        EXPECT_TRUE(allclose(s, std::get<1>(linalg::svd(arg_0, false))));
+
+        xtensor<double, 2, layout_type::column_major> a = arg_0;
+        xtensor<double, 1> out = xt::zeros<double>({3});
+        linalg::svdvals_inplace(a, out);
+        EXPECT_TRUE(allclose(out, s));
+        xtensor<double, 1> wrong = xt::zeros<double>({4});
+        EXPECT_THROW(linalg::svdvals_inplace(a, wrong), std::runtime_error);
+
+        xarray<std::complex<double>> carg = {{1.+1.i, 2.+0.i}, {0.-1.i, 3.+0.i}, {1.+0.i, 1.i}};
+        EXPECT_TRUE(allclose(linalg::svdvals(carg), std::get<1>(linalg::svd(carg, false))));
+        EXPECT_EQ(linalg::svdvals(xt::xarray<double>::from_shape({0, 3})).size(), 0u);
+    }
+
     TEST(xlinalg, svd_horizontal_vertical)
     {
         xarray<double> a = xt::ones<double>({3, 1});
@@ -147,6 +538,163 @@ namespace xt
         EXPECT_TRUE(allclose(b, xt::linalg::dot(u * s, vt)));
     }
 
+    TEST(xlinalg, matrix_rank_qr)
+    {
+        xarray<double> eall = eye<double>(4);
+        EXPECT_EQ(4, linalg::matrix_rank_qr(eall));
+        xarray<double> ones_arr = ones<double>({4, 3});
+        EXPECT_EQ(1, linalg::matrix_rank_qr(ones_arr));
+        xarray<double> zarr = zeros<double>({3, 4});
+        EXPECT_EQ(0, linalg::matrix_rank_qr(zarr));
+
+        xarray<double> a = {{1., 2., 3.},
+                            {2., 4., 6.},
+                            {1., 0., 1.},
+                            {0., 1., 1.}};
+        EXPECT_EQ(2, linalg::matrix_rank_qr(a));
+        EXPECT_EQ(2, linalg::matrix_rank(a));
+
+        xarray<std::complex<double>> c = {{1. + 1.i, 2. + 2.i},
+                                          {1. - 1.i, 2. - 2.i}};
+        EXPECT_EQ(1, linalg::matrix_rank(c));
+        EXPECT_EQ(1, linalg::matrix_rank_qr(c));
+
+        xarray<double> p = linalg::pinv(a);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(a, p), a), a));
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(p, a), p), p));
+        EXPECT_TRUE(allclose(linalg::pinv(zarr), zeros<double>({4, 3})));
+    }
+
+    TEST(xlinalg, svd_drivers)
+    {
+        xarray<double> a = {{ 3., 1., 1.},
+                            {-1., 3., 1.},
+                            { 2., 0., 4.},
+                            { 1., 1., 0.}};
+        auto s_ref = std::get<1>(linalg::svd(a, false, false));
+        xarray<double> u, s, vt;
+
+        for (auto driver : {linalg::svd_driver::gesvd, linalg::svd_driver::gesvj, linalg::svd_driver::gejsv})
+        {
+            for (auto&& m : {a, xarray<double>(xt::transpose(a))})
+            {
+                std::tie(u, s, vt) = linalg::svd(m, false, true, driver);
+                EXPECT_TRUE(allclose(s, s_ref));
+                EXPECT_TRUE(allclose(m, linalg::dot(u * s, vt)));
+
+                std::tie(u, s, vt) = linalg::svd(m, true, true, driver);
+                EXPECT_EQ(u.shape()[0], u.shape()[1]);
+                EXPECT_EQ(vt.shape()[0], vt.shape()[1]);
+                EXPECT_TRUE(allclose(linalg::dot(xt::transpose(u), u), xt::eye<double>(u.shape()[0])));
+                EXPECT_TRUE(allclose(s, s_ref));
+            }
+            EXPECT_TRUE(allclose(linalg::pinv(a, 1e-15, driver), linalg::pinv(a)));
+        }
+
+        xarray<std::complex<double>> c = {{1. + 1.i, 2. + 0.i},
+                                          {0. - 1.i, 1. + 0.i}};
+        xarray<std::complex<double>> cu, cvt;
+        xarray<double> cs;
+        std::tie(cu, cs, cvt) = linalg::svd(c, false, true, linalg::svd_driver::gesvd);
+        EXPECT_TRUE(allclose(c, linalg::dot(cu * cs, cvt)));
+        EXPECT_THROW(linalg::svd(c, false, true, linalg::svd_driver::gesvj), std::runtime_error);
+    }
+
+    TEST(xlinalg, svd_truncated)
+    {
+        xt::random::seed(0);
+        xarray<double> x = xt::random::rand<double>({40, 4});
+        xarray<double> y = xt::random::rand<double>({4, 25});
+        xarray<double> a = linalg::dot(x, y);
+        auto s_full = std::get<1>(linalg::svd(a, false));
+        auto s_ref = xt::eval(xt::view(s_full, xt::range(0, 4)));
+
+        xarray<double> u, s, vt;
+        for (auto&& m : {a, xarray<double>(xt::transpose(a))})
+        {
+            std::tie(u, s, vt) = linalg::svd_truncated(m, 4);
+            EXPECT_EQ(u.shape()[1], 4u);
+            EXPECT_EQ(vt.shape()[0], 4u);
+            EXPECT_TRUE(allclose(s, s_ref));
+            EXPECT_TRUE(allclose(m, linalg::dot(u * s, vt)));
+
+            std::tie(u, s, vt) = linalg::randomized_svd(m, 4, 5, 2, 7);
+            EXPECT_TRUE(allclose(s, s_ref));
+            EXPECT_TRUE(allclose(m, linalg::dot(u * s, vt)));
+        }
+
+        auto r1 = linalg::randomized_svd(a, 2, 3, 1, 42);
+        auto r2 = linalg::randomized_svd(a, 2, 3, 1, 42);
+        EXPECT_EQ(std::get<0>(r1), std::get<0>(r2));
+
+        xarray<std::complex<double>> c = {{1. + 1.i, 2. + 0.i, 0. - 1.i},
+                                          {0. + 2.i, 1. - 1.i, 3. + 0.i}};
+        xarray<std::complex<double>> cu, cvt;
+        xarray<double> cs;
+        std::tie(cu, cs, cvt) = linalg::svd_truncated(c, 2);
+        EXPECT_TRUE(allclose(cs, std::get<1>(linalg::svd(c, false))));
+        EXPECT_TRUE(allclose(c, linalg::dot(cu * cs, cvt)));
+
+        EXPECT_THROW(linalg::svd_truncated(a, 26), std::runtime_error);
+        EXPECT_THROW(linalg::randomized_svd(a, 0), std::runtime_error);
+    }
+
+    TEST(xlinalg, nystrom)
+    {
+        // Gaussian kernel on points along a line: fast spectral decay
+        std::size_t n = 400;
+        xtensor<double, 1> t = xt::linspace<double>(0., 4., n);
+        auto kernel = [&t](std::size_t i, std::size_t j)
+        {
+            double d = t(i) - t(j);
+            return std::exp(-0.5 * d * d);
+        };
+        xtensor<double, 2> K = xtensor<double, 2>::from_shape({n, n});
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                K(i, j) = kernel(i, j);
+            }
+        }
+
+        auto approx = linalg::nystrom(n, kernel, 40);
+        EXPECT_EQ(approx.size(), n);
+        EXPECT_LE(approx.rank(), 40u);
+        EXPECT_EQ(approx.indices().size(), 40u);
+        xtensor<double, 2> F = approx.factor();
+        xtensor<double, 2> low_rank = linalg::dot(F, xt::transpose(F));
+        EXPECT_LT(xt::amax(xt::abs(low_rank - K))(), 1e-6);
+
+        // sampling from the matrix gives the same columns and factor
+        auto from_matrix = linalg::nystrom(K, 40);
+        EXPECT_EQ(approx.indices(), from_matrix.indices());
+        EXPECT_TRUE(allclose(from_matrix.factor(), approx.factor()));
+
+        // shifted solves and log-determinants against the dense ones
+        double noise = 0.1;
+        xtensor<double, 2> shifted = K + noise * xt::eye<double>(n);
+        xtensor<double, 1> b = xt::sin(3. * t);
+        xtensor<double, 1> x = approx.solve(b, noise);
+        EXPECT_TRUE(allclose(linalg::dot(shifted, x), b, 1e-5, 1e-5));
+        xtensor<double, 2> B = xt::stack(xt::xtuple(b, xt::cos(t)), 1);
+        xtensor<double, 2> X = approx.solve(B, noise);
+        EXPECT_TRUE(allclose(xt::view(X, all(), 0), x));
+        double logdet = std::get<1>(linalg::slogdet(shifted));
+        EXPECT_NEAR(approx.logdet(noise), logdet, 1e-4 * std::abs(logdet));
+        EXPECT_TRUE(allclose(approx.dot(b), linalg::dot(low_rank, b)));
+
+        linalg::nystrom_options options;
+        options.sampling = linalg::nystrom_sampling::leverage;
+        options.seed = 3;
+        auto leverage = linalg::nystrom(n, kernel, 40, options);
+        xtensor<double, 2> G = leverage.factor();
+        EXPECT_LT(xt::amax(xt::abs(linalg::dot(G, xt::transpose(G)) - K))(), 1e-6);
+
+        EXPECT_THROW(linalg::nystrom(K, 0), std::runtime_error);
+        EXPECT_THROW(approx.solve(b, 0.), std::runtime_error);
+    }
+
     TEST(xlinalg, matrix_rank)
     {
         xarray<double> eall = eye<double>(4);
@@ -165,6 +713,71 @@ namespace xt
         EXPECT_EQ(0, rz);
     }
 
+    TEST(xlinalg, orth_null_space)
+    {
+        xt::random::seed(0);
+        // rank 3 matrices, tall and wide
+        for (auto shape : {std::vector<std::size_t>{9, 5}, {4, 7}})
+        {
+            xarray<double> a = linalg::dot(xt::random::randn<double>({shape[0], 3}),
+                                           xt::random::randn<double>({3, shape[1]}));
+            auto q = linalg::orth(a);
+            auto z = linalg::null_space(a);
+            EXPECT_EQ(q.shape()[1], 3u);
+            EXPECT_EQ(z.shape()[0], shape[1]);
+            EXPECT_EQ(z.shape()[1], shape[1] - 3);
+            EXPECT_TRUE(allclose(linalg::dot(xt::transpose(q), q), xt::eye<double>(3)));
+            EXPECT_TRUE(allclose(linalg::dot(xt::transpose(z), z), xt::eye<double>(shape[1] - 3)));
+            // q spans the columns of a, z is annihilated by it
+            EXPECT_TRUE(allclose(linalg::dot(q, linalg::dot(xt::transpose(q), a)), a));
+            EXPECT_TRUE(allclose(linalg::dot(a, z), xt::zeros<double>({shape[0], shape[1] - 3}), 1e-5, 1e-10));
+        }
+
+        xarray<std::complex<double>> c = {{1. + 1i, 2. + 0i, 0i}, {2. + 0i, 2. - 2i, 0i}};
+        auto zc = linalg::null_space(c);
+        EXPECT_EQ(zc.shape()[1], 2u);
+        auto cz = linalg::dot(c, zc);
+        EXPECT_LT(xt::amax(xt::abs(cz))(), 1e-12);
+        EXPECT_EQ(linalg::orth(c).shape()[1], 1u);
+
+        EXPECT_EQ(linalg::null_space(xt::eye<double>(4)).shape()[1], 0u);
+        EXPECT_TRUE(allclose(linalg::null_space(xt::zeros<double>({0, 3})), xt::eye<double>(3)));
+    }
+
+    TEST(xlinalg, cholqr)
+    {
+        xt::random::seed(0);
+        xarray<double> a = xt::random::randn<double>({200, 12});
+        auto qr = linalg::cholqr(a);
+        const auto& q = std::get<0>(qr);
+        const auto& r = std::get<1>(qr);
+        EXPECT_TRUE(allclose(linalg::dot(q, r), a));
+        EXPECT_TRUE(allclose(linalg::dot(xt::transpose(q), q), xt::eye<double>(12)));
+        EXPECT_TRUE(allclose(r, xt::triu(r)));
+
+        // condition number ~1e12, beyond plain CholQR2: shifted CholQR3
+        xarray<double> ill = linalg::dot(a, xt::diag(xt::logspace<double>(0., -12., 12)));
+        auto qri = linalg::cholqr(ill);
+        EXPECT_TRUE(allclose(linalg::dot(xt::transpose(std::get<0>(qri)), std::get<0>(qri)), xt::eye<double>(12)));
+        EXPECT_TRUE(allclose(linalg::dot(std::get<0>(qri), std::get<1>(qri)), ill, 1e-6, 1e-14));
+
+        // block Gram-Schmidt of a second block against the first
+        xarray<std::complex<double>> x = xt::random::randn<double>({200, 4}) + 1i * xt::random::randn<double>({200, 4});
+        xarray<std::complex<double>> v = linalg::dot(q, xt::random::randn<double>({12, 4})) + 1e-3 * x;
+        auto gs = linalg::block_gram_schmidt(q, v);
+        const auto& w = std::get<0>(gs);
+        auto cross = linalg::dot(xt::transpose(q), w);
+        EXPECT_LT(xt::amax(xt::abs(cross))(), 1e-12);
+        auto ww = linalg::dot(xt::conj(xt::transpose(w)), w);
+        EXPECT_TRUE(allclose(xt::real(ww), xt::eye<double>(4)));
+        auto back = linalg::dot(q, std::get<1>(gs)) + linalg::dot(w, std::get<2>(gs));
+        EXPECT_TRUE(allclose(xt::real(back), xt::real(v)));
+        EXPECT_TRUE(allclose(xt::imag(back), xt::imag(v)));
+
+        EXPECT_THROW(linalg::cholqr(xt::transpose(a)), std::runtime_error);
+        EXPECT_THROW(linalg::block_gram_schmidt(q, xt::ones<double>({10, 2})), std::runtime_error);
+    }
+
     TEST(xlinalg, eigh)
     {
         xarray<double> arg_0 = {{ -761. , -208. , -582. },
@@ -200,6 +813,132 @@ namespace xt
         EXPECT_TRUE(allclose(complexpected_0, cmvals2));
     }
 
+    TEST(xlinalg, eigh_subset)
+    {
+        xarray<double> arg_0 = {{ -761. , -208. , -582. },
+                                { -208. , -623. ,-1605.5},
+                                { -582. ,-1605.5, -476. }};
+        xarray<double> expected_0 = {-2351.3290686 , -609.79206435, 1101.12113295};
+
+        auto top = xt::linalg::eigh(arg_0, xt::linalg::select_index{1, 2});
+        auto& w = std::get<0>(top);
+        auto& v = std::get<1>(top);
+        EXPECT_EQ(v.shape()[0], 3u);
+        EXPECT_EQ(v.shape()[1], 2u);
+        EXPECT_TRUE(allclose(w, xt::view(expected_0, xt::range(1, 3))));
+        EXPECT_TRUE(allclose(linalg::dot(arg_0, v), v * xt::view(w, xt::newaxis(), xt::all())));
+
+        auto in_range = xt::linalg::eigh(arg_0, xt::linalg::select_range{-3000., 0.}, 'U');
+        EXPECT_TRUE(allclose(std::get<0>(in_range), xt::view(expected_0, xt::range(0, 2))));
+        EXPECT_EQ(std::get<1>(in_range).shape()[1], 2u);
+
+        EXPECT_TRUE(allclose(xt::linalg::eigvalsh(arg_0, xt::linalg::select_index{0, 0}), xt::view(expected_0, xt::range(0, 1))));
+        EXPECT_EQ(xt::linalg::eigvalsh(arg_0, xt::linalg::select_range{2000., 3000.}).size(), 0u);
+        EXPECT_THROW(xt::linalg::eigh(arg_0, xt::linalg::select_index{2, 3}), std::runtime_error);
+
+        xarray<std::complex<double>> complarg_0 = {{ 1.+0.i,-0.-2.i},
+                                                   { 0.+2.i, 5.+0.i}};
+        auto complres = xt::linalg::eigh(complarg_0, xt::linalg::select_index{1, 1});
+        auto& cw = std::get<0>(complres);
+        auto& cv = std::get<1>(complres);
+        EXPECT_NEAR(cw(0), 5.82842712, 1e-7);
+        EXPECT_TRUE(allclose(linalg::dot(complarg_0, cv), 5.82842712 * cv));
+        EXPECT_TRUE(allclose(xt::linalg::eigvalsh(complarg_0, xt::linalg::select_range{0., 1.}), xarray<double>{0.17157288}));
+    }
+
+    TEST(xlinalg, eigh_tridiagonal)
+    {
+        // the second difference matrix, eigenvalues 2 - 2 cos(k pi / 7)
+        xarray<double> d = {2., 2., 2., 2., 2., 2.};
+        xarray<double> e = {-1., -1., -1., -1., -1.};
+        xarray<double> t = diag(d) + diag(e, 1) + diag(e, -1);
+        xarray<double> expected = 2. - 2. * cos(arange(1., 7.) * numeric_constants<double>::PI / 7.);
+
+        auto res = linalg::eigh_tridiagonal(d, e);
+        auto& w = std::get<0>(res);
+        auto& v = std::get<1>(res);
+        EXPECT_TRUE(allclose(w, expected));
+        EXPECT_TRUE(allclose(linalg::dot(t, v), v * xt::view(w, xt::newaxis(), xt::all())));
+        EXPECT_TRUE(allclose(linalg::eigvalsh_tridiagonal(d, e), linalg::eigvalsh(t)));
+
+        auto top = linalg::eigh_tridiagonal(d, e, linalg::select_index{4, 5});
+        EXPECT_EQ(std::get<1>(top).shape()[1], 2u);
+        EXPECT_TRUE(allclose(std::get<0>(top), xt::view(expected, xt::range(4, 6))));
+        EXPECT_TRUE(allclose(linalg::dot(t, std::get<1>(top)), std::get<1>(top) * xt::view(std::get<0>(top), xt::newaxis(), xt::all())));
+        auto low = linalg::eigh_tridiagonal(d, e, linalg::select_range{0., 1.});
+        EXPECT_TRUE(allclose(std::get<0>(low), xt::view(expected, xt::range(0, 2))));
+        EXPECT_TRUE(allclose(linalg::eigvalsh_tridiagonal(d, e, linalg::select_index{0, 0}), xt::view(expected, xt::range(0, 1))));
+        EXPECT_EQ(linalg::eigvalsh_tridiagonal(d, e, linalg::select_range{5., 6.}).size(), 0u);
+        EXPECT_THROW(linalg::eigh_tridiagonal(d, d), std::runtime_error);
+        EXPECT_THROW(linalg::eigh_tridiagonal(d, e, linalg::select_index{5, 6}), std::runtime_error);
+
+        xarray<double> bd = {1., 2., 3.};
+        xarray<double> be = {4., 5.};
+        xarray<double> b = diag(bd) + diag(be, 1);
+        auto usv = linalg::svd_bidiagonal(bd, be);
+        auto& s = std::get<1>(usv);
+        EXPECT_TRUE(allclose(s, std::get<1>(linalg::svd(b))));
+        EXPECT_TRUE(allclose(linalg::dot(std::get<0>(usv) * xt::view(s, xt::newaxis(), xt::all()), std::get<2>(usv)), b));
+        auto lower = linalg::svd_bidiagonal(bd, be, true, 'L');
+        xarray<double> bl = transpose(b);
+        EXPECT_TRUE(allclose(linalg::dot(std::get<0>(lower) * xt::view(std::get<1>(lower), xt::newaxis(), xt::all()), std::get<2>(lower)), bl));
+        auto values = linalg::svd_bidiagonal(bd, be, false);
+        EXPECT_TRUE(allclose(std::get<1>(values), s));
+        EXPECT_EQ(std::get<0>(values).size(), 0u);
+    }
+
+    TEST(xlinalg, schur)
+    {
+        xarray<double> arg_0 = {{ 1., -1.,  2.},
+                                { 1.,  1.,  1.},
+                                { 0.,  0., -3.}};
+
+        auto split = xt::linalg::eigvals_split(arg_0);
+        auto full = xt::linalg::eigvals(arg_0);
+        EXPECT_TRUE(allclose(std::get<0>(split), xt::real(full)));
+        EXPECT_TRUE(allclose(std::get<1>(split), xt::imag(full)));
+
+        auto res = xt::linalg::schur(arg_0, xt::linalg::schur_sort::left_half_plane);
+        auto& T = std::get<0>(res);
+        auto& Z = std::get<1>(res);
+        EXPECT_EQ(std::get<2>(res), 1u);
+        EXPECT_NEAR(T(0, 0), -3., 1e-12);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(Z, T), xt::transpose(Z)), arg_0));
+        EXPECT_TRUE(allclose(linalg::dot(xt::transpose(Z), Z), xt::eye<double>(3)));
+
+        xarray<std::complex<double>> complarg_0 = {{ 1.+1.i, 2.+0.i},
+                                                   { 0.-1.i, 0.5+0.i}};
+        auto complres = xt::linalg::schur(complarg_0);
+        auto& cT = std::get<0>(complres);
+        auto& cZ = std::get<1>(complres);
+        EXPECT_EQ(std::get<2>(complres), 0u);
+        EXPECT_NEAR(std::abs(cT(1, 0)), 0., 1e-12);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(cZ, cT), xt::conj(xt::transpose(cZ))), complarg_0));
+
+        auto plain = xt::linalg::schur(arg_0);
+        auto& pT = std::get<0>(plain);
+        xtensor<bool, 1> select = {pT(0, 0) < -2., pT(1, 1) < -2., pT(2, 2) < -2.};
+        auto ord = xt::linalg::ordschur(pT, std::get<1>(plain), select);
+        auto& oT = std::get<0>(ord);
+        auto& oZ = std::get<1>(ord);
+        EXPECT_EQ(std::get<2>(ord), 1u);
+        EXPECT_NEAR(oT(0, 0), -3., 1e-12);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(oZ, oT), xt::transpose(oZ)), arg_0));
+
+        auto novec = xt::linalg::schur(arg_0, xt::linalg::schur_sort::none, false);
+        EXPECT_EQ(std::get<1>(novec).size(), 0u);
+        EXPECT_TRUE(allclose(std::get<0>(novec), pT));
+        auto ordnovec = xt::linalg::ordschur(std::get<0>(novec), std::get<1>(novec), select);
+        EXPECT_EQ(std::get<1>(ordnovec).size(), 0u);
+        EXPECT_TRUE(allclose(std::get<0>(ordnovec), oT));
+
+        xtensor<int, 1> cselect = {0, 1};
+        auto cord = xt::linalg::ordschur(cT, cZ, cselect);
+        EXPECT_NEAR(std::abs(std::get<0>(cord)(0, 0) - cT(1, 1)), 0., 1e-12);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::dot(std::get<1>(cord), std::get<0>(cord)),
+                                         xt::conj(xt::transpose(std::get<1>(cord)))), complarg_0));
+    }
+
     TEST(xlinalg, pinv)
     {
         xarray<double> arg_0 = {{ 1.47351391, 0.94686323, 0.92236842,-1.44141916,-1.53123963,-0.36949144},
@@ -325,6 +1064,85 @@ namespace xt
         EXPECT_NEAR(0.785489192861, xt::linalg::norm(arg_1, linalg::normorder::neg_inf), 1e-06);
     }
 
+    TEST(xlinalg, norm_layouts)
+    {
+        xtensor<double, 2> a = {{1., -2., 3.}, {4., 5., -6.}};
+        xtensor<double, 2, layout_type::column_major> ac = a;
+        auto at = transpose(a);
+
+        EXPECT_DOUBLE_EQ(9., linalg::norm(a, 1));
+        EXPECT_DOUBLE_EQ(9., linalg::norm(ac, 1));
+        EXPECT_DOUBLE_EQ(15., linalg::norm(at, 1));
+        EXPECT_DOUBLE_EQ(5., linalg::norm(a, -1));
+        EXPECT_DOUBLE_EQ(15., linalg::norm(a, linalg::normorder::inf));
+        EXPECT_DOUBLE_EQ(15., linalg::norm(ac, linalg::normorder::inf));
+        EXPECT_DOUBLE_EQ(9., linalg::norm(at, linalg::normorder::inf));
+        EXPECT_DOUBLE_EQ(6., linalg::norm(a, linalg::normorder::neg_inf));
+        EXPECT_NEAR(std::sqrt(91.), linalg::norm(a, linalg::normorder::frob), 1e-13);
+        EXPECT_NEAR(std::sqrt(91.), linalg::norm(at, linalg::normorder::frob), 1e-13);
+
+        // the sum of squares would overflow
+        xtensor<double, 2> big = {{1e200, -1e200}, {1e200, 1e200}};
+        EXPECT_NEAR(1., linalg::norm(big, linalg::normorder::frob) / 2e200, 1e-14);
+
+        xtensor<double, 2> d = {{3., 0.}, {0., -2.}};
+        EXPECT_NEAR(3., linalg::norm(d, 2), 1e-14);
+        EXPECT_NEAR(2., linalg::norm(d, -2), 1e-14);
+        EXPECT_NEAR(5., linalg::norm(d, linalg::normorder::nuc), 1e-14);
+
+        xtensor<double, 1> v = {1., -7., 3.};
+        EXPECT_DOUBLE_EQ(7., linalg::norm(v, linalg::normorder::inf));
+        EXPECT_DOUBLE_EQ(16., linalg::norm(view(a, 1, all()) - 2. * view(a, 0, all()) + 7., linalg::normorder::inf));
+
+        // iamax would pick 3 + 3i by |re| + |im|
+        xtensor<std::complex<double>, 1> c = {4.5 + 0.i, 3. + 3.i};
+        EXPECT_DOUBLE_EQ(4.5, linalg::norm(c, linalg::normorder::inf));
+    }
+
+    TEST(xlinalg, norm_axis)
+    {
+        xtensor<double, 2> a = {{1., -2., 3.}, {4., 5., -6.}};
+        xtensor<double, 2, layout_type::column_major> ac = a;
+        auto at = transpose(a);
+
+        xtensor<double, 1> rows2 = {std::sqrt(14.), std::sqrt(77.)};
+        xtensor<double, 1> cols1 = {5., 7., 9.};
+        EXPECT_TRUE(allclose(linalg::norm(a, 2, 1), rows2));
+        EXPECT_TRUE(allclose(linalg::norm(ac, 2, 1), rows2));
+        EXPECT_TRUE(allclose(linalg::norm(at, 2, 0), rows2));
+        EXPECT_TRUE(allclose(linalg::norm(a, 1, 0), cols1));
+        EXPECT_TRUE(allclose(linalg::norm(ac, 1, 0), cols1));
+        EXPECT_TRUE(allclose(linalg::norm(view(a, all(), range(0, 3, 2)), 1, 1), xtensor<double, 1>{4., 10.}));
+        EXPECT_TRUE(allclose(linalg::norm(a, 3, 1), xtensor<double, 1>{std::cbrt(36.), std::cbrt(405.)}));
+        EXPECT_TRUE(allclose(linalg::norm(a, linalg::normorder::inf, 1), xtensor<double, 1>{3., 6.}));
+        EXPECT_TRUE(allclose(linalg::norm(ac, linalg::normorder::neg_inf, 0), xtensor<double, 1>{1., 2., 3.}));
+
+        xtensor<double, 2> z = {{0., 1.}, {0., 0.}};
+        EXPECT_TRUE(allclose(linalg::norm(z, 0, 1), xtensor<double, 1>{1., 0.}));
+
+        // the sums of squares would overflow and underflow
+        xtensor<double, 2> scaled = {{1e200, -1e200}, {3e-200, 4e-200}};
+        auto s = linalg::norm(scaled, 2, 1);
+        EXPECT_NEAR(1., s(0) / (std::sqrt(2.) * 1e200), 1e-14);
+        EXPECT_NEAR(1., s(1) / 5e-200, 1e-14);
+
+        xtensor<std::complex<double>, 2> c = {{3. + 4.i, 0. + 1.i}};
+        EXPECT_TRUE(allclose(linalg::norm(c, 2, 1), xtensor<double, 1>{std::sqrt(26.)}));
+
+        xtensor<double, 2> b = {{2., 1., 0.5}, {-1., 0., 1.}};
+        xtensor<double, 2, layout_type::column_major> bc = b;
+        xtensor<double, 1> row_dots = {1.5, -10.};
+        EXPECT_TRUE(allclose(linalg::dot_along(a, b, 1), row_dots));
+        EXPECT_TRUE(allclose(linalg::dot_along(ac, b, 1), row_dots));
+        EXPECT_TRUE(allclose(linalg::dot_along(ac, bc, 1), row_dots));
+        EXPECT_TRUE(allclose(linalg::dot_along(a, bc, 0), xtensor<double, 1>{-2., -2., -4.5}));
+
+        EXPECT_THROW(linalg::norm(a, 2, 2), std::runtime_error);
+        EXPECT_THROW(linalg::norm(a, -1, 1), std::runtime_error);
+        EXPECT_THROW(linalg::norm(a, linalg::normorder::frob, 1), std::runtime_error);
+        EXPECT_THROW(linalg::dot_along(a, at, 1), std::runtime_error);
+    }
+
     TEST(xlinalg, vdot)
     {
         xarray<double> arg_0 = { 0.23451288, 0.98799529, 0.76599595, 0.77700444, 0.02798196};
@@ -342,6 +1160,73 @@ namespace xt
         EXPECT_NEAR(0.8075433553117102, std::imag(res_c), 1e-06);
     }
 
+    TEST(xlinalg, vdot_nd)
+    {
+        xt::random::seed(5);
+        xarray<double> a = xt::random::rand<double>({3, 4, 2});
+        xarray<double> b = xt::random::rand<double>({3, 4, 2});
+        double expected = xt::sum(a * b)();
+        EXPECT_NEAR(linalg::vdot(a, b), expected, 1e-12);
+
+        // column major operands of the same shape pair up as in row major order
+        xarray<double, layout_type::column_major> ac = a;
+        xarray<double, layout_type::column_major> bc = b;
+        EXPECT_NEAR(linalg::vdot(ac, bc), expected, 1e-12);
+        EXPECT_NEAR(linalg::vdot(ac, b), expected, 1e-12);
+
+        // different shapes of the same size are flattened in row major order
+        xarray<double> flat = xt::flatten(b);
+        xarray<double, layout_type::column_major> reshaped = xt::reshape_view(flat, {6, 4});
+        EXPECT_NEAR(linalg::vdot(a, reshaped), expected, 1e-12);
+        EXPECT_NEAR(linalg::vdot(xt::view(a, xt::all(), xt::range(0, 4, 2), xt::all()),
+                                 xt::view(b, xt::all(), xt::range(0, 4, 2), xt::all())),
+                    xt::sum(xt::view(a * b, xt::all(), xt::range(0, 4, 2), xt::all()))(), 1e-12);
+
+        xarray<std::complex<double>> z = a + std::complex<double>(0., 1.) * b;
+        std::complex<double> zz = linalg::vdot(z, z);
+        EXPECT_NEAR(std::real(zz), xt::sum(a * a + b * b)(), 1e-12);
+        EXPECT_NEAR(std::imag(zz), 0., 1e-12);
+
+        EXPECT_THROW(linalg::vdot(a, xt::view(b, 0)), std::runtime_error);
+    }
+
+    TEST(xlinalg, inner)
+    {
+        xt::random::seed(6);
+        xarray<double> a = xt::random::rand<double>({2, 3, 4});
+        xarray<double> b = xt::random::rand<double>({5, 4});
+        xarray<double> r = linalg::inner(a, b);
+        ASSERT_EQ(r.dimension(), 3u);
+        EXPECT_EQ(r.shape()[0], 2u);
+        EXPECT_EQ(r.shape()[1], 3u);
+        EXPECT_EQ(r.shape()[2], 5u);
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            xarray<double> ai = xt::view(a, i);
+            EXPECT_TRUE(allclose(xt::view(r, i), linalg::dot(ai, xt::transpose(b))));
+        }
+
+        // transposed operands are copied to row major order first
+        xarray<double> bt = xt::transpose(b);
+        EXPECT_TRUE(allclose(linalg::inner(a, xt::transpose(bt)), r));
+
+        xarray<double> v = xt::random::rand<double>({4});
+        xarray<double> w = xt::random::rand<double>({4});
+        xarray<double> vw = linalg::inner(v, w);
+        EXPECT_EQ(vw.dimension(), 0u);
+        EXPECT_NEAR(vw(), xt::sum(v * w)(), 1e-12);
+
+        xarray<std::complex<double>> z = xt::random::rand<double>({3, 4}) + std::complex<double>(0., 1.);
+        xarray<std::complex<double>> zv = linalg::inner(z, v);
+        xarray<std::complex<double>> zv_expected = linalg::dot(z, v);
+        EXPECT_TRUE(allclose(xt::real(zv), xt::real(zv_expected)));
+        EXPECT_TRUE(allclose(xt::imag(zv), xt::imag(zv_expected)));
+
+        xarray<double> scalar = 2.;
+        EXPECT_TRUE(allclose(linalg::inner(scalar, b), 2. * b));
+        EXPECT_THROW(linalg::inner(a, bt), std::runtime_error);
+    }
+
     TEST(xlinalg, kron)
     {
         xarray<int> arg_0 = {{2,1,8},
@@ -366,6 +1251,57 @@ namespace xt
         EXPECT_EQ(expected, res);
     }
 
+    TEST(xlinalg, kron_nd)
+    {
+        xarray<double> a = {{1., 2.}, {3., 4.}};
+        xarray<double> v = {1., -1., 2.};
+
+        // v is padded to shape (1, 3)
+        xarray<double> expected = {{1., -1., 2., 2., -2., 4.}, {3., -3., 6., 4., -4., 8.}};
+        EXPECT_EQ(expected, linalg::kron(a, v));
+
+        xtensor<double, 3> c = {{{1., 2.}}, {{3., 4.}}};
+        auto r = linalg::kron(c, a);
+        EXPECT_EQ(r.dimension(), 3u);
+        EXPECT_EQ(r.shape()[0], 2u);
+        EXPECT_EQ(r.shape()[1], 2u);
+        EXPECT_EQ(r.shape()[2], 4u);
+        EXPECT_EQ(r(1, 1, 2), c(1, 0, 1) * a(1, 0));
+        EXPECT_EQ(r(0, 0, 3), c(0, 0, 1) * a(0, 1));
+
+        xarray<double> s = {{{1., 2.}, {3., 4.}}, {{0., 1.}, {1., 0.}}};
+        xarray<double> t = {{{1., -1.}}, {{2., 3.}}};
+        xarray<double> batched = linalg::batch_kron(s, t);
+        EXPECT_EQ(batched.shape()[1], 2u);
+        EXPECT_EQ(batched.shape()[2], 4u);
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            xarray<double> si = view(s, i, all(), all());
+            xarray<double> ti = view(t, i, all(), all());
+            xarray<double> bi = view(batched, i, all(), all());
+            EXPECT_EQ(linalg::kron(si, ti), bi);
+        }
+        EXPECT_THROW(linalg::batch_kron(s, a), std::runtime_error);
+    }
+
+    TEST(xlinalg, lazy_kron)
+    {
+        xarray<double> a = {{1., 2., 0.}, {-1., 3., 1.}};
+        xarray<double> b = {{2., 1.}, {0., -1.}, {1., 4.}, {3., 1.}};
+        xarray<double> full = linalg::kron(a, b);
+        auto k = linalg::lazy_kron(a, b);
+        EXPECT_EQ(k.shape()[0], 8u);
+        EXPECT_EQ(k.shape()[1], 6u);
+        EXPECT_EQ(full, k.evaluate());
+
+        xarray<double> x = {1., -2., 0.5, 3., 1., -1.};
+        EXPECT_TRUE(allclose(linalg::dot(full, x), linalg::dot(k, x)));
+
+        xarray<double> X = {{1., 0.}, {-2., 1.}, {0.5, 2.}, {3., -1.}, {1., 1.}, {-1., 0.}};
+        EXPECT_TRUE(allclose(linalg::dot(full, X), linalg::dot(k, X)));
+        EXPECT_THROW(linalg::dot(k, xarray<double>{1., 2.}), std::runtime_error);
+    }
+
     TEST(xlinalg, cholesky)
     {
         xarray<double> arg_0 = {{  4, 12,-16},
@@ -378,6 +1314,13 @@ namespace xt
                                    {-8., 5., 3.}};
         EXPECT_EQ(expected, res);
 
+        // without zeroing, the strict upper triangle keeps the input
+        auto lower = xt::linalg::cholesky(arg_0, false);
+        EXPECT_EQ(xt::tril(lower), expected);
+        EXPECT_EQ(lower(0, 2), -16.);
+        EXPECT_TRUE(allclose(xt::linalg::solve_cholesky(lower, xarray<double>{1., 2., 3.}),
+                             xt::linalg::solve(arg_0, xarray<double>{1., 2., 3.})));
+
         xarray<std::complex<double>> cmplarg_0 = {{ 1.+0.i,-0.-2.i},
                                                   { 0.+2.i, 5.+0.i}};
         auto cmplres = xt::linalg::cholesky(cmplarg_0);
@@ -386,6 +1329,82 @@ namespace xt
         EXPECT_EQ(cmplexpected, cmplres);
     }
 
+    TEST(xlinalg, cholesky_update)
+    {
+        xarray<double> a = {{  4, 12,-16},
+                            { 12, 37,-43},
+                            {-16,-43, 98}};
+        xarray<double> x = {1., -2., 0.5};
+        xarray<double> updated = a + linalg::outer(x, x);
+
+        auto l = xt::linalg::cholesky(a);
+        linalg::cholesky_update(l, x);
+        EXPECT_TRUE(allclose(linalg::cholesky(updated), l));
+        linalg::cholesky_downdate(l, x);
+        EXPECT_TRUE(allclose(linalg::cholesky(a), l));
+
+        // rank-k update with the columns of a matrix
+        xarray<double> xk = {{1., 0.}, {-2., 3.}, {0.5, 1.}};
+        xarray<double> updated_k = a + linalg::dot(xk, transpose(xk));
+        linalg::cholesky_update(l, xk);
+        EXPECT_TRUE(allclose(linalg::cholesky(updated_k), l));
+        linalg::cholesky_downdate(l, xk);
+        EXPECT_TRUE(allclose(linalg::cholesky(a), l));
+
+        // a - y y^T is indefinite, l is left unchanged
+        xarray<double> y = {3., 0., 0.};
+        EXPECT_THROW(linalg::cholesky_downdate(l, y), std::runtime_error);
+        EXPECT_TRUE(allclose(linalg::cholesky(a), l));
+
+        xarray<std::complex<double>> ca = {{ 1.+0.i,-0.-2.i},
+                                           { 0.+2.i, 5.+0.i}};
+        xarray<std::complex<double>> cx = {0.5 + 1.i, -1.i};
+        xarray<std::complex<double>> cupdated = ca + linalg::outer(cx, conj(cx));
+        auto cl = xt::linalg::cholesky(ca);
+        linalg::cholesky_update(cl, cx);
+        auto cexpected = linalg::cholesky(cupdated);
+        EXPECT_TRUE(allclose(real(cexpected), real(cl)));
+        EXPECT_TRUE(allclose(imag(cexpected), imag(cl)));
+        linalg::cholesky_downdate(cl, cx);
+        EXPECT_TRUE(allclose(real(linalg::cholesky(ca)), real(cl)));
+        EXPECT_TRUE(allclose(imag(linalg::cholesky(ca)), imag(cl)));
+    }
+
+    TEST(xlinalg, cholesky_pivoted)
+    {
+        // rank 2 positive semidefinite matrix, on which cholesky fails
+        xarray<double> b = {{1., 0.}, {2., 1.}, {0., 3.}, {1., 1.}};
+        xarray<double> a = linalg::dot(b, transpose(b));
+        EXPECT_THROW(linalg::cholesky(a), std::runtime_error);
+
+        auto res = linalg::cholesky_pivoted(a);
+        auto& L = std::get<0>(res);
+        auto& P = std::get<1>(res);
+        EXPECT_EQ(L.shape()[1], 2u);
+        EXPECT_EQ(P(0), 2u);
+        EXPECT_TRUE(allclose(linalg::dot(L, transpose(L)), a));
+        EXPECT_NEAR(L(P(0), 1), 0., 1e-14);
+
+        // the same pivots and factor from the diagonal and the pivot columns
+        xarray<double> d = xt::diagonal(a);
+        std::size_t calls = 0;
+        auto column = [&a, &calls](std::size_t j, xtensor<double, 1>& c) {
+            ++calls;
+            c = xt::view(a, xt::all(), j);
+        };
+        auto part = linalg::cholesky_pivoted_partial(d, column, 4);
+        EXPECT_EQ(calls, 2u);
+        EXPECT_TRUE(allclose(std::get<0>(part), L));
+        EXPECT_EQ(std::get<1>(part)(0), P(0));
+        EXPECT_EQ(std::get<1>(part)(1), P(1));
+
+        // stopping at max_rank leaves a positive semidefinite remainder
+        auto one = linalg::cholesky_pivoted_partial(d, column, 1);
+        EXPECT_EQ(std::get<0>(one).shape()[1], 1u);
+        xarray<double> remainder = a - linalg::dot(std::get<0>(one), transpose(std::get<0>(one)));
+        EXPECT_TRUE(xt::all(linalg::eigvalsh(remainder) > -1e-12));
+    }
+
     TEST(xlinalg, qr)
     {
         xarray<double, layout_type::column_major> a = xt::random::rand<double>({9, 6});
@@ -406,6 +1425,14 @@ namespace xt
         EXPECT_EQ(std::get<0>(resr).size(), 0u);
         EXPECT_EQ(std::get<0>(resr).dimension(), 1u);
 
+        xtensor<double, 2, layout_type::column_major> qi = a;
+        xtensor<double, 2, layout_type::column_major> ri;
+        linalg::qr_inplace(qi, ri);
+        EXPECT_TRUE(allclose(qi, q));
+        EXPECT_TRUE(allclose(ri, r));
+        xtensor<double, 2, layout_type::column_major> wide = xt::transpose(a);
+        EXPECT_THROW(linalg::qr_inplace(wide, ri), std::runtime_error);
+
         xarray<double, layout_type::column_major> erawR = {{-1.00444014e+01,  0.00000000e+00,  6.74440143e-01, 2.24813381e-01},
                                                            {-9.58743044e+00, -1.25730337e+01, -6.22814365e-03, 3.37562246e-01},
                                                            {-1.29027101e+01, -7.34080303e+00, -4.07831856e+00, -5.76331089e-01}};
@@ -425,6 +1452,129 @@ namespace xt
         EXPECT_TRUE(allclose(erawR, rawR));
     }
 
+    TEST(xlinalg, qr_pivoted_apply_q)
+    {
+        xarray<double, layout_type::column_major> a = {{ 3.3,  1.,  2.},
+                                                       { 0. , 10.,  8.},
+                                                       { 9. ,  7., 12.},
+                                                       { 3. , 10.,  5.}};
+        xarray<double> b = {{1., 0.},
+                            {2., 1.},
+                            {0., 3.},
+                            {1., 1.}};
+
+        auto res = linalg::qr_pivoted(a);
+        auto& q = std::get<0>(res);
+        auto& r = std::get<1>(res);
+        auto& p = std::get<2>(res);
+        EXPECT_EQ(q.shape()[1], 3u);
+        std::vector<std::size_t> cols(p.begin(), p.end());
+        EXPECT_TRUE(allclose(linalg::dot(q, r), xt::view(a, xt::all(), xt::keep(cols))));
+        EXPECT_GE(std::abs(r(0, 0)), std::abs(r(1, 1)));
+        EXPECT_GE(std::abs(r(1, 1)), std::abs(r(2, 2)));
+
+        auto raw = linalg::qr_pivoted(a, linalg::qrmode::raw);
+        auto qtb = linalg::apply_q(std::get<0>(raw), std::get<1>(raw), b, 'T');
+        EXPECT_EQ(qtb.shape()[0], 4u);
+        EXPECT_TRUE(allclose(xt::view(qtb, xt::range(0, 3), xt::all()), linalg::dot(xt::transpose(q), b)));
+        EXPECT_TRUE(allclose(linalg::apply_q(std::get<0>(raw), std::get<1>(raw), qtb), b));
+
+        auto fac = linalg::qr_factor(a);
+        auto qr_res = linalg::qr(a);
+        xarray<double> y = {1., -1., 2.};
+        EXPECT_TRUE(allclose(fac.apply_q(y), linalg::dot(std::get<0>(qr_res), y)));
+        xarray<double> qtb2 = linalg::apply_q(fac, b, 'T');
+        EXPECT_TRUE(allclose(xt::view(qtb2, xt::range(0, 3), xt::all()), linalg::dot(xt::transpose(std::get<0>(qr_res)), b)));
+        EXPECT_THROW(fac.apply_q(y, 'T'), std::runtime_error);
+    }
+
+    TEST(xlinalg, householder)
+    {
+        xarray<double> x = {3., 4., 0., 12.};
+        auto res = linalg::householder(x);
+        auto& v = std::get<0>(res);
+        double tau = std::get<1>(res);
+        double beta = std::get<2>(res);
+        EXPECT_EQ(v(0), 1.);
+        EXPECT_NEAR(std::abs(beta), 13., 1e-12);
+        xarray<double> hx = x - tau * v * linalg::vdot(v, x);
+        xarray<double> expected = {beta, 0., 0., 0.};
+        EXPECT_TRUE(allclose(hx, expected, 1e-10, 1e-12));
+        EXPECT_THROW(linalg::householder(xarray<double>::from_shape({0})), std::runtime_error);
+
+        // the compact WY form of the reflectors of qrmode::raw applies Q
+        xarray<double, layout_type::column_major> a = {{ 3.3,  1.,  2.},
+                                                       { 0. , 10.,  8.},
+                                                       { 9. ,  7., 12.},
+                                                       { 3. , 10.,  5.}};
+        xarray<double> b = {{1., 0.},
+                            {2., 1.},
+                            {0., 3.},
+                            {1., 1.}};
+        auto raw = linalg::qr(a, linalg::qrmode::raw);
+        auto& h = std::get<0>(raw);
+        auto& t = std::get<1>(raw);
+        auto T = linalg::block_reflector(transpose(h), t);
+        EXPECT_EQ(T.shape()[0], 3u);
+        EXPECT_EQ(T(1, 0), 0.);
+        auto qtb = linalg::apply_block_reflector(transpose(h), T, b, 'L', 'T');
+        EXPECT_TRUE(allclose(qtb, linalg::apply_q(h, t, b, 'T')));
+        EXPECT_TRUE(allclose(linalg::apply_block_reflector(transpose(h), T, qtb), b));
+        xarray<double> bt = transpose(b);
+        EXPECT_TRUE(allclose(linalg::apply_block_reflector(transpose(h), T, bt, 'R'), transpose(qtb)));
+        EXPECT_THROW(linalg::apply_block_reflector(transpose(h), T, bt), std::runtime_error);
+        EXPECT_THROW(linalg::apply_block_reflector(transpose(h), T, b, 'X'), std::runtime_error);
+    }
+
+    TEST(xlinalg, apply_rotations)
+    {
+        // rotation k of the pivot in the planes (first, second) of z lines
+        auto plane = [](std::size_t z, std::size_t first, std::size_t second, double c, double s) {
+            xarray<double> g = eye<double>(z);
+            g(first, first) = c;
+            g(second, second) = c;
+            g(first, second) = s;
+            g(second, first) = -s;
+            return g;
+        };
+        xarray<double> c = {0.6, 1., 0.8, std::cos(0.3)};
+        xarray<double> s = {0.8, 0., -0.6, std::sin(0.3)};
+
+        xarray<double> a = {{ 1., 2., 3.},
+                            { 4., 5., 6.},
+                            {-1., 0., 2.},
+                            { 7., 1., 3.},
+                            { 2., 2., 9.}};
+        xarray<double> expected = a;
+        for (std::size_t k = 0; k < 4; ++k)
+        {
+            expected = linalg::dot(plane(5, k, k + 1, c(k), s(k)), expected);
+        }
+        xarray<double> rows = a;
+        linalg::apply_rotations(rows, c, s);
+        EXPECT_TRUE(allclose(rows, expected));
+
+        // columns of a strided view, bottom pivot, last rotation first
+        xarray<double, layout_type::column_major> big = zeros<double>({4, 11});
+        auto cols = view(big, range(1, 4), range(0, 10, 2));
+        cols = transpose(a);
+        expected = transpose(a);
+        for (std::size_t k = 4; k-- > 0;)
+        {
+            expected = linalg::dot(expected, transpose(plane(5, k, 4, c(k), s(k))));
+        }
+        linalg::apply_rotations(cols, c, s, 'R', 'B', 'B');
+        EXPECT_TRUE(allclose(cols, expected));
+        EXPECT_EQ(big(0, 0), 0.);
+        EXPECT_EQ(big(1, 1), 0.);
+
+        xarray<std::complex<double>> z = {{1., 2.}, {3., 4.}};
+        linalg::apply_rotations(z, xarray<double>{0.6}, xarray<double>{0.8}, 'L', 'T');
+        EXPECT_TRUE(allclose(real(z), xarray<double>{{3., 4.4}, {1., 0.8}}));
+        EXPECT_THROW(linalg::apply_rotations(rows, xarray<double>{1.}, xarray<double>{0.}), std::runtime_error);
+        EXPECT_THROW(linalg::apply_rotations(rows, c, s, 'X'), std::runtime_error);
+    }
+
     TEST(xlinalg, lstsq)
     {
         xarray<double> arg_0 = {{ 0., 1.},
@@ -470,6 +1620,97 @@ namespace xt
         EXPECT_TRUE(allclose(cel_3, std::get<3>(cres)));
     }
 
+    TEST(xlinalg, lstsq_drivers)
+    {
+        xarray<double> a = {{ 0., 1.},
+                            { 1., 1.},
+                            { 2., 1.},
+                            { 3., 1.}};
+        xarray<double> b = {-1., 0.2, 0.9, 2.1};
+
+        auto ref = linalg::lstsq(a, b);
+        for (auto driver : {linalg::lstsq_driver::gelss, linalg::lstsq_driver::gelsy,
+                            linalg::lstsq_driver::gels, linalg::lstsq_driver::cholesky})
+        {
+            auto res = linalg::lstsq(a, b, -1., driver);
+            EXPECT_TRUE(allclose(std::get<0>(ref), std::get<0>(res)));
+            EXPECT_TRUE(allclose(std::get<1>(ref), std::get<1>(res)));
+            EXPECT_EQ(2, std::get<2>(res));
+        }
+        EXPECT_TRUE(allclose(std::get<3>(ref), std::get<3>(linalg::lstsq(a, b, -1., linalg::lstsq_driver::gelss))));
+        EXPECT_EQ(0u, std::get<3>(linalg::lstsq(a, b, -1., linalg::lstsq_driver::gelsy)).size());
+
+        xarray<std::complex<double>> ca = {{ 0., 1.},
+                                           { 1. - 3i, 1.},
+                                           { 2., 1.},
+                                           { 3., 1.}};
+        xarray<std::complex<double>> cb = {{-1. , 0.2+4i, 0.9, 2.1-1i}, {2,3i,2,1}};
+        cb = transpose(cb);
+        auto cref = linalg::lstsq(ca, cb);
+        for (auto driver : {linalg::lstsq_driver::gelss, linalg::lstsq_driver::gelsy,
+                            linalg::lstsq_driver::gels, linalg::lstsq_driver::cholesky})
+        {
+            auto cres = linalg::lstsq(ca, cb, -1., driver);
+            EXPECT_TRUE(allclose(real(std::get<0>(cref)), real(std::get<0>(cres))));
+            EXPECT_TRUE(allclose(imag(std::get<0>(cref)), imag(std::get<0>(cres))));
+            EXPECT_TRUE(allclose(std::get<1>(cref), std::get<1>(cres)));
+        }
+
+        xarray<double> rank_deficient = {{1., 2.}, {2., 4.}, {3., 6.}};
+        xarray<double> rb = {1., 2., 3.};
+        EXPECT_EQ(1, std::get<2>(linalg::lstsq(rank_deficient, rb, -1., linalg::lstsq_driver::gelsy)));
+        xarray<double> wide = transpose(a);
+        xarray<double> wb = {1., 2.};
+        EXPECT_THROW(linalg::lstsq(wide, wb, -1., linalg::lstsq_driver::cholesky), std::runtime_error);
+    }
+
+    TEST(xlinalg, incremental_lstsq)
+    {
+        xt::random::seed(0);
+        xarray<double> a = xt::random::rand<double>({30, 4});
+        xarray<double> b = xt::random::rand<double>({30, 2});
+
+        linalg::incremental_lstsq<double> inc(4, 2);
+        inc.add_rows(view(a, range(0, 10), all()), view(b, range(0, 10), all()));
+        inc.add_rows(view(a, range(10, 30), all()), view(b, range(10, 30), all()));
+        EXPECT_EQ(30u, inc.rows());
+
+        auto ref = linalg::lstsq(a, b);
+        EXPECT_TRUE(allclose(std::get<0>(ref), inc.solve()));
+        EXPECT_TRUE(allclose(std::get<1>(ref), inc.residuals()));
+
+        // sliding window: drop the oldest rows
+        inc.remove_rows(view(a, range(0, 12), all()), view(b, range(0, 12), all()));
+        EXPECT_EQ(18u, inc.rows());
+        xarray<double> a_window = view(a, range(12, 30), all());
+        xarray<double> b_window = view(b, range(12, 30), all());
+        auto ref_window = linalg::lstsq(a_window, b_window);
+        EXPECT_TRUE(allclose(std::get<0>(ref_window), inc.solve()));
+        EXPECT_TRUE(allclose(std::get<1>(ref_window), inc.residuals()));
+
+        xarray<std::complex<double>> ca = {{ 0., 1.},
+                                           { 1. - 3i, 1.},
+                                           { 2., 1.},
+                                           { 3., 1.},
+                                           { 1i, 2.}};
+        xarray<std::complex<double>> cb = {-1., 0.2+4i, 0.9, 2.1-1i, 1.};
+        linalg::incremental_lstsq<std::complex<double>> cinc(2);
+        cinc.add_rows(ca, cb);
+        cinc.remove_rows(view(ca, range(4, 5), all()), view(cb, range(4, 5)));
+        xarray<std::complex<double>> ca_head = view(ca, range(0, 4), all());
+        xarray<std::complex<double>> cb_head = view(cb, range(0, 4));
+        auto cref = linalg::lstsq(ca_head, cb_head);
+        auto cx = cinc.solve();
+        EXPECT_TRUE(allclose(real(std::get<0>(cref)), real(view(cx, all(), 0))));
+        EXPECT_TRUE(allclose(imag(std::get<0>(cref)), imag(view(cx, all(), 0))));
+        EXPECT_TRUE(allclose(std::get<1>(cref), cinc.residuals()));
+
+        linalg::incremental_lstsq<double> small(4);
+        small.add_rows(view(a, range(0, 2), all()), view(b, range(0, 2), 0));
+        EXPECT_THROW(small.solve(), std::runtime_error);
+        EXPECT_THROW(small.add_rows(a, b), std::runtime_error);
+    }
+
     TEST(xlinalg, trace)
     {
         auto e1 = eye<double>(10);
@@ -497,6 +1738,28 @@ namespace xt
         EXPECT_EQ(12, ar1());
         EXPECT_EQ(6,  ar2());
         EXPECT_EQ(10, ar3());
+
+        // static rank 2: a scalar of the value type
+        xtensor<int, 2> ti = {{1, 2, 3}, {4, 5, 6}};
+        auto tti = linalg::trace(ti);
+        static_assert(std::is_same<decltype(tti), int>::value, "trace of an int matrix should be an int");
+        EXPECT_EQ(6, tti);
+        EXPECT_EQ(8, linalg::trace(ti, 1));
+        EXPECT_EQ(4, linalg::trace(ti, -1));
+        EXPECT_EQ(0, linalg::trace(ti, 3));
+
+        xtensor<std::complex<double>, 2, layout_type::column_major> tc = {{1. + 2.i, 7. + 0.i}, {0. + 1.i, 3. - 1.i}};
+        EXPECT_EQ(linalg::trace(tc), 4. + 1.i);
+        EXPECT_EQ(linalg::trace(view(tc, all(), range(1, 2)), 0), 7. + 0.i);
+
+        // batched over the leading axis
+        xtensor<float, 3> tb = xt::arange<float>(18.f).reshape({2, 3, 3});
+        auto ttb = linalg::trace(tb, 0, -2, -1);
+        static_assert(std::is_same<decltype(ttb), xtensor<float, 1>>::value, "trace of a stack should be an xtensor");
+        EXPECT_EQ(ttb(0), 12.f);
+        EXPECT_EQ(ttb(1), 39.f);
+        EXPECT_TRUE(allclose(linalg::trace(tb, 0, 0, 2), xarray<float>({10.f, 16.f, 22.f})));
+        EXPECT_THROW(linalg::trace(tb, 0, 1, 1), std::runtime_error);
     }
 
     TEST(xlinalg, dots)
@@ -628,4 +1891,887 @@ namespace xt
         EXPECT_THROW(xt::linalg::cholesky(xt::ones<std::complex<double>>({3, 1})), std::runtime_error);
     }
 
+    TEST(xlinalg, lu_factor)
+    {
+        xarray<double> a = {{ 4., 3., 2.},
+                            { 2., 1., 3.},
+                            { 3., 2., 1.}};
+        xarray<double> b = {1., 2., 3.};
+        xarray<double> B = {{1., 0.}, {2., 1.}, {3., 2.}};
+
+        auto lu = linalg::lu_factor(a);
+        EXPECT_TRUE(allclose(lu.solve(b), linalg::solve(a, b)));
+        EXPECT_TRUE(allclose(lu.solve(B), linalg::solve(a, B)));
+        xarray<double> at = transpose(a);
+        EXPECT_TRUE(allclose(lu.solve(b, 'T'), linalg::solve(at, b)));
+
+        EXPECT_NEAR(lu.det(), linalg::det(a), 1e-12);
+        auto ld = lu.logdet();
+        auto sld = linalg::slogdet(a);
+        EXPECT_EQ(std::get<0>(ld), std::get<0>(sld));
+        EXPECT_NEAR(std::get<1>(ld), std::get<1>(sld), 1e-12);
+        EXPECT_TRUE(allclose(lu.inv(), linalg::inv(a)));
+
+        double expected_rcond = 1. / (linalg::norm(a, 1) * linalg::norm(linalg::inv(a), 1));
+        EXPECT_NEAR(lu.rcond(), expected_rcond, 1e-12);
+
+        xarray<double> singular = {{1., 2.}, {2., 4.}};
+        auto lus = linalg::lu_factor(singular);
+        EXPECT_TRUE(lus.singular());
+        EXPECT_EQ(lus.det(), 0.);
+        EXPECT_EQ(lus.rcond(), 0.);
+        EXPECT_THROW(lus.solve(xarray<double>{1., 2.}), std::runtime_error);
+    }
+
+    TEST(xlinalg, cond)
+    {
+        xarray<double> a = {{ 4., 3., 2.},
+                            { 2., 1., 3.},
+                            { 3., 2., 1.}};
+        xarray<double> a_inv = linalg::inv(a);
+        double cond_1 = linalg::norm(a, 1) * linalg::norm(a_inv, 1);
+        double cond_inf = linalg::norm(a, linalg::normorder::inf) * linalg::norm(a_inv, linalg::normorder::inf);
+
+        EXPECT_NEAR(cond_1, linalg::cond(a, 1), 1e-10);
+        EXPECT_NEAR(cond_inf, linalg::cond(a, linalg::normorder::inf), 1e-10);
+        EXPECT_NEAR(1. / cond_inf, linalg::lu_factor(a).rcond('I'), 1e-12);
+        EXPECT_NEAR(1. / cond_1, linalg::rcond(a), 1e-12);
+
+        xarray<double> d = {{3., 0.}, {0., -2.}};
+        EXPECT_NEAR(1.5, linalg::cond(d, 2), 1e-14);
+        EXPECT_NEAR(1. / 1.5, linalg::cond(d, -2), 1e-14);
+
+        // trcon and pocon, without an LU factorization
+        xarray<double> l = {{1., 0.}, {5., 1.}};
+        EXPECT_NEAR(1. / 36., linalg::rcond(l, '1', linalg::assume_a::lower_triangular), 1e-14);
+        EXPECT_NEAR(1. / 36., linalg::rcond(l, 'I', linalg::assume_a::detect), 1e-14);
+        xarray<double> s = {{2., 1.}, {1., 3.}};
+        EXPECT_NEAR(1. / 3.2, linalg::rcond(s, '1', linalg::assume_a::positive_definite), 1e-14);
+
+        // detected as a candidate for Cholesky, which fails
+        xarray<double> indefinite = {{1., 2.}, {2., 1.}};
+        EXPECT_NEAR(1. / 3., linalg::rcond(indefinite, '1', linalg::assume_a::detect), 1e-14);
+        EXPECT_THROW(linalg::rcond(indefinite, '1', linalg::assume_a::positive_definite), std::runtime_error);
+
+        xarray<double> singular = {{1., 2.}, {2., 4.}};
+        EXPECT_EQ(0., linalg::rcond(singular));
+    }
+
+    TEST(xlinalg, cholesky_factor)
+    {
+        xarray<double> a = {{ 4., 12., -16.},
+                            {12., 37., -43.},
+                            {-16., -43., 98.}};
+        xarray<double> b = {1., 2., 3.};
+
+        auto chol = linalg::cholesky_factor(a);
+        EXPECT_TRUE(allclose(chol.matrix(), linalg::cholesky(a)));
+        EXPECT_TRUE(allclose(chol.solve(b), linalg::solve(a, b)));
+        EXPECT_NEAR(chol.det(), linalg::det(a), 1e-9);
+        EXPECT_NEAR(chol.logdet(), std::log(linalg::det(a)), 1e-12);
+        EXPECT_TRUE(allclose(chol.inv(), linalg::inv(a)));
+        EXPECT_GT(chol.rcond(), 0.);
+        EXPECT_LE(chol.rcond(), 1.);
+
+        xarray<double> not_pd = {{1., 2.}, {2., 1.}};
+        EXPECT_THROW(linalg::cholesky_factor(not_pd), std::runtime_error);
+
+        xarray<double> x = {{1., 0.}, {-2., 3.}, {0.5, 1.}};
+        xarray<double> updated = a + linalg::dot(x, transpose(x));
+        chol.update(x);
+        EXPECT_TRUE(allclose(chol.matrix(), linalg::cholesky(updated)));
+        EXPECT_TRUE(allclose(chol.solve(b), linalg::solve(updated, b)));
+        EXPECT_GT(chol.rcond(), 0.);
+        chol.update(x, true);
+        EXPECT_TRUE(allclose(chol.matrix(), linalg::cholesky(a)));
+
+        // a - y y^T is indefinite, the factorization is left unchanged
+        xarray<double> y = {3., 0., 0.};
+        EXPECT_THROW(chol.update(y, true), std::runtime_error);
+        EXPECT_TRUE(allclose(chol.matrix(), linalg::cholesky(a)));
+    }
+
+    TEST(xlinalg, ldl_factor)
+    {
+        // KKT matrix of a quadratic program with one equality constraint
+        xarray<double> kkt = {{4., 1., 0., 1.},
+                              {1., 3., 1., 1.},
+                              {0., 1., 2., -1.},
+                              {1., 1., -1., 0.}};
+        xarray<double> b = {1., 2., 3., 4.};
+        xarray<double> rhs = {{1., 0.}, {2., 1.}, {3., -1.}, {4., 2.}};
+
+        auto ldl = linalg::ldl_factor(kkt);
+        EXPECT_TRUE(allclose(ldl.solve(b), linalg::solve(kkt, b)));
+        EXPECT_TRUE(allclose(ldl.solve(rhs), linalg::solve(kkt, rhs)));
+        EXPECT_NEAR(ldl.det(), linalg::det(kkt), 1e-10);
+        auto logdet = ldl.logdet();
+        EXPECT_EQ(std::get<0>(logdet), -1.);
+        EXPECT_NEAR(std::get<1>(logdet), std::log(std::abs(linalg::det(kkt))), 1e-12);
+        EXPECT_TRUE(allclose(ldl.inv(), linalg::inv(kkt)));
+        EXPECT_EQ(ldl.inertia(), std::make_tuple(std::size_t(3), std::size_t(1), std::size_t(0)));
+        EXPECT_GT(ldl.rcond(), 0.);
+        EXPECT_LE(ldl.rcond(), 1.);
+
+        // no 1x1 pivot is possible
+        xarray<double> swap = {{0., 1.}, {1., 0.}};
+        auto s = linalg::ldl_factor(swap);
+        EXPECT_LT(s.pivots()[0], 0);
+        EXPECT_EQ(s.inertia(), std::make_tuple(std::size_t(1), std::size_t(1), std::size_t(0)));
+        EXPECT_NEAR(s.det(), -1., 1e-15);
+
+        xarray<std::complex<double>> h = {{1., {0., 2.}}, {{0., -2.}, 1.}};
+        xarray<std::complex<double>> hb = {1., 2.};
+        auto lh = linalg::ldl_factor(h);
+        EXPECT_TRUE(lh.hermitian());
+        EXPECT_EQ(lh.inertia(), std::make_tuple(std::size_t(1), std::size_t(1), std::size_t(0)));
+        EXPECT_NEAR(std::real(lh.det()), -3., 1e-12);
+        xarray<std::complex<double>> hx = linalg::dot(h, lh.solve(hb));
+        EXPECT_TRUE(allclose(xt::real(hx), xt::real(hb)));
+        EXPECT_TRUE(allclose(xt::imag(hx), xt::imag(hb)));
+        auto complex_symmetric = linalg::ldl_factor(h, false);
+        EXPECT_NEAR(std::abs(complex_symmetric.det() - std::complex<double>(5.)), 0., 1e-12);
+        EXPECT_THROW(complex_symmetric.inertia(), std::runtime_error);
+
+        xarray<double> singular = {{1., 1.}, {1., 1.}};
+        auto ls = linalg::ldl_factor(singular);
+        EXPECT_TRUE(ls.singular());
+        EXPECT_EQ(ls.rcond(), 0.);
+        EXPECT_EQ(ls.inertia(), std::make_tuple(std::size_t(1), std::size_t(0), std::size_t(1)));
+        EXPECT_THROW(ls.solve(xarray<double>{1., 2.}), std::runtime_error);
+    }
+
+    TEST(xlinalg, woodbury)
+    {
+        xarray<double> a = {{4., 1., 0., 2.},
+                            {1., 5., 1., 0.},
+                            {0., 1., 6., 1.},
+                            {2., 0., 1., 7.}};
+        xarray<double> u = {{1., 0.}, {2., 1.}, {0., -1.}, {1., 3.}};
+        xarray<double> c = {{1., 2.}, {0., -1.}};
+        xarray<double> v = {{0., 1.}, {1., 1.}, {2., 0.}, {-1., 1.}};
+        xarray<double> b = {{1., 0.}, {2., 1.}, {3., -1.}, {4., 2.}};
+        xarray<double> updated = a + linalg::dot(u, linalg::dot(c, transpose(v)));
+        xarray<double> expected = linalg::solve(updated, b);
+
+        auto lu = linalg::lu_factor(a);
+        EXPECT_TRUE(allclose(linalg::solve_woodbury(lu, u, c, v, b), expected));
+        EXPECT_TRUE(allclose(linalg::solve_woodbury(linalg::cholesky_factor(a), u, c, v, b), expected));
+
+        auto w = linalg::woodbury_update(lu, u, c, v);
+        EXPECT_EQ(w.rank(), 2u);
+        xarray<double> b0 = view(b, all(), 0);
+        xarray<double> expected0 = view(expected, all(), 0);
+        EXPECT_TRUE(allclose(w.solve(b0), expected0));
+
+        // successive updates, with a singular C
+        xarray<double> u2 = {{1., 0.}, {0., 1.}, {1., 0.}, {0., 0.}};
+        xarray<double> c2 = {{3., 0.}, {0., 0.}};
+        xarray<double> v2 = {{0., 1.}, {1., 0.}, {0., 2.}, {1., 0.}};
+        xarray<double> updated2 = updated + linalg::dot(u2, linalg::dot(c2, transpose(v2)));
+        EXPECT_TRUE(allclose(linalg::woodbury_update(w, u2, c2, v2).solve(b), linalg::solve(updated2, b)));
+
+        xarray<double> d = {1., 2., 3., 4.};
+        xarray<double> diag_updated = xt::diag(d) + linalg::dot(u, linalg::dot(c, transpose(v)));
+        EXPECT_TRUE(allclose(linalg::solve_woodbury(d, u, c, v, b), linalg::solve(diag_updated, b)));
+
+        EXPECT_TRUE(allclose(linalg::inv_update(linalg::inv(a), u, c, v), linalg::inv(updated)));
+
+        // I - e0 e0^T is singular
+        xarray<double> ones = {1., 1., 1., 1.};
+        xarray<double> e0 = {{1.}, {0.}, {0.}, {0.}};
+        xarray<double> minus_one = {{-1.}};
+        EXPECT_THROW(linalg::woodbury_update(ones, e0, minus_one, e0), std::runtime_error);
+        EXPECT_THROW(linalg::woodbury_update(lu, u, minus_one, v), std::runtime_error);
+    }
+
+    TEST(xlinalg, qr_factor)
+    {
+        xarray<double> a = {{ 4., 3., 2.},
+                            { 2., 1., 3.},
+                            { 3., 2., 1.}};
+        xarray<double> b = {1., 2., 3.};
+
+        auto qr = linalg::qr_factor(a);
+        EXPECT_TRUE(allclose(qr.solve(b), linalg::solve(a, b)));
+        EXPECT_NEAR(qr.det(), linalg::det(a), 1e-12);
+        auto ld = qr.logdet();
+        EXPECT_EQ(std::get<0>(ld), std::get<0>(linalg::slogdet(a)));
+        EXPECT_TRUE(allclose(qr.inv(), linalg::inv(a)));
+        EXPECT_GT(qr.rcond(), 0.);
+
+        // least squares for a tall matrix
+        xarray<double> tall = {{1., 1.}, {1., 2.}, {1., 3.}, {1., 4.}};
+        xarray<double> y = {6., 5., 7., 10.};
+        auto qr_tall = linalg::qr_factor(tall);
+        xarray<double> expected = {3.5, 1.4};
+        EXPECT_TRUE(allclose(qr_tall.solve(y), expected));
+
+        xarray<double> wide = {{1., 2., 3.}};
+        EXPECT_THROW(linalg::qr_factor(wide), std::runtime_error);
+    }
+
+    TEST(xlinalg, inplace)
+    {
+        xarray<double> a = {{ 4., 12., -16.},
+                            {12., 37., -43.},
+                            {-16., -43., 98.}};
+        xarray<double> b = {1., 2., 3.};
+
+        xtensor<double, 2, layout_type::column_major> A = a;
+        xtensor<double, 1, layout_type::column_major> x = b;
+        auto& xr = linalg::solve_inplace(A, x);
+        EXPECT_EQ(&xr, &x);
+        EXPECT_TRUE(allclose(x, linalg::solve(a, b)));
+
+        A = a;
+        linalg::inv_inplace(A);
+        EXPECT_TRUE(allclose(A, linalg::inv(a)));
+
+        A = a;
+        linalg::cholesky_inplace(A);
+        EXPECT_TRUE(allclose(A, linalg::cholesky(a)));
+
+        A = a;
+        auto w = linalg::eigh_inplace(A);
+        auto eig_res = linalg::eigh(a);
+        EXPECT_TRUE(allclose(w, std::get<0>(eig_res)));
+        EXPECT_TRUE(allclose(abs(A), abs(std::get<1>(eig_res))));
+
+        xarray<double, layout_type::column_major> M = a;
+        auto svd_res = linalg::svd_inplace(M, false, false);
+        EXPECT_TRUE(allclose(std::get<1>(svd_res), std::get<1>(linalg::svd(a, false, false))));
+
+        xarray<double> row_major = a;
+        EXPECT_THROW(linalg::inv_inplace(row_major), std::runtime_error);
+    }
+
+    TEST(xlinalg, try_inplace)
+    {
+        xarray<double> a = {{ 4., 12., -16.},
+                            {12., 37., -43.},
+                            {-16., -43., 98.}};
+        xarray<double> b = {1., 2., 3.};
+        xarray<double> expected = linalg::solve(a, b);
+
+        xtensor<double, 2, layout_type::column_major> lu = xtensor<double, 2, layout_type::column_major>::from_shape({3, 3});
+        xtensor<double, 1, layout_type::column_major> x = xtensor<double, 1, layout_type::column_major>::from_shape({3});
+        uvector<blas_index_t> piv(3);
+        EXPECT_EQ(linalg::try_solve(a, b, x, lu, piv), 0);
+        EXPECT_TRUE(allclose(x, expected));
+        x.fill(0.);
+        EXPECT_EQ(linalg::try_solve(a, b, x), 0);
+        EXPECT_TRUE(allclose(x, expected));
+
+        xtensor<double, 2, layout_type::column_major> A = a;
+        xtensor<double, 1, layout_type::column_major> y = b;
+        EXPECT_EQ(linalg::try_solve_positive_definite_inplace(A, y), 0);
+        EXPECT_TRUE(allclose(y, expected));
+
+        A = a;
+        EXPECT_EQ(linalg::try_cholesky_inplace(A), 0);
+        EXPECT_TRUE(allclose(A, linalg::cholesky(a)));
+
+        A = a;
+        lapack::workspace<double> ws;
+        ws.prepare<lapack::routine::getri>({3, 0, 0});
+        EXPECT_EQ(linalg::try_inv_inplace(A, piv, ws), 0);
+        EXPECT_TRUE(allclose(A, linalg::inv(a)));
+
+        // failures are reported, not thrown
+        xtensor<double, 2, layout_type::column_major> singular = {{1., 2.}, {2., 4.}};
+        xtensor<double, 1, layout_type::column_major> z = {1., 1.};
+        EXPECT_GT(linalg::try_solve_inplace(singular, z, piv), 0);
+        A = -a;
+        EXPECT_EQ(linalg::try_cholesky_inplace(A), 1);
+        xarray<double> row_major = a;
+        y = b;
+        EXPECT_EQ(linalg::try_solve_inplace(row_major, y, piv), -1);
+        EXPECT_EQ(linalg::try_solve(a, xarray<double>{1., 2.}, x, lu, piv), -2);
+        uvector<blas_index_t> short_piv(2);
+        A = a;
+        EXPECT_EQ(linalg::try_solve_inplace(A, y, short_piv), -3);
+    }
+
+    TEST(xlinalg, row_major_operands)
+    {
+        xtensor<double, 2> a = {{ 2., 1., 1.},
+                                {-1., 1.,-1.},
+                                { 1., 2., 3.}};
+        xtensor<double, 2, layout_type::column_major> ac = a;
+        xtensor<double, 1> b = {2., 3., -10.};
+        xtensor<double, 2> B = {{2., 18.}, {3., 6.}, {-10., -30.}};
+
+        EXPECT_TRUE(allclose(linalg::solve(a, b), linalg::solve(ac, b)));
+        EXPECT_TRUE(allclose(linalg::solve(a, B), linalg::solve(ac, B)));
+
+        auto ai = linalg::inv(a);
+        EXPECT_EQ(ai.layout(), layout_type::row_major);
+        EXPECT_TRUE(allclose(ai, linalg::inv(ac)));
+        EXPECT_TRUE(allclose(linalg::dot(ai, a), eye<double>(3)));
+
+        EXPECT_NEAR(linalg::det(a), linalg::det(ac), 1e-12);
+        EXPECT_EQ(std::get<0>(linalg::slogdet(a)), std::get<0>(linalg::slogdet(ac)));
+
+        // non-contiguous row-major operand
+        xtensor<double, 2> big = zeros<double>({3, 6});
+        view(big, all(), range(0, 6, 2)) = a;
+        auto strided = view(big, all(), range(0, 6, 2));
+        EXPECT_TRUE(allclose(linalg::solve(strided, b), linalg::solve(ac, b)));
+        EXPECT_TRUE(allclose(linalg::inv(strided), linalg::inv(ac)));
+    }
+
+    TEST(xlinalg, batch_solvers)
+    {
+        for (std::size_t n : {3, 10})
+        {
+            xt::random::seed(0);
+            xarray<double> a = xt::random::rand<double>({2, 3, n, n});
+            xarray<double> b = xt::random::rand<double>({2, 3, n});
+            xarray<double> B = xt::random::rand<double>({2, 3, n, 2});
+
+            auto d = linalg::batch_det(a);
+            auto ai = linalg::batch_inv(a);
+            auto x = linalg::batch_solve(a, b);
+            auto X = linalg::batch_solve(a, B);
+            EXPECT_EQ(d.dimension(), std::size_t(2));
+            EXPECT_EQ(d.shape()[1], std::size_t(3));
+            EXPECT_EQ(ai.shape(), a.shape());
+            EXPECT_EQ(x.shape(), b.shape());
+            EXPECT_EQ(X.shape(), B.shape());
+
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                for (std::size_t j = 0; j < 3; ++j)
+                {
+                    xarray<double> m = view(a, i, j);
+                    EXPECT_NEAR(d(i, j), linalg::det(m), 1e-10);
+                    EXPECT_TRUE(allclose(view(ai, i, j), linalg::inv(m)));
+                    EXPECT_TRUE(allclose(view(x, i, j), linalg::solve(m, xarray<double>(view(b, i, j)))));
+                    EXPECT_TRUE(allclose(view(X, i, j), linalg::solve(m, xarray<double>(view(B, i, j)))));
+
+                    xarray<double> spd = linalg::dot(m, transpose(m)) + double(n) * eye<double>(n);
+                    view(a, i, j) = spd;
+                }
+            }
+
+            auto l = linalg::batch_cholesky(a);
+            auto eh = linalg::batch_eigh(a);
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                for (std::size_t j = 0; j < 3; ++j)
+                {
+                    xarray<double> m = view(a, i, j);
+                    EXPECT_TRUE(allclose(view(l, i, j), linalg::cholesky(m)));
+                    auto single = linalg::eigh(m);
+                    EXPECT_TRUE(allclose(view(std::get<0>(eh), i, j), std::get<0>(single)));
+                    EXPECT_TRUE(allclose(abs(view(std::get<1>(eh), i, j)), abs(std::get<1>(single))));
+                }
+            }
+        }
+
+        xarray<std::complex<double>> c = {{{2. + 0.i, 1. - 1.i}, {1. + 1.i, 3. + 0.i}}};
+        auto lc = linalg::batch_cholesky(c);
+        xarray<std::complex<double>> c0 = view(c, 0);
+        EXPECT_TRUE(allclose(linalg::dot(view(lc, 0), conj(transpose(view(lc, 0)))), c0));
+
+        xarray<double> singular = zeros<double>({2, 2, 2});
+        EXPECT_THROW(linalg::batch_inv(singular), std::runtime_error);
+        EXPECT_TRUE(allclose(linalg::batch_det(singular), zeros<double>({2})));
+        EXPECT_THROW(linalg::batch_det(zeros<double>({2, 3})), std::runtime_error);
+    }
+
+    TEST(xlinalg, eigh_warm)
+    {
+        std::size_t n = 30, k = 4;
+        xt::random::seed(0);
+        xarray<double> b = xt::random::rand<double>({n, n});
+        xarray<double> a = b + transpose(b) + diag(arange<double>(double(n)) * 2.);
+        auto full = linalg::eigh(a);
+        xarray<double> V = view(std::get<1>(full), all(), range(n - k, n));
+
+        // a small perturbation
+        xarray<double> p = xt::random::rand<double>({n, n}) * 1e-3;
+        xarray<double> a2 = a + p + transpose(p);
+        auto res = linalg::eigh_warm(a2, V, k);
+        auto& w = std::get<0>(res);
+        auto& X = std::get<1>(res);
+        xarray<double> expected = view(linalg::eigvalsh(a2), range(n - k, n));
+        EXPECT_TRUE(allclose(w, expected));
+        EXPECT_TRUE(allclose(linalg::dot(a2, X), X * view(w, newaxis(), all()), 1e-8, 1e-8));
+        EXPECT_TRUE(allclose(linalg::dot(transpose(X), X), eye<double>(k), 1e-8, 1e-8));
+
+        // a random start still ends on eigenpairs, through the fallback if need be
+        xarray<double> R = xt::random::rand<double>({n, k});
+        auto rres = linalg::eigh_warm(a2, R, k, -1., 2);
+        auto& rw = std::get<0>(rres);
+        auto& rX = std::get<1>(rres);
+        EXPECT_TRUE(allclose(linalg::dot(a2, rX), rX * view(rw, newaxis(), all()), 1e-8, 1e-8));
+
+        EXPECT_THROW(linalg::eigh_warm(a2, V, k + 1), std::runtime_error);
+    }
+
+    TEST(xlinalg, eigh_update)
+    {
+        std::size_t n = 12;
+        xt::random::seed(0);
+        xarray<double> b = xt::random::rand<double>({n, n});
+        xarray<double> a = b + transpose(b);
+        auto ed = linalg::eigh(a);
+        xarray<double> x = xt::random::rand<double>({n}) - 0.5;
+        for (double rho : {2., -0.5})
+        {
+            auto res = linalg::eigh_update(std::get<0>(ed), std::get<1>(ed), x, rho);
+            xarray<double> a2 = a + rho * linalg::outer(x, x);
+            auto& w = std::get<0>(res);
+            auto& V = std::get<1>(res);
+            EXPECT_TRUE(allclose(w, linalg::eigvalsh(a2)));
+            EXPECT_TRUE(allclose(linalg::dot(a2, V), V * view(w, newaxis(), all()), 1e-9, 1e-9));
+            EXPECT_TRUE(allclose(linalg::dot(transpose(V), V), eye<double>(n), 1e-9, 1e-9));
+        }
+
+        // a repeated eigenvalue and a truncated basis, grown by one vector
+        xarray<double> d = {1., 1., 3.};
+        xarray<double> Q = view(eye<double>(5), all(), range(0, 3));
+        xarray<double> y = {1., 2., 0., 1., 0.};
+        auto tr = linalg::eigh_update(d, Q, y, 1.);
+        xarray<double> a3 = linalg::dot(Q * view(d, newaxis(), all()), transpose(Q)) + linalg::outer(y, y);
+        auto& tw = std::get<0>(tr);
+        auto& tV = std::get<1>(tr);
+        EXPECT_EQ(tw.size(), 4u);
+        EXPECT_TRUE(allclose(linalg::dot(a3, tV), tV * view(tw, newaxis(), all()), 1e-9, 1e-9));
+        auto kept = linalg::eigh_update(d, Q, y, 1., 2);
+        EXPECT_EQ(std::get<0>(kept).size(), 2u);
+        EXPECT_TRUE(allclose(std::get<0>(kept), view(tw, range(2, 4))));
+    }
+
+    TEST(xlinalg, svd_append_downdate)
+    {
+        std::size_t m = 10, n = 6;
+        xt::random::seed(0);
+        xarray<double> a = xt::random::rand<double>({m, n + 2});
+        xarray<double> a0 = view(a, all(), range(0, n));
+        auto d = linalg::svd(a0, false);
+        auto res = linalg::svd_append(std::get<0>(d), std::get<1>(d), std::get<2>(d), view(a, all(), range(n, n + 2)));
+        auto& U = std::get<0>(res);
+        auto& s = std::get<1>(res);
+        auto& Vt = std::get<2>(res);
+        EXPECT_TRUE(allclose(s, std::get<1>(linalg::svd(a, false))));
+        EXPECT_TRUE(allclose(linalg::dot(U * view(s, newaxis(), all()), Vt), a));
+        EXPECT_TRUE(allclose(linalg::dot(transpose(U), U), eye<double>(s.size()), 1e-9, 1e-9));
+
+        // removing the appended columns again
+        auto dd = linalg::svd_downdate(U, s, Vt, n + 1);
+        dd = linalg::svd_downdate(std::get<0>(dd), std::get<1>(dd), std::get<2>(dd), n);
+        EXPECT_TRUE(allclose(std::get<1>(dd), std::get<1>(d)));
+        EXPECT_TRUE(allclose(linalg::dot(std::get<0>(dd) * view(std::get<1>(dd), newaxis(), all()), std::get<2>(dd)), a0));
+
+        auto tr = linalg::svd_append(std::get<0>(d), std::get<1>(d), std::get<2>(d), view(a, all(), range(n, n + 2)), 3);
+        EXPECT_EQ(std::get<1>(tr).size(), 3u);
+        EXPECT_TRUE(allclose(std::get<1>(tr), view(s, range(0, 3))));
+    }
+
+    TEST(xlinalg, batch_eigh_closed_form)
+    {
+        // a repeated eigenvalue, a diagonal matrix and a 2 x 2 stack
+        xarray<double> a = {{{2., 1., 1.}, {1., 2., 1.}, {1., 1., 2.}},
+                            {{3., 0., 0.}, {0., -1., 0.}, {0., 0., 2.}}};
+        for (char uplo : {'L', 'U'})
+        {
+            auto eh = linalg::batch_eigh(a, uplo);
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                xarray<double> m = view(a, i);
+                xarray<double> V = view(std::get<1>(eh), i);
+                xarray<double> w = view(std::get<0>(eh), i);
+                EXPECT_TRUE(allclose(w, linalg::eigvalsh(m)));
+                EXPECT_TRUE(allclose(linalg::dot(m, V), V * view(w, newaxis(), all())));
+                EXPECT_TRUE(allclose(linalg::dot(transpose(V), V), eye<double>(3)));
+            }
+        }
+        xarray<double> expected = {1., 1., 4.};
+        EXPECT_TRUE(allclose(view(std::get<0>(linalg::batch_eigh(a)), 0), expected));
+
+        xt::random::seed(0);
+        xarray<float> r = xt::random::rand<float>({5, 2, 2});
+        xarray<float> s = r + transpose(r, {0, 2, 1});
+        auto es = linalg::batch_eigh(s);
+        for (std::size_t i = 0; i < 5; ++i)
+        {
+            xarray<float> m = view(s, i);
+            xarray<float> V = view(std::get<1>(es), i);
+            xarray<float> w = view(std::get<0>(es), i);
+            EXPECT_TRUE(allclose(linalg::dot(m, V), V * view(w, newaxis(), all()), 1e-4, 1e-5));
+            EXPECT_LE(w(0), w(1));
+        }
+    }
+
+    TEST(xlinalg, batch_qr_svd)
+    {
+        for (auto shape : {std::vector<std::size_t>{6, 6}, std::vector<std::size_t>{4, 3},
+                           std::vector<std::size_t>{3, 5}, std::vector<std::size_t>{10, 9}})
+        {
+            std::size_t m = shape[0], n = shape[1], k = std::min(m, n);
+            xt::random::seed(0);
+            xarray<double> a = xt::random::rand<double>({2, 3, m, n});
+            auto fq = linalg::batch_qr(a);
+            auto fs = linalg::batch_svd(a);
+            EXPECT_EQ(std::get<0>(fq).shape()[3], k);
+            EXPECT_EQ(std::get<1>(fq).shape()[2], k);
+            EXPECT_EQ(std::get<1>(fs).shape()[2], k);
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                for (std::size_t j = 0; j < 3; ++j)
+                {
+                    xarray<double> mat = view(a, i, j);
+                    xarray<double> Q = view(std::get<0>(fq), i, j);
+                    xarray<double> R = view(std::get<1>(fq), i, j);
+                    EXPECT_TRUE(allclose(linalg::dot(Q, R), mat));
+                    EXPECT_TRUE(allclose(linalg::dot(transpose(Q), Q), eye<double>(k)));
+                    EXPECT_TRUE(allclose(R, triu(R)));
+
+                    xarray<double> U = view(std::get<0>(fs), i, j);
+                    xarray<double> s = view(std::get<1>(fs), i, j);
+                    xarray<double> Vt = view(std::get<2>(fs), i, j);
+                    EXPECT_TRUE(allclose(s, linalg::svdvals(mat)));
+                    EXPECT_TRUE(allclose(linalg::dot(U * view(s, newaxis(), all()), Vt), mat));
+                    EXPECT_TRUE(allclose(linalg::dot(transpose(U), U), eye<double>(k)));
+                    EXPECT_TRUE(allclose(linalg::dot(Vt, transpose(Vt)), eye<double>(k)));
+                }
+            }
+        }
+
+        // rank one: the basis of U is completed for the zero singular values
+        xarray<double> r1 = {{{1., 2., 3.}, {2., 4., 6.}, {1., 2., 3.}, {0., 0., 0.}}};
+        auto fs = linalg::batch_svd(r1);
+        xarray<double> U = view(std::get<0>(fs), 0);
+        EXPECT_TRUE(allclose(linalg::dot(transpose(U), U), eye<double>(3)));
+        EXPECT_NEAR(std::get<1>(fs)(0, 1), 0., 1e-12);
+
+        xarray<std::complex<double>> c = {{{2. + 1.i, 1. - 1.i}, {1. + 1.i, 3. + 0.i}, {0. + 2.i, 1. + 0.i}}};
+        auto cqr = linalg::batch_qr(c);
+        xarray<std::complex<double>> c0 = view(c, 0);
+        EXPECT_TRUE(allclose(linalg::dot(view(std::get<0>(cqr), 0), view(std::get<1>(cqr), 0)), c0));
+        EXPECT_THROW(linalg::batch_qr(xarray<double>{1., 2.}), std::runtime_error);
+    }
+
+    TEST(xlinalg, batch_slogdet)
+    {
+        for (std::size_t n : {2, 3, 5, 10})
+        {
+            xt::random::seed(0);
+            xarray<double> a = xt::random::rand<double>({2, 3, n, n}) - 0.5;
+
+            auto d = linalg::batch_det(a);
+            auto sl = linalg::batch_slogdet(a);
+            EXPECT_EQ(std::get<0>(sl).shape(), d.shape());
+            EXPECT_EQ(std::get<1>(sl).shape(), d.shape());
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                for (std::size_t j = 0; j < 3; ++j)
+                {
+                    xarray<double> m = view(a, i, j);
+                    auto single = linalg::slogdet(m);
+                    EXPECT_NEAR(d(i, j), linalg::det(m), 1e-10);
+                    EXPECT_EQ(std::get<0>(sl)(i, j), std::get<0>(single));
+                    EXPECT_NEAR(std::get<1>(sl)(i, j), std::get<1>(single), 1e-10);
+
+                    xarray<double> spd = linalg::dot(m, transpose(m)) + double(n) * eye<double>(n);
+                    view(a, i, j) = spd;
+                }
+            }
+
+            auto sp = linalg::batch_slogdet(a, linalg::assume_a::positive_definite);
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                for (std::size_t j = 0; j < 3; ++j)
+                {
+                    xarray<double> m = view(a, i, j);
+                    auto single = linalg::slogdet(m, linalg::assume_a::positive_definite);
+                    EXPECT_EQ(std::get<0>(sp)(i, j), 1.);
+                    EXPECT_EQ(std::get<0>(single), 1.);
+                    EXPECT_NEAR(std::get<1>(sp)(i, j), std::get<1>(linalg::slogdet(m)), 1e-10);
+                    EXPECT_NEAR(std::get<1>(single), std::get<1>(linalg::slogdet(m)), 1e-10);
+                }
+            }
+
+            view(a, 1, 2) = -view(a, 1, 2);
+            EXPECT_THROW(linalg::batch_slogdet(a, linalg::assume_a::positive_definite), std::runtime_error);
+        }
+
+        xarray<double> singular = zeros<double>({2, 4, 4});
+        auto ss = linalg::batch_slogdet(singular);
+        EXPECT_EQ(std::get<0>(ss)(1), 0.);
+        EXPECT_EQ(std::get<1>(ss)(1), -std::numeric_limits<double>::infinity());
+
+        // not positive definite: detect falls back to LU, an explicit structure throws
+        xarray<double> indefinite = {{1., 2.}, {2., 1.}};
+        auto si = linalg::slogdet(indefinite, linalg::assume_a::detect);
+        EXPECT_EQ(std::get<0>(si), -1.);
+        EXPECT_NEAR(std::get<1>(si), std::log(3.), 1e-12);
+        EXPECT_THROW(linalg::slogdet(indefinite, linalg::assume_a::positive_definite), std::runtime_error);
+
+        // column-major rvalues are factored in their own buffer
+        xtensor<double, 2, layout_type::column_major> cm = {{4., 3., 2.}, {2., 1., 3.}, {3., 2., 1.}};
+        double expected = linalg::det(cm);
+        auto expected_log = linalg::slogdet(cm);
+        xtensor<double, 2, layout_type::column_major> cm2 = cm;
+        EXPECT_NEAR(linalg::det(std::move(cm)), expected, 1e-12);
+        auto moved_log = linalg::slogdet(std::move(cm2));
+        EXPECT_EQ(std::get<0>(moved_log), std::get<0>(expected_log));
+        EXPECT_NEAR(std::get<1>(moved_log), std::get<1>(expected_log), 1e-12);
+    }
+
+    TEST(xlinalg, batched)
+    {
+        xt::random::seed(0);
+        xarray<double> a = xt::random::rand<double>({3, 4, 5, 5});
+        xarray<double> b = xt::random::rand<double>({5});
+
+        auto d = linalg::batched([](const xtensor<double, 2>& m) { return linalg::det(m); }, a);
+        auto x = linalg::batched([&b](const xtensor<double, 2>& m) { return linalg::solve(m, b); }, a);
+        auto e = linalg::batched([](const xtensor<double, 2>& m) { return linalg::eigh(m); }, a);
+        EXPECT_EQ(d.dimension(), std::size_t(2));
+        EXPECT_EQ(x.dimension(), std::size_t(3));
+        EXPECT_EQ(x.shape()[2], std::size_t(5));
+        EXPECT_EQ(std::get<1>(e).shape(), a.shape());
+        EXPECT_TRUE(allclose(d, linalg::batch_det(a)));
+        EXPECT_TRUE(allclose(std::get<0>(e), std::get<0>(linalg::batch_eigh(a))));
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            for (std::size_t j = 0; j < 4; ++j)
+            {
+                xarray<double> m = view(a, i, j);
+                EXPECT_TRUE(allclose(view(x, i, j), linalg::solve(m, b)));
+            }
+        }
+
+        // over the last axis only
+        auto n = linalg::batched<1>([](const xtensor<double, 1>& v) { return linalg::norm(v, 2); }, a);
+        EXPECT_EQ(n.dimension(), std::size_t(3));
+        EXPECT_NEAR(n(2, 3, 4), linalg::norm(xarray<double>(view(a, 2, 3, 4, all())), 2), 1e-12);
+
+        auto throwing = [](const xtensor<double, 2>& m) -> double {
+            if (m(0, 0) > 0.5)
+            {
+                throw std::runtime_error("large");
+            }
+            return 0.;
+        };
+        EXPECT_THROW(linalg::batched(throwing, a), std::runtime_error);
+        EXPECT_THROW(linalg::batched([](const xtensor<double, 2>& m) { return linalg::det(m); }, b), std::runtime_error);
+    }
+
+    TEST(xlinalg, fixed_size)
+    {
+        xtensor_fixed<double, xshape<3, 3>> a = {{ 2., 1., 1.},
+                                                 {-1., 1.,-1.},
+                                                 { 1., 2., 3.}};
+        xtensor_fixed<double, xshape<3>> b = {2., 3., -10.};
+        xarray<double> ad = a;
+        xarray<double> bd = b;
+
+        auto d = linalg::det(a);
+        EXPECT_NEAR(d, linalg::det(ad), 1e-12);
+
+        auto ai = linalg::inv(a);
+        static_assert(std::is_same<decltype(ai), xtensor_fixed<double, xshape<3, 3>>>::value,
+                      "inv of a fixed-size matrix should be fixed-size");
+        EXPECT_TRUE(allclose(ai, linalg::inv(ad)));
+
+        auto x = linalg::solve(a, b);
+        static_assert(std::is_same<decltype(x), xtensor_fixed<double, xshape<3>>>::value,
+                      "solve of a fixed-size system should be fixed-size");
+        xarray<double> expected = {3., 1., -5.};
+        EXPECT_TRUE(allclose(x, expected));
+
+        xtensor_fixed<double, xshape<3, 2>> B = {{2., 18.}, {3., 6.}, {-10., -30.}};
+        xarray<double> expected_B = {{3., 16.}, {1., 4.}, {-5., -18.}};
+        EXPECT_TRUE(allclose(linalg::solve(a, B), expected_B));
+
+        auto p = linalg::dot(a, b);
+        static_assert(std::is_same<decltype(p), xtensor_fixed<double, xshape<3>>>::value,
+                      "dot of fixed-size operands should be fixed-size");
+        EXPECT_TRUE(allclose(p, linalg::dot(ad, bd)));
+        EXPECT_TRUE(allclose(linalg::dot(a, a), linalg::dot(ad, ad)));
+        EXPECT_TRUE(allclose(linalg::dot(b, a), linalg::dot(bd, ad)));
+        EXPECT_TRUE(allclose(linalg::dot(b, b), linalg::dot(bd, bd)));
+
+        auto c = linalg::cross(b, b);
+        static_assert(std::is_same<decltype(c), xtensor_fixed<double, xshape<3>>>::value,
+                      "cross of fixed-size vectors should be fixed-size");
+        EXPECT_TRUE(allclose(c, zeros<double>({3})));
+
+        xtensor_fixed<double, xshape<4, 4>> s = {{4., 1., 0., 0.},
+                                                 {1., 4., 1., 0.},
+                                                 {0., 1., 4., 1.},
+                                                 {0., 0., 1., 4.}};
+        xarray<double> sd = s;
+        EXPECT_NEAR(linalg::det(s), 209., 1e-12);
+        EXPECT_TRUE(allclose(linalg::inv(s), linalg::inv(sd)));
+        EXPECT_TRUE(allclose(linalg::cholesky(s), linalg::cholesky(sd)));
+
+        xtensor_fixed<std::complex<double>, xshape<2, 2>> z = {{1. + 1.i, 2. + 0.i},
+                                                               {0. + 1.i, 3. + 0.i}};
+        xarray<std::complex<double>> zd = z;
+        EXPECT_TRUE(allclose(linalg::inv(z), linalg::inv(zd)));
+
+        xtensor_fixed<double, xshape<2, 2>> singular = {{1., 2.}, {2., 4.}};
+        EXPECT_EQ(linalg::det(singular), 0.);
+        EXPECT_THROW(linalg::inv(singular), std::runtime_error);
+        EXPECT_THROW(linalg::cholesky(singular), std::runtime_error);
+    }
+
+    TEST(xlinalg, gram)
+    {
+        xarray<double> a = {{1., 2., 0.},
+                            {-1., 3., 2.},
+                            {0.5, 1., 4.},
+                            {2., 0., 1.}};
+        xarray<double> expected = linalg::dot(transpose(a), a);
+
+        auto lower = linalg::gram(a);
+        EXPECT_TRUE(allclose(tril(expected), lower));
+        auto upper = linalg::gram(a, 'U');
+        EXPECT_TRUE(allclose(triu(expected), upper));
+        EXPECT_TRUE(allclose(expected, linalg::gram(a, 'L', true)));
+        EXPECT_TRUE(allclose(expected, linalg::gram(a, 'U', true)));
+        EXPECT_TRUE(allclose(linalg::cholesky(expected), linalg::cholesky(lower)));
+
+        xarray<std::complex<double>> z = {{1. + 1.i, 2. + 0.i},
+                                          {0. - 1.i, 3. + 2.i},
+                                          {2. + 0.5i, -1. + 0.i}};
+        xarray<std::complex<double>> zexpected = linalg::dot(conj(transpose(z)), z);
+        EXPECT_TRUE(allclose(zexpected, linalg::gram(z, 'L', true)));
+        EXPECT_TRUE(allclose(zexpected, linalg::gram(z, 'U', true)));
+
+        // large enough for several mirror tiles
+        xarray<double> r = random::rand<double>({50, 70});
+        EXPECT_TRUE(allclose(linalg::dot(transpose(r), r), linalg::gram(r, 'L', true)));
+        xarray<double> rt = transpose(r);
+        EXPECT_TRUE(allclose(linalg::dot(r, rt), linalg::dot(r, transpose(r))));
+
+        // shares its first element with the transposed operand, but is not A * A'
+        xtensor<double, 2> x = {{1., 2., 3.},
+                                {4., 5., 6.},
+                                {7., 8., 10.}};
+        xtensor<double, 2> x_head = view(x, range(0, 2), all());
+        xtensor<double, 2> x_t = transpose(x);
+        EXPECT_TRUE(allclose(linalg::dot(x_head, x_t), linalg::dot(view(x, range(0, 2), all()), transpose(x))));
+    }
+
+    TEST(xlinalg, gram_accumulator)
+    {
+        xt::random::seed(3);
+        xtensor<double, 2> x = random::randn<double>({103, 6});
+        x += 1e6;
+        xtensor<double, 1> mean = xt::mean(x, {0});
+        xtensor<double, 2> centered = x - view(mean, newaxis(), all());
+        xtensor<double, 2> expected = linalg::dot(transpose(centered), centered) / 102.;
+
+        linalg::gram_accumulator<double> all_rows(6);
+        linalg::gram_accumulator<double> first(6, 'U');
+        linalg::gram_accumulator<double> second(6);
+        for (std::size_t row = 0; row < 103; row += 10)
+        {
+            xtensor<double, 2> chunk = view(x, range(row, std::min(row + 10, std::size_t(103))), all());
+            all_rows.add(chunk);
+            (row < 50 ? first : second).add(chunk);
+        }
+        first.merge(second);
+        for (const auto* acc : {&all_rows, &first})
+        {
+            EXPECT_EQ(acc->rows(), 103u);
+            EXPECT_TRUE(allclose(acc->mean(), mean));
+            EXPECT_TRUE(allclose(acc->covariance(), expected, 1e-8, 1e-8));
+            EXPECT_TRUE(allclose(acc->gram(), linalg::dot(transpose(x), x)));
+        }
+
+        xarray<std::complex<double>> z = {{1. + 1.i, 2. + 0.i},
+                                          {0. - 1.i, 3. + 2.i},
+                                          {2. + 0.5i, -1. + 0.i}};
+        linalg::gram_accumulator<std::complex<double>> zacc(2);
+        zacc.add(z);
+        EXPECT_TRUE(allclose(zacc.gram(), linalg::dot(conj(transpose(z)), z)));
+
+        linalg::gram_accumulator<double> empty(6);
+        EXPECT_THROW(empty.mean(), std::runtime_error);
+        xtensor<double, 2> narrow = random::randn<double>({4, 5});
+        EXPECT_THROW(empty.add(narrow), std::runtime_error);
+    }
+
+    TEST(xlinalg, cross_batched)
+    {
+        xt::random::seed(0);
+        xtensor<double, 2> a = random::rand<double>({5000, 3});
+        xtensor<double, 2> b = random::rand<double>({5000, 3});
+        auto c = linalg::cross(a, b, -1);
+        static_assert(std::is_same<decltype(c), xtensor<double, 2>>::value,
+                      "cross of xtensors should be an xtensor");
+        EXPECT_EQ(c.shape(), a.shape());
+        for (std::size_t i = 0; i < a.shape()[0]; i += 499)
+        {
+            xtensor<double, 1> ai = view(a, i, all());
+            xtensor<double, 1> bi = view(b, i, all());
+            EXPECT_TRUE(allclose(view(c, i, all()), linalg::cross(ai, bi)));
+        }
+
+        // vectors along the first axis, a broadcast operand, expressions
+        xtensor<double, 1> v = {1., -2., 3.};
+        xarray<double> at = transpose(a);
+        EXPECT_TRUE(allclose(linalg::cross(at, v, 0), transpose(linalg::cross(a, v, -1))));
+        EXPECT_TRUE(allclose(linalg::cross(2. * a, b, -1), 2. * c));
+
+        xarray<double> stacked = random::rand<double>({2, 4, 3});
+        auto cs = linalg::cross(stacked, v, -1);
+        EXPECT_EQ(cs.shape(), stacked.shape());
+        xtensor<double, 1> s11 = view(stacked, 1, 1, all());
+        EXPECT_TRUE(allclose(view(cs, 1, 1, all()), linalg::cross(s11, v)));
+
+        // two components
+        xarray<double> p = {{1., 2.}, {3., 4.}};
+        xarray<double> expected = {{6., -3., -4.}, {12., -9., -10.}};
+        EXPECT_TRUE(allclose(linalg::cross(p, v, -1), expected));
+
+        xtensor<double, 2, layout_type::column_major> r = zeros<double>({2, 3});
+        linalg::cross_into(p, v, r);
+        EXPECT_TRUE(allclose(r, expected));
+
+        xtensor<double, 2> wrong = zeros<double>({2, 2});
+        EXPECT_THROW(linalg::cross_into(p, v, wrong), std::runtime_error);
+        EXPECT_THROW(linalg::cross(p, zeros<double>({3, 3}), -1), std::runtime_error);
+        EXPECT_THROW(linalg::cross(p, zeros<double>({2, 4}), -1), std::runtime_error);
+    }
+
+    TEST(xlinalg, random_matrix)
+    {
+        // more entries than one stream, reproducible from the seed
+        auto a = linalg::random_matrix(300, 100, linalg::random_distribution::uniform, 42);
+        EXPECT_EQ(a.shape()[0], 300u);
+        EXPECT_EQ(a.shape()[1], 100u);
+        EXPECT_TRUE(all(a > 0.) && all(a < 1.));
+        EXPECT_EQ(a, linalg::random_matrix(300, 100, linalg::random_distribution::uniform, 42));
+        EXPECT_NE(a, linalg::random_matrix(300, 100, linalg::random_distribution::uniform, 43));
+        EXPECT_NEAR(mean(a)(), 0.5, 0.01);
+
+        auto g = linalg::random_matrix(200, 200);
+        EXPECT_NEAR(mean(g)(), 0., 0.02);
+        EXPECT_NEAR(mean(g * g)(), 1., 0.02);
+        auto s = linalg::random_matrix<float>(20, 30, linalg::random_distribution::symmetric_uniform, 1);
+        EXPECT_TRUE(all(s > -1.f) && all(s < 1.f));
+
+        auto q = linalg::random_orthogonal(50, 3);
+        EXPECT_TRUE(allclose(linalg::dot(transpose(q), q), eye<double>(50), 1e-10, 1e-12));
+        auto u = linalg::random_orthogonal<std::complex<double>>(20, 3);
+        EXPECT_TRUE(allclose(linalg::dot(conj(transpose(u)), u), eye<std::complex<double>>(20), 1e-10, 1e-12));
+
+        auto spd = linalg::random_spd(40, 1e3, 5);
+        EXPECT_TRUE(allclose(spd, transpose(spd)));
+        auto w = linalg::eigvalsh(spd);
+        EXPECT_NEAR(w(0), 1e-3, 1e-12);
+        EXPECT_NEAR(w(39), 1., 1e-12);
+        EXPECT_NEAR(linalg::cond(spd, 2), 1e3, 1e-6);
+        EXPECT_NO_THROW(linalg::cholesky(linalg::random_spd<std::complex<double>>(10, 100.)));
+        EXPECT_THROW(linalg::random_spd(4, 0.5), std::runtime_error);
+    }
 }
@@ -0,0 +1,152 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <tuple>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlinalg_io.hpp"
+
+namespace xt
+{
+    namespace
+    {
+        std::string fac_path(const char* name)
+        {
+            return ::testing::TempDir() + name;
+        }
+    }
+
+    TEST(xlinalg_io, save_load)
+    {
+        xt::random::seed(3);
+        std::size_t n = 40;
+        xarray<double> b = xt::random::randn<double>({n, n});
+        xarray<double> a = linalg::dot(b, transpose(b)) + 10. * eye<double>(n);
+        xarray<double> rhs = xt::random::randn<double>({n, 3});
+        auto expected = linalg::solve(a, rhs);
+
+        std::string path = fac_path("lu.fac");
+        auto lu = linalg::lu_factor(a);
+        linalg::save_factorization(path, lu);
+        auto lu2 = linalg::load_lu<double>(path);
+        EXPECT_EQ(lu2.matrix(), lu.matrix());
+        EXPECT_TRUE(allclose(lu2.solve(rhs), expected));
+        EXPECT_DOUBLE_EQ(lu2.rcond(), lu.rcond());
+        EXPECT_THROW(linalg::load_cholesky<double>(path), std::runtime_error);
+        EXPECT_THROW(linalg::load_lu<float>(path), std::runtime_error);
+        {
+            linalg::mapped_factorization<double> m(path);
+            EXPECT_EQ(m.kind(), linalg::factorization_kind::lu);
+            EXPECT_TRUE(allclose(m.solve(rhs), expected));
+            EXPECT_EQ(m.pivots()(0), lu.pivots()[0]);
+        }
+
+        path = fac_path("cholesky.fac");
+        auto ch = linalg::cholesky_factor(a);
+        linalg::save_factorization(path, ch);
+        EXPECT_TRUE(allclose(linalg::load_cholesky<double>(path).solve(rhs), expected));
+        EXPECT_DOUBLE_EQ(linalg::load_cholesky<double>(path).rcond(), ch.rcond());
+        {
+            linalg::mapped_factorization<double> m(path);
+            EXPECT_TRUE(allclose(m.matrix(), ch.matrix()));
+            EXPECT_TRUE(allclose(m.solve(view(rhs, all(), 0)), view(expected, all(), 0)));
+        }
+
+        path = fac_path("qr.fac");
+        xarray<double> tall = xt::random::randn<double>({n + 5, n});
+        xarray<double> y = xt::random::randn<double>({n + 5});
+        auto qr = linalg::qr_factor(tall);
+        linalg::save_factorization(path, qr);
+        auto ls = qr.solve(y);
+        EXPECT_TRUE(allclose(linalg::load_qr<double>(path).solve(y), ls));
+        {
+            linalg::mapped_factorization<double> m(path);
+            EXPECT_TRUE(allclose(m.solve(y), ls));
+            EXPECT_TRUE(allclose(m.tau(), qr.tau()));
+        }
+
+        path = fac_path("eigh.fac");
+        auto eh = linalg::eigh(a);
+        linalg::save_eigh(path, std::get<0>(eh), std::get<1>(eh));
+        auto eh2 = linalg::load_eigh<double>(path);
+        EXPECT_TRUE(allclose(std::get<0>(eh2), std::get<0>(eh)));
+        EXPECT_TRUE(allclose(std::get<1>(eh2), std::get<1>(eh)));
+        {
+            linalg::mapped_factorization<double> m(path);
+            EXPECT_TRUE(allclose(m.eigenvalues(), std::get<0>(eh)));
+            EXPECT_TRUE(allclose(m.solve(rhs), expected));
+        }
+        EXPECT_THROW(linalg::mapped_factorization<std::complex<double>> m(path), std::runtime_error);
+        EXPECT_THROW(linalg::mapped_factorization<double> m(fac_path("missing.fac")), std::runtime_error);
+
+        for (const char* name : {"lu.fac", "cholesky.fac", "qr.fac", "eigh.fac"})
+        {
+            std::remove(fac_path(name).c_str());
+        }
+    }
+
+    TEST(xlinalg_io, mapped_matrix)
+    {
+        xt::random::seed(4);
+        std::size_t n = 30;
+        xarray<double> b = xt::random::randn<double>({n, n});
+        xtensor<double, 2, layout_type::column_major> a = linalg::dot(b, transpose(b)) + 5. * eye<double>(n);
+        xarray<double> rhs = xt::random::randn<double>({n});
+
+        std::string path = fac_path("a.npy");
+        linalg::save_npy(path, a);
+        {
+            auto m = linalg::map_npy<double>(path);
+            EXPECT_EQ(m.rows(), n);
+            EXPECT_EQ(m.matrix(), a);
+            EXPECT_TRUE(allclose(linalg::solve(m.matrix(), rhs), linalg::solve(a, rhs)));
+            EXPECT_TRUE(allclose(linalg::cholesky(m.matrix()), linalg::cholesky(a)));
+            EXPECT_THROW(linalg::map_npy<float>(path), std::runtime_error);
+        }
+        {
+            // factor in place on private pages, the file keeps A
+            auto m = linalg::map_npy<double>(path, linalg::mapping_mode::copy_on_write);
+            EXPECT_EQ(lapack::potr(m.matrix(), 'L'), 0);
+            EXPECT_NEAR(m.matrix()(1, 0), linalg::cholesky(a)(1, 0), 1e-12);
+            EXPECT_EQ(linalg::map_npy<double>(path).matrix(), a);
+        }
+
+        // a row-major expression is written by columns
+        xarray<double> r = b;
+        linalg::save_npy(path, view(r, all(), range(0, 4)));
+        EXPECT_EQ(linalg::map_npy<double>(path).matrix(), view(r, all(), range(0, 4)));
+        linalg::save_npy(path, rhs);
+        EXPECT_EQ(linalg::map_npy<double>(path).cols(), std::size_t(1));
+
+        path = fac_path("a.bin");
+        linalg::save_raw(path, a);
+        EXPECT_EQ(linalg::map_raw<double>(path, n, n).matrix(), a);
+        EXPECT_THROW(linalg::map_raw<double>(path, n + 1, n), std::runtime_error);
+
+        path = fac_path("a.mtx");
+        {
+            std::ofstream out(path);
+            out << "%%MatrixMarket matrix array real symmetric\n% a comment\n3 3\n4\n1\n2\n5\n3\n6\n";
+        }
+        xarray<double> expected = {{4., 1., 2.}, {1., 5., 3.}, {2., 3., 6.}};
+        EXPECT_EQ(linalg::load_matrix_market_dense<double>(path), expected);
+
+        for (const char* name : {"a.npy", "a.bin", "a.mtx"})
+        {
+            std::remove(fac_path(name).c_str());
+        }
+    }
+}
@@ -10,11 +10,14 @@
 // This file is generated from test/files/cppy_source/test_lstsq.cppy by preprocess.py!
 
 #include <algorithm>
+#include <cmath>
 
 #include "gtest/gtest.h"
 #include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
 #include "xtensor/xfixed.hpp"
 #include "xtensor/xnoalias.hpp"
+#include "xtensor/xrandom.hpp"
 #include "xtensor/xstrided_view.hpp"
 #include "xtensor/xtensor.hpp"
 #include "xtensor/xview.hpp"
@@ -346,5 +349,54 @@ namespace xt
         EXPECT_TRUE(xt::allclose(std::get<3>(xres), py_res3));
     }
 
+    TEST(xtest_extended, batch_lstsq)
+    {
+        xt::random::seed(9);
+        xtensor<double, 3> a = xt::random::randn<double>({6, 12, 3});
+        xtensor<double, 2> b = xt::random::randn<double>({6, 12});
+        // rank deficient slice: the residual is left out, as by lstsq
+        xt::view(a, 5, xt::all(), 2) = xt::view(a, 5, xt::all(), 1);
+
+        for (auto driver : {linalg::lstsq_driver::gelsd, linalg::lstsq_driver::gelsy, linalg::lstsq_driver::cholesky})
+        {
+            std::size_t count = driver == linalg::lstsq_driver::cholesky ? 5 : 6;
+            auto res = linalg::batch_lstsq(xt::view(a, xt::range(0, count)), xt::view(b, xt::range(0, count)), -1.0, driver);
+            EXPECT_EQ(std::get<0>(res).shape(), (std::vector<std::size_t>{count, 3}));
+            EXPECT_EQ(std::get<1>(res).shape(), (std::vector<std::size_t>{count}));
+            for (std::size_t p = 0; p < count; ++p)
+            {
+                xtensor<double, 2> ap = xt::view(a, p);
+                xtensor<double, 1> bp = xt::view(b, p);
+                auto expected = linalg::lstsq(ap, bp);
+                EXPECT_TRUE(allclose(xt::view(std::get<0>(res), p), std::get<0>(expected)));
+                EXPECT_EQ(std::get<2>(res)(p), std::get<2>(expected));
+                if (std::get<1>(expected).size() == 1)
+                {
+                    EXPECT_NEAR(std::get<1>(res)(p), std::get<1>(expected)(0), 1e-10);
+                }
+                else
+                {
+                    EXPECT_TRUE(std::isnan(std::get<1>(res)(p)));
+                }
+            }
+        }
 
+        // several right-hand sides, through LAPACK for the cholesky driver
+        xtensor<double, 3> a2 = xt::random::randn<double>({3, 20, 10});
+        xtensor<double, 3> b2 = xt::random::randn<double>({3, 20, 2});
+        auto res2 = linalg::batch_lstsq(a2, b2, -1.0, linalg::lstsq_driver::cholesky);
+        for (std::size_t p = 0; p < 3; ++p)
+        {
+            xtensor<double, 2> ap = xt::view(a2, p);
+            xtensor<double, 2> bp = xt::view(b2, p);
+            auto expected = linalg::lstsq(ap, bp);
+            EXPECT_TRUE(allclose(xt::view(std::get<0>(res2), p), std::get<0>(expected)));
+            EXPECT_TRUE(allclose(xt::view(std::get<1>(res2), p), std::get<1>(expected)));
+        }
+
+        EXPECT_THROW(linalg::batch_lstsq(a, xt::view(b, xt::range(0, 5))), std::runtime_error);
+        xtensor<double, 3> wide = xt::ones<double>({2, 3, 5});
+        xtensor<double, 2> wide_b = xt::ones<double>({2, 3});
+        EXPECT_THROW(linalg::batch_lstsq(wide, wide_b, -1.0, linalg::lstsq_driver::cholesky), std::runtime_error);
+    }
 }
@@ -0,0 +1,140 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <complex>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xcomplex.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xmultilinear.hpp"
+
+namespace xt
+{
+    TEST(xmultilinear, mode_product)
+    {
+        xt::random::seed(0);
+        xarray<double> x = xt::random::rand<double>({4, 5, 3});
+        xarray<double, layout_type::column_major> xc = x;
+        xarray<double> u = xt::random::rand<double>({6, 5});
+        xarray<std::complex<double>> z = x + std::complex<double>(0., 1.) * xt::random::rand<double>({4, 5, 3});
+        xarray<std::complex<double>> w = xt::random::rand<double>({3, 6}) + std::complex<double>(0., 1.);
+
+        // X x_1 U(j, ...) = sum_i U(j, i) X(..., i, ...)
+        xarray<double> expected = xt::transpose(linalg::tensordot(u, x, {1}, {1}), {1, 0, 2});
+        EXPECT_TRUE(allclose(linalg::mode_product(x, u, 1), expected));
+        EXPECT_TRUE(allclose(linalg::mode_product(xc, u, 1), expected));
+        EXPECT_TRUE(allclose(linalg::mode_product(x, xt::transpose(u), 1, true), expected));
+        xarray<double> v = xt::random::rand<double>({2, 4});
+        xarray<double> first = linalg::mode_product(x, v, 0);
+        EXPECT_TRUE(allclose(first, linalg::tensordot(v, x, {1}, {0})));
+        EXPECT_TRUE(allclose(xarray<double>(linalg::mode_product(xc, v, 0)), first));
+
+        xarray<std::complex<double>> zc_expected = linalg::tensordot(z, xt::conj(w), {2}, {0});
+        xarray<std::complex<double>, layout_type::column_major> zc = z;
+        for (const auto& product : {xarray<std::complex<double>>(linalg::mode_product(z, w, 2, true)),
+                                    xarray<std::complex<double>>(linalg::mode_product(zc, w, 2, true))})
+        {
+            EXPECT_TRUE(allclose(xt::real(product), xt::real(zc_expected)));
+            EXPECT_TRUE(allclose(xt::imag(product), xt::imag(zc_expected)));
+        }
+
+        EXPECT_THROW(linalg::mode_product(x, u, 0), std::runtime_error);
+        EXPECT_THROW(linalg::mode_product(x, u, 3), std::runtime_error);
+    }
+
+    TEST(xmultilinear, tucker)
+    {
+        xt::random::seed(1);
+        xarray<double> x = xt::random::rand<double>({6, 5, 4, 3});
+
+        // full rank: the decomposition is exact and the factors orthonormal
+        auto full = linalg::hosvd(x, {6, 5, 4, 3});
+        EXPECT_TRUE(allclose(linalg::tucker_to_tensor(full), x));
+        EXPECT_NEAR(full.relative_error, 0., 1e-6);
+        for (const auto& factor : full.factors)
+        {
+            auto n = factor.shape()[1];
+            EXPECT_TRUE(allclose(linalg::dot(xt::transpose(factor), factor), xt::eye<double>(n)));
+        }
+
+        // a tensor of multilinear rank (2, 3, 2, 2) plus noise
+        xarray<double> core = xt::random::rand<double>({2, 3, 2, 2});
+        xarray<double> y = core;
+        for (std::size_t n = 0; n < 4; ++n)
+        {
+            y = linalg::mode_product(y, xt::random::rand<double>({x.shape()[n], y.shape()[n]}), n);
+        }
+        xarray<double> noisy = y + 1e-3 * xt::random::randn<double>(y.shape());
+        std::vector<std::size_t> ranks = {2, 3, 2, 2};
+        auto t = linalg::hosvd(noisy, ranks);
+        EXPECT_LT(t.relative_error, 1e-2);
+        EXPECT_EQ(t.core.shape(), core.shape());
+        EXPECT_NEAR(t.relative_error, linalg::norm(noisy - linalg::tucker_to_tensor(t), linalg::normorder::frob)
+                                          / linalg::norm(noisy, linalg::normorder::frob), 1e-8);
+
+        xarray<double, layout_type::column_major> noisy_c = noisy;
+        auto hooi = linalg::tucker_hooi(noisy_c, ranks);
+        EXPECT_LE(hooi.relative_error, t.relative_error + 1e-12);
+        EXPECT_GE(hooi.iterations, 1u);
+        xarray<double> reconstruction = linalg::tucker_to_tensor(hooi);
+        EXPECT_NEAR(hooi.relative_error, linalg::norm(noisy - reconstruction, linalg::normorder::frob)
+                                             / linalg::norm(noisy, linalg::normorder::frob), 1e-8);
+
+        xarray<std::complex<double>> z = y + std::complex<double>(0., 1.) * xt::random::rand<double>(y.shape());
+        auto tz = linalg::tucker_hooi(z, {6, 5, 4, 3}, 2);
+        xarray<std::complex<double>> zr = linalg::tucker_to_tensor(tz);
+        EXPECT_TRUE(allclose(xt::real(zr), xt::real(z)));
+        EXPECT_TRUE(allclose(xt::imag(zr), xt::imag(z)));
+
+        EXPECT_THROW(linalg::hosvd(x, {6, 5, 4}), std::runtime_error);
+        EXPECT_THROW(linalg::hosvd(x, {7, 5, 4, 3}), std::runtime_error);
+        EXPECT_THROW(linalg::hosvd(x, {6, 0, 4, 3}), std::runtime_error);
+    }
+
+    TEST(xmultilinear, cp_als)
+    {
+        xt::random::seed(2);
+        std::size_t rank = 3;
+        std::vector<std::size_t> shape = {7, 6, 5};
+        linalg::cp_decomposition<double> expected;
+        expected.weights = xtensor<double, 1>{4., 2., 1.};
+        for (auto extent : shape)
+        {
+            expected.factors.emplace_back(xt::random::rand<double>({extent, rank}));
+        }
+        xarray<double> x = linalg::cp_to_tensor(expected);
+
+        auto cp = linalg::cp_als(x, rank, 500, 1e-14);
+        EXPECT_LT(cp.relative_error, 1e-5);
+        EXPECT_TRUE(allclose(linalg::cp_to_tensor(cp), x, 1e-3, 1e-4));
+        for (const auto& factor : cp.factors)
+        {
+            for (std::size_t r = 0; r < rank; ++r)
+            {
+                EXPECT_NEAR(linalg::norm(xt::view(factor, xt::all(), r), 2), 1., 1e-12);
+            }
+        }
+
+        // the same tensor in column major layout, with the error matching the reconstruction
+        xarray<double, layout_type::column_major> xc = x + 1e-2 * xt::random::randn<double>(x.shape());
+        auto cpc = linalg::cp_als(xc, rank, 100, 1e-12, 7);
+        xarray<double, layout_type::column_major> r = linalg::cp_to_tensor<layout_type::column_major>(cpc);
+        EXPECT_NEAR(cpc.relative_error, linalg::norm(xc - r, linalg::normorder::frob)
+                                            / linalg::norm(xc, linalg::normorder::frob), 1e-8);
+        EXPECT_LT(cpc.relative_error, 5e-2);
+
+        EXPECT_THROW(linalg::cp_als(x, 0), std::runtime_error);
+    }
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+
+#include <complex>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xadapt.hpp"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xcomplex.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xout_of_core.hpp"
+
+namespace xt
+{
+    namespace
+    {
+        linalg::out_of_core_t small_budget(std::size_t bytes, bool prefetch = true)
+        {
+            linalg::out_of_core_t options;
+            options.memory_budget = bytes;
+            options.prefetch = prefetch;
+            return options;
+        }
+    }
+
+    TEST(xout_of_core, dot_into)
+    {
+        xt::random::seed(31);
+        for (std::size_t budget : {200u, 3u * 16u * 16u * 8u, 1u << 24})
+        {
+            xtensor<double, 2> a = xt::random::randn<double>({37, 51});
+            xtensor<double, 2, layout_type::column_major> b = xt::random::randn<double>({51, 29});
+            xtensor<double, 2> c = xt::random::randn<double>({37, 29});
+            xtensor<double, 2> expected = 2. * xt::linalg::dot(a, b) + 0.5 * c;
+            xt::linalg::dot_into(a, b, c, small_budget(budget), 2., 0.5);
+            EXPECT_TRUE(xt::allclose(c, expected));
+
+            xt::linalg::dot_into(a, b, c, small_budget(budget, false));
+            EXPECT_TRUE(xt::allclose(c, xt::linalg::dot(a, b)));
+        }
+
+        // a Gram matrix of data adapted in place, as from a memory mapping
+        std::vector<double> storage(300 * 20);
+        auto x = xt::adapt(storage.data(), storage.size(), xt::no_ownership(), std::vector<std::size_t>{300, 20});
+        x = xt::random::randn<double>({300, 20});
+        xtensor<double, 2> gram = xt::zeros<double>({20, 20});
+        xt::linalg::dot_into(xt::transpose(x), x, gram, small_budget(1000));
+        EXPECT_TRUE(xt::allclose(gram, xt::linalg::dot(xt::transpose(x), x)));
+
+        xtensor<std::complex<double>, 2> ca = xt::random::randn<double>({23, 19});
+        ca += std::complex<double>(0., 1.) * xt::random::randn<double>({23, 19});
+        xtensor<std::complex<double>, 2> cb = xt::random::randn<double>({19, 31});
+        xtensor<std::complex<double>, 2> cc = xt::zeros<std::complex<double>>({23, 31});
+        xt::linalg::dot_into(ca, cb, cc, small_budget(2000));
+        EXPECT_TRUE(xt::allclose(cc, xt::linalg::dot(ca, cb)));
+
+        xtensor<double, 2> wrong = xt::zeros<double>({37, 30});
+        xtensor<double, 2> a = xt::random::randn<double>({37, 51});
+        xtensor<double, 2> b = xt::random::randn<double>({51, 29});
+        EXPECT_THROW(xt::linalg::dot_into(a, b, wrong, linalg::out_of_core), std::runtime_error);
+        EXPECT_THROW(xt::linalg::dot_into(a, b, wrong, small_budget(8)), std::runtime_error);
+    }
+
+    TEST(xout_of_core, cholesky_inplace)
+    {
+        xt::random::seed(32);
+        xtensor<double, 2> g = xt::random::randn<double>({50, 50});
+        xtensor<double, 2> a = xt::linalg::dot(g, xt::transpose(g)) + 50. * xt::eye<double>(50);
+        auto expected = xt::linalg::cholesky(a);
+        for (std::size_t budget : {3u * 50u * 8u, 3u * 50u * 8u * 7u, 1u << 24})
+        {
+            xtensor<double, 2, layout_type::column_major> l = a;
+            xt::linalg::cholesky_inplace(l, small_budget(budget));
+            EXPECT_TRUE(xt::allclose(xt::tril(l), expected));
+            EXPECT_TRUE(xt::allclose(xt::triu(l, 1), xt::triu(a, 1)));
+        }
+
+        xtensor<std::complex<double>, 2> cg = xt::random::randn<double>({30, 30});
+        cg += std::complex<double>(0., 1.) * xt::random::randn<double>({30, 30});
+        xtensor<std::complex<double>, 2> ca = xt::linalg::dot(cg, xt::conj(xt::transpose(cg)));
+        ca += 30. * xt::eye<std::complex<double>>(30);
+        xtensor<std::complex<double>, 2> cl = ca;
+        xt::linalg::cholesky_inplace(cl, small_budget(3 * 30 * 16 * 4));
+        EXPECT_TRUE(xt::allclose(xt::tril(cl), xt::linalg::cholesky(ca)));
+
+        xtensor<double, 2> indefinite = {{1., 2.}, {2., 1.}};
+        EXPECT_THROW(xt::linalg::cholesky_inplace(indefinite, linalg::out_of_core), std::runtime_error);
+        EXPECT_THROW(xt::linalg::cholesky_inplace(a, small_budget(8)), std::runtime_error);
+    }
+}
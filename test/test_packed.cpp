@@ -0,0 +1,158 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <complex>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xcomplex.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xpacked.hpp"
+
+using namespace std::complex_literals;
+
+namespace xt
+{
+    TEST(xpacked, storage)
+    {
+        xarray<double> a = {{1., 2., 3.},
+                            {2., 4., 5.},
+                            {3., 5., 6.}};
+
+        xpacked_symmetric<double> lo(a, 'L');
+        EXPECT_EQ(lo.order(), 3u);
+        EXPECT_EQ(lo.storage().size(), 6u);
+        EXPECT_EQ(lo.storage(), (uvector<double>{1., 2., 3., 4., 5., 6.}));
+
+        xpacked_symmetric<double> up(a, 'U');
+        EXPECT_EQ(up.storage(), (uvector<double>{1., 2., 4., 3., 5., 6.}));
+
+        EXPECT_EQ(lo.dense(), a);
+        EXPECT_EQ(up.dense(), a);
+        EXPECT_EQ(up(2, 0), 3.);
+        EXPECT_EQ(lo(0, 2), 3.);
+
+        up.stored(0, 2) = 7.;
+        EXPECT_EQ(up(2, 0), 7.);
+
+        xpacked_triangular<double> t(a, 'U', 'U');
+        xarray<double> expected_t = {{1., 2., 3.},
+                                     {0., 1., 5.},
+                                     {0., 0., 1.}};
+        EXPECT_EQ(t.dense(), expected_t);
+
+        xarray<std::complex<double>> h = {{2. + 0i, 1. - 1i},
+                                          {1. + 1i, 3. + 0i}};
+        xpacked_symmetric<std::complex<double>> hp(h, 'L');
+        EXPECT_EQ(hp(0, 1), 1. - 1i);
+        EXPECT_EQ(hp.dense(), h);
+    }
+
+    TEST(xpacked, cholesky_solve)
+    {
+        xt::random::seed(0);
+        xtensor<double, 2> b = xt::random::rand<double>({6, 6});
+        xtensor<double, 2> a = linalg::dot(xt::transpose(b), b) + 6. * xt::eye<double>(6);
+        xtensor<double, 2> rhs = xt::random::rand<double>({6, 2});
+        xtensor<double, 1> v = xt::random::rand<double>({6});
+
+        for (char uplo : {'L', 'U'})
+        {
+            xpacked_symmetric<double> ap(a, uplo);
+
+            auto l = linalg::cholesky(ap);
+            EXPECT_EQ(l.uplo(), uplo);
+            auto ld = l.dense();
+            xtensor<double, 2> prod = uplo == 'L' ? xtensor<double, 2>(linalg::dot(ld, xt::transpose(ld)))
+                                                  : xtensor<double, 2>(linalg::dot(xt::transpose(ld), ld));
+            EXPECT_TRUE(allclose(prod, a));
+
+            EXPECT_TRUE(allclose(linalg::solve(ap, rhs), linalg::solve(a, rhs)));
+            EXPECT_TRUE(allclose(linalg::solve(ap, v), linalg::solve(a, v)));
+            EXPECT_TRUE(allclose(linalg::solve_cholesky(l, rhs), linalg::solve(a, rhs)));
+            EXPECT_TRUE(allclose(linalg::solve(l, v), linalg::solve(ld, v)));
+
+            EXPECT_TRUE(allclose(linalg::dot(ap, rhs), linalg::dot(a, rhs)));
+            EXPECT_TRUE(allclose(linalg::dot(ap, v), linalg::dot(a, v)));
+            EXPECT_TRUE(allclose(linalg::dot(l, v), linalg::dot(ld, v)));
+        }
+
+        xarray<double> indefinite = {{0., 1.},
+                                     {1., 0.}};
+        xpacked_symmetric<double> ip(indefinite);
+        EXPECT_THROW(linalg::cholesky(ip), std::runtime_error);
+        xarray<double> expected = {2., 1.};
+        EXPECT_TRUE(allclose(linalg::solve(ip, xarray<double>{1., 2.}), expected));
+    }
+
+    TEST(xpacked, eigh)
+    {
+        xarray<double> a = {{2., -1., 0.},
+                            {-1., 2., -1.},
+                            {0., -1., 2.}};
+        xpacked_symmetric<double> ap(a, 'U');
+
+        auto res = linalg::eigh(ap);
+        auto dense_res = linalg::eigh(a);
+        EXPECT_TRUE(allclose(std::get<0>(res), std::get<0>(dense_res)));
+        auto& w = std::get<0>(res);
+        auto& V = std::get<1>(res);
+        EXPECT_TRUE(allclose(linalg::dot(a, V), V * xt::view(w, xt::newaxis(), xt::all())));
+        EXPECT_TRUE(allclose(linalg::eigvalsh(ap), w));
+
+        xarray<std::complex<double>> h = {{2. + 0i, 1. - 1i, 0. + 0i},
+                                          {1. + 1i, 3. + 0i, 0. - 2i},
+                                          {0. + 0i, 0. + 2i, 1. + 0i}};
+        xarray<std::complex<double>> x = {1. + 1i, 2. + 0i, 0. - 1i};
+        for (char uplo : {'L', 'U'})
+        {
+            xpacked_symmetric<std::complex<double>> hp(h, uplo);
+            auto hres = linalg::eigh(hp);
+            EXPECT_TRUE(allclose(std::get<0>(hres), linalg::eigvalsh(h)));
+            auto& hV = std::get<1>(hres);
+            EXPECT_TRUE(allclose(linalg::dot(h, hV), hV * xt::view(std::get<0>(hres), xt::newaxis(), xt::all())));
+
+            EXPECT_TRUE(allclose(linalg::dot(hp, x), linalg::dot(h, x)));
+            EXPECT_TRUE(allclose(linalg::solve(hp, x), linalg::solve(h, x)));
+        }
+    }
+    TEST(xpacked, eigh_select)
+    {
+        xarray<std::complex<double>> h = {{2. + 0i, 1. - 1i, 0. + 0i},
+                                          {1. + 1i, 3. + 0i, 0. - 2i},
+                                          {0. + 0i, 0. + 2i, 1. + 0i}};
+        auto w = linalg::eigvalsh(h);
+        for (char uplo : {'L', 'U'})
+        {
+            xpacked_symmetric<std::complex<double>> hp(h, uplo);
+            auto res = linalg::eigh(hp, linalg::select_index{1, 2});
+            auto& V = std::get<1>(res);
+            EXPECT_EQ(V.shape()[1], std::size_t(2));
+            EXPECT_TRUE(allclose(std::get<0>(res), xt::view(w, xt::range(1, 3))));
+            EXPECT_TRUE(allclose(linalg::dot(h, V), V * xt::view(std::get<0>(res), xt::newaxis(), xt::all())));
+
+            double lower = w(0) + 1e-3, upper = w(2) + 1.;
+            auto values = linalg::eigvalsh(hp, linalg::select_range{lower, upper});
+            EXPECT_TRUE(allclose(values, xt::view(w, xt::range(1, 3))));
+            EXPECT_EQ(std::get<1>(linalg::eigh(hp, linalg::select_range{lower, upper})).shape()[1], std::size_t(2));
+        }
+
+        xarray<double> a = {{2., -1., 0.},
+                            {-1., 2., -1.},
+                            {0., -1., 2.}};
+        xpacked_symmetric<double> ap(a);
+        EXPECT_TRUE(allclose(linalg::eigvalsh(ap, linalg::select_index{0, 0}), xt::view(linalg::eigvalsh(a), xt::range(0, 1))));
+        EXPECT_THROW(linalg::eigvalsh(ap, linalg::select_index{2, 3}), std::runtime_error);
+    }
+}
@@ -0,0 +1,224 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xcomplex.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xsparse.hpp"
+
+using namespace std::complex_literals;
+
+namespace xt
+{
+    TEST(xsparse, storage)
+    {
+        xarray<double> a = {{1., 0., 2.},
+                            {0., 0., 3.},
+                            {4., 5., 0.}};
+
+        xsparse_csr<double> csr(a);
+        EXPECT_EQ(csr.nnz(), 5u);
+        EXPECT_EQ(csr.row_offsets(), (uvector<blas_index_t>{0, 2, 3, 5}));
+        EXPECT_EQ(csr.column_indices(), (uvector<blas_index_t>{0, 2, 2, 0, 1}));
+        EXPECT_EQ(csr.values(), (uvector<double>{1., 2., 3., 4., 5.}));
+        EXPECT_EQ(csr(2, 1), 5.);
+        EXPECT_EQ(csr(1, 0), 0.);
+        EXPECT_EQ(csr.dense(), a);
+
+        xsparse_ccs<double> ccs(a);
+        EXPECT_EQ(ccs.column_offsets(), (uvector<blas_index_t>{0, 2, 3, 5}));
+        EXPECT_EQ(ccs.row_indices(), (uvector<blas_index_t>{0, 2, 2, 0, 1}));
+        EXPECT_EQ(ccs.values(), (uvector<double>{1., 4., 5., 2., 3.}));
+        EXPECT_EQ(ccs.dense(), a);
+        EXPECT_EQ(ccs.transpose().dense(), xt::transpose(a));
+
+        std::vector<std::size_t> rows = {2, 0, 1, 0, 2, 1};
+        std::vector<std::size_t> cols = {1, 2, 2, 0, 0, 2};
+        std::vector<double> vals = {5., 2., 1., 1., 4., 2.};
+        auto t = xsparse_csr<double>::from_triplets(3, 3, rows, cols, vals);
+        EXPECT_EQ(t.nnz(), 5u);
+        EXPECT_EQ(t.column_indices(), csr.column_indices());
+        EXPECT_EQ(t.dense(), a);
+        EXPECT_EQ(xsparse_ccs<double>::from_triplets(3, 3, rows, cols, vals).dense(), a);
+
+        EXPECT_THROW(xsparse_csr<double>(2, 2, {1.}, {0, 1, 2}, {0}), std::runtime_error);
+        EXPECT_THROW(xsparse_csr<double>(2, 2, {1.}, {0, 1, 1}, {2}), std::runtime_error);
+    }
+
+    TEST(xsparse, dot)
+    {
+        xt::random::seed(0);
+        xtensor<double, 2> a = xt::random::rand<double>({40, 30});
+        a = xt::where(a > 0.7, a, 0.);
+        xtensor<double, 1> v = xt::random::rand<double>({30});
+        xtensor<double, 2> m = xt::random::rand<double>({30, 3});
+
+        xsparse_csr<double> csr(a);
+        xsparse_ccs<double> ccs(a);
+        EXPECT_TRUE(allclose(linalg::dot(csr, v), linalg::dot(a, v)));
+        EXPECT_TRUE(allclose(linalg::dot(csr, m), linalg::dot(a, m)));
+        EXPECT_TRUE(allclose(linalg::dot(ccs, v), linalg::dot(a, v)));
+        EXPECT_TRUE(allclose(linalg::dot(ccs, m), linalg::dot(a, m)));
+        xtensor<double, 1> w = xt::random::rand<double>({40});
+        EXPECT_THROW(linalg::dot(csr, w), std::runtime_error);
+        EXPECT_TRUE(allclose(linalg::dot(csr.transpose(), w), linalg::dot(xt::transpose(a), w)));
+
+        xarray<std::complex<double>> h = {{2. + 0i, 1. - 1i, 0. + 0i},
+                                          {1. + 1i, 3. + 0i, 0. - 2i},
+                                          {0. + 0i, 0. + 2i, 1. + 0i}};
+        xarray<std::complex<double>> x = {1. + 1i, 2. + 0i, 0. - 1i};
+        xarray<std::complex<double>> upper = {{2. + 0i, 1. - 1i, 0. + 0i},
+                                              {0. + 0i, 3. + 0i, 0. - 2i},
+                                              {0. + 0i, 0. + 0i, 1. + 0i}};
+        xarray<std::complex<double>> lower = xt::conj(xt::transpose(upper));
+        EXPECT_TRUE(allclose(linalg::dot_symmetric(xsparse_csr<std::complex<double>>(upper), x, 'U'), linalg::dot(h, x)));
+        EXPECT_TRUE(allclose(linalg::dot_symmetric(xsparse_ccs<std::complex<double>>(lower), x, 'L'), linalg::dot(h, x)));
+    }
+
+    TEST(xsparse, expm_multiply)
+    {
+        // 1-D Laplacian, the diagonal is only partially stored
+        std::size_t n = 20;
+        xtensor<double, 2> a = zeros<double>({n, n});
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            a(i, i) = i % 3 == 0 ? 0. : -2.;
+            if (i + 1 < n)
+            {
+                a(i, i + 1) = 1.;
+                a(i + 1, i) = 1.;
+            }
+        }
+        xtensor<double, 2> b = xt::random::rand<double>({n, 2});
+
+        xsparse_csr<double> csr(a);
+        xsparse_ccs<double> ccs(a);
+        auto expected = linalg::expm_multiply(a, b, 0.5);
+        EXPECT_TRUE(allclose(expected, linalg::dot(linalg::expm(xtensor<double, 2>(0.5 * a)), b)));
+        EXPECT_TRUE(allclose(linalg::expm_multiply(csr, b, 0.5), expected));
+        EXPECT_TRUE(allclose(linalg::expm_multiply(ccs, b, 0.5), expected));
+    }
+
+    TEST(xsparse, sparse_product)
+    {
+        xt::random::seed(0);
+        xtensor<double, 2> a = xt::random::rand<double>({40, 30});
+        a = xt::where(a > 0.8, a, 0.);
+        xtensor<double, 2> b = xt::random::rand<double>({30, 25});
+        b = xt::where(b > 0.8, b, 0.);
+
+        auto c = linalg::dot(xsparse_csr<double>(a), xsparse_csr<double>(b));
+        EXPECT_EQ(c.shape()[0], 40u);
+        EXPECT_EQ(c.shape()[1], 25u);
+        EXPECT_TRUE(allclose(c.dense(), linalg::dot(a, b)));
+        for (std::size_t i = 0; i < 40; ++i)
+        {
+            EXPECT_TRUE(std::is_sorted(c.column_indices().begin() + c.row_offsets()[i],
+                                       c.column_indices().begin() + c.row_offsets()[i + 1]));
+        }
+        EXPECT_TRUE(allclose(linalg::dot(xsparse_ccs<double>(a), xsparse_ccs<double>(b)).dense(), linalg::dot(a, b)));
+        EXPECT_THROW(linalg::dot(xsparse_csr<double>(a), xsparse_csr<double>(a)), std::runtime_error);
+
+        xtensor<double, 2> ata = linalg::dot(xt::transpose(a), a);
+        auto g = linalg::gram(xsparse_csr<double>(a));
+        EXPECT_TRUE(allclose(g.dense(), xt::tril(ata)));
+        EXPECT_TRUE(allclose(linalg::gram(xsparse_csr<double>(a), 'U').dense(), xt::triu(ata)));
+        EXPECT_TRUE(allclose(linalg::gram(xsparse_ccs<double>(a), 'L', true).dense(), ata));
+        xtensor<double, 1> v = xt::random::rand<double>({30});
+        EXPECT_TRUE(allclose(linalg::dot_symmetric(g, v, 'L'), linalg::dot(ata, v)));
+
+        xarray<std::complex<double>> z = {{1. + 1i, 0. + 0i, 2. + 0i},
+                                          {0. + 0i, 0. - 3i, 1. + 1i},
+                                          {4. + 0i, 0. + 0i, 0. + 0i},
+                                          {0. + 0i, 1. + 2i, 0. + 1i}};
+        xarray<std::complex<double>> zhz = linalg::dot(xt::conj(xt::transpose(z)), z);
+        EXPECT_TRUE(allclose(linalg::gram(xsparse_csr<std::complex<double>>(z)).dense(), xt::tril(zhz)));
+        EXPECT_TRUE(allclose(linalg::gram(xsparse_ccs<std::complex<double>>(z)).dense(), xt::tril(zhz)));
+        EXPECT_TRUE(allclose(linalg::gram(xsparse_ccs<std::complex<double>>(z), 'U').dense(), xt::triu(zhz)));
+    }
+
+    TEST(xsparse, solve_triangular)
+    {
+        xarray<double> l = {{2., 0., 0.},
+                            {1., 4., 0.},
+                            {0., 3., 5.}};
+        xarray<double> b = {{2., 4.},
+                            {5., 6.},
+                            {8., 13.}};
+
+        xsparse_csr<double> csr(l);
+        xsparse_ccs<double> ccs(l);
+        EXPECT_TRUE(allclose(linalg::dot(l, linalg::solve_triangular(csr, b)), b));
+        EXPECT_TRUE(allclose(linalg::dot(l, linalg::solve_triangular(ccs, b)), b));
+
+        xarray<double> u = xt::transpose(l);
+        xarray<double> v = {1., 2., 3.};
+        EXPECT_TRUE(allclose(linalg::dot(u, linalg::solve_triangular(xsparse_csr<double>(u), v, 'U')), v));
+        EXPECT_TRUE(allclose(linalg::dot(u, linalg::solve_triangular(xsparse_ccs<double>(u), v, 'U')), v));
+
+        xarray<double> unit = l;
+        unit(0, 0) = 1.;
+        unit(1, 1) = 1.;
+        unit(2, 2) = 1.;
+        EXPECT_TRUE(allclose(linalg::dot(unit, linalg::solve_triangular(csr, v, 'L', true)), v));
+
+        xarray<double> singular = {{1., 0.},
+                                   {1., 0.}};
+        EXPECT_THROW(linalg::solve_triangular(xsparse_csr<double>(singular), xarray<double>{1., 1.}), std::runtime_error);
+    }
+
+    TEST(xsparse, triangular_solver)
+    {
+        random::seed(5);
+        std::size_t n = 400;
+        xtensor<double, 2> dense = random::rand<double>({n, n});
+        dense = xt::where(dense > 0.99, dense, 0.) + 4. * xt::eye<double>(n);
+        xtensor<double, 2> l = xt::tril(dense);
+        xtensor<double, 2> u = xt::triu(dense);
+        xtensor<double, 2> b = random::rand<double>({n, std::size_t(3)});
+
+        xsparse_csr<double> A(dense);
+        auto lower = A.triangular_solver('L');
+        EXPECT_GT(lower.levels(), 1u);
+        EXPECT_LT(lower.levels(), n);
+        EXPECT_EQ(lower.level_offsets().back(), static_cast<blas_index_t>(n));
+        EXPECT_TRUE(allclose(linalg::dot(l, lower.solve(b)), b));
+        EXPECT_TRUE(allclose(lower.solve(b), linalg::solve_triangular(A, b, 'L')));
+
+        auto upper = xsparse_ccs<double>(dense).triangular_solver('U');
+        xtensor<double, 1> v = xt::view(b, xt::all(), 0);
+        EXPECT_TRUE(allclose(linalg::dot(u, upper.solve(v)), v));
+
+        // a chain of dependent rows has one row per level
+        xarray<double> bidiagonal = {{2., 0., 0.},
+                                     {1., 4., 0.},
+                                     {0., 3., 5.}};
+        auto chain = xsparse_csr<double>(bidiagonal).triangular_solver('L', true);
+        EXPECT_EQ(chain.levels(), 3u);
+        EXPECT_FALSE(chain.parallel());
+        xarray<double> unit = bidiagonal;
+        unit(0, 0) = unit(1, 1) = unit(2, 2) = 1.;
+        xarray<double> w = {1., 2., 3.};
+        EXPECT_TRUE(allclose(linalg::dot(unit, chain.solve(w)), w));
+
+        xarray<double> singular = {{1., 0.},
+                                   {1., 0.}};
+        EXPECT_THROW(xsparse_csr<double>(singular).triangular_solver(), std::runtime_error);
+    }
+}
@@ -0,0 +1,139 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#if defined(XTENSOR_USE_SUITESPARSE)
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xsparse_direct.hpp"
+
+namespace xt
+{
+    // 1D Laplacian shifted by s, the stiffness matrix of an implicit time step
+    xsparse_ccs<double> shifted_laplacian(std::size_t n, double s)
+    {
+        std::vector<int> rows, cols;
+        std::vector<double> values;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            rows.push_back(int(i));
+            cols.push_back(int(i));
+            values.push_back(2. + s);
+            if (i + 1 < n)
+            {
+                rows.insert(rows.end(), {int(i + 1), int(i)});
+                cols.insert(cols.end(), {int(i), int(i + 1)});
+                values.insert(values.end(), {-1., -1.});
+            }
+        }
+        return xsparse_ccs<double>::from_triplets(n, n, rows, cols, values);
+    }
+
+    TEST(xsparse_direct, cholesky)
+    {
+        auto a = shifted_laplacian(20, 0.5);
+        xarray<double> b = xt::arange<double>(20.);
+        xarray<double> rhs = xt::ones<double>({20, 3});
+
+        auto chol = linalg::cholesky_factor(a);
+        EXPECT_TRUE(allclose(chol.solve(b), linalg::solve(a.dense(), b)));
+        EXPECT_TRUE(allclose(chol.solve(rhs), linalg::solve(a.dense(), rhs)));
+        EXPECT_GT(chol.rcond(), 0.);
+        EXPECT_EQ(chol.analyses(), 1u);
+
+        // same pattern: only the numerical factorization is repeated
+        auto next = shifted_laplacian(20, 1.);
+        chol.refactor(next);
+        EXPECT_EQ(chol.analyses(), 1u);
+        EXPECT_TRUE(allclose(chol.solve(b), linalg::solve(next.dense(), b)));
+        chol.refactor(shifted_laplacian(21, 1.));
+        EXPECT_EQ(chol.analyses(), 2u);
+
+        // CSR storage of the upper triangle
+        xsparse_csr<double> upper(xt::triu(a.dense()));
+        EXPECT_TRUE(allclose(linalg::cholesky_factor(upper, 'U').solve(b), linalg::solve(a.dense(), b)));
+
+        EXPECT_THROW(linalg::cholesky_factor(shifted_laplacian(5, -3.)), std::runtime_error);
+    }
+
+    TEST(xsparse_direct, lu)
+    {
+        std::vector<int> rows = {0, 1, 2, 0, 2, 1};
+        std::vector<int> cols = {0, 0, 1, 1, 2, 2};
+        std::vector<double> values = {4., 1., 2., 3., 5., -1.};
+        auto a = xsparse_ccs<double>::from_triplets(3, 3, rows, cols, values);
+        auto dense = a.dense();
+        xarray<double> b = {{1., 1.}, {2., 0.}, {3., -1.}};
+
+        auto lu = linalg::lu_factor(a);
+        EXPECT_TRUE(allclose(lu.solve(b), linalg::solve(dense, b)));
+        EXPECT_TRUE(allclose(lu.solve(b, 'T'), linalg::solve(xt::transpose(dense), b)));
+        EXPECT_TRUE(allclose(linalg::solve(a, b), linalg::solve(dense, b)));
+        auto logdet = lu.logdet();
+        EXPECT_EQ(std::get<0>(logdet), linalg::det(dense) < 0. ? -1. : 1.);
+        EXPECT_NEAR(std::get<1>(logdet), std::log(std::abs(linalg::det(dense))), 1e-12);
+        lu.refactor(a);
+        EXPECT_EQ(lu.analyses(), 1u);
+
+        auto csr = xsparse_csr<double>::from_triplets(3, 3, rows, cols, values);
+        EXPECT_TRUE(allclose(linalg::lu_factor(csr).solve(b), linalg::solve(dense, b)));
+
+        xarray<double> singular = {{1., 1., 0.}, {1., 1., 0.}, {0., 1., 1.}};
+        auto ls = linalg::lu_factor(xsparse_ccs<double>(singular));
+        EXPECT_TRUE(ls.singular());
+        EXPECT_EQ(ls.rcond(), 0.);
+        EXPECT_THROW(ls.solve(b), std::runtime_error);
+    }
+
+    TEST(xsparse_direct, shift_invert)
+    {
+        // interior eigenvalues of the 1D Laplacian, 2 - 2 cos(k pi / (n + 1))
+        std::size_t n = 60;
+        auto a = shifted_laplacian(n, 0.);
+        auto reference = std::get<0>(linalg::eigh(a.dense()));
+        double sigma = 1.01;
+        std::vector<double> closest(reference.cbegin(), reference.cend());
+        std::sort(closest.begin(), closest.end(), [sigma](double x, double y) {
+            return std::abs(x - sigma) < std::abs(y - sigma);
+        });
+        std::sort(closest.begin(), closest.begin() + 4);
+
+        auto op = linalg::make_shift_invert(a, sigma);
+        auto eig = linalg::eigsh(op, 4);
+        const auto& w = std::get<0>(eig);
+        const auto& v = std::get<1>(eig);
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            EXPECT_NEAR(w(i), closest[i], 1e-9);
+            auto x = xt::eval(xt::view(v, xt::all(), i));
+            EXPECT_TRUE(allclose(linalg::dot(a.dense(), x), w(i) * x, 1e-6, 1e-8));
+        }
+
+        // the same shift reuses the factorization, a new one keeps the pattern
+        op.set_shift(sigma);
+        EXPECT_EQ(op.factorizations(), 1u);
+        op.set_shift(3.);
+        EXPECT_EQ(op.factorizations(), 2u);
+
+        auto cayley = linalg::eigsh(xsparse_csr<double>(a.dense()), 4, sigma, linalg::spectral_transform::cayley);
+        EXPECT_TRUE(allclose(std::get<0>(cayley), w, 1e-8, 1e-9));
+        EXPECT_THROW(linalg::make_shift_invert(a, 0., linalg::spectral_transform::cayley), std::runtime_error);
+    }
+}
+
+#endif
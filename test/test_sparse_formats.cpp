@@ -0,0 +1,150 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <complex>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xkrylov.hpp"
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xsparse_formats.hpp"
+
+namespace xt
+{
+    namespace
+    {
+        // rows of very different lengths, so that SELL has to sort them
+        xsparse_csr<double> irregular_matrix(std::size_t m, std::size_t n)
+        {
+            random::seed(11);
+            xtensor<double, 2> dense = random::rand<double>({m, n});
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                double keep = i % 17 == 0 ? 0.6 : 0.02;
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    if (dense(i, j) > keep)
+                    {
+                        dense(i, j) = 0.;
+                    }
+                }
+            }
+            return xsparse_csr<double>(dense);
+        }
+
+        // dense 3 by 3 blocks on a block tridiagonal pattern
+        xsparse_csr<double> block_matrix(std::size_t blocks)
+        {
+            std::vector<std::size_t> rows, cols;
+            std::vector<double> values;
+            for (std::size_t I = 0; I < blocks; ++I)
+            {
+                for (std::size_t J = (I == 0 ? 0 : I - 1); J < std::min(I + 2, blocks); ++J)
+                {
+                    for (std::size_t k = 0; k < 9; ++k)
+                    {
+                        rows.push_back(3 * I + k / 3);
+                        cols.push_back(3 * J + k % 3);
+                        values.push_back(I == J && k % 4 == 0 ? 8. : -0.5);
+                    }
+                }
+            }
+            return xsparse_csr<double>::from_triplets(3 * blocks, 3 * blocks, rows, cols, values);
+        }
+    }
+
+    TEST(xsparse_formats, sell)
+    {
+        auto A = irregular_matrix(203, 150);
+        xtensor<double, 2> x = random::rand<double>({std::size_t(150), std::size_t(6)});
+        auto expected = linalg::dot(A, x);
+        for (std::size_t C : {2, 4, 8, 16, 32})
+        {
+            for (std::size_t sigma : {1, 64, 0})
+            {
+                xsparse_sell<double> S(A, C, sigma);
+                EXPECT_EQ(S.nnz(), A.nnz());
+                EXPECT_GE(S.stored(), S.nnz());
+                EXPECT_TRUE(allclose(linalg::dot(S, x), expected));
+            }
+        }
+        xsparse_sell<double> sorted(A, 8, 0), unsorted(A, 8, 1);
+        EXPECT_LT(sorted.stored(), unsorted.stored());
+
+        xtensor<double, 1> v = random::rand<double>({std::size_t(150)});
+        EXPECT_TRUE(allclose(linalg::dot(sorted, v), linalg::dot(A, v)));
+        EXPECT_THROW(xsparse_sell<double>(A, 3), std::runtime_error);
+
+        xarray<std::complex<double>> zdense = {{{1., 2.}, {0., 0.}, {3., -1.}},
+                                               {{0., 0.}, {0., 0.}, {0., 1.}}};
+        xsparse_csr<std::complex<double>> Z(zdense);
+        xtensor<std::complex<double>, 1> zx = {{1., 1.}, {2., 0.}, {0., -1.}};
+        EXPECT_TRUE(allclose(linalg::dot(xsparse_sell<std::complex<double>>(Z), zx), linalg::dot(zdense, zx)));
+    }
+
+    TEST(xsparse_formats, bcsr)
+    {
+        auto A = block_matrix(40);
+        xtensor<double, 2> x = random::rand<double>({std::size_t(120), std::size_t(5)});
+        auto expected = linalg::dot(A, x);
+
+        xsparse_bcsr<double> B(A, 3, 3);
+        EXPECT_EQ(B.blocks(), 40u * 3u - 2u);
+        EXPECT_EQ(B.stored(), A.nnz());
+        EXPECT_TRUE(allclose(linalg::dot(B, x), expected));
+
+        // block sizes that do not divide the shape, and the generic kernel
+        auto I = irregular_matrix(203, 150);
+        xtensor<double, 2> y = random::rand<double>({std::size_t(150), std::size_t(2)});
+        for (std::size_t r : {1, 2, 4, 5})
+        {
+            for (std::size_t c : {1, 2, 4, 7})
+            {
+                xsparse_bcsr<double> Bi(I, r, c);
+                EXPECT_EQ(Bi.nnz(), I.nnz());
+                EXPECT_TRUE(allclose(linalg::dot(Bi, y), linalg::dot(I, y)));
+            }
+        }
+    }
+
+    TEST(xsparse_formats, analysis)
+    {
+        auto A = block_matrix(200);
+        auto analysis = linalg::analyze_spmv(A);
+        EXPECT_EQ(analysis.format, linalg::sparse_format::bcsr);
+        EXPECT_EQ(analysis.block_size, 3u);
+        EXPECT_DOUBLE_EQ(analysis.bcsr_fill, 1.);
+
+        auto I = irregular_matrix(500, 300);
+        auto irregular = linalg::analyze_spmv(I);
+        EXPECT_EQ(irregular.format, linalg::sparse_format::sell);
+        EXPECT_GT(irregular.sell_fill, 0.8);
+
+        auto measured = linalg::analyze_spmv(I, true);
+        EXPECT_GT(measured.cost[0], 0.);
+        EXPECT_GT(measured.cost[1], 0.);
+        EXPECT_GT(measured.cost[2], 0.);
+
+        xsparse_tuned<double> T(A);
+        EXPECT_EQ(T.format(), linalg::sparse_format::bcsr);
+        EXPECT_EQ(T.nnz(), A.nnz());
+        xtensor<double, 1> x = random::rand<double>({A.shape()[1]});
+        EXPECT_TRUE(allclose(linalg::dot(T, x), linalg::dot(A, x)));
+
+        // the Krylov solvers take the tuned matrix as their operator
+        xtensor<double, 1> b = linalg::dot(A, x);
+        xtensor<double, 1> solution;
+        EXPECT_TRUE(linalg::cg(T, b, solution).converged);
+        EXPECT_TRUE(allclose(solution, x, 1e-6, 1e-6));
+    }
+}
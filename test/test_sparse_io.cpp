@@ -0,0 +1,128 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xsparse_io.hpp"
+
+using namespace std::complex_literals;
+
+namespace xt
+{
+    namespace
+    {
+        std::string sparse_path(const char* name)
+        {
+            return ::testing::TempDir() + name;
+        }
+    }
+
+    TEST(xsparse_io, matrix_market)
+    {
+        std::string path = sparse_path("xsparse_io_sym.mtx");
+        {
+            std::ofstream out(path);
+            out << "%%MatrixMarket matrix coordinate real symmetric\n"
+                << "% a comment\n"
+                << "\n"
+                << "3 3 4\n"
+                << "1 1 2.0\n"
+                << "3 1 -1.5\n"
+                << "2 2 1e1\n"
+                << "3 1 0.5";
+        }
+        auto A = linalg::load_matrix_market_sparse<double>(path);
+        xarray<double> expected = {{2., 0., -1.},
+                                   {0., 10., 0.},
+                                   {-1., 0., 0.}};
+        EXPECT_EQ(A.nnz(), 4u);
+        EXPECT_EQ(A.dense(), expected);
+
+        path = sparse_path("xsparse_io_herm.mtx");
+        {
+            std::ofstream out(path);
+            out << "%%MatrixMarket matrix coordinate complex hermitian\n"
+                << "2 2 2\n"
+                << "1 1 1 0\n"
+                << "2 1 1 2\n";
+        }
+        auto Z = linalg::load_matrix_market_sparse<std::complex<double>>(path);
+        xarray<std::complex<double>> zexpected = {{1. + 0i, 1. - 2i},
+                                                  {1. + 2i, 0. + 0i}};
+        EXPECT_EQ(Z.dense(), zexpected);
+        EXPECT_THROW(linalg::load_matrix_market_sparse<double>(path), std::runtime_error);
+
+        path = sparse_path("xsparse_io_bad.mtx");
+        {
+            std::ofstream out(path);
+            out << "%%MatrixMarket matrix coordinate pattern general\n"
+                << "2 2 2\n"
+                << "1 1\n"
+                << "3 1\n";
+        }
+        EXPECT_THROW(linalg::load_matrix_market_sparse<double>(path), std::runtime_error);
+        std::remove(path.c_str());
+    }
+
+    TEST(xsparse_io, parallel_and_binary)
+    {
+        std::size_t m = 2000, n = 1500, count = 40000;
+        std::mt19937 gen(42);
+        std::vector<std::size_t> rows(count), cols(count);
+        std::vector<double> values(count);
+        std::string path = sparse_path("xsparse_io_large.mtx");
+        {
+            std::ofstream out(path);
+            out << "%%MatrixMarket matrix coordinate real general\n" << m << " " << n << " " << count << "\n";
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                // eighths are exact, so duplicates sum to the same value in any order
+                rows[k] = gen() % m;
+                cols[k] = gen() % n;
+                values[k] = static_cast<double>(gen() % 1000) / 8.;
+                out << rows[k] + 1 << " " << cols[k] + 1 << " " << values[k] << "\n";
+            }
+        }
+        auto expected = xsparse_csr<double>::from_triplets(m, n, rows, cols, values);
+
+        for (std::size_t threads : {1, 3, 8})
+        {
+            auto A = linalg::load_matrix_market_sparse<double>(path, threads);
+            EXPECT_EQ(A.row_offsets(), expected.row_offsets());
+            EXPECT_EQ(A.column_indices(), expected.column_indices());
+            EXPECT_EQ(A.values(), expected.values());
+        }
+
+        std::string binary = sparse_path("xsparse_io_large.csr");
+        linalg::save_csr(binary, expected);
+        auto B = linalg::load_csr<double>(binary, 4);
+        EXPECT_EQ(B.shape(), expected.shape());
+        EXPECT_EQ(B.row_offsets(), expected.row_offsets());
+        EXPECT_EQ(B.column_indices(), expected.column_indices());
+        EXPECT_EQ(B.values(), expected.values());
+
+        xtensor<double, 1> x = random::rand<double>({n});
+        EXPECT_TRUE(allclose(linalg::dot(B, x), linalg::dot(expected, x)));
+        EXPECT_THROW(linalg::load_csr<float>(binary), std::runtime_error);
+
+        std::remove(path.c_str());
+        std::remove(binary.c_str());
+    }
+}
@@ -0,0 +1,218 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include <complex>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xcomplex.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+#include "xtensor/xview.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xstructured.hpp"
+
+namespace xt
+{
+    TEST(xstructured, diagonal)
+    {
+        xarray<double> d = {1.5, 2.5, 3.5, 4.5};
+        xdiagonal<double> D(d);
+        xarray<double> dense = xt::diag(d);
+        EXPECT_EQ(D.dense(), dense);
+        EXPECT_EQ(D(1, 1), 2.5);
+        EXPECT_EQ(D(1, 2), 0.);
+
+        xt::random::seed(0);
+        xarray<double> x = xt::random::rand<double>({4, 3});
+        xarray<double> y = xt::random::rand<double>({2, 4});
+        xarray<double> v = {1., 2., 3., 4.};
+        EXPECT_TRUE(allclose(linalg::dot(D, x), linalg::dot(dense, x)));
+        EXPECT_TRUE(allclose(linalg::dot(D, v), linalg::dot(dense, v)));
+        EXPECT_TRUE(allclose(linalg::dot(y, D), linalg::dot(y, dense)));
+        EXPECT_TRUE(allclose(linalg::solve(D, x), linalg::solve(dense, x)));
+        EXPECT_TRUE(allclose(linalg::inv(D).dense(), linalg::inv(dense)));
+        EXPECT_NEAR(linalg::det(D), linalg::det(dense), 1e-10);
+
+        xdiagonal<double> singular(3, 0.);
+        EXPECT_THROW(linalg::solve(singular, xarray<double>{1., 2., 3.}), std::runtime_error);
+        EXPECT_THROW(linalg::inv(singular), std::runtime_error);
+        EXPECT_THROW(linalg::dot(D, xarray<double>{1., 2.}), std::runtime_error);
+    }
+
+    TEST(xstructured, block_diagonal)
+    {
+        xt::random::seed(0);
+        xblock_diagonal<double> B;
+        B.push_back(xt::random::rand<double>({2, 2}) + 3. * xt::eye<double>(2));
+        B.push_back(xt::random::rand<double>({3, 3}) + 3. * xt::eye<double>(3));
+        B.push_back(xarray<double>{{2.}});
+        EXPECT_EQ(B.block_count(), 3u);
+        EXPECT_EQ(B.row_offset(2), 5u);
+
+        auto dense = B.dense();
+        EXPECT_EQ(B(3, 4), dense(3, 4));
+        EXPECT_EQ(B(1, 3), 0.);
+
+        xarray<double> x = xt::random::rand<double>({6, 4});
+        xarray<double> y = xt::random::rand<double>({3, 6});
+        xarray<double> v = xt::random::rand<double>({6});
+        EXPECT_TRUE(allclose(linalg::dot(B, x), linalg::dot(dense, x)));
+        EXPECT_TRUE(allclose(linalg::dot(B, v), linalg::dot(dense, v)));
+        EXPECT_TRUE(allclose(linalg::dot(y, B), linalg::dot(y, dense)));
+        EXPECT_TRUE(allclose(linalg::solve(B, x), linalg::solve(dense, x)));
+        EXPECT_TRUE(allclose(linalg::solve(B, v), linalg::solve(dense, v)));
+        EXPECT_TRUE(allclose(linalg::inv(B).dense(), linalg::inv(dense)));
+        EXPECT_NEAR(linalg::det(B), linalg::det(dense), 1e-10);
+
+        // rectangular blocks only multiply
+        using block_type = xblock_diagonal<double>::block_type;
+        xblock_diagonal<double> R(std::vector<block_type>{xt::random::rand<double>({2, 3}),
+                                                          xt::random::rand<double>({3, 1})});
+        xarray<double> xr = xt::random::rand<double>({4, 2});
+        EXPECT_TRUE(allclose(linalg::dot(R, xr), linalg::dot(R.dense(), xr)));
+        EXPECT_THROW(linalg::solve(R, xr), std::runtime_error);
+    }
+
+    TEST(xstructured, permutation)
+    {
+        xarray<int> perm = {3, 0, 4, 1, 2, 5};
+        xpermutation P(perm);
+        auto dense = P.dense();
+        EXPECT_EQ(P(0, 3), 1);
+        EXPECT_EQ(P(0, 0), 0);
+
+        xt::random::seed(0);
+        xarray<double> x = xt::random::rand<double>({6, 3});
+        xarray<double> y = xt::random::rand<double>({2, 6});
+        xarray<std::complex<double>> v = {1., 2., 3., 4., 5., 6.};
+        EXPECT_EQ(linalg::dot(P, x), linalg::dot(dense, x));
+        EXPECT_EQ(linalg::dot(y, P), linalg::dot(y, dense));
+        EXPECT_EQ(linalg::dot(P, v)(0), v(3));
+        EXPECT_EQ(linalg::solve(P, x), linalg::dot(xt::transpose(dense), x));
+        EXPECT_EQ(linalg::inv(P).dense(), xt::transpose(dense));
+        EXPECT_EQ(linalg::det(P), -1);
+
+        // the row interchanges of an LU factorization, P A = L U
+        xarray<double> a = xt::random::rand<double>({6, 6});
+        auto lu = linalg::lu_factor(a);
+        auto Q = xpermutation::from_pivots(lu.pivots());
+        xarray<double> l = xt::tril(lu.matrix(), -1) + xt::eye<double>(6);
+        xarray<double> u = xt::triu(lu.matrix());
+        EXPECT_TRUE(allclose(linalg::dot(Q, a), linalg::dot(l, u)));
+
+        xarray<int> not_perm = {0, 0, 1};
+        EXPECT_THROW(xpermutation{not_perm}, std::runtime_error);
+    }
+
+    TEST(xstructured, toeplitz)
+    {
+        xt::random::seed(0);
+        for (std::size_t n : {1, 5, 100})
+        {
+            xarray<double> c = xt::random::rand<double>({n});
+            xarray<double> r = xt::random::rand<double>({n});
+            c(0) = r(0) = double(n) + 2.;
+            xarray<double> t = xt::zeros<double>({n, n});
+            xarray<double> circulant = xt::zeros<double>({n, n});
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    t(i, j) = i >= j ? c(i - j) : r(j - i);
+                    circulant(i, j) = c((i + n - j) % n);
+                }
+            }
+            xarray<double> b = xt::random::rand<double>({n, 3});
+            xarray<double> v = xt::random::rand<double>({n});
+
+            EXPECT_TRUE(allclose(linalg::solve_toeplitz(c, r, b), linalg::solve(t, b)));
+            EXPECT_TRUE(allclose(linalg::solve_toeplitz(c, r, v), linalg::solve(t, v)));
+            EXPECT_TRUE(allclose(linalg::matmul_toeplitz(c, r, b), linalg::dot(t, b)));
+            EXPECT_TRUE(allclose(linalg::solve_circulant(c, b), linalg::solve(circulant, b)));
+
+            xarray<double> symmetric = (t + xt::transpose(t)) / 2.;
+            xarray<double> sc = xt::view(symmetric, xt::all(), 0);
+            EXPECT_TRUE(allclose(linalg::solve_toeplitz(sc, v), linalg::solve(symmetric, v)));
+        }
+
+        // rectangular products, through the FFT for the larger one
+        for (std::size_t m : {3, 150})
+        {
+            xarray<std::complex<double>> c = xt::random::rand<double>({m}) + std::complex<double>(0., 1.);
+            xarray<double> r = xt::random::rand<double>({m + 7});
+            xarray<std::complex<double>> t = xt::zeros<std::complex<double>>({m, m + 7});
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                for (std::size_t j = 0; j < m + 7; ++j)
+                {
+                    t(i, j) = i >= j ? c(i - j) : std::complex<double>(r(j - i));
+                }
+            }
+            xarray<double> x = xt::random::rand<double>({m + 7, 2});
+            auto product = linalg::matmul_toeplitz(c, r, x);
+            auto expected = linalg::dot(t, x);
+            EXPECT_TRUE(allclose(xt::real(product), xt::real(expected)));
+            EXPECT_TRUE(allclose(xt::imag(product), xt::imag(expected)));
+        }
+
+        xarray<double> zero_first = {0., 1.};
+        EXPECT_THROW(linalg::solve_toeplitz(zero_first, zero_first, xarray<double>{1., 1.}), std::runtime_error);
+        xarray<double> ones = {1., 1.};
+        EXPECT_THROW(linalg::solve_circulant(ones, xarray<double>{1., 1.}), std::runtime_error);
+    }
+
+    TEST(xstructured, vandermonde)
+    {
+        xarray<double> x = {-1., -0.5, 0., 0.3, 0.7, 1.2};
+        xarray<double> v = linalg::vander(x, 6, true);
+        EXPECT_DOUBLE_EQ(v(4, 3), 0.7 * 0.7 * 0.7);
+        EXPECT_TRUE(allclose(linalg::vander(x, 6), xt::flip(v, 1)));
+
+        xt::random::seed(0);
+        xarray<double> b = xt::random::rand<double>({6, 3});
+        xarray<double> bv = xt::view(b, xt::all(), 0);
+        EXPECT_TRUE(allclose(linalg::solve_vandermonde(x, b), linalg::solve(v, b)));
+        EXPECT_TRUE(allclose(linalg::solve_vandermonde(x, bv), linalg::solve(v, bv)));
+
+        // interpolation, matching the coefficients in decreasing powers
+        xarray<double> p = linalg::polyfit(x, b, 5);
+        EXPECT_TRUE(allclose(p, xt::flip(linalg::solve(v, b), 0)));
+
+        // exact fits of a quadratic, in one multi-column solve
+        xarray<double> t = xt::linspace<double>(0., 2., 20);
+        xarray<double> quad = xt::stack(xt::xtuple(3. * t * t - t + 2., -t * t + 0.5));
+        xarray<double> ys = xt::transpose(quad);
+        xarray<double> expected = {{3., -1.}, {-1., 0.}, {2., 0.5}};
+        EXPECT_TRUE(allclose(linalg::polyfit(t, ys, 2), expected));
+        xarray<double> y0 = xt::view(ys, xt::all(), 0);
+        xarray<double> e0 = xt::view(expected, xt::all(), 0);
+        EXPECT_TRUE(allclose(linalg::polyfit(t, y0, 2), e0));
+
+        // weighted fit: the normal equations of the weighted Vandermonde matrix
+        xarray<double> noisy = y0 + 0.1 * xt::random::randn<double>({20});
+        xarray<double> w = xt::random::rand<double>({20}) + 0.5;
+        xarray<double> wv = linalg::vander(t, 3) * xt::view(w, xt::all(), xt::newaxis());
+        xarray<double> wy = w * noisy;
+        xarray<double> normal = linalg::solve(linalg::dot(xt::transpose(wv), wv), linalg::dot(xt::transpose(wv), wy));
+        EXPECT_TRUE(allclose(linalg::polyfit(t, noisy, 2, w), normal));
+
+        // repeated points fall back to the least squares solution
+        xarray<double> repeated = {0., 1., 1.};
+        xarray<double> line = {1., 3., 3.};
+        xarray<double> fit = linalg::polyfit(repeated, line, 2);
+        EXPECT_TRUE(allclose(linalg::dot(linalg::vander(repeated, 3), fit), line));
+
+        EXPECT_THROW(linalg::solve_vandermonde(repeated, line), std::runtime_error);
+        EXPECT_THROW(linalg::polyfit(x, line, 2), std::runtime_error);
+    }
+}
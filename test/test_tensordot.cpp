@@ -258,4 +258,161 @@ namespace xt
         EXPECT_EQ(r, e);
 
     }
+
+    TEST(xtensordot, static_rank)
+    {
+        xtensor<double, 3> a = reshape_view(arange<double>(2 * 3 * 4), {2, 3, 4});
+        xtensor<double, 2> b = reshape_view(arange<double>(4 * 5), {4, 5});
+
+        auto r = linalg::tensordot<1>(a, b);
+        bool r_static = std::is_same<decltype(r), xtensor<double, 3>>::value;
+        EXPECT_TRUE(r_static);
+
+        xarray<double> da = a;
+        xarray<double> db = b;
+        auto e = linalg::tensordot(da, db, 1);
+        EXPECT_EQ(e.dimension(), 3u);
+        EXPECT_EQ(e, r);
+    }
+
+    TEST(xtensordot, mixed_layout)
+    {
+        xarray<double> a = reshape_view(arange<double>(2 * 3 * 4), {2, 3, 4});
+        xarray<double> b = reshape_view(arange<double>(3 * 4 * 5), {3, 4, 5});
+        auto e = linalg::tensordot(a, b, 2);
+
+        xarray<double, layout_type::column_major> a_cm = a;
+        xarray<double, layout_type::column_major> b_cm = b;
+        EXPECT_EQ(e, linalg::tensordot(a_cm, b_cm, 2));
+        EXPECT_EQ(e, linalg::tensordot(a, b_cm, 2));
+        EXPECT_EQ(e, linalg::tensordot(a_cm, b, 2));
+
+        // a column major matrix is consumed as a transposed operand
+        xarray<double> m = reshape_view(arange<double>(4 * 5), {4, 5});
+        xarray<double, layout_type::column_major> m_cm = m;
+        EXPECT_EQ(linalg::tensordot(a, m, 1), linalg::tensordot(a, m_cm, 1));
+
+        xarray<double> empty = zeros<double>({4, 0});
+        auto r_empty = linalg::tensordot(a, empty, 1);
+        EXPECT_EQ(r_empty.size(), 0u);
+    }
+
+    TEST(xtensordot, plan)
+    {
+        xarray<double> a = reshape_view(arange<double>(3 * 4 * 5), {3, 4, 5});
+        xarray<double> b = reshape_view(arange<double>(4 * 2 * 3), {4, 2, 3});
+
+        auto plan = linalg::make_tensordot_plan(3, 3, {1, 0}, {0, 2});
+        std::vector<std::size_t> e_perm_a = {2, 1, 0};
+        std::vector<std::size_t> e_perm_b = {0, 2, 1};
+        EXPECT_EQ(plan.perm_a, e_perm_a);
+        EXPECT_EQ(plan.perm_b, e_perm_b);
+        EXPECT_TRUE(plan.permute_a);
+        EXPECT_TRUE(plan.permute_b);
+
+        xarray<double> a_t = transpose(a, {2, 1, 0});
+        xarray<double> b_t = transpose(b, {0, 2, 1});
+        auto e = linalg::tensordot(a_t, b_t, 2);
+        EXPECT_EQ(e, linalg::tensordot(a, b, plan));
+        EXPECT_EQ(e, linalg::tensordot(a, b, {1, 0}, {0, 2}));
+
+        // transposed matrices are consumed without copies
+        xarray<double> m = reshape_view(arange<double>(3 * 4), {3, 4});
+        xarray<double> n = reshape_view(arange<double>(3 * 5), {3, 5});
+        auto r = linalg::tensordot(m, n, {0}, {0});
+        xarray<double> em = linalg::dot(xarray<double>(transpose(m)), n);
+        EXPECT_EQ(em, r);
+
+        auto identity = linalg::make_tensordot_plan(2, 2, {1}, {0});
+        EXPECT_FALSE(identity.permute_a);
+        EXPECT_FALSE(identity.permute_b);
+    }
+
+    TEST(xtensordot, contract)
+    {
+        // contracted axes interleaved with free ones, large enough for the blocked kernel
+        xarray<double> a = reshape_view(arange<double>(6 * 5 * 4 * 3), {6, 5, 4, 3});
+        xarray<double> b = reshape_view(arange<double>(3 * 7 * 5 * 2), {3, 7, 5, 2});
+        xarray<double> a_t = transpose(a, {0, 2, 1, 3});
+        xarray<double> b_t = transpose(b, {2, 0, 1, 3});
+        auto expected = linalg::tensordot(a_t, b_t, 2);
+        EXPECT_EQ(expected, linalg::contract(a, b, {1, 3}, {2, 0}));
+        EXPECT_EQ(expected, linalg::tensordot(a, b, {1, 3}, {2, 0}));
+
+        xarray<double, layout_type::column_major> a_cm = a;
+        xarray<double, layout_type::column_major> b_cm = b;
+        xarray<double, layout_type::column_major> r_cm = linalg::contract(a_cm, b_cm, {1, 3}, {2, 0});
+        EXPECT_EQ(xarray<double>(r_cm), expected);
+
+        // strided views and operands of another value type
+        auto v = strided_view(a, {all(), range(1, 5), all(), all()});
+        xarray<double> v_t = transpose(xarray<double>(v), {0, 2, 1, 3});
+        xarray<double> bv = view(b, all(), all(), range(0, 4), all());
+        EXPECT_EQ(linalg::tensordot(v_t, xarray<double>(transpose(bv, {2, 0, 1, 3})), 2),
+                  linalg::contract(v, bv, {1, 3}, {2, 0}));
+        xarray<int> bi = b;
+        EXPECT_EQ(expected, linalg::contract(a, bi, {1, 3}, {2, 0}));
+
+        // outer product and transposed matrices
+        xarray<double> x = {1., 2., 3.};
+        EXPECT_EQ(linalg::tensordot(x, x, 0), linalg::contract(x, x, {}, {}));
+        xarray<double> s = reshape_view(arange<double>(3 * 4), {3, 4});
+        xarray<double> w = reshape_view(arange<double>(4 * 3), {4, 3});
+        EXPECT_EQ(linalg::tensordot(xarray<double>(transpose(s)), xarray<double>(transpose(w)), 1),
+                  linalg::contract(s, w, {0}, {1}));
+
+        EXPECT_THROW(linalg::contract(a, b, {0, 3}, {2, 0}), std::runtime_error);
+    }
+
+    TEST(xtensordot, einsum)
+    {
+        xarray<double> a = reshape_view(arange<double>(3 * 4), {3, 4});
+        xarray<double> b = reshape_view(arange<double>(4 * 5), {4, 5});
+        xarray<double> c = reshape_view(arange<double>(5 * 2), {5, 2});
+        xarray<double> ab = linalg::dot(a, b);
+
+        EXPECT_EQ(ab, linalg::einsum("ij,jk->ik", a, b));
+        EXPECT_EQ(ab, linalg::einsum("ij,jk", a, b));
+        EXPECT_EQ(xarray<double>(transpose(ab)), linalg::einsum("ij,jk->ki", a, b));
+        EXPECT_EQ(xarray<double>(linalg::dot(ab, c)), linalg::einsum("ij, jk, kl -> il", a, b, c));
+        EXPECT_EQ(xarray<double>(transpose(a)), linalg::einsum("ij->ji", a));
+
+        xarray<double> t = reshape_view(arange<double>(2 * 3 * 4), {2, 3, 4});
+        EXPECT_EQ(linalg::tensordot(t, b, 1), linalg::einsum("ijk,kl->ijl", t, b));
+        EXPECT_EQ(linalg::tensordot(t, a, {1, 2}, {0, 1}), linalg::einsum("ijk,jk->i", t, a));
+
+        // batch labels go through a batched GEMM
+        xarray<double> s = reshape_view(arange<double>(2 * 4 * 5), {2, 4, 5});
+        EXPECT_EQ(linalg::matmul(t, s), linalg::einsum("bij,bjk->bik", t, s));
+
+        // trace, diagonal and reductions
+        xarray<double> sq = reshape_view(arange<double>(4 * 4), {4, 4});
+        EXPECT_EQ(30., linalg::einsum("ii", sq)());
+        xarray<double> diag = {0., 5., 10., 15.};
+        EXPECT_EQ(diag, linalg::einsum("ii->i", sq));
+        xarray<double> row_sums = {6., 22., 38.};
+        EXPECT_EQ(row_sums, linalg::einsum("ij->i", a));
+        xarray<double> v = {1., 2., 3., 4.};
+        EXPECT_EQ(30., linalg::einsum("i,i", v, v)());
+
+        EXPECT_THROW(linalg::einsum("ij,jk->ik", a, c), std::runtime_error);
+        EXPECT_THROW(linalg::einsum("...j,jk->ik", a, b), std::runtime_error);
+        EXPECT_THROW(linalg::einsum("ij,jk->iz", a, b), std::runtime_error);
+    }
+
+    TEST(xtensordot, einsum_plan)
+    {
+        // (A * B) * C is 100 times cheaper than A * (B * C)
+        auto plan = linalg::make_einsum_plan("ij,jk,kl->il", {{10, 1000}, {1000, 5}, {5, 500}});
+        ASSERT_EQ(plan.path.size(), 2u);
+        EXPECT_EQ(plan.path[0], std::make_pair(std::size_t(0), std::size_t(1)));
+        EXPECT_EQ(plan.flops, 75000.);
+        plan = linalg::make_einsum_plan("ij,jk,kl->il", {{500, 5}, {5, 1000}, {1000, 10}});
+        EXPECT_EQ(plan.path[0], std::make_pair(std::size_t(1), std::size_t(2)));
+
+        xarray<double> a = reshape_view(arange<double>(3 * 4), {3, 4});
+        xarray<double> b = reshape_view(arange<double>(4 * 5), {4, 5});
+        auto p = linalg::make_einsum_plan("ij,jk->ik", {{3, 4}, {4, 5}});
+        EXPECT_EQ(xarray<double>(linalg::dot(a, b)), linalg::einsum(p, a, b));
+    }
 }
@@ -0,0 +1,163 @@
+/***************************************************************************
+* Copyright (c) Wolf Vollprecht, Johan Mabille and Sylvain Corlay          *
+* Copyright (c) QuantStack                                                 *
+*                                                                          *
+* Distributed under the terms of the BSD 3-Clause License.                 *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+
+#include <complex>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xtensor/xarray.hpp"
+#include "xtensor/xbuilder.hpp"
+#include "xtensor/xcomplex.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xtensor.hpp"
+
+#include "xtensor-blas/xlinalg.hpp"
+#include "xtensor-blas/xtiled.hpp"
+
+namespace xt
+{
+    namespace
+    {
+        linalg::parallel::tiled_t small_tiles(std::size_t tile_size, std::size_t threads)
+        {
+            linalg::parallel::tiled_t tiling;
+            tiling.tile_size = tile_size;
+            tiling.threads = threads;
+            return tiling;
+        }
+    }
+
+    TEST(xtiled, cholesky)
+    {
+        xt::random::seed(21);
+        for (std::size_t n : {10u, 64u, 97u})
+        {
+            xtensor<double, 2> g = xt::random::randn<double>({n, n});
+            xtensor<double, 2> a = xt::linalg::dot(g, xt::transpose(g)) + double(n) * xt::eye<double>(n);
+            auto expected = xt::linalg::cholesky(a);
+            auto L = xt::linalg::cholesky(a, small_tiles(16, 4));
+            EXPECT_TRUE(xt::allclose(L, expected, 1e-12, 1e-10));
+        }
+
+        xtensor<std::complex<double>, 2> g = xt::random::randn<double>({50, 50});
+        g += std::complex<double>(0., 1.) * xt::random::randn<double>({50, 50});
+        xtensor<std::complex<double>, 2> a = xt::linalg::dot(g, xt::conj(xt::transpose(g)));
+        a += 50. * xt::eye<std::complex<double>>(50);
+        auto L = xt::linalg::cholesky(a, small_tiles(16, 3));
+        EXPECT_TRUE(xt::allclose(L, xt::linalg::cholesky(a), 1e-12, 1e-10));
+
+        xtensor<double, 2> indefinite = {{1., 2.}, {2., 1.}};
+        EXPECT_THROW(xt::linalg::cholesky(indefinite, small_tiles(1, 2)), std::runtime_error);
+    }
+
+    TEST(xtiled, lu_factor)
+    {
+        xt::random::seed(22);
+        for (std::size_t n : {10u, 64u, 97u})
+        {
+            xtensor<double, 2> a = xt::random::randn<double>({n, n});
+            auto expected = xt::linalg::lu_factor(a);
+            auto lu = xt::linalg::lu_factor(a, small_tiles(16, 4));
+            EXPECT_EQ(lu.pivots(), expected.pivots());
+            EXPECT_TRUE(xt::allclose(lu.matrix(), expected.matrix(), 1e-12, 1e-10));
+
+            xtensor<double, 1> b = xt::random::randn<double>({n});
+            EXPECT_TRUE(xt::allclose(lu.solve(b), xt::linalg::solve(a, b)));
+        }
+
+        xtensor<double, 2> singular = {{1., 2., 3.}, {2., 4., 6.}, {1., 0., 1.}};
+        EXPECT_TRUE(xt::linalg::lu_factor(singular, small_tiles(1, 2)).singular());
+    }
+
+    TEST(xtiled, qr)
+    {
+        xt::random::seed(23);
+        for (auto shape : {std::make_pair(100u, 60u), std::make_pair(97u, 97u), std::make_pair(50u, 17u)})
+        {
+            xtensor<double, 2> a = xt::random::randn<double>({shape.first, shape.second});
+            auto qr = xt::linalg::qr(a, small_tiles(16, 4));
+            const auto& Q = std::get<0>(qr);
+            const auto& R = std::get<1>(qr);
+            EXPECT_EQ(Q.shape()[1], shape.second);
+            EXPECT_TRUE(xt::allclose(xt::linalg::dot(Q, R), a, 1e-10, 1e-10));
+            EXPECT_TRUE(xt::allclose(xt::linalg::dot(xt::transpose(Q), Q), xt::eye<double>(shape.second), 1e-10, 1e-10));
+            EXPECT_TRUE(xt::allclose(R, xt::triu(R)));
+
+            auto expected = std::get<1>(xt::linalg::qr(a));
+            EXPECT_TRUE(xt::allclose(xt::abs(R), xt::abs(expected), 1e-8, 1e-8));
+        }
+
+        xtensor<std::complex<double>, 2> c = xt::random::randn<double>({40, 30});
+        c += std::complex<double>(0., 1.) * xt::random::randn<double>({40, 30});
+        auto qr = xt::linalg::qr(c, small_tiles(8, 2));
+        EXPECT_TRUE(xt::allclose(xt::linalg::dot(std::get<0>(qr), std::get<1>(qr)), c, 1e-10, 1e-10));
+    }
+
+    TEST(xtiled, tsqr)
+    {
+        xt::random::seed(24);
+        linalg::tsqr_options options;
+        options.block_rows = 40;
+        options.threads = 4;
+        for (std::size_t m : {20u, 300u, 441u})
+        {
+            xtensor<double, 2> a = xt::random::randn<double>({m, std::size_t(20)});
+            auto f = xt::linalg::tsqr_factor(a, options);
+            auto Q = f.q();
+            auto R = f.r();
+            EXPECT_TRUE(xt::allclose(xt::linalg::dot(Q, R), a, 1e-10, 1e-10));
+            EXPECT_TRUE(xt::allclose(xt::linalg::dot(xt::transpose(Q), Q), xt::eye<double>(20), 1e-10, 1e-10));
+            EXPECT_TRUE(xt::allclose(xt::abs(R), xt::abs(std::get<1>(xt::linalg::qr(a))), 1e-8, 1e-8));
+
+            xtensor<double, 1> b = xt::random::randn<double>({m});
+            auto expected = std::get<0>(xt::linalg::lstsq(a, b));
+            EXPECT_TRUE(xt::allclose(f.solve(b), expected, 1e-8, 1e-8));
+            EXPECT_TRUE(xt::allclose(f.apply_qh(b), xt::linalg::dot(xt::transpose(Q), b), 1e-10, 1e-10));
+        }
+
+        xtensor<std::complex<double>, 2> c = xt::random::randn<double>({130, 12});
+        c += std::complex<double>(0., 1.) * xt::random::randn<double>({130, 12});
+        auto f = xt::linalg::tsqr_factor(c, options);
+        EXPECT_TRUE(xt::allclose(xt::linalg::dot(f.q(), f.r()), c, 1e-10, 1e-10));
+
+        xtensor<double, 2> wide = xt::random::randn<double>({3, 5});
+        EXPECT_THROW(xt::linalg::tsqr_factor(wide), std::runtime_error);
+    }
+
+    TEST(xtiled, tsqr_stream)
+    {
+        xt::random::seed(25);
+        xtensor<double, 2> a = xt::random::randn<double>({250, 8});
+        xtensor<double, 2> b = xt::random::randn<double>({250, 2});
+
+        std::vector<std::pair<xtensor<double, 2>, xtensor<double, 2>>> blocks;
+        for (std::size_t row = 0; row < 250; row += 60)
+        {
+            std::size_t end = std::min(row + 60, std::size_t(250));
+            blocks.emplace_back(xt::view(a, xt::range(row, end), xt::all()), xt::view(b, xt::range(row, end), xt::all()));
+        }
+        auto stream = xt::linalg::lstsq_stream(blocks.begin(), blocks.end());
+        EXPECT_EQ(stream.rows(), 250u);
+        auto expected = xt::linalg::lstsq(a, b);
+        EXPECT_TRUE(xt::allclose(stream.solve(), std::get<0>(expected), 1e-8, 1e-8));
+        EXPECT_TRUE(xt::allclose(stream.residuals(), std::get<1>(expected), 1e-8, 1e-8));
+
+        std::vector<xtensor<double, 2>> rows;
+        for (std::size_t row = 0; row < 250; row += 3)
+        {
+            rows.push_back(xt::view(a, xt::range(row, std::min(row + 3, std::size_t(250))), xt::all()));
+        }
+        auto R = xt::linalg::tsqr_r(rows.begin(), rows.end());
+        EXPECT_TRUE(xt::allclose(xt::abs(R), xt::abs(std::get<1>(xt::linalg::qr(a))), 1e-8, 1e-8));
+
+        std::vector<xtensor<double, 2>> none;
+        EXPECT_THROW(xt::linalg::tsqr_r(none.begin(), none.end()), std::runtime_error);
+    }
+}